@@ -0,0 +1,71 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "glLoader.h"
+
+#include "glGpuTimer.h"
+
+GLGpuTimer::~GLGpuTimer() {
+    for (int i = 0; i < kNumFrames; ++i) {
+        if (!_queries[i].empty()) {
+            glDeleteQueries((GLsizei)_queries[i].size(), &_queries[i][0]);
+        }
+    }
+}
+
+void
+GLGpuTimer::writeTimestamp(int slot, int query) {
+#if defined(GL_VERSION_3_3) || defined(GL_ARB_timer_query)
+    std::vector<GLuint> & queries = _queries[slot];
+    while ((int)queries.size() <= query) {
+        GLuint q = 0;
+        glGenQueries(1, &q);
+        queries.push_back(q);
+    }
+    glQueryCounter(queries[query], GL_TIMESTAMP);
+#else
+    (void)slot;
+    (void)query;
+#endif
+}
+
+bool
+GLGpuTimer::readTimestamps(int slot, int count, double *times) {
+#if defined(GL_VERSION_3_3) || defined(GL_ARB_timer_query)
+    std::vector<GLuint> const & queries = _queries[slot];
+    if ((int)queries.size() < count) return false;
+
+    for (int i = 0; i < count; ++i) {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &nanoseconds);
+        times[i] = (double)nanoseconds * 1.0e-6;
+    }
+    return true;
+#else
+    (void)slot;
+    (void)count;
+    (void)times;
+    return false;
+#endif
+}
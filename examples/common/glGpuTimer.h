@@ -0,0 +1,49 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV_EXAMPLES_GL_GPU_TIMER_H
+#define OPENSUBDIV_EXAMPLES_GL_GPU_TIMER_H
+
+#include "glLoader.h"
+
+#include "./gpuTimer.h"
+
+// GpuTimer implemented with GL timestamp queries (GL 3.3 or
+// ARB_timer_query), these do not interfere with GL_TIME_ELAPSED queries
+class GLGpuTimer : public GpuTimer {
+public:
+    GLGpuTimer() { }
+    virtual ~GLGpuTimer();
+
+protected:
+    virtual void beginFrameQueries(int /* slot */) { }
+    virtual void endFrameQueries(int /* slot */) { }
+    virtual void writeTimestamp(int slot, int query);
+    virtual bool readTimestamps(int slot, int count, double *times);
+
+private:
+    std::vector<GLuint> _queries[kNumFrames];
+};
+
+#endif  // OPENSUBDIV_EXAMPLES_GL_GPU_TIMER_H
@@ -87,7 +87,8 @@ genTextureBuffer(GLenum format, GLsizeiptr size, GLvoid const * data)
 GLPtexMipmapTexture *
 GLPtexMipmapTexture::Create(PtexTexture * reader,
                                int maxLevels,
-                               size_t targetMemory)
+                               size_t targetMemory,
+                               int maxResidentPages)
 {
     GLPtexMipmapTexture * result = NULL;
 
@@ -98,7 +99,10 @@ GLPtexMipmapTexture::Create(PtexTexture * reader,
     PtexMipmapTextureLoader loader(reader,
                                    maxNumPages,
                                    maxLevels,
-                                   targetMemory);
+                                   targetMemory,
+                                   true,  // seamlessMipmap
+                                   false, // padAlpha
+                                   maxResidentPages);
 
     // Setup GPU memory
     int numFaces = loader.GetNumFaces();
@@ -139,7 +143,25 @@ GLPtexMipmapTexture::Create(PtexTexture * reader,
                  loader.GetPageHeight(),
                  loader.GetNumPages(),
                  0, format, type,
-                 loader.GetTexelBuffer());
+                 NULL);
+
+    // pack and upload the pages progressively
+    for (int page = 0; page < loader.GetNumPages(); ) {
+        int numPages = (page == loader.GetFirstResidentPage() &&
+                        loader.GetNumResidentPages() > 0)
+                     ? loader.GetNumResidentPages()
+                     : loader.GeneratePages(page);
+        if (numPages == 0) break;
+
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0,
+                        0, 0, page,
+                        loader.GetPageWidth(),
+                        loader.GetPageHeight(),
+                        numPages,
+                        format, type,
+                        loader.GetTexelBuffer());
+        page += numPages;
+    }
 
 //    loader.ClearBuffers();
 
@@ -34,9 +34,12 @@
 
 class GLPtexMipmapTexture : OpenSubdiv::Osd::NonCopyable<GLPtexMipmapTexture> {
 public:
+    /// Creates the texture, packing and uploading the texels of at most
+    /// maxResidentPages pages at a time (all pages at once if 0)
     static GLPtexMipmapTexture * Create(PtexTexture * reader,
                                            int maxLevels=-1,
-                                           size_t targetMemory=0);
+                                           size_t targetMemory=0,
+                                           int maxResidentPages=8);
 
     /// Returns GLSL shader snippet to fetch ptex
     static const char *GetShaderSource();
@@ -29,6 +29,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "./shaderCache.h"
 
 class GLDrawConfig {
@@ -46,7 +47,8 @@ public:
 private:
     GLuint _program;
     std::string _version;
-    int _numShaders;
+    std::vector<GLenum> _shaderTypes;
+    std::vector<std::string> _shaderSources;
 };
 
 // workaround for template alias
@@ -0,0 +1,175 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV_EXAMPLES_GPU_TIMER_H
+#define OPENSUBDIV_EXAMPLES_GPU_TIMER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Measures the GPU time of named sections of each frame with timestamp
+// queries. The queries of a frame are read back several frames later so
+// that the CPU never waits on the GPU. Sections may be nested. A history
+// of the most recent frames can be written to a CSV file.
+//
+// The graphics API specific subclasses issue and resolve the timestamps.
+class GpuTimer {
+public:
+    // number of frames in flight before results are read back
+    static const int kNumFrames = 4;
+
+    GpuTimer(int maxHistory = 1000) :
+        _frame(0), _inFrame(false), _maxHistory(maxHistory) { }
+
+    virtual ~GpuTimer() { }
+
+    void BeginFrame() {
+        FrameQueries & frame = _frames[_frame % kNumFrames];
+        if (!frame.names.empty()) {
+            resolveFrame(_frame - kNumFrames, frame);
+        }
+        frame.names.clear();
+        frame.parents.clear();
+        _openSections.clear();
+
+        beginFrameQueries(_frame % kNumFrames);
+        _inFrame = true;
+    }
+
+    void EndFrame() {
+        if (!_inFrame) return;
+        while (!_openSections.empty()) End();
+
+        endFrameQueries(_frame % kNumFrames);
+        _inFrame = false;
+        ++_frame;
+    }
+
+    // sections started outside of BeginFrame() / EndFrame() are ignored
+    void Begin(const char *name) {
+        if (!_inFrame) return;
+        FrameQueries & frame = _frames[_frame % kNumFrames];
+        int section = (int)frame.names.size();
+        frame.names.push_back(name);
+        frame.parents.push_back(_openSections.empty() ? -1 : _openSections.back());
+        _openSections.push_back(section);
+        writeTimestamp(_frame % kNumFrames, 2*section);
+    }
+
+    void End() {
+        if (!_inFrame || _openSections.empty()) return;
+        writeTimestamp(_frame % kNumFrames, 2*_openSections.back() + 1);
+        _openSections.pop_back();
+    }
+
+    // results of the most recently resolved frame, in milliseconds
+    int GetNumSections() const {
+        return (int)_results.size();
+    }
+    const char *GetSectionName(int section) const {
+        return _results[section].name.c_str();
+    }
+    int GetSectionDepth(int section) const {
+        return _results[section].depth;
+    }
+    float GetSectionTime(int section) const {
+        return _results[section].time;
+    }
+
+    // writes "frame,section,depth,ms" for each section of the frames kept
+    // in the history
+    bool WriteHistory(const char *filename) const {
+        FILE *file = fopen(filename, "w");
+        if (!file) return false;
+        fprintf(file, "frame,section,depth,ms\n");
+        for (int i = 0; i < (int)_history.size(); ++i) {
+            Section const & s = _history[i];
+            fprintf(file, "%d,%s,%d,%.4f\n", s.frame, s.name.c_str(), s.depth, s.time);
+        }
+        fclose(file);
+        return true;
+    }
+
+protected:
+    // issued by BeginFrame() and EndFrame() for the given query slot
+    virtual void beginFrameQueries(int slot) = 0;
+    virtual void endFrameQueries(int slot) = 0;
+
+    // records a timestamp as the given query of the slot
+    virtual void writeTimestamp(int slot, int query) = 0;
+
+    // returns the given number of timestamps of the slot in milliseconds,
+    // or false if they are not valid (e.g. the GPU clock changed)
+    virtual bool readTimestamps(int slot, int count, double *times) = 0;
+
+private:
+    struct FrameQueries {
+        std::vector<std::string> names;
+        std::vector<int> parents;
+    };
+
+    struct Section {
+        std::string name;
+        int frame;
+        int depth;
+        float time;
+    };
+
+    void resolveFrame(int frameIndex, FrameQueries const & frame) {
+        int numSections = (int)frame.names.size();
+        std::vector<double> times(2*numSections);
+        if (!readTimestamps(frameIndex % kNumFrames, 2*numSections, &times[0])) {
+            return;
+        }
+
+        _results.resize(numSections);
+        for (int i = 0; i < numSections; ++i) {
+            Section & s = _results[i];
+            s.name = frame.names[i];
+            s.frame = frameIndex;
+            s.depth = (frame.parents[i] < 0) ? 0 : _results[frame.parents[i]].depth + 1;
+            s.time = (float)(times[2*i+1] - times[2*i]);
+        }
+
+        // keep the sections of the last _maxHistory frames
+        int numExpired = 0;
+        while (numExpired < (int)_history.size() &&
+               _history[numExpired].frame <= frameIndex - _maxHistory) {
+            ++numExpired;
+        }
+        _history.erase(_history.begin(), _history.begin() + numExpired);
+        _history.insert(_history.end(), _results.begin(), _results.end());
+    }
+
+    FrameQueries _frames[kNumFrames];
+    std::vector<int> _openSections;
+    std::vector<Section> _results;
+    std::vector<Section> _history;
+    int _frame;
+    bool _inFrame;
+    int _maxHistory;
+};
+
+#endif  // OPENSUBDIV_EXAMPLES_GPU_TIMER_H
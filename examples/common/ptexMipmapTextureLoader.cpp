@@ -191,7 +191,28 @@ PtexMipmapTextureLoader::Block::Generate(PtexMipmapTextureLoader *loader,
         --vlog2_;
         ++level;
     }
-    nMipmaps = level;
+    assert(level == nMipmaps);
+}
+
+// the number of mipmap levels packed by Generate()
+int
+PtexMipmapTextureLoader::Block::CountMipmaps(PtexTexture *ptex,
+                                             int maxLevels) const
+{
+    int ulog2_ = this->ulog2;
+    int vlog2_ = this->vlog2;
+
+    int limit = ptex->getFaceInfo(index).isSubface() ? 1 : 2;
+    limit = std::min(std::min(limit, ulog2_), vlog2_);
+
+    int level = 0;
+    while (ulog2_ >= limit && vlog2_ >= limit
+           && (maxLevels == -1 || level <= maxLevels)) {
+        --ulog2_;
+        --vlog2_;
+        ++level;
+    }
+    return level;
 }
 
 void
@@ -287,15 +308,6 @@ struct PtexMipmapTextureLoader::Page
         return false;
     }
 
-    void Generate(PtexMipmapTextureLoader *loader, PtexTexture *ptex,
-                  unsigned char *destination,
-                  int bpp, int width, int maxLevels) {
-        for (BlockList::iterator it = _blocks.begin();
-             it != _blocks.end(); ++it) {
-            (*it)->Generate(loader, ptex, destination, bpp, width, maxLevels);
-        }
-    }
-
     const BlockList &GetBlocks() const {
         return _blocks;
     }
@@ -447,9 +459,12 @@ PtexMipmapTextureLoader::PtexMipmapTextureLoader(PtexTexture *ptex,
                                                        int maxLevels,
                                                        size_t targetMemory,
                                                        bool seamlessMipmap,
-                                                       bool padAlpha) :
+                                                       bool padAlpha,
+                                                       int maxResidentPages) :
     _ptex(ptex), _maxLevels(maxLevels), _bpp(0),
     _pageWidth(0), _pageHeight(0),
+    _padAlpha(padAlpha), _texelBpp(0), _maxResidentPages(0),
+    _firstResidentPage(0), _numResidentPages(0),
     _texelBuffer(NULL), _layoutBuffer(NULL), _memoryUsage(0)
 {
     // bytes per pixel
@@ -473,10 +488,26 @@ PtexMipmapTextureLoader::PtexMipmapTextureLoader(PtexTexture *ptex,
     }
 
     optimizePacking(maxNumPages, targetMemory);
-    generateBuffers();
-    
-    if (padAlpha) {
-        addAlphaChannel();
+
+    for (int i = 0; i < numFaces; ++i) {
+        _blocks[i].nMipmaps = _blocks[i].CountMipmaps(ptex, _maxLevels);
+    }
+    generateLayoutBuffer();
+
+    // the texel buffer holds the resident pages, padded with an alpha
+    // channel if requested
+    int numPages = (int)_pages.size();
+    _maxResidentPages = (maxResidentPages > 0)
+                      ? std::min(maxResidentPages, numPages) : numPages;
+
+    _texelBpp = _bpp + (padAlpha ? Ptex::DataSize(ptex->dataType()) : 0);
+
+    size_t pageStride = (size_t)_texelBpp * _pageWidth * _pageHeight;
+    _texelBuffer = new unsigned char[pageStride * _maxResidentPages];
+    _memoryUsage += pageStride * numPages;
+
+    if (maxResidentPages <= 0) {
+        GeneratePages(0);
     }
 }
 
@@ -485,34 +516,74 @@ PtexMipmapTextureLoader::~PtexMipmapTextureLoader()
     for (size_t i = 0; i < _pages.size(); ++i) {
         delete _pages[i];
     }
-    delete _texelBuffer;
-    delete _layoutBuffer;
+    delete [] _texelBuffer;
+    delete [] _layoutBuffer;
+}
+
+int
+PtexMipmapTextureLoader::GeneratePages(int firstPage)
+{
+    int numPages = std::min(_maxResidentPages,
+                            (int)_pages.size() - firstPage);
+    if (numPages <= 0) return 0;
+
+    // blocks are packed into a scratch buffer first when an alpha channel
+    // is padded
+    size_t numTexels = (size_t)_pageWidth * _pageHeight * numPages;
+    int pageStride = _bpp * _pageWidth * _pageHeight;
+
+    unsigned char *texels = _padAlpha
+                          ? new unsigned char[_bpp * numTexels]
+                          : _texelBuffer;
+    memset(texels, 0, _bpp * numTexels);
+
+    // the blocks of all pages, packed in parallel into disjoint areas
+    std::vector<Block *> blocks;
+    std::vector<int> blockPages;
+    for (int i = 0; i < numPages; ++i) {
+        Page *page = _pages[firstPage + i];
+        for (Page::BlockList::const_iterator it = page->GetBlocks().begin();
+             it != page->GetBlocks().end(); ++it) {
+            blocks.push_back(*it);
+            blockPages.push_back(i);
+        }
+    }
+    int numBlocks = (int)blocks.size();
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (int i = 0; i < numBlocks; ++i) {
+        blocks[i]->Generate(this, _ptex, texels + pageStride * blockPages[i],
+                            _bpp, _pageWidth, _maxLevels);
+    }
+
+    if (_padAlpha) {
+        addAlphaChannel(texels, _texelBuffer, numTexels);
+        delete [] texels;
+    }
+
+    _firstResidentPage = firstPage;
+    _numResidentPages = numPages;
+    return numPages;
 }
 
-// add alpha channel to texelbuffer :
-//   assumes the texel buffer has been generated and apply a raw copy
-//   into a larger buffer with an alpha channel padded in
+// add alpha channel to texels :
+//   apply a raw copy of packed texels into a larger buffer with an alpha
+//   channel padded in
 // note : this is not a particularly elegant solution...
 void
-PtexMipmapTextureLoader::addAlphaChannel() {
+PtexMipmapTextureLoader::addAlphaChannel(unsigned char const *src,
+                                         unsigned char *dest,
+                                         size_t numTexels) {
 
     assert(_ptex);
 
-    // allocate new larger texel buffer
-    int bpc = Ptex::DataSize(_ptex->dataType()),
-        srcStride = _ptex->numChannels() * bpc,
-        dstStride = srcStride + bpc;
-
-    size_t numTexels = _pageWidth * _pageHeight * _pages.size(),
-           memoryUsed = dstStride * numTexels;
-
-    unsigned char * texBuffer = new unsigned char[memoryUsed];
+    int srcStride = _bpp,
+        dstStride = _texelBpp;
 
     // loop over every texel & copy + pad
-    unsigned char const * src = _texelBuffer;
-    unsigned char * dest = texBuffer;
-
-    for (int i=0; i<(int)numTexels; ++i, src+=srcStride, dest+=dstStride) {
+    for (size_t i=0; i<numTexels; ++i, src+=srcStride, dest+=dstStride) {
         memcpy(dest, src, srcStride);
 
         /// set alpha to 1
@@ -523,12 +594,6 @@ PtexMipmapTextureLoader::addAlphaChannel() {
             case Ptex::dt_float  : *(float *)(dest+srcStride) = 1.0f; break;
         }
     }
-
-    // remove old buffer & adjust class members
-    delete [] _texelBuffer;
-    _texelBuffer = texBuffer;
-    _memoryUsage = memoryUsed;
-    _bpp = dstStride;
 }
 
 // resample border texels for guttering
@@ -972,7 +1037,7 @@ PtexMipmapTextureLoader::optimizePacking(int maxNumPages,
 }
 
 void
-PtexMipmapTextureLoader::generateBuffers()
+PtexMipmapTextureLoader::generateLayoutBuffer()
 {
     // ptex layout struct
     // struct Layout {
@@ -988,21 +1053,9 @@ PtexMipmapTextureLoader::generateBuffers()
     int numFaces = (int)_blocks.size();
     int numPages = (int)_pages.size();
 
-    // populate the texels
-    int pageStride = _bpp * _pageWidth * _pageHeight;
-
-    _texelBuffer = new unsigned char[pageStride * numPages];
-    _memoryUsage = pageStride * numPages;
-    memset(_texelBuffer, 0, pageStride * numPages);
-
-    for (int i = 0; i < numPages; ++i) {
-        _pages[i]->Generate(this, _ptex, _texelBuffer + pageStride * i,
-                            _bpp, _pageWidth, _maxLevels);
-    }
-
     // populate the layout texture buffer
     _layoutBuffer = new unsigned char[numFaces * sizeof(uint16_t) * 6];
-    _memoryUsage += numFaces * sizeof(uint16_t) * 6;
+    _memoryUsage = numFaces * sizeof(uint16_t) * 6;
     for (int i = 0; i < numPages; ++i) {
         Page *page = _pages[i];
         for (Page::BlockList::const_iterator it = page->GetBlocks().begin();
@@ -1018,23 +1071,4 @@ PtexMipmapTextureLoader::generateBuffers()
             *p++ = (uint16_t)(((*it)->ulog2 << 8) | (*it)->vlog2);
         }
     }
-
-#if 0
-    // debug
-    FILE *fp = fopen("out.ppm", "w");
-    fprintf(fp, "P3\n");
-    fprintf(fp, "%d %d\n", _pageWidth, _pageHeight * numPages);
-    fprintf(fp, "255\n");
-    unsigned char *p = _texelBuffer;
-    for (int i = 0; i < numPages; ++i) {
-        for (int y = 0; y < _pageHeight; ++y) {
-            for (int x = 0; x < _pageWidth; ++x) {
-                fprintf(fp, "%d %d %d ", (int)p[0], (int)p[1], (int)p[2]);
-                p += _bpp;
-            }
-            fprintf(fp, "\n");
-        }
-    }
-    fclose(fp);
-#endif
 }
@@ -33,21 +33,39 @@
 
 class PtexMipmapTextureLoader {
 public:
+    // The texels of all pages are packed by the constructor unless
+    // maxResidentPages is positive : the pages are then packed on demand by
+    // GeneratePages(), at most maxResidentPages at a time, so that they can
+    // be uploaded progressively with a bounded texel buffer.
     PtexMipmapTextureLoader(PtexTexture *ptex,
                                int maxNumPages,
                                int maxLevels = -1,
                                size_t targetMemory = 0,
                                bool seamlessMipmap = true,
-                               bool padAlpha = false);
+                               bool padAlpha = false,
+                               int maxResidentPages = 0);
 
     ~PtexMipmapTextureLoader();
 
+    // Packs the texels of the pages following firstPage into the texel
+    // buffer (replacing the resident pages) and returns the number of pages
+    // packed. The blocks of the pages are packed concurrently when OpenMP
+    // is available, which relies on the thread safety of Ptex readers.
+    int GeneratePages(int firstPage);
+
     const unsigned char * GetLayoutBuffer() const {
         return _layoutBuffer;
     }
+    // Texels of the resident pages
     const unsigned char * GetTexelBuffer() const {
         return _texelBuffer;
     }
+    int GetFirstResidentPage() const {
+        return _firstResidentPage;
+    }
+    int GetNumResidentPages() const {
+        return _numResidentPages;
+    }
     int GetNumFaces() const {
         return (int)_blocks.size();
     }
@@ -110,6 +128,8 @@ private:
 
         void SetSize(unsigned char ulog2_, unsigned char vlog2_, bool mipmap);
 
+        int CountMipmaps(PtexTexture *ptex, int maxLevels) const;
+
         int GetNumTexels() const {
             return width*height;
         }
@@ -127,7 +147,7 @@ private:
     struct Page;
     class CornerIterator;
 
-    void generateBuffers();
+    void generateLayoutBuffer();
     void optimizePacking(int maxNumPages, size_t targetMemory);
     int  getLevelDiff(int face, int edge);
     bool getCornerPixel(float *resultPixel, int numchannels,
@@ -137,7 +157,8 @@ private:
     int  resampleBorder(int face, int edgeId, unsigned char *result,
                         int dstLength, int bpp,
                         float srcStart = 0.0f, float srcEnd = 1.0f);
-    void addAlphaChannel();
+    void addAlphaChannel(unsigned char const *src, unsigned char *dst,
+                         size_t numTexels);
 
     std::vector<Block> _blocks;
     std::vector<Page *> _pages;
@@ -147,6 +168,12 @@ private:
     int _bpp;
     int _pageWidth, _pageHeight;
 
+    bool _padAlpha;
+    int _texelBpp;          // bytes per texel of the texel buffer
+    int _maxResidentPages;
+    int _firstResidentPage;
+    int _numResidentPages;
+
     unsigned char *_texelBuffer;
     unsigned char *_layoutBuffer;
 
@@ -25,6 +25,7 @@
 #ifndef OPENSUBDIV_EXAMPLES_SHADER_CACHE_H
 #define OPENSUBDIV_EXAMPLES_SHADER_CACHE_H
 
+#include <deque>
 #include <map>
 
 template <typename DESC_TYPE, typename CONFIG_TYPE>
@@ -44,6 +45,7 @@ public:
             delete it->second;
         }
         _configMap.clear();
+        _warmUpQueue.clear();
     }
 
     // fetch shader config
@@ -60,10 +62,32 @@ public:
         }
     }
 
+    // queue a shader config to be created ahead of its first use
+    void WarmUp(DescType const & desc) {
+        if (_configMap.find(desc) == _configMap.end()) {
+            _warmUpQueue.push_back(desc);
+        }
+    }
+
+    // create up to maxConfigs of the queued shader configs, spreading
+    // their compilation over several frames, returns the number remaining
+    int ProcessWarmUp(int maxConfigs = 1) {
+        while (maxConfigs > 0 && !_warmUpQueue.empty()) {
+            DescType desc = _warmUpQueue.front();
+            _warmUpQueue.pop_front();
+            if (_configMap.find(desc) == _configMap.end()) {
+                GetDrawConfig(desc);
+                --maxConfigs;
+            }
+        }
+        return (int)_warmUpQueue.size();
+    }
+
     virtual ConfigType *CreateDrawConfig(DescType const &desc) = 0;
 
 private:
     ConfigMap _configMap;
+    std::deque<DescType> _warmUpQueue;
 };
 
 
@@ -74,6 +74,7 @@
 #include "../common/stb_image_write.h"    // common.obj has an implementation.
 #include "../common/glShaderCache.h"
 #include "../common/glUtils.h"
+#include "../common/stopwatch.h"
 #include "init_shapes.h"
 
 using namespace OpenSubdiv;
@@ -291,11 +292,148 @@ createOsdMesh(std::string const &kernel,
     exit(1);
 }
 
+// ---------------------------------------------------------------------------
+
+static const int kNumPatchTypes = Far::PatchDescriptor::GREGORY_TRIANGLE + 1;
+
+static const char *g_patchTypeNames[kNumPatchTypes] = {
+    "NON_PATCH", "POINTS", "LINES", "QUADS", "TRIANGLES", "LOOP",
+    "REGULAR", "GREGORY", "GREGORY_BOUNDARY", "GREGORY_BASIS",
+    "GREGORY_TRIANGLE"
+};
+
+// timings of a shape averaged over several runs (in ms) : CPU and GPU
+// (GL timer query) time of the refinement, and GPU time of the draw calls
+// of each patch type
+struct PerfTimings {
+    PerfTimings() : numRuns(0), refineCpuTime(0), refineGpuTime(0),
+                    drawCpuTime(0), drawGpuTime(0) {
+        for (int i = 0; i < kNumPatchTypes; ++i) {
+            numPatches[i] = 0;
+            patchGpuTime[i] = 0;
+        }
+    }
+
+    int numRuns;
+    double refineCpuTime;
+    double refineGpuTime;
+    double drawCpuTime;
+    double drawGpuTime;
+
+    int numPatches[kNumPatchTypes];
+    double patchGpuTime[kNumPatchTypes];
+};
+
+static double
+getQueryTime(GLuint query) {
+    GLuint64 timeElapsed = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &timeElapsed);
+    return timeElapsed * 1e-6;
+}
+
+static void drawPatches(Osd::GLMeshInterface *mesh,
+                        ShaderCache *shaderCache,
+                        PerfTimings *perf) {
+
+    Osd::PatchArrayVector const & patches =
+        mesh->GetPatchTable()->GetPatchArrays();
+
+    // one timer query per draw call when capturing timings
+    std::vector<GLuint> queries;
+    if (perf) {
+        queries.resize(patches.size() + 1);
+        glGenQueries((GLsizei)queries.size(), &queries[0]);
+    }
+
+    Stopwatch s;
+    s.Start();
+
+    for (int i=0; i<(int)patches.size(); ++i) {
+        Osd::PatchArray const & patch = patches[i];
+        Far::PatchDescriptor desc = patch.GetDescriptor();
+        Far::PatchDescriptor::Type patchType = desc.GetType();
+
+        GLenum primType;
+        switch(patchType) {
+        case Far::PatchDescriptor::QUADS:
+            primType = GL_LINES_ADJACENCY;
+            break;
+        case Far::PatchDescriptor::TRIANGLES:
+            primType = GL_TRIANGLES;
+            break;
+        default:
+            primType = GL_PATCHES;
+            glPatchParameteri(GL_PATCH_VERTICES, desc.GetNumControlVertices());
+        }
+
+        GLuint program = shaderCache->GetDrawConfig(desc)->GetProgram();
+        glUseProgram(program);
+
+        GLuint diffuseColor =
+            glGetUniformLocation(program, "diffuseColor");
+        GLuint uniformPrimitiveIdBase =
+            glGetUniformLocation(program, "PrimitiveIdBase");
+
+        if (primType == GL_PATCHES) {
+            float const * color = getAdaptivePatchColor( desc );
+            glProgramUniform4f(program, diffuseColor,
+                               color[0], color[1], color[2], color[3]);
+            glProgramUniform1i(program, uniformPrimitiveIdBase,
+                               patch.GetPrimitiveIdBase());
+        } else {
+            glProgramUniform4f(program, diffuseColor, 0.4f, 0.4f, 0.8f, 1);
+        }
+
+        if (perf) glBeginQuery(GL_TIME_ELAPSED, queries[i]);
+
+        glDrawElements(primType,
+                       patch.GetNumPatches() * desc.GetNumControlVertices(),
+                       GL_UNSIGNED_INT,
+                       (void *)(patch.GetIndexBase() * sizeof(unsigned int)));
+
+        if (perf) glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    if (perf) {
+        // wait for the draw calls to complete for the CPU time
+        glFinish();
+        s.Stop();
+
+        // accumulate the running averages of each patch type
+        int run = perf->numRuns;
+        double drawGpuTime = 0;
+        double patchGpuTime[kNumPatchTypes];
+        for (int t = 0; t < kNumPatchTypes; ++t) {
+            patchGpuTime[t] = 0;
+            perf->numPatches[t] = 0;
+        }
+        for (int i=0; i<(int)patches.size(); ++i) {
+            int t = patches[i].GetDescriptor().GetType();
+            double time = getQueryTime(queries[i]);
+            patchGpuTime[t] += time;
+            drawGpuTime += time;
+            perf->numPatches[t] += patches[i].GetNumPatches();
+        }
+        for (int t = 0; t < kNumPatchTypes; ++t) {
+            perf->patchGpuTime[t] += (patchGpuTime[t] - perf->patchGpuTime[t])
+                                   / (run + 1);
+        }
+        perf->drawGpuTime += (drawGpuTime - perf->drawGpuTime) / (run + 1);
+        perf->drawCpuTime += (s.GetElapsed() * 1000.0 - perf->drawCpuTime)
+                           / (run + 1);
+
+        glDeleteQueries((GLsizei)queries.size(), &queries[0]);
+    }
+}
+
 void runTest(ShapeDesc const &shapeDesc, std::string const &kernel,
              int level, bool adaptive,
-             ShaderCache *shaderCache) {
+             ShaderCache *shaderCache,
+             int numPerfRuns = 0, PerfTimings *perf = NULL) {
 
-    std::cout << "Testing " << shapeDesc.name << ", kernel = " << kernel << "\n";
+    if (!perf) {
+        std::cout << "Testing " << shapeDesc.name << ", kernel = " << kernel << "\n";
+    }
 
     Shape const * shape = Shape::parseObj(shapeDesc);
 
@@ -369,6 +507,35 @@ void runTest(ShapeDesc const &shapeDesc, std::string const &kernel,
     // refine
     mesh->Refine();
 
+    // refine again for the requested runs, timing each after a first run
+    // that warmed up the kernels
+    if (perf) {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        for (int run = 0; run < numPerfRuns; ++run) {
+            mesh->Synchronize();
+            glFinish();
+
+            Stopwatch s;
+            s.Start();
+            glBeginQuery(GL_TIME_ELAPSED, query);
+
+            mesh->UpdateVertexBuffer(&vertex[0], 0, nverts);
+            mesh->Refine();
+            mesh->Synchronize();
+
+            glEndQuery(GL_TIME_ELAPSED);
+            glFinish();
+            s.Stop();
+
+            perf->refineCpuTime +=
+                (s.GetElapsed() * 1000.0 - perf->refineCpuTime) / (run + 1);
+            perf->refineGpuTime +=
+                (getQueryTime(query) - perf->refineGpuTime) / (run + 1);
+        }
+        glDeleteQueries(1, &query);
+    }
+
     // draw
     glClearColor(0.1f, 0.1f, 0.1f, 1.0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -396,49 +563,16 @@ void runTest(ShapeDesc const &shapeDesc, std::string const &kernel,
                       mesh->GetPatchTable()->GetPatchParamTextureBuffer());
     }
 
-    Osd::PatchArrayVector const & patches =
-        mesh->GetPatchTable()->GetPatchArrays();
-
-    for (int i=0; i<(int)patches.size(); ++i) {
-        Osd::PatchArray const & patch = patches[i];
-        Far::PatchDescriptor desc = patch.GetDescriptor();
-        Far::PatchDescriptor::Type patchType = desc.GetType();
-
-        GLenum primType;
-        switch(patchType) {
-        case Far::PatchDescriptor::QUADS:
-            primType = GL_LINES_ADJACENCY;
-            break;
-        case Far::PatchDescriptor::TRIANGLES:
-            primType = GL_TRIANGLES;
-            break;
-        default:
-            primType = GL_PATCHES;
-            glPatchParameteri(GL_PATCH_VERTICES, desc.GetNumControlVertices());
-        }
-
-        GLuint program = shaderCache->GetDrawConfig(desc)->GetProgram();
-        glUseProgram(program);
-
-        GLuint diffuseColor =
-            glGetUniformLocation(program, "diffuseColor");
-        GLuint uniformPrimitiveIdBase =
-            glGetUniformLocation(program, "PrimitiveIdBase");
+    drawPatches(mesh, shaderCache, NULL);
 
-        if (primType == GL_PATCHES) {
-            float const * color = getAdaptivePatchColor( desc );
-            glProgramUniform4f(program, diffuseColor,
-                               color[0], color[1], color[2], color[3]);
-            glProgramUniform1i(program, uniformPrimitiveIdBase,
-                               patch.GetPrimitiveIdBase());
-        } else {
-            glProgramUniform4f(program, diffuseColor, 0.4f, 0.4f, 0.8f, 1);
+    // redraw for the requested runs, timing the draw calls after a first
+    // draw that compiled the shaders
+    if (perf) {
+        for (int run = 0; run < numPerfRuns; ++run) {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawPatches(mesh, shaderCache, perf);
+            perf->numRuns = run + 1;
         }
-
-        glDrawElements(primType,
-                       patch.GetNumPatches() * desc.GetNumControlVertices(),
-                       GL_UNSIGNED_INT,
-                       (void *)(patch.GetIndexBase() * sizeof(unsigned int)));
     }
 
     glDisableVertexAttribArray(0);
@@ -454,28 +588,61 @@ void runTest(ShapeDesc const &shapeDesc, std::string const &kernel,
     // mesh takes an ownership of topologyRefiner. no need to delete it.
 }
 
+static void writePerfHeader(std::ostream &os) {
+    os << "kernel,shape,isolationLevel,tessLevel,stage,patchType,"
+       << "numPatches,cpuTime,gpuTime\n";
+}
+
+static void writePerfTimings(std::ostream &os, std::string const &kernel,
+                             std::string const &shape, int isolationLevel,
+                             int tessLevel, PerfTimings const &perf) {
+    std::stringstream prefix;
+    prefix << kernel << "," << shape << ","
+           << isolationLevel << "," << tessLevel << ",";
+
+    int numPatches = 0;
+    for (int t = 0; t < kNumPatchTypes; ++t) {
+        numPatches += perf.numPatches[t];
+    }
+    os << prefix.str() << "refine,ALL," << numPatches << ","
+       << perf.refineCpuTime << "," << perf.refineGpuTime << "\n";
+    for (int t = 0; t < kNumPatchTypes; ++t) {
+        if (perf.numPatches[t] == 0) continue;
+        os << prefix.str() << "draw," << g_patchTypeNames[t] << ","
+           << perf.numPatches[t] << ",," << perf.patchGpuTime[t] << "\n";
+    }
+    os << prefix.str() << "draw,ALL," << numPatches << ","
+       << perf.drawCpuTime << "," << perf.drawGpuTime << "\n";
+}
+
 static void usage(const char *program) {
     std::cout
         << "Usage: " << program << "\n"
         << "   -a                      : adaptive refinement (default)\n"
         << "   -u                      : uniform refinement\n"
         << "   -l <isolation level>    : isolation level (default = 2)\n"
-        << "   -t <tess level>         : tessellation level (default = 1)\n"
+        << "   -t <tess level>,...     : tessellation levels (default = 1),\n"
+        << "                             all captured, the first imaged\n"
         << "   -w <prefix>             : write images to PNG as\n"
         << "                             <prefix>_<kernel>_modelname.png\n"
         << "   -s <width> <height>     : image size (default = 128 128)\n"
         << "   -k <kernel>,<kernel>... : kernel types (default = all)\n"
         << "      kernel = [CPU, OPENMP, TBB, CUDA, CL, XFB, GLSL]\n"
         << "   -d <displayMode>        : display mode\n"
-        << "      displayMode = [PATCH_TYPE, VARYING, NORMAL]\n";
+        << "      displayMode = [PATCH_TYPE, VARYING, NORMAL]\n"
+        << "   -p <file.csv>           : capture the CPU and GPU times (ms) of\n"
+        << "                             refinement and drawing by patch type\n"
+        << "   -r <runs>               : timed runs averaged (default = 10)\n";
 }
 
 int main(int argc, char ** argv) {
 
     int width = 128;
     int height = 128;
-    int tessLevel = 1;
+    std::vector<int> tessLevels;
     int isolationLevel = 2;
+    int numPerfRuns = 10;
+    std::string perfFile;
     bool writeToFile = false;
     bool adaptive = true;
     std::string prefix;
@@ -499,7 +666,15 @@ int main(int argc, char ** argv) {
                 kernels.push_back(kernel);
             }
         } else if (!strcmp(argvRem[i], "-t")) {
-            tessLevel = atoi(argvRem[++i]);
+            std::stringstream ss(argvRem[++i]);
+            std::string level;
+            while(std::getline(ss, level, ',')) {
+                tessLevels.push_back(atoi(level.c_str()));
+            }
+        } else if (!strcmp(argvRem[i], "-p")) {
+            perfFile = argvRem[++i];
+        } else if (!strcmp(argvRem[i], "-r")) {
+            numPerfRuns = std::max(1, atoi(argvRem[++i]));
         } else if (!strcmp(argvRem[i], "-w")) {
             writeToFile = true;
             prefix = argvRem[++i];
@@ -515,6 +690,11 @@ int main(int argc, char ** argv) {
         }
     }
 
+    if (tessLevels.empty()) {
+        tessLevels.push_back(1);
+    }
+    int tessLevel = tessLevels[0];
+
     if (! glfwInit()) {
         std::cout << "Failed to initialize GLFW\n";
         return 1;
@@ -659,6 +839,12 @@ int main(int argc, char ** argv) {
         ofs.close();
     }
 
+    std::ofstream perfStream;
+    if (!perfFile.empty()) {
+        perfStream.open(perfFile.c_str());
+        writePerfHeader(perfStream);
+    }
+
     // run test
     for (size_t k = 0; k < kernels.size(); ++k) {
         std::string const &kernel = kernels[k];
@@ -700,6 +886,28 @@ int main(int argc, char ** argv) {
             }
 
             glfwSwapBuffers(window);
+
+            // capture the timings at each tessellation level
+            if (!perfFile.empty()) {
+                for (size_t t = 0; t < tessLevels.size(); ++t) {
+                    transformData.TessLevel =
+                        static_cast<float>(1 << tessLevels[t]);
+                    glBindBuffer(GL_UNIFORM_BUFFER, transformUB);
+                    glBufferSubData(GL_UNIFORM_BUFFER, 0,
+                                    sizeof(transformData), &transformData);
+
+                    PerfTimings perf;
+                    runTest(g_defaultShapes[i], kernel, isolationLevel,
+                            adaptive, &shaderCache, numPerfRuns, &perf);
+                    writePerfTimings(perfStream, kernel,
+                                     g_defaultShapes[i].name,
+                                     isolationLevel, tessLevels[t], perf);
+                }
+                transformData.TessLevel = static_cast<float>(1 << tessLevel);
+                glBindBuffer(GL_UNIFORM_BUFFER, transformUB);
+                glBufferSubData(GL_UNIFORM_BUFFER, 0,
+                                sizeof(transformData), &transformData);
+            }
         }
     }
 
@@ -78,6 +78,7 @@ bool g_legacyGregoryEnabled = false;
 #include "../common/glHud.h"
 #include "../common/glUtils.h"
 #include "../common/glControlMeshDisplay.h"
+#include "../common/glGpuTimer.h"
 #include "../common/glShaderCache.h"
 #include "../common/glUtils.h"
 #include "../common/objAnim.h"
@@ -85,6 +86,7 @@ bool g_legacyGregoryEnabled = false;
 #include "../common/stopwatch.h"
 #include "../common/viewerArgsUtils.h"
 #include <opensubdiv/osd/glslPatchShaderSource.h>
+#include <opensubdiv/osd/glProgramBinaryCache.h>
 
 static const char *shaderSource(){
     static const char *res = NULL;
@@ -148,7 +150,8 @@ enum HudCheckBox { kHUD_CB_DISPLAY_CONTROL_MESH_EDGES,
                    kHUD_CB_ADAPTIVE,
                    kHUD_CB_SMOOTH_CORNER_PATCH,
                    kHUD_CB_SINGLE_CREASE_PATCH,
-                   kHUD_CB_INF_SHARP_PATCH };
+                   kHUD_CB_INF_SHARP_PATCH,
+                   kHUD_CB_DISPLAY_GPU_TIMINGS };
 
 int g_currentShape = 0;
 
@@ -173,7 +176,9 @@ int   g_freeze = 0,
 int   g_screenSpaceTess = 0,
       g_fractionalSpacing = 0,
       g_patchCull = 0,
-      g_displayPatchCounts = 0;
+      g_displayPatchCounts = 0,
+      g_displayGpuTimings = 0,
+      g_warmUpShaders = 0;
 
 float g_rotate[2] = {0, 0},
       g_dolly = 5,
@@ -196,6 +201,7 @@ GLControlMeshDisplay g_controlMeshDisplay;
 float g_cpuTime = 0;
 float g_gpuTime = 0;
 Stopwatch g_fpsTimer;
+GLGpuTimer *g_gpuTimer = NULL;
 
 // geometry
 std::vector<float> g_orgPositions;
@@ -383,6 +389,8 @@ updateGeom() {
     Stopwatch s;
     s.Start();
 
+    g_gpuTimer->Begin("Evaluation");
+
     g_mesh->Refine();
 
     s.Stop();
@@ -391,6 +399,8 @@ updateGeom() {
 
     g_mesh->Synchronize();
 
+    g_gpuTimer->End();
+
     s.Stop();
     g_gpuTime = float(s.GetElapsed() * 1000.0f);
 }
@@ -448,6 +458,7 @@ rebuildMesh() {
 
     delete g_mesh;
     g_mesh = NULL;
+    g_warmUpShaders = 1;
 
     Osd::MeshBitset bits;
     bits.set(Osd::MeshAdaptive,             g_adaptive != 0);
@@ -1028,9 +1039,9 @@ bindTextures() {
     glActiveTexture(GL_TEXTURE0);
 }
 
-static GLenum
-bindProgram(Effect effect,
-            OpenSubdiv::Osd::PatchArray const & patch) {
+static EffectDesc
+getEffectDesc(Effect effect,
+              OpenSubdiv::Osd::PatchArray const & patch) {
     EffectDesc effectDesc(patch.GetDescriptor(), effect);
 
     // only legacy gregory needs maxValence and numElements
@@ -1039,7 +1050,7 @@ bindProgram(Effect effect,
     if (patch.GetDescriptor().GetType() == Descriptor::GREGORY ||
         patch.GetDescriptor().GetType() == Descriptor::GREGORY_BOUNDARY) {
         int maxValence = g_mesh->GetMaxValence();
-        int numElements = (g_shadingMode == kShadingInterleavedVaryingColor ? 7 : 3);
+        int numElements = (effect.shadingMode == kShadingInterleavedVaryingColor ? 7 : 3);
         effectDesc.maxValence = maxValence;
         effectDesc.numElements = numElements;
         effectDesc.effect.singleCreasePatch = 0;
@@ -1047,6 +1058,51 @@ bindProgram(Effect effect,
     if (patch.GetDescriptor().GetType() == Descriptor::GREGORY_BASIS) {
         effectDesc.effect.singleCreasePatch = 0;
     }
+    return effectDesc;
+}
+
+// queue the programs of all display styles and shading modes for the
+// patches of the mesh, so that switching between them does not stall
+static void
+warmUpShaders() {
+    OpenSubdiv::Osd::PatchArrayVector const & patches =
+        g_mesh->GetPatchTable()->GetPatchArrays();
+
+    Effect effect = GetEffect();
+    for (int style = kDisplayStyleWire; style <= kDisplayStyleWireOnShaded; ++style) {
+        for (int mode = kShadingMaterial; mode <= kShadingNormal; ++mode) {
+            effect.displayStyle = style;
+            effect.shadingMode = mode;
+            for (int i = 0; i < (int)patches.size(); ++i) {
+                g_shaderCache.WarmUp(getEffectDesc(effect, patches[i]));
+            }
+        }
+    }
+}
+
+static const char *
+getPatchTypeName(OpenSubdiv::Far::PatchDescriptor::Type type) {
+    typedef OpenSubdiv::Far::PatchDescriptor Descriptor;
+    switch (type) {
+        case Descriptor::POINTS:           return "Points";
+        case Descriptor::LINES:            return "Lines";
+        case Descriptor::QUADS:            return "Quads";
+        case Descriptor::TRIANGLES:        return "Triangles";
+        case Descriptor::LOOP:             return "Loop";
+        case Descriptor::REGULAR:          return "Regular";
+        case Descriptor::GREGORY:          return "Gregory";
+        case Descriptor::GREGORY_BOUNDARY: return "Gregory Boundary";
+        case Descriptor::GREGORY_BASIS:    return "Gregory Basis";
+        case Descriptor::GREGORY_TRIANGLE: return "Gregory Triangle";
+        default:                           return "Unknown";
+    }
+}
+
+static GLenum
+bindProgram(Effect effect,
+            OpenSubdiv::Osd::PatchArray const & patch) {
+    EffectDesc effectDesc = getEffectDesc(effect, patch);
+    typedef OpenSubdiv::Far::PatchDescriptor Descriptor;
 
     // lookup shader cache (compile the shader if needed)
     GLDrawConfig *config = g_shaderCache.GetDrawConfig(effectDesc);
@@ -1181,17 +1237,29 @@ display() {
 
         GLenum primType = bindProgram(GetEffect(), patch);
 
+        // tessellation and shading run within the same draw, so the
+        // GPU time is broken down per patch array
+        g_gpuTimer->Begin(getPatchTypeName(patchType));
 
         glDrawElements(primType,
                        patch.GetNumPatches() * desc.GetNumControlVertices(),
                        GL_UNSIGNED_INT,
                        (void *)(patch.GetIndexBase() * sizeof(unsigned int)));
         ++numDrawCalls;
+
+        g_gpuTimer->End();
     }
 
     s.Stop();
     float drawCpuTime = float(s.GetElapsed() * 1000.0f);
 
+    // compile one of the programs queued for warm-up per frame
+    if (g_warmUpShaders) {
+        warmUpShaders();
+        g_warmUpShaders = 0;
+    }
+    g_shaderCache.ProcessWarmUp(1);
+
     glEndQuery(GL_PRIMITIVES_GENERATED);
 #if defined(GL_VERSION_3_3)
     glEndQuery(GL_TIME_ELAPSED);
@@ -1206,8 +1274,10 @@ display() {
 
     // draw the control mesh
     int stride = g_shadingMode == kShadingInterleavedVaryingColor ? 7 : 3;
+    g_gpuTimer->Begin("Control mesh");
     g_controlMeshDisplay.Draw(vbo, stride*sizeof(float),
                               g_transformData.ModelViewProjectionMatrix);
+    g_gpuTimer->End();
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
@@ -1256,6 +1326,22 @@ display() {
                              patchCount[Descriptor::GREGORY_TRIANGLE]); y+= 20;
         }
 
+        if (g_displayGpuTimings) {
+            // timings resolve a few frames late, sections of the most
+            // recent completed frame are listed bottom-up
+            int numSections = g_gpuTimer->GetNumSections();
+            int x = -220;
+            int y = -40 - 20 * numSections;
+            g_hud.DrawString(x, y, "GPU timings (ms)"); y += 20;
+            for (int i = 0; i < numSections; ++i) {
+                int indent = 2 * g_gpuTimer->GetSectionDepth(i);
+                g_hud.DrawString(x, y, "%*s%-*s: %.3f",
+                                 indent, "", 18 - indent,
+                                 g_gpuTimer->GetSectionName(i),
+                                 g_gpuTimer->GetSectionTime(i)); y += 20;
+            }
+        }
+
         int y = -220;
         g_hud.DrawString(10, y, "Tess level : %d", g_tessLevel); y+= 20;
         g_hud.DrawString(10, y, "Patches    : %d", numTotalPatches); y+= 20;
@@ -1326,6 +1412,9 @@ uninitGL() {
     glDeleteQueries(2, g_queries);
     glDeleteVertexArrays(1, &g_vao);
 
+    delete g_gpuTimer;
+    g_gpuTimer = NULL;
+
     if (g_mesh)
         delete g_mesh;
 
@@ -1376,6 +1465,8 @@ keyboard(GLFWwindow *, int key, int /* scancode */, int event, int /* mods */) {
         case '-':  g_tessLevel = std::max(g_tessLevelMin, g_tessLevel-1); break;
         case GLFW_KEY_ESCAPE: g_hud.SetVisible(!g_hud.IsVisible()); break;
         case 'X': GLUtils::WriteScreenshot(g_width, g_height); break;
+        case 'D': g_gpuTimer->WriteHistory("gpu_timings.csv");
+                  printf("GPU timings written to gpu_timings.csv\n"); break;
     }
 }
 
@@ -1497,6 +1588,9 @@ callbackCheckBox(bool checked, int button) {
     case kHUD_CB_DISPLAY_PATCH_COUNTS:
         g_displayPatchCounts = checked;
         break;
+    case kHUD_CB_DISPLAY_GPU_TIMINGS:
+        g_displayGpuTimings = checked;
+        break;
     }
 }
 
@@ -1638,6 +1732,7 @@ initHUD() {
     }
 
     g_hud.AddCheckBox("Show patch counts", g_displayPatchCounts!=0, -420, -20, callbackCheckBox, kHUD_CB_DISPLAY_PATCH_COUNTS);
+    g_hud.AddCheckBox("Show GPU timings (G)", g_displayGpuTimings!=0, -220, -20, callbackCheckBox, kHUD_CB_DISPLAY_GPU_TIMINGS, 'g');
 
     g_hud.Rebuild(windowWidth, windowHeight, frameBufferWidth, frameBufferHeight);
 }
@@ -1654,6 +1749,8 @@ initGL() {
     glGenQueries(2, g_queries);
 
     glGenVertexArrays(1, &g_vao);
+
+    g_gpuTimer = new GLGpuTimer();
 }
 
 //------------------------------------------------------------------------------
@@ -1701,6 +1798,8 @@ int main(int argc, char ** argv) {
 
         if (!strcmp(rargs[i], "-lg")) {
             g_legacyGregoryEnabled = true;
+        } else if (!strcmp(rargs[i], "-shadercache") && i+1 < rargs.size()) {
+            OpenSubdiv::Osd::SetGLProgramBinaryCacheDirectory(rargs[++i]);
         } else {
             args.PrintUnrecognizedArgWarning(rargs[i]);
         }
@@ -1782,9 +1881,13 @@ int main(int argc, char ** argv) {
     rebuildMesh();
 
     while (g_running) {
+        g_gpuTimer->BeginFrame();
+
         idle();
         display();
 
+        g_gpuTimer->EndFrame();
+
         glfwPollEvents();
         glfwSwapBuffers(g_window);
 
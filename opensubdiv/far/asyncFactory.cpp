@@ -0,0 +1,173 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/asyncFactory.h"
+#include "../far/topologyRefinerFactory.h"
+
+#include <algorithm>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+namespace {
+    inline bool
+    isCancelled(BuildMonitor const * monitor) {
+        return monitor && monitor->IsCancelled();
+    }
+
+    inline void
+    refine(TopologyRefiner & refiner, TopologyRefiner::UniformOptions const & options) {
+        refiner.RefineUniform(options);
+    }
+    inline void
+    refine(TopologyRefiner & refiner, TopologyRefiner::AdaptiveOptions const & options) {
+        refiner.RefineAdaptive(options);
+    }
+
+    template <class REFINE_OPTIONS>
+    TopologyRefiner *
+    createRefiner(TopologyDescriptor const & desc,
+                  AsyncFactory::RefinerOptions const & options,
+                  REFINE_OPTIONS const & refineOptions) {
+
+        //  Skip builds already cancelled while queued:
+        if (isCancelled(refineOptions.monitor)) return 0;
+
+        TopologyRefiner * refiner =
+            TopologyRefinerFactory<TopologyDescriptor>::Create(desc, options);
+        if (!refiner) return 0;
+
+        refine(*refiner, refineOptions);
+
+        //  A cancelled refiner is left unrefined and discarded:
+        if (isCancelled(refineOptions.monitor)) {
+            delete refiner;
+            return 0;
+        }
+        return refiner;
+    }
+}
+
+AsyncFactory::AsyncFactory(int numThreads) : _stopping(false) {
+
+    numThreads = std::max(numThreads, 1);
+
+    _threads.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        _threads.push_back(std::thread(&AsyncFactory::work, this));
+    }
+}
+
+AsyncFactory::~AsyncFactory() {
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _condition.notify_all();
+
+    for (int i = 0; i < (int)_threads.size(); ++i) {
+        _threads[i].join();
+    }
+}
+
+void
+AsyncFactory::enqueue(std::function<void()> const & task) {
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push_back(task);
+    }
+    _condition.notify_one();
+}
+
+void
+AsyncFactory::work() {
+
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock,
+                [this]() { return _stopping || !_tasks.empty(); });
+
+            //  Queued tasks are completed before stopping:
+            if (_tasks.empty()) return;
+
+            task = _tasks.front();
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+std::future<TopologyRefiner *>
+AsyncFactory::CreateRefiner(TopologyDescriptor const & desc,
+                            RefinerOptions const & options,
+                            TopologyRefiner::UniformOptions const & refineOptions) {
+
+    TopologyDescriptor const * descPtr = &desc;
+    return Run([=]() {
+        return createRefiner(*descPtr, options, refineOptions);
+    });
+}
+
+std::future<TopologyRefiner *>
+AsyncFactory::CreateRefiner(TopologyDescriptor const & desc,
+                            RefinerOptions const & options,
+                            TopologyRefiner::AdaptiveOptions const & refineOptions) {
+
+    TopologyDescriptor const * descPtr = &desc;
+    return Run([=]() {
+        return createRefiner(*descPtr, options, refineOptions);
+    });
+}
+
+std::future<PatchTable *>
+AsyncFactory::CreatePatchTable(TopologyRefiner const & refiner,
+                               PatchTableFactory::Options const & options,
+                               ConstIndexArray selectedFaces) {
+
+    TopologyRefiner const * refinerPtr = &refiner;
+    return Run([=]() {
+        return PatchTableFactory::Create(*refinerPtr, options, selectedFaces);
+    });
+}
+
+std::future<StencilTable const *>
+AsyncFactory::CreateStencilTable(TopologyRefiner const & refiner,
+                                 StencilTableFactory::Options const & options) {
+
+    TopologyRefiner const * refinerPtr = &refiner;
+    return Run([=]() {
+        return StencilTableFactory::Create(*refinerPtr, options);
+    });
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,171 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_ASYNC_FACTORY_H
+#define OPENSUBDIV3_FAR_ASYNC_FACTORY_H
+
+#include "../version.h"
+
+#include "../far/buildMonitor.h"
+#include "../far/topologyDescriptor.h"
+#include "../far/topologyRefiner.h"
+#include "../far/patchTableFactory.h"
+#include "../far/stencilTableFactory.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+///
+/// \brief Builds refiners and tables asynchronously on a pool of worker
+///        threads
+///
+/// Each build is queued and returns a std::future of its result, so that
+/// the thread issuing it -- e.g. the UI thread of an interactive application
+/// -- is not blocked.  Builds are cancelled through the BuildMonitor of their
+/// options, which also reports their progress: a cancelled build returns 0,
+/// and a build whose monitor is cancelled before it starts returns 0
+/// without doing any work, so that a stream of edits each cancelling the
+/// build of the previous edit only completes the latest.
+///
+/// The refiners and tables returned are new instances owned by the caller,
+/// as with the factories.  The descriptor, refiner, selected faces and
+/// monitor given to a build are referenced, not copied, and so must remain
+/// valid until its result is ready.
+///
+/// The AsyncFactory requires C++11 (std::thread and std::future) and is
+/// only built and installed when the platform thread library is found and
+/// NO_ASYNC is not set.
+///
+/// \code
+///   Far::BuildMonitor * monitor = new MyProgressMonitor;
+///   refineOptions.monitor = monitor;
+///   patchOptions.monitor = monitor;
+///
+///   std::future<Far::PatchTable *> result = factory.Run([=]() {
+///       Far::TopologyRefiner * refiner =
+///           Far::TopologyRefinerFactory<Far::TopologyDescriptor>::Create(
+///               desc, options);
+///       refiner->RefineAdaptive(refineOptions);
+///       Far::PatchTable * table =
+///           Far::PatchTableFactory::Create(*refiner, patchOptions);
+///       delete refiner;
+///       return table;
+///   });
+///
+///   // on the next edit:
+///   monitor->Cancel();
+/// \endcode
+///
+class AsyncFactory {
+public:
+
+    typedef TopologyRefinerFactory<TopologyDescriptor>::Options RefinerOptions;
+
+    /// \brief Constructor
+    ///
+    /// @param numThreads  The number of worker threads (at least one)
+    ///
+    explicit AsyncFactory(int numThreads = 1);
+
+    /// \brief Destructor -- completes the queued builds before returning
+    ~AsyncFactory();
+
+    /// \brief Returns the number of worker threads
+    int GetNumThreads() const { return (int)_threads.size(); }
+
+    /// \brief Returns a new refiner for the descriptor refined uniformly
+    ///        (or 0 if the topology is invalid or the build cancelled)
+    std::future<TopologyRefiner *> CreateRefiner(
+        TopologyDescriptor const & desc,
+        RefinerOptions const & options,
+        TopologyRefiner::UniformOptions const & refineOptions);
+
+    /// \brief Returns a new refiner for the descriptor refined adaptively
+    ///        (or 0 if the topology is invalid or the build cancelled)
+    std::future<TopologyRefiner *> CreateRefiner(
+        TopologyDescriptor const & desc,
+        RefinerOptions const & options,
+        TopologyRefiner::AdaptiveOptions const & refineOptions);
+
+    /// \brief Returns a new patch table of a refiner (or 0 if cancelled)
+    std::future<PatchTable *> CreatePatchTable(
+        TopologyRefiner const & refiner,
+        PatchTableFactory::Options const & options,
+        ConstIndexArray selectedFaces = ConstIndexArray());
+
+    /// \brief Returns a new stencil table of a refiner (or 0 if cancelled)
+    std::future<StencilTable const *> CreateStencilTable(
+        TopologyRefiner const & refiner,
+        StencilTableFactory::Options const & options);
+
+    /// \brief Queues any function, e.g. to chain the stages of a build
+    template <class FUNCTION>
+    std::future<typename std::result_of<FUNCTION()>::type>
+    Run(FUNCTION function);
+
+private:
+    void enqueue(std::function<void()> const & task);
+    void work();
+
+    std::vector<std::thread>          _threads;
+    std::deque<std::function<void()> > _tasks;
+    std::mutex                        _mutex;
+    std::condition_variable           _condition;
+    bool                              _stopping;
+};
+
+template <class FUNCTION>
+std::future<typename std::result_of<FUNCTION()>::type>
+AsyncFactory::Run(FUNCTION function) {
+
+    typedef typename std::result_of<FUNCTION()>::type Result;
+
+    //  std::function requires a copyable target:
+    std::shared_ptr<std::packaged_task<Result()> > task =
+        std::make_shared<std::packaged_task<Result()> >(function);
+
+    std::future<Result> result = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return result;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_ASYNC_FACTORY_H */
@@ -0,0 +1,540 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/buildEstimator.h"
+#include "../far/buildMonitor.h"
+#include "../far/patchParam.h"
+#include "../far/topologyDescriptor.h"
+#include "../far/topologyRefinerFactory.h"
+#include "../far/trace.h"
+#include "../sdc/crease.h"
+#include "../sdc/types.h"
+#include "../vtr/level.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+namespace {
+
+    //
+    //  Typical sizes observed for the regression shapes, used where the
+    //  exact values would require building the tables (the first of each
+    //  pair for quad schemes, the second for triangular schemes):
+    //
+    //  - the refined vertices and faces (including those of the
+    //    neighborhoods of the sparse refinement) per face refined
+    //  - the memory of the refiner per refined vertex
+    //  - the weights of the factorized stencils of the refined vertices and
+    //    of the stencils of local points, which grow with the valence of
+    //    the irregular vertices
+    //
+    float const REFINED_VERTICES_PER_REFINED_FACE[2] = { 7.0f, 4.0f };
+    float const REFINED_FACES_PER_REFINED_FACE[2]    = { 6.0f, 6.5f };
+
+    size_t const REFINER_BYTES_PER_REFINED_VERTEX[2] = { 240, 330 };
+
+    float const ELEMENTS_PER_REFINED_VERTEX[2]     = { 4.0f, 5.0f };
+    float const ELEMENTS_PER_REFINED_VERTEX_VALENCE = 0.75f;
+    float const ELEMENTS_PER_LOCAL_POINT           = 6.5f;
+    float const ELEMENTS_PER_LOCAL_POINT_VALENCE   = 0.15f;
+    float const FACTORIZED_ELEMENTS_PER_LOCAL_POINT         = 6.0f;
+    float const FACTORIZED_ELEMENTS_PER_LOCAL_POINT_VALENCE = 0.9f;
+
+    //
+    //  Counts accumulated by the dry run:
+    //
+    struct DryRunCounts {
+        DryRunCounts() : regular(0), irregular(0), refinedFaces(0) { }
+
+        int regular;
+        int irregular;
+        int refinedFaces;
+    };
+
+    //
+    //  The features of a face for the dry run -- the depth to which each
+    //  corner is isolated (and whether the patch at that depth is irregular)
+    //  and the depth of each semi-sharp edge (edge i from corner i to i+1):
+    //
+    struct DryRunFace {
+        int  numCorners;
+        int  cornerDepth[4];
+        bool cornerIrregular[4];
+        int  edgeDepth[4];
+    };
+
+    //
+    //  Counts the patches of a face by refining its features -- a child is
+    //  incident one corner of its parent and the midpoints of the adjacent
+    //  edges, which remain sharp (and so are isolated) to one level less
+    //  than the edges.  The middle child of a triangle is incident the
+    //  midpoints of the three edges.  A child only incident one deep corner
+    //  is refined as a chain leaving three regular patches per level:
+    //
+    void
+    countFacePatches(DryRunFace const & face, DryRunCounts & counts) {
+
+        int n = face.numCorners;
+
+        int  maxDepth = 0;
+        int  numDeep = 0;
+        bool hasEdges = false;
+        bool isIrregular = false;
+        for (int i = 0; i < n; ++i) {
+            maxDepth     = std::max(maxDepth, face.cornerDepth[i]);
+            numDeep     += (face.cornerDepth[i] > 0);
+            hasEdges    |= (face.edgeDepth[i] > 0);
+            isIrregular |= face.cornerIrregular[i];
+        }
+
+        if (maxDepth == 0) {
+            if (isIrregular) {
+                ++counts.irregular;
+            } else {
+                ++counts.regular;
+            }
+            return;
+        }
+        if ((numDeep == 1) && !hasEdges && (n == 4)) {
+            for (int i = 0; i < n; ++i) {
+                if (face.cornerDepth[i] == 0) continue;
+
+                int depth = face.cornerDepth[i];
+                counts.regular      += 3 * depth;
+                counts.refinedFaces += depth;
+                if (face.cornerIrregular[i]) {
+                    ++counts.irregular;
+                } else {
+                    ++counts.regular;
+                }
+            }
+            return;
+        }
+        ++counts.refinedFaces;
+
+        for (int i = 0; i < n; ++i) {
+            int iPrev = (i + n - 1) % n;
+
+            DryRunFace child;
+            child.numCorners = n;
+            for (int j = 0; j < n; ++j) {
+                child.cornerDepth[j]     = 0;
+                child.cornerIrregular[j] = false;
+                child.edgeDepth[j]       = 0;
+            }
+            child.cornerDepth[0]     = std::max(face.cornerDepth[i] - 1, 0);
+            child.cornerIrregular[0] = face.cornerIrregular[i];
+            child.cornerDepth[1]     = std::max(face.edgeDepth[i] - 1, 0);
+            child.cornerDepth[n-1]   = std::max(face.edgeDepth[iPrev] - 1, 0);
+            child.edgeDepth[0]       = std::max(face.edgeDepth[i] - 1, 0);
+            child.edgeDepth[n-1]     = std::max(face.edgeDepth[iPrev] - 1, 0);
+
+            countFacePatches(child, counts);
+        }
+        if (n == 3) {
+            DryRunFace middle;
+            middle.numCorners = 3;
+            for (int j = 0; j < 3; ++j) {
+                middle.cornerDepth[j]     = std::max(face.edgeDepth[j] - 1, 0);
+                middle.cornerIrregular[j] = false;
+                middle.edgeDepth[j]       = 0;
+            }
+            countFacePatches(middle, counts);
+        }
+    }
+
+    inline int
+    sharpnessDepth(float sharpness) {
+        return (int) std::ceil(sharpness);
+    }
+} // end namespace
+
+void
+BuildEstimator::ComputeTopologyStats(TopologyRefiner const & refiner,
+                                     TopologyStats & stats) {
+
+    Vtr::internal::Level const & level = refiner.getLevel(0);
+
+    stats = TopologyStats();
+
+    stats.numVertices = level.getNumVertices();
+    stats.numEdges    = level.getNumEdges();
+    stats.numFaces    = level.getNumFaces();
+    stats.maxValence  = level.getMaxValence();
+
+    int regFaceSize = Sdc::SchemeTypeTraits::GetRegularFaceSize(
+        refiner.GetSchemeType());
+
+    for (Index face = 0; face < stats.numFaces; ++face) {
+        if (level.isFaceHole(face)) {
+            ++stats.numHoles;
+        } else if (level.getFaceVertices(face).size() != regFaceSize) {
+            ++stats.numIrregularFaces;
+        }
+    }
+
+    for (Index vert = 0; vert < stats.numVertices; ++vert) {
+        Vtr::internal::Level::VTag vTag = level.getVertexTag(vert);
+
+        stats.numBoundaryVertices      += vTag._boundary;
+        stats.numExtraordinaryVertices += vTag._xordinary;
+        stats.numNonManifoldVertices   += vTag._nonManifold;
+
+        float sharpness = level.getVertexSharpness(vert);
+        if (Sdc::Crease::IsInfinite(sharpness)) {
+            ++stats.numInfSharpVertices;
+        } else if (Sdc::Crease::IsSharp(sharpness)) {
+            ++stats.numSemiSharpVertices;
+            stats.maxSemiSharpness = std::max(stats.maxSemiSharpness, sharpness);
+        }
+    }
+
+    for (Index edge = 0; edge < stats.numEdges; ++edge) {
+        Vtr::internal::Level::ETag eTag = level.getEdgeTag(edge);
+        if (eTag._boundary) continue;
+
+        float sharpness = level.getEdgeSharpness(edge);
+        if (Sdc::Crease::IsInfinite(sharpness)) {
+            ++stats.numInfSharpEdges;
+        } else if (Sdc::Crease::IsSharp(sharpness)) {
+            ++stats.numSemiSharpEdges;
+            stats.maxSemiSharpness = std::max(stats.maxSemiSharpness, sharpness);
+        }
+    }
+
+    int numChannels = level.getNumFVarChannels();
+
+    stats.numFVarSeamEdges.assign(numChannels, 0);
+    for (int channel = 0; channel < numChannels; ++channel) {
+        if (level.doesFVarChannelTopologyMatch(channel)) continue;
+
+        for (Index edge = 0; edge < stats.numEdges; ++edge) {
+            if (!level.doesEdgeFVarTopologyMatch(edge, channel)) {
+                ++stats.numFVarSeamEdges[channel];
+            }
+        }
+    }
+}
+
+bool
+BuildEstimator::EstimateAdaptive(TopologyRefiner const & refiner,
+                                 TopologyRefiner::AdaptiveOptions adaptiveOptions,
+                                 PatchTableFactory::Options patchOptions,
+                                 Estimate & estimate,
+                                 EstimateMode mode) {
+
+    OPENSUBDIV_TRACE_SCOPE("estimate.adaptive");
+
+    estimate = Estimate();
+
+    if (mode == ESTIMATE_REFINE) {
+        TopologyRefiner * trial =
+            TopologyRefinerFactory<TopologyDescriptor>::Create(refiner);
+
+        trial->RefineAdaptive(adaptiveOptions);
+
+        if (adaptiveOptions.monitor && adaptiveOptions.monitor->IsCancelled()) {
+            delete trial;
+            return false;
+        }
+
+        estimate.numRefinedVertices =
+            trial->GetNumVerticesTotal() - trial->GetLevel(0).GetNumVertices();
+        estimate.numRefinedFaces =
+            trial->GetNumFacesTotal() - trial->GetLevel(0).GetNumFaces();
+        estimate.refinerBytes = trial->GetMemoryUsage();
+
+        PatchTableFactory::CountPatches(*trial, estimate.patches, patchOptions);
+
+        delete trial;
+
+        estimateTables(refiner, patchOptions, estimate);
+        return true;
+    }
+
+    //
+    //  The dry run predicts the isolation of the features of each face from
+    //  the depth to which each of its corners and edges is refined:
+    //
+    Vtr::internal::Level const & level = refiner.getLevel(0);
+
+    Sdc::SchemeType scheme = refiner.GetSchemeType();
+
+    int  regFaceSize = Sdc::SchemeTypeTraits::GetRegularFaceSize(scheme);
+    bool isTri       = (regFaceSize == 3);
+    bool isLinear    = (Sdc::SchemeTypeTraits::GetLocalNeighborhoodSize(scheme) == 0);
+
+    int isolation = std::min((int) adaptiveOptions.isolationLevel,
+                             (int) patchOptions.maxIsolationLevel);
+    int secondary = std::min((int) adaptiveOptions.secondaryLevel, isolation);
+
+    int numVertices = level.getNumVertices();
+
+    std::vector<unsigned char> vertDepth(numVertices, 0);
+    std::vector<unsigned char> vertIrregular(numVertices, 0);
+
+    for (Index vert = 0; vert < numVertices && !isLinear; ++vert) {
+        Vtr::internal::Level::VTag vTag = level.getVertexTag(vert);
+
+        int  depth = 0;
+        bool irregular = false;
+        if (vTag._nonManifold) {
+            depth = isolation;
+            irregular = true;
+        } else if (vTag._infSharpEdges || vTag._infSharp) {
+            if (adaptiveOptions.useInfSharpPatch) {
+                if (vTag._infIrregular) {
+                    depth = secondary;
+                    irregular = true;
+                }
+            } else if (vTag._xordinary || (vTag._infSharpEdges && !vTag._boundary)) {
+                depth = isolation;
+                irregular = vTag._xordinary;
+            }
+        } else if (vTag._xordinary) {
+            depth = isolation;
+            irregular = true;
+        }
+
+        if (vTag._semiSharp || vTag._semiSharpEdges) {
+            float sharpness = level.getVertexSharpness(vert);
+            ConstIndexArray vEdges = level.getVertexEdges(vert);
+            for (int i = 0; i < vEdges.size(); ++i) {
+                float edgeSharpness = level.getEdgeSharpness(vEdges[i]);
+                if (!Sdc::Crease::IsInfinite(edgeSharpness)) {
+                    sharpness = std::max(sharpness, edgeSharpness);
+                }
+            }
+            if (!Sdc::Crease::IsInfinite(sharpness)) {
+                depth = std::max(depth,
+                    std::min(sharpnessDepth(sharpness), isolation));
+            }
+        }
+        vertDepth[vert]     = (unsigned char) depth;
+        vertIrregular[vert] = irregular;
+    }
+
+    DryRunCounts counts;
+
+    for (Index face = 0; face < level.getNumFaces(); ++face) {
+        if (level.isFaceHole(face)) continue;
+
+        ConstIndexArray fVerts = level.getFaceVertices(face);
+        int numCorners = fVerts.size();
+
+        if (isLinear) {
+            //  Irregular faces of linear schemes are split once:
+            if (numCorners == regFaceSize) {
+                ++counts.regular;
+            } else {
+                counts.regular += numCorners;
+                ++counts.refinedFaces;
+            }
+            continue;
+        }
+
+        //  Semi-sharp edges not stopped by single-crease patches:
+        int edgeDepth[4] = { 0, 0, 0, 0 };
+        if (!adaptiveOptions.useSingleCreasePatch) {
+            ConstIndexArray fEdges = level.getFaceEdges(face);
+            for (int i = 0; i < fEdges.size() && i < 4; ++i) {
+                float sharpness = level.getEdgeSharpness(fEdges[i]);
+                if (Sdc::Crease::IsSharp(sharpness) &&
+                    !Sdc::Crease::IsInfinite(sharpness)) {
+                    edgeDepth[i] = std::min(sharpnessDepth(sharpness), isolation);
+                }
+            }
+        }
+
+        if (numCorners == regFaceSize) {
+            DryRunFace dryFace;
+            dryFace.numCorners = numCorners;
+            for (int i = 0; i < numCorners; ++i) {
+                dryFace.cornerDepth[i]     = vertDepth[fVerts[i]];
+                dryFace.cornerIrregular[i] = vertIrregular[fVerts[i]] != 0;
+                dryFace.edgeDepth[i]       = edgeDepth[i];
+            }
+            countFacePatches(dryFace, counts);
+        } else {
+            //  Irregular faces are split into quads incident an irregular
+            //  vertex at their center and one corner of the face (ignoring
+            //  the sharpness of their edges):
+            ++counts.refinedFaces;
+            for (int i = 0; i < numCorners; ++i) {
+                DryRunFace child = { 4, { 0, 0, 0, 0 },
+                                     { false, false, false, false },
+                                     { 0, 0, 0, 0 } };
+                child.cornerDepth[0]     = std::max(vertDepth[fVerts[i]] - 1, 0);
+                child.cornerIrregular[0] = vertIrregular[fVerts[i]] != 0;
+                child.cornerDepth[2]     = std::max(isolation - 1, 0);
+                child.cornerIrregular[2] = true;
+
+                countFacePatches(child, counts);
+            }
+        }
+    }
+
+    //
+    //  The types of patches follow the scheme and end-cap type as they do
+    //  in the PatchTableFactory:
+    //
+    PatchTableFactory::PatchCounts & patches = estimate.patches;
+
+    PatchDescriptor::Type linearType =
+        isTri ? PatchDescriptor::TRIANGLES : PatchDescriptor::QUADS;
+    PatchDescriptor::Type regularType = isLinear ? linearType :
+        (isTri ? PatchDescriptor::LOOP : PatchDescriptor::REGULAR);
+
+    PatchDescriptor::Type irregularType = regularType;
+    switch (patchOptions.GetEndCapType()) {
+        case PatchTableFactory::Options::ENDCAP_BILINEAR_BASIS:
+            irregularType = linearType;
+            break;
+        case PatchTableFactory::Options::ENDCAP_LEGACY_GREGORY:
+            irregularType = PatchDescriptor::GREGORY;
+            break;
+        case PatchTableFactory::Options::ENDCAP_BSPLINE_BASIS:
+            break;
+        default:
+            irregularType = isTri ? PatchDescriptor::GREGORY_TRIANGLE
+                                  : PatchDescriptor::GREGORY_BASIS;
+            break;
+    }
+    if (isLinear) irregularType = PatchDescriptor::NON_PATCH;
+
+    patches.regularPatchType    = regularType;
+    patches.irregularPatchType  = irregularType;
+    patches.numRegularPatches   = counts.regular;
+    patches.numIrregularPatches = counts.irregular;
+
+    //  Local points as estimated by the PatchTableFactory:
+    if (!isLinear && (irregularType != PatchDescriptor::GREGORY)) {
+        int numPointsPerPatch = PatchDescriptor::GetNumControlVertices(irregularType);
+        if (irregularType == regularType) {
+            numPointsPerPatch /= 2;
+        }
+        patches.numLocalPoints = counts.irregular * numPointsPerPatch;
+    }
+
+    estimate.numRefinedVertices = (int) ((float) counts.refinedFaces *
+        REFINED_VERTICES_PER_REFINED_FACE[isTri]);
+    estimate.numRefinedFaces = (int) ((float) counts.refinedFaces *
+        REFINED_FACES_PER_REFINED_FACE[isTri]);
+
+    estimate.refinerBytes = refiner.GetMemoryUsage() +
+        (size_t) estimate.numRefinedVertices * REFINER_BYTES_PER_REFINED_VERTEX[isTri];
+
+    estimateTables(refiner, patchOptions, estimate);
+    return true;
+}
+
+void
+BuildEstimator::estimateTables(TopologyRefiner const & refiner,
+                               PatchTableFactory::Options const & patchOptions,
+                               Estimate & estimate) {
+
+    PatchTableFactory::PatchCounts const & patches = estimate.patches;
+
+    Vtr::internal::Level const & level = refiner.getLevel(0);
+
+    int  regFaceSize = Sdc::SchemeTypeTraits::GetRegularFaceSize(
+        refiner.GetSchemeType());
+    bool isTri = (regFaceSize == 3);
+
+    //
+    //  The sizes of stencils grow with the valence of the irregular
+    //  vertices, i.e. the average of the interior extraordinary vertices:
+    //
+    int numIrregular = 0;
+    int sumValence = 0;
+    for (Index vert = 0; vert < level.getNumVertices(); ++vert) {
+        Vtr::internal::Level::VTag vTag = level.getVertexTag(vert);
+        if (vTag._xordinary && !vTag._boundary && !vTag._nonManifold) {
+            sumValence += level.getVertexFaces(vert).size();
+            ++numIrregular;
+        }
+    }
+    float valence = numIrregular ? ((float) sumValence / (float) numIrregular)
+                                 : (float) (isTri ? 6 : 4);
+
+    //
+    //  Stencils of the refined vertices and local points:
+    //
+    estimate.numStencils = estimate.numRefinedVertices + patches.numLocalPoints;
+
+    estimate.numLocalPointStencilElements = (int) ((float) patches.numLocalPoints *
+        (ELEMENTS_PER_LOCAL_POINT + ELEMENTS_PER_LOCAL_POINT_VALENCE * valence));
+
+    estimate.numStencilElements = (int) (
+        (float) estimate.numRefinedVertices * (ELEMENTS_PER_REFINED_VERTEX[isTri] +
+            ELEMENTS_PER_REFINED_VERTEX_VALENCE * valence) +
+        (float) patches.numLocalPoints * (FACTORIZED_ELEMENTS_PER_LOCAL_POINT +
+            FACTORIZED_ELEMENTS_PER_LOCAL_POINT_VALENCE * valence));
+
+    size_t realSize = patchOptions.patchPrecisionDouble
+                    ? sizeof(double) : sizeof(float);
+
+    size_t stencilBytes = sizeof(int) + sizeof(Index);
+    size_t elementBytes = sizeof(Index) + sizeof(float);
+
+    estimate.stencilTableBytes =
+        (size_t) estimate.numStencils * stencilBytes +
+        (size_t) estimate.numStencilElements * elementBytes;
+
+    //
+    //  The patches, their local point stencils and optional tables:
+    //
+    int numPatches = patches.numRegularPatches + patches.numIrregularPatches;
+
+    size_t patchBytes =
+        (size_t) patches.numRegularPatches *
+            PatchDescriptor::GetNumControlVertices(patches.regularPatchType) +
+        (size_t) patches.numIrregularPatches *
+            PatchDescriptor::GetNumControlVertices(patches.irregularPatchType);
+    patchBytes *= sizeof(Index);
+    patchBytes += (size_t) numPatches * sizeof(PatchParam);
+
+    if (patchOptions.useSingleCreasePatch || patchOptions.useDoubleCreasePatch) {
+        patchBytes += (size_t) numPatches * sizeof(Index);
+    }
+    if (patchOptions.generateVaryingTables) {
+        patchBytes += (size_t) numPatches * (isTri ? 3 : 4) * sizeof(Index);
+    }
+
+    patchBytes += (size_t) patches.numLocalPoints * stencilBytes +
+                  (size_t) estimate.numLocalPointStencilElements *
+                      (sizeof(Index) + realSize);
+
+    estimate.patchTableBytes = sizeof(PatchTable) + patchBytes;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,192 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_BUILD_ESTIMATOR_H
+#define OPENSUBDIV3_FAR_BUILD_ESTIMATOR_H
+
+#include "../version.h"
+
+#include "../far/patchTableFactory.h"
+#include "../far/topologyRefiner.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief Inspects the base level of a TopologyRefiner and predicts the cost
+///        of the refinement and tables built from it
+///
+/// The estimates are intended to schedule work (e.g. to assign assets to
+/// machines according to their memory) before committing to a build.  They
+/// are given for an adaptive refinement and a PatchTable created with the
+/// given options, and for the StencilTable of the refined vertices and local
+/// points of the patches, as created by StencilTableFactory::Create() and
+/// StencilTableFactory::AppendLocalPointStencilTable().
+///
+/// An estimate is computed in one of two modes:
+///
+///   - ESTIMATE_REFINE refines a temporary refiner sharing the base level
+///     and counts the patches as PatchTableFactory::CountPatches() does, so
+///     the refined vertices, patches and refiner memory are exact.  Only the
+///     topology of the refinement is allocated, never the tables.
+///
+///   - ESTIMATE_DRY_RUN allocates nothing and only inspects the base level,
+///     predicting the isolation of each irregular feature from its depth and
+///     the corners of the faces it affects.  It is intended for large
+///     batches of assets, where its error (typically within 30% of the
+///     refined estimate) is preferable to refining each asset.
+///
+/// In both modes the stencil elements and the sizes of the stencils of local
+/// points are predicted from their typical sizes and the valence of the
+/// irregular vertices, and are only approximate (typically within 50%).
+///
+class BuildEstimator {
+public:
+
+    /// \brief Statistics of the features of the base level of a refiner
+    struct TopologyStats {
+
+        TopologyStats() : numVertices(0), numEdges(0), numFaces(0),
+                          numHoles(0), numIrregularFaces(0),
+                          numBoundaryVertices(0), numExtraordinaryVertices(0),
+                          numNonManifoldVertices(0),
+                          numSemiSharpVertices(0), numInfSharpVertices(0),
+                          numSemiSharpEdges(0), numInfSharpEdges(0),
+                          maxValence(0), maxSemiSharpness(0.0f) { }
+
+        int numVertices;
+        int numEdges;
+        int numFaces;
+
+        int numHoles;                  ///< faces tagged as holes
+        int numIrregularFaces;         ///< faces not of the regular size of
+                                       ///< the scheme (e.g. non-quads)
+
+        int numBoundaryVertices;
+        int numExtraordinaryVertices;  ///< vertices of irregular valence
+        int numNonManifoldVertices;
+
+        int numSemiSharpVertices;      ///< vertices of finite sharpness
+        int numInfSharpVertices;       ///< infinitely sharp vertices
+        int numSemiSharpEdges;         ///< edges of finite sharpness
+        int numInfSharpEdges;          ///< infinitely sharp interior edges
+
+        int   maxValence;
+        float maxSemiSharpness;        ///< of semi-sharp vertices and edges
+
+        std::vector<int> numFVarSeamEdges; ///< edges of each face-varying
+                                           ///< channel whose values differ
+                                           ///< on either side (seams)
+    };
+
+    /// \brief Computes the statistics of the base level of a refiner
+    ///
+    /// @param refiner  TopologyRefiner whose base level is inspected
+    ///
+    /// @param stats    The statistics of the base level
+    ///
+    static void ComputeTopologyStats(TopologyRefiner const & refiner,
+                                     TopologyStats & stats);
+
+    /// \brief The predicted sizes of a refinement and its tables
+    struct Estimate {
+
+        Estimate() : numRefinedVertices(0), numRefinedFaces(0),
+                     numStencils(0), numStencilElements(0),
+                     numLocalPointStencilElements(0),
+                     refinerBytes(0), patchTableBytes(0),
+                     stencilTableBytes(0) { }
+
+        int numRefinedVertices;            ///< vertices of the refined levels
+        int numRefinedFaces;               ///< faces of the refined levels
+
+        PatchTableFactory::PatchCounts patches;  ///< patches by type and
+                                                 ///< local points
+
+        int numStencils;                   ///< stencils of the refined
+                                           ///< vertices and local points
+        int numStencilElements;            ///< weights of those stencils
+        int numLocalPointStencilElements;  ///< weights of the stencils of
+                                           ///< the local points alone
+
+        size_t refinerBytes;               ///< the refiner and its levels
+        size_t patchTableBytes;            ///< the PatchTable, including the
+                                           ///< stencils of its local points
+        size_t stencilTableBytes;          ///< the StencilTable
+
+        /// \brief Returns the total number of bytes predicted
+        size_t GetTotalBytes() const {
+            return refinerBytes + patchTableBytes + stencilTableBytes;
+        }
+    };
+
+    enum EstimateMode {
+        ESTIMATE_REFINE,   ///< refine the topology and count the patches
+        ESTIMATE_DRY_RUN   ///< predict from the base level without allocating
+    };
+
+    /// \brief Predicts the sizes of an adaptive refinement and its tables
+    ///
+    /// Only the base level of the refiner is considered, so it may already
+    /// have been refined (or not).
+    ///
+    /// @param refiner         TopologyRefiner whose base level is to be
+    ///                        refined
+    ///
+    /// @param adaptiveOptions Options of the adaptive refinement
+    ///
+    /// @param patchOptions    Options of the PatchTable
+    ///
+    /// @param estimate        The predicted sizes
+    ///
+    /// @param mode            Refine the topology or predict from the base
+    ///                        level (see class description)
+    ///
+    /// @return                False if the refinement of a refined estimate
+    ///                        was cancelled by the monitor of the options
+    ///
+    static bool EstimateAdaptive(TopologyRefiner const & refiner,
+                                 TopologyRefiner::AdaptiveOptions adaptiveOptions,
+                                 PatchTableFactory::Options patchOptions,
+                                 Estimate & estimate,
+                                 EstimateMode mode = ESTIMATE_REFINE);
+
+private:
+    static void estimateTables(TopologyRefiner const & refiner,
+                               PatchTableFactory::Options const & patchOptions,
+                               Estimate & estimate);
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_FAR_BUILD_ESTIMATOR_H
@@ -0,0 +1,103 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_BUILD_MONITOR_H
+#define OPENSUBDIV3_FAR_BUILD_MONITOR_H
+
+#include "../version.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+///
+/// \brief Reports the progress of the construction of a refiner or table and
+///        allows it to be cancelled
+///
+/// A monitor is assigned to the options of TopologyRefiner::RefineUniform(),
+/// TopologyRefiner::RefineAdaptive(), PatchTableFactory::Create() or
+/// StencilTableFactory::Create().  These report their progress between
+/// levels or batches of patches, where they also stop if the monitor was
+/// cancelled -- a cancelled refinement leaves the refiner unrefined and a
+/// cancelled factory returns 0.
+///
+/// Cancel() may be called from any thread, e.g. by an interactive
+/// application discarding a stale build (see AsyncFactory), while
+/// OnProgress() is called on the thread doing the build.
+///
+class BuildMonitor {
+public:
+    /// \brief The stages of a build
+    enum Stage {
+        STAGE_REFINE = 0,      ///< Refinement of the topology
+        STAGE_PATCH_TABLE,     ///< Construction of a PatchTable
+        STAGE_STENCIL_TABLE    ///< Construction of a StencilTable
+    };
+
+    BuildMonitor();
+    virtual ~BuildMonitor();
+
+    /// \brief Requests the builds monitored to stop
+    void Cancel();
+
+    /// \brief Returns true if Cancel() was called
+    bool IsCancelled() const;
+
+    /// \brief Reports the progress of a stage, returning false if the build
+    ///        is to stop (used by the factories)
+    ///
+    /// @param stage     The stage being built
+    ///
+    /// @param fraction  The fraction of the stage completed in [0, 1]
+    ///
+    bool Progress(Stage stage, float fraction) {
+        if (IsCancelled()) return false;
+        OnProgress(stage, fraction);
+        return !IsCancelled();
+    }
+
+protected:
+    /// \brief Override to receive the progress of each stage
+    virtual void OnProgress(Stage /* stage */, float /* fraction */) { }
+
+private:
+    //  Not copyable:
+    BuildMonitor(BuildMonitor const &);
+    BuildMonitor & operator=(BuildMonitor const &);
+
+    //  The flag set by Cancel() from any thread (defined privately)
+    struct CancelFlag;
+
+    CancelFlag * _cancelled;
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_BUILD_MONITOR_H */
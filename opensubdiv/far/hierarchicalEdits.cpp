@@ -0,0 +1,257 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../far/hierarchicalEdits.h"
+#include "../far/topologyRefiner.h"
+#include "../sdc/crease.h"
+#include "../vtr/level.h"
+#include "../vtr/refinement.h"
+
+#include <algorithm>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+//
+//  Assembly of edits -- the child faces of all paths are stored in a
+//  single vector and referenced by offset:
+//
+HierarchicalEdits::Edit &
+HierarchicalEdits::addEdit(std::vector<Edit> & edits, Index baseFace,
+        int numChildren, int const childFaces[], int componentInFace) {
+
+    Edit edit;
+    edit.baseFace        = baseFace;
+    edit.level           = numChildren;
+    edit.pathOffset      = (int)_paths.size();
+    edit.componentInFace = componentInFace;
+    edit.isEdge          = false;
+    edit.operation       = OPERATION_SET;
+    edit.sharpness       = 0.0f;
+
+    _paths.insert(_paths.end(), childFaces, childFaces + numChildren);
+
+    edits.push_back(edit);
+    return edits.back();
+}
+
+int
+HierarchicalEdits::AddVertexEdit(Index baseFace, int numChildren,
+        int const childFaces[], int vertexInFace, Operation operation) {
+
+    Edit & edit = addEdit(_vertexEdits, baseFace, numChildren, childFaces,
+                          vertexInFace);
+    edit.operation = operation;
+
+    return (int)_vertexEdits.size() - 1;
+}
+
+int
+HierarchicalEdits::AddEdgeSharpnessEdit(Index baseFace, int numChildren,
+        int const childFaces[], int edgeInFace, float sharpness,
+        Operation operation) {
+
+    Edit & edit = addEdit(_sharpnessEdits, baseFace, numChildren, childFaces,
+                          edgeInFace);
+    edit.isEdge    = true;
+    edit.operation = operation;
+    edit.sharpness = sharpness;
+
+    return (int)_sharpnessEdits.size() - 1;
+}
+
+int
+HierarchicalEdits::AddVertexSharpnessEdit(Index baseFace, int numChildren,
+        int const childFaces[], int vertexInFace, float sharpness,
+        Operation operation) {
+
+    Edit & edit = addEdit(_sharpnessEdits, baseFace, numChildren, childFaces,
+                          vertexInFace);
+    edit.operation = operation;
+    edit.sharpness = sharpness;
+
+    return (int)_sharpnessEdits.size() - 1;
+}
+
+//
+//  Resolution of the face at the end of the path of an edit -- following
+//  the child faces of the refinements present in the refiner:
+//
+Index
+HierarchicalEdits::findFace(TopologyRefiner const & refiner,
+        Edit const & edit) const {
+
+    if ((edit.level > (int)refiner._refinements.size()) || refiner.IsCompact()) {
+        return INDEX_INVALID;
+    }
+
+    Index face = edit.baseFace;
+    if ((face < 0) || (face >= refiner.getLevel(0).getNumFaces())) {
+        return INDEX_INVALID;
+    }
+
+    int const * path = edit.level ? &_paths[edit.pathOffset] : 0;
+    for (int i = 0; i < edit.level; ++i) {
+        ConstIndexArray childFaces = refiner.getRefinement(i).getFaceChildFaces(face);
+        if ((path[i] < 0) || (path[i] >= childFaces.size())) {
+            return INDEX_INVALID;
+        }
+        face = childFaces[path[i]];
+        if (!IndexIsValid(face)) {
+            return INDEX_INVALID;
+        }
+    }
+    return face;
+}
+
+Index
+HierarchicalEdits::FindVertexEditVertex(TopologyRefiner const & refiner,
+        int editIndex) const {
+
+    Edit const & edit = _vertexEdits[editIndex];
+
+    Index face = findFace(refiner, edit);
+    if (!IndexIsValid(face)) {
+        return INDEX_INVALID;
+    }
+
+    ConstIndexArray fVerts = refiner.getLevel(edit.level).getFaceVertices(face);
+    if ((edit.componentInFace < 0) || (edit.componentInFace >= fVerts.size())) {
+        return INDEX_INVALID;
+    }
+    return fVerts[edit.componentInFace];
+}
+
+//
+//  Application of sharpness edits to a refined level -- the sharpness of
+//  edited edges and vertices is assigned before updating the tags of the
+//  edges and of all vertices affected:
+//
+void
+HierarchicalEdits::applySharpnessEdits(TopologyRefiner & refiner,
+        int levelIndex) const {
+
+    if (levelIndex == 0) return;
+
+    Vtr::internal::Level & level = refiner.getLevel(levelIndex);
+
+    std::vector<Index> editedVerts;
+
+    bool hasSemiSharpEdits = false;
+
+    for (int i = 0; i < (int)_sharpnessEdits.size(); ++i) {
+        Edit const & edit = _sharpnessEdits[i];
+        if (edit.level != levelIndex) continue;
+
+        Index face = findFace(refiner, edit);
+        if (!IndexIsValid(face)) continue;
+
+        ConstIndexArray fComps = edit.isEdge ? level.getFaceEdges(face)
+                                             : level.getFaceVertices(face);
+        if ((edit.componentInFace < 0) || (edit.componentInFace >= fComps.size())) {
+            continue;
+        }
+        Index comp = fComps[edit.componentInFace];
+
+        if (edit.isEdge) {
+            Vtr::internal::Level::ETag & eTag = level.getEdgeTag(comp);
+            if (eTag._boundary) continue;
+
+            float & eSharpness = level.getEdgeSharpness(comp);
+            eSharpness = (edit.operation == OPERATION_ADD)
+                       ? (eSharpness + edit.sharpness) : edit.sharpness;
+            eSharpness = std::max(eSharpness, Sdc::Crease::SHARPNESS_SMOOTH);
+
+            eTag._infSharp  = Sdc::Crease::IsInfinite(eSharpness);
+            eTag._semiSharp = Sdc::Crease::IsSharp(eSharpness) && !eTag._infSharp;
+
+            hasSemiSharpEdits |= eTag._semiSharp;
+
+            ConstIndexArray eVerts = level.getEdgeVertices(comp);
+            editedVerts.push_back(eVerts[0]);
+            editedVerts.push_back(eVerts[1]);
+        } else {
+            float & vSharpness = level.getVertexSharpness(comp);
+            vSharpness = (edit.operation == OPERATION_ADD)
+                       ? (vSharpness + edit.sharpness) : edit.sharpness;
+            vSharpness = std::max(vSharpness, Sdc::Crease::SHARPNESS_SMOOTH);
+
+            hasSemiSharpEdits |= Sdc::Crease::IsSemiSharp(vSharpness);
+
+            editedVerts.push_back(comp);
+        }
+    }
+
+    //
+    //  Update the tags of the affected vertices that depend on sharpness --
+    //  the remaining tags are topological and unaffected:
+    //
+    Sdc::Crease creasing(refiner.GetSchemeOptions());
+
+    for (int i = 0; i < (int)editedVerts.size(); ++i) {
+        Index vIndex = editedVerts[i];
+
+        Vtr::internal::Level::VTag & vTag = level.getVertexTag(vIndex);
+
+        float vSharpness = level.getVertexSharpness(vIndex);
+
+        ConstIndexArray vEdges = level.getVertexEdges(vIndex);
+
+        int infSharpEdgeCount  = 0;
+        int semiSharpEdgeCount = 0;
+        for (int j = 0; j < vEdges.size(); ++j) {
+            Vtr::internal::Level::ETag const & eTag = level.getEdgeTag(vEdges[j]);
+
+            infSharpEdgeCount  += eTag._infSharp;
+            semiSharpEdgeCount += eTag._semiSharp;
+        }
+
+        vTag._infSharp       = Sdc::Crease::IsInfinite(vSharpness);
+        vTag._semiSharp      = Sdc::Crease::IsSemiSharp(vSharpness);
+        vTag._semiSharpEdges = (semiSharpEdgeCount > 0);
+        vTag._infSharpEdges  = (infSharpEdgeCount > 0);
+
+        vTag._rule = (Vtr::internal::Level::VTag::VTagSize)
+            creasing.DetermineVertexVertexRule(vSharpness,
+                infSharpEdgeCount + semiSharpEdgeCount);
+    }
+
+    //
+    //  Semi-sharp features introduced in a level without any must be flagged,
+    //  as the subdivision of sharpness of the next level is otherwise reduced
+    //  to that of infinitely sharp features (the flag is conservatively left
+    //  set when edits make the features of a level smooth):
+    //
+    if (hasSemiSharpEdits) {
+        level.setHasSemiSharpFeatures(true);
+    }
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
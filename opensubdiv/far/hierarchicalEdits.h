@@ -0,0 +1,190 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_HIERARCHICAL_EDITS_H
+#define OPENSUBDIV3_FAR_HIERARCHICAL_EDITS_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+class TopologyRefiner;
+
+///
+/// \brief Hierarchical edits of sharpness and vertex data at refined levels
+///
+/// As with Hbr, each edit identifies a component of a refined level by its
+/// path through the hierarchy:  a base face, the index of the child face
+/// chosen at each level of refinement and the index of the vertex or edge
+/// within the resulting face.  Child faces are indexed as in Far, i.e. for
+/// quad and triangle splits the child at corner i of its parent is child i
+/// (and the interior child of a triangle is child 3).  The number of child
+/// indices in the path is the level of the edit.
+///
+/// Sharpness edits are applied during uniform refinement -- see the overload
+/// of TopologyRefiner::RefineUniform() taking HierarchicalEdits -- before the
+/// level of the edit is itself refined.  They have no effect when given for
+/// the last level or on boundary (i.e. infinitely sharp) edges, and sharpness
+/// of the base level should be assigned by the TopologyRefinerFactory.  The
+/// tags of face-varying channels are not updated by sharpness edits.
+///
+/// Vertex edits are applied as additional terms of the stencils created by
+/// StencilTableFactory (vertex interpolation only):  the value of each edit
+/// is an additional control vertex (following those of the base level) that
+/// is added to, or replaces, the interpolated value of its edited vertex and
+/// is so propagated to all subsequent levels.  As with Hbr, edits are applied
+/// once their whole level is interpolated, so the other vertices of the level
+/// (e.g. the edge-vertices adjacent to an edited face-vertex) are unaffected.
+///
+class HierarchicalEdits {
+
+public:
+
+    /// \brief Operations applied by an edit
+    enum Operation {
+        OPERATION_SET,  ///< Replace the current value
+        OPERATION_ADD   ///< Add to the current value
+    };
+
+    /// \brief Constructor
+    HierarchicalEdits() { }
+
+    /// \brief Destructor
+    ~HierarchicalEdits() { }
+
+    //@{
+    ///
+    /// Vertex edits
+    ///
+
+    /// \brief Adds an edit of the data of a refined vertex
+    ///
+    /// @param baseFace      index of the face in the base level
+    ///
+    /// @param numChildren   number of child face indices in the path, i.e.
+    ///                      the level of the edited vertex
+    ///
+    /// @param childFaces    index of the child face at each level
+    ///
+    /// @param vertexInFace  index of the vertex in the face of the path
+    ///
+    /// @param operation     operation applied with the value of the edit
+    ///
+    /// @return              index of the vertex edit
+    ///
+    int AddVertexEdit(Index baseFace, int numChildren, int const childFaces[],
+                      int vertexInFace, Operation operation = OPERATION_ADD);
+
+    /// \brief Returns the number of vertex edits
+    int GetNumVertexEdits() const { return (int)_vertexEdits.size(); }
+
+    /// \brief Returns the level of a vertex edit
+    int GetVertexEditLevel(int edit) const {
+        return _vertexEdits[edit].level;
+    }
+
+    /// \brief Returns the operation of a vertex edit
+    Operation GetVertexEditOperation(int edit) const {
+        return _vertexEdits[edit].operation;
+    }
+
+    /// \brief Returns the vertex of its level identified by a vertex edit
+    ///
+    /// Returns INDEX_INVALID if the refiner does not include the level of
+    /// the edit or the path of the edit is not valid in the refiner.
+    ///
+    Index FindVertexEditVertex(TopologyRefiner const & refiner, int edit) const;
+
+    //@}
+
+    //@{
+    ///
+    /// Sharpness edits
+    ///
+
+    /// \brief Adds an edit of the sharpness of a refined edge
+    ///
+    /// The edge is identified by its index in the face of the path.
+    ///
+    int AddEdgeSharpnessEdit(Index baseFace, int numChildren,
+                             int const childFaces[], int edgeInFace,
+                             float sharpness, Operation operation = OPERATION_SET);
+
+    /// \brief Adds an edit of the sharpness of a refined vertex
+    ///
+    /// The vertex is identified by its index in the face of the path.
+    ///
+    int AddVertexSharpnessEdit(Index baseFace, int numChildren,
+                               int const childFaces[], int vertexInFace,
+                               float sharpness, Operation operation = OPERATION_SET);
+
+    /// \brief Returns the number of edge and vertex sharpness edits
+    int GetNumSharpnessEdits() const { return (int)_sharpnessEdits.size(); }
+
+    //@}
+
+protected:
+    friend class TopologyRefiner;
+
+    //  Applies the sharpness edits of a level of a refiner being refined
+    //  (prior to refining the level) and updates the affected tags:
+    void applySharpnessEdits(TopologyRefiner & refiner, int level) const;
+
+private:
+    struct Edit {
+        Index     baseFace;
+        int       level;
+        int       pathOffset;
+        int       componentInFace;
+        bool      isEdge;
+        Operation operation;
+        float     sharpness;
+    };
+
+    Edit & addEdit(std::vector<Edit> & edits, Index baseFace, int numChildren,
+                   int const childFaces[], int componentInFace);
+
+    Index findFace(TopologyRefiner const & refiner, Edit const & edit) const;
+
+private:
+    std::vector<int>  _paths;
+    std::vector<Edit> _vertexEdits;
+    std::vector<Edit> _sharpnessEdits;
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_HIERARCHICAL_EDITS_H */
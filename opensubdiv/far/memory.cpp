@@ -0,0 +1,109 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/memory.h"
+#include "../vtr/arena.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+//
+//  Statics for the publicly assignable callbacks (disable static assignment
+//  warnings when assigning them):
+//
+static MemoryStatsCallbackFunc incrementFunc = 0;
+static MemoryStatsCallbackFunc decrementFunc = 0;
+
+static ArenaAllocateFunc   arenaAllocateFunc   = 0;
+static ArenaDeallocateFunc arenaDeallocateFunc = 0;
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 1711
+#endif
+
+void SetMemoryStatsCallbacks(MemoryStatsCallbackFunc increment,
+                             MemoryStatsCallbackFunc decrement) {
+    incrementFunc = increment;
+    decrementFunc = decrement;
+}
+
+void SetArenaAllocator(ArenaAllocateFunc allocate,
+                       ArenaDeallocateFunc deallocate) {
+    arenaAllocateFunc   = allocate;
+    arenaDeallocateFunc = deallocate;
+}
+
+#ifdef __INTEL_COMPILER
+#pragma warning enable 1711
+#endif
+
+namespace internal {
+
+Vtr::internal::Arena *
+NewArena() {
+
+    //  Both functions are replaced together, or neither:
+    if (arenaAllocateFunc && arenaDeallocateFunc) {
+        return new Vtr::internal::Arena(Vtr::internal::Arena::DEFAULT_BLOCK_SIZE,
+            arenaAllocateFunc, arenaDeallocateFunc);
+    }
+    return new Vtr::internal::Arena;
+}
+
+bool
+MemoryStats::IsReporting() {
+    return incrementFunc || decrementFunc;
+}
+
+void
+MemoryStats::Update(MemoryObjectType type, void const * object, size_t bytes) {
+
+    _type   = type;
+    _object = object;
+
+    if (bytes > _bytes) {
+        if (incrementFunc) incrementFunc(_type, _object, bytes - _bytes);
+    } else if (bytes < _bytes) {
+        if (decrementFunc) decrementFunc(_type, _object, _bytes - bytes);
+    }
+    _bytes = bytes;
+}
+
+void
+MemoryStats::Release() {
+
+    if (_bytes && decrementFunc) {
+        decrementFunc(_type, _object, _bytes);
+    }
+    _bytes = 0;
+}
+
+} // end namespace internal
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
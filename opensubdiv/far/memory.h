@@ -0,0 +1,157 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_MEMORY_H
+#define OPENSUBDIV3_FAR_MEMORY_H
+
+#include "../version.h"
+
+#include <cstddef>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Vtr { namespace internal { class Arena; } }
+
+namespace Far {
+
+typedef enum {
+    MEMORY_TOPOLOGY_REFINER,    ///< A TopologyRefiner
+    MEMORY_PATCH_TABLE,         ///< A PatchTable (including its stencils)
+    MEMORY_STENCIL_TABLE        ///< A StencilTable or LimitStencilTable
+} MemoryObjectType;
+
+
+/// \brief The memory statistics callback function type
+///
+/// @param type    the type of the object
+///
+/// @param object  the object whose memory changed (a TopologyRefiner,
+///                PatchTable or StencilTableReal<>, according to type)
+///
+/// @param bytes   the number of bytes acquired or released by the object
+///
+typedef void (*MemoryStatsCallbackFunc)(MemoryObjectType type,
+                                        void const * object, size_t bytes);
+
+/// \brief Sets the callbacks notified as refiners and tables acquire and
+///        release memory (default is none)
+///
+/// Similar to the memory statistics of the Hbr allocators, the increment
+/// callback is notified of the memory held by a TopologyRefiner when its
+/// factory creates it and when it is refined, unrefined or compacted, of
+/// the memory of a PatchTable or StencilTable when returned by its factory
+/// or serializer, and the decrement callback of the memory released when
+/// any of these is destroyed.  The object is given to attribute the memory
+/// to the asset it belongs to.  The bytes reported are those of
+/// GetMemoryUsage().
+///
+/// Objects copied or modified directly by a client are not reported.
+///
+/// \note This function is not thread-safe and should be called before any
+///       refiners or tables are created !
+///
+/// @param increment  function pointer to the callback notified of memory
+///                   acquired (or 0)
+///
+/// @param decrement  function pointer to the callback notified of memory
+///                   released (or 0)
+///
+void SetMemoryStatsCallbacks(MemoryStatsCallbackFunc increment,
+                             MemoryStatsCallbackFunc decrement);
+
+
+
+/// \brief The arena block allocation callback function type
+typedef void * (*ArenaAllocateFunc)(size_t bytes);
+
+/// \brief The arena block deallocation callback function type
+typedef void (*ArenaDeallocateFunc)(void * block, size_t bytes);
+
+/// \brief Sets the functions allocating the blocks of the arenas of refined
+///        levels (default is malloc and free)
+///
+/// The refined levels of a TopologyRefiner are allocated from a few large
+/// blocks of its own arena when requested by its refinement options (see
+/// TopologyRefiner::UniformOptions::useArena), which a client may take from
+/// a pool or allocator of its own.  The blocks of an arena are released with
+/// the functions that allocated them.  Allocation failures (returning 0) are
+/// reported by throwing std::bad_alloc.
+///
+/// \note This function is not thread-safe !
+///
+/// @param allocate    function pointer allocating a block
+///
+/// @param deallocate  function pointer releasing a block
+///
+/// Both functions are replaced together -- 0 for either restores the
+/// default.
+///
+void SetArenaAllocator(ArenaAllocateFunc allocate,
+                       ArenaDeallocateFunc deallocate);
+
+
+namespace internal {
+
+//
+//  Returns a new arena allocating its blocks with the current functions:
+//
+Vtr::internal::Arena * NewArena();
+
+//
+//  The memory reported for an object -- a member of each object reported,
+//  which reports the change of its memory with each update and releases it
+//  when destroyed.  A copy of an object is not reported until updated:
+//
+class MemoryStats {
+public:
+    MemoryStats() : _object(0), _bytes(0), _type(MEMORY_TOPOLOGY_REFINER) { }
+    MemoryStats(MemoryStats const &) :
+        _object(0), _bytes(0), _type(MEMORY_TOPOLOGY_REFINER) { }
+    MemoryStats & operator=(MemoryStats const &) { return *this; }
+
+    ~MemoryStats() { Release(); }
+
+    //  True if any callbacks are set -- to avoid evaluating the memory:
+    static bool IsReporting();
+
+    void Update(MemoryObjectType type, void const * object, size_t bytes);
+    void Release();
+
+private:
+    void const *     _object;
+    size_t           _bytes;
+    MemoryObjectType _type;
+};
+
+} // end namespace internal
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_FAR_MEMORY_H
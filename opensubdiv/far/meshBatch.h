@@ -0,0 +1,124 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_MESH_BATCH_H
+#define OPENSUBDIV3_FAR_MESH_BATCH_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+#include "../far/patchTable.h"
+#include "../far/stencilTable.h"
+#include "../far/topologyRefiner.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief The tables of a batch of meshes built together
+///
+/// The stencils of all meshes of a batch are stored in a single StencilTable,
+/// each mesh owning a range of its control vertices -- those of the meshes
+/// concatenated in the order of the batch -- and a range of its stencils, so
+/// that the refined vertices of all meshes are computed by a single
+/// evaluation of the table.  Each mesh is described by a lightweight view of
+/// these ranges (see MeshBatchFactory).
+///
+class MeshBatch {
+public:
+
+    /// \brief The ranges of a mesh in the batch
+    struct Mesh {
+        bool valid;                 ///< false if the topology of the mesh
+                                    ///< is invalid (its ranges of stencils
+                                    ///< are then empty)
+        int  controlVertexOffset;   ///< index of the first control vertex
+                                    ///< of the mesh in the batch
+        int  numControlVertices;    ///< number of control vertices
+        int  stencilOffset;         ///< index of the first stencil of the
+                                    ///< mesh in GetStencilTable()
+        int  numStencils;           ///< number of stencils
+    };
+
+    ~MeshBatch();
+
+    /// \brief Returns the number of meshes
+    int GetNumMeshes() const { return (int)_meshes.size(); }
+
+    /// \brief Returns the ranges of a mesh
+    Mesh const & GetMesh(int mesh) const { return _meshes[mesh]; }
+
+    /// \brief Returns the number of control vertices of all meshes
+    int GetNumControlVertices() const {
+        return _stencilTable->GetNumControlVertices();
+    }
+
+    /// \brief Returns the stencils of all meshes, indexing the control
+    ///        vertices of all meshes
+    StencilTable const * GetStencilTable() const { return _stencilTable; }
+
+    /// \brief Returns the patch table of a mesh (or 0 if patch tables were
+    ///        not generated or the mesh is invalid)
+    ///
+    /// The points of its patches index the stencils of the mesh, i.e. are
+    /// relative to the stencil offset of the mesh.
+    ///
+    PatchTable const * GetPatchTable(int mesh) const {
+        return _patchTables.empty() ? 0 : _patchTables[mesh];
+    }
+
+    /// \brief Returns the refiner of a mesh (or 0 if refiners were not
+    ///        retained or the mesh is invalid)
+    TopologyRefiner const * GetRefiner(int mesh) const {
+        return _refiners.empty() ? 0 : _refiners[mesh];
+    }
+
+private:
+    friend class MeshBatchFactory;
+
+    MeshBatch() : _stencilTable(0) { }
+
+    //  Non-copyable:
+    MeshBatch(MeshBatch const &);
+    MeshBatch & operator=(MeshBatch const &);
+
+    std::vector<Mesh> _meshes;
+
+    StencilTable *                 _stencilTable;
+    std::vector<PatchTable *>      _patchTables;
+    std::vector<TopologyRefiner *> _refiners;
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_MESH_BATCH_H */
@@ -0,0 +1,224 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../far/meshBatchFactory.h"
+#include "../far/error.h"
+#include "../far/trace.h"
+
+#include <algorithm>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+MeshBatch::~MeshBatch() {
+
+    delete _stencilTable;
+    for (int i = 0; i < (int)_patchTables.size(); ++i) {
+        delete _patchTables[i];
+    }
+    for (int i = 0; i < (int)_refiners.size(); ++i) {
+        delete _refiners[i];
+    }
+}
+
+MeshBatch *
+MeshBatchFactory::Create(int numMeshes, TopologyDescriptor const meshes[],
+                         Options options) {
+
+    OPENSUBDIV_TRACE_SCOPE("meshBatch.create");
+
+    StencilTableFactory::Options & stencilOptions = options.stencilOptions;
+    if (stencilOptions.interpolationMode ==
+            StencilTableFactory::INTERPOLATE_FACE_VARYING) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in MeshBatchFactory::Create() -- "
+            "face-varying stencils are not supported.");
+        return 0;
+    }
+
+    //  Each mesh is built on a single thread:
+    stencilOptions.numThreads = 0;
+    stencilOptions.monitor = 0;
+    options.patchOptions.monitor = 0;
+
+    if (options.generatePatchTables) {
+        stencilOptions.generateControlVerts = true;
+        stencilOptions.generateIntermediateLevels = true;
+        options.patchOptions.includeBaseLevelIndices = true;
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = options.numThreads;
+#else
+    int numThreads = 1;
+#endif
+
+    //
+    //  Build the refiner and tables of each mesh:
+    //
+    std::vector<TopologyRefiner *>    refiners(numMeshes, 0);
+    std::vector<StencilTable const *> stencilTables(numMeshes, 0);
+    std::vector<PatchTable *>         patchTables(numMeshes, 0);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) \
+                             schedule(dynamic, 16)
+#endif
+    for (int mesh = 0; mesh < numMeshes; ++mesh) {
+        TopologyRefiner * refiner =
+            TopologyRefinerFactory<TopologyDescriptor>::Create(
+                meshes[mesh], options.refinerOptions);
+        if (!refiner) continue;
+
+        if (options.adaptive) {
+            TopologyRefiner::AdaptiveOptions adaptiveOptions =
+                options.patchOptions.GetRefineAdaptiveOptions();
+            adaptiveOptions.isolationLevel = options.refineLevel;
+            refiner->RefineAdaptive(adaptiveOptions);
+        } else {
+            refiner->RefineUniform(
+                TopologyRefiner::UniformOptions(options.refineLevel));
+        }
+
+        StencilTable const * stencilTable =
+            StencilTableFactory::Create(*refiner, stencilOptions);
+
+        if (options.generatePatchTables) {
+            PatchTable * patchTable =
+                PatchTableFactory::Create(*refiner, options.patchOptions);
+
+            StencilTable const * localPointStencilTable =
+                (stencilOptions.interpolationMode ==
+                    StencilTableFactory::INTERPOLATE_VERTEX)
+                ? patchTable->GetLocalPointStencilTable()
+                : patchTable->GetLocalPointVaryingStencilTable();
+            if (localPointStencilTable) {
+                StencilTable const * table =
+                    StencilTableFactory::AppendLocalPointStencilTable(
+                        *refiner, stencilTable, localPointStencilTable);
+                delete stencilTable;
+                stencilTable = table;
+            }
+            patchTables[mesh] = patchTable;
+        }
+
+        stencilTables[mesh] = stencilTable;
+        if (options.retainRefiners) {
+            refiners[mesh] = refiner;
+        } else {
+            delete refiner;
+        }
+    }
+
+    //
+    //  Assign the ranges of each mesh in the batch:
+    //
+    MeshBatch * batch = new MeshBatch;
+    batch->_meshes.resize(numMeshes);
+
+    std::vector<Offset> elementOffsets(numMeshes + 1, 0);
+
+    int numControlVertices = 0;
+    int numStencils = 0;
+    for (int mesh = 0; mesh < numMeshes; ++mesh) {
+        StencilTable const * stencilTable = stencilTables[mesh];
+
+        MeshBatch::Mesh & m = batch->_meshes[mesh];
+        m.valid = (stencilTable != 0);
+        m.controlVertexOffset = numControlVertices;
+        m.numControlVertices = meshes[mesh].numVertices;
+        m.stencilOffset = numStencils;
+        m.numStencils = m.valid ? stencilTable->GetNumStencils() : 0;
+
+        numControlVertices += m.numControlVertices;
+        numStencils += m.numStencils;
+        elementOffsets[mesh + 1] = elementOffsets[mesh] +
+            (m.valid ? (Offset)stencilTable->GetControlIndices().size() : 0);
+    }
+
+    //
+    //  Gather the stencils of all meshes into a single table, offsetting
+    //  their indices by the first control vertex of their mesh:
+    //
+    StencilTableReal<float> * table =
+        new StencilTableReal<float>(numControlVertices);
+    table->_sizes.resize(numStencils);
+    table->_indices.resize(elementOffsets[numMeshes]);
+    table->_weights.resize(elementOffsets[numMeshes]);
+    if (stencilOptions.generateOffsets) {
+        table->_offsets.resize(numStencils);
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) \
+                             schedule(dynamic, 16)
+#endif
+    for (int mesh = 0; mesh < numMeshes; ++mesh) {
+        StencilTable const * stencilTable = stencilTables[mesh];
+        if (!stencilTable) continue;
+
+        MeshBatch::Mesh const & m = batch->_meshes[mesh];
+
+        std::vector<int> const &   sizes   = stencilTable->GetSizes();
+        std::vector<Index> const & indices = stencilTable->GetControlIndices();
+        std::vector<float> const & weights = stencilTable->GetWeights();
+
+        std::copy(sizes.begin(), sizes.end(),
+                  table->_sizes.begin() + m.stencilOffset);
+        std::copy(weights.begin(), weights.begin() + indices.size(),
+                  table->_weights.begin() + elementOffsets[mesh]);
+
+        Index * dstIndices = &table->_indices[0] + elementOffsets[mesh];
+        for (int i = 0; i < (int)indices.size(); ++i) {
+            dstIndices[i] = indices[i] + m.controlVertexOffset;
+        }
+
+        if (stencilOptions.generateOffsets) {
+            std::vector<Offset> const & offsets = stencilTable->GetOffsets();
+            for (int i = 0; i < (int)offsets.size(); ++i) {
+                table->_offsets[m.stencilOffset + i] =
+                    offsets[i] + elementOffsets[mesh];
+            }
+        }
+        delete stencilTable;
+    }
+    table->updateMemoryStats();
+
+    batch->_stencilTable = static_cast<StencilTable *>(table);
+    if (options.generatePatchTables) {
+        batch->_patchTables.swap(patchTables);
+    }
+    if (options.retainRefiners) {
+        batch->_refiners.swap(refiners);
+    }
+    return batch;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,110 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_MESH_BATCH_FACTORY_H
+#define OPENSUBDIV3_FAR_MESH_BATCH_FACTORY_H
+
+#include "../version.h"
+
+#include "../far/meshBatch.h"
+#include "../far/patchTableFactory.h"
+#include "../far/stencilTableFactory.h"
+#include "../far/topologyDescriptor.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief A factory building the refiners and tables of many meshes at once
+///
+/// Libraries of many small meshes spend most of their build time in the
+/// overhead of each mesh rather than in its refinement.  The meshes of a
+/// batch share the same options and are built in parallel (with OpenMP
+/// support), each refined and factorized on a single thread, and their
+/// stencils are gathered into the single table of a MeshBatch rather than
+/// many small tables.
+///
+/// When patch tables are generated, the stencils of each mesh include those
+/// of its control vertices, of all its refined levels and of the local
+/// points of its patches, so that the points of its patches index its range
+/// of stencils directly.
+///
+class MeshBatchFactory {
+public:
+
+    typedef TopologyRefinerFactory<TopologyDescriptor>::Options RefinerOptions;
+
+    struct Options {
+
+        Options() : refineLevel(2),
+                    adaptive(false),
+                    generatePatchTables(false),
+                    retainRefiners(false),
+                    numThreads(0) { }
+
+        RefinerOptions               refinerOptions; ///< scheme of the meshes
+        StencilTableFactory::Options stencilOptions; ///< stencils of the
+                                                     ///< meshes (vertex or
+                                                     ///< varying)
+        PatchTableFactory::Options   patchOptions;   ///< patches of the meshes
+                                                     ///< (and adaptive
+                                                     ///< refinement options)
+
+        unsigned int refineLevel         : 4, ///< uniform level or adaptive
+                                              ///< isolation level
+                     adaptive            : 1, ///< refine adaptively
+                     generatePatchTables : 1, ///< generate a patch table
+                                              ///< per mesh
+                     retainRefiners      : 1, ///< keep the refiners in the
+                                              ///< batch
+                     numThreads          : 8; ///< number of threads building
+                                              ///< meshes (with OpenMP support)
+    };
+
+    /// \brief Instantiates a MeshBatch from the descriptors of its meshes
+    ///
+    /// @param numMeshes  The number of meshes
+    ///
+    /// @param meshes     The topology of each mesh
+    ///
+    /// @param options    Options shared by all meshes
+    ///
+    /// @return           A new instance of MeshBatch (or 0 for face-varying
+    ///                   stencils), in which meshes of invalid topology are
+    ///                   marked invalid
+    ///
+    static MeshBatch * Create(int numMeshes, TopologyDescriptor const meshes[],
+                              Options options = Options());
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_MESH_BATCH_FACTORY_H */
@@ -0,0 +1,122 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_MESHLET_TABLE_H
+#define OPENSUBDIV3_FAR_MESHLET_TABLE_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief The triangles of a refined level packed into meshlets
+///
+/// A meshlet is a cluster of at most a given number of vertices and
+/// triangles (see MeshletTableFactory::Options), as consumed by a mesh
+/// shader: its triangles index its own list of vertices with local 8-bit
+/// indices, and its vertices index the vertices of the level.
+///
+/// The triangles are also provided as a single index buffer (in the same
+/// order, so with the locality of the meshlets) for pipelines drawing
+/// indexed triangles.
+///
+class MeshletTable {
+public:
+
+    /// \brief A range of vertices and triangles of the table
+    struct Meshlet {
+        int vertexOffset;   ///< index of the first vertex of the meshlet in
+                            ///< GetMeshletVertices()
+        int vertexCount;    ///< number of vertices of the meshlet
+        int triangleOffset; ///< index of the first triangle of the meshlet,
+                            ///< whose local indices start at 3 times this
+                            ///< offset in GetMeshletTriangles()
+        int triangleCount;  ///< number of triangles of the meshlet
+    };
+
+    /// \brief Returns the refinement level of the vertices
+    int GetLevel() const { return _level; }
+
+    /// \brief Returns the number of meshlets
+    int GetNumMeshlets() const { return (int)_meshlets.size(); }
+
+    /// \brief Returns a meshlet
+    Meshlet const & GetMeshlet(int meshlet) const { return _meshlets[meshlet]; }
+
+    /// \brief Returns the vertices of a meshlet
+    ConstIndexArray GetMeshletVertices(int meshlet) const {
+        Meshlet const & m = _meshlets[meshlet];
+        return ConstIndexArray(&_vertices[m.vertexOffset], m.vertexCount);
+    }
+
+    /// \brief Returns the number of triangles
+    int GetNumTriangles() const { return (int)_triangleIndices.size() / 3; }
+
+    /// \brief Returns the table of all meshlets
+    std::vector<Meshlet> const & GetMeshlets() const { return _meshlets; }
+
+    /// \brief Returns the vertices of all meshlets -- indices of the vertices
+    ///        of the level
+    std::vector<Index> const & GetMeshletVertices() const { return _vertices; }
+
+    /// \brief Returns the local vertex indices of the triangles of all
+    ///        meshlets (three per triangle)
+    std::vector<unsigned char> const & GetMeshletTriangles() const {
+        return _triangles;
+    }
+
+    /// \brief Returns the vertex indices of the triangles of all meshlets
+    ///        (three per triangle, in the order of the meshlets)
+    std::vector<Index> const & GetTriangleIndices() const {
+        return _triangleIndices;
+    }
+
+private:
+    friend class MeshletTableFactory;
+
+    MeshletTable() : _level(0) { }
+
+    int _level;
+
+    std::vector<Meshlet>       _meshlets;
+    std::vector<Index>         _vertices;
+    std::vector<unsigned char> _triangles;
+    std::vector<Index>         _triangleIndices;
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_MESHLET_TABLE_H */
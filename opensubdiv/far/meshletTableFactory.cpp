@@ -0,0 +1,226 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../far/meshletTableFactory.h"
+#include "../far/topologyLevel.h"
+#include "../far/trace.h"
+
+#include <algorithm>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+namespace {
+
+    //  Number of faces of the blocks packed independently:
+    int const FACES_PER_BLOCK = 2048;
+
+    //
+    //  Packs triangles into meshlets, appending each triangle to the last
+    //  meshlet unless its new vertices or the triangle exceed the limits:
+    //
+    class MeshletPacker {
+    public:
+        typedef MeshletTable::Meshlet Meshlet;
+
+        MeshletPacker(int maxVertices, int maxTriangles) :
+            _maxVertices(maxVertices), _maxTriangles(maxTriangles) { }
+
+        void AddTriangle(Index v0, Index v1, Index v2) {
+
+            Index const verts[3] = { v0, v1, v2 };
+
+            int local[3];
+            int numNewVertices = 0;
+            if (!_meshlets.empty()) {
+                numNewVertices = findVertices(verts, local);
+            }
+            if (_meshlets.empty() ||
+                (_meshlets.back().vertexCount + numNewVertices >
+                    _maxVertices) ||
+                (_meshlets.back().triangleCount + 1 > _maxTriangles)) {
+                Meshlet meshlet;
+                meshlet.vertexOffset = (int)_vertices.size();
+                meshlet.vertexCount = 0;
+                meshlet.triangleOffset = (int)_triangles.size() / 3;
+                meshlet.triangleCount = 0;
+                _meshlets.push_back(meshlet);
+
+                findVertices(verts, local);
+            }
+
+            Meshlet & meshlet = _meshlets.back();
+            for (int i = 0; i < 3; ++i) {
+                if (local[i] < 0) {
+                    local[i] = meshlet.vertexCount++;
+                    _vertices.push_back(verts[i]);
+                }
+                _triangles.push_back((unsigned char)local[i]);
+            }
+            ++meshlet.triangleCount;
+        }
+
+        std::vector<Meshlet>       _meshlets;
+        std::vector<Index>         _vertices;
+        std::vector<unsigned char> _triangles;
+
+    private:
+        //  Returns the number of vertices new to the last meshlet, which are
+        //  given a local index of -1
+        int findVertices(Index const verts[3], int local[3]) const {
+
+            int numNewVertices = 0;
+            for (int i = 0; i < 3; ++i) {
+                local[i] = -1;
+                if (!_meshlets.empty()) {
+                    Meshlet const & meshlet = _meshlets.back();
+                    //  Recent vertices are the most likely to be shared:
+                    for (int j = meshlet.vertexCount - 1; j >= 0; --j) {
+                        if (_vertices[meshlet.vertexOffset + j] == verts[i]) {
+                            local[i] = j;
+                            break;
+                        }
+                    }
+                }
+                if (local[i] < 0) {
+                    ++numNewVertices;
+                }
+            }
+            return numNewVertices;
+        }
+
+        int _maxVertices;
+        int _maxTriangles;
+    };
+}
+
+MeshletTable *
+MeshletTableFactory::Create(TopologyRefiner const & refiner,
+                            Options options) {
+
+    return Create(refiner, refiner.GetMaxLevel(), options);
+}
+
+MeshletTable *
+MeshletTableFactory::Create(TopologyRefiner const & refiner, int level,
+                            Options options) {
+
+    OPENSUBDIV_TRACE_SCOPE("meshletTable.create");
+
+    int maxVertices = options.maxVertices;
+    int maxTriangles = options.maxTriangles;
+    if ((maxVertices < 3) || (maxVertices > 256) ||
+        (maxTriangles < 1) || (maxTriangles > 512) ||
+        (level < 0) || (level > refiner.GetMaxLevel())) {
+        return 0;
+    }
+
+    TopologyLevel const & refLevel = refiner.GetLevel(level);
+
+    int numFaces = refLevel.GetNumFaces();
+    int numBlocks = (numFaces + FACES_PER_BLOCK - 1) / FACES_PER_BLOCK;
+    int numThreads = options.numThreads;
+    (void)numThreads;
+
+    std::vector<MeshletPacker> blocks(numBlocks,
+        MeshletPacker(maxVertices, maxTriangles));
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(dynamic, 1)
+#endif
+    for (int block = 0; block < numBlocks; ++block) {
+        MeshletPacker & packer = blocks[block];
+
+        Index firstFace = block * FACES_PER_BLOCK;
+        Index lastFace = std::min(firstFace + FACES_PER_BLOCK, numFaces);
+        for (Index face = firstFace; face < lastFace; ++face) {
+            if (refLevel.IsFaceHole(face)) continue;
+
+            ConstIndexArray fVerts = refLevel.GetFaceVertices(face);
+            for (int i = 2; i < fVerts.size(); ++i) {
+                packer.AddTriangle(fVerts[0], fVerts[i - 1], fVerts[i]);
+            }
+        }
+    }
+
+    //
+    //  Concatenate the meshlets of the blocks:
+    //
+    MeshletTable * table = new MeshletTable;
+    table->_level = level;
+
+    size_t numMeshlets = 0, numVertices = 0, numTriangleIndices = 0;
+    for (int block = 0; block < numBlocks; ++block) {
+        numMeshlets += blocks[block]._meshlets.size();
+        numVertices += blocks[block]._vertices.size();
+        numTriangleIndices += blocks[block]._triangles.size();
+    }
+    table->_meshlets.reserve(numMeshlets);
+    table->_vertices.reserve(numVertices);
+    table->_triangles.reserve(numTriangleIndices);
+    table->_triangleIndices.resize(numTriangleIndices);
+
+    for (int block = 0; block < numBlocks; ++block) {
+        MeshletPacker const & packer = blocks[block];
+
+        int vertexOffset = (int)table->_vertices.size();
+        int triangleOffset = (int)table->_triangles.size() / 3;
+
+        for (int i = 0; i < (int)packer._meshlets.size(); ++i) {
+            MeshletTable::Meshlet meshlet = packer._meshlets[i];
+            meshlet.vertexOffset += vertexOffset;
+            meshlet.triangleOffset += triangleOffset;
+            table->_meshlets.push_back(meshlet);
+        }
+        table->_vertices.insert(table->_vertices.end(),
+            packer._vertices.begin(), packer._vertices.end());
+        table->_triangles.insert(table->_triangles.end(),
+            packer._triangles.begin(), packer._triangles.end());
+    }
+
+    //  Resolve the local indices into the triangle index buffer:
+    int numTableMeshlets = (int)table->_meshlets.size();
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(static, 64)
+#endif
+    for (int i = 0; i < numTableMeshlets; ++i) {
+        MeshletTable::Meshlet const & meshlet = table->_meshlets[i];
+
+        Index const * vertices = &table->_vertices[meshlet.vertexOffset];
+        int first = meshlet.triangleOffset * 3;
+        int last = first + meshlet.triangleCount * 3;
+        for (int j = first; j < last; ++j) {
+            table->_triangleIndices[j] = vertices[table->_triangles[j]];
+        }
+    }
+    return table;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
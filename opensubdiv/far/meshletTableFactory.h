@@ -0,0 +1,94 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_MESHLET_TABLE_FACTORY_H
+#define OPENSUBDIV3_FAR_MESHLET_TABLE_FACTORY_H
+
+#include "../version.h"
+
+#include "../far/meshletTable.h"
+#include "../far/topologyRefiner.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief A specialized factory for MeshletTable
+///
+/// The faces of a uniformly refined level are triangulated and packed into
+/// meshlets in the order of the faces, i.e. the order of the child faces of
+/// the refinement: the faces of each parent face are consecutive, so that
+/// the faces of a level are ordered as a hierarchy of the base faces and
+/// packing them in order already yields compact meshlets sharing most of
+/// their vertices, without any reordering.  Quads are split along their
+/// diagonal from the first vertex, other faces into fans, and holes are
+/// skipped.
+///
+/// The faces are packed in fixed blocks, each closing its last meshlet, so
+/// that blocks are packed in parallel (with OpenMP support) and the table
+/// is the same for any number of threads.
+///
+class MeshletTableFactory {
+public:
+
+    struct Options {
+
+        Options() : maxVertices(64), maxTriangles(124), numThreads(0) { }
+
+        unsigned int maxVertices  : 9,  ///< maximum number of vertices of a
+                                        ///< meshlet (at most 256)
+                     maxTriangles : 10, ///< maximum number of triangles of a
+                                        ///< meshlet (at most 512)
+                     numThreads   : 8;  ///< number of threads packing the
+                                        ///< meshlets (with OpenMP support)
+    };
+
+    /// \brief Instantiates a MeshletTable from the last level of a refiner
+    ///        refined uniformly
+    ///
+    /// @param refiner  TopologyRefiner from which to generate the meshlets
+    ///
+    /// @param options  Options controlling the meshlets
+    ///
+    /// @return         A new instance of MeshletTable (or 0 if the limits of
+    ///                 the options are invalid)
+    ///
+    static MeshletTable * Create(TopologyRefiner const & refiner,
+                                 Options options = Options());
+
+    /// \brief Instantiates a MeshletTable from a level of a refiner
+    static MeshletTable * Create(TopologyRefiner const & refiner, int level,
+                                 Options options = Options());
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_MESHLET_TABLE_FACTORY_H */
@@ -0,0 +1,640 @@
+//
+//   Copyright 2014 DreamWorks Animation LLC.
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/patchBVH.h"
+#include "../far/patchBasis.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+namespace {
+
+    //
+    //  Orders patches by the coordinate of their centroids along an axis:
+    //
+    struct CentroidLess {
+        CentroidLess(std::vector<float> const & centroids, int axis) :
+            _centroids(centroids), _axis(axis) { }
+
+        bool operator()(int a, int b) const {
+            return _centroids[a * 3 + _axis] < _centroids[b * 3 + _axis];
+        }
+
+        std::vector<float> const & _centroids;
+        int                        _axis;
+    };
+
+    inline void
+    clearBounds(float bounds[6]) {
+        bounds[0] = bounds[1] = bounds[2] =  FLT_MAX;
+        bounds[3] = bounds[4] = bounds[5] = -FLT_MAX;
+    }
+
+    inline void
+    addBounds(float bounds[6], float const other[6]) {
+        for (int k = 0; k < 3; ++k) {
+            bounds[k]     = std::min(bounds[k],     other[k]);
+            bounds[k + 3] = std::max(bounds[k + 3], other[k + 3]);
+        }
+    }
+
+    template <typename REAL>
+    inline void
+    addPoint(float bounds[6], REAL const p[3]) {
+        for (int k = 0; k < 3; ++k) {
+            bounds[k]     = std::min(bounds[k],     (float)p[k]);
+            bounds[k + 3] = std::max(bounds[k + 3], (float)p[k]);
+        }
+    }
+
+    //
+    //  Returns the parameter at which a ray enters a box (or a value greater
+    //  than tMax if it misses the box) from the inverse of its direction:
+    //
+    template <typename REAL>
+    inline REAL
+    intersectBounds(float const bounds[6], REAL const origin[3],
+                    REAL const invDirection[3], REAL tMax) {
+        REAL tNear = 0.0f, tFar = tMax;
+        for (int k = 0; k < 3; ++k) {
+            REAL t0 = ((REAL)bounds[k]     - origin[k]) * invDirection[k];
+            REAL t1 = ((REAL)bounds[k + 3] - origin[k]) * invDirection[k];
+            if (t0 > t1) std::swap(t0, t1);
+            // comparisons fail for NaN (ray within the plane of a slab)
+            if (t0 > tNear) tNear = t0;
+            if (t1 < tFar)  tFar  = t1;
+            if (tNear > tFar) return tMax + 1.0f;
+        }
+        return tNear;
+    }
+
+    //
+    //  Returns the squared distance of a point to a box:
+    //
+    template <typename REAL>
+    inline REAL
+    distanceToBounds2(float const bounds[6], REAL const p[3]) {
+        REAL d2 = 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            REAL d = std::max((REAL)bounds[k] - p[k],
+                     std::max(p[k] - (REAL)bounds[k + 3], (REAL)0.0f));
+            d2 += d * d;
+        }
+        return d2;
+    }
+
+    //
+    //  Combines the points of a patch with the weights of its basis (of
+    //  which all weights of the phantom points are zero -- their own indices
+    //  not necessarily being valid):
+    //
+    template <typename REAL>
+    inline void
+    evalPatchPoint(ConstIndexArray const & cvs, REAL const * points,
+                   int stride, REAL const * w[], int numWeights,
+                   REAL (*result)[3]) {
+        for (int j = 0; j < numWeights; ++j) {
+            result[j][0] = result[j][1] = result[j][2] = 0.0f;
+        }
+        for (int i = 0; i < cvs.size(); ++i) {
+            REAL const * src = 0;
+            for (int j = 0; j < numWeights; ++j) {
+                REAL wi = w[j][i];
+                if (wi == 0.0f) continue;
+                if (!src) src = points + cvs[i] * stride;
+                result[j][0] += wi * src[0];
+                result[j][1] += wi * src[1];
+                result[j][2] += wi * src[2];
+            }
+        }
+    }
+
+    template <typename REAL>
+    inline REAL
+    dot(REAL const a[3], REAL const b[3]) {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    //
+    //  Clamps a location to the unit square or triangle:
+    //
+    template <typename REAL>
+    inline void
+    clampToDomain(bool triangular, REAL & s, REAL & t) {
+        s = std::max(s, (REAL)0.0f);
+        t = std::max(t, (REAL)0.0f);
+        if (triangular) {
+            REAL excess = (s + t - 1.0f) * 0.5f;
+            if (excess > 0.0f) {
+                s = std::max(s - excess, (REAL)0.0f);
+                t = std::max(t - excess, (REAL)0.0f);
+                if (s + t > 1.0f) {
+                    if (s > t) s = 1.0f - t; else t = 1.0f - s;
+                }
+            }
+        } else {
+            s = std::min(s, (REAL)1.0f);
+            t = std::min(t, (REAL)1.0f);
+        }
+    }
+
+} // end namespace
+
+template <typename REAL>
+PatchBVH::PatchBVH(PatchTable const & patchTable, REAL const * points,
+                   int stride, Options options) :
+    _patchTable(patchTable), _numThreads(options.numThreads) {
+
+    int numArrays  = (int) patchTable.GetNumPatchArrays();
+    int numPatches = (int) patchTable.GetNumPatchesTotal();
+
+    _handles.resize(numPatches);
+
+    for (int pArray = 0, handleIndex = 0; pArray < numArrays; ++pArray) {
+
+        int patchSize =
+            patchTable.GetPatchArrayDescriptor(pArray).GetNumControlVertices();
+
+        for (Index j=0; j < patchTable.GetNumPatches(pArray); ++j, ++handleIndex) {
+
+            Handle & h = _handles[handleIndex];
+
+            h.arrayIndex = pArray;
+            h.patchIndex = handleIndex;
+            h.vertIndex  = j * patchSize;
+        }
+    }
+
+    computePatchBounds(points, stride);
+
+    build(std::max(1, (int)options.maxLeafPatches));
+
+    refitNodes();
+}
+
+template <typename REAL>
+void
+PatchBVH::Refit(REAL const * points, int stride) {
+
+    computePatchBounds(points, stride);
+
+    refitNodes();
+}
+
+template <typename REAL>
+void
+PatchBVH::computePatchBounds(REAL const * points, int stride) {
+
+    int numPatches = (int)_handles.size();
+    _patchBounds.resize(numPatches * 6);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads) schedule(static, 64)
+#endif
+    for (int patch = 0; patch < numPatches; ++patch) {
+        Handle const & handle = _handles[patch];
+        float * bounds = &_patchBounds[patch * 6];
+
+        PatchDescriptor::Type type =
+            _patchTable.GetPatchArrayDescriptor(handle.arrayIndex).GetType();
+
+        // the legacy Gregory patches are not bounded by their points
+        if (type == PatchDescriptor::GREGORY ||
+            type == PatchDescriptor::GREGORY_BOUNDARY) {
+            bounds[0] = bounds[1] = bounds[2] = -FLT_MAX;
+            bounds[3] = bounds[4] = bounds[5] =  FLT_MAX;
+            continue;
+        }
+
+        ConstIndexArray cvs = _patchTable.GetPatchVertices(handle);
+        clearBounds(bounds);
+
+        REAL w[16 * 16];
+        int nPoints = internal::GetPatchBoundaryPointWeights(type,
+            _patchTable.GetPatchParam(handle), w);
+
+        if (nPoints == 0) {
+            for (int i = 0; i < cvs.size(); ++i) {
+                addPoint(bounds, points + cvs[i] * stride);
+            }
+        } else {
+            // the effective points, including the phantom points (whose
+            // own indices have no weight and are not necessarily valid)
+            for (int j = 0; j < nPoints; ++j) {
+                REAL const * wj = w + j * nPoints;
+                REAL p[3] = { 0.0f, 0.0f, 0.0f };
+                for (int i = 0; i < nPoints; ++i) {
+                    if (wj[i] == 0.0f) continue;
+                    REAL const * src = points + cvs[i] * stride;
+                    p[0] += wj[i] * src[0];
+                    p[1] += wj[i] * src[1];
+                    p[2] += wj[i] * src[2];
+                }
+                addPoint(bounds, p);
+            }
+        }
+    }
+}
+
+void
+PatchBVH::build(int maxLeafPatches) {
+
+    int numPatches = (int)_handles.size();
+
+    // patches are partitioned by the centroids of their points
+    std::vector<float> centroids(numPatches * 3, 0.0f);
+    for (int patch = 0; patch < numPatches; ++patch) {
+        float const * bounds = &_patchBounds[patch * 6];
+        if (bounds[0] > bounds[3]) continue;
+        for (int k = 0; k < 3; ++k) {
+            // unbounded patches are partitioned at the origin
+            centroids[patch * 3 + k] = (bounds[0] == -FLT_MAX) ? 0.0f :
+                0.5f * (bounds[k] + bounds[k + 3]);
+        }
+    }
+
+    _leafPatches.resize(numPatches);
+    for (int patch = 0; patch < numPatches; ++patch) {
+        _leafPatches[patch] = patch;
+    }
+
+    _nodes.clear();
+    if (numPatches == 0) return;
+    _nodes.reserve(2 * numPatches / maxLeafPatches + 1);
+
+    Node root;
+    root.index = 0;
+    root.numPatches = numPatches;
+    _nodes.push_back(root);
+
+    // nodes are split depth first, appending their children after them
+    std::vector<int> stack(1, 0);
+    while (!stack.empty()) {
+        int nodeIndex = stack.back();
+        stack.pop_back();
+
+        int begin = _nodes[nodeIndex].index;
+        int count = _nodes[nodeIndex].numPatches;
+        if (count <= maxLeafPatches) continue;
+
+        // split at the median of the longest axis of the centroids
+        float extent[6];
+        clearBounds(extent);
+        for (int i = begin; i < begin + count; ++i) {
+            addPoint(extent, &centroids[_leafPatches[i] * 3]);
+        }
+        int axis = 0;
+        for (int k = 1; k < 3; ++k) {
+            if (extent[k + 3] - extent[k] > extent[axis + 3] - extent[axis]) {
+                axis = k;
+            }
+        }
+
+        int half = count / 2;
+        std::nth_element(_leafPatches.begin() + begin,
+                         _leafPatches.begin() + begin + half,
+                         _leafPatches.begin() + begin + count,
+                         CentroidLess(centroids, axis));
+
+        int firstChild = (int)_nodes.size();
+
+        Node child;
+        child.index = begin;
+        child.numPatches = half;
+        _nodes.push_back(child);
+
+        child.index = begin + half;
+        child.numPatches = count - half;
+        _nodes.push_back(child);
+
+        _nodes[nodeIndex].index = firstChild;
+        _nodes[nodeIndex].numPatches = 0;
+
+        stack.push_back(firstChild);
+        stack.push_back(firstChild + 1);
+    }
+}
+
+void
+PatchBVH::refitNodes() {
+
+    // children follow their parents
+    for (int i = (int)_nodes.size() - 1; i >= 0; --i) {
+        Node & node = _nodes[i];
+        clearBounds(node.bounds);
+        if (node.IsLeaf()) {
+            for (int j = 0; j < node.numPatches; ++j) {
+                int patch = _leafPatches[node.index + j];
+                addBounds(node.bounds, &_patchBounds[patch * 6]);
+            }
+        } else {
+            addBounds(node.bounds, _nodes[node.index].bounds);
+            addBounds(node.bounds, _nodes[node.index + 1].bounds);
+        }
+    }
+}
+
+template <typename REAL>
+void
+PatchBVH::IntersectRay(REAL const origin[3], REAL const direction[3],
+                       REAL tMax, std::vector<int> & patches) const {
+
+    patches.clear();
+    if (_nodes.empty()) return;
+
+    REAL invDirection[3];
+    for (int k = 0; k < 3; ++k) {
+        invDirection[k] = (REAL)1.0f / direction[k];
+    }
+
+    if (intersectBounds(_nodes[0].bounds, origin, invDirection, tMax) > tMax) {
+        return;
+    }
+
+    std::vector<int> stack(1, 0);
+    while (!stack.empty()) {
+        Node const & node = _nodes[stack.back()];
+        stack.pop_back();
+
+        if (node.IsLeaf()) {
+            for (int j = 0; j < node.numPatches; ++j) {
+                int patch = _leafPatches[node.index + j];
+                if (intersectBounds(&_patchBounds[patch * 6],
+                                    origin, invDirection, tMax) <= tMax) {
+                    patches.push_back(patch);
+                }
+            }
+            continue;
+        }
+
+        // visit the nearest child first
+        int c0 = node.index, c1 = node.index + 1;
+        REAL t0 = intersectBounds(_nodes[c0].bounds, origin, invDirection, tMax);
+        REAL t1 = intersectBounds(_nodes[c1].bounds, origin, invDirection, tMax);
+        if (t1 < t0) {
+            std::swap(c0, c1);
+            std::swap(t0, t1);
+        }
+        if (t1 <= tMax) stack.push_back(c1);
+        if (t0 <= tMax) stack.push_back(c0);
+    }
+}
+
+template <typename REAL>
+void
+PatchBVH::FindClosestPoints(REAL const * points, int stride,
+                            REAL const * queries, int numQueries,
+                            ClosestPoint * results, REAL maxDistance) const {
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads) schedule(dynamic, 16)
+#endif
+    for (int i = 0; i < numQueries; ++i) {
+        findClosestPoint(points, stride, queries + i * 3, maxDistance,
+                         results[i]);
+    }
+}
+
+template <typename REAL>
+void
+PatchBVH::findClosestPoint(REAL const * points, int stride,
+                           REAL const query[3], REAL maxDistance,
+                           ClosestPoint & result) const {
+
+    result.patch = -1;
+    result.u = result.v = 0.0f;
+    result.distance = (float)maxDistance;
+
+    if (_nodes.empty()) return;
+
+    REAL best2 = (maxDistance < (REAL)FLT_MAX) ? maxDistance * maxDistance
+                                              : (REAL)FLT_MAX;
+
+    //  Nodes are visited in the order of the distance to their bounds, until
+    //  the nearest of them is farther than the closest point found:
+    typedef std::pair<REAL, int> Entry;
+    std::vector<Entry> heap;
+    heap.reserve(64);
+
+    REAL rootDist2 = distanceToBounds2(_nodes[0].bounds, query);
+    if (rootDist2 >= best2) return;
+    heap.push_back(Entry(-rootDist2, 0));
+
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+        Entry entry = heap.back();
+        heap.pop_back();
+        if (-entry.first >= best2) break;
+
+        Node const & node = _nodes[entry.second];
+        if (node.IsLeaf()) {
+            for (int j = 0; j < node.numPatches; ++j) {
+                int patch = _leafPatches[node.index + j];
+                if (distanceToBounds2(&_patchBounds[patch * 6], query) >= best2) {
+                    continue;
+                }
+                REAL u = 0.0f, v = 0.0f;
+                REAL dist2 = projectOntoPatch(patch, points, stride, query, u, v);
+                if (dist2 < best2) {
+                    best2 = dist2;
+                    result.patch = patch;
+                    result.u = (float)u;
+                    result.v = (float)v;
+                }
+            }
+            continue;
+        }
+        for (int c = node.index; c < node.index + 2; ++c) {
+            REAL dist2 = distanceToBounds2(_nodes[c].bounds, query);
+            if (dist2 < best2) {
+                heap.push_back(Entry(-dist2, c));
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+    }
+
+    if (result.patch >= 0) {
+        result.distance = (float)std::sqrt(best2);
+    }
+}
+
+//
+//  Returns the squared distance to the point of a patch locally closest to
+//  the query and its location (u,v), starting Newton iterations on the
+//  squared distance from the nearest of a few samples of the patch.  The
+//  iterations are in base face space, where the basis is evaluated, and
+//  each location is clamped to the domain of the patch:
+//
+template <typename REAL>
+REAL
+PatchBVH::projectOntoPatch(int patch, REAL const * points, int stride,
+                           REAL const query[3], REAL & u, REAL & v) const {
+
+    Handle const & handle = _handles[patch];
+
+    PatchDescriptor::Type type =
+        _patchTable.GetPatchArrayDescriptor(handle.arrayIndex).GetType();
+    if (type == PatchDescriptor::GREGORY ||
+        type == PatchDescriptor::GREGORY_BOUNDARY) {
+        return (REAL)FLT_MAX;
+    }
+    bool triangular = (type == PatchDescriptor::LOOP) ||
+                      (type == PatchDescriptor::GREGORY_TRIANGLE) ||
+                      (type == PatchDescriptor::TRIANGLES);
+
+    PatchParam param = _patchTable.GetPatchParam(handle);
+    ConstIndexArray cvs = _patchTable.GetPatchVertices(handle);
+
+    REAL wP[20], wDu[20], wDv[20], wDuu[20], wDuv[20], wDvv[20];
+    REAL const * w[6] = { wP, wDu, wDv, wDuu, wDuv, wDvv };
+    REAL p[6][3];
+
+    //  Start from the nearest of the samples of a 4x4 grid of the domain:
+    int const n = 4;
+    REAL best2 = (REAL)FLT_MAX;
+    for (int i = 0; i <= n; ++i) {
+        for (int j = 0; j <= n; ++j) {
+            if (triangular && (i + j > n)) continue;
+
+            REAL su = (REAL)i / n, sv = (REAL)j / n;
+            if (triangular) {
+                param.UnnormalizeTriangle(su, sv);
+            } else {
+                param.Unnormalize(su, sv);
+            }
+            _patchTable.EvaluateBasis(handle, su, sv, wP);
+            evalPatchPoint(cvs, points, stride, w, 1, p);
+
+            REAL d[3] = { p[0][0] - query[0], p[0][1] - query[1],
+                          p[0][2] - query[2] };
+            REAL dist2 = dot(d, d);
+            if (dist2 < best2) {
+                best2 = dist2;
+                u = su;
+                v = sv;
+            }
+        }
+    }
+
+    REAL tolerance = (REAL)1.0e-6f * (REAL)param.GetParamFraction();
+
+    for (int iteration = 0; iteration < 16; ++iteration) {
+        _patchTable.EvaluateBasis(handle, u, v, wP, wDu, wDv, wDuu, wDuv, wDvv);
+        evalPatchPoint(cvs, points, stride, w, 6, p);
+
+        REAL d[3] = { p[0][0] - query[0], p[0][1] - query[1],
+                      p[0][2] - query[2] };
+
+        //  Gradient and Hessian of half the squared distance, reverting to
+        //  the Gauss-Newton approximation where it is not positive definite:
+        REAL gu = dot(p[1], d);
+        REAL gv = dot(p[2], d);
+
+        REAL huu = dot(p[1], p[1]) + dot(p[3], d);
+        REAL huv = dot(p[1], p[2]) + dot(p[4], d);
+        REAL hvv = dot(p[2], p[2]) + dot(p[5], d);
+        REAL det = huu * hvv - huv * huv;
+        if ((huu <= 0.0f) || (det <= 0.0f)) {
+            huu = dot(p[1], p[1]);
+            huv = dot(p[1], p[2]);
+            hvv = dot(p[2], p[2]);
+            det = huu * hvv - huv * huv;
+        }
+        if (det <= (REAL)FLT_MIN) break;
+
+        REAL du = (huv * gv - hvv * gu) / det;
+        REAL dv = (huv * gu - huu * gv) / det;
+
+        //  Clamp the step to the domain, halving it until the distance
+        //  decreases:
+        bool improved = false;
+        for (int halving = 0; halving < 4 && !improved; ++halving) {
+            REAL su = u + du, sv = v + dv;
+            if (triangular) {
+                param.NormalizeTriangle(su, sv);
+                clampToDomain(true, su, sv);
+                param.UnnormalizeTriangle(su, sv);
+            } else {
+                param.Normalize(su, sv);
+                clampToDomain(false, su, sv);
+                param.Unnormalize(su, sv);
+            }
+
+            REAL q[1][3];
+            _patchTable.EvaluateBasis(handle, su, sv, wP);
+            evalPatchPoint(cvs, points, stride, w, 1, q);
+            REAL e[3] = { q[0][0] - query[0], q[0][1] - query[1],
+                          q[0][2] - query[2] };
+            REAL dist2 = dot(e, e);
+            if (dist2 <= best2) {
+                improved = (dist2 < best2);
+                du = su - u;
+                dv = sv - v;
+                u = su;
+                v = sv;
+                best2 = dist2;
+                break;
+            }
+            du *= 0.5f;
+            dv *= 0.5f;
+        }
+        if (!improved ||
+            (std::abs(du) < tolerance && std::abs(dv) < tolerance)) {
+            break;
+        }
+    }
+    return best2;
+}
+
+//
+//  Explicit float and double instantiations:
+//
+template PatchBVH::PatchBVH(PatchTable const & patchTable,
+    float const * points, int stride, Options options);
+template void PatchBVH::Refit(float const * points, int stride);
+template void PatchBVH::IntersectRay(float const origin[3],
+    float const direction[3], float tMax, std::vector<int> & patches) const;
+template void PatchBVH::FindClosestPoints(float const * points, int stride,
+    float const * queries, int numQueries, ClosestPoint * results,
+    float maxDistance) const;
+
+template PatchBVH::PatchBVH(PatchTable const & patchTable,
+    double const * points, int stride, Options options);
+template void PatchBVH::Refit(double const * points, int stride);
+template void PatchBVH::IntersectRay(double const origin[3],
+    double const direction[3], double tMax, std::vector<int> & patches) const;
+template void PatchBVH::FindClosestPoints(double const * points, int stride,
+    double const * queries, int numQueries, ClosestPoint * results,
+    double maxDistance) const;
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,227 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_PATCH_BVH_H
+#define OPENSUBDIV3_FAR_PATCH_BVH_H
+
+#include "../version.h"
+
+#include "../far/patchTable.h"
+
+#include <cfloat>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief A bounding volume hierarchy over the patches of a PatchTable
+///
+/// The bounding box of each patch is computed from its control points (for
+/// boundary patches, with the phantom points extrapolated beyond their
+/// boundaries), which bound the limit surface of the B-spline, Loop, Gregory
+/// and linear patches. The patches of the legacy Gregory types are not
+/// bounded by their points and are given unbounded boxes.
+///
+/// The hierarchy is built once from a set of point positions (the refined
+/// vertices followed by the local points of the table) and its bounds are
+/// refitted to the new positions of the points after each evaluation of
+/// the stencils, e.g. of an animated mesh:
+///
+///     Far::PatchBVH bvh(*patchTable, &points[0].x, 3);
+///     ...
+///     evaluator->EvalStencils(...);
+///     bvh.Refit(&points[0].x, 3);
+///
+///     bvh.IntersectRay(origin, direction, tMax, candidates);
+///     // intersect the limit surface of the candidate patches
+///
+/// The closest points of the limit surface to a batch of query points are
+/// found with FindClosestPoints(), visiting the patches in the order of the
+/// distance to their bounds and projecting the queries onto each patch with
+/// Newton iterations, until no other bounds are closer than the point found:
+///
+///     bvh.FindClosestPoints(&points[0].x, 3, &queries[0].x, numQueries,
+///                           &results[0]);
+///     ...
+///     Osd::PatchCoord coord(bvh.GetPatchHandle(results[i].patch),
+///                           results[i].u, results[i].v);
+///
+/// Refitting keeps the topology of the tree, so its quality decreases with
+/// the extent of the deformation and it is rebuilt by constructing a new
+/// PatchBVH.
+///
+class PatchBVH {
+public:
+
+    typedef PatchTable::PatchHandle Handle;
+
+    struct Options {
+        Options() : maxLeafPatches(4), numThreads(0) { }
+
+        unsigned int maxLeafPatches : 8, ///< maximum number of patches of a
+                                         ///< leaf node
+                     numThreads     : 8; ///< number of threads used to refit
+                                         ///< the bounds of the patches and
+                                         ///< to find closest points (with
+                                         ///< OpenMP support)
+    };
+
+    /// \brief The closest point of the limit surface to a query point
+    struct ClosestPoint {
+        int   patch;     ///< index of the patch (see GetPatchHandle()), or -1
+                         ///< if none is within the maximum distance
+        float u, v;      ///< location in base face normalized space, as for
+                         ///< PatchTable::EvaluateBasis() and Osd::PatchCoord
+        float distance;  ///< distance of the point to the query
+    };
+
+    /// \brief A node of the hierarchy, either a leaf with a range of the
+    ///        patches of GetLeafPatches() or an internal node with two
+    ///        consecutive children
+    struct Node {
+        float bounds[6];    ///< min x,y,z and max x,y,z
+        int   index;        ///< first patch (leaf) or first child
+        int   numPatches;   ///< number of patches, 0 for internal nodes
+
+        bool IsLeaf() const { return numPatches > 0; }
+    };
+
+    /// \brief Constructor
+    ///
+    /// @param patchTable  A valid PatchTable, which must outlive the
+    ///                    hierarchy
+    ///
+    /// @param points      The positions of the refined vertices and local
+    ///                    points indexed by the patches
+    ///
+    /// @param stride      The number of REAL between two positions
+    ///
+    /// @param options     Options controlling the hierarchy
+    ///
+    template <typename REAL>
+    PatchBVH(PatchTable const & patchTable, REAL const * points,
+             int stride = 3, Options options = Options());
+
+    /// \brief Updates the bounds of the patches and of the nodes for new
+    ///        positions of the points
+    template <typename REAL>
+    void Refit(REAL const * points, int stride = 3);
+
+    /// \brief Returns the patches whose bounds are crossed by a ray
+    ///
+    /// @param origin     The origin of the ray
+    ///
+    /// @param direction  The direction of the ray (need not be normalized)
+    ///
+    /// @param tMax       The maximum parameter along the ray
+    ///
+    /// @param patches    The indices of the patches (see GetPatchHandle()),
+    ///                   in the order of the traversal from the nearest
+    ///                   nodes
+    ///
+    template <typename REAL>
+    void IntersectRay(REAL const origin[3], REAL const direction[3],
+                      REAL tMax, std::vector<int> & patches) const;
+
+    /// \brief Finds the closest points of the limit surface to a batch of
+    ///        query points
+    ///
+    /// The local minimum of the distance is found on each candidate patch,
+    /// from the nearest of a few samples of the patch, so a point closer than
+    /// the result may be missed on a patch folding over itself.  The patches
+    /// of the legacy Gregory types are not evaluated.
+    ///
+    /// @param points       The positions of the refined vertices and local
+    ///                     points, as given to the constructor or Refit()
+    ///
+    /// @param stride       The number of REAL between two positions
+    ///
+    /// @param queries      The positions of the queries (3 REAL each)
+    ///
+    /// @param numQueries   The number of queries
+    ///
+    /// @param results      The closest point of each query
+    ///
+    /// @param maxDistance  The maximum distance of the points searched
+    ///
+    template <typename REAL>
+    void FindClosestPoints(REAL const * points, int stride,
+                           REAL const * queries, int numQueries,
+                           ClosestPoint * results,
+                           REAL maxDistance = (REAL)FLT_MAX) const;
+
+    /// \brief Returns the number of patches
+    int GetNumPatches() const { return (int)_handles.size(); }
+
+    /// \brief Returns the handle of a patch of the table
+    Handle const & GetPatchHandle(int patch) const { return _handles[patch]; }
+
+    /// \brief Returns the bounds (min x,y,z and max x,y,z) of a patch
+    float const * GetPatchBounds(int patch) const {
+        return &_patchBounds[patch * 6];
+    }
+
+    /// \brief Returns the nodes of the hierarchy, with the root first
+    std::vector<Node> const & GetNodes() const { return _nodes; }
+
+    /// \brief Returns the patches of the leaves
+    std::vector<int> const & GetLeafPatches() const { return _leafPatches; }
+
+private:
+    template <typename REAL>
+    void computePatchBounds(REAL const * points, int stride);
+
+    template <typename REAL>
+    void findClosestPoint(REAL const * points, int stride,
+                          REAL const query[3], REAL maxDistance,
+                          ClosestPoint & result) const;
+
+    template <typename REAL>
+    REAL projectOntoPatch(int patch, REAL const * points, int stride,
+                          REAL const query[3], REAL & u, REAL & v) const;
+
+    void build(int maxLeafPatches);
+    void refitNodes();
+
+private:
+    PatchTable const & _patchTable;
+    int                _numThreads;
+
+    std::vector<Handle> _handles;      // all the patches of the table
+    std::vector<float>  _patchBounds;  // 6 per patch
+    std::vector<Node>   _nodes;
+    std::vector<int>    _leafPatches;
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_PATCH_BVH_H */
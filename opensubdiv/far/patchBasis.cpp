@@ -29,6 +29,7 @@
 #include <cstring>
 #include <cmath>
 #include <cstdio>
+#include <algorithm>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -1367,6 +1368,566 @@ EvaluatePatchBasis(int patchType, PatchParam const & param, REAL s, REAL t,
     return nPoints;
 }
 
+//
+//  Batched evaluation of a single patch at multiple locations:
+//
+//  The weights of each group of locations are computed in "structure of
+//  arrays" form so that the inner loops over the locations of the group are
+//  free of dependencies.  The bicubic B-spline, Loop box spline and Gregory
+//  triangle cases are specialized -- other patch types are evaluated one
+//  location at a time and the results scattered into the same layout.
+//
+namespace {
+    template <typename REAL>
+    void
+    adjustBSplineBoundaryWeightsBatch(int boundary, int n, int stride, REAL w[]) {
+
+        //  As with adjustBSplineBoundaryWeights() but for n locations per point:
+        if ((boundary & 1) != 0) {
+            for (int i = 0; i < 4; ++i) {
+                REAL * w0 = w + (i + 0) * stride;
+                REAL * w4 = w + (i + 4) * stride;
+                REAL * w8 = w + (i + 8) * stride;
+                for (int k = 0; k < n; ++k) {
+                    w8[k] -= w0[k];
+                    w4[k] += w0[k] * 2.0f;
+                    w0[k]  = 0.0f;
+                }
+            }
+        }
+        if ((boundary & 2) != 0) {
+            for (int i = 0; i < 16; i += 4) {
+                REAL * w1 = w + (i + 1) * stride;
+                REAL * w2 = w + (i + 2) * stride;
+                REAL * w3 = w + (i + 3) * stride;
+                for (int k = 0; k < n; ++k) {
+                    w1[k] -= w3[k];
+                    w2[k] += w3[k] * 2.0f;
+                    w3[k]  = 0.0f;
+                }
+            }
+        }
+        if ((boundary & 4) != 0) {
+            for (int i = 0; i < 4; ++i) {
+                REAL * w4  = w + (i +  4) * stride;
+                REAL * w8  = w + (i +  8) * stride;
+                REAL * w12 = w + (i + 12) * stride;
+                for (int k = 0; k < n; ++k) {
+                    w4[k]  -= w12[k];
+                    w8[k]  += w12[k] * 2.0f;
+                    w12[k]  = 0.0f;
+                }
+            }
+        }
+        if ((boundary & 8) != 0) {
+            for (int i = 0; i < 16; i += 4) {
+                REAL * w0 = w + (i + 0) * stride;
+                REAL * w1 = w + (i + 1) * stride;
+                REAL * w2 = w + (i + 2) * stride;
+                for (int k = 0; k < n; ++k) {
+                    w2[k] -= w0[k];
+                    w1[k] += w0[k] * 2.0f;
+                    w0[k]  = 0.0f;
+                }
+            }
+        }
+    }
+
+    template <typename REAL>
+    void
+    evalBSplineCurveBatch(int n, REAL const t[],
+        REAL wP[4][PATCH_BASIS_BATCH_SIZE],
+        REAL wDP[4][PATCH_BASIS_BATCH_SIZE],
+        REAL wDP2[4][PATCH_BASIS_BATCH_SIZE]) {
+
+        REAL const one6th = (REAL)(1.0 / 6.0);
+
+        for (int k = 0; k < n; ++k) {
+            REAL t1 = t[k];
+            REAL t2 = t1 * t1;
+            REAL t3 = t1 * t2;
+
+            wP[0][k] = one6th * (1.0f - 3.0f*(t1 -      t2) -      t3);
+            wP[1][k] = one6th * (4.0f            - 6.0f*t2  + 3.0f*t3);
+            wP[2][k] = one6th * (1.0f + 3.0f*(t1 +      t2  -      t3));
+            wP[3][k] = one6th * (                                  t3);
+
+            wDP[0][k] = -0.5f*t2 +      t1 - 0.5f;
+            wDP[1][k] =  1.5f*t2 - 2.0f*t1;
+            wDP[2][k] = -1.5f*t2 +      t1 + 0.5f;
+            wDP[3][k] =  0.5f*t2;
+
+            wDP2[0][k] = -       t1 + 1.0f;
+            wDP2[1][k] =  3.0f * t1 - 2.0f;
+            wDP2[2][k] = -3.0f * t1 + 1.0f;
+            wDP2[3][k] =         t1;
+        }
+    }
+
+    template <typename REAL>
+    void
+    tensorBSplineBatch(int n, int stride,
+        REAL const sW[4][PATCH_BASIS_BATCH_SIZE],
+        REAL const tW[4][PATCH_BASIS_BATCH_SIZE], REAL w[]) {
+
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                REAL * wij = w + (4*i+j) * stride;
+                for (int k = 0; k < n; ++k) {
+                    wij[k] = sW[j][k] * tW[i][k];
+                }
+            }
+        }
+    }
+
+    template <typename REAL>
+    int
+    evalBasisBSplineBatch(int boundary, int n, REAL const s[], REAL const t[],
+        int stride, REAL wP[], REAL wDs[], REAL wDt[],
+        REAL wDss[], REAL wDst[], REAL wDtt[]) {
+
+        REAL sW[4][PATCH_BASIS_BATCH_SIZE],
+             dsW[4][PATCH_BASIS_BATCH_SIZE],
+             dssW[4][PATCH_BASIS_BATCH_SIZE];
+        REAL tW[4][PATCH_BASIS_BATCH_SIZE],
+             dtW[4][PATCH_BASIS_BATCH_SIZE],
+             dttW[4][PATCH_BASIS_BATCH_SIZE];
+
+        evalBSplineCurveBatch(n, s, sW, dsW, dssW);
+        evalBSplineCurveBatch(n, t, tW, dtW, dttW);
+
+        if (wP) {
+            tensorBSplineBatch<REAL>(n, stride, sW, tW, wP);
+        }
+        if (wDs && wDt) {
+            tensorBSplineBatch<REAL>(n, stride, dsW, tW, wDs);
+            tensorBSplineBatch<REAL>(n, stride, sW, dtW, wDt);
+
+            if (wDss && wDst && wDtt) {
+                tensorBSplineBatch<REAL>(n, stride, dssW, tW, wDss);
+                tensorBSplineBatch<REAL>(n, stride, dsW, dtW, wDst);
+                tensorBSplineBatch<REAL>(n, stride, sW, dttW, wDtt);
+            }
+        }
+
+        if (boundary) {
+            bool hasD1 = wDs && wDt;
+            bool hasD2 = hasD1 && wDss && wDst && wDtt;
+
+            if (wP) adjustBSplineBoundaryWeightsBatch(boundary, n, stride, wP);
+            if (hasD1) {
+                adjustBSplineBoundaryWeightsBatch(boundary, n, stride, wDs);
+                adjustBSplineBoundaryWeightsBatch(boundary, n, stride, wDt);
+            }
+            if (hasD2) {
+                adjustBSplineBoundaryWeightsBatch(boundary, n, stride, wDss);
+                adjustBSplineBoundaryWeightsBatch(boundary, n, stride, wDst);
+                adjustBSplineBoundaryWeightsBatch(boundary, n, stride, wDtt);
+            }
+        }
+        return 16;
+    }
+
+    //
+    //  The triangular bases are evaluated over a group as the product of a
+    //  matrix of coefficients with the quartic monomials M(s,t), or their
+    //  derivatives, at each location.  With the exponents of s and t of the
+    //  15 monomials:
+    //
+    int const quarticMonomialExponents[15][2] = {
+        { 0, 0 },
+        { 1, 0 }, { 0, 1 },
+        { 2, 0 }, { 1, 1 }, { 0, 2 },
+        { 3, 0 }, { 2, 1 }, { 1, 2 }, { 0, 3 },
+        { 4, 0 }, { 3, 1 }, { 2, 2 }, { 1, 3 }, { 0, 4 } };
+
+    //
+    //  The 12 x 15 matrix C of the Loop box spline (see above), scaled by a
+    //  common factor of 1/12:
+    //
+    int const boxSplineTriCoefficients[12][15] = {
+        { 1, -2,-4,    0,  6,  6,   2,  0, -6, -4,  -1, -2, 0,  2,  1 },
+        { 1,  2,-2,    0, -6,  0,  -4,  0,  6,  2,   2,  4, 0, -2, -1 },
+        { 0,  0, 0,    0,  0,  0,   2,  0,  0,  0,  -1, -2, 0,  0,  0 },
+        { 1, -4,-2,    6,  6,  0,  -4, -6,  0,  2,   1,  2, 0, -2, -1 },
+        { 6,  0, 0,  -12,-12,-12,   8, 12, 12,  8,  -1, -2, 0, -2, -1 },
+        { 1,  4, 2,    6,  6,  0,  -4, -6,-12, -4,  -1, -2, 0,  4,  2 },
+        { 0,  0, 0,    0,  0,  0,   0,  0,  0,  0,   1,  2, 0,  0,  0 },
+        { 1, -2, 2,    0, -6,  0,   2,  6,  0, -4,  -1, -2, 0,  4,  2 },
+        { 1,  2, 4,    0,  6,  6,  -4,-12, -6, -4,   2,  4, 0, -2, -1 },
+        { 0,  0, 0,    0,  0,  0,   2,  6,  6,  2,  -1, -2, 0, -2, -1 },
+        { 0,  0, 0,    0,  0,  0,   0,  0,  0,  2,   0,  0, 0, -2, -1 },
+        { 0,  0, 0,    0,  0,  0,   0,  0,  0,  0,   0,  0, 0,  2,  1 } };
+
+    //
+    //  The 15 x 15 matrix of the quartic Bezier triangle, i.e. the expansion
+    //  of the basis functions B(u,v,w) above with u = s, v = t, w = 1 - s - t:
+    //
+    int const bezierTriCoefficients[15][15] = {
+        { 1, -4,-4,    6, 12,  6,  -4,-12,-12, -4,   1,  4,  6,  4,  1 },
+        { 0,  4, 0,  -12,-12,  0,  12, 24, 12,  0,  -4,-12,-12, -4,  0 },
+        { 0,  0, 0,    6,  0,  0, -12,-12,  0,  0,   6, 12,  6,  0,  0 },
+        { 0,  0, 0,    0,  0,  0,   4,  0,  0,  0,  -4, -4,  0,  0,  0 },
+        { 0,  0, 0,    0,  0,  0,   0,  0,  0,  0,   1,  0,  0,  0,  0 },
+        { 0,  0, 4,    0,-12,-12,   0, 12, 24, 12,   0, -4,-12,-12, -4 },
+        { 0,  0, 0,    0, 12,  0,   0,-24,-24,  0,   0, 12, 24, 12,  0 },
+        { 0,  0, 0,    0,  0,  0,   0, 12,  0,  0,   0,-12,-12,  0,  0 },
+        { 0,  0, 0,    0,  0,  0,   0,  0,  0,  0,   0,  4,  0,  0,  0 },
+        { 0,  0, 0,    0,  0,  6,   0,  0,-12,-12,   0,  0,  6, 12,  6 },
+        { 0,  0, 0,    0,  0,  0,   0,  0, 12,  0,   0,  0,-12,-12,  0 },
+        { 0,  0, 0,    0,  0,  0,   0,  0,  0,  0,   0,  0,  6,  0,  0 },
+        { 0,  0, 0,    0,  0,  0,   0,  0,  0,  4,   0,  0,  0, -4, -4 },
+        { 0,  0, 0,    0,  0,  0,   0,  0,  0,  0,   0,  0,  0,  4,  0 },
+        { 0,  0, 0,    0,  0,  0,   0,  0,  0,  0,   0,  0,  0,  0,  1 } };
+
+    //
+    //  The boundary adjustments of the box spline are linear, so they are
+    //  applied once to the columns of its matrix rather than to the weights
+    //  of every location:
+    //
+    template <typename REAL>
+    void
+    initBoxSplineTriCoefficients(int boundaryMask, REAL C[15][15]) {
+
+        REAL const scale = (REAL) (1.0 / 12.0);
+
+        for (int m = 0; m < 15; ++m) {
+            REAL column[12];
+            for (int j = 0; j < 12; ++j) {
+                column[j] = scale * (REAL) boxSplineTriCoefficients[j][m];
+            }
+            adjustBoxSplineTriBoundaryWeights(boundaryMask, column);
+
+            for (int j = 0; j < 12; ++j) {
+                C[j][m] = column[j];
+            }
+        }
+    }
+
+    template <typename REAL>
+    void
+    initBezierTriCoefficients(REAL C[15][15]) {
+
+        for (int j = 0; j < 15; ++j) {
+            for (int m = 0; m < 15; ++m) {
+                C[j][m] = (REAL) bezierTriCoefficients[j][m];
+            }
+        }
+    }
+
+    //
+    //  Weights of the (ds,dt) derivative of the basis with matrix C for a
+    //  group of n locations -- the derivatives of the monomials are products
+    //  of the derivatives of the powers of s and t:
+    //
+    template <typename REAL>
+    void
+    evalTriDerivWeightsBatch(int nPoints, REAL const C[15][15],
+        int n, REAL const s[], REAL const t[], int ds, int dt,
+        int stride, REAL w[]) {
+
+        REAL sD[5][PATCH_BASIS_BATCH_SIZE],
+             tD[5][PATCH_BASIS_BATCH_SIZE];
+
+        for (int a = 0; a < 5; ++a) {
+            //  Coefficient of the power (a - d) in the d-th derivative of x^a:
+            REAL sCoeff = (REAL) ((a < ds) ? 0 : ((ds == 2) ? a * (a-1) :
+                                                 ((ds == 1) ? a : 1)));
+            REAL tCoeff = (REAL) ((a < dt) ? 0 : ((dt == 2) ? a * (a-1) :
+                                                 ((dt == 1) ? a : 1)));
+            for (int k = 0; k < n; ++k) {
+                sD[a][k] = sCoeff;
+                tD[a][k] = tCoeff;
+            }
+            for (int p = 0; p < a - ds; ++p) {
+                for (int k = 0; k < n; ++k) sD[a][k] *= s[k];
+            }
+            for (int p = 0; p < a - dt; ++p) {
+                for (int k = 0; k < n; ++k) tD[a][k] *= t[k];
+            }
+        }
+
+        REAL M[15][PATCH_BASIS_BATCH_SIZE];
+        for (int m = 0; m < 15; ++m) {
+            REAL const * sDm = sD[quarticMonomialExponents[m][0]];
+            REAL const * tDm = tD[quarticMonomialExponents[m][1]];
+            for (int k = 0; k < n; ++k) {
+                M[m][k] = sDm[k] * tDm[k];
+            }
+        }
+
+        for (int j = 0; j < nPoints; ++j) {
+            REAL * wj = w + j * stride;
+            for (int k = 0; k < n; ++k) {
+                wj[k] = 0.0f;
+            }
+
+            //  Terms of order less than the derivative vanish:
+            for (int m = (ds + dt == 2) ? 3 : ((ds + dt == 1) ? 1 : 0);
+                     m < 15; ++m) {
+                REAL c = C[j][m];
+                if (c == 0.0f) continue;
+
+                REAL const * Mm = M[m];
+                for (int k = 0; k < n; ++k) {
+                    wj[k] += c * Mm[k];
+                }
+            }
+        }
+    }
+
+    template <typename REAL>
+    int
+    evalBasisBoxSplineTriBatch(REAL const C[15][15],
+        int n, REAL const s[], REAL const t[],
+        int stride, REAL wP[], REAL wDs[], REAL wDt[],
+        REAL wDss[], REAL wDst[], REAL wDtt[]) {
+
+        if (wP) {
+            evalTriDerivWeightsBatch(12, C, n, s, t, 0, 0, stride, wP);
+        }
+        if (wDs && wDt) {
+            evalTriDerivWeightsBatch(12, C, n, s, t, 1, 0, stride, wDs);
+            evalTriDerivWeightsBatch(12, C, n, s, t, 0, 1, stride, wDt);
+
+            if (wDss && wDst && wDtt) {
+                evalTriDerivWeightsBatch(12, C, n, s, t, 2, 0, stride, wDss);
+                evalTriDerivWeightsBatch(12, C, n, s, t, 1, 1, stride, wDst);
+                evalTriDerivWeightsBatch(12, C, n, s, t, 0, 2, stride, wDtt);
+            }
+        }
+        return 12;
+    }
+
+    //
+    //  As with convertBezierWeightsToGregory() but for a group of locations,
+    //  each with its own rational weights:
+    //
+    template <typename REAL>
+    void
+    convertBezierWeightsToGregoryBatch(int n,
+        REAL const wB[15][PATCH_BASIS_BATCH_SIZE],
+        REAL const rG[6][PATCH_BASIS_BATCH_SIZE], int stride, REAL wG[]) {
+
+        //  Bezier point of each Gregory point and its rational weight (if any):
+        static int const bezierPoint[18] = {  0,  1,  5,  6,  6,
+                                              4,  8,  3,  7,  7,
+                                             14, 12, 13, 10, 10,
+                                              2, 11,  9 };
+        static int const rationalWeight[18] = { -1, -1, -1,  0,  1,
+                                                -1, -1, -1,  2,  3,
+                                                -1, -1, -1,  4,  5,
+                                                -1, -1, -1 };
+
+        for (int j = 0; j < 18; ++j) {
+            REAL       * wGj = wG + j * stride;
+            REAL const * wBj = wB[bezierPoint[j]];
+
+            if (rationalWeight[j] < 0) {
+                for (int k = 0; k < n; ++k) {
+                    wGj[k] = wBj[k];
+                }
+            } else {
+                REAL const * rGj = rG[rationalWeight[j]];
+                for (int k = 0; k < n; ++k) {
+                    wGj[k] = wBj[k] * rGj[k];
+                }
+            }
+        }
+    }
+
+    template <typename REAL>
+    int
+    evalBasisGregoryTriBatch(REAL const C[15][15],
+        int n, REAL const s[], REAL const t[],
+        int stride, REAL wP[], REAL wDs[], REAL wDt[],
+        REAL wDss[], REAL wDst[], REAL wDtt[]) {
+
+        REAL G[6][PATCH_BASIS_BATCH_SIZE];
+        for (int k = 0; k < n; ++k) {
+            REAL u = s[k];
+            REAL v = t[k];
+            REAL w = 1 - u - v;
+
+            G[0][k] = ((u + v) > 0) ? (u / (u + v)) : 1.0f;
+            G[1][k] = ((u + v) > 0) ? (v / (u + v)) : 0.0f;
+            G[2][k] = ((v + w) > 0) ? (v / (v + w)) : 1.0f;
+            G[3][k] = ((v + w) > 0) ? (w / (v + w)) : 0.0f;
+            G[4][k] = ((w + u) > 0) ? (w / (w + u)) : 1.0f;
+            G[5][k] = ((w + u) > 0) ? (u / (w + u)) : 0.0f;
+        }
+
+        //  Derivatives use the same rational weights as EvalBasisGregoryTri():
+        REAL B[15][PATCH_BASIS_BATCH_SIZE];
+
+        REAL * const wG[6] = { wP, wDs, wDt, wDss, wDst, wDtt };
+        int const dS[6] = { 0, 1, 0, 2, 1, 0 };
+        int const dT[6] = { 0, 0, 1, 0, 1, 2 };
+
+        bool hasD1 = wDs && wDt;
+        bool hasD2 = hasD1 && wDss && wDst && wDtt;
+
+        for (int i = 0; i < 6; ++i) {
+            if ((i == 0) ? !wP : ((i < 3) ? !hasD1 : !hasD2)) continue;
+
+            evalTriDerivWeightsBatch(15, C, n, s, t, dS[i], dT[i],
+                PATCH_BASIS_BATCH_SIZE, B[0]);
+            convertBezierWeightsToGregoryBatch(n, B, G, stride, wG[i]);
+        }
+        return 18;
+    }
+
+    template <typename REAL>
+    inline void
+    scatterBasisWeights(int nPoints, REAL const src[], int stride, REAL dst[]) {
+        if (dst) {
+            for (int j = 0; j < nPoints; ++j) {
+                dst[j * stride] = src[j];
+            }
+        }
+    }
+} // end namespace
+
+template <typename REAL>
+int
+EvaluatePatchBasisBatch(int patchType, PatchParam const & param,
+    int count, REAL const s[], REAL const t[],
+    REAL wP[], REAL wDs[], REAL wDt[],
+    REAL wDss[], REAL wDst[], REAL wDtt[]) {
+
+    bool isTriangle = (patchType == PatchDescriptor::LOOP) ||
+                      (patchType == PatchDescriptor::GREGORY_TRIANGLE) ||
+                      (patchType == PatchDescriptor::TRIANGLES);
+
+    REAL derivSign = (isTriangle && param.IsTriangleRotated()) ? -1.0f : 1.0f;
+
+    bool hasD1 = wDs && wDt;
+    bool hasD2 = hasD1 && wDss && wDst && wDtt;
+
+    REAL triC[15][15];
+    if (patchType == PatchDescriptor::LOOP) {
+        initBoxSplineTriCoefficients(param.GetBoundary(), triC);
+    } else if (patchType == PatchDescriptor::GREGORY_TRIANGLE) {
+        initBezierTriCoefficients(triC);
+    }
+
+    int nPoints = 0;
+    for (int k0 = 0; k0 < count; k0 += PATCH_BASIS_BATCH_SIZE) {
+        int n = std::min(PATCH_BASIS_BATCH_SIZE, count - k0);
+
+        REAL u[PATCH_BASIS_BATCH_SIZE], v[PATCH_BASIS_BATCH_SIZE];
+        for (int k = 0; k < n; ++k) {
+            u[k] = s[k0 + k];
+            v[k] = t[k0 + k];
+            if (isTriangle) {
+                param.NormalizeTriangle(u[k], v[k]);
+            } else {
+                param.Normalize(u[k], v[k]);
+            }
+        }
+
+        if (patchType == PatchDescriptor::REGULAR) {
+            nPoints = evalBasisBSplineBatch(param.GetBoundary(), n, u, v, count,
+                wP ? wP + k0 : 0,
+                hasD1 ? wDs + k0 : 0, hasD1 ? wDt + k0 : 0,
+                hasD2 ? wDss + k0 : 0, hasD2 ? wDst + k0 : 0,
+                hasD2 ? wDtt + k0 : 0);
+            continue;
+        }
+        if (patchType == PatchDescriptor::LOOP) {
+            nPoints = evalBasisBoxSplineTriBatch(triC, n, u, v, count,
+                wP ? wP + k0 : 0,
+                hasD1 ? wDs + k0 : 0, hasD1 ? wDt + k0 : 0,
+                hasD2 ? wDss + k0 : 0, hasD2 ? wDst + k0 : 0,
+                hasD2 ? wDtt + k0 : 0);
+            continue;
+        }
+        if (patchType == PatchDescriptor::GREGORY_TRIANGLE) {
+            nPoints = evalBasisGregoryTriBatch(triC, n, u, v, count,
+                wP ? wP + k0 : 0,
+                hasD1 ? wDs + k0 : 0, hasD1 ? wDt + k0 : 0,
+                hasD2 ? wDss + k0 : 0, hasD2 ? wDst + k0 : 0,
+                hasD2 ? wDtt + k0 : 0);
+            continue;
+        }
+
+        //  Maximum number of points of all patch types (Gregory):
+        REAL bP[20], bDs[20], bDt[20], bDss[20], bDst[20], bDtt[20];
+
+        for (int k = 0; k < n; ++k) {
+            nPoints = EvaluatePatchBasisNormalized(patchType, param, u[k], v[k],
+                wP ? bP : 0, hasD1 ? bDs : 0, hasD1 ? bDt : 0,
+                hasD2 ? bDss : 0, hasD2 ? bDst : 0, hasD2 ? bDtt : 0);
+
+            REAL * const wK[6] = { wP ? wP + k0 + k : 0,
+                hasD1 ? wDs + k0 + k : 0, hasD1 ? wDt + k0 + k : 0,
+                hasD2 ? wDss + k0 + k : 0, hasD2 ? wDst + k0 + k : 0,
+                hasD2 ? wDtt + k0 + k : 0 };
+            REAL const * const bK[6] = { bP, bDs, bDt, bDss, bDst, bDtt };
+
+            for (int i = 0; i < 6; ++i) {
+                scatterBasisWeights(nPoints, bK[i], count, wK[i]);
+            }
+        }
+    }
+
+    if (hasD1) {
+        REAL d1Scale = derivSign * (REAL)(1 << param.GetDepth());
+
+        int nWeights = nPoints * count;
+        for (int i = 0; i < nWeights; ++i) {
+            wDs[i] *= d1Scale;
+            wDt[i] *= d1Scale;
+        }
+
+        if (hasD2) {
+            REAL d2Scale = derivSign * d1Scale * d1Scale;
+
+            for (int i = 0; i < nWeights; ++i) {
+                wDss[i] *= d2Scale;
+                wDst[i] *= d2Scale;
+                wDtt[i] *= d2Scale;
+            }
+        }
+    }
+    return nPoints;
+}
+
+template <typename REAL>
+int
+GetPatchBoundaryPointWeights(int patchType, PatchParam const & param,
+    REAL w[]) {
+
+    int boundaryMask = param.GetBoundary();
+    if (boundaryMask == 0) return 0;
+
+    int nPoints = 0;
+    if (patchType == PatchDescriptor::REGULAR) {
+        nPoints = 16;
+    } else if (patchType == PatchDescriptor::LOOP) {
+        nPoints = 12;
+    } else {
+        return 0;
+    }
+
+    //
+    //  The boundary adjustments are linear in the weights, so the effective
+    //  point j is the combination the adjustment makes of a unit weight j:
+    //
+    for (int j = 0; j < nPoints; ++j) {
+        REAL * wj = w + j * nPoints;
+        for (int i = 0; i < nPoints; ++i) {
+            wj[i] = (i == j) ? 1.0f : 0.0f;
+        }
+        if (nPoints == 16) {
+            adjustBSplineBoundaryWeights(boundaryMask, wj);
+        } else {
+            adjustBoxSplineTriBoundaryWeights(boundaryMask, wj);
+        }
+    }
+    return nPoints;
+}
+
 //
 //  Explicit float and double instantiations:
 //
@@ -1374,11 +1935,21 @@ template int EvaluatePatchBasisNormalized<float>(int patchType, PatchParam const
     float s, float t, float wP[], float wDs[], float wDt[], float wDss[], float wDst[], float wDtt[]);
 template int EvaluatePatchBasis<float>(int patchType, PatchParam const & param,
     float s, float t, float wP[], float wDs[], float wDt[], float wDss[], float wDst[], float wDtt[]);
+template int EvaluatePatchBasisBatch<float>(int patchType, PatchParam const & param,
+    int count, float const s[], float const t[],
+    float wP[], float wDs[], float wDt[], float wDss[], float wDst[], float wDtt[]);
+template int GetPatchBoundaryPointWeights<float>(int patchType,
+    PatchParam const & param, float w[]);
 
 template int EvaluatePatchBasisNormalized<double>(int patchType, PatchParam const & param,
     double s, double t, double wP[], double wDs[], double wDt[], double wDss[], double wDst[], double wDtt[]);
 template int EvaluatePatchBasis<double>(int patchType, PatchParam const & param,
     double s, double t, double wP[], double wDs[], double wDt[], double wDss[], double wDst[], double wDtt[]);
+template int EvaluatePatchBasisBatch<double>(int patchType, PatchParam const & param,
+    int count, double const s[], double const t[],
+    double wP[], double wDs[], double wDt[], double wDss[], double wDst[], double wDtt[]);
+template int GetPatchBoundaryPointWeights<double>(int patchType,
+    PatchParam const & param, double w[]);
 
 //
 //   Most basis evaluation functions are implicitly instantiated above -- Bezier
@@ -98,6 +98,36 @@ template <typename REAL>
 int EvaluatePatchBasis(int patchType, PatchParam const & param, REAL s, REAL t,
     REAL wP[], REAL wDs[] = 0, REAL wDt[] = 0, REAL wDss[] = 0, REAL wDst[] = 0, REAL wDtt[] = 0);
 
+//
+// Batched basis evaluation of a single patch at multiple (s,t) locations:
+//
+// Weights are returned as a "structure of arrays", i.e. the weight for point
+// j at location k is stored in w[j * count + k], so that arrays of weights
+// can be accumulated across all locations with unit stride.  Locations are
+// processed internally in groups of PATCH_BASIS_BATCH_SIZE and the bicubic
+// B-spline, Loop and Gregory triangle cases are evaluated over each group
+// directly.
+//
+static const int PATCH_BASIS_BATCH_SIZE = 16;
+
+template <typename REAL>
+int EvaluatePatchBasisBatch(int patchType, PatchParam const & param,
+    int count, REAL const s[], REAL const t[],
+    REAL wP[], REAL wDs[] = 0, REAL wDt[] = 0, REAL wDss[] = 0, REAL wDst[] = 0, REAL wDtt[] = 0);
+
+
+//
+// Weights of the effective control points of a boundary patch, for which the
+// phantom points beyond its boundaries are extrapolated from its other
+// points: the weight of point i in effective point j is stored in
+// w[j * nPoints + i] (up to 16 x 16 weights).  Since the unadjusted bases are
+// non-negative and sum to one, the limit surface of the patch lies within
+// the convex hull of its effective points.  Returns the number of points or
+// 0 if the patch has no boundary adjustments:
+//
+template <typename REAL>
+int GetPatchBoundaryPointWeights(int patchType, PatchParam const & param,
+    REAL w[]);
 
 } // end namespace internal
 } // end namespace Far
@@ -31,8 +31,11 @@
 #include "../vtr/refinement.h"
 #include "../vtr/stackBuffer.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -1150,6 +1153,31 @@ PatchBuilder::assembleIrregularSourcePatch(
 }
 
 
+int
+PatchBuilder::GetIrregularPatchValenceDeviation(int levelIndex,
+        Index faceIndex, Level::VSpan const cornerSpans[]) const {
+
+    SourcePatch sourcePatch;
+    assembleIrregularSourcePatch(
+            levelIndex, faceIndex, cornerSpans, sourcePatch);
+
+    int regValence = (_schemeRegFaceSize == 4) ? 4 : 6;
+
+    int maxDeviation = 0;
+    for (int i = 0; i < sourcePatch._numCorners; ++i) {
+        SourcePatch::Corner const & corner = sourcePatch._corners[i];
+
+        int numFaces = corner._numFaces;
+        if (corner._dart || (corner._sharp && (numFaces > 1))) return -1;
+
+        int regNumFaces = corner._sharp    ? 1
+                        : corner._boundary ? (regValence / 2)
+                        :                    regValence;
+        maxDeviation = std::max(maxDeviation, std::abs(numFaces - regNumFaces));
+    }
+    return maxDeviation;
+}
+
 //
 //  Gather patch points from around the face of a level given a previously
 //  initialized SourcePatch.  This is historically specific to an irregular
@@ -1231,23 +1259,143 @@ PatchBuilder::GetIrregularPatchSourcePoints(
         cornerSpans, sourcePatch, sourcePoints, fvarChannel);
 }
 
+//
+//  The key identifying the topology of a SourcePatch includes all members
+//  of its Corners -- from which all other members are derived:
+//
+PatchBuilder::SourcePatchKey::SourcePatchKey(SourcePatch const & sourcePatch,
+                                             PatchDescriptor::Type patchType) {
+
+    std::memset(_data, 0, sizeof(_data));
+
+    _data[0] = (unsigned short) sourcePatch._numCorners;
+    for (int i = 0; i < sourcePatch._numCorners; ++i) {
+        SourcePatch::Corner const & corner = sourcePatch._corners[i];
+
+        unsigned short * cornerData = &_data[1 + 3 * i];
+
+        cornerData[0] = corner._numFaces;
+        cornerData[1] = corner._patchFace;
+        cornerData[2] = (unsigned short) ((corner._boundary       << 0) |
+                                          (corner._sharp          << 1) |
+                                          (corner._dart           << 2) |
+                                          (corner._sharesWithPrev << 3) |
+                                          (corner._sharesWithNext << 4) |
+                                          (corner._val2Interior   << 5) |
+                                          (corner._val2Adjacent   << 6));
+    }
+    _data[13] = (unsigned short) patchType;
+}
+
+bool
+PatchBuilder::SourcePatchKey::operator<(SourcePatchKey const & other) const {
+
+    return std::memcmp(_data, other._data, sizeof(_data)) < 0;
+}
+
 //
 //  Template conversion methods for the matrix type -- explicit instantiation
 //  for float and double is required and follows the definition:
 //
 template <typename REAL>
-int
-PatchBuilder::GetIrregularPatchConversionMatrix(
+SparseMatrix<REAL> const &
+PatchBuilder::AcquireIrregularPatchConversionMatrix(
         int levelIndex, Index faceIndex,
         Level::VSpan const cornerSpans[],
-        SparseMatrix<REAL> & conversionMatrix) const {
+        SparseMatrix<REAL> & scratchMatrix) const {
+
+    return AcquireIrregularPatchConversionMatrix(levelIndex, faceIndex,
+            cornerSpans, GetIrregularPatchType(), scratchMatrix);
+}
+template SparseMatrix<float> const &
+PatchBuilder::AcquireIrregularPatchConversionMatrix<float>(
+        int levelIndex, Index faceIndex, Level::VSpan const cornerSpans[],
+        SparseMatrix<float> & scratchMatrix) const;
+template SparseMatrix<double> const &
+PatchBuilder::AcquireIrregularPatchConversionMatrix<double>(
+        int levelIndex, Index faceIndex, Level::VSpan const cornerSpans[],
+        SparseMatrix<double> & scratchMatrix) const;
+
+template <typename REAL>
+SparseMatrix<REAL> const &
+PatchBuilder::AcquireIrregularPatchConversionMatrix(
+        int levelIndex, Index faceIndex,
+        Level::VSpan const cornerSpans[],
+        PatchDescriptor::Type patchType,
+        SparseMatrix<REAL> & scratchMatrix) const {
 
     SourcePatch sourcePatch;
     assembleIrregularSourcePatch(
             levelIndex, faceIndex, cornerSpans, sourcePatch);
 
-    return convertToPatchType(
-        sourcePatch, GetIrregularPatchType(), conversionMatrix);
+    if (!_options.cacheConversionMatrices) {
+        convertToPatchType(sourcePatch, patchType, scratchMatrix);
+        return scratchMatrix;
+    }
+
+    //
+    //  The conversion depends only on the SourcePatch, so return a matrix
+    //  previously computed for the same topology when available -- adding
+    //  the result of the conversion to the cache otherwise.  Entries of the
+    //  map are never modified once assigned and references to them remain
+    //  valid as others are added:
+    //
+    typedef std::map<SourcePatchKey, SparseMatrix<REAL> > MatrixCache;
+
+    MatrixCache & cache = getConversionCache(scratchMatrix);
+    SourcePatchKey key(sourcePatch, patchType);
+
+    SparseMatrix<REAL> const * cachedMatrix = 0;
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp critical (FarPatchBuilderCache)
+#endif
+    {
+        typename MatrixCache::const_iterator it = cache.find(key);
+        if (it != cache.end()) {
+            cachedMatrix = &it->second;
+        }
+    }
+    if (cachedMatrix) {
+        return *cachedMatrix;
+    }
+
+    convertToPatchType(sourcePatch, patchType, scratchMatrix);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp critical (FarPatchBuilderCache)
+#endif
+    {
+        SparseMatrix<REAL> & newMatrix = cache[key];
+        if (newMatrix.GetNumRows() == 0) {
+            newMatrix.Copy(scratchMatrix);
+        }
+    }
+    return scratchMatrix;
+}
+template SparseMatrix<float> const &
+PatchBuilder::AcquireIrregularPatchConversionMatrix<float>(
+        int levelIndex, Index faceIndex, Level::VSpan const cornerSpans[],
+        PatchDescriptor::Type patchType,
+        SparseMatrix<float> & scratchMatrix) const;
+template SparseMatrix<double> const &
+PatchBuilder::AcquireIrregularPatchConversionMatrix<double>(
+        int levelIndex, Index faceIndex, Level::VSpan const cornerSpans[],
+        PatchDescriptor::Type patchType,
+        SparseMatrix<double> & scratchMatrix) const;
+
+template <typename REAL>
+int
+PatchBuilder::GetIrregularPatchConversionMatrix(
+        int levelIndex, Index faceIndex,
+        Level::VSpan const cornerSpans[],
+        SparseMatrix<REAL> & conversionMatrix) const {
+
+    SparseMatrix<REAL> const & matrix = AcquireIrregularPatchConversionMatrix(
+            levelIndex, faceIndex, cornerSpans, conversionMatrix);
+    if (&matrix != &conversionMatrix) {
+        conversionMatrix.Copy(matrix);
+    }
+    return conversionMatrix.GetNumRows();
 }
 template int PatchBuilder::GetIrregularPatchConversionMatrix<float>(
         int levelIndex, Index faceIndex, Level::VSpan const cornerSpans[],
@@ -1269,6 +1417,18 @@ PatchBuilder::IsRegularSingleCreasePatch(int levelIndex, Index faceIndex,
                 &creaseInfo.creaseSharpness, &creaseInfo.creaseEdgeInFace);
 }   
 
+bool
+PatchBuilder::IsRegularDoubleCreasePatch(int levelIndex, Index faceIndex,
+        DoubleCreaseInfo & creaseInfo) const {
+
+    if (_schemeRegFaceSize != 4) return false;
+
+    Level const & level = _refiner.getLevel(levelIndex);
+
+    return level.isDoubleCreasePatch(faceIndex,
+                creaseInfo.creaseSharpness, &creaseInfo.creaseEdgeInFace);
+}
+
 PatchParam
 PatchBuilder::ComputePatchParam(int levelIndex, Index faceIndex,
         PtexIndices const& ptexIndices, bool isRegular,
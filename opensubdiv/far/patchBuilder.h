@@ -35,6 +35,8 @@
 #include "../far/ptexIndices.h"
 #include "../far/sparseMatrix.h"
 
+#include <map>
+
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -169,20 +171,28 @@ public:
     //  Required Options specify a patch basis to use for both regular and
     //  irregular patches -- sparing the client the need to repeatedly
     //  specify these for each face considered.  Other options are included
-    //  to support legacy approximations:
+    //  to support legacy approximations.
+    //
+    //  Conversion matrices for irregular patches depend only on the local
+    //  topology of the patch, so they can optionally be cached and reused
+    //  for all patches sharing that topology.  The cache is mutated by the
+    //  (const) conversion methods and is only protected when concurrency
+    //  is provided by OpenMP:
     //
     struct Options {
         Options() : regBasisType(BASIS_UNSPECIFIED),
                     irregBasisType(BASIS_UNSPECIFIED),
                     fillMissingBoundaryPoints(false),
                     approxInfSharpWithSmooth(false),
-                    approxSmoothCornerWithSharp(false) { }
+                    approxSmoothCornerWithSharp(false),
+                    cacheConversionMatrices(false) { }
 
         BasisType regBasisType;
         BasisType irregBasisType;
         bool      fillMissingBoundaryPoints;
         bool      approxInfSharpWithSmooth;
         bool      approxSmoothCornerWithSharp;
+        bool      cacheConversionMatrices;
     };
 
 public:
@@ -224,6 +234,13 @@ public:
     void GetIrregularPatchCornerSpans(int level, Index face,
             Vtr::internal::Level::VSpan cornerSpans[4], int fvc = -1) const;
 
+    //  Largest difference of the valence of the corners of an irregular patch
+    //  from that of a regular corner, as a measure of how closely a patch of
+    //  the regular basis approximates it (or -1 if a corner is a dart or an
+    //  irregular sharp corner, i.e. a feature to be preserved):
+    int GetIrregularPatchValenceDeviation(int level, Index face,
+            Vtr::internal::Level::VSpan const cornerSpans[]) const;
+
     bool DoesFaceVaryingPatchMatch(int level, Index face, int fvc) const {
         return _refiner.getLevel(level).doesFaceFVarTopologyMatch(face, fvc);
     }
@@ -242,6 +259,24 @@ public:
             Vtr::internal::Level::VSpan const cornerSpans[],
             SparseMatrix<REAL> &              matrix) const;
 
+    //  Variant of the above avoiding a copy of a cached matrix (see Options):
+    //  the matrix returned is either that in the cache (which remains valid
+    //  for the life of the PatchBuilder) or the given matrix once assigned
+    template <typename REAL>
+    SparseMatrix<REAL> const & AcquireIrregularPatchConversionMatrix(
+            int level, Index face,
+            Vtr::internal::Level::VSpan const cornerSpans[],
+            SparseMatrix<REAL> &              scratchMatrix) const;
+
+    //  Variant of the above converting to a given patch type rather than the
+    //  irregular patch type of the Options:
+    template <typename REAL>
+    SparseMatrix<REAL> const & AcquireIrregularPatchConversionMatrix(
+            int level, Index face,
+            Vtr::internal::Level::VSpan const cornerSpans[],
+            PatchDescriptor::Type             patchType,
+            SparseMatrix<REAL> &              scratchMatrix) const;
+
     int GetIrregularPatchSourcePoints(int level, Index face,
             Vtr::internal::Level::VSpan const cornerSpans[],
             Index                             sourcePoints[],
@@ -257,6 +292,18 @@ public:
     bool IsRegularSingleCreasePatch(int level, Index face,
             SingleCreaseInfo & info) const;
 
+    //
+    //  Queries related to "double-crease" patches -- regular interior patches
+    //  between two parallel semi-sharp creases along opposite edges (the
+    //  edge given and the one opposite it):
+    //
+    struct DoubleCreaseInfo {
+        int   creaseEdgeInFace;
+        float creaseSharpness[2];
+    };
+    bool IsRegularDoubleCreasePatch(int level, Index face,
+            DoubleCreaseInfo & info) const;
+
     //
     //  Computing the PatchParam -- note the regrettable dependency on
     //  PtexIndices but PatchParam is essentially tied to it indefinitely.
@@ -294,6 +341,26 @@ protected:
             SourcePatch &  sourcePatch,
             Index patchPoints[], int fvc) const;
 
+    //  Conversion matrices cached by the topology of their SourcePatch and
+    //  the patch type converted to:
+    struct SourcePatchKey {
+        SourcePatchKey(SourcePatch const & sourcePatch,
+                       PatchDescriptor::Type patchType);
+
+        bool operator<(SourcePatchKey const & other) const;
+
+        unsigned short _data[14];
+    };
+    typedef std::map<SourcePatchKey, SparseMatrix<float> >  FloatMatrixCache;
+    typedef std::map<SourcePatchKey, SparseMatrix<double> > DoubleMatrixCache;
+
+    FloatMatrixCache &  getConversionCache(SparseMatrix<float> const &) const {
+        return _floatConversionCache;
+    }
+    DoubleMatrixCache & getConversionCache(SparseMatrix<double> const &) const {
+        return _doubleConversionCache;
+    }
+
 protected:
     //
     //  Virtual methods to be provided by subclass for each scheme:
@@ -320,6 +387,9 @@ protected:
     PatchDescriptor::Type _irregPatchType;
     PatchDescriptor::Type _nativePatchType;
     PatchDescriptor::Type _linearPatchType;
+
+    mutable FloatMatrixCache  _floatConversionCache;
+    mutable DoubleMatrixCache _doubleConversionCache;
 };
 
 } // end namespace Far
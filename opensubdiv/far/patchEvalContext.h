@@ -0,0 +1,215 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_PATCH_EVAL_CONTEXT_H
+#define OPENSUBDIV3_FAR_PATCH_EVAL_CONTEXT_H
+
+#include "../version.h"
+
+#include "../far/patchMap.h"
+#include "../far/patchTable.h"
+
+#include <cassert>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief Per-thread state for concurrent limit queries of a shared PatchTable
+///
+/// The const query methods of PatchTable (e.g. EvaluateBasis()) and PatchMap
+/// (e.g. FindPatch()) modify no state and allocate no memory, so any number
+/// of threads may call them concurrently on the same table and map.  What
+/// they need in addition -- the arrays of weights and the patch found -- is
+/// held by a PatchEvalContext, which each thread owns:
+///
+/// \code
+///     // once per thread:
+///     Far::PatchEvalContext context(patchTable, patchMap);
+///
+///     // per query:
+///     if (context.Evaluate(face, u, v, 1)) {
+///         Far::ConstIndexArray cvs = context.GetPatchVertices();
+///         float const * wP  = context.GetWeights(0);
+///         float const * wDu = context.GetWeights(1);
+///         ...
+///     }
+/// \endcode
+///
+/// A context holds the weights of the largest patch in fixed-size arrays, so
+/// queries through it never allocate.  A context must not be shared between
+/// threads, and the table and map must outlive it and not be modified while
+/// it is in use.
+///
+template <typename REAL>
+class PatchEvalContextReal {
+public:
+    typedef PatchTable::PatchHandle Handle;
+
+    /// \brief The largest number of control vertices of any patch type
+    static int const MAX_PATCH_VERTICES = 20;
+
+    /// \brief Constructor
+    ///
+    /// @param patchTable  PatchTable to be evaluated
+    ///
+    /// @param patchMap    PatchMap of the table, locating the patches of
+    ///                    Evaluate() -- may be null when only patch handles
+    ///                    are evaluated
+    ///
+    PatchEvalContextReal(PatchTable const & patchTable,
+                         PatchMap const * patchMap = 0) :
+        _patchTable(&patchTable), _patchMap(patchMap), _handle(0) { }
+
+    /// \brief Constructor
+    PatchEvalContextReal(PatchTable const & patchTable,
+                         PatchMap const & patchMap) :
+        _patchTable(&patchTable), _patchMap(&patchMap), _handle(0) { }
+
+    /// \brief Locates the patch of a face at (u,v) and evaluates its basis
+    ///
+    /// @param patchFaceId  The index of the patch (Ptex) face
+    ///
+    /// @param u            Local u parameter
+    ///
+    /// @param v            Local v parameter
+    ///
+    /// @param derivatives  The order of derivatives to evaluate (0, 1 or 2)
+    ///
+    /// @return             False if the face has no patch (e.g. a hole), in
+    ///                     which case the context holds no patch
+    ///
+    bool Evaluate(int patchFaceId, REAL u, REAL v, int derivatives = 0) {
+        assert(_patchMap);
+        Handle const * handle = _patchMap->FindPatch(patchFaceId, u, v);
+        if (!handle) {
+            _handle = 0;
+            return false;
+        }
+        EvaluateHandle(*handle, u, v, derivatives);
+        return true;
+    }
+
+    /// \brief Evaluates the basis of a patch at (u,v)
+    ///
+    /// @param handle       The patch, which must remain valid while the
+    ///                     context refers to it
+    ///
+    /// @param u            Patch coordinate (in base face normalized space)
+    ///
+    /// @param v            Patch coordinate (in base face normalized space)
+    ///
+    /// @param derivatives  The order of derivatives to evaluate (0, 1 or 2)
+    ///
+    void EvaluateHandle(Handle const & handle, REAL u, REAL v,
+                        int derivatives = 0) {
+        _handle = &handle;
+        _patchTable->EvaluateBasis(handle, u, v, _weights[0],
+            (derivatives > 0) ? _weights[1] : 0,
+            (derivatives > 0) ? _weights[2] : 0,
+            (derivatives > 1) ? _weights[3] : 0,
+            (derivatives > 1) ? _weights[4] : 0,
+            (derivatives > 1) ? _weights[5] : 0);
+    }
+
+    /// \brief Returns the patch of the last evaluation (0 if none)
+    Handle const * GetPatchHandle() const { return _handle; }
+
+    /// \brief Returns the control vertices of the patch of the last
+    /// evaluation
+    ConstIndexArray GetPatchVertices() const {
+        assert(_handle);
+        return _patchTable->GetPatchVertices(*_handle);
+    }
+
+    /// \brief Returns the weights of the last evaluation, one per control
+    /// vertex of the patch
+    ///
+    /// @param derivative  The weights of the position (0), first derivatives
+    ///                    wrt u (1) and v (2), or second derivatives wrt
+    ///                    u (3), u and v (4) and v (5) -- derivatives of a
+    ///                    higher order than evaluated are undefined
+    ///
+    REAL const * GetWeights(int derivative = 0) const {
+        assert((derivative >= 0) && (derivative < 6));
+        return _weights[derivative];
+    }
+
+    /// \brief Combines values of the control vertices of the patch of the
+    /// last evaluation with its weights
+    ///
+    /// @param src         Values of the control vertices and local points of
+    ///                    the table, indexed as the patch vertices
+    ///
+    /// @param dst         Destination for the combined value
+    ///
+    /// @param derivative  The weights combined (see GetWeights())
+    ///
+    /// Values must provide Clear() and AddWithWeight() as the primvar
+    /// buffers of PrimvarRefiner and StencilTable.
+    ///
+    template <class T, class U>
+    void Combine(T const & src, U & dst, int derivative = 0) const {
+        ConstIndexArray cvs = GetPatchVertices();
+        REAL const * w = GetWeights(derivative);
+        dst.Clear();
+        for (int i = 0; i < cvs.size(); ++i) {
+            //  weights of phantom points are zero and their indices invalid
+            if (w[i] != 0.0f) {
+                dst.AddWithWeight(src[cvs[i]], w[i]);
+            }
+        }
+    }
+
+private:
+    PatchTable const * _patchTable;
+    PatchMap const *   _patchMap;
+    Handle const *     _handle;
+
+    REAL _weights[6][MAX_PATCH_VERTICES];
+};
+
+/// \brief Per-thread state for concurrent limit queries (single precision)
+///
+class PatchEvalContext : public PatchEvalContextReal<float> {
+public:
+    PatchEvalContext(PatchTable const & patchTable,
+                     PatchMap const * patchMap = 0) :
+        PatchEvalContextReal<float>(patchTable, patchMap) { }
+
+    PatchEvalContext(PatchTable const & patchTable,
+                     PatchMap const & patchMap) :
+        PatchEvalContextReal<float>(patchTable, patchMap) { }
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_FAR_PATCH_EVAL_CONTEXT_H
@@ -35,17 +35,6 @@ namespace Far {
 //  Inline quadtree assembly methods used by the constructor:
 //
 
-// sets all the children to point to the patch of given index
-inline void
-PatchMap::QuadNode::SetChildren(int index) {
-
-    for (int i=0; i<4; ++i) {
-        children[i].isSet  = true;
-        children[i].isLeaf = true;
-        children[i].index  = index;
-    }
-}
-
 // sets the child in "quadrant" to point to the node or patch of the given index
 inline void
 PatchMap::QuadNode::SetChild(int quadrant, int index, bool isLeaf) {
@@ -56,30 +45,25 @@ PatchMap::QuadNode::SetChild(int quadrant, int index, bool isLeaf) {
     children[quadrant].index  = index;
 }
 
-inline void
-PatchMap::assignRootNode(QuadNode * node, int index) {
-
-    //  Assign the given index to all children of the node (all leaves)
-    node->SetChildren(index);
-}
-
-inline PatchMap::QuadNode *
-PatchMap::assignLeafOrChildNode(QuadNode * node, bool isLeaf, int quadrant, int index) {
+inline int
+PatchMap::assignLeafOrChildNode(int nodeIndex, bool isLeaf, int quadrant, int index) {
 
     //  Assign the node given if it is a leaf node, otherwise traverse
-    //  the node -- creating/assigning a new child node if needed
+    //  the node -- creating/assigning a new child node if needed.  Nodes
+    //  are referred to by index as the quadtree grows while it is assembled
 
     if (isLeaf) {
-        node->SetChild(quadrant, index, true);
-        return node;
+        _quadtree[nodeIndex].SetChild(quadrant, index, true);
+        return nodeIndex;
     }
-    if (node->children[quadrant].isSet) {
-        return &_quadtree[node->children[quadrant].index];
+    QuadNode::Child const & child = _quadtree[nodeIndex].children[quadrant];
+    if (child.isSet) {
+        return child.index;
     } else {
         int newChildNodeIndex = (int)_quadtree.size();
         _quadtree.push_back(QuadNode());
-        node->SetChild(quadrant, newChildNodeIndex, false);
-        return &_quadtree[newChildNodeIndex];
+        _quadtree[nodeIndex].SetChild(quadrant, newChildNodeIndex, false);
+        return newChildNodeIndex;
     }
 }
 
@@ -138,34 +122,63 @@ void
 PatchMap::initializeQuadtree(PatchTable const & patchTable) {
 
     //
-    //  Reserve quadtree nodes for the worst case and prune later.  Set the
-    //  initial size to accomodate the root node of each patch face:
+    //  Assign the root of each patch face -- directly the leaf of its patch
+    //  when the face is not subdivided -- and count the patches of the
+    //  subdivided faces, whose quadtrees are assembled afterwards:
     //
     int nPatchFaces = (_maxPatchFace - _minPatchFace) + 1;
 
     int nHandles = (int)_handles.size();
 
-    _quadtree.reserve(nPatchFaces + nHandles);
-    _quadtree.resize(nPatchFaces);
+    _roots.resize(nPatchFaces);
 
     PatchParamTable const & params = patchTable.GetPatchParamTable();
 
+    int nSubPatches = 0;
     for (int handle = 0; handle < nHandles; ++handle) {
 
         PatchParam const & param = params[handle];
 
-        int depth     = param.GetDepth();
-        int rootDepth = param.NonQuadRoot();
+        int depth = param.GetDepth();
 
         _maxDepth = std::max(_maxDepth, depth);
 
-        QuadNode * node = &_quadtree[param.GetFaceId() - _minPatchFace];
+        if (depth == param.NonQuadRoot()) {
+            QuadNode::Child & root = _roots[param.GetFaceId() - _minPatchFace];
+            root.isSet  = true;
+            root.isLeaf = true;
+            root.index  = handle;
+        } else {
+            ++nSubPatches;
+        }
+    }
+    if (nSubPatches == 0) return;
+
+    //
+    //  The sub-patches of a face fill its quadtree, whose nodes are then a
+    //  third of its leaves -- reserve accordingly to avoid the copies of
+    //  incremental growth (a tree that is not filled may still grow):
+    //
+    _quadtree.reserve(nSubPatches / 3 + 1);
 
-        if (depth == rootDepth) {
-            assignRootNode(node, handle);
-            continue;
+    for (int handle = 0; handle < nHandles; ++handle) {
+
+        PatchParam const & param = params[handle];
+
+        int depth     = param.GetDepth();
+        int rootDepth = param.NonQuadRoot();
+
+        if (depth == rootDepth) continue;
+
+        QuadNode::Child & root = _roots[param.GetFaceId() - _minPatchFace];
+        if (!root.isSet) {
+            root.isSet  = true;
+            root.isLeaf = false;
+            root.index  = (int)_quadtree.size();
+            _quadtree.push_back(QuadNode());
         }
-            
+        int node = root.index;
+
         if (!_patchesAreTriangular) {
             //  Use the UV bits of the PatchParam directly for quad patches:
             int u = param.GetU();
@@ -196,11 +209,188 @@ PatchMap::initializeQuadtree(PatchTable const & patchTable) {
         }
     }
 
-    //  Swap the Node vector with a copy to reduce worst case memory allocation:
-    QuadTree tmpTree = _quadtree;
-    _quadtree.swap(tmpTree);
+    //  Swap the Node vector with a copy if the reservation was exceeded:
+    if (_quadtree.capacity() > _quadtree.size()) {
+        QuadTree tmpTree = _quadtree;
+        _quadtree.swap(tmpTree);
+    }
+}
+
+//
+//  Device representation:
+//
+inline unsigned int
+PatchMap::packChild(QuadNode::Child const & child, int nodeOffset) {
+
+    if (!child.isSet) return 0;
+
+    unsigned int index = child.isLeaf ? child.index : child.index + nodeOffset;
+    return (index << 2) | (child.isLeaf << 1) | 1;
+}
+
+void
+PatchMap::GetPackedQuadtree(std::vector<unsigned int> & packedNodes) const {
+
+    //  The device quadtree has a root node per patch face, followed by the
+    //  nodes of the subdivided faces (whose root nodes are then repeated):
+    int nRoots = (int)_roots.size();
+
+    packedNodes.resize((nRoots + _quadtree.size()) * 4);
+    for (int i = 0; i < nRoots; ++i) {
+        QuadNode::Child const & root = _roots[i];
+        for (int quadrant = 0; quadrant < 4; ++quadrant) {
+            packedNodes[i * 4 + quadrant] = !root.isLeaf
+                ? packChild(_quadtree[root.index].children[quadrant], nRoots)
+                : packChild(root, nRoots);
+        }
+    }
+    for (int i = 0; i < (int)_quadtree.size(); ++i) {
+        for (int quadrant = 0; quadrant < 4; ++quadrant) {
+            packedNodes[(nRoots + i) * 4 + quadrant] =
+                packChild(_quadtree[i].children[quadrant], nRoots);
+        }
+    }
 }
 
+//
+//  Batched queries:
+//
+template <typename REAL>
+void
+PatchMap::FindPatches(int const * faceIds, REAL const * uArray,
+        REAL const * vArray, int count, Handle const ** handles) const {
+
+    if (_patchesAreTriangular) {
+        for (int i = 0; i < count; ++i) {
+            handles[i] = FindPatch(faceIds[i], uArray[i], vArray[i]);
+        }
+        return;
+    }
+
+    //
+    //  The quadrants of quad patches at successive depths correspond to the
+    //  successive bits of the (u,v) location, so queries are processed in
+    //  blocks, converting (u,v) to fixed point for the whole block in a
+    //  simple loop the compiler can vectorize.  Scaling by a power of two
+    //  and truncating is exact, so the results are identical to FindPatch().
+    //
+    int const blockSize = 64;
+
+    int uBits[blockSize];
+    int vBits[blockSize];
+
+    int  const maxBits = (1 << (_maxDepth + 1)) - 1;
+    REAL const scale   = (REAL) (1 << (_maxDepth + 1));
+
+    for (int blockBegin = 0; blockBegin < count; blockBegin += blockSize) {
+        int blockCount = std::min(blockSize, count - blockBegin);
+
+        REAL const * u = uArray + blockBegin;
+        REAL const * v = vArray + blockBegin;
+        for (int j = 0; j < blockCount; ++j) {
+            uBits[j] = std::max(0, std::min((int)(u[j] * scale), maxBits));
+            vBits[j] = std::max(0, std::min((int)(v[j] * scale), maxBits));
+        }
+
+        for (int j = 0; j < blockCount; ++j) {
+            int i = blockBegin + j;
+            int faceId = faceIds[i];
+
+            assert( (uArray[i]>=0.0) && (uArray[i]<=1.0) &&
+                    (vArray[i]>=0.0) && (vArray[i]<=1.0) );
+
+            //  Reject patch faces not supported by this map or holes:
+            handles[i] = 0;
+            if ((faceId < _minPatchFace) || (faceId > _maxPatchFace)) continue;
+
+            QuadNode::Child const & root = _roots[faceId - _minPatchFace];
+            if (!root.isSet) continue;
+            if (root.isLeaf) {
+                handles[i] = &_handles[root.index];
+                continue;
+            }
+
+            QuadNode const * node = &_quadtree[root.index];
+
+            for (int bit = _maxDepth; bit >= 0; --bit) {
+                int quadrant = (((vBits[j] >> bit) & 1) << 1) |
+                                ((uBits[j] >> bit) & 1);
+
+                QuadNode::Child const & child = node->children[quadrant];
+
+                //  holes should have been rejected at the root of the face
+                assert(child.isSet);
+
+                if (child.isLeaf) {
+                    handles[i] = &_handles[child.index];
+                    break;
+                }
+                node = &_quadtree[child.index];
+            }
+            assert(handles[i]);
+        }
+    }
+}
+
+template <typename REAL>
+void
+PatchMap::FindPatches(int const * faceIds, REAL const * uArray,
+        REAL const * vArray, int count, Handle const ** handles,
+        Hint * hints) const {
+
+    if (_patchesAreTriangular) {
+        for (int i = 0; i < count; ++i) {
+            handles[i] = FindPatch(faceIds[i], uArray[i], vArray[i]);
+        }
+        return;
+    }
+
+    //
+    //  Convert (u,v) to fixed point in blocks as above, then resume the
+    //  descent of each query from the path of its hint:
+    //
+    int const blockSize = 64;
+
+    int uBits[blockSize];
+    int vBits[blockSize];
+
+    int  const maxBits = (1 << (_maxDepth + 1)) - 1;
+    REAL const scale   = (REAL) (1 << (_maxDepth + 1));
+
+    for (int blockBegin = 0; blockBegin < count; blockBegin += blockSize) {
+        int blockCount = std::min(blockSize, count - blockBegin);
+
+        REAL const * u = uArray + blockBegin;
+        REAL const * v = vArray + blockBegin;
+        for (int j = 0; j < blockCount; ++j) {
+            uBits[j] = std::max(0, std::min((int)(u[j] * scale), maxBits));
+            vBits[j] = std::max(0, std::min((int)(v[j] * scale), maxBits));
+        }
+
+        for (int j = 0; j < blockCount; ++j) {
+            int i = blockBegin + j;
+
+            assert( (uArray[i]>=0.0) && (uArray[i]<=1.0) &&
+                    (vArray[i]>=0.0) && (vArray[i]<=1.0) );
+
+            handles[i] = findQuadPatch(faceIds[i], uBits[j], vBits[j], hints[i]);
+        }
+    }
+}
+
+template void PatchMap::FindPatches<float>(int const * patchFaceIds,
+        float const * u, float const * v, int count,
+        Handle const ** handles) const;
+template void PatchMap::FindPatches<double>(int const * patchFaceIds,
+        double const * u, double const * v, int count,
+        Handle const ** handles) const;
+template void PatchMap::FindPatches<float>(int const * patchFaceIds,
+        float const * u, float const * v, int count,
+        Handle const ** handles, Hint * hints) const;
+template void PatchMap::FindPatches<double>(int const * patchFaceIds,
+        double const * u, double const * v, int count,
+        Handle const ** handles, Hint * hints) const;
+
 } // end namespace Far
 
 } // end namespace OPENSUBDIV_VERSION
@@ -29,6 +29,7 @@
 
 #include "../far/patchTable.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace OpenSubdiv {
@@ -46,6 +47,9 @@ namespace Far {
 /// parametric location, can efficiently return a handle to the sub-patch that
 /// contains this location.
 ///
+/// Lookups modify no state and allocate no memory, so a PatchMap may be
+/// queried by any number of threads concurrently.
+///
 class PatchMap {
 public:
 
@@ -73,6 +77,133 @@ public:
     ///
     Handle const * FindPatch( int patchFaceId, double u, double v ) const;
 
+    /// \brief Returns handles to the sub-patches of a set of faces at the
+    /// given (u,v) locations. This is equivalent to calling FindPatch() for
+    /// each location, but queries are processed in blocks, descending the
+    /// quadtree for all queries of a block one level at a time, which hides
+    /// much of the latency of the quadtree traversal.
+    ///
+    /// @param patchFaceIds  The indices of the patch (Ptex) faces
+    ///
+    /// @param u             Local u parameters
+    ///
+    /// @param v             Local v parameters
+    ///
+    /// @param count         The number of locations
+    ///
+    /// @param handles       The resulting patch handles (0 for locations whose
+    ///                      face is not supported or is tagged as a hole)
+    ///
+    template <typename REAL>
+    void FindPatches( int const * patchFaceIds, REAL const * u, REAL const * v,
+                      int count, Handle const ** handles ) const;
+
+    /// \brief A hint accelerating lookups of locations close to the last one
+    ///
+    /// A Hint records the path through the quadtree to the sub-patch found
+    /// by the last lookup that used it.  A subsequent lookup in the same face
+    /// first tests whether the location is still in that sub-patch, and
+    /// otherwise only descends from the deepest node of the path containing
+    /// the new location, rather than from the root of the face.  This suits
+    /// coherent streams of queries, e.g. of points moving a short distance
+    /// over a surface from frame to frame.
+    ///
+    /// A default constructed Hint is empty and a Hint may only be used with
+    /// the PatchMap that last updated it.  Hints only accelerate lookups of
+    /// quad patches and are ignored for triangular patches.
+    ///
+    class Hint {
+    public:
+        Hint() : _patchFaceId(-1) { }
+
+        /// \brief Empties the hint
+        void Reset() { _patchFaceId = -1; }
+
+    private:
+        friend class PatchMap;
+
+        int _patchFaceId;  // patch face of the last lookup (-1 if empty)
+        int _depth;        // levels of quadtree descended to its sub-patch
+        int _u, _v;        // fixed point origin of the sub-patch at _depth
+        int _handle;       // index of the handle of the sub-patch
+        int _nodes[16];    // quadtree nodes of the path at each level
+    };
+
+    /// \brief Returns a handle to the sub-patch of the face at the given (u,v)
+    /// using and updating a hint from a previous lookup (see Hint).  The result
+    /// is identical to that of FindPatch() without a hint.
+    ///
+    /// @param patchFaceId  The index of the patch (Ptex) face
+    ///
+    /// @param u       Local u parameter
+    ///
+    /// @param v       Local v parameter
+    ///
+    /// @param hint    The hint of a previous lookup (updated if a patch is
+    ///                found)
+    ///
+    /// @return        A patch handle or 0 if the face is not supported (index
+    ///                out of bounds) or is tagged as a hole
+    ///
+    Handle const * FindPatch( int patchFaceId, double u, double v,
+                              Hint & hint ) const;
+
+    /// \brief Returns handles to the sub-patches of a set of faces at the
+    /// given (u,v) locations, using and updating a hint for each location.
+    /// This is equivalent to calling FindPatch() with the hint of each
+    /// location, e.g. with the hints of the previous positions of a set of
+    /// moving points.
+    ///
+    /// @param patchFaceIds  The indices of the patch (Ptex) faces
+    ///
+    /// @param u             Local u parameters
+    ///
+    /// @param v             Local v parameters
+    ///
+    /// @param count         The number of locations
+    ///
+    /// @param handles       The resulting patch handles (0 for locations whose
+    ///                      face is not supported or is tagged as a hole)
+    ///
+    /// @param hints         The hints of the locations (updated for those
+    ///                      whose patch is found)
+    ///
+    template <typename REAL>
+    void FindPatches( int const * patchFaceIds, REAL const * u, REAL const * v,
+                      int count, Handle const ** handles, Hint * hints ) const;
+
+    /// \name Device representation
+    ///
+    /// Accessors to the data of the map for its representations in device
+    /// memory (see Osd::GLPatchMap), whose lookups traverse the quadtree as
+    /// FindPatch() does.
+    ///
+    /// @{
+
+    /// \brief Returns the quadtree packed as four words per node, one per
+    /// quadrant: the index of the child node or patch handle in the upper 30
+    /// bits, and the isLeaf and isSet flags of the child in bits 1 and 0.
+    /// The root node of patch face f is node (f - GetMinPatchFace()), and an
+    /// unset child (0) marks a hole.
+    void GetPackedQuadtree( std::vector<unsigned int> & packedNodes ) const;
+
+    /// \brief Returns the patch handles indexed by the quadtree leaves
+    std::vector<Handle> const & GetHandles() const { return _handles; }
+
+    /// \brief Returns the minimum patch face index supported by the map
+    int GetMinPatchFace() const { return _minPatchFace; }
+
+    /// \brief Returns the maximum patch face index supported by the map
+    int GetMaxPatchFace() const { return _maxPatchFace; }
+
+    /// \brief Returns the maximum depth of a patch in the quadtree
+    int GetMaxDepth() const { return _maxDepth; }
+
+    /// \brief Returns true if the patches are triangular
+    bool ArePatchesTriangular() const { return _patchesAreTriangular; }
+
+    /// @}
+
 private:
     void initializeHandles(PatchTable const & patchTable);
     void initializeQuadtree(PatchTable const & patchTable);
@@ -88,9 +219,6 @@ private:
             unsigned int index  : 30;  // child index (either QuadNode or Handle)
         };
 
-        // sets all the children to point to the patch of given index
-        void SetChildren(int index);
-
         // sets the child in "quadrant" to point to the node or patch of the given index
         void SetChild(int quadrant, int index, bool isLeaf);
 
@@ -99,14 +227,17 @@ private:
     typedef std::vector<QuadNode> QuadTree;
 
     // Internal methods supporting quadtree construction and queries
-    void       assignRootNode(QuadNode * node, int index);
-    QuadNode * assignLeafOrChildNode(QuadNode * node, bool isLeaf, int quad, int index);
+    int assignLeafOrChildNode(int nodeIndex, bool isLeaf, int quad, int index);
 
     template <class T>
     static int transformUVToQuadQuadrant(T const & median, T & u, T & v);
     template <class T>
     static int transformUVToTriQuadrant(T const & median, T & u, T & v, bool & rotated);
 
+    static unsigned int packChild(QuadNode::Child const & child, int nodeOffset);
+
+    Handle const * findQuadPatch(int faceId, int uBits, int vBits, Hint & hint) const;
+
 private:
     bool _patchesAreTriangular;  // tri and quad assembly and search requirements differ
 
@@ -114,8 +245,12 @@ private:
     int  _maxPatchFace;  // maximum patch face index supported by the map
     int  _maxDepth;      // maximum depth of a patch in the tree
 
-    std::vector<Handle>   _handles;  // all the patches in the PatchTable
-    std::vector<QuadNode> _quadtree; // quadtree nodes
+    //  The root of each patch face is a single child, either the leaf of the
+    //  patch of a face that is not subdivided or the root node of its tree,
+    //  so that only the (comparatively few) subdivided faces use QuadNodes:
+    std::vector<Handle>          _handles;  // all the patches in the PatchTable
+    std::vector<QuadNode::Child> _roots;    // root of each patch face
+    std::vector<QuadNode>        _quadtree; // quadtree nodes of subdivided faces
 };
 
 //
@@ -194,14 +329,17 @@ PatchMap::FindPatch( int faceid, double u, double v ) const {
 
     //
     //  Reject patch faces not supported by this map, or those corresponding
-    //  to holes or otherwise unassigned (the root node for a patch will
-    //  have all or no quadrants set):
+    //  to holes or otherwise unassigned (the root of a patch face is set
+    //  unless the face is a hole):
     //
     if ((faceid < _minPatchFace) || (faceid > _maxPatchFace)) return 0;
 
-    QuadNode const * node = &_quadtree[faceid - _minPatchFace];
+    QuadNode::Child const & root = _roots[faceid - _minPatchFace];
 
-    if (!node->children[0].isSet) return 0;
+    if (!root.isSet) return 0;
+    if (root.isLeaf) return &_handles[root.index];
+
+    QuadNode const * node = &_quadtree[root.index];
 
     //
     //  Search the tree for the sub-patch containing the given (u,v)
@@ -217,7 +355,7 @@ PatchMap::FindPatch( int faceid, double u, double v ) const {
                      ? transformUVToTriQuadrant(median, u, v, triRotated)
                      : transformUVToQuadQuadrant(median, u, v);
 
-        //  holes should have been rejected at the root node of the face
+        //  holes should have been rejected at the root of the face
         assert(node->children[quadrant].isSet);
 
         if (node->children[quadrant].isLeaf) {
@@ -230,6 +368,90 @@ PatchMap::FindPatch( int faceid, double u, double v ) const {
     return 0;
 }
 
+//
+//  Hinted lookup of a quad patch given the fixed point (u,v) location, with
+//  _maxDepth+1 bits -- the quadrant at each level is given by successive bits
+//  as in FindPatches():
+//
+inline PatchMap::Handle const *
+PatchMap::findQuadPatch( int faceid, int uBits, int vBits, Hint & hint ) const {
+
+    int level = 0;
+
+    if (faceid == hint._patchFaceId) {
+        //
+        //  The bits of the location above the depth of the hinted sub-patch
+        //  differ from its origin in the levels where the paths diverge, so
+        //  resume the descent at the last level common to both:
+        //
+        int shift = _maxDepth + 1 - hint._depth;
+        int diff = ((uBits >> shift) ^ hint._u) | ((vBits >> shift) ^ hint._v);
+        if (diff == 0) return &_handles[hint._handle];
+
+        for (level = hint._depth; diff; diff >>= 1) {
+            --level;
+        }
+    } else {
+        if ((faceid < _minPatchFace) || (faceid > _maxPatchFace)) return 0;
+
+        QuadNode::Child const & root = _roots[faceid - _minPatchFace];
+
+        if (!root.isSet) return 0;
+
+        hint._patchFaceId = faceid;
+        if (root.isLeaf) {
+            hint._depth  = 0;
+            hint._u      = 0;
+            hint._v      = 0;
+            hint._handle = root.index;
+            return &_handles[root.index];
+        }
+        hint._nodes[0] = root.index;
+    }
+
+    QuadNode const * node = &_quadtree[hint._nodes[level]];
+
+    for (int bit = _maxDepth - level; bit >= 0; --bit) {
+        int quadrant = (((vBits >> bit) & 1) << 1) | ((uBits >> bit) & 1);
+
+        QuadNode::Child const & child = node->children[quadrant];
+
+        //  holes should have been rejected at the root of the face
+        assert(child.isSet);
+
+        ++level;
+        if (child.isLeaf) {
+            hint._depth  = level;
+            hint._u      = uBits >> bit;
+            hint._v      = vBits >> bit;
+            hint._handle = child.index;
+            return &_handles[child.index];
+        }
+        hint._nodes[level] = child.index;
+        node = &_quadtree[child.index];
+    }
+    assert(0);
+    return 0;
+}
+
+/// Returns a handle to the sub-patch of the face at the given (u,v).
+inline PatchMap::Handle const *
+PatchMap::FindPatch( int faceid, double u, double v, Hint & hint ) const {
+
+    if (_patchesAreTriangular) return FindPatch(faceid, u, v);
+
+    assert( (u>=0.0) && (u<=1.0) && (v>=0.0) && (v<=1.0) );
+
+    //  Scaling by a power of two and truncating is exact (see FindPatches())
+    int    const maxBits = (1 << (_maxDepth + 1)) - 1;
+    double const scale   = (double) (1 << (_maxDepth + 1));
+
+    int uBits = std::max(0, std::min((int)(u * scale), maxBits));
+    int vBits = std::max(0, std::min((int)(v * scale), maxBits));
+
+    return findQuadPatch(faceid, uBits, vBits, hint);
+}
+
 } // end namespace Far
 
 } // end namespace OPENSUBDIV_VERSION
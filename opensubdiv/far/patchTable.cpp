@@ -24,6 +24,7 @@
 
 #include "../far/patchTable.h"
 #include "../far/patchBasis.h"
+#include "../vtr/binaryStream.h"
 
 #include <algorithm>
 #include <cstring>
@@ -59,8 +60,12 @@ PatchTable::PatchTable(PatchTable const & src) :
     _localPointVaryingStencils(src._localPointVaryingStencils),
     _varyingDesc(src._varyingDesc),
     _fvarChannels(src._fvarChannels),
+    _fvarChannelData(src._fvarChannelData),
     _sharpnessIndices(src._sharpnessIndices),
     _sharpnessValues(src._sharpnessValues),
+    _patchRemap(src._patchRemap),
+    _ptexFacePatchOffsets(src._ptexFacePatchOffsets),
+    _ptexFacePatches(src._ptexFacePatches),
     _isUniformLinear(src._isUniformLinear),
     _vertexPrecisionIsDouble(src._vertexPrecisionIsDouble),
     _varyingPrecisionIsDouble(src._varyingPrecisionIsDouble),
@@ -203,6 +208,75 @@ struct PatchTable::FVarPatchChannel {
     std::vector<PatchParam> patchParam;
 };
 
+namespace {
+    template <typename T>
+    inline size_t
+    vectorMemoryUsage(std::vector<T> const & v) {
+        return v.capacity() * sizeof(T);
+    }
+
+    template <typename REAL>
+    inline size_t
+    stencilTableMemoryUsage(StencilTableReal<REAL> const * table) {
+        return table ? table->GetMemoryUsage() : 0;
+    }
+}
+
+size_t
+PatchTable::GetMemoryUsage() const {
+
+    MemoryUsage usage;
+    GetMemoryUsage(usage);
+    return usage.GetTotal();
+}
+
+void
+PatchTable::updateMemoryStats() {
+
+    if (internal::MemoryStats::IsReporting()) {
+        _memoryStats.Update(MEMORY_PATCH_TABLE, this, GetMemoryUsage());
+    }
+}
+
+void
+PatchTable::GetMemoryUsage(MemoryUsage & usage) const {
+
+    usage.table = sizeof(*this) + vectorMemoryUsage(_patchArrays) +
+                  vectorMemoryUsage(_patchRemap) +
+                  vectorMemoryUsage(_ptexFacePatchOffsets) +
+                  vectorMemoryUsage(_ptexFacePatches);
+
+    usage.patchVertices = vectorMemoryUsage(_patchVerts);
+    usage.patchParams   = vectorMemoryUsage(_paramTable);
+
+    usage.sharpness = vectorMemoryUsage(_sharpnessIndices) +
+                      vectorMemoryUsage(_sharpnessValues);
+
+    usage.legacyGregory = vectorMemoryUsage(_quadOffsetsTable) +
+                          vectorMemoryUsage(_vertexValenceTable);
+
+    usage.localPointStencils = _vertexPrecisionIsDouble
+        ? stencilTableMemoryUsage(_localPointStencils.Get<double>())
+        : stencilTableMemoryUsage(_localPointStencils.Get<float>());
+
+    usage.varying = vectorMemoryUsage(_varyingVerts) + (_varyingPrecisionIsDouble
+        ? stencilTableMemoryUsage(_localPointVaryingStencils.Get<double>())
+        : stencilTableMemoryUsage(_localPointVaryingStencils.Get<float>()));
+
+    usage.faceVarying = vectorMemoryUsage(_fvarChannels) +
+                        vectorMemoryUsage(_localPointFaceVaryingStencils) +
+                        vectorMemoryUsage(_fvarChannelData);
+    for (int fvc=0; fvc<(int)_fvarChannels.size(); ++fvc) {
+        usage.faceVarying += vectorMemoryUsage(_fvarChannels[fvc].patchValues) +
+                             vectorMemoryUsage(_fvarChannels[fvc].patchParam);
+    }
+    for (int fvc=0; fvc<(int)_localPointFaceVaryingStencils.size(); ++fvc) {
+        usage.faceVarying += _faceVaryingPrecisionIsDouble
+            ? stencilTableMemoryUsage(_localPointFaceVaryingStencils[fvc].Get<double>())
+            : stencilTableMemoryUsage(_localPointFaceVaryingStencils[fvc].Get<float>());
+    }
+}
+
 void
 PatchTable::allocateVaryingVertices(
         PatchDescriptor desc, int numPatches) {
@@ -210,19 +284,34 @@ PatchTable::allocateVaryingVertices(
     _varyingVerts.resize(numPatches*desc.GetNumControlVertices());
 }
 
+int
+PatchTable::getFVarChannelData(int channel) const {
+    return (channel>=0 && channel<(int)_fvarChannelData.size())
+         ? _fvarChannelData[channel] : -1;
+}
 inline PatchTable::FVarPatchChannel &
 PatchTable::getFVarPatchChannel(int channel) {
-    assert(channel>=0 && channel<(int)_fvarChannels.size());
-    return _fvarChannels[channel];
+    assert(channel>=0 && channel<(int)_fvarChannelData.size());
+    return _fvarChannels[_fvarChannelData[channel]];
 }
 inline PatchTable::FVarPatchChannel const &
 PatchTable::getFVarPatchChannel(int channel) const {
-    assert(channel>=0 && channel<(int)_fvarChannels.size());
-    return _fvarChannels[channel];
+    assert(channel>=0 && channel<(int)_fvarChannelData.size());
+    return _fvarChannels[_fvarChannelData[channel]];
 }
 void
 PatchTable::allocateFVarPatchChannels(int numChannels) {
     _fvarChannels.resize(numChannels);
+
+    _fvarChannelData.resize(numChannels);
+    for (int fvc=0; fvc<numChannels; ++fvc) {
+        _fvarChannelData[fvc] = fvc;
+    }
+}
+void
+PatchTable::shareFVarPatchChannels(std::vector<int> const & channelData) {
+    //  Assigned once the data of all unique channels has been populated:
+    _fvarChannelData = channelData;
 }
 void
 PatchTable::allocateFVarPatchChannelValues(
@@ -375,6 +464,17 @@ PatchTable::GetPatchParams(int arrayIndex) const {
     return ConstPatchParamArray(&_paramTable[pa.patchIndex], pa.numPatches);
 }
 
+PatchTable::ConstPatchHandleArray
+PatchTable::GetPtexFacePatches(int ptexFace) const {
+    if (_ptexFacePatchOffsets.empty()) {
+        return ConstPatchHandleArray(0, 0);
+    }
+    assert((ptexFace >= 0) && (ptexFace < _numPtexFaces));
+    Index offset = _ptexFacePatchOffsets[ptexFace];
+    return ConstPatchHandleArray(&_ptexFacePatches[0] + offset,
+        _ptexFacePatchOffsets[ptexFace + 1] - offset);
+}
+
 float
 PatchTable::GetSingleCreasePatchSharpnessValue(PatchHandle const & handle) const {
     assert((handle.patchIndex) < (int)_sharpnessIndices.size());
@@ -383,7 +483,8 @@ PatchTable::GetSingleCreasePatchSharpnessValue(PatchHandle const & handle) const
         return 0.0f;
     }
     assert(index < (Index)_sharpnessValues.size());
-    return _sharpnessValues[index];
+    //  Double-crease patches are encoded as negative values:
+    return std::max(_sharpnessValues[index], 0.0f);
 }
 float
 PatchTable::GetSingleCreasePatchSharpnessValue(int arrayIndex, int patchIndex) const {
@@ -394,7 +495,55 @@ PatchTable::GetSingleCreasePatchSharpnessValue(int arrayIndex, int patchIndex) c
         return 0.0f;
     }
     assert(index < (Index)_sharpnessValues.size());
-    return _sharpnessValues[index];
+    return std::max(_sharpnessValues[index], 0.0f);
+}
+
+bool
+PatchTable::GetDoubleCreasePatchSharpnessValues(PatchHandle const & handle,
+                                                float sharpness[2]) const {
+    assert((handle.patchIndex) < (int)_sharpnessIndices.size());
+    Index index = _sharpnessIndices[handle.patchIndex];
+    if (index == Vtr::INDEX_INVALID) {
+        return false;
+    }
+    assert(index < (Index)_sharpnessValues.size());
+    return DecodeDoubleCreaseSharpness(_sharpnessValues[index], sharpness);
+}
+bool
+PatchTable::GetDoubleCreasePatchSharpnessValues(int arrayIndex, int patchIndex,
+                                                float sharpness[2]) const {
+    PatchArray const & pa = getPatchArray(arrayIndex);
+    assert((pa.patchIndex + patchIndex) < (int)_sharpnessIndices.size());
+    Index index = _sharpnessIndices[pa.patchIndex + patchIndex];
+    if (index == Vtr::INDEX_INVALID) {
+        return false;
+    }
+    assert(index < (Index)_sharpnessValues.size());
+    return DecodeDoubleCreaseSharpness(_sharpnessValues[index], sharpness);
+}
+
+//
+//  The two crease sharpness of a double-crease patch, each in [0,10], are
+//  quantized to 1/256 and packed into the integral part of a negative float
+//  -- the packed integer is less than 2^24 and so represented exactly:
+//
+float
+PatchTable::EncodeDoubleCreaseSharpness(float sharpnessLower,
+                                        float sharpnessUpper) {
+    int lower = (int)(std::min(std::max(sharpnessLower, 0.0f), 10.0f) * 256.0f + 0.5f);
+    int upper = (int)(std::min(std::max(sharpnessUpper, 0.0f), 10.0f) * 256.0f + 0.5f);
+
+    return -(float)((lower << 12) | upper);
+}
+bool
+PatchTable::DecodeDoubleCreaseSharpness(float value, float sharpness[2]) {
+    if (value >= 0.0f) {
+        return false;
+    }
+    int packed = (int)(-value);
+    sharpness[0] = (float)(packed >> 12)    * (1.0f / 256.0f);
+    sharpness[1] = (float)(packed & 0xfff) * (1.0f / 256.0f);
+    return true;
 }
 
 int
@@ -413,15 +562,93 @@ PatchTable::GetNumLocalPointsVarying() const {
 }
 int
 PatchTable::GetNumLocalPointsFaceVarying(int channel) const {
-    if (channel>=0 && channel<(int)_localPointFaceVaryingStencils.size()) {
-        if (!_localPointFaceVaryingStencils[channel]) return 0;
+    int data = getFVarChannelData(channel);
+    if (data>=0 && data<(int)_localPointFaceVaryingStencils.size()) {
+        if (!_localPointFaceVaryingStencils[data]) return 0;
         return _faceVaryingPrecisionIsDouble
-                    ? _localPointFaceVaryingStencils[channel].Get<double>()->GetNumStencils()
-                    : _localPointFaceVaryingStencils[channel].Get<float>()->GetNumStencils();
+                    ? _localPointFaceVaryingStencils[data].Get<double>()->GetNumStencils()
+                    : _localPointFaceVaryingStencils[data].Get<float>()->GetNumStencils();
     }
     return 0;
 }
 
+namespace {
+    template <typename REAL>
+    void
+    updateLocalPoints(StencilTableReal<REAL> const & stencils,
+                      float const * src, int srcStride,
+                      float * dst, int dstStride,
+                      int length, int numThreads) {
+
+        int numStencils = stencils.GetNumStencils();
+
+        int const    * sizes   = &stencils.GetSizes()[0];
+        Offset const * offsets = &stencils.GetOffsets()[0];
+        Index const  * indices = &stencils.GetControlIndices()[0];
+        REAL const   * weights = &stencils.GetWeights()[0];
+
+        (void)numThreads;
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(static, 64)
+#endif
+        for (int i = 0; i < numStencils; ++i) {
+            float * dstValue = dst + i * dstStride;
+            std::fill(dstValue, dstValue + length, 0.0f);
+
+            Offset offset = offsets[i];
+            for (int j = 0; j < sizes[i]; ++j) {
+                float const * srcValue = src + indices[offset + j] * srcStride;
+                float weight = (float)weights[offset + j];
+                for (int k = 0; k < length; ++k) {
+                    dstValue[k] += weight * srcValue[k];
+                }
+            }
+        }
+    }
+}
+
+void
+PatchTable::computeLocalPointValues(StencilTablePtr const & table,
+        bool isDouble, float const * src, int srcStride,
+        float * dst, int dstStride, int length, int numThreads) const {
+
+    if (!table) return;
+
+    if (isDouble) {
+        updateLocalPoints(*table.Get<double>(), src, srcStride,
+                          dst, dstStride, length, numThreads);
+    } else {
+        updateLocalPoints(*table.Get<float>(), src, srcStride,
+                          dst, dstStride, length, numThreads);
+    }
+}
+void
+PatchTable::ComputeLocalPointValues(float const *src, int srcStride,
+                                    float *dst, int dstStride,
+                                    int length, int numThreads) const {
+    computeLocalPointValues(_localPointStencils, _vertexPrecisionIsDouble,
+            src, srcStride, dst, dstStride, length, numThreads);
+}
+void
+PatchTable::ComputeLocalPointValuesVarying(float const *src, int srcStride,
+                                           float *dst, int dstStride,
+                                           int length, int numThreads) const {
+    computeLocalPointValues(_localPointVaryingStencils, _varyingPrecisionIsDouble,
+            src, srcStride, dst, dstStride, length, numThreads);
+}
+void
+PatchTable::ComputeLocalPointValuesFaceVarying(float const *src, int srcStride,
+                                               float *dst, int dstStride,
+                                               int length, int channel,
+                                               int numThreads) const {
+    int data = getFVarChannelData(channel);
+    if (data>=0 && data<(int)_localPointFaceVaryingStencils.size()) {
+        computeLocalPointValues(_localPointFaceVaryingStencils[data],
+                _faceVaryingPrecisionIsDouble,
+                src, srcStride, dst, dstStride, length, numThreads);
+    }
+}
+
 PatchTable::ConstQuadOffsetsArray
 PatchTable::GetPatchQuadOffsets(PatchHandle const & handle) const {
     PatchArray const & pa = getPatchArray(handle.arrayIndex);
@@ -523,7 +750,15 @@ PatchTable::populateVaryingVertices() {
 
 int
 PatchTable::GetNumFVarChannels() const {
-    return (int)_fvarChannels.size();
+    return (int)_fvarChannelData.size();
+}
+int
+PatchTable::GetSharedFVarChannel(int channel) const {
+    int data = getFVarChannelData(channel);
+    for (int fvc=0; fvc<channel; ++fvc) {
+        if (_fvarChannelData[fvc] == data) return fvc;
+    }
+    return channel;
 }
 Sdc::Options::FVarLinearInterpolation
 PatchTable::GetFVarChannelLinearInterpolation(int channel) const {
@@ -702,6 +937,442 @@ template void PatchTable::EvaluateBasisFaceVarying<double>(PatchHandle const & h
         double s, double t, double wP[], double wDs[], double wDt[],
         double wDss[], double wDst[], double wDtt[], int channel) const;
 
+//
+//  Spatially coherent ordering of the patches of each array -- patches of
+//  different depths share no points, so they are ordered by depth, then by
+//  ptex face (and so by base face) and along a Hilbert curve within the face:
+//
+namespace {
+    inline unsigned long long
+    spatialPatchKey(PatchParam const & param) {
+
+        //  Distance of the patch along a Hilbert curve of its depth:
+        int depth = param.GetDepth();
+        unsigned int u = param.GetU();
+        unsigned int v = param.GetV();
+
+        unsigned long long d = 0;
+        for (unsigned int s = (1u << depth) >> 1; s > 0; s >>= 1) {
+            unsigned int ru = (u & s) ? 1 : 0;
+            unsigned int rv = (v & s) ? 1 : 0;
+            d += (unsigned long long)s * s * ((3 * ru) ^ rv);
+            if (rv == 0) {
+                if (ru == 1) {
+                    u = s - 1 - (u & (s - 1));
+                    v = s - 1 - (v & (s - 1));
+                }
+                std::swap(u, v);
+            }
+        }
+        return ((unsigned long long)depth << 52) |
+               ((unsigned long long)param.GetFaceId() << 20) | d;
+    }
+
+    template <typename T>
+    void
+    permuteBlocks(std::vector<T> & values, int start, int stride,
+                  std::vector<int> const & order) {
+
+        if (values.empty() || (stride == 0)) return;
+
+        std::vector<T> blocks(values.begin() + start,
+                              values.begin() + start + order.size() * stride);
+        for (int i = 0; i < (int)order.size(); ++i) {
+            std::copy(blocks.begin() + order[i] * stride,
+                      blocks.begin() + (order[i] + 1) * stride,
+                      values.begin() + start + i * stride);
+        }
+    }
+
+    struct SpatialPatchLess {
+        SpatialPatchLess(std::vector<unsigned long long> const & keys) :
+            _keys(keys) { }
+        bool operator()(int a, int b) const { return _keys[a] < _keys[b]; }
+
+        std::vector<unsigned long long> const & _keys;
+    };
+}
+
+void
+PatchTable::reorderPatches() {
+
+    int numPatches = (int)_paramTable.size();
+
+    _patchRemap.resize(numPatches);
+
+    int varyingStride = _varyingDesc.GetNumControlVertices();
+
+    for (int i = 0; i < (int)_patchArrays.size(); ++i) {
+        PatchArray const & pa = _patchArrays[i];
+
+        std::vector<unsigned long long> keys(pa.numPatches);
+        for (int j = 0; j < pa.numPatches; ++j) {
+            keys[j] = spatialPatchKey(_paramTable[pa.patchIndex + j]);
+        }
+        std::vector<int> order(pa.numPatches);
+        for (int j = 0; j < pa.numPatches; ++j) {
+            order[j] = j;
+        }
+        std::stable_sort(order.begin(), order.end(), SpatialPatchLess(keys));
+
+        for (int j = 0; j < pa.numPatches; ++j) {
+            _patchRemap[pa.patchIndex + order[j]] = pa.patchIndex + j;
+        }
+
+        int numCVs = pa.desc.GetNumControlVertices();
+
+        permuteBlocks(_patchVerts, pa.vertIndex, numCVs, order);
+        permuteBlocks(_paramTable, pa.patchIndex, 1, order);
+        permuteBlocks(_sharpnessIndices, pa.patchIndex, 1, order);
+        permuteBlocks(_varyingVerts, pa.patchIndex * varyingStride,
+                      varyingStride, order);
+
+        //  Quad offsets of legacy Gregory patches are indexed as vertices:
+        if ((pa.desc.GetType() == PatchDescriptor::GREGORY) ||
+            (pa.desc.GetType() == PatchDescriptor::GREGORY_BOUNDARY)) {
+            permuteBlocks(_quadOffsetsTable, pa.quadOffsetIndex,
+                          numCVs, order);
+        }
+
+        for (int k = 0; k < (int)_fvarChannels.size(); ++k) {
+            FVarPatchChannel & c = _fvarChannels[k];
+
+            permuteBlocks(c.patchValues, pa.patchIndex * c.stride,
+                          c.stride, order);
+            permuteBlocks(c.patchParam, pa.patchIndex, 1, order);
+        }
+    }
+}
+
+namespace {
+    struct PatchHandleLess {
+        bool operator()(PatchTable::PatchHandle const & a,
+                        PatchTable::PatchHandle const & b) const {
+            return a.patchIndex < b.patchIndex;
+        }
+    };
+}
+
+void
+PatchTable::indexPtexFacePatches(int numThreads) {
+
+    int numPatches = (int)_paramTable.size();
+
+    _ptexFacePatchOffsets.assign(_numPtexFaces + 1, 0);
+    _ptexFacePatches.resize(numPatches);
+    if (numPatches == 0) return;
+
+    Index * offsets = &_ptexFacePatchOffsets[0];
+
+    //  Count the patches of each face, offset by one for the prefix sum:
+    (void)numThreads;
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(static, 256)
+#endif
+    for (int i = 0; i < numPatches; ++i) {
+        Index * count = offsets + _paramTable[i].GetFaceId() + 1;
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp atomic
+#endif
+        ++*count;
+    }
+    for (int i = 0; i < _numPtexFaces; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    //  Assign the patches to the slots of their faces concurrently -- the
+    //  slots are then sorted so that the index does not depend on threading:
+    std::vector<Index> filled(_numPtexFaces, 0);
+
+    for (int a = 0; a < (int)_patchArrays.size(); ++a) {
+        PatchArray const & pa = _patchArrays[a];
+
+        int numCVs = pa.desc.GetNumControlVertices();
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(static, 256)
+#endif
+        for (int j = 0; j < pa.numPatches; ++j) {
+            int face = _paramTable[pa.patchIndex + j].GetFaceId();
+
+            Index slot;
+#ifdef OPENSUBDIV_HAS_OPENMP
+            #pragma omp atomic capture
+#endif
+            slot = filled[face]++;
+
+            PatchHandle & handle = _ptexFacePatches[offsets[face] + slot];
+            handle.arrayIndex = a;
+            handle.patchIndex = pa.patchIndex + j;
+            handle.vertIndex  = j * numCVs;
+        }
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(static, 256)
+#endif
+    for (int i = 0; i < _numPtexFaces; ++i) {
+        std::sort(_ptexFacePatches.begin() + offsets[i],
+                  _ptexFacePatches.begin() + offsets[i + 1], PatchHandleLess());
+    }
+}
+
+//
+//  Serialization to/from a flat binary buffer:
+//
+//  Patch arrays and face-varying channels are written member-wise as they
+//  contain descriptors and vectors -- all other tables are written directly.
+//  Reading expects a newly constructed table.
+//
+void
+PatchTable::writeStencilTable(Vtr::internal::BinaryWriter & stream,
+        StencilTablePtr const & table, bool isDouble) const {
+
+    stream.write((int) (bool) table);
+    if (table) {
+        if (isDouble) {
+            table.Get<double>()->write(stream);
+        } else {
+            table.Get<float>()->write(stream);
+        }
+    }
+}
+
+bool
+PatchTable::readStencilTable(Vtr::internal::BinaryReader & stream,
+        StencilTablePtr & table, bool isDouble) {
+
+    int hasTable = 0;
+    if (!stream.read(hasTable) || !hasTable) {
+        return stream.isValid();
+    }
+    if (isDouble) {
+        table.Set(new StencilTableReal<double>());
+        return table.Get<double>()->read(stream);
+    } else {
+        table.Set(new StencilTableReal<float>());
+        return table.Get<float>()->read(stream);
+    }
+}
+
+void
+PatchTable::write(Vtr::internal::BinaryWriter & stream) const {
+
+    stream.write(_maxValence);
+    stream.write(_numPtexFaces);
+
+    stream.write((int) _isUniformLinear);
+    stream.write((int) _vertexPrecisionIsDouble);
+    stream.write((int) _varyingPrecisionIsDouble);
+    stream.write((int) _faceVaryingPrecisionIsDouble);
+
+    stream.write((int) _patchArrays.size());
+    for (int i = 0; i < (int) _patchArrays.size(); ++i) {
+        PatchArray const & pa = _patchArrays[i];
+
+        stream.write((int) pa.desc.GetType());
+        stream.write(pa.numPatches);
+        stream.write(pa.vertIndex);
+        stream.write(pa.patchIndex);
+        stream.write(pa.quadOffsetIndex);
+    }
+    stream.writeVector(_patchVerts);
+    stream.writeVector(_paramTable);
+
+    stream.writeVector(_quadOffsetsTable);
+    stream.writeVector(_vertexValenceTable);
+
+    writeStencilTable(stream, _localPointStencils, _vertexPrecisionIsDouble);
+    writeStencilTable(stream, _localPointVaryingStencils, _varyingPrecisionIsDouble);
+
+    stream.write((int) _varyingDesc.GetType());
+    stream.writeVector(_varyingVerts);
+
+    stream.write((int) _fvarChannels.size());
+    for (int i = 0; i < (int) _fvarChannels.size(); ++i) {
+        FVarPatchChannel const & c = _fvarChannels[i];
+
+        stream.write((int) c.interpolation);
+        stream.write((int) c.regDesc.GetType());
+        stream.write((int) c.irregDesc.GetType());
+        stream.write(c.stride);
+        stream.writeVector(c.patchValues);
+        stream.writeVector(c.patchParam);
+    }
+    stream.writeVector(_fvarChannelData);
+
+    stream.write((int) _localPointFaceVaryingStencils.size());
+    for (int i = 0; i < (int) _localPointFaceVaryingStencils.size(); ++i) {
+        writeStencilTable(stream, _localPointFaceVaryingStencils[i],
+                          _faceVaryingPrecisionIsDouble);
+    }
+
+    stream.writeVector(_sharpnessIndices);
+    stream.writeVector(_sharpnessValues);
+    stream.writeVector(_patchRemap);
+    stream.writeVector(_ptexFacePatchOffsets);
+    stream.writeVector(_ptexFacePatches);
+}
+
+namespace {
+    inline bool
+    readPatchType(Vtr::internal::BinaryReader & stream, PatchDescriptor & desc) {
+        int type = 0;
+        if (!stream.read(type) || (type < PatchDescriptor::NON_PATCH) ||
+                                  (type > PatchDescriptor::GREGORY_TRIANGLE)) {
+            return false;
+        }
+        desc = PatchDescriptor((PatchDescriptor::Type) type);
+        return true;
+    }
+}
+
+bool
+PatchTable::read(Vtr::internal::BinaryReader & stream) {
+
+    assert(_patchArrays.empty() && _fvarChannels.empty());
+
+    int isUniformLinear = 0,
+        vertexPrecisionIsDouble = 0,
+        varyingPrecisionIsDouble = 0,
+        faceVaryingPrecisionIsDouble = 0;
+
+    stream.read(_maxValence);
+    stream.read(_numPtexFaces);
+
+    stream.read(isUniformLinear);
+    stream.read(vertexPrecisionIsDouble);
+    stream.read(varyingPrecisionIsDouble);
+    stream.read(faceVaryingPrecisionIsDouble);
+
+    _isUniformLinear              = (isUniformLinear != 0);
+    _vertexPrecisionIsDouble      = (vertexPrecisionIsDouble != 0);
+    _varyingPrecisionIsDouble     = (varyingPrecisionIsDouble != 0);
+    _faceVaryingPrecisionIsDouble = (faceVaryingPrecisionIsDouble != 0);
+
+    int numPatchArrays = 0;
+    if (!stream.read(numPatchArrays) || (numPatchArrays < 0)) {
+        return false;
+    }
+    _patchArrays.reserve(numPatchArrays);
+    for (int i = 0; i < numPatchArrays; ++i) {
+        PatchDescriptor desc;
+        int   numPatches = 0;
+        Index vertIndex = 0, patchIndex = 0, quadOffsetIndex = 0;
+
+        if (!readPatchType(stream, desc)) return false;
+        stream.read(numPatches);
+        stream.read(vertIndex);
+        stream.read(patchIndex);
+        stream.read(quadOffsetIndex);
+
+        _patchArrays.push_back(
+            PatchArray(desc, numPatches, vertIndex, patchIndex, quadOffsetIndex));
+    }
+    stream.readVector(_patchVerts);
+    stream.readVector(_paramTable);
+
+    stream.readVector(_quadOffsetsTable);
+    stream.readVector(_vertexValenceTable);
+
+    if (!readStencilTable(stream, _localPointStencils, _vertexPrecisionIsDouble) ||
+        !readStencilTable(stream, _localPointVaryingStencils, _varyingPrecisionIsDouble)) {
+        return false;
+    }
+
+    if (!readPatchType(stream, _varyingDesc)) return false;
+    stream.readVector(_varyingVerts);
+
+    int numFVarChannels = 0;
+    if (!stream.read(numFVarChannels) || (numFVarChannels < 0)) {
+        return false;
+    }
+    _fvarChannels.resize(numFVarChannels);
+    for (int i = 0; i < numFVarChannels; ++i) {
+        FVarPatchChannel & c = _fvarChannels[i];
+
+        int interpolation = 0;
+        stream.read(interpolation);
+        c.interpolation = (Sdc::Options::FVarLinearInterpolation) interpolation;
+
+        if (!readPatchType(stream, c.regDesc) ||
+            !readPatchType(stream, c.irregDesc)) return false;
+        stream.read(c.stride);
+        stream.readVector(c.patchValues);
+        stream.readVector(c.patchParam);
+    }
+    stream.readVector(_fvarChannelData);
+
+    int numFVarStencilTables = 0;
+    if (!stream.read(numFVarStencilTables) || (numFVarStencilTables < 0)) {
+        return false;
+    }
+    _localPointFaceVaryingStencils.resize(numFVarStencilTables);
+    for (int i = 0; i < numFVarStencilTables; ++i) {
+        if (!readStencilTable(stream, _localPointFaceVaryingStencils[i],
+                              _faceVaryingPrecisionIsDouble)) return false;
+    }
+
+    stream.readVector(_sharpnessIndices);
+    stream.readVector(_sharpnessValues);
+    stream.readVector(_patchRemap);
+    stream.readVector(_ptexFacePatchOffsets);
+    stream.readVector(_ptexFacePatches);
+    if (!stream.isValid()) {
+        return false;
+    }
+
+    //  Verify the patch arrays refer to the tables that were read:
+    for (int i = 0; i < numPatchArrays; ++i) {
+        PatchArray const & pa = _patchArrays[i];
+
+        int numVerts = pa.numPatches * pa.desc.GetNumControlVertices();
+        if ((pa.numPatches < 0) || (pa.vertIndex < 0) || (pa.patchIndex < 0) ||
+            (pa.vertIndex + numVerts > (int) _patchVerts.size()) ||
+            (pa.patchIndex + pa.numPatches > (int) _paramTable.size())) {
+            return false;
+        }
+    }
+    for (int i = 0; i < (int) _fvarChannelData.size(); ++i) {
+        if ((_fvarChannelData[i] < 0) || (_fvarChannelData[i] >= numFVarChannels)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < numFVarChannels; ++i) {
+        FVarPatchChannel const & c = _fvarChannels[i];
+
+        if ((c.stride < 0) ||
+            (c.patchValues.size() != c.patchParam.size() * (size_t) c.stride)) {
+            return false;
+        }
+    }
+    if (!_patchRemap.empty() && (_patchRemap.size() != _paramTable.size())) {
+        return false;
+    }
+    if (!_ptexFacePatchOffsets.empty()) {
+        if ((_ptexFacePatchOffsets.size() != (size_t)_numPtexFaces + 1) ||
+            (_ptexFacePatchOffsets.front() != 0) ||
+            (_ptexFacePatchOffsets.back() != (Index)_ptexFacePatches.size())) {
+            return false;
+        }
+        for (int i = 0; i < _numPtexFaces; ++i) {
+            if (_ptexFacePatchOffsets[i] > _ptexFacePatchOffsets[i + 1]) {
+                return false;
+            }
+        }
+        for (int i = 0; i < (int)_ptexFacePatches.size(); ++i) {
+            PatchHandle const & h = _ptexFacePatches[i];
+            if ((h.arrayIndex < 0) || (h.arrayIndex >= numPatchArrays) ||
+                (h.patchIndex < 0) || (h.patchIndex >= (Index)_paramTable.size())) {
+                return false;
+            }
+        }
+    } else if (!_ptexFacePatches.empty()) {
+        return false;
+    }
+    return true;
+}
+
 } // end namespace Far
 
 } // end namespace OPENSUBDIV_VERSION
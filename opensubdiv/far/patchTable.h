@@ -27,6 +27,7 @@
 
 #include "../version.h"
 
+#include "../far/memory.h"
 #include "../far/patchDescriptor.h"
 #include "../far/patchParam.h"
 #include "../far/stencilTable.h"
@@ -49,6 +50,10 @@ namespace Far {
 /// Note : PatchTable can be accessed either using a PatchHandle or a
 ///        combination of array and patch indices.
 ///
+/// Note : The const methods of PatchTable neither modify it nor allocate
+///        memory, so a table may be queried by any number of threads
+///        concurrently (see PatchEvalContext for per-thread query state).
+///
 /// XXXX manuelk we should add a PatchIterator that can dereference into
 ///              a PatchHandle for fast linear traversal of the table
 ///
@@ -94,6 +99,35 @@ public:
     /// \brief Returns the total number of ptex faces in the mesh
     int GetNumPtexFaces() const { return _numPtexFaces; }
 
+    /// \brief Returns the number of bytes allocated by the table, including
+    ///        its local point stencil tables
+    size_t GetMemoryUsage() const;
+
+    /// \brief Number of bytes allocated by each component of the table
+    struct MemoryUsage {
+        size_t table;                  ///< the table itself, its patch arrays,
+                                       ///< any patch remapping and any index
+                                       ///< of the patches of ptex faces
+        size_t patchVertices;          ///< control vertex indices of the patches
+        size_t patchParams;            ///< PatchParams of the patches
+        size_t sharpness;              ///< single-crease sharpness tables
+        size_t legacyGregory;          ///< quad offsets and vertex valences
+        size_t localPointStencils;     ///< local point stencils
+        size_t varying;                ///< varying patches and local point stencils
+        size_t faceVarying;            ///< face-varying channels and local point stencils
+
+        /// \brief Returns the total number of bytes (see GetMemoryUsage())
+        size_t GetTotal() const {
+            return table + patchVertices + patchParams + sharpness +
+                   legacyGregory + localPointStencils + varying + faceVarying;
+        }
+    };
+
+    /// \brief Returns the number of bytes allocated by each component of the
+    ///        table, e.g. to assess the savings of the options of the
+    ///        PatchTableFactory that omit data not needed by a client
+    void GetMemoryUsage(MemoryUsage & usage) const;
+
 
     //@{
     ///  @name Individual patches
@@ -148,6 +182,26 @@ public:
     //@}
 
 
+    //@{
+    ///  @name Patches of ptex faces
+    ///
+    /// \anchor ptex_face_patches
+    ///
+    /// \brief Accessors for the patches of each ptex face, indexed when
+    ///        PatchTableFactory::Options::generatePtexFacePatches is set
+    ///
+
+    typedef Vtr::ConstArray<PatchHandle> ConstPatchHandleArray;
+
+    /// \brief True if the patches of each ptex face are indexed
+    bool HasPtexFacePatches() const { return !_ptexFacePatchOffsets.empty(); }
+
+    /// \brief Returns the handles of the patches of \p ptexFace, ordered by
+    ///        patch index (empty if not indexed)
+    ConstPatchHandleArray GetPtexFacePatches(int ptexFace) const;
+    //@}
+
+
     //@{
     ///  @name Change of basis patches
     ///
@@ -186,6 +240,31 @@ public:
     template <class T> void
     ComputeLocalPointValues(T const *src, T *dst) const;
 
+    /// \brief Updates local point vertex values of raw float buffers in
+    ///        parallel (with OpenMP support)
+    ///
+    /// @param src        Buffer with primvar data for the base and refined
+    ///                   vertex values (offset to the first element used)
+    ///
+    /// @param srcStride  Number of floats between consecutive values of src
+    ///
+    /// @param dst        Destination buffer for the computed local point
+    ///                   vertex values (offset to the first element written)
+    ///
+    /// @param dstStride  Number of floats between consecutive values of dst
+    ///
+    /// @param length     Number of floats of each value
+    ///
+    /// @param numThreads Number of threads (the points are computed serially
+    ///                   if less than 2)
+    ///
+    /// Unlike the templated version, this accepts the local point stencils
+    /// of either precision.
+    ///
+    void ComputeLocalPointValues(float const *src, int srcStride,
+                                 float *dst, int dstStride,
+                                 int length, int numThreads) const;
+
 
     /// \brief Returns the number of local varying points.
     int GetNumLocalPointsVarying() const;
@@ -216,6 +295,13 @@ public:
     template <class T> void
     ComputeLocalPointValuesVarying(T const *src, T *dst) const;
 
+    /// \brief Updates local point varying values of raw float buffers in
+    ///        parallel (see the raw float ComputeLocalPointValues())
+    ///
+    void ComputeLocalPointValuesVarying(float const *src, int srcStride,
+                                        float *dst, int dstStride,
+                                        int length, int numThreads) const;
+
 
     /// \brief Returns the number of local face-varying points for \p channel
     int GetNumLocalPointsFaceVarying(int channel = 0) const;
@@ -247,6 +333,15 @@ public:
     ///
     template <class T> void
     ComputeLocalPointValuesFaceVarying(T const *src, T *dst, int channel = 0) const;
+
+    /// \brief Updates local point face-varying values of raw float buffers
+    ///        of \p channel in parallel (see the raw float
+    ///        ComputeLocalPointValues())
+    ///
+    void ComputeLocalPointValuesFaceVarying(float const *src, int srcStride,
+                                            float *dst, int dstStride,
+                                            int length, int channel,
+                                            int numThreads) const;
     //@}
 
 
@@ -285,6 +380,41 @@ public:
     /// \brief Returns the crease sharpness for the \p patch in \p array
     ///        if it is a single-crease patch, or 0.0f
     float GetSingleCreasePatchSharpnessValue(int array, int patch) const;
+
+    /// \brief Returns true if the patch identified by \p handle is a
+    ///        double-crease patch, with the sharpness of its creases along
+    ///        the lower and upper edges in the direction across them
+    bool GetDoubleCreasePatchSharpnessValues(PatchHandle const & handle,
+                                             float sharpness[2]) const;
+
+    /// \brief Returns true if the \p patch in \p array is a double-crease
+    ///        patch, with the sharpness of its creases along the lower and
+    ///        upper edges in the direction across them
+    bool GetDoubleCreasePatchSharpnessValues(int array, int patch,
+                                             float sharpness[2]) const;
+
+    /// \brief Returns the sharpness value encoding the two creases of a
+    ///        double-crease patch
+    ///
+    /// The sharpness of a double-crease patch is stored as a single negative
+    /// value, in which each crease sharpness (at most 10) is quantized to
+    /// 1/256, so that the sharpness of each patch remains one float (e.g. in
+    /// the patch params of the Osd patch tables).  The patch boundary mask
+    /// identifies the creased edges:  edges 0 and 2 (creases along u) or
+    /// edges 1 and 3 (creases along v).
+    ///
+    /// @param sharpnessLower  The sharpness of the crease at the lower
+    ///                        parameter across the creases (edge 0 or 3)
+    ///
+    /// @param sharpnessUpper  The sharpness of the crease at the upper
+    ///                        parameter across the creases (edge 2 or 1)
+    ///
+    static float EncodeDoubleCreaseSharpness(float sharpnessLower,
+                                             float sharpnessUpper);
+
+    /// \brief Decodes the two crease sharpness of a double-crease patch,
+    ///        returning false if \p value is not of a double-crease patch
+    static bool DecodeDoubleCreaseSharpness(float value, float sharpness[2]);
     //@}
 
 
@@ -324,6 +454,17 @@ public:
     /// \brief Returns the number of face-varying channels
     int GetNumFVarChannels() const;
 
+    /// \brief Returns the first channel whose patch data is shared with
+    /// \p channel (or \p channel itself when its data is not shared)
+    ///
+    /// Channels of the refiner with identical face-varying topology and
+    /// interpolation have identical patches, so the PatchTableFactory stores
+    /// their value indices, patch params and local point stencils once.  All
+    /// accessors of a shared channel return the data of the channel returned
+    /// here, allowing clients to upload or process that data only once.
+    ///
+    int GetSharedFVarChannel(int channel = 0) const;
+
     /// \brief Returns the regular patch descriptor for \p channel
     PatchDescriptor GetFVarPatchDescriptorRegular(int channel = 0) const;
 
@@ -386,6 +527,11 @@ public:
     /// \brief Returns sharpness values table
     std::vector<float> const &GetSharpnessValues() const { return _sharpnessValues; }
 
+    /// \brief Returns the index of each patch in the table, indexed by its
+    ///        index in the order of construction (empty unless the patches
+    ///        were reordered, see PatchTableFactory::Options)
+    std::vector<Index> const &GetPatchRemapTable() const { return _patchRemap; }
+
     typedef std::vector<unsigned int> QuadOffsetsTable;
 
     /// \brief Returns the quad-offsets table
@@ -529,6 +675,9 @@ public:
 protected:
 
     friend class PatchTableBuilder;
+    friend class PatchTableFactory;
+    friend class PatchTableSerializer;
+    friend class TopologyEditor;
 
     // Factory constructor
     PatchTable(int maxvalence);
@@ -581,6 +730,8 @@ private:
     FVarPatchChannel const & getFVarPatchChannel(int channel) const;
 
     void allocateFVarPatchChannels(int numChannels);
+    void shareFVarPatchChannels(std::vector<int> const & channelData);
+    int  getFVarChannelData(int channel) const;
     void allocateFVarPatchChannelValues(
         PatchDescriptor regDesc, PatchDescriptor irregDesc,
         int numPatches, int channel);
@@ -627,6 +778,41 @@ private:
         template <typename REAL> StencilTableReal<REAL> * Get() const;
     };
 
+    //
+    //  Spatially coherent ordering of the patches of each array (see
+    //  PatchTableFactory::Options::spatialPatchOrder):
+    //
+    void reorderPatches();
+
+    //
+    //  Index of the patches of each ptex face (see
+    //  PatchTableFactory::Options::generatePtexFacePatches):
+    //
+    void indexPtexFacePatches(int numThreads);
+
+    //
+    //  Memory reported to the client (see SetMemoryStatsCallbacks()):
+    //
+    void updateMemoryStats();
+
+    //
+    //  Serialization to/from a flat binary buffer (see PatchTableSerializer):
+    //
+    void write(Vtr::internal::BinaryWriter & stream) const;
+    bool read(Vtr::internal::BinaryReader & stream);
+
+    void writeStencilTable(Vtr::internal::BinaryWriter & stream,
+            StencilTablePtr const & table, bool isDouble) const;
+    bool readStencilTable(Vtr::internal::BinaryReader & stream,
+            StencilTablePtr & table, bool isDouble);
+
+    //
+    //  Update of local points from raw float buffers:
+    //
+    void computeLocalPointValues(StencilTablePtr const & table, bool isDouble,
+            float const * src, int srcStride, float * dst, int dstStride,
+            int length, int numThreads) const;
+
 private:
 
     //
@@ -668,12 +854,29 @@ private:
 
     std::vector<StencilTablePtr> _localPointFaceVaryingStencils;
 
+    //  Index of the (possibly shared) data above for each face-varying channel:
+    std::vector<int> _fvarChannelData;
+
     //
     // 'single-crease' patch sharpness tables
     //
     std::vector<Index>   _sharpnessIndices; // Indices of single-crease sharpness (one per patch)
     std::vector<float>   _sharpnessValues;  // Sharpness values.
 
+    //
+    // Spatially coherent patch order -- index of each patch in the table by
+    // its index in the order of construction
+    //
+    std::vector<Index>   _patchRemap;
+
+    //
+    // Patches of each ptex face -- the handles of face i start at offset i
+    //
+    std::vector<Index>       _ptexFacePatchOffsets;
+    std::vector<PatchHandle> _ptexFacePatches;
+
+    internal::MemoryStats _memoryStats;
+
     //
     //  Construction history -- relevant to at least one public query:
     //
@@ -740,9 +943,10 @@ PatchTable::GetLocalPointVaryingStencilTable() const {
 inline StencilTable const *
 PatchTable::GetLocalPointFaceVaryingStencilTable(int channel) const {
     assert(LocalPointFaceVaryingStencilPrecisionMatchesType<float>());
-    if (channel >= 0 && channel < (int)_localPointFaceVaryingStencils.size()) {
+    int data = getFVarChannelData(channel);
+    if (data >= 0 && data < (int)_localPointFaceVaryingStencils.size()) {
         return static_cast<StencilTable const *>(
-                _localPointFaceVaryingStencils[channel].Get<float>());
+                _localPointFaceVaryingStencils[data].Get<float>());
     }
     return NULL;
 }
@@ -763,8 +967,9 @@ template <typename REAL>
 inline StencilTableReal<REAL> const *
 PatchTable::GetLocalPointFaceVaryingStencilTable(int channel) const {
     assert(LocalPointFaceVaryingStencilPrecisionMatchesType<REAL>());
-    if (channel >= 0 && channel < (int)_localPointFaceVaryingStencils.size()) {
-        return _localPointFaceVaryingStencils[channel].Get<REAL>();
+    int data = getFVarChannelData(channel);
+    if (data >= 0 && data < (int)_localPointFaceVaryingStencils.size()) {
+        return _localPointFaceVaryingStencils[data].Get<REAL>();
     }
     return NULL;
 }
@@ -795,9 +1000,10 @@ template <class T>
 inline void
 PatchTable::ComputeLocalPointValuesFaceVarying(T const *src, T *dst, int channel) const {
     assert(LocalPointFaceVaryingStencilPrecisionMatchesType<float>());
-    if (channel >= 0 && channel < (int)_localPointFaceVaryingStencils.size()) {
-        if (_localPointFaceVaryingStencils[channel]) {
-            _localPointFaceVaryingStencils[channel].Get<float>()->UpdateValues(src, dst);
+    int data = getFVarChannelData(channel);
+    if (data >= 0 && data < (int)_localPointFaceVaryingStencils.size()) {
+        if (_localPointFaceVaryingStencils[data]) {
+            _localPointFaceVaryingStencils[data].Get<float>()->UpdateValues(src, dst);
         }
     }
 }
@@ -22,9 +22,12 @@
 //   language governing permissions and limitations under the Apache License.
 //
 #include "../far/patchTableFactory.h"
+#include "../far/buildMonitor.h"
 #include "../far/patchBuilder.h"
 #include "../far/error.h"
+#include "../far/trace.h"
 #include "../far/ptexIndices.h"
+#include "../far/stencilTableFactory.h"
 #include "../far/topologyRefiner.h"
 #include "../vtr/level.h"
 #include "../vtr/fvarLevel.h"
@@ -111,6 +114,10 @@ public:
 
     void BuildUniformPolygons();
     void BuildPatches();
+    void CountPatches(PatchTableFactory::PatchCounts & counts);
+
+    //  Gather the patches of each base face up to a level of its own:
+    void SetFaceLevels(int const faceLevels[]);
 
     PatchTable * GetPatchTable() const { return _table; };
 
@@ -130,11 +137,23 @@ private:
     //  may be shared (between vertex and face-varying patches):
     struct PatchInfo {
         PatchInfo() : isRegular(false), isRegSingleCrease(false),
+                      isIrregApprox(false),
                       regBoundaryMask(0), regSharpness(0.0f),
-                      paramBoundaryMask(0) { }
+                      paramBoundaryMask(0),
+                      fMatrixShared(0), dMatrixShared(0) { }
+
+        //  The conversion matrix is either assigned to the local matrix or
+        //  shared from those cached by the PatchBuilder:
+        SparseMatrix<float> const &  getFMatrix() const {
+            return fMatrixShared ? *fMatrixShared : fMatrix;
+        }
+        SparseMatrix<double> const & getDMatrix() const {
+            return dMatrixShared ? *dMatrixShared : dMatrix;
+        }
 
         bool         isRegular;
         bool         isRegSingleCrease;
+        bool         isIrregApprox;     // irregular in the regular basis
         int          regBoundaryMask;
         float        regSharpness;
         Level::VSpan irregCornerSpans[4];
@@ -142,6 +161,9 @@ private:
 
         SparseMatrix<float>  fMatrix;
         SparseMatrix<double> dMatrix;
+
+        SparseMatrix<float>  const * fMatrixShared;
+        SparseMatrix<double> const * dMatrixShared;
     };
 
 private:
@@ -271,7 +293,8 @@ private:
     //
     class LegacyGregoryHelper {
     public:
-        LegacyGregoryHelper(TopologyRefiner const & ref) : _refiner(ref) { }
+        LegacyGregoryHelper(TopologyRefiner const & ref, int patchLevel) :
+            _refiner(ref), _patchLevel(patchLevel) { }
         ~LegacyGregoryHelper() { }
 
     public:
@@ -284,6 +307,7 @@ private:
                                    int lastLevelVertOffset);
     private:
         TopologyRefiner const& _refiner;
+        int                    _patchLevel;
         std::vector<Index> _interiorFaceIndices;
         std::vector<Index> _boundaryFaceIndices;
     };
@@ -292,6 +316,9 @@ private:
     //  Builder methods for internal use:
 
     //  Simple queries:
+    bool doFVarChannelsMatch(int refinerChannel0, int refinerChannel1) const;
+    void shareMatchingFVarChannels();
+
     int getRefinerFVarChannel(int fvcInTable) const {
         return (fvcInTable >= 0) ? _fvarChannelIndices[fvcInTable] : -1;
     }
@@ -308,9 +335,32 @@ private:
             getRefinerFVarChannel(fvcInTable));
     }
 
+    //  Face-varying patches share the info of the vertex patch when their
+    //  topology and precision match (and the vertex patch uses the end-cap
+    //  type of the face-varying patches):
+    bool doesFVarPatchInfoMatch(PatchTuple const & patch,
+                                PatchInfo const & patchInfo, int fvcInTable) {
+        return (_options.patchPrecisionDouble ==
+                _options.fvarPatchPrecisionDouble) &&
+               !patchInfo.isIrregApprox &&
+               doesFVarTopologyMatch(patch, fvcInTable);
+    }
+
+    bool isIrregularPatchApproximated(int levelIndex, Index faceIndex,
+            Vtr::internal::Level::VSpan const cornerSpans[]) const {
+        int deviation = _patchBuilder->GetIrregularPatchValenceDeviation(
+            levelIndex, faceIndex, cornerSpans);
+        return (deviation >= 0) &&
+               (deviation <= (int) _options.maxApproxEndCapValenceDeviation);
+    }
+
     //  Methods for identifying and assigning patch-related data:
     void identifyPatchTopology(PatchTuple const & patch, PatchInfo & patchInfo,
                                int fvcInTable = -1);
+    void identifyPatchTopologies(int patchBegin, int patchEnd,
+                                 PatchInfo patchInfos[],
+                                 PatchInfo fvarPatchInfos[],
+                                 int numThreads);
 
     int assignPatchPointsAndStencils(PatchTuple const & patch,
                                      PatchInfo const & patchInfo,
@@ -328,6 +378,10 @@ private:
     void findDescendantPatches(int levelIndex, Index faceIndex, int targetLevel);
     void populatePatches();
 
+    //  Methods for levels of detail per base face:
+    Index getBaseFace(int levelIndex, Index faceIndex) const;
+    int getFaceLevelTransitionMask(int levelIndex, Index faceIndex) const;
+
     void allocateVertexTables();
     void allocateFVarChannels();
 
@@ -340,10 +394,19 @@ private:
     Options const           _options;
     ConstIndexArray         _selectedFaces;
 
+    //  Deepest level from which patches are gathered (may be less than the
+    //  last level of an adaptive refinement for a lower level of detail):
+    int _maxPatchLevel;
+
+    //  Deepest level from which the patches of each base face are gathered
+    //  (empty unless levels of detail are given per base face):
+    std::vector<int> _faceLevels;
+
     // Flags indicating the need for processing based on provided options
     unsigned int _requiresLocalPoints          : 1;
     unsigned int _requiresRegularLocalPoints   : 1;
     unsigned int _requiresIrregularLocalPoints : 1;
+    unsigned int _requiresIrregularApprox      : 1;
     unsigned int _requiresSharpnessArray       : 1;
     unsigned int _requiresFVarPatches          : 1;
     unsigned int _requiresVaryingPatches       : 1;
@@ -363,6 +426,7 @@ private:
 
     int _numRegularPatches;
     int _numIrregularPatches;
+    int _numIrregularApproxPatches;
 
     // Vectors for remapping indices of vertices and fvar values as well
     // as the fvar channels (when a subset is chosen)
@@ -370,6 +434,10 @@ private:
     std::vector< std::vector<int> > _levelFVarValueOffsets;
     std::vector<int>                _fvarChannelIndices;
 
+    // Index of the unique fvar channel (above) whose data is shared by each
+    // of the channels selected for the table:
+    std::vector<int>                _fvarChannelData;
+
     // State and helpers for legacy features
     bool                  _requiresLegacyGregoryTables;
     LegacyGregoryHelper * _legacyGregoryHelper;
@@ -379,8 +447,11 @@ private:
 PatchTableBuilder::PatchTableBuilder(
     TopologyRefiner const & refiner, Options opts, ConstIndexArray faces) :
     _refiner(refiner), _options(opts), _selectedFaces(faces),
+    _maxPatchLevel(refiner.IsUniform() ? (int) opts.maxIsolationLevel :
+                   std::min((int) opts.maxIsolationLevel, refiner.GetMaxLevel())),
     _table(0), _patchBuilder(0), _ptexIndices(refiner),
     _numRegularPatches(0), _numIrregularPatches(0),
+    _numIrregularApproxPatches(0),
     _legacyGregoryHelper(0) {
 
     if (_options.generateFVarTables) {
@@ -396,6 +467,7 @@ PatchTableBuilder::PatchTableBuilder(
                 _options.fvarChannelIndices,
                 _options.fvarChannelIndices + _options.numFVarChannels);
         }
+        shareMatchingFVarChannels();
     }
 
     //
@@ -427,6 +499,7 @@ PatchTableBuilder::PatchTableBuilder(
     patchOptions.approxInfSharpWithSmooth    = !_options.useInfSharpPatch;
     patchOptions.approxSmoothCornerWithSharp =
         _options.generateLegacySharpCornerPatches;
+    patchOptions.cacheConversionMatrices     = true;
 
     _patchBuilder = PatchBuilder::Create(_refiner, patchOptions);
 
@@ -435,12 +508,25 @@ PatchTableBuilder::PatchTableBuilder(
     //
     _requiresRegularLocalPoints =
         (patchOptions.regBasisType != PatchBuilder::BASIS_REGULAR);
+    //  Patches of linear schemes are all regular (irregular faces are not
+    //  patches), so no local point tables are created for them:
     _requiresIrregularLocalPoints =
-        (_options.GetEndCapType() != Options::ENDCAP_LEGACY_GREGORY);
+        (_options.GetEndCapType() != Options::ENDCAP_LEGACY_GREGORY) &&
+        (Sdc::SchemeTypeTraits::GetLocalNeighborhoodSize(
+            _refiner.GetSchemeType()) > 0);
     _requiresLocalPoints =
         _requiresIrregularLocalPoints || _requiresRegularLocalPoints;
 
-    _requiresSharpnessArray = _options.useSingleCreasePatch;
+    //  Irregular patches close to regular in the regular basis rather than
+    //  Gregory (uniform tables have no end-caps):
+    _requiresIrregularApprox = _options.approxEndCapsWithBSpline &&
+        !_refiner.IsUniform() &&
+        (_options.GetEndCapType() == Options::ENDCAP_GREGORY_BASIS) &&
+        (_patchBuilder->GetRegularPatchType() !=
+         _patchBuilder->GetIrregularPatchType());
+
+    _requiresSharpnessArray = _options.useSingleCreasePatch ||
+                              _options.useDoubleCreasePatch;
     _requiresFVarPatches = ! _fvarChannelIndices.empty();
 
     _requiresVaryingPatches = _options.generateVaryingTables;
@@ -470,7 +556,7 @@ PatchTableBuilder::PatchTableBuilder(
         (_options.GetEndCapType() == Options::ENDCAP_LEGACY_GREGORY);
 
     if (_requiresLegacyGregoryTables) {
-        _legacyGregoryHelper = new LegacyGregoryHelper(_refiner);
+        _legacyGregoryHelper = new LegacyGregoryHelper(_refiner, _maxPatchLevel);
     }
 
 }
@@ -498,6 +584,8 @@ PatchTableBuilder::identifyPatchTopology(PatchTuple const & patch,
                          ? _options.patchPrecisionDouble
                          : _options.fvarPatchPrecisionDouble;
 
+    patchInfo.isIrregApprox = false;
+
     if (patchInfo.isRegular) {
         patchInfo.regBoundaryMask = _patchBuilder->GetRegularPatchBoundaryMask(
             patchLevel, patchFace, fvarInRefiner);
@@ -521,36 +609,116 @@ PatchTableBuilder::identifyPatchTopology(PatchTuple const & patch,
         //  patches (maintaining continuity with other semi-sharp patches
         //  also reduced to regular).
         //
+        //  Double-crease patches are clamped similarly, their two sharpness
+        //  values encoded in the single sharpness value of the patch (see
+        //  PatchTable::EncodeDoubleCreaseSharpness()).
+        //
         if (_requiresSharpnessArray &&
                 (patchInfo.regBoundaryMask == 0) && (fvarInRefiner < 0)) {
             if (patchLevel < (int) _options.maxIsolationLevel) {
+                float maxSharpness =
+                    (float)(_options.maxIsolationLevel - patchLevel);
+
                 PatchBuilder::SingleCreaseInfo creaseInfo;
+                PatchBuilder::DoubleCreaseInfo doubleCreaseInfo;
 
-                if (_patchBuilder->IsRegularSingleCreasePatch(
+                if (_options.useSingleCreasePatch &&
+                    _patchBuilder->IsRegularSingleCreasePatch(
                         patchLevel, patchFace, creaseInfo)) {
                     creaseInfo.creaseSharpness =
-                        std::min(creaseInfo.creaseSharpness,
-                             (float)(_options.maxIsolationLevel - patchLevel));
+                        std::min(creaseInfo.creaseSharpness, maxSharpness);
 
                     patchInfo.isRegSingleCrease = true;
                     patchInfo.regSharpness      = creaseInfo.creaseSharpness;
                     patchInfo.paramBoundaryMask = (1 << creaseInfo.creaseEdgeInFace);
+                } else if (_options.useDoubleCreasePatch &&
+                    _patchBuilder->IsRegularDoubleCreasePatch(
+                        patchLevel, patchFace, doubleCreaseInfo)) {
+                    //  The crease along edge 0 or 3 is the lower one:
+                    int   creaseEdge = doubleCreaseInfo.creaseEdgeInFace;
+                    float sharpness0 = std::min(
+                        doubleCreaseInfo.creaseSharpness[0], maxSharpness);
+                    float sharpness2 = std::min(
+                        doubleCreaseInfo.creaseSharpness[1], maxSharpness);
+
+                    patchInfo.regSharpness = (creaseEdge == 0)
+                        ? PatchTable::EncodeDoubleCreaseSharpness(sharpness0, sharpness2)
+                        : PatchTable::EncodeDoubleCreaseSharpness(sharpness2, sharpness0);
+                    patchInfo.paramBoundaryMask = (5 << creaseEdge);
                 }
             }
         }
-    } else if (_requiresIrregularLocalPoints) {
-        _patchBuilder->GetIrregularPatchCornerSpans(
-            patchLevel, patchFace, patchInfo.irregCornerSpans, fvarInRefiner);
+    } else {
+        //  Clear the properties of regular patches so that nothing is
+        //  inherited from a previously identified patch:
+        patchInfo.isRegSingleCrease = false;
+        patchInfo.regSharpness      = 0.0f;
+        patchInfo.paramBoundaryMask = 0;
 
-        if (useDoubleMatrix) {
-            _patchBuilder->GetIrregularPatchConversionMatrix(
-                patchLevel, patchFace, patchInfo.irregCornerSpans, patchInfo.dMatrix);
-        } else {
-            _patchBuilder->GetIrregularPatchConversionMatrix(
-                patchLevel, patchFace, patchInfo.irregCornerSpans, patchInfo.fMatrix);
+        if (_requiresIrregularLocalPoints) {
+            _patchBuilder->GetIrregularPatchCornerSpans(
+                patchLevel, patchFace, patchInfo.irregCornerSpans, fvarInRefiner);
+
+            patchInfo.isIrregApprox = _requiresIrregularApprox &&
+                (fvarInRefiner < 0) && isIrregularPatchApproximated(
+                    patchLevel, patchFace, patchInfo.irregCornerSpans);
+
+            PatchDescriptor::Type patchType = patchInfo.isIrregApprox
+                                            ? _patchBuilder->GetRegularPatchType()
+                                            : _patchBuilder->GetIrregularPatchType();
+
+            //  Refer to a shared matrix rather than copying it when possible:
+            if (useDoubleMatrix) {
+                SparseMatrix<double> const & dMatrix =
+                    _patchBuilder->AcquireIrregularPatchConversionMatrix(
+                        patchLevel, patchFace, patchInfo.irregCornerSpans,
+                        patchType, patchInfo.dMatrix);
+                patchInfo.dMatrixShared =
+                    (&dMatrix != &patchInfo.dMatrix) ? &dMatrix : 0;
+            } else {
+                SparseMatrix<float> const & fMatrix =
+                    _patchBuilder->AcquireIrregularPatchConversionMatrix(
+                        patchLevel, patchFace, patchInfo.irregCornerSpans,
+                        patchType, patchInfo.fMatrix);
+                patchInfo.fMatrixShared =
+                    (&fMatrix != &patchInfo.fMatrix) ? &fMatrix : 0;
+            }
         }
+    }
+}
 
-        patchInfo.paramBoundaryMask = 0;
+//
+//  Identifies the topology of a range of patches concurrently -- the vertex
+//  patch info is assigned to consecutive elements of the given array and
+//  the info for each non-linear face-varying channel (when not matching
+//  the vertex topology) to consecutive groups of elements per patch:
+//
+void
+PatchTableBuilder::identifyPatchTopologies(int patchBegin, int patchEnd,
+        PatchInfo patchInfos[], PatchInfo fvarPatchInfos[], int numThreads) {
+
+    int numFVarChannels = (int)_fvarChannelIndices.size();
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic, 16) num_threads(numThreads)
+#else
+    (void)numThreads;
+#endif
+    for (int patchIndex = patchBegin; patchIndex < patchEnd; ++patchIndex) {
+        PatchTuple const & patch = _patches[patchIndex];
+
+        int infoIndex = patchIndex - patchBegin;
+
+        identifyPatchTopology(patch, patchInfos[infoIndex]);
+
+        for (int fvc = 0; fvc < numFVarChannels; ++fvc) {
+            if (isFVarChannelLinear(fvc)) continue;
+
+            if (!doesFVarPatchInfoMatch(patch, patchInfos[infoIndex], fvc)) {
+                identifyPatchTopology(patch,
+                    fvarPatchInfos[infoIndex * numFVarChannels + fvc], fvc);
+            }
+        }
     }
 }
 
@@ -623,11 +791,11 @@ PatchTableBuilder::assignPatchPointsAndStencils(PatchTuple const & patch,
     } else if (_requiresIrregularLocalPoints) {
         int numSourcePoints = 0;
         if (useDoubleMatrix) {
-            numSourcePoints = patchInfo.dMatrix.GetNumColumns();
-            numPatchPoints  = patchInfo.dMatrix.GetNumRows();
+            numSourcePoints = patchInfo.getDMatrix().GetNumColumns();
+            numPatchPoints  = patchInfo.getDMatrix().GetNumRows();
         } else {
-            numSourcePoints = patchInfo.fMatrix.GetNumColumns();
-            numPatchPoints  = patchInfo.fMatrix.GetNumRows();
+            numSourcePoints = patchInfo.getFMatrix().GetNumColumns();
+            numPatchPoints  = patchInfo.getFMatrix().GetNumRows();
         }
 
         StackBuffer<Index,64,true> sourcePoints(numSourcePoints);
@@ -636,15 +804,18 @@ PatchTableBuilder::assignPatchPointsAndStencils(PatchTuple const & patch,
                 patch.levelIndex, patch.faceIndex,
                 patchInfo.irregCornerSpans, sourcePoints, fvarInRefiner);
 
+        PatchDescriptor::Type patchType = patchInfo.isIrregApprox
+                                        ? _patchBuilder->GetRegularPatchType()
+                                        : _patchBuilder->GetIrregularPatchType();
         if (useDoubleMatrix) {
             localHelper.AppendLocalPatchPoints(
                     patch.levelIndex, patch.faceIndex,
-                    patchInfo.dMatrix, _patchBuilder->GetIrregularPatchType(),
+                    patchInfo.getDMatrix(), patchType,
                     sourcePoints, sourcePointOffset, patchPoints);
         } else {
             localHelper.AppendLocalPatchPoints(
                     patch.levelIndex, patch.faceIndex,
-                    patchInfo.fMatrix, _patchBuilder->GetIrregularPatchType(),
+                    patchInfo.getFMatrix(), patchType,
                     sourcePoints, sourcePointOffset, patchPoints);
         }
     }
@@ -703,6 +874,56 @@ PatchTableBuilder::allocateVertexTables() {
     }
 }
 
+//
+//  Face-varying channels with identical topology and interpolation will have
+//  identical patches -- the topology of all refined levels is determined by
+//  the values assigned to the faces of the base level:
+//
+bool
+PatchTableBuilder::doFVarChannelsMatch(int channel0, int channel1) const {
+
+    if (channel0 == channel1) return true;
+
+    if (_refiner.GetFVarLinearInterpolation(channel0) !=
+        _refiner.GetFVarLinearInterpolation(channel1)) return false;
+
+    TopologyLevel const & baseLevel = _refiner.GetLevel(0);
+    if (baseLevel.GetNumFVarValues(channel0) !=
+        baseLevel.GetNumFVarValues(channel1)) return false;
+
+    for (int face = 0; face < baseLevel.GetNumFaces(); ++face) {
+        ConstIndexArray fValues0 = baseLevel.GetFaceFVarValues(face, channel0);
+        ConstIndexArray fValues1 = baseLevel.GetFaceFVarValues(face, channel1);
+        if (std::memcmp(&fValues0[0], &fValues1[0],
+                        fValues0.size() * sizeof(Index))) return false;
+    }
+    return true;
+}
+
+//
+//  Reduce the selected channels to those that are unique and identify the
+//  unique channel shared by each selected channel:
+//
+void
+PatchTableBuilder::shareMatchingFVarChannels() {
+
+    std::vector<int> selectedChannels;
+    selectedChannels.swap(_fvarChannelIndices);
+
+    _fvarChannelData.resize(selectedChannels.size());
+    for (int fvc = 0; fvc < (int)selectedChannels.size(); ++fvc) {
+        int unique = 0;
+        for ( ; unique < (int)_fvarChannelIndices.size(); ++unique) {
+            if (doFVarChannelsMatch(selectedChannels[fvc],
+                                    _fvarChannelIndices[unique])) break;
+        }
+        if (unique == (int)_fvarChannelIndices.size()) {
+            _fvarChannelIndices.push_back(selectedChannels[fvc]);
+        }
+        _fvarChannelData[fvc] = unique;
+    }
+}
+
 //
 //  Allocate face-varying tables
 //
@@ -909,13 +1130,84 @@ PatchTableBuilder::BuildUniformPolygons() {
             }
         }
     }
+
+    //  The unique channels populated are shared once complete:
+    if (_requiresFVarPatches) {
+        _table->shareFVarPatchChannels(_fvarChannelData);
+    }
 }
 
 void
 PatchTableBuilder::BuildPatches() {
 
+    {
+        OPENSUBDIV_TRACE_SCOPE("patchTable.identify");
+        identifyPatches();
+    }
+
+    //  The incomplete table of a cancelled build is discarded by the factory:
+    if (_options.monitor && _options.monitor->IsCancelled()) return;
+
+    {
+        OPENSUBDIV_TRACE_SCOPE("patchTable.populate");
+        populatePatches();
+    }
+
+    //  The unique channels populated are shared once complete:
+    if (_requiresFVarPatches) {
+        _table->shareFVarPatchChannels(_fvarChannelData);
+    }
+}
+
+void
+PatchTableBuilder::CountPatches(PatchTableFactory::PatchCounts & counts) {
+
+    counts = PatchTableFactory::PatchCounts();
+
+    if (_buildUniformLinear) {
+        bool triangulateQuads =
+            _options.triangulateQuads && (_patchBuilder->GetRegularFaceSize() == 4);
+
+        int maxlevel = _refiner.GetMaxLevel(),
+            firstlevel = _options.generateAllLevels ? 1 : maxlevel;
+
+        int npatches = 0;
+        for (int level = firstlevel; level <= maxlevel; ++level) {
+            TopologyLevel const & refLevel = _refiner.GetLevel(level);
+
+            npatches += refLevel.GetNumFaces();
+            if (_refiner.HasHoles()) {
+                for (int i = refLevel.GetNumFaces() - 1; i >= 0; --i) {
+                    npatches -= refLevel.IsFaceHole(i);
+                }
+            }
+        }
+        counts.regularPatchType = triangulateQuads
+                                ? PatchDescriptor::TRIANGLES
+                                : _patchBuilder->GetLinearPatchType();
+        counts.numRegularPatches = triangulateQuads ? (2 * npatches) : npatches;
+        return;
+    }
+
     identifyPatches();
-    populatePatches();
+
+    counts.regularPatchType    = _patchBuilder->GetRegularPatchType();
+    counts.irregularPatchType  = _requiresLegacyGregoryTables
+                               ? PatchDescriptor::GREGORY
+                               : _patchBuilder->GetIrregularPatchType();
+    counts.numRegularPatches   = _numRegularPatches + _numIrregularApproxPatches;
+    counts.numIrregularPatches = _numIrregularPatches - _numIrregularApproxPatches;
+
+    if (_requiresLocalPoints) {
+        //  The options of the LocalPointHelper in populatePatches():
+        LocalPointHelper::Options opts;
+        opts.shareLocalPoints  = _options.shareEndCapPatchPoints;
+        opts.reuseSourcePoints = (_patchBuilder->GetIrregularPatchType() ==
+                                  _patchBuilder->GetNativePatchType() ) ||
+                                 _requiresIrregularApprox;
+
+        counts.numLocalPoints = estimateLocalPointCount(opts, -1);
+    }
 }
 
 //
@@ -938,6 +1230,18 @@ PatchTableBuilder::appendPatch(int levelIndex, Index faceIndex) {
         if (_requiresLegacyGregoryTables) {
             _legacyGregoryHelper->AddPatchFace(levelIndex, faceIndex);
         }
+
+        //  Irregular patches approximated in the regular basis are packed
+        //  with the regular patches:
+        if (_requiresIrregularApprox) {
+            Vtr::internal::Level::VSpan cornerSpans[4];
+            _patchBuilder->GetIrregularPatchCornerSpans(
+                levelIndex, faceIndex, cornerSpans);
+            if (isIrregularPatchApproximated(levelIndex, faceIndex,
+                                             cornerSpans)) {
+                ++_numIrregularApproxPatches;
+            }
+        }
     }
 }
 
@@ -963,6 +1267,90 @@ PatchTableBuilder::findDescendantPatches(int levelIndex, Index faceIndex, int ta
     }
 }
 
+void
+PatchTableBuilder::SetFaceLevels(int const faceLevels[]) {
+
+    TopologyLevel const & baseLevel = _refiner.GetLevel(0);
+    int numFaces = baseLevel.GetNumFaces();
+    int regFaceSize = Sdc::SchemeTypeTraits::GetRegularFaceSize(
+                            _refiner.GetSchemeType());
+
+    //  Clamp the levels to those refined -- faces of irregular size are not
+    //  patches before their first level of refinement:
+    _faceLevels.assign(faceLevels, faceLevels + numFaces);
+    for (Index face = 0; face < numFaces; ++face) {
+        int minLevel = (baseLevel.GetFaceVertices(face).size() != regFaceSize)
+                     ? std::min(1, _maxPatchLevel) : 0;
+        _faceLevels[face] = std::max(minLevel,
+                            std::min(_faceLevels[face], _maxPatchLevel));
+    }
+
+    //  Transition patches only account for neighboring patches one level
+    //  deeper, so the levels of faces sharing an edge may differ by at most
+    //  one.  Lower levels are raised until so, propagating from each face
+    //  raised:
+    std::vector<Index> faceStack(numFaces);
+    for (Index face = 0; face < numFaces; ++face) {
+        faceStack[face] = numFaces - 1 - face;
+    }
+    while (!faceStack.empty()) {
+        Index face = faceStack.back();
+        faceStack.pop_back();
+
+        int minNeighborLevel = _faceLevels[face] - 1;
+
+        ConstIndexArray fEdges = baseLevel.GetFaceEdges(face);
+        for (int i = 0; i < fEdges.size(); ++i) {
+            ConstIndexArray eFaces = baseLevel.GetEdgeFaces(fEdges[i]);
+            for (int j = 0; j < eFaces.size(); ++j) {
+                if (_faceLevels[eFaces[j]] < minNeighborLevel) {
+                    _faceLevels[eFaces[j]] = minNeighborLevel;
+                    faceStack.push_back(eFaces[j]);
+                }
+            }
+        }
+    }
+}
+
+Index
+PatchTableBuilder::getBaseFace(int levelIndex, Index faceIndex) const {
+
+    for (int i = levelIndex; i > 0; --i) {
+        faceIndex = _refiner.GetLevel(i).GetFaceParentFace(faceIndex);
+    }
+    return faceIndex;
+}
+
+int
+PatchTableBuilder::getFaceLevelTransitionMask(int levelIndex,
+                                              Index faceIndex) const {
+
+    //
+    //  The patches across an edge are one level deeper when the face across
+    //  it was refined and the level of detail of its base face exceeds the
+    //  level of the patch (the levels of neighboring base faces differing by
+    //  at most one):
+    //
+    if (levelIndex >= _refiner.GetMaxLevel()) return 0;
+
+    TopologyLevel const & level = _refiner.GetLevel(levelIndex);
+
+    int transitionMask = 0;
+
+    ConstIndexArray fEdges = level.GetFaceEdges(faceIndex);
+    for (int i = 0; i < fEdges.size(); ++i) {
+        ConstIndexArray eFaces = level.GetEdgeFaces(fEdges[i]);
+        for (int j = 0; j < eFaces.size(); ++j) {
+            if ((eFaces[j] != faceIndex) &&
+                !_patchBuilder->IsFaceALeaf(levelIndex, eFaces[j]) &&
+                (levelIndex < _faceLevels[getBaseFace(levelIndex, eFaces[j])])) {
+                transitionMask |= 1 << i;
+            }
+        }
+    }
+    return transitionMask;
+}
+
 void
 PatchTableBuilder::identifyPatches() {
 
@@ -991,33 +1379,42 @@ PatchTableBuilder::identifyPatches() {
 
     //
     //  If a set of selected base faces is present, identify the patches
-    //  depth first.  Otherwise search breadth first through the levels:
+    //  depth first.  Otherwise search breadth first through the levels --
+    //  all patches of a uniform refinement are in its last level, while for
+    //  adaptive refinement, faces in the last patch level are patches whether
+    //  or not they were refined further (i.e. a lower level of detail):
     //
-    int uniformLevel = _refiner.IsUniform() ? _options.maxIsolationLevel : -1;
-
     _patches.reserve(_refiner.GetNumFacesTotal());
 
-    if (_selectedFaces.size()) {
+    if (!_faceLevels.empty()) {
+        int numFaces = _selectedFaces.size() ? _selectedFaces.size()
+                     : _refiner.GetLevel(0).GetNumFaces();
+        for (int i = 0; i < numFaces; ++i) {
+            Index baseFace = _selectedFaces.size() ? _selectedFaces[i] : i;
+            findDescendantPatches(0, baseFace, _faceLevels[baseFace]);
+        }
+    } else if (_selectedFaces.size()) {
         for (int i = 0; i < (int)_selectedFaces.size(); ++i) {
-            findDescendantPatches(0, _selectedFaces[i], uniformLevel);
+            findDescendantPatches(0, _selectedFaces[i], _maxPatchLevel);
         }
-    } else if (uniformLevel >= 0) {
-        int numFaces = _refiner.getLevel(uniformLevel).getNumFaces();
+    } else if (_refiner.IsUniform()) {
+        int numFaces = _refiner.getLevel(_maxPatchLevel).getNumFaces();
 
         for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
 
-            if (_patchBuilder->IsFaceAPatch(uniformLevel, faceIndex)) {
-                appendPatch(uniformLevel, faceIndex);
+            if (_patchBuilder->IsFaceAPatch(_maxPatchLevel, faceIndex)) {
+                appendPatch(_maxPatchLevel, faceIndex);
             }
         }
     } else {
-        for (int levelIndex=0; levelIndex<_refiner.GetNumLevels(); ++levelIndex) {
+        for (int levelIndex=0; levelIndex<=_maxPatchLevel; ++levelIndex) {
             int numFaces = _refiner.getLevel(levelIndex).getNumFaces();
 
             for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
 
                 if (_patchBuilder->IsFaceAPatch(levelIndex, faceIndex) &&
-                    _patchBuilder->IsFaceALeaf(levelIndex, faceIndex)) {
+                    ((levelIndex == _maxPatchLevel) ||
+                     _patchBuilder->IsFaceALeaf(levelIndex, faceIndex))) {
                     appendPatch(levelIndex, faceIndex);
                 }
             }
@@ -1068,10 +1465,13 @@ PatchTableBuilder::populatePatches() {
     int ARRAY_BOUNDARY  = 2; // only used by LegacyGregory
 
     arrayBuilders[ARRAY_REGULAR].patchType = _patchBuilder->GetRegularPatchType();
-    arrayBuilders[ARRAY_REGULAR].numPatches = _numRegularPatches;
+    arrayBuilders[ARRAY_REGULAR].numPatches =
+        _numRegularPatches + _numIrregularApproxPatches;
+
+    int numIrregularPatches = _numIrregularPatches - _numIrregularApproxPatches;
 
-    int numPatchArrays = (_numRegularPatches > 0);
-    if (_numIrregularPatches > 0) {
+    int numPatchArrays = (arrayBuilders[ARRAY_REGULAR].numPatches > 0);
+    if (numIrregularPatches > 0) {
         if (!_requiresLegacyGregoryTables) {
             //
             //  Pack irregular patches into same array as regular or separately:
@@ -1086,7 +1486,7 @@ PatchTableBuilder::populatePatches() {
             }
             arrayBuilders[ARRAY_IRREGULAR].patchType =
                 _patchBuilder->GetIrregularPatchType();
-            arrayBuilders[ARRAY_IRREGULAR].numPatches += _numIrregularPatches;
+            arrayBuilders[ARRAY_IRREGULAR].numPatches += numIrregularPatches;
         } else {
             //
             // Arrays for Legacy-Gregory tables -- irregular patches are split
@@ -1169,7 +1569,8 @@ PatchTableBuilder::populatePatches() {
         opts.doubleStencilTable = _options.patchPrecisionDouble;
         opts.shareLocalPoints   = _options.shareEndCapPatchPoints;
         opts.reuseSourcePoints  = (_patchBuilder->GetIrregularPatchType() ==
-                                   _patchBuilder->GetNativePatchType() );
+                                   _patchBuilder->GetNativePatchType() ) ||
+                                  _requiresIrregularApprox;
 
         vertexLocalPointHelper = new LocalPointHelper(
                 _refiner, opts, -1, estimateLocalPointCount(opts, -1));
@@ -1194,23 +1595,64 @@ PatchTableBuilder::populatePatches() {
     //  Intentionally declare local vairables to contain patch topology info
     //  outside the loop to avoid repeated memory de-allocation/re-allocation
     //  associated with a change-of-basis.
-    PatchInfo patchInfo;
-    PatchInfo fvarPatchInfo;
+    PatchInfo serialPatchInfo;
+    PatchInfo serialFVarPatchInfo;
+
+    //
+    //  When threaded, the topology of batches of patches is identified
+    //  concurrently (notably the change-of-basis matrices of irregular
+    //  patches) and the patches of the batch are then assigned serially --
+    //  local points are shared and appended in the same order as when
+    //  serial, so the resulting table is identical:
+    //
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = _options.numThreads;
+#else
+    int numThreads = 1;
+#endif
+    bool threaded = (numThreads > 1);
+
+    int numPatches      = (int)_patches.size();
+    int numFVarChannels = (int)_fvarChannelIndices.size();
+    int batchSize       = threaded ? (256 * numThreads) : 0;
+
+    std::vector<PatchInfo> batchPatchInfos(batchSize);
+    std::vector<PatchInfo> batchFVarPatchInfos(batchSize * numFVarChannels);
 
-    bool fvarPrecisionMatches = (_options.patchPrecisionDouble ==
-                                 _options.fvarPatchPrecisionDouble);
+    //  Progress is reported (and cancellation checked) between batches, or
+    //  blocks of the same size when serial:
+    int monitorInterval = threaded ? batchSize : 1024;
 
-    for (int patchIndex = 0; patchIndex < (int)_patches.size(); ++patchIndex) {
+    for (int patchIndex = 0; patchIndex < numPatches; ++patchIndex) {
 
         PatchTuple const & patch = _patches[patchIndex];
 
+        if (_options.monitor && ((patchIndex % monitorInterval) == 0) &&
+            !_options.monitor->Progress(BuildMonitor::STAGE_PATCH_TABLE,
+                    (float)patchIndex / (float)numPatches)) {
+            break;
+        }
+
         //
         //  Identify and assign points, stencils, sharpness, etc. for this patch:
         //
-        identifyPatchTopology(patch, patchInfo);
+        int batchIndex = threaded ? (patchIndex % batchSize) : 0;
+
+        if (threaded && (batchIndex == 0)) {
+            identifyPatchTopologies(patchIndex,
+                std::min(patchIndex + batchSize, numPatches),
+                &batchPatchInfos[0],
+                numFVarChannels ? &batchFVarPatchInfos[0] : 0, numThreads);
+        }
+
+        PatchInfo & patchInfo = threaded ? batchPatchInfos[batchIndex]
+                                         : serialPatchInfo;
+        if (!threaded) {
+            identifyPatchTopology(patch, patchInfo);
+        }
 
         PatchArrayBuilder * arrayBuilder = &arrayBuilders[ARRAY_REGULAR];
-        if (!patchInfo.isRegular) {
+        if (!patchInfo.isRegular && !patchInfo.isIrregApprox) {
             arrayBuilder = &arrayBuilders[ARRAY_IRREGULAR];
         }
 
@@ -1237,7 +1679,16 @@ PatchTableBuilder::populatePatches() {
         PatchParam patchParam =
             _patchBuilder->ComputePatchParam(patch.levelIndex, patch.faceIndex,
                   _ptexIndices, patchInfo.isRegular, patchInfo.paramBoundaryMask,
-                  true/* condition to compute transition mask */);
+                  _faceLevels.empty() &&
+                  patch.levelIndex < _maxPatchLevel/* compute transition mask */);
+        if (!_faceLevels.empty()) {
+            patchParam.Set(patchParam.GetFaceId(),
+                  patchParam.GetU(), patchParam.GetV(), patchParam.GetDepth(),
+                  patchParam.NonQuadRoot(), patchParam.GetBoundary(),
+                  (unsigned short) getFaceLevelTransitionMask(
+                        patch.levelIndex, patch.faceIndex),
+                  patchParam.IsRegular());
+        }
         *arrayBuilder->pptr++ = patchParam;
 
         //
@@ -1257,13 +1708,17 @@ PatchTableBuilder::populatePatches() {
                 //  topology of the face in face-varying space matches the
                 //  original patch:
                 //
-                bool fvcTopologyMatches = fvarPrecisionMatches &&
-                                          doesFVarTopologyMatch(patch, fvc);
+                bool fvcTopologyMatches =
+                    doesFVarPatchInfoMatch(patch, patchInfo, fvc);
+
+                PatchInfo & fvarPatchInfo = threaded
+                    ? batchFVarPatchInfos[batchIndex * numFVarChannels + fvc]
+                    : serialFVarPatchInfo;
 
                 PatchInfo & fvcPatchInfo = fvcTopologyMatches
                                          ? patchInfo : fvarPatchInfo;
 
-                if (!fvcTopologyMatches) {
+                if (!fvcTopologyMatches && !threaded) {
                     identifyPatchTopology(patch, fvcPatchInfo, fvc);
                 }
                 assignPatchPointsAndStencils(patch, fvcPatchInfo,
@@ -1293,6 +1748,8 @@ PatchTableBuilder::populatePatches() {
     //  Finalizing and destroying StencilTable and other helpers:
     //
     if (_requiresLocalPoints) {
+        OPENSUBDIV_TRACE_SCOPE("patchTable.endcaps");
+
         _table->_localPointStencils =
             vertexLocalPointHelper->AcquireStencilTable();
         if (_requiresVaryingLocalPoints) {
@@ -1314,7 +1771,7 @@ PatchTableBuilder::populatePatches() {
     if (_requiresLegacyGregoryTables) {
         _legacyGregoryHelper->FinalizeQuadOffsets(_table->_quadOffsetsTable);
         _legacyGregoryHelper->FinalizeVertexValence(_table->_vertexValenceTable,
-                                       _levelVertOffsets[_refiner.GetMaxLevel()]);
+                                       _levelVertOffsets[_maxPatchLevel]);
     }
 }
 
@@ -1369,6 +1826,15 @@ PatchTableBuilder::estimateLocalPointCount(
                                           _patchBuilder->GetNativePatchType())) {
             numPointsPerPatch /= 2;
         }
+
+        //  Irregular patches approximated in the native basis are similar:
+        if (_requiresIrregularApprox && (fvarChannel < 0)) {
+            int numApproxPatches = std::min(_numIrregularApproxPatches,
+                                            numIrregularPatches);
+            numIrregularPatches -= numApproxPatches;
+            estLocalPoints += numApproxPatches * PatchDescriptor(
+                _patchBuilder->GetRegularPatchType()).GetNumControlVertices() / 2;
+        }
         estLocalPoints += numIrregularPatches * numPointsPerPatch;
     } 
 
@@ -1906,8 +2372,8 @@ PatchTableBuilder::LegacyGregoryHelper::FinalizeQuadOffsets(
     if (numTotalPatches > 0) {
         qTable.resize(numTotalPatches*4);
 
-        // all patches assumed to be at the last level
-        Level const &maxLevel = _refiner.getLevel(_refiner.GetMaxLevel());
+        // all patches assumed to be at the last patch level
+        Level const &maxLevel = _refiner.getLevel(_patchLevel);
 
         PatchTable::QuadOffsetsTable::value_type *p = &(qTable[0]);
         for (size_t i = 0; i < numInteriorPatches; ++i) {
@@ -1938,7 +2404,7 @@ PatchTableBuilder::LegacyGregoryHelper::FinalizeVertexValence(
 
     vTable.resize((long)_refiner.GetNumVerticesTotal() * vWidth);
 
-    Level const & lastLevel = _refiner.getLevel(_refiner.GetMaxLevel());
+    Level const & lastLevel = _refiner.getLevel(_patchLevel);
 
     int * vTableEntry = &vTable[lastLevelOffset * vWidth];
 
@@ -1975,6 +2441,13 @@ PatchTableFactory::Create(TopologyRefiner const & refiner,
                           Options options,
                           ConstIndexArray selectedFaces) {
 
+    OPENSUBDIV_TRACE_SCOPE("patchTable.create");
+
+    if (options.monitor &&
+        !options.monitor->Progress(BuildMonitor::STAGE_PATCH_TABLE, 0.0f)) {
+        return 0;
+    }
+
     PatchTableBuilder builder(refiner, options, selectedFaces);
 
     if (builder.UniformPolygonsSpecified()) {
@@ -1982,7 +2455,330 @@ PatchTableFactory::Create(TopologyRefiner const & refiner,
     } else {
         builder.BuildPatches();
     }
-    return builder.GetPatchTable();
+    PatchTable * table = builder.GetPatchTable();
+
+    if (options.spatialPatchOrder) {
+        table->reorderPatches();
+    }
+    if (options.generatePtexFacePatches) {
+        table->indexPtexFacePatches(options.numThreads);
+    }
+
+    //  The table of a cancelled build may be incomplete and is discarded:
+    if (options.monitor &&
+        !options.monitor->Progress(BuildMonitor::STAGE_PATCH_TABLE, 1.0f)) {
+        delete table;
+        return 0;
+    }
+    table->updateMemoryStats();
+    return table;
+}
+
+void
+PatchTableFactory::CountPatches(TopologyRefiner const & refiner,
+                                PatchCounts & counts,
+                                Options options,
+                                ConstIndexArray selectedFaces) {
+
+    OPENSUBDIV_TRACE_SCOPE("patchTable.count");
+
+    PatchTableBuilder builder(refiner, options, selectedFaces);
+
+    builder.CountPatches(counts);
+
+    //  The builder's table was never populated:
+    delete builder.GetPatchTable();
+}
+
+void
+PatchTableFactory::CreateLevelsOfDetail(TopologyRefiner const & refiner,
+                                        Options options,
+                                        int numLevels,
+                                        int const isolationLevels[],
+                                        PatchTable * tables[],
+                                        ConstIndexArray selectedFaces) {
+
+    OPENSUBDIV_TRACE_SCOPE("patchTable.createLevelsOfDetail");
+
+    for (int i = 0; i < numLevels; ++i) {
+        options.maxIsolationLevel = isolationLevels[i];
+
+        tables[i] = Create(refiner, options, selectedFaces);
+    }
+}
+
+PatchTable *
+PatchTableFactory::CreateFaceLevelsOfDetail(TopologyRefiner const & refiner,
+                                            Options options,
+                                            int const faceLevels[],
+                                            ConstIndexArray selectedFaces) {
+
+    OPENSUBDIV_TRACE_SCOPE("patchTable.createFaceLevelsOfDetail");
+
+    //  Legacy Gregory patches are only supported in the last level:
+    if (refiner.IsUniform() ||
+        (options.GetEndCapType() == Options::ENDCAP_LEGACY_GREGORY)) {
+        return 0;
+    }
+    if (options.monitor &&
+        !options.monitor->Progress(BuildMonitor::STAGE_PATCH_TABLE, 0.0f)) {
+        return 0;
+    }
+
+    PatchTableBuilder builder(refiner, options, selectedFaces);
+
+    builder.SetFaceLevels(faceLevels);
+    builder.BuildPatches();
+
+    PatchTable * table = builder.GetPatchTable();
+
+    if (options.spatialPatchOrder) {
+        table->reorderPatches();
+    }
+    if (options.generatePtexFacePatches) {
+        table->indexPtexFacePatches(options.numThreads);
+    }
+
+    //  The table of a cancelled build may be incomplete and is discarded:
+    if (options.monitor &&
+        !options.monitor->Progress(BuildMonitor::STAGE_PATCH_TABLE, 1.0f)) {
+        delete table;
+        return 0;
+    }
+    table->updateMemoryStats();
+    return table;
+}
+
+PatchTable *
+PatchTableFactory::CreateRegion(TopologyRefiner const & refiner,
+                                Options options,
+                                ConstIndexArray selectedFaces,
+                                StencilTable const ** regionStencils) {
+
+    OPENSUBDIV_TRACE_SCOPE("patchTable.createRegion");
+
+    *regionStencils = 0;
+
+    if (options.GetEndCapType() == Options::ENDCAP_LEGACY_GREGORY) {
+        return 0;
+    }
+    options.includeBaseLevelIndices = true;
+    options.SetPatchPrecision<float>();
+
+    PatchTable * table = Create(refiner, options, selectedFaces);
+    if (!table) return 0;
+
+    //  Renumber the points used by the patches in order of first use:
+    int numRefinedPoints = refiner.GetNumVerticesTotal();
+    int numPoints = numRefinedPoints + table->GetNumLocalPoints();
+
+    std::vector<Index> pointRemap(numPoints, INDEX_INVALID);
+    std::vector<Index> regionPoints;
+
+    std::vector<Index> & patchVerts = table->_patchVerts;
+    for (int i = 0; i < (int)patchVerts.size(); ++i) {
+        Index & point = pointRemap[patchVerts[i]];
+        if (point == INDEX_INVALID) {
+            point = (Index)regionPoints.size();
+            regionPoints.push_back(patchVerts[i]);
+        }
+        patchVerts[i] = point;
+    }
+
+    //  Gather the stencils of the points from those of all refined vertices
+    //  and local points, factorized to the control vertices:
+    StencilTableFactory::Options stencilOptions;
+    stencilOptions.generateIntermediateLevels = true;
+    stencilOptions.factorizeIntermediateLevels = true;
+    stencilOptions.generateControlVerts = true;
+    stencilOptions.generateOffsets = true;
+    stencilOptions.maxLevel = refiner.GetMaxLevel();
+    stencilOptions.monitor = options.monitor;
+
+    StencilTable const * refinedStencils =
+        StencilTableFactory::Create(refiner, stencilOptions);
+    if (!refinedStencils) {
+        delete table;
+        return 0;
+    }
+    if (StencilTable const * localPointStencils =
+            table->GetLocalPointStencilTable()) {
+        StencilTable const * pointStencils =
+            StencilTableFactory::AppendLocalPointStencilTable(
+                refiner, refinedStencils, localPointStencils);
+        delete refinedStencils;
+        refinedStencils = pointStencils;
+    }
+
+    *regionStencils = regionPoints.empty() ? 0 :
+        StencilTableFactory::GatherStencils(refinedStencils,
+            (int)regionPoints.size(), &regionPoints[0]);
+    delete refinedStencils;
+
+    //  The local points are now computed by the region stencils:
+    delete table->_localPointStencils.Get<float>();
+    table->_localPointStencils.Set();
+
+    table->updateMemoryStats();
+    return table;
+}
+
+namespace {
+    int
+    findPatchArray(PatchTable const & table, PatchDescriptor desc) {
+        for (int i = 0; i < table.GetNumPatchArrays(); ++i) {
+            if (table.GetPatchArrayDescriptor(i) == desc) return i;
+        }
+        return -1;
+    }
+}
+
+PatchTable *
+PatchTableFactory::Create(int numTables,
+                          PatchTable const ** tables,
+                          Index const * pointOffsets,
+                          std::vector<int> * patchRanges) {
+
+    OPENSUBDIV_TRACE_SCOPE("patchTable.merge");
+
+    //  Gather the patch types of all tables in order of first appearance:
+    std::vector<PatchDescriptor> descs;
+    PatchDescriptor::Type varyingType = PatchDescriptor::NON_PATCH;
+
+    int  maxValence = 0;
+    bool isUniformLinear = true,
+         hasSharpness = false,
+         hasVarying = true,
+         firstTable = true;
+
+    for (int t = 0; t < numTables; ++t) {
+        if (!tables[t]) continue;
+        PatchTable const & src = *tables[t];
+
+        for (int a = 0; a < src.GetNumPatchArrays(); ++a) {
+            PatchDescriptor desc = src.GetPatchArrayDescriptor(a);
+            if ((desc.GetType() == PatchDescriptor::GREGORY) ||
+                (desc.GetType() == PatchDescriptor::GREGORY_BOUNDARY)) {
+                return 0;
+            }
+            if (std::find(descs.begin(), descs.end(), desc) == descs.end()) {
+                descs.push_back(desc);
+            }
+        }
+        maxValence = std::max(maxValence, src.GetMaxValence());
+        isUniformLinear = isUniformLinear && src._isUniformLinear;
+        hasSharpness = hasSharpness || !src._sharpnessIndices.empty();
+
+        //  Varying patches are merged only if present and alike in all:
+        if (src._varyingVerts.empty() ||
+            (!firstTable && (src._varyingDesc.GetType() != varyingType))) {
+            hasVarying = false;
+        }
+        varyingType = src._varyingDesc.GetType();
+        firstTable = false;
+    }
+    int numArrays = (int)descs.size();
+
+    PatchTable * table = new PatchTable(maxValence);
+    table->_isUniformLinear = isUniformLinear;
+
+    //  Append the sharpness values, recording the offset of each table:
+    std::vector<Index> sharpnessOffsets(numTables, 0);
+    for (int t = 0; t < numTables; ++t) {
+        if (!tables[t]) continue;
+        sharpnessOffsets[t] = (Index)table->_sharpnessValues.size();
+        table->_sharpnessValues.insert(table->_sharpnessValues.end(),
+            tables[t]->_sharpnessValues.begin(),
+            tables[t]->_sharpnessValues.end());
+    }
+
+    if (patchRanges) {
+        patchRanges->assign((numTables + 1) * numArrays, 0);
+    }
+
+    //  Allocate an array for each patch type:
+    table->reservePatchArrays(numArrays);
+
+    Index vertIndex = 0, patchIndex = 0;
+    for (int a = 0; a < numArrays; ++a) {
+        int numPatches = 0;
+        for (int t = 0; t < numTables; ++t) {
+            int srcArray = tables[t] ? findPatchArray(*tables[t], descs[a]) : -1;
+            if (srcArray >= 0) {
+                numPatches += tables[t]->GetNumPatches(srcArray);
+            }
+        }
+        table->pushPatchArray(descs[a], numPatches, &vertIndex, &patchIndex);
+    }
+    table->_patchVerts.resize(vertIndex);
+    table->_paramTable.resize(patchIndex);
+    if (hasSharpness) {
+        table->_sharpnessIndices.resize(patchIndex, INDEX_INVALID);
+    }
+    PatchDescriptor varyingDesc(varyingType);
+    if (hasVarying) {
+        table->allocateVaryingVertices(varyingDesc, patchIndex);
+    }
+    int numVaryingCVs = hasVarying ? varyingDesc.GetNumControlVertices() : 0;
+
+    //  Copy the patches of each table, rebasing their points and faces:
+    for (int a = 0; a < table->GetNumPatchArrays(); ++a) {
+        Index * dstVerts = &table->getPatchArrayVertices(a)[0];
+
+        int firstPatch = table->getPatchIndex(a, 0);
+        int patch = firstPatch;
+        int numPtexFaces = 0;
+
+        for (int t = 0; t < numTables; ++t) {
+            if (patchRanges) {
+                (*patchRanges)[t * numArrays + a] = patch - firstPatch;
+            }
+            if (!tables[t]) continue;
+            PatchTable const & src = *tables[t];
+
+            int srcArray = findPatchArray(src, descs[a]);
+            if (srcArray >= 0) {
+                ConstIndexArray srcVerts = src.GetPatchArrayVertices(srcArray);
+                for (int i = 0; i < srcVerts.size(); ++i) {
+                    *dstVerts++ = srcVerts[i] + pointOffsets[t];
+                }
+
+                ConstPatchParamArray srcParams = src.GetPatchParams(srcArray);
+                Index const * srcSharpness = src._sharpnessIndices.empty() ? 0 :
+                    &src._sharpnessIndices[0] + src.getPatchIndex(srcArray, 0);
+
+                for (int i = 0; i < srcParams.size(); ++i, ++patch) {
+                    //  The ptex face id occupies the low 28 bits of field0:
+                    PatchParam param = srcParams[i];
+                    param.field0 = (param.field0 & ~0xfffffffu) |
+                                   (unsigned int)(param.GetFaceId() + numPtexFaces);
+                    table->_paramTable[patch] = param;
+
+                    if (srcSharpness && (srcSharpness[i] != INDEX_INVALID)) {
+                        table->_sharpnessIndices[patch] =
+                            srcSharpness[i] + sharpnessOffsets[t];
+                    }
+                }
+
+                if (hasVarying) {
+                    ConstIndexArray srcVarying =
+                        src.GetPatchArrayVaryingVertices(srcArray);
+                    Index * dstVarying = &table->_varyingVerts[
+                        (patch - srcParams.size()) * numVaryingCVs];
+                    for (int i = 0; i < srcVarying.size(); ++i) {
+                        dstVarying[i] = srcVarying[i] + pointOffsets[t];
+                    }
+                }
+            }
+            numPtexFaces += src.GetNumPtexFaces();
+        }
+        if (patchRanges) {
+            (*patchRanges)[numTables * numArrays + a] = patch - firstPatch;
+        }
+        table->_numPtexFaces = numPtexFaces;
+    }
+    table->updateMemoryStats();
+    return table;
 }
 
 
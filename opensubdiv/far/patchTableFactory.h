@@ -66,10 +66,13 @@ public:
              includeFVarBaseLevelIndices(false),
              triangulateQuads(false),
              useSingleCreasePatch(false),
+             useDoubleCreasePatch(false),
              useInfSharpPatch(false),
              maxIsolationLevel(maxIsolation),
              endCapType(ENDCAP_GREGORY_BASIS),
              shareEndCapPatchPoints(true),
+             approxEndCapsWithBSpline(false),
+             maxApproxEndCapValenceDeviation(1),
              generateVaryingTables(true),
              generateVaryingLocalPoints(true),
              generateFVarTables(false),
@@ -77,8 +80,12 @@ public:
              fvarPatchPrecisionDouble(false),
              generateFVarLegacyLinearPatches(true),
              generateLegacySharpCornerPatches(true),
+             spatialPatchOrder(false),
+             generatePtexFacePatches(false),
+             numThreads(0),
              numFVarChannels(-1),
-             fvarChannelIndices(0)
+             fvarChannelIndices(0),
+             monitor(0)
         { }
 
         /// \brief Get endcap basis type
@@ -87,6 +94,26 @@ public:
         /// \brief Set endcap basis type
         void SetEndCapType(EndCapType e) { endCapType = e; }
 
+        /// \brief Set the options of a table used only to evaluate vertex
+        ///        patches
+        ///
+        /// Omits the varying and face-varying patches and local points, and
+        /// replaces legacy Gregory end-caps (whose quad offsets and valence
+        /// tables are only used by the legacy drawing shaders) with Gregory
+        /// basis end-caps.  The remaining options are not affected, so the
+        /// table retains the patch vertices, PatchParams, local point
+        /// stencils and any single-crease sharpness it requires (see
+        /// PatchTable::GetMemoryUsage() for a breakdown of its memory).
+        ///
+        void SetEvaluationOnly() {
+            generateVaryingTables      = false;
+            generateVaryingLocalPoints = false;
+            generateFVarTables         = false;
+            if (endCapType == ENDCAP_LEGACY_GREGORY) {
+                endCapType = ENDCAP_GREGORY_BASIS;
+            }
+        }
+
         /// \brief Set precision of vertex patches
         template <typename REAL> void SetPatchPrecision();
 
@@ -99,6 +126,7 @@ public:
 
             adaptiveOptions.useInfSharpPatch     = useInfSharpPatch;
             adaptiveOptions.useSingleCreasePatch = useSingleCreasePatch;
+            adaptiveOptions.useDoubleCreasePatch = useDoubleCreasePatch;
             adaptiveOptions.considerFVarChannels = generateFVarTables &&
                                                   !generateFVarLegacyLinearPatches;
             return adaptiveOptions;
@@ -110,6 +138,8 @@ public:
                      triangulateQuads            : 1, ///< Triangulate 'QUADS' primitives (Uniform mode only)
 
                      useSingleCreasePatch : 1, ///< Use single crease patch
+                     useDoubleCreasePatch : 1, ///< Use double crease patch between
+                                               ///< two parallel semi-sharp creases
                      useInfSharpPatch     : 1, ///< Use infinitely-sharp patch
                      maxIsolationLevel    : 4, ///< Cap adaptive feature isolation to the given level (max. 10)
 
@@ -117,6 +147,11 @@ public:
                      endCapType              : 3, ///< EndCapType
                      shareEndCapPatchPoints  : 1, ///< Share endcap patch points among adjacent endcap patches.
                                                   ///< currently only work with GregoryBasis.
+                     approxEndCapsWithBSpline        : 1, ///< With GregoryBasis end-caps, use BSpline end-caps
+                                                          ///< for irregular patches close to regular (see
+                                                          ///< maxApproxEndCapValenceDeviation)
+                     maxApproxEndCapValenceDeviation : 2, ///< Largest difference of the valence of the corners
+                                                          ///< of a BSpline end-cap from regular valence
 
                      // varying
                      generateVaryingTables      : 1, ///< Generate varying patch tables
@@ -131,10 +166,21 @@ public:
 
                      // legacy behaviors (default to true)
                      generateFVarLegacyLinearPatches  : 1, ///< Generate all linear face-varying patches (legacy)
-                     generateLegacySharpCornerPatches : 1; ///< Generate sharp regular patches at smooth corners (legacy)
+                     generateLegacySharpCornerPatches : 1, ///< Generate sharp regular patches at smooth corners (legacy)
+
+                     // construction
+                     spatialPatchOrder : 1, ///< Order the patches of each array along a space-filling
+                                            ///< curve within the base faces (see PatchTable::GetPatchRemapTable())
+                     generatePtexFacePatches : 1, ///< Index the patches of each ptex face
+                                                  ///< (see PatchTable::GetPtexFacePatches())
+                     numThreads : 8; ///< Number of threads used to identify the topology and
+                                     ///< end-cap conversion of patches and to index the
+                                     ///< patches of ptex faces (0 or 1 for serial construction)
 
         int          numFVarChannels;          ///< Number of channel indices and interpolation modes passed
         int const *  fvarChannelIndices;       ///< List containing the indices of the channels selected for the factory
+
+        BuildMonitor * monitor;                ///< Optional progress and cancellation (see Create())
     };
 
     /// \brief Instantiates a PatchTable from a client-provided TopologyRefiner.
@@ -161,18 +207,238 @@ public:
     ///  the base level in addition to the last level while indices for face-varying
     ///  patches include only the last level.
     ///
+    ///  When Options::numThreads is greater than 1 (and OpenMP support is
+    ///  available), the topology of batches of patches -- including the
+    ///  change-of-basis matrices of end-caps -- is identified concurrently,
+    ///  while patch points and local point stencils are still assigned in
+    ///  order.  The resulting table is identical to that of serial
+    ///  construction.
+    ///
+    ///  When Options::approxEndCapsWithBSpline is set with GregoryBasis
+    ///  end-caps, the end-cap of each irregular patch is chosen by its
+    ///  topology:  a patch whose corners differ from regular valence by at
+    ///  most Options::maxApproxEndCapValenceDeviation (and that has no dart
+    ///  or irregular sharp corner) is approximated by a BSpline end-cap,
+    ///  packed with the regular patches and reusing their points, while the
+    ///  others remain GregoryBasis patches in an array of their own.  The
+    ///  error of the approximation is bounded by that of the valence allowed,
+    ///  in exchange for fewer local points and cheaper evaluation.
+    ///  Face-varying patches always use the end-cap type of the options.
+    ///
+    ///  When Options::spatialPatchOrder is set, the patches of each array
+    ///  are ordered by depth, by base face and, within a face, along a
+    ///  Hilbert curve of their parameterization, so that consecutive
+    ///  patches share more control points.  The index of each patch in the order of
+    ///  construction is mapped to its new index by
+    ///  PatchTable::GetPatchRemapTable() -- the PatchParams, and so a
+    ///  PatchMap or ptex lookup of the table, reflect the new order.
+    ///
+    ///  When Options::generatePtexFacePatches is set, the handles of the
+    ///  patches of each ptex face are indexed (concurrently given
+    ///  Options::numThreads) for direct traversal of the patches face by
+    ///  face with PatchTable::GetPtexFacePatches().
+    ///
+    ///  An optional Options::monitor is notified as batches of patches are
+    ///  populated, and the construction stops -- returning 0 -- if it is
+    ///  cancelled.
+    ///
     /// @param refiner        TopologyRefiner from which to generate patches
     ///
     /// @param options        Options controlling the creation of the table
     ///
     /// @param selectedFaces  Only create patches for the given set of base faces.
     ///
-    /// @return               A new instance of PatchTable
+    /// @return               A new instance of PatchTable (or 0 if cancelled)
     ///
     static PatchTable * Create(TopologyRefiner const & refiner,
                                Options options = Options(),
                                ConstIndexArray selectedFaces = ConstIndexArray());
 
+    /// \brief Instantiates PatchTables for several levels of detail from a
+    ///        single adaptively refined TopologyRefiner.
+    ///
+    ///  When Options::maxIsolationLevel is less than the maximum level of an
+    ///  adaptively refined TopologyRefiner, Create() gathers patches only up
+    ///  to that level -- treating faces refined beyond it as patches of the
+    ///  lower level of detail.  This method creates a table for each of the
+    ///  given isolation levels in this way.  The patch points of all tables
+    ///  index the same refined vertices, so a single set of refined control
+    ///  points (and the stencils computing them) serves all levels of detail
+    ///  and switching between levels requires no further refinement.  Only
+    ///  the local points of each table (e.g. for end-caps) are specific to it.
+    ///
+    /// @param refiner          Adaptively refined TopologyRefiner
+    ///
+    /// @param options          Options controlling the creation of the tables
+    ///                         (excluding maxIsolationLevel)
+    ///
+    /// @param numLevels        Number of levels of detail
+    ///
+    /// @param isolationLevels  Isolation level of each level of detail
+    ///
+    /// @param tables           Array of numLevels new PatchTables to assign
+    ///
+    /// @param selectedFaces    Only create patches for the given set of base faces.
+    ///
+    static void CreateLevelsOfDetail(TopologyRefiner const & refiner,
+                                     Options options,
+                                     int numLevels,
+                                     int const isolationLevels[],
+                                     PatchTable * tables[],
+                                     ConstIndexArray selectedFaces = ConstIndexArray());
+
+    /// \brief Instantiates a PatchTable from a single adaptively refined
+    ///        TopologyRefiner with a level of detail for each base face.
+    ///
+    ///  The patches of each base face are gathered up to its own isolation
+    ///  level, as Create() does for all faces up to Options::maxIsolationLevel
+    ///  (see CreateLevelsOfDetail()).  The levels are typically chosen per
+    ///  frame from the screen-space size of the base faces, so that distant
+    ///  faces are drawn with fewer and larger patches, while the refinement
+    ///  -- and so the refined vertices indexed by the patches -- is shared by
+    ///  all frames.  Only the local points (e.g. for end-caps) are specific
+    ///  to each table.
+    ///
+    ///  The levels are clamped to those refined (and to maxIsolationLevel),
+    ///  faces of irregular size are given at least level 1, and levels are
+    ///  raised so that those of faces sharing an edge differ by at most one.
+    ///  The transition masks of the patches then identify the edges shared
+    ///  with the deeper patches of neighboring faces as they do in Create().
+    ///  Legacy Gregory end-caps are not supported.
+    ///
+    /// @param refiner        Adaptively refined TopologyRefiner
+    ///
+    /// @param options        Options controlling the creation of the table
+    ///
+    /// @param faceLevels     Isolation level of each base face
+    ///
+    /// @param selectedFaces  Only create patches for the given set of base faces.
+    ///
+    /// @return               A new instance of PatchTable (or 0 if not
+    ///                       supported or cancelled)
+    ///
+    static PatchTable * CreateFaceLevelsOfDetail(TopologyRefiner const & refiner,
+                                                 Options options,
+                                                 int const faceLevels[],
+                                                 ConstIndexArray selectedFaces = ConstIndexArray());
+
+    /// \brief Instantiates a PatchTable for a region of interest -- a subset
+    ///        of the base faces, e.g. those under a brush or in a render
+    ///        crop -- and the stencils of only the points of its patches.
+    ///
+    ///  The patches of the selected faces are created as with Create().
+    ///  The refined vertices and local points they use are then renumbered
+    ///  consecutively, in order of first use, and the stencils of these
+    ///  points -- factorized to the control vertices of the full mesh -- are
+    ///  returned in a table whose stencils match the renumbered points.  So
+    ///  the patches are evaluated by applying the region stencils to the
+    ///  control vertices, without computing the refined vertices and local
+    ///  points outside the region.  For best results the refiner should be
+    ///  refined adaptively with the same selected faces, so that only the
+    ///  region is refined.
+    ///
+    ///  Since the local points are included in the region stencils, the
+    ///  table has no local point vertex stencils.  Only the vertex patch
+    ///  points are renumbered -- varying and face-varying patch points
+    ///  index the refined and local values as usual.  Single precision
+    ///  stencils are created, and the legacy Gregory end caps (whose
+    ///  tables index the refined vertices) are not supported.
+    ///
+    /// @param refiner          TopologyRefiner from which to generate patches
+    ///
+    /// @param options          Options controlling the creation of the table
+    ///
+    /// @param selectedFaces    The base faces of the region
+    ///
+    /// @param regionStencils   Returns a new table of the stencils of the
+    ///                         points of the region
+    ///
+    /// @return                 A new instance of PatchTable (or 0 if
+    ///                         cancelled or not supported)
+    ///
+    static PatchTable * CreateRegion(TopologyRefiner const & refiner,
+                                     Options options,
+                                     ConstIndexArray selectedFaces,
+                                     StencilTable const ** regionStencils);
+
+    /// \brief Instantiates a PatchTable merging the patches of several
+    ///        tables, e.g. of the meshes of a scene, so that they can be
+    ///        uploaded and drawn with a single set of buffers.
+    ///
+    ///  The merged table has a patch array for each patch type of the input
+    ///  tables, with the patches of each table following those of the
+    ///  previous one.  The patch points of each table are rebased to its
+    ///  offset in a shared buffer of points (i.e. the refined vertices and
+    ///  local points of each mesh, computed separately), and its ptex face
+    ///  ids follow those of the previous tables.  The varying patches and
+    ///  single-crease sharpness are merged likewise, while the local point
+    ///  stencils and face-varying channels are not -- these remain those of
+    ///  the individual tables.  Tables with legacy Gregory patches are not
+    ///  supported.
+    ///
+    /// @param numTables     Number of input PatchTables
+    ///
+    /// @param tables        Array of input PatchTables (which may include
+    ///                      null entries)
+    ///
+    /// @param pointOffsets  Offset of the points of each table in the
+    ///                      shared buffer of points
+    ///
+    /// @param patchRanges   Optional ranges of the patches of each table in
+    ///                      each patch array of the merged table: the
+    ///                      patches of table t in array a are those from
+    ///                      (*patchRanges)[t * numArrays + a] up to
+    ///                      (*patchRanges)[(t + 1) * numArrays + a]
+    ///
+    /// @return              A new instance of PatchTable (or 0 if not
+    ///                      supported)
+    ///
+    static PatchTable * Create(int numTables,
+                               PatchTable const ** tables,
+                               Index const * pointOffsets,
+                               std::vector<int> * patchRanges = 0);
+
+    /// \brief The numbers of patches and local points of the PatchTable
+    ///        that Create() would build (see CountPatches())
+    struct PatchCounts {
+
+        PatchCounts() : regularPatchType(PatchDescriptor::NON_PATCH),
+                        irregularPatchType(PatchDescriptor::NON_PATCH),
+                        numRegularPatches(0),
+                        numIrregularPatches(0),
+                        numLocalPoints(0) { }
+
+        PatchDescriptor::Type regularPatchType;   ///< type of the regular patches
+        PatchDescriptor::Type irregularPatchType; ///< type of the irregular patches
+        int numRegularPatches;                    ///< patches of the regular type,
+                                                  ///< including irregular patches
+                                                  ///< approximated in that basis
+        int numIrregularPatches;                  ///< patches of the irregular type
+        int numLocalPoints;                       ///< estimated local points of
+                                                  ///< the vertex patches
+    };
+
+    /// \brief Counts the patches Create() would gather from a refiner without
+    ///        building the table
+    ///
+    ///  The patches are identified as they are by Create() -- the counts are
+    ///  exact -- but neither the patches nor their local points are built.
+    ///  The number of local points is the estimate with which Create()
+    ///  reserves them, so it may exceed the local points actually shared.
+    ///
+    /// @param refiner        TopologyRefiner from which to count patches
+    ///
+    /// @param counts         The numbers of patches and local points
+    ///
+    /// @param options        Options controlling the creation of the table
+    ///
+    /// @param selectedFaces  Only count patches for the given set of base faces.
+    ///
+    static void CountPatches(TopologyRefiner const & refiner,
+                             PatchCounts & counts,
+                             Options options = Options(),
+                             ConstIndexArray selectedFaces = ConstIndexArray());
+
 public:
     //  PatchFaceTag
     //
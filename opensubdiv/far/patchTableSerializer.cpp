@@ -0,0 +1,123 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+#include "../far/patchTableSerializer.h"
+#include "../far/error.h"
+#include "../vtr/binaryStream.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+using Vtr::internal::BinaryHeader;
+using Vtr::internal::BinaryWriter;
+using Vtr::internal::BinaryReader;
+
+namespace {
+    //
+    //  The version must be incremented with any change to the layout of the
+    //  patch table or its stencil tables:
+    //
+    char const         MAGIC[8] = { 'O', 'S', 'D', 'P', 'T', 'A', 'B', '\0' };
+    unsigned int const VERSION  = 4;
+
+    BinaryHeader
+    createHeader() {
+        BinaryHeader header(MAGIC, VERSION);
+
+        header.setTypeSize(0, sizeof(Index));
+        header.setTypeSize(1, sizeof(PatchParam));
+        header.setTypeSize(2, sizeof(float));
+        header.setTypeSize(3, sizeof(double));
+        return header;
+    }
+}
+
+void
+PatchTableSerializer::write(BinaryWriter & stream, PatchTable const & table) {
+
+    stream.write(createHeader());
+    table.write(stream);
+    stream.align();
+}
+
+size_t
+PatchTableSerializer::GetSerializedSize(PatchTable const & table) {
+
+    BinaryWriter stream;
+    write(stream, table);
+    return stream.getSize();
+}
+
+size_t
+PatchTableSerializer::Serialize(PatchTable const & table,
+                                void * buffer, size_t bufferSize) {
+
+    BinaryWriter stream(buffer, bufferSize);
+    write(stream, table);
+
+    if (!buffer || !stream.isValid()) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in PatchTableSerializer::Serialize() -- "
+            "buffer too small for patch table.");
+        return 0;
+    }
+    return stream.getSize();
+}
+
+PatchTable *
+PatchTableSerializer::Deserialize(void const * buffer, size_t bufferSize) {
+
+    BinaryReader stream(buffer, bufferSize);
+
+    BinaryHeader header;
+    if (!stream.read(header) || !header.isCompatible(createHeader())) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in PatchTableSerializer::Deserialize() -- "
+            "buffer not written by a compatible version of the library.");
+        return 0;
+    }
+
+    PatchTable * table = new PatchTable(0);
+    //  The trailing padding must also be present to not accept a buffer
+    //  truncated within it:
+    bool isValid = table->read(stream);
+    stream.align();
+
+    if (!isValid || !stream.isValid()) {
+        delete table;
+
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in PatchTableSerializer::Deserialize() -- "
+            "invalid or truncated buffer.");
+        return 0;
+    }
+    table->updateMemoryStats();
+    return table;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,95 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_PATCH_TABLE_SERIALIZER_H
+#define OPENSUBDIV3_FAR_PATCH_TABLE_SERIALIZER_H
+
+#include "../version.h"
+
+#include "../far/patchTable.h"
+
+#include <cstddef>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+///
+/// \brief Writes and reads a PatchTable to/from a flat binary buffer
+///
+/// All tables of a PatchTable are written -- including its local point
+/// stencil tables and face-varying channels -- so that it can be loaded
+/// (e.g. from a file mapped into memory) without recreating it from a
+/// refiner.  As with the TopologyRefinerSerializer, the format is intended
+/// to be read by the same build of the library that wrote it, and arrays
+/// within the buffer are aligned to 8 bytes.  The contents are copied into
+/// the new table on load, so the buffer need not persist.
+///
+class PatchTableSerializer {
+
+public:
+
+    /// \brief Returns the size in bytes of the serialized patch table
+    static size_t GetSerializedSize(PatchTable const & table);
+
+    /// \brief Writes the patch table to the given buffer
+    ///
+    /// @param table       The patch table to be written
+    ///
+    /// @param buffer      Destination buffer, of at least GetSerializedSize()
+    ///                    bytes
+    ///
+    /// @param bufferSize  Size of the destination buffer
+    ///
+    /// @return            The number of bytes written, or 0 if the buffer was
+    ///                    too small
+    ///
+    static size_t Serialize(PatchTable const & table,
+                            void * buffer, size_t bufferSize);
+
+    /// \brief Creates a new patch table from the contents of a buffer
+    ///
+    /// @param buffer      Buffer previously written by Serialize()
+    ///
+    /// @param bufferSize  Size of the buffer
+    ///
+    /// @return            A new instance of PatchTable or 0 if the buffer is
+    ///                    not valid or was written by an incompatible build
+    ///                    of the library
+    ///
+    static PatchTable * Deserialize(void const * buffer, size_t bufferSize);
+
+private:
+    static void write(Vtr::internal::BinaryWriter & stream,
+                      PatchTable const & table);
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_PATCH_TABLE_SERIALIZER_H */
@@ -0,0 +1,853 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../version.h"
+#include "../far/primvarRefiner.h"
+#include "../far/trace.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+//
+//  Vertex interpolation of primvars stored in strided arrays:
+//
+//  The weights of each child vertex are gathered into a list of sources and
+//  weights which is then applied to every primvar -- or stored, to be applied
+//  repeatedly without recomputing the masks (see LevelWeights).  The sources
+//  are listed in the order in which the weights are applied by the templated
+//  methods, so that the results are identical.  The vertices of each type of
+//  parent component only depend on the child vertices of faces (interpolated
+//  in an earlier pass), so each pass can be distributed over several threads.
+//
+namespace {
+    //
+    //  Sources with a negative index refer to the (complemented) index of a
+    //  child vertex interpolated in an earlier pass:
+    //
+    inline Index encodeChildSource(Index cVert) { return ~cVert; }
+
+    //
+    //  Accumulation for a single primvar -- specialized for common lengths
+    //  (LENGTH of 0 for all others) so that the inner loop is unrolled:
+    //
+    template <int LENGTH, typename REAL>
+    inline void
+    applyWeightsToArray(REAL const * src, REAL * dst, int length, int stride,
+                        Index cVert, Index const * sources, REAL const * weights,
+                        int numSources) {
+
+        if (LENGTH) length = LENGTH;
+
+        REAL * cDst = dst + cVert * stride;
+        for (int k = 0; k < length; ++k) {
+            cDst[k] = 0.0f;
+        }
+        for (int i = 0; i < numSources; ++i) {
+            REAL const * iSrc = (sources[i] >= 0)
+                              ? src + sources[i] * stride
+                              : dst + encodeChildSource(sources[i]) * stride;
+            REAL weight = weights[i];
+            for (int k = 0; k < length; ++k) {
+                cDst[k] += weight * iSrc[k];
+            }
+        }
+    }
+
+    template <typename REAL, class PRIMVAR_ARRAY>
+    inline void
+    applyWeights(PRIMVAR_ARRAY const * primvars, int numPrimvars, Index cVert,
+                 Index const * sources, REAL const * weights, int numSources) {
+
+        for (int p = 0; p < numPrimvars; ++p) {
+            PRIMVAR_ARRAY const & pv = primvars[p];
+
+            switch (pv.length) {
+            case 1: applyWeightsToArray<1>(pv.src, pv.dst, 1, pv.stride,
+                        cVert, sources, weights, numSources); break;
+            case 2: applyWeightsToArray<2>(pv.src, pv.dst, 2, pv.stride,
+                        cVert, sources, weights, numSources); break;
+            case 3: applyWeightsToArray<3>(pv.src, pv.dst, 3, pv.stride,
+                        cVert, sources, weights, numSources); break;
+            case 4: applyWeightsToArray<4>(pv.src, pv.dst, 4, pv.stride,
+                        cVert, sources, weights, numSources); break;
+            default:
+                applyWeightsToArray<0>(pv.src, pv.dst, pv.length, pv.stride,
+                        cVert, sources, weights, numSources); break;
+            }
+        }
+    }
+
+    //
+    //  Actions invoked with the gathered weights of each child vertex -- the
+    //  former applying them to primvars (concurrently) and the latter storing
+    //  them (serially):
+    //
+    template <typename REAL, class PRIMVAR_ARRAY>
+    class ApplyWeightsAction {
+    public:
+        ApplyWeightsAction(PRIMVAR_ARRAY const * primvars, int numPrimvars) :
+            _primvars(primvars), _numPrimvars(numPrimvars) { }
+
+        void operator()(Index cVert, Index const * sources, REAL const * weights,
+                        int numSources) const {
+            applyWeights(_primvars, _numPrimvars, cVert, sources, weights, numSources);
+        }
+
+    private:
+        PRIMVAR_ARRAY const * _primvars;
+        int                   _numPrimvars;
+    };
+
+    template <typename REAL>
+    class StoreWeightsAction {
+    public:
+        StoreWeightsAction(std::vector<int> & sizes, std::vector<Index> & offsets,
+                           std::vector<Index> & sources, std::vector<REAL> & weights) :
+            _sizes(sizes), _offsets(offsets), _sources(sources), _weights(weights) { }
+
+        void operator()(Index cVert, Index const * sources, REAL const * weights,
+                        int numSources) const {
+            _sizes[cVert]   = numSources;
+            _offsets[cVert] = (Index) _sources.size();
+            _sources.insert(_sources.end(), sources, sources + numSources);
+            _weights.insert(_weights.end(), weights, weights + numSources);
+        }
+
+    private:
+        std::vector<int>   & _sizes;
+        std::vector<Index> & _offsets;
+        std::vector<Index> & _sources;
+        std::vector<REAL>  & _weights;
+    };
+}
+
+template <typename REAL>
+void
+PrimvarRefinerReal<REAL>::Interpolate(int level,
+        PrimvarArray const * primvars, int numPrimvars,
+        Options options) const {
+
+    assert(level>0 && level<=(int)_refiner._refinements.size());
+
+    if (numPrimvars <= 0) return;
+
+    OPENSUBDIV_TRACE_SCOPE_INDEXED("primvar.interpolate.level", level);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = options.numThreads;
+#else
+    int numThreads = 1;
+    (void)options;
+#endif
+
+    ApplyWeightsAction<REAL, PrimvarArray> action(primvars, numPrimvars);
+
+    gatherWeights(level, action, numThreads);
+}
+
+template <typename REAL>
+void
+PrimvarRefinerReal<REAL>::PrepareWeights(int level, LevelWeights & weights) const {
+
+    assert(level>0 && level<=(int)_refiner._refinements.size());
+
+    OPENSUBDIV_TRACE_SCOPE_INDEXED("primvar.prepare.level", level);
+
+    Vtr::internal::Refinement const & refinement = _refiner.getRefinement(level-1);
+
+    weights._level = level;
+
+    weights._firstVertex[0] = refinement.getFirstChildVertexFromFaces();
+    weights._numVertices[0] = refinement.getNumChildVerticesFromFaces();
+    weights._firstVertex[1] = refinement.getFirstChildVertexFromEdges();
+    weights._numVertices[1] = refinement.getNumChildVerticesFromEdges();
+    weights._firstVertex[2] = refinement.getFirstChildVertexFromVertices();
+    weights._numVertices[2] = refinement.getNumChildVerticesFromVertices();
+
+    int numChildVerts = refinement.child().getNumVertices();
+
+    weights._sizes.assign(numChildVerts, 0);
+    weights._offsets.assign(numChildVerts, 0);
+    weights._sources.clear();
+    weights._weights.clear();
+
+    StoreWeightsAction<REAL> action(weights._sizes, weights._offsets,
+                                    weights._sources, weights._weights);
+
+    gatherWeights(level, action, 1);
+
+    //  Release any excess capacity of the incrementally assembled lists:
+    std::vector<Index>(weights._sources).swap(weights._sources);
+    std::vector<REAL>(weights._weights).swap(weights._weights);
+}
+
+template <typename REAL>
+void
+PrimvarRefinerReal<REAL>::Interpolate(LevelWeights const & weights,
+        PrimvarArray const * primvars, int numPrimvars,
+        Options options) const {
+
+    assert(weights._level>0 && weights._level<=(int)_refiner._refinements.size());
+
+    if (numPrimvars <= 0) return;
+
+    OPENSUBDIV_TRACE_SCOPE_INDEXED("primvar.interpolate.level", weights._level);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = options.numThreads;
+#else
+    (void)options;
+#endif
+
+    for (int pass = 0; pass < 3; ++pass) {
+        int firstVertex = weights._firstVertex[pass];
+        int numVertices = weights._numVertices[pass];
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(static, 256)
+#endif
+        for (int i = 0; i < numVertices; ++i) {
+            Index cVert  = firstVertex + i;
+            Index offset = weights._offsets[cVert];
+
+            applyWeights(primvars, numPrimvars, cVert, &weights._sources[offset],
+                         &weights._weights[offset], weights._sizes[cVert]);
+        }
+    }
+}
+
+template <typename REAL>
+size_t
+PrimvarRefinerReal<REAL>::LevelWeights::GetMemoryUsage() const {
+
+    return sizeof(*this) + _sizes.capacity() * sizeof(int)
+                         + _offsets.capacity() * sizeof(Index)
+                         + _sources.capacity() * sizeof(Index)
+                         + _weights.capacity() * sizeof(REAL);
+}
+
+template <typename REAL>
+template <class ACTION>
+void
+PrimvarRefinerReal<REAL>::gatherWeights(int level, ACTION & action,
+        int numThreads) const {
+
+    switch (_refiner._subdivType) {
+    case Sdc::SCHEME_CATMARK:
+        gatherWeightsFromFaces<Sdc::SCHEME_CATMARK>(level, action, numThreads);
+        gatherWeightsFromEdges<Sdc::SCHEME_CATMARK>(level, action, numThreads);
+        gatherWeightsFromVerts<Sdc::SCHEME_CATMARK>(level, action, numThreads);
+        break;
+    case Sdc::SCHEME_LOOP:
+        gatherWeightsFromFaces<Sdc::SCHEME_LOOP>(level, action, numThreads);
+        gatherWeightsFromEdges<Sdc::SCHEME_LOOP>(level, action, numThreads);
+        gatherWeightsFromVerts<Sdc::SCHEME_LOOP>(level, action, numThreads);
+        break;
+    case Sdc::SCHEME_BILINEAR:
+        gatherWeightsFromFaces<Sdc::SCHEME_BILINEAR>(level, action, numThreads);
+        gatherWeightsFromEdges<Sdc::SCHEME_BILINEAR>(level, action, numThreads);
+        gatherWeightsFromVerts<Sdc::SCHEME_BILINEAR>(level, action, numThreads);
+        break;
+    }
+}
+
+template <typename REAL>
+template <Sdc::SchemeType SCHEME, class ACTION>
+void
+PrimvarRefinerReal<REAL>::gatherWeightsFromFaces(int level, ACTION & action,
+        int numThreads) const {
+
+    Vtr::internal::Refinement const & refinement = _refiner.getRefinement(level-1);
+    Vtr::internal::Level const &      parent     = refinement.parent();
+
+    if (refinement.getNumChildVerticesFromFaces() == 0) return;
+
+    Sdc::Scheme<SCHEME> scheme(_refiner._subdivOptions);
+
+    int numFaces = parent.getNumFaces();
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel if (numThreads > 1) num_threads(numThreads)
+#else
+    (void)numThreads;
+#endif
+    {
+        Vtr::internal::StackBuffer<Weight,16> fVertWeights(parent.getMaxValence());
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp for schedule(static, 256)
+#endif
+        for (int face = 0; face < numFaces; ++face) {
+
+            Vtr::Index cVert = refinement.getFaceChildVertex(face);
+            if (!Vtr::IndexIsValid(cVert))
+                continue;
+
+            ConstIndexArray fVerts = parent.getFaceVertices(face);
+
+            Mask fMask(fVertWeights, 0, 0);
+            Vtr::internal::FaceInterface fHood(fVerts.size());
+
+            scheme.ComputeFaceVertexMask(fHood, fMask);
+
+            action(cVert, &fVerts[0], (Weight const *)fVertWeights, fVerts.size());
+        }
+    }
+}
+
+template <typename REAL>
+template <Sdc::SchemeType SCHEME, class ACTION>
+void
+PrimvarRefinerReal<REAL>::gatherWeightsFromEdges(int level, ACTION & action,
+        int numThreads) const {
+
+    Vtr::internal::Refinement const & refinement = _refiner.getRefinement(level-1);
+    Vtr::internal::Level const &      parent     = refinement.parent();
+    Vtr::internal::Level const &      child      = refinement.child();
+
+    Sdc::Scheme<SCHEME> scheme(_refiner._subdivOptions);
+
+    int numEdges = parent.getNumEdges();
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel if (numThreads > 1) num_threads(numThreads)
+#else
+    (void)numThreads;
+#endif
+    {
+        Vtr::internal::EdgeInterface eHood(parent);
+
+        Weight                               eVertWeights[2];
+        Vtr::internal::StackBuffer<Weight,8> eFaceWeights(parent.getMaxEdgeFaces());
+
+        Vtr::internal::StackBuffer<Index,16>  sources(2 + parent.getMaxEdgeFaces());
+        Vtr::internal::StackBuffer<Weight,16> weights(2 + parent.getMaxEdgeFaces());
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp for schedule(static, 256)
+#endif
+        for (int edge = 0; edge < numEdges; ++edge) {
+
+            Vtr::Index cVert = refinement.getEdgeChildVertex(edge);
+            if (!Vtr::IndexIsValid(cVert))
+                continue;
+
+            ConstIndexArray eVerts = parent.getEdgeVertices(edge),
+                            eFaces = parent.getEdgeFaces(edge);
+
+            Mask eMask(eVertWeights, 0, eFaceWeights);
+
+            eHood.SetIndex(edge);
+
+            Sdc::Crease::Rule pRule = (parent.getEdgeSharpness(edge) > 0.0f) ? Sdc::Crease::RULE_CREASE : Sdc::Crease::RULE_SMOOTH;
+            Sdc::Crease::Rule cRule = child.getVertexRule(cVert);
+
+            scheme.ComputeEdgeVertexMask(eHood, eMask, pRule, cRule);
+
+            //  Gather the parent edge's vertices and (if applicable) the child
+            //  vertices of its incident faces or their opposite vertices:
+            int numSources = 0;
+            sources[numSources] = eVerts[0];
+            weights[numSources++] = eVertWeights[0];
+            sources[numSources] = eVerts[1];
+            weights[numSources++] = eVertWeights[1];
+
+            if (eMask.GetNumFaceWeights() > 0) {
+
+                for (int i = 0; i < eFaces.size(); ++i) {
+
+                    if (eMask.AreFaceWeightsForFaceCenters()) {
+                        Vtr::Index cVertOfFace = refinement.getFaceChildVertex(eFaces[i]);
+                        assert(Vtr::IndexIsValid(cVertOfFace));
+
+                        sources[numSources] = encodeChildSource(cVertOfFace);
+                    } else {
+                        Vtr::Index      pFace      = eFaces[i];
+                        ConstIndexArray pFaceEdges = parent.getFaceEdges(pFace),
+                                        pFaceVerts = parent.getFaceVertices(pFace);
+
+                        int eInFace = 0;
+                        for ( ; pFaceEdges[eInFace] != edge; ++eInFace ) ;
+
+                        int vInFace = eInFace + 2;
+                        if (vInFace >= pFaceVerts.size()) vInFace -= pFaceVerts.size();
+
+                        sources[numSources] = pFaceVerts[vInFace];
+                    }
+                    weights[numSources++] = eFaceWeights[i];
+                }
+            }
+            action(cVert, (Index const *)sources, (Weight const *)weights, numSources);
+        }
+    }
+}
+
+template <typename REAL>
+template <Sdc::SchemeType SCHEME, class ACTION>
+void
+PrimvarRefinerReal<REAL>::gatherWeightsFromVerts(int level, ACTION & action,
+        int numThreads) const {
+
+    Vtr::internal::Refinement const & refinement = _refiner.getRefinement(level-1);
+    Vtr::internal::Level const &      parent     = refinement.parent();
+    Vtr::internal::Level const &      child      = refinement.child();
+
+    Sdc::Scheme<SCHEME> scheme(_refiner._subdivOptions);
+
+    int numVerts = parent.getNumVertices();
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel if (numThreads > 1) num_threads(numThreads)
+#else
+    (void)numThreads;
+#endif
+    {
+        Vtr::internal::VertexInterface vHood(parent, child);
+
+        Vtr::internal::StackBuffer<Weight,32> weightBuffer(2*parent.getMaxValence());
+
+        Vtr::internal::StackBuffer<Index,32>  sources(2*parent.getMaxValence() + 1);
+        Vtr::internal::StackBuffer<Weight,32> weights(2*parent.getMaxValence() + 1);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp for schedule(static, 256)
+#endif
+        for (int vert = 0; vert < numVerts; ++vert) {
+
+            Vtr::Index cVert = refinement.getVertexChildVertex(vert);
+            if (!Vtr::IndexIsValid(cVert))
+                continue;
+
+            ConstIndexArray vEdges = parent.getVertexEdges(vert),
+                            vFaces = parent.getVertexFaces(vert);
+
+            Weight   vVertWeight,
+                   * vEdgeWeights = weightBuffer,
+                   * vFaceWeights = vEdgeWeights + vEdges.size();
+
+            Mask vMask(&vVertWeight, vEdgeWeights, vFaceWeights);
+
+            vHood.SetIndex(vert, cVert);
+
+            Sdc::Crease::Rule pRule = parent.getVertexRule(vert);
+            Sdc::Crease::Rule cRule = child.getVertexRule(cVert);
+
+            scheme.ComputeVertexVertexMask(vHood, vMask, pRule, cRule);
+
+            //  Gather the child vertices of the incident faces, the vertices
+            //  opposite the incident edges and the parent vertex -- smaller
+            //  weights first, as in interpFromVerts():
+            int numSources = 0;
+            if (vMask.GetNumFaceWeights() > 0) {
+                assert(vMask.AreFaceWeightsForFaceCenters());
+
+                for (int i = 0; i < vFaces.size(); ++i) {
+
+                    Vtr::Index cVertOfFace = refinement.getFaceChildVertex(vFaces[i]);
+                    assert(Vtr::IndexIsValid(cVertOfFace));
+
+                    sources[numSources] = encodeChildSource(cVertOfFace);
+                    weights[numSources++] = vFaceWeights[i];
+                }
+            }
+            if (vMask.GetNumEdgeWeights() > 0) {
+
+                for (int i = 0; i < vEdges.size(); ++i) {
+
+                    ConstIndexArray eVerts = parent.getEdgeVertices(vEdges[i]);
+
+                    sources[numSources] = (eVerts[0] == vert) ? eVerts[1] : eVerts[0];
+                    weights[numSources++] = vEdgeWeights[i];
+                }
+            }
+            sources[numSources] = vert;
+            weights[numSources++] = vVertWeight;
+
+            action(cVert, (Index const *)sources, (Weight const *)weights, numSources);
+        }
+    }
+}
+
+//
+//  Limit positions and tangents of primvars stored in strided arrays:
+//
+//  The limit masks of each vertex are combined into a single list of sources
+//  with a weight for the position and each tangent, listed in the order in
+//  which the templated Limit() applies them.  The limit masks assume the
+//  neighborhood of a refined level (all quads for Catmark), so vertices of
+//  the base level incident to other faces are evaluated by applying the masks
+//  to the points of their locally refined neighborhood -- their child vertex
+//  and the child vertices of their incident edges and faces -- expressed in
+//  terms of the vertices of the level.
+//
+namespace {
+    template <typename REAL>
+    class LimitWeights {
+    public:
+        LimitWeights(Vtr::internal::Level const & level) : _level(level) { }
+
+        void Clear() { _sources.clear(); _weights.clear(); }
+
+        int GetNumSources() const { return (int)_sources.size(); }
+        Index const * GetSources() const { return &_sources[0]; }
+        REAL const * GetWeights() const { return &_weights[0]; }
+
+        //  Append a source with its position and tangent weights:
+        void Append(Index source, REAL p, REAL t1, REAL t2) {
+            _sources.push_back(source);
+            _weights.push_back(p);
+            _weights.push_back(t1);
+            _weights.push_back(t2);
+        }
+
+        //  Add scaled weights to a source, appending it if not yet present:
+        void Add(Index source, REAL const w[3], REAL scale) {
+            for (int i = 0; i < (int)_sources.size(); ++i) {
+                if (_sources[i] == source) {
+                    _weights[3*i]   += w[0] * scale;
+                    _weights[3*i+1] += w[1] * scale;
+                    _weights[3*i+2] += w[2] * scale;
+                    return;
+                }
+            }
+            Append(source, w[0] * scale, w[1] * scale, w[2] * scale);
+        }
+
+        //  Points of the Catmark refinement of the neighborhood of a vertex:
+        void AddFacePoint(Index face, REAL const w[3], REAL scale) {
+            ConstIndexArray fVerts = _level.getFaceVertices(face);
+            for (int i = 0; i < fVerts.size(); ++i) {
+                Add(fVerts[i], w, scale / (REAL)fVerts.size());
+            }
+        }
+        void AddEdgePoint(Index vert, Index edge, REAL const w[3]) {
+            ConstIndexArray eVerts = _level.getEdgeVertices(edge);
+            ConstIndexArray eFaces = _level.getEdgeFaces(edge);
+            Index vOpp = (eVerts[0] == vert) ? eVerts[1] : eVerts[0];
+
+            REAL sharp = (eFaces.size() == 2)
+                       ? std::min((REAL)_level.getEdgeSharpness(edge), (REAL)1.0f)
+                       : (REAL)1.0f;
+            REAL smooth = (REAL)1.0f - sharp;
+
+            Add(vert, w, sharp * 0.5f + smooth * 0.25f);
+            Add(vOpp, w, sharp * 0.5f + smooth * 0.25f);
+            if (smooth > 0.0f) {
+                AddFacePoint(eFaces[0], w, smooth * 0.25f);
+                AddFacePoint(eFaces[1], w, smooth * 0.25f);
+            }
+        }
+        void AddVertexPoint(Index vert, Sdc::Crease::Rule rule,
+                            int const creaseEnds[2], REAL const w[3]) {
+            ConstIndexArray vEdges = _level.getVertexEdges(vert);
+            ConstIndexArray vFaces = _level.getVertexFaces(vert);
+
+            if (rule == Sdc::Crease::RULE_CREASE) {
+                Add(vert, w, 0.75f);
+                Add(oppositeVertex(vert, vEdges[creaseEnds[0]]), w, 0.125f);
+                Add(oppositeVertex(vert, vEdges[creaseEnds[1]]), w, 0.125f);
+            } else {
+                REAL n = (REAL) vEdges.size();
+                Add(vert, w, (n - 2.0f) / n);
+                for (int i = 0; i < vEdges.size(); ++i) {
+                    Add(oppositeVertex(vert, vEdges[i]), w, 1.0f / (n * n));
+                }
+                for (int i = 0; i < vFaces.size(); ++i) {
+                    AddFacePoint(vFaces[i], w, 1.0f / (n * n));
+                }
+            }
+        }
+
+    private:
+        Index oppositeVertex(Index vert, Index edge) const {
+            ConstIndexArray eVerts = _level.getEdgeVertices(edge);
+            return (eVerts[0] == vert) ? eVerts[1] : eVerts[0];
+        }
+
+        Vtr::internal::Level const & _level;
+
+        std::vector<Index> _sources;
+        std::vector<REAL>  _weights;
+    };
+
+    template <typename REAL>
+    inline void
+    applyLimitWeightsToArray(REAL const * src, REAL * dst, int length,
+                             int stride, Index vert, Index const * sources,
+                             REAL const * weights, int numSources) {
+
+        REAL * vDst = dst + vert * stride;
+        for (int k = 0; k < length; ++k) {
+            vDst[k] = 0.0f;
+        }
+        for (int i = 0; i < numSources; ++i) {
+            REAL const * iSrc = src + sources[i] * stride;
+            REAL weight = weights[3*i];
+            for (int k = 0; k < length; ++k) {
+                vDst[k] += weight * iSrc[k];
+            }
+        }
+    }
+}
+
+template <typename REAL>
+void
+PrimvarRefinerReal<REAL>::Limit(int level,
+        PrimvarArray const * primvars, int numPrimvars,
+        Options options) const {
+
+    Limit(level, primvars, numPrimvars, 0, 0, options);
+}
+
+template <typename REAL>
+void
+PrimvarRefinerReal<REAL>::Limit(int level,
+        PrimvarArray const * primvars, int numPrimvars,
+        REAL * const dstTan1[], REAL * const dstTan2[],
+        Options options) const {
+
+    assert(level>=0 && level<=(int)_refiner._refinements.size());
+
+    if (numPrimvars <= 0) return;
+
+    if (level == (int)_refiner._refinements.size()) {
+        _refiner.CompleteLastLevelTopology();
+    }
+    if (_refiner.getLevel(level).getNumVertexEdgesTotal() == 0) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in PrimvarRefiner::Limit() -- "
+            "level of refinement does not include full topology.");
+        return;
+    }
+
+    OPENSUBDIV_TRACE_SCOPE_INDEXED("primvar.limit.level", level);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = options.numThreads;
+#else
+    int numThreads = 1;
+    (void)options;
+#endif
+
+    switch (_refiner._subdivType) {
+    case Sdc::SCHEME_CATMARK:
+        limitArrays<Sdc::SCHEME_CATMARK>(level, primvars, numPrimvars,
+                                         dstTan1, dstTan2, numThreads);
+        break;
+    case Sdc::SCHEME_LOOP:
+        limitArrays<Sdc::SCHEME_LOOP>(level, primvars, numPrimvars,
+                                      dstTan1, dstTan2, numThreads);
+        break;
+    case Sdc::SCHEME_BILINEAR:
+        limitArrays<Sdc::SCHEME_BILINEAR>(level, primvars, numPrimvars,
+                                          dstTan1, dstTan2, numThreads);
+        break;
+    }
+}
+
+template <typename REAL>
+template <Sdc::SchemeType SCHEME>
+void
+PrimvarRefinerReal<REAL>::limitArrays(int levelIndex,
+        PrimvarArray const * primvars, int numPrimvars,
+        REAL * const * dstTan1, REAL * const * dstTan2,
+        int numThreads) const {
+
+    Sdc::Scheme<SCHEME> scheme(_refiner._subdivOptions);
+    Sdc::Crease         crease(_refiner._subdivOptions);
+
+    Vtr::internal::Level const & level = _refiner.getLevel(levelIndex);
+
+    bool hasTangents = (dstTan1 && dstTan2);
+
+    int numVerts          = level.getNumVertices();
+    int maxValence        = level.getMaxValence();
+    int maxWeightsPerMask = 1 + 2 * maxValence;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel if (numThreads > 1) num_threads(numThreads)
+#else
+    (void)numThreads;
+#endif
+    {
+        Vtr::internal::VertexInterface vHood(level, level);
+
+        Vtr::internal::StackBuffer<Weight,99> maskWeights(3 * maxWeightsPerMask);
+        Vtr::internal::StackBuffer<float,16>  eSharpness(maxValence);
+
+        Weight * vPosWeights  = maskWeights,
+               * ePosWeights  = vPosWeights + 1,
+               * fPosWeights  = ePosWeights + maxValence;
+        Weight * vTan1Weights = vPosWeights + maxWeightsPerMask,
+               * eTan1Weights = ePosWeights + maxWeightsPerMask,
+               * fTan1Weights = fPosWeights + maxWeightsPerMask;
+        Weight * vTan2Weights = vTan1Weights + maxWeightsPerMask,
+               * eTan2Weights = eTan1Weights + maxWeightsPerMask,
+               * fTan2Weights = fTan1Weights + maxWeightsPerMask;
+
+        Mask posMask( vPosWeights,  ePosWeights,  fPosWeights);
+        Mask tan1Mask(vTan1Weights, eTan1Weights, fTan1Weights);
+        Mask tan2Mask(vTan2Weights, eTan2Weights, fTan2Weights);
+
+        LimitWeights<REAL> weights(level);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp for schedule(static, 256)
+#endif
+        for (int vert = 0; vert < numVerts; ++vert) {
+            ConstIndexArray vEdges = level.getVertexEdges(vert);
+            ConstIndexArray vFaces = level.getVertexFaces(vert);
+
+            weights.Clear();
+
+            //  Incomplete vertices and those without edges are left at their
+            //  location (with null tangents), as in Limit():
+            if (level.getVertexTag(vert)._incomplete || (vEdges.size() == 0)) {
+                weights.Append(vert, 1.0f, 0.0f, 0.0f);
+            } else {
+                Sdc::Crease::Rule vRule = level.getVertexRule(vert);
+
+                vHood.SetIndex(vert, vert);
+
+                if (hasTangents) {
+                    scheme.ComputeVertexLimitMask(vHood, posMask, tan1Mask, tan2Mask, vRule);
+                } else {
+                    scheme.ComputeVertexLimitMask(vHood, posMask, vRule);
+                    tan1Mask.SetNumFaceWeights(0);
+                    tan1Mask.SetNumEdgeWeights(0);
+                }
+
+                int numFaceWeights = std::max(posMask.GetNumFaceWeights(),
+                                              tan1Mask.GetNumFaceWeights());
+                int numEdgeWeights = std::max(posMask.GetNumEdgeWeights(),
+                                              tan1Mask.GetNumEdgeWeights());
+
+                //  Zero the weights absent from either mask:
+                for (int i = posMask.GetNumFaceWeights(); i < numFaceWeights; ++i) {
+                    fPosWeights[i] = 0.0f;
+                }
+                for (int i = posMask.GetNumEdgeWeights(); i < numEdgeWeights; ++i) {
+                    ePosWeights[i] = 0.0f;
+                }
+                if (!hasTangents) {
+                    std::fill(vTan1Weights, vTan1Weights + 2 * maxWeightsPerMask,
+                              (Weight)0.0f);
+                } else {
+                    for (int i = tan1Mask.GetNumFaceWeights(); i < numFaceWeights; ++i) {
+                        fTan1Weights[i] = fTan2Weights[i] = 0.0f;
+                    }
+                    for (int i = tan1Mask.GetNumEdgeWeights(); i < numEdgeWeights; ++i) {
+                        eTan1Weights[i] = eTan2Weights[i] = 0.0f;
+                    }
+                }
+
+                bool refineLocally = false;
+                if ((SCHEME == Sdc::SCHEME_CATMARK) &&
+                    (vRule != Sdc::Crease::RULE_CORNER)) {
+                    for (int i = 0; i < vFaces.size(); ++i) {
+                        refineLocally |= (level.getFaceVertices(vFaces[i]).size() != 4);
+                    }
+                }
+
+                if (!refineLocally) {
+                    //  Face weights apply to the vertices opposite the vertex
+                    //  in its incident faces and edge weights to the vertices
+                    //  opposite its incident edges -- smaller weights first:
+                    ConstLocalIndexArray vInFace = level.getVertexFaceLocalIndices(vert);
+                    for (int i = 0; i < numFaceWeights; ++i) {
+                        ConstIndexArray fVerts = level.getFaceVertices(vFaces[i]);
+
+                        LocalIndex vOppInFace = (vInFace[i] + 2);
+                        if (vOppInFace >= fVerts.size()) vOppInFace -= (LocalIndex)fVerts.size();
+
+                        weights.Append(fVerts[vOppInFace],
+                            fPosWeights[i], fTan1Weights[i], fTan2Weights[i]);
+                    }
+                    for (int i = 0; i < numEdgeWeights; ++i) {
+                        ConstIndexArray eVerts = level.getEdgeVertices(vEdges[i]);
+
+                        weights.Append((eVerts[0] == vert) ? eVerts[1] : eVerts[0],
+                            ePosWeights[i], eTan1Weights[i], eTan2Weights[i]);
+                    }
+                    weights.Append(vert, vPosWeights[0], vTan1Weights[0], vTan2Weights[0]);
+                } else {
+                    //  The masks apply to the refined neighborhood of the
+                    //  vertex: its child vertex, the child vertices of its
+                    //  edges and those of its faces (opposite the child
+                    //  vertex in each child quad):
+                    int creaseEnds[2] = { 0, 0 };
+                    if (vRule == Sdc::Crease::RULE_CREASE) {
+                        vHood.GetSharpnessPerEdge(eSharpness);
+                        crease.GetSharpEdgePairOfCrease(eSharpness, vEdges.size(), creaseEnds);
+                    }
+
+                    Weight w[3];
+                    for (int i = 0; i < numFaceWeights; ++i) {
+                        w[0] = fPosWeights[i], w[1] = fTan1Weights[i], w[2] = fTan2Weights[i];
+                        weights.AddFacePoint(vFaces[i], w, 1.0f);
+                    }
+                    for (int i = 0; i < numEdgeWeights; ++i) {
+                        w[0] = ePosWeights[i], w[1] = eTan1Weights[i], w[2] = eTan2Weights[i];
+                        weights.AddEdgePoint(vert, vEdges[i], w);
+                    }
+                    w[0] = vPosWeights[0], w[1] = vTan1Weights[0], w[2] = vTan2Weights[0];
+                    weights.AddVertexPoint(vert, vRule, creaseEnds, w);
+                }
+            }
+
+            Index const * sources = weights.GetSources();
+            REAL const * sourceWeights = weights.GetWeights();
+            int numSources = weights.GetNumSources();
+
+            for (int p = 0; p < numPrimvars; ++p) {
+                PrimvarArray const & pv = primvars[p];
+
+                applyLimitWeightsToArray(pv.src, pv.dst, pv.length, pv.stride,
+                        vert, sources, sourceWeights, numSources);
+                if (hasTangents) {
+                    applyLimitWeightsToArray(pv.src, dstTan1[p], pv.length, pv.stride,
+                            vert, sources, sourceWeights + 1, numSources);
+                    applyLimitWeightsToArray(pv.src, dstTan2[p], pv.length, pv.stride,
+                            vert, sources, sourceWeights + 2, numSources);
+                }
+            }
+        }
+    }
+}
+
+//
+//  Explicit instantiation for float and double:
+//
+template class PrimvarRefinerReal<float>;
+template class PrimvarRefinerReal<double>;
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
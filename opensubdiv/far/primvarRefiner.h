@@ -43,6 +43,7 @@
 #include "../far/topologyRefiner.h"
 
 #include <cassert>
+#include <vector>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -112,6 +113,163 @@ public:
     ///
     template <class T, class U> void Interpolate(int level, T const & src, U & dst) const;
 
+    /// \brief Apply vertex interpolation weights to a subset of the refined
+    ///        vertices of a single level of refinement.
+    ///
+    /// Only the destination elements of the given vertices are assigned. As
+    /// the weights of vertices originating from parent edges and vertices may
+    /// include the interpolated values of the child vertices of incident faces,
+    /// these must either be included in the subset or already be present in
+    /// the destination buffer. Vertices of the subset are interpolated in the
+    /// same order as Interpolate(), i.e. those from faces first, then those
+    /// from edges and vertices, in the order given within each group.
+    ///
+    /// @param level     The refinement level
+    ///
+    /// @param src       Source primvar buffer (\ref templating control vertex data)
+    ///
+    /// @param dst       Destination primvar buffer (\ref templating refined vertex data)
+    ///
+    /// @param vertices  Indices of the refined vertices to interpolate
+    ///
+    template <class T, class U> void Interpolate(int level, T const & src, U & dst,
+                                                 ConstIndexArray vertices) const;
+
+    /// \brief Description of a primvar stored in strided arrays of REAL
+    ///
+    /// The components of vertex i are found at src[i * stride] and assigned
+    /// to dst[i * stride], i.e. an offset into an interleaved buffer is
+    /// applied by offsetting the pointers.
+    ///
+    struct PrimvarArray {
+        PrimvarArray() : src(0), dst(0), length(0), stride(0) { }
+        PrimvarArray(REAL const * srcArg, REAL * dstArg, int lengthArg,
+                     int strideArg = 0) :
+            src(srcArg), dst(dstArg), length(lengthArg),
+            stride(strideArg ? strideArg : lengthArg) { }
+
+        REAL const * src;    ///< values of the vertices of the parent level
+        REAL *       dst;    ///< values of the vertices of the refined level
+        int          length; ///< number of components of each value
+        int          stride; ///< number of elements between consecutive values
+    };
+
+    struct Options {
+
+        Options() : numThreads(0) { }
+
+        unsigned int numThreads : 8; ///< Number of threads used to interpolate
+                                     ///< the vertices of each type of parent
+                                     ///< component (or to limit the vertices
+                                     ///< of a level) concurrently (requires
+                                     ///< OpenMP support, ignored otherwise)
+    };
+
+    /// \brief Apply vertex interpolation weights to several primvars stored
+    ///        in strided arrays for a single level of refinement.
+    ///
+    /// The weights of each refined vertex are computed once and applied to
+    /// all primvars, which is more efficient than interpolating each primvar
+    /// independently when several are refined. The result is identical to
+    /// that of Interpolate() with a type accumulating each component.
+    ///
+    /// @param level        The refinement level
+    ///
+    /// @param primvars     Source and destination arrays of each primvar
+    ///                     (the destination arrays must not overlap any of
+    ///                     the source arrays)
+    ///
+    /// @param numPrimvars  Number of primvars
+    ///
+    /// @param options      Options controlling interpolation
+    ///
+    void Interpolate(int level, PrimvarArray const * primvars, int numPrimvars,
+                     Options options = Options()) const;
+
+    /// \brief Vertex interpolation weights of all refined vertices of a level
+    ///
+    /// The weights of each refined vertex are stored as a list of sources
+    /// and weights -- effectively a stencil local to the level whose sources
+    /// are the vertices of the parent level or refined vertices of its faces.
+    /// Once prepared, interpolation is reduced to weighted sums, which avoids
+    /// recomputing the masks when the same topology is used to interpolate
+    /// varying data repeatedly (e.g. deforming meshes).
+    ///
+    class LevelWeights {
+    public:
+        LevelWeights() : _level(0) { }
+
+        /// \brief Returns the refinement level (0 if not prepared)
+        int GetLevel() const { return _level; }
+
+        /// \brief Returns the number of refined vertices
+        int GetNumVertices() const { return (int)_sizes.size(); }
+
+        /// \brief Returns the number of stored weights
+        int GetNumWeights() const { return (int)_weights.size(); }
+
+        /// \brief Returns the amount of memory (in bytes) used by the weights
+        size_t GetMemoryUsage() const;
+
+    private:
+        friend class PrimvarRefinerReal;
+
+        int _level;
+
+        //  First refined vertex and number of refined vertices of each type
+        //  of parent component (faces, edges and vertices) -- interpolated
+        //  in that order:
+        Index _firstVertex[3];
+        int   _numVertices[3];
+
+        std::vector<int>   _sizes;
+        std::vector<Index> _offsets;
+        std::vector<Index> _sources;
+        std::vector<REAL>  _weights;
+    };
+
+    /// \brief Compute and store the vertex interpolation weights of all
+    ///        refined vertices of a single level of refinement
+    ///
+    /// @param level    The refinement level
+    ///
+    /// @param weights  The weights to prepare (any previous content is
+    ///                 replaced)
+    ///
+    void PrepareWeights(int level, LevelWeights & weights) const;
+
+    /// \brief Apply previously prepared vertex interpolation weights to a
+    ///        primvar buffer for a single level of refinement
+    ///
+    /// The result is identical to that of Interpolate() for the level of
+    /// the weights, provided the topology has not been refined again.
+    ///
+    /// @param weights  Weights prepared for the refinement level
+    ///
+    /// @param src      Source primvar buffer (\ref templating control vertex data)
+    ///
+    /// @param dst      Destination primvar buffer (\ref templating refined vertex data)
+    ///
+    template <class T, class U> void Interpolate(LevelWeights const & weights,
+                                                 T const & src, U & dst) const;
+
+    /// \brief Apply previously prepared vertex interpolation weights to
+    ///        several primvars stored in strided arrays
+    ///
+    /// @param weights      Weights prepared for the refinement level
+    ///
+    /// @param primvars     Source and destination arrays of each primvar
+    ///                     (the destination arrays must not overlap any of
+    ///                     the source arrays)
+    ///
+    /// @param numPrimvars  Number of primvars
+    ///
+    /// @param options      Options controlling interpolation
+    ///
+    void Interpolate(LevelWeights const & weights,
+                     PrimvarArray const * primvars, int numPrimvars,
+                     Options options = Options()) const;
+
     /// \brief Apply only varying interpolation weights to a primvar buffer
     ///        for a single level of refinement.
     ///
@@ -168,6 +326,9 @@ public:
     /// must allocate an array for all vertices at the last refinement level,
     /// i.e. at least refiner.GetLevel(refiner.GetMaxLevel()).GetNumVertices()
     ///
+    /// If the last level was refined without full topology, it is completed
+    /// on first use (see TopologyRefiner::CompleteLastLevelTopology()).
+    ///
     /// @param src     Source primvar buffer (refined data) for last level
     ///
     /// @param dstPos  Destination primvar buffer (data at the limit)
@@ -179,6 +340,54 @@ public:
 
     template <class T, class U> void LimitFaceVarying(T const & src, U & dst, int channel = 0) const;
 
+    /// \brief Apply limit weights to several primvars stored in strided
+    ///        arrays for the vertices of any level
+    ///
+    /// Unlike Limit(), the vertices of any level with full topology can be
+    /// projected to the limit -- including those of the base level of an
+    /// unrefined TopologyRefiner -- so no further level needs to be refined
+    /// or interpolated. Vertices of Catmark meshes incident to faces other
+    /// than quads (only present in the base level) are evaluated from the
+    /// points of a single local refinement of their neighborhood, which is
+    /// computed directly from the vertices of the level. Results for the
+    /// last level are identical to those of Limit().
+    ///
+    /// @param level        The level of the vertices
+    ///
+    /// @param primvars     Source and destination arrays of each primvar:
+    ///                     the data of the vertices of the level and their
+    ///                     positions at the limit (the destination arrays
+    ///                     must not overlap any of the source arrays)
+    ///
+    /// @param numPrimvars  Number of primvars
+    ///
+    /// @param options      Options controlling the evaluation
+    ///
+    void Limit(int level, PrimvarArray const * primvars, int numPrimvars,
+               Options options = Options()) const;
+
+    /// \brief Apply limit position and tangent weights to several primvars
+    ///        stored in strided arrays for the vertices of any level
+    ///
+    /// @param level        The level of the vertices
+    ///
+    /// @param primvars     Source and destination arrays of each primvar
+    ///                     (as above)
+    ///
+    /// @param numPrimvars  Number of primvars
+    ///
+    /// @param dstTan1      Destination arrays of the first tangent of each
+    ///                     primvar (with the length and stride of the primvar)
+    ///
+    /// @param dstTan2      Destination arrays of the second tangent of each
+    ///                     primvar (with the length and stride of the primvar)
+    ///
+    /// @param options      Options controlling the evaluation
+    ///
+    void Limit(int level, PrimvarArray const * primvars, int numPrimvars,
+               REAL * const dstTan1[], REAL * const dstTan2[],
+               Options options = Options()) const;
+
     //@}
 
 private:
@@ -188,9 +397,33 @@ private:
     PrimvarRefinerReal(PrimvarRefinerReal const & src) : _refiner(src._refiner) { }
     PrimvarRefinerReal & operator=(PrimvarRefinerReal const &) { return *this; }
 
-    template <Sdc::SchemeType SCHEME, class T, class U> void interpFromFaces(int, T const &, U &) const;
-    template <Sdc::SchemeType SCHEME, class T, class U> void interpFromEdges(int, T const &, U &) const;
-    template <Sdc::SchemeType SCHEME, class T, class U> void interpFromVerts(int, T const &, U &) const;
+    //  Vertex interpolation of all child vertices from a type of parent component,
+    //  or only those in an optional subset of the child vertices:
+    template <Sdc::SchemeType SCHEME, class T, class U>
+    void interpFromFaces(int, T const &, U &, ConstIndexArray const * subset = 0) const;
+    template <Sdc::SchemeType SCHEME, class T, class U>
+    void interpFromEdges(int, T const &, U &, ConstIndexArray const * subset = 0) const;
+    template <Sdc::SchemeType SCHEME, class T, class U>
+    void interpFromVerts(int, T const &, U &, ConstIndexArray const * subset = 0) const;
+
+    //  Gathering of the vertex weights of all child vertices from a type of
+    //  parent component, each list of sources and weights being passed to
+    //  an action applying or storing them (see primvarRefiner.cpp):
+    template <Sdc::SchemeType SCHEME, class ACTION>
+    void gatherWeightsFromFaces(int, ACTION &, int numThreads) const;
+    template <Sdc::SchemeType SCHEME, class ACTION>
+    void gatherWeightsFromEdges(int, ACTION &, int numThreads) const;
+    template <Sdc::SchemeType SCHEME, class ACTION>
+    void gatherWeightsFromVerts(int, ACTION &, int numThreads) const;
+
+    template <class ACTION>
+    void gatherWeights(int, ACTION &, int numThreads) const;
+
+    //  Limit positions and optional tangents of the vertices of a level for
+    //  primvars stored in strided arrays:
+    template <Sdc::SchemeType SCHEME>
+    void limitArrays(int, PrimvarArray const *, int,
+                     REAL * const *, REAL * const *, int numThreads) const;
 
     template <Sdc::SchemeType SCHEME, class T, class U> void interpFVarFromFaces(int, T const &, U &, int) const;
     template <Sdc::SchemeType SCHEME, class T, class U> void interpFVarFromEdges(int, T const &, U &, int) const;
@@ -287,6 +520,64 @@ PrimvarRefinerReal<REAL>::Interpolate(int level, T const & src, U & dst) const {
     }
 }
 
+template <typename REAL>
+template <class T, class U>
+inline void
+PrimvarRefinerReal<REAL>::Interpolate(int level, T const & src, U & dst,
+                                      ConstIndexArray vertices) const {
+
+    assert(level>0 && level<=(int)_refiner._refinements.size());
+
+    switch (_refiner._subdivType) {
+    case Sdc::SCHEME_CATMARK:
+        interpFromFaces<Sdc::SCHEME_CATMARK>(level, src, dst, &vertices);
+        interpFromEdges<Sdc::SCHEME_CATMARK>(level, src, dst, &vertices);
+        interpFromVerts<Sdc::SCHEME_CATMARK>(level, src, dst, &vertices);
+        break;
+    case Sdc::SCHEME_LOOP:
+        interpFromFaces<Sdc::SCHEME_LOOP>(level, src, dst, &vertices);
+        interpFromEdges<Sdc::SCHEME_LOOP>(level, src, dst, &vertices);
+        interpFromVerts<Sdc::SCHEME_LOOP>(level, src, dst, &vertices);
+        break;
+    case Sdc::SCHEME_BILINEAR:
+        interpFromFaces<Sdc::SCHEME_BILINEAR>(level, src, dst, &vertices);
+        interpFromEdges<Sdc::SCHEME_BILINEAR>(level, src, dst, &vertices);
+        interpFromVerts<Sdc::SCHEME_BILINEAR>(level, src, dst, &vertices);
+        break;
+    }
+}
+
+template <typename REAL>
+template <class T, class U>
+inline void
+PrimvarRefinerReal<REAL>::Interpolate(LevelWeights const & weights,
+                                      T const & src, U & dst) const {
+
+    assert(weights._level>0 && weights._level<=(int)_refiner._refinements.size());
+
+    //  Sources with a negative index are the (complemented) indices of child
+    //  vertices of faces, i.e. refined vertices interpolated in an earlier pass:
+    for (int pass = 0; pass < 3; ++pass) {
+        Index cVertEnd = weights._firstVertex[pass] + weights._numVertices[pass];
+
+        for (Index cVert = weights._firstVertex[pass]; cVert < cVertEnd; ++cVert) {
+
+            int          size    = weights._sizes[cVert];
+            Index const* sources = &weights._sources[weights._offsets[cVert]];
+            REAL const * wts     = &weights._weights[weights._offsets[cVert]];
+
+            dst[cVert].Clear();
+            for (int i = 0; i < size; ++i) {
+                if (sources[i] >= 0) {
+                    dst[cVert].AddWithWeight(src[sources[i]], wts[i]);
+                } else {
+                    dst[cVert].AddWithWeight(dst[~sources[i]], wts[i]);
+                }
+            }
+        }
+    }
+}
+
 template <typename REAL>
 template <class T, class U>
 inline void
@@ -294,6 +585,13 @@ PrimvarRefinerReal<REAL>::InterpolateFaceVarying(int level, T const & src, U & d
 
     assert(level>0 && level<=(int)_refiner._refinements.size());
 
+    //  Values of the refined levels of a channel matching the vertex topology are
+    //  implicitly the vertices, so are interpolated as vertices without indirection:
+    if (_refiner.getLevel(level-1).getFVarLevel(channel).valuesAreVertices()) {
+        Interpolate(level, src, dst);
+        return;
+    }
+
     switch (_refiner._subdivType) {
     case Sdc::SCHEME_CATMARK:
         interpFVarFromFaces<Sdc::SCHEME_CATMARK>(level, src, dst, channel);
@@ -318,6 +616,8 @@ template <class T, class U>
 inline void
 PrimvarRefinerReal<REAL>::Limit(T const & src, U & dst) const {
 
+    _refiner.CompleteLastLevelTopology();
+
     if (_refiner.getLevel(_refiner.GetMaxLevel()).getNumVertexEdgesTotal() == 0) {
         Error(FAR_RUNTIME_ERROR,
             "Failure in PrimvarRefiner::Limit() -- "
@@ -343,6 +643,8 @@ template <class T, class U, class U1, class U2>
 inline void
 PrimvarRefinerReal<REAL>::Limit(T const & src, U & dstPos, U1 & dstTan1, U2 & dstTan2) const {
 
+    _refiner.CompleteLastLevelTopology();
+
     if (_refiner.getLevel(_refiner.GetMaxLevel()).getNumVertexEdgesTotal() == 0) {
         Error(FAR_RUNTIME_ERROR,
             "Failure in PrimvarRefiner::Limit() -- "
@@ -368,6 +670,8 @@ template <class T, class U>
 inline void
 PrimvarRefinerReal<REAL>::LimitFaceVarying(T const & src, U & dst, int channel) const {
 
+    _refiner.CompleteLastLevelTopology();
+
     if (_refiner.getLevel(_refiner.GetMaxLevel()).getNumVertexEdgesTotal() == 0) {
         Error(FAR_RUNTIME_ERROR,
             "Failure in PrimvarRefiner::LimitFaceVarying() -- "
@@ -472,7 +776,8 @@ PrimvarRefinerReal<REAL>::InterpolateVarying(int level, T const & src, U & dst)
 template <typename REAL>
 template <Sdc::SchemeType SCHEME, class T, class U>
 inline void
-PrimvarRefinerReal<REAL>::interpFromFaces(int level, T const & src, U & dst) const {
+PrimvarRefinerReal<REAL>::interpFromFaces(int level, T const & src, U & dst,
+                                          ConstIndexArray const * subset) const {
 
     Vtr::internal::Refinement const & refinement = _refiner.getRefinement(level-1);
     Vtr::internal::Level const &      parent     = refinement.parent();
@@ -483,11 +788,24 @@ PrimvarRefinerReal<REAL>::interpFromFaces(int level, T const & src, U & dst) con
 
     Vtr::internal::StackBuffer<Weight,16> fVertWeights(parent.getMaxValence());
 
-    for (int face = 0; face < parent.getNumFaces(); ++face) {
+    int firstChild = refinement.getFirstChildVertexFromFaces(),
+        numChildren = refinement.getNumChildVerticesFromFaces();
 
-        Vtr::Index cVert = refinement.getFaceChildVertex(face);
-        if (!Vtr::IndexIsValid(cVert))
-            continue;
+    int numItems = subset ? subset->size() : parent.getNumFaces();
+    for (int item = 0; item < numItems; ++item) {
+
+        Vtr::Index face, cVert;
+        if (subset) {
+            cVert = (*subset)[item];
+            if ((cVert < firstChild) || (cVert >= firstChild + numChildren))
+                continue;
+            face = refinement.getChildVertexParentIndex(cVert);
+        } else {
+            face  = item;
+            cVert = refinement.getFaceChildVertex(face);
+            if (!Vtr::IndexIsValid(cVert))
+                continue;
+        }
 
         //  Declare and compute mask weights for this vertex relative to its parent face:
         ConstIndexArray fVerts = parent.getFaceVertices(face);
@@ -510,7 +828,8 @@ PrimvarRefinerReal<REAL>::interpFromFaces(int level, T const & src, U & dst) con
 template <typename REAL>
 template <Sdc::SchemeType SCHEME, class T, class U>
 inline void
-PrimvarRefinerReal<REAL>::interpFromEdges(int level, T const & src, U & dst) const {
+PrimvarRefinerReal<REAL>::interpFromEdges(int level, T const & src, U & dst,
+                                          ConstIndexArray const * subset) const {
 
     Vtr::internal::Refinement const & refinement = _refiner.getRefinement(level-1);
     Vtr::internal::Level const &      parent     = refinement.parent();
@@ -523,11 +842,24 @@ PrimvarRefinerReal<REAL>::interpFromEdges(int level, T const & src, U & dst) con
     Weight                               eVertWeights[2];
     Vtr::internal::StackBuffer<Weight,8> eFaceWeights(parent.getMaxEdgeFaces());
 
-    for (int edge = 0; edge < parent.getNumEdges(); ++edge) {
+    int firstChild = refinement.getFirstChildVertexFromEdges(),
+        numChildren = refinement.getNumChildVerticesFromEdges();
 
-        Vtr::Index cVert = refinement.getEdgeChildVertex(edge);
-        if (!Vtr::IndexIsValid(cVert))
-            continue;
+    int numItems = subset ? subset->size() : parent.getNumEdges();
+    for (int item = 0; item < numItems; ++item) {
+
+        Vtr::Index edge, cVert;
+        if (subset) {
+            cVert = (*subset)[item];
+            if ((cVert < firstChild) || (cVert >= firstChild + numChildren))
+                continue;
+            edge = refinement.getChildVertexParentIndex(cVert);
+        } else {
+            edge  = item;
+            cVert = refinement.getEdgeChildVertex(edge);
+            if (!Vtr::IndexIsValid(cVert))
+                continue;
+        }
 
         //  Declare and compute mask weights for this vertex relative to its parent edge:
         ConstIndexArray eVerts = parent.getEdgeVertices(edge),
@@ -580,7 +912,8 @@ PrimvarRefinerReal<REAL>::interpFromEdges(int level, T const & src, U & dst) con
 template <typename REAL>
 template <Sdc::SchemeType SCHEME, class T, class U>
 inline void
-PrimvarRefinerReal<REAL>::interpFromVerts(int level, T const & src, U & dst) const {
+PrimvarRefinerReal<REAL>::interpFromVerts(int level, T const & src, U & dst,
+                                          ConstIndexArray const * subset) const {
 
     Vtr::internal::Refinement const & refinement = _refiner.getRefinement(level-1);
     Vtr::internal::Level const &      parent     = refinement.parent();
@@ -592,11 +925,24 @@ PrimvarRefinerReal<REAL>::interpFromVerts(int level, T const & src, U & dst) con
 
     Vtr::internal::StackBuffer<Weight,32> weightBuffer(2*parent.getMaxValence());
 
-    for (int vert = 0; vert < parent.getNumVertices(); ++vert) {
+    int firstChild = refinement.getFirstChildVertexFromVertices(),
+        numChildren = refinement.getNumChildVerticesFromVertices();
 
-        Vtr::Index cVert = refinement.getVertexChildVertex(vert);
-        if (!Vtr::IndexIsValid(cVert))
-            continue;
+    int numItems = subset ? subset->size() : parent.getNumVertices();
+    for (int item = 0; item < numItems; ++item) {
+
+        Vtr::Index vert, cVert;
+        if (subset) {
+            cVert = (*subset)[item];
+            if ((cVert < firstChild) || (cVert >= firstChild + numChildren))
+                continue;
+            vert = refinement.getChildVertexParentIndex(cVert);
+        } else {
+            vert  = item;
+            cVert = refinement.getVertexChildVertex(vert);
+            if (!Vtr::IndexIsValid(cVert))
+                continue;
+        }
 
         //  Declare and compute mask weights for this vertex relative to its parent edge:
         ConstIndexArray vEdges = parent.getVertexEdges(vert),
@@ -743,9 +1089,10 @@ PrimvarRefinerReal<REAL>::interpFVarFromEdges(int level, T const & src, U & dst,
         if (!Vtr::IndexIsValid(cVert))
             continue;
 
-        ConstIndexArray cVertValues = childFVar.getVertexValues(cVert);
+        int        cValueCount = childFVar.getNumVertexValues(cVert);
+        Vtr::Index cValue0     = childFVar.getVertexValueOffset(cVert);
 
-        bool fvarEdgeVertMatchesVertex = childFVar.valueTopologyMatches(cVertValues[0]);
+        bool fvarEdgeVertMatchesVertex = childFVar.valueTopologyMatches(cValue0);
         if (fvarEdgeVertMatchesVertex) {
             //
             //  If smoothly interpolated, compute new weights for the edge mask:
@@ -784,7 +1131,7 @@ PrimvarRefinerReal<REAL>::interpFVarFromEdges(int level, T const & src, U & dst,
 
             parentFVar.getEdgeFaceValues(edge, 0, eVertValues);
 
-            Index cVertValue = cVertValues[0];
+            Index cVertValue = cValue0;
 
             dst[cVertValue].Clear();
             dst[cVertValue].AddWithWeight(src[eVertValues[0]], eVertWeights[0]);
@@ -828,14 +1175,14 @@ PrimvarRefinerReal<REAL>::interpFVarFromEdges(int level, T const & src, U & dst,
             //  In the manifold case, the sibling and edge-face indices will correspond.  We
             //  will eventually need to update this to account for > 3 incident faces.
             //
-            for (int i = 0; i < cVertValues.size(); ++i) {
+            for (int i = 0; i < cValueCount; ++i) {
                 Vtr::Index eVertValues[2];
                 int      eFaceIndex = refineFVar.getChildValueParentSource(cVert, i);
                 assert(eFaceIndex == i);
 
                 parentFVar.getEdgeFaceValues(edge, eFaceIndex, eVertValues);
 
-                Index cVertValue = cVertValues[i];
+                Index cVertValue = cValue0 + i;
 
                 dst[cVertValue].Clear();
                 dst[cVertValue].AddWithWeight(src[eVertValues[0]], 0.5);
@@ -875,13 +1222,13 @@ PrimvarRefinerReal<REAL>::interpFVarFromVerts(int level, T const & src, U & dst,
         if (!Vtr::IndexIsValid(cVert))
             continue;
 
-        ConstIndexArray pVertValues = parentFVar.getVertexValues(vert),
-                        cVertValues = childFVar.getVertexValues(cVert);
+        int        cValueCount = childFVar.getNumVertexValues(cVert);
+        Vtr::Index cValue0     = childFVar.getVertexValueOffset(cVert);
 
-        bool fvarVertVertMatchesVertex = childFVar.valueTopologyMatches(cVertValues[0]);
+        bool fvarVertVertMatchesVertex = childFVar.valueTopologyMatches(cValue0);
         if (isLinearFVar && fvarVertVertMatchesVertex) {
-            dst[cVertValues[0]].Clear();
-            dst[cVertValues[0]].AddWithWeight(src[pVertValues[0]], 1.0f);
+            dst[cValue0].Clear();
+            dst[cValue0].AddWithWeight(src[parentFVar.getVertexValue(vert)], 1.0f);
             continue;
         }
 
@@ -931,8 +1278,8 @@ PrimvarRefinerReal<REAL>::interpFVarFromVerts(int level, T const & src, U & dst,
             //  precision, it's better to apply smaller weights first, so begin with the
             //  face-weights followed by the edge-weights and the vertex weight last.
             //
-            Vtr::Index pVertValue = pVertValues[0];
-            Vtr::Index cVertValue = cVertValues[0];
+            Vtr::Index pVertValue = parentFVar.getVertexValue(vert);
+            Vtr::Index cVertValue = cValue0;
 
             dst[cVertValue].Clear();
             if (vMask.GetNumFaceWeights() > 0) {
@@ -969,12 +1316,12 @@ PrimvarRefinerReal<REAL>::interpFVarFromVerts(int level, T const & src, U & dst,
             Vtr::internal::FVarLevel::ConstValueTagArray pValueTags = parentFVar.getVertexValueTags(vert);
             Vtr::internal::FVarLevel::ConstValueTagArray cValueTags = childFVar.getVertexValueTags(cVert);
 
-            for (int cSibling = 0; cSibling < cVertValues.size(); ++cSibling) {
+            for (int cSibling = 0; cSibling < cValueCount; ++cSibling) {
                 int pSibling = refineFVar.getChildValueParentSource(cVert, cSibling);
                 assert(pSibling == cSibling);
 
-                Vtr::Index pVertValue = pVertValues[pSibling];
-                Vtr::Index cVertValue = cVertValues[cSibling];
+                Vtr::Index pVertValue = parentFVar.getVertexValue(vert, (LocalIndex)pSibling);
+                Vtr::Index cVertValue = cValue0 + cSibling;
 
                 dst[cVertValue].Clear();
                 if (isLinearFVar || cValueTags[cSibling].isCorner()) {
@@ -1168,8 +1515,8 @@ PrimvarRefinerReal<REAL>::limitFVar(T const & src, U & dst, int channel) const {
 
     for (int vert = 0; vert < level.getNumVertices(); ++vert) {
 
-        ConstIndexArray vEdges  = level.getVertexEdges(vert);
-        ConstIndexArray vValues = fvarChannel.getVertexValues(vert);
+        ConstIndexArray vEdges      = level.getVertexEdges(vert);
+        int             vValueCount = fvarChannel.getNumVertexValues(vert);
 
         //  Incomplete vertices (present in sparse refinement) do not have their full
         //  topological neighborhood to determine a proper limit -- just leave the
@@ -1179,8 +1526,8 @@ PrimvarRefinerReal<REAL>::limitFVar(T const & src, U & dst, int channel) const {
         //
         bool isIncomplete = (level.getVertexTag(vert)._incomplete || (vEdges.size() == 0));
         if (isIncomplete || fvarChannel.isLinear()) {
-            for (int i = 0; i < vValues.size(); ++i) {
-                Vtr::Index vValue = vValues[i];
+            for (int i = 0; i < vValueCount; ++i) {
+                Vtr::Index vValue = fvarChannel.getVertexValue(vert, (LocalIndex)i);
 
                 dst[vValue].Clear();
                 dst[vValue].AddWithWeight(src[vValue], 1.0f);
@@ -1188,7 +1535,7 @@ PrimvarRefinerReal<REAL>::limitFVar(T const & src, U & dst, int channel) const {
             continue;
         }
 
-        bool fvarVertMatchesVertex = fvarChannel.valueTopologyMatches(vValues[0]);
+        bool fvarVertMatchesVertex = fvarChannel.valueTopologyMatches(fvarChannel.getVertexValueOffset(vert));
         if (fvarVertMatchesVertex) {
 
             //  Assign the mask weights to the common buffer and compute the mask:
@@ -1206,7 +1553,7 @@ PrimvarRefinerReal<REAL>::limitFVar(T const & src, U & dst, int channel) const {
             //
             //  Apply mask to corresponding FVar values for neighboring vertices:
             //
-            Vtr::Index vValue = vValues[0];
+            Vtr::Index vValue = fvarChannel.getVertexValue(vert);
 
             dst[vValue].Clear();
             if (vMask.GetNumFaceWeights() > 0) {
@@ -1238,8 +1585,8 @@ PrimvarRefinerReal<REAL>::limitFVar(T const & src, U & dst, int channel) const {
             //
             //  Sibling FVar values associated with a vertex will be either a corner or a crease:
             //
-            for (int i = 0; i < vValues.size(); ++i) {
-                Vtr::Index vValue = vValues[i];
+            for (int i = 0; i < vValueCount; ++i) {
+                Vtr::Index vValue = fvarChannel.getVertexValue(vert, (LocalIndex)i);
 
                 dst[vValue].Clear();
                 if (fvarChannel.getValueTag(vValue).isCorner()) {
@@ -1263,6 +1610,75 @@ public:
         : PrimvarRefinerReal<float>(refiner) { }
 };
 
+
+///
+///  \brief A PrimvarRefiner with the vertex interpolation weights of all
+///         levels of refinement prepared on construction
+///
+///  Vertex interpolation with a PreparedPrimvarRefiner only applies the
+///  stored weights, which is substantially cheaper than recomputing them
+///  when the same topology is used to interpolate vertex data repeatedly,
+///  without constructing a StencilTable for all levels.  The topology must
+///  not be refined again once the weights are prepared.
+///
+template <typename REAL>
+class PreparedPrimvarRefinerReal : public PrimvarRefinerReal<REAL> {
+
+public:
+    typedef PrimvarRefinerReal<REAL>              BaseRefiner;
+    typedef typename BaseRefiner::LevelWeights    LevelWeights;
+    typedef typename BaseRefiner::PrimvarArray    PrimvarArray;
+    typedef typename BaseRefiner::Options         Options;
+
+    PreparedPrimvarRefinerReal(TopologyRefiner const & refiner) :
+        BaseRefiner(refiner), _levelWeights(refiner.GetNumLevels() - 1) {
+
+        for (int level = 1; level < refiner.GetNumLevels(); ++level) {
+            BaseRefiner::PrepareWeights(level, _levelWeights[level-1]);
+        }
+    }
+    ~PreparedPrimvarRefinerReal() { }
+
+    /// \brief Returns the prepared weights of a refinement level
+    LevelWeights const & GetLevelWeights(int level) const {
+        assert(level>0 && level<=(int)_levelWeights.size());
+        return _levelWeights[level-1];
+    }
+
+    /// \brief Apply the prepared vertex interpolation weights to a primvar
+    ///        buffer for a single level of refinement (see
+    ///        PrimvarRefinerReal::Interpolate())
+    template <class T, class U> void Interpolate(int level, T const & src, U & dst) const {
+        BaseRefiner::Interpolate(GetLevelWeights(level), src, dst);
+    }
+
+    /// \brief Apply the prepared vertex interpolation weights to several
+    ///        primvars stored in strided arrays (see
+    ///        PrimvarRefinerReal::Interpolate())
+    void Interpolate(int level, PrimvarArray const * primvars, int numPrimvars,
+                     Options options = Options()) const {
+        BaseRefiner::Interpolate(GetLevelWeights(level), primvars, numPrimvars, options);
+    }
+
+    /// \brief Returns the amount of memory (in bytes) used by the weights
+    size_t GetMemoryUsage() const {
+        size_t memoryUsage = sizeof(*this);
+        for (int i = 0; i < (int)_levelWeights.size(); ++i) {
+            memoryUsage += _levelWeights[i].GetMemoryUsage();
+        }
+        return memoryUsage;
+    }
+
+private:
+    std::vector<LevelWeights> _levelWeights;
+};
+
+class PreparedPrimvarRefiner : public PreparedPrimvarRefinerReal<float> {
+public:
+    PreparedPrimvarRefiner(TopologyRefiner const & refiner)
+        : PreparedPrimvarRefinerReal<float>(refiner) { }
+};
+
 } // end namespace Far
 
 } // end namespace OPENSUBDIV_VERSION
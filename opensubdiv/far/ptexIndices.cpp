@@ -56,8 +56,8 @@ PtexIndices::initializePtexIndices(TopologyRefiner const &refiner) {
     int ptexID=0;
     for (int i = 0; i < nfaces; ++i) {
         _ptexIndices[i] = ptexID;
-        Vtr::ConstIndexArray fverts = coarseLevel.getFaceVertices(i);
-        ptexID += fverts.size()==regFaceSize ? 1 : fverts.size();
+        int nverts = coarseLevel.getNumFaceVertices(i);
+        ptexID += nverts==regFaceSize ? 1 : nverts;
     }
     // last entry contains the number of ptex texture faces
     _ptexIndices[nfaces]=ptexID;
@@ -207,6 +207,46 @@ PtexIndices::GetAdjacency(
     }
 }
 
+void
+PtexIndices::ComputeAdjacency(TopologyRefiner const &refiner) {
+
+    int regFaceSize =
+        Sdc::SchemeTypeTraits::GetRegularFaceSize(refiner.GetSchemeType());
+
+    Vtr::internal::Level const & level = refiner.getLevel(0);
+
+    int nfaces = level.getNumFaces();
+    int nptexFaces = GetNumFaces();
+
+    _adjFaces.resize(4*nptexFaces);
+    _adjEdges.resize(4*nptexFaces);
+
+    int adjFaces[4], adjEdges[4];
+    for (int face = 0; face < nfaces; ++face) {
+
+        int nverts = level.getNumFaceVertices(face);
+        if (nverts!=regFaceSize && regFaceSize!=4) {
+            Far::Error(FAR_RUNTIME_ERROR,
+                    "Failure in PtexIndices::ComputeAdjacency() -- "
+                    "irregular faces only supported for quad schemes.");
+            _adjFaces.clear();
+            _adjEdges.clear();
+            return;
+        }
+
+        int nquadrants = (nverts==regFaceSize) ? 1 : nverts;
+        for (int quadrant = 0; quadrant < nquadrants; ++quadrant) {
+            GetAdjacency(refiner, face, quadrant, adjFaces, adjEdges);
+
+            int ptexFace = _ptexIndices[face] + quadrant;
+            for (int i=0; i<4; ++i) {
+                _adjFaces[4*ptexFace + i] = adjFaces[i];
+                _adjEdges[4*ptexFace + i] = (unsigned char)adjEdges[i];
+            }
+        }
+    }
+}
+
 } // end namespace Far
 
 } // end namespace OPENSUBDIV_VERSION
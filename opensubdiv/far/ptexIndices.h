@@ -29,6 +29,7 @@
 #include "../far/topologyRefiner.h"
 #include "../far/types.h"
 
+#include <cassert>
 #include <vector>
 
 namespace OpenSubdiv {
@@ -85,6 +86,34 @@ public:
         int face, int quadrant,
         int adjFaces[4], int adjEdges[4]) const;
 
+    /// \brief Precomputes the adjacency of all ptex faces, which is then
+    /// returned by GetAdjacency(ptexFace, ...) without any topological
+    /// traversal (e.g. for the many queries of ptex filtering)
+    ///
+    /// @param refiner   refiner used to build this PtexIndices object.
+    ///
+    void ComputeAdjacency(TopologyRefiner const &refiner);
+
+    /// \brief Returns true if the adjacency has been precomputed
+    bool HasAdjacency() const { return !_adjFaces.empty(); }
+
+    /// \brief Returns the precomputed adjacency of a ptex face (see
+    /// ComputeAdjacency())
+    ///
+    /// @param ptexFace  ptex face index
+    ///
+    /// @param adjFaces  ptex face indices of adjacent faces
+    ///
+    /// @param adjEdges  ptex edge indices of adjacent faces
+    ///
+    void GetAdjacency(int ptexFace, int adjFaces[4], int adjEdges[4]) const {
+        assert(HasAdjacency());
+        for (int i=0; i<4; ++i) {
+            adjFaces[i] = _adjFaces[4*ptexFace + i];
+            adjEdges[i] = _adjEdges[4*ptexFace + i];
+        }
+    }
+
     //@}
 
 private:
@@ -94,6 +123,10 @@ private:
 private:
 
     std::vector<Index> _ptexIndices;
+
+    // precomputed adjacent faces and edges, 4 per ptex face
+    std::vector<Index>         _adjFaces;
+    std::vector<unsigned char> _adjEdges;
 };
 
 
@@ -24,6 +24,8 @@
 
 #include "../far/stencilBuilder.h"
 #include "../far/topologyRefiner.h"
+
+#include <algorithm>
  
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -157,10 +159,23 @@ public:
             _weights[i] = 1.0;
         }
 
-        _size = static_cast<int>(_sources.size());
+        _size = static_cast<Offset>(_sources.size());
         _lastOffset = _size - 1;
     }
 
+    // Construct an empty table for stencils whose sources are resolved from
+    // those of another table (see AddWithWeight() and Append() below).
+    WeightTable(WeightTable const & resolver, int numElements)
+        : _size(0)
+        , _lastOffset(0)
+        , _coarseVertCount(resolver._coarseVertCount)
+        , _compactWeights(resolver._compactWeights)
+    {
+        _dests.reserve(numElements);
+        _sources.reserve(numElements);
+        _weights.reserve(numElements);
+    }
+
     template <class W, class WACCUM>
     void AddWithWeight(int src, int dest, W weight, WACCUM weights)
     {
@@ -182,9 +197,9 @@ public:
         //
         // Find the src stencil and number of contributing CVs.
         int len = _sizes[src];
-        int start = _indices[src];
+        Offset start = _indices[src];
 
-        for (int i = start; i < start+len; i++) {
+        for (Offset i = start; i < start+len; i++) {
             // Invariant: by processing each level in order and each vertex in
             // dependent order, any src stencil vertex reference is guaranteed
             // to consist only of coarse verts: therefore resolving src verts
@@ -197,6 +212,62 @@ public:
         }
     }
 
+    // Same as the scalar AddWithWeight() above, but with stencils of src
+    // vertices that are not in the control mesh resolved from the given
+    // table rather than this one. The resolving table is only read, so
+    // several tables may be populated concurrently from the same one.
+    void AddWithWeight(WeightTable const & resolver,
+                       int src, int dest, REAL weight)
+    {
+        if (src < _coarseVertCount) {
+            merge(src, dest, weight, REAL(1.0), _lastOffset, _size,
+                  GetScalarAccumulator());
+            return;
+        }
+
+        int len = resolver._sizes[src];
+        Offset start = resolver._indices[src];
+
+        for (Offset i = start; i < start+len; i++) {
+            assert(resolver._sources[i] < _coarseVertCount);
+
+            merge(resolver._sources[i], dest, resolver._weights[i], weight,
+                                _lastOffset, _size, GetScalarAccumulator());
+        }
+    }
+
+    // Append the stencils of another table, where stencil[i] of the other
+    // table becomes the stencil of vertex dests[i] in this one.
+    void Append(WeightTable const & other, int const * dests)
+    {
+        Offset base = static_cast<Offset>(_sources.size());
+
+        for (int i = 0; i < (int)other._sizes.size(); ++i) {
+            if (other._sizes[i] == 0) continue;
+
+            int dst = dests[i];
+            if (dst+1 > (int)_indices.size()) {
+                _indices.resize(dst+1);
+                _sizes.resize(dst+1);
+            }
+            _indices[dst] = base + other._indices[i];
+            _sizes[dst] = other._sizes[i];
+        }
+        if (other._size == 0) return;
+
+        _dests.reserve(_dests.size() + other._size);
+        for (Offset i = 0; i < other._size; ++i) {
+            _dests.push_back(dests[other._dests[i]]);
+        }
+        _sources.insert(_sources.end(),
+                        other._sources.begin(), other._sources.end());
+        _weights.insert(_weights.end(),
+                        other._weights.begin(), other._weights.end());
+
+        _size += other._size;
+        _lastOffset = base + other._lastOffset;
+    }
+
     class Point1stDerivAccumulator {
         WeightTable* _tbl;
     public:
@@ -275,7 +346,7 @@ public:
         return ScalarAccumulator(this);
     };
 
-    std::vector<int> const&
+    std::vector<Offset> const&
     GetOffsets() const { return _indices; }
 
     std::vector<int> const& 
@@ -318,7 +389,7 @@ private:
                W weightFactor, 
                // Similarly, passing offset & tableSize as params yields higher
                // performance than accessing the class members directly.
-               int lastOffset, int tableSize, WACCUM weights)
+               Offset lastOffset, Offset tableSize, WACCUM weights)
     {
         // The lastOffset is the vertex we're currently processing, by
         // leveraging this we need not lookup the dest stencil size or offset.
@@ -329,7 +400,7 @@ private:
 
             // tableSize is exactly _sources.size(), but using tableSize is
             // significantly faster.
-            for (int i = lastOffset; i < tableSize; i++) {
+            for (Offset i = lastOffset; i < tableSize; i++) {
 
                 // If we find an existing vertex that matches src, we need to
                 // combine the weights to avoid duplicate entries for src.
@@ -363,11 +434,11 @@ private:
                 _sizes.resize(dst+1);
             }
             // Initialize the new stencil's meta-data (offset, size).
-            _indices[dst] = static_cast<int>(_sources.size());
+            _indices[dst] = static_cast<Offset>(_sources.size());
             _sizes[dst] = 0;
             // Keep track of where the current stencil begins, which lets us
             // avoid having to look it up later.
-            _lastOffset = static_cast<int>(_sources.size());
+            _lastOffset = static_cast<Offset>(_sources.size());
         }
         // Cache the number of elements as an optimization, it's faster than
         // calling size() on any of the vectors.
@@ -399,12 +470,12 @@ private:
     std::vector<REAL> _dvvWeights;
 
     // Index data used to recover stencil-to-vertex mapping.
-    std::vector<int> _indices;
+    std::vector<Offset> _indices;
     std::vector<int> _sizes;
 
     // Acceleration members to avoid pointer chasing and reverse loops.
-    int _size;
-    int _lastOffset;
+    Offset _size;
+    Offset _lastOffset;
     int _coarseVertCount;
     bool _compactWeights;
 };
@@ -451,7 +522,7 @@ StencilBuilder<REAL>::SetCoarseVertCount(int numVerts)
 }
 
 template <typename REAL>
-std::vector<int> const&
+std::vector<Offset> const&
 StencilBuilder<REAL>::GetStencilOffsets() const {
     return _weightTable->GetOffsets();
 }
@@ -504,6 +575,116 @@ StencilBuilder<REAL>::GetStencilDvvWeights() const {
     return _weightTable->GetDvvWeights();
 }
 
+template <typename REAL>
+void
+StencilBuilder<REAL>::AddStencils(StencilBatch<REAL> const & batch,
+                                  int numThreads)
+{
+    int numStencils = (int)batch.dests.size();
+    if (numStencils == 0) return;
+
+    std::vector<int> offsets(numStencils+1);
+    offsets[0] = 0;
+    for (int i = 0; i < numStencils; ++i) {
+        offsets[i+1] = offsets[i] + batch.sizes[i];
+    }
+
+    // Recorded stencils may refer to earlier stencils of the same batch (e.g.
+    // the face-vertices of a level contributing to its edge-vertices and
+    // vertex-vertices), so the batch is split into consecutive segments of
+    // independent stencils, each appended before the next is factorized.
+    int minDest = *std::min_element(batch.dests.begin(), batch.dests.end());
+    int maxDest = *std::max_element(batch.dests.begin(), batch.dests.end());
+
+    std::vector<int> destSegment(maxDest - minDest + 1, -1);
+
+    int segment = 0;
+    int segmentBegin = 0;
+    for (int i = 0; i <= numStencils; ++i) {
+        bool endOfSegment = (i == numStencils);
+        for (int j = offsets[i]; !endOfSegment && (j < offsets[i+1]); ++j) {
+            int src = batch.sources[j] - minDest;
+            endOfSegment = (src >= 0) && (src < (int)destSegment.size()) &&
+                           (destSegment[src] == segment);
+        }
+        if (endOfSegment) {
+            addStencils(batch, offsets, segmentBegin, i, numThreads);
+            segmentBegin = i;
+            ++segment;
+        }
+        if (i < numStencils) {
+            destSegment[batch.dests[i] - minDest] = segment;
+        }
+    }
+}
+
+template <typename REAL>
+void
+StencilBuilder<REAL>::addStencils(StencilBatch<REAL> const & batch,
+                                  std::vector<int> const & offsets,
+                                  int begin, int end, int numThreads)
+{
+    int numChunks = std::min(numThreads, end - begin);
+
+    if (numChunks <= 1) {
+        for (int i = begin; i < end; ++i) {
+            for (int j = offsets[i]; j < offsets[i+1]; ++j) {
+                _weightTable->AddWithWeight(batch.sources[j], batch.dests[i],
+                    batch.weights[j], _weightTable->GetScalarAccumulator());
+            }
+        }
+        return;
+    }
+
+    // Each chunk of consecutive stencils is factorized into its own table,
+    // resolving sources from the (unmodified) builder table, and the chunk
+    // tables are then appended in order:
+    std::vector<WeightTable<REAL>*> chunkTables(numChunks);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for num_threads(numChunks)
+#endif
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
+        int chunkBegin = begin + (int)((long)(end - begin) * chunk / numChunks);
+        int chunkEnd = begin + (int)((long)(end - begin) * (chunk+1) / numChunks);
+
+        WeightTable<REAL> * table = new WeightTable<REAL>(*_weightTable,
+            offsets[chunkEnd] - offsets[chunkBegin]);
+
+        for (int i = chunkBegin; i < chunkEnd; ++i) {
+            for (int j = offsets[i]; j < offsets[i+1]; ++j) {
+                table->AddWithWeight(*_weightTable, batch.sources[j],
+                                     i - chunkBegin, batch.weights[j]);
+            }
+        }
+        chunkTables[chunk] = table;
+    }
+
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
+        int chunkBegin = begin + (int)((long)(end - begin) * chunk / numChunks);
+
+        _weightTable->Append(*chunkTables[chunk], &batch.dests[chunkBegin]);
+        delete chunkTables[chunk];
+    }
+}
+
+template <typename REAL>
+void
+StencilBatch<REAL>::Index::AddWithWeight(Index const & src, REAL weight)
+{
+    // Ignore no-op weights.
+    if (isWeightZero(weight)) {
+        return;
+    }
+    if (_owner->dests.empty() || (_owner->dests.back() != _index)) {
+        _owner->dests.push_back(_index);
+        _owner->sizes.push_back(0);
+    }
+    ++_owner->sizes.back();
+    _owner->sources.push_back(src._index);
+    _owner->weights.push_back(weight);
+}
+
 template <typename REAL>
 void
 StencilBuilder<REAL>::Index::AddWithWeight(Index const & src, REAL weight)
@@ -598,7 +779,9 @@ StencilBuilder<REAL>::Index::AddWithWeight(StencilReal<REAL> const& src,
 }
 
 template class StencilBuilder<float>;
+template class StencilBatch<float>;
 template class StencilBuilder<double>;
+template class StencilBatch<double>;
 
 } // end namespace internal
 } // end namespace Far
@@ -37,6 +37,7 @@ namespace Far {
 namespace internal {
 
 template <typename REAL> class WeightTable;
+template <typename REAL> class StencilBatch;
 
 template <typename REAL>
 class StencilBuilder {
@@ -55,7 +56,7 @@ public:
     void SetCoarseVertCount(int numVerts);
 
     // Mapping from stencil[i] to its starting offset in the sources[] and weights[] arrays;
-    std::vector<int> const& GetStencilOffsets() const;
+    std::vector<Offset> const& GetStencilOffsets() const;
 
     // The number of contributing sources and weights in stencil[i]
     std::vector<int> const& GetStencilSizes() const;
@@ -71,6 +72,11 @@ public:
     std::vector<REAL> const& GetStencilDuvWeights() const;
     std::vector<REAL> const& GetStencilDvvWeights() const;
 
+    // Factorize and append a batch of recorded stencils, using up to
+    // numThreads threads. The result is identical to adding the stencils
+    // of the batch one by one in the order they were recorded.
+    void AddStencils(StencilBatch<REAL> const & batch, int numThreads);
+
     // Vertex Facade.
     class Index {
     public:
@@ -104,9 +110,51 @@ public:
     };
 
 private:
+    void addStencils(StencilBatch<REAL> const & batch,
+                     std::vector<int> const & offsets,
+                     int begin, int end, int numThreads);
+
     WeightTable<REAL>* _weightTable;
 };
 
+// Unfactorized stencils, recorded through the same vertex facade as the
+// StencilBuilder, for deferred (and possibly concurrent) factorization
+// with StencilBuilder::AddStencils().
+template <typename REAL>
+class StencilBatch {
+public:
+    // Vertex Facade.
+    class Index {
+    public:
+        Index(StencilBatch* owner, int index)
+            : _owner(owner)
+            , _index(index)
+        {}
+
+        // Add with point/vertex weight only.
+        void AddWithWeight(Index const & src, REAL weight);
+
+        Index operator[](int index) const {
+            return Index(_owner, index+_index);
+        }
+
+        int GetOffset() const { return _index; }
+
+        void Clear() {/*nothing to do here*/}
+    private:
+        StencilBatch* _owner;
+        int _index;
+    };
+
+    // Destination vertex and number of sources for each recorded stencil
+    std::vector<int> dests;
+    std::vector<int> sizes;
+
+    // The sources and weights of all recorded stencils, in order.
+    std::vector<int> sources;
+    std::vector<REAL> weights;
+};
+
 } // end namespace internal
 } // end namespace Far
 } // end namespace OPENSUBDIV_VERSION
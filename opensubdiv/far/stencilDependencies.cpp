@@ -0,0 +1,116 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/stencilDependencies.h"
+
+#include <algorithm>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+template <typename REAL>
+StencilDependencies::StencilDependencies(
+    StencilTableReal<REAL> const & stencilTable) {
+
+    _numControlVertices = stencilTable.GetNumControlVertices();
+
+    int numStencils = stencilTable.GetNumStencils();
+
+    std::vector<int> const & sizes = stencilTable.GetSizes();
+    std::vector<Index> const & indices = stencilTable.GetControlIndices();
+
+    //  Count the stencils referring to each vertex, then distribute them:
+    int numVertices = _numControlVertices + numStencils;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        numVertices = std::max(numVertices, indices[i] + 1);
+    }
+
+    _offsets.assign(numVertices + 1, 0);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        ++_offsets[indices[i] + 1];
+    }
+    for (int i = 0; i < numVertices; ++i) {
+        _offsets[i + 1] += _offsets[i];
+    }
+
+    _stencils.resize(_offsets[numVertices]);
+    std::vector<Index> counts(_offsets.begin(), _offsets.end() - 1);
+    //  The offsets of the stencils are not required to be generated:
+    Index const * stencilIndices = indices.empty() ? 0 : &indices[0];
+    for (int i = 0; i < numStencils; ++i) {
+        for (int j = 0; j < sizes[i]; ++j) {
+            _stencils[counts[stencilIndices[j]]++] = i;
+        }
+        stencilIndices += sizes[i];
+    }
+}
+
+void
+StencilDependencies::FindDependentStencils(Index const vertices[],
+    int numVertices, std::vector<Index> & stencils) const {
+
+    stencils.clear();
+
+    int numStencils = GetNumVertices() - _numControlVertices;
+
+    //  Visit the stencils referring to the given vertices and to the
+    //  vertices refined by the stencils visited:
+    std::vector<bool> visited(numStencils, false);
+
+    std::vector<Index> queue;
+    for (int i = 0; i < numVertices; ++i) {
+        if ((vertices[i] >= 0) && (vertices[i] < GetNumVertices())) {
+            queue.push_back(vertices[i]);
+        }
+    }
+    while (! queue.empty()) {
+        Index vertex = queue.back();
+        queue.pop_back();
+
+        ConstIndexArray vertexStencils = GetVertexStencils(vertex);
+        for (int i = 0; i < vertexStencils.size(); ++i) {
+            Index stencil = vertexStencils[i];
+            if (! visited[stencil]) {
+                visited[stencil] = true;
+                stencils.push_back(stencil);
+                if (_numControlVertices + stencil < GetNumVertices()) {
+                    queue.push_back(_numControlVertices + stencil);
+                }
+            }
+        }
+    }
+    std::sort(stencils.begin(), stencils.end());
+}
+
+template StencilDependencies::StencilDependencies(
+    StencilTableReal<float> const & stencilTable);
+template StencilDependencies::StencilDependencies(
+    StencilTableReal<double> const & stencilTable);
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
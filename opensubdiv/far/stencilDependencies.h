@@ -0,0 +1,105 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+#ifndef OPENSUBDIV3_FAR_STENCIL_DEPENDENCIES_H
+#define OPENSUBDIV3_FAR_STENCIL_DEPENDENCIES_H
+
+#include "../version.h"
+
+#include "../far/stencilTable.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief Reverse index of a StencilTable from the vertices to the stencils
+///        referring to them
+///
+/// The vertices of a table are its control vertices followed by the
+/// vertices its stencils refine, i.e. stencil i refines vertex
+/// GetNumControlVertices() + i.  Stencils of tables whose intermediate
+/// levels are not factorized also refer to the refined vertices of other
+/// stencils, whose dependents are then followed as well:
+///
+///     Far::StencilDependencies dependencies(*stencilTable);
+///     ...
+///     // the sculpting tool moved some control vertices
+///     dependencies.FindDependentStencils(&moved[0], (int)moved.size(),
+///                                        stencils);
+///     evaluator->EvalStencils(..., &stencils[0], (int)stencils.size());
+///
+/// The refined vertices of the dependent stencils also identify the patches
+/// whose points need to be re-evaluated.
+///
+class StencilDependencies {
+public:
+
+    /// \brief Builds the reverse index of a stencil table
+    template <typename REAL>
+    StencilDependencies(StencilTableReal<REAL> const & stencilTable);
+
+    /// \brief Returns the number of control vertices of the table
+    int GetNumControlVertices() const { return _numControlVertices; }
+
+    /// \brief Returns the number of vertices of the table, i.e. the control
+    ///        vertices followed by those refined by the stencils
+    int GetNumVertices() const { return (int)_offsets.size() - 1; }
+
+    /// \brief Returns the stencils referring directly to a vertex
+    ConstIndexArray GetVertexStencils(Index vertex) const {
+        return ConstIndexArray(_stencils.empty() ? 0 :
+                               &_stencils[0] + _offsets[vertex],
+                               _offsets[vertex + 1] - _offsets[vertex]);
+    }
+
+    /// \brief Returns the sorted indices of all the stencils depending
+    ///        directly or through other stencils on the given vertices
+    ///
+    /// @param vertices      vertices of the table (typically control
+    ///                      vertices)
+    ///
+    /// @param numVertices   number of vertices
+    ///
+    /// @param stencils      returns the indices of the dependent stencils
+    ///
+    void FindDependentStencils(Index const vertices[], int numVertices,
+                               std::vector<Index> & stencils) const;
+
+private:
+    int _numControlVertices;
+
+    std::vector<Index> _offsets;   // vertex -> first of _stencils
+    std::vector<Index> _stencils;  // stencils referring to each vertex
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_FAR_STENCIL_DEPENDENCIES_H
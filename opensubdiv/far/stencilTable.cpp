@@ -24,6 +24,7 @@
 
 #include "../version.h"
 #include "../far/stencilTable.h"
+#include "../vtr/binaryStream.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -37,8 +38,8 @@ namespace {
     copyStencilData(int numControlVerts,
                     bool includeCoarseVerts,
                     size_t firstOffset,
-                    std::vector<int> const*   offsets,
-                    std::vector<int> *       _offsets,
+                    std::vector<Offset> const* offsets,
+                    std::vector<Offset> *     _offsets,
                     std::vector<int> const*   sizes,
                     std::vector<int> *       _sizes,
                     std::vector<int> const*   sources,
@@ -74,7 +75,7 @@ namespace {
 
         // The stencils are probably not in order, so we must copy/sort them.
         // Note here that loop index 'i' represents stencil_i for vertex_i.
-        int curOffset = 0;
+        Offset curOffset = 0;
 
         size_t stencilCount = 0,
                weightCount = 0;
@@ -87,7 +88,7 @@ namespace {
 
             // Copy the stencil.
             int sz = (*sizes)[i];
-            int off = (*offsets)[i];
+            Offset off = (*offsets)[i];
 
             (*_offsets)[stencilCount] = curOffset;
             (*_sizes)[stencilCount] = sz;
@@ -144,7 +145,7 @@ namespace {
 
 template <typename REAL>
 StencilTableReal<REAL>::StencilTableReal(int numControlVerts,
-                           std::vector<int> const& offsets,
+                           std::vector<Offset> const& offsets,
                            std::vector<int> const& sizes,
                            std::vector<int> const& sources,
                            std::vector<REAL> const& weights,
@@ -170,10 +171,50 @@ StencilTableReal<REAL>::Clear() {
     _weights.clear();
 }
 
+template <typename REAL>
+size_t
+StencilTableReal<REAL>::GetMemoryUsage() const {
+    return sizeof(*this) +
+           _sizes.capacity()   * sizeof(int) +
+           _offsets.capacity() * sizeof(Offset) +
+           _indices.capacity() * sizeof(Index) +
+           _weights.capacity() * sizeof(REAL);
+}
+
+template <typename REAL>
+void
+StencilTableReal<REAL>::write(Vtr::internal::BinaryWriter & stream) const {
+    stream.write(_numControlVertices);
+    stream.writeVector(_sizes);
+    stream.writeVector(_offsets);
+    stream.writeVector(_indices);
+    stream.writeVector(_weights);
+}
+
+template <typename REAL>
+bool
+StencilTableReal<REAL>::read(Vtr::internal::BinaryReader & stream) {
+    stream.read(_numControlVertices);
+    stream.readVector(_sizes);
+    stream.readVector(_offsets);
+    stream.readVector(_indices);
+    stream.readVector(_weights);
+
+    //  Offsets are optional but the indices and weights must cover the sizes
+    //  (factories do not always trim the weights to the indices):
+    size_t numElements = 0;
+    for (size_t i = 0; i < _sizes.size(); ++i) {
+        numElements += _sizes[i];
+    }
+    return stream.isValid() && (_indices.size() >= numElements) &&
+           (_weights.size() >= numElements) &&
+           (_offsets.empty() || (_offsets.size() == _sizes.size()));
+}
+
 template <typename REAL>
 LimitStencilTableReal<REAL>::LimitStencilTableReal(
                                      int numControlVerts,
-                                     std::vector<int> const& offsets,
+                                     std::vector<Offset> const& offsets,
                                      std::vector<int> const& sizes,
                                      std::vector<int> const& sources,
                                      std::vector<REAL> const& weights,
@@ -210,6 +251,16 @@ LimitStencilTableReal<REAL>::Clear() {
     _dvvWeights.clear();
 }
 
+template <typename REAL>
+size_t
+LimitStencilTableReal<REAL>::GetMemoryUsage() const {
+    return StencilTableReal<REAL>::GetMemoryUsage() +
+           sizeof(*this) - sizeof(StencilTableReal<REAL>) +
+           (_duWeights.capacity()  + _dvWeights.capacity() +
+            _duuWeights.capacity() + _duvWeights.capacity() +
+            _dvvWeights.capacity()) * sizeof(REAL);
+}
+
 
 //
 //  Explicit instantiation for float and double:
@@ -28,6 +28,7 @@
 #include "../version.h"
 
 #include "../far/types.h"
+#include "../far/memory.h"
 
 #include <cassert>
 #include <cstring>
@@ -37,13 +38,21 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+namespace Vtr { namespace internal {
+    class BinaryWriter;
+    class BinaryReader;
+} }
+
 namespace Far {
 
 //  Forward declarations for friends:
+class PatchTable;
 class PatchTableBuilder;
+class MeshBatchFactory;
 
 template <typename REAL> class StencilTableFactoryReal;
 template <typename REAL> class LimitStencilTableFactoryReal;
+template <typename REAL> class StencilTableSerializerReal;
 
 /// \brief Vertex stencil descriptor
 ///
@@ -141,7 +150,7 @@ template <typename REAL>
 class StencilTableReal {
 protected:
     StencilTableReal(int numControlVerts,
-                    std::vector<int> const& offsets,
+                    std::vector<Offset> const& offsets,
                     std::vector<int> const& sizes,
                     std::vector<int> const& sources,
                     std::vector<REAL> const& weights,
@@ -171,7 +180,7 @@ public:
     }
 
     /// \brief Returns the offset to a given stencil (factory may leave empty)
-    std::vector<Index> const & GetOffsets() const {
+    std::vector<Offset> const & GetOffsets() const {
         return _offsets;
     }
 
@@ -226,6 +235,9 @@ public:
     /// \brief Clears the stencils from the table
     void Clear();
 
+    /// \brief Returns the number of bytes allocated by the table
+    virtual size_t GetMemoryUsage() const;
+
 protected:
 
     // Update values by applying cached stencil weights to new control values
@@ -240,10 +252,10 @@ protected:
     void generateOffsets();
 
     // Resize the table arrays (factory helper)
-    void resize(int nstencils, int nelems);
+    void resize(int nstencils, Offset nelems);
 
     // Reserves the table arrays (factory helper)
-    void reserve(int nstencils, int nelems);
+    void reserve(int nstencils, Offset nelems);
 
     // Reallocates the table arrays to remove excess capacity (factory helper)
     void shrinkToFit();
@@ -251,6 +263,17 @@ protected:
     // Performs any final operations on internal tables (factory helper)
     void finalize();
 
+    // Reports the memory of a completed table (factory and serializer helper)
+    void updateMemoryStats() {
+        if (internal::MemoryStats::IsReporting()) {
+            _memoryStats.Update(MEMORY_STENCIL_TABLE, this, GetMemoryUsage());
+        }
+    }
+
+    // Writes/reads the table to/from a flat binary buffer (serializer helpers)
+    void write(Vtr::internal::BinaryWriter & stream) const;
+    bool read(Vtr::internal::BinaryReader & stream);
+
 protected:
     StencilTableReal() : _numControlVertices(0) {}
     StencilTableReal(int numControlVerts)
@@ -258,14 +281,19 @@ protected:
     { }
 
     friend class StencilTableFactoryReal<REAL>;
+    friend class StencilTableSerializerReal<REAL>;
+    friend class Far::PatchTable;
     friend class Far::PatchTableBuilder;
+    friend class Far::MeshBatchFactory;
 
     int _numControlVertices;              // number of control vertices
 
     std::vector<int>           _sizes;    // number of coefficients for each stencil
-    std::vector<Index>         _offsets,  // offset to the start of each stencil
-                               _indices;  // indices of contributing coarse vertices
+    std::vector<Offset>        _offsets;  // offset to the start of each stencil
+    std::vector<Index>         _indices;  // indices of contributing coarse vertices
     std::vector<REAL>         _weights;  // stencil weight coefficients
+
+    internal::MemoryStats      _memoryStats; // memory reported to the client
 };
 
 /// \brief Stencil table class wrapping the template for compatibility.
@@ -286,7 +314,7 @@ protected:
     StencilTable() : BaseTable() { }
     StencilTable(int numControlVerts) : BaseTable(numControlVerts) { }
     StencilTable(int numControlVerts,
-                 std::vector<int> const& offsets,
+                 std::vector<Offset> const& offsets,
                  std::vector<int> const& sizes,
                  std::vector<int> const& sources,
                  std::vector<float> const& weights,
@@ -410,7 +438,7 @@ class LimitStencilTableReal : public StencilTableReal<REAL> {
 protected:
     LimitStencilTableReal(
                     int numControlVerts,
-                    std::vector<int> const& offsets,
+                    std::vector<Offset> const& offsets,
                     std::vector<int> const& sizes,
                     std::vector<int> const& sources,
                     std::vector<REAL> const& weights,
@@ -422,6 +450,9 @@ protected:
                     bool includeCoarseVerts,
                     size_t firstOffset);
 
+    LimitStencilTableReal(int numControlVerts)
+        : StencilTableReal<REAL>(numControlVerts) { }
+
 public:
 
     /// \brief Returns a LimitStencil at index i in the table
@@ -564,11 +595,14 @@ public:
     /// \brief Clears the stencils from the table
     void Clear();
 
+    /// \brief Returns the number of bytes allocated by the table
+    virtual size_t GetMemoryUsage() const;
+
 private:
     friend class LimitStencilTableFactoryReal<REAL>;
 
     // Resize the table arrays (factory helper)
-    void resize(int nstencils, int nelems);
+    void resize(int nstencils, Offset nelems);
 
 private:
     std::vector<REAL>   _duWeights,   // u  derivative limit stencil weights
@@ -594,7 +628,7 @@ public:
 
 protected:
     LimitStencilTable(int numControlVerts,
-                    std::vector<int> const& offsets,
+                    std::vector<Offset> const& offsets,
                     std::vector<int> const& sizes,
                     std::vector<int> const& sources,
                     std::vector<float> const& weights,
@@ -676,7 +710,7 @@ StencilTableReal<REAL>::update(T const &srcValues, U &dstValues,
 template <typename REAL>
 inline void
 StencilTableReal<REAL>::generateOffsets() {
-    Index offset=0;
+    Offset offset=0;
     int noffsets = (int)_sizes.size();
     _offsets.resize(noffsets);
     for (int i=0; i<(int)_sizes.size(); ++i ) {
@@ -687,7 +721,7 @@ StencilTableReal<REAL>::generateOffsets() {
 
 template <typename REAL>
 inline void
-StencilTableReal<REAL>::resize(int nstencils, int nelems) {
+StencilTableReal<REAL>::resize(int nstencils, Offset nelems) {
     _sizes.resize(nstencils);
     _indices.resize(nelems);
     _weights.resize(nelems);
@@ -695,7 +729,7 @@ StencilTableReal<REAL>::resize(int nstencils, int nelems) {
 
 template <typename REAL>
 inline void
-StencilTableReal<REAL>::reserve(int nstencils, int nelems) {
+StencilTableReal<REAL>::reserve(int nstencils, Offset nelems) {
     _sizes.reserve(nstencils);
     _indices.reserve(nelems);
     _weights.reserve(nelems);
@@ -722,7 +756,7 @@ inline StencilReal<REAL>
 StencilTableReal<REAL>::GetStencil(Index i) const {
     assert((! _offsets.empty()) && i<(int)_offsets.size());
 
-    Index ofs = _offsets[i];
+    Offset ofs = _offsets[i];
 
     return StencilReal<REAL>(const_cast<int*>(&_sizes[i]),
                              const_cast<Index*>(&_indices[ofs]),
@@ -737,7 +771,7 @@ StencilTableReal<REAL>::operator[] (Index index) const {
 
 template <typename REAL>
 inline void
-LimitStencilTableReal<REAL>::resize(int nstencils, int nelems) {
+LimitStencilTableReal<REAL>::resize(int nstencils, Offset nelems) {
     StencilTableReal<REAL>::resize(nstencils, nelems);
     _duWeights.resize(nelems);
     _dvWeights.resize(nelems);
@@ -749,7 +783,7 @@ inline LimitStencilReal<REAL>
 LimitStencilTableReal<REAL>::GetLimitStencil(Index i) const {
     assert((! this->GetOffsets().empty()) && i<(int)this->GetOffsets().size());
 
-    Index ofs = this->GetOffsets()[i];
+    Offset ofs = this->GetOffsets()[i];
 
     if (!_duWeights.empty() && !_dvWeights.empty() &&
         !_duuWeights.empty() && !_duvWeights.empty() && !_dvvWeights.empty()) {
@@ -23,14 +23,19 @@
 //
 
 #include "../far/stencilTableFactory.h"
+#include "../far/buildMonitor.h"
 #include "../far/stencilBuilder.h"
 #include "../far/patchTable.h"
 #include "../far/patchTableFactory.h"
 #include "../far/patchMap.h"
 #include "../far/topologyRefiner.h"
 #include "../far/primvarRefiner.h"
+#include "../far/sparseMatrix.h"
+#include "../far/hierarchicalEdits.h"
+#include "../far/trace.h"
 
 #include <cassert>
+#include <cstring>
 #include <algorithm>
 #include <iostream>
 
@@ -53,6 +58,526 @@ namespace {
 #ifdef __INTEL_COMPILER
 #pragma warning (pop)
 #endif
+
+    template <class T>
+    void
+    interpolateLevel(PrimvarRefiner const & primvarRefiner,
+                     int interpolationMode, int fvarChannel,
+                     int level, T const & src, T & dst) {
+
+        if (interpolationMode == StencilTableFactory::INTERPOLATE_VERTEX) {
+            primvarRefiner.Interpolate(level, src, dst);
+        } else if (interpolationMode == StencilTableFactory::INTERPOLATE_VARYING) {
+            primvarRefiner.InterpolateVarying(level, src, dst);
+        } else {
+            primvarRefiner.InterpolateFaceVarying(level, src, dst, fvarChannel);
+        }
+    }
+
+    //
+    //  The vertex edits of a level -- for each vertex of the level the first
+    //  edit applied (or -1) and whether its interpolated value is replaced,
+    //  and for each edit the next edit of the same vertex:
+    //
+    struct LevelVertexEdits {
+        std::vector<int>  firstEdit;
+        std::vector<char> isReplaced;
+        std::vector<int>  nextEdit;
+    };
+
+    //
+    //  Identifies the vertex edits of a level of the refiner, returning false
+    //  if there are none:
+    //
+    bool
+    findLevelVertexEdits(TopologyRefiner const & refiner,
+                         HierarchicalEdits const & edits, int level,
+                         LevelVertexEdits & levelEdits) {
+
+        levelEdits.firstEdit.clear();
+        levelEdits.isReplaced.clear();
+        levelEdits.nextEdit.clear();
+
+        int numEdits = edits.GetNumVertexEdits();
+        for (int e = 0; e < numEdits; ++e) {
+            if (edits.GetVertexEditLevel(e) != level) continue;
+
+            Index vertex = edits.FindVertexEditVertex(refiner, e);
+            if (!Vtr::IndexIsValid(vertex)) continue;
+
+            if (levelEdits.firstEdit.empty()) {
+                int numVertices = refiner.GetLevel(level).GetNumVertices();
+
+                levelEdits.firstEdit.resize(numVertices, -1);
+                levelEdits.isReplaced.resize(numVertices, false);
+                levelEdits.nextEdit.resize(numEdits, -1);
+            }
+
+            //  A replacement discards the edits preceding it, others are
+            //  appended to the list of edits of the vertex to preserve order:
+            if (edits.GetVertexEditOperation(e) == HierarchicalEdits::OPERATION_SET) {
+                levelEdits.firstEdit[vertex]  = e;
+                levelEdits.isReplaced[vertex] = true;
+            } else {
+                int * last = &levelEdits.firstEdit[vertex];
+                while (*last >= 0) {
+                    last = &levelEdits.nextEdit[*last];
+                }
+                *last = e;
+            }
+        }
+        return !levelEdits.firstEdit.empty();
+    }
+
+    //
+    //  Appends the stencil recorded for a vertex of a level with the given
+    //  weight, expanding its references to edited vertices of the same level
+    //  into their recorded (i.e. unedited) stencils:
+    //
+    template <typename REAL>
+    void
+    appendUneditedStencil(internal::StencilBatch<REAL> const & batch,
+                          std::vector<int> const & batchOffsets,
+                          std::vector<int> const & vertexStencils,
+                          LevelVertexEdits const & levelEdits,
+                          int levelOffset, int stencil, REAL weight,
+                          internal::StencilBatch<REAL> & result) {
+
+        int numVertices = (int)vertexStencils.size();
+
+        for (int j = batchOffsets[stencil]; j < batchOffsets[stencil+1]; ++j) {
+            int vertex = batch.sources[j] - levelOffset;
+            if ((vertex >= 0) && (vertex < numVertices) &&
+                    (levelEdits.firstEdit[vertex] >= 0) &&
+                    (vertexStencils[vertex] >= 0)) {
+                appendUneditedStencil(batch, batchOffsets, vertexStencils,
+                    levelEdits, levelOffset, vertexStencils[vertex],
+                    weight * batch.weights[j], result);
+            } else {
+                result.sources.push_back(batch.sources[j]);
+                result.weights.push_back(weight * batch.weights[j]);
+            }
+        }
+    }
+
+    //
+    //  Applies the vertex edits of a level to the stencils recorded for the
+    //  whole level:  the values of the edits are added to (or replace) the
+    //  stencils of their edited vertices, while the other vertices of the
+    //  level still refer to the interpolated values -- as with Hbr, e.g. the
+    //  edge-vertices of a Catmark level are computed from its unedited
+    //  face-vertices:
+    //
+    template <typename REAL>
+    void
+    applyLevelVertexEdits(LevelVertexEdits const & levelEdits,
+                          int levelOffset, int editOffset,
+                          internal::StencilBatch<REAL> & batch) {
+
+        int numStencils = (int)batch.dests.size();
+        int numVertices = (int)levelEdits.firstEdit.size();
+
+        std::vector<int> batchOffsets(numStencils + 1, 0);
+        std::vector<int> vertexStencils(numVertices, -1);
+        for (int i = 0; i < numStencils; ++i) {
+            batchOffsets[i+1] = batchOffsets[i] + batch.sizes[i];
+
+            int vertex = batch.dests[i] - levelOffset;
+            if ((vertex >= 0) && (vertex < numVertices)) {
+                vertexStencils[vertex] = i;
+            }
+        }
+
+        internal::StencilBatch<REAL> result;
+        result.dests.reserve(numStencils);
+        result.sizes.reserve(numStencils);
+        result.sources.reserve(batch.sources.size());
+        result.weights.reserve(batch.weights.size());
+
+        for (int i = 0; i < numStencils; ++i) {
+            int vertex = batch.dests[i] - levelOffset;
+            bool isEdited = (vertex >= 0) && (vertex < numVertices) &&
+                            (levelEdits.firstEdit[vertex] >= 0);
+
+            int size = (int)result.sources.size();
+            if (!isEdited || !levelEdits.isReplaced[vertex]) {
+                appendUneditedStencil(batch, batchOffsets, vertexStencils,
+                    levelEdits, levelOffset, i, (REAL) 1.0, result);
+            }
+            if (isEdited) {
+                for (int e = levelEdits.firstEdit[vertex]; e >= 0;
+                         e = levelEdits.nextEdit[e]) {
+                    result.sources.push_back(editOffset + e);
+                    result.weights.push_back((REAL) 1.0);
+                }
+            }
+            size = (int)result.sources.size() - size;
+            if (size > 0) {
+                result.dests.push_back(batch.dests[i]);
+                result.sizes.push_back(size);
+            }
+        }
+
+        //  Edited vertices without interpolated terms have no recorded
+        //  stencil, so their edits are appended:
+        for (int vertex = 0; vertex < numVertices; ++vertex) {
+            if ((levelEdits.firstEdit[vertex] < 0) ||
+                (vertexStencils[vertex] >= 0)) continue;
+
+            int size = 0;
+            for (int e = levelEdits.firstEdit[vertex]; e >= 0;
+                     e = levelEdits.nextEdit[e], ++size) {
+                result.sources.push_back(editOffset + e);
+                result.weights.push_back((REAL) 1.0);
+            }
+            result.dests.push_back(levelOffset + vertex);
+            result.sizes.push_back(size);
+        }
+
+        std::swap(batch.dests, result.dests);
+        std::swap(batch.sizes, result.sizes);
+        std::swap(batch.sources, result.sources);
+        std::swap(batch.weights, result.weights);
+    }
+
+    //
+    //  Factorized stencils for a subset of the vertices of a level, resolved
+    //  through the stencils of the previous level (or directly for the control
+    //  vertices of the base level).  Weights are accumulated in the same order
+    //  as with the StencilBuilder, so that regenerated stencils are identical
+    //  to those of a newly created table:
+    //
+    template <typename REAL>
+    class SparseStencilLevel {
+    public:
+        struct Stencil {
+            std::vector<Index> indices;
+            std::vector<REAL>  weights;
+        };
+
+        class Element {
+        public:
+            Element(SparseStencilLevel * owner, Index index) :
+                _owner(owner), _index(index) { }
+
+            Element operator[](Index index) const {
+                return Element(_owner, index);
+            }
+
+            void Clear() {
+                Stencil & dst = _owner->getStencil(_index);
+                dst.indices.clear();
+                dst.weights.clear();
+            }
+
+            void AddWithWeight(Element const & src, REAL weight) {
+                if (isWeightZero(weight)) {
+                    return;
+                }
+                Stencil & dst = _owner->getStencil(_index);
+                if (src._owner->_isCoarse) {
+                    merge(dst, src._index, weight);
+                } else {
+                    Stencil const & srcStencil = src._owner->getStencil(src._index);
+                    for (int i = 0; i < (int)srcStencil.indices.size(); ++i) {
+                        merge(dst, srcStencil.indices[i], srcStencil.weights[i] * weight);
+                    }
+                }
+            }
+
+        private:
+            static void merge(Stencil & dst, Index src, REAL weight) {
+                for (int i = 0; i < (int)dst.indices.size(); ++i) {
+                    if (dst.indices[i] == src) {
+                        dst.weights[i] += weight;
+                        return;
+                    }
+                }
+                dst.indices.push_back(src);
+                dst.weights.push_back(weight);
+            }
+
+            SparseStencilLevel * _owner;
+            Index                _index;
+        };
+
+    public:
+        //  A coarse level has no stencils -- its vertices are the control vertices:
+        SparseStencilLevel() : _isCoarse(true) { }
+
+        SparseStencilLevel(std::vector<Index> const & vertices, int numVertices) :
+            _isCoarse(false), _slots(numVertices, -1), _stencils(vertices.size()) {
+
+            for (int i = 0; i < (int)vertices.size(); ++i) {
+                _slots[vertices[i]] = i;
+            }
+        }
+
+        Element GetElement() { return Element(this, 0); }
+
+        Stencil & getStencil(Index vertex) {
+            assert(_slots[vertex] >= 0);
+            return _stencils[_slots[vertex]];
+        }
+
+    private:
+        bool                 _isCoarse;
+        std::vector<int>     _slots;
+        std::vector<Stencil> _stencils;
+    };
+
+    //
+    //  Simple set of component indices of a level, retaining both a list of
+    //  the members and a tag per component to avoid duplicates:
+    //
+    class ComponentSet {
+    public:
+        ComponentSet(int numComponents = 0) : _tags(numComponents, 0) { }
+
+        void Add(Index index) {
+            if (Vtr::IndexIsValid(index) && !_tags[index]) {
+                _tags[index] = 1;
+                _members.push_back(index);
+            }
+        }
+        bool Contains(Index index) const { return _tags[index] != 0; }
+
+        std::vector<Index> const & GetMembers() const { return _members; }
+        std::vector<Index> GetSortedMembers() const {
+            std::vector<Index> members(_members);
+            std::sort(members.begin(), members.end());
+            return members;
+        }
+
+    private:
+        std::vector<char>  _tags;
+        std::vector<Index> _members;
+    };
+
+    //
+    //  Factorized stencils composed by sparse matrix products:  the stencils
+    //  of a level recorded in a StencilBatch are the rows of its subdivision
+    //  matrix S, whose columns are the vertices of the previous levels, and
+    //  the factorized stencils of the level are the rows of the product S * P,
+    //  where P holds the (factorized) stencils of all previous vertices, the
+    //  control vertices being rows of the identity.
+    //
+    //  The product is computed row by row (Gustavson's algorithm) with a dense
+    //  accumulator per thread over the control vertices, so each row costs
+    //  time proportional to its terms rather than the quadratic merging of
+    //  the StencilBuilder.  Columns are kept in the order they first appear
+    //  and each is summed in the order of the terms, so the stencils are
+    //  identical to those of the StencilBuilder.
+    //
+    template <typename REAL>
+    class StencilProduct {
+    public:
+        StencilProduct(int numControlVertices) :
+            _numControlVertices(numControlVertices),
+            _offsets(numControlVertices), _sizes(numControlVertices, 1),
+            _sources(numControlVertices), _weights(numControlVertices, 1) {
+
+            for (int i = 0; i < numControlVertices; ++i) {
+                _offsets[i] = i;
+                _sources[i] = i;
+            }
+        }
+
+        //  Appends the products of the rows of a level:
+        void AddLevel(internal::StencilBatch<REAL> const & batch,
+                      int numThreads);
+
+        std::vector<Offset> const & GetOffsets() const { return _offsets; }
+        std::vector<int> const &    GetSizes() const   { return _sizes; }
+        std::vector<int> const &    GetSources() const { return _sources; }
+        std::vector<REAL> const &   GetWeights() const { return _weights; }
+
+    private:
+        //  Dense accumulator of a thread -- the position of each control
+        //  vertex in the current row, or -1:
+        struct Accumulator {
+            std::vector<int> positions;
+        };
+
+        void multiplyRows(internal::StencilBatch<REAL> const & batch,
+                          std::vector<int> const & rowOffsets,
+                          int begin, int end, Accumulator & accumulator,
+                          SparseMatrix<REAL> & product) const;
+
+        void addRows(internal::StencilBatch<REAL> const & batch,
+                     std::vector<int> const & rowOffsets,
+                     int begin, int end, int numThreads);
+
+        int _numControlVertices;
+
+        std::vector<Offset> _offsets;
+        std::vector<int>    _sizes;
+        std::vector<int>    _sources;
+        std::vector<REAL>   _weights;
+
+        std::vector<Accumulator> _accumulators;
+    };
+
+    template <typename REAL>
+    void
+    StencilProduct<REAL>::multiplyRows(
+            internal::StencilBatch<REAL> const & batch,
+            std::vector<int> const & rowOffsets, int begin, int end,
+            Accumulator & accumulator, SparseMatrix<REAL> & product) const {
+
+        std::vector<int> & positions = accumulator.positions;
+        if (positions.empty()) {
+            positions.resize(_numControlVertices, -1);
+        }
+
+        product.Resize(end - begin, _numControlVertices,
+                       (rowOffsets[end] - rowOffsets[begin]) * 4);
+
+        std::vector<int>  columns;
+        std::vector<REAL> elements;
+
+        for (int row = begin; row < end; ++row) {
+            columns.clear();
+            elements.clear();
+
+            for (int i = rowOffsets[row]; i < rowOffsets[row+1]; ++i) {
+                int  src    = batch.sources[i];
+                REAL weight = batch.weights[i];
+
+                //  A control vertex is its own (identity) row of P:
+                int    srcSize  = 1;
+                int    const *  srcSources = &src;
+                REAL   const *  srcWeights = 0;
+                if (src >= _numControlVertices) {
+                    srcSize    = _sizes[src];
+                    srcSources = &_sources[_offsets[src]];
+                    srcWeights = &_weights[_offsets[src]];
+                }
+
+                for (int j = 0; j < srcSize; ++j) {
+                    REAL w = srcWeights ? srcWeights[j] * weight : weight;
+
+                    int & position = positions[srcSources[j]];
+                    if (position < 0) {
+                        position = (int)columns.size();
+                        columns.push_back(srcSources[j]);
+                        elements.push_back(w);
+                    } else {
+                        elements[position] += w;
+                    }
+                }
+            }
+
+            int productRow = row - begin;
+            int rowSize = (int)columns.size();
+
+            product.SetRowSize(productRow, rowSize);
+            Vtr::Array<int>  rowColumns  = product.SetRowColumns(productRow);
+            Vtr::Array<REAL> rowElements = product.SetRowElements(productRow);
+            for (int j = 0; j < rowSize; ++j) {
+                rowColumns[j]  = columns[j];
+                rowElements[j] = elements[j];
+                positions[columns[j]] = -1;
+            }
+        }
+    }
+
+    template <typename REAL>
+    void
+    StencilProduct<REAL>::addRows(internal::StencilBatch<REAL> const & batch,
+            std::vector<int> const & rowOffsets,
+            int begin, int end, int numThreads) {
+
+        //  Each chunk of consecutive rows is multiplied into its own matrix,
+        //  reading only the rows of previous segments, and the chunks are
+        //  then appended in order:
+        int numChunks = std::max(1, std::min(numThreads, end - begin));
+
+        if ((int)_accumulators.size() < numChunks) {
+            _accumulators.resize(numChunks);
+        }
+        std::vector<SparseMatrix<REAL> > products(numChunks);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp parallel for if (numChunks > 1) num_threads(numChunks)
+#endif
+        for (int chunk = 0; chunk < numChunks; ++chunk) {
+            int chunkBegin = begin + (int)((long)(end - begin) * chunk / numChunks);
+            int chunkEnd = begin + (int)((long)(end - begin) * (chunk+1) / numChunks);
+
+            multiplyRows(batch, rowOffsets, chunkBegin, chunkEnd,
+                         _accumulators[chunk], products[chunk]);
+        }
+
+        for (int chunk = 0; chunk < numChunks; ++chunk) {
+            int chunkBegin = begin + (int)((long)(end - begin) * chunk / numChunks);
+
+            SparseMatrix<REAL> const & product = products[chunk];
+
+            Offset offset = (Offset)_sources.size();
+            if (product.GetNumElements() > 0) {
+                Vtr::ConstArray<int>  columns  = product.GetColumns();
+                Vtr::ConstArray<REAL> elements = product.GetElements();
+
+                _sources.insert(_sources.end(), columns.begin(), columns.end());
+                _weights.insert(_weights.end(), elements.begin(), elements.end());
+            }
+
+            for (int row = 0; row < product.GetNumRows(); ++row) {
+                int dst = batch.dests[chunkBegin + row];
+                if (dst >= (int)_sizes.size()) {
+                    _offsets.resize(dst + 1, 0);
+                    _sizes.resize(dst + 1, 0);
+                }
+                _offsets[dst] = offset;
+                _sizes[dst] = product.GetRowSize(row);
+                offset += _sizes[dst];
+            }
+        }
+    }
+
+    template <typename REAL>
+    void
+    StencilProduct<REAL>::AddLevel(internal::StencilBatch<REAL> const & batch,
+                                   int numThreads) {
+
+        int numRows = (int)batch.dests.size();
+        if (numRows == 0) return;
+
+        std::vector<int> rowOffsets(numRows + 1);
+        rowOffsets[0] = 0;
+        for (int i = 0; i < numRows; ++i) {
+            rowOffsets[i+1] = rowOffsets[i] + batch.sizes[i];
+        }
+
+        //  Rows may refer to earlier rows of the same level (e.g. those of
+        //  its face-vertices), so -- as in StencilBuilder::AddStencils() --
+        //  the level is split into consecutive segments of independent rows,
+        //  each appended before the next is multiplied:
+        int minDest = *std::min_element(batch.dests.begin(), batch.dests.end());
+        int maxDest = *std::max_element(batch.dests.begin(), batch.dests.end());
+
+        std::vector<int> destSegment(maxDest - minDest + 1, -1);
+
+        int segment = 0;
+        int segmentBegin = 0;
+        for (int i = 0; i <= numRows; ++i) {
+            bool endOfSegment = (i == numRows);
+            for (int j = rowOffsets[i]; !endOfSegment && (j < rowOffsets[i+1]); ++j) {
+                int src = batch.sources[j] - minDest;
+                endOfSegment = (src >= 0) && (src < (int)destSegment.size()) &&
+                               (destSegment[src] == segment);
+            }
+            if (endOfSegment) {
+                addRows(batch, rowOffsets, segmentBegin, i, numThreads);
+                segmentBegin = i;
+                ++segment;
+            }
+            if (i < numRows) {
+                destSegment[batch.dests[i] - minDest] = segment;
+            }
+        }
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -80,22 +605,57 @@ StencilTableReal<REAL> const *
 StencilTableFactoryReal<REAL>::Create(TopologyRefiner const & refiner,
     Options options) {
 
-    bool interpolateVertex = options.interpolationMode==INTERPOLATE_VERTEX;
-    bool interpolateVarying = options.interpolationMode==INTERPOLATE_VARYING;
+    return create(refiner, 0, options);
+}
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+StencilTableFactoryReal<REAL>::Create(TopologyRefiner const & refiner,
+    HierarchicalEdits const & edits, Options options) {
+
+    return create(refiner, &edits, options);
+}
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+StencilTableFactoryReal<REAL>::create(TopologyRefiner const & refiner,
+    HierarchicalEdits const * edits, Options options) {
+
+    OPENSUBDIV_TRACE_SCOPE("stencils.create");
+
     bool interpolateFaceVarying = options.interpolationMode==INTERPOLATE_FACE_VARYING;
 
     int numControlVertices = !interpolateFaceVarying
         ? refiner.GetLevel(0).GetNumVertices()
         : refiner.GetLevel(0).GetNumFVarValues(options.fvarChannel);
 
+    //  The values of vertex edits are control vertices following those of
+    //  the base level:
+    bool applyVertexEdits = edits && (edits->GetNumVertexEdits() > 0) &&
+                            (options.interpolationMode == INTERPOLATE_VERTEX);
+
+    int numBaseVertices = numControlVertices;
+    if (applyVertexEdits) {
+        numControlVertices += edits->GetNumVertexEdits();
+    }
+
     int maxlevel = std::min(int(options.maxLevel), refiner.GetMaxLevel());
     if (maxlevel==0 && (! options.generateControlVerts)) {
         StencilTableReal<REAL> * result = new StencilTableReal<REAL>;
         result->_numControlVertices = numControlVertices;
+        result->updateMemoryStats();
         return result;
     }
 
-    StencilBuilder<REAL> builder(numControlVertices,
+    //  Stencils of factorized levels without edits may be composed by
+    //  sparse matrix products, leaving the StencilBuilder empty:
+    bool useMatrixProduct = options.factorizeByMatrixProduct &&
+                            options.factorizeIntermediateLevels &&
+                            !applyVertexEdits;
+
+    StencilProduct<REAL> product(useMatrixProduct ? numControlVertices : 0);
+
+    StencilBuilder<REAL> builder(useMatrixProduct ? 0 : numControlVertices,
                                 /*genControlVerts*/ true,
                                 /*compactWeights*/  true);
 
@@ -108,13 +668,63 @@ StencilTableFactoryReal<REAL>::Create(TopologyRefiner const & refiner,
     typename StencilBuilder<REAL>::Index srcIndex(&builder, 0);
     typename StencilBuilder<REAL>::Index dstIndex(&builder, numControlVertices);
 
+    LevelVertexEdits levelEdits;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = options.numThreads;
+#else
+    int numThreads = 1;
+#endif
+
     for (int level=1; level<=maxlevel; ++level) {
-        if (interpolateVertex) {
-            primvarRefiner.Interpolate(level, srcIndex, dstIndex);
-        } else if (interpolateVarying) {
-            primvarRefiner.InterpolateVarying(level, srcIndex, dstIndex);
+        OPENSUBDIV_TRACE_SCOPE_INDEXED("stencils.level", level);
+
+        if (options.monitor && !options.monitor->Progress(
+                BuildMonitor::STAGE_STENCIL_TABLE,
+                (float)(level - 1) / (float)maxlevel)) {
+            return 0;
+        }
+
+        bool levelHasEdits = applyVertexEdits &&
+            findLevelVertexEdits(refiner, *edits, level, levelEdits);
+
+        if (useMatrixProduct) {
+            // Record the subdivision matrix of the level and multiply it by
+            // the stencils of the previous levels:
+            internal::StencilBatch<REAL> batch;
+
+            typedef typename internal::StencilBatch<REAL>::Index BatchIndex;
+
+            BatchIndex batchSrc(&batch, srcIndex.GetOffset()),
+                       batchDst(&batch, dstIndex.GetOffset());
+
+            interpolateLevel(primvarRefiner, options.interpolationMode,
+                options.fvarChannel, level, batchSrc, batchDst);
+
+            product.AddLevel(batch, numThreads);
+        } else if ((numThreads > 1) || levelHasEdits) {
+            // Record the unfactorized stencils of the level and factorize
+            // them concurrently, once the vertex edits of the whole level
+            // have been applied:
+            internal::StencilBatch<REAL> batch;
+
+            typedef typename internal::StencilBatch<REAL>::Index BatchIndex;
+
+            BatchIndex batchSrc(&batch, srcIndex.GetOffset()),
+                       batchDst(&batch, dstIndex.GetOffset());
+
+            interpolateLevel(primvarRefiner, options.interpolationMode,
+                options.fvarChannel, level, batchSrc, batchDst);
+
+            if (levelHasEdits) {
+                applyLevelVertexEdits(levelEdits, dstIndex.GetOffset(),
+                                      numBaseVertices, batch);
+            }
+
+            builder.AddStencils(batch, numThreads);
         } else {
-            primvarRefiner.InterpolateFaceVarying(level, srcIndex, dstIndex, options.fvarChannel);
+            interpolateLevel(primvarRefiner, options.interpolationMode,
+                options.fvarChannel, level, srcIndex, dstIndex);
         }
 
         if (options.factorizeIntermediateLevels) {
@@ -140,97 +750,534 @@ StencilTableFactoryReal<REAL>::Create(TopologyRefiner const & refiner,
  
     // Copy stencils from the StencilBuilder into the StencilTable.
     // Always initialize numControlVertices (useful for torus case)
-    StencilTableReal<REAL> * result = 
-                        new StencilTableReal<REAL>(numControlVertices,
+    StencilTableReal<REAL> * result = useMatrixProduct
+                      ? new StencilTableReal<REAL>(numControlVertices,
+                                          product.GetOffsets(),
+                                          product.GetSizes(),
+                                          product.GetSources(),
+                                          product.GetWeights(),
+                                          options.generateControlVerts,
+                                          firstOffset)
+                      : new StencilTableReal<REAL>(numControlVertices,
                                           builder.GetStencilOffsets(),
                                           builder.GetStencilSizes(),
                                           builder.GetStencilSources(),
                                           builder.GetStencilWeights(),
                                           options.generateControlVerts,
                                           firstOffset);
+
+    if (options.monitor) {
+        options.monitor->Progress(BuildMonitor::STAGE_STENCIL_TABLE, 1.0f);
+    }
+    result->updateMemoryStats();
     return result;
 }
 
 //------------------------------------------------------------------------------
 
 template <typename REAL>
-StencilTableReal<REAL> const *
-StencilTableFactoryReal<REAL>::Create(int numTables,
-    StencilTableReal<REAL> const ** tables) {
-
-    // XXXtakahito:
-    // This function returns NULL for empty inputs or erroneous condition.
-    // It's convenient for skipping varying stencils etc, however,
-    // other Create() API returns an empty stencil instead of NULL.
-    // They need to be consistent.
+bool
+StencilTableFactoryReal<REAL>::UpdateStencilTable(TopologyRefiner const & refiner,
+    StencilTableReal<REAL> & table, ConstIndexArray edges, ConstIndexArray vertices,
+    Options options) {
 
-    if ( (numTables<=0) || (! tables)) {
-        return NULL;
+    //  Varying weights are independent of sharpness:
+    if (options.interpolationMode == INTERPOLATE_VARYING) {
+        return true;
+    }
+    if (options.interpolationMode == INTERPOLATE_FACE_VARYING) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in StencilTableFactory::UpdateStencilTable() -- "
+            "face-varying stencils are not supported.");
+        return false;
+    }
+    if (!options.factorizeIntermediateLevels) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in StencilTableFactory::UpdateStencilTable() -- "
+            "stencils of intermediate levels must be factorized.");
+        return false;
+    }
+    if (!refiner.IsUniform()) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in StencilTableFactory::UpdateStencilTable() -- "
+            "refinement is adaptive.");
+        return false;
     }
 
-    int ncvs = -1,
-        nstencils = 0,
-        nelems = 0;
+    int numControlVertices = refiner.GetLevel(0).GetNumVertices();
 
-    for (int i=0; i<numTables; ++i) {
+    int maxlevel = std::min(int(options.maxLevel), refiner.GetMaxLevel());
 
-        StencilTableReal<REAL> const * st = tables[i];
-        // allow the tables could have a null entry.
-        if (!st) continue;
+    //
+    //  Identify the location of the stencils of each level in the table:
+    //
+    bool const outputAllLevels = options.generateIntermediateLevels;
 
-        if (ncvs >= 0 && st->GetNumControlVertices() != ncvs) {
-            return NULL;
-        }
-        ncvs = st->GetNumControlVertices();
-        nstencils += st->GetNumStencils();
-        nelems += (int)st->GetControlIndices().size();
-    }
+    std::vector<int> levelOffsets(maxlevel+1, 0);
 
-    if (ncvs == -1) {
-        return NULL;
+    int numStencils = options.generateControlVerts ? numControlVertices : 0;
+    for (int level = outputAllLevels ? 1 : maxlevel; level <= maxlevel; ++level) {
+        levelOffsets[level] = numStencils;
+        numStencils += refiner.GetLevel(level).GetNumVertices();
+    }
+    if ((maxlevel == 0) && !options.generateControlVerts) {
+        numStencils = 0;
+    }
+    if ((table.GetNumStencils() != numStencils) ||
+        (table.GetNumControlVertices() != numControlVertices)) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in StencilTableFactory::UpdateStencilTable() -- "
+            "table does not match the refiner and options.");
+        return false;
+    }
+    if (maxlevel == 0) {
+        return true;
     }
 
-    StencilTableReal<REAL> * result = new StencilTableReal<REAL>;
-    result->resize(nstencils, nelems);
+    //
+    //  Identify the vertices of each level whose stencils are affected -- the
+    //  components whose sharpness or rules may change are tracked from level
+    //  to level (those of the modified components and their children, and
+    //  with the Chaikin rule, of the edges incident their end vertices) with
+    //  the vertices whose masks they affect, and the stencils of vertices are
+    //  affected when their masks or the stencils supporting them are:
+    //
+    bool const isChaikin = (refiner.GetSchemeOptions().GetCreasingMethod() ==
+                            Sdc::Options::CREASE_CHAIKIN);
 
-    int * sizes = &result->_sizes[0];
-    Index * indices = &result->_indices[0];
-    REAL * weights = &result->_weights[0];
-    for (int i=0; i<numTables; ++i) {
-        StencilTableReal<REAL> const * st = tables[i];
-        if (!st) continue;
+    std::vector<std::vector<Index> > affected(maxlevel+1);
 
-        int st_nstencils = st->GetNumStencils(),
-            st_nelems = (int)st->_indices.size();
-        memcpy(sizes, &st->_sizes[0], st_nstencils*sizeof(int));
-        memcpy(indices, &st->_indices[0], st_nelems*sizeof(Index));
-        memcpy(weights, &st->_weights[0], st_nelems*sizeof(REAL));
+    {
+        Vtr::internal::Level const & base = refiner.getLevel(0);
 
-        sizes += st_nstencils;
-        indices += st_nelems;
-        weights += st_nelems;
-    }
+        ComponentSet sharpEdges(base.getNumEdges()),
+                     sharpVerts(base.getNumVertices()),
+                     affectedVerts(base.getNumVertices());
 
-    result->_numControlVertices = ncvs;
+        for (int i = 0; i < edges.size(); ++i) {
+            if ((edges[i] < 0) || (edges[i] >= base.getNumEdges())) continue;
 
-    // have to re-generate offsets from scratch
-    result->generateOffsets();
+            ConstIndexArray eVerts = base.getEdgeVertices(edges[i]);
+            sharpEdges.Add(edges[i]);
+            sharpVerts.Add(eVerts[0]);
+            sharpVerts.Add(eVerts[1]);
+        }
+        for (int i = 0; i < vertices.size(); ++i) {
+            if ((vertices[i] < 0) || (vertices[i] >= base.getNumVertices())) continue;
 
-    return result;
-}
+            sharpVerts.Add(vertices[i]);
+        }
 
-//------------------------------------------------------------------------------
+        for (int level = 1; level <= maxlevel; ++level) {
+            Vtr::internal::Refinement const & refinement = refiner.getRefinement(level-1);
+            Vtr::internal::Level const & parent = refinement.parent();
+            Vtr::internal::Level const & child  = refinement.child();
+
+            if (isChaikin) {
+                std::vector<Index> const & pVerts = sharpVerts.GetMembers();
+                for (int i = 0; i < (int)pVerts.size(); ++i) {
+                    ConstIndexArray vEdges = parent.getVertexEdges(pVerts[i]);
+                    for (int j = 0; j < vEdges.size(); ++j) {
+                        sharpEdges.Add(vEdges[j]);
+                    }
+                }
+            }
 
-template <typename REAL>
-StencilTableReal<REAL> const *
-StencilTableFactoryReal<REAL>::AppendLocalPointStencilTable(
-    TopologyRefiner const &refiner,
-    StencilTableReal<REAL> const * baseStencilTable,
-    StencilTableReal<REAL> const * localPointStencilTable,
-    bool factorize) {
+            ComponentSet childSharpEdges(child.getNumEdges()),
+                         childSharpVerts(child.getNumVertices());
 
-    return appendLocalPointStencilTable(
-        refiner,
+            std::vector<Index> const & pEdges = sharpEdges.GetMembers();
+            for (int i = 0; i < (int)pEdges.size(); ++i) {
+                ConstIndexArray eVerts = parent.getEdgeVertices(pEdges[i]);
+
+                childSharpVerts.Add(refinement.getEdgeChildVertex(pEdges[i]));
+                childSharpVerts.Add(refinement.getVertexChildVertex(eVerts[0]));
+                childSharpVerts.Add(refinement.getVertexChildVertex(eVerts[1]));
+
+                if (child.getNumEdges() > 0) {
+                    ConstIndexArray eChildEdges = refinement.getEdgeChildEdges(pEdges[i]);
+                    childSharpEdges.Add(eChildEdges[0]);
+                    childSharpEdges.Add(eChildEdges[1]);
+                }
+            }
+            std::vector<Index> const & pVerts = sharpVerts.GetMembers();
+            for (int i = 0; i < (int)pVerts.size(); ++i) {
+                childSharpVerts.Add(refinement.getVertexChildVertex(pVerts[i]));
+            }
+
+            //  Masks of all children of sharp components are affected:
+            ComponentSet childAffectedVerts(child.getNumVertices());
+
+            std::vector<Index> const & cVerts = childSharpVerts.GetMembers();
+            for (int i = 0; i < (int)cVerts.size(); ++i) {
+                childAffectedVerts.Add(cVerts[i]);
+            }
+
+            //  Children supported by affected parent vertices are affected:
+            ComponentSet affectedFaces(parent.getNumFaces());
+
+            std::vector<Index> const & pAffected = affectedVerts.GetMembers();
+            for (int i = 0; i < (int)pAffected.size(); ++i) {
+                Index pVert = pAffected[i];
+
+                childAffectedVerts.Add(refinement.getVertexChildVertex(pVert));
+
+                ConstIndexArray vFaces = parent.getVertexFaces(pVert);
+                for (int j = 0; j < vFaces.size(); ++j) {
+                    affectedFaces.Add(vFaces[j]);
+                }
+                ConstIndexArray vEdges = parent.getVertexEdges(pVert);
+                for (int j = 0; j < vEdges.size(); ++j) {
+                    ConstIndexArray eVerts = parent.getEdgeVertices(vEdges[j]);
+                    childAffectedVerts.Add(refinement.getEdgeChildVertex(vEdges[j]));
+                    childAffectedVerts.Add(refinement.getVertexChildVertex(eVerts[0]));
+                    childAffectedVerts.Add(refinement.getVertexChildVertex(eVerts[1]));
+                }
+            }
+            std::vector<Index> const & pFaces = affectedFaces.GetMembers();
+            for (int i = 0; i < (int)pFaces.size(); ++i) {
+                if (refinement.getNumChildVerticesFromFaces()) {
+                    childAffectedVerts.Add(refinement.getFaceChildVertex(pFaces[i]));
+                }
+
+                ConstIndexArray fEdges = parent.getFaceEdges(pFaces[i]),
+                                fVerts = parent.getFaceVertices(pFaces[i]);
+                for (int j = 0; j < fEdges.size(); ++j) {
+                    childAffectedVerts.Add(refinement.getEdgeChildVertex(fEdges[j]));
+                }
+                for (int j = 0; j < fVerts.size(); ++j) {
+                    childAffectedVerts.Add(refinement.getVertexChildVertex(fVerts[j]));
+                }
+            }
+
+            affected[level] = childAffectedVerts.GetSortedMembers();
+
+            sharpEdges    = childSharpEdges;
+            sharpVerts    = childSharpVerts;
+            affectedVerts = childAffectedVerts;
+        }
+    }
+
+    //
+    //  Identify the vertices of each level whose stencils are needed, i.e. the
+    //  affected vertices of levels in the table and the vertices supporting
+    //  those needed in the next level:
+    //
+    std::vector<std::vector<Index> > needed(maxlevel+1);
+
+    {
+        ComponentSet support;
+
+        for (int level = maxlevel; level >= 1; --level) {
+            Vtr::internal::Refinement const & refinement = refiner.getRefinement(level-1);
+            Vtr::internal::Level const & parent = refinement.parent();
+
+            ComponentSet required(refiner.getLevel(level).getNumVertices());
+            if (level < maxlevel) {
+                std::vector<Index> const & members = support.GetMembers();
+                for (int i = 0; i < (int)members.size(); ++i) {
+                    required.Add(members[i]);
+                }
+            }
+            if (outputAllLevels || (level == maxlevel)) {
+                for (int i = 0; i < (int)affected[level].size(); ++i) {
+                    required.Add(affected[level][i]);
+                }
+            }
+
+            //  Vertices from edges and vertices may depend on the child vertices
+            //  of incident faces, and all on vertices of the parent level:
+            ComponentSet parentSupport(parent.getNumVertices());
+
+            Index firstFromEdge = refinement.getFirstChildVertexFromEdges(),
+                  firstFromVert = refinement.getFirstChildVertexFromVertices(),
+                  firstFromFace = refinement.getFirstChildVertexFromFaces();
+            int   numFromEdges  = refinement.getNumChildVerticesFromEdges(),
+                  numFromVerts  = refinement.getNumChildVerticesFromVertices(),
+                  numFromFaces  = refinement.getNumChildVerticesFromFaces();
+
+            for (int i = 0; i < (int)required.GetMembers().size(); ++i) {
+                Index cVert = required.GetMembers()[i];
+                Index pIndex = refinement.getChildVertexParentIndex(cVert);
+
+                if ((cVert >= firstFromFace) && (cVert < firstFromFace + numFromFaces)) {
+                    ConstIndexArray fVerts = parent.getFaceVertices(pIndex);
+                    for (int j = 0; j < fVerts.size(); ++j) {
+                        parentSupport.Add(fVerts[j]);
+                    }
+                } else if ((cVert >= firstFromEdge) && (cVert < firstFromEdge + numFromEdges)) {
+                    ConstIndexArray eVerts = parent.getEdgeVertices(pIndex),
+                                    eFaces = parent.getEdgeFaces(pIndex);
+                    parentSupport.Add(eVerts[0]);
+                    parentSupport.Add(eVerts[1]);
+                    for (int j = 0; j < eFaces.size(); ++j) {
+                        ConstIndexArray fVerts = parent.getFaceVertices(eFaces[j]);
+                        for (int k = 0; k < fVerts.size(); ++k) {
+                            parentSupport.Add(fVerts[k]);
+                        }
+                        if (numFromFaces) {
+                            required.Add(refinement.getFaceChildVertex(eFaces[j]));
+                        }
+                    }
+                } else if ((cVert >= firstFromVert) && (cVert < firstFromVert + numFromVerts)) {
+                    ConstIndexArray vEdges = parent.getVertexEdges(pIndex),
+                                    vFaces = parent.getVertexFaces(pIndex);
+                    parentSupport.Add(pIndex);
+                    for (int j = 0; j < vEdges.size(); ++j) {
+                        ConstIndexArray eVerts = parent.getEdgeVertices(vEdges[j]);
+                        parentSupport.Add(eVerts[0]);
+                        parentSupport.Add(eVerts[1]);
+                    }
+                    if (numFromFaces) {
+                        for (int j = 0; j < vFaces.size(); ++j) {
+                            required.Add(refinement.getFaceChildVertex(vFaces[j]));
+                        }
+                    }
+                }
+            }
+            needed[level] = required.GetSortedMembers();
+            support = parentSupport;
+        }
+    }
+
+    //
+    //  Regenerate the needed stencils of each level from those of the previous
+    //  level and replace the affected stencils of levels in the table -- retaining
+    //  the new stencils until all are available in case their sizes changed:
+    //
+    typedef typename SparseStencilLevel<REAL>::Stencil SparseStencil;
+
+    std::vector<int>           updatedIndices;
+    std::vector<SparseStencil> updatedStencils;
+
+    PrimvarRefiner primvarRefiner(refiner);
+
+    SparseStencilLevel<REAL> * srcLevel = new SparseStencilLevel<REAL>();
+
+    for (int level = 1; level <= maxlevel; ++level) {
+        SparseStencilLevel<REAL> * dstLevel = new SparseStencilLevel<REAL>(
+                needed[level], refiner.getLevel(level).getNumVertices());
+
+        typename SparseStencilLevel<REAL>::Element src = srcLevel->GetElement(),
+                                                   dst = dstLevel->GetElement();
+        if (!needed[level].empty()) {
+            primvarRefiner.Interpolate(level, src, dst,
+                ConstIndexArray(&needed[level][0], (int)needed[level].size()));
+        }
+
+        if (outputAllLevels || (level == maxlevel)) {
+            for (int i = 0; i < (int)affected[level].size(); ++i) {
+                Index vert = affected[level][i];
+
+                updatedIndices.push_back(levelOffsets[level] + vert);
+                updatedStencils.push_back(dstLevel->getStencil(vert));
+            }
+        }
+        delete srcLevel;
+        srcLevel = dstLevel;
+    }
+    delete srcLevel;
+
+    //
+    //  Overwrite the stencils in place when their sizes are unchanged, otherwise
+    //  rebuild the vectors of the table around them:
+    //
+    if (table._offsets.empty()) {
+        table.generateOffsets();
+    }
+
+    bool sizesChanged = false;
+    for (int i = 0; i < (int)updatedIndices.size(); ++i) {
+        if (table._sizes[updatedIndices[i]] != (int)updatedStencils[i].indices.size()) {
+            sizesChanged = true;
+            break;
+        }
+    }
+
+    if (!sizesChanged) {
+        for (int i = 0; i < (int)updatedIndices.size(); ++i) {
+            SparseStencil const & stencil = updatedStencils[i];
+
+            Offset offset = table._offsets[updatedIndices[i]];
+            for (int j = 0; j < (int)stencil.indices.size(); ++j) {
+                table._indices[offset + j] = stencil.indices[j];
+                table._weights[offset + j] = stencil.weights[j];
+            }
+        }
+    } else {
+        std::vector<Index> indices;
+        std::vector<REAL>  weights;
+        indices.reserve(table._indices.size());
+        weights.reserve(table._indices.size());
+
+        int next = 0;
+        for (int i = 0; i < numStencils; ++i) {
+            if ((next < (int)updatedIndices.size()) && (updatedIndices[next] == i)) {
+                SparseStencil const & stencil = updatedStencils[next++];
+
+                table._sizes[i] = (int)stencil.indices.size();
+                indices.insert(indices.end(), stencil.indices.begin(), stencil.indices.end());
+                weights.insert(weights.end(), stencil.weights.begin(), stencil.weights.end());
+            } else {
+                Offset offset = table._offsets[i];
+                int    size   = table._sizes[i];
+
+                indices.insert(indices.end(), table._indices.begin() + offset,
+                                              table._indices.begin() + offset + size);
+                weights.insert(weights.end(), table._weights.begin() + offset,
+                                              table._weights.begin() + offset + size);
+            }
+        }
+        table._indices.swap(indices);
+        table._weights.swap(weights);
+        table.generateOffsets();
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+StencilTableFactoryReal<REAL>::Create(int numTables,
+    StencilTableReal<REAL> const ** tables) {
+
+    // XXXtakahito:
+    // This function returns NULL for empty inputs or erroneous condition.
+    // It's convenient for skipping varying stencils etc, however,
+    // other Create() API returns an empty stencil instead of NULL.
+    // They need to be consistent.
+
+    if ( (numTables<=0) || (! tables)) {
+        return NULL;
+    }
+
+    int ncvs = -1,
+        nstencils = 0;
+    Offset nelems = 0;
+
+    for (int i=0; i<numTables; ++i) {
+
+        StencilTableReal<REAL> const * st = tables[i];
+        // allow the tables could have a null entry.
+        if (!st) continue;
+
+        if (ncvs >= 0 && st->GetNumControlVertices() != ncvs) {
+            return NULL;
+        }
+        ncvs = st->GetNumControlVertices();
+        nstencils += st->GetNumStencils();
+        nelems += (Offset)st->GetControlIndices().size();
+    }
+
+    if (ncvs == -1) {
+        return NULL;
+    }
+
+    StencilTableReal<REAL> * result = new StencilTableReal<REAL>;
+    result->resize(nstencils, nelems);
+
+    int * sizes = &result->_sizes[0];
+    Index * indices = &result->_indices[0];
+    REAL * weights = &result->_weights[0];
+    for (int i=0; i<numTables; ++i) {
+        StencilTableReal<REAL> const * st = tables[i];
+        if (!st) continue;
+
+        int    st_nstencils = st->GetNumStencils();
+        Offset st_nelems = (Offset)st->_indices.size();
+        memcpy(sizes, &st->_sizes[0], st_nstencils*sizeof(int));
+        memcpy(indices, &st->_indices[0], st_nelems*sizeof(Index));
+        memcpy(weights, &st->_weights[0], st_nelems*sizeof(REAL));
+
+        sizes += st_nstencils;
+        indices += st_nelems;
+        weights += st_nelems;
+    }
+
+    result->_numControlVertices = ncvs;
+
+    // have to re-generate offsets from scratch
+    result->generateOffsets();
+
+    result->updateMemoryStats();
+    return result;
+}
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+StencilTableFactoryReal<REAL>::Create(int numTables,
+    StencilTableReal<REAL> const ** tables, Index const * controlVertexOffsets) {
+
+    if ( (numTables<=0) || (! tables) || (! controlVertexOffsets)) {
+        return NULL;
+    }
+
+    int ncvs = 0,
+        nstencils = 0;
+    Offset nelems = 0;
+
+    for (int i=0; i<numTables; ++i) {
+
+        StencilTableReal<REAL> const * st = tables[i];
+        if (!st) continue;
+
+        if (controlVertexOffsets[i] < 0) {
+            return NULL;
+        }
+        ncvs = std::max(ncvs, controlVertexOffsets[i] + st->GetNumControlVertices());
+        nstencils += st->GetNumStencils();
+        nelems += (Offset)st->GetControlIndices().size();
+    }
+
+    StencilTableReal<REAL> * result = new StencilTableReal<REAL>;
+    result->resize(nstencils, nelems);
+
+    int * sizes = nstencils ? &result->_sizes[0] : 0;
+    Index * indices = nelems ? &result->_indices[0] : 0;
+    REAL * weights = nelems ? &result->_weights[0] : 0;
+    for (int i=0; i<numTables; ++i) {
+        StencilTableReal<REAL> const * st = tables[i];
+        if (!st) continue;
+
+        int    st_nstencils = st->GetNumStencils();
+        Offset st_nelems = (Offset)st->_indices.size();
+        if (st_nstencils) {
+            memcpy(sizes, &st->_sizes[0], st_nstencils*sizeof(int));
+        }
+        for (Offset j=0; j<st_nelems; ++j) {
+            indices[j] = st->_indices[j] + controlVertexOffsets[i];
+        }
+        if (st_nelems) {
+            memcpy(weights, &st->_weights[0], st_nelems*sizeof(REAL));
+        }
+
+        sizes += st_nstencils;
+        indices += st_nelems;
+        weights += st_nelems;
+    }
+
+    result->_numControlVertices = ncvs;
+
+    // have to re-generate offsets from scratch
+    result->generateOffsets();
+
+    result->updateMemoryStats();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+StencilTableFactoryReal<REAL>::AppendLocalPointStencilTable(
+    TopologyRefiner const &refiner,
+    StencilTableReal<REAL> const * baseStencilTable,
+    StencilTableReal<REAL> const * localPointStencilTable,
+    bool factorize) {
+
+    return appendLocalPointStencilTable(
+        refiner,
         baseStencilTable,
         localPointStencilTable,
         /*channel*/-1,
@@ -254,6 +1301,41 @@ StencilTableFactoryReal<REAL>::AppendLocalPointStencilTableFaceVarying(
         factorize);
 }
 
+template <typename REAL>
+bool
+StencilTableFactoryReal<REAL>::AppendLocalPointStencilTable(
+    TopologyRefiner const &refiner,
+    StencilTableReal<REAL> & stencilTable,
+    StencilTableReal<REAL> const * localPointStencilTable,
+    bool factorize) {
+
+    return appendLocalPointStencils(
+        refiner,
+        &stencilTable,
+        localPointStencilTable,
+        /*channel*/-1,
+        factorize,
+        stencilTable);
+}
+
+template <typename REAL>
+bool
+StencilTableFactoryReal<REAL>::AppendLocalPointStencilTableFaceVarying(
+    TopologyRefiner const &refiner,
+    StencilTableReal<REAL> & stencilTable,
+    StencilTableReal<REAL> const * localPointStencilTable,
+    int channel,
+    bool factorize) {
+
+    return appendLocalPointStencils(
+        refiner,
+        &stencilTable,
+        localPointStencilTable,
+        channel,
+        factorize,
+        stencilTable);
+}
+
 template <typename REAL>
 StencilTableReal<REAL> const *
 StencilTableFactoryReal<REAL>::appendLocalPointStencilTable(
@@ -263,152 +1345,729 @@ StencilTableFactoryReal<REAL>::appendLocalPointStencilTable(
     int channel,
     bool factorize) {
 
+    StencilTableReal<REAL> * result = new StencilTableReal<REAL>;
+    if (! appendLocalPointStencils(refiner, baseStencilTable,
+            localPointStencilTable, channel, factorize, *result)) {
+        delete result;
+        return NULL;
+    }
+    result->updateMemoryStats();
+    return result;
+}
+
+template <typename REAL>
+bool
+StencilTableFactoryReal<REAL>::appendLocalPointStencils(
+    TopologyRefiner const &refiner,
+    StencilTableReal<REAL> const * baseStencilTable,
+    StencilTableReal<REAL> const * localPointStencilTable,
+    int channel,
+    bool factorize,
+    StencilTableReal<REAL> & result) {
+
+    OPENSUBDIV_TRACE_SCOPE("stencils.append");
+
     // require the local point stencils exist and be non-empty
     if ((localPointStencilTable == NULL) ||
         (localPointStencilTable->GetNumStencils() == 0)) {
-        return NULL;
+        return false;
     }
 
     int nControlVerts = channel < 0
         ? refiner.GetLevel(0).GetNumVertices()
         : refiner.GetLevel(0).GetNumFVarValues(channel);
 
-    //  if no base stencils or empty, return copy of local point stencils
-    if ((baseStencilTable == NULL) ||
-        (baseStencilTable->GetNumStencils() == 0)) {
-        StencilTableReal<REAL> * result =
-                new StencilTableReal<REAL>(*localPointStencilTable);
-        result->_numControlVertices = nControlVerts;
-        return result;
+    //  if no base stencils or empty, the result is a copy of the local
+    //  point stencils
+    if ((baseStencilTable == NULL) ||
+        (baseStencilTable->GetNumStencils() == 0)) {
+        result = *localPointStencilTable;
+        result._numControlVertices = nControlVerts;
+        return true;
+    }
+
+    // baseStencilTable can be built with or without singular stencils
+    // (single weight of 1.0f) as place-holders for coarse mesh vertices.
+
+    int controlVertsIndexOffset = 0;
+    int nBaseStencils = baseStencilTable->GetNumStencils();
+    Offset nBaseStencilsElements = (Offset)baseStencilTable->_indices.size();
+    int nverts = channel < 0
+        ? refiner.GetNumVerticesTotal()
+        : refiner.GetNumFVarValuesTotal(channel);
+    {
+        if (nBaseStencils == nverts) {
+
+            // the table contains stencils for the control vertices
+            //
+            //  <-----------------  nverts ------------------>
+            //
+            //  +---------------+----------------------------+-----------------+
+            //  | control verts | refined verts   : (max lv) |   local points  |
+            //  +---------------+----------------------------+-----------------+
+            //  |          base stencil table                |    LP stencils  |
+            //  +--------------------------------------------+-----------------+
+            //                         ^                           /
+            //                          \_________________________/
+            //
+            //
+            controlVertsIndexOffset = 0;
+
+        } else if (nBaseStencils == (nverts - nControlVerts)) {
+
+            // the table does not contain stencils for the control vertices
+            //
+            //  <-----------------  nverts ------------------>
+            //                  <------ nBaseStencils ------->
+            //  +---------------+----------------------------+-----------------+
+            //  | control verts | refined verts   : (max lv) |   local points  |
+            //  +---------------+----------------------------+-----------------+
+            //                  |     base stencil table     |    LP stencils  |
+            //                  +----------------------------+-----------------+
+            //                                 ^                   /
+            //                                  \_________________/
+            //  <-------------->
+            //                 controlVertsIndexOffset
+            //
+            controlVertsIndexOffset = nControlVerts;
+
+        } else {
+            // these are not the stencils you are looking for.
+            assert(0);
+            return false;
+        }
+    }
+
+    // copy all local point stencils to proto stencils, and factorize if needed.
+    int nLocalPointStencils = localPointStencilTable->GetNumStencils();
+    Offset nLocalPointStencilsElements = 0;
+
+    // unfactorized local point stencils refer to the refined vertices as
+    // well as the control vertices
+    StencilBuilder<REAL> builder(factorize ? nControlVerts : nverts,
+                                /*genControlVerts*/ false,
+                                /*compactWeights*/  factorize);
+    typename StencilBuilder<REAL>::Index origin(&builder, 0);
+    typename StencilBuilder<REAL>::Index dst = origin;
+    typename StencilBuilder<REAL>::Index srcIdx = origin;
+
+    {
+        OPENSUBDIV_TRACE_SCOPE(factorize ? "stencils.factorize" : "stencils.copy");
+
+        for (int i = 0 ; i < nLocalPointStencils; ++i) {
+            StencilReal<REAL> src = localPointStencilTable->GetStencil(i);
+            dst = origin[i];
+            for (int j = 0; j < src.GetSize(); ++j) {
+                Index index = src.GetVertexIndices()[j];
+                REAL weight = src.GetWeights()[j];
+                if (isWeightZero<REAL>(weight)) continue;
+
+                if (factorize) {
+                    dst.AddWithWeight(
+                        // subtracting controlVertsIndex if the baseStencil doesn't
+                        // include control vertices (see above diagram)
+                        // since currently local point stencils are created with
+                        // absolute indices including control (level=0) vertices.
+                        baseStencilTable->GetStencil(index - controlVertsIndexOffset),
+                        weight);
+                } else {
+                    srcIdx = origin[index];
+                    dst.AddWithWeight(srcIdx, weight);
+                }
+            }
+            nLocalPointStencilsElements += builder.GetNumVertsInStencil(i);
+        }
+    }
+
+    //  The local point stencils follow the base stencils.  When appending
+    //  in place, the arrays of the table are grown to their exact size and
+    //  the base stencils are left where they are, otherwise the base
+    //  stencils are copied into the new table first:
+    bool inPlace = (&result == baseStencilTable);
+
+    int    nStencils = nBaseStencils + nLocalPointStencils;
+    Offset nElements = nBaseStencilsElements + nLocalPointStencilsElements;
+
+    result._numControlVertices = nControlVerts;
+    result.reserve(nStencils, nElements);
+    result.resize(nStencils, nElements);
+
+    int* sizes = &result._sizes[0];
+    Index * indices = &result._indices[0];
+    REAL * weights = &result._weights[0];
+
+    // put base stencils first
+    if (! inPlace) {
+        memcpy(sizes, &baseStencilTable->_sizes[0],
+               nBaseStencils*sizeof(int));
+        memcpy(indices, &baseStencilTable->_indices[0],
+               nBaseStencilsElements*sizeof(Index));
+        memcpy(weights, &baseStencilTable->_weights[0],
+               nBaseStencilsElements*sizeof(REAL));
+    }
+
+    sizes += nBaseStencils;
+    indices += nBaseStencilsElements;
+    weights += nBaseStencilsElements;
+
+    // endcap stencils second
+    for (int i = 0 ; i < nLocalPointStencils; ++i) {
+        int size = builder.GetNumVertsInStencil(i);
+        Offset idx = builder.GetStencilOffsets()[i];
+        for (int j = 0; j < size; ++j) {
+            *indices++ = builder.GetStencilSources()[idx+j];
+            *weights++ = builder.GetStencilWeights()[idx+j];
+        }
+        *sizes++ = size;
+    }
+
+    // have to re-generate offsets from scratch
+    result._offsets.reserve(nStencils);
+    result.generateOffsets();
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+    //
+    //  Reverse Cuthill-McKee ordering of the vertices of a graph given in
+    //  compressed form, returning the new index of each vertex.  Each
+    //  connected component starts from a vertex of minimal degree and
+    //  neighbors are visited in order of increasing degree:
+    //
+    void
+    computeRCMOrdering(int numVertices, std::vector<int> const & offsets,
+            std::vector<Index> const & neighbors,
+            std::vector<Index> & permutation) {
+
+        std::vector<Index> order;
+        order.reserve(numVertices);
+
+        std::vector<Index> byDegree(numVertices);
+        for (int i = 0; i < numVertices; ++i) {
+            byDegree[i] = i;
+        }
+        std::vector<int> degree(numVertices);
+        for (int i = 0; i < numVertices; ++i) {
+            degree[i] = offsets[i+1] - offsets[i];
+        }
+        //  Stable bucket sort of the vertices by degree to choose the starts:
+        {
+            int maxDegree = 0;
+            for (int i = 0; i < numVertices; ++i) {
+                maxDegree = std::max(maxDegree, degree[i]);
+            }
+            std::vector<int> counts(maxDegree + 2, 0);
+            for (int i = 0; i < numVertices; ++i) {
+                ++counts[degree[i] + 1];
+            }
+            for (int d = 0; d <= maxDegree; ++d) {
+                counts[d + 1] += counts[d];
+            }
+            for (int i = 0; i < numVertices; ++i) {
+                byDegree[counts[degree[i]]++] = i;
+            }
+        }
+
+        std::vector<bool> visited(numVertices, false);
+        std::vector<std::pair<int, Index> > adjacent;
+
+        for (int s = 0; s < numVertices; ++s) {
+            Index start = byDegree[s];
+            if (visited[start]) continue;
+
+            visited[start] = true;
+            size_t head = order.size();
+            order.push_back(start);
+
+            while (head < order.size()) {
+                Index v = order[head++];
+
+                adjacent.clear();
+                for (int j = offsets[v]; j < offsets[v+1]; ++j) {
+                    Index n = neighbors[j];
+                    if (!visited[n]) {
+                        visited[n] = true;
+                        adjacent.push_back(std::make_pair(degree[n], n));
+                    }
+                }
+                std::sort(adjacent.begin(), adjacent.end());
+                for (size_t j = 0; j < adjacent.size(); ++j) {
+                    order.push_back(adjacent[j].second);
+                }
+            }
+        }
+        assert((int)order.size() == numVertices);
+
+        permutation.resize(numVertices);
+        for (int i = 0; i < numVertices; ++i) {
+            permutation[order[numVertices - 1 - i]] = i;
+        }
+    }
+} // end namespace
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+StencilTableFactoryReal<REAL>::ReorderControlVertices(
+        TopologyRefiner const &refiner,
+        StencilTableReal<REAL> const *stencilTable,
+        std::vector<Index> &permutation,
+        int fvarChannel) {
+
+    OPENSUBDIV_TRACE_SCOPE("stencils.reorder");
+
+    if (stencilTable == NULL) return NULL;
+
+    TopologyLevel const & level = refiner.GetLevel(0);
+
+    int numVertices = (fvarChannel < 0) ? level.GetNumVertices()
+                                        : level.GetNumFVarValues(fvarChannel);
+    if (stencilTable->GetNumControlVertices() != numVertices) {
+        return NULL;
+    }
+
+    //  Gather the (directed) edges of the faces in both directions and
+    //  compress them into sorted, unique lists of neighbors per vertex:
+    std::vector<std::pair<Index, Index> > edges;
+    for (int face = 0; face < level.GetNumFaces(); ++face) {
+        ConstIndexArray fVerts = (fvarChannel < 0)
+            ? level.GetFaceVertices(face)
+            : level.GetFaceFVarValues(face, fvarChannel);
+        for (int i = 0; i < fVerts.size(); ++i) {
+            Index v0 = fVerts[i];
+            Index v1 = fVerts[(i + 1) % fVerts.size()];
+            if (v0 == v1) continue;
+            edges.push_back(std::make_pair(v0, v1));
+            edges.push_back(std::make_pair(v1, v0));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<int> offsets(numVertices + 1, 0);
+    std::vector<Index> neighbors(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        ++offsets[edges[i].first + 1];
+        neighbors[i] = edges[i].second;
+    }
+    for (int i = 0; i < numVertices; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    computeRCMOrdering(numVertices, offsets, neighbors, permutation);
+
+    //  Copy the table, renumbering the control vertices and sorting the
+    //  entries of each stencil by index:
+    StencilTableReal<REAL> * result = new StencilTableReal<REAL>(*stencilTable);
+
+    std::vector<std::pair<Index, REAL> > entries;
+    Offset offset = 0;
+    for (int i = 0; i < result->GetNumStencils(); ++i) {
+        int size = result->_sizes[i];
+        Index * indices = &result->_indices[offset];
+        REAL  * weights = &result->_weights[offset];
+        offset += size;
+
+        entries.resize(size);
+        for (int j = 0; j < size; ++j) {
+            Index index = indices[j];
+            entries[j].first = (index < numVertices) ? permutation[index]
+                                                     : index;
+            entries[j].second = weights[j];
+        }
+        std::sort(entries.begin(), entries.end());
+        for (int j = 0; j < size; ++j) {
+            indices[j] = entries[j].first;
+            weights[j] = entries[j].second;
+        }
+    }
+    result->updateMemoryStats();
+    return result;
+}
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+StencilTableFactoryReal<REAL>::ExtractStencils(
+        StencilTableReal<REAL> const *stencilTable,
+        int start, int end,
+        Index const *indexRemap) {
+
+    if ((stencilTable == NULL) || (start < 0) || (start >= end) ||
+        (end > stencilTable->GetNumStencils())) {
+        return NULL;
+    }
+
+    Offset firstElement = 0;
+    for (int i = 0; i < start; ++i) {
+        firstElement += stencilTable->_sizes[i];
+    }
+    Offset numElements = 0;
+    for (int i = start; i < end; ++i) {
+        numElements += stencilTable->_sizes[i];
+    }
+
+    StencilTableReal<REAL> * result = new StencilTableReal<REAL>;
+    result->_numControlVertices = stencilTable->_numControlVertices;
+    result->resize(end - start, numElements);
+
+    memcpy(&result->_sizes[0], &stencilTable->_sizes[start],
+           (end - start)*sizeof(int));
+    memcpy(&result->_weights[0], &stencilTable->_weights[firstElement],
+           numElements*sizeof(REAL));
+    if (indexRemap) {
+        Index const * indices = &stencilTable->_indices[firstElement];
+        for (Offset i = 0; i < numElements; ++i) {
+            result->_indices[i] = indexRemap[indices[i]];
+        }
+    } else {
+        memcpy(&result->_indices[0], &stencilTable->_indices[firstElement],
+               numElements*sizeof(Index));
+    }
+
+    result->generateOffsets();
+
+    result->updateMemoryStats();
+    return result;
+}
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+StencilTableFactoryReal<REAL>::GatherStencils(
+        StencilTableReal<REAL> const *stencilTable,
+        int numStencils,
+        Index const *stencilIndices) {
+
+    if ((stencilTable == NULL) || (numStencils <= 0)) {
+        return NULL;
+    }
+
+    //  The offsets of the input table may not have been generated:
+    std::vector<Offset> offsets(stencilTable->GetNumStencils());
+    Offset offset = 0;
+    for (int i = 0; i < (int)offsets.size(); ++i) {
+        offsets[i] = offset;
+        offset += stencilTable->_sizes[i];
+    }
+
+    Offset numElements = 0;
+    for (int i = 0; i < numStencils; ++i) {
+        Index stencil = stencilIndices[i];
+        if ((stencil < 0) || (stencil >= (Index)offsets.size())) {
+            return NULL;
+        }
+        numElements += stencilTable->_sizes[stencil];
+    }
+
+    StencilTableReal<REAL> * result = new StencilTableReal<REAL>;
+    result->_numControlVertices = stencilTable->_numControlVertices;
+    result->resize(numStencils, numElements);
+
+    Offset element = 0;
+    for (int i = 0; i < numStencils; ++i) {
+        Index stencil = stencilIndices[i];
+        int size = stencilTable->_sizes[stencil];
+
+        result->_sizes[i] = size;
+        if (size) {
+            memcpy(&result->_indices[element],
+                   &stencilTable->_indices[offsets[stencil]], size*sizeof(Index));
+            memcpy(&result->_weights[element],
+                   &stencilTable->_weights[offsets[stencil]], size*sizeof(REAL));
+        }
+        element += size;
+    }
+
+    result->generateOffsets();
+
+    result->updateMemoryStats();
+    return result;
+}
+
+template <typename REAL>
+bool
+StencilTableFactoryReal<REAL>::PartitionStencils(
+        StencilTableReal<REAL> const *stencilTable,
+        int numPartitions,
+        StencilTableReal<REAL> const *partitionTables[],
+        std::vector<Index> partitionSources[],
+        std::vector<Index> partitionStencils[]) {
+
+    OPENSUBDIV_TRACE_SCOPE("stencils.partition");
+
+    if ((stencilTable == NULL) || (numPartitions < 1)) return false;
+
+    int numVertices = stencilTable->GetNumControlVertices();
+    int numStencils = stencilTable->GetNumStencils();
+
+    std::vector<int>   const & sizes = stencilTable->_sizes;
+    std::vector<Index> const & indices = stencilTable->_indices;
+    std::vector<REAL>  const & weights = stencilTable->_weights;
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if ((indices[i] < 0) || (indices[i] >= numVertices)) return false;
+    }
+
+    //  Connect the control vertices of each stencil into a chain (stencils
+    //  are local, so any connection of their vertices preserves locality)
+    //  and order the vertices by RCM:
+    std::vector<std::pair<Index, Index> > edges;
+    std::vector<Index> stencilVerts;
+    Offset offset = 0;
+    for (int i = 0; i < numStencils; offset += sizes[i++]) {
+        stencilVerts.assign(indices.begin() + offset,
+                            indices.begin() + offset + sizes[i]);
+        std::sort(stencilVerts.begin(), stencilVerts.end());
+        for (int j = 1; j < (int)stencilVerts.size(); ++j) {
+            Index v0 = stencilVerts[j-1];
+            Index v1 = stencilVerts[j];
+            if (v0 == v1) continue;
+            edges.push_back(std::make_pair(v0, v1));
+            edges.push_back(std::make_pair(v1, v0));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<int> offsets(numVertices + 1, 0);
+    std::vector<Index> neighbors(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        ++offsets[edges[i].first + 1];
+        neighbors[i] = edges[i].second;
+    }
+    for (int i = 0; i < numVertices; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    std::vector<Index> rank;
+    computeRCMOrdering(numVertices, offsets, neighbors, rank);
+
+    //  Order the stencils by the rank of their most weighted vertex and
+    //  split them into ranges of balanced numbers of entries:
+    std::vector<std::pair<Index, int> > order(numStencils);
+    offset = 0;
+    for (int i = 0; i < numStencils; offset += sizes[i++]) {
+        Index key = 0;
+        REAL maxWeight = 0;
+        for (int j = 0; j < sizes[i]; ++j) {
+            REAL w = weights[offset + j];
+            if (w < 0) w = -w;
+            if ((j == 0) || (w > maxWeight)) {
+                maxWeight = w;
+                key = rank[indices[offset + j]];
+            }
+        }
+        order[i] = std::make_pair(key, i);
+    }
+    std::sort(order.begin(), order.end());
+
+    //  (each stencil, even empty, costs at least one entry)
+    size_t totalCost = 0;
+    for (int i = 0; i < numStencils; ++i) {
+        totalCost += std::max(sizes[i], 1);
+    }
+
+    std::vector<Offset> const & stencilOffsets = stencilTable->_offsets;
+
+    std::vector<int> sourceTags(numVertices, -1);
+
+    size_t cost = 0;
+    for (int p = 0, next = 0; p < numPartitions; ++p) {
+        std::vector<Index> & stencils = partitionStencils[p];
+        std::vector<Index> & sources = partitionSources[p];
+
+        size_t endCost = (totalCost * (p + 1)) / numPartitions;
+
+        stencils.clear();
+        while ((next < numStencils) &&
+               ((cost < endCost) || (p == numPartitions - 1))) {
+            int stencil = order[next++].second;
+            cost += std::max(sizes[stencil], 1);
+            stencils.push_back(stencil);
+        }
+        std::sort(stencils.begin(), stencils.end());
+
+        //  Gather the sources of the partition and remap the entries:
+        sources.clear();
+        Offset numElements = 0;
+        for (size_t i = 0; i < stencils.size(); ++i) {
+            int size = sizes[stencils[i]];
+            Index const * stencilIndices =
+                &indices[stencilOffsets[stencils[i]]];
+            for (int j = 0; j < size; ++j) {
+                if (sourceTags[stencilIndices[j]] != p) {
+                    sourceTags[stencilIndices[j]] = p;
+                    sources.push_back(stencilIndices[j]);
+                }
+            }
+            numElements += size;
+        }
+        std::sort(sources.begin(), sources.end());
+
+        StencilTableReal<REAL> * result = new StencilTableReal<REAL>;
+        result->_numControlVertices = (int)sources.size();
+        result->resize((int)stencils.size(), numElements);
+
+        Offset element = 0;
+        for (int i = 0; i < (int)stencils.size(); ++i) {
+            int    size = sizes[stencils[i]];
+            Offset offset = stencilOffsets[stencils[i]];
+            result->_sizes[i] = size;
+            for (int j = 0; j < size; ++j, ++element) {
+                result->_indices[element] = (Index)(std::lower_bound(
+                    sources.begin(), sources.end(), indices[offset + j]) -
+                    sources.begin());
+                result->_weights[element] = weights[offset + j];
+            }
+        }
+        result->generateOffsets();
+        result->updateMemoryStats();
+
+        partitionTables[p] = result;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+    template <class T>
+    inline void
+    copyEntries(std::vector<T> & dst, Offset offset,
+                std::vector<T> const & src, Offset count) {
+        if (count > 0) {
+            std::memcpy(&dst[offset], &src[0], count * sizeof(T));
+        }
     }
 
-    // baseStencilTable can be built with or without singular stencils
-    // (single weight of 1.0f) as place-holders for coarse mesh vertices.
+    //
+    //  Construction of the limit stencils for a range of the locations of all
+    //  location arrays.  The stencils of a range are independent of those of
+    //  any other range, so ranges can be built concurrently into separate
+    //  StencilBuilders:
+    //
+    template <typename REAL>
+    struct LimitStencilContext {
+        typedef typename LimitStencilTableFactoryReal<REAL>::LocationArrayVec
+                LocationArrayVec;
 
-    int controlVertsIndexOffset = 0;
-    int nBaseStencils = baseStencilTable->GetNumStencils();
-    int nBaseStencilsElements = (int)baseStencilTable->_indices.size();
-    {
-        int nverts = channel < 0
-            ? refiner.GetNumVerticesTotal()
-            : refiner.GetNumFVarValuesTotal(channel);
-        if (nBaseStencils == nverts) {
+        LocationArrayVec const *       locationArrays;
+        PatchTable const *             patchTable;
+        PatchMap const *               patchMap;
+        StencilTableReal<REAL> const * cvStencils;
 
-            // the table contains stencils for the control vertices
-            //
-            //  <-----------------  nverts ------------------>
-            //
-            //  +---------------+----------------------------+-----------------+
-            //  | control verts | refined verts   : (max lv) |   local points  |
-            //  +---------------+----------------------------+-----------------+
-            //  |          base stencil table                |    LP stencils  |
-            //  +--------------------------------------------+-----------------+
-            //                         ^                           /
-            //                          \_________________________/
-            //
-            //
-            controlVertsIndexOffset = 0;
+        bool useVertexPatches;
+        bool useFVarPatches;
+        bool generate1st;
+        bool generate2nd;
+        int  fvarChannel;
 
-        } else if (nBaseStencils == (nverts - nControlVerts)) {
+        //  Returns the number of stencils of the locations found:
+        int Build(StencilBuilder<REAL> & builder, int first, int count) const;
+    };
 
-            // the table does not contain stencils for the control vertices
-            //
-            //  <-----------------  nverts ------------------>
-            //                  <------ nBaseStencils ------->
-            //  +---------------+----------------------------+-----------------+
-            //  | control verts | refined verts   : (max lv) |   local points  |
-            //  +---------------+----------------------------+-----------------+
-            //                  |     base stencil table     |    LP stencils  |
-            //                  +----------------------------+-----------------+
-            //                                 ^                   /
-            //                                  \_________________/
-            //  <-------------->
-            //                 controlVertsIndexOffset
-            //
-            controlVertsIndexOffset = nControlVerts;
+    template <typename REAL>
+    int
+    LimitStencilContext<REAL>::Build(StencilBuilder<REAL> & builder,
+                                     int first, int count) const {
 
-        } else {
-            // these are not the stencils you are looking for.
-            assert(0);
-            return NULL;
-        }
-    }
+        typename StencilBuilder<REAL>::Index origin(&builder, 0);
+        typename StencilBuilder<REAL>::Index dst = origin;
 
-    // copy all local point stencils to proto stencils, and factorize if needed.
-    int nLocalPointStencils = localPointStencilTable->GetNumStencils();
-    int nLocalPointStencilsElements = 0;
+        PatchTable const & patchtable = *patchTable;
+        StencilTableReal<REAL> const & src = *cvStencils;
 
-    StencilBuilder<REAL> builder(nControlVerts,
-                                /*genControlVerts*/ false,
-                                /*compactWeights*/  factorize);
-    typename StencilBuilder<REAL>::Index origin(&builder, 0);
-    typename StencilBuilder<REAL>::Index dst = origin;
-    typename StencilBuilder<REAL>::Index srcIdx = origin;
+        REAL  wP[20], wDs[20], wDt[20], wDss[20], wDst[20], wDtt[20];
 
-    for (int i = 0 ; i < nLocalPointStencils; ++i) {
-        StencilReal<REAL> src = localPointStencilTable->GetStencil(i);
-        dst = origin[i];
-        for (int j = 0; j < src.GetSize(); ++j) {
-            Index index = src.GetVertexIndices()[j];
-            REAL weight = src.GetWeights()[j];
-            if (isWeightZero<REAL>(weight)) continue;
-
-            if (factorize) {
-                dst.AddWithWeight(
-                    // subtracting controlVertsIndex if the baseStencil doesn't
-                    // include control vertices (see above diagram)
-                    // since currently local point stencils are created with
-                    // absolute indices including control (level=0) vertices.
-                    baseStencilTable->GetStencil(index - controlVertsIndexOffset),
-                    weight);
-            } else {
-                srcIdx = origin[index + controlVertsIndexOffset];
-                dst.AddWithWeight(srcIdx, weight);
+        int numLimitStencils = 0;
+
+        //  Locate the array containing the first location:
+        int arrayIndex = 0,
+            arrayStart = 0;
+        for (int i = first; i < first + count; ++i) {
+            while ((i - arrayStart) >= (*locationArrays)[arrayIndex].numLocations) {
+                arrayStart += (*locationArrays)[arrayIndex++].numLocations;
             }
-        }
-        nLocalPointStencilsElements += builder.GetNumVertsInStencil(i);
-    }
+            typename LimitStencilTableFactoryReal<REAL>::LocationArray const &
+                array = (*locationArrays)[arrayIndex];
+            assert(array.ptexIdx>=0);
 
-    // create new stencil table
-    StencilTableReal<REAL> * result = new StencilTableReal<REAL>;
-    result->_numControlVertices = nControlVerts;
-    result->resize(nBaseStencils + nLocalPointStencils,
-                   nBaseStencilsElements + nLocalPointStencilsElements);
+            int j = i - arrayStart;
 
-    int* sizes = &result->_sizes[0];
-    Index * indices = &result->_indices[0];
-    REAL * weights = &result->_weights[0];
+            REAL  s = array.s[j],
+                  t = array.t[j]; // for each target (s,t) point on that face
 
-    // put base stencils first
-    memcpy(sizes, &baseStencilTable->_sizes[0],
-           nBaseStencils*sizeof(int));
-    memcpy(indices, &baseStencilTable->_indices[0],
-           nBaseStencilsElements*sizeof(Index));
-    memcpy(weights, &baseStencilTable->_weights[0],
-           nBaseStencilsElements*sizeof(REAL));
+            PatchMap::Handle const * handle = 
+                                        patchMap->FindPatch(array.ptexIdx, s, t);
+            if (handle) {
+                ConstIndexArray cvs;
+                if (useVertexPatches) {
+                    cvs = patchtable.GetPatchVertices(*handle);
+                } else if (useFVarPatches) {
+                    cvs = patchtable.GetPatchFVarValues(*handle, fvarChannel);
+                } else {
+                    cvs = patchtable.GetPatchVaryingVertices(*handle);
+                }
 
-    sizes += nBaseStencils;
-    indices += nBaseStencilsElements;
-    weights += nBaseStencilsElements;
+                dst = origin[numLimitStencils];
 
-    // endcap stencils second
-    for (int i = 0 ; i < nLocalPointStencils; ++i) {
-        int size = builder.GetNumVertsInStencil(i);
-        int idx = builder.GetStencilOffsets()[i];
-        for (int j = 0; j < size; ++j) {
-            *indices++ = builder.GetStencilSources()[idx+j];
-            *weights++ = builder.GetStencilWeights()[idx+j];
-        }
-        *sizes++ = size;
-    }
+                if (generate2nd) {
+                    if (useVertexPatches) {
+                        patchtable.EvaluateBasis<REAL>(
+                                *handle, s, t, wP, wDs, wDt, wDss, wDst, wDtt);
+                    } else if (useFVarPatches) {
+                        patchtable.EvaluateBasisFaceVarying<REAL>(
+                                *handle, s, t, wP, wDs, wDt, wDss, wDst, wDtt, fvarChannel);
+                    } else {
+                        patchtable.EvaluateBasisVarying<REAL>(
+                                *handle, s, t, wP, wDs, wDt, wDss, wDst, wDtt);
+                    }
 
-    // have to re-generate offsets from scratch
-    result->generateOffsets();
+                    dst.Clear();
+                    for (int k = 0; k < cvs.size(); ++k) {
+                        dst.AddWithWeight(src[cvs[k]], wP[k], wDs[k], wDt[k], wDss[k], wDst[k], wDtt[k]);
+                    }
+                } else if (generate1st) {
+                    if (useVertexPatches) {
+                        patchtable.EvaluateBasis<REAL>(
+                                *handle, s, t, wP, wDs, wDt);
+                    } else if (useFVarPatches) {
+                        patchtable.EvaluateBasisFaceVarying<REAL>(
+                                *handle, s, t, wP, wDs, wDt, 0, 0, 0, fvarChannel);
+                    } else {
+                        patchtable.EvaluateBasisVarying<REAL>(
+                                *handle, s, t, wP, wDs, wDt);
+                    }
 
-    return result;
+                    dst.Clear();
+                    for (int k = 0; k < cvs.size(); ++k) {
+                        dst.AddWithWeight(src[cvs[k]], wP[k], wDs[k], wDt[k]);
+                    }
+                } else {
+                    if (useVertexPatches) {
+                        patchtable.EvaluateBasis<REAL>(
+                                *handle, s, t, wP);
+                    } else if (useFVarPatches) {
+                        patchtable.EvaluateBasisFaceVarying<REAL>(
+                                *handle, s, t, wP, 0, 0, 0, 0, 0, fvarChannel);
+                    } else {
+                        patchtable.EvaluateBasisVarying<REAL>(
+                                *handle, s, t, wP);
+                    }
+
+                    dst.Clear();
+                    for (int k = 0; k < cvs.size(); ++k) {
+                        dst.AddWithWeight(src[cvs[k]], wP[k]);
+                    }
+                }
+
+                ++numLimitStencils;
+            }
+        }
+        return numLimitStencils;
+    }
 }
 
-//------------------------------------------------------------------------------
 template <typename REAL>
 LimitStencilTableReal<REAL> const *
 LimitStencilTableFactoryReal<REAL>::Create(TopologyRefiner const & refiner,
@@ -417,8 +2076,10 @@ LimitStencilTableFactoryReal<REAL>::Create(TopologyRefiner const & refiner,
     PatchTable const * patchTableIn,
     Options options) {
 
+    OPENSUBDIV_TRACE_SCOPE("stencils.limit");
+
     // Compute the total number of stencils to generate
-    int numStencils=0, numLimitStencils=0;
+    int numStencils=0;
     for (int i=0; i<(int)locationArrays.size(); ++i) {
         assert(locationArrays[i].numLocations>=0);
         numStencils += locationArrays[i].numLocations;
@@ -475,6 +2136,7 @@ LimitStencilTableFactoryReal<REAL>::Create(TopologyRefiner const & refiner,
         stencilTableOptions.generateOffsets = true;
         stencilTableOptions.interpolationMode = options.interpolationMode;
         stencilTableOptions.fvarChannel = options.fvarChannel;
+        stencilTableOptions.numThreads = options.numThreads;
 
         cvstencils = StencilTableFactoryReal<REAL>::Create(refiner, stencilTableOptions);
     }
@@ -503,6 +2165,7 @@ LimitStencilTableFactoryReal<REAL>::Create(TopologyRefiner const & refiner,
             Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
         patchTableOptions.useInfSharpPatch = !uniform &&
             refiner.GetAdaptiveOptions().useInfSharpPatch;
+        patchTableOptions.numThreads = options.numThreads;
 
         patchtable = PatchTableFactory::Create(refiner, patchTableOptions);
     }
@@ -541,124 +2204,284 @@ LimitStencilTableFactoryReal<REAL>::Create(TopologyRefiner const & refiner,
                          ? refiner.GetLevel(0).GetNumFVarValues(fvarChannel)
                          : refiner.GetLevel(0).GetNumVertices();
 
-    StencilBuilder<REAL> builder(nControlVertices,
-                                /*genControlVerts*/ false,
-                                /*compactWeights*/  true);
-    typename StencilBuilder<REAL>::Index origin(&builder, 0);
-    typename StencilBuilder<REAL>::Index dst = origin;
-
     //
     //  Generally use the patches corresponding to the interpolation mode, but Uniform
     //  PatchTables do not have varying patches -- use the equivalent linear vertex
     //  patches in this case:
     //
-    bool useVertexPatches = interpolateVertex || (interpolateVarying && uniform);
-    bool useFVarPatches   = interpolateFaceVarying;
-
-    REAL  wP[20], wDs[20], wDt[20], wDss[20], wDst[20], wDtt[20];
-
-    for (size_t i=0; i<locationArrays.size(); ++i) {
-        LocationArray const & array = locationArrays[i];
-        assert(array.ptexIdx>=0);
+    LimitStencilContext<REAL> context;
+    context.locationArrays   = &locationArrays;
+    context.patchTable       = patchtable;
+    context.patchMap         = &patchmap;
+    context.cvStencils       = cvstencils;
+    context.useVertexPatches = interpolateVertex || (interpolateVarying && uniform);
+    context.useFVarPatches   = interpolateFaceVarying;
+    context.generate1st      = options.generate1stDerivatives;
+    context.generate2nd      = options.generate2ndDerivatives;
+    context.fvarChannel      = fvarChannel;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = std::min((int)options.numThreads, numStencils);
+#else
+    int numThreads = 1;
+#endif
 
-        for (int j=0; j<array.numLocations; ++j) { // for each face we're working on
-            REAL  s = array.s[j],
-                  t = array.t[j]; // for each target (s,t) point on that face
+    //  Build the stencils of disjoint ranges of locations concurrently, each
+    //  into its own StencilBuilder.  More ranges than threads are used to
+    //  balance the uneven costs of locating and evaluating the patches:
+    int const minRangeSize = 1024;
 
-            PatchMap::Handle const * handle = 
-                                        patchmap.FindPatch(array.ptexIdx, s, t);
-            if (handle) {
-                ConstIndexArray cvs;
-                if (useVertexPatches) {
-                    cvs = patchtable->GetPatchVertices(*handle);
-                } else if (useFVarPatches) {
-                    cvs = patchtable->GetPatchFVarValues(*handle, fvarChannel);
-                } else {
-                    cvs = patchtable->GetPatchVaryingVertices(*handle);
-                }
+    int numRanges = 1;
+    if (numThreads > 1) {
+        numRanges = std::max(numThreads,
+                    std::min(numThreads * 8, numStencils / minRangeSize));
+    }
 
-                StencilTableReal<REAL> const & src = *cvstencils;
-                dst = origin[numLimitStencils];
+    std::vector<StencilBuilder<REAL> *> builders(numRanges, 0);
 
-                if (options.generate2ndDerivatives) {
-                    if (useVertexPatches) {
-                        patchtable->EvaluateBasis<REAL>(
-                                *handle, s, t, wP, wDs, wDt, wDss, wDst, wDtt);
-                    } else if (useFVarPatches) {
-                        patchtable->EvaluateBasisFaceVarying<REAL>(
-                                *handle, s, t, wP, wDs, wDt, wDss, wDst, wDtt, fvarChannel);
-                    } else {
-                        patchtable->EvaluateBasisVarying<REAL>(
-                                *handle, s, t, wP, wDs, wDt, wDss, wDst, wDtt);
-                    }
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(dynamic, 1)
+#endif
+    for (int i = 0; i < numRanges; ++i) {
+        int first = (int)(((long long)numStencils * i) / numRanges),
+            last  = (int)(((long long)numStencils * (i+1)) / numRanges);
+
+        builders[i] = new StencilBuilder<REAL>(nControlVertices,
+                            /*genControlVerts*/ false,
+                            /*compactWeights*/  true);
+        context.Build(*builders[i], first, last - first);
+    }
 
-                    dst.Clear();
-                    for (int k = 0; k < cvs.size(); ++k) {
-                        dst.AddWithWeight(src[cvs[k]], wP[k], wDs[k], wDt[k], wDss[k], wDst[k], wDtt[k]);
-                    }
-                } else if (options.generate1stDerivatives) {
-                    if (useVertexPatches) {
-                        patchtable->EvaluateBasis<REAL>(
-                                *handle, s, t, wP, wDs, wDt);
-                    } else if (useFVarPatches) {
-                        patchtable->EvaluateBasisFaceVarying<REAL>(
-                                *handle, s, t, wP, wDs, wDt, 0, 0, 0, fvarChannel);
-                    } else {
-                        patchtable->EvaluateBasisVarying<REAL>(
-                                *handle, s, t, wP, wDs, wDt);
-                    }
+    if (! cvStencilsIn) {
+        delete cvstencils;
+    }
 
-                    dst.Clear();
-                    for (int k = 0; k < cvs.size(); ++k) {
-                        dst.AddWithWeight(src[cvs[k]], wP[k], wDs[k], wDt[k]);
-                    }
-                } else {
-                    if (useVertexPatches) {
-                        patchtable->EvaluateBasis<REAL>(
-                                *handle, s, t, wP);
-                    } else if (useFVarPatches) {
-                        patchtable->EvaluateBasisFaceVarying<REAL>(
-                                *handle, s, t, wP, 0, 0, 0, 0, 0, fvarChannel);
-                    } else {
-                        patchtable->EvaluateBasisVarying<REAL>(
-                                *handle, s, t, wP);
-                    }
+    if (! patchTableIn) {
+        delete patchtable;
+    }
 
-                    dst.Clear();
-                    for (int k = 0; k < cvs.size(); ++k) {
-                        dst.AddWithWeight(src[cvs[k]], wP[k]);
-                    }
-                }
+    //
+    //  Copy the proto-stencils of all ranges into the presized arrays of the
+    //  limit stencil table, releasing each builder once copied:
+    //
+    std::vector<int>    stencilOffsets(numRanges + 1, 0);
+    std::vector<Offset> entryOffsets(numRanges + 1, 0);
+    for (int i = 0; i < numRanges; ++i) {
+        stencilOffsets[i+1] = stencilOffsets[i] +
+                              (int) builders[i]->GetStencilSizes().size();
+        entryOffsets[i+1] = entryOffsets[i] +
+                            (Offset) builders[i]->GetStencilSources().size();
+    }
+    int    numLimitStencils = stencilOffsets[numRanges];
+    Offset numEntries       = entryOffsets[numRanges];
+
+    bool has1st = options.generate1stDerivatives ||
+                  options.generate2ndDerivatives,
+         has2nd = options.generate2ndDerivatives;
+
+    LimitStencilTableReal<REAL> * result =
+        new LimitStencilTableReal<REAL>(nControlVertices);
+
+    result->_sizes.resize(numLimitStencils);
+    result->_offsets.resize(numLimitStencils);
+    result->_indices.resize(numEntries);
+    result->_weights.resize(numEntries);
+    if (has1st) {
+        result->_duWeights.resize(numEntries);
+        result->_dvWeights.resize(numEntries);
+    }
+    if (has2nd) {
+        result->_duuWeights.resize(numEntries);
+        result->_duvWeights.resize(numEntries);
+        result->_dvvWeights.resize(numEntries);
+    }
 
-                ++numLimitStencils;
-            }
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(dynamic, 1)
+#endif
+    for (int i = 0; i < numRanges; ++i) {
+        StencilBuilder<REAL> const & builder = *builders[i];
+
+        int    stencilOffset = stencilOffsets[i];
+        Offset entryOffset   = entryOffsets[i],
+               rangeEntries  = entryOffsets[i+1] - entryOffset;
+
+        std::vector<int> const & sizes = builder.GetStencilSizes();
+        std::vector<Offset> const & offsets = builder.GetStencilOffsets();
+        for (size_t j = 0; j < sizes.size(); ++j) {
+            result->_sizes[stencilOffset + j]   = sizes[j];
+            result->_offsets[stencilOffset + j] = entryOffset + offsets[j];
+        }
+        copyEntries(result->_indices, entryOffset,
+                    builder.GetStencilSources(), rangeEntries);
+        copyEntries(result->_weights, entryOffset,
+                    builder.GetStencilWeights(), rangeEntries);
+        if (has1st) {
+            copyEntries(result->_duWeights, entryOffset,
+                        builder.GetStencilDuWeights(), rangeEntries);
+            copyEntries(result->_dvWeights, entryOffset,
+                        builder.GetStencilDvWeights(), rangeEntries);
         }
+        if (has2nd) {
+            copyEntries(result->_duuWeights, entryOffset,
+                        builder.GetStencilDuuWeights(), rangeEntries);
+            copyEntries(result->_duvWeights, entryOffset,
+                        builder.GetStencilDuvWeights(), rangeEntries);
+            copyEntries(result->_dvvWeights, entryOffset,
+                        builder.GetStencilDvvWeights(), rangeEntries);
+        }
+
+        delete builders[i];
+        builders[i] = 0;
     }
+    result->updateMemoryStats();
+    return result;
+}
 
-    if (! cvStencilsIn) {
-        delete cvstencils;
+template <typename REAL>
+LimitStencilTableReal<REAL> const *
+LimitStencilTableFactoryReal<REAL>::Create(PatchTable const & patchTable,
+    int numLocations,
+    PatchTable::PatchHandle const * handles,
+    REAL const * s, REAL const * t,
+    Options options) {
+
+    OPENSUBDIV_TRACE_SCOPE("stencils.limit.patches");
+
+    if ((numLocations <= 0) || !handles || !s || !t) {
+        return 0;
     }
 
-    if (! patchTableIn) {
-        delete patchtable;
+    bool interpolateVertex      = (options.interpolationMode == INTERPOLATE_VERTEX);
+    bool interpolateVarying     = (options.interpolationMode == INTERPOLATE_VARYING);
+    int  fvarChannel            = options.fvarChannel;
+
+    //
+    //  As above, uniform PatchTables do not have varying patches -- use the
+    //  equivalent linear vertex patches in this case:
+    //
+    bool useVertexPatches = interpolateVertex ||
+                            (interpolateVarying && !patchTable.IsFeatureAdaptive());
+
+    ConstIndexArray points;
+    if (useVertexPatches) {
+        PatchTable::PatchVertsTable const & cvs =
+            patchTable.GetPatchControlVerticesTable();
+        points = ConstIndexArray(cvs.empty() ? 0 : &cvs[0], (int)cvs.size());
+    } else if (interpolateVarying) {
+        points = patchTable.GetVaryingVertices();
+    } else if ((fvarChannel >= 0) &&
+               (fvarChannel < patchTable.GetNumFVarChannels())) {
+        points = patchTable.GetFVarValues(fvarChannel);
     }
+    if (points.empty()) {
+        //  Missing patches for the interpolation mode
+        return 0;
+    }
+
+    int nControlVertices = 1 + *std::max_element(points.begin(), points.end());
+
+    bool generate1st = options.generate1stDerivatives;
+    bool generate2nd = options.generate2ndDerivatives;
+
+    //  2nd derivatives of the basis are only evaluated with the 1st:
+    bool evaluate1st = generate1st || generate2nd;
 
     //
-    // Copy the proto-stencils into the limit stencil table
+    //  Each stencil holds all points of its patch, so the sizes and offsets
+    //  of all stencils are known before evaluating any of their weights:
     //
-    LimitStencilTableReal<REAL> * result = new LimitStencilTableReal<REAL>(
-                                          nControlVertices,
-                                          builder.GetStencilOffsets(),
-                                          builder.GetStencilSizes(),
-                                          builder.GetStencilSources(),
-                                          builder.GetStencilWeights(),
-                                          builder.GetStencilDuWeights(),
-                                          builder.GetStencilDvWeights(),
-                                          builder.GetStencilDuuWeights(),
-                                          builder.GetStencilDuvWeights(),
-                                          builder.GetStencilDvvWeights(),
-                                          /*ctrlVerts*/false,
-                                          /*fristOffset*/0);
+    std::vector<int>    sizes(numLocations);
+    std::vector<Offset> offsets(numLocations);
+
+    Offset numEntries = 0;
+    for (int i = 0; i < numLocations; ++i) {
+        PatchTable::PatchHandle const & handle = handles[i];
+
+        int size = 0;
+        if (useVertexPatches) {
+            size = patchTable.GetPatchVertices(handle).size();
+        } else if (interpolateVarying) {
+            size = patchTable.GetPatchVaryingVertices(handle).size();
+        } else {
+            PatchParam param = patchTable.GetPatchFVarPatchParam(handle, fvarChannel);
+            size = (param.IsRegular()
+                 ? patchTable.GetFVarPatchDescriptorRegular(fvarChannel)
+                 : patchTable.GetFVarPatchDescriptorIrregular(fvarChannel)).
+                        GetNumControlVertices();
+        }
+        sizes[i]    = size;
+        offsets[i]  = numEntries;
+        numEntries += size;
+    }
+
+    std::vector<int>  sources(numEntries);
+    std::vector<REAL> weights(numEntries),
+                      duWeights(generate1st ? numEntries : 0),
+                      dvWeights(generate1st ? numEntries : 0),
+                      duuWeights(generate2nd ? numEntries : 0),
+                      duvWeights(generate2nd ? numEntries : 0),
+                      dvvWeights(generate2nd ? numEntries : 0);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = std::min((int)options.numThreads, numLocations);
+#else
+    int numThreads = 1;
+#endif
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+#endif
+    for (int i = 0; i < numLocations; ++i) {
+        PatchTable::PatchHandle const & handle = handles[i];
+
+        REAL wP[20], wDs[20], wDt[20], wDss[20], wDst[20], wDtt[20];
+
+        ConstIndexArray cvs;
+        if (useVertexPatches) {
+            patchTable.EvaluateBasis(handle, s[i], t[i], wP,
+                evaluate1st ? wDs : 0, evaluate1st ? wDt : 0,
+                generate2nd ? wDss : 0, generate2nd ? wDst : 0,
+                generate2nd ? wDtt : 0);
+            cvs = patchTable.GetPatchVertices(handle);
+        } else if (interpolateVarying) {
+            patchTable.EvaluateBasisVarying(handle, s[i], t[i], wP,
+                evaluate1st ? wDs : 0, evaluate1st ? wDt : 0,
+                generate2nd ? wDss : 0, generate2nd ? wDst : 0,
+                generate2nd ? wDtt : 0);
+            cvs = patchTable.GetPatchVaryingVertices(handle);
+        } else {
+            patchTable.EvaluateBasisFaceVarying(handle, s[i], t[i], wP,
+                evaluate1st ? wDs : 0, evaluate1st ? wDt : 0,
+                generate2nd ? wDss : 0, generate2nd ? wDst : 0,
+                generate2nd ? wDtt : 0, fvarChannel);
+            cvs = patchTable.GetPatchFVarValues(handle, fvarChannel);
+        }
+
+        Offset offset = offsets[i];
+        for (int j = 0; j < sizes[i]; ++j) {
+            sources[offset + j] = cvs[j];
+            weights[offset + j] = wP[j];
+            if (generate1st) {
+                duWeights[offset + j] = wDs[j];
+                dvWeights[offset + j] = wDt[j];
+            }
+            if (generate2nd) {
+                duuWeights[offset + j] = wDss[j];
+                duvWeights[offset + j] = wDst[j];
+                dvvWeights[offset + j] = wDtt[j];
+            }
+        }
+    }
+
+    LimitStencilTableReal<REAL> * result =
+        new LimitStencilTableReal<REAL>(nControlVertices,
+                                        offsets, sizes, sources, weights,
+                                        duWeights, dvWeights,
+                                        duuWeights, duvWeights, dvvWeights,
+                                        /*ctrlVerts*/false,
+                                        /*fristOffset*/0);
+    result->updateMemoryStats();
     return result;
 }
 
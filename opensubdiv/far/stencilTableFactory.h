@@ -37,6 +37,8 @@ namespace OPENSUBDIV_VERSION {
 namespace Far {
 
 class TopologyRefiner;
+class HierarchicalEdits;
+class BuildMonitor;
 
 template <typename REAL> class StencilReal;
 template <typename REAL> class StencilTableReal;
@@ -65,8 +67,11 @@ public:
                     generateControlVerts(false),
                     generateIntermediateLevels(true),
                     factorizeIntermediateLevels(true),
+                    factorizeByMatrixProduct(false),
                     maxLevel(10),
-                    fvarChannel(0) { }
+                    numThreads(0),
+                    fvarChannel(0),
+                    monitor(0) { }
 
         unsigned int interpolationMode           : 2, ///< interpolation mode
                      generateOffsets             : 1, ///< populate optional "_offsets" field
@@ -75,9 +80,17 @@ public:
                      factorizeIntermediateLevels : 1, ///< accumulate stencil weights from control
                                                       ///  vertices or from the stencils of the
                                                       ///  previous level
-                     maxLevel                    : 4; ///< generate stencils up to 'maxLevel'
+                     factorizeByMatrixProduct    : 1, ///< compose the factorized stencils of
+                                                      ///  each level by sparse matrix
+                                                      ///  products (see Create())
+                     maxLevel                    : 4, ///< generate stencils up to 'maxLevel'
+                     numThreads                  : 8; ///< number of threads used to factorize
+                                                      ///  the stencils of each level (0 or 1
+                                                      ///  for serial construction)
         unsigned int fvarChannel;                     ///< face-varying channel to use
                                                       ///  when generating face-varying stencils
+        BuildMonitor * monitor;                       ///< optional progress and cancellation
+                                                      ///  (see Create())
     };
 
     /// \brief Instantiates StencilTable from TopologyRefiner that have been
@@ -87,6 +100,25 @@ public:
     ///       been refined in the TopologyRefiner. Use RefineUniform() or
     ///       RefineAdaptive() before constructing the stencils.
     ///
+    /// \note When Options::numThreads is greater than 1 (and OpenMP support
+    ///       is available), the stencils of each level are factorized by
+    ///       several threads over disjoint ranges of vertices. The resulting
+    ///       table is identical to that of serial construction.
+    ///
+    /// \note When Options::factorizeByMatrixProduct is set, the stencils of
+    ///       each level are recorded as the rows of a sparse subdivision
+    ///       matrix, which is multiplied by the stencils of the previous
+    ///       levels row by row with a dense accumulator per thread.  This
+    ///       scales better than the StencilBuilder to the large stencils of
+    ///       deep levels and to many threads, at the cost of memory linear in
+    ///       the number of control vertices per thread.  The resulting table
+    ///       is identical.  It is ignored when intermediate levels are not
+    ///       factorized or hierarchical edits are applied.
+    ///
+    /// \note An optional Options::monitor is notified as each level is
+    ///       interpolated, and the construction stops -- returning 0 -- if
+    ///       it is cancelled.
+    ///
     /// @param refiner  The TopologyRefiner containing the topology
     ///
     /// @param options  Options controlling the creation of the table
@@ -94,6 +126,61 @@ public:
     static StencilTableReal<REAL> const * Create(
                 TopologyRefiner const & refiner, Options options = Options());
 
+    /// \brief Instantiates StencilTable from a TopologyRefiner refined with
+    ///        hierarchical edits.
+    ///
+    /// The vertex edits are applied as additional terms of the stencils of
+    /// their edited vertices (and so of all vertices subsequently refined
+    /// from them) when interpolating vertex data.  The control vertices of
+    /// the resulting table are those of the base level followed by the value
+    /// of each vertex edit, in the order of the edits.  Edits are ignored for
+    /// varying and face-varying interpolation.
+    ///
+    /// \note The refiner is expected to have been refined uniformly with the
+    ///       same edits (see TopologyRefiner::RefineUniform()) so that their
+    ///       sharpness edits are also applied.
+    ///
+    /// @param refiner  The TopologyRefiner containing the topology
+    ///
+    /// @param edits    The hierarchical edits of the refined levels
+    ///
+    /// @param options  Options controlling the creation of the table
+    ///
+    static StencilTableReal<REAL> const * Create(
+                TopologyRefiner const & refiner,
+                HierarchicalEdits const & edits, Options options = Options());
+
+    /// \brief Updates a StencilTable following changes to the sharpness of
+    ///        edges and vertices of the base level of its TopologyRefiner.
+    ///
+    /// Only the stencils of refined vertices whose weights depend on the
+    /// modified components are regenerated -- the immediate neighborhood of
+    /// the components in each level and the vertices supported by them in
+    /// subsequent levels -- and they are replaced in the existing table.
+    ///
+    /// \note The sharpness must already have been updated in the refiner
+    ///       (see TopologyRefiner::UpdateBaseSharpness()), and the table must
+    ///       have been created from the same refiner with the given options.
+    ///       Only tables of factorized vertex stencils are supported (varying
+    ///       stencils do not depend on sharpness and are left unchanged).
+    ///
+    /// @param refiner   The TopologyRefiner with updated sharpness
+    ///
+    /// @param table     The StencilTable to update
+    ///
+    /// @param edges     Indices of base edges whose sharpness changed
+    ///
+    /// @param vertices  Indices of base vertices whose sharpness changed
+    ///
+    /// @param options   Options with which the table was created
+    ///
+    /// @return          False if the table could not be updated
+    ///
+    static bool UpdateStencilTable(
+                TopologyRefiner const & refiner, StencilTableReal<REAL> & table,
+                ConstIndexArray edges, ConstIndexArray vertices,
+                Options options = Options());
+
 
     /// \brief Instantiates StencilTable by concatenating an array of existing
     ///        stencil tables.
@@ -110,6 +197,28 @@ public:
     static StencilTableReal<REAL> const * Create(
                 int numTables, StencilTableReal<REAL> const ** tables);
 
+    /// \brief Instantiates StencilTable by concatenating an array of existing
+    ///        stencil tables whose control vertices are located at different
+    ///        offsets of a shared source buffer.
+    ///
+    /// The control indices of each table are rebased to its offset, so that
+    /// the stencils of several meshes can be applied with a single evaluation
+    /// (or dispatch) from a buffer containing all of their control vertices
+    /// to a buffer containing all of their refined vertices -- the stencils
+    /// of each table following those of the previous one.
+    ///
+    /// @param numTables             Number of input StencilTables
+    ///
+    /// @param tables                Array of input StencilTables (which may
+    ///                              include null entries)
+    ///
+    /// @param controlVertexOffsets  Offset of the control vertices of each
+    ///                              table in the source buffer
+    ///
+    static StencilTableReal<REAL> const * Create(
+                int numTables, StencilTableReal<REAL> const ** tables,
+                Index const * controlVertexOffsets);
+
 
     /// \brief Utility function for stencil splicing for local point stencils.
     ///
@@ -178,8 +287,174 @@ public:
                 int channel = 0,
                 bool factorize = true);
 
+    /// \brief Appends the local point stencils to a stencil table in place
+    ///
+    /// Equivalent to AppendLocalPointStencilTable() above, but rather than
+    /// copying the stencils of the base table into a new table, the arrays
+    /// of the given table are grown to their exact size and the local point
+    /// stencils written after its own, which avoids the copy and the peak
+    /// memory of both tables when the base table is no longer needed.
+    ///
+    /// @param refiner              The TopologyRefiner containing the topology
+    ///
+    /// @param stencilTable         StencilTable for refined vertices, to which
+    ///                             the local point stencils are appended
+    ///
+    /// @param localPointStencilTable
+    ///                             StencilTable for the change of basis patch points.
+    ///
+    /// @param factorize            If factorize is set to true, endcap stencils will be
+    ///                             factorized with supporting vertices from the
+    ///                             stencil table.
+    ///
+    /// @return                     False (leaving the table unchanged) if there
+    ///                             are no local point stencils to append
+    ///
+    static bool AppendLocalPointStencilTable(
+                TopologyRefiner const &refiner,
+                StencilTableReal<REAL> &stencilTable,
+                StencilTableReal<REAL> const *localPointStencilTable,
+                bool factorize = true);
+
+    /// \brief Appends the local point varying stencils to a stencil table
+    ///        in place (see AppendLocalPointStencilTable())
+    static bool AppendLocalPointStencilTableVarying(
+                TopologyRefiner const &refiner,
+                StencilTableReal<REAL> &stencilTable,
+                StencilTableReal<REAL> const *localPointStencilTable,
+                bool factorize = true) {
+        return AppendLocalPointStencilTable(
+                refiner, stencilTable, localPointStencilTable, factorize);
+    }
+
+    /// \brief Appends the local point face-varying stencils to a stencil
+    ///        table in place (see AppendLocalPointStencilTable())
+    static bool AppendLocalPointStencilTableFaceVarying(
+                TopologyRefiner const &refiner,
+                StencilTableReal<REAL> &stencilTable,
+                StencilTableReal<REAL> const *localPointStencilTable,
+                int channel = 0,
+                bool factorize = true);
+
+    /// \brief Returns a copy of a stencil table with its control vertices
+    ///        renumbered for locality of the stencil gathers
+    ///
+    /// The control vertices are ordered by reverse Cuthill-McKee on the
+    /// edges of the faces of the base level, so that the stencils of nearby
+    /// refined vertices gather nearby control vertices, and the indices of
+    /// each stencil are sorted by increasing index. The order of the
+    /// stencils (and so of the refined vertices) is unchanged, as are the
+    /// indices of refined vertices in tables of unfactorized intermediate
+    /// levels.
+    ///
+    /// The control vertex data must then be supplied in the new order, i.e.
+    /// the data of control vertex i at index permutation[i].
+    ///
+    /// @param refiner              The TopologyRefiner containing the topology
+    ///
+    /// @param stencilTable         Input StencilTable (the derivative weights
+    ///                             of limit stencils are not preserved)
+    ///
+    /// @param permutation          Returns the new index of each control
+    ///                             vertex
+    ///
+    /// @param fvarChannel          face-varying channel of a face-varying
+    ///                             table, or -1 for vertex and varying tables
+    ///
+    /// Returns NULL if the number of control vertices of the table does not
+    /// match the base level of the refiner.
+    ///
+    static StencilTableReal<REAL> const * ReorderControlVertices(
+                TopologyRefiner const &refiner,
+                StencilTableReal<REAL> const *stencilTable,
+                std::vector<Index> &permutation,
+                int fvarChannel = -1);
+
+    /// \brief Returns a new stencil table with a range of the stencils of a
+    ///        table, e.g. the stencils of a single level of a table whose
+    ///        intermediate levels are not factorized
+    ///
+    /// @param stencilTable         Input StencilTable
+    ///
+    /// @param start                index of the first stencil of the range
+    ///
+    /// @param end                  index of the stencil after the range
+    ///
+    /// @param indexRemap           optional new indices of the vertices the
+    ///                             stencils refer to, indexed by their
+    ///                             indices in the table
+    ///
+    /// Returns NULL for an empty or invalid range.
+    ///
+    static StencilTableReal<REAL> const * ExtractStencils(
+                StencilTableReal<REAL> const *stencilTable,
+                int start, int end,
+                Index const *indexRemap = NULL);
+
+    /// \brief Returns a new stencil table with the given stencils of a
+    ///        table, in the given order, e.g. the stencils of only the points
+    ///        used by a subset of patches
+    ///
+    /// @param stencilTable         Input StencilTable (the derivative weights
+    ///                             of limit stencils are not preserved)
+    ///
+    /// @param numStencils          number of stencils to gather
+    ///
+    /// @param stencilIndices       indices of the stencils in the table
+    ///
+    /// Returns NULL if a stencil index is out of range.
+    ///
+    static StencilTableReal<REAL> const * GatherStencils(
+                StencilTableReal<REAL> const *stencilTable,
+                int numStencils,
+                Index const *stencilIndices);
+
+    /// \brief Splits a stencil table into independent partitions, e.g. to
+    ///        distribute its evaluation
+    ///
+    /// The stencils are ordered along a bandwidth-reducing ordering of the
+    /// control vertices (derived from the stencils themselves) and split
+    /// into partitions of balanced numbers of stencil entries, so that each
+    /// partition depends on a compact set of control vertices.  Each
+    /// partition table refers to its own control vertices and refines its
+    /// own stencils, so it can be evaluated with EvalStencils from the
+    /// gathered control vertices of the partition alone.
+    ///
+    /// @param stencilTable         Input StencilTable, factorized down to
+    ///                             the control vertices (the derivative
+    ///                             weights of limit stencils are not
+    ///                             preserved)
+    ///
+    /// @param numPartitions        Number of partitions
+    ///
+    /// @param partitionTables      Returns the numPartitions stencil tables
+    ///                             of the partitions, owned by the caller
+    ///
+    /// @param partitionSources     Returns for each partition the sorted
+    ///                             indices of the control vertices of the
+    ///                             table its control vertices correspond to
+    ///
+    /// @param partitionStencils    Returns for each partition the sorted
+    ///                             indices of the stencils of the table its
+    ///                             stencils correspond to
+    ///
+    /// Returns false if the table refers to vertices other than its control
+    /// vertices, leaving the outputs unset.
+    ///
+    static bool PartitionStencils(
+                StencilTableReal<REAL> const *stencilTable,
+                int numPartitions,
+                StencilTableReal<REAL> const *partitionTables[],
+                std::vector<Index> partitionSources[],
+                std::vector<Index> partitionStencils[]);
+
 private:
 
+    // Internal method to create stencils with optional hierarchical edits
+    static StencilTableReal<REAL> const * create(
+                TopologyRefiner const & refiner,
+                HierarchicalEdits const * edits, Options options);
+
     // Generate stencils for the coarse control-vertices (single weight = 1.0f)
     static void generateControlVertStencils(
                 int numControlVerts,
@@ -192,6 +467,16 @@ private:
                 StencilTableReal<REAL> const * localPointStencilTable,
                 int channel,
                 bool factorize);
+
+    // Splices the local point stencils after the base stencils into result,
+    // which is either a new table or the base table itself
+    static bool appendLocalPointStencils(
+                TopologyRefiner const &refiner,
+                StencilTableReal<REAL> const * baseStencilTable,
+                StencilTableReal<REAL> const * localPointStencilTable,
+                int channel,
+                bool factorize,
+                StencilTableReal<REAL> & result);
 };
 
 /// \brief A specialized factory for LimitStencilTable
@@ -221,11 +506,16 @@ public:
         Options() : interpolationMode(INTERPOLATE_VERTEX),
                     generate1stDerivatives(true),
                     generate2ndDerivatives(false),
+                    numThreads(0),
                     fvarChannel(0) { }
 
         unsigned int interpolationMode           : 2, ///< interpolation mode
                      generate1stDerivatives      : 1, ///< Generate weights for 1st derivatives
-                     generate2ndDerivatives      : 1; ///< Generate weights for 2nd derivatives
+                     generate2ndDerivatives      : 1, ///< Generate weights for 2nd derivatives
+                     numThreads                  : 8; ///< number of threads used to build
+                                                      ///< the stencils of the locations
+                                                      ///< (requires OpenMP support,
+                                                      ///< ignored otherwise)
         unsigned int fvarChannel;                     ///< face-varying channel to use
     };
 
@@ -246,6 +536,15 @@ public:
     /// \brief Instantiates LimitStencilTable from a TopologyRefiner that has
     ///        been refined either uniformly or adaptively.
     ///
+    /// \note When Options::numThreads is greater than 1 (and OpenMP support
+    ///       is available), the stencils of disjoint ranges of locations are
+    ///       built by several threads and copied into the presized arrays of
+    ///       the table, and the number of threads is also used for any
+    ///       StencilTable or PatchTable created internally. The resulting
+    ///       table is identical to that of serial construction. Weights of
+    ///       derivatives not requested by the Options are neither computed
+    ///       nor allocated.
+    ///
     /// @param refiner          The TopologyRefiner containing the topology
     ///
     /// @param locationArrays   An array of surface location descriptors
@@ -273,6 +572,47 @@ public:
                 PatchTable const * patchTable = 0,
                 Options options = Options());
 
+    /// \brief Instantiates LimitStencilTable for a fixed set of locations on
+    ///        the patches of a PatchTable
+    ///
+    /// Unlike the stencils of the factory above, which are factored in terms
+    /// of the control vertices of the refiner, each stencil here combines
+    /// the points of its patch directly, i.e. the refined and local points
+    /// indexed by the PatchTable. The table applies to the same primvar
+    /// buffer as the patch evaluation of the Osd evaluators, and so caches
+    /// their basis evaluation for locations sampled repeatedly. Each
+    /// location is then evaluated with EvalStencils() of any Osd evaluator
+    /// as a gather-multiply-add of the weights of its patch.
+    ///
+    /// Locations are expressed as the patch handles and (s,t) coordinates
+    /// of the PatchCoords of the Osd evaluators (e.g. as returned by the
+    /// PatchMap). The table refers to the PatchTable only while created.
+    ///
+    /// @param patchTable       The PatchTable containing the patches
+    ///
+    /// @param numLocations     The number of locations
+    ///
+    /// @param handles          The patch handles of the locations
+    ///
+    /// @param s                The s coordinates of the locations
+    ///
+    /// @param t                The t coordinates of the locations
+    ///
+    /// @param options          Options controlling the creation of the table
+    ///                         (the interpolation mode selects the vertex,
+    ///                         varying or face-varying patches of the table)
+    ///
+    /// @return                 The table, or NULL if there are no locations
+    ///                         or the PatchTable lacks the patches of the
+    ///                         interpolation mode
+    ///
+    static LimitStencilTableReal<REAL> const * Create(
+                PatchTable const & patchTable,
+                int numLocations,
+                PatchTable::PatchHandle const * handles,
+                REAL const * s, REAL const * t,
+                Options options = Options());
+
 };
 
 
@@ -297,6 +637,14 @@ public:
                 BaseFactory::Create(refiner, options));
     }
 
+    static StencilTable const * Create(
+                TopologyRefiner const & refiner,
+                HierarchicalEdits const & edits, Options options = Options()) {
+
+        return static_cast<StencilTable const *>(
+                BaseFactory::Create(refiner, edits, options));
+    }
+
     static StencilTable const * Create(
                 int numTables, StencilTable const ** tables) {
 
@@ -305,6 +653,16 @@ public:
                         reinterpret_cast<BaseTable const **>(tables)));
     }
 
+    static StencilTable const * Create(
+                int numTables, StencilTable const ** tables,
+                Index const * controlVertexOffsets) {
+
+        return static_cast<StencilTable const *>(
+                BaseFactory::Create(numTables,
+                        reinterpret_cast<BaseTable const **>(tables),
+                        controlVertexOffsets));
+    }
+
     static StencilTable const * AppendLocalPointStencilTable(
                 TopologyRefiner const &refiner,
                 StencilTable const *baseStencilTable,
@@ -344,6 +702,97 @@ public:
                         static_cast<BaseTable const *>(localPointStencilTable),
                         channel, factorize));
     }
+
+    static bool AppendLocalPointStencilTable(
+                TopologyRefiner const &refiner,
+                StencilTable &stencilTable,
+                StencilTable const *localPointStencilTable,
+                bool factorize = true) {
+
+        return BaseFactory::AppendLocalPointStencilTable(refiner,
+                static_cast<BaseTable &>(stencilTable),
+                static_cast<BaseTable const *>(localPointStencilTable),
+                factorize);
+    }
+
+    static bool AppendLocalPointStencilTableVarying(
+                TopologyRefiner const &refiner,
+                StencilTable &stencilTable,
+                StencilTable const *localPointStencilTable,
+                bool factorize = true) {
+
+        return BaseFactory::AppendLocalPointStencilTableVarying(refiner,
+                static_cast<BaseTable &>(stencilTable),
+                static_cast<BaseTable const *>(localPointStencilTable),
+                factorize);
+    }
+
+    static bool AppendLocalPointStencilTableFaceVarying(
+                TopologyRefiner const &refiner,
+                StencilTable &stencilTable,
+                StencilTable const *localPointStencilTable,
+                int channel = 0,
+                bool factorize = true) {
+
+        return BaseFactory::AppendLocalPointStencilTableFaceVarying(refiner,
+                static_cast<BaseTable &>(stencilTable),
+                static_cast<BaseTable const *>(localPointStencilTable),
+                channel, factorize);
+    }
+
+    static StencilTable const * ReorderControlVertices(
+                TopologyRefiner const &refiner,
+                StencilTable const *stencilTable,
+                std::vector<Index> &permutation,
+                int fvarChannel = -1) {
+
+        return static_cast<StencilTable const *>(
+                BaseFactory::ReorderControlVertices(refiner,
+                        static_cast<BaseTable const *>(stencilTable),
+                        permutation, fvarChannel));
+    }
+
+    static StencilTable const * ExtractStencils(
+                StencilTable const *stencilTable,
+                int start, int end,
+                Index const *indexRemap = NULL) {
+
+        return static_cast<StencilTable const *>(
+                BaseFactory::ExtractStencils(
+                        static_cast<BaseTable const *>(stencilTable),
+                        start, end, indexRemap));
+    }
+
+    static StencilTable const * GatherStencils(
+                StencilTable const *stencilTable,
+                int numStencils,
+                Index const *stencilIndices) {
+
+        return static_cast<StencilTable const *>(
+                BaseFactory::GatherStencils(
+                        static_cast<BaseTable const *>(stencilTable),
+                        numStencils, stencilIndices));
+    }
+
+    static bool PartitionStencils(
+                StencilTable const *stencilTable,
+                int numPartitions,
+                StencilTable const *partitionTables[],
+                std::vector<Index> partitionSources[],
+                std::vector<Index> partitionStencils[]) {
+
+        std::vector<BaseTable const *> tables(numPartitions, (BaseTable *)0);
+        if (!BaseFactory::PartitionStencils(
+                static_cast<BaseTable const *>(stencilTable), numPartitions,
+                numPartitions ? &tables[0] : 0,
+                partitionSources, partitionStencils)) {
+            return false;
+        }
+        for (int i = 0; i < numPartitions; ++i) {
+            partitionTables[i] = static_cast<StencilTable const *>(tables[i]);
+        }
+        return true;
+    }
 };
 
 class LimitStencil;
@@ -372,6 +821,18 @@ public:
                         patchTable,
                         options));
     }
+
+    static LimitStencilTable const * Create(
+                PatchTable const & patchTable,
+                int numLocations,
+                PatchTable::PatchHandle const * handles,
+                float const * s, float const * t,
+                Options options = Options()) {
+
+        return static_cast<LimitStencilTable const *>(
+                BaseFactory::Create(
+                        patchTable, numLocations, handles, s, t, options));
+    }
 };
 
 } // end namespace Far
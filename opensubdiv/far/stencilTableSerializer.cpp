@@ -0,0 +1,136 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+#include "../far/stencilTableSerializer.h"
+#include "../far/error.h"
+#include "../vtr/binaryStream.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+using Vtr::internal::BinaryHeader;
+using Vtr::internal::BinaryWriter;
+using Vtr::internal::BinaryReader;
+
+namespace {
+    //
+    //  The version must be incremented with any change to the layout of the
+    //  stencil table:
+    //
+    char const         MAGIC[8] = { 'O', 'S', 'D', 'S', 'T', 'E', 'N', '\0' };
+    unsigned int const VERSION  = 2;
+
+    template <typename REAL>
+    BinaryHeader
+    createHeader() {
+        BinaryHeader header(MAGIC, VERSION);
+
+        header.setTypeSize(0, sizeof(Index));
+        header.setTypeSize(1, sizeof(REAL));
+        header.setTypeSize(2, sizeof(Offset));
+        return header;
+    }
+}
+
+template <typename REAL>
+void
+StencilTableSerializerReal<REAL>::write(BinaryWriter & stream,
+                                        StencilTableReal<REAL> const & table) {
+
+    stream.write(createHeader<REAL>());
+    table.write(stream);
+    stream.align();
+}
+
+template <typename REAL>
+size_t
+StencilTableSerializerReal<REAL>::GetSerializedSize(
+        StencilTableReal<REAL> const & table) {
+
+    BinaryWriter stream;
+    write(stream, table);
+    return stream.getSize();
+}
+
+template <typename REAL>
+size_t
+StencilTableSerializerReal<REAL>::Serialize(
+        StencilTableReal<REAL> const & table, void * buffer, size_t bufferSize) {
+
+    BinaryWriter stream(buffer, bufferSize);
+    write(stream, table);
+
+    if (!buffer || !stream.isValid()) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in StencilTableSerializer::Serialize() -- "
+            "buffer too small for stencil table.");
+        return 0;
+    }
+    return stream.getSize();
+}
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+StencilTableSerializerReal<REAL>::Deserialize(void const * buffer,
+                                              size_t bufferSize) {
+
+    BinaryReader stream(buffer, bufferSize);
+
+    BinaryHeader header;
+    if (!stream.read(header) || !header.isCompatible(createHeader<REAL>())) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in StencilTableSerializer::Deserialize() -- "
+            "buffer not written by a compatible version of the library.");
+        return 0;
+    }
+
+    StencilTableReal<REAL> * table = new StencilTableReal<REAL>();
+    //  The trailing padding must also be present to not accept a buffer
+    //  truncated within it:
+    bool isValid = table->read(stream);
+    stream.align();
+
+    if (!isValid || !stream.isValid()) {
+        delete table;
+
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in StencilTableSerializer::Deserialize() -- "
+            "invalid or truncated buffer.");
+        return 0;
+    }
+    table->updateMemoryStats();
+    return table;
+}
+
+//
+//  Explicit instantiation for float and double:
+//
+template class StencilTableSerializerReal<float>;
+template class StencilTableSerializerReal<double>;
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,634 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/topologyCache.h"
+#include "../far/buildMonitor.h"
+#include "../far/topologyRefinerSerializer.h"
+#include "../far/patchTableSerializer.h"
+#include "../far/stencilTableSerializer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+//
+//  TopologyKey:
+//
+std::string
+TopologyKey::GetString() const {
+
+    static char const digits[] = "0123456789abcdef";
+
+    std::string str(32, '0');
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 16; ++j) {
+            str[i * 16 + j] = digits[(_words[i] >> (60 - 4 * j)) & 0xf];
+        }
+    }
+    return str;
+}
+
+//
+//  TopologyHasher:
+//
+//  The hash follows the 128-bit variant of MurmurHash3, processing the data
+//  a 64-bit word at a time on two lanes.  Each block appended is padded to a
+//  whole number of words and followed by its size, so that the hash of a
+//  sequence of blocks cannot be confused with that of a different sequence.
+//
+namespace {
+    unsigned long long const C1 = 0x87c37b91114253d5ULL;
+    unsigned long long const C2 = 0x4cf5ad432745937fULL;
+
+    inline unsigned long long
+    rotl(unsigned long long x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline unsigned long long
+    fmix(unsigned long long k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    //  The kind of table addressed by a key, and the version of the contents
+    //  hashed (to be incremented with any change to them):
+    enum KeyKind {
+        KEY_REFINER_UNIFORM  = 1,
+        KEY_REFINER_ADAPTIVE = 2,
+        KEY_PATCH_TABLE      = 3,
+        KEY_STENCIL_TABLE    = 4
+    };
+    unsigned int const KEY_VERSION = 3;
+
+    //  Hashes an optional array, distinguishing absent arrays from empty ones
+    template <typename T>
+    void
+    appendArray(TopologyHasher & hasher, T const * array, int size) {
+        hasher.Append(array != 0);
+        if (array && (size > 0)) {
+            hasher.Append(array, size * sizeof(T));
+        }
+    }
+}
+
+TopologyHasher::TopologyHasher() : _size(0) {
+    _h[0] = _h[1] = 0;
+}
+
+inline void
+TopologyHasher::appendWord(unsigned long long k) {
+
+    unsigned long long k1 = rotl(k * C1, 31) * C2;
+    _h[0] ^= k1;
+    _h[0]  = rotl(_h[0], 27) + _h[1];
+    _h[0]  = _h[0] * 5 + 0x52dce729;
+
+    unsigned long long k2 = rotl(k * C2, 33) * C1;
+    _h[1] ^= k2;
+    _h[1]  = rotl(_h[1], 31) + _h[0];
+    _h[1]  = _h[1] * 5 + 0x38495ab5;
+}
+
+void
+TopologyHasher::Append(void const * data, size_t size) {
+
+    unsigned char const * bytes = static_cast<unsigned char const *>(data);
+
+    size_t numWords = size / sizeof(unsigned long long);
+    for (size_t i = 0; i < numWords; ++i) {
+        unsigned long long word;
+        std::memcpy(&word, bytes + i * sizeof(word), sizeof(word));
+        appendWord(word);
+    }
+
+    size_t tail = size - numWords * sizeof(unsigned long long);
+    if (tail) {
+        unsigned long long word = 0;
+        std::memcpy(&word, bytes + numWords * sizeof(word), tail);
+        appendWord(word);
+    }
+    appendWord(size);
+
+    _size += size;
+}
+
+void
+TopologyHasher::Append(TopologyKey const & key) {
+
+    appendWord(key._words[0]);
+    appendWord(key._words[1]);
+    _size += sizeof(key._words);
+}
+
+TopologyKey
+TopologyHasher::GetKey() const {
+
+    unsigned long long h0 = _h[0] ^ _size;
+    unsigned long long h1 = _h[1] ^ _size;
+
+    h0 += h1;
+    h1 += h0;
+
+    h0 = fmix(h0);
+    h1 = fmix(h1);
+
+    h0 += h1;
+    h1 += h0;
+
+    TopologyKey key;
+    key._words[0] = h0;
+    key._words[1] = h1;
+    return key;
+}
+
+void
+TopologyHasher::Append(TopologyDescriptor const & desc) {
+
+    Append(desc.numVertices);
+    Append(desc.numFaces);
+
+    int numFaceVerts = 0;
+    if (desc.numVertsPerFace) {
+        for (int i = 0; i < desc.numFaces; ++i) {
+            numFaceVerts += desc.numVertsPerFace[i];
+        }
+    }
+    appendArray(*this, desc.numVertsPerFace, desc.numFaces);
+    appendArray(*this, desc.vertIndicesPerFace, numFaceVerts);
+
+    Append(desc.numCreases);
+    appendArray(*this, desc.creaseVertexIndexPairs, 2 * desc.numCreases);
+    appendArray(*this, desc.creaseWeights, desc.numCreases);
+
+    Append(desc.numCorners);
+    appendArray(*this, desc.cornerVertexIndices, desc.numCorners);
+    appendArray(*this, desc.cornerWeights, desc.numCorners);
+
+    Append(desc.numHoles);
+    appendArray(*this, desc.holeIndices, desc.numHoles);
+
+    Append(desc.isLeftHanded);
+
+    Append(desc.fvarChannels ? desc.numFVarChannels : 0);
+    for (int i = 0; desc.fvarChannels && (i < desc.numFVarChannels); ++i) {
+        Append(desc.fvarChannels[i].numValues);
+        appendArray(*this, desc.fvarChannels[i].valueIndices, numFaceVerts);
+    }
+}
+
+void
+TopologyHasher::Append(TopologyRefinerFactory<TopologyDescriptor>::Options const & options) {
+
+    int fields[5] = { options.schemeType,
+                      options.schemeOptions.GetVtxBoundaryInterpolation(),
+                      options.schemeOptions.GetFVarLinearInterpolation(),
+                      options.schemeOptions.GetCreasingMethod(),
+                      options.schemeOptions.GetTriangleSubdivision() };
+    Append(fields, sizeof(fields));
+}
+
+void
+TopologyHasher::Append(TopologyRefiner::UniformOptions const & options) {
+
+    int fields[5] = { (int) options.refinementLevel,
+                      (int) options.orderVerticesFromFacesFirst,
+                      (int) options.orderVerticesByFaces,
+                      (int) options.fullTopologyInLastLevel,
+                      (int) options.pruneHoles };
+    Append(fields, sizeof(fields));
+}
+
+void
+TopologyHasher::Append(TopologyRefiner::AdaptiveOptions const & options) {
+
+    int fields[10] = { (int) options.isolationLevel,
+                       (int) options.secondaryLevel,
+                       (int) options.useSingleCreasePatch,
+                       (int) options.useDoubleCreasePatch,
+                       (int) options.useInfSharpPatch,
+                       (int) options.considerFVarChannels,
+                       (int) options.orderVerticesFromFacesFirst,
+                       (int) options.orderVerticesByFaces,
+                       options.maxVertices,
+                       options.maxFaces };
+    Append(fields, sizeof(fields));
+    Append((unsigned long long) options.maxMemory);
+}
+
+void
+TopologyHasher::Append(PatchTableFactory::Options const & options) {
+
+    int fields[22] = { (int) options.generateAllLevels,
+                       (int) options.includeBaseLevelIndices,
+                       (int) options.includeFVarBaseLevelIndices,
+                       (int) options.triangulateQuads,
+                       (int) options.useSingleCreasePatch,
+                       (int) options.useDoubleCreasePatch,
+                       (int) options.useInfSharpPatch,
+                       (int) options.maxIsolationLevel,
+                       (int) options.endCapType,
+                       (int) options.shareEndCapPatchPoints,
+                       (int) options.approxEndCapsWithBSpline,
+                       (int) options.maxApproxEndCapValenceDeviation,
+                       (int) options.generateVaryingTables,
+                       (int) options.generateVaryingLocalPoints,
+                       (int) options.generateFVarTables,
+                       (int) options.patchPrecisionDouble,
+                       (int) options.fvarPatchPrecisionDouble,
+                       (int) options.generateFVarLegacyLinearPatches,
+                       (int) options.generateLegacySharpCornerPatches,
+                       (int) options.spatialPatchOrder,
+                       (int) options.generatePtexFacePatches,
+                       options.numFVarChannels };
+    Append(fields, sizeof(fields));
+    appendArray(*this, options.fvarChannelIndices,
+                std::max(options.numFVarChannels, 0));
+}
+
+template <class OPTIONS>
+void
+TopologyHasher::appendStencilOptions(OPTIONS const & options) {
+
+    int fields[7] = { (int) options.interpolationMode,
+                      (int) options.generateOffsets,
+                      (int) options.generateControlVerts,
+                      (int) options.generateIntermediateLevels,
+                      (int) options.factorizeIntermediateLevels,
+                      (int) options.maxLevel,
+                      (int) options.fvarChannel };
+    Append(fields, sizeof(fields));
+}
+
+void
+TopologyHasher::Append(StencilTableFactoryReal<float>::Options const & options) {
+    appendStencilOptions(options);
+}
+
+void
+TopologyHasher::Append(StencilTableFactoryReal<double>::Options const & options) {
+    appendStencilOptions(options);
+}
+
+//
+//  TopologyCache stores:
+//
+struct TopologyCache::MemoryStore::Buffers {
+    std::map<TopologyKey, std::vector<char> > buffers;
+    std::mutex                                mutex;
+};
+
+TopologyCache::MemoryStore::MemoryStore() : _buffers(new Buffers) {
+}
+
+TopologyCache::MemoryStore::~MemoryStore() {
+    delete _buffers;
+}
+
+bool
+TopologyCache::MemoryStore::Read(TopologyKey const & key,
+                                 std::vector<char> & buffer) {
+
+    std::lock_guard<std::mutex> lock(_buffers->mutex);
+
+    std::map<TopologyKey, std::vector<char> >::const_iterator it =
+        _buffers->buffers.find(key);
+    if (it == _buffers->buffers.end()) return false;
+
+    buffer = it->second;
+    return true;
+}
+
+void
+TopologyCache::MemoryStore::Write(TopologyKey const & key,
+                                  void const * buffer, size_t size) {
+
+    char const * bytes = static_cast<char const *>(buffer);
+    std::vector<char> contents(bytes, bytes + size);
+
+    std::lock_guard<std::mutex> lock(_buffers->mutex);
+    _buffers->buffers[key].swap(contents);
+}
+
+void
+TopologyCache::MemoryStore::Clear() {
+
+    std::lock_guard<std::mutex> lock(_buffers->mutex);
+    _buffers->buffers.clear();
+}
+
+size_t
+TopologyCache::MemoryStore::GetMemoryUsage() const {
+
+    std::lock_guard<std::mutex> lock(_buffers->mutex);
+
+    size_t size = 0;
+    std::map<TopologyKey, std::vector<char> >::const_iterator it;
+    for (it = _buffers->buffers.begin(); it != _buffers->buffers.end(); ++it) {
+        size += it->second.size();
+    }
+    return size;
+}
+
+std::string
+TopologyCache::FileStore::getPath(TopologyKey const & key) const {
+
+    std::string path = _directory;
+    if (!path.empty() && (path[path.size()-1] != '/')) {
+        path += '/';
+    }
+    return path + key.GetString() + ".osd";
+}
+
+bool
+TopologyCache::FileStore::Read(TopologyKey const & key,
+                               std::vector<char> & buffer) {
+
+    FILE * file = fopen(getPath(key).c_str(), "rb");
+    if (!file) return false;
+
+    bool success = (fseek(file, 0, SEEK_END) == 0);
+    long size = success ? ftell(file) : -1;
+    success = (size > 0) && (fseek(file, 0, SEEK_SET) == 0);
+    if (success) {
+        buffer.resize(size);
+        success = (fread(&buffer[0], 1, size, file) == (size_t) size);
+    }
+    fclose(file);
+    return success;
+}
+
+void
+TopologyCache::FileStore::Write(TopologyKey const & key,
+                                void const * buffer, size_t size) {
+
+    //  Write to a name unique to this thread and process, so that the file
+    //  only appears under its final name once complete:
+    std::string path = getPath(key);
+
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%zx.%llx",
+        std::hash<std::thread::id>()(std::this_thread::get_id()),
+        (unsigned long long)
+            std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    std::string tmpPath = path + suffix;
+
+    FILE * file = fopen(tmpPath.c_str(), "wb");
+    if (!file) return;
+
+    bool success = (fwrite(buffer, 1, size, file) == size);
+    success = (fclose(file) == 0) && success;
+
+    if (!success || (std::rename(tmpPath.c_str(), path.c_str()) != 0)) {
+        std::remove(tmpPath.c_str());
+    }
+}
+
+//
+//  TopologyCache:
+//
+namespace {
+    inline void
+    refine(TopologyRefiner & refiner, TopologyRefiner::UniformOptions const & options) {
+        refiner.RefineUniform(options);
+    }
+    inline void
+    refine(TopologyRefiner & refiner, TopologyRefiner::AdaptiveOptions const & options) {
+        refiner.RefineAdaptive(options);
+    }
+
+    inline KeyKind
+    getRefinerKeyKind(TopologyRefiner::UniformOptions const &) {
+        return KEY_REFINER_UNIFORM;
+    }
+    inline KeyKind
+    getRefinerKeyKind(TopologyRefiner::AdaptiveOptions const &) {
+        return KEY_REFINER_ADAPTIVE;
+    }
+}
+
+struct TopologyCache::Counters {
+    Counters() : numHits(0), numMisses(0) { }
+
+    std::atomic<int> numHits;
+    std::atomic<int> numMisses;
+};
+
+TopologyCache::TopologyCache(Store & store) :
+    _store(store), _counters(new Counters) {
+}
+
+TopologyCache::~TopologyCache() {
+    delete _counters;
+}
+
+int
+TopologyCache::GetNumHits() const {
+    return _counters->numHits;
+}
+
+int
+TopologyCache::GetNumMisses() const {
+    return _counters->numMisses;
+}
+
+template <class SERIALIZER, class TABLE>
+void
+TopologyCache::write(TopologyKey const & key, TABLE const & table) {
+
+    std::vector<char> buffer(SERIALIZER::GetSerializedSize(table));
+    if (!buffer.empty() &&
+        SERIALIZER::Serialize(table, &buffer[0], buffer.size())) {
+        _store.Write(key, &buffer[0], buffer.size());
+    }
+}
+
+template <class REFINE_OPTIONS>
+TopologyRefiner *
+TopologyCache::createRefiner(TopologyDescriptor const & desc,
+                             RefinerOptions const & options,
+                             REFINE_OPTIONS const & refineOptions,
+                             TopologyKey * keyPtr) {
+
+    TopologyHasher hasher;
+    hasher.Append(KEY_VERSION);
+    hasher.Append((int) getRefinerKeyKind(refineOptions));
+    hasher.Append(desc);
+    hasher.Append(options);
+    hasher.Append(refineOptions);
+
+    TopologyKey key = hasher.GetKey();
+    if (keyPtr) *keyPtr = key;
+
+    std::vector<char> buffer;
+    if (_store.Read(key, buffer) && !buffer.empty()) {
+        TopologyRefiner * refiner =
+            TopologyRefinerSerializer::Deserialize(&buffer[0], buffer.size());
+        if (refiner) {
+            ++_counters->numHits;
+            return refiner;
+        }
+    }
+
+    TopologyRefiner * refiner =
+        TopologyRefinerFactory<TopologyDescriptor>::Create(desc, options);
+    if (!refiner) return 0;
+
+    refine(*refiner, refineOptions);
+
+    //  A cancelled refinement is incomplete and not stored:
+    if (refineOptions.monitor && refineOptions.monitor->IsCancelled()) {
+        delete refiner;
+        return 0;
+    }
+
+    write<TopologyRefinerSerializer>(key, *refiner);
+    ++_counters->numMisses;
+    return refiner;
+}
+
+TopologyRefiner *
+TopologyCache::CreateRefiner(TopologyDescriptor const & desc,
+                             RefinerOptions const & options,
+                             TopologyRefiner::UniformOptions const & refineOptions,
+                             TopologyKey * key) {
+
+    return createRefiner(desc, options, refineOptions, key);
+}
+
+TopologyRefiner *
+TopologyCache::CreateRefiner(TopologyDescriptor const & desc,
+                             RefinerOptions const & options,
+                             TopologyRefiner::AdaptiveOptions const & refineOptions,
+                             TopologyKey * key) {
+
+    return createRefiner(desc, options, refineOptions, key);
+}
+
+PatchTable *
+TopologyCache::CreatePatchTable(TopologyKey const & refinerKey,
+                                TopologyRefiner const & refiner,
+                                PatchTableFactory::Options const & options,
+                                ConstIndexArray selectedFaces) {
+
+    TopologyHasher hasher;
+    hasher.Append(KEY_VERSION);
+    hasher.Append((int) KEY_PATCH_TABLE);
+    hasher.Append(refinerKey);
+    hasher.Append(options);
+    hasher.Append(selectedFaces.size());
+    if (selectedFaces.size()) {
+        hasher.Append(&selectedFaces[0], selectedFaces.size() * sizeof(Index));
+    }
+    TopologyKey key = hasher.GetKey();
+
+    std::vector<char> buffer;
+    if (_store.Read(key, buffer) && !buffer.empty()) {
+        PatchTable * table =
+            PatchTableSerializer::Deserialize(&buffer[0], buffer.size());
+        if (table) {
+            ++_counters->numHits;
+            return table;
+        }
+    }
+
+    PatchTable * table =
+        PatchTableFactory::Create(refiner, options, selectedFaces);
+    if (!table) return 0;
+
+    write<PatchTableSerializer>(key, *table);
+    ++_counters->numMisses;
+    return table;
+}
+
+template <typename REAL>
+StencilTableReal<REAL> const *
+TopologyCache::createStencilTable(TopologyKey const & refinerKey,
+                                  TopologyRefiner const & refiner,
+                                  typename StencilTableFactoryReal<REAL>::Options const & options) {
+
+    TopologyHasher hasher;
+    hasher.Append(KEY_VERSION);
+    hasher.Append((int) KEY_STENCIL_TABLE);
+    hasher.Append((int) sizeof(REAL));
+    hasher.Append(refinerKey);
+    hasher.Append(options);
+    TopologyKey key = hasher.GetKey();
+
+    std::vector<char> buffer;
+    if (_store.Read(key, buffer) && !buffer.empty()) {
+        StencilTableReal<REAL> const * table =
+            StencilTableSerializerReal<REAL>::Deserialize(&buffer[0],
+                                                          buffer.size());
+        if (table) {
+            ++_counters->numHits;
+            return table;
+        }
+    }
+
+    StencilTableReal<REAL> const * table =
+        StencilTableFactoryReal<REAL>::Create(refiner, options);
+    if (!table) return 0;
+
+    write< StencilTableSerializerReal<REAL> >(key, *table);
+    ++_counters->numMisses;
+    return table;
+}
+
+StencilTable const *
+TopologyCache::CreateStencilTable(TopologyKey const & refinerKey,
+                                  TopologyRefiner const & refiner,
+                                  StencilTableFactoryReal<float>::Options const & options) {
+
+    return static_cast<StencilTable const *>(
+        createStencilTable<float>(refinerKey, refiner, options));
+}
+
+StencilTableReal<double> const *
+TopologyCache::CreateStencilTable(TopologyKey const & refinerKey,
+                                  TopologyRefiner const & refiner,
+                                  StencilTableFactoryReal<double>::Options const & options) {
+
+    return createStencilTable<double>(refinerKey, refiner, options);
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,346 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_TOPOLOGY_CACHE_H
+#define OPENSUBDIV3_FAR_TOPOLOGY_CACHE_H
+
+#include "../version.h"
+
+#include "../far/topologyDescriptor.h"
+#include "../far/topologyRefiner.h"
+#include "../far/patchTableFactory.h"
+#include "../far/stencilTableFactory.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+///
+/// \brief A 128-bit hash identifying the content of a topology and the
+///        options applied to it
+///
+/// Keys are only intended to be compared within the same build of the
+/// library on the same platform (as with the serialized tables they address),
+/// as they depend on the byte order of the host and the layout of the tables.
+///
+class TopologyKey {
+public:
+    TopologyKey() { _words[0] = _words[1] = 0; }
+
+    bool operator==(TopologyKey const & other) const {
+        return (_words[0] == other._words[0]) && (_words[1] == other._words[1]);
+    }
+    bool operator!=(TopologyKey const & other) const {
+        return !(*this == other);
+    }
+    bool operator<(TopologyKey const & other) const {
+        return (_words[0] != other._words[0]) ? (_words[0] < other._words[0])
+                                              : (_words[1] < other._words[1]);
+    }
+
+    /// \brief Returns the key as a string of 32 hexadecimal digits
+    std::string GetString() const;
+
+private:
+    friend class TopologyHasher;
+
+    unsigned long long _words[2];
+};
+
+///
+/// \brief Accumulates the hash of a topology and the options applied to it
+///
+/// The options are hashed field by field, excluding those that do not affect
+/// the resulting tables (the number of threads used to build them, the use of
+/// an arena or extra validation).  Arrays are hashed by content, so that two
+/// descriptors of the same topology hash identically regardless of where
+/// their arrays are stored.
+///
+class TopologyHasher {
+public:
+    TopologyHasher();
+
+    /// \brief Hashes a block of plain data
+    void Append(void const * data, size_t size);
+
+    /// \brief Hashes a plain value
+    template <typename T>
+    void Append(T const & value) { Append(&value, sizeof(T)); }
+
+    /// \brief Hashes the topology of a descriptor
+    void Append(TopologyDescriptor const & desc);
+
+    /// \brief Hashes the scheme and options of a TopologyRefinerFactory
+    void Append(TopologyRefinerFactory<TopologyDescriptor>::Options const & options);
+
+    /// \brief Hashes the options of uniform refinement
+    void Append(TopologyRefiner::UniformOptions const & options);
+
+    /// \brief Hashes the options of adaptive refinement
+    void Append(TopologyRefiner::AdaptiveOptions const & options);
+
+    /// \brief Hashes the options of a PatchTableFactory
+    void Append(PatchTableFactory::Options const & options);
+
+    /// \brief Hashes the options of a StencilTableFactory
+    void Append(StencilTableFactoryReal<float>::Options const & options);
+
+    /// \brief Hashes the options of a StencilTableFactory
+    void Append(StencilTableFactoryReal<double>::Options const & options);
+
+    /// \brief Hashes a previously computed key
+    void Append(TopologyKey const & key);
+
+    /// \brief Returns the key of everything appended so far
+    TopologyKey GetKey() const;
+
+private:
+    void appendWord(unsigned long long word);
+
+    template <class OPTIONS> void appendStencilOptions(OPTIONS const & options);
+
+    unsigned long long _h[2];
+    unsigned long long _size;
+};
+
+///
+/// \brief A content-addressed cache of refiners and the tables built from
+///        them
+///
+/// The cache avoids rebuilding the TopologyRefiner, PatchTable and
+/// StencilTable of a topology that has already been processed, e.g. when the
+/// same asset is loaded many times by separate sessions or processes.  Each
+/// is addressed by a TopologyKey hashing the topology and all options that
+/// contributed to it, and stored in serialized form (see
+/// TopologyRefinerSerializer, PatchTableSerializer and StencilTableSerializer)
+/// by a pluggable Store -- in memory or in a directory shared by processes.
+///
+/// The refiner and tables returned are new instances owned by the caller,
+/// as with the factories that build them on a miss.  The cache may be used
+/// concurrently by several threads if its Store may.
+///
+/// \code
+///   Far::TopologyKey key;
+///   Far::TopologyRefiner * refiner =
+///       cache.CreateRefiner(desc, refinerOptions, adaptiveOptions, &key);
+///
+///   Far::PatchTable * patchTable =
+///       cache.CreatePatchTable(key, *refiner, patchOptions);
+/// \endcode
+///
+class TopologyCache {
+public:
+
+    /// \brief Interface of the storage of serialized tables
+    class Store {
+    public:
+        virtual ~Store() { }
+
+        /// \brief Reads the buffer stored for a key, returns false if none
+        virtual bool Read(TopologyKey const & key,
+                          std::vector<char> & buffer) = 0;
+
+        /// \brief Stores the buffer of a key
+        virtual void Write(TopologyKey const & key,
+                           void const * buffer, size_t size) = 0;
+    };
+
+    /// \brief Store keeping the serialized tables in memory
+    class MemoryStore : public Store {
+    public:
+        MemoryStore();
+        virtual ~MemoryStore();
+
+        virtual bool Read(TopologyKey const & key, std::vector<char> & buffer);
+        virtual void Write(TopologyKey const & key,
+                           void const * buffer, size_t size);
+
+        /// \brief Releases all stored tables
+        void Clear();
+
+        /// \brief Returns the total size of the stored tables
+        size_t GetMemoryUsage() const;
+
+    private:
+        //  Not copyable:
+        MemoryStore(MemoryStore const &);
+        MemoryStore & operator=(MemoryStore const &);
+
+        //  The stored buffers and the lock guarding them (defined privately)
+        struct Buffers;
+
+        Buffers * _buffers;
+    };
+
+    /// \brief Store keeping the serialized tables in files of a directory
+    ///
+    /// Each table is written to a file named after its key.  Files are
+    /// written under a temporary name and renamed when complete, so that
+    /// several processes may share the directory.
+    ///
+    class FileStore : public Store {
+    public:
+        /// \brief Constructor
+        ///
+        /// @param directory  An existing directory holding the files
+        ///
+        FileStore(std::string const & directory) : _directory(directory) { }
+
+        virtual bool Read(TopologyKey const & key, std::vector<char> & buffer);
+        virtual void Write(TopologyKey const & key,
+                           void const * buffer, size_t size);
+
+    private:
+        std::string getPath(TopologyKey const & key) const;
+
+        std::string _directory;
+    };
+
+public:
+
+    typedef TopologyRefinerFactory<TopologyDescriptor>::Options RefinerOptions;
+
+    /// \brief Constructor
+    ///
+    /// @param store  The storage of the tables (not owned)
+    ///
+    TopologyCache(Store & store);
+
+    /// \brief Destructor
+    ~TopologyCache();
+
+    /// \brief Returns a new refiner for the descriptor refined uniformly
+    ///
+    /// @param desc           The topology of the base level
+    ///
+    /// @param options        The options of the TopologyRefinerFactory
+    ///
+    /// @param refineOptions  The options of uniform refinement
+    ///
+    /// @param key            Optional key of the refiner to address the
+    ///                       tables built from it
+    ///
+    /// @return               A new refiner or 0 if the topology is invalid
+    ///
+    TopologyRefiner * CreateRefiner(TopologyDescriptor const & desc,
+                                    RefinerOptions const & options,
+                                    TopologyRefiner::UniformOptions const & refineOptions,
+                                    TopologyKey * key = 0);
+
+    /// \brief Returns a new refiner for the descriptor refined adaptively
+    ///
+    /// @param desc           The topology of the base level
+    ///
+    /// @param options        The options of the TopologyRefinerFactory
+    ///
+    /// @param refineOptions  The options of adaptive refinement
+    ///
+    /// @param key            Optional key of the refiner to address the
+    ///                       tables built from it
+    ///
+    /// @return               A new refiner or 0 if the topology is invalid
+    ///
+    TopologyRefiner * CreateRefiner(TopologyDescriptor const & desc,
+                                    RefinerOptions const & options,
+                                    TopologyRefiner::AdaptiveOptions const & refineOptions,
+                                    TopologyKey * key = 0);
+
+    /// \brief Returns a new patch table of a refiner
+    ///
+    /// @param refinerKey     The key of the refiner returned by CreateRefiner()
+    ///
+    /// @param refiner        The refiner
+    ///
+    /// @param options        The options of the PatchTableFactory
+    ///
+    /// @param selectedFaces  Only create patches for the given set of base faces
+    ///
+    PatchTable * CreatePatchTable(TopologyKey const & refinerKey,
+                                  TopologyRefiner const & refiner,
+                                  PatchTableFactory::Options const & options,
+                                  ConstIndexArray selectedFaces = ConstIndexArray());
+
+    /// \brief Returns a new stencil table of a refiner
+    ///
+    /// @param refinerKey     The key of the refiner returned by CreateRefiner()
+    ///
+    /// @param refiner        The refiner
+    ///
+    /// @param options        The options of the StencilTableFactory
+    ///
+    StencilTable const * CreateStencilTable(TopologyKey const & refinerKey,
+                                            TopologyRefiner const & refiner,
+                                            StencilTableFactoryReal<float>::Options const & options);
+
+    /// \brief Returns a new double precision stencil table of a refiner
+    StencilTableReal<double> const * CreateStencilTable(TopologyKey const & refinerKey,
+                                            TopologyRefiner const & refiner,
+                                            StencilTableFactoryReal<double>::Options const & options);
+
+    /// \brief Returns the number of refiners and tables read from the store
+    int GetNumHits() const;
+
+    /// \brief Returns the number of refiners and tables built and stored
+    int GetNumMisses() const;
+
+private:
+    //  Not copyable:
+    TopologyCache(TopologyCache const &);
+    TopologyCache & operator=(TopologyCache const &);
+
+    template <class REFINE_OPTIONS>
+    TopologyRefiner * createRefiner(TopologyDescriptor const & desc,
+                                    RefinerOptions const & options,
+                                    REFINE_OPTIONS const & refineOptions,
+                                    TopologyKey * key);
+
+    template <typename REAL>
+    StencilTableReal<REAL> const * createStencilTable(TopologyKey const & refinerKey,
+                                    TopologyRefiner const & refiner,
+                                    typename StencilTableFactoryReal<REAL>::Options const & options);
+
+    template <class SERIALIZER, class TABLE>
+    void write(TopologyKey const & key, TABLE const & table);
+
+private:
+    Store & _store;
+
+    //  The counts of hits and misses, updated concurrently (defined privately)
+    struct Counters;
+
+    Counters * _counters;
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_TOPOLOGY_CACHE_H */
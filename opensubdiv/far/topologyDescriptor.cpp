@@ -29,6 +29,7 @@
 #include "../vtr/level.h"
 
 #include <cstdio>
+#include <cstring>
 #ifdef _MSC_VER
     #define snprintf _snprintf
 #endif
@@ -70,21 +71,24 @@ bool
 TopologyRefinerFactory<TopologyDescriptor>::assignComponentTopology(
     TopologyRefiner & refiner, TopologyDescriptor const & desc) {
 
+    //  Face-vertices of right-handed faces are stored contiguously in the same
+    //  order as the base level, so are assigned with a single copy:
+    if (!desc.isLeftHanded) {
+        int numFaceVerts = refiner.getLevel(0).getNumFaceVerticesTotal();
+
+        std::memcpy(&getBaseFaceVertices(refiner, 0)[0], desc.vertIndicesPerFace,
+                    numFaceVerts * sizeof(Index));
+        return true;
+    }
+
     for (int face=0, idx=0; face<desc.numFaces; ++face) {
 
         IndexArray dstFaceVerts = getBaseFaceVertices(refiner, face);
 
-        if (desc.isLeftHanded) {
-            dstFaceVerts[0] = desc.vertIndicesPerFace[idx++];
-            for (int vert=dstFaceVerts.size()-1; vert > 0; --vert) {
+        dstFaceVerts[0] = desc.vertIndicesPerFace[idx++];
+        for (int vert=dstFaceVerts.size()-1; vert > 0; --vert) {
 
-                dstFaceVerts[vert] = desc.vertIndicesPerFace[idx++];
-            }
-        } else {
-            for (int vert=0; vert<dstFaceVerts.size(); ++vert) {
-
-                dstFaceVerts[vert] = desc.vertIndicesPerFace[idx++];
-            }
+            dstFaceVerts[vert] = desc.vertIndicesPerFace[idx++];
         }
     }
     return true;
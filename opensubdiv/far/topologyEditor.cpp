@@ -0,0 +1,352 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/topologyEditor.h"
+#include "../far/ptexIndices.h"
+#include "../far/topologyDescriptor.h"
+#include "../far/trace.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+TopologyEditor::TopologyEditor(Sdc::SchemeType schemeType,
+                               Sdc::Options schemeOptions,
+                               Options options) :
+    _schemeType(schemeType),
+    _schemeOptions(schemeOptions),
+    _options(options),
+    _numVertices(0),
+    _baseRefiner(0) {
+
+    _options.regionSize = std::max(_options.regionSize, 1);
+
+    //  Face-varying data is not supported:
+    _options.refineOptions.considerFVarChannels = false;
+    _options.patchOptions.generateFVarTables = false;
+}
+
+TopologyEditor::~TopologyEditor() {
+
+    for (int i = 0; i < (int)_regions.size(); ++i) {
+        delete _regions[i].patchTable;
+        delete _regions[i].stencilTable;
+    }
+    delete _baseRefiner;
+}
+
+void
+TopologyEditor::editFace(Index face) {
+
+    _editedFaces.push_back(face);
+    _editedVertices.insert(_editedVertices.end(),
+                           _faces[face].begin(), _faces[face].end());
+}
+
+Index
+TopologyEditor::AddFace(int numVertices, Index const vertices[]) {
+
+    if (numVertices < 3) return INDEX_INVALID;
+    for (int i = 0; i < numVertices; ++i) {
+        if (vertices[i] < 0) return INDEX_INVALID;
+        _numVertices = std::max(_numVertices, vertices[i] + 1);
+    }
+
+    Index face = (Index)_faces.size();
+    _faces.push_back(std::vector<Index>(vertices, vertices + numVertices));
+    editFace(face);
+    return face;
+}
+
+void
+TopologyEditor::RemoveFace(Index face) {
+
+    assert(face >= 0 && face < GetNumFaces());
+
+    Index lastFace = GetNumFaces() - 1;
+
+    //  The neighbors of the vertices of the face removed are affected, as
+    //  well as the regions of both slots:
+    editFace(face);
+    _editedFaces.push_back(lastFace);
+
+    if (face != lastFace) {
+        _faces[face].swap(_faces[lastFace]);
+    }
+    _faces.pop_back();
+}
+
+Index
+TopologyEditor::MergeFaces(Index face0, Index face1) {
+
+    assert(face0 >= 0 && face0 < GetNumFaces());
+    assert(face1 >= 0 && face1 < GetNumFaces());
+
+    if (face0 == face1) return INDEX_INVALID;
+
+    std::vector<Index> const & verts0 = _faces[face0];
+    std::vector<Index> const & verts1 = _faces[face1];
+    int n0 = (int)verts0.size();
+    int n1 = (int)verts1.size();
+
+    //  Find the edge (a, b) of face0 traversed as (b, a) by face1, and
+    //  reject faces sharing any other vertex:
+    int edge0 = -1, edge1 = -1;
+    int numShared = 0;
+    for (int i = 0; i < n0; ++i) {
+        for (int j = 0; j < n1; ++j) {
+            if (verts0[i] != verts1[j]) continue;
+
+            ++numShared;
+            if (verts0[(i + 1) % n0] == verts1[(j + n1 - 1) % n1]) {
+                edge0 = i;
+                edge1 = (j + n1 - 1) % n1;
+            }
+        }
+    }
+    if ((numShared != 2) || (edge0 < 0)) return INDEX_INVALID;
+
+    //  The merged face follows face0 from b around to a, then face1 from
+    //  the vertex after a around to the vertex before b:
+    std::vector<Index> merged;
+    merged.reserve(n0 + n1 - 2);
+    for (int i = 1; i <= n0; ++i) {
+        merged.push_back(verts0[(edge0 + i) % n0]);
+    }
+    for (int j = 2; j < n1; ++j) {
+        merged.push_back(verts1[(edge1 + j) % n1]);
+    }
+
+    editFace(face0);
+    _faces[face0].swap(merged);
+
+    //  The merged face is moved if it is the last face:
+    Index lastFace = GetNumFaces() - 1;
+    RemoveFace(face1);
+    return (face0 == lastFace) ? face1 : face0;
+}
+
+void
+TopologyEditor::GetRegionFaces(int region, Index * firstFace,
+                               int * numFaces) const {
+
+    *firstFace = region * _options.regionSize;
+    *numFaces = std::min(_options.regionSize, GetNumFaces() - *firstFace);
+}
+
+bool
+TopologyEditor::Update() {
+
+    OPENSUBDIV_TRACE_SCOPE("topologyEditor.update");
+
+    //
+    //  Rebuild the base level from the faces:
+    //
+    int numFaces = GetNumFaces();
+
+    std::vector<int> numVertsPerFace(numFaces);
+    std::vector<Index> vertIndicesPerFace;
+    for (int face = 0; face < numFaces; ++face) {
+        numVertsPerFace[face] = (int)_faces[face].size();
+        vertIndicesPerFace.insert(vertIndicesPerFace.end(),
+                                  _faces[face].begin(), _faces[face].end());
+    }
+
+    TopologyDescriptor desc;
+    desc.numVertices = _numVertices;
+    desc.numFaces = numFaces;
+    desc.numVertsPerFace = numFaces ? &numVertsPerFace[0] : 0;
+    desc.vertIndicesPerFace = numFaces ? &vertIndicesPerFace[0] : 0;
+
+    typedef TopologyRefinerFactory<TopologyDescriptor> RefinerFactory;
+
+    TopologyRefiner * baseRefiner = RefinerFactory::Create(desc,
+        RefinerFactory::Options(_schemeType, _schemeOptions));
+    if (!baseRefiner) return false;
+
+    TopologyLevel const & baseLevel = baseRefiner->GetLevel(0);
+
+    //
+    //  Find the regions to rebuild -- all of them on the first update, else
+    //  those of the slots of the faces edited, and those containing faces
+    //  within two rings of the vertices of the faces edited:
+    //
+    int regionSize = _options.regionSize;
+    int numRegions = (numFaces + regionSize - 1) / regionSize;
+
+    std::vector<bool> regionsToBuild(numRegions, _baseRefiner == 0);
+    for (int i = (int)_regions.size(); i < numRegions; ++i) {
+        regionsToBuild[i] = true;
+    }
+    for (int i = 0; i < (int)_editedFaces.size(); ++i) {
+        int region = _editedFaces[i] / regionSize;
+        if (region < numRegions) {
+            regionsToBuild[region] = true;
+        }
+    }
+
+    std::vector<bool> firstRing(numFaces, false);
+    std::vector<Index> firstRingFaces;
+    for (int i = 0; i < (int)_editedVertices.size(); ++i) {
+        Index vertex = _editedVertices[i];
+        if (vertex >= _numVertices) continue;
+
+        ConstIndexArray vertFaces = baseLevel.GetVertexFaces(vertex);
+        for (int j = 0; j < vertFaces.size(); ++j) {
+            if (!firstRing[vertFaces[j]]) {
+                firstRing[vertFaces[j]] = true;
+                firstRingFaces.push_back(vertFaces[j]);
+            }
+        }
+    }
+    for (int i = 0; i < (int)firstRingFaces.size(); ++i) {
+        ConstIndexArray faceVerts =
+            baseLevel.GetFaceVertices(firstRingFaces[i]);
+        for (int j = 0; j < faceVerts.size(); ++j) {
+            ConstIndexArray vertFaces = baseLevel.GetVertexFaces(faceVerts[j]);
+            for (int k = 0; k < vertFaces.size(); ++k) {
+                regionsToBuild[vertFaces[k] / regionSize] = true;
+            }
+        }
+    }
+
+    //
+    //  Build the tables of these regions, each refined on its own refiner
+    //  sharing the base level, with the faces of the region and their
+    //  neighbors selected so that the transitions of the patches at the
+    //  border of the region match those of the whole mesh:
+    //
+    std::vector<Region> regions(numRegions);
+    std::vector<bool> selected(numFaces, false);
+    std::vector<Index> selectedFaces;
+    std::vector<Index> regionFaces;
+
+    bool success = true;
+    for (int region = 0; region < numRegions; ++region) {
+        if (!regionsToBuild[region]) continue;
+
+        Index firstFace = region * regionSize;
+        Index lastFace = std::min(firstFace + regionSize, numFaces);
+
+        regionFaces.clear();
+        selectedFaces.clear();
+        for (Index face = firstFace; face < lastFace; ++face) {
+            regionFaces.push_back(face);
+
+            ConstIndexArray faceVerts = baseLevel.GetFaceVertices(face);
+            for (int j = 0; j < faceVerts.size(); ++j) {
+                ConstIndexArray vertFaces =
+                    baseLevel.GetVertexFaces(faceVerts[j]);
+                for (int k = 0; k < vertFaces.size(); ++k) {
+                    if (!selected[vertFaces[k]]) {
+                        selected[vertFaces[k]] = true;
+                        selectedFaces.push_back(vertFaces[k]);
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < (int)selectedFaces.size(); ++i) {
+            selected[selectedFaces[i]] = false;
+        }
+
+        TopologyRefiner * refiner = RefinerFactory::Create(*baseRefiner);
+        refiner->RefineAdaptive(_options.refineOptions,
+            ConstIndexArray(&selectedFaces[0], (int)selectedFaces.size()));
+
+        regions[region].patchTable = PatchTableFactory::CreateRegion(
+            *refiner, _options.patchOptions,
+            ConstIndexArray(&regionFaces[0], (int)regionFaces.size()),
+            &regions[region].stencilTable);
+        regions[region].updated = true;
+        delete refiner;
+
+        if (!regions[region].patchTable) {
+            success = false;
+            break;
+        }
+    }
+
+    if (!success) {
+        for (int region = 0; region < numRegions; ++region) {
+            delete regions[region].patchTable;
+            delete regions[region].stencilTable;
+        }
+        delete baseRefiner;
+        return false;
+    }
+
+    //
+    //  Keep the tables of the other regions, shifting the ptex indices of
+    //  their patches when the ptex faces preceding them were renumbered:
+    //
+    PtexIndices ptexIndices(*baseRefiner);
+
+    for (int region = 0; region < numRegions; ++region) {
+        Region & newRegion = regions[region];
+        Index ptexBase = ptexIndices.GetFaceId(region * regionSize);
+
+        if (!regionsToBuild[region]) {
+            newRegion = _regions[region];
+            newRegion.updated = false;
+            _regions[region].patchTable = 0;
+            _regions[region].stencilTable = 0;
+
+            Index ptexShift = ptexBase - newRegion.ptexBase;
+            if (ptexShift) {
+                PatchParamTable & params = newRegion.patchTable->_paramTable;
+                for (int i = 0; i < (int)params.size(); ++i) {
+                    PatchParam & param = params[i];
+                    param.Set(param.GetFaceId() + ptexShift,
+                              param.GetU(), param.GetV(), param.GetDepth(),
+                              param.NonQuadRoot(), param.GetBoundary(),
+                              param.GetTransition(), param.IsRegular());
+                }
+            }
+        }
+        newRegion.ptexBase = ptexBase;
+        newRegion.patchTable->_numPtexFaces = ptexIndices.GetNumFaces();
+    }
+
+    for (int i = 0; i < (int)_regions.size(); ++i) {
+        delete _regions[i].patchTable;
+        delete _regions[i].stencilTable;
+    }
+    _regions.swap(regions);
+
+    delete _baseRefiner;
+    _baseRefiner = baseRefiner;
+
+    _editedVertices.clear();
+    _editedFaces.clear();
+    return true;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,215 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_TOPOLOGY_EDITOR_H
+#define OPENSUBDIV3_FAR_TOPOLOGY_EDITOR_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+#include "../far/topologyRefiner.h"
+#include "../far/patchTable.h"
+#include "../far/patchTableFactory.h"
+#include "../far/stencilTable.h"
+#include "../sdc/options.h"
+#include "../sdc/types.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+///
+/// \brief An editable base level whose patches are rebuilt incrementally
+///
+/// The faces of the base level are edited by AddFace(), RemoveFace() and
+/// MergeFaces(), e.g. by a modeling tool, and Update() then rebuilds only the
+/// patches the edits affect.  The base faces are divided into regions of
+/// consecutive faces, each with its own PatchTable and the stencils of its
+/// patch points -- as created by PatchTableFactory::CreateRegion(), i.e.
+/// factorized to the control vertices -- so that the tables of the regions
+/// not affected by the edits are kept as they are.
+///
+/// The patches of a face depend on the faces incident to its vertices, and
+/// their transitions on the refinement of the faces adjacent to it, so a
+/// region is rebuilt when it contains a face within two rings of the
+/// vertices of an edited face.  Each region is refined adaptively on its own
+/// refiner sharing the new base level, with the faces of the region and
+/// their neighbors selected -- the SparseSelector then limits refinement to
+/// the neighborhood of the region.  The patch parameterization of the regions
+/// kept is shifted when edits renumber the ptex faces preceding them.
+///
+/// The base level itself is rebuilt from the faces on each Update(), as its
+/// construction is linear in the size of the mesh and much cheaper than the
+/// refinement and tables it replaces.
+///
+/// Vertices are never renumbered: a vertex left without faces remains as an
+/// isolated vertex of the base level.  Faces are removed by moving the last
+/// face into their place, so removals renumber the last face.  Face-varying
+/// data, creases and corners are not supported.
+///
+class TopologyEditor {
+public:
+
+    struct Options {
+
+        Options() : refineOptions(2), regionSize(256) { }
+
+        TopologyRefiner::AdaptiveOptions refineOptions; ///< adaptive refinement
+        PatchTableFactory::Options       patchOptions;  ///< patch tables
+        int                              regionSize;    ///< faces per region
+    };
+
+    /// \brief Constructor of an empty base level
+    ///
+    /// @param schemeType     The subdivision scheme
+    ///
+    /// @param schemeOptions  The options of the subdivision scheme
+    ///
+    /// @param options        The options of the refinement and patch tables
+    ///                       (end caps other than legacy Gregory patches)
+    ///
+    TopologyEditor(Sdc::SchemeType schemeType,
+                   Sdc::Options schemeOptions = Sdc::Options(),
+                   Options options = Options());
+
+    ~TopologyEditor();
+
+    /// \name Editing of the base level
+    /// @{
+
+    /// \brief Returns the number of vertices, i.e. one more than the largest
+    ///        vertex index of a face added so far
+    int GetNumVertices() const { return _numVertices; }
+
+    /// \brief Returns the number of faces
+    int GetNumFaces() const { return (int)_faces.size(); }
+
+    /// \brief Returns the vertices of a face
+    ConstIndexArray GetFaceVertices(Index face) const {
+        return ConstIndexArray(&_faces[face][0], (int)_faces[face].size());
+    }
+
+    /// \brief Adds a face, returning its index
+    Index AddFace(int numVertices, Index const vertices[]);
+
+    /// \brief Removes a face, moving the last face into its place
+    void RemoveFace(Index face);
+
+    /// \brief Merges two faces sharing a single edge into one face without
+    ///        that edge
+    ///
+    /// The merged face replaces the first face and the second face is
+    /// removed, moving the last face into its place.
+    ///
+    /// @return  The index of the merged face, or INDEX_INVALID if the faces
+    ///          do not share exactly one edge (and no other vertex)
+    ///
+    Index MergeFaces(Index face0, Index face1);
+
+    /// @}
+
+    /// \name Incremental update of the tables
+    /// @{
+
+    /// \brief Rebuilds the base level and the tables of the regions affected
+    ///        by the edits since the last update (of all the regions on the
+    ///        first update).
+    ///
+    /// @return  false if the topology of the base level is invalid, in which
+    ///          case the tables are left as they were and the edits remain
+    ///          pending
+    ///
+    bool Update();
+
+    /// \brief Returns the unrefined refiner of the base level of the last
+    ///        update (or 0 before the first update)
+    TopologyRefiner const * GetBaseRefiner() const { return _baseRefiner; }
+
+    /// \brief Returns the number of regions
+    int GetNumRegions() const { return (int)_regions.size(); }
+
+    /// \brief Returns the first base face and the number of faces of a region
+    void GetRegionFaces(int region, Index * firstFace, int * numFaces) const;
+
+    /// \brief Returns the patch table of a region, whose patch points are
+    ///        those of the stencils of GetRegionStencilTable()
+    PatchTable const * GetRegionPatchTable(int region) const {
+        return _regions[region].patchTable;
+    }
+
+    /// \brief Returns the stencils of the patch points of a region,
+    ///        factorized to the control vertices (or 0 if it has no patches)
+    StencilTable const * GetRegionStencilTable(int region) const {
+        return _regions[region].stencilTable;
+    }
+
+    /// \brief Returns true if the tables of a region were rebuilt by the last
+    ///        update, e.g. to upload only those
+    bool IsRegionUpdated(int region) const { return _regions[region].updated; }
+
+    /// @}
+
+private:
+    //  Non-copyable:
+    TopologyEditor(TopologyEditor const &);
+    TopologyEditor & operator=(TopologyEditor const &);
+
+    struct Region {
+        Region() : patchTable(0), stencilTable(0), ptexBase(0),
+                   updated(false) { }
+
+        PatchTable *         patchTable;
+        StencilTable const * stencilTable;
+        Index                ptexBase;      // ptex index of the first face
+        bool                 updated;
+    };
+
+    void editFace(Index face);
+
+    Sdc::SchemeType _schemeType;
+    Sdc::Options    _schemeOptions;
+    Options         _options;
+
+    int _numVertices;
+    std::vector<std::vector<Index> > _faces;
+
+    //  Edits pending until the next update:
+    std::vector<Index> _editedVertices;
+    std::vector<Index> _editedFaces;
+
+    TopologyRefiner *   _baseRefiner;
+    std::vector<Region> _regions;
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_TOPOLOGY_EDITOR_H */
@@ -120,6 +120,51 @@ public:
     Index FindEdge(Index v0, Index v1) const { return _level->findEdge(v0, v1); }
     //@}
 
+    //@{
+    /// @name Methods to access the topological relations of all components at once:
+    ///
+    /// The incident components of all vertices are stored in a single array, located
+    /// for each vertex by a pair of integers -- the number of incident components
+    /// followed by the offset of the first.  These arrays are returned as stored
+    /// (without copying) and are valid for the lifetime of the level.  Note that in
+    /// refined levels the offsets are not necessarily contiguous, i.e. the offset of
+    /// one vertex is not always the offset plus count of the previous one, so the
+    /// count should always be used to bound the incident components of a vertex.
+    ///
+
+    /// \brief Access the vertex pairs of all edges (two per edge)
+    ConstIndexArray GetEdgeVertexIndices() const { return _level->getEdgeVertices(); }
+
+    /// \brief Access the (count, offset) pairs of all vertex-faces (two per vertex)
+    ConstIndexArray GetVertexFaceCountsAndOffsets() const { return _level->getVertexFaceCountsAndOffsets(); }
+
+    /// \brief Access the incident faces of all vertices
+    ConstIndexArray GetVertexFaceIndices() const  { return _level->getVertexFaces(); }
+
+    /// \brief Access the (count, offset) pairs of all vertex-edges (two per vertex)
+    ConstIndexArray GetVertexEdgeCountsAndOffsets() const { return _level->getVertexEdgeCountsAndOffsets(); }
+
+    /// \brief Access the incident edges of all vertices
+    ConstIndexArray GetVertexEdgeIndices() const  { return _level->getVertexEdges(); }
+
+    /// \brief Compute the vertices adjacent to each vertex in compressed row form
+    ///
+    /// The neighbors of vertex v are written to indices[offsets[v]] through
+    /// indices[offsets[v+1]-1], ordered as the incident edges of v.  Unlike the
+    /// relations above, this is computed and copied on each call.
+    ///
+    /// @param offsets  Resized to the number of vertices plus one
+    ///
+    /// @param indices  Resized to the total number of adjacent vertices
+    ///
+    /// @return         The total number of adjacent vertices
+    ///
+    int GetVertexVertexAdjacency(std::vector<Index> & offsets,
+                                 std::vector<Index> & indices) const {
+        return _level->gatherVertexVertices(offsets, indices);
+    }
+    //@}
+
     //@{
     /// @name Methods to inspect other topological properties of individual components:
     ///
@@ -216,6 +261,14 @@ public:
         return _level->doesFaceFVarTopologyMatch(f, channel);
     }
 
+    /// \brief Return if face-varying topology of the entire channel matches,
+    /// i.e. each value is associated with a single vertex and is interpolated
+    /// as the vertex (the values of refined levels are then indexed as their
+    /// vertices and the face-varying data may be refined as vertex data)
+    bool DoesFVarChannelTopologyMatch(int channel = 0) const {
+        return _level->doesFVarChannelTopologyMatch(channel);
+    }
+
     //@}
 
     //@{
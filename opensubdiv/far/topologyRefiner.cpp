@@ -22,12 +22,19 @@
 //   language governing permissions and limitations under the Apache License.
 //
 #include "../far/topologyRefiner.h"
+#include "../far/buildMonitor.h"
+#include "../far/topologyRefinerFactory.h"
+#include "../far/hierarchicalEdits.h"
 #include "../far/error.h"
+#include "../far/trace.h"
 #include "../vtr/fvarLevel.h"
 #include "../vtr/sparseSelector.h"
 #include "../vtr/quadRefinement.h"
 #include "../vtr/triRefinement.h"
+#include "../vtr/arena.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 
@@ -37,6 +44,16 @@ namespace OPENSUBDIV_VERSION {
 
 namespace Far {
 
+//
+//  The base level and the count of instances sharing it:
+//
+struct TopologyRefiner::SharedBaseLevel {
+    SharedBaseLevel() : numReferences(1) { }
+
+    Vtr::internal::Level level;
+    std::atomic<int>     numReferences;
+};
+
 //
 //  Relatively trivial construction/destruction -- the base level (level[0]) needs
 //  to be explicitly initialized after construction and refinement then applied
@@ -49,6 +66,8 @@ TopologyRefiner::TopologyRefiner(Sdc::SchemeType schemeType, Sdc::Options scheme
     _hasIrregFaces(false),
     _regFaceSize(Sdc::SchemeTypeTraits::GetRegularFaceSize(schemeType)),
     _maxLevel(0),
+    _isCompact(false),
+    _isRepeatable(false),
     _uniformOptions(0),
     _adaptiveOptions(0),
     _totalVertices(0),
@@ -56,12 +75,14 @@ TopologyRefiner::TopologyRefiner(Sdc::SchemeType schemeType, Sdc::Options scheme
     _totalFaces(0),
     _totalFaceVertices(0),
     _maxValence(0),
-    _baseLevelOwned(true) {
+    _baseLevel(new SharedBaseLevel),
+    _arena(0) {
 
     //  Need to revisit allocation scheme here -- want to use smart-ptrs for these
-    //  but will probably have to settle for explicit new/delete...
+    //  but will probably have to settle for explicit new/delete (other than for
+    //  the base level, which is shared by reference count between copies)...
     _levels.reserve(10);
-    _levels.push_back(new Vtr::internal::Level);
+    _levels.push_back(&_baseLevel->level);
     _farLevels.reserve(10);
     assembleFarLevels();
 }
@@ -80,28 +101,70 @@ TopologyRefiner::TopologyRefiner(TopologyRefiner const & source) :
     _hasIrregFaces(source._hasIrregFaces),
     _regFaceSize(source._regFaceSize),
     _maxLevel(0),
+    _isCompact(false),
+    _isRepeatable(false),
     _uniformOptions(0),
     _adaptiveOptions(0),
-    _baseLevelOwned(false) {
+    _baseLevel(source._baseLevel),
+    _arena(0) {
+
+    ++_baseLevel->numReferences;
 
     _levels.reserve(10);
-    _levels.push_back(source._levels[0]);
+    _levels.push_back(&_baseLevel->level);
     initializeInventory();
 
     _farLevels.reserve(10);
     assembleFarLevels();
+
+    updateMemoryStats();
 }
 
 
 TopologyRefiner::~TopologyRefiner() {
 
-    for (int i=0; i<(int)_levels.size(); ++i) {
-        if ((i > 0) || _baseLevelOwned) delete _levels[i];
+    for (int i=1; i<(int)_levels.size(); ++i) {
+        delete _levels[i];
     }
 
     for (int i=0; i<(int)_refinements.size(); ++i) {
         delete _refinements[i];
     }
+
+    //  The arena must be released after the levels allocated from it:
+    delete _arena;
+
+    //  The base level is released with the last instance sharing it:
+    if (--_baseLevel->numReferences == 0) {
+        delete _baseLevel;
+    }
+}
+
+size_t
+TopologyRefiner::GetMemoryUsage() const {
+
+    size_t bytes = sizeof(*this) +
+        _levels.capacity()      * sizeof(Vtr::internal::Level *) +
+        _refinements.capacity() * sizeof(Vtr::internal::Refinement *) +
+        _farLevels.capacity()   * sizeof(TopologyLevel);
+
+    for (int i=0; i<(int)_levels.size(); ++i) {
+        bytes += _levels[i]->getMemoryUsage();
+    }
+    for (int i=0; i<(int)_refinements.size(); ++i) {
+        bytes += _refinements[i]->getMemoryUsage();
+    }
+    bytes += _clampedFaces.capacity()      * sizeof(Index) +
+             _clampedFaceLevels.capacity() * sizeof(int);
+    return bytes;
+}
+
+void
+TopologyRefiner::updateMemoryStats() {
+
+    if (internal::MemoryStats::IsReporting()) {
+        _memoryStats.Update(MEMORY_TOPOLOGY_REFINER, this, GetMemoryUsage());
+    }
 }
 
 void
@@ -119,7 +182,161 @@ TopologyRefiner::Unrefine() {
     }
     _refinements.clear();
 
+    _clampedFaces.clear();
+    _clampedFaceLevels.clear();
+
+    if (_arena) {
+        _arena->clear();
+    }
+    _isCompact = false;
+
     assembleFarLevels();
+
+    updateMemoryStats();
+}
+
+//
+//  Discarding all levels of a refinement stopped by its BuildMonitor:
+//
+void
+TopologyRefiner::cancelRefinement() {
+
+    Unrefine();
+    _maxLevel = 0;
+}
+
+//
+//  Discarding the levels of a previous refinement beyond those retained by a
+//  new refinement -- all are discarded (and the arena cleared) if none:
+//
+void
+TopologyRefiner::truncateRefinements(int numRefinements) {
+
+    if (numRefinements == 0) {
+        Unrefine();
+        return;
+    }
+    if (numRefinements == (int)_refinements.size()) return;
+
+    for (int i = numRefinements; i < (int)_refinements.size(); ++i) {
+        delete _refinements[i];
+        delete _levels[i + 1];
+    }
+    _refinements.resize(numRefinements);
+
+    std::vector<Vtr::internal::Level *> retainedLevels(_levels.begin() + 1,
+                                          _levels.begin() + numRefinements + 1);
+    _levels.resize(1);
+    initializeInventory();
+    for (int i = 0; i < numRefinements; ++i) {
+        appendLevel(*retainedLevels[i]);
+    }
+    assembleFarLevels();
+}
+
+void
+TopologyRefiner::Compact(CompactOptions options) {
+
+    if (_refinements.empty()) return;
+
+    OPENSUBDIV_TRACE_SCOPE("refine.compact");
+
+    //  Levels and refinements are retained (with their component counts) to
+    //  preserve the inventory and face-varying value counts of all levels:
+    int numReleased = (int)_levels.size() - (options.keepLastLevel ? 2 : 1);
+
+    for (int i = 1; i <= numReleased; ++i) {
+        _levels[i]->releaseTopology();
+    }
+    for (int i = 0; i < (int)_refinements.size(); ++i) {
+        _refinements[i]->releaseMappings();
+    }
+
+    //  All arena allocations are released only when no level refers to them:
+    if (_arena && !options.keepLastLevel) {
+        _arena->clear();
+    }
+    _isCompact = true;
+
+    updateMemoryStats();
+}
+
+//
+//  Updating sharpness of the base level and propagating it to refined levels:
+//
+bool
+TopologyRefiner::UpdateBaseSharpness(ConstIndexArray edges, float const * edgeSharpness,
+                                     ConstIndexArray vertices, float const * vertexSharpness) {
+
+    if (!_isUniform && _refinements.size()) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in TopologyRefiner::UpdateBaseSharpness() -- "
+            "refinement is adaptive.");
+        return false;
+    }
+    if (GetNumFVarChannels()) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in TopologyRefiner::UpdateBaseSharpness() -- "
+            "face-varying channels are present.");
+        return false;
+    }
+    if (_isCompact) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in TopologyRefiner::UpdateBaseSharpness() -- "
+            "refined topology has been compacted.");
+        return false;
+    }
+    if (_refinements.size() && !_isRepeatable) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in TopologyRefiner::UpdateBaseSharpness() -- "
+            "refinement applied hierarchical edits.");
+        return false;
+    }
+    if (_baseLevel->numReferences > 1) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in TopologyRefiner::UpdateBaseSharpness() -- "
+            "base level is shared with other instances.");
+        return false;
+    }
+
+    Vtr::internal::Level & baseLevel = getLevel(0);
+
+    for (int i = 0; i < edges.size(); ++i) {
+        if ((edges[i] < 0) || (edges[i] >= baseLevel.getNumEdges())) {
+            Error(FAR_RUNTIME_ERROR,
+                "Failure in TopologyRefiner::UpdateBaseSharpness() -- "
+                "edge %d is out of range.", edges[i]);
+            return false;
+        }
+    }
+    for (int i = 0; i < vertices.size(); ++i) {
+        if ((vertices[i] < 0) || (vertices[i] >= baseLevel.getNumVertices())) {
+            Error(FAR_RUNTIME_ERROR,
+                "Failure in TopologyRefiner::UpdateBaseSharpness() -- "
+                "vertex %d is out of range.", vertices[i]);
+            return false;
+        }
+    }
+
+    for (int i = 0; i < edges.size(); ++i) {
+        baseLevel.getEdgeSharpness(edges[i]) = edgeSharpness[i];
+    }
+    for (int i = 0; i < vertices.size(); ++i) {
+        baseLevel.getVertexSharpness(vertices[i]) = vertexSharpness[i];
+    }
+
+    //
+    //  Re-apply the boundary sharpening and tagging of the base level, then the
+    //  propagation of tags and subdivision of sharpness for each refinement:
+    //
+    if (!TopologyRefinerFactoryBase::prepareComponentTagsAndSharpness(*this)) {
+        return false;
+    }
+    for (int i = 0; i < (int)_refinements.size(); ++i) {
+        _refinements[i]->propagateComponentTags();
+        _refinements[i]->subdivideSharpnessValues();
+    }
+    return true;
 }
 
 
@@ -220,23 +437,51 @@ TopologyRefiner::GetNumFVarValuesTotal(int channel) const {
 void
 TopologyRefiner::RefineUniform(UniformOptions options) {
 
+    refineUniform(options, 0);
+    updateMemoryStats();
+}
+
+void
+TopologyRefiner::RefineUniform(UniformOptions options,
+                               HierarchicalEdits const & edits) {
+
+    refineUniform(options, &edits);
+    updateMemoryStats();
+}
+
+void
+TopologyRefiner::refineUniform(UniformOptions options,
+                               HierarchicalEdits const * edits) {
+
     if (_levels[0]->getNumVertices() == 0) {
         Error(FAR_RUNTIME_ERROR,
             "Failure in TopologyRefiner::RefineUniform() -- base level is uninitialized.");
         return;
     }
-    if (_refinements.size()) {
-        Error(FAR_RUNTIME_ERROR,
-            "Failure in TopologyRefiner::RefineUniform() -- previous refinements already applied.");
-        return;
+
+    OPENSUBDIV_TRACE_SCOPE("refine.uniform");
+
+    //
+    //  Retain the levels of a previous refinement unaffected by the options,
+    //  completing the last if it lacks the topology to be refined further:
+    //
+    int numReused = getNumReusableRefinements(options, edits);
+
+    truncateRefinements(numReused);
+
+    if (numReused && ((numReused < (int)options.refinementLevel) ||
+                      options.fullTopologyInLastLevel)) {
+        CompleteLastLevelTopology();
     }
 
     //
     //  Allocate the stack of levels and the refinements between them:
     //
     _uniformOptions = options;
+    _uniformOptions.monitor = 0;
 
     _isUniform = true;
+    _isRepeatable = (edits == 0);
     _maxLevel = options.refinementLevel;
 
     Sdc::Split splitType = Sdc::SchemeTypeTraits::GetTopologicalSplitType(_subdivType);
@@ -244,16 +489,37 @@ TopologyRefiner::RefineUniform(UniformOptions options) {
     //
     //  Initialize refinement options for Vtr -- adjusting full-topology for the last level:
     //
+    //  When pruning holes, each level is refined sparsely from the faces that
+    //  are not holes -- children of hole faces are then only created in the
+    //  neighborhoods needed to refine the vertices of the remaining faces:
+    //
+    bool pruneHoles = options.pruneHoles && HasHoles();
+
     Vtr::internal::Refinement::Options refineOptions;
-    refineOptions._sparse         = false;
-    refineOptions._faceVertsFirst = options.orderVerticesFromFacesFirst;
+    refineOptions._sparse            = pruneHoles;
+    refineOptions._faceVertsFirst    = options.orderVerticesFromFacesFirst;
+    refineOptions._orderVertsByFaces = options.orderVerticesByFaces;
+    refineOptions._numThreads        = options.numThreads;
+
+    if (options.useArena && !_arena) {
+        _arena = internal::NewArena();
+    }
+
+    for (int i = numReused + 1; i <= (int)options.refinementLevel; ++i) {
+        OPENSUBDIV_TRACE_SCOPE_INDEXED("refine.level", i);
+
+        if (options.monitor && !options.monitor->Progress(
+                BuildMonitor::STAGE_REFINE,
+                (float)(i - 1) / (float)options.refinementLevel)) {
+            cancelRefinement();
+            return;
+        }
 
-    for (int i = 1; i <= (int)options.refinementLevel; ++i) {
         refineOptions._minimalTopology =
             options.fullTopologyInLastLevel ? false : (i == (int)options.refinementLevel);
 
         Vtr::internal::Level& parentLevel = getLevel(i-1);
-        Vtr::internal::Level& childLevel  = *(new Vtr::internal::Level);
+        Vtr::internal::Level& childLevel  = *(new Vtr::internal::Level(_arena));
 
         Vtr::internal::Refinement* refinement = 0;
         if (splitType == Sdc::SPLIT_TO_QUADS) {
@@ -261,12 +527,74 @@ TopologyRefiner::RefineUniform(UniformOptions options) {
         } else {
             refinement = new Vtr::internal::TriRefinement(parentLevel, childLevel, _subdivOptions);
         }
+
+        if (pruneHoles) {
+            Vtr::internal::SparseSelector selector(*refinement);
+            for (Index face = 0; face < parentLevel.getNumFaces(); ++face) {
+                if (!parentLevel.isFaceHole(face)) {
+                    selector.selectFace(face);
+                }
+            }
+            if (selector.isSelectionEmpty()) {
+                delete refinement;
+                delete &childLevel;
+                break;
+            }
+        }
         refinement->refine(refineOptions);
 
         appendLevel(childLevel);
         appendRefinement(*refinement);
+
+        //  Sharpness edits are only of consequence to levels still to be refined:
+        if (edits && (i < (int)options.refinementLevel)) {
+            edits->applySharpnessEdits(*this, i);
+        }
     }
+    _maxLevel = (unsigned int) _refinements.size();
+
     assembleFarLevels();
+
+    if (options.monitor) {
+        options.monitor->Progress(BuildMonitor::STAGE_REFINE, 1.0f);
+    }
+}
+
+int
+TopologyRefiner::getNumReusableRefinements(UniformOptions const & options,
+                                           HierarchicalEdits const * edits) const {
+
+    //  Levels are the same when refined with the same vertex ordering (the
+    //  last level of the previous refinement may lack some topology, which
+    //  is completed as needed):
+    if (_refinements.empty() || !_isUniform || !_isRepeatable || edits ||
+        _isCompact || _arena) {
+        return 0;
+    }
+    if ((options.orderVerticesFromFacesFirst !=
+            _uniformOptions.orderVerticesFromFacesFirst) ||
+        (options.orderVerticesByFaces != _uniformOptions.orderVerticesByFaces) ||
+        (options.pruneHoles != _uniformOptions.pruneHoles)) {
+        return 0;
+    }
+    return std::min((int)_refinements.size(), (int)options.refinementLevel);
+}
+
+void
+TopologyRefiner::CompleteLastLevelTopology() const {
+
+    if (_refinements.empty() || _isCompact) return;
+
+    Vtr::internal::Level const & lastLevel = *_levels.back();
+    if ((lastLevel.getNumVertexEdgesTotal() > 0) || (lastLevel.getNumVertices() == 0)) {
+        return;
+    }
+
+    OPENSUBDIV_TRACE_SCOPE_INDEXED("refine.completeTopology", (int)_refinements.size());
+
+    //  The level and refinement are lazily completed -- the pointers to them
+    //  held by the refiner are not const:
+    _refinements.back()->populateMissingChildRelations();
 }
 
 //
@@ -292,6 +620,10 @@ namespace internal {
         void Clear()         { *((int_type*)this) = 0; }
         bool IsEmpty() const { return *((int_type*)this) == 0; }
 
+        bool operator==(FeatureMask const & other) const {
+            return *((int_type const *)this) == *((int_type const *)&other);
+        }
+
         FeatureMask() { Clear(); }
         FeatureMask(Options const & options, int regFaceSize) {
             Clear();
@@ -310,6 +642,7 @@ namespace internal {
         int_type selectXOrdinaryBoundary : 1;
 
         int_type selectSemiSharpSingle    : 1;
+        int_type selectSemiSharpDouble    : 1;
         int_type selectSemiSharpNonSingle : 1;
 
         int_type selectInfSharpRegularCrease   : 1;
@@ -342,12 +675,17 @@ namespace internal {
         //
         bool useSingleCreasePatch = options.useSingleCreasePatch && (regFaceSize == 4);
 
+        //  The "double-crease patch" extends the semi-sharp single-crease case to regular
+        //  faces between two parallel creases:
+        bool useDoubleCreasePatch = options.useDoubleCreasePatch && (regFaceSize == 4);
+
         //  Extra-ordinary features (independent of the inf-sharp options):
         selectXOrdinaryInterior = true;
         selectXOrdinaryBoundary = true;
 
-        //  Semi-sharp features -- the regular single crease case and all others:
+        //  Semi-sharp features -- the regular single and double crease cases and all others:
         selectSemiSharpSingle    = !useSingleCreasePatch;
+        selectSemiSharpDouble    = !useDoubleCreasePatch;
         selectSemiSharpNonSingle = true;
 
         //  Inf-sharp features -- boundary extra-ordinary vertices are irreg creases:
@@ -378,79 +716,194 @@ namespace internal {
             selectInfSharpIrregularCrease  = false;
         }
     }
+
+    //
+    //  The features selected at each level of adaptive refinement -- with two
+    //  sets of levels isolating different sets of features, both sets are
+    //  initialized up front and the appropriate one used for each level:
+    //
+    class FeatureLevels {
+    public:
+        typedef TopologyRefiner::AdaptiveOptions Options;
+
+        FeatureLevels(Options const & options, Sdc::SchemeType schemeType,
+                      int regFaceSize, bool hasIrregFaces,
+                      Vtr::internal::Level const & baseLevel);
+
+        FeatureMask const & GetLevelFeatures(int level) const {
+            return (level <= shallowLevel) ? moreFeatures : lessFeatures;
+        }
+
+    public:
+        FeatureMask moreFeatures;
+        FeatureMask lessFeatures;
+
+        int  shallowLevel;
+        int  potentialMaxLevel;
+        bool nonLinearScheme;
+    };
+
+    FeatureLevels::FeatureLevels(Options const & options, Sdc::SchemeType schemeType,
+                                 int regFaceSize, bool hasIrregFaces,
+                                 Vtr::internal::Level const & baseLevel) :
+            moreFeatures(options, regFaceSize) {
+
+        nonLinearScheme = Sdc::SchemeTypeTraits::GetLocalNeighborhoodSize(schemeType) != 0;
+
+        shallowLevel = std::min<int>(options.secondaryLevel, options.isolationLevel);
+
+        potentialMaxLevel = nonLinearScheme ? (int)options.isolationLevel
+                                            : (int)hasIrregFaces;
+
+        lessFeatures = moreFeatures;
+        if (shallowLevel < potentialMaxLevel) {
+            lessFeatures.ReduceFeatures(options);
+        }
+
+        //
+        //  If face-varying channels are considered, make sure non-linear channels are present
+        //  and turn off consideration if none present:
+        //
+        if (moreFeatures.selectFVarFeatures && nonLinearScheme) {
+            bool nonLinearChannelsPresent = false;
+            for (int channel = 0; channel < baseLevel.getNumFVarChannels(); ++channel) {
+                nonLinearChannelsPresent |= !baseLevel.getFVarLevel(channel).isLinear();
+            }
+            if (!nonLinearChannelsPresent) {
+                moreFeatures.selectFVarFeatures = false;
+                lessFeatures.selectFVarFeatures = false;
+            }
+        }
+    }
 } // end namespace internal
 
 void
 TopologyRefiner::RefineAdaptive(AdaptiveOptions options,
                                 ConstIndexArray baseFacesToRefine) {
 
-    if (_levels[0]->getNumVertices() == 0) {
+    refineAdaptive(options, baseFacesToRefine, Vtr::ConstArray<int>());
+    updateMemoryStats();
+}
+
+void
+TopologyRefiner::RefineAdaptive(AdaptiveOptions options,
+                                ConstIndexArray baseFacesToRefine,
+                                Vtr::ConstArray<int> baseFaceLevels) {
+
+    if (baseFaceLevels.size() != _levels[0]->getNumFaces()) {
         Error(FAR_RUNTIME_ERROR,
-            "Failure in TopologyRefiner::RefineAdaptive() -- base level is uninitialized.");
+            "Failure in TopologyRefiner::RefineAdaptive() -- "
+            "%d base face levels given for %d base faces.",
+            baseFaceLevels.size(), _levels[0]->getNumFaces());
         return;
     }
-    if (_refinements.size()) {
+    refineAdaptive(options, baseFacesToRefine, baseFaceLevels);
+    updateMemoryStats();
+}
+
+void
+TopologyRefiner::refineAdaptive(AdaptiveOptions options,
+                                ConstIndexArray baseFacesToRefine,
+                                Vtr::ConstArray<int> baseFaceLevels) {
+
+    if (_levels[0]->getNumVertices() == 0) {
         Error(FAR_RUNTIME_ERROR,
-            "Failure in TopologyRefiner::RefineAdaptive() -- previous refinements already applied.");
+            "Failure in TopologyRefiner::RefineAdaptive() -- base level is uninitialized.");
         return;
     }
 
+    OPENSUBDIV_TRACE_SCOPE("refine.adaptive");
+
+    bool hasFaceLevels = !baseFaceLevels.empty();
+
+    //
+    //  Retain the levels of a previous refinement that select the same features:
+    //
+    int numReused = hasFaceLevels ? 0 :
+                    getNumReusableRefinements(options, baseFacesToRefine);
+
+    truncateRefinements(numReused);
+
     //
     //  Initialize member and local variables from the adaptive options:
     //
     _isUniform = false;
     _adaptiveOptions = options;
+    _adaptiveOptions.monitor = 0;
 
     //
-    //  Initialize the feature-selection options based on given options -- with two sets
-    //  of levels isolating different sets of features, initialize the two feature sets
-    //  up front and use the appropriate one for each level:
+    //  Initialize the feature-selection options based on given options:
     //
-    int nonLinearScheme = Sdc::SchemeTypeTraits::GetLocalNeighborhoodSize(_subdivType);
-
-    int shallowLevel = std::min<int>(options.secondaryLevel, options.isolationLevel);
-    int deeperLevel  = options.isolationLevel;
+    internal::FeatureLevels features(options, _subdivType, _regFaceSize,
+                                     _hasIrregFaces, *_levels[0]);
 
-    int potentialMaxLevel = nonLinearScheme ? deeperLevel : _hasIrregFaces;
+    //
+    //  Initialize refinement options for Vtr -- full topology is always generated in
+    //  the last level as expected usage is for patch retrieval:
+    //
+    Vtr::internal::Refinement::Options refineOptions;
 
-    internal::FeatureMask moreFeaturesMask(options, _regFaceSize);
-    internal::FeatureMask lessFeaturesMask = moreFeaturesMask;
+    refineOptions._sparse            = true;
+    refineOptions._minimalTopology   = false;
+    refineOptions._faceVertsFirst    = options.orderVerticesFromFacesFirst;
+    refineOptions._orderVertsByFaces = options.orderVerticesByFaces;
+    refineOptions._numThreads        = options.numThreads;
 
-    if (shallowLevel < potentialMaxLevel) {
-        lessFeaturesMask.ReduceFeatures(options);
-    }
+    Sdc::Split splitType = Sdc::SchemeTypeTraits::GetTopologicalSplitType(_subdivType);
 
     //
-    //  If face-varying channels are considered, make sure non-linear channels are present
-    //  and turn off consideration if none present:
+    //  When a budget is given, levels exceeding it are discarded and replaced, so
+    //  the arena (which cannot reclaim them) is not used:
     //
-    if (moreFeaturesMask.selectFVarFeatures && nonLinearScheme) {
-        bool nonLinearChannelsPresent = false;
-        for (int channel = 0; channel < _levels[0]->getNumFVarChannels(); ++channel) {
-            nonLinearChannelsPresent |= !_levels[0]->getFVarLevel(channel).isLinear();
-        }
-        if (!nonLinearChannelsPresent) {
-            moreFeaturesMask.selectFVarFeatures = false;
-            lessFeaturesMask.selectFVarFeatures = false;
-        }
+    bool hasBudget = options.maxVertices || options.maxFaces || options.maxMemory;
+
+    _isRepeatable = !hasBudget && baseFacesToRefine.empty() && !hasFaceLevels;
+
+    _clampedFaces.clear();
+    _clampedFaceLevels.clear();
+
+    if (options.useArena && !hasBudget && !_arena) {
+        _arena = internal::NewArena();
     }
 
     //
-    //  Initialize refinement options for Vtr -- full topology is always generated in
-    //  the last level as expected usage is for patch retrieval:
+    //  With per-face isolation levels, only the faces of the parent level whose
+    //  base faces are to be isolated further are inspected -- the base face of
+    //  each face of the parent level is propagated with each refinement:
     //
-    Vtr::internal::Refinement::Options refineOptions;
+    std::vector<Index> parentBaseFaces;
+    std::vector<Index> facesWithinLevel;
 
-    refineOptions._sparse          = true;
-    refineOptions._minimalTopology = false;
-    refineOptions._faceVertsFirst  = options.orderVerticesFromFacesFirst;
+    for (int i = numReused + 1; i <= features.potentialMaxLevel; ++i) {
+        OPENSUBDIV_TRACE_SCOPE_INDEXED("refine.level", i);
 
-    Sdc::Split splitType = Sdc::SchemeTypeTraits::GetTopologicalSplitType(_subdivType);
+        if (options.monitor && !options.monitor->Progress(
+                BuildMonitor::STAGE_REFINE,
+                (float)(i - 1) / (float)features.potentialMaxLevel)) {
+            cancelRefinement();
+            return;
+        }
 
-    for (int i = 1; i <= potentialMaxLevel; ++i) {
+        ConstIndexArray facesToRefine = (i > 1) ? ConstIndexArray() : baseFacesToRefine;
+        if (hasFaceLevels) {
+            int numFaces = facesToRefine.size() ? facesToRefine.size()
+                                                : getLevel(i-1).getNumFaces();
+            facesWithinLevel.clear();
+            for (int fIndex = 0; fIndex < numFaces; ++fIndex) {
+                Index face = facesToRefine.size() ? facesToRefine[fIndex] : (Index) fIndex;
+                Index baseFace = (i > 1) ? parentBaseFaces[face] : face;
+                if (baseFaceLevels[baseFace] >= i) {
+                    facesWithinLevel.push_back(face);
+                }
+            }
+            if (facesWithinLevel.empty()) break;
+
+            facesToRefine = ConstIndexArray(&facesWithinLevel[0],
+                                            (int)facesWithinLevel.size());
+        }
 
         Vtr::internal::Level& parentLevel     = getLevel(i-1);
-        Vtr::internal::Level& childLevel      = *(new Vtr::internal::Level);
+        Vtr::internal::Level& childLevel      = *(new Vtr::internal::Level(hasBudget ? 0 : _arena));
 
         Vtr::internal::Refinement* refinement = 0;
         if (splitType == Sdc::SPLIT_TO_QUADS) {
@@ -465,31 +918,206 @@ TopologyRefiner::RefineAdaptive(AdaptiveOptions options,
         //
         Vtr::internal::SparseSelector selector(*refinement);
 
-        internal::FeatureMask const & levelFeatures = (i <= shallowLevel) ? moreFeaturesMask
-                                                                          : lessFeaturesMask;
+        internal::FeatureMask const & levelFeatures = features.GetLevelFeatures(i);
 
-        if (i > 1) {
-            selectFeatureAdaptiveComponents(selector, levelFeatures, ConstIndexArray());
-        } else if (nonLinearScheme) {
-            selectFeatureAdaptiveComponents(selector, levelFeatures, baseFacesToRefine);
+        if ((i > 1) || features.nonLinearScheme) {
+            selectFeatureAdaptiveComponents(selector, levelFeatures, facesToRefine);
         } else {
-            selectLinearIrregularFaces(selector, baseFacesToRefine);
+            selectLinearIrregularFaces(selector, facesToRefine);
         }
 
         if (selector.isSelectionEmpty()) {
             delete refinement;
             delete &childLevel;
             break;
-        } else {
-            refinement->refine(refineOptions);
+        }
+
+        refinement->refine(refineOptions);
+
+        if (hasBudget && exceedsAdaptiveBudget(*refinement)) {
+            refinement = fitRefinementToBudget(refinement, refineOptions);
+            if (refinement == 0) break;
+        }
 
-            appendLevel(childLevel);
-            appendRefinement(*refinement);
+        if (hasFaceLevels) {
+            Vtr::internal::Level const & child = refinement->child();
+
+            std::vector<Index> childBaseFaces(child.getNumFaces());
+            for (Index face = 0; face < child.getNumFaces(); ++face) {
+                Index parentFace = refinement->getChildFaceParentFace(face);
+                childBaseFaces[face] = (i > 1) ? parentBaseFaces[parentFace] : parentFace;
+            }
+            parentBaseFaces.swap(childBaseFaces);
         }
+
+        appendLevel(refinement->child());
+        appendRefinement(*refinement);
     }
     _maxLevel = (unsigned int) _refinements.size();
 
+    if (!_clampedFaces.empty()) {
+        Warning("TopologyRefiner::RefineAdaptive() -- isolation of %d base faces "
+                "clamped to satisfy the refinement budget.", (int)_clampedFaces.size());
+    }
+
     assembleFarLevels();
+
+    if (options.monitor) {
+        options.monitor->Progress(BuildMonitor::STAGE_REFINE, 1.0f);
+    }
+}
+
+int
+TopologyRefiner::getNumReusableRefinements(AdaptiveOptions const & options,
+                                           ConstIndexArray selectedFaces) const {
+
+    //  Sparse levels are the same when the same features were selected to
+    //  refine their parents (with the same vertex ordering):
+    if (_refinements.empty() || _isUniform || !_isRepeatable || _isCompact ||
+        _arena || !selectedFaces.empty() ||
+        options.maxVertices || options.maxFaces || options.maxMemory) {
+        return 0;
+    }
+    if ((options.orderVerticesFromFacesFirst !=
+            _adaptiveOptions.orderVerticesFromFacesFirst) ||
+        (options.orderVerticesByFaces !=
+            _adaptiveOptions.orderVerticesByFaces)) {
+        return 0;
+    }
+
+    internal::FeatureLevels prevFeatures(_adaptiveOptions, _subdivType,
+                                         _regFaceSize, _hasIrregFaces, *_levels[0]);
+    internal::FeatureLevels newFeatures(options, _subdivType,
+                                        _regFaceSize, _hasIrregFaces, *_levels[0]);
+
+    int maxReused = std::min((int)_refinements.size(), newFeatures.potentialMaxLevel);
+
+    int numReused = 0;
+    while ((numReused < maxReused) &&
+           (prevFeatures.GetLevelFeatures(numReused + 1) ==
+            newFeatures.GetLevelFeatures(numReused + 1))) {
+        ++numReused;
+    }
+    return numReused;
+}
+
+//
+//  Methods supporting the optional budget of adaptive refinement -- the first
+//  tests whether appending a new refinement (and its child level) would exceed
+//  the budget, while the second replaces a refinement exceeding the budget with
+//  one refining the selected faces of the largest subset of base faces to fit.
+//  Base faces clamped in the process are recorded with the level of their
+//  parent faces.  Zero is returned (and the refinement deleted) when no subset
+//  of the base faces fits:
+//
+bool
+TopologyRefiner::exceedsAdaptiveBudget(Vtr::internal::Refinement const & refinement) const {
+
+    AdaptiveOptions const & budget = _adaptiveOptions;
+
+    Vtr::internal::Level const & childLevel = refinement.child();
+
+    if (budget.maxVertices &&
+            ((_totalVertices + childLevel.getNumVertices()) > budget.maxVertices)) {
+        return true;
+    }
+    if (budget.maxFaces &&
+            ((_totalFaces + childLevel.getNumFaces()) > budget.maxFaces)) {
+        return true;
+    }
+    if (budget.maxMemory) {
+        size_t bytes = GetMemoryUsage() + childLevel.getMemoryUsage() +
+                       refinement.getMemoryUsage();
+        if (bytes > budget.maxMemory) return true;
+    }
+    return false;
+}
+
+Vtr::internal::Refinement *
+TopologyRefiner::fitRefinementToBudget(Vtr::internal::Refinement * refinement,
+        Vtr::internal::Refinement::Options const & refineOptions) {
+
+    Vtr::internal::Level const & parentLevel = refinement->parent();
+
+    int parentLevelIndex = (int) _refinements.size();
+
+    //
+    //  Gather the selected parent faces with the base faces they originate from
+    //  and sort them into contiguous groups for each base face:
+    //
+    std::vector<std::pair<Index,Index> > selectedFaces;
+    for (Index face = 0; face < parentLevel.getNumFaces(); ++face) {
+        if (refinement->getParentFaceSparseTag(face)._selected) {
+            Index baseFace = face;
+            for (int i = parentLevelIndex; i > 0; --i) {
+                baseFace = _refinements[i-1]->getChildFaceParentFace(baseFace);
+            }
+            selectedFaces.push_back(std::make_pair(baseFace, face));
+        }
+    }
+    std::sort(selectedFaces.begin(), selectedFaces.end());
+
+    std::vector<int> groupOffsets;
+    for (int i = 0; i < (int)selectedFaces.size(); ++i) {
+        if ((i == 0) || (selectedFaces[i].first != selectedFaces[i-1].first)) {
+            groupOffsets.push_back(i);
+        }
+    }
+    int numGroups = (int) groupOffsets.size();
+    groupOffsets.push_back((int)selectedFaces.size());
+
+    delete &refinement->child();
+    delete refinement;
+
+    //
+    //  Cost is monotonic in the number of groups refined, so search for the
+    //  largest leading subset of groups that fits (the full set does not):
+    //
+    Sdc::Split splitType = Sdc::SchemeTypeTraits::GetTopologicalSplitType(_subdivType);
+
+    Vtr::internal::Refinement * fitted = 0;
+    int numFitted = 0;
+
+    int lower = 1;
+    int upper = numGroups - 1;
+    while (lower <= upper) {
+        int numTrial = (lower + upper) / 2;
+
+        Vtr::internal::Level & trialLevel = *(new Vtr::internal::Level);
+
+        Vtr::internal::Refinement * trial = 0;
+        if (splitType == Sdc::SPLIT_TO_QUADS) {
+            trial = new Vtr::internal::QuadRefinement(parentLevel, trialLevel, _subdivOptions);
+        } else {
+            trial = new Vtr::internal::TriRefinement(parentLevel, trialLevel, _subdivOptions);
+        }
+
+        Vtr::internal::SparseSelector selector(*trial);
+        for (int i = 0; i < groupOffsets[numTrial]; ++i) {
+            selector.selectFace(selectedFaces[i].second);
+        }
+        trial->refine(refineOptions);
+
+        if (exceedsAdaptiveBudget(*trial)) {
+            delete &trialLevel;
+            delete trial;
+            upper = numTrial - 1;
+        } else {
+            if (fitted) {
+                delete &fitted->child();
+                delete fitted;
+            }
+            fitted = trial;
+            numFitted = numTrial;
+            lower = numTrial + 1;
+        }
+    }
+
+    for (int i = numFitted; i < numGroups; ++i) {
+        _clampedFaces.push_back(selectedFaces[groupOffsets[i]].first);
+        _clampedFaceLevels.push_back(parentLevelIndex);
+    }
+    return fitted;
 }
 
 //
@@ -677,10 +1305,13 @@ namespace {
 
         //  Semi-sharp features -- select all immediately or test the single-crease case:
         if (compFaceVTag._semiSharp || compFaceVTag._semiSharpEdges) {
-            if (featureMask.selectSemiSharpSingle && featureMask.selectSemiSharpNonSingle) {
+            if (featureMask.selectSemiSharpSingle && featureMask.selectSemiSharpDouble &&
+                featureMask.selectSemiSharpNonSingle) {
                 return true;
             } else if (level.isSingleCreasePatch(face)) {
                 return featureMask.selectSemiSharpSingle;
+            } else if (level.isDoubleCreasePatch(face)) {
+                return featureMask.selectSemiSharpDouble;
             } else {
                 return featureMask.selectSemiSharpNonSingle;
             }
@@ -769,6 +1400,21 @@ TopologyRefiner::selectFeatureAdaptiveComponents(Vtr::internal::SparseSelector&
 
     int numFVarChannels = featureMask.selectFVarFeatures ? level.getNumFVarChannels() : 0;
 
+    //
+    //  Inspecting the faces only reads the parent Level, so it is distributed over
+    //  the available threads.  Selecting a face marks its incident components and
+    //  so the selections are applied afterward, in order, to keep the tags (and so
+    //  the resulting refinement) independent of the number of threads:
+    //
+    int numThreads = std::max(1, (int) _adaptiveOptions.numThreads);
+
+    std::vector<unsigned char> faceSelected(numFacesToRefine, 0);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024) if (numThreads > 1) num_threads(numThreads)
+#else
+    (void)numThreads;
+#endif
     for (int fIndex = 0; fIndex < numFacesToRefine; ++fIndex) {
 
         Vtr::Index face = facesToRefine.size() ? facesToRefine[fIndex] : (Index) fIndex;
@@ -791,8 +1437,12 @@ TopologyRefiner::selectFeatureAdaptiveComponents(Vtr::internal::SparseSelector&
                 }
             }
         }
-        if (selectFace) {
-            selector.selectFace(face);
+        faceSelected[fIndex] = selectFace;
+    }
+
+    for (int fIndex = 0; fIndex < numFacesToRefine; ++fIndex) {
+        if (faceSelected[fIndex]) {
+            selector.selectFace(facesToRefine.size() ? facesToRefine[fIndex] : (Index) fIndex);
         }
     }
 }
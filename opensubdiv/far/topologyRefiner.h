@@ -30,6 +30,7 @@
 #include "../sdc/options.h"
 #include "../far/types.h"
 #include "../far/topologyLevel.h"
+#include "../far/memory.h"
 
 #include <vector>
 
@@ -37,13 +38,15 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
-namespace Vtr { namespace internal { class SparseSelector; } }
+namespace Vtr { namespace internal { class SparseSelector; class Arena; } }
 namespace Far { namespace internal { class FeatureMask; } }
 
 namespace Far {
 
 template <typename REAL> class PrimvarRefinerReal;
 template <class MESH> class TopologyRefinerFactory;
+class HierarchicalEdits;
+class BuildMonitor;
 
 ///
 ///  \brief Stores topology data for a specified set of refinement options.
@@ -91,6 +94,10 @@ public:
     /// \brief Returns the total number of face vertices in all levels
     int GetNumFaceVerticesTotal() const { return _totalFaceVertices; }
 
+    /// \brief Returns the number of bytes allocated for the topology of all
+    ///        levels and the refinements between them
+    size_t GetMemoryUsage() const;
+
     /// \brief Returns a handle to access data specific to a particular level
     TopologyLevel const & GetLevel(int level) const { return _farLevels[level]; }
 
@@ -113,21 +120,60 @@ public:
     /// last level by default, i.e. a vertex and face-vertex list.  If requiring
     /// topology traversal of the last level, e.g. inspecting edges or incident
     /// faces of vertices, the option to generate full topology in the last
-    /// level should be enabled.
+    /// level should be enabled -- or the missing topology completed later on
+    /// demand with CompleteLastLevelTopology().
+    ///
+    /// Child vertices are ordered in blocks by the type of their parent --
+    /// faces, edges and vertices -- and within each block by the index of
+    /// their parent.  With orderVerticesByFaces, the blocks are retained but
+    /// the children of edges and vertices are instead ordered as their parents
+    /// are first visited by the faces of the parent level, as are the children
+    /// of faces, so the children of neighboring faces are near each other in
+    /// all three blocks.  This improves the locality of the vertices gathered
+    /// by the stencils and faces of the refined levels, but the children of
+    /// vertices no longer correspond to the indices of their parents.
+    ///
+    /// The topology of each level may optionally be populated using multiple
+    /// threads (when OpenMP support is available).  The resulting topology is
+    /// identical to that of serial refinement.
+    ///
+    /// The refined levels may also optionally be allocated from a single arena
+    /// owned by the TopologyRefiner, rather than from many small allocations
+    /// on the heap.  The arena is released on Unrefine() or destruction.
+    ///
+    /// An optional BuildMonitor is notified after each level is refined, and
+    /// refinement stops -- leaving the refiner unrefined -- if it is
+    /// cancelled.  The monitor is not retained by the refiner.
     ///
     struct UniformOptions {
 
         UniformOptions(int level) :
             refinementLevel(level),
             orderVerticesFromFacesFirst(false),
-            fullTopologyInLastLevel(false) { }
+            orderVerticesByFaces(false),
+            fullTopologyInLastLevel(false),
+            numThreads(0),
+            useArena(false),
+            pruneHoles(false),
+            monitor(0) { }
 
         unsigned int refinementLevel:4,             ///< Number of refinement iterations
                      orderVerticesFromFacesFirst:1, ///< Order child vertices from faces first
                                                     ///< instead of child vertices of vertices
-                     fullTopologyInLastLevel:1;     ///< Skip topological relationships in the last
+                     orderVerticesByFaces:1,        ///< Order the child vertices of edges and
+                                                    ///< vertices as their parents are visited
+                                                    ///< by the parent faces (see below)
+                     fullTopologyInLastLevel:1,     ///< Skip topological relationships in the last
                                                     ///< level of refinement that are not needed for
                                                     ///< interpolation (keep false if using limit).
+                     numThreads:8,                  ///< Number of threads used to populate each
+                                                    ///< level (0 or 1 for serial refinement)
+                     useArena:1,                    ///< Allocate refined levels from an arena
+                     pruneHoles:1;                  ///< Omit the children of hole faces not
+                                                    ///< needed by the neighborhoods of the
+                                                    ///< remaining faces (sparse levels)
+
+        BuildMonitor * monitor;                     ///< Optional progress and cancellation
     };
 
     /// \brief Refine the topology uniformly
@@ -138,13 +184,46 @@ public:
     /// Note the impact of the UniformOption to generate fullTopologyInLastLevel
     /// and be sure it is assigned to satisfy the needs of the resulting refinement.
     ///
+    /// When faces are tagged as holes and pruneHoles is set, refined levels
+    /// only retain the children of hole faces adjacent to the remaining faces,
+    /// so the vertices of hole regions (and their stencils) are not generated.
+    /// Refinement ends early if every face of a level is a hole.
+    ///
+    /// If the topology has already been refined, the previous refinement is
+    /// replaced.  Levels of a previous uniform refinement that the new options
+    /// leave unchanged are retained rather than refined again, e.g. when only
+    /// the refinement level is changed (see RefineAdaptive() for exceptions).
+    ///
     /// @param options   Options controlling uniform refinement
     ///
     void RefineUniform(UniformOptions options);
 
+    /// \brief Refine the topology uniformly applying hierarchical edits
+    ///
+    /// The sharpness edits of each refined level are applied to that level
+    /// before it is itself refined (see HierarchicalEdits).
+    ///
+    /// @param options   Options controlling uniform refinement
+    ///
+    /// @param edits     Hierarchical edits of the refined levels
+    ///
+    void RefineUniform(UniformOptions options, HierarchicalEdits const & edits);
+
     /// \brief Returns the options specified on refinement
     UniformOptions GetUniformOptions() const { return _uniformOptions; }
 
+    /// \brief Populate the topology omitted from the last level of uniform
+    ///        refinement without fullTopologyInLastLevel
+    ///
+    /// A refinement used only for interpolation, e.g. by StencilTableFactory,
+    /// need not pay for the full topology of its last level up front.  Those
+    /// requiring it later, e.g. PrimvarRefiner::Limit(), complete it lazily
+    /// through this method, which returns immediately when the topology is
+    /// already complete. As the last level is modified, this must not be
+    /// invoked concurrently with other uses of the TopologyRefiner.
+    ///
+    void CompleteLastLevelTopology() const;
+
     //
     // Adaptive refinement
     //
@@ -156,9 +235,17 @@ public:
             isolationLevel(level),
             secondaryLevel(15),
             useSingleCreasePatch(false),
+            useDoubleCreasePatch(false),
             useInfSharpPatch(false),
             considerFVarChannels(false),
-            orderVerticesFromFacesFirst(false) { }
+            orderVerticesFromFacesFirst(false),
+            orderVerticesByFaces(false),
+            numThreads(0),
+            useArena(false),
+            maxVertices(0),
+            maxFaces(0),
+            maxMemory(0),
+            monitor(0) { }
 
         unsigned int isolationLevel:4;              ///< Number of iterations applied to isolate
                                                     ///< extraordinary vertices and creases
@@ -166,16 +253,44 @@ public:
                                                     ///< smooth irregular features
         unsigned int useSingleCreasePatch:1;        ///< Use 'single-crease' patch and stop
                                                     ///< isolation where applicable
+        unsigned int useDoubleCreasePatch:1;        ///< Use 'double-crease' patch between two
+                                                    ///< parallel semi-sharp creases and stop
+                                                    ///< isolation where applicable
         unsigned int useInfSharpPatch:1;            ///< Use infinitely sharp patches and stop
                                                     ///< isolation where applicable
         unsigned int considerFVarChannels:1;        ///< Inspect face-varying channels and
                                                     ///< isolate when irregular features present
         unsigned int orderVerticesFromFacesFirst:1; ///< Order child vertices from faces first
                                                     ///< instead of child vertices of vertices
+        unsigned int orderVerticesByFaces:1;        ///< Order the child vertices of edges and
+                                                    ///< vertices as their parents are visited
+                                                    ///< by the parent faces (see UniformOptions)
+        unsigned int numThreads:8;                  ///< Number of threads used to populate each
+                                                    ///< level (0 or 1 for serial refinement)
+        unsigned int useArena:1;                    ///< Allocate refined levels from an arena
+
+        //  Optional budget for the refined topology -- when exceeded, isolation
+        //  is stopped for the base faces whose refinement no longer fits (see
+        //  GetNumClampedFaces()).  A budget of 0 is unbounded.  The arena is
+        //  not used when a budget is given as rejected levels are discarded:
+        int    maxVertices;                         ///< Max vertices of all levels
+        int    maxFaces;                            ///< Max faces of all levels
+        size_t maxMemory;                           ///< Max bytes reported by GetMemoryUsage()
+
+        BuildMonitor * monitor;                     ///< Optional progress and cancellation
+                                                    ///< (see UniformOptions)
     };
 
     /// \brief Feature Adaptive topology refinement
     ///
+    /// If the topology has already been refined, the previous refinement is
+    /// replaced.  Levels of a previous adaptive refinement that isolate the
+    /// same features under the new options are retained rather than refined
+    /// again, e.g. when only the isolation level is changed.  Levels are not
+    /// retained when either refinement was given selected faces, per-face
+    /// isolation levels, a budget or hierarchical edits, when the refiner was
+    /// compacted, or when levels are allocated from an arena.
+    ///
     /// @param options         Options controlling adaptive refinement
     ///
     /// @param selectedFaces   Limit adaptive refinement to the specified faces
@@ -183,12 +298,109 @@ public:
     void RefineAdaptive(AdaptiveOptions options,
                         ConstIndexArray selectedFaces = ConstIndexArray());
 
+    /// \brief Feature Adaptive topology refinement with an isolation level
+    ///        for each base face
+    ///
+    /// Features of each base face are isolated no deeper than its level in
+    /// the given array (and the isolationLevel of the options), e.g. to
+    /// isolate areas of interest deeply while leaving hidden areas coarse.
+    /// A level of 0 leaves the base face unrefined.  Faces bordering deeper
+    /// neighbors are still refined as far as the neighborhoods of those
+    /// neighbors require.
+    ///
+    /// @param options              Options controlling adaptive refinement
+    ///
+    /// @param selectedFaces        Limit adaptive refinement to the specified
+    ///                             faces
+    ///
+    /// @param baseFaceLevels       Max isolation level of each base face
+    ///
+    void RefineAdaptive(AdaptiveOptions options,
+                        ConstIndexArray selectedFaces,
+                        Vtr::ConstArray<int> baseFaceLevels);
+
     /// \brief Returns the options specified on refinement
     AdaptiveOptions GetAdaptiveOptions() const { return _adaptiveOptions; }
 
+    /// \brief Returns the number of base faces whose isolation was clamped
+    ///        to satisfy the budget of the AdaptiveOptions
+    int GetNumClampedFaces() const { return (int)_clampedFaces.size(); }
+
+    /// \brief Returns the i'th base face whose isolation was clamped
+    Index GetClampedFace(int i) const { return _clampedFaces[i]; }
+
+    /// \brief Returns the deepest level to which the i'th clamped base face
+    ///        was refined (less than the level its features required)
+    int GetClampedFaceLevel(int i) const { return _clampedFaceLevels[i]; }
+
     /// \brief Unrefine the topology, keeping only the base level.
     void Unrefine();
 
+    /// \brief Options for compacting a refined topology
+    struct CompactOptions {
+
+        CompactOptions() : keepLastLevel(false) { }
+
+        unsigned int keepLastLevel:1;  ///< Retain the topology of the last level
+    };
+
+    /// \brief Release the topology of refined levels and the refinements
+    ///        between them once tables dependent on them have been created
+    ///
+    /// Once a PatchTable, StencilTable or other tables have been created from
+    /// a refinement, the topology of its refined levels is often no longer
+    /// needed while the TopologyRefiner is still required for queries of the
+    /// base level, e.g. face-varying values or PtexIndices.  Compacting
+    /// releases the topology of all refined levels (optionally excluding the
+    /// last) along with the refinements between levels.
+    ///
+    /// The base level and the inventory of all levels are preserved:  the
+    /// number of levels and the component and face-varying value counts of
+    /// each (and their totals) remain unchanged.  Queries of the topology of
+    /// a released level and any use of the refinements, e.g. by PrimvarRefiner
+    /// or the table factories, are no longer valid.
+    ///
+    /// Memory allocated from an arena (see UniformOptions::useArena) is only
+    /// reclaimed when no refined level is retained.  The refiner can again be
+    /// fully refined after an Unrefine().
+    ///
+    /// @param options   Options controlling what is retained
+    ///
+    void Compact(CompactOptions options = CompactOptions());
+
+    /// \brief Returns true if Compact() released refined topology
+    bool IsCompact() const { return _isCompact; }
+
+    /// \brief Assign new sharpness values to edges and vertices of the base
+    ///        level and update the sharpness of all refined levels
+    ///
+    /// Changes to sharpness do not affect the topology of uniform refinement,
+    /// so the existing levels are preserved and only the sharpness and rules
+    /// of their components are updated (tables created from the refiner can
+    /// then be updated selectively, e.g. with
+    /// StencilTableFactory::UpdateStencilTable()).
+    ///
+    /// Sharpness is only updated for refiners that have not been refined
+    /// adaptively and have no face-varying channels (both of which are
+    /// dependent on sharpness), nor with hierarchical edits (which would be
+    /// discarded), and whose base level is not shared with other instances
+    /// (see TopologyRefinerFactory::Create()). As when the refiner was
+    /// created, sharpness of boundary edges and vertices may be overridden
+    /// by the boundary interpolation options.
+    ///
+    /// @param edges            Indices of base edges whose sharpness changed
+    ///
+    /// @param edgeSharpness    New sharpness values of the edges
+    ///
+    /// @param vertices         Indices of base vertices whose sharpness changed
+    ///
+    /// @param vertexSharpness  New sharpness values of the vertices
+    ///
+    /// @return                 False if the sharpness could not be updated
+    ///
+    bool UpdateBaseSharpness(ConstIndexArray edges, float const * edgeSharpness,
+                             ConstIndexArray vertices, float const * vertexSharpness);
+
 
     //@{
     /// @name Number and properties of face-varying channels:
@@ -216,8 +428,13 @@ protected:
     friend class PatchTableBuilder;
     friend class PatchBuilder;
     friend class PtexIndices;
+    friend class TopologyRefinerSerializer;
+    friend class HierarchicalEdits;
+    friend class BuildEstimator;
     template <typename REAL>
     friend class PrimvarRefinerReal;
+    template <typename REAL>
+    friend class StencilTableFactoryReal;
 
     //  Copy constructor exposed via the factory class:
     TopologyRefiner(TopologyRefiner const & source);
@@ -230,15 +447,30 @@ protected:
 
 private:
     //  Not default constructible or copyable:
-    TopologyRefiner() : _uniformOptions(0), _adaptiveOptions(0) { }
+    TopologyRefiner() : _isCompact(false), _isRepeatable(false), _uniformOptions(0), _adaptiveOptions(0), _baseLevel(0), _arena(0) { }
     TopologyRefiner & operator=(TopologyRefiner const &) { return *this; }
 
+    void refineUniform(UniformOptions options, HierarchicalEdits const * edits);
+    void refineAdaptive(AdaptiveOptions options, ConstIndexArray selectedFaces,
+                        Vtr::ConstArray<int> baseFaceLevels);
+
+    int getNumReusableRefinements(UniformOptions const & options,
+                                  HierarchicalEdits const * edits) const;
+    int getNumReusableRefinements(AdaptiveOptions const & options,
+                                  ConstIndexArray selectedFaces) const;
+    void truncateRefinements(int numRefinements);
+    void cancelRefinement();
+
     void selectFeatureAdaptiveComponents(Vtr::internal::SparseSelector& selector,
                                          internal::FeatureMask const & mask,
                                          ConstIndexArray selectedFaces);
     void selectLinearIrregularFaces(Vtr::internal::SparseSelector& selector,
                                     ConstIndexArray selectedFaces);
 
+    bool exceedsAdaptiveBudget(Vtr::internal::Refinement const & refinement) const;
+    Vtr::internal::Refinement * fitRefinementToBudget(Vtr::internal::Refinement * refinement,
+                            Vtr::internal::Refinement::Options const & refineOptions);
+
     void initializeInventory();
     void updateInventory(Vtr::internal::Level const & newLevel);
 
@@ -246,6 +478,8 @@ private:
     void appendRefinement(Vtr::internal::Refinement & newRefinement);
     void assembleFarLevels();
 
+    void updateMemoryStats();
+
 private:
 
     Sdc::SchemeType _subdivType;
@@ -256,6 +490,8 @@ private:
     unsigned int _hasIrregFaces : 1;
     unsigned int _regFaceSize   : 3;
     unsigned int _maxLevel      : 4;
+    unsigned int _isCompact     : 1;
+    unsigned int _isRepeatable  : 1;  // levels depend on options alone
 
     //  Options assigned on refinement:
     UniformOptions  _uniformOptions;
@@ -268,13 +504,26 @@ private:
     int _totalFaceVertices;
     int _maxValence;
 
-    //  Note the base level may be shared with another instance
-    bool _baseLevelOwned;
+    //  Note the base level may be shared with other instances (by reference
+    //  count, both defined privately):
+    struct SharedBaseLevel;
+
+    SharedBaseLevel * _baseLevel;
 
     std::vector<Vtr::internal::Level *>      _levels;
     std::vector<Vtr::internal::Refinement *> _refinements;
 
+    //  Optional arena from which all refined levels are allocated:
+    Vtr::internal::Arena * _arena;
+
     std::vector<TopologyLevel> _farLevels;
+
+    //  Base faces (and their levels) whose isolation was clamped to a budget:
+    std::vector<Index> _clampedFaces;
+    std::vector<int>   _clampedFaceLevels;
+
+    //  Memory reported to the client (see SetMemoryStatsCallbacks()):
+    internal::MemoryStats _memoryStats;
 };
 
 
@@ -102,6 +102,15 @@ TopologyRefinerFactoryBase::prepareComponentTopologySizing(
     }
     baseLevel.resizeFaceVertices(fVertCount);
 
+    //
+    //  When all faces are of the regular size of the scheme -- typical of
+    //  Catmark and Loop cages -- their counts and offsets are implicit, as
+    //  they are for all refined levels:
+    //
+    if (!refiner._hasIrregFaces) {
+        baseLevel.setRegularFaceSize(refiner._regFaceSize);
+    }
+
     //
     //  If edges were sized, all other topological relations must be sized
     //  with it, in which case we allocate those members to be populated.
@@ -133,13 +142,13 @@ TopologyRefinerFactoryBase::prepareComponentTopologySizing(
 bool
 TopologyRefinerFactoryBase::prepareComponentTopologyAssignment(
     TopologyRefiner& refiner, bool fullValidation,
-    TopologyCallback callback, void const * callbackData) {
+    TopologyCallback callback, void const * callbackData, int numThreads) {
 
     Vtr::internal::Level& baseLevel = refiner.getLevel(0);
 
     bool completeMissingTopology = (baseLevel.getNumEdges() == 0);
     if (completeMissingTopology) {
-        if (! baseLevel.completeTopologyFromFaceVertices()) {
+        if (! baseLevel.completeTopologyFromFaceVertices(numThreads)) {
             char msg[1024];
             snprintf(msg, 1024,
                 "Failure in TopologyRefinerFactory<>::Create() -- "
@@ -158,7 +167,7 @@ TopologyRefinerFactoryBase::prepareComponentTopologyAssignment(
     }
 
     if (fullValidation) {
-        if (! baseLevel.validateTopology(callback, callbackData)) {
+        if (! baseLevel.validateTopology(callback, callbackData, numThreads)) {
             if (completeMissingTopology) {
                 Error(FAR_RUNTIME_ERROR,
                     "Failure in TopologyRefinerFactory<>::Create() -- "
@@ -246,8 +255,12 @@ TopologyRefinerFactoryBase::prepareComponentTagsAndSharpness(
 
     //
     //  Process the Edge tags first, as Vertex tags (notably the Rule) are
-    //  dependent on properties of their incident edges.
+    //  dependent on properties of their incident edges.  Note whether any
+    //  semi-sharp features are present so that refinement can skip the
+    //  subdivision of sharpness when none are:
     //
+    bool hasSemiSharpFeatures = false;
+
     for (Vtr::Index eIndex = 0; eIndex < baseLevel.getNumEdges(); ++eIndex) {
         Vtr::internal::Level::ETag& eTag = baseLevel.getEdgeTag(eIndex);
 
@@ -259,6 +272,8 @@ TopologyRefinerFactoryBase::prepareComponentTagsAndSharpness(
         }
         eTag._infSharp  = Sdc::Crease::IsInfinite(eSharpness);
         eTag._semiSharp = Sdc::Crease::IsSharp(eSharpness) && !eTag._infSharp;
+
+        if (eTag._semiSharp) hasSemiSharpFeatures = true;
     }
 
     //
@@ -322,6 +337,8 @@ TopologyRefinerFactoryBase::prepareComponentTagsAndSharpness(
         vTag._semiSharp      = Sdc::Crease::IsSemiSharp(vSharpness);
         vTag._semiSharpEdges = (semiSharpEdgeCount > 0);
 
+        if (vTag._semiSharp) hasSemiSharpFeatures = true;
+
         vTag._rule = (Vtr::internal::Level::VTag::VTagSize)
             creasing.DetermineVertexVertexRule(vSharpness, sharpEdgeCount);
 
@@ -411,12 +428,13 @@ TopologyRefinerFactoryBase::prepareComponentTagsAndSharpness(
             }
         }
     }
+    baseLevel.setHasSemiSharpFeatures(hasSemiSharpFeatures);
     return true;
 }
 
 bool
 TopologyRefinerFactoryBase::prepareFaceVaryingChannels(
-    TopologyRefiner& refiner) {
+    TopologyRefiner& refiner, int numThreads) {
 
     Vtr::internal::Level& baseLevel = refiner.getLevel(0);
 
@@ -424,7 +442,9 @@ TopologyRefinerFactoryBase::prepareFaceVaryingChannels(
         Sdc::SchemeTypeTraits::GetRegularVertexValence(refiner.GetSchemeType());
     int regBoundaryValence = regVertexValence / 2;
 
-    for (int channel=0; channel<refiner.GetNumFVarChannels(); ++channel) {
+    int numChannels = refiner.GetNumFVarChannels();
+
+    for (int channel=0; channel<numChannels; ++channel) {
         if (baseLevel.getNumFVarValues(channel) == 0) {
             char msg[1024];
             snprintf(msg, 1024,
@@ -433,8 +453,29 @@ TopologyRefinerFactoryBase::prepareFaceVaryingChannels(
             Error(FAR_RUNTIME_ERROR, msg);
             return false;
         }
-        baseLevel.completeFVarChannelTopology(channel, regBoundaryValence);
     }
+
+    //
+    //  Channels are completed independently of each other -- with at least as
+    //  many channels as threads, each thread completes whole channels, otherwise
+    //  the channels are completed in turn with all threads sharing the vertices
+    //  of each (avoiding nested parallel regions):
+    //
+    bool completeChannelsConcurrently = (numThreads > 1) && (numChannels >= numThreads);
+    int  numThreadsPerChannel = completeChannelsConcurrently ? 1 : numThreads;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (completeChannelsConcurrently) num_threads(numThreads) schedule(dynamic, 1)
+#else
+    (void)completeChannelsConcurrently;
+#endif
+    for (int channel=0; channel<numChannels; ++channel) {
+        baseLevel.completeFVarChannelTopology(channel, regBoundaryValence,
+                                              numThreadsPerChannel);
+    }
+
+    //  The base level is complete:
+    refiner.updateMemoryStats();
     return true;
 }
 
@@ -28,6 +28,7 @@
 
 #include "../far/topologyRefiner.h"
 #include "../far/error.h"
+#include "../far/trace.h"
 
 #include <cassert>
 
@@ -55,9 +56,13 @@ protected:
 
     static bool prepareComponentTopologySizing(TopologyRefiner& refiner);
     static bool prepareComponentTopologyAssignment(TopologyRefiner& refiner, bool fullValidation,
-                                                   TopologyCallback callback, void const * callbackData);
+                                                   TopologyCallback callback, void const * callbackData,
+                                                   int numThreads = 0);
     static bool prepareComponentTagsAndSharpness(TopologyRefiner& refiner);
-    static bool prepareFaceVaryingChannels(TopologyRefiner& refiner);
+    static bool prepareFaceVaryingChannels(TopologyRefiner& refiner, int numThreads = 0);
+
+    //  Tags and sharpness are re-prepared when the refiner updates its sharpness:
+    friend class TopologyRefiner;
 };
 
 
@@ -86,7 +91,8 @@ public:
         Options(Sdc::SchemeType sdcType = Sdc::SCHEME_CATMARK, Sdc::Options sdcOptions = Sdc::Options()) :
             schemeType(sdcType),
             schemeOptions(sdcOptions),
-            validateFullTopology(false) { }
+            validateFullTopology(false),
+            numThreads(0) { }
 
         Sdc::SchemeType schemeType;             ///< The subdivision scheme type identifier
         Sdc::Options    schemeOptions;          ///< The full set of options for the scheme,
@@ -94,6 +100,11 @@ public:
         unsigned int validateFullTopology : 1;  ///< Apply more extensive validation of
                                                 ///< the constructed topology -- intended
                                                 ///< for debugging.
+        unsigned int numThreads : 8;            ///< Number of threads used to complete the
+                                                ///< topology when only face-vertices are
+                                                ///< assigned, to validate it and to complete
+                                                ///< the face-varying channels (0 or 1 for
+                                                ///< serial completion and validation)
     };
 
     /// \brief Instantiates a TopologyRefiner from client-provided topological
@@ -116,10 +127,10 @@ public:
     ///        existing instance.
     ///
     ///  This allows lightweight copies of the same topology to be refined
-    ///  differently for each new instance.  As with other classes that refer
-    ///  to an existing TopologyRefiner, it must generally exist for the entire
-    ///  lifetime of the new instance.  In this case, the base level of the
-    ///  original instance must be preserved.
+    ///  differently for each new instance.  The base level is shared by
+    ///  reference count, so the original instance may be destroyed before
+    ///  its copies.  As the base level is shared, it cannot be modified (e.g.
+    ///  with UpdateBaseSharpness()) while other instances share it.
     ///
     /// @param baseLevel  An existing TopologyRefiner to share base level.
     ///
@@ -332,6 +343,8 @@ template <class MESH>
 TopologyRefiner*
 TopologyRefinerFactory<MESH>::Create(MESH const& mesh, Options options) {
 
+    OPENSUBDIV_TRACE_SCOPE("topology.create");
+
     TopologyRefiner * refiner = new TopologyRefiner(options.schemeType, options.schemeOptions);
 
     if (! populateBaseLevel(*refiner, mesh, options)) {
@@ -384,7 +397,8 @@ TopologyRefinerFactory<MESH>::populateBaseLevel(TopologyRefiner& refiner, MESH c
     void const *     userData = &mesh;
         
     if (! assignComponentTopology(refiner, mesh)) return false;
-    if (! prepareComponentTopologyAssignment(refiner, validate, callback, userData)) return false;
+    if (! prepareComponentTopologyAssignment(refiner, validate, callback, userData,
+                                             options.numThreads)) return false;
 
     //
     //  User assigned and internal tagging of components -- an optional specialization for
@@ -397,7 +411,7 @@ TopologyRefinerFactory<MESH>::populateBaseLevel(TopologyRefiner& refiner, MESH c
     //  Defining channels of face-varying primvar data -- an optional specialization for MESH.
     //
     if (! assignFaceVaryingTopology(refiner, mesh)) return false;
-    if (! prepareFaceVaryingChannels(refiner)) return false;
+    if (! prepareFaceVaryingChannels(refiner, options.numThreads)) return false;
 
     return true;
 }
@@ -0,0 +1,232 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+#include "../far/topologyRefinerSerializer.h"
+#include "../far/error.h"
+#include "../far/memory.h"
+#include "../vtr/level.h"
+#include "../vtr/fvarLevel.h"
+#include "../vtr/refinement.h"
+#include "../vtr/quadRefinement.h"
+#include "../vtr/triRefinement.h"
+#include "../vtr/binaryStream.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+using Vtr::internal::BinaryWriter;
+using Vtr::internal::BinaryReader;
+
+using Vtr::internal::BinaryHeader;
+
+namespace {
+    //
+    //  The version must be incremented with any change to the layout of the
+    //  refiner or its levels and refinements:
+    //
+    char const         MAGIC[8] = { 'O', 'S', 'D', 'T', 'R', 'E', 'F', '\0' };
+    unsigned int const VERSION  = 7;
+
+    BinaryHeader
+    createHeader() {
+        BinaryHeader header(MAGIC, VERSION);
+
+        header.setTypeSize(0,  sizeof(Index));
+        header.setTypeSize(1,  sizeof(LocalIndex));
+        header.setTypeSize(2,  sizeof(Vtr::internal::Level::VTag));
+        header.setTypeSize(3,  sizeof(Vtr::internal::Level::ETag));
+        header.setTypeSize(4,  sizeof(Vtr::internal::Level::FTag));
+        header.setTypeSize(5,  sizeof(Vtr::internal::FVarLevel::ETag));
+        header.setTypeSize(6,  sizeof(Vtr::internal::FVarLevel::ValueTag));
+        header.setTypeSize(7,  sizeof(Vtr::internal::FVarLevel::CreaseEndPair));
+        header.setTypeSize(8,  sizeof(Vtr::internal::Refinement::ChildTag));
+        header.setTypeSize(9,  sizeof(Vtr::internal::Refinement::SparseTag));
+        header.setTypeSize(10, sizeof(Sdc::Options));
+        header.setTypeSize(11, sizeof(TopologyRefiner::UniformOptions));
+        header.setTypeSize(12, sizeof(TopologyRefiner::AdaptiveOptions));
+        return header;
+    }
+}
+
+//
+//  The refiner is written by accessing its levels and refinements directly
+//  (as a friend) while its inventory is recomputed on reading as it would be
+//  during refinement:
+//
+void
+TopologyRefinerSerializer::write(BinaryWriter & stream,
+                                 TopologyRefiner const & refiner) {
+
+    stream.write(createHeader());
+
+    stream.write((int) refiner._subdivType);
+    stream.write(refiner._subdivOptions);
+    stream.write((int) refiner._isUniform);
+    stream.write((int) refiner._hasHoles);
+    stream.write((int) refiner._hasIrregFaces);
+    stream.write((int) refiner._maxLevel);
+    stream.write(refiner._uniformOptions);
+    stream.write(refiner._adaptiveOptions);
+
+    int numRefinements = (int) refiner._refinements.size();
+    stream.write(numRefinements);
+
+    refiner.getLevel(0).write(stream);
+    for (int i = 0; i < numRefinements; ++i) {
+        refiner.getRefinement(i).write(stream);
+    }
+    stream.align();
+}
+
+size_t
+TopologyRefinerSerializer::GetSerializedSize(TopologyRefiner const & refiner) {
+
+    BinaryWriter stream;
+    write(stream, refiner);
+    return stream.getSize();
+}
+
+size_t
+TopologyRefinerSerializer::Serialize(TopologyRefiner const & refiner,
+                                     void * buffer, size_t bufferSize) {
+
+    BinaryWriter stream(buffer, bufferSize);
+    write(stream, refiner);
+
+    if (!buffer || !stream.isValid()) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in TopologyRefinerSerializer::Serialize() -- "
+            "buffer too small for refiner.");
+        return 0;
+    }
+    return stream.getSize();
+}
+
+TopologyRefiner *
+TopologyRefinerSerializer::Deserialize(void const * buffer, size_t bufferSize) {
+
+    BinaryReader stream(buffer, bufferSize);
+
+    BinaryHeader header;
+    if (!stream.read(header) || !header.isCompatible(createHeader())) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in TopologyRefinerSerializer::Deserialize() -- "
+            "buffer not written by a compatible version of the library.");
+        return 0;
+    }
+
+    int                              schemeType = 0;
+    Sdc::Options                     schemeOptions;
+    int                              isUniform = 0;
+    int                              hasHoles = 0;
+    int                              hasIrregFaces = 0;
+    int                              maxLevel = 0;
+    TopologyRefiner::UniformOptions  uniformOptions(0);
+    TopologyRefiner::AdaptiveOptions adaptiveOptions(0);
+    int                              numRefinements = 0;
+
+    stream.read(schemeType);
+    stream.read(schemeOptions);
+    stream.read(isUniform);
+    stream.read(hasHoles);
+    stream.read(hasIrregFaces);
+    stream.read(maxLevel);
+    stream.read(uniformOptions);
+    stream.read(adaptiveOptions);
+    stream.read(numRefinements);
+
+    if (!stream.isValid() || (schemeType < Sdc::SCHEME_BILINEAR) ||
+            (schemeType > Sdc::SCHEME_LOOP) || (maxLevel < 0) ||
+            (maxLevel > 15) || (numRefinements < 0) ||
+            (numRefinements > maxLevel)) {
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in TopologyRefinerSerializer::Deserialize() -- "
+            "invalid refiner properties.");
+        return 0;
+    }
+
+    TopologyRefiner * refiner =
+        new TopologyRefiner((Sdc::SchemeType) schemeType, schemeOptions);
+
+    refiner->_isUniform       = (isUniform != 0);
+    refiner->_hasHoles        = (hasHoles != 0);
+    refiner->_hasIrregFaces   = (hasIrregFaces != 0);
+    refiner->_maxLevel        = maxLevel;
+    refiner->_uniformOptions  = uniformOptions;
+    refiner->_adaptiveOptions = adaptiveOptions;
+
+    bool isValid = refiner->getLevel(0).read(stream);
+    if (isValid) {
+        refiner->initializeInventory();
+
+        Sdc::Split splitType = Sdc::SchemeTypeTraits::GetTopologicalSplitType(
+                refiner->_subdivType);
+
+        bool useArena = refiner->_isUniform ? uniformOptions.useArena
+                                            : adaptiveOptions.useArena;
+        if (useArena && (numRefinements > 0)) {
+            refiner->_arena = internal::NewArena();
+        }
+
+        for (int i = 1; isValid && (i <= numRefinements); ++i) {
+            Vtr::internal::Level& parentLevel = refiner->getLevel(i-1);
+            Vtr::internal::Level& childLevel  = *(new Vtr::internal::Level(refiner->_arena));
+
+            Vtr::internal::Refinement* refinement = 0;
+            if (splitType == Sdc::SPLIT_TO_QUADS) {
+                refinement = new Vtr::internal::QuadRefinement(parentLevel, childLevel, schemeOptions);
+            } else {
+                refinement = new Vtr::internal::TriRefinement(parentLevel, childLevel, schemeOptions);
+            }
+            isValid = refinement->read(stream);
+
+            //  Append regardless so that the refiner owns (and deletes) both:
+            refiner->appendLevel(childLevel);
+            refiner->appendRefinement(*refinement);
+        }
+
+        //  The trailing padding must also be present to not accept a buffer
+        //  truncated within it:
+        stream.align();
+        isValid = isValid && stream.isValid();
+    }
+    if (!isValid) {
+        delete refiner;
+
+        Error(FAR_RUNTIME_ERROR,
+            "Failure in TopologyRefinerSerializer::Deserialize() -- "
+            "invalid or truncated buffer.");
+        return 0;
+    }
+
+    refiner->assembleFarLevels();
+    refiner->updateMemoryStats();
+    return refiner;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,101 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_TOPOLOGY_REFINER_SERIALIZER_H
+#define OPENSUBDIV3_FAR_TOPOLOGY_REFINER_SERIALIZER_H
+
+#include "../version.h"
+
+#include "../far/topologyRefiner.h"
+
+#include <cstddef>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Vtr { namespace internal { class BinaryWriter; } }
+
+namespace Far {
+
+///
+/// \brief Writes and reads a TopologyRefiner to/from a flat binary buffer
+///
+/// All levels and refinements of a TopologyRefiner -- including face-varying
+/// channels -- are written so that the refiner can be reconstituted without
+/// repeating any of the analysis or refinement that produced it, e.g. to
+/// reduce the cost of loading assets whose topology has been refined offline.
+///
+/// The format is versioned and records the sizes of the internal types and
+/// the byte order of the host.  It is intended to be read by the same build
+/// of the library on the same platform that wrote it -- buffers that do not
+/// match are rejected when read.  Arrays within the buffer are aligned to 8
+/// bytes (relative to its start), so buffers may be read directly from a
+/// memory-mapped file.
+///
+class TopologyRefinerSerializer {
+
+public:
+
+    /// \brief Returns the size in bytes of the serialized refiner
+    static size_t GetSerializedSize(TopologyRefiner const & refiner);
+
+    /// \brief Writes the refiner to the given buffer
+    ///
+    /// @param refiner     The refiner to be written
+    ///
+    /// @param buffer      Destination buffer, of at least GetSerializedSize()
+    ///                    bytes
+    ///
+    /// @param bufferSize  Size of the destination buffer
+    ///
+    /// @return            The number of bytes written, or 0 if the buffer was
+    ///                    too small
+    ///
+    static size_t Serialize(TopologyRefiner const & refiner,
+                            void * buffer, size_t bufferSize);
+
+    /// \brief Creates a new refiner from the contents of a buffer
+    ///
+    /// @param buffer      Buffer previously written by Serialize()
+    ///
+    /// @param bufferSize  Size of the buffer
+    ///
+    /// @return            A new instance of TopologyRefiner or 0 if the
+    ///                    buffer is not valid or was written by an
+    ///                    incompatible build of the library
+    ///
+    static TopologyRefiner * Deserialize(void const * buffer, size_t bufferSize);
+
+private:
+    static void write(Vtr::internal::BinaryWriter & stream,
+                      TopologyRefiner const & refiner);
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_TOPOLOGY_REFINER_SERIALIZER_H */
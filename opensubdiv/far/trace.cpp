@@ -0,0 +1,88 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/trace.h"
+
+#include <cstdio>
+#ifdef _MSC_VER
+    #define snprintf _snprintf
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+//
+//  Statics for the publicly assignable callbacks and the method to
+//  assign them (disable static assignment warnings when doing so):
+//
+static TraceCallbackFunc traceBeginFunc = 0;
+static TraceCallbackFunc traceEndFunc = 0;
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 1711
+#endif
+
+void SetTraceCallbacks(TraceCallbackFunc beginFunc, TraceCallbackFunc endFunc) {
+    traceBeginFunc = beginFunc;
+    traceEndFunc = endFunc;
+}
+
+#ifdef __INTEL_COMPILER
+#pragma warning enable 1711
+#endif
+
+namespace internal {
+
+bool IsTraceEnabled() {
+    return (traceBeginFunc != 0) || (traceEndFunc != 0);
+}
+
+void TraceBegin(const char *name) {
+    if (traceBeginFunc) {
+        traceBeginFunc(name);
+    }
+}
+
+void TraceEnd(const char *name) {
+    if (traceEndFunc) {
+        traceEndFunc(name);
+    }
+}
+
+TraceScope::TraceScope(const char *prefix, int index) : _name(0) {
+    if (IsTraceEnabled()) {
+        snprintf(_buffer, sizeof(_buffer), "%s%d", prefix, index);
+        _name = _buffer;
+        TraceBegin(_name);
+    }
+}
+
+} // end namespace internal
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
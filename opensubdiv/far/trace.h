@@ -0,0 +1,135 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_TRACE_H
+#define OPENSUBDIV3_FAR_TRACE_H
+
+#include "../version.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief The trace callback function type, invoked on entering and leaving
+///        a stage of the library
+///
+/// Stage names are hierarchical and separated by periods, e.g.
+/// "refine.adaptive", "refine.level2", "patchTable.endcaps",
+/// "stencils.factorize" or "eval.stencils.tbb".  The name is only valid for
+/// the duration of the call and should be copied if retained.
+///
+/// Stages of the Osd evaluators may be entered concurrently when the
+/// evaluators are invoked from multiple threads, so callbacks are expected
+/// to be thread-safe.
+///
+typedef void (*TraceCallbackFunc)(const char *name);
+
+/// \brief Sets the callback functions invoked on entering and leaving each
+///        traced stage (default is none)
+///
+/// Tracing is compiled out of the library when it is built with
+/// OPENSUBDIV_NO_TRACE defined (the NO_TRACE CMake option), in which case
+/// the callbacks are never invoked.
+///
+/// \note This function is not thread-safe !
+///
+/// @param beginFunc  function pointer to the callback invoked on entering a
+///                   stage (or NULL)
+///
+/// @param endFunc    function pointer to the callback invoked on leaving a
+///                   stage (or NULL)
+///
+void SetTraceCallbacks(TraceCallbackFunc beginFunc, TraceCallbackFunc endFunc);
+
+
+//
+//  The following are intended for internal use only
+//
+namespace internal {
+
+/// \brief Returns true if trace callbacks are assigned (internal use only)
+bool IsTraceEnabled();
+
+/// \brief Invokes the callbacks for an entire stage (internal use only)
+void TraceBegin(const char *name);
+void TraceEnd(const char *name);
+
+//
+//  Scoped stage -- invoking the callbacks on construction and destruction.
+//  Names with a trailing index (e.g. the level of refinement) are only
+//  formatted when callbacks are assigned:
+//
+class TraceScope {
+public:
+    explicit TraceScope(const char *name) : _name(0) {
+        if (IsTraceEnabled()) {
+            _name = name;
+            TraceBegin(_name);
+        }
+    }
+    TraceScope(const char *prefix, int index);
+
+    ~TraceScope() {
+        if (_name) TraceEnd(_name);
+    }
+
+private:
+    //  Non-copyable:
+    TraceScope(TraceScope const &);
+    TraceScope & operator=(TraceScope const &);
+
+    const char * _name;
+    char         _buffer[64];
+};
+
+} // end namespace internal
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+//
+//  Macros to declare a traced scope -- removed entirely when compiled with
+//  OPENSUBDIV_NO_TRACE:
+//
+#ifdef OPENSUBDIV_NO_TRACE
+    #define OPENSUBDIV_TRACE_SCOPE(name)
+    #define OPENSUBDIV_TRACE_SCOPE_INDEXED(prefix, index)
+#else
+    #define OPENSUBDIV_TRACE_CONCAT_(a, b) a ## b
+    #define OPENSUBDIV_TRACE_CONCAT(a, b) OPENSUBDIV_TRACE_CONCAT_(a, b)
+
+    #define OPENSUBDIV_TRACE_SCOPE(name) \
+        OpenSubdiv::Far::internal::TraceScope \
+            OPENSUBDIV_TRACE_CONCAT(_osdTraceScope, __LINE__)(name)
+    #define OPENSUBDIV_TRACE_SCOPE_INDEXED(prefix, index) \
+        OpenSubdiv::Far::internal::TraceScope \
+            OPENSUBDIV_TRACE_CONCAT(_osdTraceScope, __LINE__)(prefix, index)
+#endif
+
+#endif // OPENSUBDIV3_FAR_TRACE_H
@@ -27,6 +27,7 @@
 
 #include "../version.h"
 
+#include "../far/config.h"
 #include "../vtr/types.h"
 
 namespace OpenSubdiv {
@@ -52,6 +53,18 @@ inline bool IndexIsValid(Index index) { return Vtr::IndexIsValid(index); }
 static const Index INDEX_INVALID = Vtr::INDEX_INVALID;
 static const int   VALENCE_LIMIT = Vtr::VALENCE_LIMIT;
 
+//
+//  Offsets into the flattened arrays of stencil tables, whose total number of
+//  elements (sources and weights) may exceed the range of Index for very large
+//  meshes.  The setting of OPENSUBDIV_64BIT_OFFSETS the library was built
+//  with is recorded in the generated far/config.h.
+//
+#ifdef OPENSUBDIV_64BIT_OFFSETS
+typedef long long Offset;
+#else
+typedef int       Offset;
+#endif
+
 } // end namespace Far
 
 } // end namespace OPENSUBDIV_VERSION
@@ -0,0 +1,158 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_VARYING_TABLE_H
+#define OPENSUBDIV3_FAR_VARYING_TABLE_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief Table of the parent vertices of refined vertices for varying
+///        interpolation
+///
+/// Varying primvars are interpolated bilinearly: a vertex refined from a
+/// face is the average of the vertices of the face, a vertex refined from
+/// an edge the average of its two end vertices and a vertex refined from a
+/// vertex a copy of it.  The weights of the sources of each refined vertex
+/// are hence all equal to the inverse of their number, and this table only
+/// stores the indices of the sources, which takes less than half of the
+/// memory of the equivalent varying StencilTable (no sizes and no weights).
+///
+/// The table covers the refined vertices of all levels in order, as a
+/// varying StencilTable generated with generateIntermediateLevels, but the
+/// sources of the vertices of a level are the vertices of the previous
+/// level rather than the control vertices: source indices refer to the
+/// control vertices followed by the refined vertices, and values are
+/// updated in a single buffer, e.g.
+///
+/// \code
+///     table->UpdateValues(&values[0], &values[table->GetNumControlVertices()]);
+/// \endcode
+///
+class VaryingTable {
+public:
+
+    /// \brief Returns the number of control vertices
+    int GetNumControlVertices() const { return _numControlVertices; }
+
+    /// \brief Returns the number of refined vertices (of all levels)
+    int GetNumVertices() const { return (int)_offsets.size() - 1; }
+
+    /// \brief Returns the number of refined vertices of a level (starting
+    ///        from the control vertices at level 0)
+    int GetNumVertices(int level) const {
+        return level ? (_levelOffsets[level] - _levelOffsets[level-1])
+                     : _numControlVertices;
+    }
+
+    /// \brief Returns the number of levels
+    int GetMaxLevel() const { return (int)_levelOffsets.size() - 1; }
+
+    /// \brief Returns the sources of a refined vertex
+    ConstIndexArray GetSources(Index vertex) const {
+        return ConstIndexArray(&_indices[_offsets[vertex]],
+                               _offsets[vertex+1] - _offsets[vertex]);
+    }
+
+    /// \brief Returns the offsets of the sources of the refined vertices,
+    ///        with a final offset to the end of the sources
+    std::vector<Index> const & GetOffsets() const { return _offsets; }
+
+    /// \brief Returns the sources of all refined vertices
+    std::vector<Index> const & GetIndices() const { return _indices; }
+
+    /// \brief Updates varying values of a range of refined vertices
+    ///
+    /// @param srcValues  Control values followed by the values of the
+    ///                   refined vertices preceding \p start
+    ///
+    /// @param dstValues  Destination values of the refined vertices
+    ///
+    /// @param start      (skip to) index of first refined vertex to update
+    ///
+    /// @param end        Index of last refined vertex to update
+    ///
+    template <class T, class U>
+    void UpdateValues(T const &srcValues, U &dstValues,
+                      Index start=-1, Index end=-1) const {
+
+        if (start < 0) start = 0;
+        if (end < start) end = GetNumVertices();
+
+        for (Index i = start; i < end; ++i) {
+            Index const * sources = &_indices[_offsets[i]];
+            int numSources = _offsets[i+1] - _offsets[i];
+
+            float weight = 1.0f / (float)numSources;
+
+            dstValues[i].Clear();
+            for (int j = 0; j < numSources; ++j) {
+                dstValues[i].AddWithWeight(srcValues[sources[j]], weight);
+            }
+        }
+    }
+
+    //  Pointer interface for consistency with StencilTable
+    template <class T, class U>
+    void UpdateValues(T const *src, U *dst,
+                      Index start=-1, Index end=-1) const {
+        UpdateValues<T const *, U *>(src, dst, start, end);
+    }
+
+    /// \brief Returns the number of bytes allocated by the table
+    size_t GetMemoryUsage() const {
+        return (_offsets.capacity() + _indices.capacity() +
+                _levelOffsets.capacity()) * sizeof(Index);
+    }
+
+private:
+    friend class VaryingTableFactory;
+
+    VaryingTable() : _numControlVertices(0) { }
+
+    int _numControlVertices;
+
+    std::vector<Index> _offsets;
+    std::vector<Index> _indices;
+    std::vector<Index> _levelOffsets;   // end of the vertices of each level
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_VARYING_TABLE_H */
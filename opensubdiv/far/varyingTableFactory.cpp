@@ -0,0 +1,134 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../far/varyingTableFactory.h"
+#include "../far/topologyLevel.h"
+#include "../far/trace.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+VaryingTable *
+VaryingTableFactory::Create(TopologyRefiner const & refiner) {
+
+    OPENSUBDIV_TRACE_SCOPE("varyingTable.create");
+
+    VaryingTable * table = new VaryingTable;
+
+    int maxLevel = refiner.GetMaxLevel();
+
+    table->_numControlVertices = refiner.GetLevel(0).GetNumVertices();
+    table->_levelOffsets.resize(maxLevel + 1, 0);
+
+    int numVertices = 0;
+    for (int level = 1; level <= maxLevel; ++level) {
+        numVertices += refiner.GetLevel(level).GetNumVertices();
+        table->_levelOffsets[level] = numVertices;
+    }
+
+    //
+    //  Count the sources of each vertex in the slot following its own, so
+    //  that accumulating the counts yields the offsets:
+    //
+    std::vector<Index> & offsets = table->_offsets;
+    offsets.resize(numVertices + 1, 0);
+
+    for (int level = 1; level <= maxLevel; ++level) {
+        TopologyLevel const & parent = refiner.GetLevel(level - 1);
+
+        Index * counts = &offsets[table->_levelOffsets[level - 1] + 1];
+
+        for (Index face = 0; face < parent.GetNumFaces(); ++face) {
+            Index cVert = parent.GetFaceChildVertex(face);
+            if (IndexIsValid(cVert)) {
+                counts[cVert] = parent.GetFaceVertices(face).size();
+            }
+        }
+        for (Index edge = 0; edge < parent.GetNumEdges(); ++edge) {
+            Index cVert = parent.GetEdgeChildVertex(edge);
+            if (IndexIsValid(cVert)) {
+                counts[cVert] = 2;
+            }
+        }
+        for (Index vert = 0; vert < parent.GetNumVertices(); ++vert) {
+            Index cVert = parent.GetVertexChildVertex(vert);
+            if (IndexIsValid(cVert)) {
+                counts[cVert] = 1;
+            }
+        }
+    }
+    for (int i = 0; i < numVertices; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    //
+    //  Gather the sources, offset to the vertices of the parent level in
+    //  the buffer of the control vertices followed by the refined vertices:
+    //
+    std::vector<Index> & indices = table->_indices;
+    indices.resize(offsets[numVertices]);
+
+    for (int level = 1; level <= maxLevel; ++level) {
+        TopologyLevel const & parent = refiner.GetLevel(level - 1);
+
+        Index const * vertOffsets = &offsets[table->_levelOffsets[level - 1]];
+        Index parentBase = (level == 1) ? 0 :
+            (table->_numControlVertices + table->_levelOffsets[level - 2]);
+
+        for (Index face = 0; face < parent.GetNumFaces(); ++face) {
+            Index cVert = parent.GetFaceChildVertex(face);
+            if (IndexIsValid(cVert)) {
+                ConstIndexArray fVerts = parent.GetFaceVertices(face);
+                Index * sources = &indices[vertOffsets[cVert]];
+                for (int i = 0; i < fVerts.size(); ++i) {
+                    sources[i] = parentBase + fVerts[i];
+                }
+            }
+        }
+        for (Index edge = 0; edge < parent.GetNumEdges(); ++edge) {
+            Index cVert = parent.GetEdgeChildVertex(edge);
+            if (IndexIsValid(cVert)) {
+                ConstIndexArray eVerts = parent.GetEdgeVertices(edge);
+                Index * sources = &indices[vertOffsets[cVert]];
+                sources[0] = parentBase + eVerts[0];
+                sources[1] = parentBase + eVerts[1];
+            }
+        }
+        for (Index vert = 0; vert < parent.GetNumVertices(); ++vert) {
+            Index cVert = parent.GetVertexChildVertex(vert);
+            if (IndexIsValid(cVert)) {
+                indices[vertOffsets[cVert]] = parentBase + vert;
+            }
+        }
+    }
+    return table;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
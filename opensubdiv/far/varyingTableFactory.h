@@ -0,0 +1,77 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_VARYING_TABLE_FACTORY_H
+#define OPENSUBDIV3_FAR_VARYING_TABLE_FACTORY_H
+
+#include "../version.h"
+
+#include "../far/varyingTable.h"
+#include "../far/topologyRefiner.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief A specialized factory for VaryingTable
+///
+/// The sources of the refined vertices are gathered from the parent
+/// relations of the refinements, for uniform and adaptive (sparse)
+/// refinement alike.  The table replaces a varying StencilTable (see
+/// StencilTableFactory::INTERPOLATE_VARYING) generated with intermediate
+/// levels -- the levels are not factorized, since the sources combined
+/// over several levels no longer have equal weights.
+///
+/// The vertex interpolation of Sdc::SCHEME_BILINEAR is the same bilinear
+/// interpolation, so the table also refines the vertex primvars of bilinear
+/// meshes in place of a vertex StencilTable.  Their patches are all QUADS
+/// of refined vertices, for which PatchTableFactory creates no local points.
+///
+/// Varying values of the vertices of patches do not need a table: they
+/// are the varying values of the corners of the patches (see
+/// PatchTable::GetPatchVaryingVertices()).
+///
+class VaryingTableFactory {
+public:
+
+    /// \brief Instantiates a VaryingTable from the refined levels of a
+    ///        refiner
+    ///
+    /// @param refiner  TopologyRefiner from which to generate the table
+    ///
+    /// @return         A new instance of VaryingTable
+    ///
+    static VaryingTable * Create(TopologyRefiner const & refiner);
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_VARYING_TABLE_FACTORY_H */
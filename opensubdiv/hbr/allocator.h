@@ -35,6 +35,13 @@ typedef void (*HbrMemStatFunction)(size_t bytes);
 /**
  * HbrAllocator - derived from UtBlockAllocator.h, but embedded in
  * libhbrep.
+ *
+ * An allocator is owned by a single HbrMesh and performs no locking:
+ * separate meshes (each with their own allocators) may be built and
+ * refined concurrently on separate threads, but a single mesh must not
+ * be modified from more than one thread at a time.  All blocks are
+ * released at once by Clear() or on destruction, so objects need not
+ * be returned individually via Deallocate() beforehand.
  */
 template <typename T> class HbrAllocator {
 
@@ -493,12 +493,14 @@ template <class T>
 HbrMesh<T>::~HbrMesh() {
     GarbageCollect();
 
+    // Faces and vertices are destroyed but not returned to their
+    // allocators individually -- the allocators release all of their
+    // blocks at once when they are destroyed with the mesh
     int i;
     if (!faces.empty()) {
         for (i = 0; i < nfaces; ++i) {
             if (faces[i]) {
                 faces[i]->Destroy();
-                m_faceAllocator.Deallocate(faces[i]);
             }
         }
         if (s_memStatsDecrement) {
@@ -509,7 +511,6 @@ HbrMesh<T>::~HbrMesh() {
         for (i = 0; i < nvertices; ++i) {
             if (vertices[i]) {
                 vertices[i]->Destroy(this);
-                m_vertexAllocator.Deallocate(vertices[i]);
             }
         }
         if (s_memStatsDecrement) {
@@ -41,7 +41,11 @@ namespace Osd {
 ///        batching offset if the data buffer is combined across multiple
 ///        objects together.
 ///
-///        * Note that each element has the same data type (float)
+///        * Note that each element has the same data type, float unless
+///          elementType is ELEMENT_HALF (16-bit IEEE floats), in which case
+///          offset and stride count halves.  Half elements are read and
+///          written by the stencil evaluation of the GLSL compute evaluator,
+///          which accumulates in float.
 ///
 
 //  example:
@@ -60,11 +64,24 @@ namespace Osd {
 //
 struct BufferDescriptor {
 
+    /// \brief Data type of the elements
+    enum ElementType {
+        ELEMENT_FLOAT = 0,  ///< 32-bit float
+        ELEMENT_HALF        ///< 16-bit IEEE half float
+    };
+
     /// Default Constructor
-    BufferDescriptor() : offset(0), length(0), stride(0) { }
+    BufferDescriptor() : offset(0), length(0), stride(0),
+                         elementType(ELEMENT_FLOAT) { }
 
     /// Constructor
-    BufferDescriptor(int o, int l, int s) : offset(o), length(l), stride(s) { }
+    BufferDescriptor(int o, int l, int s, ElementType t = ELEMENT_FLOAT) :
+        offset(o), length(l), stride(s), elementType(t) { }
+
+    /// True if the elements are 16-bit half floats
+    bool IsHalf() const {
+        return elementType == ELEMENT_HALF;
+    }
 
     /// Returns the relative offset within a stride
     int GetLocalOffset() const {
@@ -80,13 +97,15 @@ struct BufferDescriptor {
     /// Resets the descriptor to default
     void Reset() {
         offset = length = stride = 0;
+        elementType = ELEMENT_FLOAT;
     }
 
     /// True if the descriptors are identical
     bool operator == (BufferDescriptor const &other) const {
         return (offset == other.offset &&
                 length == other.length &&
-                stride == other.stride);
+                stride == other.stride &&
+                elementType == other.elementType);
     }
 
     /// True if the descriptors are not identical
@@ -100,6 +119,62 @@ struct BufferDescriptor {
     int length;
     /// stride to the next element
     int stride;
+    /// data type of the elements
+    ElementType elementType;
+};
+
+/// \brief SoaBufferDescriptor describes buffer elements stored as a
+///        structure of arrays, each component of the primvar (e.g. X, Y
+///        and Z) in its own contiguous array of vertices. This is the
+///        layout of the SoA evaluations of CpuEvaluator, which vectorize
+///        across vertices rather than across the components of a vertex.
+///
+///        The component arrays are spaced by componentStride floats within
+///        the same buffer.
+///
+
+//  example:
+//       n
+//  -----+----------------------+----------------------+---------------------
+//       |  X0 X1 X2 ... Xm-1   |  Y0 Y1 Y2 ... Ym-1   |  Z0 Z1 Z2 ... Zm-1
+//  -----+----------------------+----------------------+---------------------
+//       <-- componentStride --->
+//
+//     - XYZ      (offset = n, numComponents = 3, componentStride = m)
+//
+struct SoaBufferDescriptor {
+
+    /// Default Constructor
+    SoaBufferDescriptor() : offset(0), numComponents(0), componentStride(0) { }
+
+    /// Constructor
+    SoaBufferDescriptor(int o, int n, int s) :
+        offset(o), numComponents(n), componentStride(s) { }
+
+    /// True if the descriptor values are internally consistent
+    bool IsValid() const {
+        return ((numComponents > 0) &&
+                (numComponents == 1 || componentStride > 0));
+    }
+
+    /// True if the descriptors are identical
+    bool operator == (SoaBufferDescriptor const &other) const {
+        return (offset == other.offset &&
+                numComponents == other.numComponents &&
+                componentStride == other.componentStride);
+    }
+
+    /// True if the descriptors are not identical
+    bool operator != (SoaBufferDescriptor const &other) const {
+        return !(this->operator==(other));
+    }
+
+    /// offset to the first vertex of the first component
+    int offset;
+    /// number of components (arrays) of the data
+    int numComponents;
+    /// stride from one component array to the next
+    int componentStride;
 };
 
 } // end namespace Osd
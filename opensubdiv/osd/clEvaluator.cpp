@@ -32,6 +32,7 @@
 #include "../osd/opencl.h"
 #include "../far/error.h"
 #include "../far/stencilTable.h"
+#include "../osd/stencilOffsets.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -73,6 +74,17 @@ createCLBuffer(std::vector<T> const & src, cl_context clContext) {
     return devicePtr;
 }
 
+#ifdef OPENSUBDIV_64BIT_OFFSETS
+// The kernels address the stencil tables with 32-bit offsets (tables
+// exceeding them are rejected)
+static cl_mem
+createCLBuffer(std::vector<Far::Offset> const & src, cl_context clContext) {
+    std::vector<int> offsets;
+    if (! internal::NarrowStencilOffsets(src, offsets)) return NULL;
+    return createCLBuffer(offsets, clContext);
+}
+#endif
+
 // ----------------------------------------------------------------------------
 
 CLStencilTable::CLStencilTable(Far::StencilTable const *stencilTable,
@@ -0,0 +1,108 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/cpuCompactStencilTable.h"
+#include "../far/stencilTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+namespace {
+    unsigned int
+    packEntry(int indexDelta, int weight) {
+        return (unsigned int)indexDelta |
+               ((unsigned int)(weight & 0xffff) << 16);
+    }
+}
+
+CpuCompactStencilTable::CpuCompactStencilTable(
+    Far::StencilTable const *stencilTable) {
+
+    static int const maxDelta  = 0xffff;
+    static int const maxWeight = 0x7fff;
+
+    int numStencils = stencilTable->GetNumStencils();
+
+    _sizes.resize(numStencils);
+    _offsets.resize(numStencils);
+    _baseIndices.resize(numStencils);
+    _scales.resize(numStencils);
+    _entries.reserve(stencilTable->GetControlIndices().size());
+
+    std::vector<std::pair<int, float> > stencilEntries;
+
+    for (int i = 0; i < numStencils; ++i) {
+        Far::Stencil stencil = stencilTable->GetStencil(i);
+
+        int           size    = stencil.GetSize();
+        int const *   indices = stencil.GetVertexIndices();
+        float const * weights = stencil.GetWeights();
+
+        //  Sort the entries by control vertex so that deltas are positive:
+        stencilEntries.resize(size);
+        float maxAbsWeight = 0.0f;
+        for (int j = 0; j < size; ++j) {
+            stencilEntries[j] = std::make_pair(indices[j], weights[j]);
+            maxAbsWeight = std::max(maxAbsWeight, std::abs(weights[j]));
+        }
+        std::sort(stencilEntries.begin(), stencilEntries.end());
+
+        float scale = maxAbsWeight / (float)maxWeight;
+        int   base  = size ? stencilEntries[0].first : 0;
+
+        _offsets[i]     = (Far::Offset)_entries.size();
+        _baseIndices[i] = base;
+        _scales[i]      = scale;
+
+        int previous = base;
+        for (int j = 0; j < size; ++j) {
+            int delta = stencilEntries[j].first - previous;
+            for ( ; delta > maxDelta; delta -= maxDelta) {
+                _entries.push_back(packEntry(maxDelta, 0));
+            }
+
+            int weight = 0;
+            if (scale > 0.0f) {
+                weight = (int)std::floor(stencilEntries[j].second / scale + 0.5f);
+                weight = std::max(-maxWeight, std::min(maxWeight, weight));
+            }
+            _entries.push_back(packEntry(delta, weight));
+
+            previous = stencilEntries[j].first;
+        }
+        _sizes[i] = (int)((Far::Offset)_entries.size() - _offsets[i]);
+    }
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
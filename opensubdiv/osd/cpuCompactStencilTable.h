@@ -0,0 +1,121 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_CPU_COMPACT_STENCIL_TABLE_H
+#define OPENSUBDIV3_OSD_CPU_COMPACT_STENCIL_TABLE_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class StencilTable;
+}
+
+namespace Osd {
+
+/// \brief Cpu compact stencil table
+///
+/// This class is a quantized representation of the primvar weights of a
+/// Far::StencilTable, which needs half of the memory (and bandwidth) of the
+/// original table for the stencil entries:
+///
+///  - the entries of each stencil are sorted by control vertex, and each
+///    entry packs the 16-bit delta from the index of the previous entry
+///    (or from the base index of the stencil) with a 16-bit signed weight.
+///
+///  - weights are scaled per stencil so that the largest weight of the
+///    stencil maps to the largest 16-bit value, which preserves about five
+///    significant digits of each weight.
+///
+///  - deltas that exceed 16 bits are split with additional entries of zero
+///    weight, so sizes and offsets of the compact table differ from those
+///    of the original table.
+///
+/// Only the primvar weights are represented -- derivative weights of limit
+/// stencil tables are ignored. The table is also used as the staging buffer
+/// for the device-specific compact stencil tables.
+///
+class CpuCompactStencilTable {
+public:
+    static CpuCompactStencilTable *Create(Far::StencilTable const *stencilTable,
+                                          void *deviceContext = NULL) {
+        (void)deviceContext;  // unused
+        return new CpuCompactStencilTable(stencilTable);
+    }
+
+    explicit CpuCompactStencilTable(Far::StencilTable const *stencilTable);
+    ~CpuCompactStencilTable() {}
+
+    /// \brief Decodes an entry into its control vertex delta and weight
+    static int GetEntryIndexDelta(unsigned int entry) {
+        return (int)(entry & 0xffff);
+    }
+    static float GetEntryWeight(unsigned int entry, float scale) {
+        return (float)(short)(entry >> 16) * scale;
+    }
+
+    int GetNumStencils() const { return (int)_sizes.size(); }
+
+    std::vector<int> const & GetSizes() const { return _sizes; }
+    std::vector<Far::Offset> const & GetOffsets() const { return _offsets; }
+    std::vector<int> const & GetBaseIndices() const { return _baseIndices; }
+    std::vector<float> const & GetScales() const { return _scales; }
+    std::vector<unsigned int> const & GetEntries() const { return _entries; }
+
+    // interfaces needed for CpuEvaluator
+    int const * GetSizesBuffer() const { return bufferOf(_sizes); }
+    Far::Offset const * GetOffsetsBuffer() const { return bufferOf(_offsets); }
+    int const * GetBaseIndicesBuffer() const { return bufferOf(_baseIndices); }
+    float const * GetScalesBuffer() const { return bufferOf(_scales); }
+    unsigned int const * GetEntriesBuffer() const { return bufferOf(_entries); }
+
+private:
+    template <typename T>
+    static T const * bufferOf(std::vector<T> const & v) {
+        return v.empty() ? 0 : &v[0];
+    }
+
+    std::vector<int>          _sizes;
+    std::vector<Far::Offset>  _offsets;
+    std::vector<int>          _baseIndices;
+    std::vector<float>        _scales;
+    std::vector<unsigned int> _entries;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_COMPACT_STENCIL_TABLE_H
@@ -24,11 +24,11 @@
 
 #include "../osd/cpuEvaluator.h"
 #include "../osd/cpuKernel.h"
-#include "../osd/patchBasisCommonTypes.h"
-#include "../osd/patchBasisCommon.h"
-#include "../osd/patchBasisCommonEval.h"
+#include "../far/stencilTable.h"
+#include "../far/trace.h"
 
 #include <cstdlib>
+#include <vector>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -40,11 +40,13 @@ bool
 CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
                            float *dst,       BufferDescriptor const &dstDesc,
                            const int * sizes,
-                           const int * offsets,
+                           const Far::Offset * offsets,
                            const int * indices,
                            const float * weights,
                            int start, int end) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
 
@@ -55,19 +57,180 @@ CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
     return true;
 }
 
+/* static */
+bool
+CpuEvaluator::EvalStencils(PrimvarBinding const * bindings, int numBindings,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const float * weights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    for (int b = 0; b < numBindings; ++b) {
+        if (bindings[b].srcDesc.length != bindings[b].dstDesc.length) {
+            return false;
+        }
+    }
+
+    CpuEvalStencils(bindings, numBindings, sizes, offsets, indices, weights,
+                    start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const float * weights,
+                           const int * stencilIndices,
+                           int numStencilIndices) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (numStencilIndices <= 0) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, indices, weights,
+                    stencilIndices, numStencilIndices);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * baseIndices,
+                           const float * scales,
+                           const unsigned int * entries,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, baseIndices, scales, entries, start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           const Far::Index * offsets,
+                           const Far::Index * indices,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc, offsets, indices, start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           float *du,        BufferDescriptor const &duDesc,
+                           float *dv,        BufferDescriptor const &dvDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const float * weights,
+                           const unsigned short * duWeights,
+                           const unsigned short * dvWeights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    du,  duDesc, dv,  dvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    start, end);
+
+    return true;
+}
+
 /* static */
 bool
 CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
                            float *dst,       BufferDescriptor const &dstDesc,
                            float *du,        BufferDescriptor const &duDesc,
                            float *dv,        BufferDescriptor const &dvDesc,
+                           float *duu,       BufferDescriptor const &duuDesc,
+                           float *duv,       BufferDescriptor const &duvDesc,
+                           float *dvv,       BufferDescriptor const &dvvDesc,
                            const int * sizes,
-                           const int * offsets,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const float * weights,
+                           const unsigned short * duWeights,
+                           const unsigned short * dvWeights,
+                           const unsigned short * duuWeights,
+                           const unsigned short * duvWeights,
+                           const unsigned short * dvvWeights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+    if (srcDesc.length != duuDesc.length) return false;
+    if (srcDesc.length != duvDesc.length) return false;
+    if (srcDesc.length != dvvDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    du,  duDesc, dv,  dvDesc,
+                    duu, duuDesc, duv, duvDesc, dvv, dvvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    duuWeights, duvWeights, dvvWeights,
+                    start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           float *du,        BufferDescriptor const &duDesc,
+                           float *dv,        BufferDescriptor const &dvDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
                            const int * indices,
                            const float * weights,
                            const float * duWeights,
                            const float * dvWeights,
                            int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
     if (srcDesc.length != duDesc.length) return false;
@@ -94,7 +257,203 @@ CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
                            float *duv,       BufferDescriptor const &duvDesc,
                            float *dvv,       BufferDescriptor const &dvvDesc,
                            const int * sizes,
-                           const int * offsets,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const float * weights,
+                           const float * duWeights,
+                           const float * dvWeights,
+                           const float * duuWeights,
+                           const float * duvWeights,
+                           const float * dvvWeights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+    if (srcDesc.length != duuDesc.length) return false;
+    if (srcDesc.length != duvDesc.length) return false;
+    if (srcDesc.length != dvvDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    du,  duDesc,
+                    dv,  dvDesc,
+                    duu, duuDesc,
+                    duv, duvDesc,
+                    dvv, dvvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    duuWeights, duvWeights, dvvWeights,
+                    start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const double *src, BufferDescriptor const &srcDesc,
+                           double *dst,       BufferDescriptor const &dstDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const double * weights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, indices, weights, start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const double *src, BufferDescriptor const &srcDesc,
+                           double *dst,       BufferDescriptor const &dstDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const float * weights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, indices, weights, start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const double *src, BufferDescriptor const &srcDesc,
+                           double *dst,       BufferDescriptor const &dstDesc,
+                           double *du,        BufferDescriptor const &duDesc,
+                           double *dv,        BufferDescriptor const &dvDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const double * weights,
+                           const double * duWeights,
+                           const double * dvWeights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    du,  duDesc,
+                    dv,  dvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const double *src, BufferDescriptor const &srcDesc,
+                           double *dst,       BufferDescriptor const &dstDesc,
+                           double *du,        BufferDescriptor const &duDesc,
+                           double *dv,        BufferDescriptor const &dvDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const float * weights,
+                           const float * duWeights,
+                           const float * dvWeights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    du,  duDesc,
+                    dv,  dvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const double *src, BufferDescriptor const &srcDesc,
+                           double *dst,       BufferDescriptor const &dstDesc,
+                           double *du,        BufferDescriptor const &duDesc,
+                           double *dv,        BufferDescriptor const &dvDesc,
+                           double *duu,       BufferDescriptor const &duuDesc,
+                           double *duv,       BufferDescriptor const &duvDesc,
+                           double *dvv,       BufferDescriptor const &dvvDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const double * weights,
+                           const double * duWeights,
+                           const double * dvWeights,
+                           const double * duuWeights,
+                           const double * duvWeights,
+                           const double * dvvWeights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+    if (srcDesc.length != duuDesc.length) return false;
+    if (srcDesc.length != duvDesc.length) return false;
+    if (srcDesc.length != dvvDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    du,  duDesc,
+                    dv,  dvDesc,
+                    duu, duuDesc,
+                    duv, duvDesc,
+                    dvv, dvvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    duuWeights, duvWeights, dvvWeights,
+                    start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const double *src, BufferDescriptor const &srcDesc,
+                           double *dst,       BufferDescriptor const &dstDesc,
+                           double *du,        BufferDescriptor const &duDesc,
+                           double *dv,        BufferDescriptor const &dvDesc,
+                           double *duu,       BufferDescriptor const &duuDesc,
+                           double *duv,       BufferDescriptor const &duvDesc,
+                           double *dvv,       BufferDescriptor const &dvvDesc,
+                           const int * sizes,
+                           const Far::Offset * offsets,
                            const int * indices,
                            const float * weights,
                            const float * duWeights,
@@ -103,58 +462,135 @@ CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
                            const float * duvWeights,
                            const float * dvvWeights,
                            int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
-    if (srcDesc.length != duDesc.length) return false;
-    if (srcDesc.length != dvDesc.length) return false;
-    if (srcDesc.length != duuDesc.length) return false;
-    if (srcDesc.length != duvDesc.length) return false;
-    if (srcDesc.length != dvvDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+    if (srcDesc.length != duuDesc.length) return false;
+    if (srcDesc.length != duvDesc.length) return false;
+    if (srcDesc.length != dvvDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    du,  duDesc,
+                    dv,  dvDesc,
+                    duu, duuDesc,
+                    duv, duvDesc,
+                    dvv, dvvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    duuWeights, duvWeights, dvvWeights,
+                    start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencilsNormals(const float *src, BufferDescriptor const &srcDesc,
+                                  float *dst,       BufferDescriptor const &dstDesc,
+                                  float *normal,    BufferDescriptor const &normalDesc,
+                                  const int * sizes,
+                                  const Far::Offset * offsets,
+                                  const int * indices,
+                                  const float * weights,
+                                  const float * duWeights,
+                                  const float * dvWeights,
+                                  int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length < 3 || normalDesc.length != 3) return false;
+    if (dst && srcDesc.length != dstDesc.length) return false;
+
+    CpuEvalStencilsNormals(src, srcDesc, dst, dstDesc, normal, normalDesc,
+                           sizes, offsets, indices,
+                           weights, duWeights, dvWeights, start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencilsSkinned(const float *src, BufferDescriptor const &srcDesc,
+                                  float *dst,       BufferDescriptor const &dstDesc,
+                                  const int * sizes,
+                                  const Far::Offset * offsets,
+                                  const int * indices,
+                                  const float * weights,
+                                  SkinningDescriptor const &skinning,
+                                  int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (srcDesc.length < 3 || srcDesc.length != dstDesc.length) return false;
+
+    CpuEvalStencilsSkinned(src, srcDesc, dst, dstDesc,
+                           sizes, offsets, indices, weights,
+                           skinning, start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencilsSamples(const float *src, BufferDescriptor const &srcDesc,
+                                  float *dst,       BufferDescriptor const &dstDesc,
+                                  int numSamples, int srcSampleStride,
+                                  int dstSampleStride,
+                                  const int * sizes,
+                                  const Far::Offset * offsets,
+                                  const int * indices,
+                                  const float * weights,
+                                  int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start || numSamples <= 0) return true;
+    if (srcDesc.length != dstDesc.length) return false;
 
-    CpuEvalStencils(src, srcDesc,
-                    dst, dstDesc,
-                    du,  duDesc,
-                    dv,  dvDesc,
-                    duu, duuDesc,
-                    duv, duvDesc,
-                    dvv, dvvDesc,
-                    sizes, offsets, indices,
-                    weights, duWeights, dvWeights,
-                    duuWeights, duvWeights, dvvWeights,
-                    start, end);
+    CpuEvalStencilsSamples(src, srcDesc, dst, dstDesc,
+                           numSamples, srcSampleStride, dstSampleStride,
+                           sizes, offsets, indices, weights, start, end);
 
     return true;
 }
 
-template <typename T>
-struct BufferAdapter {
-    BufferAdapter(T *p, int length, int stride) :
-        _p(p), _length(length), _stride(stride) { }
-    void Clear() {
-        for (int i = 0; i < _length; ++i) _p[i] = 0;
-    }
-    void AddWithWeight(T const *src, float w) {
-        if (_p) {
-            for (int i = 0; i < _length; ++i) {
-                _p[i] += src[i] * w;
-            }
-        }
-    }
-    const T *operator[] (int index) const {
-        return _p + _stride * index;
-    }
-    BufferAdapter<T> & operator ++() {
-        if (_p) {
-            _p += _stride;
-        }
-        return *this;
-    }
+/* static */
+bool
+CpuEvaluator::EvalStencilsBounds(const float *src, BufferDescriptor const &srcDesc,
+                                  float *dst,       BufferDescriptor const &dstDesc,
+                                  const int * sizes,
+                                  const Far::Offset * offsets,
+                                  const int * indices,
+                                  const float * weights,
+                                  BoundsDescriptor const &bounds,
+                                  int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (dstDesc.length < 3 || srcDesc.length != dstDesc.length) return false;
+    if (!bounds.bounds || bounds.numRanges < 1) return false;
+
+    CpuClearBounds(bounds);
+    if (end <= start) return true;
+
+    CpuEvalStencilsBounds(src, srcDesc, dst, dstDesc,
+                      sizes, offsets, indices, weights,
+                      bounds, start, end);
 
-    T *_p;
-    int _length;
-    int _stride;
-};
+    return true;
+}
 
+//
+//  Limit evaluation of patches -- consecutive coords on the same patch are
+//  evaluated together by the kernel (see CpuEvalPatches()):
+//
 /* static */
 bool
 CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
@@ -164,6 +600,9 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
                           const PatchArray *patchArrays,
                           const int *patchIndexBuffer,
                           const PatchParam *patchParamBuffer) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.cpu");
+
     if (src) {
         src += srcDesc.offset;
     } else {
@@ -176,38 +615,43 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
         return false;
     }
 
-    BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
-    BufferAdapter<float>       dstT(dst, dstDesc.length, dstDesc.stride);
-
-    float wP[20];
-
-    for (int i = 0; i < numPatchCoords; ++i) {
-        PatchCoord const &coord = patchCoords[i];
-        PatchArray const &array = patchArrays[coord.handle.arrayIndex];
-
-        Osd::PatchParam const & paramStruct =
-            patchParamBuffer[coord.handle.patchIndex];
-        OsdPatchParam param = OsdPatchParamInit(
-            paramStruct.field0, paramStruct.field1, paramStruct.sharpness);
-
-        int patchType = OsdPatchParamIsRegular(param)
-            ? array.GetPatchTypeRegular()
-            : array.GetPatchTypeIrregular();
+    BufferDescriptor none;
+    CpuEvalPatches(src, srcDesc, dst, dstDesc,
+                   0, none, 0, none, 0, none, 0, none, 0, none,
+                   patchCoords, 0, patchArrays,
+                   patchIndexBuffer, patchParamBuffer, 0, numPatchCoords);
+    return true;
+}
 
-        int nPoints = OsdEvaluatePatchBasis(patchType, param,
-                coord.s, coord.t, wP, 0, 0, 0, 0, 0);
+/* static */
+bool
+CpuEvaluator::EvalPatchesSamples(const float *src, BufferDescriptor const &srcDesc,
+                                 float *dst,       BufferDescriptor const &dstDesc,
+                                 float *du,        BufferDescriptor const &duDesc,
+                                 float *dv,        BufferDescriptor const &dvDesc,
+                                 int numSamples, int srcSampleStride,
+                                 int dstSampleStride,
+                                 int numPatchCoords,
+                                 const PatchCoord *patchCoords,
+                                 const PatchArray *patchArrays,
+                                 const int *patchIndexBuffer,
+                                 const PatchParam *patchParamBuffer) {
 
-        int indexBase = array.GetIndexBase() + array.GetStride() *
-                (coord.handle.patchIndex - array.GetPrimitiveIdBase());
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.cpu");
 
-        const int *cvs = &patchIndexBuffer[indexBase];
+    if (!src || !dst || numSamples <= 0) return false;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (du && srcDesc.length != duDesc.length) return false;
+    if (dv && srcDesc.length != dvDesc.length) return false;
 
-        dstT.Clear();
-        for (int j = 0; j < nPoints; ++j) {
-            dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
-        }
-        ++dstT;
-    }
+    CpuEvalPatchesSamples(src + srcDesc.offset, srcDesc,
+                          dst + dstDesc.offset, dstDesc,
+                          du ? du + duDesc.offset : 0, duDesc,
+                          dv ? dv + dvDesc.offset : 0, dvDesc,
+                          numSamples, srcSampleStride, dstSampleStride,
+                          patchCoords, patchArrays,
+                          patchIndexBuffer, patchParamBuffer,
+                          0, numPatchCoords);
     return true;
 }
 
@@ -222,6 +666,9 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
                           const PatchArray *patchArrays,
                           const int *patchIndexBuffer,
                           const PatchParam *patchParamBuffer) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.cpu");
+
     if (src) {
         src += srcDesc.offset;
     } else {
@@ -240,46 +687,11 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
         if (srcDesc.length != dvDesc.length) return false;
     }
 
-    BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
-    BufferAdapter<float>       dstT(dst, dstDesc.length, dstDesc.stride);
-    BufferAdapter<float>        duT(du,  duDesc.length,  duDesc.stride);
-    BufferAdapter<float>        dvT(dv,  dvDesc.length,  dvDesc.stride);
-
-    float wP[20], wDs[20], wDt[20];
-
-    for (int i = 0; i < numPatchCoords; ++i) {
-        PatchCoord const &coord = patchCoords[i];
-        PatchArray const &array = patchArrays[coord.handle.arrayIndex];
-
-        Osd::PatchParam const & paramStruct =
-            patchParamBuffer[coord.handle.patchIndex];
-        OsdPatchParam param = OsdPatchParamInit(
-            paramStruct.field0, paramStruct.field1, paramStruct.sharpness);
-
-        int patchType = OsdPatchParamIsRegular(param)
-            ? array.GetPatchTypeRegular()
-            : array.GetPatchTypeIrregular();
-
-        int nPoints = OsdEvaluatePatchBasis(patchType, param,
-                coord.s, coord.t, wP, wDs, wDt, 0, 0, 0);
-
-        int indexBase = array.GetIndexBase() + array.GetStride() *
-                (coord.handle.patchIndex - array.GetPrimitiveIdBase());
-
-        const int *cvs = &patchIndexBuffer[indexBase];
-
-        dstT.Clear();
-        duT.Clear();
-        dvT.Clear();
-        for (int j = 0; j < nPoints; ++j) {
-            dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
-            duT.AddWithWeight (srcT[cvs[j]], wDs[j]);
-            dvT.AddWithWeight (srcT[cvs[j]], wDt[j]);
-        }
-        ++dstT;
-        ++duT;
-        ++dvT;
-    }
+    BufferDescriptor none;
+    CpuEvalPatches(src, srcDesc, dst, dstDesc,
+                   du, duDesc, dv, dvDesc, 0, none, 0, none, 0, none,
+                   patchCoords, 0, patchArrays,
+                   patchIndexBuffer, patchParamBuffer, 0, numPatchCoords);
     return true;
 }
 
@@ -297,6 +709,9 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
                           const PatchArray *patchArrays,
                           const int *patchIndexBuffer,
                           const PatchParam *patchParamBuffer) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.cpu");
+
     if (src) {
         src += srcDesc.offset;
     } else {
@@ -327,61 +742,428 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
         if (srcDesc.length != dvvDesc.length) return false;
     }
 
-    BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
-    BufferAdapter<float>       dstT(dst, dstDesc.length, dstDesc.stride);
-    BufferAdapter<float>       duT(du,   duDesc.length,  duDesc.stride);
-    BufferAdapter<float>       dvT(dv,   dvDesc.length,  dvDesc.stride);
-    BufferAdapter<float>       duuT(duu, duuDesc.length, duuDesc.stride);
-    BufferAdapter<float>       duvT(duv, duvDesc.length, duvDesc.stride);
-    BufferAdapter<float>       dvvT(dvv, dvvDesc.length, dvvDesc.stride);
-
-    float wP[20], wDu[20], wDv[20], wDuu[20], wDuv[20], wDvv[20];
-
-    for (int i = 0; i < numPatchCoords; ++i) {
-        PatchCoord const &coord = patchCoords[i];
-        PatchArray const &array = patchArrays[coord.handle.arrayIndex];
-
-        Osd::PatchParam const & paramStruct =
-            patchParamBuffer[coord.handle.patchIndex];
-        OsdPatchParam param = OsdPatchParamInit(
-            paramStruct.field0, paramStruct.field1, paramStruct.sharpness);
-
-        int patchType = OsdPatchParamIsRegular(param)
-            ? array.GetPatchTypeRegular()
-            : array.GetPatchTypeIrregular();
-
-        int nPoints = OsdEvaluatePatchBasis(patchType, param,
-                coord.s, coord.t, wP, wDu, wDv, wDuu, wDuv, wDvv);
-
-        int indexBase = array.GetIndexBase() + array.GetStride() *
-                (coord.handle.patchIndex - array.GetPrimitiveIdBase());
-
-        const int *cvs = &patchIndexBuffer[indexBase];
-
-        dstT.Clear();
-        duT.Clear();
-        dvT.Clear();
-        duuT.Clear();
-        duvT.Clear();
-        dvvT.Clear();
-        for (int j = 0; j < nPoints; ++j) {
-            dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
-            duT.AddWithWeight (srcT[cvs[j]], wDu[j]);
-            dvT.AddWithWeight (srcT[cvs[j]], wDv[j]);
-            duuT.AddWithWeight (srcT[cvs[j]], wDuu[j]);
-            duvT.AddWithWeight (srcT[cvs[j]], wDuv[j]);
-            dvvT.AddWithWeight (srcT[cvs[j]], wDvv[j]);
-        }
-        ++dstT;
-        ++duT;
-        ++dvT;
-        ++duuT;
-        ++duvT;
-        ++dvvT;
+    CpuEvalPatches(src, srcDesc, dst, dstDesc,
+                   du, duDesc, dv, dvDesc,
+                   duu, duuDesc, duv, duvDesc, dvv, dvvDesc,
+                   patchCoords, 0, patchArrays,
+                   patchIndexBuffer, patchParamBuffer, 0, numPatchCoords);
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatchesNormals(const float *src, BufferDescriptor const &srcDesc,
+                                 float *dst,       BufferDescriptor const &dstDesc,
+                                 float *normal,    BufferDescriptor const &normalDesc,
+                                 int numPatchCoords,
+                                 const PatchCoord *patchCoords,
+                                 const PatchArray *patchArrays,
+                                 const int *patchIndexBuffer,
+                                 const PatchParam *patchParamBuffer) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.cpu");
+
+    if (src) {
+        src += srcDesc.offset;
+    } else {
+        return false;
+    }
+    if (srcDesc.length < 3) return false;
+    if (dst) {
+        if (srcDesc.length != dstDesc.length) return false;
+        dst += dstDesc.offset;
+    }
+    if (normal) {
+        if (normalDesc.length != 3) return false;
+        normal += normalDesc.offset;
+    } else {
+        return false;
+    }
+
+    CpuEvalPatchesNormals(src, srcDesc, dst, dstDesc, normal, normalDesc,
+                          patchCoords, patchArrays,
+                          patchIndexBuffer, patchParamBuffer,
+                          0, numPatchCoords);
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatchesDisplaced(const float *src, BufferDescriptor const &srcDesc,
+                                   float *dst,       BufferDescriptor const &dstDesc,
+                                   float *normal,    BufferDescriptor const &normalDesc,
+                                   int numPatchCoords,
+                                   const PatchCoord *patchCoords,
+                                   const PatchArray *patchArrays,
+                                   const int *patchIndexBuffer,
+                                   const PatchParam *patchParamBuffer,
+                                   DisplacementSampler sampler,
+                                   void *samplerData) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.cpu");
+
+    if (src) {
+        src += srcDesc.offset;
+    } else {
+        return false;
+    }
+    if (srcDesc.length < 3) return false;
+    if (dst) {
+        if (srcDesc.length != dstDesc.length) return false;
+        dst += dstDesc.offset;
+    } else {
+        return false;
+    }
+    if (normal) {
+        if (normalDesc.length != 3) return false;
+        normal += normalDesc.offset;
+    }
+    if (sampler == NULL) return false;
+
+    CpuEvalPatchesDisplaced(src, srcDesc, dst, dstDesc, normal, normalDesc,
+                            patchCoords, patchArrays,
+                            patchIndexBuffer, patchParamBuffer,
+                            sampler, samplerData,
+                            0, numPatchCoords);
+    return true;
+}
+
+//
+//  Limit evaluation of double-precision primvar data -- the patch basis is
+//  evaluated in double precision with Far, for the point and any of its
+//  derivatives with a destination:
+//
+static bool
+evalPatchesDouble(const double *src, BufferDescriptor const &srcDesc,
+                  double *dst,       BufferDescriptor const &dstDesc,
+                  double *du,        BufferDescriptor const &duDesc,
+                  double *dv,        BufferDescriptor const &dvDesc,
+                  double *duu,       BufferDescriptor const &duuDesc,
+                  double *duv,       BufferDescriptor const &duvDesc,
+                  double *dvv,       BufferDescriptor const &dvvDesc,
+                  int numPatchCoords,
+                  const PatchCoord *patchCoords,
+                  const PatchArray *patchArrays,
+                  const int *patchIndexBuffer,
+                  const PatchParam *patchParamBuffer) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.cpu");
+
+    if (src) {
+        src += srcDesc.offset;
+    } else {
+        return false;
+    }
+    if (dst) {
+        if (srcDesc.length != dstDesc.length) return false;
+        dst += dstDesc.offset;
+    }
+    if (du) {
+        du  += duDesc.offset;
+        if (srcDesc.length != duDesc.length) return false;
+    }
+    if (dv) {
+        dv  += dvDesc.offset;
+        if (srcDesc.length != dvDesc.length) return false;
+    }
+    if (duu) {
+        duu += duuDesc.offset;
+        if (srcDesc.length != duuDesc.length) return false;
+    }
+    if (duv) {
+        duv += duvDesc.offset;
+        if (srcDesc.length != duvDesc.length) return false;
+    }
+    if (dvv) {
+        dvv += dvvDesc.offset;
+        if (srcDesc.length != dvvDesc.length) return false;
+    }
+
+    CpuEvalPatches(src, srcDesc, dst, dstDesc,
+                   du, duDesc, dv, dvDesc,
+                   duu, duuDesc, duv, duvDesc, dvv, dvvDesc,
+                   patchCoords, 0, patchArrays,
+                   patchIndexBuffer, patchParamBuffer, 0, numPatchCoords);
+    return true;
+}
+
+//
+//  Limit evaluation of patches computing the points past the control vertices
+//  from their stencils:
+//
+/* static */
+bool
+CpuEvaluator::EvalPatchesWithStencils(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *du,        BufferDescriptor const &duDesc,
+    float *dv,        BufferDescriptor const &dvDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    Far::StencilTable const *stencilTable) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.stencils.cpu");
+
+    if (src) {
+        src += srcDesc.offset;
+    } else {
+        return false;
+    }
+    if (dst) {
+        if (srcDesc.length != dstDesc.length) return false;
+        dst += dstDesc.offset;
+    }
+    if (du) {
+        du  += duDesc.offset;
+        if (srcDesc.length != duDesc.length) return false;
+    }
+    if (dv) {
+        dv  += dvDesc.offset;
+        if (srcDesc.length != dvDesc.length) return false;
+    }
+
+    CpuPatchPointStencils stencils;
+    stencils.numControlVertices = stencilTable->GetNumControlVertices();
+    if (stencilTable->GetNumStencils() > 0) {
+        stencils.sizes   = &stencilTable->GetSizes()[0];
+        stencils.offsets = &stencilTable->GetOffsets()[0];
+        stencils.indices = &stencilTable->GetControlIndices()[0];
+        stencils.weights = &stencilTable->GetWeights()[0];
+    } else {
+        stencils.sizes = stencils.indices = 0;
+        stencils.offsets = 0;
+        stencils.weights = 0;
+    }
+
+    CpuEvalPatchesWithStencils(src, srcDesc, dst, dstDesc,
+                               du, duDesc, dv, dvDesc,
+                               patchCoords, patchArrays,
+                               patchIndexBuffer, patchParamBuffer,
+                               stencils, 0, numPatchCoords);
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatches(const double *src, BufferDescriptor const &srcDesc,
+                          double *dst,       BufferDescriptor const &dstDesc,
+                          int numPatchCoords,
+                          const PatchCoord *patchCoords,
+                          const PatchArray *patchArrays,
+                          const int *patchIndexBuffer,
+                          const PatchParam *patchParamBuffer) {
+
+    if (!dst) return false;
+
+    BufferDescriptor none;
+    return evalPatchesDouble(src, srcDesc, dst, dstDesc,
+                             0, none, 0, none, 0, none, 0, none, 0, none,
+                             numPatchCoords, patchCoords, patchArrays,
+                             patchIndexBuffer, patchParamBuffer);
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatches(const double *src, BufferDescriptor const &srcDesc,
+                          double *dst,       BufferDescriptor const &dstDesc,
+                          double *du,        BufferDescriptor const &duDesc,
+                          double *dv,        BufferDescriptor const &dvDesc,
+                          int numPatchCoords,
+                          const PatchCoord *patchCoords,
+                          const PatchArray *patchArrays,
+                          const int *patchIndexBuffer,
+                          const PatchParam *patchParamBuffer) {
+
+    BufferDescriptor none;
+    return evalPatchesDouble(src, srcDesc, dst, dstDesc,
+                             du, duDesc, dv, dvDesc, 0, none, 0, none, 0, none,
+                             numPatchCoords, patchCoords, patchArrays,
+                             patchIndexBuffer, patchParamBuffer);
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatches(const double *src, BufferDescriptor const &srcDesc,
+                          double *dst,       BufferDescriptor const &dstDesc,
+                          double *du,        BufferDescriptor const &duDesc,
+                          double *dv,        BufferDescriptor const &dvDesc,
+                          double *duu,       BufferDescriptor const &duuDesc,
+                          double *duv,       BufferDescriptor const &duvDesc,
+                          double *dvv,       BufferDescriptor const &dvvDesc,
+                          int numPatchCoords,
+                          const PatchCoord *patchCoords,
+                          const PatchArray *patchArrays,
+                          const int *patchIndexBuffer,
+                          const PatchParam *patchParamBuffer) {
+
+    return evalPatchesDouble(src, srcDesc, dst, dstDesc,
+                             du, duDesc, dv, dvDesc,
+                             duu, duuDesc, duv, duvDesc, dvv, dvvDesc,
+                             numPatchCoords, patchCoords, patchArrays,
+                             patchIndexBuffer, patchParamBuffer);
+}
+
+//
+//  Structure of arrays evaluations -- the descriptors are resolved to the
+//  pointers of the component arrays taken by the kernels:
+//
+template <typename T> static bool
+bindSoaComponents(T * buffer, SoaBufferDescriptor const &desc,
+                  int numComponents, std::vector<T *> & components) {
+
+    if (!buffer) {
+        components.clear();
+        return true;
+    }
+    if (!desc.IsValid() || desc.numComponents != numComponents) return false;
+
+    components.resize(numComponents);
+    for (int c = 0; c < numComponents; ++c) {
+        components[c] = buffer + desc.offset + c * desc.componentStride;
+    }
+    return true;
+}
+
+template <typename T> static T *
+componentsOrNull(std::vector<T> & components) {
+    return components.empty() ? 0 : &components[0];
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencilsSoa(const float *src, SoaBufferDescriptor const &srcDesc,
+                              float *dst,       SoaBufferDescriptor const &dstDesc,
+                              float *du,        SoaBufferDescriptor const &duDesc,
+                              float *dv,        SoaBufferDescriptor const &dvDesc,
+                              const int * sizes,
+                              const Far::Offset * offsets,
+                              const int * indices,
+                              const float * weights,
+                              const float * duWeights,
+                              const float * dvWeights,
+                              int start, int end) {
+
+    if (!src || !srcDesc.IsValid()) return false;
+
+    int numComponents = srcDesc.numComponents;
+
+    std::vector<float const *> srcComponents;
+    std::vector<float *> dstComponents, duComponents, dvComponents;
+    if (!bindSoaComponents(src, srcDesc, numComponents, srcComponents) ||
+        !bindSoaComponents(dst, dstDesc, numComponents, dstComponents) ||
+        !bindSoaComponents(du,  duDesc,  numComponents, duComponents) ||
+        !bindSoaComponents(dv,  dvDesc,  numComponents, dvComponents)) {
+        return false;
+    }
+
+    return EvalStencilsSoa(&srcComponents[0],
+                           componentsOrNull(dstComponents),
+                           componentsOrNull(duComponents),
+                           componentsOrNull(dvComponents),
+                           numComponents, sizes, offsets, indices,
+                           weights, duWeights, dvWeights, start, end);
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencilsSoa(const float * const *src,
+                              float * const *dst,
+                              float * const *du,
+                              float * const *dv,
+                              int numComponents,
+                              const int * sizes,
+                              const Far::Offset * offsets,
+                              const int * indices,
+                              const float * weights,
+                              const float * duWeights,
+                              const float * dvWeights,
+                              int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.cpu");
+
+    if (end <= start) return true;
+    if (!src || !dst || numComponents <= 0) return false;
+    if ((du != 0) != (dv != 0)) return false;
+    if (du && (!duWeights || !dvWeights)) return false;
+
+    CpuEvalStencilsSoa(src, dst, du, dv, numComponents,
+                       sizes, offsets, indices,
+                       weights, duWeights, dvWeights, start, end);
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatchesSoa(const float *src, SoaBufferDescriptor const &srcDesc,
+                             float *dst,       SoaBufferDescriptor const &dstDesc,
+                             float *du,        SoaBufferDescriptor const &duDesc,
+                             float *dv,        SoaBufferDescriptor const &dvDesc,
+                             int numPatchCoords,
+                             const PatchCoord *patchCoords,
+                             const PatchArray *patchArrays,
+                             const int *patchIndexBuffer,
+                             const PatchParam *patchParamBuffer) {
+
+    if (!src || !srcDesc.IsValid()) return false;
+
+    int numComponents = srcDesc.numComponents;
+
+    std::vector<float const *> srcComponents;
+    std::vector<float *> dstComponents, duComponents, dvComponents;
+    if (!bindSoaComponents(src, srcDesc, numComponents, srcComponents) ||
+        !bindSoaComponents(dst, dstDesc, numComponents, dstComponents) ||
+        !bindSoaComponents(du,  duDesc,  numComponents, duComponents) ||
+        !bindSoaComponents(dv,  dvDesc,  numComponents, dvComponents)) {
+        return false;
     }
+
+    return EvalPatchesSoa(&srcComponents[0],
+                          componentsOrNull(dstComponents),
+                          componentsOrNull(duComponents),
+                          componentsOrNull(dvComponents),
+                          numComponents, numPatchCoords, patchCoords,
+                          patchArrays, patchIndexBuffer, patchParamBuffer);
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatchesSoa(const float * const *src,
+                             float * const *dst,
+                             float * const *du,
+                             float * const *dv,
+                             int numComponents,
+                             int numPatchCoords,
+                             const PatchCoord *patchCoords,
+                             const PatchArray *patchArrays,
+                             const int *patchIndexBuffer,
+                             const PatchParam *patchParamBuffer) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.cpu");
+
+    if (!src || numComponents <= 0) return false;
+    if (numPatchCoords <= 0) return true;
+
+    CpuEvalPatchesSoa(src, dst, du, dv, numComponents,
+                      patchCoords, patchArrays, patchIndexBuffer,
+                      patchParamBuffer, 0, numPatchCoords);
     return true;
 }
 
+/* static */
+void
+CpuEvaluator::SetReproducible(bool reproducible) {
+    CpuSetReproducible(reproducible);
+}
+
+/* static */
+bool
+CpuEvaluator::IsReproducible() {
+    return CpuIsReproducible();
+}
+
 
 }  // end namespace Osd
 
@@ -26,7 +26,10 @@
 #define OPENSUBDIV3_OSD_CPU_EVALUATOR_H
 
 #include "../version.h"
+#include "../far/varyingTable.h"
 #include "../osd/bufferDescriptor.h"
+#include "../osd/cpuCompactStencilTable.h"
+#include "../osd/cpuHalfLimitStencilTable.h"
 #include "../osd/types.h"
 
 #include <cstddef>
@@ -34,6 +37,10 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+namespace Far {
+    class StencilTable;
+}
+
 namespace Osd {
 
 class CpuEvaluator {
@@ -122,39 +129,17 @@ public:
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
         const int * sizes,
-        const int * offsets,
+        const Far::Offset * offsets,
         const int * indices,
         const float * weights,
         int start, int end);
 
-    /// \brief Generic static eval stencils function with derivatives.
-    ///        This function has a same signature as other device kernels
-    ///        have so that it can be called in the same way from OsdMesh
-    ///        template interface.
-    ///
-    /// @param srcBuffer      Input primvar buffer.
-    ///                       must have BindCpuBuffer() method returning a
-    ///                       const float pointer for read
-    ///
-    /// @param srcDesc        vertex buffer descriptor for the input buffer
-    ///
-    /// @param dstBuffer      Output primvar buffer
-    ///                       must have BindCpuBuffer() method returning a
-    ///                       float pointer for write
-    ///
-    /// @param dstDesc        vertex buffer descriptor for the output buffer
-    ///
-    /// @param duBuffer       Output buffer derivative wrt u
-    ///                       must have BindCpuBuffer() method returning a
-    ///                       float pointer for write
-    ///
-    /// @param duDesc         vertex buffer descriptor for the duBuffer
+    /// \brief Static eval stencils function applying the stencils of a table
+    ///        to several primvars in a single pass (see PrimvarBinding)
     ///
-    /// @param dvBuffer       Output buffer derivative wrt v
-    ///                       must have BindCpuBuffer() method returning a
-    ///                       float pointer for write
+    /// @param bindings       array of primvar bindings, with raw CPU pointers
     ///
-    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
+    /// @param numBindings    number of primvar bindings
     ///
     /// @param stencilTable   Far::StencilTable or equivalent
     ///
@@ -164,12 +149,9 @@ public:
     ///
     /// @param deviceContext  not used in the cpu kernel
     ///
-    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    template <typename STENCIL_TABLE>
     static bool EvalStencils(
-        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
-        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
-        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
-        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        PrimvarBinding const * bindings, int numBindings,
         STENCIL_TABLE const *stencilTable,
         const CpuEvaluator *instance = NULL,
         void * deviceContext = NULL) {
@@ -177,43 +159,24 @@ public:
         (void)instance;       // unused
         (void)deviceContext;  // unused
 
-        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
-                            dstBuffer->BindCpuBuffer(), dstDesc,
-                            duBuffer->BindCpuBuffer(),  duDesc,
-                            dvBuffer->BindCpuBuffer(),  dvDesc,
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalStencils(bindings, numBindings,
                             &stencilTable->GetSizes()[0],
                             &stencilTable->GetOffsets()[0],
                             &stencilTable->GetControlIndices()[0],
                             &stencilTable->GetWeights()[0],
-                            &stencilTable->GetDuWeights()[0],
-                            &stencilTable->GetDvWeights()[0],
                             /*start = */ 0,
                             /*end   = */ stencilTable->GetNumStencils());
     }
 
-    /// \brief Static eval stencils function with derivatives, which takes
-    ///        raw CPU pointers for input and output.
-    ///
-    /// @param src            Input primvar pointer. An offset of srcDesc
-    ///                       will be applied internally (i.e. the pointer
-    ///                       should not include the offset)
-    ///
-    /// @param srcDesc        vertex buffer descriptor for the input buffer
-    ///
-    /// @param dst            Output primvar pointer. An offset of dstDesc
-    ///                       will be applied internally.
-    ///
-    /// @param dstDesc        vertex buffer descriptor for the output buffer
-    ///
-    /// @param du             Output pointer derivative wrt u. An offset of
-    ///                       duDesc will be applied internally.
-    ///
-    /// @param duDesc         vertex buffer descriptor for the duBuffer
+    /// \brief Static eval stencils function applying the stencils to several
+    ///        primvars in a single pass, which takes raw CPU pointers
     ///
-    /// @param dv             Output pointer derivative wrt v. An offset of
-    ///                       dvDesc will be applied internally.
+    /// @param bindings       array of primvar bindings
     ///
-    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
+    /// @param numBindings    number of primvar bindings
     ///
     /// @param sizes          pointer to the sizes buffer of the stencil table
     ///
@@ -223,120 +186,159 @@ public:
     ///
     /// @param weights        pointer to the weights buffer of the stencil table
     ///
-    /// @param duWeights      pointer to the du-weights buffer of the stencil table
-    ///
-    /// @param dvWeights      pointer to the dv-weights buffer of the stencil table
-    ///
     /// @param start          start index of stencil table
     ///
     /// @param end            end index of stencil table
     ///
+    /// @return               false if the descriptors of any binding
+    ///                       mismatch, in which case nothing is evaluated
+    ///
     static bool EvalStencils(
-        const float *src, BufferDescriptor const &srcDesc,
-        float *dst,       BufferDescriptor const &dstDesc,
-        float *du,        BufferDescriptor const &duDesc,
-        float *dv,        BufferDescriptor const &dvDesc,
+        PrimvarBinding const * bindings, int numBindings,
         const int * sizes,
-        const int * offsets,
+        const Far::Offset * offsets,
         const int * indices,
         const float * weights,
-        const float * duWeights,
-        const float * dvWeights,
         int start, int end);
 
-    /// \brief Generic static eval stencils function with derivatives.
-    ///        This function has a same signature as other device kernels
-    ///        have so that it can be called in the same way from OsdMesh
-    ///        template interface.
+    /// \brief Generic static eval stencils function for a subset of the
+    ///        stencils of a table, e.g. only those needed for the faces that
+    ///        are visible.
     ///
-    /// @param srcBuffer      Input primvar buffer.
-    ///                       must have BindCpuBuffer() method returning a
-    ///                       const float pointer for read
+    /// @param srcBuffer        Input primvar buffer.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
     ///
-    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
     ///
-    /// @param dstBuffer      Output primvar buffer
-    ///                       must have BindCpuBuffer() method returning a
-    ///                       float pointer for write
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
     ///
-    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
     ///
-    /// @param duBuffer       Output buffer derivative wrt u
-    ///                       must have BindCpuBuffer() method returning a
-    ///                       float pointer for write
+    /// @param stencilTable     Far::StencilTable or equivalent
     ///
-    /// @param duDesc         vertex buffer descriptor for the duBuffer
+    /// @param stencilIndices   indices of the stencils to evaluate -- each
+    ///                         is written to the element of dstBuffer of the
+    ///                         same index, other elements are not modified
     ///
-    /// @param dvBuffer       Output buffer derivative wrt v
-    ///                       must have BindCpuBuffer() method returning a
-    ///                       float pointer for write
+    /// @param numStencilIndices number of stencil indices
     ///
-    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
+    /// @param instance         not used in the cpu kernel
     ///
-    /// @param duuBuffer      Output buffer 2nd derivative wrt u
-    ///                       must have BindCpuBuffer() method returning a
-    ///                       float pointer for write
+    /// @param deviceContext    not used in the cpu kernel
     ///
-    /// @param duuDesc        vertex buffer descriptor for the duuBuffer
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        STENCIL_TABLE const *stencilTable,
+        const int * stencilIndices, int numStencilIndices,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            &stencilTable->GetSizes()[0],
+                            &stencilTable->GetOffsets()[0],
+                            &stencilTable->GetControlIndices()[0],
+                            &stencilTable->GetWeights()[0],
+                            stencilIndices, numStencilIndices);
+    }
+
+    /// \brief Static eval stencils function for a subset of the stencils of
+    ///        a table, which takes raw CPU pointers for input and output.
     ///
-    /// @param duvBuffer      Output buffer 2nd derivative wrt u and v
+    /// @param src              Input primvar pointer. An offset of srcDesc
+    ///                         will be applied internally (i.e. the pointer
+    ///                         should not include the offset)
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst              Output primvar pointer. An offset of dstDesc
+    ///                         will be applied internally.
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param sizes            pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets          pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices          pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights          pointer to the weights buffer of the stencil table
+    ///
+    /// @param stencilIndices   indices of the stencils to evaluate -- each
+    ///                         is written to the element of dst of the same
+    ///                         index, other elements are not modified
+    ///
+    /// @param numStencilIndices number of stencil indices
+    ///
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const int * stencilIndices,
+        int numStencilIndices);
+
+    /// \brief Generic static eval stencils function for compact stencil
+    ///        tables (see CpuCompactStencilTable).
+    ///
+    /// @param srcBuffer      Input primvar buffer.
     ///                       must have BindCpuBuffer() method returning a
-    ///                       float pointer for write
+    ///                       const float pointer for read
     ///
-    /// @param duvDesc        vertex buffer descriptor for the duvBuffer
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
     ///
-    /// @param dvvBuffer      Output buffer 2nd derivative wrt v
+    /// @param dstBuffer      Output primvar buffer
     ///                       must have BindCpuBuffer() method returning a
     ///                       float pointer for write
     ///
-    /// @param dvvDesc        vertex buffer descriptor for the dvvBuffer
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
     ///
-    /// @param stencilTable   Far::StencilTable or equivalent
+    /// @param stencilTable   CpuCompactStencilTable
     ///
     /// @param instance       not used in the cpu kernel
-    ///                       (declared as a typed pointer to prevent
-    ///                        undesirable template resolution)
     ///
     /// @param deviceContext  not used in the cpu kernel
     ///
-    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    template <typename SRC_BUFFER, typename DST_BUFFER>
     static bool EvalStencils(
         SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
         DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
-        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
-        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
-        DST_BUFFER *duuBuffer, BufferDescriptor const &duuDesc,
-        DST_BUFFER *duvBuffer, BufferDescriptor const &duvDesc,
-        DST_BUFFER *dvvBuffer, BufferDescriptor const &dvvDesc,
-        STENCIL_TABLE const *stencilTable,
+        CpuCompactStencilTable const *stencilTable,
         const CpuEvaluator *instance = NULL,
         void * deviceContext = NULL) {
 
         (void)instance;       // unused
         (void)deviceContext;  // unused
 
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
         return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
                             dstBuffer->BindCpuBuffer(), dstDesc,
-                            duBuffer->BindCpuBuffer(),  duDesc,
-                            dvBuffer->BindCpuBuffer(),  dvDesc,
-                            duuBuffer->BindCpuBuffer(), duuDesc,
-                            duvBuffer->BindCpuBuffer(), duvDesc,
-                            dvvBuffer->BindCpuBuffer(), dvvDesc,
-                            &stencilTable->GetSizes()[0],
-                            &stencilTable->GetOffsets()[0],
-                            &stencilTable->GetControlIndices()[0],
-                            &stencilTable->GetWeights()[0],
-                            &stencilTable->GetDuWeights()[0],
-                            &stencilTable->GetDvWeights()[0],
-                            &stencilTable->GetDuuWeights()[0],
-                            &stencilTable->GetDuvWeights()[0],
-                            &stencilTable->GetDvvWeights()[0],
+                            stencilTable->GetSizesBuffer(),
+                            stencilTable->GetOffsetsBuffer(),
+                            stencilTable->GetBaseIndicesBuffer(),
+                            stencilTable->GetScalesBuffer(),
+                            stencilTable->GetEntriesBuffer(),
                             /*start = */ 0,
                             /*end   = */ stencilTable->GetNumStencils());
     }
 
-    /// \brief Static eval stencils function with derivatives, which takes
-    ///        raw CPU pointers for input and output.
+    /// \brief Static eval stencils function for compact stencil tables which
+    ///        takes raw CPU pointers for input and output.
     ///
     /// @param src            Input primvar pointer. An offset of srcDesc
     ///                       will be applied internally (i.e. the pointer
@@ -349,48 +351,17 @@ public:
     ///
     /// @param dstDesc        vertex buffer descriptor for the output buffer
     ///
-    /// @param du             Output pointer derivative wrt u. An offset of
-    ///                       duDesc will be applied internally.
-    ///
-    /// @param duDesc         vertex buffer descriptor for the duBuffer
-    ///
-    /// @param dv             Output pointer derivative wrt v. An offset of
-    ///                       dvDesc will be applied internally.
-    ///
-    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
-    ///
-    /// @param duu            Output pointer 2nd derivative wrt u. An offset of
-    ///                       duuDesc will be applied internally.
-    ///
-    /// @param duuDesc        vertex buffer descriptor for the duuBuffer
-    ///
-    /// @param duv            Output pointer 2nd derivative wrt u and v. An offset of
-    ///                       duvDesc will be applied internally.
-    ///
-    /// @param duvDesc        vertex buffer descriptor for the duvBuffer
-    ///
-    /// @param dvv            Output pointer 2nd derivative wrt v. An offset of
-    ///                       dvvDesc will be applied internally.
-    ///
-    /// @param dvvDesc        vertex buffer descriptor for the dvvBuffer
-    ///
     /// @param sizes          pointer to the sizes buffer of the stencil table
     ///
     /// @param offsets        pointer to the offsets buffer of the stencil table
     ///
-    /// @param indices        pointer to the indices buffer of the stencil table
-    ///
-    /// @param weights        pointer to the weights buffer of the stencil table
-    ///
-    /// @param duWeights      pointer to the du-weights buffer of the stencil table
-    ///
-    /// @param dvWeights      pointer to the dv-weights buffer of the stencil table
-    ///
-    /// @param duuWeights     pointer to the duu-weights buffer of the stencil table
+    /// @param baseIndices    pointer to the base indices buffer of the
+    ///                       stencil table
     ///
-    /// @param duvWeights     pointer to the duv-weights buffer of the stencil table
+    /// @param scales         pointer to the weight scales buffer of the
+    ///                       stencil table
     ///
-    /// @param dvvWeights     pointer to the dvv-weights buffer of the stencil table
+    /// @param entries        pointer to the entries buffer of the stencil table
     ///
     /// @param start          start index of stencil table
     ///
@@ -399,304 +370,1981 @@ public:
     static bool EvalStencils(
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
-        float *du,        BufferDescriptor const &duDesc,
-        float *dv,        BufferDescriptor const &dvDesc,
-        float *duu,       BufferDescriptor const &duuDesc,
-        float *duv,       BufferDescriptor const &duvDesc,
-        float *dvv,       BufferDescriptor const &dvvDesc,
         const int * sizes,
-        const int * offsets,
-        const int * indices,
-        const float * weights,
-        const float * duWeights,
-        const float * dvWeights,
-        const float * duuWeights,
-        const float * duvWeights,
-        const float * dvvWeights,
+        const Far::Offset * offsets,
+        const int * baseIndices,
+        const float * scales,
+        const unsigned int * entries,
         int start, int end);
 
-    /// ----------------------------------------------------------------------
+    /// \brief Generic static eval stencils function for varying tables
+    ///        (see Far::VaryingTable).
     ///
-    ///   Limit evaluations with PatchTable
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
     ///
-    /// ----------------------------------------------------------------------
-
-    /// \brief Generic limit eval function. This function has a same
-    ///        signature as other device kernels have so that it can be called
-    ///        in the same way.
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
     ///
-    /// @param srcBuffer        Input primvar buffer.
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         const float pointer for read
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param varyingTable   Far::VaryingTable
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        Far::VaryingTable const *varyingTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (varyingTable->GetNumVertices() == 0)
+            return false;
+
+        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            &varyingTable->GetOffsets()[0],
+                            varyingTable->GetIndices().empty() ? 0 :
+                                &varyingTable->GetIndices()[0],
+                            /*start = */ 0,
+                            /*end   = */ varyingTable->GetNumVertices());
+    }
+
+    /// \brief Static eval stencils function for varying tables which takes
+    ///        raw CPU pointers for input and output. The weights of each
+    ///        stencil are the inverse of its number of sources.
+    ///
+    /// @param src            Input primvar pointer. An offset of srcDesc
+    ///                       will be applied internally (i.e. the pointer
+    ///                       should not include the offset)
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer. An offset of dstDesc
+    ///                       will be applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param offsets        pointer to the offsets buffer of the varying
+    ///                       table (one more than the number of vertices)
+    ///
+    /// @param indices        pointer to the sources buffer of the varying
+    ///                       table
+    ///
+    /// @param start          start index of varying table
+    ///
+    /// @param end            end index of varying table
+    ///
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        const Far::Index * offsets,
+        const Far::Index * indices,
+        int start, int end);
+
+    /// \brief Generic static eval stencils function with derivatives for
+    ///        limit stencil tables with half-precision derivative weights
+    ///        (see CpuHalfLimitStencilTable).
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param duBuffer       Output buffer derivative wrt u
+    ///
+    /// @param duDesc         vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dvBuffer       Output buffer derivative wrt v
+    ///
+    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param stencilTable   CpuHalfLimitStencilTable
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        CpuHalfLimitStencilTable const *stencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            duBuffer->BindCpuBuffer(),  duDesc,
+                            dvBuffer->BindCpuBuffer(),  dvDesc,
+                            stencilTable->GetSizesBuffer(),
+                            stencilTable->GetOffsetsBuffer(),
+                            stencilTable->GetIndicesBuffer(),
+                            stencilTable->GetWeightsBuffer(),
+                            stencilTable->GetDuWeightsBuffer(),
+                            stencilTable->GetDvWeightsBuffer(),
+                            /*start = */ 0,
+                            /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function with derivatives for
+    ///        half-precision derivative weights, which takes raw CPU
+    ///        pointers for input and output. Arguments are those of the
+    ///        full-precision version.
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const unsigned short * duWeights,
+        const unsigned short * dvWeights,
+        int start, int end);
+
+    /// \brief Generic static eval stencils function with first and second
+    ///        derivatives for limit stencil tables with half-precision
+    ///        derivative weights (see CpuHalfLimitStencilTable). Arguments
+    ///        are those of the version with first derivatives, plus the
+    ///        buffers and descriptors of the second derivatives. The
+    ///        table must have second derivative weights.
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        DST_BUFFER *duuBuffer, BufferDescriptor const &duuDesc,
+        DST_BUFFER *duvBuffer, BufferDescriptor const &duvDesc,
+        DST_BUFFER *dvvBuffer, BufferDescriptor const &dvvDesc,
+        CpuHalfLimitStencilTable const *stencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0 ||
+            !stencilTable->HasSecondDerivatives())
+            return false;
+
+        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            duBuffer->BindCpuBuffer(),  duDesc,
+                            dvBuffer->BindCpuBuffer(),  dvDesc,
+                            duuBuffer->BindCpuBuffer(), duuDesc,
+                            duvBuffer->BindCpuBuffer(), duvDesc,
+                            dvvBuffer->BindCpuBuffer(), dvvDesc,
+                            stencilTable->GetSizesBuffer(),
+                            stencilTable->GetOffsetsBuffer(),
+                            stencilTable->GetIndicesBuffer(),
+                            stencilTable->GetWeightsBuffer(),
+                            stencilTable->GetDuWeightsBuffer(),
+                            stencilTable->GetDvWeightsBuffer(),
+                            stencilTable->GetDuuWeightsBuffer(),
+                            stencilTable->GetDuvWeightsBuffer(),
+                            stencilTable->GetDvvWeightsBuffer(),
+                            /*start = */ 0,
+                            /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function with first and second
+    ///        derivatives for half-precision derivative weights, which
+    ///        takes raw CPU pointers for input and output.
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        float *duu,       BufferDescriptor const &duuDesc,
+        float *duv,       BufferDescriptor const &duvDesc,
+        float *dvv,       BufferDescriptor const &dvvDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const unsigned short * duWeights,
+        const unsigned short * dvWeights,
+        const unsigned short * duuWeights,
+        const unsigned short * duvWeights,
+        const unsigned short * dvvWeights,
+        int start, int end);
+
+    /// \brief Generic static eval stencils function with derivatives.
+    ///        This function has a same signature as other device kernels
+    ///        have so that it can be called in the same way from OsdMesh
+    ///        template interface.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param duBuffer       Output buffer derivative wrt u
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param duDesc         vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dvBuffer       Output buffer derivative wrt v
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///                       (declared as a typed pointer to prevent
+    ///                        undesirable template resolution)
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        STENCIL_TABLE const *stencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            duBuffer->BindCpuBuffer(),  duDesc,
+                            dvBuffer->BindCpuBuffer(),  dvDesc,
+                            &stencilTable->GetSizes()[0],
+                            &stencilTable->GetOffsets()[0],
+                            &stencilTable->GetControlIndices()[0],
+                            &stencilTable->GetWeights()[0],
+                            &stencilTable->GetDuWeights()[0],
+                            &stencilTable->GetDvWeights()[0],
+                            /*start = */ 0,
+                            /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function with derivatives, which takes
+    ///        raw CPU pointers for input and output.
+    ///
+    /// @param src            Input primvar pointer. An offset of srcDesc
+    ///                       will be applied internally (i.e. the pointer
+    ///                       should not include the offset)
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer. An offset of dstDesc
+    ///                       will be applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param du             Output pointer derivative wrt u. An offset of
+    ///                       duDesc will be applied internally.
+    ///
+    /// @param duDesc         vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dv             Output pointer derivative wrt v. An offset of
+    ///                       dvDesc will be applied internally.
+    ///
+    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param duWeights      pointer to the du-weights buffer of the stencil table
+    ///
+    /// @param dvWeights      pointer to the dv-weights buffer of the stencil table
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        int start, int end);
+
+    /// \brief Generic static eval stencils function with derivatives.
+    ///        This function has a same signature as other device kernels
+    ///        have so that it can be called in the same way from OsdMesh
+    ///        template interface.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param duBuffer       Output buffer derivative wrt u
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param duDesc         vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dvBuffer       Output buffer derivative wrt v
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param duuBuffer      Output buffer 2nd derivative wrt u
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param duuDesc        vertex buffer descriptor for the duuBuffer
+    ///
+    /// @param duvBuffer      Output buffer 2nd derivative wrt u and v
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param duvDesc        vertex buffer descriptor for the duvBuffer
+    ///
+    /// @param dvvBuffer      Output buffer 2nd derivative wrt v
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dvvDesc        vertex buffer descriptor for the dvvBuffer
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///                       (declared as a typed pointer to prevent
+    ///                        undesirable template resolution)
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        DST_BUFFER *duuBuffer, BufferDescriptor const &duuDesc,
+        DST_BUFFER *duvBuffer, BufferDescriptor const &duvDesc,
+        DST_BUFFER *dvvBuffer, BufferDescriptor const &dvvDesc,
+        STENCIL_TABLE const *stencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            duBuffer->BindCpuBuffer(),  duDesc,
+                            dvBuffer->BindCpuBuffer(),  dvDesc,
+                            duuBuffer->BindCpuBuffer(), duuDesc,
+                            duvBuffer->BindCpuBuffer(), duvDesc,
+                            dvvBuffer->BindCpuBuffer(), dvvDesc,
+                            &stencilTable->GetSizes()[0],
+                            &stencilTable->GetOffsets()[0],
+                            &stencilTable->GetControlIndices()[0],
+                            &stencilTable->GetWeights()[0],
+                            &stencilTable->GetDuWeights()[0],
+                            &stencilTable->GetDvWeights()[0],
+                            &stencilTable->GetDuuWeights()[0],
+                            &stencilTable->GetDuvWeights()[0],
+                            &stencilTable->GetDvvWeights()[0],
+                            /*start = */ 0,
+                            /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function with derivatives, which takes
+    ///        raw CPU pointers for input and output.
+    ///
+    /// @param src            Input primvar pointer. An offset of srcDesc
+    ///                       will be applied internally (i.e. the pointer
+    ///                       should not include the offset)
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer. An offset of dstDesc
+    ///                       will be applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param du             Output pointer derivative wrt u. An offset of
+    ///                       duDesc will be applied internally.
+    ///
+    /// @param duDesc         vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dv             Output pointer derivative wrt v. An offset of
+    ///                       dvDesc will be applied internally.
+    ///
+    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param duu            Output pointer 2nd derivative wrt u. An offset of
+    ///                       duuDesc will be applied internally.
+    ///
+    /// @param duuDesc        vertex buffer descriptor for the duuBuffer
+    ///
+    /// @param duv            Output pointer 2nd derivative wrt u and v. An offset of
+    ///                       duvDesc will be applied internally.
+    ///
+    /// @param duvDesc        vertex buffer descriptor for the duvBuffer
+    ///
+    /// @param dvv            Output pointer 2nd derivative wrt v. An offset of
+    ///                       dvvDesc will be applied internally.
+    ///
+    /// @param dvvDesc        vertex buffer descriptor for the dvvBuffer
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param duWeights      pointer to the du-weights buffer of the stencil table
+    ///
+    /// @param dvWeights      pointer to the dv-weights buffer of the stencil table
+    ///
+    /// @param duuWeights     pointer to the duu-weights buffer of the stencil table
+    ///
+    /// @param duvWeights     pointer to the duv-weights buffer of the stencil table
+    ///
+    /// @param dvvWeights     pointer to the dvv-weights buffer of the stencil table
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        float *duu,       BufferDescriptor const &duuDesc,
+        float *duv,       BufferDescriptor const &duvDesc,
+        float *dvv,       BufferDescriptor const &dvvDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        const float * duuWeights,
+        const float * duvWeights,
+        const float * dvvWeights,
+        int start, int end);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Double-precision stencil evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Static eval stencils functions for double-precision primvar
+    ///        data, which take raw CPU pointers for input and output.
+    ///
+    /// The parameters are those of the single-precision functions above.
+    /// They are invoked by the generic functions above for primvar buffers
+    /// whose BindCpuBuffer() method returns a double pointer, either with a
+    /// Far::StencilTableReal<double> (or Far::LimitStencilTableReal<double>)
+    /// or with a single-precision stencil table, whose float weights are
+    /// then accumulated in double precision without converting the table.
+    ///
+    static bool EvalStencils(
+        const double *src, BufferDescriptor const &srcDesc,
+        double *dst,       BufferDescriptor const &dstDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const double * weights,
+        int start, int end);
+
+    static bool EvalStencils(
+        const double *src, BufferDescriptor const &srcDesc,
+        double *dst,       BufferDescriptor const &dstDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        int start, int end);
+
+    static bool EvalStencils(
+        const double *src, BufferDescriptor const &srcDesc,
+        double *dst,       BufferDescriptor const &dstDesc,
+        double *du,        BufferDescriptor const &duDesc,
+        double *dv,        BufferDescriptor const &dvDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const double * weights,
+        const double * duWeights,
+        const double * dvWeights,
+        int start, int end);
+
+    static bool EvalStencils(
+        const double *src, BufferDescriptor const &srcDesc,
+        double *dst,       BufferDescriptor const &dstDesc,
+        double *du,        BufferDescriptor const &duDesc,
+        double *dv,        BufferDescriptor const &dvDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        int start, int end);
+
+    static bool EvalStencils(
+        const double *src, BufferDescriptor const &srcDesc,
+        double *dst,       BufferDescriptor const &dstDesc,
+        double *du,        BufferDescriptor const &duDesc,
+        double *dv,        BufferDescriptor const &dvDesc,
+        double *duu,       BufferDescriptor const &duuDesc,
+        double *duv,       BufferDescriptor const &duvDesc,
+        double *dvv,       BufferDescriptor const &dvvDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const double * weights,
+        const double * duWeights,
+        const double * dvWeights,
+        const double * duuWeights,
+        const double * duvWeights,
+        const double * dvvWeights,
+        int start, int end);
+
+    static bool EvalStencils(
+        const double *src, BufferDescriptor const &srcDesc,
+        double *dst,       BufferDescriptor const &dstDesc,
+        double *du,        BufferDescriptor const &duDesc,
+        double *dv,        BufferDescriptor const &dvDesc,
+        double *duu,       BufferDescriptor const &duuDesc,
+        double *duv,       BufferDescriptor const &duvDesc,
+        double *dvv,       BufferDescriptor const &dvvDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        const float * duuWeights,
+        const float * duvWeights,
+        const float * dvvWeights,
+        int start, int end);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Limit evaluations with PatchTable
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic limit eval function. This function has a same
+    ///        signature as other device kernels have so that it can be called
+    ///        in the same way.
+    ///
+    /// @param srcBuffer        Input primvar buffer.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///                         XXX: currently Far::PatchTable can't be used
+    ///                              due to interface mismatch
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatches(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatches(srcBuffer->BindCpuBuffer(), srcDesc,
+                           dstBuffer->BindCpuBuffer(), dstDesc,
+                           numPatchCoords,
+                           (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                           patchTable->GetPatchArrayBuffer(),
+                           patchTable->GetPatchIndexBuffer(),
+                           patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Generic limit eval function with derivatives. This function has
+    ///        a same signature as other device kernels have so that it can be
+    ///        called in the same way.
+    ///
+    /// @param srcBuffer        Input primvar buffer.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param duBuffer         Output buffer derivative wrt u
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param duDesc           vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dvBuffer         Output buffer derivative wrt v
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dvDesc           vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///                         XXX: currently Far::PatchTable can't be used
+    ///                              due to interface mismatch
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatches(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        // XXX: PatchCoords is somewhat abusing vertex primvar buffer interop.
+        //      ideally all buffer classes should have templated by datatype
+        //      so that downcast isn't needed there.
+        //      (e.g. Osd::CpuBuffer<PatchCoord> )
+        //
+        return EvalPatches(srcBuffer->BindCpuBuffer(), srcDesc,
+                           dstBuffer->BindCpuBuffer(), dstDesc,
+                           duBuffer->BindCpuBuffer(),  duDesc,
+                           dvBuffer->BindCpuBuffer(),  dvDesc,
+                           numPatchCoords,
+                           (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                           patchTable->GetPatchArrayBuffer(),
+                           patchTable->GetPatchIndexBuffer(),
+                           patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Generic limit eval function with derivatives. This function has
+    ///        a same signature as other device kernels have so that it can be
+    ///        called in the same way.
+    ///
+    /// @param srcBuffer        Input primvar buffer.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param duBuffer         Output buffer derivative wrt u
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param duDesc           vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dvBuffer         Output buffer derivative wrt v
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dvDesc           vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param duuBuffer        Output buffer 2nd derivative wrt u
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param duuDesc          vertex buffer descriptor for the duuBuffer
+    ///
+    /// @param duvBuffer        Output buffer 2nd derivative wrt u and v
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param duvDesc          vertex buffer descriptor for the duvBuffer
+    ///
+    /// @param dvvBuffer        Output buffer 2nd derivative wrt v
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dvvDesc          vertex buffer descriptor for the dvvBuffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///                         XXX: currently Far::PatchTable can't be used
+    ///                              due to interface mismatch
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatches(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        DST_BUFFER *duuBuffer, BufferDescriptor const &duuDesc,
+        DST_BUFFER *duvBuffer, BufferDescriptor const &duvDesc,
+        DST_BUFFER *dvvBuffer, BufferDescriptor const &dvvDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        // XXX: PatchCoords is somewhat abusing vertex primvar buffer interop.
+        //      ideally all buffer classes should have templated by datatype
+        //      so that downcast isn't needed there.
+        //      (e.g. Osd::CpuBuffer<PatchCoord> )
+        //
+        return EvalPatches(srcBuffer->BindCpuBuffer(), srcDesc,
+                           dstBuffer->BindCpuBuffer(), dstDesc,
+                           duBuffer->BindCpuBuffer(),  duDesc,
+                           dvBuffer->BindCpuBuffer(),  dvDesc,
+                           duuBuffer->BindCpuBuffer(), duuDesc,
+                           duvBuffer->BindCpuBuffer(), duvDesc,
+                           dvvBuffer->BindCpuBuffer(), dvvDesc,
+                           numPatchCoords,
+                           (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                           patchTable->GetPatchArrayBuffer(),
+                           patchTable->GetPatchIndexBuffer(),
+                           patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static limit eval function. It takes an array of PatchCoord
+    ///        and evaluate limit values on given PatchTable.
+    ///
+    /// @param src              Input primvar pointer. An offset of srcDesc
+    ///                         will be applied internally (i.e. the pointer
+    ///                         should not include the offset)
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst              Output primvar pointer. An offset of dstDesc
+    ///                         will be applied internally.
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///                         indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer an array of patch indices
+    ///                         indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer an array of Osd::PatchParam struct
+    ///                         indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatches(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer);
+
+    /// \brief Static limit eval function. It takes an array of PatchCoord
+    ///        and evaluate limit values on given PatchTable.
+    ///
+    /// @param src              Input primvar pointer. An offset of srcDesc
+    ///                         will be applied internally (i.e. the pointer
+    ///                         should not include the offset)
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst              Output primvar pointer. An offset of dstDesc
+    ///                         will be applied internally.
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param du               Output pointer derivative wrt u. An offset of
+    ///                         duDesc will be applied internally.
+    ///
+    /// @param duDesc           vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dv               Output pointer derivative wrt v. An offset of
+    ///                         dvDesc will be applied internally.
+    ///
+    /// @param dvDesc           vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///                         indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer an array of patch indices
+    ///                         indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer an array of Osd::PatchParam struct
+    ///                         indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatches(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    /// \brief Static limit eval function. It takes an array of PatchCoord
+    ///        and evaluate limit values on given PatchTable.
+    ///
+    /// @param src              Input primvar pointer. An offset of srcDesc
+    ///                         will be applied internally (i.e. the pointer
+    ///                         should not include the offset)
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst              Output primvar pointer. An offset of dstDesc
+    ///                         will be applied internally.
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param du               Output pointer derivative wrt u. An offset of
+    ///                         duDesc will be applied internally.
+    ///
+    /// @param duDesc           vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dv               Output pointer derivative wrt v. An offset of
+    ///                         dvDesc will be applied internally.
+    ///
+    /// @param dvDesc           vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param duu              Output pointer 2nd derivative wrt u. An offset of
+    ///                         duuDesc will be applied internally.
+    ///
+    /// @param duuDesc          vertex buffer descriptor for the duuBuffer
+    ///
+    /// @param duv              Output pointer 2nd derivative wrt u and v. An offset of
+    ///                         duvDesc will be applied internally.
+    ///
+    /// @param duvDesc          vertex buffer descriptor for the duvBuffer
+    ///
+    /// @param dvv              Output pointer 2nd derivative wrt v. An offset of
+    ///                         dvvDesc will be applied internally.
+    ///
+    /// @param dvvDesc          vertex buffer descriptor for the dvvBuffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///                         indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer an array of patch indices
+    ///                         indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer an array of Osd::PatchParam struct
+    ///                         indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatches(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        float *duu,       BufferDescriptor const &duuDesc,
+        float *duv,       BufferDescriptor const &duvDesc,
+        float *dvv,       BufferDescriptor const &dvvDesc,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    /// \brief Static limit eval functions for double-precision primvar data,
+    ///        which take raw CPU pointers for input and output.
+    ///
+    /// The parameters are those of the single-precision functions above,
+    /// which the generic functions invoke for primvar buffers whose
+    /// BindCpuBuffer() method returns a double pointer.  The patch basis is
+    /// evaluated in double precision.
+    ///
+    static bool EvalPatches(
+        const double *src, BufferDescriptor const &srcDesc,
+        double *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    static bool EvalPatches(
+        const double *src, BufferDescriptor const &srcDesc,
+        double *dst,       BufferDescriptor const &dstDesc,
+        double *du,        BufferDescriptor const &duDesc,
+        double *dv,        BufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    static bool EvalPatches(
+        const double *src, BufferDescriptor const &srcDesc,
+        double *dst,       BufferDescriptor const &dstDesc,
+        double *du,        BufferDescriptor const &duDesc,
+        double *dv,        BufferDescriptor const &dvDesc,
+        double *duu,       BufferDescriptor const &duuDesc,
+        double *duv,       BufferDescriptor const &duvDesc,
+        double *dvv,       BufferDescriptor const &dvvDesc,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Normal evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static eval stencils function writing the unit normals
+    ///        of the limit surface -- the normalized cross product of the
+    ///        first three elements of the derivatives, which are accumulated
+    ///        in the kernel but not written -- and the limit points.
+    ///
+    /// @param srcBuffer      Input primvar buffer (of at least 3 elements).
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param normalBuffer   Output buffer of the normals
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param normalDesc     vertex buffer descriptor for the normalBuffer
+    ///                       (of length 3)
+    ///
+    /// @param stencilTable   Far::LimitStencilTable or equivalent
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        STENCIL_TABLE const *stencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencilsNormals(srcBuffer->BindCpuBuffer(), srcDesc,
+                                   dstBuffer->BindCpuBuffer(), dstDesc,
+                                   normalBuffer->BindCpuBuffer(), normalDesc,
+                                   &stencilTable->GetSizes()[0],
+                                   &stencilTable->GetOffsets()[0],
+                                   &stencilTable->GetControlIndices()[0],
+                                   &stencilTable->GetWeights()[0],
+                                   &stencilTable->GetDuWeights()[0],
+                                   &stencilTable->GetDvWeights()[0],
+                                   /*start = */ 0,
+                                   /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Generic static eval stencils function writing only the unit
+    ///        normals of the limit surface (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        STENCIL_TABLE const *stencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencilsNormals(srcBuffer->BindCpuBuffer(), srcDesc,
+                                   NULL, BufferDescriptor(),
+                                   normalBuffer->BindCpuBuffer(), normalDesc,
+                                   &stencilTable->GetSizes()[0],
+                                   &stencilTable->GetOffsets()[0],
+                                   &stencilTable->GetControlIndices()[0],
+                                   &stencilTable->GetWeights()[0],
+                                   &stencilTable->GetDuWeights()[0],
+                                   &stencilTable->GetDvWeights()[0],
+                                   /*start = */ 0,
+                                   /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function writing the unit normals of the
+    ///        limit surface, which takes raw CPU pointers for input and
+    ///        output.
+    ///
+    /// @param src            Input primvar pointer (of at least 3 elements).
+    ///                       An offset of srcDesc will be applied internally
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer (or NULL to write only
+    ///                       the normals). An offset of dstDesc will be
+    ///                       applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param normal         Output pointer of the normals. An offset of
+    ///                       normalDesc will be applied internally.
+    ///
+    /// @param normalDesc     vertex buffer descriptor for the normals
+    ///                       (of length 3)
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param duWeights      pointer to the du-weights buffer of the stencil table
+    ///
+    /// @param dvWeights      pointer to the dv-weights buffer of the stencil table
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    static bool EvalStencilsNormals(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *normal,    BufferDescriptor const &normalDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        int start, int end);
+
+    /// \brief Generic limit eval function writing the unit normals of the
+    ///        limit surface and the limit points (see EvalStencilsNormals()).
+    ///
+    /// @param srcBuffer        Input primvar buffer (of at least 3 elements).
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param normalBuffer     Output buffer of the normals
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param normalDesc       vertex buffer descriptor for the normalBuffer
+    ///                         (of length 3)
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesNormals(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  dstBuffer->BindCpuBuffer(), dstDesc,
+                                  normalBuffer->BindCpuBuffer(), normalDesc,
+                                  numPatchCoords,
+                                  (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                                  patchTable->GetPatchArrayBuffer(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Generic limit eval function writing only the unit normals of
+    ///        the limit surface (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesNormals(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  NULL, BufferDescriptor(),
+                                  normalBuffer->BindCpuBuffer(), normalDesc,
+                                  numPatchCoords,
+                                  (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                                  patchTable->GetPatchArrayBuffer(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static limit eval function writing the unit normals of the
+    ///        limit surface, which takes raw CPU pointers for input and
+    ///        output.
+    ///
+    /// @param src              Input primvar pointer (of at least 3
+    ///                         elements). An offset of srcDesc will be
+    ///                         applied internally
     ///
     /// @param srcDesc          vertex buffer descriptor for the input buffer
     ///
-    /// @param dstBuffer        Output primvar buffer
+    /// @param dst              Output primvar pointer (or NULL to write only
+    ///                         the normals). An offset of dstDesc will be
+    ///                         applied internally.
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param normal           Output pointer of the normals. An offset of
+    ///                         normalDesc will be applied internally.
+    ///
+    /// @param normalDesc       vertex buffer descriptor for the normals
+    ///                         (of length 3)
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///                         indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer an array of patch indices
+    ///                         indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer an array of Osd::PatchParam struct
+    ///                         indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatchesNormals(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *normal,    BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Skinned stencil evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static eval stencils function skinning the positions
+    ///        of the control vertices as the stencils gather them (see
+    ///        SkinningDescriptor), so that the skinned cage is neither
+    ///        written nor read again.
+    ///
+    /// The control vertices of srcBuffer hold the rest pose. To also write
+    /// the skinned control vertices (e.g. for the patches of adaptive
+    /// meshes), the stencil table is created with generateControlVerts.
+    ///
+    /// @param srcBuffer      Input primvar buffer (of at least 3 elements).
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param skinning       bones, bone indices and weights of the control
+    ///                       vertices (CPU pointers)
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsSkinned(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        STENCIL_TABLE const *stencilTable,
+        SkinningDescriptor const &skinning,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencilsSkinned(srcBuffer->BindCpuBuffer(), srcDesc,
+                                   dstBuffer->BindCpuBuffer(), dstDesc,
+                                   &stencilTable->GetSizes()[0],
+                                   &stencilTable->GetOffsets()[0],
+                                   &stencilTable->GetControlIndices()[0],
+                                   &stencilTable->GetWeights()[0],
+                                   skinning,
+                                   /*start = */ 0,
+                                   /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function skinning the positions of the
+    ///        control vertices as they are gathered, which takes raw CPU
+    ///        pointers for input and output.
+    ///
+    /// @param src            Input primvar pointer (of at least 3 elements).
+    ///                       An offset of srcDesc will be applied internally
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer. An offset of dstDesc
+    ///                       will be applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param skinning       bones, bone indices and weights of the control
+    ///                       vertices
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    static bool EvalStencilsSkinned(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        SkinningDescriptor const &skinning,
+        int start, int end);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Time-sampled evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static eval stencils function evaluating several time
+    ///        samples of the primvars (e.g. the cage positions from shutter
+    ///        open to shutter close for motion blur) in a single traversal of
+    ///        the stencil table, each index and weight being loaded once for
+    ///        all the samples.
+    ///
+    /// @param srcBuffer      Input primvar buffer holding the samples.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor of the first sample of
+    ///                       the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer holding the samples.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor of the first sample of
+    ///                       the output buffer
+    ///
+    /// @param numSamples     number of time samples
+    ///
+    /// @param srcSampleStride  number of floats from a sample of the source
+    ///                       to the next (e.g. the number of vertices times
+    ///                       srcDesc.stride, for samples laid out one after
+    ///                       the other)
+    ///
+    /// @param dstSampleStride  number of floats from a sample of the
+    ///                       destinations to the next
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsSamples(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        STENCIL_TABLE const *stencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencilsSamples(srcBuffer->BindCpuBuffer(), srcDesc,
+                                   dstBuffer->BindCpuBuffer(), dstDesc,
+                                   numSamples, srcSampleStride,
+                                   dstSampleStride,
+                                   &stencilTable->GetSizes()[0],
+                                   &stencilTable->GetOffsets()[0],
+                                   &stencilTable->GetControlIndices()[0],
+                                   &stencilTable->GetWeights()[0],
+                                   /*start = */ 0,
+                                   /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function evaluating several time samples
+    ///        of the primvars, which takes raw CPU pointers for input and
+    ///        output.
+    ///
+    /// @param src            Input primvar pointer of the first sample. An
+    ///                       offset of srcDesc will be applied internally
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer of the first sample. An
+    ///                       offset of dstDesc will be applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param numSamples     number of time samples
+    ///
+    /// @param srcSampleStride  number of floats from a sample of the source
+    ///                       to the next (e.g. the number of vertices times
+    ///                       srcDesc.stride, for samples laid out one after
+    ///                       the other)
+    ///
+    /// @param dstSampleStride  number of floats from a sample of the
+    ///                       destinations to the next
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    static bool EvalStencilsSamples(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        int start, int end);
+
+    /// \brief Generic limit eval function evaluating several time samples of
+    ///        the primvars, the basis of each coord being evaluated once for
+    ///        all the samples (see EvalStencilsSamples()).
+    ///
+    /// @param srcBuffer        Input primvar buffer holding the samples.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor of the first sample
+    ///                         of the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer holding the samples.
     ///                         must have BindCpuBuffer() method returning a
     ///                         float pointer for write
     ///
-    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    /// @param dstDesc          vertex buffer descriptor of the first sample
+    ///                         of the output buffer
+    ///
+    /// @param numSamples     number of time samples
+    ///
+    /// @param srcSampleStride  number of floats from a sample of the source
+    ///                         to the next (e.g. the number of vertices times
+    ///                         srcDesc.stride, for samples laid out one after
+    ///                         the other)
+    ///
+    /// @param dstSampleStride  number of floats from a sample of the
+    ///                         destinations to the next
     ///
     /// @param numPatchCoords   number of patchCoords.
     ///
     /// @param patchCoords      array of locations to be evaluated.
     ///
     /// @param patchTable       CpuPatchTable or equivalent
-    ///                         XXX: currently Far::PatchTable can't be used
-    ///                              due to interface mismatch
     ///
-    /// @param instance         not used in the cpu evaluator
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesSamples(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesSamples(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  dstBuffer->BindCpuBuffer(), dstDesc,
+                                  NULL, BufferDescriptor(),
+                                  NULL, BufferDescriptor(),
+                                  numSamples, srcSampleStride, dstSampleStride,
+                                  numPatchCoords,
+                                  (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                                  patchTable->GetPatchArrayBuffer(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Generic limit eval function evaluating several time samples of
+    ///        the primvars and of their derivatives (see above), the samples
+    ///        of the derivatives being dstSampleStride floats apart as well.
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesSamples(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesSamples(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  dstBuffer->BindCpuBuffer(), dstDesc,
+                                  duBuffer->BindCpuBuffer(),  duDesc,
+                                  dvBuffer->BindCpuBuffer(),  dvDesc,
+                                  numSamples, srcSampleStride, dstSampleStride,
+                                  numPatchCoords,
+                                  (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                                  patchTable->GetPatchArrayBuffer(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static limit eval function evaluating several time samples of
+    ///        the primvars and optionally of their derivatives, which takes
+    ///        raw CPU pointers for input and output.
+    ///
+    /// @param src              Input primvar pointer of the first sample. An
+    ///                         offset of srcDesc will be applied internally
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst              Output primvar pointer of the first sample. An
+    ///                         offset of dstDesc will be applied internally.
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param du               Output pointer of the first sample of the
+    ///                         derivatives wrt u (or NULL)
+    ///
+    /// @param duDesc           vertex buffer descriptor for the du buffer
+    ///
+    /// @param dv               Output pointer of the first sample of the
+    ///                         derivatives wrt v (or NULL)
+    ///
+    /// @param dvDesc           vertex buffer descriptor for the dv buffer
+    ///
+    /// @param numSamples     number of time samples
+    ///
+    /// @param srcSampleStride  number of floats from a sample of the source
+    ///                         to the next (e.g. the number of vertices times
+    ///                         srcDesc.stride, for samples laid out one after
+    ///                         the other)
+    ///
+    /// @param dstSampleStride  number of floats from a sample of the
+    ///                         destinations to the next
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///                         indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer an array of patch indices
+    ///                         indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer an array of Osd::PatchParam struct
+    ///                         indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatchesSamples(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Bounded stencil evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static eval stencils function also computing the
+    ///        bounding boxes of the first three elements of the results (see
+    ///        BoundsDescriptor), reduced as they are written rather than in
+    ///        a second pass over the destination buffer.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer (of at least 3 elements).
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param bounds         ranges of the stencils and their bounding boxes
     ///
-    /// @param deviceContext    not used in the cpu evaluator
+    /// @param instance       not used in the cpu kernel
     ///
-    template <typename SRC_BUFFER, typename DST_BUFFER,
-              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
-    static bool EvalPatches(
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsBounds(
         SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
         DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
-        int numPatchCoords,
-        PATCHCOORD_BUFFER *patchCoords,
-        PATCH_TABLE *patchTable,
-        CpuEvaluator const *instance = NULL,
+        STENCIL_TABLE const *stencilTable,
+        BoundsDescriptor const &bounds,
+        const CpuEvaluator *instance = NULL,
         void * deviceContext = NULL) {
 
         (void)instance;       // unused
         (void)deviceContext;  // unused
 
-        return EvalPatches(srcBuffer->BindCpuBuffer(), srcDesc,
-                           dstBuffer->BindCpuBuffer(), dstDesc,
-                           numPatchCoords,
-                           (const PatchCoord*)patchCoords->BindCpuBuffer(),
-                           patchTable->GetPatchArrayBuffer(),
-                           patchTable->GetPatchIndexBuffer(),
-                           patchTable->GetPatchParamBuffer());
+        return EvalStencilsBounds(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  dstBuffer->BindCpuBuffer(), dstDesc,
+                                  &stencilTable->GetSizes()[0],
+                                  &stencilTable->GetOffsets()[0],
+                                  &stencilTable->GetControlIndices()[0],
+                                  &stencilTable->GetWeights()[0],
+                                  bounds,
+                                  /*start = */ 0,
+                                  /*end   = */ stencilTable->GetNumStencils());
     }
 
-    /// \brief Generic limit eval function with derivatives. This function has
-    ///        a same signature as other device kernels have so that it can be
-    ///        called in the same way.
+    /// \brief Static eval stencils function also computing the bounding
+    ///        boxes of the first three elements of the results, which takes
+    ///        raw CPU pointers for input and output.
     ///
-    /// @param srcBuffer        Input primvar buffer.
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         const float pointer for read
+    /// @param src            Input primvar pointer. An offset of srcDesc
+    ///                       will be applied internally
     ///
-    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
     ///
-    /// @param dstBuffer        Output primvar buffer
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         float pointer for write
+    /// @param dst            Output primvar pointer (of at least 3 elements).
+    ///                       An offset of dstDesc will be applied internally.
     ///
-    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
     ///
-    /// @param duBuffer         Output buffer derivative wrt u
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         float pointer for write
+    /// @param sizes          pointer to the sizes buffer of the stencil table
     ///
-    /// @param duDesc           vertex buffer descriptor for the duBuffer
+    /// @param offsets        pointer to the offsets buffer of the stencil table
     ///
-    /// @param dvBuffer         Output buffer derivative wrt v
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         float pointer for write
+    /// @param indices        pointer to the indices buffer of the stencil table
     ///
-    /// @param dvDesc           vertex buffer descriptor for the dvBuffer
+    /// @param weights        pointer to the weights buffer of the stencil table
     ///
-    /// @param numPatchCoords   number of patchCoords.
+    /// @param bounds         ranges of the stencils and their bounding boxes,
+    ///                       bounding the stencils from start to end only
     ///
-    /// @param patchCoords      array of locations to be evaluated.
+    /// @param start          start index of stencil table
     ///
-    /// @param patchTable       CpuPatchTable or equivalent
-    ///                         XXX: currently Far::PatchTable can't be used
-    ///                              due to interface mismatch
+    /// @param end            end index of stencil table
     ///
-    /// @param instance         not used in the cpu evaluator
+    static bool EvalStencilsBounds(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        BoundsDescriptor const &bounds,
+        int start, int end);
+
+    /// ----------------------------------------------------------------------
     ///
-    /// @param deviceContext    not used in the cpu evaluator
+    ///   Displaced limit evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic limit eval function writing the limit points displaced
+    ///        along the unit normals of the limit surface, and optionally
+    ///        the normals of the displaced surface, in a single pass.
+    ///
+    /// The displacement of each patch coord is sampled at its ptex face and
+    /// (s,t). The normals of the displaced surface are those of the
+    /// derivatives of the limit surface offset by the derivatives of the
+    /// displacement along the normal, i.e. the variation of the limit normal
+    /// itself is ignored, as for bump mapping.
+    ///
+    /// @param srcBuffer      Input primvar buffer (of at least 3 elements,
+    ///                       the first 3 of which are displaced).
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param normalBuffer   Output buffer of the normals of the displaced
+    ///                       surface (or NULL)
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param normalDesc     vertex buffer descriptor for the normals
+    ///                       (of length 3)
+    ///
+    /// @param numPatchCoords number of patchCoords.
+    ///
+    /// @param patchCoords    array of locations to be evaluated.
+    ///                       must have BindCpuBuffer() method returning an
+    ///                       array of PatchCoord struct.
+    ///
+    /// @param patchTable     CpuPatchTable or equivalent
+    ///
+    /// @param sampler        displacement sampler
+    ///
+    /// @param samplerData    data passed to the sampler
     ///
     template <typename SRC_BUFFER, typename DST_BUFFER,
               typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
-    static bool EvalPatches(
-        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
-        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
-        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
-        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+    static bool EvalPatchesDisplaced(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
         int numPatchCoords,
         PATCHCOORD_BUFFER *patchCoords,
         PATCH_TABLE *patchTable,
-        CpuEvaluator const *instance = NULL,
-        void * deviceContext = NULL) {
+        DisplacementSampler sampler,
+        void *samplerData) {
 
-        (void)instance;       // unused
-        (void)deviceContext;  // unused
-
-        // XXX: PatchCoords is somewhat abusing vertex primvar buffer interop.
-        //      ideally all buffer classes should have templated by datatype
-        //      so that downcast isn't needed there.
-        //      (e.g. Osd::CpuBuffer<PatchCoord> )
-        //
-        return EvalPatches(srcBuffer->BindCpuBuffer(), srcDesc,
-                           dstBuffer->BindCpuBuffer(), dstDesc,
-                           duBuffer->BindCpuBuffer(),  duDesc,
-                           dvBuffer->BindCpuBuffer(),  dvDesc,
-                           numPatchCoords,
-                           (const PatchCoord*)patchCoords->BindCpuBuffer(),
-                           patchTable->GetPatchArrayBuffer(),
-                           patchTable->GetPatchIndexBuffer(),
-                           patchTable->GetPatchParamBuffer());
+        return EvalPatchesDisplaced(srcBuffer->BindCpuBuffer(), srcDesc,
+                                    dstBuffer->BindCpuBuffer(), dstDesc,
+                                    normalBuffer ?
+                                        normalBuffer->BindCpuBuffer() : NULL,
+                                    normalDesc,
+                                    numPatchCoords,
+                                    (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                                    patchTable->GetPatchArrayBuffer(),
+                                    patchTable->GetPatchIndexBuffer(),
+                                    patchTable->GetPatchParamBuffer(),
+                                    sampler, samplerData);
     }
 
-    /// \brief Generic limit eval function with derivatives. This function has
-    ///        a same signature as other device kernels have so that it can be
-    ///        called in the same way.
+    /// \brief Static limit eval function writing the displaced limit points
+    ///        and optionally the normals of the displaced surface (see
+    ///        above), which takes raw CPU pointers for input and output.
     ///
-    /// @param srcBuffer        Input primvar buffer.
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         const float pointer for read
+    /// @param src              Input primvar pointer (of at least 3
+    ///                         elements). An offset of srcDesc will be
+    ///                         applied internally
     ///
     /// @param srcDesc          vertex buffer descriptor for the input buffer
     ///
-    /// @param dstBuffer        Output primvar buffer
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         float pointer for write
+    /// @param dst              Output primvar pointer. An offset of dstDesc
+    ///                         will be applied internally.
     ///
     /// @param dstDesc          vertex buffer descriptor for the output buffer
     ///
-    /// @param duBuffer         Output buffer derivative wrt u
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         float pointer for write
+    /// @param normal           Output pointer of the normals of the displaced
+    ///                         surface (or NULL). An offset of normalDesc
+    ///                         will be applied internally.
     ///
-    /// @param duDesc           vertex buffer descriptor for the duBuffer
+    /// @param normalDesc       vertex buffer descriptor for the normals
+    ///                         (of length 3)
     ///
-    /// @param dvBuffer         Output buffer derivative wrt v
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         float pointer for write
+    /// @param numPatchCoords   number of patchCoords.
     ///
-    /// @param dvDesc           vertex buffer descriptor for the dvBuffer
+    /// @param patchCoords      array of locations to be evaluated.
     ///
-    /// @param duuBuffer        Output buffer 2nd derivative wrt u
-    ///                         must have BindCpuBuffer() method returning a
-    ///                         float pointer for write
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///                         indexed by PatchCoord::arrayIndex
     ///
-    /// @param duuDesc          vertex buffer descriptor for the duuBuffer
+    /// @param patchIndexBuffer an array of patch indices
+    ///                         indexed by PatchCoord::vertIndex
     ///
-    /// @param duvBuffer        Output buffer 2nd derivative wrt u and v
+    /// @param patchParamBuffer an array of Osd::PatchParam struct
+    ///                         indexed by PatchCoord::patchIndex
+    ///
+    /// @param sampler          displacement sampler
+    ///
+    /// @param samplerData      data passed to the sampler
+    ///
+    static bool EvalPatchesDisplaced(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *normal,    BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer,
+        DisplacementSampler sampler,
+        void *samplerData);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Limit evaluations with PatchTable and StencilTable
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic limit eval function evaluating the patches directly
+    ///        from the control vertices. The points of the patches past the
+    ///        control vertices are computed from their stencils as needed,
+    ///        so no buffer of refined vertices and local points is required
+    ///        when only limit samples are needed.
+    ///
+    /// @param srcBuffer        Input buffer of the control vertices.
     ///                         must have BindCpuBuffer() method returning a
-    ///                         float pointer for write
+    ///                         const float pointer for read
     ///
-    /// @param duvDesc          vertex buffer descriptor for the duvBuffer
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
     ///
-    /// @param dvvBuffer        Output buffer 2nd derivative wrt v
+    /// @param dstBuffer        Output primvar buffer
     ///                         must have BindCpuBuffer() method returning a
     ///                         float pointer for write
     ///
-    /// @param dvvDesc          vertex buffer descriptor for the dvvBuffer
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
     ///
     /// @param numPatchCoords   number of patchCoords.
     ///
     /// @param patchCoords      array of locations to be evaluated.
     ///
     /// @param patchTable       CpuPatchTable or equivalent
-    ///                         XXX: currently Far::PatchTable can't be used
-    ///                              due to interface mismatch
+    ///
+    /// @param stencilTable     Far::StencilTable of the refined vertices and
+    ///                         local points the patches refer to, factorized
+    ///                         to the control vertices (i.e. created without
+    ///                         MeshMultiLevelStencils)
     ///
     /// @param instance         not used in the cpu evaluator
     ///
     /// @param deviceContext    not used in the cpu evaluator
     ///
     template <typename SRC_BUFFER, typename DST_BUFFER,
-              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
-    static bool EvalPatches(
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename STENCIL_TABLE>
+    static bool EvalPatchesWithStencils(
         SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
         DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
-        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
-        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
-        DST_BUFFER *duuBuffer, BufferDescriptor const &duuDesc,
-        DST_BUFFER *duvBuffer, BufferDescriptor const &duvDesc,
-        DST_BUFFER *dvvBuffer, BufferDescriptor const &dvvDesc,
         int numPatchCoords,
         PATCHCOORD_BUFFER *patchCoords,
         PATCH_TABLE *patchTable,
+        STENCIL_TABLE const *stencilTable,
         CpuEvaluator const *instance = NULL,
         void * deviceContext = NULL) {
 
         (void)instance;       // unused
         (void)deviceContext;  // unused
 
-        // XXX: PatchCoords is somewhat abusing vertex primvar buffer interop.
-        //      ideally all buffer classes should have templated by datatype
-        //      so that downcast isn't needed there.
-        //      (e.g. Osd::CpuBuffer<PatchCoord> )
-        //
-        return EvalPatches(srcBuffer->BindCpuBuffer(), srcDesc,
+        return EvalPatchesWithStencils(srcBuffer->BindCpuBuffer(), srcDesc,
                            dstBuffer->BindCpuBuffer(), dstDesc,
-                           duBuffer->BindCpuBuffer(),  duDesc,
-                           dvBuffer->BindCpuBuffer(),  dvDesc,
-                           duuBuffer->BindCpuBuffer(), duuDesc,
-                           duvBuffer->BindCpuBuffer(), duvDesc,
-                           dvvBuffer->BindCpuBuffer(), dvvDesc,
+                           NULL, BufferDescriptor(),
+                           NULL, BufferDescriptor(),
                            numPatchCoords,
                            (const PatchCoord*)patchCoords->BindCpuBuffer(),
                            patchTable->GetPatchArrayBuffer(),
                            patchTable->GetPatchIndexBuffer(),
-                           patchTable->GetPatchParamBuffer());
+                           patchTable->GetPatchParamBuffer(),
+                           stencilTable);
     }
 
-    /// \brief Static limit eval function. It takes an array of PatchCoord
-    ///        and evaluate limit values on given PatchTable.
-    ///
-    /// @param src              Input primvar pointer. An offset of srcDesc
-    ///                         will be applied internally (i.e. the pointer
-    ///                         should not include the offset)
-    ///
-    /// @param srcDesc          vertex buffer descriptor for the input buffer
-    ///
-    /// @param dst              Output primvar pointer. An offset of dstDesc
-    ///                         will be applied internally.
-    ///
-    /// @param dstDesc          vertex buffer descriptor for the output buffer
-    ///
-    /// @param numPatchCoords   number of patchCoords.
-    ///
-    /// @param patchCoords      array of locations to be evaluated.
-    ///
-    /// @param patchArrays      an array of Osd::PatchArray struct
-    ///                         indexed by PatchCoord::arrayIndex
-    ///
-    /// @param patchIndexBuffer an array of patch indices
-    ///                         indexed by PatchCoord::vertIndex
-    ///
-    /// @param patchParamBuffer an array of Osd::PatchParam struct
-    ///                         indexed by PatchCoord::patchIndex
-    ///
-    static bool EvalPatches(
-        const float *src, BufferDescriptor const &srcDesc,
-        float *dst,       BufferDescriptor const &dstDesc,
-        int numPatchCoords,
-        const PatchCoord *patchCoords,
-        const PatchArray *patchArrays,
-        const int *patchIndexBuffer,
-        const PatchParam *patchParamBuffer);
-
-    /// \brief Static limit eval function. It takes an array of PatchCoord
-    ///        and evaluate limit values on given PatchTable.
+    /// \brief Generic limit eval function evaluating the patches and their
+    ///        first derivatives directly from the control vertices (see
+    ///        above).
     ///
-    /// @param src              Input primvar pointer. An offset of srcDesc
-    ///                         will be applied internally (i.e. the pointer
-    ///                         should not include the offset)
+    /// @param srcBuffer        Input buffer of the control vertices.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
     ///
     /// @param srcDesc          vertex buffer descriptor for the input buffer
     ///
-    /// @param dst              Output primvar pointer. An offset of dstDesc
-    ///                         will be applied internally.
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
     ///
     /// @param dstDesc          vertex buffer descriptor for the output buffer
     ///
-    /// @param du               Output pointer derivative wrt u. An offset of
-    ///                         duDesc will be applied internally.
+    /// @param duBuffer         Output buffer derivative wrt u
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
     ///
     /// @param duDesc           vertex buffer descriptor for the duBuffer
     ///
-    /// @param dv               Output pointer derivative wrt v. An offset of
-    ///                         dvDesc will be applied internally.
+    /// @param dvBuffer         Output buffer derivative wrt v
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
     ///
     /// @param dvDesc           vertex buffer descriptor for the dvBuffer
     ///
@@ -704,65 +2352,68 @@ public:
     ///
     /// @param patchCoords      array of locations to be evaluated.
     ///
-    /// @param patchArrays      an array of Osd::PatchArray struct
-    ///                         indexed by PatchCoord::arrayIndex
+    /// @param patchTable       CpuPatchTable or equivalent
     ///
-    /// @param patchIndexBuffer an array of patch indices
-    ///                         indexed by PatchCoord::vertIndex
+    /// @param stencilTable     Far::StencilTable of the refined vertices and
+    ///                         local points the patches refer to, factorized
+    ///                         to the control vertices
     ///
-    /// @param patchParamBuffer an array of Osd::PatchParam struct
-    ///                         indexed by PatchCoord::patchIndex
+    /// @param instance         not used in the cpu evaluator
     ///
-    static bool EvalPatches(
-        const float *src, BufferDescriptor const &srcDesc,
-        float *dst,       BufferDescriptor const &dstDesc,
-        float *du,        BufferDescriptor const &duDesc,
-        float *dv,        BufferDescriptor const &dvDesc,
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename STENCIL_TABLE>
+    static bool EvalPatchesWithStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
         int numPatchCoords,
-        PatchCoord const *patchCoords,
-        PatchArray const *patchArrays,
-        const int *patchIndexBuffer,
-        PatchParam const *patchParamBuffer);
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        STENCIL_TABLE const *stencilTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
 
-    /// \brief Static limit eval function. It takes an array of PatchCoord
-    ///        and evaluate limit values on given PatchTable.
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesWithStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                           dstBuffer->BindCpuBuffer(), dstDesc,
+                           duBuffer->BindCpuBuffer(),  duDesc,
+                           dvBuffer->BindCpuBuffer(),  dvDesc,
+                           numPatchCoords,
+                           (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                           patchTable->GetPatchArrayBuffer(),
+                           patchTable->GetPatchIndexBuffer(),
+                           patchTable->GetPatchParamBuffer(),
+                           stencilTable);
+    }
+
+    /// \brief Static limit eval function evaluating the patches directly
+    ///        from the control vertices, computing their other points from
+    ///        their stencils.
     ///
-    /// @param src              Input primvar pointer. An offset of srcDesc
-    ///                         will be applied internally (i.e. the pointer
-    ///                         should not include the offset)
+    /// @param src              Input pointer to the control vertices. An
+    ///                         offset of srcDesc will be applied internally
     ///
     /// @param srcDesc          vertex buffer descriptor for the input buffer
     ///
-    /// @param dst              Output primvar pointer. An offset of dstDesc
-    ///                         will be applied internally.
+    /// @param dst              Output primvar pointer (or NULL). An offset of
+    ///                         dstDesc will be applied internally.
     ///
     /// @param dstDesc          vertex buffer descriptor for the output buffer
     ///
-    /// @param du               Output pointer derivative wrt u. An offset of
-    ///                         duDesc will be applied internally.
+    /// @param du               Output pointer derivative wrt u (or NULL)
     ///
     /// @param duDesc           vertex buffer descriptor for the duBuffer
     ///
-    /// @param dv               Output pointer derivative wrt v. An offset of
-    ///                         dvDesc will be applied internally.
+    /// @param dv               Output pointer derivative wrt v (or NULL)
     ///
     /// @param dvDesc           vertex buffer descriptor for the dvBuffer
     ///
-    /// @param duu              Output pointer 2nd derivative wrt u. An offset of
-    ///                         duuDesc will be applied internally.
-    ///
-    /// @param duuDesc          vertex buffer descriptor for the duuBuffer
-    ///
-    /// @param duv              Output pointer 2nd derivative wrt u and v. An offset of
-    ///                         duvDesc will be applied internally.
-    ///
-    /// @param duvDesc          vertex buffer descriptor for the duvBuffer
-    ///
-    /// @param dvv              Output pointer 2nd derivative wrt v. An offset of
-    ///                         dvvDesc will be applied internally.
-    ///
-    /// @param dvvDesc          vertex buffer descriptor for the dvvBuffer
-    ///
     /// @param numPatchCoords   number of patchCoords.
     ///
     /// @param patchCoords      array of locations to be evaluated.
@@ -776,19 +2427,20 @@ public:
     /// @param patchParamBuffer an array of Osd::PatchParam struct
     ///                         indexed by PatchCoord::patchIndex
     ///
-    static bool EvalPatches(
+    /// @param stencilTable     stencils of the points past the control
+    ///                         vertices, factorized to the control vertices
+    ///
+    static bool EvalPatchesWithStencils(
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
         float *du,        BufferDescriptor const &duDesc,
         float *dv,        BufferDescriptor const &dvDesc,
-        float *duu,       BufferDescriptor const &duuDesc,
-        float *duv,       BufferDescriptor const &duvDesc,
-        float *dvv,       BufferDescriptor const &dvvDesc,
         int numPatchCoords,
         PatchCoord const *patchCoords,
         PatchArray const *patchArrays,
         const int *patchIndexBuffer,
-        PatchParam const *patchParamBuffer);
+        PatchParam const *patchParamBuffer,
+        Far::StencilTable const *stencilTable);
 
     /// \brief Generic limit eval function. This function has a same
     ///        signature as other device kernels have so that it can be called
@@ -1217,6 +2869,331 @@ public:
                            patchTable->GetFVarPatchParamBuffer(fvarChannel));
     }
 
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Structure of arrays evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static eval stencils function for primvars stored as a
+    ///        structure of arrays (see SoaBufferDescriptor). Each component
+    ///        is evaluated on its own, vectorized across the source vertices
+    ///        of the stencils.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        SoA buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        SoA buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsSoa(
+        SRC_BUFFER *srcBuffer, SoaBufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, SoaBufferDescriptor const &dstDesc,
+        STENCIL_TABLE const *stencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalStencilsSoa(srcBuffer->BindCpuBuffer(), srcDesc,
+                               dstBuffer->BindCpuBuffer(), dstDesc,
+                               NULL, SoaBufferDescriptor(),
+                               NULL, SoaBufferDescriptor(),
+                               &stencilTable->GetSizes()[0],
+                               &stencilTable->GetOffsets()[0],
+                               &stencilTable->GetControlIndices()[0],
+                               &stencilTable->GetWeights()[0],
+                               NULL, NULL,
+                               /*start = */ 0,
+                               /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Generic static eval stencils function with derivatives for
+    ///        primvars stored as a structure of arrays (see above).
+    ///
+    /// @param stencilTable   Far::LimitStencilTable or equivalent
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsSoa(
+        SRC_BUFFER *srcBuffer, SoaBufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, SoaBufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  SoaBufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  SoaBufferDescriptor const &dvDesc,
+        STENCIL_TABLE const *stencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalStencilsSoa(srcBuffer->BindCpuBuffer(), srcDesc,
+                               dstBuffer->BindCpuBuffer(), dstDesc,
+                               duBuffer->BindCpuBuffer(), duDesc,
+                               dvBuffer->BindCpuBuffer(), dvDesc,
+                               &stencilTable->GetSizes()[0],
+                               &stencilTable->GetOffsets()[0],
+                               &stencilTable->GetControlIndices()[0],
+                               &stencilTable->GetWeights()[0],
+                               &stencilTable->GetDuWeights()[0],
+                               &stencilTable->GetDvWeights()[0],
+                               /*start = */ 0,
+                               /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function for primvars stored as a
+    ///        structure of arrays, which takes raw CPU pointers for input
+    ///        and output.
+    ///
+    /// @param src            Input primvar pointer. An offset of srcDesc
+    ///                       will be applied internally
+    ///
+    /// @param srcDesc        SoA buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer. An offset of dstDesc
+    ///                       will be applied internally.
+    ///
+    /// @param dstDesc        SoA buffer descriptor for the output buffer
+    ///
+    /// @param du             Output pointer of the du-derivatives (or NULL
+    ///                       together with dv)
+    ///
+    /// @param duDesc         SoA buffer descriptor for the du-derivatives
+    ///
+    /// @param dv             Output pointer of the dv-derivatives (or NULL
+    ///                       together with du)
+    ///
+    /// @param dvDesc         SoA buffer descriptor for the dv-derivatives
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param duWeights      pointer to the du-weights buffer of the stencil
+    ///                       table (only read with the derivatives)
+    ///
+    /// @param dvWeights      pointer to the dv-weights buffer of the stencil
+    ///                       table (only read with the derivatives)
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    static bool EvalStencilsSoa(
+        const float *src, SoaBufferDescriptor const &srcDesc,
+        float *dst,       SoaBufferDescriptor const &dstDesc,
+        float *du,        SoaBufferDescriptor const &duDesc,
+        float *dv,        SoaBufferDescriptor const &dvDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        int start, int end);
+
+    /// \brief Static eval stencils function for primvars whose components
+    ///        are stored in separate arrays, e.g. by a simulation.
+    ///
+    /// @param src            Array of numComponents pointers to the input
+    ///                       arrays of the components
+    ///
+    /// @param dst            Array of numComponents pointers to the output
+    ///                       arrays of the components
+    ///
+    /// @param du             Array of numComponents pointers to the output
+    ///                       arrays of the du-derivatives (or NULL together
+    ///                       with dv)
+    ///
+    /// @param dv             Array of numComponents pointers to the output
+    ///                       arrays of the dv-derivatives (or NULL together
+    ///                       with du)
+    ///
+    /// @param numComponents  number of components of the primvar
+    ///
+    /// The stencil table arguments are those of the function above.
+    ///
+    static bool EvalStencilsSoa(
+        const float * const *src,
+        float * const *dst,
+        float * const *du,
+        float * const *dv,
+        int numComponents,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        int start, int end);
+
+    /// \brief Generic limit eval function for primvars stored as a
+    ///        structure of arrays (see SoaBufferDescriptor). The results of
+    ///        consecutive coords on the same patch are accumulated together
+    ///        in each component array.
+    ///
+    /// @param srcBuffer        Input primvar buffer.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          SoA buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          SoA buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesSoa(
+        SRC_BUFFER *srcBuffer, SoaBufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, SoaBufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesSoa(srcBuffer->BindCpuBuffer(), srcDesc,
+                              dstBuffer->BindCpuBuffer(), dstDesc,
+                              NULL, SoaBufferDescriptor(),
+                              NULL, SoaBufferDescriptor(),
+                              numPatchCoords,
+                              (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                              patchTable->GetPatchArrayBuffer(),
+                              patchTable->GetPatchIndexBuffer(),
+                              patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Generic limit eval function with derivatives for primvars
+    ///        stored as a structure of arrays (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesSoa(
+        SRC_BUFFER *srcBuffer, SoaBufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, SoaBufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  SoaBufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  SoaBufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesSoa(srcBuffer->BindCpuBuffer(), srcDesc,
+                              dstBuffer->BindCpuBuffer(), dstDesc,
+                              duBuffer->BindCpuBuffer(), duDesc,
+                              dvBuffer->BindCpuBuffer(), dvDesc,
+                              numPatchCoords,
+                              (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                              patchTable->GetPatchArrayBuffer(),
+                              patchTable->GetPatchIndexBuffer(),
+                              patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static limit eval function for primvars stored as a structure
+    ///        of arrays, which takes raw CPU pointers for input and output.
+    ///        Any of dst, du and dv may be NULL.
+    ///
+    /// @param src              Input primvar pointer. An offset of srcDesc
+    ///                         will be applied internally
+    ///
+    /// @param srcDesc          SoA buffer descriptor for the input buffer
+    ///
+    /// @param dst              Output primvar pointer. An offset of dstDesc
+    ///                         will be applied internally.
+    ///
+    /// @param dstDesc          SoA buffer descriptor for the output buffer
+    ///
+    /// @param du               Output pointer of the du-derivatives
+    ///
+    /// @param duDesc           SoA buffer descriptor for the du-derivatives
+    ///
+    /// @param dv               Output pointer of the dv-derivatives
+    ///
+    /// @param dvDesc           SoA buffer descriptor for the dv-derivatives
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///                         indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer an array of patch indices
+    ///                         indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer an array of Osd::PatchParam struct
+    ///                         indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatchesSoa(
+        const float *src, SoaBufferDescriptor const &srcDesc,
+        float *dst,       SoaBufferDescriptor const &dstDesc,
+        float *du,        SoaBufferDescriptor const &duDesc,
+        float *dv,        SoaBufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    /// \brief Static limit eval function for primvars whose components are
+    ///        stored in separate arrays (see EvalStencilsSoa()). Any of dst,
+    ///        du and dv may be NULL.
+    ///
+    static bool EvalPatchesSoa(
+        const float * const *src,
+        float * const *dst,
+        float * const *du,
+        float * const *dv,
+        int numComponents,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
     /// ----------------------------------------------------------------------
     ///
     ///   Other methods
@@ -1227,6 +3204,29 @@ public:
     static void Synchronize(void * /*deviceContext = NULL*/) {
         // nothing.
     }
+
+    /// \brief Enables or disables reproducible evaluation
+    ///
+    /// By default, stencils are evaluated with the kernels vectorized for
+    /// the host CPU (whose fused multiply-adds round differently) and runs
+    /// of consecutive PatchCoords on the same patch share the evaluation of
+    /// their basis.  When reproducible evaluation is enabled, the portable
+    /// kernels are used and each PatchCoord is evaluated on its own, so that
+    /// the results of CpuEvaluator, OmpEvaluator and TbbEvaluator are
+    /// bitwise identical to each other, independently of the host CPU and of
+    /// the number of threads.  The setting is shared by the three
+    /// evaluators and should not be changed while evaluations are running.
+    ///
+    /// Stencil tables built by Far are themselves identical regardless of
+    /// the number of threads used to build them (see
+    /// Far::StencilTableFactory::Options::numThreads).
+    ///
+    /// @param reproducible    true to enable reproducible evaluation
+    ///
+    static void SetReproducible(bool reproducible);
+
+    /// \brief Returns true if reproducible evaluation is enabled
+    static bool IsReproducible();
 };
 
 
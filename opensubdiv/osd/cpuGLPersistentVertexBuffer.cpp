@@ -0,0 +1,203 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "glLoader.h"
+
+#include "../osd/cpuGLPersistentVertexBuffer.h"
+
+#include <string.h>
+
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+namespace {
+    // Triple buffering keeps the cpu from waiting on frames still in flight
+    // for the typical depth of the GL command queue
+    const int DEFAULT_NUM_REGIONS = 3;
+}
+
+CpuGLPersistentVertexBuffer::CpuGLPersistentVertexBuffer(int numElements,
+    int numVertices, int numRegions)
+    : _numElements(numElements), _numVertices(numVertices),
+      _numRegions(numRegions), _region(0),
+      _vbo(0), _mappedBuffer(0), _fences(0), _boundForDraw(false) {
+
+    // Initialize internal OpenGL loader library if necessary
+    OpenSubdiv::internal::GLLoader::libraryInitializeGL();
+}
+
+CpuGLPersistentVertexBuffer::~CpuGLPersistentVertexBuffer() {
+
+    if (_fences) {
+        for (int i = 0; i < _numRegions; ++i) {
+            if (_fences[i]) {
+                glDeleteSync(_fences[i]);
+            }
+        }
+        delete[] _fences;
+    }
+
+    if (_vbo) {
+        if (_mappedBuffer) {
+            glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &_vbo);
+    }
+}
+
+CpuGLPersistentVertexBuffer *
+CpuGLPersistentVertexBuffer::Create(int numElements, int numVertices,
+                                    void *deviceContext) {
+
+    return Create(numElements, numVertices, DEFAULT_NUM_REGIONS,
+                  deviceContext);
+}
+
+CpuGLPersistentVertexBuffer *
+CpuGLPersistentVertexBuffer::Create(int numElements, int numVertices,
+                                    int numRegions, void *) {
+
+    if (numRegions < 1) return NULL;
+
+    CpuGLPersistentVertexBuffer *instance =
+        new CpuGLPersistentVertexBuffer(numElements, numVertices, numRegions);
+    if (instance->allocate()) return instance;
+    delete instance;
+    return NULL;
+}
+
+void
+CpuGLPersistentVertexBuffer::UpdateData(const float *src,
+                                        int startVertex, int numVertices,
+                                        void * /*deviceContext*/) {
+
+    memcpy(BindCpuBuffer() + startVertex * GetNumElements(), src,
+           GetNumElements() * numVertices * sizeof(float));
+}
+
+int
+CpuGLPersistentVertexBuffer::GetNumElements() const {
+
+    return _numElements;
+}
+
+int
+CpuGLPersistentVertexBuffer::GetNumVertices() const {
+
+    return _numVertices;
+}
+
+float*
+CpuGLPersistentVertexBuffer::BindCpuBuffer() {
+
+    if (_boundForDraw) {
+        advanceRegion();
+    }
+    return _mappedBuffer + _region * GetNumElements() * GetNumVertices();
+}
+
+GLuint
+CpuGLPersistentVertexBuffer::BindVBO(void * /*deviceContext*/) {
+
+    // The buffer is mapped coherently, so the data written by the cpu is
+    // visible to GL without any flush or copy
+    _boundForDraw = true;
+    return _vbo;
+}
+
+size_t
+CpuGLPersistentVertexBuffer::GetBufferOffset() const {
+
+    return (size_t)_region * GetNumElements() * GetNumVertices() *
+           sizeof(float);
+}
+
+void
+CpuGLPersistentVertexBuffer::advanceRegion() {
+
+    // Commands reading the current region have all been issued by now
+    _fences[_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    _region = (_region + 1) % _numRegions;
+
+    if (_fences[_region]) {
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        for (;;) {
+            GLenum status = glClientWaitSync(_fences[_region], flags,
+                                             1000000 /* ns */);
+            if ((status == GL_ALREADY_SIGNALED) ||
+                (status == GL_CONDITION_SATISFIED) ||
+                (status == GL_WAIT_FAILED)) break;
+            flags = 0;
+        }
+        glDeleteSync(_fences[_region]);
+        _fences[_region] = 0;
+    }
+    _boundForDraw = false;
+}
+
+bool
+CpuGLPersistentVertexBuffer::allocate() {
+
+#if defined(GL_ARB_buffer_storage)
+    if (OSD_OPENGL_HAS(ARB_buffer_storage) || OSD_OPENGL_HAS(VERSION_4_4)) {
+        GLsizeiptr size = (GLsizeiptr)_numRegions *
+            GetNumElements() * GetNumVertices() * sizeof(float);
+
+        // The evaluators also read the coarse and intermediate vertices
+        // back from the buffer, so request readable client-side storage
+        GLbitfield mapFlags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT |
+                              GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        GLint prev = 0;
+        glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &prev);
+        glGenBuffers(1, &_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+        glBufferStorage(GL_ARRAY_BUFFER, size, 0,
+                        mapFlags | GL_CLIENT_STORAGE_BIT);
+        _mappedBuffer = (float *)glMapBufferRange(GL_ARRAY_BUFFER, 0, size,
+                                                  mapFlags);
+        glBindBuffer(GL_ARRAY_BUFFER, prev);
+
+        if (! _mappedBuffer) return false;
+
+        _fences = new GLsync[_numRegions];
+        for (int i = 0; i < _numRegions; ++i) {
+            _fences[i] = 0;
+        }
+        return true;
+    }
+#endif
+    return false;
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
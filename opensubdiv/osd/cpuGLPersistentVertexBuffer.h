@@ -0,0 +1,130 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_OSD_CPU_GL_PERSISTENT_VERTEX_BUFFER_H
+#define OPENSUBDIV3_OSD_CPU_GL_PERSISTENT_VERTEX_BUFFER_H
+
+#include "../version.h"
+
+#include <cstddef>
+#include "../osd/opengl.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+///
+/// \brief Concrete vertex buffer class for cpu subdivision and OpenGL drawing
+///        through a persistently mapped GL buffer.
+///
+/// CpuGLPersistentVertexBuffer implements CpuVertexBufferInterface and
+/// GLVertexBufferInterface.
+///
+/// Unlike CpuGLVertexBuffer, no cpu-side copy of the vertex data exists:
+/// BindCpuBuffer returns the address of GL buffer storage mapped with
+/// GL_MAP_PERSISTENT_BIT, so that the cpu evaluators write refined vertices
+/// directly into memory visible to GL.  The storage is divided into a ring
+/// of regions -- each holding all vertices of the buffer -- so that the cpu
+/// can write one region while GL still reads from the others.  A fence is
+/// placed on a region when writing resumes after the region was bound with
+/// BindVBO, and the cpu waits on that fence only when the ring wraps around
+/// to the region again.
+///
+/// Since every region retains only the data written to it, all coarse
+/// vertices have to be supplied again with UpdateData each time the buffer
+/// is refined after it was bound for drawing.  The vertices of the current
+/// region start at GetBufferOffset bytes into the GL buffer.
+///
+/// Creation fails and returns NULL if the GL context does not support
+/// GL_ARB_buffer_storage (core in OpenGL 4.4).
+///
+class CpuGLPersistentVertexBuffer {
+public:
+    /// Creator with the default number of regions. Returns NULL if error.
+    static CpuGLPersistentVertexBuffer * Create(int numElements,
+                                                int numVertices,
+                                                void *deviceContext = NULL);
+
+    /// Creator with the given number of regions. Returns NULL if error.
+    static CpuGLPersistentVertexBuffer * Create(int numElements,
+                                                int numVertices,
+                                                int numRegions,
+                                                void *deviceContext);
+
+    /// Destructor.
+    ~CpuGLPersistentVertexBuffer();
+
+    /// This method is meant to be used in client code in order to provide
+    /// coarse vertices data to Osd.
+    void UpdateData(const float *src, int startVertex, int numVertices,
+                    void *deviceContext = NULL);
+
+    /// Returns how many elements defined in this vertex buffer.
+    int GetNumElements() const;
+
+    /// Returns how many vertices allocated in this vertex buffer.
+    int GetNumVertices() const;
+
+    /// Returns the mapped memory of the current region. Advances to the
+    /// next region first if the current one was bound with BindVBO.
+    float * BindCpuBuffer();
+
+    /// Returns the name of GL buffer object.
+    GLuint BindVBO(void *deviceContext = NULL);
+
+    /// Returns the offset in bytes of the current region in the GL buffer.
+    size_t GetBufferOffset() const;
+
+protected:
+    /// Constructor.
+    CpuGLPersistentVertexBuffer(int numElements, int numVertices,
+                                int numRegions);
+
+    /// Allocates and maps the GL buffer storage. Returns true if success.
+    bool allocate();
+
+    /// Fences the current region and waits for the next one to be released
+    /// by GL.
+    void advanceRegion();
+
+private:
+    int _numElements;
+    int _numVertices;
+    int _numRegions;
+    int _region;
+    GLuint _vbo;
+    float *_mappedBuffer;
+    GLsync *_fences;
+    bool _boundForDraw;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_GL_PERSISTENT_VERTEX_BUFFER_H
@@ -26,6 +26,7 @@
 
 #include "../osd/cpuGLVertexBuffer.h"
 
+#include <algorithm>
 #include <string.h>
 
 
@@ -36,7 +37,7 @@ namespace Osd {
 
 CpuGLVertexBuffer::CpuGLVertexBuffer(int numElements, int numVertices)
     : _numElements(numElements), _numVertices(numVertices),
-      _vbo(0), _cpuBuffer(0), _dataDirty(true) {
+      _vbo(0), _cpuBuffer(0), _dirtyBegin(0), _dirtyEnd(numVertices) {
 
     // Initialize internal OpenGL loader library if necessary
     OpenSubdiv::internal::GLLoader::libraryInitializeGL();
@@ -67,7 +68,8 @@ CpuGLVertexBuffer::UpdateData(const float *src,
 
     memcpy(_cpuBuffer + startVertex * GetNumElements(), src,
            GetNumElements() * numVertices * sizeof(float));
-    _dataDirty = true;
+
+    markDirty(startVertex, numVertices);
 }
 
 int
@@ -85,35 +87,68 @@ CpuGLVertexBuffer::GetNumVertices() const {
 float*
 CpuGLVertexBuffer::BindCpuBuffer() {
 
-    _dataDirty = true; // caller might modify data
+    // caller might modify data
+    _dirtyBegin = 0;
+    _dirtyEnd = GetNumVertices();
+    return _cpuBuffer;
+}
+
+float*
+CpuGLVertexBuffer::BindCpuBuffer(int startVertex, int numVertices) {
+
+    markDirty(startVertex, numVertices);
     return _cpuBuffer;
 }
 
 GLuint
 CpuGLVertexBuffer::BindVBO(void * /*deviceContext*/) {
 
-    if (! _dataDirty)
+    if (_dirtyBegin >= _dirtyEnd)
         return _vbo;
 
     int size = GetNumElements() * GetNumVertices() * sizeof(float);
 
-    if (! _vbo) {
+    bool allocated = (_vbo != 0);
+    if (! allocated) {
         glGenBuffers(1, &_vbo);
     }
 
     glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-    glBufferData(GL_ARRAY_BUFFER, size, _cpuBuffer, GL_STATIC_DRAW);
+    if (allocated && ((_dirtyEnd - _dirtyBegin) < GetNumVertices())) {
+        // upload only the vertices modified since the last upload
+        int stride = GetNumElements() * sizeof(float);
+        glBufferSubData(GL_ARRAY_BUFFER, _dirtyBegin * stride,
+                        (_dirtyEnd - _dirtyBegin) * stride,
+                        _cpuBuffer + _dirtyBegin * GetNumElements());
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, size, _cpuBuffer, GL_STATIC_DRAW);
+    }
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    _dataDirty = false;
+    _dirtyBegin = _dirtyEnd = 0;
     return _vbo;
 }
 
+void
+CpuGLVertexBuffer::markDirty(int startVertex, int numVertices) {
+
+    if (numVertices <= 0) return;
+
+    if (_dirtyBegin < _dirtyEnd) {
+        _dirtyBegin = std::min(_dirtyBegin, startVertex);
+        _dirtyEnd = std::max(_dirtyEnd, startVertex + numVertices);
+    } else {
+        _dirtyBegin = startVertex;
+        _dirtyEnd = startVertex + numVertices;
+    }
+}
+
 bool
 CpuGLVertexBuffer::allocate() {
 
     _cpuBuffer = new float[GetNumElements() * GetNumVertices()];
-    _dataDirty = true;
+    _dirtyBegin = 0;
+    _dirtyEnd = GetNumVertices();
     return true;
 }
 
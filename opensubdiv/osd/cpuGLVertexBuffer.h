@@ -44,6 +44,10 @@ namespace Osd {
 /// The buffer interop between Cpu and GL is handled automatically when a
 /// client calls BindCpuBuffer and BindVBO methods.
 ///
+/// The range of vertices modified with UpdateData since the last upload is
+/// tracked, so that BindVBO only uploads that range unless the whole buffer
+/// was exposed with BindCpuBuffer.
+///
 class CpuGLVertexBuffer {
 public:
     /// Creator. Returns NULL if error.
@@ -68,6 +72,11 @@ public:
     /// if necessary.
     float * BindCpuBuffer();
 
+    /// Returns cpu memory, of which only the given range of vertices will
+    /// be uploaded by the next BindVBO (in addition to the vertices already
+    /// modified). numVertices can be 0 when the memory is only read.
+    float * BindCpuBuffer(int startVertex, int numVertices);
+
     /// Returns the name of GL buffer object. If the buffer is mapped
     /// to cpu address, it will be unmapped back to GL.
     GLuint BindVBO(void *deviceContext = NULL);
@@ -79,12 +88,16 @@ protected:
     /// Allocates VBO for this buffer. Returns true if success.
     bool allocate();
 
+    /// Adds a range of vertices to the range to upload.
+    void markDirty(int startVertex, int numVertices);
+
 private:
     int _numElements;
     int _numVertices;
     GLuint _vbo;
     float *_cpuBuffer;
-    bool _dataDirty;
+    int _dirtyBegin;    // range of vertices to upload
+    int _dirtyEnd;
 };
 
 }  // end namespace Osd
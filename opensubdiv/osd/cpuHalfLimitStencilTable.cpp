@@ -0,0 +1,120 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/cpuHalfLimitStencilTable.h"
+#include "../far/stencilTable.h"
+
+#include <cmath>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+namespace {
+    void
+    convertWeights(std::vector<float> const & src,
+                   std::vector<unsigned short> & dst) {
+        dst.resize(src.size());
+        for (size_t i = 0; i < src.size(); ++i) {
+            dst[i] = CpuHalfLimitStencilTable::FloatToHalf(src[i]);
+        }
+    }
+
+    template <typename T>
+    size_t
+    capacityOf(std::vector<T> const & v) {
+        return v.capacity() * sizeof(T);
+    }
+}
+
+CpuHalfLimitStencilTable::CpuHalfLimitStencilTable(
+    Far::LimitStencilTable const *limitStencilTable) :
+    _sizes(limitStencilTable->GetSizes()),
+    _offsets(limitStencilTable->GetOffsets()),
+    _indices(limitStencilTable->GetControlIndices()),
+    _weights(limitStencilTable->GetWeights()) {
+
+    convertWeights(limitStencilTable->GetDuWeights(), _duWeights);
+    convertWeights(limitStencilTable->GetDvWeights(), _dvWeights);
+    convertWeights(limitStencilTable->GetDuuWeights(), _duuWeights);
+    convertWeights(limitStencilTable->GetDuvWeights(), _duvWeights);
+    convertWeights(limitStencilTable->GetDvvWeights(), _dvvWeights);
+}
+
+unsigned short
+CpuHalfLimitStencilTable::FloatToHalf(float value) {
+
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+    unsigned int   absBits = bits & 0x7fffffff;
+
+    if (absBits >= 0x7f800000) {
+        // infinity and NaN (kept quiet)
+        return (unsigned short)(sign | 0x7c00 |
+                                ((absBits > 0x7f800000) ? 0x200 : 0));
+    }
+    if (absBits >= 0x477ff000) {
+        // rounds beyond the largest half (65504)
+        return (unsigned short)(sign | 0x7c00);
+    }
+    if (absBits < 0x38800000) {
+        // subnormal halves are multiples of 2^-24, rounded to nearest even
+        // (a result of 0x400 is the smallest normal half)
+        float scaled = std::fabs(value) * 16777216.0f;
+        float rounded = std::floor(scaled);
+        float remainder = scaled - rounded;
+        if (remainder > 0.5f || (remainder == 0.5f &&
+                                 std::fmod(rounded, 2.0f) != 0.0f)) {
+            rounded += 1.0f;
+        }
+        return (unsigned short)(sign | (unsigned short)rounded);
+    }
+
+    // rebias the exponent and round the mantissa to nearest even -- a carry
+    // into the exponent yields the next power of two
+    unsigned int half = (absBits - 0x38000000) >> 13;
+    unsigned int remainder = absBits & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        ++half;
+    }
+    return (unsigned short)(sign | half);
+}
+
+size_t
+CpuHalfLimitStencilTable::GetMemoryUsage() const {
+    return capacityOf(_sizes) + capacityOf(_offsets) +
+           capacityOf(_indices) + capacityOf(_weights) +
+           capacityOf(_duWeights) + capacityOf(_dvWeights) +
+           capacityOf(_duuWeights) + capacityOf(_duvWeights) +
+           capacityOf(_dvvWeights);
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
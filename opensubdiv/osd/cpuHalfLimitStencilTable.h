@@ -0,0 +1,147 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_CPU_HALF_LIMIT_STENCIL_TABLE_H
+#define OPENSUBDIV3_OSD_CPU_HALF_LIMIT_STENCIL_TABLE_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class LimitStencilTable;
+}
+
+namespace Osd {
+
+/// \brief Cpu limit stencil table with half-precision derivative weights
+///
+/// This class is a copy of a Far::LimitStencilTable which stores the
+/// derivative weights as 16-bit IEEE half-precision floats, decoded on the
+/// fly by the CpuEvaluator kernels.  The sizes, offsets, indices and point
+/// weights are kept at full precision and are shared by the point and all
+/// derivatives, as in the original table.  With first derivatives, an
+/// entry takes 12 bytes instead of 16, and with second derivatives 18
+/// bytes instead of 28.
+///
+/// Half-precision weights have a relative error of at most 2^-11 (weights
+/// beyond 65504 overflow to infinity, far beyond the derivative weights of
+/// patches), which is acceptable for shading normals but not for
+/// positions.
+///
+class CpuHalfLimitStencilTable {
+public:
+    static CpuHalfLimitStencilTable *Create(
+        Far::LimitStencilTable const *limitStencilTable,
+        void *deviceContext = NULL) {
+        (void)deviceContext;  // unused
+        return new CpuHalfLimitStencilTable(limitStencilTable);
+    }
+
+    explicit CpuHalfLimitStencilTable(
+        Far::LimitStencilTable const *limitStencilTable);
+    ~CpuHalfLimitStencilTable() {}
+
+    /// \brief Converts a float to half precision (rounded to nearest even)
+    static unsigned short FloatToHalf(float value);
+
+    /// \brief Converts a half-precision value to float
+    static float HalfToFloat(unsigned short value) {
+        unsigned int sign = (unsigned int)(value & 0x8000) << 16;
+        unsigned int exponent = (value >> 10) & 0x1f;
+        unsigned int mantissa = value & 0x3ff;
+        if (exponent == 0) {
+            // zero and subnormals
+            float f = (float)mantissa * (1.0f / 16777216.0f);
+            return sign ? -f : f;
+        }
+        unsigned int bits = sign | (mantissa << 13) | ((exponent == 0x1f) ?
+            0x7f800000 : ((exponent + 112) << 23));
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    int GetNumStencils() const { return (int)_sizes.size(); }
+
+    /// \brief Returns true if the table has second derivative weights
+    bool HasSecondDerivatives() const { return !_duuWeights.empty(); }
+
+    std::vector<int> const & GetSizes() const { return _sizes; }
+    std::vector<Far::Offset> const & GetOffsets() const { return _offsets; }
+    std::vector<int> const & GetControlIndices() const { return _indices; }
+    std::vector<float> const & GetWeights() const { return _weights; }
+    std::vector<unsigned short> const & GetDuWeights() const { return _duWeights; }
+    std::vector<unsigned short> const & GetDvWeights() const { return _dvWeights; }
+    std::vector<unsigned short> const & GetDuuWeights() const { return _duuWeights; }
+    std::vector<unsigned short> const & GetDuvWeights() const { return _duvWeights; }
+    std::vector<unsigned short> const & GetDvvWeights() const { return _dvvWeights; }
+
+    // interfaces needed for CpuEvaluator
+    int const * GetSizesBuffer() const { return bufferOf(_sizes); }
+    Far::Offset const * GetOffsetsBuffer() const { return bufferOf(_offsets); }
+    int const * GetIndicesBuffer() const { return bufferOf(_indices); }
+    float const * GetWeightsBuffer() const { return bufferOf(_weights); }
+    unsigned short const * GetDuWeightsBuffer() const { return bufferOf(_duWeights); }
+    unsigned short const * GetDvWeightsBuffer() const { return bufferOf(_dvWeights); }
+    unsigned short const * GetDuuWeightsBuffer() const { return bufferOf(_duuWeights); }
+    unsigned short const * GetDuvWeightsBuffer() const { return bufferOf(_duvWeights); }
+    unsigned short const * GetDvvWeightsBuffer() const { return bufferOf(_dvvWeights); }
+
+    /// \brief Returns the number of bytes allocated by the table
+    size_t GetMemoryUsage() const;
+
+private:
+    template <typename T>
+    static T const * bufferOf(std::vector<T> const & v) {
+        return v.empty() ? 0 : &v[0];
+    }
+
+    std::vector<int>            _sizes;
+    std::vector<Far::Offset>    _offsets;
+    std::vector<int>            _indices;
+    std::vector<float>          _weights;
+    std::vector<unsigned short> _duWeights,
+                                _dvWeights,
+                                _duuWeights,
+                                _duvWeights,
+                                _dvvWeights;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_HALF_LIMIT_STENCIL_TABLE_H
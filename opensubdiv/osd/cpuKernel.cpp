@@ -23,11 +23,22 @@
 //
 
 #include "../osd/cpuKernel.h"
+#include "../osd/cpuCompactStencilTable.h"
+#include "../osd/cpuHalfLimitStencilTable.h"
+#include "../osd/cpuSimdKernel.h"
 #include "../osd/bufferDescriptor.h"
+#include "../osd/types.h"
+#include "../osd/patchBasisCommonTypes.h"
+#include "../osd/patchBasisCommon.h"
+#include "../osd/patchBasisCommonEval.h"
+#include "../far/patchBasis.h"
+#include "../far/patchDescriptor.h"
 
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 #include <cstdlib>
+#include <limits>
 #include <vector>
 
 namespace OpenSubdiv {
@@ -35,6 +46,23 @@ namespace OPENSUBDIV_VERSION {
 
 namespace Osd {
 
+//
+// Reproducible evaluation (see CpuSetReproducible())
+//
+static bool reproducibleEvaluation = false;
+
+void
+CpuSetReproducible(bool reproducible) {
+
+    reproducibleEvaluation = reproducible;
+}
+
+bool
+CpuIsReproducible() {
+
+    return reproducibleEvaluation;
+}
+
 template <class T> T *
 elementAtIndex(T * src, int index, BufferDescriptor const &desc) {
 
@@ -68,11 +96,35 @@ copy(float *dst, int dstIndex, const float *src, BufferDescriptor const &desc) {
     memcpy(dst, src, desc.length*sizeof(float));
 }
 
+//
+// Runs the kernels specialized for the primvar length when all destinations
+// have the length of the source
+//
+template <int NUM_OUTPUTS> static bool
+evalFixedLengthStencils(float const * src, BufferDescriptor const &srcDesc,
+                        float * const * dsts,
+                        BufferDescriptor const * const * dstDescs,
+                        float const * const * weights,
+                        int const * sizes, int const * indices,
+                        int numStencils) {
+
+    CpuStencilOutputs<NUM_OUTPUTS> out;
+    for (int d = 0; d < NUM_OUTPUTS; ++d) {
+        if (dstDescs[d]->length != srcDesc.length) return false;
+
+        out.dst[d] = dsts[d];
+        out.dstStride[d] = dstDescs[d]->stride;
+        out.weights[d] = weights[d];
+    }
+    return ComputeFixedLengthStencils<NUM_OUTPUTS>(src, srcDesc.stride,
+        srcDesc.length, out, sizes, indices, numStencils);
+}
+
 void
 CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 int start, int end) {
@@ -88,22 +140,23 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     src += srcDesc.offset;
     dst += dstDesc.offset;
 
-    if (srcDesc.length == 4 && dstDesc.length == 4 &&
-        srcDesc.stride == 4 && dstDesc.stride == 4) {
+    BufferDescriptor const * dstDescPtr = &dstDesc;
+
+    if (!reproducibleEvaluation &&
+        CpuEvalStencilsSimd(src, srcDesc, dst, dstDesc,
+                            sizes, indices, weights, end-start)) {
 
-        // SIMD fast path for aligned primvar data (4 floats)
-        ComputeStencilKernel<4>(src, dst,
-            sizes, indices, weights, start,  end);
+        // Vectorized kernel for the host CPU
 
-    } else if (srcDesc.length == 8 && dstDesc.length == 8 &&
-               srcDesc.stride == 8 && dstDesc.stride == 8) {
+    } else if (evalFixedLengthStencils<1>(src, srcDesc, &dst, &dstDescPtr,
+                                          &weights, sizes, indices,
+                                          end-start)) {
+
+        // Kernel specialized for the primvar length (up to 16 floats)
 
-        // SIMD fast path for aligned primvar data (8 floats)
-        ComputeStencilKernel<8>(src, dst,
-            sizes, indices, weights, start,  end);
     } else {
 
-        // Slow path for non-aligned data
+        // Slow path for longer primvars
 
         float * result = (float*)alloca(srcDesc.length * sizeof(float));
 
@@ -127,7 +180,7 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDu,     BufferDescriptor const &dstDuDesc,
                 float * dstDv,     BufferDescriptor const &dstDvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -146,6 +199,23 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     dstDu += dstDuDesc.offset;
     dstDv += dstDvDesc.offset;
 
+    if (!reproducibleEvaluation &&
+        CpuEvalStencilsSimd(src, srcDesc, dst, dstDesc,
+                            dstDu, dstDuDesc, dstDv, dstDvDesc,
+                            sizes, indices,
+                            weights, duWeights, dvWeights, end-start)) {
+        return;
+    }
+
+    float * const dsts[3] = { dst, dstDu, dstDv };
+    BufferDescriptor const * const dstDescs[3] = {
+        &dstDesc, &dstDuDesc, &dstDvDesc };
+    float const * const dstWeights[3] = { weights, duWeights, dvWeights };
+    if (evalFixedLengthStencils<3>(src, srcDesc, dsts, dstDescs, dstWeights,
+                                   sizes, indices, end-start)) {
+        return;
+    }
+
     int nOutLength = dstDesc.length + dstDuDesc.length + dstDvDesc.length;
     float * result   = (float*)alloca(nOutLength * sizeof(float));
     float * resultDu = result + dstDesc.length;
@@ -178,7 +248,7 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDuv,    BufferDescriptor const &dstDuvDesc,
                 float * dstDvv,    BufferDescriptor const &dstDvvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -206,6 +276,27 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     dstDuv += dstDuvDesc.offset;
     dstDvv += dstDvvDesc.offset;
 
+    if (!reproducibleEvaluation &&
+        CpuEvalStencilsSimd(src, srcDesc, dst, dstDesc,
+                            dstDu, dstDuDesc, dstDv, dstDvDesc,
+                            dstDuu, dstDuuDesc, dstDuv, dstDuvDesc,
+                            dstDvv, dstDvvDesc,
+                            sizes, indices,
+                            weights, duWeights, dvWeights,
+                            duuWeights, duvWeights, dvvWeights, end-start)) {
+        return;
+    }
+
+    float * const dsts[6] = { dst, dstDu, dstDv, dstDuu, dstDuv, dstDvv };
+    BufferDescriptor const * const dstDescs[6] = { &dstDesc,
+        &dstDuDesc, &dstDvDesc, &dstDuuDesc, &dstDuvDesc, &dstDvvDesc };
+    float const * const dstWeights[6] = { weights, duWeights, dvWeights,
+                                          duuWeights, duvWeights, dvvWeights };
+    if (evalFixedLengthStencils<6>(src, srcDesc, dsts, dstDescs, dstWeights,
+                                   sizes, indices, end-start)) {
+        return;
+    }
+
     int nOutLength = dstDesc.length + dstDuDesc.length + dstDvDesc.length
                    + dstDuuDesc.length + dstDuvDesc.length + dstDvvDesc.length;
     float * result   = (float*)alloca(nOutLength * sizeof(float));
@@ -239,6 +330,1865 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     }
 }
 
+//
+// Stencil kernel for double-precision primvar data -- the weights of each
+// stencil (of the type of the stencil table) are accumulated in double
+// precision for the point and each of its (optional) derivatives
+//
+void
+CpuEvalStencils(PrimvarBinding const * bindings, int numBindings,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end) {
+
+    assert(start>=0 && start<end);
+
+    if (start>0) {
+        sizes += start;
+        indices += offsets[start];
+        weights += offsets[start];
+    }
+
+    //  The results of all primvars are accumulated together:
+    int totalLength = 0;
+    for (int b = 0; b < numBindings; ++b) {
+        totalLength += bindings[b].srcDesc.length;
+    }
+    float * result = (float*)alloca(totalLength * sizeof(float));
+
+    int nStencils = end - start;
+    for (int i = 0; i < nStencils; ++i, ++sizes) {
+
+        memset(result, 0, totalLength * sizeof(float));
+
+        for (int j = 0; j < *sizes; ++j, ++indices, ++weights) {
+            float * resultB = result;
+            for (int b = 0; b < numBindings; ++b) {
+                BufferDescriptor const & srcDesc = bindings[b].srcDesc;
+                float const * src = bindings[b].src + srcDesc.offset +
+                                    *indices * srcDesc.stride;
+                for (int k = 0; k < srcDesc.length; ++k) {
+                    resultB[k] += src[k] * *weights;
+                }
+                resultB += srcDesc.length;
+            }
+        }
+
+        float const * resultB = result;
+        for (int b = 0; b < numBindings; ++b) {
+            BufferDescriptor const & dstDesc = bindings[b].dstDesc;
+            memcpy(bindings[b].dst + dstDesc.offset + i * dstDesc.stride,
+                   resultB, dstDesc.length * sizeof(float));
+            resultB += dstDesc.length;
+        }
+    }
+}
+
+template <typename WEIGHT> static void
+evalStencilsDouble(double const * src, BufferDescriptor const &srcDesc,
+                   double * const * dsts, BufferDescriptor const * const * dstDescs,
+                   int const * sizes,
+                   Far::Offset const * offsets,
+                   int const * indices,
+                   WEIGHT const * const * weights,
+                   int numOutputs,
+                   int start, int end) {
+
+    assert(start>=0 && start<end);
+
+    src += srcDesc.offset;
+
+    int length = srcDesc.length;
+
+    double * result = (double*)alloca(numOutputs * length * sizeof(double));
+
+    for (int i = start; i < end; ++i) {
+
+        memset(result, 0, numOutputs * length * sizeof(double));
+
+        int const * iIndices = indices + offsets[i];
+
+        for (int j = 0; j < sizes[i]; ++j) {
+            double const * iSrc = src + iIndices[j] * srcDesc.stride;
+
+            for (int n = 0; n < numOutputs; ++n) {
+                double weight = weights[n][offsets[i] + j];
+
+                double * nResult = result + n * length;
+                for (int k = 0; k < length; ++k) {
+                    nResult[k] += iSrc[k] * weight;
+                }
+            }
+        }
+
+        for (int n = 0; n < numOutputs; ++n) {
+            double * nDst = dsts[n] + dstDescs[n]->offset +
+                            (i - start) * dstDescs[n]->stride;
+            memcpy(nDst, result + n * length, length * sizeof(double));
+        }
+    }
+}
+
+template <typename WEIGHT> static void
+evalStencilsDouble(double const * src, BufferDescriptor const &srcDesc,
+                   double * dst,       BufferDescriptor const &dstDesc,
+                   double * dstDu,     BufferDescriptor const &dstDuDesc,
+                   double * dstDv,     BufferDescriptor const &dstDvDesc,
+                   double * dstDuu,    BufferDescriptor const &dstDuuDesc,
+                   double * dstDuv,    BufferDescriptor const &dstDuvDesc,
+                   double * dstDvv,    BufferDescriptor const &dstDvvDesc,
+                   int const * sizes,
+                   Far::Offset const * offsets,
+                   int const * indices,
+                   WEIGHT const * weights,
+                   WEIGHT const * duWeights,
+                   WEIGHT const * dvWeights,
+                   WEIGHT const * duuWeights,
+                   WEIGHT const * duvWeights,
+                   WEIGHT const * dvvWeights,
+                   int start, int end) {
+
+    double *                 allDsts[6] = { dst, dstDu, dstDv,
+                                            dstDuu, dstDuv, dstDvv };
+    BufferDescriptor const * allDescs[6] = { &dstDesc, &dstDuDesc, &dstDvDesc,
+                                             &dstDuuDesc, &dstDuvDesc, &dstDvvDesc };
+    WEIGHT const *           allWeights[6] = { weights, duWeights, dvWeights,
+                                               duuWeights, duvWeights, dvvWeights };
+
+    //  Skip any outputs without a destination or weights:
+    double *                 dsts[6];
+    BufferDescriptor const * dstDescs[6];
+    WEIGHT const *           dstWeights[6];
+
+    int numOutputs = 0;
+    for (int n = 0; n < 6; ++n) {
+        if (allDsts[n] && allWeights[n]) {
+            dsts[numOutputs] = allDsts[n];
+            dstDescs[numOutputs] = allDescs[n];
+            dstWeights[numOutputs++] = allWeights[n];
+        }
+    }
+    if (numOutputs == 0) return;
+
+    evalStencilsDouble(src, srcDesc, dsts, dstDescs,
+                       sizes, offsets, indices, dstWeights, numOutputs,
+                       start, end);
+}
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                double const * weights,
+                int start, int end) {
+
+    BufferDescriptor none;
+    evalStencilsDouble<double>(src, srcDesc, dst, dstDesc,
+                       0, none, 0, none, 0, none, 0, none, 0, none,
+                       sizes, offsets, indices, weights, 0, 0, 0, 0, 0,
+                       start, end);
+}
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end) {
+
+    BufferDescriptor none;
+    evalStencilsDouble<float>(src, srcDesc, dst, dstDesc,
+                       0, none, 0, none, 0, none, 0, none, 0, none,
+                       sizes, offsets, indices, weights, 0, 0, 0, 0, 0,
+                       start, end);
+}
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                double * dstDu,     BufferDescriptor const &dstDuDesc,
+                double * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                double const * weights,
+                double const * duWeights,
+                double const * dvWeights,
+                int start, int end) {
+
+    BufferDescriptor none;
+    evalStencilsDouble<double>(src, srcDesc, dst, dstDesc,
+                       dstDu, dstDuDesc, dstDv, dstDvDesc, 0, none, 0, none, 0, none,
+                       sizes, offsets, indices, weights, duWeights, dvWeights, 0, 0, 0,
+                       start, end);
+}
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                double * dstDu,     BufferDescriptor const &dstDuDesc,
+                double * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end) {
+
+    BufferDescriptor none;
+    evalStencilsDouble<float>(src, srcDesc, dst, dstDesc,
+                       dstDu, dstDuDesc, dstDv, dstDvDesc, 0, none, 0, none, 0, none,
+                       sizes, offsets, indices, weights, duWeights, dvWeights, 0, 0, 0,
+                       start, end);
+}
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                double * dstDu,     BufferDescriptor const &dstDuDesc,
+                double * dstDv,     BufferDescriptor const &dstDvDesc,
+                double * dstDuu,    BufferDescriptor const &dstDuuDesc,
+                double * dstDuv,    BufferDescriptor const &dstDuvDesc,
+                double * dstDvv,    BufferDescriptor const &dstDvvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                double const * weights,
+                double const * duWeights,
+                double const * dvWeights,
+                double const * duuWeights,
+                double const * duvWeights,
+                double const * dvvWeights,
+                int start, int end) {
+
+    evalStencilsDouble<double>(src, srcDesc, dst, dstDesc,
+                       dstDu, dstDuDesc, dstDv, dstDvDesc,
+                       dstDuu, dstDuuDesc, dstDuv, dstDuvDesc, dstDvv, dstDvvDesc,
+                       sizes, offsets, indices, weights, duWeights, dvWeights,
+                       duuWeights, duvWeights, dvvWeights,
+                       start, end);
+}
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                double * dstDu,     BufferDescriptor const &dstDuDesc,
+                double * dstDv,     BufferDescriptor const &dstDvDesc,
+                double * dstDuu,    BufferDescriptor const &dstDuuDesc,
+                double * dstDuv,    BufferDescriptor const &dstDuvDesc,
+                double * dstDvv,    BufferDescriptor const &dstDvvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                float const * duuWeights,
+                float const * duvWeights,
+                float const * dvvWeights,
+                int start, int end) {
+
+    evalStencilsDouble<float>(src, srcDesc, dst, dstDesc,
+                       dstDu, dstDuDesc, dstDv, dstDvDesc,
+                       dstDuu, dstDuuDesc, dstDuv, dstDuvDesc, dstDvv, dstDvvDesc,
+                       sizes, offsets, indices, weights, duWeights, dvWeights,
+                       duuWeights, duvWeights, dvvWeights,
+                       start, end);
+}
+
+template <int numElems> static void
+computeCompactStencilKernel(float const * vertexSrc,
+                            float * vertexDst,
+                            int const * sizes,
+                            int const * baseIndices,
+                            float const * scales,
+                            unsigned int const * entries,
+                            int numStencils) {
+
+    float result[numElems];
+
+    for (int i = 0; i < numStencils; ++i) {
+
+        for (int k = 0; k < numElems; ++k) {
+            result[k] = 0.0f;
+        }
+
+        int   index = baseIndices[i];
+        float scale = scales[i];
+
+        for (int j = 0; j < sizes[i]; ++j, ++entries) {
+            index += CpuCompactStencilTable::GetEntryIndexDelta(*entries);
+
+            float const * src = vertexSrc + index * numElems;
+            float weight = CpuCompactStencilTable::GetEntryWeight(*entries, scale);
+
+            for (int k = 0; k < numElems; ++k) {
+                result[k] += src[k] * weight;
+            }
+        }
+
+        memcpy(vertexDst + i * numElems, result, numElems * sizeof(float));
+    }
+}
+
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * baseIndices,
+                float const * scales,
+                unsigned int const * entries,
+                int start, int end) {
+
+    assert(start>=0 && start<end);
+
+    if (start>0) {
+        sizes += start;
+        baseIndices += start;
+        scales += start;
+        entries += offsets[start];
+    }
+
+    src += srcDesc.offset;
+    dst += dstDesc.offset;
+
+    int nStencils = end - start;
+
+    if (srcDesc.length == 3 && dstDesc.length == 3 &&
+        srcDesc.stride == 3 && dstDesc.stride == 3) {
+
+        computeCompactStencilKernel<3>(src, dst,
+            sizes, baseIndices, scales, entries, nStencils);
+
+    } else if (srcDesc.length == 4 && dstDesc.length == 4 &&
+               srcDesc.stride == 4 && dstDesc.stride == 4) {
+
+        computeCompactStencilKernel<4>(src, dst,
+            sizes, baseIndices, scales, entries, nStencils);
+
+    } else {
+
+        float * result = (float*)alloca(srcDesc.length * sizeof(float));
+
+        for (int i=0; i<nStencils; ++i) {
+
+            clear(result, srcDesc);
+
+            int   index = baseIndices[i];
+            float scale = scales[i];
+
+            for (int j=0; j<sizes[i]; ++j, ++entries) {
+                index += CpuCompactStencilTable::GetEntryIndexDelta(*entries);
+                addWithWeight(result, src, index,
+                    CpuCompactStencilTable::GetEntryWeight(*entries, scale),
+                    srcDesc);
+            }
+
+            copy(dst, i, result, dstDesc);
+        }
+    }
+}
+
+//
+// Applies the full-precision point weights and the half-precision weights of
+// numDerivs derivatives, decoding each weight once per stencil entry
+//
+template <int numDerivs> static void
+evalHalfDerivativeStencils(float const * src, BufferDescriptor const &srcDesc,
+                           float * const * dsts,
+                           BufferDescriptor const * const * dstDescs,
+                           int const * sizes,
+                           Far::Offset const * offsets,
+                           int const * indices,
+                           float const * weights,
+                           unsigned short const * const * derivWeights,
+                           int start, int end) {
+
+    assert(start>=0 && start<end);
+
+    Far::Offset first = offsets[start];
+
+    sizes += start;
+    indices += first;
+    weights += first;
+
+    unsigned short const * dWeights[numDerivs];
+    for (int k = 0; k < numDerivs; ++k) {
+        dWeights[k] = derivWeights[k] + first;
+    }
+
+    src += srcDesc.offset;
+
+    float * dstPtrs[numDerivs + 1];
+    int nOutLength = 0;
+    for (int k = 0; k <= numDerivs; ++k) {
+        dstPtrs[k] = dsts[k] + dstDescs[k]->offset;
+        nOutLength += dstDescs[k]->length;
+    }
+
+    float * results[numDerivs + 1];
+    results[0] = (float*)alloca(nOutLength * sizeof(float));
+    for (int k = 1; k <= numDerivs; ++k) {
+        results[k] = results[k-1] + dstDescs[k-1]->length;
+    }
+
+    int nStencils = end - start;
+    for (int i = 0; i < nStencils; ++i, ++sizes) {
+
+        // clear
+        memset(results[0], 0, nOutLength * sizeof(float));
+
+        for (int j=0; j<*sizes; ++j) {
+            addWithWeight(results[0], src, *indices, *weights++, srcDesc);
+            for (int k = 0; k < numDerivs; ++k) {
+                float weight =
+                    CpuHalfLimitStencilTable::HalfToFloat(*dWeights[k]++);
+                addWithWeight(results[k+1], src, *indices, weight, srcDesc);
+            }
+            ++indices;
+        }
+        for (int k = 0; k <= numDerivs; ++k) {
+            copy(dstPtrs[k], i, results[k], *dstDescs[k]);
+        }
+    }
+}
+
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                unsigned short const * duWeights,
+                unsigned short const * dvWeights,
+                int start, int end) {
+
+    float * const dsts[3] = { dst, dstDu, dstDv };
+    BufferDescriptor const * const dstDescs[3] = {
+        &dstDesc, &dstDuDesc, &dstDvDesc };
+    unsigned short const * const derivWeights[2] = { duWeights, dvWeights };
+
+    evalHalfDerivativeStencils<2>(src, srcDesc, dsts, dstDescs,
+        sizes, offsets, indices, weights, derivWeights, start, end);
+}
+
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
+                float * dstDuu,    BufferDescriptor const &dstDuuDesc,
+                float * dstDuv,    BufferDescriptor const &dstDuvDesc,
+                float * dstDvv,    BufferDescriptor const &dstDvvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                unsigned short const * duWeights,
+                unsigned short const * dvWeights,
+                unsigned short const * duuWeights,
+                unsigned short const * duvWeights,
+                unsigned short const * dvvWeights,
+                int start, int end) {
+
+    float * const dsts[6] = { dst, dstDu, dstDv, dstDuu, dstDuv, dstDvv };
+    BufferDescriptor const * const dstDescs[6] = { &dstDesc,
+        &dstDuDesc, &dstDvDesc, &dstDuuDesc, &dstDuvDesc, &dstDvvDesc };
+    unsigned short const * const derivWeights[5] = {
+        duWeights, dvWeights, duuWeights, duvWeights, dvvWeights };
+
+    evalHalfDerivativeStencils<5>(src, srcDesc, dsts, dstDescs,
+        sizes, offsets, indices, weights, derivWeights, start, end);
+}
+
+template <int numElems> static void
+computeVaryingStencilKernel(float const * vertexSrc,
+                            float * vertexDst,
+                            Far::Index const * offsets,
+                            Far::Index const * indices,
+                            int numStencils) {
+
+    float result[numElems];
+
+    for (int i = 0; i < numStencils; ++i) {
+
+        for (int k = 0; k < numElems; ++k) {
+            result[k] = 0.0f;
+        }
+
+        int size = offsets[i+1] - offsets[i];
+        float weight = 1.0f / (float)size;
+
+        for (int j = 0; j < size; ++j, ++indices) {
+            float const * src = vertexSrc + *indices * numElems;
+            for (int k = 0; k < numElems; ++k) {
+                result[k] += src[k] * weight;
+            }
+        }
+
+        memcpy(vertexDst + i * numElems, result, numElems * sizeof(float));
+    }
+}
+
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                Far::Index const * offsets,
+                Far::Index const * indices,
+                int start, int end) {
+
+    assert(start>=0 && start<end);
+
+    offsets += start;
+    indices += offsets[0];
+
+    src += srcDesc.offset;
+    dst += dstDesc.offset;
+
+    int nStencils = end - start;
+
+    if (srcDesc.length == 3 && dstDesc.length == 3 &&
+        srcDesc.stride == 3 && dstDesc.stride == 3) {
+
+        computeVaryingStencilKernel<3>(src, dst, offsets, indices, nStencils);
+
+    } else if (srcDesc.length == 4 && dstDesc.length == 4 &&
+               srcDesc.stride == 4 && dstDesc.stride == 4) {
+
+        computeVaryingStencilKernel<4>(src, dst, offsets, indices, nStencils);
+
+    } else {
+
+        float * result = (float*)alloca(srcDesc.length * sizeof(float));
+
+        for (int i=0; i<nStencils; ++i) {
+
+            clear(result, srcDesc);
+
+            int size = offsets[i+1] - offsets[i];
+            float weight = 1.0f / (float)size;
+
+            for (int j=0; j<size; ++j, ++indices) {
+                addWithWeight(result, src, *indices, weight, srcDesc);
+            }
+
+            copy(dst, i, result, dstDesc);
+        }
+    }
+}
+
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int const * stencilIndices,
+                int numStencilIndices) {
+
+    src += srcDesc.offset;
+    dst += dstDesc.offset;
+
+    float * result = (float*)alloca(srcDesc.length * sizeof(float));
+
+    for (int k=0; k<numStencilIndices; ++k) {
+
+        int stencil = stencilIndices[k];
+
+        int const   * cvIndices = indices + offsets[stencil];
+        float const * stencilWeights   = weights + offsets[stencil];
+
+        clear(result, srcDesc);
+
+        for (int j=0; j<sizes[stencil]; ++j) {
+            addWithWeight(result, src, cvIndices[j], stencilWeights[j],
+                          srcDesc);
+        }
+
+        copy(dst, stencil, result, dstDesc);
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+//
+//  Scalar patch basis evaluation of a single coord -- float data uses the
+//  basis shared with the GPU kernels and double data the basis of Far:
+//
+static inline int
+evalPatchBasis(int patchType, PatchParam const &param, float s, float t,
+               float * const w[6]) {
+
+    OsdPatchParam osdParam = OsdPatchParamInit(
+        param.field0, param.field1, param.sharpness);
+
+    return OsdEvaluatePatchBasis(patchType, osdParam, s, t,
+                                 w[0], w[1], w[2], w[3], w[4], w[5]);
+}
+
+static inline int
+evalPatchBasis(int patchType, PatchParam const &param, double s, double t,
+               double * const w[6]) {
+
+    //  The basis of Far does not support double-crease patches, whose
+    //  weights are evaluated with the shared basis and widened:
+    if (param.sharpness < 0.0f) {
+        float weights[6][20];
+        float * const wF[6] = { weights[0],
+                                w[1] ? weights[1] : 0, w[2] ? weights[2] : 0,
+                                w[3] ? weights[3] : 0, w[4] ? weights[4] : 0,
+                                w[5] ? weights[5] : 0 };
+
+        int nPoints = evalPatchBasis(patchType, param, (float)s, (float)t, wF);
+        for (int d = 0; d < 6; ++d) {
+            if (!w[d]) continue;
+            for (int j = 0; j < nPoints; ++j) {
+                w[d][j] = wF[d][j];
+            }
+        }
+        return nPoints;
+    }
+    return Far::internal::EvaluatePatchBasis<double>(patchType, param, s, t,
+                                 w[0], w[1], w[2], w[3], w[4], w[5]);
+}
+
+static inline bool
+isPatchBasisBatched(int patchType, PatchParam const &param) {
+
+    //  Double-crease patches are not supported by the batched basis of Far:
+    if (param.sharpness < 0.0f) return false;
+
+    return (patchType == Far::PatchDescriptor::REGULAR) ||
+           (patchType == Far::PatchDescriptor::LOOP) ||
+           (patchType == Far::PatchDescriptor::GREGORY_TRIANGLE);
+}
+
+//
+//  Adds a point weighted by the basis of the n coords of a run, optionally
+//  scaled by the weight of a stencil entry.  The primvar length is given by
+//  LENGTH when specialized for it (and by 'length' when LENGTH is 0):
+//
+template <int LENGTH, typename REAL>
+static inline void
+addPatchPoint(REAL * dst, int stride, int length,
+              int const * indices, int n,
+              REAL const * src, REAL const * w, REAL scale) {
+
+    if (LENGTH) length = LENGTH;
+
+    for (int k = 0; k < n; ++k) {
+        REAL * dstK = dst + indices[k] * stride;
+        REAL   wK   = w[k] * scale;
+        for (int e = 0; e < length; ++e) {
+            dstK[e] += src[e] * wK;
+        }
+    }
+}
+
+//
+//  The points of a single coord are a stencil of the control points of its
+//  patch, weighted by the basis, and so are evaluated by the vectorized
+//  stencil kernels for the host CPU (AVX2 or NEON) if any applies:
+//
+static inline bool
+evalPatchPointsSimd(float const * src, BufferDescriptor const &srcDesc,
+                    float * dst, BufferDescriptor const &dstDesc,
+                    int nPoints, int const * cvs, float const * w) {
+
+    return !reproducibleEvaluation &&
+           CpuEvalStencilsSimd(src, srcDesc, dst, dstDesc,
+                               &nPoints, cvs, w, 1);
+}
+
+static inline bool
+evalPatchPointsSimd(double const *, BufferDescriptor const &,
+                    double *, BufferDescriptor const &,
+                    int, int const *, double const *) {
+
+    return false;
+}
+
+//
+//  Patch basis of a single coord specialized at compile time for the patch
+//  type and the derivative order (0, 1 or 2), which OsdEvaluatePatchBasis()
+//  (shared with the GPU kernels) otherwise tests for every coord:
+//
+template <int PATCH_TYPE, int DERIVS>
+static inline int
+evalPatchBasisTyped(PatchParam const &param, float s, float t,
+                    float * const w[6]) {
+
+    typedef Far::PatchDescriptor Descriptor;
+
+    bool const isTriangle = (PATCH_TYPE == Descriptor::LOOP) ||
+                            (PATCH_TYPE == Descriptor::GREGORY_TRIANGLE) ||
+                            (PATCH_TYPE == Descriptor::TRIANGLES);
+
+    float * wP   = w[0];
+    float * wDs  = (DERIVS > 0) ? w[1] : 0;
+    float * wDt  = (DERIVS > 0) ? w[2] : 0;
+    float * wDss = (DERIVS > 1) ? w[3] : 0;
+    float * wDst = (DERIVS > 1) ? w[4] : 0;
+    float * wDtt = (DERIVS > 1) ? w[5] : 0;
+
+    OsdPatchParam osdParam = OsdPatchParamInit(
+        param.field0, param.field1, param.sharpness);
+
+    float uv[2] = { s, t };
+    float derivSign = 1.0f;
+    if (isTriangle) {
+        OsdPatchParamNormalizeTriangle(osdParam, uv);
+        if (OsdPatchParamIsTriangleRotated(osdParam)) derivSign = -1.0f;
+    } else {
+        OsdPatchParamNormalize(osdParam, uv);
+    }
+
+    int boundaryMask = OsdPatchParamGetBoundary(osdParam);
+
+    int nPoints = 0;
+    switch (PATCH_TYPE) {
+    case Descriptor::REGULAR:
+        if (OsdPatchParamIsDoubleCrease(osdParam)) {
+            float sharpness[2];
+            OsdPatchParamGetDoubleCreaseSharpness(osdParam, sharpness);
+            nPoints = Osd_EvalBasisBSplineDoubleCrease(uv[0], uv[1],
+                boundaryMask, sharpness[0], sharpness[1],
+                wP, wDs, wDt, wDss, wDst, wDtt);
+        } else {
+            nPoints = Osd_EvalBasisBSpline(uv[0], uv[1],
+                wP, wDs, wDt, wDss, wDst, wDtt);
+            if (boundaryMask) {
+                Osd_boundBasisBSpline(boundaryMask,
+                    wP, wDs, wDt, wDss, wDst, wDtt);
+            }
+        }
+        break;
+    case Descriptor::LOOP:
+        nPoints = Osd_EvalBasisBoxSplineTri(uv[0], uv[1],
+            wP, wDs, wDt, wDss, wDst, wDtt);
+        if (boundaryMask) {
+            Osd_boundBasisBoxSplineTri(boundaryMask,
+                wP, wDs, wDt, wDss, wDst, wDtt);
+        }
+        break;
+    case Descriptor::GREGORY_BASIS:
+        nPoints = Osd_EvalBasisGregory(uv[0], uv[1],
+            wP, wDs, wDt, wDss, wDst, wDtt);
+        break;
+    case Descriptor::GREGORY_TRIANGLE:
+        nPoints = Osd_EvalBasisGregoryTri(uv[0], uv[1],
+            wP, wDs, wDt, wDss, wDst, wDtt);
+        break;
+    case Descriptor::QUADS:
+        nPoints = Osd_EvalBasisLinear(uv[0], uv[1],
+            wP, wDs, wDt, wDss, wDst, wDtt);
+        break;
+    case Descriptor::TRIANGLES:
+        nPoints = Osd_EvalBasisLinearTri(uv[0], uv[1],
+            wP, wDs, wDt, wDss, wDst, wDtt);
+        break;
+    default:
+        break;
+    }
+
+    if (DERIVS > 0) {
+        float d1Scale = derivSign * (float)(1 << OsdPatchParamGetDepth(osdParam));
+        for (int i = 0; i < nPoints; ++i) {
+            wDs[i] *= d1Scale;
+            wDt[i] *= d1Scale;
+        }
+        if (DERIVS > 1) {
+            float d2Scale = derivSign * d1Scale * d1Scale;
+            for (int i = 0; i < nPoints; ++i) {
+                wDss[i] *= d2Scale;
+                wDst[i] *= d2Scale;
+                wDtt[i] *= d2Scale;
+            }
+        }
+    }
+    return nPoints;
+}
+
+//
+//  Evaluates the basis of n coords on patches of the same type, storing the
+//  weights of coord k at w[d] + k * 20.  Returns the number of points of the
+//  patches, or 0 if the type has no specialization:
+//
+template <int PATCH_TYPE, int DERIVS>
+static int
+evalPatchBasisRunTyped(PatchCoord const * patchCoords, int const * indices,
+                       int n, PatchParam const * patchParamBuffer,
+                       float * const w[6]) {
+
+    int nPoints = 0;
+    for (int k = 0; k < n; ++k) {
+        PatchCoord const & coord = patchCoords[indices[k]];
+
+        float * const wK[6] = { w[0] + k * 20,
+                                w[1] ? w[1] + k * 20 : 0,
+                                w[2] ? w[2] + k * 20 : 0,
+                                w[3] ? w[3] + k * 20 : 0,
+                                w[4] ? w[4] + k * 20 : 0,
+                                w[5] ? w[5] + k * 20 : 0 };
+
+        nPoints = evalPatchBasisTyped<PATCH_TYPE, DERIVS>(
+            patchParamBuffer[coord.handle.patchIndex],
+            coord.s, coord.t, wK);
+    }
+    return nPoints;
+}
+
+template <int DERIVS>
+static int
+evalPatchBasisRunDispatch(int patchType,
+                          PatchCoord const * patchCoords, int const * indices,
+                          int n, PatchParam const * patchParamBuffer,
+                          float * const w[6]) {
+
+    typedef Far::PatchDescriptor Descriptor;
+
+#define OSD_TYPED_PATCH_BASIS_CASE(TYPE) \
+    case Descriptor::TYPE: \
+        return evalPatchBasisRunTyped<Descriptor::TYPE, DERIVS>( \
+            patchCoords, indices, n, patchParamBuffer, w);
+
+    switch (patchType) {
+        OSD_TYPED_PATCH_BASIS_CASE(REGULAR)
+        OSD_TYPED_PATCH_BASIS_CASE(LOOP)
+        OSD_TYPED_PATCH_BASIS_CASE(GREGORY_BASIS)
+        OSD_TYPED_PATCH_BASIS_CASE(GREGORY_TRIANGLE)
+        OSD_TYPED_PATCH_BASIS_CASE(QUADS)
+        OSD_TYPED_PATCH_BASIS_CASE(TRIANGLES)
+        default:
+            break;
+    }
+#undef OSD_TYPED_PATCH_BASIS_CASE
+    return 0;
+}
+
+static inline int
+evalPatchBasisRun(int patchType, int derivs,
+                  PatchCoord const * patchCoords, int const * indices, int n,
+                  PatchParam const * patchParamBuffer, float * const w[6]) {
+
+    switch (derivs) {
+        case 0: return evalPatchBasisRunDispatch<0>(patchType,
+                    patchCoords, indices, n, patchParamBuffer, w);
+        case 1: return evalPatchBasisRunDispatch<1>(patchType,
+                    patchCoords, indices, n, patchParamBuffer, w);
+        default: return evalPatchBasisRunDispatch<2>(patchType,
+                    patchCoords, indices, n, patchParamBuffer, w);
+    }
+}
+
+//  The basis of double data is that of Far, which is not specialized:
+static inline int
+evalPatchBasisRun(int, int, PatchCoord const *, int const *, int,
+                  PatchParam const *, double * const [6]) {
+    return 0;
+}
+
+//
+//  Accumulates the points of the n coords of a run on the same patch, whose
+//  weight j of coord k is stored in w[d][j * n + k]:
+//
+template <int LENGTH, typename REAL>
+static inline void
+addPatchPoints(REAL const * src, BufferDescriptor const &srcDesc,
+               REAL * const dst[6], BufferDescriptor const * const dstDesc[6],
+               int const * indices, int n,
+               int nPoints, int const * cvs, REAL const * const w[6],
+               CpuPatchPointStencils const * stencils) {
+
+    for (int d = 0; d < 6; ++d) {
+        if (!dst[d]) continue;
+
+        int const   length = LENGTH ? LENGTH : dstDesc[d]->length;
+        int const   stride = dstDesc[d]->stride;
+        REAL const * wD    = w[d];
+
+        if (n == 1 && !stencils &&
+            evalPatchPointsSimd(src, srcDesc, dst[d] + indices[0] * stride,
+                                *dstDesc[d], nPoints, cvs, wD)) {
+            continue;
+        }
+
+        for (int k = 0; k < n; ++k) {
+            std::fill(dst[d] + indices[k] * stride,
+                      dst[d] + indices[k] * stride + length, (REAL)0);
+        }
+        for (int j = 0; j < nPoints; ++j) {
+            REAL const * wJ = wD + j * n;
+
+            int cv = cvs[j];
+            if (!stencils || cv < stencils->numControlVertices) {
+                addPatchPoint<LENGTH>(dst[d], stride, length, indices, n,
+                                      src + cv * srcDesc.stride, wJ,
+                                      (REAL)1);
+                continue;
+            }
+
+            //  Points past the control vertices are computed from their
+            //  stencil rather than read from a refined buffer:
+            int         stencil = cv - stencils->numControlVertices;
+            Far::Offset offset  = stencils->offsets[stencil];
+            for (int e = 0; e < stencils->sizes[stencil]; ++e) {
+                addPatchPoint<LENGTH>(dst[d], stride, length, indices, n,
+                    src + stencils->indices[offset + e] * srcDesc.stride,
+                    wJ, (REAL)stencils->weights[offset + e]);
+            }
+        }
+    }
+}
+
+template <int LENGTH, typename REAL>
+static void
+evalPatches(REAL const * src, BufferDescriptor const &srcDesc,
+            REAL * const dst[6], BufferDescriptor const * const dstDesc[6],
+            PatchCoord const * patchCoords,
+            int const * patchCoordOrder,
+            PatchArray const * patchArrays,
+            int const * patchIndexBuffer,
+            PatchParam const * patchParamBuffer,
+            CpuPatchPointStencils const * stencils,
+            int start, int end) {
+
+    int const batchSize = Far::internal::PATCH_BASIS_BATCH_SIZE;
+
+    bool evalD2 = dst[3] || dst[4] || dst[5];
+    bool evalD1 = evalD2 || dst[1] || dst[2];
+    int  derivs = evalD2 ? 2 : (evalD1 ? 1 : 0);
+
+    //  Weight j of coord k of a run is stored in w[j * n + k]:
+    REAL weights[6][20 * batchSize];
+    REAL * const w[6] = { weights[0],
+                          evalD1 ? weights[1] : 0, evalD1 ? weights[2] : 0,
+                          evalD2 ? weights[3] : 0, evalD2 ? weights[4] : 0,
+                          evalD2 ? weights[5] : 0 };
+
+    int  indices[batchSize];
+    REAL s[batchSize], t[batchSize];
+
+    for (int i = start; i < end; ) {
+        int index = patchCoordOrder ? patchCoordOrder[i] : i;
+
+        PatchCoord const &coord = patchCoords[index];
+        PatchArray const &array = patchArrays[coord.handle.arrayIndex];
+        PatchParam const &param = patchParamBuffer[coord.handle.patchIndex];
+
+        int patchType = param.IsRegular()
+            ? array.GetPatchTypeRegular()
+            : array.GetPatchTypeIrregular();
+
+        //  Gather the run of following coords on the same patch:
+        int n = 1;
+        indices[0] = index;
+        if (!reproducibleEvaluation && isPatchBasisBatched(patchType, param)) {
+            for ( ; (n < batchSize) && (i + n < end); ++n) {
+                int next = patchCoordOrder ? patchCoordOrder[i + n] : i + n;
+                if (patchCoords[next].handle.patchIndex !=
+                    coord.handle.patchIndex) break;
+                indices[n] = next;
+            }
+        }
+
+        if (n == 1) {
+            //  Gather the run of following coords on patches of the same
+            //  type -- the patches of an array, when coords are grouped by
+            //  patch -- for the basis specialized for the type:
+            int m = 1;
+            for ( ; (m < batchSize) && (i + m < end); ++m) {
+                int next = patchCoordOrder ? patchCoordOrder[i + m] : i + m;
+                PatchCoord const &nextCoord = patchCoords[next];
+                if (nextCoord.handle.arrayIndex != coord.handle.arrayIndex ||
+                    patchParamBuffer[nextCoord.handle.patchIndex].IsRegular()
+                        != param.IsRegular()) break;
+                indices[m] = next;
+            }
+
+            int nPoints = evalPatchBasisRun(patchType, derivs, patchCoords,
+                                            indices, m, patchParamBuffer, w);
+            if (nPoints) {
+                for (int k = 0; k < m; ++k) {
+                    PatchCoord const &coordK = patchCoords[indices[k]];
+                    PatchArray const &arrayK =
+                        patchArrays[coordK.handle.arrayIndex];
+                    int indexBase = arrayK.GetIndexBase() + arrayK.GetStride() *
+                        (coordK.handle.patchIndex - arrayK.GetPrimitiveIdBase());
+
+                    REAL const * const wK[6] = { w[0] + k * 20,
+                        w[1] ? w[1] + k * 20 : 0, w[2] ? w[2] + k * 20 : 0,
+                        w[3] ? w[3] + k * 20 : 0, w[4] ? w[4] + k * 20 : 0,
+                        w[5] ? w[5] + k * 20 : 0 };
+
+                    addPatchPoints<LENGTH>(src, srcDesc, dst, dstDesc,
+                        &indices[k], 1, nPoints,
+                        &patchIndexBuffer[indexBase], wK, stencils);
+                }
+                i += m;
+                continue;
+            }
+        }
+        i += n;
+
+        int nPoints = 0;
+        if (n == 1) {
+            nPoints = evalPatchBasis(patchType, param,
+                                     (REAL)coord.s, (REAL)coord.t, w);
+        } else {
+            for (int k = 0; k < n; ++k) {
+                s[k] = patchCoords[indices[k]].s;
+                t[k] = patchCoords[indices[k]].t;
+            }
+            nPoints = Far::internal::EvaluatePatchBasisBatch<REAL>(
+                patchType, param, n, s, t, w[0], w[1], w[2], w[3], w[4], w[5]);
+        }
+
+        int indexBase = array.GetIndexBase() + array.GetStride() *
+                (coord.handle.patchIndex - array.GetPrimitiveIdBase());
+
+        addPatchPoints<LENGTH>(src, srcDesc, dst, dstDesc, indices, n,
+                               nPoints, &patchIndexBuffer[indexBase], w,
+                               stencils);
+    }
+}
+
+//
+//  Dispatches to the patch kernel specialized for the primvar length when all
+//  destinations have the length of the source (up to 16 elements):
+//
+template <typename REAL>
+static void
+evalPatchesDispatch(REAL const * src, BufferDescriptor const &srcDesc,
+                    REAL * const dst[6],
+                    BufferDescriptor const * const dstDesc[6],
+                    PatchCoord const * patchCoords,
+                    int const * patchCoordOrder,
+                    PatchArray const * patchArrays,
+                    int const * patchIndexBuffer,
+                    PatchParam const * patchParamBuffer,
+                    CpuPatchPointStencils const * stencils,
+                    int start, int end) {
+
+    int length = srcDesc.length;
+    for (int d = 0; d < 6; ++d) {
+        if (dst[d] && dstDesc[d]->length != length) length = 0;
+    }
+
+#define OSD_FIXED_LENGTH_PATCH_CASE(LENGTH) \
+    case LENGTH: \
+        evalPatches<LENGTH>(src, srcDesc, dst, dstDesc, patchCoords, \
+            patchCoordOrder, patchArrays, patchIndexBuffer, patchParamBuffer, \
+            stencils, start, end); \
+        return;
+
+    switch (length) {
+        OSD_FIXED_LENGTH_PATCH_CASE(1)
+        OSD_FIXED_LENGTH_PATCH_CASE(2)
+        OSD_FIXED_LENGTH_PATCH_CASE(3)
+        OSD_FIXED_LENGTH_PATCH_CASE(4)
+        OSD_FIXED_LENGTH_PATCH_CASE(5)
+        OSD_FIXED_LENGTH_PATCH_CASE(6)
+        OSD_FIXED_LENGTH_PATCH_CASE(7)
+        OSD_FIXED_LENGTH_PATCH_CASE(8)
+        OSD_FIXED_LENGTH_PATCH_CASE(9)
+        OSD_FIXED_LENGTH_PATCH_CASE(10)
+        OSD_FIXED_LENGTH_PATCH_CASE(11)
+        OSD_FIXED_LENGTH_PATCH_CASE(12)
+        OSD_FIXED_LENGTH_PATCH_CASE(13)
+        OSD_FIXED_LENGTH_PATCH_CASE(14)
+        OSD_FIXED_LENGTH_PATCH_CASE(15)
+        OSD_FIXED_LENGTH_PATCH_CASE(16)
+        default:
+            break;
+    }
+#undef OSD_FIXED_LENGTH_PATCH_CASE
+
+    evalPatches<0>(src, srcDesc, dst, dstDesc, patchCoords, patchCoordOrder,
+                   patchArrays, patchIndexBuffer, patchParamBuffer,
+                   stencils, start, end);
+}
+
+void
+CpuEvalPatches(float const * src, BufferDescriptor const &srcDesc,
+               float * dst,       BufferDescriptor const &dstDesc,
+               float * dstDu,     BufferDescriptor const &dstDuDesc,
+               float * dstDv,     BufferDescriptor const &dstDvDesc,
+               float * dstDuu,    BufferDescriptor const &dstDuuDesc,
+               float * dstDuv,    BufferDescriptor const &dstDuvDesc,
+               float * dstDvv,    BufferDescriptor const &dstDvvDesc,
+               PatchCoord const * patchCoords,
+               int const * patchCoordOrder,
+               PatchArray const * patchArrays,
+               int const * patchIndexBuffer,
+               PatchParam const * patchParamBuffer,
+               int start, int end) {
+
+    float * const dsts[6] = { dst, dstDu, dstDv, dstDuu, dstDuv, dstDvv };
+    BufferDescriptor const * const descs[6] = { &dstDesc,
+        &dstDuDesc, &dstDvDesc, &dstDuuDesc, &dstDuvDesc, &dstDvvDesc };
+
+    evalPatchesDispatch(src, srcDesc, dsts, descs, patchCoords,
+                        patchCoordOrder, patchArrays, patchIndexBuffer,
+                        patchParamBuffer, (CpuPatchPointStencils const *)0,
+                        start, end);
+}
+
+void
+CpuEvalPatches(double const * src, BufferDescriptor const &srcDesc,
+               double * dst,       BufferDescriptor const &dstDesc,
+               double * dstDu,     BufferDescriptor const &dstDuDesc,
+               double * dstDv,     BufferDescriptor const &dstDvDesc,
+               double * dstDuu,    BufferDescriptor const &dstDuuDesc,
+               double * dstDuv,    BufferDescriptor const &dstDuvDesc,
+               double * dstDvv,    BufferDescriptor const &dstDvvDesc,
+               PatchCoord const * patchCoords,
+               int const * patchCoordOrder,
+               PatchArray const * patchArrays,
+               int const * patchIndexBuffer,
+               PatchParam const * patchParamBuffer,
+               int start, int end) {
+
+    double * const dsts[6] = { dst, dstDu, dstDv, dstDuu, dstDuv, dstDvv };
+    BufferDescriptor const * const descs[6] = { &dstDesc,
+        &dstDuDesc, &dstDvDesc, &dstDuuDesc, &dstDuvDesc, &dstDvvDesc };
+
+    evalPatchesDispatch(src, srcDesc, dsts, descs, patchCoords,
+                        patchCoordOrder, patchArrays, patchIndexBuffer,
+                        patchParamBuffer, (CpuPatchPointStencils const *)0,
+                        start, end);
+}
+
+void
+CpuEvalPatchesWithStencils(float const * src, BufferDescriptor const &srcDesc,
+                           float * dst,       BufferDescriptor const &dstDesc,
+                           float * dstDu,     BufferDescriptor const &dstDuDesc,
+                           float * dstDv,     BufferDescriptor const &dstDvDesc,
+                           PatchCoord const * patchCoords,
+                           PatchArray const * patchArrays,
+                           int const * patchIndexBuffer,
+                           PatchParam const * patchParamBuffer,
+                           CpuPatchPointStencils const &stencils,
+                           int start, int end) {
+
+    float * const dsts[6] = { dst, dstDu, dstDv, 0, 0, 0 };
+    BufferDescriptor none;
+    BufferDescriptor const * const descs[6] = { &dstDesc,
+        &dstDuDesc, &dstDvDesc, &none, &none, &none };
+
+    evalPatchesDispatch(src, srcDesc, dsts, descs, patchCoords, 0,
+                        patchArrays, patchIndexBuffer, patchParamBuffer,
+                        &stencils, start, end);
+}
+
+// ---------------------------------------------------------------------------
+
+//
+//  Writes the normalized cross product of the first three elements of the
+//  derivatives (or zero if degenerate):
+//
+static inline void
+writeNormal(float * normal, float const * du, float const * dv) {
+
+    float n[3] = { du[1] * dv[2] - du[2] * dv[1],
+                   du[2] * dv[0] - du[0] * dv[2],
+                   du[0] * dv[1] - du[1] * dv[0] };
+
+    float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    float scale = (len > 0.0f) ? (1.0f / len) : 0.0f;
+
+    normal[0] = n[0] * scale;
+    normal[1] = n[1] * scale;
+    normal[2] = n[2] * scale;
+}
+
+void
+CpuEvalStencilsNormals(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       float * dstNormal, BufferDescriptor const &dstNormalDesc,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       float const * duWeights,
+                       float const * dvWeights,
+                       int start, int end) {
+
+    assert(srcDesc.length >= 3 && dstNormalDesc.length == 3);
+
+    if (start > 0) {
+        sizes += start;
+        indices += offsets[start];
+        weights += offsets[start];
+        duWeights += offsets[start];
+        dvWeights += offsets[start];
+    }
+
+    src += srcDesc.offset;
+    if (dst) dst += dstDesc.offset;
+    dstNormal += dstNormalDesc.offset;
+
+    //  Only the first three elements of the derivatives are accumulated:
+    float * result = dst ? (float*)alloca(srcDesc.length * sizeof(float)) : 0;
+
+    int nStencils = end - start;
+    for (int i = 0; i < nStencils; ++i, ++sizes) {
+
+        float du[3] = { 0.0f, 0.0f, 0.0f };
+        float dv[3] = { 0.0f, 0.0f, 0.0f };
+        if (result) clear(result, srcDesc);
+
+        for (int j = 0; j < *sizes; ++j, ++indices) {
+            float const * srcVert = elementAtIndex(src, *indices, srcDesc);
+
+            float wDu = *duWeights++;
+            float wDv = *dvWeights++;
+            for (int k = 0; k < 3; ++k) {
+                du[k] += srcVert[k] * wDu;
+                dv[k] += srcVert[k] * wDv;
+            }
+            if (result) {
+                addWithWeight(result, src, *indices, *weights, srcDesc);
+            }
+            ++weights;
+        }
+        if (result) copy(dst, i, result, dstDesc);
+
+        writeNormal(elementAtIndex(dstNormal, i, dstNormalDesc), du, dv);
+    }
+}
+
+void
+CpuEvalPatchesNormals(float const * src, BufferDescriptor const &srcDesc,
+                      float * dst,       BufferDescriptor const &dstDesc,
+                      float * dstNormal, BufferDescriptor const &dstNormalDesc,
+                      PatchCoord const * patchCoords,
+                      PatchArray const * patchArrays,
+                      int const * patchIndexBuffer,
+                      PatchParam const * patchParamBuffer,
+                      int start, int end) {
+
+    assert(srcDesc.length >= 3 && dstNormalDesc.length == 3);
+
+    //  The derivatives of a chunk of coords are evaluated into a scratch
+    //  buffer and reduced to normals -- of the full primvar when the points
+    //  are also written (so the kernel specialized for the primvar length
+    //  is used) and of its first three elements otherwise:
+    int const chunkSize = 64;
+
+    BufferDescriptor derivDesc(0, dst ? srcDesc.length : 3,
+                                  dst ? srcDesc.length : 3);
+    BufferDescriptor evalSrcDesc(0, derivDesc.length, srcDesc.stride);
+
+    float * du = (float*)alloca(2 * chunkSize * derivDesc.stride * sizeof(float));
+    float * dv = du + chunkSize * derivDesc.stride;
+
+    BufferDescriptor none;
+    BufferDescriptor const * const descs[6] = { &dstDesc,
+        &derivDesc, &derivDesc, &none, &none, &none };
+
+    for (int c = start; c < end; c += chunkSize) {
+        int n = std::min(chunkSize, end - c);
+
+        float * const dsts[6] = { dst ? dst + c * dstDesc.stride : 0,
+                                  du, dv, 0, 0, 0 };
+
+        evalPatchesDispatch(src, evalSrcDesc, dsts, descs, patchCoords + c, 0,
+                            patchArrays, patchIndexBuffer, patchParamBuffer,
+                            (CpuPatchPointStencils const *)0, 0, n);
+
+        for (int i = 0; i < n; ++i) {
+            writeNormal(elementAtIndex(dstNormal, c + i, dstNormalDesc),
+                        elementAtIndex(du, i, derivDesc),
+                        elementAtIndex(dv, i, derivDesc));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+//
+//  Writes the position of control vertex v skinned by its bones:
+//
+static inline void
+skinPosition(float * p, float const * pos, int v,
+             SkinningDescriptor const & skinning) {
+
+    int const   n       = skinning.numInfluences;
+    int const   * bones = skinning.boneIndices + v * n;
+    float const * wts   = skinning.boneWeights + v * n;
+
+    if (skinning.method == SkinningDescriptor::LINEAR_BLEND) {
+        p[0] = p[1] = p[2] = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            if (wts[i] == 0.0f) continue;
+
+            float const * m = skinning.bones + bones[i] * 12;
+            for (int k = 0; k < 3; ++k, m += 4) {
+                p[k] += wts[i] * (m[0] * pos[0] + m[1] * pos[1] +
+                                  m[2] * pos[2] + m[3]);
+            }
+        }
+        return;
+    }
+
+    //  Dual quaternions are blended in the hemisphere of the first bone:
+    float r[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float d[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float const * q0 = skinning.bones + bones[0] * 8;
+    for (int i = 0; i < n; ++i) {
+        float const * q = skinning.bones + bones[i] * 8;
+        float w = wts[i];
+        if (q0[0] * q[0] + q0[1] * q[1] + q0[2] * q[2] + q0[3] * q[3] < 0.0f) {
+            w = -w;
+        }
+        for (int k = 0; k < 4; ++k) {
+            r[k] += w * q[k];
+            d[k] += w * q[4 + k];
+        }
+    }
+    float len = std::sqrt(r[0] * r[0] + r[1] * r[1] +
+                          r[2] * r[2] + r[3] * r[3]);
+    float scale = (len > 0.0f) ? (1.0f / len) : 0.0f;
+    for (int k = 0; k < 4; ++k) {
+        r[k] *= scale;
+        d[k] *= scale;
+    }
+
+    //  p = pos + 2 r.xyz x (r.xyz x pos + r.w pos) + translation, where the
+    //  translation is 2 (r.w d.xyz - d.w r.xyz + r.xyz x d.xyz):
+    float c[3] = { r[1] * pos[2] - r[2] * pos[1] + r[3] * pos[0],
+                   r[2] * pos[0] - r[0] * pos[2] + r[3] * pos[1],
+                   r[0] * pos[1] - r[1] * pos[0] + r[3] * pos[2] };
+    float t[3] = { r[3] * d[0] - d[3] * r[0] + r[1] * d[2] - r[2] * d[1],
+                   r[3] * d[1] - d[3] * r[1] + r[2] * d[0] - r[0] * d[2],
+                   r[3] * d[2] - d[3] * r[2] + r[0] * d[1] - r[1] * d[0] };
+
+    p[0] = pos[0] + 2.0f * (r[1] * c[2] - r[2] * c[1] + t[0]);
+    p[1] = pos[1] + 2.0f * (r[2] * c[0] - r[0] * c[2] + t[1]);
+    p[2] = pos[2] + 2.0f * (r[0] * c[1] - r[1] * c[0] + t[2]);
+}
+
+void
+CpuEvalStencilsSkinned(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       SkinningDescriptor const & skinning,
+                       int start, int end) {
+
+    assert(srcDesc.length >= 3);
+
+    if (start > 0) {
+        sizes += start;
+        indices += offsets[start];
+        weights += offsets[start];
+    }
+
+    src += srcDesc.offset;
+    dst += dstDesc.offset;
+
+    float * result = (float*)alloca(srcDesc.length * sizeof(float));
+
+    int nStencils = end - start;
+    for (int i = 0; i < nStencils; ++i, ++sizes) {
+
+        clear(result, srcDesc);
+
+        for (int j = 0; j < *sizes; ++j, ++indices, ++weights) {
+            float const * srcVert = elementAtIndex(src, *indices, srcDesc);
+
+            //  The skinned position replaces the first three elements of
+            //  the control vertices as they are gathered:
+            int k = 0;
+            if (*indices < skinning.numControlVertices) {
+                float p[3];
+                skinPosition(p, srcVert, *indices, skinning);
+                for ( ; k < 3; ++k) {
+                    result[k] += p[k] * *weights;
+                }
+            }
+            for ( ; k < srcDesc.length; ++k) {
+                result[k] += srcVert[k] * *weights;
+            }
+        }
+        copy(dst, i, result, dstDesc);
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+void
+CpuEvalStencilsSamples(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       int numSamples, int srcSampleStride,
+                       int dstSampleStride,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       int start, int end) {
+
+    assert(numSamples > 0);
+
+    if (start > 0) {
+        sizes += start;
+        indices += offsets[start];
+        weights += offsets[start];
+    }
+
+    src += srcDesc.offset;
+    dst += dstDesc.offset;
+
+    int const length = srcDesc.length;
+
+    //  The results of all the samples of a stencil are accumulated together,
+    //  each index and weight being loaded once:
+    float * result = (float*)alloca(numSamples * length * sizeof(float));
+
+    int nStencils = end - start;
+    for (int i = 0; i < nStencils; ++i, ++sizes) {
+
+        std::fill(result, result + numSamples * length, 0.0f);
+
+        for (int j = 0; j < *sizes; ++j, ++indices, ++weights) {
+            float const * srcVert = elementAtIndex(src, *indices, srcDesc);
+            float w = *weights;
+
+            for (int t = 0; t < numSamples; ++t) {
+                float const * srcT = srcVert + t * srcSampleStride;
+                float * resultT = result + t * length;
+                for (int k = 0; k < length; ++k) {
+                    resultT[k] += srcT[k] * w;
+                }
+            }
+        }
+        for (int t = 0; t < numSamples; ++t) {
+            copy(dst + t * dstSampleStride, i, result + t * length, dstDesc);
+        }
+    }
+}
+
+void
+CpuEvalPatchesSamples(float const * src, BufferDescriptor const &srcDesc,
+                      float * dst,       BufferDescriptor const &dstDesc,
+                      float * dstDu,     BufferDescriptor const &dstDuDesc,
+                      float * dstDv,     BufferDescriptor const &dstDvDesc,
+                      int numSamples, int srcSampleStride,
+                      int dstSampleStride,
+                      PatchCoord const * patchCoords,
+                      PatchArray const * patchArrays,
+                      int const * patchIndexBuffer,
+                      PatchParam const * patchParamBuffer,
+                      int start, int end) {
+
+    assert(numSamples > 0);
+
+    int const length = srcDesc.length;
+
+    float weights[3][20];
+    float * const w[6] = { weights[0],
+                           dstDu ? weights[1] : 0, dstDv ? weights[2] : 0,
+                           0, 0, 0 };
+
+    float * const outputs[3] = { dst, dstDu, dstDv };
+    BufferDescriptor const * const outputDescs[3] = { &dstDesc,
+                                                      &dstDuDesc, &dstDvDesc };
+
+    for (int i = start; i < end; ++i) {
+        PatchCoord const &coord = patchCoords[i];
+        PatchArray const &array = patchArrays[coord.handle.arrayIndex];
+        PatchParam const &param = patchParamBuffer[coord.handle.patchIndex];
+
+        int patchType = param.IsRegular()
+            ? array.GetPatchTypeRegular()
+            : array.GetPatchTypeIrregular();
+
+        //  The basis is evaluated once for all the samples:
+        int nPoints = evalPatchBasis(patchType, param, coord.s, coord.t, w);
+
+        int indexBase = array.GetIndexBase() + array.GetStride() *
+                (coord.handle.patchIndex - array.GetPrimitiveIdBase());
+        int const * cvs = &patchIndexBuffer[indexBase];
+
+        for (int d = 0; d < 3; ++d) {
+            if (!outputs[d]) continue;
+
+            for (int t = 0; t < numSamples; ++t) {
+                float * out = elementAtIndex(outputs[d] + t * dstSampleStride,
+                                             i, *outputDescs[d]);
+                std::fill(out, out + length, 0.0f);
+
+                float const * srcT = src + t * srcSampleStride;
+                for (int j = 0; j < nPoints; ++j) {
+                    float const * srcVert =
+                        elementAtIndex(srcT, cvs[j], srcDesc);
+                    for (int k = 0; k < length; ++k) {
+                        out[k] += srcVert[k] * w[d][j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+//
+//  Returns the box of the range of the given stencil (or -1 if the stencil is
+//  in no range) and the end of the stencils sharing it:
+//
+static inline int
+findBoundsRange(BoundsDescriptor const & bounds, int stencil, int & rangeEnd) {
+
+    rangeEnd = std::numeric_limits<int>::max();
+    if (!bounds.rangeOffsets) return 0;
+
+    int const * rangeOffsets = bounds.rangeOffsets;
+    int range = (int)(std::upper_bound(rangeOffsets,
+                                       rangeOffsets + bounds.numRanges + 1,
+                                       stencil) - rangeOffsets) - 1;
+    if (range < 0) {
+        rangeEnd = rangeOffsets[0];
+        return -1;
+    }
+    if (range >= bounds.numRanges) return -1;
+
+    rangeEnd = rangeOffsets[range + 1];
+    return range;
+}
+
+void
+CpuEvalStencilsBounds(float const * src, BufferDescriptor const &srcDesc,
+                      float * dst,       BufferDescriptor const &dstDesc,
+                      int const * sizes,
+                      Far::Offset const * offsets,
+                      int const * indices,
+                      float const * weights,
+                      BoundsDescriptor const & bounds,
+                      int start, int end) {
+
+    assert(dstDesc.length >= 3);
+
+    //
+    //  Stencils are evaluated in blocks within a single range, each block
+    //  being bounded while its results are still in cache rather than in
+    //  a second pass reading all of the destination:
+    //
+    int const blockSize = 256;
+
+    for (int blockBegin = start; blockBegin < end; ) {
+
+        int rangeEnd = 0;
+        int range = findBoundsRange(bounds, blockBegin, rangeEnd);
+
+        int blockEnd = std::min(std::min(blockBegin + blockSize, end),
+                                rangeEnd);
+
+        float * blockDst = dst + (blockBegin - start) * dstDesc.stride;
+
+        CpuEvalStencils(src, srcDesc, blockDst, dstDesc,
+                        sizes, offsets, indices, weights,
+                        blockBegin, blockEnd);
+
+        if (range >= 0) {
+            float * box = bounds.bounds + range * 6;
+
+            float lo[3] = { box[0], box[1], box[2] };
+            float hi[3] = { box[3], box[4], box[5] };
+
+            float const * p = blockDst + dstDesc.offset;
+            for (int i = blockBegin; i < blockEnd; ++i, p += dstDesc.stride) {
+                for (int k = 0; k < 3; ++k) {
+                    lo[k] = std::min(lo[k], p[k]);
+                    hi[k] = std::max(hi[k], p[k]);
+                }
+            }
+            for (int k = 0; k < 3; ++k) {
+                box[k]     = lo[k];
+                box[3 + k] = hi[k];
+            }
+        }
+        blockBegin = blockEnd;
+    }
+}
+
+void
+CpuClearBounds(BoundsDescriptor const & bounds) {
+
+    for (int i = 0; i < bounds.numRanges; ++i) {
+        float * box = bounds.bounds + i * 6;
+        for (int k = 0; k < 3; ++k) {
+            box[k]     =  std::numeric_limits<float>::max();
+            box[3 + k] = -std::numeric_limits<float>::max();
+        }
+    }
+}
+
+void
+CpuEvalPatchesDisplaced(float const * src, BufferDescriptor const &srcDesc,
+                        float * dst,       BufferDescriptor const &dstDesc,
+                        float * dstNormal, BufferDescriptor const &dstNormalDesc,
+                        PatchCoord const * patchCoords,
+                        PatchArray const * patchArrays,
+                        int const * patchIndexBuffer,
+                        PatchParam const * patchParamBuffer,
+                        DisplacementSampler sampler, void * samplerData,
+                        int start, int end) {
+
+    assert(srcDesc.length >= 3 && dstDesc.length == srcDesc.length);
+    assert(!dstNormal || dstNormalDesc.length == 3);
+
+    //  As for the normals, the points and derivatives of a chunk of coords
+    //  are evaluated together and the points then displaced in place:
+    int const chunkSize = 64;
+
+    BufferDescriptor derivDesc(0, srcDesc.length, srcDesc.length);
+
+    float * du = (float*)alloca(2 * chunkSize * derivDesc.stride * sizeof(float));
+    float * dv = du + chunkSize * derivDesc.stride;
+
+    BufferDescriptor none;
+    BufferDescriptor const * const descs[6] = { &dstDesc,
+        &derivDesc, &derivDesc, &none, &none, &none };
+
+    for (int c = start; c < end; c += chunkSize) {
+        int n = std::min(chunkSize, end - c);
+
+        float * const dsts[6] = { dst + c * dstDesc.stride, du, dv, 0, 0, 0 };
+
+        evalPatchesDispatch(src, srcDesc, dsts, descs, patchCoords + c, 0,
+                            patchArrays, patchIndexBuffer, patchParamBuffer,
+                            (CpuPatchPointStencils const *)0, 0, n);
+
+        for (int i = 0; i < n; ++i) {
+            PatchCoord const & coord = patchCoords[c + i];
+            float * P = elementAtIndex(dst, c + i, dstDesc);
+            float * Pu = elementAtIndex(du, i, derivDesc);
+            float * Pv = elementAtIndex(dv, i, derivDesc);
+
+            float N[3];
+            writeNormal(N, Pu, Pv);
+
+            //  The patch coords are the ptex coordinates of the faces:
+            int faceId = patchParamBuffer[coord.handle.patchIndex].GetFaceId();
+            float dDu = 0.0f, dDv = 0.0f;
+            float d = sampler(samplerData, faceId, coord.s, coord.t,
+                              dstNormal ? &dDu : 0, dstNormal ? &dDv : 0);
+
+            for (int k = 0; k < 3; ++k) {
+                P[k] += d * N[k];
+            }
+
+            //  The derivatives of the displaced surface ignore those of the
+            //  normal (i.e. the displacement is small relative to the
+            //  curvature), as for bump mapping:
+            if (dstNormal) {
+                for (int k = 0; k < 3; ++k) {
+                    Pu[k] += dDu * N[k];
+                    Pv[k] += dDv * N[k];
+                }
+                writeNormal(elementAtIndex(dstNormal, c + i, dstNormalDesc),
+                            Pu, Pv);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+//
+//  Structure of arrays kernels
+//
+template <bool DERIVATIVES> static void
+evalStencilsSoa(float const * src,
+                float * dst, float * dstDu, float * dstDv,
+                int const * sizes, int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int numStencils) {
+
+    int offset = 0;
+    for (int i = 0; i < numStencils; ++i) {
+
+        float p = 0.0f, du = 0.0f, dv = 0.0f;
+
+        int end = offset + sizes[i];
+        for (int j = offset; j < end; ++j) {
+            float value = src[indices[j]];
+            p += value * weights[j];
+            if (DERIVATIVES) {
+                du += value * duWeights[j];
+                dv += value * dvWeights[j];
+            }
+        }
+        offset = end;
+
+        dst[i] = p;
+        if (DERIVATIVES) {
+            dstDu[i] = du;
+            dstDv[i] = dv;
+        }
+    }
+}
+
+void
+CpuEvalStencilsSoa(float const * const * src,
+                   float * const * dst,
+                   float * const * dstDu,
+                   float * const * dstDv,
+                   int numComponents,
+                   int const * sizes,
+                   Far::Offset const * offsets,
+                   int const * indices,
+                   float const * weights,
+                   float const * duWeights,
+                   float const * dvWeights,
+                   int start, int end) {
+
+    assert(start>=0 && start<end);
+    assert(dst && ((dstDu && dstDv) || (!dstDu && !dstDv)));
+
+    bool derivatives = (dstDu != 0);
+
+    //  The stencils are evaluated in blocks, all the components of a block
+    //  in turn, so that its indices and weights remain in the cache:
+    int const blockSize = 256;
+
+    for (int block = start; block < end; block += blockSize) {
+        int n = std::min(blockSize, end - block);
+
+        Far::Offset offset = offsets[block];
+        int i = block - start;
+
+        for (int c = 0; c < numComponents; ++c) {
+
+            float * dstDuC = derivatives ? dstDu[c] + i : 0;
+            float * dstDvC = derivatives ? dstDv[c] + i : 0;
+
+            float const * duW = derivatives ? duWeights + offset : 0;
+            float const * dvW = derivatives ? dvWeights + offset : 0;
+
+            if (!reproducibleEvaluation &&
+                CpuEvalStencilsSoaSimd(src[c], dst[c] + i, dstDuC, dstDvC,
+                                       sizes + block, indices + offset,
+                                       weights + offset, duW, dvW, n)) {
+
+                // Vectorized kernel for the host CPU
+
+            } else if (derivatives) {
+                evalStencilsSoa<true>(src[c], dst[c] + i, dstDuC, dstDvC,
+                                      sizes + block, indices + offset,
+                                      weights + offset, duW, dvW, n);
+            } else {
+                evalStencilsSoa<false>(src[c], dst[c] + i, 0, 0,
+                                       sizes + block, indices + offset,
+                                       weights + offset, 0, 0, n);
+            }
+        }
+    }
+}
+
+void
+CpuEvalPatchesSoa(float const * const * src,
+                  float * const * dst,
+                  float * const * dstDu,
+                  float * const * dstDv,
+                  int numComponents,
+                  PatchCoord const * patchCoords,
+                  PatchArray const * patchArrays,
+                  int const * patchIndexBuffer,
+                  PatchParam const * patchParamBuffer,
+                  int start, int end) {
+
+    int const batchSize = Far::internal::PATCH_BASIS_BATCH_SIZE;
+
+    bool evalD1 = dstDu || dstDv;
+
+    //  Weight j of coord k of a run is stored in w[j * n + k]:
+    float weights[3][20 * batchSize];
+    float * const w[6] = { weights[0],
+                           evalD1 ? weights[1] : 0, evalD1 ? weights[2] : 0,
+                           0, 0, 0 };
+
+    float * const * dsts[3] = { dst, dstDu, dstDv };
+
+    float s[batchSize], t[batchSize], result[batchSize];
+
+    for (int i = start; i < end; ) {
+
+        PatchCoord const &coord = patchCoords[i];
+        PatchArray const &array = patchArrays[coord.handle.arrayIndex];
+        PatchParam const &param = patchParamBuffer[coord.handle.patchIndex];
+
+        int patchType = param.IsRegular()
+            ? array.GetPatchTypeRegular()
+            : array.GetPatchTypeIrregular();
+
+        //  Gather the run of following coords on the same patch, whose
+        //  results are contiguous in each component array:
+        int n = 1;
+        if (!reproducibleEvaluation && isPatchBasisBatched(patchType, param)) {
+            for ( ; (n < batchSize) && (i + n < end); ++n) {
+                if (patchCoords[i + n].handle.patchIndex !=
+                    coord.handle.patchIndex) break;
+            }
+        }
+
+        int nPoints = 0;
+        if (n == 1) {
+            nPoints = evalPatchBasis(patchType, param, coord.s, coord.t, w);
+        } else {
+            for (int k = 0; k < n; ++k) {
+                s[k] = patchCoords[i + k].s;
+                t[k] = patchCoords[i + k].t;
+            }
+            nPoints = Far::internal::EvaluatePatchBasisBatch<float>(
+                patchType, param, n, s, t, w[0], w[1], w[2], w[3], w[4], w[5]);
+        }
+
+        int indexBase = array.GetIndexBase() + array.GetStride() *
+                (coord.handle.patchIndex - array.GetPrimitiveIdBase());
+
+        int const * cvs = &patchIndexBuffer[indexBase];
+
+        for (int d = 0; d < 3; ++d) {
+            if (!dsts[d]) continue;
+
+            float const * wD = w[d];
+            for (int c = 0; c < numComponents; ++c) {
+                float const * srcC = src[c];
+
+                std::fill(result, result + n, 0.0f);
+                for (int j = 0; j < nPoints; ++j) {
+                    float         value = srcC[cvs[j]];
+                    float const * wJ    = wD + j * n;
+                    for (int k = 0; k < n; ++k) {
+                        result[k] += value * wJ[k];
+                    }
+                }
+                std::copy(result, result + n, dsts[d][c] + i);
+            }
+        }
+        i += n;
+    }
+}
+
 }  // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
@@ -26,6 +26,8 @@
 #define OPENSUBDIV3_OSD_CPU_KERNEL_H
 
 #include "../version.h"
+#include "../far/types.h"
+#include "../osd/types.h"
 #include <cstring>
 
 namespace OpenSubdiv {
@@ -34,12 +36,16 @@ namespace OPENSUBDIV_VERSION {
 namespace Osd {
 
 struct BufferDescriptor;
+struct PatchArray;
+struct PatchCoord;
+struct PatchParam;
+struct PrimvarBinding;
 
 void
 CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 int start, int end);
@@ -50,7 +56,7 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDu,     BufferDescriptor const &dstDuDesc,
                 float * dstDv,     BufferDescriptor const &dstDvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -66,7 +72,7 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDuv,    BufferDescriptor const &dstDuvDesc,
                 float * dstDvv,    BufferDescriptor const &dstDvvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -76,6 +82,413 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float const * dvvWeights,
                 int start, int end);
 
+//
+// Stencil kernels for double-precision primvar data, with weights of either
+// precision -- float weights are accumulated in double precision
+//
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                double const * weights,
+                int start, int end);
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end);
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                double * dstDu,     BufferDescriptor const &dstDuDesc,
+                double * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                double const * weights,
+                double const * duWeights,
+                double const * dvWeights,
+                int start, int end);
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                double * dstDu,     BufferDescriptor const &dstDuDesc,
+                double * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end);
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                double * dstDu,     BufferDescriptor const &dstDuDesc,
+                double * dstDv,     BufferDescriptor const &dstDvDesc,
+                double * dstDuu,    BufferDescriptor const &dstDuuDesc,
+                double * dstDuv,    BufferDescriptor const &dstDuvDesc,
+                double * dstDvv,    BufferDescriptor const &dstDvvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                double const * weights,
+                double const * duWeights,
+                double const * dvWeights,
+                double const * duuWeights,
+                double const * duvWeights,
+                double const * dvvWeights,
+                int start, int end);
+
+void
+CpuEvalStencils(double const * src, BufferDescriptor const &srcDesc,
+                double * dst,       BufferDescriptor const &dstDesc,
+                double * dstDu,     BufferDescriptor const &dstDuDesc,
+                double * dstDv,     BufferDescriptor const &dstDvDesc,
+                double * dstDuu,    BufferDescriptor const &dstDuuDesc,
+                double * dstDuv,    BufferDescriptor const &dstDuvDesc,
+                double * dstDvv,    BufferDescriptor const &dstDvvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                float const * duuWeights,
+                float const * duvWeights,
+                float const * dvvWeights,
+                int start, int end);
+
+//
+// Stencil kernel for the quantized entries of a CpuCompactStencilTable
+//
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * baseIndices,
+                float const * scales,
+                unsigned int const * entries,
+                int start, int end);
+
+//
+// Stencil kernels for the half-precision derivative weights of a
+// CpuHalfLimitStencilTable
+//
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                unsigned short const * duWeights,
+                unsigned short const * dvWeights,
+                int start, int end);
+
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
+                float * dstDuu,    BufferDescriptor const &dstDuuDesc,
+                float * dstDuv,    BufferDescriptor const &dstDuvDesc,
+                float * dstDvv,    BufferDescriptor const &dstDvvDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                unsigned short const * duWeights,
+                unsigned short const * dvWeights,
+                unsigned short const * duuWeights,
+                unsigned short const * duvWeights,
+                unsigned short const * dvvWeights,
+                int start, int end);
+
+//
+// Stencil kernel for the sources of a Far::VaryingTable, weighted by the
+// inverse of their number
+//
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                Far::Index const * offsets,
+                Far::Index const * indices,
+                int start, int end);
+
+//
+// Stencil kernel for a list of stencils -- unlike the kernels above, each
+// stencil is written to the element of the destination of the same index
+//
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int const * stencilIndices,
+                int numStencilIndices);
+
+//
+// Stencil kernel applying the stencils to several primvars in a single pass
+// over the stencil table (see PrimvarBinding)
+//
+void
+CpuEvalStencils(PrimvarBinding const * bindings, int numBindings,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end);
+
+//
+// Patch kernels for the PatchCoords [start, end) -- coords are visited in
+// the order given by patchCoordOrder (if any) and the result of each is
+// written to the element of its index in patchCoords.  Consecutive coords on
+// the same B-spline, Loop or Gregory triangle patch are evaluated together
+// with the batched patch basis of Far, each control point being accumulated
+// into the results of all of them.  The buffers are expected to be already
+// offset to their first element and any destination may be NULL.
+//
+void
+CpuEvalPatches(float const * src, BufferDescriptor const &srcDesc,
+               float * dst,       BufferDescriptor const &dstDesc,
+               float * dstDu,     BufferDescriptor const &dstDuDesc,
+               float * dstDv,     BufferDescriptor const &dstDvDesc,
+               float * dstDuu,    BufferDescriptor const &dstDuuDesc,
+               float * dstDuv,    BufferDescriptor const &dstDuvDesc,
+               float * dstDvv,    BufferDescriptor const &dstDvvDesc,
+               PatchCoord const * patchCoords,
+               int const * patchCoordOrder,
+               PatchArray const * patchArrays,
+               int const * patchIndexBuffer,
+               PatchParam const * patchParamBuffer,
+               int start, int end);
+
+void
+CpuEvalPatches(double const * src, BufferDescriptor const &srcDesc,
+               double * dst,       BufferDescriptor const &dstDesc,
+               double * dstDu,     BufferDescriptor const &dstDuDesc,
+               double * dstDv,     BufferDescriptor const &dstDvDesc,
+               double * dstDuu,    BufferDescriptor const &dstDuuDesc,
+               double * dstDuv,    BufferDescriptor const &dstDuvDesc,
+               double * dstDvv,    BufferDescriptor const &dstDvvDesc,
+               PatchCoord const * patchCoords,
+               int const * patchCoordOrder,
+               PatchArray const * patchArrays,
+               int const * patchIndexBuffer,
+               PatchParam const * patchParamBuffer,
+               int start, int end);
+
+//
+// Stencils of the patch points past the control vertices, factorized to
+// the control vertices
+//
+struct CpuPatchPointStencils {
+    int numControlVertices;
+    int const * sizes;
+    Far::Offset const * offsets;
+    int const * indices;
+    float const * weights;
+};
+
+//
+// Patch kernel reading the control vertices of the patches from src and
+// computing their other points from their stencils, without a buffer of
+// refined vertices (see CpuEvaluator::EvalPatchesWithStencils())
+//
+void
+CpuEvalPatchesWithStencils(float const * src, BufferDescriptor const &srcDesc,
+                           float * dst,       BufferDescriptor const &dstDesc,
+                           float * dstDu,     BufferDescriptor const &dstDuDesc,
+                           float * dstDv,     BufferDescriptor const &dstDvDesc,
+                           PatchCoord const * patchCoords,
+                           PatchArray const * patchArrays,
+                           int const * patchIndexBuffer,
+                           PatchParam const * patchParamBuffer,
+                           CpuPatchPointStencils const &stencils,
+                           int start, int end);
+
+//
+// Kernels writing the unit normals of the limit surface -- the normalized
+// cross product of the first three elements of the derivatives, which are
+// accumulated in the kernel without being written.  The points are written
+// to dst only if not NULL, and a degenerate normal is written as zero.  The
+// stencil kernel writes the results of stencil start+i to element i (as
+// CpuEvalStencils()) and the patch kernel to the element of the index of the
+// coord (as CpuEvalPatches(), the buffers being already offset).
+//
+void
+CpuEvalStencilsNormals(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       float * dstNormal, BufferDescriptor const &dstNormalDesc,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       float const * duWeights,
+                       float const * dvWeights,
+                       int start, int end);
+
+void
+CpuEvalPatchesNormals(float const * src, BufferDescriptor const &srcDesc,
+                      float * dst,       BufferDescriptor const &dstDesc,
+                      float * dstNormal, BufferDescriptor const &dstNormalDesc,
+                      PatchCoord const * patchCoords,
+                      PatchArray const * patchArrays,
+                      int const * patchIndexBuffer,
+                      PatchParam const * patchParamBuffer,
+                      int start, int end);
+
+//
+// Stencil kernel skinning the first three elements of the control vertices
+// as they are gathered (see SkinningDescriptor), writing the results of
+// stencil start+i to element i (as CpuEvalStencils()):
+//
+void
+CpuEvalStencilsSkinned(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       SkinningDescriptor const & skinning,
+                       int start, int end);
+
+//
+// Kernels evaluating numSamples time samples of the primvars in a single
+// traversal of the stencils (or patches), sample t of the source and the
+// destinations starting srcSampleStride and dstSampleStride floats after
+// sample t-1.  Results are written as by CpuEvalStencils() and
+// CpuEvalPatches() (the buffers of the patch kernel being already offset):
+//
+void
+CpuEvalStencilsSamples(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       int numSamples, int srcSampleStride,
+                       int dstSampleStride,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       int start, int end);
+
+void
+CpuEvalPatchesSamples(float const * src, BufferDescriptor const &srcDesc,
+                      float * dst,       BufferDescriptor const &dstDesc,
+                      float * dstDu,     BufferDescriptor const &dstDuDesc,
+                      float * dstDv,     BufferDescriptor const &dstDvDesc,
+                      int numSamples, int srcSampleStride,
+                      int dstSampleStride,
+                      PatchCoord const * patchCoords,
+                      PatchArray const * patchArrays,
+                      int const * patchIndexBuffer,
+                      PatchParam const * patchParamBuffer,
+                      int start, int end);
+
+//
+// Stencil kernel extending the bounding boxes of the ranges of the stencils
+// by the first three elements of their results (see BoundsDescriptor), the
+// results of stencil start+i being written to element i (as
+// CpuEvalStencils()). The boxes are extended rather than reset, so that
+// they may be reduced over several calls (see CpuClearBounds()).
+//
+void
+CpuEvalStencilsBounds(float const * src, BufferDescriptor const &srcDesc,
+                      float * dst,       BufferDescriptor const &dstDesc,
+                      int const * sizes,
+                      Far::Offset const * offsets,
+                      int const * indices,
+                      float const * weights,
+                      BoundsDescriptor const & bounds,
+                      int start, int end);
+
+//
+// Empties the bounding boxes of a BoundsDescriptor
+//
+void
+CpuClearBounds(BoundsDescriptor const & bounds);
+
+//
+// Limit evaluation displacing the first three elements of the points along
+// the unit normals by the displacement sampled at the ptex coordinates of
+// each coord, and writing the normals perturbed by the derivatives of the
+// displacement (if dstNormal is not NULL):
+//
+void
+CpuEvalPatchesDisplaced(float const * src, BufferDescriptor const &srcDesc,
+                        float * dst,       BufferDescriptor const &dstDesc,
+                        float * dstNormal, BufferDescriptor const &dstNormalDesc,
+                        PatchCoord const * patchCoords,
+                        PatchArray const * patchArrays,
+                        int const * patchIndexBuffer,
+                        PatchParam const * patchParamBuffer,
+                        DisplacementSampler sampler, void * samplerData,
+                        int start, int end);
+
+//
+// Kernels for primvars stored as a structure of arrays -- src, dst, dstDu and
+// dstDv are arrays of numComponents pointers to the (already offset) arrays
+// of each component, and the derivatives may be NULL.  Each component is
+// accumulated on its own, so that the kernels vectorize across the vertices
+// of a stencil rather than across the components of a vertex.  The stencil
+// kernel writes the results of stencil start+i to vertex i of the
+// destinations (and requires dst, as well as both dstDu and dstDv or
+// neither) and the patch kernel those of each coord to the vertex of its
+// index.
+//
+void
+CpuEvalStencilsSoa(float const * const * src,
+                   float * const * dst,
+                   float * const * dstDu,
+                   float * const * dstDv,
+                   int numComponents,
+                   int const * sizes,
+                   Far::Offset const * offsets,
+                   int const * indices,
+                   float const * weights,
+                   float const * duWeights,
+                   float const * dvWeights,
+                   int start, int end);
+
+void
+CpuEvalPatchesSoa(float const * const * src,
+                  float * const * dst,
+                  float * const * dstDu,
+                  float * const * dstDv,
+                  int numComponents,
+                  PatchCoord const * patchCoords,
+                  PatchArray const * patchArrays,
+                  int const * patchIndexBuffer,
+                  PatchParam const * patchParamBuffer,
+                  int start, int end);
+
+//
+// Reproducible evaluation -- when enabled, the stencil and patch kernels
+// shared by the Cpu, Tbb and Omp evaluators avoid the paths whose rounding
+// differs from that of the portable kernels: the explicitly vectorized
+// (FMA) stencil kernels and the batched evaluation of the patch basis, whose
+// runs of coords depend on how the coords are split among threads
+//
+void
+CpuSetReproducible(bool reproducible);
+
+bool
+CpuIsReproducible();
+
 //
 // SIMD ICC optimization of the stencil kernel
 //
@@ -140,6 +553,97 @@ ComputeStencilKernel(float const * vertexSrc,
     }
 }
 
+//
+// Stencil kernels for a primvar length known at compile time, so that the
+// loops over the elements of the primvar are fully unrolled and vectorized.
+// The NUM_OUTPUTS sets of weights (points and derivatives) are applied to the
+// same source elements, and the strides of the buffers are arbitrary.  The
+// weights are expected to be already offset to the first stencil evaluated
+// and the results of stencil i are written to element i of the destinations.
+//
+template <int NUM_OUTPUTS>
+struct CpuStencilOutputs {
+    float * dst[NUM_OUTPUTS];
+    int dstStride[NUM_OUTPUTS];
+    float const * weights[NUM_OUTPUTS];
+};
+
+template <int LENGTH, int NUM_OUTPUTS> void
+ComputeFixedLengthStencilKernel(float const * vertexSrc, int srcStride,
+                                CpuStencilOutputs<NUM_OUTPUTS> const & out,
+                                int const * sizes,
+                                int const * indices,
+                                int numStencils) {
+
+    int offset = 0;
+    for (int i = 0; i < numStencils; ++i) {
+
+        float result[NUM_OUTPUTS][LENGTH];
+        for (int d = 0; d < NUM_OUTPUTS; ++d) {
+            for (int k = 0; k < LENGTH; ++k) {
+                result[d][k] = 0.0f;
+            }
+        }
+
+        int end = offset + sizes[i];
+        for (int j = offset; j < end; ++j) {
+            float const * src = vertexSrc + indices[j] * srcStride;
+            for (int d = 0; d < NUM_OUTPUTS; ++d) {
+                float weight = out.weights[d][j];
+                for (int k = 0; k < LENGTH; ++k) {
+                    result[d][k] += src[k] * weight;
+                }
+            }
+        }
+        offset = end;
+
+        for (int d = 0; d < NUM_OUTPUTS; ++d) {
+            memcpy(out.dst[d] + i * out.dstStride[d], result[d],
+                   LENGTH * sizeof(float));
+        }
+    }
+}
+
+// Dispatches to the kernel of the given length once for all the stencils --
+// returns false for lengths past 16, which are left to the generic kernels
+template <int NUM_OUTPUTS> bool
+ComputeFixedLengthStencils(float const * vertexSrc, int srcStride, int length,
+                           CpuStencilOutputs<NUM_OUTPUTS> const & out,
+                           int const * sizes,
+                           int const * indices,
+                           int numStencils) {
+
+#define OSD_FIXED_LENGTH_STENCIL_CASE(LENGTH) \
+    case LENGTH: \
+        ComputeFixedLengthStencilKernel<LENGTH, NUM_OUTPUTS>( \
+            vertexSrc, srcStride, out, sizes, indices, numStencils); \
+        return true;
+
+    switch (length) {
+        OSD_FIXED_LENGTH_STENCIL_CASE(1)
+        OSD_FIXED_LENGTH_STENCIL_CASE(2)
+        OSD_FIXED_LENGTH_STENCIL_CASE(3)
+        OSD_FIXED_LENGTH_STENCIL_CASE(4)
+        OSD_FIXED_LENGTH_STENCIL_CASE(5)
+        OSD_FIXED_LENGTH_STENCIL_CASE(6)
+        OSD_FIXED_LENGTH_STENCIL_CASE(7)
+        OSD_FIXED_LENGTH_STENCIL_CASE(8)
+        OSD_FIXED_LENGTH_STENCIL_CASE(9)
+        OSD_FIXED_LENGTH_STENCIL_CASE(10)
+        OSD_FIXED_LENGTH_STENCIL_CASE(11)
+        OSD_FIXED_LENGTH_STENCIL_CASE(12)
+        OSD_FIXED_LENGTH_STENCIL_CASE(13)
+        OSD_FIXED_LENGTH_STENCIL_CASE(14)
+        OSD_FIXED_LENGTH_STENCIL_CASE(15)
+        OSD_FIXED_LENGTH_STENCIL_CASE(16)
+        default:
+            break;
+    }
+#undef OSD_FIXED_LENGTH_STENCIL_CASE
+
+    return false;
+}
+
 }  // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
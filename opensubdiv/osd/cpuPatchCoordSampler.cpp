@@ -0,0 +1,279 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../osd/cpuPatchCoordSampler.h"
+#include "../far/ptexIndices.h"
+#include "../far/topologyRefiner.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+namespace {
+
+//
+//  The cells of a face sampled with a grid of m x m cells, indexed in rows
+//  of increasing v: the m*m squares of a quad, or the m*m triangles of a
+//  triangle subdivided m times along each edge -- the 2(m-j)-1 triangles of
+//  row j alternating between upright and inverted.  The location of (r0,r1)
+//  in [0,1) x [0,1) within a cell is mapped to the face:
+//
+inline void
+getQuadCellLocation(int cell, int m, float r0, float r1, float & u, float & v) {
+
+    u = ((float)(cell % m) + r0) / (float)m;
+    v = ((float)(cell / m) + r1) / (float)m;
+}
+
+inline void
+getTriCellLocation(int cell, int m, float r0, float r1, float & u, float & v) {
+
+    int row = 0;
+    for (int rowSize = 2*m - 1; cell >= rowSize; rowSize -= 2) {
+        cell -= rowSize;
+        ++row;
+    }
+    if (r0 + r1 > 1.0f) {
+        r0 = 1.0f - r0;
+        r1 = 1.0f - r1;
+    }
+    if (cell & 1) {
+        u = ((float)(cell / 2 + 1) - r0) / (float)m;
+        v = ((float)(row + 1) - r1) / (float)m;
+    } else {
+        u = ((float)(cell / 2) + r0) / (float)m;
+        v = ((float)row + r1) / (float)m;
+    }
+}
+
+//
+//  Random numbers of a face, from a hash of the seed and the face so that
+//  the samples do not depend on the order in which faces are processed:
+//
+inline unsigned int
+hashValue(unsigned int x) {
+
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+class RandomSequence {
+public:
+    RandomSequence(unsigned int seed, int face) :
+        _state(hashValue(seed ^ hashValue((unsigned int)face))) { }
+
+    //  Returns a random number in [0,1)
+    float Next() {
+        _state = _state * 1664525U + 1013904223U;
+        return (float)(hashValue(_state) >> 8) * (1.0f / 16777216.0f);
+    }
+
+private:
+    unsigned int _state;
+};
+
+//
+//  Writes the locations of the samples of a face:
+//
+struct UniformSamples {
+    bool triangles;
+
+    void operator()(int /* face */, int count, PatchCoord * coords) const {
+
+        int m = (int)std::sqrt((double)count);
+        float r = triangles ? (1.0f / 3.0f) : 0.5f;
+        for (int i = 0; i < count; ++i) {
+            if (triangles) {
+                getTriCellLocation(i, m, r, r, coords[i].s, coords[i].t);
+            } else {
+                getQuadCellLocation(i, m, r, r, coords[i].s, coords[i].t);
+            }
+        }
+    }
+};
+
+struct StratifiedSamples {
+    bool         triangles;
+    unsigned int seed;
+
+    void operator()(int face, int count, PatchCoord * coords) const {
+
+        RandomSequence random(seed, face);
+
+        //  The count cells are evenly spaced among the m*m cells of the
+        //  grid, from a random offset:
+        int m = (int)std::ceil(std::sqrt((double)count));
+        float spacing = (float)(m * m) / (float)count;
+        float offset = random.Next();
+
+        for (int i = 0; i < count; ++i) {
+            int cell = std::min((int)(((float)i + offset) * spacing), m*m - 1);
+            float r0 = random.Next();
+            float r1 = random.Next();
+            if (triangles) {
+                getTriCellLocation(cell, m, r0, r1, coords[i].s, coords[i].t);
+            } else {
+                getQuadCellLocation(cell, m, r0, r1, coords[i].s, coords[i].t);
+            }
+        }
+    }
+};
+
+} // end namespace
+
+CpuPatchCoordSampler::CpuPatchCoordSampler(Far::TopologyRefiner const & refiner,
+                                           Far::PatchTable const & patchTable,
+                                           Options options) :
+    _patchMap(patchTable), _options(options),
+    _triangles(_patchMap.ArePatchesTriangular()) {
+
+    Far::PtexIndices ptexIndices(refiner);
+
+    int numBaseFaces = refiner.GetLevel(0).GetNumFaces();
+    _baseFacePtexOffsets.resize(numBaseFaces + 1);
+    for (int face = 0; face < numBaseFaces; ++face) {
+        _baseFacePtexOffsets[face] = ptexIndices.GetFaceId(face);
+    }
+    _baseFacePtexOffsets[numBaseFaces] = ptexIndices.GetNumFaces();
+
+    //  The patch found at the center of a face covers the whole face if it
+    //  is at the depth of the face itself:
+    int numPtexFaces = ptexIndices.GetNumFaces();
+    _faceHandles.resize(numPtexFaces, 0);
+    _faceSubdivided.resize(numPtexFaces, false);
+    for (int face = 0; face < numPtexFaces; ++face) {
+        Handle const * handle = _patchMap.FindPatch(face, 0.5, 0.5);
+        if (handle) {
+            Far::PatchParam param = patchTable.GetPatchParam(*handle);
+            int faceDepth = param.NonQuadRoot() ? 1 : 0;
+            _faceHandles[face] = handle;
+            _faceSubdivided[face] = (param.GetDepth() > faceDepth);
+        }
+    }
+}
+
+int
+CpuPatchCoordSampler::computeOffsets(int const * counts,
+                                     std::vector<int> & offsets) const {
+
+    int numFaces = GetNumPtexFaces();
+    offsets.resize(numFaces + 1);
+    offsets[0] = 0;
+    for (int face = 0; face < numFaces; ++face) {
+        int count = _faceHandles[face] ? std::max(counts[face], 0) : 0;
+        offsets[face + 1] = offsets[face] + count;
+    }
+    return offsets[numFaces];
+}
+
+template <class SAMPLE_FUNC>
+int
+CpuPatchCoordSampler::sample(int const * counts,
+                             SAMPLE_FUNC const & sampleFace,
+                             PatchCoord * coords) const {
+
+    std::vector<int> offsets;
+    int numSamples = computeOffsets(counts, offsets);
+    int numFaces = GetNumPtexFaces();
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = std::max(1, (int)_options.numThreads);
+    #pragma omp parallel for num_threads(numThreads) if (numThreads > 1) \
+                             schedule(dynamic, 64)
+#endif
+    for (int face = 0; face < numFaces; ++face) {
+        int count = offsets[face + 1] - offsets[face];
+        if (count == 0) continue;
+
+        PatchCoord * faceCoords = coords + offsets[face];
+        sampleFace(face, count, faceCoords);
+
+        if (!_faceSubdivided[face]) {
+            for (int i = 0; i < count; ++i) {
+                faceCoords[i].handle = *_faceHandles[face];
+            }
+        } else {
+            for (int i = 0; i < count; ++i) {
+                Handle const * handle = _patchMap.FindPatch(face,
+                    faceCoords[i].s, faceCoords[i].t);
+                faceCoords[i].handle = handle ? *handle : *_faceHandles[face];
+            }
+        }
+    }
+    return numSamples;
+}
+
+int
+CpuPatchCoordSampler::SampleUniform(int rate, PatchCoord * coords) const {
+
+    if (rate < 1) return 0;
+
+    std::vector<int> counts(GetNumPtexFaces(), rate * rate);
+
+    UniformSamples sampleFace;
+    sampleFace.triangles = _triangles;
+    return sample(counts.empty() ? 0 : &counts[0], sampleFace, coords);
+}
+
+int
+CpuPatchCoordSampler::SampleStratified(int const * ptexFaceCounts,
+                                       unsigned int seed,
+                                       PatchCoord * coords) const {
+
+    StratifiedSamples sampleFace;
+    sampleFace.triangles = _triangles;
+    sampleFace.seed = seed;
+    return sample(ptexFaceCounts, sampleFace, coords);
+}
+
+int
+CpuPatchCoordSampler::SampleBaseFaces(int const * baseFaceCounts,
+                                      unsigned int seed,
+                                      PatchCoord * coords) const {
+
+    std::vector<int> counts(GetNumPtexFaces(), 0);
+    for (int face = 0; face < GetNumBaseFaces(); ++face) {
+        int first = _baseFacePtexOffsets[face];
+        int numPtexFaces = _baseFacePtexOffsets[face + 1] - first;
+        int count = std::max(baseFaceCounts[face], 0);
+        for (int i = 0; i < numPtexFaces; ++i) {
+            counts[first + i] = count / numPtexFaces +
+                                ((i < count % numPtexFaces) ? 1 : 0);
+        }
+    }
+    return SampleStratified(counts.empty() ? 0 : &counts[0], seed, coords);
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
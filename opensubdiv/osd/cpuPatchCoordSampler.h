@@ -0,0 +1,166 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_CPU_PATCH_COORD_SAMPLER_H
+#define OPENSUBDIV3_OSD_CPU_PATCH_COORD_SAMPLER_H
+
+#include "../version.h"
+#include "../far/patchMap.h"
+#include "../far/patchTable.h"
+#include "../osd/types.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class TopologyRefiner;
+}
+
+namespace Osd {
+
+/// \brief Generates arrays of PatchCoord for common sampling patterns
+///
+/// The samples of each ptex face are generated independently, and in
+/// parallel when OpenMP is available, directly into the array given, the
+/// samples of the faces following each other in the order of the faces.
+/// The patch of a face that is not subdivided -- i.e. covered by a single
+/// patch, as most faces of a mesh are -- is found once for all its samples,
+/// so that only the samples of the faces around extraordinary features are
+/// located with the Far::PatchMap.
+///
+/// No samples are generated for the faces that are holes, so the arrays
+/// sized for the number of samples requested are upper bounds, and the
+/// number of samples written is returned.
+///
+/// The random samples are stratified: the k samples of a face are each in a
+/// different cell of the smallest uniform grid of at least k cells, at a
+/// random location within its cell. They depend only on the seed and the
+/// face, not on the number of threads.
+///
+class CpuPatchCoordSampler {
+public:
+    struct Options {
+
+        Options() : numThreads(0) { }
+
+        unsigned int numThreads : 8; ///< Number of threads used to generate
+                                     ///< samples concurrently (requires
+                                     ///< OpenMP support, ignored otherwise)
+    };
+
+    /// \brief Constructor
+    ///
+    /// @param refiner     the refiner of the patch table, for the mapping
+    ///                    of its base faces to ptex faces
+    ///
+    /// @param patchTable  the patch table to sample
+    ///
+    /// @param options     options controlling the sampling
+    ///
+    CpuPatchCoordSampler(Far::TopologyRefiner const & refiner,
+                         Far::PatchTable const & patchTable,
+                         Options options = Options());
+
+    /// \brief Returns the number of ptex faces
+    int GetNumPtexFaces() const { return (int)_faceHandles.size(); }
+
+    /// \brief Returns the number of base faces
+    int GetNumBaseFaces() const { return (int)_baseFacePtexOffsets.size() - 1; }
+
+    /// \brief Generates a uniform grid of rate x rate samples on each ptex
+    ///        face: the centers of the cells of a quad face, or the
+    ///        centroids of the triangles of a triangular face subdivided
+    ///        rate times along each edge
+    ///
+    /// @param rate     the number of samples along each edge of a face
+    ///
+    /// @param coords   the coords of at least GetNumPtexFaces() * rate *
+    ///                 rate samples
+    ///
+    /// @return         the number of samples written
+    ///
+    int SampleUniform(int rate, PatchCoord * coords) const;
+
+    /// \brief Generates stratified random samples with a number of samples
+    ///        for each ptex face
+    ///
+    /// @param ptexFaceCounts  the number of samples of each ptex face
+    ///
+    /// @param seed            the seed of the random samples
+    ///
+    /// @param coords          the coords of at least the sum of the counts
+    ///
+    /// @return                the number of samples written
+    ///
+    int SampleStratified(int const * ptexFaceCounts, unsigned int seed,
+                         PatchCoord * coords) const;
+
+    /// \brief Generates stratified random samples with a number of samples
+    ///        for each base face, divided evenly between the ptex faces of
+    ///        the non-quads
+    ///
+    /// @param baseFaceCounts  the number of samples of each base face
+    ///
+    /// @param seed            the seed of the random samples
+    ///
+    /// @param coords          the coords of at least the sum of the counts
+    ///
+    /// @return                the number of samples written
+    ///
+    int SampleBaseFaces(int const * baseFaceCounts, unsigned int seed,
+                        PatchCoord * coords) const;
+
+private:
+    typedef Far::PatchTable::PatchHandle Handle;
+
+    //  Offsets of the samples of each face, counting no samples for holes:
+    int computeOffsets(int const * counts, std::vector<int> & offsets) const;
+
+    template <class SAMPLE_FUNC>
+    int sample(int const * counts, SAMPLE_FUNC const & sampleFace,
+               PatchCoord * coords) const;
+
+    Far::PatchMap _patchMap;
+    Options       _options;
+    bool          _triangles;
+
+    //  The patch of each ptex face that is not subdivided, the PatchMap
+    //  being searched for the others (or 0 for holes):
+    std::vector<Handle const *> _faceHandles;
+    std::vector<bool>           _faceSubdivided;
+
+    std::vector<int> _baseFacePtexOffsets;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_PATCH_COORD_SAMPLER_H
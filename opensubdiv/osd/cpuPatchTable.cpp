@@ -54,13 +54,20 @@ CpuPatchTable::CpuPatchTable(const Far::PatchTable *farPatchTable) {
     _fvarPatchArrays.resize(farPatchTable->GetNumFVarChannels());
     _fvarIndexBuffers.resize(farPatchTable->GetNumFVarChannels());
     _fvarParamBuffers.resize(farPatchTable->GetNumFVarChannels());
+    _fvarSharedChannels.resize(farPatchTable->GetNumFVarChannels());
     for (int fvc=0; fvc<farPatchTable->GetNumFVarChannels(); ++fvc) {
         _fvarPatchArrays[fvc].reserve(nPatchArrays);
+
+        //  Buffers of channels sharing the data of another are left empty:
+        _fvarSharedChannels[fvc] = farPatchTable->GetSharedFVarChannel(fvc);
+        if (_fvarSharedChannels[fvc] != fvc) continue;
+
         _fvarIndexBuffers[fvc].reserve(
             numPatches * farPatchTable->GetFVarValueStride(fvc));
         _fvarParamBuffers[fvc].reserve(numPatches);
     }
     _patchParamBuffer.reserve(numPatches);
+    _patchParamNormalizationBuffer.reserve(numPatches);
 
     // for each patchArray
     for (int j = 0; j < nPatchArrays; ++j) {
@@ -90,6 +97,13 @@ CpuPatchTable::CpuPatchTable(const Far::PatchTable *farPatchTable) {
 
         // create face-varying arrays for each channel:
         for (int fvc=0; fvc<farPatchTable->GetNumFVarChannels(); ++fvc) {
+            // shared channels refer to the arrays of their source channel:
+            int srcFvc = _fvarSharedChannels[fvc];
+            if (srcFvc != fvc) {
+                _fvarPatchArrays[fvc].push_back(_fvarPatchArrays[srcFvc].back());
+                continue;
+            }
+
             // create face-varying array and append indices to buffer:
             PatchArray fvarPatchArray(
                 farPatchTable->GetFVarPatchDescriptorRegular(fvc),
@@ -138,6 +152,11 @@ CpuPatchTable::CpuPatchTable(const Far::PatchTable *farPatchTable) {
         std::vector<Far::Index> const &sharpnessIndexTable =
             farPatchTable->GetSharpnessIndexTable();
         int numPatchesJ = farPatchTable->GetNumPatches(j);
+        Far::PatchDescriptor::Type patchType =
+            farPatchTable->GetPatchArrayDescriptor(j).GetType();
+        bool triangle = (patchType == Far::PatchDescriptor::TRIANGLES ||
+                         patchType == Far::PatchDescriptor::LOOP ||
+                         patchType == Far::PatchDescriptor::GREGORY_TRIANGLE);
         for (int k = 0; k < numPatchesJ; ++k) {
             float sharpness = 0.0;
             int patchIndex = (int)_patchParamBuffer.size();
@@ -152,9 +171,26 @@ CpuPatchTable::CpuPatchTable(const Far::PatchTable *farPatchTable) {
             param.field1 = patchParamTable[patchIndex].field1;
             param.sharpness = sharpness;
             _patchParamBuffer.push_back(param);
+            _patchParamNormalizationBuffer.push_back(
+                PatchParamNormalization(patchParamTable[patchIndex], triangle));
         }
 #endif
     }
+
+    // single-crease matrices, only for tables with single-crease patches
+    // (double-crease patches have a negative sharpness)
+    for (int i = 0; i < (int)_patchParamBuffer.size(); ++i) {
+        if (_patchParamBuffer[i].sharpness > 0.0f) {
+            _singleCreaseMatricesBuffer.resize(_patchParamBuffer.size());
+            break;
+        }
+    }
+    for (int i = 0; i < (int)_singleCreaseMatricesBuffer.size(); ++i) {
+        float sharpness = _patchParamBuffer[i].sharpness;
+        if (sharpness > 0.0f) {
+            _singleCreaseMatricesBuffer[i] = SingleCreaseMatrices(sharpness);
+        }
+    }
 }
 
 }  // end namespace Osd
@@ -87,6 +87,25 @@ public:
         return _patchParamBuffer.size();
     }
 
+    /// Returns the normalization of each patch param (see
+    /// Osd::PatchParamNormalization), parallel to the patch param buffer
+    const PatchParamNormalization *GetPatchParamNormalizationBuffer() const {
+        return &_patchParamNormalizationBuffer[0];
+    }
+
+    /// Returns the single-crease matrices of each patch (see
+    /// Osd::SingleCreaseMatrices), parallel to the patch param buffer, or
+    /// NULL if the table has no single-crease patches
+    const SingleCreaseMatrices *GetSingleCreaseMatricesBuffer() const {
+        if (_singleCreaseMatricesBuffer.empty()) {
+            return NULL;
+        }
+        return &_singleCreaseMatricesBuffer[0];
+    }
+    size_t GetSingleCreaseMatricesSize() const {
+        return _singleCreaseMatricesBuffer.size();
+    }
+
     const PatchArray *GetVaryingPatchArrayBuffer() const {
         if (_varyingPatchArrays.empty()) {
             return NULL;
@@ -106,26 +125,33 @@ public:
     int GetNumFVarChannels() const {
         return (int)_fvarPatchArrays.size();
     }
+    /// Returns the first channel whose buffers are shared with fvarChannel
+    /// (see Far::PatchTable::GetSharedFVarChannel())
+    int GetSharedFVarChannel(int fvarChannel = 0) const {
+        return _fvarSharedChannels[fvarChannel];
+    }
     const PatchArray *GetFVarPatchArrayBuffer(int fvarChannel = 0) const {
         return &_fvarPatchArrays[fvarChannel][0];
     }
     const int *GetFVarPatchIndexBuffer(int fvarChannel = 0) const {
-        return &_fvarIndexBuffers[fvarChannel][0];
+        return &_fvarIndexBuffers[GetSharedFVarChannel(fvarChannel)][0];
     }
     size_t GetFVarPatchIndexSize(int fvarChannel = 0) const {
-        return _fvarIndexBuffers[fvarChannel].size();
+        return _fvarIndexBuffers[GetSharedFVarChannel(fvarChannel)].size();
     }
     const PatchParam *GetFVarPatchParamBuffer(int fvarChannel= 0) const {
-        return &_fvarParamBuffers[fvarChannel][0];
+        return &_fvarParamBuffers[GetSharedFVarChannel(fvarChannel)][0];
     }
     size_t GetFVarPatchParamSize(int fvarChannel = 0) const {
-        return _fvarParamBuffers[fvarChannel].size();
+        return _fvarParamBuffers[GetSharedFVarChannel(fvarChannel)].size();
     }
 
 protected:
     PatchArrayVector _patchArrays;
     std::vector<int> _indexBuffer;
     PatchParamVector _patchParamBuffer;
+    PatchParamNormalizationVector _patchParamNormalizationBuffer;
+    SingleCreaseMatricesVector _singleCreaseMatricesBuffer;
 
     PatchArrayVector _varyingPatchArrays;
     std::vector<int> _varyingIndexBuffer;
@@ -133,6 +159,7 @@ protected:
     std::vector< PatchArrayVector > _fvarPatchArrays;
     std::vector< std::vector<int> > _fvarIndexBuffers;
     std::vector< PatchParamVector > _fvarParamBuffers;
+    std::vector< int >              _fvarSharedChannels;
 };
 
 }  // end namespace Osd
@@ -0,0 +1,804 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../osd/cpuSimdKernel.h"
+#include "../osd/bufferDescriptor.h"
+
+//
+// The x86 vectorized kernels rely on per-function target attributes, so
+// that the library itself does not need to be compiled for a specific
+// instruction set, and on the compiler's CPU feature detection. The NEON
+// kernels are built for any AArch64 target (e.g. Apple Silicon).
+//
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    #define OSD_CPU_SIMD_KERNELS
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define OSD_CPU_NEON_KERNELS
+    #include <arm_neon.h>
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+#if defined(OSD_CPU_SIMD_KERNELS) || defined(OSD_CPU_NEON_KERNELS)
+
+namespace {
+
+//
+// Stencil outputs: NUM_OUTPUTS sets of weights (1 for points only, 3 with
+// 1st derivatives and 6 with 2nd derivatives) are applied to the same
+// source elements, each accumulated into its own destination buffer.
+//
+template <int NUM_OUTPUTS>
+struct StencilOutputs {
+    float * dst[NUM_OUTPUTS];
+    int dstStride[NUM_OUTPUTS];
+    float const * weights[NUM_OUTPUTS];
+};
+
+//
+// Returns true if every source element is followed by enough padding to
+// be loaded as a vector of paddedLength floats
+//
+inline bool
+isPadded(BufferDescriptor const &desc, int paddedLength) {
+
+    return desc.stride >= paddedLength &&
+           (desc.offset % desc.stride) + paddedLength <= desc.stride;
+}
+
+} // end namespace
+
+#endif
+
+#if defined(OSD_CPU_SIMD_KERNELS)
+
+namespace {
+
+#define OSD_TARGET_AVX2   __attribute__((target("avx2,fma")))
+#define OSD_TARGET_AVX512 __attribute__((target("avx512f")))
+
+enum SimdLevel {
+    SIMD_NONE,
+    SIMD_AVX2,
+    SIMD_AVX512
+};
+
+SimdLevel
+detectSimdLevel() {
+
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        return SIMD_AVX512;
+    } else if (__builtin_cpu_supports("avx2") &&
+               __builtin_cpu_supports("fma")) {
+        return SIMD_AVX2;
+    }
+    return SIMD_NONE;
+}
+
+SimdLevel
+getSimdLevel() {
+
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+//
+// AVX2 kernels for a fixed primvar length of 3, 4, 6 or 8 floats, accum-
+// ulated in the lower lanes of a 256-bit register. Lengths other than 4 and
+// 8 use masked loads and stores, which never touch memory beyond the
+// element (including the last one of a buffer). When the source elements
+// are PADDED to 4 or 8 floats (e.g. XYZ positions with a stride of 4), the
+// whole vector is loaded instead, the padding being discarded by the
+// masked stores.
+//
+template <int LENGTH, bool PADDED>
+struct Avx2Element {
+
+    static OSD_TARGET_AVX2 __m256i
+    mask() {
+        return _mm256_setr_epi32(
+            LENGTH > 0 ? -1 : 0, LENGTH > 1 ? -1 : 0,
+            LENGTH > 2 ? -1 : 0, LENGTH > 3 ? -1 : 0,
+            LENGTH > 4 ? -1 : 0, LENGTH > 5 ? -1 : 0,
+            LENGTH > 6 ? -1 : 0, LENGTH > 7 ? -1 : 0);
+    }
+
+    static OSD_TARGET_AVX2 __m256
+    load(float const * src, __m256i mask) {
+        if (LENGTH == 8 || (PADDED && LENGTH > 4)) {
+            return _mm256_loadu_ps(src);
+        } else if (LENGTH == 4 || PADDED) {
+            return _mm256_castps128_ps256(_mm_loadu_ps(src));
+        }
+        return _mm256_maskload_ps(src, mask);
+    }
+
+    static OSD_TARGET_AVX2 void
+    store(float * dst, __m256 value, __m256i mask) {
+        if (LENGTH == 8) {
+            _mm256_storeu_ps(dst, value);
+        } else if (LENGTH == 4) {
+            _mm_storeu_ps(dst, _mm256_castps256_ps128(value));
+        } else {
+            _mm256_maskstore_ps(dst, mask, value);
+        }
+    }
+};
+
+template <int LENGTH, bool PADDED, int NUM_OUTPUTS>
+OSD_TARGET_AVX2 void
+evalStencilsAvx2(float const * src, int srcStride,
+                 StencilOutputs<NUM_OUTPUTS> const & out,
+                 int const * sizes, int const * indices,
+                 int numStencils) {
+
+    typedef Avx2Element<LENGTH, PADDED> Element;
+
+    __m256i mask = Element::mask();
+
+    int offset = 0;
+    for (int i = 0; i < numStencils; ++i) {
+
+        __m256 result[NUM_OUTPUTS];
+        for (int k = 0; k < NUM_OUTPUTS; ++k) {
+            result[k] = _mm256_setzero_ps();
+        }
+
+        int end = offset + sizes[i];
+        for (int j = offset; j < end; ++j) {
+            __m256 s = Element::load(src + indices[j] * srcStride, mask);
+
+            for (int k = 0; k < NUM_OUTPUTS; ++k) {
+                result[k] = _mm256_fmadd_ps(
+                    s, _mm256_broadcast_ss(out.weights[k] + j), result[k]);
+            }
+        }
+        offset = end;
+
+        for (int k = 0; k < NUM_OUTPUTS; ++k) {
+            Element::store(out.dst[k] + i * out.dstStride[k], result[k], mask);
+        }
+    }
+}
+
+template <int LENGTH, int NUM_OUTPUTS>
+void
+evalStencilsAvx2(float const * src, BufferDescriptor const &srcDesc,
+                 StencilOutputs<NUM_OUTPUTS> const & out,
+                 int const * sizes, int const * indices,
+                 int numStencils) {
+
+    if ((LENGTH == 3 || LENGTH == 6) && isPadded(srcDesc, LENGTH > 4 ? 8 : 4)) {
+        evalStencilsAvx2<LENGTH, true>(src, srcDesc.stride, out,
+                                       sizes, indices, numStencils);
+    } else {
+        evalStencilsAvx2<LENGTH, false>(src, srcDesc.stride, out,
+                                        sizes, indices, numStencils);
+    }
+}
+
+//
+// AVX-512 kernel for any primvar length up to 16 floats, using a lane mask
+// for loads and stores.
+//
+template <int NUM_OUTPUTS>
+OSD_TARGET_AVX512 void
+evalStencilsAvx512(float const * src, int srcStride, int length,
+                   StencilOutputs<NUM_OUTPUTS> const & out,
+                   int const * sizes, int const * indices,
+                   int numStencils) {
+
+    __mmask16 mask = (__mmask16)((1u << length) - 1);
+
+    int offset = 0;
+    for (int i = 0; i < numStencils; ++i) {
+
+        __m512 result[NUM_OUTPUTS];
+        for (int k = 0; k < NUM_OUTPUTS; ++k) {
+            result[k] = _mm512_setzero_ps();
+        }
+
+        int end = offset + sizes[i];
+        for (int j = offset; j < end; ++j) {
+            __m512 s = _mm512_maskz_loadu_ps(mask, src + indices[j] * srcStride);
+
+            for (int k = 0; k < NUM_OUTPUTS; ++k) {
+                result[k] = _mm512_fmadd_ps(
+                    s, _mm512_set1_ps(out.weights[k][j]), result[k]);
+            }
+        }
+        offset = end;
+
+        for (int k = 0; k < NUM_OUTPUTS; ++k) {
+            _mm512_mask_storeu_ps(
+                out.dst[k] + i * out.dstStride[k], mask, result[k]);
+        }
+    }
+}
+
+template <int NUM_OUTPUTS>
+bool
+evalStencils(float const * src, BufferDescriptor const &srcDesc,
+             BufferDescriptor const * const dstDescs[NUM_OUTPUTS],
+             StencilOutputs<NUM_OUTPUTS> const & out,
+             int const * sizes, int const * indices,
+             int numStencils) {
+
+    int length = srcDesc.length;
+    for (int k = 0; k < NUM_OUTPUTS; ++k) {
+        if (dstDescs[k]->length != length) return false;
+    }
+
+    SimdLevel level = getSimdLevel();
+    if (level == SIMD_NONE) return false;
+
+    // The fixed length AVX2 kernels are preferred for the most common
+    // lengths since there is nothing to gain from wider registers there:
+    switch (length) {
+        case 3:
+            evalStencilsAvx2<3>(src, srcDesc, out,
+                                sizes, indices, numStencils);
+            return true;
+        case 4:
+            evalStencilsAvx2<4>(src, srcDesc, out,
+                                sizes, indices, numStencils);
+            return true;
+        case 6:
+            evalStencilsAvx2<6>(src, srcDesc, out,
+                                sizes, indices, numStencils);
+            return true;
+        case 8:
+            evalStencilsAvx2<8>(src, srcDesc, out,
+                                sizes, indices, numStencils);
+            return true;
+        default:
+            break;
+    }
+
+    if (level == SIMD_AVX512 && length > 0 && length <= 16) {
+        evalStencilsAvx512(src, srcDesc.stride, length, out,
+                           sizes, indices, numStencils);
+        return true;
+    }
+    return false;
+}
+
+//
+// AVX2 kernel for a single component array: the indices and weights of each
+// stencil are loaded 8 at a time, the source values gathered with them and
+// the lanes summed once the stencil is complete. The last indices of a
+// stencil are loaded and gathered with a mask.
+//
+OSD_TARGET_AVX2 inline float
+horizontalSumAvx2(__m256 v) {
+
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v),
+                          _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+template <bool DERIVATIVES>
+OSD_TARGET_AVX2 void
+evalStencilsSoaAvx2(float const * src,
+                    float * dst, float * dstDu, float * dstDv,
+                    int const * sizes, int const * indices,
+                    float const * weights,
+                    float const * duWeights,
+                    float const * dvWeights,
+                    int numStencils) {
+
+    __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    int offset = 0;
+    for (int i = 0; i < numStencils; ++i) {
+
+        __m256 p  = _mm256_setzero_ps();
+        __m256 du = _mm256_setzero_ps();
+        __m256 dv = _mm256_setzero_ps();
+
+        int end = offset + sizes[i];
+        int j = offset;
+        for ( ; j + 8 <= end; j += 8) {
+            __m256i idx = _mm256_loadu_si256((__m256i const *)(indices + j));
+            __m256  s   = _mm256_i32gather_ps(src, idx, 4);
+
+            p = _mm256_fmadd_ps(s, _mm256_loadu_ps(weights + j), p);
+            if (DERIVATIVES) {
+                du = _mm256_fmadd_ps(s, _mm256_loadu_ps(duWeights + j), du);
+                dv = _mm256_fmadd_ps(s, _mm256_loadu_ps(dvWeights + j), dv);
+            }
+        }
+        if (j < end) {
+            __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(end - j),
+                                              lanes);
+            __m256i idx  = _mm256_maskload_epi32(indices + j, mask);
+            __m256  s    = _mm256_mask_i32gather_ps(_mm256_setzero_ps(),
+                               src, idx, _mm256_castsi256_ps(mask), 4);
+
+            p = _mm256_fmadd_ps(s, _mm256_maskload_ps(weights + j, mask), p);
+            if (DERIVATIVES) {
+                du = _mm256_fmadd_ps(
+                    s, _mm256_maskload_ps(duWeights + j, mask), du);
+                dv = _mm256_fmadd_ps(
+                    s, _mm256_maskload_ps(dvWeights + j, mask), dv);
+            }
+        }
+        offset = end;
+
+        dst[i] = horizontalSumAvx2(p);
+        if (DERIVATIVES) {
+            dstDu[i] = horizontalSumAvx2(du);
+            dstDv[i] = horizontalSumAvx2(dv);
+        }
+    }
+}
+
+bool
+evalStencilsSoa(float const * src,
+                float * dst, float * dstDu, float * dstDv,
+                int const * sizes,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int numStencils) {
+
+    if (getSimdLevel() == SIMD_NONE) return false;
+
+    if (dstDu && dstDv) {
+        evalStencilsSoaAvx2<true>(src, dst, dstDu, dstDv, sizes, indices,
+                                  weights, duWeights, dvWeights, numStencils);
+    } else {
+        evalStencilsSoaAvx2<false>(src, dst, 0, 0, sizes, indices,
+                                   weights, 0, 0, numStencils);
+    }
+    return true;
+}
+
+} // end namespace
+
+#elif defined(OSD_CPU_NEON_KERNELS)
+
+namespace {
+
+//
+// NEON kernels for a fixed primvar length of up to 16 floats, accumulated in
+// as many 128-bit registers as needed. NEON is part of the AArch64 base
+// instruction set, so the host CPU needs no detection. The last register of
+// a length that is not a multiple of 4 is loaded and stored by pairs and
+// single lanes, which never touch memory beyond the element -- unless the
+// source elements are PADDED to a multiple of 4 floats, in which case the
+// whole register is loaded.
+//
+template <int COUNT>
+struct NeonLanes;
+
+template <>
+struct NeonLanes<4> {
+    static inline float32x4_t
+    load(float const * src) {
+        return vld1q_f32(src);
+    }
+    static inline void
+    store(float * dst, float32x4_t value) {
+        vst1q_f32(dst, value);
+    }
+};
+
+template <>
+struct NeonLanes<3> {
+    static inline float32x4_t
+    load(float const * src) {
+        return vld1q_lane_f32(src + 2,
+            vcombine_f32(vld1_f32(src), vdup_n_f32(0.0f)), 2);
+    }
+    static inline void
+    store(float * dst, float32x4_t value) {
+        vst1_f32(dst, vget_low_f32(value));
+        vst1q_lane_f32(dst + 2, value, 2);
+    }
+};
+
+template <>
+struct NeonLanes<2> {
+    static inline float32x4_t
+    load(float const * src) {
+        return vcombine_f32(vld1_f32(src), vdup_n_f32(0.0f));
+    }
+    static inline void
+    store(float * dst, float32x4_t value) {
+        vst1_f32(dst, vget_low_f32(value));
+    }
+};
+
+template <>
+struct NeonLanes<1> {
+    static inline float32x4_t
+    load(float const * src) {
+        return vld1q_lane_f32(src, vdupq_n_f32(0.0f), 0);
+    }
+    static inline void
+    store(float * dst, float32x4_t value) {
+        vst1q_lane_f32(dst, value, 0);
+    }
+};
+
+template <int LENGTH, bool PADDED, int NUM_OUTPUTS>
+void
+evalStencilsNeon(float const * src, int srcStride,
+                 StencilOutputs<NUM_OUTPUTS> const & out,
+                 int const * sizes, int const * indices,
+                 int numStencils) {
+
+    enum { NUM_REGISTERS = (LENGTH + 3) / 4,
+           LAST_COUNT    = LENGTH - 4 * ((LENGTH + 3) / 4 - 1),
+           LAST          = 4 * ((LENGTH + 3) / 4 - 1) };
+
+    typedef NeonLanes<PADDED ? 4 : LAST_COUNT> LastLoad;
+    typedef NeonLanes<LAST_COUNT>              LastStore;
+
+    int offset = 0;
+    for (int i = 0; i < numStencils; ++i) {
+
+        float32x4_t result[NUM_OUTPUTS][NUM_REGISTERS];
+        for (int k = 0; k < NUM_OUTPUTS; ++k) {
+            for (int r = 0; r < NUM_REGISTERS; ++r) {
+                result[k][r] = vdupq_n_f32(0.0f);
+            }
+        }
+
+        int end = offset + sizes[i];
+        for (int j = offset; j < end; ++j) {
+            float const * element = src + indices[j] * srcStride;
+
+            float32x4_t s[NUM_REGISTERS];
+            for (int r = 0; r < NUM_REGISTERS - 1; ++r) {
+                s[r] = vld1q_f32(element + 4 * r);
+            }
+            s[NUM_REGISTERS - 1] = LastLoad::load(element + LAST);
+
+            for (int k = 0; k < NUM_OUTPUTS; ++k) {
+                float32x4_t w = vld1q_dup_f32(out.weights[k] + j);
+                for (int r = 0; r < NUM_REGISTERS; ++r) {
+                    result[k][r] = vfmaq_f32(result[k][r], s[r], w);
+                }
+            }
+        }
+        offset = end;
+
+        for (int k = 0; k < NUM_OUTPUTS; ++k) {
+            float * element = out.dst[k] + i * out.dstStride[k];
+            for (int r = 0; r < NUM_REGISTERS - 1; ++r) {
+                vst1q_f32(element + 4 * r, result[k][r]);
+            }
+            LastStore::store(element + LAST, result[k][NUM_REGISTERS - 1]);
+        }
+    }
+}
+
+template <int LENGTH, int NUM_OUTPUTS>
+void
+evalStencilsNeon(float const * src, BufferDescriptor const &srcDesc,
+                 StencilOutputs<NUM_OUTPUTS> const & out,
+                 int const * sizes, int const * indices,
+                 int numStencils) {
+
+    if ((LENGTH % 4) && isPadded(srcDesc, (LENGTH + 3) & ~3)) {
+        evalStencilsNeon<LENGTH, true>(src, srcDesc.stride, out,
+                                       sizes, indices, numStencils);
+    } else {
+        evalStencilsNeon<LENGTH, false>(src, srcDesc.stride, out,
+                                        sizes, indices, numStencils);
+    }
+}
+
+template <int NUM_OUTPUTS>
+bool
+evalStencils(float const * src, BufferDescriptor const &srcDesc,
+             BufferDescriptor const * const dstDescs[NUM_OUTPUTS],
+             StencilOutputs<NUM_OUTPUTS> const & out,
+             int const * sizes, int const * indices,
+             int numStencils) {
+
+    int length = srcDesc.length;
+    for (int k = 0; k < NUM_OUTPUTS; ++k) {
+        if (dstDescs[k]->length != length) return false;
+    }
+
+#define OSD_NEON_STENCIL_CASE(LENGTH) \
+    case LENGTH: \
+        evalStencilsNeon<LENGTH>(src, srcDesc, out, \
+                                 sizes, indices, numStencils); \
+        return true;
+
+    switch (length) {
+        OSD_NEON_STENCIL_CASE(1)
+        OSD_NEON_STENCIL_CASE(2)
+        OSD_NEON_STENCIL_CASE(3)
+        OSD_NEON_STENCIL_CASE(4)
+        OSD_NEON_STENCIL_CASE(5)
+        OSD_NEON_STENCIL_CASE(6)
+        OSD_NEON_STENCIL_CASE(7)
+        OSD_NEON_STENCIL_CASE(8)
+        OSD_NEON_STENCIL_CASE(9)
+        OSD_NEON_STENCIL_CASE(10)
+        OSD_NEON_STENCIL_CASE(11)
+        OSD_NEON_STENCIL_CASE(12)
+        OSD_NEON_STENCIL_CASE(13)
+        OSD_NEON_STENCIL_CASE(14)
+        OSD_NEON_STENCIL_CASE(15)
+        OSD_NEON_STENCIL_CASE(16)
+        default:
+            break;
+    }
+#undef OSD_NEON_STENCIL_CASE
+
+    return false;
+}
+
+//
+// NEON kernel for a single component array: NEON has no gather, so the
+// source values of each stencil are loaded 4 at a time into the lanes of a
+// register, multiplied by their contiguous weights and accumulated in 4
+// independent sums.
+//
+template <bool DERIVATIVES>
+void
+evalStencilsSoaNeon(float const * src,
+                    float * dst, float * dstDu, float * dstDv,
+                    int const * sizes, int const * indices,
+                    float const * weights,
+                    float const * duWeights,
+                    float const * dvWeights,
+                    int numStencils) {
+
+    int offset = 0;
+    for (int i = 0; i < numStencils; ++i) {
+
+        float32x4_t p  = vdupq_n_f32(0.0f);
+        float32x4_t du = vdupq_n_f32(0.0f);
+        float32x4_t dv = vdupq_n_f32(0.0f);
+
+        int end = offset + sizes[i];
+        int j = offset;
+        for ( ; j + 4 <= end; j += 4) {
+            float32x4_t s = vdupq_n_f32(0.0f);
+            s = vld1q_lane_f32(src + indices[j],     s, 0);
+            s = vld1q_lane_f32(src + indices[j + 1], s, 1);
+            s = vld1q_lane_f32(src + indices[j + 2], s, 2);
+            s = vld1q_lane_f32(src + indices[j + 3], s, 3);
+
+            p = vfmaq_f32(p, s, vld1q_f32(weights + j));
+            if (DERIVATIVES) {
+                du = vfmaq_f32(du, s, vld1q_f32(duWeights + j));
+                dv = vfmaq_f32(dv, s, vld1q_f32(dvWeights + j));
+            }
+        }
+
+        float pSum  = vaddvq_f32(p);
+        float duSum = DERIVATIVES ? vaddvq_f32(du) : 0.0f;
+        float dvSum = DERIVATIVES ? vaddvq_f32(dv) : 0.0f;
+        for ( ; j < end; ++j) {
+            float s = src[indices[j]];
+            pSum += s * weights[j];
+            if (DERIVATIVES) {
+                duSum += s * duWeights[j];
+                dvSum += s * dvWeights[j];
+            }
+        }
+        offset = end;
+
+        dst[i] = pSum;
+        if (DERIVATIVES) {
+            dstDu[i] = duSum;
+            dstDv[i] = dvSum;
+        }
+    }
+}
+
+bool
+evalStencilsSoa(float const * src,
+                float * dst, float * dstDu, float * dstDv,
+                int const * sizes,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int numStencils) {
+
+    if (dstDu && dstDv) {
+        evalStencilsSoaNeon<true>(src, dst, dstDu, dstDv, sizes, indices,
+                                  weights, duWeights, dvWeights, numStencils);
+    } else {
+        evalStencilsSoaNeon<false>(src, dst, 0, 0, sizes, indices,
+                                   weights, 0, 0, numStencils);
+    }
+    return true;
+}
+
+} // end namespace
+
+#endif
+
+#if defined(OSD_CPU_SIMD_KERNELS) || defined(OSD_CPU_NEON_KERNELS)
+
+bool
+CpuEvalStencilsSimd(float const * src, BufferDescriptor const &srcDesc,
+                    float * dst,       BufferDescriptor const &dstDesc,
+                    int const * sizes,
+                    int const * indices,
+                    float const * weights,
+                    int numStencils) {
+
+    BufferDescriptor const * dstDescs[1] = { &dstDesc };
+
+    StencilOutputs<1> out;
+    out.dst[0] = dst;
+    out.dstStride[0] = dstDesc.stride;
+    out.weights[0] = weights;
+
+    return evalStencils<1>(src, srcDesc, dstDescs, out,
+                           sizes, indices, numStencils);
+}
+
+bool
+CpuEvalStencilsSimd(float const * src, BufferDescriptor const &srcDesc,
+                    float * dst,       BufferDescriptor const &dstDesc,
+                    float * dstDu,     BufferDescriptor const &dstDuDesc,
+                    float * dstDv,     BufferDescriptor const &dstDvDesc,
+                    int const * sizes,
+                    int const * indices,
+                    float const * weights,
+                    float const * duWeights,
+                    float const * dvWeights,
+                    int numStencils) {
+
+    BufferDescriptor const * dstDescs[3] = { &dstDesc, &dstDuDesc, &dstDvDesc };
+
+    StencilOutputs<3> out;
+    out.dst[0] = dst;
+    out.dst[1] = dstDu;
+    out.dst[2] = dstDv;
+    out.weights[0] = weights;
+    out.weights[1] = duWeights;
+    out.weights[2] = dvWeights;
+    for (int k = 0; k < 3; ++k) {
+        out.dstStride[k] = dstDescs[k]->stride;
+    }
+
+    return evalStencils<3>(src, srcDesc, dstDescs, out,
+                           sizes, indices, numStencils);
+}
+
+bool
+CpuEvalStencilsSimd(float const * src, BufferDescriptor const &srcDesc,
+                    float * dst,       BufferDescriptor const &dstDesc,
+                    float * dstDu,     BufferDescriptor const &dstDuDesc,
+                    float * dstDv,     BufferDescriptor const &dstDvDesc,
+                    float * dstDuu,    BufferDescriptor const &dstDuuDesc,
+                    float * dstDuv,    BufferDescriptor const &dstDuvDesc,
+                    float * dstDvv,    BufferDescriptor const &dstDvvDesc,
+                    int const * sizes,
+                    int const * indices,
+                    float const * weights,
+                    float const * duWeights,
+                    float const * dvWeights,
+                    float const * duuWeights,
+                    float const * duvWeights,
+                    float const * dvvWeights,
+                    int numStencils) {
+
+    BufferDescriptor const * dstDescs[6] = { &dstDesc, &dstDuDesc, &dstDvDesc,
+                                  &dstDuuDesc, &dstDuvDesc, &dstDvvDesc };
+
+    StencilOutputs<6> out;
+    out.dst[0] = dst;
+    out.dst[1] = dstDu;
+    out.dst[2] = dstDv;
+    out.dst[3] = dstDuu;
+    out.dst[4] = dstDuv;
+    out.dst[5] = dstDvv;
+    out.weights[0] = weights;
+    out.weights[1] = duWeights;
+    out.weights[2] = dvWeights;
+    out.weights[3] = duuWeights;
+    out.weights[4] = duvWeights;
+    out.weights[5] = dvvWeights;
+    for (int k = 0; k < 6; ++k) {
+        out.dstStride[k] = dstDescs[k]->stride;
+    }
+
+    return evalStencils<6>(src, srcDesc, dstDescs, out,
+                           sizes, indices, numStencils);
+}
+
+bool
+CpuEvalStencilsSoaSimd(float const * src,
+                       float * dst, float * dstDu, float * dstDv,
+                       int const * sizes,
+                       int const * indices,
+                       float const * weights,
+                       float const * duWeights,
+                       float const * dvWeights,
+                       int numStencils) {
+
+    return evalStencilsSoa(src, dst, dstDu, dstDv, sizes, indices,
+                           weights, duWeights, dvWeights, numStencils);
+}
+
+#else
+
+bool
+CpuEvalStencilsSimd(float const *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    int const *, int const *, float const *, int) {
+    return false;
+}
+
+bool
+CpuEvalStencilsSimd(float const *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    int const *, int const *,
+                    float const *, float const *, float const *, int) {
+    return false;
+}
+
+bool
+CpuEvalStencilsSimd(float const *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    float *, BufferDescriptor const &,
+                    int const *, int const *,
+                    float const *, float const *, float const *,
+                    float const *, float const *, float const *, int) {
+    return false;
+}
+
+bool
+CpuEvalStencilsSoaSimd(float const *, float *, float *, float *,
+                       int const *, int const *,
+                       float const *, float const *, float const *, int) {
+    return false;
+}
+
+#endif
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
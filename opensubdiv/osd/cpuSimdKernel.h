@@ -0,0 +1,114 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_OSD_CPU_SIMD_KERNEL_H
+#define OPENSUBDIV3_OSD_CPU_SIMD_KERNEL_H
+
+#include "../version.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+struct BufferDescriptor;
+
+//
+// Explicitly vectorized stencil kernels
+//
+// On x86, the instruction set (AVX2 or AVX-512) is selected at runtime from
+// the features of the host CPU. Kernels are specialized for primvar lengths
+// of 3, 4, 6 and 8 floats, and AVX-512 also handles any other length up to
+// 16. On AArch64, the NEON kernels handle any length up to 16.
+//
+// The buffers are expected to be already offset to their first element and
+// the sizes, indices and weights to the first stencil evaluated. Results of
+// stencil i are written to element i of the destination buffers.
+//
+// These return false when no vectorized kernel applies (unsupported CPU or
+// primvar length), in which case nothing has been written.
+//
+
+bool
+CpuEvalStencilsSimd(float const * src, BufferDescriptor const &srcDesc,
+                    float * dst,       BufferDescriptor const &dstDesc,
+                    int const * sizes,
+                    int const * indices,
+                    float const * weights,
+                    int numStencils);
+
+bool
+CpuEvalStencilsSimd(float const * src, BufferDescriptor const &srcDesc,
+                    float * dst,       BufferDescriptor const &dstDesc,
+                    float * dstDu,     BufferDescriptor const &dstDuDesc,
+                    float * dstDv,     BufferDescriptor const &dstDvDesc,
+                    int const * sizes,
+                    int const * indices,
+                    float const * weights,
+                    float const * duWeights,
+                    float const * dvWeights,
+                    int numStencils);
+
+bool
+CpuEvalStencilsSimd(float const * src, BufferDescriptor const &srcDesc,
+                    float * dst,       BufferDescriptor const &dstDesc,
+                    float * dstDu,     BufferDescriptor const &dstDuDesc,
+                    float * dstDv,     BufferDescriptor const &dstDvDesc,
+                    float * dstDuu,    BufferDescriptor const &dstDuuDesc,
+                    float * dstDuv,    BufferDescriptor const &dstDuvDesc,
+                    float * dstDvv,    BufferDescriptor const &dstDvvDesc,
+                    int const * sizes,
+                    int const * indices,
+                    float const * weights,
+                    float const * duWeights,
+                    float const * dvWeights,
+                    float const * duuWeights,
+                    float const * duvWeights,
+                    float const * dvvWeights,
+                    int numStencils);
+
+//
+// Stencil kernel for a single component of a primvar stored as a structure
+// of arrays (see CpuEvalStencilsSoa()) -- the source vertices of each
+// stencil are gathered 8 at a time along with their contiguous weights. The
+// derivatives are evaluated only if dstDu and dstDv are not NULL.
+//
+bool
+CpuEvalStencilsSoaSimd(float const * src,
+                       float * dst, float * dstDu, float * dstDv,
+                       int const * sizes,
+                       int const * indices,
+                       float const * weights,
+                       float const * duWeights,
+                       float const * dvWeights,
+                       int numStencils);
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_SIMD_KERNEL_H
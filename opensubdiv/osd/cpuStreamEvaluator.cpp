@@ -0,0 +1,173 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/cpuStreamEvaluator.h"
+#include "../osd/cpuKernel.h"
+#include "../far/trace.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+/* static */
+CpuStreamEvaluator::ChunkTable const *
+CpuStreamEvaluator::CreateChunkTable(const int *sizes,
+                                     const Far::Offset *offsets,
+                                     const int *indices,
+                                     int numStencils,
+                                     int maxSourceElements, int maxStencils) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stream.createChunkTable");
+
+    ChunkTable * table = new ChunkTable;
+    if (numStencils <= 0) return table;
+
+    if (maxSourceElements <= 0) maxSourceElements = INT_MAX;
+    if (maxStencils <= 0) maxStencils = INT_MAX;
+
+    int numSourceElements = 0;
+    for (int i = 0; i < numStencils; ++i) {
+        for (int j = 0; j < sizes[i]; ++j) {
+            numSourceElements = std::max(numSourceElements,
+                                         indices[offsets[i] + j] + 1);
+        }
+    }
+
+    // source elements are tagged with the last chunk and the last stencil
+    // that referenced them
+    std::vector<int> chunkTags(numSourceElements, -1);
+    std::vector<int> stencilTags(numSourceElements, -1);
+
+    Chunk chunk;
+    chunk.stencilBegin = 0;
+    chunk.sourceOffset = 0;
+    chunk.numSources = 0;
+
+    std::vector<int> & sources = table->_sources;
+    int chunkIndex = 0;
+
+    for (int i = 0; i < numStencils; ++i) {
+        int const * stencilIndices = indices + offsets[i];
+
+        int numNewSources = 0;
+        for (int j = 0; j < sizes[i]; ++j) {
+            int index = stencilIndices[j];
+            if (stencilTags[index] != i) {
+                stencilTags[index] = i;
+                numNewSources += (chunkTags[index] != chunkIndex);
+            }
+        }
+
+        if ((i - chunk.stencilBegin >= maxStencils) ||
+            ((i > chunk.stencilBegin) &&
+             (chunk.numSources + numNewSources > maxSourceElements))) {
+            // close the current chunk and start a new one with stencil i
+            chunk.stencilEnd = i;
+            std::sort(sources.begin() + chunk.sourceOffset, sources.end());
+            table->_chunks.push_back(chunk);
+
+            chunk.stencilBegin = i;
+            chunk.sourceOffset = (int)sources.size();
+            chunk.numSources = 0;
+            ++chunkIndex;
+        }
+
+        for (int j = 0; j < sizes[i]; ++j) {
+            int index = stencilIndices[j];
+            if (chunkTags[index] != chunkIndex) {
+                chunkTags[index] = chunkIndex;
+                sources.push_back(index);
+                ++chunk.numSources;
+            }
+        }
+    }
+    chunk.stencilEnd = numStencils;
+    std::sort(sources.begin() + chunk.sourceOffset, sources.end());
+    table->_chunks.push_back(chunk);
+
+    for (int i = 0; i < (int)table->_chunks.size(); ++i) {
+        table->_maxNumSources =
+            std::max(table->_maxNumSources, table->_chunks[i].numSources);
+        table->_maxNumStencils =
+            std::max(table->_maxNumStencils, table->_chunks[i].GetNumStencils());
+    }
+    return table;
+}
+
+/* static */
+bool
+CpuStreamEvaluator::EvalStencilsChunk(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    const int *sizes,
+    const Far::Offset *offsets,
+    const int *indices,
+    const float *weights,
+    ChunkTable const *chunkTable, int chunkIndex) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stream.stencils.cpu");
+
+    Chunk const & chunk = chunkTable->GetChunk(chunkIndex);
+
+    if (chunk.stencilEnd <= chunk.stencilBegin) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    // Remap the control vertex indices of the chunk to its footprint, so
+    // that the regular kernels can evaluate the chunk from its own buffers.
+    int const * sourcesBegin = chunkTable->GetChunkSources(chunkIndex);
+    int const * sourcesEnd = sourcesBegin + chunk.numSources;
+
+    Far::Offset firstEntry = offsets[chunk.stencilBegin];
+    int numEntries = (int)(offsets[chunk.stencilEnd - 1] +
+                           sizes[chunk.stencilEnd - 1] - firstEntry);
+
+    std::vector<int> chunkIndices(std::max(numEntries, 1));
+    for (int i = 0; i < numEntries; ++i) {
+        int const * source = std::lower_bound(sourcesBegin, sourcesEnd,
+                                              indices[firstEntry + i]);
+        if (source == sourcesEnd || *source != indices[firstEntry + i]) {
+            return false;
+        }
+        chunkIndices[i] = (int)(source - sourcesBegin);
+    }
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes + chunk.stencilBegin,
+                    offsets + chunk.stencilBegin,
+                    &chunkIndices[0],
+                    weights + firstEntry,
+                    0, chunk.GetNumStencils());
+
+    return true;
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,292 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_CPU_STREAM_EVALUATOR_H
+#define OPENSUBDIV3_OSD_CPU_STREAM_EVALUATOR_H
+
+#include "../version.h"
+#include "../far/types.h"
+#include "../osd/bufferDescriptor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+/// \brief Streaming evaluation of stencil tables over out-of-core primvars
+///
+/// CpuStreamEvaluator evaluates a stencil table without requiring either
+/// the source or the refined primvar data to be resident in memory:
+///
+///  - the stencils are partitioned into chunks of consecutive stencils, each
+///    of which references a bounded number of source elements (its control
+///    vertex footprint, kept sorted by index).  Stencils generated by Far
+///    are ordered by level and by topological proximity, so the footprints
+///    of consecutive chunks are compact and overlap largely.
+///
+///  - each chunk is evaluated from a buffer holding only the source elements
+///    of its footprint, into a buffer holding only its refined elements.
+///
+/// The stencil table must be factorized down to the source elements, i.e.
+/// it must not reference the elements it refines (the default for tables
+/// created by Far::StencilTableFactory without intermediate levels).
+///
+class CpuStreamEvaluator {
+public:
+    /// \brief A range of stencils and the source elements they reference
+    struct Chunk {
+        int stencilBegin, stencilEnd;  // stencils [begin, end)
+        int sourceOffset, numSources;  // footprint in ChunkTable sources
+
+        int GetNumStencils() const { return stencilEnd - stencilBegin; }
+    };
+
+    /// \brief The chunks of a stencil table and their footprints
+    class ChunkTable {
+    public:
+        int GetNumChunks() const { return (int)_chunks.size(); }
+
+        Chunk const & GetChunk(int i) const { return _chunks[i]; }
+
+        /// \brief Returns the sorted indices of the source elements of a chunk
+        int const * GetChunkSources(int i) const {
+            return _sources.empty() ? 0 : &_sources[_chunks[i].sourceOffset];
+        }
+
+        /// \brief Returns the largest footprint of the chunks
+        int GetMaxNumSources() const { return _maxNumSources; }
+
+        /// \brief Returns the largest number of stencils of the chunks
+        int GetMaxNumStencils() const { return _maxNumStencils; }
+
+    private:
+        friend class CpuStreamEvaluator;
+
+        ChunkTable() : _maxNumSources(0), _maxNumStencils(0) {}
+
+        std::vector<Chunk> _chunks;
+        std::vector<int>   _sources;
+        int _maxNumSources,
+            _maxNumStencils;
+    };
+
+    /// \brief Partitions a stencil table into chunks
+    ///
+    /// @param stencilTable       Far::StencilTable or equivalent
+    ///
+    /// @param maxSourceElements  maximum number of source elements referenced
+    ///                           by a chunk (0 for no limit).  A stencil whose
+    ///                           own footprint exceeds the limit is placed in
+    ///                           a chunk of its own.
+    ///
+    /// @param maxStencils        maximum number of stencils of a chunk
+    ///                           (0 for no limit)
+    ///
+    /// @return                   a new ChunkTable, owned by the caller
+    ///
+    template <typename STENCIL_TABLE>
+    static ChunkTable const * CreateChunkTable(
+        STENCIL_TABLE const *stencilTable,
+        int maxSourceElements, int maxStencils) {
+
+        if (stencilTable->GetNumStencils() == 0)
+            return new ChunkTable;
+
+        return CreateChunkTable(&stencilTable->GetSizes()[0],
+                                &stencilTable->GetOffsets()[0],
+                                &stencilTable->GetControlIndices()[0],
+                                stencilTable->GetNumStencils(),
+                                maxSourceElements, maxStencils);
+    }
+
+    /// \brief Partitions raw stencil buffers into chunks
+    static ChunkTable const * CreateChunkTable(
+        const int *sizes,
+        const Far::Offset *offsets,
+        const int *indices,
+        int numStencils,
+        int maxSourceElements, int maxStencils);
+
+    /// \brief Evaluates the stencils of a chunk
+    ///
+    /// @param src           Input primvar pointer to the elements of the
+    ///                      footprint of the chunk, in the order given by
+    ///                      GetChunkSources().  An offset of srcDesc will be
+    ///                      applied internally.
+    ///
+    /// @param srcDesc       vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst           Output primvar pointer to the refined elements
+    ///                      of the chunk, i.e. the first element receives
+    ///                      stencil stencilBegin of the chunk.  An offset of
+    ///                      dstDesc will be applied internally.
+    ///
+    /// @param dstDesc       vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable  Far::StencilTable or equivalent
+    ///
+    /// @param chunkTable    chunks of the stencil table
+    ///
+    /// @param chunk         index of the chunk to evaluate
+    ///
+    template <typename STENCIL_TABLE>
+    static bool EvalStencilsChunk(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        STENCIL_TABLE const *stencilTable,
+        ChunkTable const *chunkTable, int chunk) {
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalStencilsChunk(src, srcDesc, dst, dstDesc,
+                                 &stencilTable->GetSizes()[0],
+                                 &stencilTable->GetOffsets()[0],
+                                 &stencilTable->GetControlIndices()[0],
+                                 &stencilTable->GetWeights()[0],
+                                 chunkTable, chunk);
+    }
+
+    /// \brief Evaluates the stencils of a chunk from raw stencil buffers
+    static bool EvalStencilsChunk(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        const int *sizes,
+        const Far::Offset *offsets,
+        const int *indices,
+        const float *weights,
+        ChunkTable const *chunkTable, int chunk);
+
+    /// \brief Evaluates a stencil table chunk by chunk
+    ///
+    /// The source elements are requested from the reader and the refined
+    /// elements are handed to the writer one chunk at a time, so that only
+    /// the data of a single chunk (and of the footprint of the previous one)
+    /// is held in memory:
+    ///
+    ///     bool READER::Read(float *elements, int begin, int end);
+    ///     bool WRITER::Write(float const *elements, int begin, int end);
+    ///
+    /// Read() fills the source elements [begin, end) with the layout of
+    /// srcDesc (i.e. (end - begin) * srcDesc.stride floats) and is called
+    /// once per run of consecutive indices of a footprint.  Source elements
+    /// shared with the footprint of the previous chunk are kept rather than
+    /// read again.  Write() receives the refined elements [begin, end) of a
+    /// chunk with the layout of dstDesc.  Evaluation stops when either one
+    /// returns false.
+    ///
+    /// @param reader        source primvar reader
+    ///
+    /// @param srcDesc       vertex buffer descriptor for the source
+    ///
+    /// @param writer        refined primvar writer
+    ///
+    /// @param dstDesc       vertex buffer descriptor for the output
+    ///
+    /// @param stencilTable  Far::StencilTable or equivalent
+    ///
+    /// @param chunkTable    chunks of the stencil table
+    ///
+    template <typename READER, typename WRITER, typename STENCIL_TABLE>
+    static bool EvalStencils(
+        READER &reader, BufferDescriptor const &srcDesc,
+        WRITER &writer, BufferDescriptor const &dstDesc,
+        STENCIL_TABLE const *stencilTable,
+        ChunkTable const *chunkTable) {
+
+        if (srcDesc.length != dstDesc.length) return false;
+
+        int const srcStride = srcDesc.stride;
+
+        std::vector<float> srcBuffer, prevBuffer, dstBuffer;
+
+        int const * prevSources = 0;
+        int numPrevSources = 0;
+
+        for (int i = 0; i < chunkTable->GetNumChunks(); ++i) {
+            Chunk const &chunk = chunkTable->GetChunk(i);
+            int const * sources = chunkTable->GetChunkSources(i);
+
+            // (stencils of a chunk may all be empty and reference nothing)
+            srcBuffer.resize(std::max(chunk.numSources, 1) * srcStride);
+            dstBuffer.resize(chunk.GetNumStencils() * dstDesc.stride);
+
+            // gather the footprint, copying the elements shared with the
+            // previous footprint and reading runs of the missing ones
+            int prev = 0;
+            for (int j = 0; j < chunk.numSources; ) {
+                while (prev < numPrevSources && prevSources[prev] < sources[j])
+                    ++prev;
+                if (prev < numPrevSources && prevSources[prev] == sources[j]) {
+                    std::memcpy(&srcBuffer[j * srcStride],
+                                &prevBuffer[prev * srcStride],
+                                srcStride * sizeof(float));
+                    ++j;
+                    continue;
+                }
+                int runEnd = j + 1;
+                while (runEnd < chunk.numSources &&
+                       sources[runEnd] == sources[runEnd-1] + 1 &&
+                       (prev >= numPrevSources ||
+                        prevSources[prev] > sources[runEnd])) {
+                    ++runEnd;
+                }
+                if (!reader.Read(&srcBuffer[j * srcStride],
+                                 sources[j], sources[runEnd-1] + 1)) {
+                    return false;
+                }
+                j = runEnd;
+            }
+
+            if (!EvalStencilsChunk(&srcBuffer[0], srcDesc,
+                                   &dstBuffer[0], dstDesc,
+                                   stencilTable, chunkTable, i)) {
+                return false;
+            }
+            if (!writer.Write(&dstBuffer[0],
+                              chunk.stencilBegin, chunk.stencilEnd)) {
+                return false;
+            }
+
+            std::swap(srcBuffer, prevBuffer);
+            prevSources = sources;
+            numPrevSources = chunk.numSources;
+        }
+        return true;
+    }
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_STREAM_EVALUATOR_H
@@ -0,0 +1,495 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../osd/cpuTessellator.h"
+#include "../far/patchTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+const int CpuTessellator::MAX_PATCH_EDGES;
+
+namespace {
+
+//
+//  Tessellation patterns:
+//
+//  The vertices of a pattern are ordered with those of the boundary first --
+//  the rate[i] vertices of each edge i starting from its first corner -- and
+//  the interior vertices following in rows of increasing v.  The interior is
+//  a uniform grid (quads) or triangular grid (triangles) with one segment
+//  more than the vertices of its outermost ring, and each boundary edge is
+//  stitched to the side of that ring facing it.
+//
+//  There is no interior when all rates are 1 -- the pattern is then simply
+//  the corners of the patch.
+//
+inline int
+clampRate(int rate) {
+    return (rate < 1) ? 1 : rate;
+}
+
+inline bool
+isQuadPatch(Far::PatchDescriptor::Type type) {
+    return (type == Far::PatchDescriptor::QUADS) ||
+           (type == Far::PatchDescriptor::REGULAR) ||
+           (type == Far::PatchDescriptor::GREGORY_BASIS);
+}
+
+inline bool
+isTrianglePatch(Far::PatchDescriptor::Type type) {
+    return (type == Far::PatchDescriptor::TRIANGLES) ||
+           (type == Far::PatchDescriptor::LOOP) ||
+           (type == Far::PatchDescriptor::GREGORY_TRIANGLE);
+}
+
+struct PatchPattern {
+    std::vector<float> coords;  // (s,t) of each vertex
+    std::vector<int>   outer;
+    std::vector<int>   inner;
+};
+
+//
+//  Stitches the rate segments of the outer row to the (numInner - 1)
+//  segments of the inner row facing it, where inner vertex j lies at
+//  (j + 1) / n along the edge:
+//
+int *
+stitchEdge(std::vector<int> const & outer, int rate,
+           std::vector<int> const & inner, int n,
+           int * tris) {
+
+    int numInnerSegments = (int)inner.size() - 1;
+
+    int i = 0, j = 0;
+    while ((i < rate) || (j < numInnerSegments)) {
+        if ((j == numInnerSegments) ||
+            ((i < rate) && ((i + 1) * n <= (j + 2) * rate))) {
+            *tris++ = outer[i];
+            *tris++ = outer[i + 1];
+            *tris++ = inner[j];
+            ++i;
+        } else {
+            *tris++ = outer[i];
+            *tris++ = inner[j + 1];
+            *tris++ = inner[j];
+            ++j;
+        }
+    }
+    return tris;
+}
+
+void
+getQuadSize(int const edgeRates[], int * numVertices, int * numTriangles) {
+
+    int r0 = clampRate(edgeRates[0]), r1 = clampRate(edgeRates[1]),
+        r2 = clampRate(edgeRates[2]), r3 = clampRate(edgeRates[3]);
+
+    if ((r0 == 1) && (r1 == 1) && (r2 == 1) && (r3 == 1)) {
+        *numVertices = 4;
+        *numTriangles = 2;
+        return;
+    }
+
+    int nu = std::max(2, std::max(r0, r2));
+    int nv = std::max(2, std::max(r1, r3));
+
+    *numVertices  = r0 + r1 + r2 + r3 + (nu - 1) * (nv - 1);
+    *numTriangles = r0 + r1 + r2 + r3 + 2 * (nu - 2) * (nv - 2)
+                  + 2 * (nu - 2) + 2 * (nv - 2);
+}
+
+void
+getTriangleSize(int const edgeRates[], int * numVertices, int * numTriangles) {
+
+    int r0 = clampRate(edgeRates[0]), r1 = clampRate(edgeRates[1]),
+        r2 = clampRate(edgeRates[2]);
+
+    if ((r0 == 1) && (r1 == 1) && (r2 == 1)) {
+        *numVertices = 3;
+        *numTriangles = 1;
+        return;
+    }
+
+    int n = std::max(3, std::max(r0, std::max(r1, r2)));
+
+    *numVertices  = r0 + r1 + r2 + (n - 2) * (n - 1) / 2;
+    *numTriangles = r0 + r1 + r2 + (n - 3) * (n - 3) + 3 * (n - 3);
+}
+
+void
+tessellateQuad(int const edgeRates[], PatchPattern & pattern, int * tris) {
+
+    int r[4];
+    for (int e = 0; e < 4; ++e) r[e] = clampRate(edgeRates[e]);
+
+    std::vector<float> & st = pattern.coords;
+    st.clear();
+
+    if ((r[0] == 1) && (r[1] == 1) && (r[2] == 1) && (r[3] == 1)) {
+        static float const corners[8] = { 0, 0, 1, 0, 1, 1, 0, 1 };
+        st.assign(corners, corners + 8);
+        static int const cornerTris[6] = { 0, 1, 2, 0, 2, 3 };
+        std::copy(cornerTris, cornerTris + 6, tris);
+        return;
+    }
+
+    int nu = std::max(2, std::max(r[0], r[2]));
+    int nv = std::max(2, std::max(r[1], r[3]));
+
+    //  Boundary vertices, counter-clockwise from (0,0):
+    int edgeStart[5];
+    edgeStart[0] = 0;
+    for (int e = 0; e < 4; ++e) {
+        edgeStart[e + 1] = edgeStart[e] + r[e];
+        for (int k = 0; k < r[e]; ++k) {
+            float t = (float)k / (float)r[e];
+            switch (e) {
+                case 0: st.push_back(t);        st.push_back(0.0f);     break;
+                case 1: st.push_back(1.0f);     st.push_back(t);        break;
+                case 2: st.push_back(1.0f - t); st.push_back(1.0f);     break;
+                case 3: st.push_back(0.0f);     st.push_back(1.0f - t); break;
+            }
+        }
+    }
+
+    //  Interior vertices (i,j) for 0 < i < nu, 0 < j < nv:
+    int innerStart = edgeStart[4];
+    for (int j = 1; j < nv; ++j) {
+        for (int i = 1; i < nu; ++i) {
+            st.push_back((float)i / (float)nu);
+            st.push_back((float)j / (float)nv);
+        }
+    }
+#define INNER(i, j) (innerStart + ((j) - 1) * (nu - 1) + ((i) - 1))
+
+    for (int e = 0; e < 4; ++e) {
+        std::vector<int> & outer = pattern.outer;
+        outer.resize(r[e] + 1);
+        for (int k = 0; k < r[e]; ++k) {
+            outer[k] = edgeStart[e] + k;
+        }
+        outer[r[e]] = edgeStart[(e + 1) % 4];
+
+        std::vector<int> & inner = pattern.inner;
+        int n = (e & 1) ? nv : nu;
+        inner.resize(n - 1);
+        for (int k = 0; k < n - 1; ++k) {
+            switch (e) {
+                case 0: inner[k] = INNER(1 + k, 1);           break;
+                case 1: inner[k] = INNER(nu - 1, 1 + k);      break;
+                case 2: inner[k] = INNER(nu - 1 - k, nv - 1); break;
+                case 3: inner[k] = INNER(1, nv - 1 - k);      break;
+            }
+        }
+        tris = stitchEdge(outer, r[e], inner, n, tris);
+    }
+
+    for (int j = 1; j < nv - 1; ++j) {
+        for (int i = 1; i < nu - 1; ++i) {
+            int v00 = INNER(i, j),     v10 = INNER(i + 1, j),
+                v11 = INNER(i + 1, j + 1), v01 = INNER(i, j + 1);
+            *tris++ = v00; *tris++ = v10; *tris++ = v11;
+            *tris++ = v00; *tris++ = v11; *tris++ = v01;
+        }
+    }
+#undef INNER
+}
+
+void
+tessellateTriangle(int const edgeRates[], PatchPattern & pattern, int * tris) {
+
+    int r[3];
+    for (int e = 0; e < 3; ++e) r[e] = clampRate(edgeRates[e]);
+
+    std::vector<float> & st = pattern.coords;
+    st.clear();
+
+    if ((r[0] == 1) && (r[1] == 1) && (r[2] == 1)) {
+        static float const corners[6] = { 0, 0, 1, 0, 0, 1 };
+        st.assign(corners, corners + 6);
+        tris[0] = 0; tris[1] = 1; tris[2] = 2;
+        return;
+    }
+
+    int n = std::max(3, std::max(r[0], std::max(r[1], r[2])));
+
+    //  Boundary vertices, counter-clockwise from (0,0):
+    int edgeStart[4];
+    edgeStart[0] = 0;
+    for (int e = 0; e < 3; ++e) {
+        edgeStart[e + 1] = edgeStart[e] + r[e];
+        for (int k = 0; k < r[e]; ++k) {
+            float t = (float)k / (float)r[e];
+            switch (e) {
+                case 0: st.push_back(t);        st.push_back(0.0f);     break;
+                case 1: st.push_back(1.0f - t); st.push_back(t);        break;
+                case 2: st.push_back(0.0f);     st.push_back(1.0f - t); break;
+            }
+        }
+    }
+
+    //  Interior vertices (i,j) for 0 < i, 0 < j and i + j < n:
+    int innerStart = edgeStart[3];
+    for (int j = 1; j < n - 1; ++j) {
+        for (int i = 1; i < n - j; ++i) {
+            st.push_back((float)i / (float)n);
+            st.push_back((float)j / (float)n);
+        }
+    }
+#define INNER(i, j) \
+    (innerStart + ((j) - 1) * (n - 1) - ((j) - 1) * (j) / 2 + ((i) - 1))
+
+    for (int e = 0; e < 3; ++e) {
+        std::vector<int> & outer = pattern.outer;
+        outer.resize(r[e] + 1);
+        for (int k = 0; k < r[e]; ++k) {
+            outer[k] = edgeStart[e] + k;
+        }
+        outer[r[e]] = edgeStart[(e + 1) % 3];
+
+        std::vector<int> & inner = pattern.inner;
+        inner.resize(n - 2);
+        for (int k = 0; k < n - 2; ++k) {
+            switch (e) {
+                case 0: inner[k] = INNER(1 + k, 1);         break;
+                case 1: inner[k] = INNER(n - 2 - k, 1 + k); break;
+                case 2: inner[k] = INNER(1, n - 2 - k);     break;
+            }
+        }
+        tris = stitchEdge(outer, r[e], inner, n, tris);
+    }
+
+    for (int j = 1; j < n - 2; ++j) {
+        for (int i = 1; i < n - 1 - j; ++i) {
+            *tris++ = INNER(i, j);
+            *tris++ = INNER(i + 1, j);
+            *tris++ = INNER(i, j + 1);
+            if (i + j < n - 2) {
+                *tris++ = INNER(i + 1, j);
+                *tris++ = INNER(i + 1, j + 1);
+                *tris++ = INNER(i, j + 1);
+            }
+        }
+    }
+#undef INNER
+}
+
+} // end namespace
+
+/* static */
+void
+CpuTessellator::GetPatchTessellationSize(int numEdges, int const edgeRates[],
+                                         int * numVertices,
+                                         int * numTriangles) {
+    if (numEdges == 3) {
+        getTriangleSize(edgeRates, numVertices, numTriangles);
+    } else {
+        getQuadSize(edgeRates, numVertices, numTriangles);
+    }
+}
+
+/* static */
+bool
+CpuTessellator::ComputeOffsets(Far::PatchTable const & patchTable,
+                               int const * edgeRates,
+                               int * vertexOffsets,
+                               int * triangleOffsets) {
+
+    int patch = 0;
+    vertexOffsets[0] = 0;
+    triangleOffsets[0] = 0;
+
+    for (int array = 0; array < patchTable.GetNumPatchArrays(); ++array) {
+        Far::PatchDescriptor::Type type =
+            patchTable.GetPatchArrayDescriptor(array).GetType();
+
+        int numEdges = isQuadPatch(type) ? 4 : (isTrianglePatch(type) ? 3 : 0);
+        if (numEdges == 0) return false;
+
+        for (int i = 0; i < patchTable.GetNumPatches(array); ++i, ++patch) {
+            int numVertices = 0, numTriangles = 0;
+            GetPatchTessellationSize(numEdges,
+                                     edgeRates + patch * MAX_PATCH_EDGES,
+                                     &numVertices, &numTriangles);
+            vertexOffsets[patch + 1] = vertexOffsets[patch] + numVertices;
+            triangleOffsets[patch + 1] = triangleOffsets[patch] + numTriangles;
+        }
+    }
+    return true;
+}
+
+/* static */
+bool
+CpuTessellator::Tessellate(Far::PatchTable const & patchTable,
+                           float const * src, BufferDescriptor const & srcDesc,
+                           int const * edgeRates,
+                           int const * vertexOffsets,
+                           int const * triangleOffsets,
+                           float * dst,       BufferDescriptor const & dstDesc,
+                           float * normals,   BufferDescriptor const & normalDesc,
+                           float * uvs,       BufferDescriptor const & uvDesc,
+                           int * triangles,
+                           Options options) {
+
+    if (srcDesc.length != dstDesc.length) return false;
+    if (normals && ((normalDesc.length != 3) || (srcDesc.length < 3))) {
+        return false;
+    }
+    if (uvs && (uvDesc.length != 2)) return false;
+
+    //  Gather the handles of all patches:
+    int numPatches = patchTable.GetNumPatchesTotal();
+    if (numPatches == 0) return true;
+
+    std::vector<Far::PatchTable::PatchHandle> handles(numPatches);
+    for (int array = 0, patch = 0; array < patchTable.GetNumPatchArrays();
+         ++array) {
+        Far::PatchDescriptor desc = patchTable.GetPatchArrayDescriptor(array);
+        if (!isQuadPatch(desc.GetType()) && !isTrianglePatch(desc.GetType())) {
+            return false;
+        }
+        int numCVs = desc.GetNumControlVertices();
+        for (int i = 0; i < patchTable.GetNumPatches(array); ++i, ++patch) {
+            handles[patch].arrayIndex = array;
+            handles[patch].patchIndex = patch;
+            handles[patch].vertIndex = i * numCVs;
+        }
+    }
+
+    src += srcDesc.offset;
+    if (dst) dst += dstDesc.offset;
+    if (normals) normals += normalDesc.offset;
+    if (uvs) uvs += uvDesc.offset;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = std::max(1, (int)options.numThreads);
+    #pragma omp parallel num_threads(numThreads) if (numThreads > 1)
+#else
+    (void)options;
+#endif
+    {
+        PatchPattern pattern;
+        std::vector<float> result(srcDesc.length + 6);
+
+        float * p  = &result[0];
+        float * du = p + srcDesc.length;
+        float * dv = du + 3;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp for schedule(dynamic, 16)
+#endif
+        for (int patch = 0; patch < numPatches; ++patch) {
+            Far::PatchTable::PatchHandle const & handle = handles[patch];
+
+            Far::PatchDescriptor::Type type =
+                patchTable.GetPatchArrayDescriptor(handle.arrayIndex).GetType();
+            bool isTriangle = isTrianglePatch(type);
+
+            int * patchTris = triangles + 3 * triangleOffsets[patch];
+            if (isTriangle) {
+                tessellateTriangle(edgeRates + patch * MAX_PATCH_EDGES,
+                                   pattern, patchTris);
+            } else {
+                tessellateQuad(edgeRates + patch * MAX_PATCH_EDGES,
+                               pattern, patchTris);
+            }
+
+            int vertexBase = vertexOffsets[patch];
+            int numVertices = (int)pattern.coords.size() / 2;
+            int numTriangles = triangleOffsets[patch + 1] -
+                               triangleOffsets[patch];
+            for (int i = 0; i < 3 * numTriangles; ++i) {
+                patchTris[i] += vertexBase;
+            }
+
+            Far::PatchParam param = patchTable.GetPatchParam(handle);
+            Far::ConstIndexArray cvs = patchTable.GetPatchVertices(handle);
+
+            for (int i = 0; i < numVertices; ++i) {
+                float u = pattern.coords[2 * i];
+                float v = pattern.coords[2 * i + 1];
+                if (isTriangle) {
+                    param.UnnormalizeTriangle(u, v);
+                } else {
+                    param.Unnormalize(u, v);
+                }
+
+                float wP[20], wDu[20], wDv[20];
+                patchTable.EvaluateBasis(handle, u, v, wP,
+                                         normals ? wDu : 0,
+                                         normals ? wDv : 0);
+
+                std::fill(result.begin(), result.end(), 0.0f);
+                for (int j = 0; j < cvs.size(); ++j) {
+                    float const * cv = src + cvs[j] * srcDesc.stride;
+                    for (int k = 0; k < srcDesc.length; ++k) {
+                        p[k] += wP[j] * cv[k];
+                    }
+                    if (normals) {
+                        for (int k = 0; k < 3; ++k) {
+                            du[k] += wDu[j] * cv[k];
+                            dv[k] += wDv[j] * cv[k];
+                        }
+                    }
+                }
+
+                int vertex = vertexBase + i;
+                if (dst) {
+                    std::copy(p, p + srcDesc.length,
+                              dst + vertex * dstDesc.stride);
+                }
+                if (normals) {
+                    float n[3] = { du[1] * dv[2] - du[2] * dv[1],
+                                   du[2] * dv[0] - du[0] * dv[2],
+                                   du[0] * dv[1] - du[1] * dv[0] };
+                    float len = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+                    float scale = (len > 0.0f) ? (1.0f / len) : 0.0f;
+
+                    float * dstNormal = normals + vertex * normalDesc.stride;
+                    dstNormal[0] = n[0] * scale;
+                    dstNormal[1] = n[1] * scale;
+                    dstNormal[2] = n[2] * scale;
+                }
+                if (uvs) {
+                    float * dstUV = uvs + vertex * uvDesc.stride;
+                    dstUV[0] = u;
+                    dstUV[1] = v;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
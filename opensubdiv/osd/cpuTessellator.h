@@ -0,0 +1,182 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_OSD_CPU_TESSELLATOR_H
+#define OPENSUBDIV3_OSD_CPU_TESSELLATOR_H
+
+#include "../version.h"
+#include "../osd/bufferDescriptor.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class PatchTable;
+}
+
+namespace Osd {
+
+/// \brief Tessellates the limit surface of a PatchTable into triangles on
+///        the CPU
+///
+/// Each patch is tessellated independently from a rate (a number of
+/// segments) for each of its edges, where edge i of a patch runs from its
+/// corner i to corner i+1 in the parameterization of the patch, i.e. from
+/// (0,0) to (1,0), (1,1) and (0,1) for quads and to (1,0) and (0,1) for
+/// triangles.  The interior of the patch is tessellated uniformly with the
+/// largest rate of the opposing edges and stitched to the vertices of each
+/// edge, so that when adjacent patches are given the same rate for the edge
+/// they share, the vertices along that edge are evaluated at the same
+/// locations of the limit surface and the tessellation is free of cracks.
+///
+/// Usage is in two passes: ComputeOffsets() returns the number of vertices
+/// and triangles of each patch, from which the client allocates the output
+/// buffers, and Tessellate() evaluates and writes them.
+///
+class CpuTessellator {
+public:
+    struct Options {
+
+        Options() : numThreads(0) { }
+
+        unsigned int numThreads : 8; ///< Number of threads used to evaluate
+                                     ///< patches concurrently (requires
+                                     ///< OpenMP support, ignored otherwise)
+    };
+
+    /// \brief Maximum number of edges of a patch, i.e. the stride of the
+    ///        per-patch edge rates
+    static const int MAX_PATCH_EDGES = 4;
+
+    /// \brief Returns the number of vertices and triangles of a patch
+    ///
+    /// @param numEdges       3 for triangular patches, 4 for quads
+    ///
+    /// @param edgeRates      the number of segments of each edge (values
+    ///                       less than 1 are treated as 1)
+    ///
+    /// @param numVertices    returned number of vertices
+    ///
+    /// @param numTriangles   returned number of triangles
+    ///
+    static void GetPatchTessellationSize(int numEdges, int const edgeRates[],
+                                         int * numVertices,
+                                         int * numTriangles);
+
+    /// \brief Computes the offsets of the vertices and triangles of each
+    ///        patch in the output of Tessellate()
+    ///
+    /// @param patchTable       the patch table to tessellate
+    ///
+    /// @param edgeRates        MAX_PATCH_EDGES rates for each patch of the
+    ///                         table, in order of the patches over all patch
+    ///                         arrays (the last rate of triangular patches
+    ///                         is ignored)
+    ///
+    /// @param vertexOffsets    returned offsets of the vertices of each patch
+    ///                         (numPatches + 1 entries, the last one being the
+    ///                         total number of vertices)
+    ///
+    /// @param triangleOffsets  returned offsets of the triangles of each
+    ///                         patch (numPatches + 1 entries, the last one
+    ///                         being the total number of triangles)
+    ///
+    /// @return                 false if the table contains patches that
+    ///                         cannot be tessellated (points, lines or
+    ///                         legacy Gregory patches)
+    ///
+    static bool ComputeOffsets(Far::PatchTable const & patchTable,
+                               int const * edgeRates,
+                               int * vertexOffsets,
+                               int * triangleOffsets);
+
+    /// \brief Evaluates and writes the tessellation of all patches
+    ///
+    /// @param patchTable       the patch table to tessellate
+    ///
+    /// @param src              Input primvar pointer with the control
+    ///                         vertices and local points of the patch table.
+    ///                         An offset of srcDesc will be applied
+    ///                         internally (i.e. the pointer should not
+    ///                         include the offset)
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param edgeRates        rates of the edges of each patch, as given to
+    ///                         ComputeOffsets()
+    ///
+    /// @param vertexOffsets    vertex offsets returned by ComputeOffsets()
+    ///
+    /// @param triangleOffsets  triangle offsets returned by ComputeOffsets()
+    ///
+    /// @param dst              Output primvar pointer for the limit position
+    ///                         of each vertex. An offset of dstDesc will be
+    ///                         applied internally.
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///                         (its length must match that of srcDesc)
+    ///
+    /// @param normals          Output pointer for the unit normal of each
+    ///                         vertex, computed from the first three
+    ///                         components of the primvar (can be NULL)
+    ///
+    /// @param normalDesc       vertex buffer descriptor for the normals
+    ///                         (its length must be 3)
+    ///
+    /// @param uvs              Output pointer for the (u,v) location of each
+    ///                         vertex in the parameterization of its base
+    ///                         face (can be NULL)
+    ///
+    /// @param uvDesc           vertex buffer descriptor for the uvs (its
+    ///                         length must be 2)
+    ///
+    /// @param triangles        Output pointer for the three vertex indices of
+    ///                         each triangle, counter-clockwise with respect
+    ///                         to the parameterization of the patch
+    ///
+    /// @param options          options controlling tessellation
+    ///
+    /// @return                 false if the descriptors mismatch or the table
+    ///                         contains patches that cannot be tessellated
+    ///
+    static bool Tessellate(Far::PatchTable const & patchTable,
+                           float const * src, BufferDescriptor const & srcDesc,
+                           int const * edgeRates,
+                           int const * vertexOffsets,
+                           int const * triangleOffsets,
+                           float * dst,       BufferDescriptor const & dstDesc,
+                           float * normals,   BufferDescriptor const & normalDesc,
+                           float * uvs,       BufferDescriptor const & uvDesc,
+                           int * triangles,
+                           Options options = Options());
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_TESSELLATOR_H
@@ -24,24 +24,63 @@
 
 #include "../osd/cpuVertexBuffer.h"
 
+#include <cstdlib>
 #include <string.h>
 
+#if defined(_WIN32)
+    #include <malloc.h>
+#endif
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
 namespace Osd {
 
-CpuVertexBuffer::CpuVertexBuffer(int numElements, int numVertices)
+namespace {
+    float *
+    allocateAligned(size_t size, int alignment) {
+#if defined(_WIN32)
+        return static_cast<float *>(_aligned_malloc(size, alignment));
+#else
+        void * ptr = NULL;
+        if (posix_memalign(&ptr, alignment, size) != 0) return NULL;
+        return static_cast<float *>(ptr);
+#endif
+    }
+
+    void
+    freeAligned(float * ptr) {
+#if defined(_WIN32)
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+    }
+}
+
+CpuVertexBuffer::CpuVertexBuffer(int numElements, int numVertices,
+                                 int alignment)
     : _numElements(numElements),
       _numVertices(numVertices),
+      _alignment(alignment),
       _cpuBuffer(NULL) {
 
-    _cpuBuffer = new float[numElements * numVertices];
+    if (_alignment > 0) {
+        //  Never allocate 0 bytes, which may return NULL
+        size_t size = (size_t)numElements * numVertices * sizeof(float);
+        _cpuBuffer = allocateAligned(size ? size : sizeof(float), alignment);
+    } else {
+        _cpuBuffer = new float[numElements * numVertices];
+    }
 }
 
 CpuVertexBuffer::~CpuVertexBuffer() {
 
-    delete[] _cpuBuffer;
+    if (_alignment > 0) {
+        freeAligned(_cpuBuffer);
+    } else {
+        delete[] _cpuBuffer;
+    }
 }
 
 CpuVertexBuffer *
@@ -51,6 +90,24 @@ CpuVertexBuffer::Create(int numElements, int numVertices,
     return new CpuVertexBuffer(numElements, numVertices);
 }
 
+CpuVertexBuffer *
+CpuVertexBuffer::CreateAligned(int numElements, int numVertices,
+                               int alignment, void * /*deviceContext*/) {
+
+    //  The alignment must be a power of 2 multiple of the size of a pointer
+    if (alignment < (int)sizeof(void *) || (alignment & (alignment - 1))) {
+        return NULL;
+    }
+
+    CpuVertexBuffer * instance =
+        new CpuVertexBuffer(numElements, numVertices, alignment);
+    if (!instance->_cpuBuffer) {
+        delete instance;
+        return NULL;
+    }
+    return instance;
+}
+
 void
 CpuVertexBuffer::UpdateData(const float *src, int startVertex, int numVertices,
                             void * /*deviceContext*/) {
@@ -71,6 +128,12 @@ CpuVertexBuffer::GetNumVertices() const {
     return _numVertices;
 }
 
+int
+CpuVertexBuffer::GetAlignment() const {
+
+    return _alignment;
+}
+
 float*
 CpuVertexBuffer::BindCpuBuffer() {
 
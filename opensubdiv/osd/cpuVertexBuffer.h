@@ -45,6 +45,20 @@ public:
     static CpuVertexBuffer * Create(int numElements, int numVertices,
                                     void *deviceContext = NULL);
 
+    /// \brief Creator of a buffer aligned for the vectorized kernels.
+    /// Returns NULL if error.
+    ///
+    /// The buffer is allocated at an \p alignment in bytes (a power of 2,
+    /// e.g. 32 or 64 for AVX2 or AVX-512 cache lines). Elements can also
+    /// be padded, e.g. 4 elements per vertex for XYZ positions described
+    /// by BufferDescriptor(0, 3, 4), which lets CpuEvaluator load whole
+    /// vectors of the primvars instead of masking them. The padding is
+    /// only read and never written by the evaluation.
+    ///
+    static CpuVertexBuffer * CreateAligned(int numElements, int numVertices,
+                                           int alignment,
+                                           void *deviceContext = NULL);
+
     /// Destructor.
     ~CpuVertexBuffer();
 
@@ -59,16 +73,20 @@ public:
     /// Returns how many vertices allocated in this vertex buffer.
     int GetNumVertices() const;
 
+    /// Returns the alignment of the buffer in bytes (0 if default).
+    int GetAlignment() const;
+
     /// Returns the address of CPU buffer
     float * BindCpuBuffer();
 
 protected:
     /// Constructor.
-    CpuVertexBuffer(int numElements, int numVertices);
+    CpuVertexBuffer(int numElements, int numVertices, int alignment = 0);
 
 private:
     int _numElements;
     int _numVertices;
+    int _alignment;
     float *_cpuBuffer;
 };
 
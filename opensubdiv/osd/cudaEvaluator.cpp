@@ -28,6 +28,7 @@
 #include <vector>
 
 #include "../far/stencilTable.h"
+#include "../osd/stencilOffsets.h"
 #include "../osd/types.h"
 
 extern "C" {
@@ -95,6 +96,17 @@ createCudaBuffer(std::vector<T> const & src) {
     return devicePtr;
 }
 
+#ifdef OPENSUBDIV_64BIT_OFFSETS
+// The kernels address the stencil tables with 32-bit offsets (tables
+// exceeding them are rejected)
+static void *
+createCudaBuffer(std::vector<Far::Offset> const & src) {
+    std::vector<int> offsets;
+    if (! internal::NarrowStencilOffsets(src, offsets)) return 0;
+    return createCudaBuffer(offsets);
+}
+#endif
+
 // ----------------------------------------------------------------------------
 
 CudaStencilTable::CudaStencilTable(Far::StencilTable const *stencilTable) {
@@ -36,6 +36,7 @@
 
 #include "../far/error.h"
 #include "../far/stencilTable.h"
+#include "../osd/stencilOffsets.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -91,6 +92,17 @@ static ID3D11Buffer *createBuffer(std::vector<T> const &src,
     return buffer;
 }
 
+#ifdef OPENSUBDIV_64BIT_OFFSETS
+// The kernels address the stencil tables with 32-bit offsets (tables
+// exceeding them are rejected)
+static ID3D11Buffer *createBuffer(std::vector<Far::Offset> const &src,
+                                  ID3D11Device *device) {
+    std::vector<int> offsets;
+    if (! internal::NarrowStencilOffsets(src, offsets)) return NULL;
+    return createBuffer(offsets, device);
+}
+#endif
+
 static ID3D11ShaderResourceView *createSRV(ID3D11Buffer *buffer,
                                            DXGI_FORMAT format,
                                            ID3D11Device *device,
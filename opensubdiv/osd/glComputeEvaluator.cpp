@@ -25,11 +25,15 @@
 #include "glLoader.h"
 
 #include "../osd/glComputeEvaluator.h"
+#include "../osd/glProgramBinaryCache.h"
 #include "../osd/glslPatchShaderSource.h"
 
 #include "../far/error.h"
 #include "../far/stencilTable.h"
+#include "../osd/stencilOffsets.h"
+#include "../osd/cpuCompactStencilTable.h"
 
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 #include <string>
@@ -46,10 +50,13 @@ static const char *shaderSource =
 ;
 
 template <class T> GLuint
-createSSBO(std::vector<T> const & src) {
+createSSBO(std::vector<T> const & src, size_t *memoryUsage = NULL) {
     if (src.empty()) {
         return 0;
     }
+    if (memoryUsage) {
+        *memoryUsage += src.size()*sizeof(T);
+    }
 
     GLuint devicePtr = 0;
 
@@ -73,43 +80,100 @@ createSSBO(std::vector<T> const & src) {
     return devicePtr;
 }
 
+#ifdef OPENSUBDIV_64BIT_OFFSETS
+// The kernels address the stencil tables with 32-bit offsets (tables
+// exceeding them are rejected)
+static GLuint
+createSSBO(std::vector<Far::Offset> const & src, size_t *memoryUsage = NULL) {
+    std::vector<int> offsets;
+    if (! internal::NarrowStencilOffsets(src, offsets)) return 0;
+    return createSSBO(offsets, memoryUsage);
+}
+#endif
+
+// stencils of at least this size are evaluated by the cooperative kernel,
+// each by this number of invocations
+static const int cooperativeStencilSize = 16;
+static const int cooperativeLanes = 8;
+
 GLStencilTableSSBO::GLStencilTableSSBO(
     Far::StencilTable const *stencilTable) {
     _numStencils = stencilTable->GetNumStencils();
+    _numControlVertices = stencilTable->GetNumControlVertices();
+    _memoryUsage = 0;
     if (_numStencils > 0) {
-        _sizes   = createSSBO(stencilTable->GetSizes());
-        _offsets = createSSBO(stencilTable->GetOffsets());
-        _indices = createSSBO(stencilTable->GetControlIndices());
-        _weights = createSSBO(stencilTable->GetWeights());
+        _sizes   = createSSBO(stencilTable->GetSizes(), &_memoryUsage);
+        _offsets = createSSBO(stencilTable->GetOffsets(), &_memoryUsage);
+        _indices = createSSBO(stencilTable->GetControlIndices(), &_memoryUsage);
+        _weights = createSSBO(stencilTable->GetWeights(), &_memoryUsage);
         _duWeights = _dvWeights = 0;
         _duuWeights = _duvWeights = _dvvWeights = 0;
+        createSortedIndices(stencilTable->GetSizes());
     } else {
         _sizes = _offsets = _indices = _weights = 0;
         _duWeights = _dvWeights = 0;
         _duuWeights = _duvWeights = _dvvWeights = 0;
+        _sortedIndices = 0;
+        _numCooperativeStencils = 0;
     }
 }
 
 GLStencilTableSSBO::GLStencilTableSSBO(
     Far::LimitStencilTable const *limitStencilTable) {
     _numStencils = limitStencilTable->GetNumStencils();
+    _numControlVertices = limitStencilTable->GetNumControlVertices();
+    _memoryUsage = 0;
     if (_numStencils > 0) {
-        _sizes   = createSSBO(limitStencilTable->GetSizes());
-        _offsets = createSSBO(limitStencilTable->GetOffsets());
-        _indices = createSSBO(limitStencilTable->GetControlIndices());
-        _weights = createSSBO(limitStencilTable->GetWeights());
-        _duWeights = createSSBO(limitStencilTable->GetDuWeights());
-        _dvWeights = createSSBO(limitStencilTable->GetDvWeights());
-        _duuWeights = createSSBO(limitStencilTable->GetDuuWeights());
-        _duvWeights = createSSBO(limitStencilTable->GetDuvWeights());
-        _dvvWeights = createSSBO(limitStencilTable->GetDvvWeights());
+        _sizes   = createSSBO(limitStencilTable->GetSizes(), &_memoryUsage);
+        _offsets = createSSBO(limitStencilTable->GetOffsets(), &_memoryUsage);
+        _indices = createSSBO(limitStencilTable->GetControlIndices(), &_memoryUsage);
+        _weights = createSSBO(limitStencilTable->GetWeights(), &_memoryUsage);
+        _duWeights = createSSBO(limitStencilTable->GetDuWeights(), &_memoryUsage);
+        _dvWeights = createSSBO(limitStencilTable->GetDvWeights(), &_memoryUsage);
+        _duuWeights = createSSBO(limitStencilTable->GetDuuWeights(), &_memoryUsage);
+        _duvWeights = createSSBO(limitStencilTable->GetDuvWeights(), &_memoryUsage);
+        _dvvWeights = createSSBO(limitStencilTable->GetDvvWeights(), &_memoryUsage);
+        createSortedIndices(limitStencilTable->GetSizes());
     } else {
         _sizes = _offsets = _indices = _weights = 0;
         _duWeights = _dvWeights = 0;
         _duuWeights = _duvWeights = _dvvWeights = 0;
+        _sortedIndices = 0;
+        _numCooperativeStencils = 0;
     }
 }
 
+void
+GLStencilTableSSBO::createSortedIndices(std::vector<int> const &sizes) {
+
+    _sortedIndices = 0;
+    _numCooperativeStencils = 0;
+
+    // tables of uniformly small stencils keep their natural order
+    int maxSize = 0;
+    for (int i = 0; i < _numStencils; ++i) {
+        maxSize = std::max(maxSize, sizes[i]);
+    }
+    if (maxSize < cooperativeStencilSize) return;
+
+    // counting sort of the stencils by decreasing size, which keeps the
+    // stencils of similar sizes (and so similar work) in the same subgroups
+    std::vector<int> starts(maxSize + 2, 0);
+    for (int i = 0; i < _numStencils; ++i) {
+        ++starts[maxSize - sizes[i] + 1];
+    }
+    for (int size = 0; size <= maxSize; ++size) {
+        starts[size + 1] += starts[size];
+    }
+    _numCooperativeStencils = starts[maxSize - cooperativeStencilSize + 1];
+
+    std::vector<int> sortedIndices(_numStencils);
+    for (int i = 0; i < _numStencils; ++i) {
+        sortedIndices[starts[maxSize - sizes[i]]++] = i;
+    }
+    _sortedIndices = createSSBO(sortedIndices, &_memoryUsage);
+}
+
 GLStencilTableSSBO::~GLStencilTableSSBO() {
     if (_sizes)   glDeleteBuffers(1, &_sizes);
     if (_offsets) glDeleteBuffers(1, &_offsets);
@@ -120,6 +184,33 @@ GLStencilTableSSBO::~GLStencilTableSSBO() {
     if (_duuWeights) glDeleteBuffers(1, &_duuWeights);
     if (_duvWeights) glDeleteBuffers(1, &_duvWeights);
     if (_dvvWeights) glDeleteBuffers(1, &_dvvWeights);
+    if (_sortedIndices) glDeleteBuffers(1, &_sortedIndices);
+}
+
+// ---------------------------------------------------------------------------
+
+GLCompactStencilTableSSBO::GLCompactStencilTableSSBO(
+    Far::StencilTable const *stencilTable) {
+    _numStencils = stencilTable->GetNumStencils();
+    if (_numStencils > 0) {
+        CpuCompactStencilTable compactTable(stencilTable);
+
+        _sizes       = createSSBO(compactTable.GetSizes());
+        _offsets     = createSSBO(compactTable.GetOffsets());
+        _baseIndices = createSSBO(compactTable.GetBaseIndices());
+        _scales      = createSSBO(compactTable.GetScales());
+        _entries     = createSSBO(compactTable.GetEntries());
+    } else {
+        _sizes = _offsets = _baseIndices = _scales = _entries = 0;
+    }
+}
+
+GLCompactStencilTableSSBO::~GLCompactStencilTableSSBO() {
+    if (_sizes)       glDeleteBuffers(1, &_sizes);
+    if (_offsets)     glDeleteBuffers(1, &_offsets);
+    if (_baseIndices) glDeleteBuffers(1, &_baseIndices);
+    if (_scales)      glDeleteBuffers(1, &_scales);
+    if (_entries)     glDeleteBuffers(1, &_entries);
 }
 
 // ---------------------------------------------------------------------------
@@ -128,9 +219,6 @@ GLStencilTableSSBO::~GLStencilTableSSBO() {
 GLComputeEvaluator::GLComputeEvaluator()
     : _workGroupSize(64),
       _patchArraysSSBO(0) {
-    memset (&_stencilKernel, 0, sizeof(_stencilKernel));
-    memset (&_patchKernel, 0, sizeof(_patchKernel));
-
     // Initialize internal OpenGL loader library if necessary
     OpenSubdiv::internal::GLLoader::libraryInitializeGL();
 }
@@ -151,10 +239,6 @@ compileKernel(BufferDescriptor const &srcDesc,
               BufferDescriptor const & dvvDesc,
               const char *kernelDefine,
               int workGroupSize) {
-    GLuint program = glCreateProgram();
-
-    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
-
     std::string patchBasisShaderSource =
         GLSLPatchShaderSource::GetPatchBasisShaderSource();
     const char *patchBasisShaderSourceDefine = "#define OSD_PATCH_BASIS_GLSL\n";
@@ -167,6 +251,13 @@ compileKernel(BufferDescriptor const &srcDesc,
             << kernelDefine << "\n"
             << patchBasisShaderSourceDefine << "\n";
 
+    if (srcDesc.IsHalf()) {
+        defines << "#define SRC_HALF\n";
+    }
+    if (dstDesc.IsHalf()) {
+        defines << "#define DST_HALF\n";
+    }
+
     bool deriv1 = (duDesc.length > 0 || dvDesc.length > 0);
     bool deriv2 = (duuDesc.length > 0 || duvDesc.length > 0 || dvvDesc.length > 0);
     if (deriv1) {
@@ -183,6 +274,20 @@ compileKernel(BufferDescriptor const &srcDesc,
     shaderSources[1] = defineStr.c_str();
     shaderSources[2] = patchBasisShaderSource.c_str();
     shaderSources[3] = shaderSource;
+
+    GLuint program = glCreateProgram();
+
+    // look up a program binary previously stored for these sources
+    std::string binaryKey;
+    if (internal::IsGLProgramBinaryCacheEnabled()) {
+        binaryKey = internal::GetGLProgramBinaryKey(shaderSources, 4);
+        if (internal::LoadGLProgramBinary(program, binaryKey)) {
+            return program;
+        }
+        internal::PrepareGLProgramBinary(program);
+    }
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
     glShaderSource(shader, 4, shaderSources, NULL);
     glCompileShader(shader);
     glAttachShader(program, shader);
@@ -205,9 +310,39 @@ compileKernel(BufferDescriptor const &srcDesc,
 
     glDeleteShader(shader);
 
+    if (!binaryKey.empty()) {
+        internal::StoreGLProgramBinary(program, binaryKey);
+    }
+
     return program;
 }
 
+//
+// The cooperative kernel reduces the contributions of its invocations with
+// clustered subgroup operations when the driver supports them in compute
+// shaders, and through shared memory otherwise
+//
+static bool
+supportsClusteredSubgroups(int workGroupSize) {
+#if defined(GL_KHR_shader_subgroup)
+    if (OSD_OPENGL_HAS(KHR_shader_subgroup)) {
+        GLint size = 0, stages = 0, features = 0;
+        glGetIntegerv(GL_SUBGROUP_SIZE_KHR, &size);
+        glGetIntegerv(GL_SUBGROUP_SUPPORTED_STAGES_KHR, &stages);
+        glGetIntegerv(GL_SUBGROUP_SUPPORTED_FEATURES_KHR, &features);
+
+        GLint required = GL_SUBGROUP_FEATURE_BASIC_BIT_KHR |
+                         GL_SUBGROUP_FEATURE_CLUSTERED_BIT_KHR;
+        return (stages & GL_COMPUTE_SHADER_BIT) &&
+               ((features & required) == required) &&
+               (size >= cooperativeLanes) && (workGroupSize % size == 0);
+    }
+#else
+    (void)workGroupSize;
+#endif
+    return false;
+}
+
 bool
 GLComputeEvaluator::Compile(BufferDescriptor const &srcDesc,
                             BufferDescriptor const &dstDesc,
@@ -225,6 +360,30 @@ GLComputeEvaluator::Compile(BufferDescriptor const &srcDesc,
         return false;
     }
 
+    // create a compact stencil kernel (which has no derivative outputs)
+    bool derivatives = (duDesc.length > 0 || dvDesc.length > 0 ||
+                        duuDesc.length > 0 || duvDesc.length > 0 ||
+                        dvvDesc.length > 0);
+    if (!derivatives) {
+        if (!_compactStencilKernel.Compile(srcDesc, dstDesc,
+                                           duDesc, dvDesc,
+                                           duuDesc, duvDesc, dvvDesc,
+                                           _workGroupSize,
+                                           /*compact=*/true)) {
+            return false;
+        }
+    }
+
+    // create a cooperative stencil kernel for the large stencils
+    if (!_cooperativeStencilKernel.Compile(srcDesc, dstDesc,
+                                           duDesc, dvDesc,
+                                           duuDesc, duvDesc, dvvDesc,
+                                           _workGroupSize,
+                                           /*compact=*/false,
+                                           /*cooperative=*/true)) {
+        return false;
+    }
+
     // create a patch kernel
     if (!_patchKernel.Compile(srcDesc, dstDesc,
                               duDesc, dvDesc,
@@ -233,6 +392,20 @@ GLComputeEvaluator::Compile(BufferDescriptor const &srcDesc,
         return false;
     }
 
+    // create a patch kernel computing the patch points from their stencils
+    // (which has no second derivative outputs)
+    bool secondDerivatives = (duuDesc.length > 0 || duvDesc.length > 0 ||
+                              dvvDesc.length > 0);
+    if (!secondDerivatives) {
+        if (!_patchStencilKernel.Compile(srcDesc, dstDesc,
+                                         duDesc, dvDesc,
+                                         duuDesc, duvDesc, dvvDesc,
+                                         _workGroupSize,
+                                         /*stencils=*/true)) {
+            return false;
+        }
+    }
+
     // create a patch arrays buffer
     if (!_patchArraysSSBO) {
         glGenBuffers(1, &_patchArraysSSBO);
@@ -327,37 +500,211 @@ GLComputeEvaluator::EvalStencils(
 
     glUseProgram(_stencilKernel.program);
 
-    glUniform1i(_stencilKernel.uniformStart,     start);
-    glUniform1i(_stencilKernel.uniformEnd,       end);
-    glUniform1i(_stencilKernel.uniformSrcOffset, srcDesc.offset);
-    glUniform1i(_stencilKernel.uniformDstOffset, dstDesc.offset);
-    if (_stencilKernel.uniformDuDesc > 0) {
-        glUniform3i(_stencilKernel.uniformDuDesc,
-                    duDesc.offset, duDesc.length, duDesc.stride);
+    _stencilKernel.SetUniforms(srcDesc, dstDesc,
+                               duDesc, dvDesc, duuDesc, duvDesc, dvvDesc,
+                               start, end, /*useStencilIndices=*/false);
+
+    glDispatchCompute((count + _workGroupSize - 1) / _workGroupSize, 1, 1);
+
+    glUseProgram(0);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+    for (int i = 0; i < 16; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
     }
-    if (_stencilKernel.uniformDvDesc > 0) {
-        glUniform3i(_stencilKernel.uniformDvDesc,
-                    dvDesc.offset, dvDesc.length, dvDesc.stride);
+
+    return true;
+}
+
+bool
+GLComputeEvaluator::EvalStencils(
+    GLuint srcBuffer, BufferDescriptor const &srcDesc,
+    GLuint dstBuffer, BufferDescriptor const &dstDesc,
+    GLuint duBuffer,  BufferDescriptor const &duDesc,
+    GLuint dvBuffer,  BufferDescriptor const &dvDesc,
+    GLuint duuBuffer, BufferDescriptor const &duuDesc,
+    GLuint duvBuffer, BufferDescriptor const &duvDesc,
+    GLuint dvvBuffer, BufferDescriptor const &dvvDesc,
+    GLuint sizesBuffer,
+    GLuint offsetsBuffer,
+    GLuint indicesBuffer,
+    GLuint weightsBuffer,
+    GLuint duWeightsBuffer,
+    GLuint dvWeightsBuffer,
+    GLuint duuWeightsBuffer,
+    GLuint duvWeightsBuffer,
+    GLuint dvvWeightsBuffer,
+    GLuint sortedIndicesBuffer,
+    int numCooperativeStencils,
+    int numStencils) const {
+
+    if (sortedIndicesBuffer == 0 || !_cooperativeStencilKernel.program) {
+        return EvalStencils(srcBuffer, srcDesc, dstBuffer, dstDesc,
+                            duBuffer, duDesc, dvBuffer, dvDesc,
+                            duuBuffer, duuDesc, duvBuffer, duvDesc,
+                            dvvBuffer, dvvDesc,
+                            sizesBuffer, offsetsBuffer, indicesBuffer,
+                            weightsBuffer,
+                            duWeightsBuffer, dvWeightsBuffer,
+                            duuWeightsBuffer, duvWeightsBuffer,
+                            dvvWeightsBuffer,
+                            0, numStencils);
     }
-    if (_stencilKernel.uniformDuuDesc > 0) {
-        glUniform3i(_stencilKernel.uniformDuuDesc,
-                    duuDesc.offset, duuDesc.length, duuDesc.stride);
+
+    if (!_stencilKernel.program) return false;
+    if (numStencils <= 0) {
+        return true;
     }
-    if (_stencilKernel.uniformDuvDesc > 0) {
-        glUniform3i(_stencilKernel.uniformDuvDesc,
-                    duvDesc.offset, duvDesc.length, duvDesc.stride);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, srcBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dstBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, duBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, dvBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, duuBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, duvBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, dvvBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, sizesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, offsetsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, indicesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, weightsBuffer);
+    if (duWeightsBuffer)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, duWeightsBuffer);
+    if (dvWeightsBuffer)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, dvWeightsBuffer);
+    if (duuWeightsBuffer)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, duuWeightsBuffer);
+    if (duvWeightsBuffer)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, duvWeightsBuffer);
+    if (dvvWeightsBuffer)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 15, dvvWeightsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 16, sortedIndicesBuffer);
+
+    // the large stencils at the front of the sorted indices, each by a
+    // group of invocations
+    if (numCooperativeStencils > 0) {
+        int stencilsPerGroup = _workGroupSize / cooperativeLanes;
+
+        glUseProgram(_cooperativeStencilKernel.program);
+
+        _cooperativeStencilKernel.SetUniforms(
+            srcDesc, dstDesc, duDesc, dvDesc, duuDesc, duvDesc, dvvDesc,
+            0, numCooperativeStencils, /*useStencilIndices=*/true);
+
+        glDispatchCompute(
+            (numCooperativeStencils + stencilsPerGroup - 1) / stencilsPerGroup,
+            1, 1);
     }
-    if (_stencilKernel.uniformDvvDesc > 0) {
-        glUniform3i(_stencilKernel.uniformDvvDesc,
-                    dvvDesc.offset, dvvDesc.length, dvvDesc.stride);
+
+    // the remaining stencils, one per invocation
+    int count = numStencils - numCooperativeStencils;
+    if (count > 0) {
+        glUseProgram(_stencilKernel.program);
+
+        _stencilKernel.SetUniforms(
+            srcDesc, dstDesc, duDesc, dvDesc, duuDesc, duvDesc, dvvDesc,
+            numCooperativeStencils, numStencils, /*useStencilIndices=*/true);
+
+        glDispatchCompute((count + _workGroupSize - 1) / _workGroupSize, 1, 1);
+    }
+
+    glUseProgram(0);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+    for (int i = 0; i < 17; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+
+    return true;
+}
+
+bool
+GLComputeEvaluator::EvalStencils(
+    GLuint srcBuffer, BufferDescriptor const &srcDesc,
+    GLuint dstBuffer, BufferDescriptor const &dstDesc,
+    GLuint sizesBuffer,
+    GLuint offsetsBuffer,
+    GLuint indicesBuffer,
+    GLuint weightsBuffer,
+    GLuint stencilIndicesBuffer,
+    int numStencilIndices) const {
+
+    if (!_stencilKernel.program) return false;
+    if (numStencilIndices <= 0) {
+        return true;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, srcBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dstBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, sizesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, offsetsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, indicesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, weightsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 16, stencilIndicesBuffer);
+
+    glUseProgram(_stencilKernel.program);
+
+    glUniform1i(_stencilKernel.uniformStart,     0);
+    glUniform1i(_stencilKernel.uniformEnd,       numStencilIndices);
+    glUniform1i(_stencilKernel.uniformSrcOffset, srcDesc.offset);
+    glUniform1i(_stencilKernel.uniformDstOffset, dstDesc.offset);
+    glUniform1i(_stencilKernel.uniformUseStencilIndices, 1);
+
+    glDispatchCompute(
+        (numStencilIndices + _workGroupSize - 1) / _workGroupSize, 1, 1);
+
+    glUseProgram(0);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+    for (int i = 0; i < 8; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
     }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 16, 0);
+
+    return true;
+}
+
+bool
+GLComputeEvaluator::EvalStencils(
+    GLuint srcBuffer, BufferDescriptor const &srcDesc,
+    GLuint dstBuffer, BufferDescriptor const &dstDesc,
+    GLuint sizesBuffer,
+    GLuint offsetsBuffer,
+    GLuint baseIndicesBuffer,
+    GLuint scalesBuffer,
+    GLuint entriesBuffer,
+    int start, int end) const {
+
+    if (!_compactStencilKernel.program) return false;
+    int count = end - start;
+    if (count <= 0) {
+        return true;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, srcBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dstBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, sizesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, offsetsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, entriesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, scalesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, baseIndicesBuffer);
+
+    glUseProgram(_compactStencilKernel.program);
+
+    glUniform1i(_compactStencilKernel.uniformStart,     start);
+    glUniform1i(_compactStencilKernel.uniformEnd,       end);
+    glUniform1i(_compactStencilKernel.uniformSrcOffset, srcDesc.offset);
+    glUniform1i(_compactStencilKernel.uniformDstOffset, dstDesc.offset);
 
     glDispatchCompute((count + _workGroupSize - 1) / _workGroupSize, 1, 1);
 
     glUseProgram(0);
 
-    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
-    for (int i = 0; i < 16; ++i) {
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+    for (int i = 0; i < 9; ++i) {
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
     }
 
@@ -374,7 +721,8 @@ GLComputeEvaluator::EvalPatches(
     GLuint patchCoordsBuffer,
     const PatchArrayVector &patchArrays,
     GLuint patchIndexBuffer,
-    GLuint patchParamsBuffer) const {
+    GLuint patchParamsBuffer,
+    GLuint patchNormalizationBuffer) const {
 
     return EvalPatches(srcBuffer, srcDesc,
                        dstBuffer, dstDesc,
@@ -387,7 +735,8 @@ GLComputeEvaluator::EvalPatches(
                        patchCoordsBuffer,
                        patchArrays,
                        patchIndexBuffer,
-                       patchParamsBuffer);
+                       patchParamsBuffer,
+                       patchNormalizationBuffer);
 }
 
 bool
@@ -403,7 +752,8 @@ GLComputeEvaluator::EvalPatches(
     GLuint patchCoordsBuffer,
     const PatchArrayVector &patchArrays,
     GLuint patchIndexBuffer,
-    GLuint patchParamsBuffer) const {
+    GLuint patchParamsBuffer,
+    GLuint patchNormalizationBuffer) const {
 
     if (!_patchKernel.program) return false;
 
@@ -417,11 +767,14 @@ GLComputeEvaluator::EvalPatches(
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, patchCoordsBuffer);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, patchIndexBuffer);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, patchParamsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, patchNormalizationBuffer);
 
     glUseProgram(_patchKernel.program);
 
     glUniform1i(_patchKernel.uniformSrcOffset, srcDesc.offset);
     glUniform1i(_patchKernel.uniformDstOffset, dstDesc.offset);
+    glUniform1i(_patchKernel.uniformPatchNormalization,
+                patchNormalizationBuffer != 0);
 
     int patchArraySize = sizeof(PatchArray);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, _patchArraysSSBO);
@@ -469,9 +822,301 @@ GLComputeEvaluator::EvalPatches(
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, 0);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, 0);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, 0);
+
+    return true;
+}
+
+bool
+GLComputeEvaluator::EvalPatchesWithStencils(
+    GLuint srcBuffer, BufferDescriptor const &srcDesc,
+    GLuint dstBuffer, BufferDescriptor const &dstDesc,
+    GLuint duBuffer,  BufferDescriptor const &duDesc,
+    GLuint dvBuffer,  BufferDescriptor const &dvDesc,
+    int numPatchCoords,
+    GLuint patchCoordsBuffer,
+    const PatchArrayVector &patchArrays,
+    GLuint patchIndexBuffer,
+    GLuint patchParamsBuffer,
+    int numControlVertices,
+    GLuint sizesBuffer,
+    GLuint offsetsBuffer,
+    GLuint indicesBuffer,
+    GLuint weightsBuffer) const {
+
+    if (!_patchStencilKernel.program) return false;
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, srcBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dstBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, duBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, dvBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, patchCoordsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, patchIndexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, patchParamsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, sizesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, offsetsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, indicesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, weightsBuffer);
+
+    glUseProgram(_patchStencilKernel.program);
+
+    glUniform1i(_patchStencilKernel.uniformSrcOffset, srcDesc.offset);
+    glUniform1i(_patchStencilKernel.uniformDstOffset, dstDesc.offset);
+    glUniform1i(_patchStencilKernel.uniformNumControlVertices,
+                numControlVertices);
+
+    int patchArraySize = sizeof(PatchArray);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _patchArraysSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+        patchArrays.size()*patchArraySize, NULL, GL_STATIC_DRAW);
+    for (int i=0; i<(int)patchArrays.size(); ++i) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+            i*patchArraySize, sizeof(PatchArray), &patchArrays[i]);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _patchArraysSSBO);
+
+    if (_patchStencilKernel.uniformDuDesc > 0) {
+        glUniform3i(_patchStencilKernel.uniformDuDesc,
+                    duDesc.offset, duDesc.length, duDesc.stride);
+    }
+    if (_patchStencilKernel.uniformDvDesc > 0) {
+        glUniform3i(_patchStencilKernel.uniformDvDesc,
+                    dvDesc.offset, dvDesc.length, dvDesc.stride);
+    }
+
+    glDispatchCompute((numPatchCoords + _workGroupSize - 1) / _workGroupSize, 1, 1);
+
+    glUseProgram(0);
+
+    for (int i = 0; i < 12; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+
+    return true;
+}
+
+bool
+GLComputeEvaluator::EvalStencilsNormals(
+    GLuint srcBuffer,    BufferDescriptor const &srcDesc,
+    GLuint dstBuffer,    BufferDescriptor const &dstDesc,
+    GLuint normalBuffer, BufferDescriptor const &normalDesc,
+    GLuint sizesBuffer,
+    GLuint offsetsBuffer,
+    GLuint indicesBuffer,
+    GLuint weightsBuffer,
+    GLuint duWeightsBuffer,
+    GLuint dvWeightsBuffer,
+    int start, int end) const {
+
+    if (srcDesc.length < 3 || normalDesc.length != 3) return false;
+    if (dstBuffer && srcDesc.length != dstDesc.length) return false;
+
+    // the normals are written through the du buffer of the kernel
+    if (!_stencilNormalKernel.program &&
+        !_stencilNormalKernel.Compile(srcDesc, dstDesc,
+                                      normalDesc, normalDesc,
+                                      BufferDescriptor(), BufferDescriptor(),
+                                      BufferDescriptor(), _workGroupSize,
+                                      /*compact=*/false,
+                                      /*cooperative=*/false,
+                                      /*normals=*/true)) {
+        return false;
+    }
+    int count = end - start;
+    if (count <= 0) {
+        return true;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, srcBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dstBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, normalBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, sizesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, offsetsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, indicesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, weightsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, duWeightsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, dvWeightsBuffer);
+
+    glUseProgram(_stencilNormalKernel.program);
+
+    _stencilNormalKernel.SetUniforms(srcDesc, dstDesc,
+                                     normalDesc, BufferDescriptor(),
+                                     BufferDescriptor(), BufferDescriptor(),
+                                     BufferDescriptor(),
+                                     start, end, /*useStencilIndices=*/false);
+    glUniform1i(_stencilNormalKernel.uniformWritePoints, dstBuffer != 0);
+
+    glDispatchCompute((count + _workGroupSize - 1) / _workGroupSize, 1, 1);
+
+    glUseProgram(0);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+    for (int i = 0; i < 10; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
 
     return true;
 }
+
+bool
+GLComputeEvaluator::EvalPatchesNormals(
+    GLuint srcBuffer,    BufferDescriptor const &srcDesc,
+    GLuint dstBuffer,    BufferDescriptor const &dstDesc,
+    GLuint normalBuffer, BufferDescriptor const &normalDesc,
+    int numPatchCoords,
+    GLuint patchCoordsBuffer,
+    const PatchArrayVector &patchArrays,
+    GLuint patchIndexBuffer,
+    GLuint patchParamsBuffer,
+    GLuint patchNormalizationBuffer) const {
+
+    if (srcDesc.length < 3 || normalDesc.length != 3) return false;
+    if (dstBuffer && srcDesc.length != dstDesc.length) return false;
+
+    // the normals are written through the du buffer of the kernel
+    if (!_patchNormalKernel.program &&
+        !_patchNormalKernel.Compile(srcDesc, dstDesc,
+                                    normalDesc, normalDesc,
+                                    BufferDescriptor(), BufferDescriptor(),
+                                    BufferDescriptor(), _workGroupSize,
+                                    /*stencils=*/false,
+                                    /*normals=*/true)) {
+        return false;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, srcBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dstBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, normalBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, patchCoordsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, patchIndexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, patchParamsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, patchNormalizationBuffer);
+
+    glUseProgram(_patchNormalKernel.program);
+
+    glUniform1i(_patchNormalKernel.uniformSrcOffset, srcDesc.offset);
+    glUniform1i(_patchNormalKernel.uniformDstOffset, dstDesc.offset);
+    glUniform1i(_patchNormalKernel.uniformPatchNormalization,
+                patchNormalizationBuffer != 0);
+    glUniform1i(_patchNormalKernel.uniformWritePoints, dstBuffer != 0);
+    glUniform3i(_patchNormalKernel.uniformDuDesc,
+                normalDesc.offset, normalDesc.length, normalDesc.stride);
+
+    int patchArraySize = sizeof(PatchArray);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _patchArraysSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+        patchArrays.size()*patchArraySize, NULL, GL_STATIC_DRAW);
+    for (int i=0; i<(int)patchArrays.size(); ++i) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+            i*patchArraySize, sizeof(PatchArray), &patchArrays[i]);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _patchArraysSSBO);
+
+    glDispatchCompute((numPatchCoords + _workGroupSize - 1) / _workGroupSize, 1, 1);
+
+    glUseProgram(0);
+
+    for (int i = 0; i < 8; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, 0);
+
+    return true;
+}
+
+bool
+GLComputeEvaluator::EvalPatchesDisplaced(
+    GLuint srcBuffer,    BufferDescriptor const &srcDesc,
+    GLuint dstBuffer,    BufferDescriptor const &dstDesc,
+    GLuint normalBuffer, BufferDescriptor const &normalDesc,
+    int numPatchCoords,
+    GLuint patchCoordsBuffer,
+    const PatchArrayVector &patchArrays,
+    GLuint patchIndexBuffer,
+    GLuint patchParamsBuffer,
+    GLuint displacementTexels,
+    GLuint displacementLayout,
+    float displacementScale,
+    GLuint patchNormalizationBuffer) const {
+
+    if (srcDesc.length < 3 || srcDesc.length != dstDesc.length) return false;
+    if (normalBuffer && normalDesc.length != 3) return false;
+    if (dstBuffer == 0 || displacementTexels == 0 || displacementLayout == 0) {
+        return false;
+    }
+
+    // the normals are written through the du buffer of the kernel, whose
+    // descriptor is set on each dispatch
+    BufferDescriptor const normalKernelDesc(0, 3, 3);
+    if (!_patchDisplacementKernel.program &&
+        !_patchDisplacementKernel.Compile(srcDesc, dstDesc,
+                                          normalKernelDesc, normalKernelDesc,
+                                          BufferDescriptor(),
+                                          BufferDescriptor(),
+                                          BufferDescriptor(), _workGroupSize,
+                                          /*stencils=*/false,
+                                          /*normals=*/true,
+                                          /*displacement=*/true)) {
+        return false;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, srcBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dstBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, normalBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, patchCoordsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, patchIndexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, patchParamsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, patchNormalizationBuffer);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, displacementTexels);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, displacementLayout);
+    glActiveTexture(GL_TEXTURE0);
+
+    glUseProgram(_patchDisplacementKernel.program);
+
+    glUniform1i(_patchDisplacementKernel.uniformSrcOffset, srcDesc.offset);
+    glUniform1i(_patchDisplacementKernel.uniformDstOffset, dstDesc.offset);
+    glUniform1i(_patchDisplacementKernel.uniformPatchNormalization,
+                patchNormalizationBuffer != 0);
+    glUniform3i(_patchDisplacementKernel.uniformDuDesc,
+                normalDesc.offset, normalDesc.length, normalDesc.stride);
+    glUniform1i(_patchDisplacementKernel.uniformDisplacementTexels, 0);
+    glUniform1i(_patchDisplacementKernel.uniformDisplacementLayout, 1);
+    glUniform1f(_patchDisplacementKernel.uniformDisplacementScale,
+                displacementScale);
+    glUniform1i(_patchDisplacementKernel.uniformWriteNormals,
+                normalBuffer != 0);
+
+    int patchArraySize = sizeof(PatchArray);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _patchArraysSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+        patchArrays.size()*patchArraySize, NULL, GL_STATIC_DRAW);
+    for (int i=0; i<(int)patchArrays.size(); ++i) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+            i*patchArraySize, sizeof(PatchArray), &patchArrays[i]);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _patchArraysSSBO);
+
+    glDispatchCompute((numPatchCoords + _workGroupSize - 1) / _workGroupSize, 1, 1);
+
+    glUseProgram(0);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    for (int i = 0; i < 8; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, 0);
+
+    return true;
+}
+
 // ---------------------------------------------------------------------------
 
 GLComputeEvaluator::_StencilKernel::_StencilKernel() : program(0) {
@@ -490,18 +1135,38 @@ GLComputeEvaluator::_StencilKernel::Compile(BufferDescriptor const &srcDesc,
                                             BufferDescriptor const &duuDesc,
                                             BufferDescriptor const &duvDesc,
                                             BufferDescriptor const &dvvDesc,
-                                            int workGroupSize) {
+                                            int workGroupSize,
+                                            bool compact,
+                                            bool cooperative,
+                                            bool normals) {
     // create stencil kernel
     if (program) {
         glDeleteProgram(program);
     }
 
-    const char * kernelDefine =
-        "#define OPENSUBDIV_GLSL_COMPUTE_KERNEL_EVAL_STENCILS\n";
+    std::ostringstream kernelDefine;
+    kernelDefine << "#define OPENSUBDIV_GLSL_COMPUTE_KERNEL_EVAL_STENCILS\n";
+    if (compact) {
+        kernelDefine << "#define OPENSUBDIV_GLSL_COMPUTE_USE_COMPACT_STENCILS\n";
+    }
+    if (cooperative) {
+        kernelDefine
+            << "#define OPENSUBDIV_GLSL_COMPUTE_USE_COOPERATIVE_STENCILS\n"
+            << "#define COOPERATIVE_LANES " << cooperativeLanes << "\n";
+        if (supportsClusteredSubgroups(workGroupSize)) {
+            kernelDefine
+                << "#extension GL_KHR_shader_subgroup_basic : require\n"
+                << "#extension GL_KHR_shader_subgroup_clustered : require\n"
+                << "#define OPENSUBDIV_GLSL_COMPUTE_USE_SUBGROUP_CLUSTERED\n";
+        }
+    }
+    if (normals) {
+        kernelDefine << "#define OPENSUBDIV_GLSL_COMPUTE_USE_NORMALS\n";
+    }
 
     program = compileKernel(srcDesc, dstDesc,
                             duDesc, dvDesc, duuDesc, duvDesc, dvvDesc,
-                            kernelDefine, workGroupSize);
+                            kernelDefine.str().c_str(), workGroupSize);
     if (program == 0) return false;
 
     // cache uniform locations (TODO: use uniform block)
@@ -514,10 +1179,52 @@ GLComputeEvaluator::_StencilKernel::Compile(BufferDescriptor const &srcDesc,
     uniformDuuDesc   = glGetUniformLocation(program, "duuDesc");
     uniformDuvDesc   = glGetUniformLocation(program, "duvDesc");
     uniformDvvDesc   = glGetUniformLocation(program, "dvvDesc");
+    uniformUseStencilIndices =
+        glGetUniformLocation(program, "useStencilIndices");
+    uniformWritePoints = glGetUniformLocation(program, "writePoints");
 
     return true;
 }
 
+void
+GLComputeEvaluator::_StencilKernel::SetUniforms(
+    BufferDescriptor const &srcDesc,
+    BufferDescriptor const &dstDesc,
+    BufferDescriptor const &duDesc,
+    BufferDescriptor const &dvDesc,
+    BufferDescriptor const &duuDesc,
+    BufferDescriptor const &duvDesc,
+    BufferDescriptor const &dvvDesc,
+    int start, int end,
+    bool useStencilIndices) const {
+
+    glUniform1i(uniformStart,     start);
+    glUniform1i(uniformEnd,       end);
+    glUniform1i(uniformSrcOffset, srcDesc.offset);
+    glUniform1i(uniformDstOffset, dstDesc.offset);
+    glUniform1i(uniformUseStencilIndices, useStencilIndices ? 1 : 0);
+    if (uniformDuDesc > 0) {
+        glUniform3i(uniformDuDesc,
+                    duDesc.offset, duDesc.length, duDesc.stride);
+    }
+    if (uniformDvDesc > 0) {
+        glUniform3i(uniformDvDesc,
+                    dvDesc.offset, dvDesc.length, dvDesc.stride);
+    }
+    if (uniformDuuDesc > 0) {
+        glUniform3i(uniformDuuDesc,
+                    duuDesc.offset, duuDesc.length, duuDesc.stride);
+    }
+    if (uniformDuvDesc > 0) {
+        glUniform3i(uniformDuvDesc,
+                    duvDesc.offset, duvDesc.length, duvDesc.stride);
+    }
+    if (uniformDvvDesc > 0) {
+        glUniform3i(uniformDvvDesc,
+                    dvvDesc.offset, dvvDesc.length, dvvDesc.stride);
+    }
+}
+
 // ---------------------------------------------------------------------------
 
 GLComputeEvaluator::_PatchKernel::_PatchKernel() : program(0) {
@@ -536,18 +1243,30 @@ GLComputeEvaluator::_PatchKernel::Compile(BufferDescriptor const &srcDesc,
                                           BufferDescriptor const &duuDesc,
                                           BufferDescriptor const &duvDesc,
                                           BufferDescriptor const &dvvDesc,
-                                          int workGroupSize) {
+                                          int workGroupSize,
+                                          bool stencils,
+                                          bool normals,
+                                          bool displacement) {
     // create stencil kernel
     if (program) {
         glDeleteProgram(program);
     }
 
-    const char * kernelDefine =
-        "#define OPENSUBDIV_GLSL_COMPUTE_KERNEL_EVAL_PATCHES\n";
+    std::ostringstream kernelDefine;
+    kernelDefine << "#define OPENSUBDIV_GLSL_COMPUTE_KERNEL_EVAL_PATCHES\n";
+    if (stencils) {
+        kernelDefine << "#define OPENSUBDIV_GLSL_COMPUTE_USE_PATCH_STENCILS\n";
+    }
+    if (normals) {
+        kernelDefine << "#define OPENSUBDIV_GLSL_COMPUTE_USE_NORMALS\n";
+    }
+    if (displacement) {
+        kernelDefine << "#define OPENSUBDIV_GLSL_COMPUTE_USE_DISPLACEMENT\n";
+    }
 
     program = compileKernel(srcDesc, dstDesc,
                             duDesc, dvDesc, duuDesc, duvDesc, dvvDesc,
-                            kernelDefine, workGroupSize);
+                            kernelDefine.str().c_str(), workGroupSize);
     if (program == 0) return false;
 
     // cache uniform locations
@@ -559,6 +1278,18 @@ GLComputeEvaluator::_PatchKernel::Compile(BufferDescriptor const &srcDesc,
     uniformDuuDesc    = glGetUniformLocation(program, "duuDesc");
     uniformDuvDesc    = glGetUniformLocation(program, "duvDesc");
     uniformDvvDesc    = glGetUniformLocation(program, "dvvDesc");
+    uniformNumControlVertices =
+        glGetUniformLocation(program, "numControlVertices");
+    uniformPatchNormalization =
+        glGetUniformLocation(program, "patchNormalization");
+    uniformWritePoints = glGetUniformLocation(program, "writePoints");
+    uniformDisplacementTexels =
+        glGetUniformLocation(program, "displacementTexels");
+    uniformDisplacementLayout =
+        glGetUniformLocation(program, "displacementLayout");
+    uniformDisplacementScale =
+        glGetUniformLocation(program, "displacementScale");
+    uniformWriteNormals = glGetUniformLocation(program, "writeNormals");
 
     return true;
 }
@@ -31,6 +31,8 @@
 #include "../osd/types.h"
 #include "../osd/bufferDescriptor.h"
 
+#include <vector>
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
@@ -78,7 +80,25 @@ public:
     GLuint GetDvvWeightsBuffer() const { return _dvvWeights; }
     int GetNumStencils() const { return _numStencils; }
 
+    /// Returns the number of control vertices the stencils are factorized
+    /// to (see GLComputeEvaluator::EvalPatchesWithStencils())
+    int GetNumControlVertices() const { return _numControlVertices; }
+
+    /// Returns the GL buffer of the stencil indices sorted by decreasing
+    /// stencil size, or 0 if the table has no stencils large enough to
+    /// benefit from the cooperative kernel
+    GLuint GetSortedIndicesBuffer() const { return _sortedIndices; }
+
+    /// Returns the number of stencils at the front of the sorted indices
+    /// which are large enough to be evaluated cooperatively
+    int GetNumCooperativeStencils() const { return _numCooperativeStencils; }
+
+    /// Returns the number of bytes of the GL buffers of the table
+    size_t GetMemoryUsage() const { return _memoryUsage; }
+
 private:
+    void createSortedIndices(std::vector<int> const &sizes);
+
     GLuint _sizes;
     GLuint _offsets;
     GLuint _indices;
@@ -88,6 +108,46 @@ private:
     GLuint _duuWeights;
     GLuint _duvWeights;
     GLuint _dvvWeights;
+    GLuint _sortedIndices;
+    int _numStencils;
+    int _numControlVertices;
+    int _numCooperativeStencils;
+    size_t _memoryUsage;
+};
+
+/// \brief GL compact stencil table (Shader Storage buffer)
+///
+/// This class is a GLSL SSBO representation of the quantized stencils of a
+/// CpuCompactStencilTable, which halves the memory and bandwidth needed for
+/// the stencil entries at the expense of the precision of the weights.
+///
+/// GLSLComputeKernel consumes this table to apply stencils
+///
+class GLCompactStencilTableSSBO {
+public:
+    static GLCompactStencilTableSSBO *Create(
+        Far::StencilTable const *stencilTable, void *deviceContext = NULL) {
+        (void)deviceContext;  // unused
+        return new GLCompactStencilTableSSBO(stencilTable);
+    }
+
+    explicit GLCompactStencilTableSSBO(Far::StencilTable const *stencilTable);
+    ~GLCompactStencilTableSSBO();
+
+    // interfaces needed for GLSLComputeKernel
+    GLuint GetSizesBuffer() const { return _sizes; }
+    GLuint GetOffsetsBuffer() const { return _offsets; }
+    GLuint GetBaseIndicesBuffer() const { return _baseIndices; }
+    GLuint GetScalesBuffer() const { return _scales; }
+    GLuint GetEntriesBuffer() const { return _entries; }
+    int GetNumStencils() const { return _numStencils; }
+
+private:
+    GLuint _sizes;
+    GLuint _offsets;
+    GLuint _baseIndices;
+    GLuint _scales;
+    GLuint _entries;
     int _numStencils;
 };
 
@@ -391,14 +451,17 @@ public:
                             dstBuffer->BindVBO(), dstDesc,
                             0, BufferDescriptor(),
                             0, BufferDescriptor(),
+                            0, BufferDescriptor(),
+                            0, BufferDescriptor(),
+                            0, BufferDescriptor(),
                             stencilTable->GetSizesBuffer(),
                             stencilTable->GetOffsetsBuffer(),
                             stencilTable->GetIndicesBuffer(),
                             stencilTable->GetWeightsBuffer(),
-                            0,
-                            0,
-                            /* start = */ 0,
-                            /* end   = */ stencilTable->GetNumStencils());
+                            0, 0, 0, 0, 0,
+                            stencilTable->GetSortedIndicesBuffer(),
+                            stencilTable->GetNumCooperativeStencils(),
+                            stencilTable->GetNumStencils());
     }
 
     /// \brief Generic stencil function.
@@ -441,14 +504,19 @@ public:
                             dstBuffer->BindVBO(), dstDesc,
                             duBuffer->BindVBO(),  duDesc,
                             dvBuffer->BindVBO(),  dvDesc,
+                            0, BufferDescriptor(),
+                            0, BufferDescriptor(),
+                            0, BufferDescriptor(),
                             stencilTable->GetSizesBuffer(),
                             stencilTable->GetOffsetsBuffer(),
                             stencilTable->GetIndicesBuffer(),
                             stencilTable->GetWeightsBuffer(),
                             stencilTable->GetDuWeightsBuffer(),
                             stencilTable->GetDvWeightsBuffer(),
-                            /* start = */ 0,
-                            /* end   = */ stencilTable->GetNumStencils());
+                            0, 0, 0,
+                            stencilTable->GetSortedIndicesBuffer(),
+                            stencilTable->GetNumCooperativeStencils(),
+                            stencilTable->GetNumStencils());
     }
 
     /// \brief Generic stencil function.
@@ -524,8 +592,9 @@ public:
                             stencilTable->GetDuuWeightsBuffer(),
                             stencilTable->GetDuvWeightsBuffer(),
                             stencilTable->GetDvvWeightsBuffer(),
-                            /* start = */ 0,
-                            /* end   = */ stencilTable->GetNumStencils());
+                            stencilTable->GetSortedIndicesBuffer(),
+                            stencilTable->GetNumCooperativeStencils(),
+                            stencilTable->GetNumStencils());
     }
 
     /// \brief Dispatch the GLSL compute kernel on GPU asynchronously
@@ -648,6 +717,244 @@ public:
                       int start,
                       int end) const;
 
+    /// \brief Dispatch the GLSL compute kernels on GPU asynchronously for
+    /// all the stencils of a table, in the order of a list of stencil
+    /// indices sorted by decreasing size. The stencils at the front of the
+    /// list are evaluated by the cooperative kernel, which assigns several
+    /// invocations to each stencil, the remaining ones by the regular kernel.
+    /// When sortedIndicesBuffer is 0, all the stencils are evaluated in
+    /// order by the regular kernel. returns false if the kernels haven't
+    /// been compiled yet.
+    ///
+    /// @param sortedIndicesBuffer    GL buffer of the stencil indices sorted
+    ///                               by decreasing size (or 0)
+    ///
+    /// @param numCooperativeStencils number of stencils at the front of the
+    ///                               sorted indices evaluated cooperatively
+    ///
+    /// @param numStencils            number of stencils in the table
+    ///
+    /// see the EvalStencils() above for the other parameters
+    ///
+    bool EvalStencils(GLuint srcBuffer, BufferDescriptor const &srcDesc,
+                      GLuint dstBuffer, BufferDescriptor const &dstDesc,
+                      GLuint duBuffer,  BufferDescriptor const &duDesc,
+                      GLuint dvBuffer,  BufferDescriptor const &dvDesc,
+                      GLuint duuBuffer, BufferDescriptor const &duuDesc,
+                      GLuint duvBuffer, BufferDescriptor const &duvDesc,
+                      GLuint dvvBuffer, BufferDescriptor const &dvvDesc,
+                      GLuint sizesBuffer,
+                      GLuint offsetsBuffer,
+                      GLuint indicesBuffer,
+                      GLuint weightsBuffer,
+                      GLuint duWeightsBuffer,
+                      GLuint dvWeightsBuffer,
+                      GLuint duuWeightsBuffer,
+                      GLuint duvWeightsBuffer,
+                      GLuint dvvWeightsBuffer,
+                      GLuint sortedIndicesBuffer,
+                      int numCooperativeStencils,
+                      int numStencils) const;
+
+    /// \brief Generic static stencil function for compact stencil tables
+    ///        (see GLCompactStencilTableSSBO).
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of source data
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   GLCompactStencilTableSSBO
+    ///
+    /// @param instance       cached compiled instance. Clients are supposed to
+    ///                       pre-compile an instance of this class and provide
+    ///                       to this function. If it's null the kernel still
+    ///                       compute by instantiating on-demand kernel although
+    ///                       it may cause a performance problem.
+    ///
+    /// @param deviceContext  not used in the GLSL kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        GLCompactStencilTableSSBO const *stencilTable,
+        GLComputeEvaluator const *instance,
+        void * deviceContext = NULL) {
+
+        if (instance) {
+            return instance->EvalStencils(srcBuffer, srcDesc,
+                                          dstBuffer, dstDesc,
+                                          stencilTable);
+        } else {
+            // Create an instance on demand (slow)
+            (void)deviceContext;  // unused
+            instance = Create(srcDesc, dstDesc,
+                              BufferDescriptor(),
+                              BufferDescriptor());
+            if (instance) {
+                bool r = instance->EvalStencils(srcBuffer, srcDesc,
+                                                dstBuffer, dstDesc,
+                                                stencilTable);
+                delete instance;
+                return r;
+            }
+            return false;
+        }
+    }
+
+    /// \brief Generic stencil function for compact stencil tables.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of source data
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   GLCompactStencilTableSSBO
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        GLCompactStencilTableSSBO const *stencilTable) const {
+        return EvalStencils(srcBuffer->BindVBO(), srcDesc,
+                            dstBuffer->BindVBO(), dstDesc,
+                            stencilTable->GetSizesBuffer(),
+                            stencilTable->GetOffsetsBuffer(),
+                            stencilTable->GetBaseIndicesBuffer(),
+                            stencilTable->GetScalesBuffer(),
+                            stencilTable->GetEntriesBuffer(),
+                            /* start = */ 0,
+                            /* end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Dispatch the GLSL compute kernel for compact stencil tables on
+    /// GPU asynchronously. returns false if the kernel hasn't been compiled
+    /// (the compact stencil kernel is only compiled for evaluators without
+    /// derivative outputs).
+    ///
+    /// @param srcBuffer          GL buffer of input primvar source data
+    ///
+    /// @param srcDesc            vertex buffer descriptor for the srcBuffer
+    ///
+    /// @param dstBuffer          GL buffer of output primvar destination data
+    ///
+    /// @param dstDesc            vertex buffer descriptor for the dstBuffer
+    ///
+    /// @param sizesBuffer        GL buffer of the sizes in the stencil table
+    ///
+    /// @param offsetsBuffer      GL buffer of the offsets in the stencil table
+    ///
+    /// @param baseIndicesBuffer  GL buffer of the base indices in the
+    ///                           stencil table
+    ///
+    /// @param scalesBuffer       GL buffer of the weight scales in the
+    ///                           stencil table
+    ///
+    /// @param entriesBuffer      GL buffer of the entries in the stencil table
+    ///
+    /// @param start              start index of stencil table
+    ///
+    /// @param end                end index of stencil table
+    ///
+    bool EvalStencils(GLuint srcBuffer, BufferDescriptor const &srcDesc,
+                      GLuint dstBuffer, BufferDescriptor const &dstDesc,
+                      GLuint sizesBuffer,
+                      GLuint offsetsBuffer,
+                      GLuint baseIndicesBuffer,
+                      GLuint scalesBuffer,
+                      GLuint entriesBuffer,
+                      int start,
+                      int end) const;
+
+    /// \brief Generic stencil function for a subset of the stencils of a
+    ///        table.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of source data
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   stencil table to be applied. The table must have
+    ///                       SSBO interfaces.
+    ///
+    /// @param stencilIndicesBuffer GL buffer of the indices of the stencils
+    ///                       to evaluate -- each is written to the element of
+    ///                       dstBuffer of the same index, other elements are
+    ///                       not modified
+    ///
+    /// @param numStencilIndices number of stencil indices
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        STENCIL_TABLE const *stencilTable,
+        GLuint stencilIndicesBuffer, int numStencilIndices) const {
+        return EvalStencils(srcBuffer->BindVBO(), srcDesc,
+                            dstBuffer->BindVBO(), dstDesc,
+                            stencilTable->GetSizesBuffer(),
+                            stencilTable->GetOffsetsBuffer(),
+                            stencilTable->GetIndicesBuffer(),
+                            stencilTable->GetWeightsBuffer(),
+                            stencilIndicesBuffer, numStencilIndices);
+    }
+
+    /// \brief Dispatch the GLSL compute kernel on GPU asynchronously for a
+    /// subset of the stencils of a table. returns false if the kernel hasn't
+    /// been compiled yet.
+    ///
+    /// @param srcBuffer          GL buffer of input primvar source data
+    ///
+    /// @param srcDesc            vertex buffer descriptor for the srcBuffer
+    ///
+    /// @param dstBuffer          GL buffer of output primvar destination data
+    ///
+    /// @param dstDesc            vertex buffer descriptor for the dstBuffer
+    ///
+    /// @param sizesBuffer        GL buffer of the sizes in the stencil table
+    ///
+    /// @param offsetsBuffer      GL buffer of the offsets in the stencil table
+    ///
+    /// @param indicesBuffer      GL buffer of the indices in the stencil table
+    ///
+    /// @param weightsBuffer      GL buffer of the weights in the stencil table
+    ///
+    /// @param stencilIndicesBuffer GL buffer of the indices of the stencils
+    ///                           to evaluate
+    ///
+    /// @param numStencilIndices  number of stencil indices
+    ///
+    bool EvalStencils(GLuint srcBuffer, BufferDescriptor const &srcDesc,
+                      GLuint dstBuffer, BufferDescriptor const &dstDesc,
+                      GLuint sizesBuffer,
+                      GLuint offsetsBuffer,
+                      GLuint indicesBuffer,
+                      GLuint weightsBuffer,
+                      GLuint stencilIndicesBuffer,
+                      int numStencilIndices) const;
+
     /// ----------------------------------------------------------------------
     ///
     ///   Limit evaluations with PatchTable
@@ -955,7 +1262,8 @@ public:
                            patchCoords->BindVBO(),
                            patchTable->GetPatchArrays(),
                            patchTable->GetPatchIndexBuffer(),
-                           patchTable->GetPatchParamBuffer());
+                           patchTable->GetPatchParamBuffer(),
+                           patchTable->GetPatchParamNormalizationBuffer());
     }
 
     /// \brief Generic limit eval function with derivatives. This function has
@@ -1011,7 +1319,8 @@ public:
                            patchCoords->BindVBO(),
                            patchTable->GetPatchArrays(),
                            patchTable->GetPatchIndexBuffer(),
-                           patchTable->GetPatchParamBuffer());
+                           patchTable->GetPatchParamBuffer(),
+                           patchTable->GetPatchParamNormalizationBuffer());
     }
 
     /// \brief Generic limit eval function with derivatives. This function has
@@ -1091,7 +1400,8 @@ public:
                            patchCoords->BindVBO(),
                            patchTable->GetPatchArrays(),
                            patchTable->GetPatchIndexBuffer(),
-                           patchTable->GetPatchParamBuffer());
+                           patchTable->GetPatchParamBuffer(),
+                           patchTable->GetPatchParamNormalizationBuffer());
     }
 
     bool EvalPatches(GLuint srcBuffer, BufferDescriptor const &srcDesc,
@@ -1102,8 +1412,14 @@ public:
                      GLuint patchCoordsBuffer,
                      const PatchArrayVector &patchArrays,
                      GLuint patchIndexBuffer,
-                     GLuint patchParamsBuffer) const;
+                     GLuint patchParamsBuffer,
+                     GLuint patchNormalizationBuffer = 0) const;
 
+    /// \brief Dispatches the patch kernel. If patchNormalizationBuffer is
+    ///        not 0, the normalization of the parameterization of each patch
+    ///        is read from that buffer of Osd::PatchParamNormalization
+    ///        rather than decoded from the patch params.
+    ///
     bool EvalPatches(GLuint srcBuffer, BufferDescriptor const &srcDesc,
                      GLuint dstBuffer, BufferDescriptor const &dstDesc,
                      GLuint duBuffer,  BufferDescriptor const &duDesc,
@@ -1115,13 +1431,22 @@ public:
                      GLuint patchCoordsBuffer,
                      const PatchArrayVector &patchArrays,
                      GLuint patchIndexBuffer,
-                     GLuint patchParamsBuffer) const;
+                     GLuint patchParamsBuffer,
+                     GLuint patchNormalizationBuffer = 0) const;
 
-    /// \brief Generic limit eval function. This function has a same
-    ///        signature as other device kernels have so that it can be called
-    ///        in the same way.
+    /// ----------------------------------------------------------------------
     ///
-    /// @param srcBuffer      Input primvar buffer.
+    ///   Limit evaluations with PatchTable and StencilTable
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic limit eval function evaluating the patches directly
+    ///        from the control vertices. The points of the patches past the
+    ///        control vertices are computed from their stencils by the same
+    ///        kernel, so no buffer of refined vertices and local points is
+    ///        required when only limit samples are needed.
+    ///
+    /// @param srcBuffer      Input buffer of the control vertices.
     ///                       must have BindVBO() method returning a GL
     ///                       buffer object of source data
     ///
@@ -1141,31 +1466,37 @@ public:
     ///
     /// @param patchTable     GLPatchTable or equivalent
     ///
+    /// @param stencilTable   GLStencilTableSSBO of the refined vertices and
+    ///                       local points the patches refer to, factorized
+    ///                       to the control vertices
+    ///
     /// @param instance       cached compiled instance. Clients are supposed to
     ///                       pre-compile an instance of this class and provide
     ///                       to this function. If it's null the kernel still
     ///                       compute by instantiating on-demand kernel although
     ///                       it may cause a performance problem.
     ///
-    /// @param deviceContext  not used in the GLXFB evaluator
+    /// @param deviceContext  not used in the GLSL kernel
     ///
     template <typename SRC_BUFFER, typename DST_BUFFER,
-              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
-    static bool EvalPatchesVarying(
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename STENCIL_TABLE>
+    static bool EvalPatchesWithStencils(
         SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
         DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
         int numPatchCoords,
         PATCHCOORD_BUFFER *patchCoords,
         PATCH_TABLE *patchTable,
+        STENCIL_TABLE const *stencilTable,
         GLComputeEvaluator const *instance,
         void * deviceContext = NULL) {
 
         if (instance) {
-            return instance->EvalPatchesVarying(
-                                         srcBuffer, srcDesc,
-                                         dstBuffer, dstDesc,
-                                         numPatchCoords, patchCoords,
-                                         patchTable);
+            return instance->EvalPatchesWithStencils(
+                srcBuffer, srcDesc,
+                dstBuffer, dstDesc,
+                numPatchCoords, patchCoords,
+                patchTable, stencilTable);
         } else {
             // Create an instance on demand (slow)
             (void)deviceContext;  // unused
@@ -1173,11 +1504,11 @@ public:
                               BufferDescriptor(),
                               BufferDescriptor());
             if (instance) {
-                bool r = instance->EvalPatchesVarying(
-                                               srcBuffer, srcDesc,
-                                               dstBuffer, dstDesc,
-                                               numPatchCoords, patchCoords,
-                                               patchTable);
+                bool r = instance->EvalPatchesWithStencils(
+                    srcBuffer, srcDesc,
+                    dstBuffer, dstDesc,
+                    numPatchCoords, patchCoords,
+                    patchTable, stencilTable);
                 delete instance;
                 return r;
             }
@@ -1185,11 +1516,253 @@ public:
         }
     }
 
-    /// \brief Generic limit eval function. This function has a same
-    ///        signature as other device kernels have so that it can be called
-    ///        in the same way.
+    /// \brief Generic limit eval function evaluating the patches and their
+    ///        first derivatives directly from the control vertices (see
+    ///        above).
     ///
-    /// @param srcBuffer      Input primvar buffer.
+    /// @param srcBuffer      Input buffer of the control vertices.
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of source data
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param duBuffer       Output buffer derivative wrt u
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param duDesc         vertex buffer descriptor for the duBuffer
+    ///
+    /// @param dvBuffer       Output buffer derivative wrt v
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param dvDesc         vertex buffer descriptor for the dvBuffer
+    ///
+    /// @param numPatchCoords number of patchCoords.
+    ///
+    /// @param patchCoords    array of locations to be evaluated.
+    ///                       must have BindVBO() method returning an
+    ///                       array of PatchCoord struct in VBO.
+    ///
+    /// @param patchTable     GLPatchTable or equivalent
+    ///
+    /// @param stencilTable   GLStencilTableSSBO of the refined vertices and
+    ///                       local points the patches refer to, factorized
+    ///                       to the control vertices
+    ///
+    /// @param instance       cached compiled instance. Clients are supposed to
+    ///                       pre-compile an instance of this class and provide
+    ///                       to this function. If it's null the kernel still
+    ///                       compute by instantiating on-demand kernel although
+    ///                       it may cause a performance problem.
+    ///
+    /// @param deviceContext  not used in the GLSL kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename STENCIL_TABLE>
+    static bool EvalPatchesWithStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        STENCIL_TABLE const *stencilTable,
+        GLComputeEvaluator const *instance,
+        void * deviceContext = NULL) {
+
+        if (instance) {
+            return instance->EvalPatchesWithStencils(
+                srcBuffer, srcDesc,
+                dstBuffer, dstDesc,
+                duBuffer, duDesc,
+                dvBuffer, dvDesc,
+                numPatchCoords, patchCoords,
+                patchTable, stencilTable);
+        } else {
+            // Create an instance on demand (slow)
+            (void)deviceContext;  // unused
+            instance = Create(srcDesc, dstDesc,
+                              duDesc, dvDesc);
+            if (instance) {
+                bool r = instance->EvalPatchesWithStencils(
+                    srcBuffer, srcDesc,
+                    dstBuffer, dstDesc,
+                    duBuffer, duDesc,
+                    dvBuffer, dvDesc,
+                    numPatchCoords, patchCoords,
+                    patchTable, stencilTable);
+                delete instance;
+                return r;
+            }
+            return false;
+        }
+    }
+
+    /// \brief Limit eval function evaluating the patches directly from the
+    ///        control vertices (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename STENCIL_TABLE>
+    bool EvalPatchesWithStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        STENCIL_TABLE const *stencilTable) const {
+
+        return EvalPatchesWithStencils(srcBuffer->BindVBO(), srcDesc,
+                                       dstBuffer->BindVBO(), dstDesc,
+                                       0, BufferDescriptor(),
+                                       0, BufferDescriptor(),
+                                       numPatchCoords,
+                                       patchCoords->BindVBO(),
+                                       patchTable->GetPatchArrays(),
+                                       patchTable->GetPatchIndexBuffer(),
+                                       patchTable->GetPatchParamBuffer(),
+                                       stencilTable->GetNumControlVertices(),
+                                       stencilTable->GetSizesBuffer(),
+                                       stencilTable->GetOffsetsBuffer(),
+                                       stencilTable->GetIndicesBuffer(),
+                                       stencilTable->GetWeightsBuffer());
+    }
+
+    /// \brief Limit eval function evaluating the patches and their first
+    ///        derivatives directly from the control vertices (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename STENCIL_TABLE>
+    bool EvalPatchesWithStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        STENCIL_TABLE const *stencilTable) const {
+
+        return EvalPatchesWithStencils(srcBuffer->BindVBO(), srcDesc,
+                                       dstBuffer->BindVBO(), dstDesc,
+                                       duBuffer->BindVBO(),  duDesc,
+                                       dvBuffer->BindVBO(),  dvDesc,
+                                       numPatchCoords,
+                                       patchCoords->BindVBO(),
+                                       patchTable->GetPatchArrays(),
+                                       patchTable->GetPatchIndexBuffer(),
+                                       patchTable->GetPatchParamBuffer(),
+                                       stencilTable->GetNumControlVertices(),
+                                       stencilTable->GetSizesBuffer(),
+                                       stencilTable->GetOffsetsBuffer(),
+                                       stencilTable->GetIndicesBuffer(),
+                                       stencilTable->GetWeightsBuffer());
+    }
+
+    /// \brief Dispatches the fused patch kernel. The points of the patches
+    ///        of index numControlVertices and above are computed from the
+    ///        stencils given by the sizes, offsets, indices and weights
+    ///        buffers. Returns false if the instance was compiled with second
+    ///        derivatives, which the fused kernel does not evaluate.
+    ///
+    bool EvalPatchesWithStencils(GLuint srcBuffer, BufferDescriptor const &srcDesc,
+                                 GLuint dstBuffer, BufferDescriptor const &dstDesc,
+                                 GLuint duBuffer,  BufferDescriptor const &duDesc,
+                                 GLuint dvBuffer,  BufferDescriptor const &dvDesc,
+                                 int numPatchCoords,
+                                 GLuint patchCoordsBuffer,
+                                 const PatchArrayVector &patchArrays,
+                                 GLuint patchIndexBuffer,
+                                 GLuint patchParamsBuffer,
+                                 int numControlVertices,
+                                 GLuint sizesBuffer,
+                                 GLuint offsetsBuffer,
+                                 GLuint indicesBuffer,
+                                 GLuint weightsBuffer) const;
+
+    /// \brief Generic limit eval function. This function has a same
+    ///        signature as other device kernels have so that it can be called
+    ///        in the same way.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of source data
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords number of patchCoords.
+    ///
+    /// @param patchCoords    array of locations to be evaluated.
+    ///                       must have BindVBO() method returning an
+    ///                       array of PatchCoord struct in VBO.
+    ///
+    /// @param patchTable     GLPatchTable or equivalent
+    ///
+    /// @param instance       cached compiled instance. Clients are supposed to
+    ///                       pre-compile an instance of this class and provide
+    ///                       to this function. If it's null the kernel still
+    ///                       compute by instantiating on-demand kernel although
+    ///                       it may cause a performance problem.
+    ///
+    /// @param deviceContext  not used in the GLXFB evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesVarying(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        GLComputeEvaluator const *instance,
+        void * deviceContext = NULL) {
+
+        if (instance) {
+            return instance->EvalPatchesVarying(
+                                         srcBuffer, srcDesc,
+                                         dstBuffer, dstDesc,
+                                         numPatchCoords, patchCoords,
+                                         patchTable);
+        } else {
+            // Create an instance on demand (slow)
+            (void)deviceContext;  // unused
+            instance = Create(srcDesc, dstDesc,
+                              BufferDescriptor(),
+                              BufferDescriptor());
+            if (instance) {
+                bool r = instance->EvalPatchesVarying(
+                                               srcBuffer, srcDesc,
+                                               dstBuffer, dstDesc,
+                                               numPatchCoords, patchCoords,
+                                               patchTable);
+                delete instance;
+                return r;
+            }
+            return false;
+        }
+    }
+
+    /// \brief Generic limit eval function. This function has a same
+    ///        signature as other device kernels have so that it can be called
+    ///        in the same way.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
     ///                       must have BindVBO() method returning a GL
     ///                       buffer object of source data
     ///
@@ -2035,6 +2608,584 @@ public:
                            patchTable->GetFVarPatchParamBuffer(fvarChannel));
     }
 
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Normal evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static stencil function writing the unit normals of
+    ///        the limit surface -- the normalized cross product of the first
+    ///        three elements of the derivatives, which are accumulated in the
+    ///        kernel but not written -- and the limit points.
+    ///
+    /// @param srcBuffer      Input primvar buffer (of at least 3 elements).
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of source data
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the dstBuffer
+    ///
+    /// @param normalBuffer   Output buffer of the normals
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param normalDesc     vertex buffer descriptor for the normalBuffer
+    ///                       (of length 3)
+    ///
+    /// @param stencilTable   limit stencil table to be applied. The table
+    ///                       must have SSBO interfaces.
+    ///
+    /// @param instance       cached compiled instance. If it's null the
+    ///                       kernel is instantiated on-demand (slow).
+    ///
+    /// @param deviceContext  not used in the GLSL kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        STENCIL_TABLE const *stencilTable,
+        GLComputeEvaluator const *instance,
+        void * deviceContext = NULL) {
+
+        if (instance) {
+            return instance->EvalStencilsNormals(srcBuffer, srcDesc,
+                                                 dstBuffer, dstDesc,
+                                                 normalBuffer, normalDesc,
+                                                 stencilTable);
+        } else {
+            // Create an instance on demand (slow)
+            (void)deviceContext;  // unused
+            instance = Create(srcDesc, dstDesc, normalDesc, normalDesc);
+            if (instance) {
+                bool r = instance->EvalStencilsNormals(srcBuffer, srcDesc,
+                                                       dstBuffer, dstDesc,
+                                                       normalBuffer, normalDesc,
+                                                       stencilTable);
+                delete instance;
+                return r;
+            }
+            return false;
+        }
+    }
+
+    /// \brief Generic static stencil function writing only the unit normals
+    ///        of the limit surface (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        STENCIL_TABLE const *stencilTable,
+        GLComputeEvaluator const *instance,
+        void * deviceContext = NULL) {
+
+        if (instance) {
+            return instance->EvalStencilsNormals(srcBuffer, srcDesc,
+                                                 normalBuffer, normalDesc,
+                                                 stencilTable);
+        } else {
+            // Create an instance on demand (slow)
+            (void)deviceContext;  // unused
+            instance = Create(srcDesc, BufferDescriptor(),
+                              normalDesc, normalDesc);
+            if (instance) {
+                bool r = instance->EvalStencilsNormals(srcBuffer, srcDesc,
+                                                       normalBuffer, normalDesc,
+                                                       stencilTable);
+                delete instance;
+                return r;
+            }
+            return false;
+        }
+    }
+
+    /// \brief Generic stencil function writing the unit normals of the
+    ///        limit surface and the limit points (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    bool EvalStencilsNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        STENCIL_TABLE const *stencilTable) const {
+        return EvalStencilsNormals(srcBuffer->BindVBO(), srcDesc,
+                                   dstBuffer->BindVBO(), dstDesc,
+                                   normalBuffer->BindVBO(), normalDesc,
+                                   stencilTable->GetSizesBuffer(),
+                                   stencilTable->GetOffsetsBuffer(),
+                                   stencilTable->GetIndicesBuffer(),
+                                   stencilTable->GetWeightsBuffer(),
+                                   stencilTable->GetDuWeightsBuffer(),
+                                   stencilTable->GetDvWeightsBuffer(),
+                                   /* start = */ 0,
+                                   /* end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Generic stencil function writing only the unit normals of the
+    ///        limit surface (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    bool EvalStencilsNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        STENCIL_TABLE const *stencilTable) const {
+        return EvalStencilsNormals(srcBuffer->BindVBO(), srcDesc,
+                                   0, BufferDescriptor(),
+                                   normalBuffer->BindVBO(), normalDesc,
+                                   stencilTable->GetSizesBuffer(),
+                                   stencilTable->GetOffsetsBuffer(),
+                                   stencilTable->GetIndicesBuffer(),
+                                   stencilTable->GetWeightsBuffer(),
+                                   stencilTable->GetDuWeightsBuffer(),
+                                   stencilTable->GetDvWeightsBuffer(),
+                                   /* start = */ 0,
+                                   /* end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Dispatch the GLSL compute kernel writing the unit normals of
+    ///        the limit surface on GPU asynchronously. The kernel is compiled
+    ///        on first use, for the descriptors given then.
+    ///
+    /// @param srcBuffer        GL buffer of input primvar source data
+    ///                         (of at least 3 elements)
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the srcBuffer
+    ///
+    /// @param dstBuffer        GL buffer of output primvar destination data,
+    ///                         or 0 to write only the normals
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the dstBuffer
+    ///
+    /// @param normalBuffer     GL buffer of the output normals
+    ///
+    /// @param normalDesc       vertex buffer descriptor for the normalBuffer
+    ///                         (of length 3)
+    ///
+    /// @param sizesBuffer      GL buffer of the sizes in the stencil table
+    ///
+    /// @param offsetsBuffer    GL buffer of the offsets in the stencil table
+    ///
+    /// @param indicesBuffer    GL buffer of the indices in the stencil table
+    ///
+    /// @param weightsBuffer    GL buffer of the weights in the stencil table
+    ///
+    /// @param duWeightsBuffer  GL buffer of the du weights in the stencil table
+    ///
+    /// @param dvWeightsBuffer  GL buffer of the dv weights in the stencil table
+    ///
+    /// @param start            start index of stencil table
+    ///
+    /// @param end              end index of stencil table
+    ///
+    bool EvalStencilsNormals(GLuint srcBuffer,    BufferDescriptor const &srcDesc,
+                             GLuint dstBuffer,    BufferDescriptor const &dstDesc,
+                             GLuint normalBuffer, BufferDescriptor const &normalDesc,
+                             GLuint sizesBuffer,
+                             GLuint offsetsBuffer,
+                             GLuint indicesBuffer,
+                             GLuint weightsBuffer,
+                             GLuint duWeightsBuffer,
+                             GLuint dvWeightsBuffer,
+                             int start,
+                             int end) const;
+
+    /// \brief Generic limit eval function writing the unit normals of the
+    ///        limit surface and the limit points (see EvalStencilsNormals()).
+    ///
+    /// @param srcBuffer      Input primvar buffer (of at least 3 elements).
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of source data
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param normalBuffer   Output buffer of the normals
+    ///                       must have BindVBO() method returning a GL
+    ///                       buffer object of destination data
+    ///
+    /// @param normalDesc     vertex buffer descriptor for the normalBuffer
+    ///                       (of length 3)
+    ///
+    /// @param numPatchCoords number of patchCoords.
+    ///
+    /// @param patchCoords    array of locations to be evaluated.
+    ///                       must have BindVBO() method returning an
+    ///                       array of PatchCoord struct in VBO.
+    ///
+    /// @param patchTable     GLPatchTable or equivalent
+    ///
+    /// @param instance       cached compiled instance. If it's null the
+    ///                       kernel is instantiated on-demand (slow).
+    ///
+    /// @param deviceContext  not used in the GLSL evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        GLComputeEvaluator const *instance,
+        void * deviceContext = NULL) {
+
+        if (instance) {
+            return instance->EvalPatchesNormals(srcBuffer, srcDesc,
+                                                dstBuffer, dstDesc,
+                                                normalBuffer, normalDesc,
+                                                numPatchCoords, patchCoords,
+                                                patchTable);
+        } else {
+            // Create an instance on demand (slow)
+            (void)deviceContext;  // unused
+            instance = Create(srcDesc, dstDesc, normalDesc, normalDesc);
+            if (instance) {
+                bool r = instance->EvalPatchesNormals(srcBuffer, srcDesc,
+                                                      dstBuffer, dstDesc,
+                                                      normalBuffer, normalDesc,
+                                                      numPatchCoords,
+                                                      patchCoords,
+                                                      patchTable);
+                delete instance;
+                return r;
+            }
+            return false;
+        }
+    }
+
+    /// \brief Generic limit eval function writing only the unit normals of
+    ///        the limit surface (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        GLComputeEvaluator const *instance,
+        void * deviceContext = NULL) {
+
+        if (instance) {
+            return instance->EvalPatchesNormals(srcBuffer, srcDesc,
+                                                normalBuffer, normalDesc,
+                                                numPatchCoords, patchCoords,
+                                                patchTable);
+        } else {
+            // Create an instance on demand (slow)
+            (void)deviceContext;  // unused
+            instance = Create(srcDesc, BufferDescriptor(),
+                              normalDesc, normalDesc);
+            if (instance) {
+                bool r = instance->EvalPatchesNormals(srcBuffer, srcDesc,
+                                                      normalBuffer, normalDesc,
+                                                      numPatchCoords,
+                                                      patchCoords,
+                                                      patchTable);
+                delete instance;
+                return r;
+            }
+            return false;
+        }
+    }
+
+    /// \brief Generic limit eval function writing the unit normals of the
+    ///        limit surface and the limit points (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    bool EvalPatchesNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable) const {
+
+        return EvalPatchesNormals(srcBuffer->BindVBO(), srcDesc,
+                                  dstBuffer->BindVBO(), dstDesc,
+                                  normalBuffer->BindVBO(), normalDesc,
+                                  numPatchCoords,
+                                  patchCoords->BindVBO(),
+                                  patchTable->GetPatchArrays(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer(),
+                                  patchTable->GetPatchParamNormalizationBuffer());
+    }
+
+    /// \brief Generic limit eval function writing only the unit normals of
+    ///        the limit surface (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    bool EvalPatchesNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable) const {
+
+        return EvalPatchesNormals(srcBuffer->BindVBO(), srcDesc,
+                                  0, BufferDescriptor(),
+                                  normalBuffer->BindVBO(), normalDesc,
+                                  numPatchCoords,
+                                  patchCoords->BindVBO(),
+                                  patchTable->GetPatchArrays(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer(),
+                                  patchTable->GetPatchParamNormalizationBuffer());
+    }
+
+    /// \brief Dispatch the GLSL compute kernel writing the unit normals of
+    ///        patches on GPU asynchronously. The kernel is compiled on first
+    ///        use, for the descriptors given then.
+    ///
+    /// @param srcBuffer        GL buffer of input primvar source data
+    ///                         (of at least 3 elements)
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the srcBuffer
+    ///
+    /// @param dstBuffer        GL buffer of output primvar destination data,
+    ///                         or 0 to write only the normals
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the dstBuffer
+    ///
+    /// @param normalBuffer     GL buffer of the output normals
+    ///
+    /// @param normalDesc       vertex buffer descriptor for the normalBuffer
+    ///                         (of length 3)
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoordsBuffer GL buffer of PatchCoord struct
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///
+    /// @param patchIndexBuffer GL buffer of patch indices
+    ///
+    /// @param patchParamsBuffer GL buffer of Osd::PatchParam struct
+    ///
+    /// @param patchNormalizationBuffer GL buffer of the pre-expanded
+    ///                         normalizations of the patch params (or 0)
+    ///
+    bool EvalPatchesNormals(GLuint srcBuffer,    BufferDescriptor const &srcDesc,
+                            GLuint dstBuffer,    BufferDescriptor const &dstDesc,
+                            GLuint normalBuffer, BufferDescriptor const &normalDesc,
+                            int numPatchCoords,
+                            GLuint patchCoordsBuffer,
+                            const PatchArrayVector &patchArrays,
+                            GLuint patchIndexBuffer,
+                            GLuint patchParamsBuffer,
+                            GLuint patchNormalizationBuffer = 0) const;
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Displaced limit evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic limit eval function writing the limit points displaced
+    ///        along the unit normals of the limit surface, and optionally
+    ///        the normals of the displaced surface, in a single pass (see
+    ///        CpuEvaluator::EvalPatchesDisplaced()).
+    ///
+    /// The displacement is sampled from a ptex texture packed into the
+    /// pages of a GL_TEXTURE_2D_ARRAY texture, whose first channel is
+    /// the displacement, with a layout texture buffer (GL_R32I) of 6 ints
+    /// per ptex face: the page, the number of mipmaps, the u and v offsets
+    /// of the face in the page, the size differences of the adjacent faces,
+    /// and the log2 of the width and height of the face (width << 8 |
+    /// height) -- i.e. the packing of the ptex textures of the examples.
+    /// The displacement is interpolated bilinearly from the texels of the
+    /// finest level, which are expected to be bordered by those of the
+    /// adjacent faces.
+    ///
+    /// @param srcBuffer      Input primvar buffer (of at least 3 elements,
+    ///                       the first 3 of which are displaced).
+    ///                       must have BindVBO() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindVBO() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param normalBuffer   Output buffer of the normals of the displaced
+    ///                       surface (or NULL)
+    ///                       must have BindVBO() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param normalDesc     vertex buffer descriptor for the normals
+    ///                       (of length 3)
+    ///
+    /// @param numPatchCoords number of patchCoords.
+    ///
+    /// @param patchCoords    array of locations to be evaluated.
+    ///                       must have BindVBO() method returning an
+    ///                       array of PatchCoord struct in VBO.
+    ///
+    /// @param patchTable     GLPatchTable or equivalent
+    ///
+    /// @param displacementTexels  GL texture array of the texels
+    ///
+    /// @param displacementLayout  GL texture buffer of the layout
+    ///
+    /// @param displacementScale   scale applied to the displacement
+    ///
+    /// @param instance       cached compiled instance. If it's null the
+    ///                       kernel is instantiated on-demand (slow).
+    ///
+    /// @param deviceContext  not used in the GLSL evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesDisplaced(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        GLuint displacementTexels,
+        GLuint displacementLayout,
+        float displacementScale,
+        GLComputeEvaluator const *instance,
+        void * deviceContext = NULL) {
+
+        if (instance) {
+            return instance->EvalPatchesDisplaced(srcBuffer, srcDesc,
+                                                  dstBuffer, dstDesc,
+                                                  normalBuffer, normalDesc,
+                                                  numPatchCoords, patchCoords,
+                                                  patchTable,
+                                                  displacementTexels,
+                                                  displacementLayout,
+                                                  displacementScale);
+        } else {
+            // Create an instance on demand (slow)
+            (void)deviceContext;  // unused
+            instance = Create(srcDesc, dstDesc,
+                              BufferDescriptor(), BufferDescriptor());
+            if (instance) {
+                bool r = instance->EvalPatchesDisplaced(srcBuffer, srcDesc,
+                                                        dstBuffer, dstDesc,
+                                                        normalBuffer,
+                                                        normalDesc,
+                                                        numPatchCoords,
+                                                        patchCoords,
+                                                        patchTable,
+                                                        displacementTexels,
+                                                        displacementLayout,
+                                                        displacementScale);
+                delete instance;
+                return r;
+            }
+            return false;
+        }
+    }
+
+    /// \brief Generic limit eval function writing the displaced limit points
+    ///        and optionally the normals of the displaced surface (see
+    ///        above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    bool EvalPatchesDisplaced(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        GLuint displacementTexels,
+        GLuint displacementLayout,
+        float displacementScale) const {
+
+        return EvalPatchesDisplaced(srcBuffer->BindVBO(), srcDesc,
+                                    dstBuffer->BindVBO(), dstDesc,
+                                    normalBuffer ? normalBuffer->BindVBO() : 0,
+                                    normalDesc,
+                                    numPatchCoords,
+                                    patchCoords->BindVBO(),
+                                    patchTable->GetPatchArrays(),
+                                    patchTable->GetPatchIndexBuffer(),
+                                    patchTable->GetPatchParamBuffer(),
+                                    displacementTexels,
+                                    displacementLayout,
+                                    displacementScale,
+                                    patchTable->GetPatchParamNormalizationBuffer());
+    }
+
+    /// \brief Dispatch the GLSL compute kernel writing the displaced limit
+    ///        points of patches on GPU asynchronously. The kernel is compiled
+    ///        on first use, for the descriptors given then.
+    ///
+    /// @param srcBuffer        GL buffer of input primvar source data
+    ///                         (of at least 3 elements)
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the srcBuffer
+    ///
+    /// @param dstBuffer        GL buffer of output primvar destination data
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the dstBuffer
+    ///
+    /// @param normalBuffer     GL buffer of the output normals of the
+    ///                         displaced surface, or 0
+    ///
+    /// @param normalDesc       vertex buffer descriptor for the normalBuffer
+    ///                         (of length 3)
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoordsBuffer GL buffer of PatchCoord struct
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///
+    /// @param patchIndexBuffer GL buffer of patch indices
+    ///
+    /// @param patchParamsBuffer GL buffer of Osd::PatchParam struct
+    ///
+    /// @param displacementTexels GL texture array of the texels
+    ///
+    /// @param displacementLayout GL texture buffer of the layout
+    ///
+    /// @param displacementScale scale applied to the displacement
+    ///
+    /// @param patchNormalizationBuffer GL buffer of the pre-expanded
+    ///                         normalizations of the patch params (or 0)
+    ///
+    bool EvalPatchesDisplaced(GLuint srcBuffer,    BufferDescriptor const &srcDesc,
+                              GLuint dstBuffer,    BufferDescriptor const &dstDesc,
+                              GLuint normalBuffer, BufferDescriptor const &normalDesc,
+                              int numPatchCoords,
+                              GLuint patchCoordsBuffer,
+                              const PatchArrayVector &patchArrays,
+                              GLuint patchIndexBuffer,
+                              GLuint patchParamsBuffer,
+                              GLuint displacementTexels,
+                              GLuint displacementLayout,
+                              float displacementScale,
+                              GLuint patchNormalizationBuffer = 0) const;
+
     /// ----------------------------------------------------------------------
     ///
     ///   Other methods
@@ -2065,7 +3216,19 @@ private:
                      BufferDescriptor const &duuDesc,
                      BufferDescriptor const &duvDesc,
                      BufferDescriptor const &dvvDesc,
-                     int workGroupSize);
+                     int workGroupSize,
+                     bool compact = false,
+                     bool cooperative = false,
+                     bool normals = false);
+        void SetUniforms(BufferDescriptor const &srcDesc,
+                         BufferDescriptor const &dstDesc,
+                         BufferDescriptor const &duDesc,
+                         BufferDescriptor const &dvDesc,
+                         BufferDescriptor const &duuDesc,
+                         BufferDescriptor const &duvDesc,
+                         BufferDescriptor const &dvvDesc,
+                         int start, int end,
+                         bool useStencilIndices) const;
         GLuint program;
         GLuint uniformStart;
         GLuint uniformEnd;
@@ -2076,7 +3239,12 @@ private:
         GLuint uniformDuuDesc;
         GLuint uniformDuvDesc;
         GLuint uniformDvvDesc;
-    } _stencilKernel;
+        GLuint uniformUseStencilIndices;
+        GLuint uniformWritePoints;
+    } _stencilKernel, _compactStencilKernel, _cooperativeStencilKernel;
+
+    // the normal kernels are compiled on first use
+    mutable _StencilKernel _stencilNormalKernel;
 
     struct _PatchKernel {
         _PatchKernel();
@@ -2088,7 +3256,10 @@ private:
                      BufferDescriptor const &duuDesc,
                      BufferDescriptor const &duvDesc,
                      BufferDescriptor const &dvvDesc,
-                     int workGroupSize);
+                     int workGroupSize,
+                     bool stencils=false,
+                     bool normals=false,
+                     bool displacement=false);
         GLuint program;
         GLuint uniformSrcOffset;
         GLuint uniformDstOffset;
@@ -2098,7 +3269,17 @@ private:
         GLuint uniformDuuDesc;
         GLuint uniformDuvDesc;
         GLuint uniformDvvDesc;
-    } _patchKernel;
+        GLuint uniformNumControlVertices;
+        GLuint uniformPatchNormalization;
+        GLuint uniformWritePoints;
+        GLuint uniformDisplacementTexels;
+        GLuint uniformDisplacementLayout;
+        GLuint uniformDisplacementScale;
+        GLuint uniformWriteNormals;
+    } _patchKernel, _patchStencilKernel;
+
+    mutable _PatchKernel _patchNormalKernel;
+    mutable _PatchKernel _patchDisplacementKernel;
 
     int _workGroupSize;
     GLuint _patchArraysSSBO;
@@ -0,0 +1,356 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "glLoader.h"
+
+#include "../osd/glComputeTessellator.h"
+#include "../osd/glPatchTable.h"
+#include "../osd/glProgramBinaryCache.h"
+#include "../osd/glslPatchShaderSource.h"
+#include "../osd/glTessLevelComputer.h"
+
+#include "../far/error.h"
+#include "../far/patchDescriptor.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+static const char *shaderSource =
+#include "../osd/glslTessellatorKernel.gen.h"
+;
+
+// the layout of the draw command buffer: a DrawElementsIndirectCommand
+// followed by the counts of vertices and clusters and the overflow flag
+static const int drawCommandSize = 8;
+
+// the maximum number of work groups of a dimension guaranteed by GL
+static const int maxWorkGroupCount = 65535;
+
+static GLuint
+compileKernel(int workGroupSize) {
+
+    std::string patchBasisShaderSource =
+        GLSLPatchShaderSource::GetPatchBasisShaderSource();
+
+    std::ostringstream defines;
+    defines << "#define WORK_GROUP_SIZE " << workGroupSize << "\n"
+            << "#define MAX_EDGE_RATE "
+            << (int)GLComputeTessellator::MAX_EDGE_RATE << "\n"
+            << "#define OSD_PATCH_BASIS_GLSL\n";
+    std::string defineStr = defines.str();
+
+    const char *shaderSources[4] = {"#version 430\n", 0, 0, 0};
+    shaderSources[1] = defineStr.c_str();
+    shaderSources[2] = patchBasisShaderSource.c_str();
+    shaderSources[3] = shaderSource;
+
+    GLuint program = glCreateProgram();
+
+    // look up a program binary previously stored for these sources
+    std::string binaryKey;
+    if (internal::IsGLProgramBinaryCacheEnabled()) {
+        binaryKey = internal::GetGLProgramBinaryKey(shaderSources, 4);
+        if (internal::LoadGLProgramBinary(program, binaryKey)) {
+            return program;
+        }
+        internal::PrepareGLProgramBinary(program);
+    }
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 4, shaderSources, NULL);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+
+    GLint linked = 0;
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (linked == GL_FALSE) {
+        char buffer[1024];
+        glGetShaderInfoLog(shader, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glGetProgramInfoLog(program, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glDeleteShader(shader);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glDeleteShader(shader);
+
+    if (!binaryKey.empty()) {
+        internal::StoreGLProgramBinary(program, binaryKey);
+    }
+
+    return program;
+}
+
+static GLuint
+createBuffer(GLsizeiptr size, void const *data, GLenum usage) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return buffer;
+}
+
+static bool
+isTriangular(int patchType) {
+    return patchType == Far::PatchDescriptor::LOOP ||
+           patchType == Far::PatchDescriptor::TRIANGLES ||
+           patchType == Far::PatchDescriptor::GREGORY_TRIANGLE;
+}
+
+GLComputeTessellator::GLComputeTessellator(GLPatchTable const *patchTable,
+                                           int maxVertices,
+                                           int maxTriangles) :
+    _patchTable(patchTable), _patchArrays(patchTable->GetPatchArrays()),
+    _maxVertices(maxVertices), _maxTriangles(maxTriangles),
+    _program(0), _workGroupSize(64),
+    _vertexBuffer(0), _indexBuffer(0), _clusterBuffer(0),
+    _drawCommandBuffer(0) {
+}
+
+GLComputeTessellator::~GLComputeTessellator() {
+    if (_program) glDeleteProgram(_program);
+    if (_vertexBuffer) glDeleteBuffers(1, &_vertexBuffer);
+    if (_indexBuffer) glDeleteBuffers(1, &_indexBuffer);
+    if (_clusterBuffer) glDeleteBuffers(1, &_clusterBuffer);
+    if (_drawCommandBuffer) glDeleteBuffers(1, &_drawCommandBuffer);
+}
+
+GLComputeTessellator *
+GLComputeTessellator::Create(GLPatchTable const *patchTable,
+                             int maxVertices, int maxTriangles,
+                             void * /*deviceContext*/) {
+    if (patchTable == NULL || maxVertices <= 0 || maxTriangles <= 0) {
+        return NULL;
+    }
+
+    PatchArrayVector const &patchArrays = patchTable->GetPatchArrays();
+    for (int i = 0; i < (int)patchArrays.size(); ++i) {
+        int patchType = patchArrays[i].GetPatchType();
+        if (patchType == Far::PatchDescriptor::GREGORY ||
+            patchType == Far::PatchDescriptor::GREGORY_BOUNDARY) {
+            Far::Error(Far::FAR_RUNTIME_ERROR,
+                "GLComputeTessellator: legacy Gregory patches "
+                "are not supported.");
+            return NULL;
+        }
+    }
+
+    GLComputeTessellator *instance =
+        new GLComputeTessellator(patchTable, maxVertices, maxTriangles);
+    if (instance->compile()) return instance;
+    delete instance;
+    return NULL;
+}
+
+bool
+GLComputeTessellator::compile() {
+
+    _program = compileKernel(_workGroupSize);
+    if (_program == 0) return false;
+
+    // cache uniform locations
+    _uniformVertexOffset    = glGetUniformLocation(_program, "vertexOffset");
+    _uniformVertexStride    = glGetUniformLocation(_program, "vertexStride");
+    _uniformNumPatches      = glGetUniformLocation(_program, "numPatches");
+    _uniformPatchStride     = glGetUniformLocation(_program, "patchStride");
+    _uniformIndexBase       = glGetUniformLocation(_program, "indexBase");
+    _uniformPrimitiveIdBase = glGetUniformLocation(_program, "primitiveIdBase");
+    _uniformPatchType       = glGetUniformLocation(_program, "patchType");
+    _uniformRegularPatchType =
+        glGetUniformLocation(_program, "regularPatchType");
+    _uniformTriangular      = glGetUniformLocation(_program, "triangular");
+    _uniformUseTessLevelBuffer =
+        glGetUniformLocation(_program, "useTessLevelBuffer");
+    _uniformTessLevel       = glGetUniformLocation(_program, "tessLevel");
+    _uniformMaxVertices     = glGetUniformLocation(_program, "maxVertices");
+    _uniformMaxIndices      = glGetUniformLocation(_program, "maxIndices");
+    _uniformTessLevelBuffer =
+        glGetUniformLocation(_program, "OsdTessLevelBuffer");
+    _uniformPatchEdgeBuffer =
+        glGetUniformLocation(_program, "OsdPatchEdgeBuffer");
+
+    int numPatches = 0;
+    for (int i = 0; i < (int)_patchArrays.size(); ++i) {
+        numPatches += _patchArrays[i].GetNumPatches();
+    }
+
+    _vertexBuffer = createBuffer(
+        (GLsizeiptr)_maxVertices * VERTEX_SIZE, NULL, GL_DYNAMIC_COPY);
+    _indexBuffer = createBuffer(
+        (GLsizeiptr)_maxTriangles * 3 * sizeof(GLuint), NULL,
+        GL_DYNAMIC_COPY);
+    _clusterBuffer = createBuffer(
+        (GLsizeiptr)std::max(numPatches, 1) * CLUSTER_SIZE, NULL,
+        GL_DYNAMIC_COPY);
+    _drawCommandBuffer = createBuffer(
+        drawCommandSize * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+
+    return true;
+}
+
+void
+GLComputeTessellator::Tessellate(GLuint vertexBuffer,
+                                 BufferDescriptor const &vertexDesc,
+                                 float tessLevel) {
+    tessellate(vertexBuffer, vertexDesc, tessLevel, NULL);
+}
+
+void
+GLComputeTessellator::Tessellate(GLuint vertexBuffer,
+                                 BufferDescriptor const &vertexDesc,
+                                 GLTessLevelComputer const *tessLevels) {
+    if (tessLevels == NULL) return;
+    tessellate(vertexBuffer, vertexDesc, 1.0f, tessLevels);
+}
+
+void
+GLComputeTessellator::tessellate(GLuint vertexBuffer,
+                                 BufferDescriptor const &vertexDesc,
+                                 float tessLevel,
+                                 GLTessLevelComputer const *tessLevels) {
+
+    // reset the draw command and counts
+    GLuint initialDrawCommand[drawCommandSize] = {
+        0,      // count
+        1,      // instanceCount
+        0,      // firstIndex
+        0,      // baseVertex
+        0,      // baseInstance
+        0,      // number of vertices
+        0,      // number of clusters
+        0 };    // overflow
+    glBindBuffer(GL_ARRAY_BUFFER, _drawCommandBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(initialDrawCommand),
+                    initialDrawCommand);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    int numPatchArrays = (int)_patchArrays.size();
+    if (numPatchArrays == 0) return;
+
+    glUseProgram(_program);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vertexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1,
+                     _patchTable->GetPatchIndexBuffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2,
+                     _patchTable->GetPatchParamBuffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _vertexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _indexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, _clusterBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, _drawCommandBuffer);
+
+    // the levels of the edge segments are read as texture buffers
+    if (tessLevels) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER,
+                      tessLevels->GetTessLevelTextureBuffer());
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER,
+                      tessLevels->GetPatchEdgeTextureBuffer());
+        glUniform1i(_uniformTessLevelBuffer, 0);
+        glUniform1i(_uniformPatchEdgeBuffer, 1);
+    }
+
+    glUniform1i(_uniformVertexOffset, vertexDesc.offset);
+    glUniform1i(_uniformVertexStride, vertexDesc.stride);
+    glUniform1i(_uniformUseTessLevelBuffer, tessLevels ? 1 : 0);
+    glUniform1f(_uniformTessLevel, tessLevel);
+    glUniform1ui(_uniformMaxVertices, (GLuint)_maxVertices);
+    glUniform1ui(_uniformMaxIndices, (GLuint)_maxTriangles * 3);
+
+    for (int i = 0; i < numPatchArrays; ++i) {
+        PatchArray const &patchArray = _patchArrays[i];
+        int numPatches = patchArray.GetNumPatches();
+        if (numPatches == 0) continue;
+
+        glUniform1i(_uniformNumPatches, numPatches);
+        glUniform1i(_uniformPatchStride, patchArray.GetStride());
+        glUniform1i(_uniformIndexBase, patchArray.GetIndexBase());
+        glUniform1i(_uniformPrimitiveIdBase, patchArray.GetPrimitiveIdBase());
+        glUniform1i(_uniformPatchType, patchArray.GetPatchTypeIrregular());
+        glUniform1i(_uniformRegularPatchType,
+                    patchArray.GetPatchTypeRegular());
+        glUniform1i(_uniformTriangular,
+                    isTriangular(patchArray.GetPatchTypeRegular()) ? 1 : 0);
+
+        // a work group per patch, in rows of at most maxWorkGroupCount
+        int numGroupsX = std::min(numPatches, maxWorkGroupCount);
+        int numGroupsY = (numPatches + numGroupsX - 1) / numGroupsX;
+        glDispatchCompute(numGroupsX, numGroupsY, 1);
+    }
+
+    glUseProgram(0);
+
+    if (tessLevels) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // the outputs are read as vertices, indices, draw commands and storage
+    // buffers (e.g. by mesh shaders)
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+                    GL_ELEMENT_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT |
+                    GL_BUFFER_UPDATE_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+
+    for (int i = 0; i < 7; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+}
+
+bool
+GLComputeTessellator::GetCounts(int *numVertices, int *numTriangles,
+                                int *numClusters) const {
+
+    GLuint drawCommand[drawCommandSize];
+    glBindBuffer(GL_ARRAY_BUFFER, _drawCommandBuffer);
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(drawCommand), drawCommand);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (numVertices) *numVertices = (int)drawCommand[5];
+    if (numTriangles) *numTriangles = (int)drawCommand[0] / 3;
+    if (numClusters) *numClusters = (int)drawCommand[6];
+    return drawCommand[7] == 0;
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,209 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_GL_COMPUTE_TESSELLATOR_H
+#define OPENSUBDIV3_OSD_GL_COMPUTE_TESSELLATOR_H
+
+#include "../version.h"
+
+#include "../osd/opengl.h"
+#include "../osd/nonCopyable.h"
+#include "../osd/types.h"
+#include "../osd/bufferDescriptor.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+class GLPatchTable;
+class GLTessLevelComputer;
+
+/// \brief Tessellation of the patches of a GLPatchTable by a compute pass
+///
+/// GLComputeTessellator tessellates each patch of a GLPatchTable into a
+/// cluster of triangles -- a meshlet -- with the adaptive rates of its edges,
+/// without the fixed-function tessellator. Each patch has the tessellation
+/// pattern of CpuTessellator: its boundary vertices are spaced by the rates
+/// of its edges (the two halves of transition edges being spaced
+/// separately), so that the vertices of an edge match those of the
+/// neighboring patch sharing it and the tessellation is crack-free.
+///
+/// The evaluated vertices (position, normal and the (u,v) of the base face)
+/// and the triangles of the patches are appended to the vertex and index
+/// buffers of the tessellator, and each patch appends a cluster describing
+/// its range of vertices and triangles, e.g. for a mesh shader processing a
+/// cluster per work group. All of the triangles are also drawn without any
+/// readback by a DrawElementsIndirectCommand:
+///
+///     tessellator->Tessellate(vertexBuffer->BindVBO(), vertexDesc,
+///                             tessLevelComputer);
+///
+///     // vertex attributes from tessellator->GetVertexBuffer()
+///     //   (VERTEX_SIZE bytes: position, normal, uv)
+///     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tessellator->GetIndexBuffer());
+///     glBindBuffer(GL_DRAW_INDIRECT_BUFFER,
+///                  tessellator->GetDrawCommandBuffer());
+///     glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0);
+///
+/// The patches which do not fit in the capacities given on creation are
+/// skipped, which is reported by GetCounts(). The legacy Gregory patches are
+/// not supported.
+///
+class GLComputeTessellator : private NonCopyable<GLComputeTessellator> {
+public:
+    /// size in bytes of each vertex of the vertex buffer
+    enum { VERTEX_SIZE = 8 * sizeof(GLfloat) };
+
+    /// size in bytes of each cluster of the cluster buffer: the first
+    /// vertex, number of vertices, first index, number of triangles and
+    /// patch index, padded to 8 GLuints
+    enum { CLUSTER_SIZE = 8 * sizeof(GLuint) };
+
+    /// the maximum rate of an edge (or of each half of a transition edge)
+    enum { MAX_EDGE_RATE = 64 };
+
+    /// \brief Creates the tessellator of the patches of a GLPatchTable (or
+    ///        NULL if not supported or the kernel fails to compile)
+    ///
+    /// @param patchTable     the patch table, which must outlive the
+    ///                       tessellator
+    ///
+    /// @param maxVertices    the capacity of the vertex buffer
+    ///
+    /// @param maxTriangles   the capacity of the index buffer
+    ///
+    /// @param deviceContext  not used
+    ///
+    static GLComputeTessellator *Create(GLPatchTable const *patchTable,
+                                        int maxVertices, int maxTriangles,
+                                        void *deviceContext = NULL);
+
+    ~GLComputeTessellator();
+
+    /// \brief Tessellates the patches with the uniform tessellation level
+    ///        of the patch shaders (see OsdGetTessLevelsUniform())
+    ///
+    /// @param vertexBuffer     GL buffer of the refined vertices (and local
+    ///                         points) of the patch table
+    ///
+    /// @param vertexDesc       descriptor of the 3 position elements of the
+    ///                         vertices
+    ///
+    /// @param tessLevel        the level of the patches of the first level,
+    ///                         halved at each refinement level
+    ///
+    void Tessellate(GLuint vertexBuffer, BufferDescriptor const &vertexDesc,
+                    float tessLevel);
+
+    /// \brief Tessellates the patches with the screen-space levels of their
+    ///        edges last computed by a GLTessLevelComputer
+    ///
+    /// @param vertexBuffer     GL buffer of the refined vertices (and local
+    ///                         points) of the patch table
+    ///
+    /// @param vertexDesc       descriptor of the 3 position elements of the
+    ///                         vertices
+    ///
+    /// @param tessLevels       the computer of the levels, created for the
+    ///                         same patch table
+    ///
+    void Tessellate(GLuint vertexBuffer, BufferDescriptor const &vertexDesc,
+                    GLTessLevelComputer const *tessLevels);
+
+    /// Returns the GL buffer of the tessellated vertices
+    GLuint GetVertexBuffer() const { return _vertexBuffer; }
+
+    /// Returns the GL index buffer of the triangles of the clusters
+    GLuint GetIndexBuffer() const { return _indexBuffer; }
+
+    /// \brief Returns the GL buffer of the clusters (CLUSTER_SIZE bytes
+    ///        each, in no particular order)
+    GLuint GetClusterBuffer() const { return _clusterBuffer; }
+
+    /// \brief Returns the GL buffer of the DrawElementsIndirectCommand of
+    ///        the triangles, followed by the number of vertices, the number
+    ///        of clusters and a flag set if patches were skipped
+    GLuint GetDrawCommandBuffer() const { return _drawCommandBuffer; }
+
+    /// Returns the capacity of the vertex buffer
+    int GetMaxVertices() const { return _maxVertices; }
+
+    /// Returns the capacity of the index buffer in triangles
+    int GetMaxTriangles() const { return _maxTriangles; }
+
+    /// \brief Reads back the counts of the last tessellation (stalls until
+    ///        it is complete) and returns false if patches were skipped
+    bool GetCounts(int *numVertices, int *numTriangles,
+                   int *numClusters) const;
+
+protected:
+    GLComputeTessellator(GLPatchTable const *patchTable,
+                         int maxVertices, int maxTriangles);
+
+    bool compile();
+
+    void tessellate(GLuint vertexBuffer, BufferDescriptor const &vertexDesc,
+                    float tessLevel, GLTessLevelComputer const *tessLevels);
+
+private:
+    GLPatchTable const * _patchTable;
+    PatchArrayVector _patchArrays;
+    int _maxVertices;
+    int _maxTriangles;
+
+    GLuint _program;
+    int _workGroupSize;
+
+    GLint _uniformVertexOffset;
+    GLint _uniformVertexStride;
+    GLint _uniformNumPatches;
+    GLint _uniformPatchStride;
+    GLint _uniformIndexBase;
+    GLint _uniformPrimitiveIdBase;
+    GLint _uniformPatchType;
+    GLint _uniformRegularPatchType;
+    GLint _uniformTriangular;
+    GLint _uniformUseTessLevelBuffer;
+    GLint _uniformTessLevel;
+    GLint _uniformMaxVertices;
+    GLint _uniformMaxIndices;
+    GLint _uniformTessLevelBuffer;
+    GLint _uniformPatchEdgeBuffer;
+
+    GLuint _vertexBuffer;
+    GLuint _indexBuffer;
+    GLuint _clusterBuffer;
+    GLuint _drawCommandBuffer;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_GL_COMPUTE_TESSELLATOR_H
@@ -0,0 +1,269 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "glLoader.h"
+
+#include "../osd/glHybridEvaluator.h"
+#include "../osd/glComputeEvaluator.h"
+
+#ifdef OPENSUBDIV_HAS_TBB
+#include "../osd/tbbEvaluator.h"
+#else
+#include "../osd/cpuEvaluator.h"
+#endif
+
+#include "../far/stencilTable.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+// weight of the latest measure in the smoothed throughputs
+static const double rateSmoothing = 0.25;
+
+// bounds of an adaptive split, so that both sides keep being measured
+static const float minAdaptiveFraction = 0.02f;
+static const float maxAdaptiveFraction = 0.98f;
+
+GLHybridStencilTable::GLHybridStencilTable(
+    Far::StencilTable const *stencilTable) :
+    _sizes(stencilTable->GetSizes()),
+    _offsets(stencilTable->GetOffsets()),
+    _indices(stencilTable->GetControlIndices()),
+    _weights(stencilTable->GetWeights()),
+    _ssboTable(GLStencilTableSSBO::Create(stencilTable)),
+    _numStencils(stencilTable->GetNumStencils()) {
+}
+
+GLHybridStencilTable::~GLHybridStencilTable() {
+    delete _ssboTable;
+}
+
+// ---------------------------------------------------------------------------
+
+GLHybridEvaluator::GLHybridEvaluator() :
+    _glEvaluator(NULL), _cpuFraction(0.5f), _adaptive(true),
+    _cpuRate(0), _glRate(0), _query(0), _queryStencils(0) {
+
+    // Initialize internal OpenGL loader library if necessary
+    OpenSubdiv::internal::GLLoader::libraryInitializeGL();
+}
+
+GLHybridEvaluator::~GLHybridEvaluator() {
+    if (_query) {
+        glDeleteQueries(1, &_query);
+    }
+    delete _glEvaluator;
+}
+
+GLHybridEvaluator *
+GLHybridEvaluator::Create(BufferDescriptor const &srcDesc,
+                          BufferDescriptor const &dstDesc,
+                          BufferDescriptor const &duDesc,
+                          BufferDescriptor const &dvDesc,
+                          BufferDescriptor const &duuDesc,
+                          BufferDescriptor const &duvDesc,
+                          BufferDescriptor const &dvvDesc,
+                          void * deviceContext) {
+    (void)deviceContext;  // not used
+
+    // derivatives are not supported
+    if (duDesc.length > 0 || dvDesc.length > 0 || duuDesc.length > 0 ||
+        duvDesc.length > 0 || dvvDesc.length > 0) {
+        return NULL;
+    }
+
+    GLHybridEvaluator *instance = new GLHybridEvaluator();
+    if (instance->Compile(srcDesc, dstDesc)) return instance;
+    delete instance;
+    return NULL;
+}
+
+bool
+GLHybridEvaluator::Compile(BufferDescriptor const &srcDesc,
+                           BufferDescriptor const &dstDesc) {
+
+    _glEvaluator = GLComputeEvaluator::Create(srcDesc, dstDesc,
+                                              BufferDescriptor(),
+                                              BufferDescriptor());
+    if (!_glEvaluator) return false;
+
+    glGenQueries(1, &_query);
+    return true;
+}
+
+/* static */
+void
+GLHybridEvaluator::Synchronize(void *deviceContext) {
+    GLComputeEvaluator::Synchronize(deviceContext);
+}
+
+void
+GLHybridEvaluator::SetCpuFraction(float fraction, bool adaptive) {
+    _cpuFraction = std::min(std::max(fraction, 0.0f), 1.0f);
+    _adaptive = adaptive;
+    _cpuRate = _glRate = 0;
+}
+
+int
+GLHybridEvaluator::getSplit(int numStencils) const {
+
+    updateFraction();
+
+    return std::min((int)(_cpuFraction * (float)numStencils + 0.5f),
+                    numStencils);
+}
+
+void
+GLHybridEvaluator::getVertexRange(BufferDescriptor const &dstDesc,
+                                  int numElements, int numStencils,
+                                  int *first, int *count) const {
+
+    // vertices of the buffer holding elements of the first numStencils
+    // stencils written with the descriptor
+    int begin = dstDesc.offset;
+    int end = dstDesc.offset + (numStencils-1) * dstDesc.stride +
+              dstDesc.length;
+
+    *first = begin / numElements;
+    *count = (end + numElements - 1) / numElements - *first;
+}
+
+bool
+GLHybridEvaluator::evalGLStencils(GLuint srcBuffer,
+                                  BufferDescriptor const &srcDesc,
+                                  GLuint dstBuffer,
+                                  BufferDescriptor const &dstDesc,
+                                  GLHybridStencilTable const *stencilTable,
+                                  int start, int end) const {
+
+    GLStencilTableSSBO const *table = stencilTable->GetSSBOTable();
+
+    // time the dispatch unless the previous one is still being measured
+    bool timed = _adaptive && (_queryStencils == 0);
+    if (timed) {
+        glBeginQuery(GL_TIME_ELAPSED, _query);
+    }
+
+    bool r = _glEvaluator->EvalStencils(srcBuffer, srcDesc,
+                                        dstBuffer, dstDesc,
+                                        0, BufferDescriptor(),
+                                        0, BufferDescriptor(),
+                                        table->GetSizesBuffer(),
+                                        table->GetOffsetsBuffer(),
+                                        table->GetIndicesBuffer(),
+                                        table->GetWeightsBuffer(),
+                                        0, 0,
+                                        start, end);
+    if (timed) {
+        glEndQuery(GL_TIME_ELAPSED);
+        _queryStencils = end - start;
+    }
+
+    // start the kernel before the cpu takes over
+    glFlush();
+
+    return r;
+}
+
+bool
+GLHybridEvaluator::evalCpuStencils(const float *src,
+                                   BufferDescriptor const &srcDesc,
+                                   float *dst,
+                                   BufferDescriptor const &dstDesc,
+                                   GLHybridStencilTable const *stencilTable,
+                                   int start, int end) const {
+
+    std::chrono::steady_clock::time_point t0 =
+        std::chrono::steady_clock::now();
+
+#ifdef OPENSUBDIV_HAS_TBB
+    bool r = TbbEvaluator::EvalStencils(
+#else
+    bool r = CpuEvaluator::EvalStencils(
+#endif
+        src, srcDesc, dst, dstDesc,
+        stencilTable->GetSizes(),
+        stencilTable->GetOffsets(),
+        stencilTable->GetIndices(),
+        stencilTable->GetWeights(),
+        start, end);
+
+    if (_adaptive) {
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - t0).count();
+        if (seconds > 0) {
+            double rate = (double)(end - start) / seconds;
+            _cpuRate = (_cpuRate > 0)
+                     ? (1.0 - rateSmoothing) * _cpuRate + rateSmoothing * rate
+                     : rate;
+        }
+    }
+    return r;
+}
+
+void
+GLHybridEvaluator::updateFraction() const {
+
+    if (!_adaptive) return;
+
+    // collect the time of the last timed GL share once available, without
+    // waiting for it
+    if (_queryStencils > 0) {
+        GLint available = 0;
+        glGetQueryObjectiv(_query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(_query, GL_QUERY_RESULT, &nanoseconds);
+            if (nanoseconds > 0) {
+                double rate = (double)_queryStencils * 1.0e9 /
+                              (double)nanoseconds;
+                _glRate = (_glRate > 0)
+                        ? (1.0 - rateSmoothing) * _glRate + rateSmoothing * rate
+                        : rate;
+            }
+            _queryStencils = 0;
+        }
+    }
+
+    // both sides finish together when the stencils are split in
+    // proportion to their throughputs
+    if (_cpuRate > 0 && _glRate > 0) {
+        float fraction = (float)(_cpuRate / (_cpuRate + _glRate));
+        _cpuFraction = std::min(std::max(fraction, minAdaptiveFraction),
+                                maxAdaptiveFraction);
+    } else {
+        _cpuFraction = std::min(std::max(_cpuFraction, minAdaptiveFraction),
+                                maxAdaptiveFraction);
+    }
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,338 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_OSD_GL_HYBRID_EVALUATOR_H
+#define OPENSUBDIV3_OSD_GL_HYBRID_EVALUATOR_H
+
+#include "../version.h"
+
+#include "../osd/opengl.h"
+#include "../osd/types.h"
+#include "../osd/bufferDescriptor.h"
+#include "../far/types.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class StencilTable;
+}
+
+namespace Osd {
+
+class GLComputeEvaluator;
+class GLStencilTableSSBO;
+
+/// \brief Stencil table shared by the cpu and GL halves of the
+///        GLHybridEvaluator
+///
+/// This class holds both a cpu copy of the stencils of a Far::StencilTable
+/// and their GLStencilTableSSBO representation, so that any range of the
+/// stencils can be evaluated on either side.
+///
+class GLHybridStencilTable {
+public:
+    static GLHybridStencilTable *Create(Far::StencilTable const *stencilTable,
+                                        void *deviceContext = NULL) {
+        (void)deviceContext;  // unused
+        return new GLHybridStencilTable(stencilTable);
+    }
+
+    explicit GLHybridStencilTable(Far::StencilTable const *stencilTable);
+
+    /// Destructor. note that the GL context must be made current.
+    ~GLHybridStencilTable();
+
+    int GetNumStencils() const { return _numStencils; }
+
+    // interfaces needed for the cpu kernels
+    int const * GetSizes() const {
+        return _sizes.empty() ? NULL : &_sizes[0];
+    }
+    Far::Offset const * GetOffsets() const {
+        return _offsets.empty() ? NULL : &_offsets[0];
+    }
+    int const * GetIndices() const {
+        return _indices.empty() ? NULL : &_indices[0];
+    }
+    float const * GetWeights() const {
+        return _weights.empty() ? NULL : &_weights[0];
+    }
+
+    // interface needed for GLSLComputeKernel
+    GLStencilTableSSBO const * GetSSBOTable() const { return _ssboTable; }
+
+private:
+    std::vector<int> _sizes;
+    std::vector<Far::Offset> _offsets;
+    std::vector<int> _indices;
+    std::vector<float> _weights;
+    GLStencilTableSSBO *_ssboTable;
+    int _numStencils;
+};
+
+// ---------------------------------------------------------------------------
+
+/// \brief Stencil evaluator splitting the stencils between the cpu and GL
+///
+/// GLHybridEvaluator evaluates the leading stencils of a table with the
+/// TbbEvaluator (or the CpuEvaluator when TBB is not available) while the
+/// remaining stencils are evaluated by the GLComputeEvaluator, so that an
+/// idle cpu contributes to the refinement of meshes drawn with GL. The
+/// compute kernel is dispatched first and runs while the cpu evaluates its
+/// share, which is then uploaded into the same GL buffer.
+///
+/// The split adapts to the throughput measured for each side: the time of
+/// the cpu share is measured on the host, and that of the GL share with a
+/// timer query read back (without waiting) on a later evaluation. The
+/// fraction of stencils given to the cpu converges to the fraction of the
+/// combined throughput it provides, so that both sides finish together.
+///
+/// The destination buffer must provide both BindVBO() and a ranged
+/// BindCpuBuffer(startVertex, numVertices), e.g. CpuGLVertexBuffer. Since
+/// the vertices refined by GL are not read back, the stencils may only
+/// refer to source vertices kept up to date in cpu memory (e.g. control
+/// vertices supplied with UpdateData, as for the factorized stencil tables
+/// of Osd::Mesh), and only primvars are evaluated (no derivatives).
+///
+class GLHybridEvaluator {
+public:
+    typedef bool Instantiatable;
+    static GLHybridEvaluator * Create(BufferDescriptor const &srcDesc,
+                                      BufferDescriptor const &dstDesc,
+                                      BufferDescriptor const &duDesc,
+                                      BufferDescriptor const &dvDesc,
+                                      void * deviceContext = NULL) {
+        return Create(srcDesc, dstDesc, duDesc, dvDesc,
+                      BufferDescriptor(),
+                      BufferDescriptor(),
+                      BufferDescriptor(),
+                      deviceContext);
+    }
+
+    /// Returns NULL if derivatives are requested, which are not supported.
+    static GLHybridEvaluator * Create(BufferDescriptor const &srcDesc,
+                                      BufferDescriptor const &dstDesc,
+                                      BufferDescriptor const &duDesc,
+                                      BufferDescriptor const &dvDesc,
+                                      BufferDescriptor const &duuDesc,
+                                      BufferDescriptor const &duvDesc,
+                                      BufferDescriptor const &dvvDesc,
+                                      void * deviceContext = NULL);
+
+    /// Destructor. note that the GL context must be made current.
+    ~GLHybridEvaluator();
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Stencil evaluations with StencilTable
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static stencil function. This function has a same
+    ///        signature as other device kernels have so that it can be called
+    ///        transparently from OsdMesh template interface.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer(start, count) and
+    ///                       BindVBO() methods
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer(start, count) and
+    ///                       BindVBO() methods
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   GLHybridStencilTable to be applied
+    ///
+    /// @param instance       cached compiled instance. Clients are supposed to
+    ///                       pre-compile an instance of this class and provide
+    ///                       to this function. If it's null the kernel still
+    ///                       compute by instantiating on-demand kernel although
+    ///                       it may cause a performance problem, and the split
+    ///                       of the stencils can not adapt.
+    ///
+    /// @param deviceContext  not used in the hybrid kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        GLHybridStencilTable const *stencilTable,
+        GLHybridEvaluator const *instance,
+        void * deviceContext = NULL) {
+
+        if (instance) {
+            return instance->EvalStencils(srcBuffer, srcDesc,
+                                          dstBuffer, dstDesc,
+                                          stencilTable);
+        } else {
+            // Create an instance on demand (slow)
+            instance = Create(srcDesc, dstDesc,
+                              BufferDescriptor(),
+                              BufferDescriptor(), deviceContext);
+            if (instance) {
+                bool r = instance->EvalStencils(srcBuffer, srcDesc,
+                                                dstBuffer, dstDesc,
+                                                stencilTable);
+                delete instance;
+                return r;
+            }
+            return false;
+        }
+    }
+
+    /// \brief Generic stencil function.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer(start, count) and
+    ///                       BindVBO() methods
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer(start, count) and
+    ///                       BindVBO() methods
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   GLHybridStencilTable to be applied
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        GLHybridStencilTable const *stencilTable) const {
+
+        int numStencils = stencilTable->GetNumStencils();
+        if (numStencils == 0) return true;
+
+        int split = getSplit(numStencils);
+
+        // dispatch the GL share first, so that it runs during the cpu share
+        // (binding uploads the pending source vertices)
+        GLuint srcVBO = srcBuffer->BindVBO();
+        GLuint dstVBO = dstBuffer->BindVBO();
+        if (split < numStencils) {
+            if (!evalGLStencils(srcVBO, srcDesc, dstVBO, dstDesc,
+                                stencilTable, split, numStencils)) {
+                return false;
+            }
+        }
+
+        if (split > 0) {
+            // mark only the vertices of the cpu share for upload
+            int first = 0, count = 0;
+            getVertexRange(dstDesc, dstBuffer->GetNumElements(), split,
+                           &first, &count);
+
+            const float *src = srcBuffer->BindCpuBuffer(0, 0);
+            float *dst = dstBuffer->BindCpuBuffer(first, count);
+
+            if (!evalCpuStencils(src, srcDesc, dst, dstDesc,
+                                 stencilTable, 0, split)) {
+                return false;
+            }
+            dstBuffer->BindVBO();
+        }
+        return true;
+    }
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Split of the stencils
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Sets the fraction of the stencils evaluated on the cpu
+    ///
+    /// @param fraction   fraction of the stencils in [0, 1]
+    ///
+    /// @param adaptive   if true, the fraction keeps adapting to the
+    ///                   measured throughputs from this initial value
+    ///
+    void SetCpuFraction(float fraction, bool adaptive = true);
+
+    /// Returns the current fraction of the stencils evaluated on the cpu
+    float GetCpuFraction() const { return _cpuFraction; }
+
+    /// Returns true if the fraction adapts to the measured throughputs
+    bool IsAdaptive() const { return _adaptive; }
+
+    /// Wait the dispatched kernel finishes (the cpu share is evaluated
+    /// synchronously).
+    static void Synchronize(void *deviceContext);
+
+protected:
+    /// Constructor.
+    GLHybridEvaluator();
+
+    /// Configure the GL compute kernel. Returns false if it fails to compile.
+    bool Compile(BufferDescriptor const &srcDesc,
+                 BufferDescriptor const &dstDesc);
+
+private:
+    int getSplit(int numStencils) const;
+
+    void getVertexRange(BufferDescriptor const &dstDesc, int numElements,
+                        int numStencils, int *first, int *count) const;
+
+    bool evalGLStencils(GLuint srcBuffer, BufferDescriptor const &srcDesc,
+                        GLuint dstBuffer, BufferDescriptor const &dstDesc,
+                        GLHybridStencilTable const *stencilTable,
+                        int start, int end) const;
+
+    bool evalCpuStencils(const float *src, BufferDescriptor const &srcDesc,
+                         float *dst, BufferDescriptor const &dstDesc,
+                         GLHybridStencilTable const *stencilTable,
+                         int start, int end) const;
+
+    void updateFraction() const;
+
+    GLComputeEvaluator *_glEvaluator;
+
+    // The split is adjusted as the evaluations of a (const) instance cached
+    // by Osd::Mesh are measured
+    mutable float _cpuFraction;
+    bool _adaptive;
+
+    mutable double _cpuRate;            // stencils per second
+    mutable double _glRate;
+
+    GLuint _query;                      // GL_TIME_ELAPSED of the GL share
+    mutable int _queryStencils;         // stencils timed by the pending query
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_GL_HYBRID_EVALUATOR_H
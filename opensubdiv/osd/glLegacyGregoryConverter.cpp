@@ -0,0 +1,320 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "glLoader.h"
+
+#include "../osd/glLegacyGregoryConverter.h"
+#include "../osd/glProgramBinaryCache.h"
+
+#include "../far/error.h"
+#include "../far/patchTable.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+static const char *shaderSource =
+#include "../osd/glslLegacyGregoryKernel.gen.h"
+;
+static const char *patchLegacyShaderSource =
+#include "../osd/glslPatchLegacy.gen.h"
+;
+
+static GLuint
+compileKernel(int workGroupSize, Far::PatchDescriptor::Type type,
+              int maxValence) {
+
+    std::ostringstream defines;
+    defines << "#define WORK_GROUP_SIZE " << workGroupSize << "\n"
+            << "#define OSD_MAX_VALENCE " << maxValence << "\n";
+    if (type == Far::PatchDescriptor::GREGORY) {
+        defines << "#define OSD_PATCH_GREGORY\n";
+    } else {
+        defines << "#define OSD_PATCH_GREGORY_BOUNDARY\n";
+    }
+    std::string defineStr = defines.str();
+
+    // the declarations of the kernel, the legacy Gregory functions, and the
+    // main function of the kernel
+    const char *shaderSources[6] = {"#version 430\n", 0, 0, 0, 0, 0};
+    shaderSources[1] = defineStr.c_str();
+    shaderSources[2] = shaderSource;
+    shaderSources[3] = patchLegacyShaderSource;
+    shaderSources[4] = "#define OSD_LEGACY_GREGORY_KERNEL_MAIN\n";
+    shaderSources[5] = shaderSource;
+
+    GLuint program = glCreateProgram();
+
+    // look up a program binary previously stored for these sources
+    std::string binaryKey;
+    if (internal::IsGLProgramBinaryCacheEnabled()) {
+        binaryKey = internal::GetGLProgramBinaryKey(shaderSources, 6);
+        if (internal::LoadGLProgramBinary(program, binaryKey)) {
+            return program;
+        }
+        internal::PrepareGLProgramBinary(program);
+    }
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 6, shaderSources, NULL);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+
+    GLint linked = 0;
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (linked == GL_FALSE) {
+        char buffer[1024];
+        glGetShaderInfoLog(shader, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glGetProgramInfoLog(program, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glDeleteShader(shader);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glDeleteShader(shader);
+
+    if (!binaryKey.empty()) {
+        internal::StoreGLProgramBinary(program, binaryKey);
+    }
+
+    return program;
+}
+
+template <class T> static GLuint
+createSSBO(std::vector<T> const & src) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, src.size()*sizeof(T),
+                 src.empty() ? NULL : &src[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return buffer;
+}
+
+static GLuint
+createTextureBuffer(GLenum format, GLuint buffer) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    return texture;
+}
+
+GLLegacyGregoryConverter::GLLegacyGregoryConverter() :
+    _numPatches(0), _workGroupSize(64),
+    _vertexTexture(0), _cornerIndexBuffer(0),
+    _valenceBuffer(0), _valenceTexture(0),
+    _quadOffsetBuffer(0), _quadOffsetTexture(0),
+    _gregoryBasisBuffer(0), _patchIndexBuffer(0) {
+
+    // Initialize internal OpenGL loader library if necessary
+    OpenSubdiv::internal::GLLoader::libraryInitializeGL();
+}
+
+GLLegacyGregoryConverter::~GLLegacyGregoryConverter() {
+    for (int i = 0; i < 2; ++i) {
+        if (_kernels[i].program) glDeleteProgram(_kernels[i].program);
+    }
+    if (_vertexTexture) glDeleteTextures(1, &_vertexTexture);
+    if (_cornerIndexBuffer) glDeleteBuffers(1, &_cornerIndexBuffer);
+    if (_valenceBuffer) glDeleteBuffers(1, &_valenceBuffer);
+    if (_valenceTexture) glDeleteTextures(1, &_valenceTexture);
+    if (_quadOffsetBuffer) glDeleteBuffers(1, &_quadOffsetBuffer);
+    if (_quadOffsetTexture) glDeleteTextures(1, &_quadOffsetTexture);
+    if (_gregoryBasisBuffer) glDeleteBuffers(1, &_gregoryBasisBuffer);
+    if (_patchIndexBuffer) glDeleteBuffers(1, &_patchIndexBuffer);
+}
+
+GLLegacyGregoryConverter *
+GLLegacyGregoryConverter::Create(Far::PatchTable const *patchTable,
+                                 void * /*deviceContext*/) {
+    if (patchTable == NULL) return NULL;
+
+    GLLegacyGregoryConverter *instance = new GLLegacyGregoryConverter();
+    if (instance->allocate(patchTable)) return instance;
+    delete instance;
+    return NULL;
+}
+
+bool
+GLLegacyGregoryConverter::allocate(Far::PatchTable const *patchTable) {
+
+    Far::PatchDescriptor const types[2] = {
+        Far::PatchDescriptor::GREGORY,
+        Far::PatchDescriptor::GREGORY_BOUNDARY };
+    Far::PatchDescriptor const gregoryBasis(
+        Far::PatchDescriptor::GREGORY_BASIS);
+
+    // the corner vertices of the legacy Gregory patches, the boundary
+    // patches following the interior ones as their quad offsets do
+    std::vector<int> cornerIndices;
+    int primitiveIdBase = 0;
+    for (int k = 0; k < 2; ++k) {
+        Kernel &kernel = _kernels[k];
+        kernel.indexBase = (int)cornerIndices.size();
+        kernel.quadOffsetBase = kernel.indexBase;
+        kernel.pointBase = _numPatches * 20;
+
+        primitiveIdBase = 0;
+        for (int array = 0; array < patchTable->GetNumPatchArrays();
+             ++array) {
+            int numPatches = patchTable->GetNumPatches(array);
+            if (patchTable->GetPatchArrayDescriptor(array) == types[k]) {
+                Far::ConstIndexArray cvs =
+                    patchTable->GetPatchArrayVertices(array);
+                cornerIndices.insert(cornerIndices.end(),
+                                     cvs.begin(), cvs.end());
+
+                _patchArrays.push_back(PatchArray(gregoryBasis, numPatches,
+                    kernel.pointBase + kernel.numPatches * 20,
+                    primitiveIdBase));
+                kernel.numPatches += numPatches;
+            }
+            primitiveIdBase += numPatches;
+        }
+        _numPatches += kernel.numPatches;
+    }
+    if (_numPatches == 0) return true;
+
+    for (int k = 0; k < 2; ++k) {
+        if (_kernels[k].numPatches == 0) continue;
+
+        _kernels[k].program = compileKernel(_workGroupSize, types[k].GetType(),
+                                            patchTable->GetMaxValence());
+        if (_kernels[k].program == 0) return false;
+    }
+
+    std::vector<int> valences(patchTable->GetVertexValenceTable().begin(),
+                              patchTable->GetVertexValenceTable().end());
+    std::vector<int> quadOffsets(patchTable->GetQuadOffsetsTable().begin(),
+                                 patchTable->GetQuadOffsetsTable().end());
+
+    // the points of each patch are consecutive
+    std::vector<int> patchIndices(_numPatches * 20);
+    for (int i = 0; i < (int)patchIndices.size(); ++i) {
+        patchIndices[i] = i;
+    }
+
+    _cornerIndexBuffer = createSSBO(cornerIndices);
+    _valenceBuffer = createSSBO(valences);
+    _quadOffsetBuffer = createSSBO(quadOffsets);
+    _gregoryBasisBuffer = createSSBO(std::vector<float>(_numPatches*20*3));
+
+    _valenceTexture = createTextureBuffer(GL_R32I, _valenceBuffer);
+    _quadOffsetTexture = createTextureBuffer(GL_R32I, _quadOffsetBuffer);
+    glGenTextures(1, &_vertexTexture);
+
+    glGenBuffers(1, &_patchIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _patchIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, patchIndices.size()*sizeof(int),
+                 &patchIndices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+void
+GLLegacyGregoryConverter::Convert(GLuint vertexBuffer,
+                                  BufferDescriptor const &vertexDesc) {
+    if (_numPatches == 0) return;
+
+    glBindTexture(GL_TEXTURE_BUFFER, _vertexTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, vertexBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, _vertexTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, _valenceTexture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, _quadOffsetTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _cornerIndexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _gregoryBasisBuffer);
+
+    for (int k = 0; k < 2; ++k) {
+        Kernel const &kernel = _kernels[k];
+        if (kernel.numPatches == 0) continue;
+
+        GLuint program = kernel.program;
+        glUseProgram(program);
+
+        glUniform1i(glGetUniformLocation(program, "OsdVertexBuffer"), 0);
+        glUniform1i(glGetUniformLocation(program, "OsdValenceBuffer"), 1);
+        glUniform1i(glGetUniformLocation(program, "OsdQuadOffsetBuffer"), 2);
+
+        glUniform1i(glGetUniformLocation(program, "baseVertex"),
+                    vertexDesc.offset / vertexDesc.stride);
+        glUniform1i(glGetUniformLocation(program, "vertexStride"),
+                    vertexDesc.stride);
+        glUniform1i(glGetUniformLocation(program, "numPatches"),
+                    kernel.numPatches);
+        glUniform1i(glGetUniformLocation(program, "indexBase"),
+                    kernel.indexBase);
+        glUniform1i(glGetUniformLocation(program, "quadOffsetBase"),
+                    kernel.quadOffsetBase);
+        glUniform1i(glGetUniformLocation(program, "pointBase"),
+                    kernel.pointBase);
+
+        glDispatchCompute(
+            (kernel.numPatches + _workGroupSize - 1) / _workGroupSize, 1, 1);
+    }
+
+    glUseProgram(0);
+
+    // the points are read as vertices by the Gregory basis shaders
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+                    GL_TEXTURE_FETCH_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    for (int i = 0; i < 2; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
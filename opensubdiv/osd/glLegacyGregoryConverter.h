@@ -0,0 +1,150 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_GL_LEGACY_GREGORY_CONVERTER_H
+#define OPENSUBDIV3_OSD_GL_LEGACY_GREGORY_CONVERTER_H
+
+#include "../version.h"
+
+#include "../osd/nonCopyable.h"
+#include "../osd/opengl.h"
+#include "../osd/bufferDescriptor.h"
+#include "../osd/types.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class PatchTable;
+};
+
+namespace Osd {
+
+/// \brief Conversion of legacy Gregory patches to Gregory basis patches by a
+///        compute pass
+///
+/// Legacy Gregory patches (Far::PatchTableFactory::Options::
+/// ENDCAP_LEGACY_GREGORY) gather the 1-rings of their corners through the
+/// valence and quad-offset tables in the vertex and tess control shaders of
+/// every draw, which is much more costly than the 20 points of a Gregory
+/// basis patch. GLLegacyGregoryConverter computes the 20 points of each
+/// legacy Gregory patch once per update of the vertices, with the same math
+/// as glslPatchLegacy.glsl, so that the patches are drawn by the Gregory
+/// basis shaders instead:
+///
+///     converter->Convert(vertexBuffer->BindVBO(), vertexDesc);
+///
+///     // for each of converter->GetPatchArrays(), draw GREGORY_BASIS
+///     // patches with the points of converter->GetGregoryBasisBuffer()
+///     // (3 floats each) and the indices of converter->GetPatchIndexBuffer(),
+///     // the patch params being those of the GLPatchTable of the patch table
+///
+/// The positions must be the first 3 elements of the vertices, as they are
+/// for the legacy Gregory shaders.
+///
+class GLLegacyGregoryConverter
+    : private NonCopyable<GLLegacyGregoryConverter> {
+public:
+    /// \brief Creates the converter of the legacy Gregory patches of a patch
+    ///        table (or NULL if the kernels fail to compile)
+    ///
+    /// @param patchTable     the patch table
+    ///
+    /// @param deviceContext  not used
+    ///
+    static GLLegacyGregoryConverter *Create(Far::PatchTable const *patchTable,
+                                            void *deviceContext = NULL);
+
+    ~GLLegacyGregoryConverter();
+
+    /// \brief Computes the Gregory basis points of the legacy Gregory patches
+    ///
+    /// @param vertexBuffer  GL buffer of the refined vertices of the patch
+    ///                      table
+    ///
+    /// @param vertexDesc    descriptor of the vertices, whose 3 first
+    ///                      elements are the positions
+    ///
+    void Convert(GLuint vertexBuffer, BufferDescriptor const &vertexDesc);
+
+    /// Returns the number of legacy Gregory patches converted
+    int GetNumPatches() const { return _numPatches; }
+
+    /// \brief Returns the GREGORY_BASIS patch arrays of the converted patches,
+    ///        one for each legacy Gregory patch array, whose primitive id
+    ///        bases are those of the legacy arrays in the GLPatchTable
+    PatchArrayVector const &GetPatchArrays() const { return _patchArrays; }
+
+    /// \brief Returns the GL buffer of the 20 Gregory basis points of each
+    ///        patch (3 floats each)
+    GLuint GetGregoryBasisBuffer() const { return _gregoryBasisBuffer; }
+
+    /// \brief Returns the GL index buffer of the points of the patches (the
+    ///        points of each patch are consecutive)
+    GLuint GetPatchIndexBuffer() const { return _patchIndexBuffer; }
+
+protected:
+    GLLegacyGregoryConverter();
+
+    bool allocate(Far::PatchTable const *patchTable);
+
+private:
+    struct Kernel {
+        Kernel() : program(0), numPatches(0), indexBase(0),
+                   quadOffsetBase(0), pointBase(0) { }
+
+        GLuint program;
+        int numPatches;
+        int indexBase;          // index of the first corner vertex
+        int quadOffsetBase;     // index of the first quad offset
+        int pointBase;          // index of the first Gregory basis point
+    };
+
+    int _numPatches;
+    int _workGroupSize;
+
+    // the legacy Gregory and Gregory boundary patches
+    Kernel _kernels[2];
+
+    PatchArrayVector _patchArrays;
+
+    GLuint _vertexTexture;
+    GLuint _cornerIndexBuffer;
+    GLuint _valenceBuffer;
+    GLuint _valenceTexture;
+    GLuint _quadOffsetBuffer;
+    GLuint _quadOffsetTexture;
+    GLuint _gregoryBasisBuffer;
+    GLuint _patchIndexBuffer;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_GL_LEGACY_GREGORY_CONVERTER_H
@@ -0,0 +1,59 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "glLoader.h"
+
+#include "../osd/glMesh.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+MeshBufferFence<GLPatchTable>::Type
+MeshBufferFence<GLPatchTable>::Insert(void * /* deviceContext */) {
+
+    return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void
+MeshBufferFence<GLPatchTable>::Wait(Type fence, void * /* deviceContext */) {
+
+    GLsync sync = static_cast<GLsync>(fence);
+
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    for (;;) {
+        GLenum status = glClientWaitSync(sync, flags, 1000000 /* ns */);
+        if ((status == GL_ALREADY_SIGNALED) ||
+            (status == GL_CONDITION_SATISFIED) ||
+            (status == GL_WAIT_FAILED)) break;
+        flags = 0;
+    }
+    glDeleteSync(sync);
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -37,6 +37,17 @@ namespace Osd {
 
 typedef MeshInterface<GLPatchTable> GLMeshInterface;
 
+/// \brief Fences the vertex buffers of a ring of the GL meshes with GL sync
+///        objects (see Mesh::SetNumVertexBuffers())
+template <>
+struct MeshBufferFence<GLPatchTable> {
+    typedef void * Type;  // GLsync
+
+    static Type Insert(void *deviceContext);
+
+    static void Wait(Type fence, void *deviceContext);
+};
+
 
 } // end namespace Osd
 
@@ -0,0 +1,273 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "glLoader.h"
+
+#include "../osd/glPatchCuller.h"
+#include "../osd/glPatchTable.h"
+#include "../osd/glProgramBinaryCache.h"
+
+#include "../far/error.h"
+#include "../far/patchDescriptor.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+static const char *shaderSource =
+#include "../osd/glslPatchCullKernel.gen.h"
+;
+
+static GLuint
+compileKernel(int workGroupSize) {
+
+    std::ostringstream defines;
+    defines << "#define WORK_GROUP_SIZE " << workGroupSize << "\n";
+    std::string defineStr = defines.str();
+
+    const char *shaderSources[3] = {"#version 430\n", 0, 0};
+    shaderSources[1] = defineStr.c_str();
+    shaderSources[2] = shaderSource;
+
+    GLuint program = glCreateProgram();
+
+    // look up a program binary previously stored for these sources
+    std::string binaryKey;
+    if (internal::IsGLProgramBinaryCacheEnabled()) {
+        binaryKey = internal::GetGLProgramBinaryKey(shaderSources, 3);
+        if (internal::LoadGLProgramBinary(program, binaryKey)) {
+            return program;
+        }
+        internal::PrepareGLProgramBinary(program);
+    }
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 3, shaderSources, NULL);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+
+    GLint linked = 0;
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (linked == GL_FALSE) {
+        char buffer[1024];
+        glGetShaderInfoLog(shader, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glGetProgramInfoLog(program, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glDeleteShader(shader);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glDeleteShader(shader);
+
+    if (!binaryKey.empty()) {
+        internal::StoreGLProgramBinary(program, binaryKey);
+    }
+
+    return program;
+}
+
+static GLuint
+createBuffer(GLsizeiptr size, void const *data, GLenum usage) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return buffer;
+}
+
+static GLuint
+createTextureBuffer(GLenum format, GLuint buffer) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    return texture;
+}
+
+GLPatchCuller::GLPatchCuller(GLPatchTable const *patchTable) :
+    _patchTable(patchTable), _patchArrays(patchTable->GetPatchArrays()),
+    _program(0), _workGroupSize(64),
+    _patchIndexBuffer(0), _patchParamBuffer(0), _patchParamTexture(0),
+    _patchRemapBuffer(0), _patchRemapTexture(0), _drawCommandBuffer(0) {
+}
+
+GLPatchCuller::~GLPatchCuller() {
+    if (_program) glDeleteProgram(_program);
+    if (_patchIndexBuffer) glDeleteBuffers(1, &_patchIndexBuffer);
+    if (_patchParamBuffer) glDeleteBuffers(1, &_patchParamBuffer);
+    if (_patchParamTexture) glDeleteTextures(1, &_patchParamTexture);
+    if (_patchRemapBuffer) glDeleteBuffers(1, &_patchRemapBuffer);
+    if (_patchRemapTexture) glDeleteTextures(1, &_patchRemapTexture);
+    if (_drawCommandBuffer) glDeleteBuffers(1, &_drawCommandBuffer);
+}
+
+GLPatchCuller *
+GLPatchCuller::Create(GLPatchTable const *patchTable,
+                      void * /*deviceContext*/) {
+    if (patchTable == NULL) return NULL;
+
+    GLPatchCuller *instance = new GLPatchCuller(patchTable);
+    if (instance->compile()) return instance;
+    delete instance;
+    return NULL;
+}
+
+bool
+GLPatchCuller::compile() {
+
+    _program = compileKernel(_workGroupSize);
+    if (_program == 0) return false;
+
+    // cache uniform locations
+    _uniformVertexOffset    = glGetUniformLocation(_program, "vertexOffset");
+    _uniformVertexStride    = glGetUniformLocation(_program, "vertexStride");
+    _uniformNumPatches      = glGetUniformLocation(_program, "numPatches");
+    _uniformPatchStride     = glGetUniformLocation(_program, "patchStride");
+    _uniformIndexBase       = glGetUniformLocation(_program, "indexBase");
+    _uniformPrimitiveIdBase = glGetUniformLocation(_program, "primitiveIdBase");
+    _uniformDrawCommand     = glGetUniformLocation(_program, "drawCommand");
+    _uniformCullHull        = glGetUniformLocation(_program, "cullHull");
+    _uniformUseVisibility   = glGetUniformLocation(_program, "useVisibility");
+    _uniformMatrix =
+        glGetUniformLocation(_program, "modelViewProjectionMatrix");
+
+    // the culled buffers have the layout of the buffers of the patch table
+    int numIndices = 0, numPatches = 0;
+    int numPatchArrays = (int)_patchArrays.size();
+    _initialDrawCommands.resize(numPatchArrays * 5);
+    for (int i = 0; i < numPatchArrays; ++i) {
+        PatchArray const &patchArray = _patchArrays[i];
+        numIndices = std::max(numIndices, patchArray.GetIndexBase() +
+            patchArray.GetNumPatches() * patchArray.GetStride());
+        numPatches = std::max(numPatches, patchArray.GetPrimitiveIdBase() +
+            patchArray.GetNumPatches());
+
+        GLuint *command = &_initialDrawCommands[i * 5];
+        command[0] = 0;                                 // count
+        command[1] = 1;                                 // instanceCount
+        command[2] = (GLuint)patchArray.GetIndexBase(); // firstIndex
+        command[3] = 0;                                 // baseVertex
+        command[4] = 0;                                 // baseInstance
+    }
+
+    _patchIndexBuffer = createBuffer(
+        numIndices * sizeof(GLint), NULL, GL_DYNAMIC_COPY);
+    _patchParamBuffer = createBuffer(
+        numPatches * sizeof(PatchParam), NULL, GL_DYNAMIC_COPY);
+    _patchRemapBuffer = createBuffer(
+        numPatches * sizeof(GLint), NULL, GL_DYNAMIC_COPY);
+    _drawCommandBuffer = createBuffer(
+        numPatchArrays * DRAW_COMMAND_SIZE,
+        numPatchArrays ? &_initialDrawCommands[0] : NULL, GL_DYNAMIC_COPY);
+
+    _patchParamTexture = createTextureBuffer(GL_RGB32I, _patchParamBuffer);
+    _patchRemapTexture = createTextureBuffer(GL_R32I, _patchRemapBuffer);
+
+    return true;
+}
+
+void
+GLPatchCuller::Cull(GLuint vertexBuffer, BufferDescriptor const &vertexDesc,
+                    float const *modelViewProjectionMatrix,
+                    bool useVisibility) {
+
+    int numPatchArrays = (int)_patchArrays.size();
+    if (numPatchArrays == 0) return;
+
+    // reset the counts of the draw commands
+    glBindBuffer(GL_ARRAY_BUFFER, _drawCommandBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, numPatchArrays * DRAW_COMMAND_SIZE,
+                    &_initialDrawCommands[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(_program);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vertexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1,
+                     _patchTable->GetPatchIndexBuffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2,
+                     _patchTable->GetPatchParamBuffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3,
+                     _patchTable->GetPatchVisibilityBuffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _patchIndexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, _patchParamBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, _patchRemapBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, _drawCommandBuffer);
+
+    glUniform1i(_uniformVertexOffset, vertexDesc.offset);
+    glUniform1i(_uniformVertexStride, vertexDesc.stride);
+    glUniform1i(_uniformUseVisibility, useVisibility ? 1 : 0);
+    glUniformMatrix4fv(_uniformMatrix, 1, GL_FALSE, modelViewProjectionMatrix);
+
+    for (int i = 0; i < numPatchArrays; ++i) {
+        PatchArray const &patchArray = _patchArrays[i];
+        int numPatches = patchArray.GetNumPatches();
+        if (numPatches == 0) continue;
+
+        // the 4 control vertices of the legacy Gregory patches do not bound
+        // their surfaces
+        int patchType = patchArray.GetPatchType();
+        bool cullHull = (patchType != Far::PatchDescriptor::GREGORY &&
+                         patchType != Far::PatchDescriptor::GREGORY_BOUNDARY);
+
+        glUniform1i(_uniformNumPatches, numPatches);
+        glUniform1i(_uniformPatchStride, patchArray.GetStride());
+        glUniform1i(_uniformIndexBase, patchArray.GetIndexBase());
+        glUniform1i(_uniformPrimitiveIdBase, patchArray.GetPrimitiveIdBase());
+        glUniform1i(_uniformDrawCommand, i);
+        glUniform1i(_uniformCullHull, cullHull ? 1 : 0);
+
+        glDispatchCompute((numPatches + _workGroupSize - 1) / _workGroupSize,
+                          1, 1);
+    }
+
+    glUseProgram(0);
+
+    // the culled buffers are read as indices, draw commands and textures
+    glMemoryBarrier(GL_ELEMENT_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT |
+                    GL_TEXTURE_FETCH_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+
+    for (int i = 0; i < 8; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,165 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_GL_PATCH_CULLER_H
+#define OPENSUBDIV3_OSD_GL_PATCH_CULLER_H
+
+#include "../version.h"
+
+#include "../osd/opengl.h"
+#include "../osd/nonCopyable.h"
+#include "../osd/types.h"
+#include "../osd/bufferDescriptor.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+class GLPatchTable;
+
+/// \brief GPU culling of the patches of a GLPatchTable
+///
+/// GLPatchCuller runs a compute pass testing each patch against the view
+/// frustum with the hull of its control vertices (and against the patch
+/// visibility of the table), and compacts the visible patches of each patch
+/// array at the start of the array in its own index and patch param
+/// buffers. It also writes a DrawElementsIndirectCommand per patch array, so
+/// that the arrays are drawn with the visible patches only and without any
+/// readback:
+///
+///     culler->Cull(vertexBuffer->BindVBO(), vertexDesc, mvp);
+///
+///     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, culler->GetPatchIndexBuffer());
+///     glBindBuffer(GL_DRAW_INDIRECT_BUFFER, culler->GetDrawCommandBuffer());
+///     for (int i = 0; i < numPatchArrays; ++i) {
+///         // OsdPatchParamBuffer is culler->GetPatchParamTextureBuffer()
+///         // and OsdPrimitiveIdBase() the primitiveIdBase of the array
+///         glDrawElementsIndirect(GL_PATCHES, GL_UNSIGNED_INT,
+///             (void *)(i * GLPatchCuller::DRAW_COMMAND_SIZE));
+///     }
+///
+/// The hulls of the legacy Gregory patches do not bound their surfaces and
+/// those patches are only culled by their visibility. Displaced surfaces
+/// should be culled with a matrix whose frustum is enlarged accordingly.
+///
+class GLPatchCuller : private NonCopyable<GLPatchCuller> {
+public:
+    /// size in bytes of each draw command of the draw command buffer
+    enum { DRAW_COMMAND_SIZE = 5 * sizeof(GLuint) };
+
+    /// \brief Creates the culler of the patches of a GLPatchTable (or NULL
+    ///        if the kernel fails to compile)
+    ///
+    /// @param patchTable     the patch table, which must outlive the culler
+    ///
+    /// @param deviceContext  not used
+    ///
+    static GLPatchCuller *Create(GLPatchTable const *patchTable,
+                                 void *deviceContext = NULL);
+
+    ~GLPatchCuller();
+
+    /// \brief Culls the patches with the current vertex positions
+    ///
+    /// @param vertexBuffer     GL buffer of the refined vertices
+    ///
+    /// @param vertexDesc       descriptor of the 3 position elements of the
+    ///                         vertices
+    ///
+    /// @param modelViewProjectionMatrix  column-major 4x4 matrix
+    ///
+    /// @param useVisibility    also cull the patches hidden by the patch
+    ///                         visibility of the table
+    ///
+    void Cull(GLuint vertexBuffer, BufferDescriptor const &vertexDesc,
+              float const *modelViewProjectionMatrix,
+              bool useVisibility = true);
+
+    /// Returns the GL index buffer of the visible patches of each array
+    GLuint GetPatchIndexBuffer() const { return _patchIndexBuffer; }
+
+    /// Returns the GL buffer of the patch params of the visible patches
+    GLuint GetPatchParamBuffer() const { return _patchParamBuffer; }
+
+    /// Returns the GL texture buffer of the patch params of the visible
+    /// patches, to be bound as OsdPatchParamBuffer
+    GLuint GetPatchParamTextureBuffer() const { return _patchParamTexture; }
+
+    /// \brief Returns the GL texture buffer of the index of each visible
+    ///        patch in the patch table, e.g. for the face-varying patches
+    GLuint GetPatchRemapTextureBuffer() const { return _patchRemapTexture; }
+
+    /// \brief Returns the GL buffer of the draw commands of the patch arrays
+    ///        (DrawElementsIndirectCommand, DRAW_COMMAND_SIZE bytes each)
+    GLuint GetDrawCommandBuffer() const { return _drawCommandBuffer; }
+
+    /// Returns the number of draw commands, one per patch array
+    int GetNumDrawCommands() const { return (int)_patchArrays.size(); }
+
+protected:
+    GLPatchCuller(GLPatchTable const *patchTable);
+
+    bool compile();
+
+private:
+    GLPatchTable const * _patchTable;
+    PatchArrayVector _patchArrays;
+
+    GLuint _program;
+    int _workGroupSize;
+
+    GLint _uniformVertexOffset;
+    GLint _uniformVertexStride;
+    GLint _uniformNumPatches;
+    GLint _uniformPatchStride;
+    GLint _uniformIndexBase;
+    GLint _uniformPrimitiveIdBase;
+    GLint _uniformDrawCommand;
+    GLint _uniformCullHull;
+    GLint _uniformUseVisibility;
+    GLint _uniformMatrix;
+
+    GLuint _patchIndexBuffer;
+    GLuint _patchParamBuffer;
+    GLuint _patchParamTexture;
+    GLuint _patchRemapBuffer;
+    GLuint _patchRemapTexture;
+    GLuint _drawCommandBuffer;
+
+    // draw commands of the arrays with no visible patches
+    std::vector<GLuint> _initialDrawCommands;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_GL_PATCH_CULLER_H
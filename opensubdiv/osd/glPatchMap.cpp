@@ -0,0 +1,237 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "glLoader.h"
+
+#include "../osd/glPatchMap.h"
+#include "../osd/glProgramBinaryCache.h"
+
+#include "../far/error.h"
+#include "../far/patchMap.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+static const char *shaderSource =
+#include "../osd/glslPatchMap.gen.h"
+;
+
+// the default bindings of the lookup (see glslPatchMap.glsl)
+enum { QUADTREE_BINDING = 14, HANDLES_BINDING = 15 };
+
+static GLuint
+compileKernel(int workGroupSize) {
+
+    std::ostringstream defines;
+    defines << "#define WORK_GROUP_SIZE " << workGroupSize << "\n"
+            << "#define OSD_PATCH_MAP_FIND_PATCHES_KERNEL\n";
+    std::string defineStr = defines.str();
+
+    const char *shaderSources[3] = {"#version 430\n", 0, 0};
+    shaderSources[1] = defineStr.c_str();
+    shaderSources[2] = shaderSource;
+
+    GLuint program = glCreateProgram();
+
+    // look up a program binary previously stored for these sources
+    std::string binaryKey;
+    if (internal::IsGLProgramBinaryCacheEnabled()) {
+        binaryKey = internal::GetGLProgramBinaryKey(shaderSources, 3);
+        if (internal::LoadGLProgramBinary(program, binaryKey)) {
+            return program;
+        }
+        internal::PrepareGLProgramBinary(program);
+    }
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 3, shaderSources, NULL);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+
+    GLint linked = 0;
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (linked == GL_FALSE) {
+        char buffer[1024];
+        glGetShaderInfoLog(shader, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glGetProgramInfoLog(program, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glDeleteShader(shader);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glDeleteShader(shader);
+
+    if (!binaryKey.empty()) {
+        internal::StoreGLProgramBinary(program, binaryKey);
+    }
+
+    return program;
+}
+
+static GLuint
+createBuffer(GLsizeiptr size, void const *data) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return buffer;
+}
+
+GLPatchMap::GLPatchMap() :
+    _program(0), _workGroupSize(64),
+    _quadtreeBuffer(0), _handlesBuffer(0) {
+    _params[0] = _params[1] = _params[2] = _params[3] = 0;
+}
+
+GLPatchMap::~GLPatchMap() {
+    if (_program) glDeleteProgram(_program);
+    if (_quadtreeBuffer) glDeleteBuffers(1, &_quadtreeBuffer);
+    if (_handlesBuffer) glDeleteBuffers(1, &_handlesBuffer);
+}
+
+GLPatchMap *
+GLPatchMap::Create(Far::PatchMap const *patchMap,
+                   void * /*deviceContext*/) {
+    if (patchMap == NULL) return NULL;
+
+    GLPatchMap *instance = new GLPatchMap();
+    if (instance->compile()) {
+        instance->initialize(*patchMap);
+        return instance;
+    }
+    delete instance;
+    return NULL;
+}
+
+const char *
+GLPatchMap::GetShaderSource() {
+    return shaderSource;
+}
+
+bool
+GLPatchMap::compile() {
+
+    _program = compileKernel(_workGroupSize);
+    if (_program == 0) return false;
+
+    // cache uniform locations
+    _uniformNumLocations = glGetUniformLocation(_program, "numLocations");
+    _uniformParams       = glGetUniformLocation(_program, "OsdPatchMapParams");
+
+    return true;
+}
+
+void
+GLPatchMap::initialize(Far::PatchMap const &patchMap) {
+
+    std::vector<unsigned int> quadtree;
+    patchMap.GetPackedQuadtree(quadtree);
+
+    // Far::PatchMap::Handle is the same 3 ints as Osd::PatchCoord::handle
+    std::vector<GLint> handles;
+    handles.reserve(patchMap.GetHandles().size() * 3);
+    for (size_t i = 0; i < patchMap.GetHandles().size(); ++i) {
+        Far::PatchMap::Handle const &handle = patchMap.GetHandles()[i];
+        handles.push_back(handle.arrayIndex);
+        handles.push_back(handle.patchIndex);
+        handles.push_back(handle.vertIndex);
+    }
+
+    _quadtreeBuffer = createBuffer(quadtree.size() * sizeof(GLuint),
+                                   quadtree.empty() ? NULL : &quadtree[0]);
+    _handlesBuffer = createBuffer(handles.size() * sizeof(GLint),
+                                  handles.empty() ? NULL : &handles[0]);
+
+    _params[0] = patchMap.GetMinPatchFace();
+    _params[1] = patchMap.GetMaxPatchFace();
+    _params[2] = patchMap.GetMaxDepth();
+    _params[3] = patchMap.ArePatchesTriangular() ? 1 : 0;
+}
+
+void
+GLPatchMap::BindLookup(GLuint program, int quadtreeBinding,
+                       int handlesBinding) const {
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, quadtreeBinding,
+                     _quadtreeBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, handlesBinding, _handlesBuffer);
+
+    GLint uniformParams = glGetUniformLocation(program, "OsdPatchMapParams");
+    if (uniformParams >= 0) {
+        glProgramUniform4iv(program, uniformParams, 1, _params);
+    }
+}
+
+void
+GLPatchMap::FindPatches(GLuint faceIdBuffer, GLuint uvBuffer,
+                        int numLocations, GLuint patchCoordBuffer) const {
+
+    if (numLocations <= 0) return;
+
+    glUseProgram(_program);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, faceIdBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, uvBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, patchCoordBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, QUADTREE_BINDING,
+                     _quadtreeBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HANDLES_BINDING,
+                     _handlesBuffer);
+
+    glUniform1i(_uniformNumLocations, numLocations);
+    glUniform4iv(_uniformParams, 1, _params);
+
+    glDispatchCompute((numLocations + _workGroupSize - 1) / _workGroupSize,
+                      1, 1);
+
+    glUseProgram(0);
+
+    // the PatchCoords are read by the patch kernels of GLComputeEvaluator
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    for (int i = 0; i < 3; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, QUADTREE_BINDING, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HANDLES_BINDING, 0);
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,141 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_GL_PATCH_MAP_H
+#define OPENSUBDIV3_OSD_GL_PATCH_MAP_H
+
+#include "../version.h"
+
+#include "../osd/opengl.h"
+#include "../osd/nonCopyable.h"
+
+#include <cstddef>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class PatchMap;
+}
+
+namespace Osd {
+
+/// \brief GL buffers of a Far::PatchMap, for the lookup of patches on the GPU
+///
+/// GLPatchMap holds the quadtree and the patch handles of a Far::PatchMap in
+/// GL buffers, so that the PatchCoords of locations on the surface are found
+/// on the GPU, e.g. for sampling a surface without any readback.
+///
+/// FindPatches() runs a compute pass writing the PatchCoords of a batch of
+/// locations to a buffer for GLComputeEvaluator::EvalPatches(). Shaders can
+/// also look up patches themselves with the source of GetShaderSource(),
+/// which declares
+///
+///     ivec3 OsdPatchMapFindPatch(int faceId, float u, float v);
+///
+/// returning the handle (arrayIndex, patchIndex, vertIndex) of the patch of
+/// the location, or ivec3(-1) if no patch is found. The quadtree and handle
+/// buffers are bound to the shader storage bindings
+/// OSD_PATCH_MAP_QUADTREE_BINDING and OSD_PATCH_MAP_HANDLES_BINDING (14 and
+/// 15 unless defined otherwise) and the uniform OsdPatchMapParams is set to
+/// GetParams().
+///
+class GLPatchMap : private NonCopyable<GLPatchMap> {
+public:
+    /// \brief Creates the GL buffers of a patch map (or NULL if the kernel
+    ///        of FindPatches() fails to compile)
+    ///
+    /// @param patchMap       the patch map
+    ///
+    /// @param deviceContext  not used
+    ///
+    static GLPatchMap *Create(Far::PatchMap const *patchMap,
+                              void *deviceContext = NULL);
+
+    ~GLPatchMap();
+
+    /// \brief Writes the PatchCoords of locations -- the locations for which
+    ///        no patch is found get a patchIndex of -1 and must not be
+    ///        evaluated
+    ///
+    /// @param faceIdBuffer      GL buffer of the patch face (int) of each
+    ///                          location
+    ///
+    /// @param uvBuffer          GL buffer of the (u,v) pair (float) of each
+    ///                          location
+    ///
+    /// @param numLocations      number of locations
+    ///
+    /// @param patchCoordBuffer  GL buffer of numLocations PatchCoords
+    ///
+    void FindPatches(GLuint faceIdBuffer, GLuint uvBuffer, int numLocations,
+                     GLuint patchCoordBuffer) const;
+
+    /// Returns the GL buffer of the packed quadtree
+    GLuint GetQuadtreeBuffer() const { return _quadtreeBuffer; }
+
+    /// Returns the GL buffer of the patch handles (3 ints each)
+    GLuint GetHandlesBuffer() const { return _handlesBuffer; }
+
+    /// \brief Returns the value of the uniform OsdPatchMapParams: minimum and
+    ///        maximum patch face, maximum depth and triangular patches
+    GLint const *GetParams() const { return _params; }
+
+    /// \brief Binds the buffers and sets the uniform of the lookup of a
+    ///        program, to the bindings its shaders define (if not the
+    ///        defaults)
+    void BindLookup(GLuint program, int quadtreeBinding = 14,
+                    int handlesBinding = 15) const;
+
+    /// Returns the GLSL source of OsdPatchMapFindPatch()
+    static const char *GetShaderSource();
+
+protected:
+    GLPatchMap();
+
+    bool compile();
+
+    void initialize(Far::PatchMap const &patchMap);
+
+private:
+    GLuint _program;
+    int _workGroupSize;
+
+    GLint _uniformNumLocations;
+    GLint _uniformParams;
+
+    GLuint _quadtreeBuffer;
+    GLuint _handlesBuffer;
+    GLint _params[4];
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_GL_PATCH_MAP_H
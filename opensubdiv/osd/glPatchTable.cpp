@@ -36,7 +36,11 @@ namespace Osd {
 
 GLPatchTable::GLPatchTable() :
     _patchIndexBuffer(0), _patchParamBuffer(0),
-    _patchIndexTexture(0), _patchParamTexture(0) {
+    _patchParamNormalizationBuffer(0),
+    _patchIndexTexture(0), _patchParamTexture(0),
+    _singleCreaseMatricesBuffer(0), _singleCreaseMatricesTexture(0),
+    _patchVisibilityBuffer(0), _patchVisibilityTexture(0),
+    _memoryUsage(0) {
 
     // Initialize internal OpenGL loader library if necessary
     OpenSubdiv::internal::GLLoader::libraryInitializeGL();
@@ -45,15 +49,26 @@ GLPatchTable::GLPatchTable() :
 GLPatchTable::~GLPatchTable() {
     if (_patchIndexBuffer) glDeleteBuffers(1, &_patchIndexBuffer);
     if (_patchParamBuffer) glDeleteBuffers(1, &_patchParamBuffer);
+    if (_patchParamNormalizationBuffer)
+        glDeleteBuffers(1, &_patchParamNormalizationBuffer);
     if (_patchIndexTexture) glDeleteTextures(1, &_patchIndexTexture);
     if (_patchParamTexture) glDeleteTextures(1, &_patchParamTexture);
+    if (_singleCreaseMatricesBuffer)
+        glDeleteBuffers(1, &_singleCreaseMatricesBuffer);
+    if (_singleCreaseMatricesTexture)
+        glDeleteTextures(1, &_singleCreaseMatricesTexture);
+    if (_patchVisibilityBuffer) glDeleteBuffers(1, &_patchVisibilityBuffer);
+    if (_patchVisibilityTexture) glDeleteTextures(1, &_patchVisibilityTexture);
     if (_varyingIndexBuffer) glDeleteBuffers(1, &_varyingIndexBuffer);
     if (_varyingIndexTexture) glDeleteTextures(1, &_varyingIndexTexture);
     for (int fvc=0; fvc<(int)_fvarIndexBuffers.size(); ++fvc) {
+        //  Buffers and textures shared with a previous channel are not deleted:
+        if (_fvarSharedChannels[fvc] != fvc) continue;
+
         if (_fvarIndexBuffers[fvc]) glDeleteBuffers(1, &_fvarIndexBuffers[fvc]);
-    }
-    for (int fvc=0; fvc<(int)_fvarIndexTextures.size(); ++fvc) {
         if (_fvarIndexTextures[fvc]) glDeleteTextures(1, &_fvarIndexTextures[fvc]);
+        if (_fvarParamBuffers[fvc]) glDeleteBuffers(1, &_fvarParamBuffers[fvc]);
+        if (_fvarParamTextures[fvc]) glDeleteTextures(1, &_fvarParamTextures[fvc]);
     }
 }
 
@@ -87,6 +102,7 @@ GLPatchTable::allocate(Far::PatchTable const *farPatchTable) {
                  indexSize * sizeof(GLint),
                  patchTable.GetPatchIndexBuffer(),
                  GL_STATIC_DRAW);
+    _memoryUsage += indexSize * sizeof(GLint);
 
     // copy patchparam buffer
     glBindBuffer(GL_ARRAY_BUFFER, _patchParamBuffer);
@@ -94,6 +110,16 @@ GLPatchTable::allocate(Far::PatchTable const *farPatchTable) {
                  patchParamSize * sizeof(PatchParam),
                  patchTable.GetPatchParamBuffer(),
                  GL_STATIC_DRAW);
+    _memoryUsage += patchParamSize * sizeof(PatchParam);
+
+    // copy the pre-expanded normalizations of the patchparams
+    glGenBuffers(1, &_patchParamNormalizationBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, _patchParamNormalizationBuffer);
+    glBufferData(GL_ARRAY_BUFFER,
+                 patchParamSize * sizeof(PatchParamNormalization),
+                 patchTable.GetPatchParamNormalizationBuffer(),
+                 GL_STATIC_DRAW);
+    _memoryUsage += patchParamSize * sizeof(PatchParamNormalization);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     // make both buffer as texture buffers too.
@@ -106,6 +132,45 @@ GLPatchTable::allocate(Far::PatchTable const *farPatchTable) {
     glBindTexture(GL_TEXTURE_BUFFER, _patchParamTexture);
     glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32I, _patchParamBuffer);
 
+    // single-crease matrices
+    if (patchTable.GetSingleCreaseMatricesSize()) {
+        glGenBuffers(1, &_singleCreaseMatricesBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, _singleCreaseMatricesBuffer);
+        glBufferData(GL_ARRAY_BUFFER,
+                     patchTable.GetSingleCreaseMatricesSize() *
+                         sizeof(SingleCreaseMatrices),
+                     patchTable.GetSingleCreaseMatricesBuffer(),
+                     GL_STATIC_DRAW);
+        _memoryUsage += patchTable.GetSingleCreaseMatricesSize() *
+                        sizeof(SingleCreaseMatrices);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glGenTextures(1, &_singleCreaseMatricesTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, _singleCreaseMatricesTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F,
+                    _singleCreaseMatricesBuffer);
+    }
+
+    // visibility, all patches initially visible
+    int numPatches = (int)patchParamSize;
+    _patchFaceIds.resize(numPatches);
+    for (int i = 0; i < numPatches; ++i) {
+        _patchFaceIds[i] = patchTable.GetPatchParamBuffer()[i].GetFaceId();
+    }
+    // (padded to whole words for the uint access of GLPatchCuller)
+    std::vector<unsigned char> visibility((numPatches + 3) & ~3, 1);
+
+    glGenBuffers(1, &_patchVisibilityBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, _patchVisibilityBuffer);
+    glBufferData(GL_ARRAY_BUFFER, visibility.size(),
+                 numPatches ? &visibility[0] : NULL, GL_DYNAMIC_DRAW);
+    _memoryUsage += visibility.size();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenTextures(1, &_patchVisibilityTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, _patchVisibilityTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R8UI, _patchVisibilityBuffer);
+
     // varying
     _varyingPatchArrays.assign(
         patchTable.GetVaryingPatchArrayBuffer(),
@@ -117,6 +182,7 @@ GLPatchTable::allocate(Far::PatchTable const *farPatchTable) {
                  patchTable.GetVaryingPatchIndexSize() * sizeof(GLint),
                  patchTable.GetVaryingPatchIndexBuffer(),
                  GL_STATIC_DRAW);
+    _memoryUsage += patchTable.GetVaryingPatchIndexSize() * sizeof(GLint);
 
     glGenTextures(1, &_varyingIndexTexture);
     glBindTexture(GL_TEXTURE_BUFFER, _varyingIndexTexture);
@@ -129,17 +195,30 @@ GLPatchTable::allocate(Far::PatchTable const *farPatchTable) {
     _fvarIndexTextures.resize(numFVarChannels);
     _fvarParamBuffers.resize(numFVarChannels);
     _fvarParamTextures.resize(numFVarChannels);
+    _fvarSharedChannels.resize(numFVarChannels);
     for (int fvc=0; fvc<numFVarChannels; ++fvc) {
         _fvarPatchArrays[fvc].assign(
             patchTable.GetFVarPatchArrayBuffer(fvc),
             patchTable.GetFVarPatchArrayBuffer(fvc) + numPatchArrays);
 
+        //  Channels sharing the data of a previous channel share its buffers:
+        int srcFvc = patchTable.GetSharedFVarChannel(fvc);
+        _fvarSharedChannels[fvc] = srcFvc;
+        if (srcFvc != fvc) {
+            _fvarIndexBuffers[fvc]  = _fvarIndexBuffers[srcFvc];
+            _fvarIndexTextures[fvc] = _fvarIndexTextures[srcFvc];
+            _fvarParamBuffers[fvc]  = _fvarParamBuffers[srcFvc];
+            _fvarParamTextures[fvc] = _fvarParamTextures[srcFvc];
+            continue;
+        }
+
         glGenBuffers(1, &_fvarIndexBuffers[fvc]);
         glBindBuffer(GL_ARRAY_BUFFER, _fvarIndexBuffers[fvc]);
         glBufferData(GL_ARRAY_BUFFER,
                      patchTable.GetFVarPatchIndexSize(fvc) * sizeof(GLint),
                      patchTable.GetFVarPatchIndexBuffer(fvc),
                  GL_STATIC_DRAW);
+        _memoryUsage += patchTable.GetFVarPatchIndexSize(fvc) * sizeof(GLint);
 
         glGenTextures(1, &_fvarIndexTextures[fvc]);
         glBindTexture(GL_TEXTURE_BUFFER, _fvarIndexTextures[fvc]);
@@ -151,6 +230,7 @@ GLPatchTable::allocate(Far::PatchTable const *farPatchTable) {
                      patchTable.GetFVarPatchParamSize(fvc) * sizeof(PatchParam),
                      patchTable.GetFVarPatchParamBuffer(fvc),
                  GL_STATIC_DRAW);
+        _memoryUsage += patchTable.GetFVarPatchParamSize(fvc) * sizeof(PatchParam);
 
         glGenTextures(1, &_fvarParamTextures[fvc]);
         glBindTexture(GL_TEXTURE_BUFFER, _fvarParamTextures[fvc]);
@@ -164,6 +244,30 @@ GLPatchTable::allocate(Far::PatchTable const *farPatchTable) {
     return true;
 }
 
+void
+GLPatchTable::UpdatePatchVisibility(unsigned char const *visibility,
+                                    int startPatch, int numPatches) {
+    if (numPatches <= 0) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, _patchVisibilityBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, startPatch, numPatches, visibility);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void
+GLPatchTable::UpdateFaceVisibility(unsigned char const *faceVisibility,
+                                   int numFaces) {
+    int numPatches = (int)_patchFaceIds.size();
+    if (numPatches == 0) return;
+
+    std::vector<unsigned char> visibility(numPatches);
+    for (int i = 0; i < numPatches; ++i) {
+        int face = _patchFaceIds[i];
+        visibility[i] = (face < numFaces) ? faceVisibility[face] : 1;
+    }
+    UpdatePatchVisibility(&visibility[0], 0, numPatches);
+}
+
 
 }  // end namespace Osd
 
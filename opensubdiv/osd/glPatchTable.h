@@ -66,6 +66,30 @@ public:
         return _patchParamBuffer;
     }
 
+    /// \brief Returns the GL buffer containing the normalization of each
+    ///        patch param (see Osd::PatchParamNormalization), which the
+    ///        patch kernels of GLComputeEvaluator read instead of decoding
+    ///        the patch param bitfields
+    GLuint GetPatchParamNormalizationBuffer() const {
+        return _patchParamNormalizationBuffer;
+    }
+
+    /// \brief Returns the GL buffer containing the single-crease matrices of
+    ///        each patch (see Osd::SingleCreaseMatrices), or 0 if the table
+    ///        has no single-crease patches
+    GLuint GetSingleCreaseMatricesBuffer() const {
+        return _singleCreaseMatricesBuffer;
+    }
+
+    /// \brief Returns the GL texture buffer containing the single-crease
+    ///        matrices of each patch, which the patch shaders compiled with
+    ///        OSD_PATCH_ENABLE_SINGLE_CREASE_MATRICES read from
+    ///        OsdSingleCreaseMatricesBuffer, or 0 if the table has no
+    ///        single-crease patches
+    GLuint GetSingleCreaseMatricesTextureBuffer() const {
+        return _singleCreaseMatricesTexture;
+    }
+
     /// Returns the GL texture buffer containing the patch control vertices
     GLuint GetPatchIndexTextureBuffer() const {
         return _patchIndexTexture;
@@ -94,6 +118,12 @@ public:
     /// Returns the number of face-varying channel buffers
     int GetNumFVarChannels() const { return (int)_fvarPatchArrays.size(); }
 
+    /// Returns the first channel whose buffers are shared with fvarChannel
+    /// (see Far::PatchTable::GetSharedFVarChannel())
+    int GetSharedFVarChannel(int fvarChannel = 0) const {
+        return _fvarSharedChannels[fvarChannel];
+    }
+
     /// Returns the patch arrays for face-varying index buffer data
     PatchArrayVector const &GetFVarPatchArrays(int fvarChannel = 0) const {
         return _fvarPatchArrays[fvarChannel];
@@ -119,6 +149,47 @@ public:
         return _fvarParamTextures[fvarChannel];
     }
 
+    /// Returns the GL buffer containing the visibility of each patch
+    GLuint GetPatchVisibilityBuffer() const {
+        return _patchVisibilityBuffer;
+    }
+
+    /// \brief Returns the GL texture buffer containing the visibility of each
+    ///        patch (an unsigned byte, zero for hidden patches), which the
+    ///        patch shaders compiled with OSD_ENABLE_PATCH_VISIBILITY read
+    ///        from OsdPatchVisibilityBuffer to cull the hidden patches
+    GLuint GetPatchVisibilityTextureBuffer() const {
+        return _patchVisibilityTexture;
+    }
+
+    /// \brief Updates the visibility of a range of patches (all the patches
+    ///        are initially visible)
+    ///
+    /// @param visibility   numPatches values, zero for hidden patches
+    ///
+    /// @param startPatch   index of the first patch to update
+    ///
+    /// @param numPatches   number of patches to update
+    ///
+    void UpdatePatchVisibility(unsigned char const *visibility,
+                               int startPatch, int numPatches);
+
+    /// \brief Updates the visibility of all the patches from that of the
+    ///        faces they refine, e.g. to animate holes without rebuilding
+    ///        the topology
+    ///
+    /// @param faceVisibility  a value for each face id of the patches, i.e.
+    ///                        of each Ptex face (see Far::PtexIndices), zero
+    ///                        for hidden faces
+    ///
+    /// @param numFaces        number of values in faceVisibility
+    ///
+    void UpdateFaceVisibility(unsigned char const *faceVisibility,
+                              int numFaces);
+
+    /// Returns the number of bytes of the GL buffers of the table
+    size_t GetMemoryUsage() const { return _memoryUsage; }
+
 protected:
     GLPatchTable();
 
@@ -129,10 +200,14 @@ protected:
 
     GLuint _patchIndexBuffer;
     GLuint _patchParamBuffer;
+    GLuint _patchParamNormalizationBuffer;
 
     GLuint _patchIndexTexture;
     GLuint _patchParamTexture;
 
+    GLuint _singleCreaseMatricesBuffer;
+    GLuint _singleCreaseMatricesTexture;
+
     PatchArrayVector _varyingPatchArrays;
     GLuint _varyingIndexBuffer;
     GLuint _varyingIndexTexture;
@@ -143,6 +218,15 @@ protected:
 
     std::vector<GLuint> _fvarParamBuffers;
     std::vector<GLuint> _fvarParamTextures;
+
+    //  Channel whose buffers and textures are shared by each channel:
+    std::vector<int> _fvarSharedChannels;
+
+    GLuint _patchVisibilityBuffer;
+    GLuint _patchVisibilityTexture;
+    std::vector<int> _patchFaceIds;
+
+    size_t _memoryUsage;
 };
 
 
@@ -0,0 +1,315 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "glLoader.h"
+
+#include "../osd/glProgramBinaryCache.h"
+#include "../far/error.h"
+
+#include <cstdio>
+#ifdef _MSC_VER
+    #define snprintf _snprintf
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+//
+//  Statics for the publicly assignable callbacks and the method to
+//  assign them (disable static assignment warnings when doing so):
+//
+static GLProgramBinaryLoadFunc programBinaryLoadFunc = 0;
+static GLProgramBinaryStoreFunc programBinaryStoreFunc = 0;
+
+static std::string programBinaryDirectory;
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 1711
+#endif
+
+void
+SetGLProgramBinaryCallbacks(GLProgramBinaryLoadFunc loadFunc,
+                            GLProgramBinaryStoreFunc storeFunc) {
+    programBinaryLoadFunc = loadFunc;
+    programBinaryStoreFunc = storeFunc;
+}
+
+//
+//  Built-in callbacks for the directory cache -- each file holds a small
+//  header with the binary format and length followed by the binary:
+//
+static const unsigned int programBinaryFileMagic = 0x4244534f;  // "OSDB"
+
+static std::string
+getProgramBinaryPath(const char *key) {
+    return programBinaryDirectory + "/" + key + ".bin";
+}
+
+static bool
+loadProgramBinaryFile(const char *key,
+                      GLenum *format, std::vector<unsigned char> *binary) {
+    FILE *file = fopen(getProgramBinaryPath(key).c_str(), "rb");
+    if (!file) return false;
+
+    unsigned int header[3] = { 0, 0, 0 };
+    bool valid = (fread(header, sizeof(header), 1, file) == 1) &&
+                 (header[0] == programBinaryFileMagic) && (header[2] > 0);
+    if (valid) {
+        binary->resize(header[2]);
+        valid = (fread(&(*binary)[0], header[2], 1, file) == 1);
+        *format = (GLenum)header[1];
+    }
+    fclose(file);
+    return valid;
+}
+
+static void
+storeProgramBinaryFile(const char *key,
+                       GLenum format, const void *binary, int length) {
+    FILE *file = fopen(getProgramBinaryPath(key).c_str(), "wb");
+    if (!file) return;
+
+    unsigned int header[3] = { programBinaryFileMagic,
+                               (unsigned int)format, (unsigned int)length };
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(binary, length, 1, file);
+    fclose(file);
+}
+
+void
+SetGLProgramBinaryCacheDirectory(const char *path) {
+    if (path && path[0]) {
+        programBinaryDirectory = path;
+        SetGLProgramBinaryCallbacks(loadProgramBinaryFile,
+                                    storeProgramBinaryFile);
+    } else {
+        programBinaryDirectory.clear();
+        SetGLProgramBinaryCallbacks(0, 0);
+    }
+}
+
+#ifdef __INTEL_COMPILER
+#pragma warning enable 1711
+#endif
+
+static void
+reportShaderInfoLog(GLuint shader) {
+    GLint length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    if (length > 0) {
+        std::vector<char> infoLog(length);
+        glGetShaderInfoLog(shader, length, NULL, &infoLog[0]);
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+                   "Error compiling GLSL shader: %s\n", &infoLog[0]);
+    }
+}
+
+static void
+reportProgramInfoLog(GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+    if (length > 0) {
+        std::vector<char> infoLog(length);
+        glGetProgramInfoLog(program, length, NULL, &infoLog[0]);
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+                   "Error linking GLSL program: %s\n", &infoLog[0]);
+    }
+}
+
+GLuint
+LinkGLProgram(int numShaders,
+              const GLenum *shaderTypes,
+              const char * const *shaderSources) {
+
+    GLuint program = glCreateProgram();
+
+    // the key distinguishes identical sources compiled for other stages
+    std::string binaryKey;
+    if (internal::IsGLProgramBinaryCacheEnabled()) {
+        std::vector<std::string> stageNames(numShaders);
+        std::vector<const char *> strings(2 * numShaders);
+        for (int i = 0; i < numShaders; ++i) {
+            char stageName[16];
+            snprintf(stageName, sizeof(stageName), "%x", shaderTypes[i]);
+            stageNames[i] = stageName;
+            strings[2*i]   = stageNames[i].c_str();
+            strings[2*i+1] = shaderSources[i];
+        }
+        binaryKey = internal::GetGLProgramBinaryKey(
+            strings.empty() ? 0 : &strings[0], 2 * numShaders);
+        if (internal::LoadGLProgramBinary(program, binaryKey)) {
+            return program;
+        }
+        internal::PrepareGLProgramBinary(program);
+    }
+
+    std::vector<GLuint> shaders(numShaders);
+    for (int i = 0; i < numShaders; ++i) {
+        shaders[i] = glCreateShader(shaderTypes[i]);
+        glShaderSource(shaders[i], 1, &shaderSources[i], NULL);
+        glCompileShader(shaders[i]);
+        glAttachShader(program, shaders[i]);
+    }
+    glLinkProgram(program);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (linked == GL_FALSE) {
+        for (int i = 0; i < numShaders; ++i) {
+            GLint compiled = GL_FALSE;
+            glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &compiled);
+            if (compiled == GL_FALSE) {
+                reportShaderInfoLog(shaders[i]);
+            }
+        }
+        reportProgramInfoLog(program);
+    }
+
+    for (int i = 0; i < numShaders; ++i) {
+        glDeleteShader(shaders[i]);
+    }
+
+    if (linked == GL_FALSE) {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    if (!binaryKey.empty()) {
+        internal::StoreGLProgramBinary(program, binaryKey);
+    }
+    return program;
+}
+
+namespace internal {
+
+bool
+IsGLProgramBinaryCacheEnabled() {
+    if (programBinaryLoadFunc == 0 && programBinaryStoreFunc == 0) {
+        return false;
+    }
+#if defined(GL_ARB_get_program_binary)
+    if (OSD_OPENGL_HAS(VERSION_4_1) || OSD_OPENGL_HAS(ARB_get_program_binary)) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+//
+//  The key is a 64-bit FNV-1a hash of the driver strings and of the
+//  program strings, each terminated by its null character so that
+//  different splits of the same text produce different keys:
+//
+static void
+hashString(unsigned long long &hash, const char *s) {
+    if (s == 0) s = "";
+    do {
+        hash ^= (unsigned char)(*s);
+        hash *= 1099511628211ULL;
+    } while (*s++);
+}
+
+std::string
+GetGLProgramBinaryKey(const char * const *strings, int count) {
+    unsigned long long hash = 14695981039346656037ULL;
+
+    hashString(hash, (const char *)glGetString(GL_VENDOR));
+    hashString(hash, (const char *)glGetString(GL_RENDERER));
+    hashString(hash, (const char *)glGetString(GL_VERSION));
+    for (int i = 0; i < count; ++i) {
+        hashString(hash, strings[i]);
+    }
+
+    char key[32];
+    snprintf(key, sizeof(key), "osd_%08x%08x",
+             (unsigned int)(hash >> 32), (unsigned int)(hash & 0xffffffff));
+    return std::string(key);
+}
+
+bool
+LoadGLProgramBinary(GLuint program, std::string const &key) {
+#if defined(GL_ARB_get_program_binary)
+    if (programBinaryLoadFunc == 0) return false;
+
+    GLenum format = 0;
+    std::vector<unsigned char> binary;
+    if (!programBinaryLoadFunc(key.c_str(), &format, &binary) ||
+        binary.empty()) {
+        return false;
+    }
+
+    glProgramBinary(program, format, &binary[0], (GLsizei)binary.size());
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return (linked == GL_TRUE);
+#else
+    (void)program;
+    (void)key;
+    return false;
+#endif
+}
+
+void
+PrepareGLProgramBinary(GLuint program) {
+#if defined(GL_ARB_get_program_binary)
+    if (programBinaryStoreFunc) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                            GL_TRUE);
+    }
+#else
+    (void)program;
+#endif
+}
+
+void
+StoreGLProgramBinary(GLuint program, std::string const &key) {
+#if defined(GL_ARB_get_program_binary)
+    if (programBinaryStoreFunc == 0) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<unsigned char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, &binary[0]);
+    if (length > 0) {
+        programBinaryStoreFunc(key.c_str(), format, &binary[0], length);
+    }
+#else
+    (void)program;
+    (void)key;
+#endif
+}
+
+} // end namespace internal
+
+} // end namespace Osd
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
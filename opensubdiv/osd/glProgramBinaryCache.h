@@ -0,0 +1,152 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_OSD_GL_PROGRAM_BINARY_CACHE_H
+#define OPENSUBDIV3_OSD_GL_PROGRAM_BINARY_CACHE_H
+
+#include "../version.h"
+
+#include "../osd/opengl.h"
+
+#include <string>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+/// \brief The callback function type invoked to look up a previously stored
+///        GL program binary
+///
+/// The key identifies the program sources (including the defines generated
+/// from the BufferDescriptors) together with the vendor, renderer and
+/// version strings of the GL driver, and is suitable as a file name.
+/// Returns false if no binary is stored for the key.
+///
+typedef bool (*GLProgramBinaryLoadFunc)(const char *key,
+                                        GLenum *format,
+                                        std::vector<unsigned char> *binary);
+
+/// \brief The callback function type invoked to store the binary of a
+///        newly linked GL program
+typedef void (*GLProgramBinaryStoreFunc)(const char *key,
+                                         GLenum format,
+                                         const void *binary,
+                                         int length);
+
+/// \brief Sets the callback functions used by GLComputeEvaluator and
+///        GLXFBEvaluator to load and store linked program binaries
+///        (default is none)
+///
+/// When assigned, the evaluators first attempt to create their kernels
+/// with glProgramBinary. Binaries which the driver rejects (e.g. after a
+/// driver update) are silently recompiled from source and stored again.
+/// Program binaries require GL 4.1 or ARB_get_program_binary, the callbacks
+/// are ignored otherwise.
+///
+/// The callbacks are invoked from the thread compiling the evaluator, and
+/// so must be thread-safe if evaluators are compiled on several threads
+/// (each with its own current, shared GL context).
+///
+/// \note This function is not thread-safe !
+///
+/// @param loadFunc   function pointer to the callback looking up a binary
+///                   (or NULL)
+///
+/// @param storeFunc  function pointer to the callback storing a binary
+///                   (or NULL)
+///
+void SetGLProgramBinaryCallbacks(GLProgramBinaryLoadFunc loadFunc,
+                                 GLProgramBinaryStoreFunc storeFunc);
+
+/// \brief Stores program binaries as files in the given directory, which
+///        must exist (NULL or an empty path disables the cache)
+///
+/// This assigns a pair of built-in callbacks which read and write one
+/// "<key>.bin" file per program, replacing any callbacks previously set
+/// with SetGLProgramBinaryCallbacks().
+///
+/// \note This function is not thread-safe !
+///
+void SetGLProgramBinaryCacheDirectory(const char *path);
+
+/// \brief Compiles and links a GL program from the shader sources of its
+///        stages, loading it from the program binary cache when possible
+///
+/// This allows clients to cache their own programs (e.g. the drawing
+/// programs assembled from GLSLPatchShaderSource) with the same callbacks
+/// as the evaluators. All stages are compiled before any status is queried,
+/// so drivers supporting KHR_parallel_shader_compile may compile them
+/// concurrently. Compile and link errors are reported with Far::Error.
+///
+/// @param numShaders     number of shader stages
+///
+/// @param shaderTypes    GL shader type of each stage
+///                       (e.g. GL_VERTEX_SHADER)
+///
+/// @param shaderSources  null-terminated source of each stage
+///
+/// @return               the linked program, or 0 on failure
+///
+GLuint LinkGLProgram(int numShaders,
+                     const GLenum *shaderTypes,
+                     const char * const *shaderSources);
+
+
+//
+//  The following are intended for internal use only
+//
+namespace internal {
+
+/// \brief Returns true if program binary callbacks are assigned and
+///        supported by the current context (internal use only)
+bool IsGLProgramBinaryCacheEnabled();
+
+/// \brief Returns the cache key of a program built from the given strings
+///        (internal use only)
+std::string GetGLProgramBinaryKey(const char * const *strings, int count);
+
+/// \brief Links the program from a stored binary, returns false if none is
+///        found or the driver rejects it (internal use only)
+bool LoadGLProgramBinary(GLuint program, std::string const &key);
+
+/// \brief Requests the binary of the program to be retrievable, must be
+///        called before linking (internal use only)
+void PrepareGLProgramBinary(GLuint program);
+
+/// \brief Stores the binary of a successfully linked program
+///        (internal use only)
+void StoreGLProgramBinary(GLuint program, std::string const &key);
+
+} // end namespace internal
+
+} // end namespace Osd
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_OSD_GL_PROGRAM_BINARY_CACHE_H
@@ -0,0 +1,465 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "glLoader.h"
+
+#include "../osd/glTessLevelComputer.h"
+#include "../osd/cpuPatchTable.h"
+#include "../osd/glProgramBinaryCache.h"
+#include "../osd/glslPatchShaderSource.h"
+
+#include "../far/error.h"
+#include "../far/patchTable.h"
+#include "../far/ptexIndices.h"
+#include "../far/topologyRefiner.h"
+#include "../sdc/types.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+static const char *shaderSource =
+#include "../osd/glslTessLevelKernel.gen.h"
+;
+
+static GLuint
+compileKernel(int workGroupSize) {
+
+    std::string patchBasisShaderSource =
+        GLSLPatchShaderSource::GetPatchBasisShaderSource();
+
+    std::ostringstream defines;
+    defines << "#define WORK_GROUP_SIZE " << workGroupSize << "\n"
+            << "#define OSD_PATCH_BASIS_GLSL\n";
+    std::string defineStr = defines.str();
+
+    const char *shaderSources[4] = {"#version 430\n", 0, 0, 0};
+    shaderSources[1] = defineStr.c_str();
+    shaderSources[2] = patchBasisShaderSource.c_str();
+    shaderSources[3] = shaderSource;
+
+    GLuint program = glCreateProgram();
+
+    // look up a program binary previously stored for these sources
+    std::string binaryKey;
+    if (internal::IsGLProgramBinaryCacheEnabled()) {
+        binaryKey = internal::GetGLProgramBinaryKey(shaderSources, 4);
+        if (internal::LoadGLProgramBinary(program, binaryKey)) {
+            return program;
+        }
+        internal::PrepareGLProgramBinary(program);
+    }
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 4, shaderSources, NULL);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+
+    GLint linked = 0;
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (linked == GL_FALSE) {
+        char buffer[1024];
+        glGetShaderInfoLog(shader, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glGetProgramInfoLog(program, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glDeleteShader(shader);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glDeleteShader(shader);
+
+    if (!binaryKey.empty()) {
+        internal::StoreGLProgramBinary(program, binaryKey);
+    }
+
+    return program;
+}
+
+template <class T> static GLuint
+createSSBO(std::vector<T> const & src) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, src.size()*sizeof(T),
+                 src.empty() ? NULL : &src[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return buffer;
+}
+
+static GLuint
+createTextureBuffer(GLenum format, GLuint buffer) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    return texture;
+}
+
+namespace {
+
+    //
+    //  An edge segment and the patch from which its level is computed
+    //  (matching the Segment struct of the kernel):
+    //
+    struct Segment {
+        int patchIndex;
+        int patchType;
+        int indexBase;
+        int pad;
+        float endPoints[4];
+    };
+
+    //
+    //  The edges of the patches in the order of the tessOuterLo/Hi levels
+    //  of glslPatchCommonTess.glsl: the transition bit of each edge and the
+    //  corners of its Lo and Hi ends.
+    //
+    struct PatchEdge {
+        int transitionBit;
+        int cornerLo;
+        int cornerHi;
+    };
+
+    const PatchEdge quadEdges[4] = { {8, 0,3}, {1, 0,1}, {2, 1,2}, {4, 3,2} };
+    const PatchEdge triEdges[3]  = { {4, 0,2}, {1, 0,1}, {2, 2,1} };
+
+    const float quadCorners[4][2] = { {0,0}, {1,0}, {1,1}, {0,1} };
+    const float triCorners[3][2]  = { {0,0}, {1,0}, {0,1} };
+
+    //
+    //  Segments are identified by the vertices at their ends in the refined
+    //  topology, as indices into all of the levels:
+    //
+    typedef std::pair<int, int> SegmentKey;
+    typedef std::map<SegmentKey, int> SegmentMap;
+
+    SegmentKey
+    makeSegmentKey(int v0, int v1) {
+        return (v0 < v1) ? SegmentKey(v0, v1) : SegmentKey(v1, v0);
+    }
+
+    //
+    //  Returns the refined face of a quad patch from the ptex face and the
+    //  (u,v) of its patch param (child faces of quads keep the orientation
+    //  of their parent), or INDEX_INVALID:
+    //
+    Far::Index
+    findPatchFace(Far::TopologyRefiner const &refiner,
+                  std::vector<Far::Index> const &ptexFaces,
+                  Far::PtexIndices const &ptexIndices,
+                  Far::PatchParam const &param) {
+
+        int ptexFace = param.GetFaceId();
+        Far::Index face = ptexFaces[ptexFace];
+        int depth = param.GetDepth();
+        int level = 0;
+
+        if (param.NonQuadRoot()) {
+            int subFace = ptexFace - ptexIndices.GetFaceId(face);
+            face = refiner.GetLevel(0).GetFaceChildFaces(face)[subFace];
+            level = 1;
+        }
+        for ( ; level < depth; ++level) {
+            int bit = depth - level - 1;
+            int u = (param.GetU() >> bit) & 1;
+            int v = (param.GetV() >> bit) & 1;
+            int child = v ? (3 - u) : u;
+
+            Far::ConstIndexArray children =
+                refiner.GetLevel(level).GetFaceChildFaces(face);
+            if (children.size() != 4) return Far::INDEX_INVALID;
+            face = children[child];
+            if (!Far::IndexIsValid(face)) return Far::INDEX_INVALID;
+        }
+        return face;
+    }
+
+} // end namespace
+
+GLTessLevelComputer::GLTessLevelComputer() :
+    _numSegments(0), _program(0), _workGroupSize(64),
+    _segmentBuffer(0), _patchIndexBuffer(0), _patchParamBuffer(0),
+    _tessLevelBuffer(0), _tessLevelTexture(0),
+    _patchEdgeBuffer(0), _patchEdgeTexture(0) {
+}
+
+GLTessLevelComputer::~GLTessLevelComputer() {
+    if (_program) glDeleteProgram(_program);
+    if (_segmentBuffer) glDeleteBuffers(1, &_segmentBuffer);
+    if (_patchIndexBuffer) glDeleteBuffers(1, &_patchIndexBuffer);
+    if (_patchParamBuffer) glDeleteBuffers(1, &_patchParamBuffer);
+    if (_tessLevelBuffer) glDeleteBuffers(1, &_tessLevelBuffer);
+    if (_tessLevelTexture) glDeleteTextures(1, &_tessLevelTexture);
+    if (_patchEdgeBuffer) glDeleteBuffers(1, &_patchEdgeBuffer);
+    if (_patchEdgeTexture) glDeleteTextures(1, &_patchEdgeTexture);
+}
+
+GLTessLevelComputer *
+GLTessLevelComputer::Create(Far::TopologyRefiner const &refiner,
+                            Far::PatchTable const *patchTable,
+                            void * /*deviceContext*/) {
+    if (patchTable == NULL) return NULL;
+
+    GLTessLevelComputer *instance = new GLTessLevelComputer();
+    if (instance->allocate(refiner, patchTable)) return instance;
+    delete instance;
+    return NULL;
+}
+
+bool
+GLTessLevelComputer::allocate(Far::TopologyRefiner const &refiner,
+                              Far::PatchTable const *farPatchTable) {
+
+    CpuPatchTable patchTable(farPatchTable);
+
+    int numPatchArrays = (int)patchTable.GetNumPatchArrays();
+    int numPatches = (int)patchTable.GetPatchParamSize();
+    PatchArray const *patchArrays = patchTable.GetPatchArrayBuffer();
+    PatchParam const *patchParams = patchTable.GetPatchParamBuffer();
+
+    bool quads = (Sdc::SchemeTypeTraits::GetRegularFaceSize(
+                      refiner.GetSchemeType()) == 4);
+
+    // ptex faces to base faces, and offsets of the vertices of the levels
+    Far::PtexIndices ptexIndices(refiner);
+    std::vector<Far::Index> ptexFaces(ptexIndices.GetNumFaces());
+    for (int face = 0; face < refiner.GetLevel(0).GetNumFaces(); ++face) {
+        int first = ptexIndices.GetFaceId(face);
+        int last = (face + 1 < refiner.GetLevel(0).GetNumFaces())
+                 ? ptexIndices.GetFaceId(face + 1) : ptexIndices.GetNumFaces();
+        for (int ptexFace = first; ptexFace < last; ++ptexFace) {
+            ptexFaces[ptexFace] = face;
+        }
+    }
+    std::vector<int> levelVertexOffsets(refiner.GetNumLevels() + 1, 0);
+    for (int level = 0; level < refiner.GetNumLevels(); ++level) {
+        levelVertexOffsets[level + 1] = levelVertexOffsets[level] +
+            refiner.GetLevel(level).GetNumVertices();
+    }
+
+    std::vector<Segment> segments;
+    std::vector<int> patchEdges(numPatches * 8, -1);
+    SegmentMap segmentMap;
+
+    for (int array = 0; array < numPatchArrays; ++array) {
+        PatchArray const &patchArray = patchArrays[array];
+
+        for (int i = 0; i < patchArray.GetNumPatches(); ++i) {
+            int patchIndex = patchArray.GetPrimitiveIdBase() + i;
+            PatchParam const &param = patchParams[patchIndex];
+
+            int patchType = param.IsRegular()
+                          ? patchArray.GetPatchTypeRegular()
+                          : patchArray.GetPatchTypeIrregular();
+            if (patchType == Far::PatchDescriptor::GREGORY ||
+                patchType == Far::PatchDescriptor::GREGORY_BOUNDARY) {
+                Far::Error(Far::FAR_RUNTIME_ERROR,
+                    "GLTessLevelComputer: legacy Gregory patches "
+                    "are not supported.");
+                return false;
+            }
+
+            // the vertices of the corners of the refined face of the patch,
+            // triangle patches have no shared segments
+            int level = param.GetDepth();
+            Far::Index face = quads
+                ? findPatchFace(refiner, ptexFaces, ptexIndices, param)
+                : Far::INDEX_INVALID;
+            Far::ConstIndexArray faceVerts, faceEdges;
+            if (Far::IndexIsValid(face)) {
+                faceVerts = refiner.GetLevel(level).GetFaceVertices(face);
+                faceEdges = refiner.GetLevel(level).GetFaceEdges(face);
+            }
+
+            int numEdges = quads ? 4 : 3;
+            PatchEdge const *edges = quads ? quadEdges : triEdges;
+            float const (*corners)[2] = quads ? quadCorners : triCorners;
+
+            for (int edge = 0; edge < numEdges; ++edge) {
+                PatchEdge const &patchEdge = edges[edge];
+
+                float const *lo = corners[patchEdge.cornerLo];
+                float const *hi = corners[patchEdge.cornerHi];
+                float mid[2] = { (lo[0] + hi[0]) * 0.5f,
+                                 (lo[1] + hi[1]) * 0.5f };
+
+                bool transition =
+                    (param.GetTransition() & patchEdge.transitionBit) != 0;
+
+                // the ends of the Lo and Hi segments in the patch domain
+                // and in the refined topology
+                float const *ends[2][2] = { { lo, transition ? mid : hi },
+                                            { hi, mid } };
+                SegmentKey keys[2] = { SegmentKey(-1, -1),
+                                       SegmentKey(-1, -1) };
+                int numSegments = transition ? 2 : 1;
+
+                if (faceVerts.size() == 4) {
+                    Far::TopologyLevel const &faceLevel =
+                        refiner.GetLevel(level);
+                    Far::Index vLo = faceVerts[patchEdge.cornerLo];
+                    Far::Index vHi = faceVerts[patchEdge.cornerHi];
+                    if (!transition) {
+                        keys[0] = makeSegmentKey(
+                            levelVertexOffsets[level] + vLo,
+                            levelVertexOffsets[level] + vHi);
+                    } else if (level + 1 < refiner.GetNumLevels()) {
+                        int cornerLo = patchEdge.cornerLo;
+                        int cornerHi = patchEdge.cornerHi;
+                        int faceEdge = (cornerHi == (cornerLo + 1) % 4)
+                                     ? cornerLo : cornerHi;
+                        Far::Index cLo = faceLevel.GetVertexChildVertex(vLo);
+                        Far::Index cHi = faceLevel.GetVertexChildVertex(vHi);
+                        Far::Index cMid =
+                            faceLevel.GetEdgeChildVertex(faceEdges[faceEdge]);
+                        if (Far::IndexIsValid(cLo) &&
+                            Far::IndexIsValid(cHi) &&
+                            Far::IndexIsValid(cMid)) {
+                            int offset = levelVertexOffsets[level + 1];
+                            keys[0] = makeSegmentKey(offset + cLo,
+                                                     offset + cMid);
+                            keys[1] = makeSegmentKey(offset + cHi,
+                                                     offset + cMid);
+                        }
+                    }
+                }
+
+                for (int s = 0; s < numSegments; ++s) {
+                    int segment = (int)segments.size();
+                    if (keys[s].first >= 0) {
+                        std::pair<SegmentMap::iterator, bool> result =
+                            segmentMap.insert(
+                                SegmentMap::value_type(keys[s], segment));
+                        if (!result.second) {
+                            patchEdges[patchIndex * 8 + s * 4 + edge] =
+                                result.first->second;
+                            continue;
+                        }
+                    }
+
+                    Segment newSegment;
+                    newSegment.patchIndex = patchIndex;
+                    newSegment.patchType = patchType;
+                    newSegment.indexBase = patchArray.GetIndexBase() +
+                                           i * patchArray.GetStride();
+                    newSegment.pad = 0;
+                    newSegment.endPoints[0] = ends[s][0][0];
+                    newSegment.endPoints[1] = ends[s][0][1];
+                    newSegment.endPoints[2] = ends[s][1][0];
+                    newSegment.endPoints[3] = ends[s][1][1];
+                    segments.push_back(newSegment);
+
+                    patchEdges[patchIndex * 8 + s * 4 + edge] = segment;
+                }
+            }
+        }
+    }
+    _numSegments = (int)segments.size();
+
+    _program = compileKernel(_workGroupSize);
+    if (_program == 0) return false;
+
+    // cache uniform locations
+    _uniformVertexOffset = glGetUniformLocation(_program, "vertexOffset");
+    _uniformVertexStride = glGetUniformLocation(_program, "vertexStride");
+    _uniformNumSegments  = glGetUniformLocation(_program, "numSegments");
+    _uniformModelViewMatrix =
+        glGetUniformLocation(_program, "modelViewMatrix");
+    _uniformProjectionMatrix =
+        glGetUniformLocation(_program, "projectionMatrix");
+    _uniformTessLevel    = glGetUniformLocation(_program, "tessLevel");
+
+    std::vector<int> patchIndices(patchTable.GetPatchIndexBuffer(),
+                                  patchTable.GetPatchIndexBuffer() +
+                                  patchTable.GetPatchIndexSize());
+    std::vector<PatchParam> params(patchParams, patchParams + numPatches);
+
+    _segmentBuffer = createSSBO(segments);
+    _patchIndexBuffer = createSSBO(patchIndices);
+    _patchParamBuffer = createSSBO(params);
+    _tessLevelBuffer = createSSBO(std::vector<float>(_numSegments, 1.0f));
+    _patchEdgeBuffer = createSSBO(patchEdges);
+
+    _tessLevelTexture = createTextureBuffer(GL_R32F, _tessLevelBuffer);
+    _patchEdgeTexture = createTextureBuffer(GL_R32I, _patchEdgeBuffer);
+
+    return true;
+}
+
+void
+GLTessLevelComputer::Compute(GLuint vertexBuffer,
+                             BufferDescriptor const &vertexDesc,
+                             float const *modelViewMatrix,
+                             float const *projectionMatrix,
+                             float tessLevel) {
+    if (_numSegments == 0) return;
+
+    glUseProgram(_program);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vertexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _segmentBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _patchIndexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _patchParamBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _tessLevelBuffer);
+
+    glUniform1i(_uniformVertexOffset, vertexDesc.offset);
+    glUniform1i(_uniformVertexStride, vertexDesc.stride);
+    glUniform1i(_uniformNumSegments, _numSegments);
+    glUniformMatrix4fv(_uniformModelViewMatrix, 1, GL_FALSE, modelViewMatrix);
+    glUniformMatrix4fv(_uniformProjectionMatrix, 1, GL_FALSE,
+                       projectionMatrix);
+    glUniform1f(_uniformTessLevel, tessLevel);
+
+    glDispatchCompute((_numSegments + _workGroupSize - 1) / _workGroupSize,
+                      1, 1);
+
+    glUseProgram(0);
+
+    // the levels are read through texture buffers by the tess control shaders
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+
+    for (int i = 0; i < 5; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,160 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_GL_TESS_LEVEL_COMPUTER_H
+#define OPENSUBDIV3_OSD_GL_TESS_LEVEL_COMPUTER_H
+
+#include "../version.h"
+
+#include "../osd/nonCopyable.h"
+#include "../osd/opengl.h"
+#include "../osd/bufferDescriptor.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class PatchTable;
+    class TopologyRefiner;
+};
+
+namespace Osd {
+
+/// \brief Screen-space tessellation levels of the patch edges computed once
+///        per frame by a compute pass
+///
+/// With screen-space tessellation, the tess control shader of every patch
+/// computes the levels of its four (or three) edges, so the level of each
+/// edge is computed by both of its patches. GLTessLevelComputer identifies
+/// the edge segments shared by the patches of a Far::PatchTable (including
+/// the halves of transition edges shared with the patches of the next level)
+/// and computes the level of each segment once, from the limit surface of a
+/// single patch. The tess control shaders then read the levels of their
+/// edges instead of computing them, which also guarantees that the patches
+/// of a shared edge use the same level.
+///
+///     computer->Compute(vertexBuffer->BindVBO(), vertexDesc,
+///                       modelView, projection, tessLevel);
+///
+///     // shaders compiled with OSD_ENABLE_TESS_LEVEL_BUFFER: bind
+///     //   OsdTessLevelBuffer to computer->GetTessLevelTextureBuffer()
+///     //   OsdPatchEdgeBuffer to computer->GetPatchEdgeTextureBuffer()
+///
+/// The segments of triangle patches are not shared, and the legacy Gregory
+/// patches are not supported. The level of a single-crease patch is computed
+/// from its smooth limit surface.
+///
+class GLTessLevelComputer : private NonCopyable<GLTessLevelComputer> {
+public:
+    /// \brief Creates the computer of the tessellation levels of the patches
+    ///        of a patch table (or NULL if not supported)
+    ///
+    /// @param refiner        the refiner from which the patch table was
+    ///                       created
+    ///
+    /// @param patchTable     the patch table
+    ///
+    /// @param deviceContext  not used
+    ///
+    static GLTessLevelComputer *Create(Far::TopologyRefiner const &refiner,
+                                       Far::PatchTable const *patchTable,
+                                       void *deviceContext = NULL);
+
+    ~GLTessLevelComputer();
+
+    /// \brief Computes the tessellation levels of the edge segments
+    ///
+    /// @param vertexBuffer     GL buffer of the refined vertices (and local
+    ///                         points) of the patch table
+    ///
+    /// @param vertexDesc       descriptor of the 3 position elements of the
+    ///                         vertices
+    ///
+    /// @param modelViewMatrix  column-major 4x4 matrix
+    ///
+    /// @param projectionMatrix column-major 4x4 matrix
+    ///
+    /// @param tessLevel        the tessellation level of a unit projected
+    ///                         length (see OsdTessLevel())
+    ///
+    void Compute(GLuint vertexBuffer, BufferDescriptor const &vertexDesc,
+                 float const *modelViewMatrix, float const *projectionMatrix,
+                 float tessLevel);
+
+    /// Returns the number of unique edge segments
+    int GetNumSegments() const { return _numSegments; }
+
+    /// Returns the GL buffer of the tessellation levels of the segments
+    GLuint GetTessLevelBuffer() const { return _tessLevelBuffer; }
+
+    /// \brief Returns the GL texture buffer of the tessellation levels of the
+    ///        segments, to be bound as OsdTessLevelBuffer
+    GLuint GetTessLevelTextureBuffer() const { return _tessLevelTexture; }
+
+    /// \brief Returns the GL texture buffer of the segments of the edges of
+    ///        each patch, to be bound as OsdPatchEdgeBuffer
+    ///
+    /// Each patch has the segments of its 4 Lo edge segments followed by the
+    /// segments of its 4 Hi edge segments, or -1 for the Hi segments of the
+    /// edges which are not transition edges (see glslPatchCommonTess.glsl).
+    ///
+    GLuint GetPatchEdgeTextureBuffer() const { return _patchEdgeTexture; }
+
+protected:
+    GLTessLevelComputer();
+
+    bool allocate(Far::TopologyRefiner const &refiner,
+                  Far::PatchTable const *patchTable);
+
+private:
+    int _numSegments;
+
+    GLuint _program;
+    int _workGroupSize;
+
+    GLint _uniformVertexOffset;
+    GLint _uniformVertexStride;
+    GLint _uniformNumSegments;
+    GLint _uniformModelViewMatrix;
+    GLint _uniformProjectionMatrix;
+    GLint _uniformTessLevel;
+
+    GLuint _segmentBuffer;
+    GLuint _patchIndexBuffer;
+    GLuint _patchParamBuffer;
+    GLuint _tessLevelBuffer;
+    GLuint _tessLevelTexture;
+    GLuint _patchEdgeBuffer;
+    GLuint _patchEdgeTexture;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_GL_TESS_LEVEL_COMPUTER_H
@@ -0,0 +1,389 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "glLoader.h"
+
+#include "../osd/glUniformRefiner.h"
+#include "../osd/glProgramBinaryCache.h"
+
+#include "../far/error.h"
+#include "../sdc/types.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+static const char *shaderSource =
+#include "../osd/glslUniformRefineKernel.gen.h"
+;
+
+// the passes of the kernel (see glslUniformRefineKernel.glsl)
+enum { PASS_FACES = 0, PASS_EDGES = 1 };
+
+// the maximum number of work groups of a dimension guaranteed by GL
+static const int maxWorkGroupCount = 65535;
+
+static GLuint
+compileKernel(int workGroupSize) {
+
+    std::ostringstream defines;
+    defines << "#define WORK_GROUP_SIZE " << workGroupSize << "\n";
+    std::string defineStr = defines.str();
+
+    const char *shaderSources[3] = {"#version 430\n", 0, 0};
+    shaderSources[1] = defineStr.c_str();
+    shaderSources[2] = shaderSource;
+
+    GLuint program = glCreateProgram();
+
+    // look up a program binary previously stored for these sources
+    std::string binaryKey;
+    if (internal::IsGLProgramBinaryCacheEnabled()) {
+        binaryKey = internal::GetGLProgramBinaryKey(shaderSources, 3);
+        if (internal::LoadGLProgramBinary(program, binaryKey)) {
+            return program;
+        }
+        internal::PrepareGLProgramBinary(program);
+    }
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 3, shaderSources, NULL);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+
+    GLint linked = 0;
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (linked == GL_FALSE) {
+        char buffer[1024];
+        glGetShaderInfoLog(shader, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glGetProgramInfoLog(program, 1024, NULL, buffer);
+        Far::Error(Far::FAR_RUNTIME_ERROR, buffer);
+
+        glDeleteShader(shader);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glDeleteShader(shader);
+
+    if (!binaryKey.empty()) {
+        internal::StoreGLProgramBinary(program, binaryKey);
+    }
+
+    return program;
+}
+
+static GLuint
+createBuffer(GLsizeiptr size, void const *data, GLenum usage) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, std::max(size, (GLsizeiptr)sizeof(GLint)),
+                 data, usage);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return buffer;
+}
+
+static GLint const *
+vectorData(std::vector<GLint> const &v) {
+    return v.empty() ? NULL : &v[0];
+}
+
+GLUniformRefiner::GLUniformRefiner() :
+    _numLevelsRefined(0), _triSplit(false), _faceVertsFirst(false),
+    _program(0), _workGroupSize(64) {
+}
+
+GLUniformRefiner::~GLUniformRefiner() {
+    if (_program) glDeleteProgram(_program);
+    for (int i = 0; i < (int)_levels.size(); ++i) {
+        Level &level = _levels[i];
+        if (level.faceVertBuffer) glDeleteBuffers(1, &level.faceVertBuffer);
+        if (level.faceEdgeBuffer) glDeleteBuffers(1, &level.faceEdgeBuffer);
+        if (level.edgeVertBuffer) glDeleteBuffers(1, &level.edgeVertBuffer);
+        if (level.faceOffsetBuffer) {
+            glDeleteBuffers(1, &level.faceOffsetBuffer);
+        }
+    }
+}
+
+GLUniformRefiner *
+GLUniformRefiner::Create(Far::TopologyRefiner const &refiner,
+                         Far::TopologyRefiner::UniformOptions const &options,
+                         void * /*deviceContext*/) {
+
+    if (options.pruneHoles) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "GLUniformRefiner: pruned (sparse) levels are not supported.");
+        return NULL;
+    }
+    if (options.orderVerticesByFaces) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "GLUniformRefiner: vertices ordered by faces are not supported.");
+        return NULL;
+    }
+
+    Far::TopologyLevel const &base = refiner.GetLevel(0);
+
+    bool triSplit = Sdc::SchemeTypeTraits::GetTopologicalSplitType(
+        refiner.GetSchemeType()) == Sdc::SPLIT_TO_TRIS;
+
+    // gather the relations of the base level, noting whether its faces are
+    // all of the regular size of the split
+    int numFaces = base.GetNumFaces();
+    int numEdges = base.GetNumEdges();
+
+    std::vector<GLint> faceVerts, faceEdges, faceOffsets, edgeVerts;
+    faceVerts.reserve(base.GetNumFaceVertices());
+    faceEdges.reserve(base.GetNumFaceVertices());
+    faceOffsets.reserve(numFaces + 1);
+
+    int regFaceSize = triSplit ? 3 : 4;
+    bool regular = true;
+    for (int f = 0; f < numFaces; ++f) {
+        Far::ConstIndexArray fVerts = base.GetFaceVertices(f);
+        Far::ConstIndexArray fEdges = base.GetFaceEdges(f);
+
+        faceOffsets.push_back((GLint)faceVerts.size());
+        faceVerts.insert(faceVerts.end(), fVerts.begin(), fVerts.end());
+        faceEdges.insert(faceEdges.end(), fEdges.begin(), fEdges.end());
+        regular &= (fVerts.size() == regFaceSize);
+    }
+    faceOffsets.push_back((GLint)faceVerts.size());
+
+    if (triSplit && !regular) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "GLUniformRefiner: Loop meshes must be triangulated.");
+        return NULL;
+    }
+
+    edgeVerts.resize(numEdges * 2);
+    for (int e = 0; e < numEdges; ++e) {
+        Far::ConstIndexArray eVerts = base.GetEdgeVertices(e);
+        edgeVerts[2*e]   = eVerts[0];
+        edgeVerts[2*e+1] = eVerts[1];
+    }
+
+    GLUniformRefiner *instance = new GLUniformRefiner();
+    instance->_triSplit = triSplit;
+    instance->_faceVertsFirst = options.orderVerticesFromFacesFirst;
+
+    if (!instance->compile()) {
+        delete instance;
+        return NULL;
+    }
+
+    // the sizes of all levels follow from those of the base level
+    int maxLevel = std::max((int)options.refinementLevel, 0);
+    instance->_levels.resize(maxLevel + 1);
+    for (int i = 0; i <= maxLevel; ++i) {
+        Level &level = instance->_levels[i];
+        if (i == 0) {
+            level.numFaces = numFaces;
+            level.numEdges = numEdges;
+            level.numVertices = base.GetNumVertices();
+            level.numFaceVertices = (int)faceVerts.size();
+            level.regFaceSize = regular ? regFaceSize : 0;
+        } else {
+            Level const &parent = instance->_levels[i - 1];
+            if (triSplit) {
+                level.numFaces = parent.numFaces * 4;
+                level.numEdges = parent.numEdges * 2 + parent.numFaces * 3;
+                level.numVertices = parent.numVertices + parent.numEdges;
+            } else {
+                level.numFaces = parent.numFaceVertices;
+                level.numEdges = parent.numEdges * 2 + parent.numFaceVertices;
+                level.numVertices = parent.numVertices + parent.numEdges +
+                                    parent.numFaces;
+            }
+            level.numFaceVertices = level.numFaces * regFaceSize;
+            level.regFaceSize = regFaceSize;
+        }
+        level.faceVertBuffer = 0;
+        level.faceEdgeBuffer = 0;
+        level.edgeVertBuffer = 0;
+        level.faceOffsetBuffer = 0;
+    }
+
+    Level &level = instance->_levels[0];
+    level.faceVertBuffer = createBuffer(faceVerts.size() * sizeof(GLint),
+                                        vectorData(faceVerts), GL_STATIC_DRAW);
+    level.faceEdgeBuffer = createBuffer(faceEdges.size() * sizeof(GLint),
+                                        vectorData(faceEdges), GL_STATIC_DRAW);
+    level.edgeVertBuffer = createBuffer(edgeVerts.size() * sizeof(GLint),
+                                        vectorData(edgeVerts), GL_STATIC_DRAW);
+    if (!regular) {
+        level.faceOffsetBuffer = createBuffer(
+            faceOffsets.size() * sizeof(GLint), vectorData(faceOffsets),
+            GL_STATIC_DRAW);
+    }
+    instance->_numLevelsRefined = 1;
+
+    return instance;
+}
+
+bool
+GLUniformRefiner::compile() {
+
+    _program = compileKernel(_workGroupSize);
+    if (_program == 0) return false;
+
+    // cache uniform locations
+    _uniformPass              = glGetUniformLocation(_program, "refinePass");
+    _uniformTriSplit          = glGetUniformLocation(_program, "triSplit");
+    _uniformNumParentFaces    = glGetUniformLocation(_program, "numParentFaces");
+    _uniformNumParentEdges    = glGetUniformLocation(_program, "numParentEdges");
+    _uniformParentRegFaceSize =
+        glGetUniformLocation(_program, "parentRegFaceSize");
+    _uniformChildVertFromFaceBase =
+        glGetUniformLocation(_program, "childVertFromFaceBase");
+    _uniformChildVertFromEdgeBase =
+        glGetUniformLocation(_program, "childVertFromEdgeBase");
+    _uniformChildVertFromVertBase =
+        glGetUniformLocation(_program, "childVertFromVertBase");
+    _uniformChildEdgeFromEdgeBase =
+        glGetUniformLocation(_program, "childEdgeFromEdgeBase");
+
+    return true;
+}
+
+int
+GLUniformRefiner::GetVertexOffset(int level) const {
+    int offset = 0;
+    for (int i = 0; i < level; ++i) {
+        offset += _levels[i].numVertices;
+    }
+    return offset;
+}
+
+void
+GLUniformRefiner::Refine(int level) {
+
+    level = std::min(level, GetMaxLevel());
+    if (level < _numLevelsRefined) return;
+
+    glUseProgram(_program);
+
+    for (int i = _numLevelsRefined - 1; i < level; ++i) {
+        refineLevel(i);
+    }
+    _numLevelsRefined = level + 1;
+
+    glUseProgram(0);
+
+    for (int i = 0; i < 7; ++i) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+
+    // the outputs are read as indices and storage buffers
+    glMemoryBarrier(GL_ELEMENT_ARRAY_BARRIER_BIT |
+                    GL_BUFFER_UPDATE_BARRIER_BIT |
+                    GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void
+GLUniformRefiner::refineLevel(int parentLevel) {
+
+    Level const &parent = _levels[parentLevel];
+    Level &child = _levels[parentLevel + 1];
+
+    child.faceVertBuffer = createBuffer(
+        (GLsizeiptr)child.numFaceVertices * sizeof(GLint), NULL,
+        GL_DYNAMIC_COPY);
+    child.faceEdgeBuffer = createBuffer(
+        (GLsizeiptr)child.numFaceVertices * sizeof(GLint), NULL,
+        GL_DYNAMIC_COPY);
+    child.edgeVertBuffer = createBuffer(
+        (GLsizeiptr)child.numEdges * 2 * sizeof(GLint), NULL,
+        GL_DYNAMIC_COPY);
+
+    // the child vertices are ordered by the type of their parent component
+    // as in Vtr::Refinement -- Loop faces have no child vertex
+    int numFromFaces = _triSplit ? 0 : parent.numFaces;
+    int vertFromFaceBase, vertFromEdgeBase, vertFromVertBase;
+    if (_faceVertsFirst) {
+        vertFromFaceBase = 0;
+        vertFromEdgeBase = numFromFaces;
+        vertFromVertBase = numFromFaces + parent.numEdges;
+    } else {
+        vertFromVertBase = 0;
+        vertFromFaceBase = parent.numVertices;
+        vertFromEdgeBase = parent.numVertices + numFromFaces;
+    }
+    // the child edges of the parent faces precede those of the parent edges
+    int edgeFromEdgeBase = _triSplit ? parent.numFaces * 3
+                                     : parent.numFaceVertices;
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, parent.faceVertBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, parent.faceEdgeBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, parent.edgeVertBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3,
+        parent.faceOffsetBuffer ? parent.faceOffsetBuffer
+                                : parent.faceVertBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, child.faceVertBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, child.faceEdgeBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, child.edgeVertBuffer);
+
+    glUniform1i(_uniformTriSplit, _triSplit ? 1 : 0);
+    glUniform1i(_uniformNumParentFaces, parent.numFaces);
+    glUniform1i(_uniformNumParentEdges, parent.numEdges);
+    glUniform1i(_uniformParentRegFaceSize, parent.regFaceSize);
+    glUniform1i(_uniformChildVertFromFaceBase, vertFromFaceBase);
+    glUniform1i(_uniformChildVertFromEdgeBase, vertFromEdgeBase);
+    glUniform1i(_uniformChildVertFromVertBase, vertFromVertBase);
+    glUniform1i(_uniformChildEdgeFromEdgeBase, edgeFromEdgeBase);
+
+    // a pass over the parent faces and one over the parent edges, which
+    // write disjoint child components and so need no barrier in between
+    for (int pass = PASS_FACES; pass <= PASS_EDGES; ++pass) {
+        int count = (pass == PASS_FACES) ? parent.numFaces : parent.numEdges;
+        if (count == 0) continue;
+
+        glUniform1i(_uniformPass, pass);
+
+        // in rows of at most maxWorkGroupCount work groups
+        int numGroups = (count + _workGroupSize - 1) / _workGroupSize;
+        int numGroupsX = std::min(numGroups, maxWorkGroupCount);
+        int numGroupsY = (numGroups + numGroupsX - 1) / numGroupsX;
+        glDispatchCompute(numGroupsX, numGroupsY, 1);
+    }
+
+    // the child level is the parent of the next pass
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,184 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_GL_UNIFORM_REFINER_H
+#define OPENSUBDIV3_OSD_GL_UNIFORM_REFINER_H
+
+#include "../version.h"
+
+#include "../osd/opengl.h"
+#include "../osd/nonCopyable.h"
+#include "../far/topologyRefiner.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+/// \brief Uniform refinement of the topology of a base level by a compute pass
+///
+/// GLUniformRefiner generates the face-vertex indices of the levels of a
+/// uniform refinement on the GPU, so that the faces of any level can be drawn
+/// without refining the topology on the CPU. Only the base level of a
+/// Far::TopologyRefiner is read (once, on creation), and each level is
+/// generated from the previous one by a compute pass per parent face and per
+/// parent edge -- the levels of Catmark and Bilinear meshes are split into
+/// quads and those of Loop meshes into triangles.
+///
+/// The components of each level are indexed exactly as those of
+/// Far::TopologyRefiner::RefineUniform() with the same options, so the
+/// vertices of a level are those of a StencilTable of the same refinement
+/// (e.g. created with generateIntermediateLevels set and evaluated once by an
+/// Evaluator). The face-vertex indices of a level are relative to its first
+/// vertex, given by GetVertexOffset():
+///
+///     refiner->Refine(level);
+///
+///     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+///                  refiner->GetFaceVertexBuffer(level));
+///     glDrawElementsBaseVertex(GL_LINES_ADJACENCY,
+///                  refiner->GetNumFaces(level) * 4, GL_UNSIGNED_INT, 0,
+///                  refiner->GetVertexOffset(level));
+///
+/// The face-edge and edge-vertex indices of each level are also generated,
+/// e.g. for the drawing of edges. Sparse refinement (including pruneHoles)
+/// and orderVerticesByFaces are not supported.
+///
+class GLUniformRefiner : private NonCopyable<GLUniformRefiner> {
+public:
+    /// \brief Creates the refiner of the base level of a TopologyRefiner (or
+    ///        NULL if not supported or the kernel fails to compile)
+    ///
+    /// @param refiner        the refiner, of which only the base level is
+    ///                       read -- it is not needed after creation
+    ///
+    /// @param options        the options of the uniform refinement (the
+    ///                       refinementLevel being the maximum level)
+    ///
+    /// @param deviceContext  not used
+    ///
+    static GLUniformRefiner *Create(
+        Far::TopologyRefiner const &refiner,
+        Far::TopologyRefiner::UniformOptions const &options,
+        void *deviceContext = NULL);
+
+    ~GLUniformRefiner();
+
+    /// \brief Generates the levels up to the given level which have not
+    ///        been generated yet
+    void Refine(int level);
+
+    /// Returns the maximum level of the refinement
+    int GetMaxLevel() const { return (int)_levels.size() - 1; }
+
+    /// Returns the number of levels generated (including the base level)
+    int GetNumLevelsRefined() const { return _numLevelsRefined; }
+
+    /// Returns the number of faces of a level
+    int GetNumFaces(int level) const { return _levels[level].numFaces; }
+
+    /// Returns the number of edges of a level
+    int GetNumEdges(int level) const { return _levels[level].numEdges; }
+
+    /// Returns the number of vertices of a level
+    int GetNumVertices(int level) const { return _levels[level].numVertices; }
+
+    /// \brief Returns the number of vertices of the levels preceding a
+    ///        level, i.e. the index of its first vertex in the vertices of
+    ///        all levels
+    int GetVertexOffset(int level) const;
+
+    /// \brief Returns the size of the faces of a refined level (4 or 3), or
+    ///        0 for a base level of irregular faces
+    int GetRegularFaceSize(int level) const {
+        return _levels[level].regFaceSize;
+    }
+
+    /// \brief Returns the GL buffer of the face-vertex indices of a level
+    ///        (GetRegularFaceSize() per face if regular)
+    GLuint GetFaceVertexBuffer(int level) const {
+        return _levels[level].faceVertBuffer;
+    }
+
+    /// Returns the GL buffer of the face-edge indices of a level
+    GLuint GetFaceEdgeBuffer(int level) const {
+        return _levels[level].faceEdgeBuffer;
+    }
+
+    /// Returns the GL buffer of the edge-vertex indices (2 per edge) of a level
+    GLuint GetEdgeVertexBuffer(int level) const {
+        return _levels[level].edgeVertBuffer;
+    }
+
+protected:
+    GLUniformRefiner();
+
+    bool compile();
+
+    void refineLevel(int parent);
+
+private:
+    struct Level {
+        int numFaces;
+        int numEdges;
+        int numVertices;
+        int numFaceVertices;    // total of the face-vertex indices
+        int regFaceSize;
+
+        GLuint faceVertBuffer;
+        GLuint faceEdgeBuffer;
+        GLuint edgeVertBuffer;
+        GLuint faceOffsetBuffer;    // of irregular faces only
+    };
+    std::vector<Level> _levels;
+    int _numLevelsRefined;
+
+    bool _triSplit;
+    bool _faceVertsFirst;
+
+    GLuint _program;
+    int _workGroupSize;
+
+    GLint _uniformPass;
+    GLint _uniformTriSplit;
+    GLint _uniformNumParentFaces;
+    GLint _uniformNumParentEdges;
+    GLint _uniformParentRegFaceSize;
+    GLint _uniformChildVertFromFaceBase;
+    GLint _uniformChildVertFromEdgeBase;
+    GLint _uniformChildVertFromVertBase;
+    GLint _uniformChildEdgeFromEdgeBase;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_GL_UNIFORM_REFINER_H
@@ -34,7 +34,9 @@ namespace Osd {
 GLVertexBuffer::GLVertexBuffer(int numElements, int numVertices)
     : _numElements(numElements),
       _numVertices(numVertices),
-      _vbo(0) {
+      _vbo(0),
+      _readbackBuffer(0), _readbackMapped(0), _readbackFence(0),
+      _readbackStart(0), _readbackCount(0), _readbackRead(false) {
 
     // Initialize internal OpenGL loader library if necessary
     OpenSubdiv::internal::GLLoader::libraryInitializeGL();
@@ -42,6 +44,17 @@ GLVertexBuffer::GLVertexBuffer(int numElements, int numVertices)
 
 GLVertexBuffer::~GLVertexBuffer() {
 
+    if (_readbackFence) {
+        glDeleteSync(_readbackFence);
+    }
+    if (_readbackBuffer) {
+        if (_readbackMapped) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, _readbackBuffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &_readbackBuffer);
+    }
     glDeleteBuffers(1, &_vbo);
 }
 
@@ -93,6 +106,127 @@ GLVertexBuffer::BindVBO(void * /*deviceContext*/) {
     return _vbo;
 }
 
+bool
+GLVertexBuffer::BeginReadback(int startVertex, int numVertices,
+                              void * /*deviceContext*/) {
+
+    if (startVertex < 0 || numVertices <= 0 ||
+        startVertex + numVertices > _numVertices) return false;
+
+    if (! _readbackBuffer && ! allocateReadback()) return false;
+
+    if (_readbackFence) {
+        glDeleteSync(_readbackFence);
+        _readbackFence = 0;
+    }
+
+    // The copy keeps the offsets of the vertices in the readback buffer
+    GLintptr offset = (GLintptr)startVertex * _numElements * sizeof(float);
+    GLsizeiptr size = (GLsizeiptr)numVertices * _numElements * sizeof(float);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, _vbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _readbackBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                        offset, offset, size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // Flush so that the fence is eventually signaled while polled
+    _readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    _readbackStart = startVertex;
+    _readbackCount = numVertices;
+    _readbackRead = false;
+    return true;
+}
+
+bool
+GLVertexBuffer::IsReadbackReady() {
+
+    if (! _readbackCount) return false;
+    if (! _readbackFence) return true;
+
+    GLenum status = glClientWaitSync(_readbackFence, 0, 0);
+    if ((status == GL_ALREADY_SIGNALED) ||
+        (status == GL_CONDITION_SATISFIED)) {
+        glDeleteSync(_readbackFence);
+        _readbackFence = 0;
+        return true;
+    }
+    return false;
+}
+
+const float *
+GLVertexBuffer::GetReadbackData(bool wait) {
+
+    if (! IsReadbackReady()) {
+        if (! wait || ! _readbackCount) return 0;
+
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        for (;;) {
+            GLenum status = glClientWaitSync(_readbackFence, flags,
+                                             1000000 /* ns */);
+            if ((status == GL_ALREADY_SIGNALED) ||
+                (status == GL_CONDITION_SATISFIED) ||
+                (status == GL_WAIT_FAILED)) break;
+            flags = 0;
+        }
+        glDeleteSync(_readbackFence);
+        _readbackFence = 0;
+    }
+
+    size_t offset = (size_t)_readbackStart * _numElements;
+    if (_readbackMapped) {
+        return _readbackMapped + offset;
+    }
+
+    // The copy has completed, so reading it does not stall
+    if (! _readbackRead) {
+        glBindBuffer(GL_COPY_READ_BUFFER, _readbackBuffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER,
+                           (GLintptr)(offset * sizeof(float)),
+                           (GLsizeiptr)_readbackCount * _numElements *
+                               sizeof(float),
+                           &_readbackData[offset]);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        _readbackRead = true;
+    }
+    return &_readbackData[offset];
+}
+
+bool
+GLVertexBuffer::allocateReadback() {
+
+    GLsizeiptr size = (GLsizeiptr)_numElements * _numVertices * sizeof(float);
+
+    glGenBuffers(1, &_readbackBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _readbackBuffer);
+
+#if defined(GL_ARB_buffer_storage)
+    if (OSD_OPENGL_HAS(ARB_buffer_storage) || OSD_OPENGL_HAS(VERSION_4_4)) {
+        GLbitfield mapFlags = GL_MAP_READ_BIT |
+                              GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, 0,
+                        mapFlags | GL_CLIENT_STORAGE_BIT);
+        _readbackMapped = (float *)glMapBufferRange(GL_COPY_WRITE_BUFFER,
+                                                    0, size, mapFlags);
+    } else
+#endif
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, size, 0, GL_STREAM_READ);
+        _readbackData.resize((size_t)_numElements * _numVertices);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (_readbackData.empty() && ! _readbackMapped) {
+        glDeleteBuffers(1, &_readbackBuffer);
+        _readbackBuffer = 0;
+        return false;
+    }
+    return true;
+}
+
 bool
 GLVertexBuffer::allocate() {
 
@@ -29,6 +29,7 @@
 
 #include "../osd/opengl.h"
 #include <cstddef>
+#include <vector>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -41,6 +42,24 @@ namespace Osd {
 /// GLVertexBuffer implements GLVertexBufferInterface. An instance
 /// of this buffer class can be passed to OsdGLComputeEvaluator.
 ///
+/// Refined vertices are read back asynchronously by BeginReadback, which
+/// queues a copy of the vertices into a readback buffer followed by a fence,
+/// and GetReadbackData, which returns the copy once the fence is signaled
+/// without stalling the GL pipeline, e.g. for a cpu consumer reading the
+/// vertices refined on the previous frame:
+///
+/// \code
+///   if (const float *data = buffer->GetReadbackData()) {
+///       consume(data);
+///   }
+///   evaluator->EvalStencils(buffer, ...);
+///   buffer->BeginReadback(0, buffer->GetNumVertices());
+/// \endcode
+///
+/// The readback buffer is persistently mapped with GL_ARB_buffer_storage
+/// (core in OpenGL 4.4), otherwise the copy is read with
+/// glGetBufferSubData once the fence is signaled.
+///
 class GLVertexBuffer {
 public:
     /// Creator. Returns NULL if error.
@@ -64,6 +83,20 @@ public:
     /// Returns the GL buffer object.
     GLuint BindVBO(void *deviceContext = NULL);
 
+    /// Queues the copy of vertices for an asynchronous readback, replacing
+    /// the previous readback. Returns false if error.
+    bool BeginReadback(int startVertex, int numVertices,
+                       void *deviceContext = NULL);
+
+    /// Returns true if the vertices of the last readback can be read by
+    /// GetReadbackData without waiting. Never blocks.
+    bool IsReadbackReady();
+
+    /// Returns the vertices of the last readback, or NULL if none was
+    /// requested or if it is not ready and wait is false. The data remains
+    /// valid until the next BeginReadback.
+    const float * GetReadbackData(bool wait = false);
+
 protected:
     /// Constructor.
     GLVertexBuffer(int numElements, int numVertices);
@@ -72,10 +105,21 @@ protected:
     /// Returns true if success.
     bool allocate();
 
+    /// Allocates the readback buffer. Returns true if success.
+    bool allocateReadback();
+
 private:
     int _numElements;
     int _numVertices;
     GLuint _vbo;
+
+    GLuint _readbackBuffer;
+    float *_readbackMapped;
+    std::vector<float> _readbackData;
+    GLsync _readbackFence;
+    int _readbackStart;
+    int _readbackCount;
+    bool _readbackRead;
 };
 
 }  // end namespace Osd
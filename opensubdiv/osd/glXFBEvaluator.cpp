@@ -25,6 +25,7 @@
 #include "glLoader.h"
 
 #include "../osd/glXFBEvaluator.h"
+#include "../osd/glProgramBinaryCache.h"
 #include "../osd/glslPatchShaderSource.h"
 
 #include <sstream>
@@ -34,6 +35,7 @@
 
 #include "../far/error.h"
 #include "../far/stencilTable.h"
+#include "../osd/stencilOffsets.h"
 
 #if _MSC_VER
     #define snprintf _snprintf
@@ -89,6 +91,17 @@ createGLTextureBuffer(std::vector<T> const & src, GLenum type) {
     return devicePtr;
 }
 
+#ifdef OPENSUBDIV_64BIT_OFFSETS
+// The kernels address the stencil tables with 32-bit offsets (tables
+// exceeding them are rejected)
+static GLuint
+createGLTextureBuffer(std::vector<Far::Offset> const & src, GLenum type) {
+    std::vector<int> offsets;
+    if (! internal::NarrowStencilOffsets(src, offsets)) return 0;
+    return createGLTextureBuffer(offsets, type);
+}
+#endif
+
 GLStencilTableTBO::GLStencilTableTBO(
     Far::StencilTable const *stencilTable) {
 
@@ -182,10 +195,6 @@ compileKernel(BufferDescriptor const &srcDesc,
               const char *kernelDefine,
               bool interleavedDerivativeBuffers) {
 
-    GLuint program = glCreateProgram();
-
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-
     std::string patchBasisShaderSource =
         GLSLPatchShaderSource::GetPatchBasisShaderSource();
     const char *patchBasisShaderSourceDefine = "#define OSD_PATCH_BASIS_GLSL\n";
@@ -221,9 +230,6 @@ compileKernel(BufferDescriptor const &srcDesc,
     shaderSources[1] = defineStr.c_str();
     shaderSources[2] = patchBasisShaderSource.c_str();
     shaderSources[3] = shaderSource;
-    glShaderSource(vertexShader, 4, shaderSources, NULL);
-    glCompileShader(vertexShader);
-    glAttachShader(program, vertexShader);
 
     std::vector<std::string> outputs;
     char attrName[32];
@@ -401,6 +407,28 @@ compileKernel(BufferDescriptor const &srcDesc,
         pOutputs.push_back(&outputs[i][0]);
     }
 
+    GLuint program = glCreateProgram();
+
+    // look up a program binary previously stored for these sources and
+    // transform feedback varyings
+    std::string binaryKey;
+    if (internal::IsGLProgramBinaryCacheEnabled()) {
+        std::vector<const char *> keyStrings(shaderSources, shaderSources + 4);
+        keyStrings.insert(keyStrings.end(), pOutputs.begin(), pOutputs.end());
+
+        binaryKey = internal::GetGLProgramBinaryKey(&keyStrings[0],
+                                                    (int)keyStrings.size());
+        if (internal::LoadGLProgramBinary(program, binaryKey)) {
+            return program;
+        }
+        internal::PrepareGLProgramBinary(program);
+    }
+
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 4, shaderSources, NULL);
+    glCompileShader(vertexShader);
+    glAttachShader(program, vertexShader);
+
     glTransformFeedbackVaryings(program, (GLsizei)outputs.size(),
                                 &pOutputs[0], GL_INTERLEAVED_ATTRIBS);
 
@@ -422,6 +450,10 @@ compileKernel(BufferDescriptor const &srcDesc,
 
     glDeleteShader(vertexShader);
 
+    if (program && !binaryKey.empty()) {
+        internal::StoreGLProgramBinary(program, binaryKey);
+    }
+
     return program;
 }
 
@@ -95,6 +95,13 @@ private:
 
 // ---------------------------------------------------------------------------
 
+/// \brief Transform feedback evaluator
+///
+/// GLComputeEvaluator supports the same evaluations with shader storage
+/// buffers, and evaluates the points and all the requested derivatives of
+/// stencils, limit stencils and patches in a single dispatch. It should be
+/// preferred wherever OpenGL 4.3 is available.
+///
 class GLXFBEvaluator {
 public:
     typedef bool Instantiatable;
@@ -32,8 +32,17 @@ layout(std430) buffer;
 
 uniform int srcOffset = 0;
 uniform int dstOffset = 0;
+// half (SRC_HALF, DST_HALF) vertex buffers pack two elements per uint
+#if defined(SRC_HALF)
+layout(binding=0) buffer src_buffer      { uint     srcVertexBuffer[]; };
+#else
 layout(binding=0) buffer src_buffer      { float    srcVertexBuffer[]; };
+#endif
+#if defined(DST_HALF)
+layout(binding=1) buffer dst_buffer      { uint     dstVertexBuffer[]; };
+#else
 layout(binding=1) buffer dst_buffer      { float    dstVertexBuffer[]; };
+#endif
 
 // derivative buffers (if needed)
 
@@ -44,6 +53,24 @@ layout(binding=2) buffer du_buffer   { float duBuffer[]; };
 layout(binding=3) buffer dv_buffer   { float dvBuffer[]; };
 #endif
 
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_NORMALS)
+// the unit normals are written in place of the 1st derivatives, to the du
+// buffer, and the points only if writePoints is set
+uniform int writePoints = 1;
+#endif
+
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_DISPLACEMENT)
+// the points are displaced along the unit normals by the displacement
+// sampled at the ptex coordinates of the patch coords, from a ptex texture
+// packed into the pages of a texture array with a layout of 6 ints per face
+// (see GLComputeEvaluator::EvalPatchesDisplaced()), and the normals of the
+// displaced surface written in place of the normals if writeNormals is set
+uniform sampler2DArray displacementTexels;
+uniform isamplerBuffer displacementLayout;
+uniform float displacementScale = 1.0;
+uniform int writeNormals = 1;
+#endif
+
 #if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
 uniform ivec3 duuDesc;
 uniform ivec3 duvDesc;
@@ -61,8 +88,19 @@ uniform int batchStart = 0;
 uniform int batchEnd = 0;
 layout(binding=4) buffer stencilSizes    { int      _sizes[];   };
 layout(binding=5) buffer stencilOffsets  { int      _offsets[]; };
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_COMPACT_STENCILS)
+// each entry packs a 16-bit control vertex delta (low bits) with a 16-bit
+// signed weight scaled by the per-stencil scale (high bits)
+layout(binding=6) buffer stencilEntries     { uint  _entries[];     };
+layout(binding=7) buffer stencilScales      { float _scales[];      };
+layout(binding=8) buffer stencilBaseIndices { int   _baseIndices[]; };
+#else
 layout(binding=6) buffer stencilIndices  { int      _indices[]; };
 layout(binding=7) buffer stencilWeights  { float    _weights[]; };
+// when set, only the stencils in the index list are evaluated
+uniform int useStencilIndices = 0;
+layout(binding=16) buffer stencilIndexList { int    _stencilIndexList[]; };
+#endif
 
 #if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
 layout(binding=8) buffer stencilDuWeights { float  _duWeights[]; };
@@ -86,6 +124,21 @@ layout(binding=5) buffer patchCoord_buffer { OsdPatchCoord patchCoords[]; };
 layout(binding=6) buffer patchIndex_buffer { int patchIndexBuffer[]; };
 layout(binding=7) buffer patchParam_buffer { OsdPatchParam patchParamBuffer[]; };
 
+// pre-expanded normalizations of the patch params (if patchNormalization)
+layout(binding=13) buffer patchNormalization_buffer {
+    OsdPatchParamNormalization patchNormalizationBuffer[]; };
+uniform int patchNormalization = 0;
+
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_PATCH_STENCILS)
+// stencils of the patch points past the control vertices -- the fused
+// kernel has no 2nd derivatives, so the bindings of their buffers are reused
+layout(binding=8) buffer patchStencilSizes   { int _patchStencilSizes[]; };
+layout(binding=9) buffer patchStencilOffsets { int _patchStencilOffsets[]; };
+layout(binding=10) buffer patchStencilIndices { int _patchStencilIndices[]; };
+layout(binding=11) buffer patchStencilWeights { float _patchStencilWeights[]; };
+uniform int numControlVertices = 0;
+#endif
+
 OsdPatchCoord GetPatchCoord(int coordIndex)
 {
     return patchCoords[coordIndex];
@@ -119,16 +172,49 @@ Vertex readVertex(int index) {
     Vertex v;
     int vertexIndex = srcOffset + index * SRC_STRIDE;
     for (int i = 0; i < LENGTH; ++i) {
+#if defined(SRC_HALF)
+        int e = vertexIndex + i;
+        v.vertexData[i] = unpackHalf2x16(srcVertexBuffer[e >> 1])[e & 1];
+#else
         v.vertexData[i] = srcVertexBuffer[vertexIndex + i];
+#endif
     }
     return v;
 }
 
+#if defined(DST_HALF)
+// The other half of the word may belong to the vertex of another thread
+void writeHalf(int e, float value) {
+    uint shift = uint(e & 1) * 16u;
+    uint bits = packHalf2x16(vec2(value, 0)) << shift;
+    atomicAnd(dstVertexBuffer[e >> 1], ~(0xffffu << shift));
+    atomicOr(dstVertexBuffer[e >> 1], bits);
+}
+#endif
+
 void writeVertex(int index, Vertex v) {
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_NORMALS)
+    if (writePoints == 0) return;
+#endif
     int vertexIndex = dstOffset + index * DST_STRIDE;
+#if defined(DST_HALF)
+    int i = 0;
+    while (i < LENGTH) {
+        int e = vertexIndex + i;
+        if ((e & 1) == 0 && i + 1 < LENGTH) {
+            dstVertexBuffer[e >> 1] = packHalf2x16(
+                vec2(v.vertexData[i], v.vertexData[i+1]));
+            i += 2;
+        } else {
+            writeHalf(e, v.vertexData[i]);
+            i += 1;
+        }
+    }
+#else
     for (int i = 0; i < LENGTH; ++i) {
         dstVertexBuffer[vertexIndex + i] = v.vertexData[i];
     }
+#endif
 }
 
 void addWithWeight(inout Vertex v, const Vertex src, float weight) {
@@ -153,6 +239,82 @@ void writeDv(int index, Vertex dv) {
 }
 #endif
 
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_NORMALS)
+// normalized cross product of the first 3 elements (zero if degenerate)
+void writeNormal(int index, Vertex du, Vertex dv) {
+    vec3 n = cross(
+        vec3(du.vertexData[0], du.vertexData[1], du.vertexData[2]),
+        vec3(dv.vertexData[0], dv.vertexData[1], dv.vertexData[2]));
+    float len = length(n);
+    n = (len > 0) ? (n / len) : vec3(0);
+
+    int normalIndex = duDesc.x + index * duDesc.z;
+    duBuffer[normalIndex + 0] = n.x;
+    duBuffer[normalIndex + 1] = n.y;
+    duBuffer[normalIndex + 2] = n.z;
+}
+#endif
+
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_DISPLACEMENT)
+// bilinear lookup of the displacement at (u,v) of a ptex face, and of its
+// derivatives with respect to u and v
+float sampleDisplacement(int faceId, float u, float v,
+                         out float dDu, out float dDv) {
+    int page    = texelFetch(displacementLayout, faceId*6).x;
+    int uOffset = texelFetch(displacementLayout, faceId*6+2).x;
+    int vOffset = texelFetch(displacementLayout, faceId*6+3).x;
+    int wh      = texelFetch(displacementLayout, faceId*6+5).x;
+    float width  = float(1 << (wh >> 8));
+    float height = float(1 << (wh & 0xff));
+
+    vec2 coords = vec2(clamp(u, 0, 1) * width + uOffset,
+                       clamp(v, 0, 1) * height + vOffset) - vec2(0.5);
+    ivec2 c = ivec2(floor(coords));
+    vec2 f = coords - vec2(c);
+
+    float d00 = texelFetch(displacementTexels, ivec3(c.x,   c.y,   page), 0).x;
+    float d10 = texelFetch(displacementTexels, ivec3(c.x+1, c.y,   page), 0).x;
+    float d01 = texelFetch(displacementTexels, ivec3(c.x,   c.y+1, page), 0).x;
+    float d11 = texelFetch(displacementTexels, ivec3(c.x+1, c.y+1, page), 0).x;
+
+    dDu = mix(d10 - d00, d11 - d01, f.y) * width;
+    dDv = mix(d01 - d00, d11 - d10, f.x) * height;
+    return mix(mix(d00, d10, f.x), mix(d01, d11, f.x), f.y);
+}
+
+// displaces the first 3 elements of the point along the unit normal, and
+// writes the normal of the displaced surface, ignoring the variation of
+// the normal itself as for bump mapping
+void writeDisplacedVertex(int index, int faceId, float u, float v,
+                          Vertex p, Vertex du, Vertex dv) {
+    vec3 Pu = vec3(du.vertexData[0], du.vertexData[1], du.vertexData[2]);
+    vec3 Pv = vec3(dv.vertexData[0], dv.vertexData[1], dv.vertexData[2]);
+    vec3 n = cross(Pu, Pv);
+    float len = length(n);
+    n = (len > 0) ? (n / len) : vec3(0);
+
+    float dDu, dDv;
+    float d = sampleDisplacement(faceId, u, v, dDu, dDv);
+    d *= displacementScale;
+    dDu *= displacementScale;
+    dDv *= displacementScale;
+
+    for (int i = 0; i < 3; ++i) {
+        p.vertexData[i] += d * n[i];
+    }
+    writeVertex(index, p);
+
+    if (writeNormals != 0) {
+        Vertex displacedDu = du, displacedDv = dv;
+        for (int i = 0; i < 3; ++i) {
+            displacedDu.vertexData[i] += dDu * n[i];
+            displacedDv.vertexData[i] += dDv * n[i];
+        }
+        writeNormal(index, displacedDu, displacedDv);
+    }
+}
+#endif
+
 #if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
 void writeDuu(int index, Vertex duu) {
     int duuIndex = duuDesc.x + index * duuDesc.z;
@@ -177,7 +339,8 @@ void writeDvv(int index, Vertex dvv) {
 #endif
 
 //------------------------------------------------------------------------------
-#if defined(OPENSUBDIV_GLSL_COMPUTE_KERNEL_EVAL_STENCILS)
+#if defined(OPENSUBDIV_GLSL_COMPUTE_KERNEL_EVAL_STENCILS) && \
+    defined(OPENSUBDIV_GLSL_COMPUTE_USE_COMPACT_STENCILS)
 
 void main() {
 
@@ -191,47 +354,220 @@ void main() {
     clear(dst);
 
     int offset = _offsets[current],
-        size   = _sizes[current];
+        size   = _sizes[current],
+        index  = _baseIndices[current];
+    float scale = _scales[current];
 
     for (int stencil = 0; stencil < size; ++stencil) {
-        int vindex = offset + stencil;
+        uint entry = _entries[offset + stencil];
+        index += int(entry & 0xffffu);
         addWithWeight(
-            dst, readVertex(_indices[vindex]), _weights[vindex]);
+            dst, readVertex(index), float(int(entry) >> 16) * scale);
     }
 
     writeVertex(current, dst);
+}
+
+#elif defined(OPENSUBDIV_GLSL_COMPUTE_KERNEL_EVAL_STENCILS) && \
+      defined(OPENSUBDIV_GLSL_COMPUTE_USE_COOPERATIVE_STENCILS)
+
+// each stencil is evaluated by a group of COOPERATIVE_LANES invocations,
+// which accumulate every COOPERATIVE_LANES-th weight and sum their results,
+// so that large stencils (e.g. Gregory end-caps) don't serialize a single
+// invocation while the rest of the subgroup idles.
+
+#define STENCILS_PER_WORK_GROUP (WORK_GROUP_SIZE / COOPERATIVE_LANES)
+
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_SUBGROUP_CLUSTERED)
+
+int getStencilSlot() {
+    return int(gl_WorkGroupID.x) * STENCILS_PER_WORK_GROUP +
+        int(gl_SubgroupID * (gl_SubgroupSize / COOPERATIVE_LANES) +
+            gl_SubgroupInvocationID / COOPERATIVE_LANES);
+}
 
+int getStencilLane() {
+    return int(gl_SubgroupInvocationID % COOPERATIVE_LANES);
+}
+
+void reduce(inout Vertex v) {
+    for (int i = 0; i < LENGTH; ++i) {
+        v.vertexData[i] =
+            subgroupClusteredAdd(v.vertexData[i], COOPERATIVE_LANES);
+    }
+}
+
+#else
+
+shared float _reduceBuffer[WORK_GROUP_SIZE];
+
+int getStencilSlot() {
+    return int(gl_WorkGroupID.x) * STENCILS_PER_WORK_GROUP +
+        int(gl_LocalInvocationIndex) / COOPERATIVE_LANES;
+}
+
+int getStencilLane() {
+    return int(gl_LocalInvocationIndex) % COOPERATIVE_LANES;
+}
+
+// must be reached by all the invocations of the work group
+void reduce(inout Vertex v) {
+    int local = int(gl_LocalInvocationIndex);
+    int lane = local % COOPERATIVE_LANES;
+    for (int i = 0; i < LENGTH; ++i) {
+        _reduceBuffer[local] = v.vertexData[i];
+        memoryBarrierShared();
+        barrier();
+        for (int s = COOPERATIVE_LANES/2; s > 0; s >>= 1) {
+            if (lane < s) {
+                _reduceBuffer[local] += _reduceBuffer[local + s];
+            }
+            memoryBarrierShared();
+            barrier();
+        }
+        v.vertexData[i] = _reduceBuffer[local - lane];
+        barrier();
+    }
+}
+
+#endif
+
+void main() {
+
+    // invocations past the end still take part in the reductions
+    int slot = getStencilSlot() + batchStart;
+    int lane = getStencilLane();
+    bool valid = (slot < batchEnd);
+
+    int current = 0, offset = 0, size = 0;
+    if (valid) {
+        current = (useStencilIndices != 0) ? _stencilIndexList[slot] : slot;
+        offset  = _offsets[current];
+        size    = _sizes[current];
+    }
+
+    Vertex dst;
+    clear(dst);
 #if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
     Vertex du, dv;
     clear(du);
     clear(dv);
-    for (int i=0; i<size; ++i) {
-        // expects the compiler optimizes readVertex out here.
-        Vertex src = readVertex(_indices[offset+i]);
-        addWithWeight(du, src, _duWeights[offset+i]);
-        addWithWeight(dv, src, _dvWeights[offset+i]);
+#endif
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
+    Vertex duu, duv, dvv;
+    clear(duu);
+    clear(duv);
+    clear(dvv);
+#endif
+
+    // each source vertex is read once for all the requested outputs
+    for (int i = lane; i < size; i += COOPERATIVE_LANES) {
+        int vindex = offset + i;
+        Vertex src = readVertex(_indices[vindex]);
+        addWithWeight(dst, src, _weights[vindex]);
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
+        addWithWeight(du, src, _duWeights[vindex]);
+        addWithWeight(dv, src, _dvWeights[vindex]);
+#endif
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
+        addWithWeight(duu, src, _duuWeights[vindex]);
+        addWithWeight(duv, src, _duvWeights[vindex]);
+        addWithWeight(dvv, src, _dvvWeights[vindex]);
+#endif
     }
 
-    if (duDesc.y > 0) { // length
+    bool write = valid && (lane == 0);
+
+    reduce(dst);
+    if (write) {
+        writeVertex(current, dst);
+    }
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
+    reduce(du);
+    reduce(dv);
+    if (write && duDesc.y > 0) { // length
         writeDu(current, du);
     }
-    if (dvDesc.y > 0) {
+    if (write && dvDesc.y > 0) {
         writeDv(current, dv);
     }
 #endif
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
+    reduce(duu);
+    reduce(duv);
+    reduce(dvv);
+    if (write && duuDesc.y > 0) { // length
+        writeDuu(current, duu);
+    }
+    if (write && duvDesc.y > 0) {
+        writeDuv(current, duv);
+    }
+    if (write && dvvDesc.y > 0) {
+        writeDvv(current, dvv);
+    }
+#endif
+}
+
+#elif defined(OPENSUBDIV_GLSL_COMPUTE_KERNEL_EVAL_STENCILS)
+
+void main() {
+
+    int current = int(gl_GlobalInvocationID.x) + batchStart;
+
+    if (current>=batchEnd) {
+        return;
+    }
+
+    if (useStencilIndices != 0) {
+        current = _stencilIndexList[current];
+    }
+
+    Vertex dst;
+    clear(dst);
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
+    Vertex du, dv;
+    clear(du);
+    clear(dv);
+#endif
 #if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
     Vertex duu, duv, dvv;
     clear(duu);
     clear(duv);
     clear(dvv);
-    for (int i=0; i<size; ++i) {
-        // expects the compiler optimizes readVertex out here.
-        Vertex src = readVertex(_indices[offset+i]);
-        addWithWeight(duu, src, _duuWeights[offset+i]);
-        addWithWeight(duv, src, _duvWeights[offset+i]);
-        addWithWeight(dvv, src, _dvvWeights[offset+i]);
+#endif
+
+    int offset = _offsets[current],
+        size   = _sizes[current];
+
+    // each source vertex is read once for all the requested outputs
+    for (int stencil = 0; stencil < size; ++stencil) {
+        int vindex = offset + stencil;
+        Vertex src = readVertex(_indices[vindex]);
+        addWithWeight(dst, src, _weights[vindex]);
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
+        addWithWeight(du, src, _duWeights[vindex]);
+        addWithWeight(dv, src, _dvWeights[vindex]);
+#endif
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
+        addWithWeight(duu, src, _duuWeights[vindex]);
+        addWithWeight(duv, src, _duvWeights[vindex]);
+        addWithWeight(dvv, src, _dvvWeights[vindex]);
+#endif
     }
 
+    writeVertex(current, dst);
+
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_NORMALS)
+    writeNormal(current, du, dv);
+#elif defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
+    if (duDesc.y > 0) { // length
+        writeDu(current, du);
+    }
+    if (dvDesc.y > 0) {
+        writeDv(current, dv);
+    }
+#endif
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
     if (duuDesc.y > 0) { // length
         writeDuu(current, duu);
     }
@@ -262,32 +598,79 @@ void main() {
     int patchType = OsdPatchParamIsRegular(param) ? array.regDesc : array.desc;
 
     float wP[20], wDu[20], wDv[20], wDuu[20], wDuv[20], wDvv[20];
-    int nPoints = OsdEvaluatePatchBasis(patchType, param,
-        coord.s, coord.t, wP, wDu, wDv, wDuu, wDuv, wDvv);
+    int nPoints;
+    if (patchNormalization != 0) {
+        nPoints = OsdEvaluatePatchBasisWithNormalization(patchType, param,
+            patchNormalizationBuffer[coord.patchIndex],
+            coord.s, coord.t, wP, wDu, wDv, wDuu, wDuv, wDvv);
+    } else {
+        nPoints = OsdEvaluatePatchBasis(patchType, param,
+            coord.s, coord.t, wP, wDu, wDv, wDuu, wDuv, wDvv);
+    }
 
-    Vertex dst, du, dv, duu, duv, dvv;
+    Vertex dst;
     clear(dst);
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
+    Vertex du, dv;
     clear(du);
     clear(dv);
+#endif
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
+    Vertex duu, duv, dvv;
     clear(duu);
     clear(duv);
     clear(dvv);
+#endif
 
     int indexBase = array.indexBase + array.stride *
                 (coord.patchIndex - array.primitiveIdBase);
 
+    // each control point is read once for all the requested outputs
     for (int cv = 0; cv < nPoints; ++cv) {
         int index = patchIndexBuffer[indexBase + cv];
-        addWithWeight(dst, readVertex(index), wP[cv]);
-        addWithWeight(du, readVertex(index), wDu[cv]);
-        addWithWeight(dv, readVertex(index), wDv[cv]);
-        addWithWeight(duu, readVertex(index), wDuu[cv]);
-        addWithWeight(duv, readVertex(index), wDuv[cv]);
-        addWithWeight(dvv, readVertex(index), wDvv[cv]);
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_PATCH_STENCILS)
+        if (index >= numControlVertices) {
+            // compute the patch point from its stencil on the fly
+            int stencil = index - numControlVertices;
+            int offset = _patchStencilOffsets[stencil];
+            int size = _patchStencilSizes[stencil];
+            for (int i = 0; i < size; ++i) {
+                Vertex src = readVertex(_patchStencilIndices[offset + i]);
+                float w = _patchStencilWeights[offset + i];
+                addWithWeight(dst, src, wP[cv] * w);
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
+                addWithWeight(du, src, wDu[cv] * w);
+                addWithWeight(dv, src, wDv[cv] * w);
+#endif
+            }
+            continue;
+        }
+#endif
+        Vertex src = readVertex(index);
+        addWithWeight(dst, src, wP[cv]);
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
+        addWithWeight(du, src, wDu[cv]);
+        addWithWeight(dv, src, wDv[cv]);
+#endif
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_2ND_DERIVATIVES)
+        addWithWeight(duu, src, wDuu[cv]);
+        addWithWeight(duv, src, wDuv[cv]);
+        addWithWeight(dvv, src, wDvv[cv]);
+#endif
     }
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_DISPLACEMENT)
+    // the patch coords are the ptex coordinates of the faces
+    writeDisplacedVertex(current, OsdPatchParamGetFaceId(param),
+                         coord.s, coord.t, dst, du, dv);
+#else
     writeVertex(current, dst);
+#endif
 
-#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
+#if defined(OPENSUBDIV_GLSL_COMPUTE_USE_DISPLACEMENT)
+    // the normals are written with the displaced points
+#elif defined(OPENSUBDIV_GLSL_COMPUTE_USE_NORMALS)
+    writeNormal(current, du, dv);
+#elif defined(OPENSUBDIV_GLSL_COMPUTE_USE_1ST_DERIVATIVES)
     if (duDesc.y > 0) { // length
         writeDu(current, du);
     }
@@ -0,0 +1,103 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+//------------------------------------------------------------------------------
+
+//
+// Each invocation converts a legacy Gregory patch into the 20 points of a
+// Gregory basis patch, computing the per-vertex data of its 4 corners and
+// then the per-patch-vertex data of each corner as the vertex and tess
+// control shaders of glslPatchLegacy.glsl do.
+//
+// The kernel is compiled in two parts, the declarations used by
+// glslPatchLegacy.glsl before it and the main function after it (with
+// OSD_LEGACY_GREGORY_KERNEL_MAIN defined).
+//
+
+#ifndef OSD_LEGACY_GREGORY_KERNEL_MAIN
+
+layout(local_size_x=WORK_GROUP_SIZE, local_size_y=1, local_size_z=1) in;
+layout(std430) buffer;
+
+uniform int baseVertex = 0;
+uniform int vertexStride = 3;
+uniform int numPatches = 0;
+uniform int indexBase = 0;
+uniform int quadOffsetBase = 0;
+uniform int pointBase = 0;
+
+#define OSD_NUM_ELEMENTS vertexStride
+
+int OsdBaseVertex()
+{
+    return baseVertex;
+}
+
+int OsdGregoryQuadOffsetBase()
+{
+    return quadOffsetBase;
+}
+
+#else
+
+layout(binding=0) buffer cornerIndex_buffer  { int cornerIndexBuffer[]; };
+layout(binding=1) buffer gregoryBasis_buffer { float gregoryBasisBuffer[]; };
+
+void writePoint(int point, vec3 P) {
+    int index = (pointBase + point) * 3;
+    gregoryBasisBuffer[index]     = P.x;
+    gregoryBasisBuffer[index + 1] = P.y;
+    gregoryBasisBuffer[index + 2] = P.z;
+}
+
+void main() {
+
+    int current = int(gl_GlobalInvocationID.x);
+    if (current >= numPatches) return;
+
+    OsdPerVertexGregory v[4];
+    for (int i = 0; i < 4; ++i) {
+        int vID = cornerIndexBuffer[indexBase + current * 4 + i];
+        OsdComputePerVertexGregory(vID, OsdReadVertex(vID), v[i]);
+    }
+
+    // the points of each corner are ordered as those of a Gregory basis
+    // patch: P, Ep, Em, Fp, Fm
+    for (int i = 0; i < 4; ++i) {
+        OsdPerPatchVertexGregory result;
+        OsdComputePerPatchVertexGregory(ivec3(0), i, current, v, result);
+
+        int point = current * 20 + i * 5;
+        writePoint(point,     result.P);
+        writePoint(point + 1, result.Ep);
+        writePoint(point + 2, result.Em);
+        writePoint(point + 3, result.Fp);
+        writePoint(point + 4, result.Fm);
+    }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
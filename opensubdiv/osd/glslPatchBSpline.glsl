@@ -70,8 +70,10 @@ void main()
         cv[i] = inpt[i].v.position.xyz;
     }
 
-    ivec3 patchParam = OsdGetPatchParam(OsdGetPatchIndex(gl_PrimitiveID));
-    OsdComputePerPatchVertexBSpline(patchParam, gl_InvocationID, cv, outpt[gl_InvocationID].v);
+    int patchIndex = OsdGetPatchIndex(gl_PrimitiveID);
+    ivec3 patchParam = OsdGetPatchParam(patchIndex);
+    OsdComputePerPatchVertexBSpline(patchParam, patchIndex, gl_InvocationID,
+                                    cv, outpt[gl_InvocationID].v);
 
     OSD_USER_VARYING_PER_CONTROL_POINT(gl_InvocationID, gl_InvocationID);
 
@@ -85,7 +87,12 @@ void main()
 
         OSD_PATCH_CULL(16);
 
-#if defined OSD_ENABLE_SCREENSPACE_TESSELLATION
+#if defined OSD_ENABLE_TESS_LEVEL_BUFFER
+        OsdGetTessLevelsFromBuffer(
+                OsdGetPatchIndex(gl_PrimitiveID),
+                tessLevelOuter, tessLevelInner,
+                tessOuterLo, tessOuterHi);
+#elif defined OSD_ENABLE_SCREENSPACE_TESSELLATION
         // Gather bezier control points to compute limit surface tess levels
         OsdPerPatchVertexBezier cpBezier[16];
         cpBezier[0] = outpt[0].v;
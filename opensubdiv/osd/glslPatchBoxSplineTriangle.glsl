@@ -86,7 +86,12 @@ void main()
 
         OSD_PATCH_CULL(12);
 
-#if defined OSD_ENABLE_SCREENSPACE_TESSELLATION
+#if defined OSD_ENABLE_TESS_LEVEL_BUFFER
+        OsdGetTessLevelsFromBufferTriangle(
+                OsdGetPatchIndex(gl_PrimitiveID),
+                tessLevelOuter, tessLevelInner,
+                tessOuterLo, tessOuterHi);
+#elif defined OSD_ENABLE_SCREENSPACE_TESSELLATION
         // Gather bezier control points to compute limit surface tess levels
         vec3 bezcv[15];
         for (int i=0; i<15; ++i) {
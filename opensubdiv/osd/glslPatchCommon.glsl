@@ -195,6 +195,15 @@ float OsdGetPatchSharpness(ivec3 patchParam)
     return intBitsToFloat(patchParam.z);
 }
 
+// A negative sharpness encodes the sharpness of the two creases of a
+// double-crease patch, each quantized to 1/256 (lower crease first)
+vec2 OsdGetPatchDoubleCreaseSharpness(ivec3 patchParam)
+{
+    float encoded = -OsdGetPatchSharpness(patchParam);
+    float lower = floor(encoded / 4096);
+    return vec2(lower, encoded - lower * 4096) / 256;
+}
+
 float OsdGetPatchSingleCreaseSegmentParameter(ivec3 patchParam, vec2 uv)
 {
     int boundaryMask = OsdGetPatchBoundaryMask(patchParam);
@@ -239,6 +248,40 @@ vec4 OsdInterpolatePatchCoordTriangle(vec2 localUV, ivec3 patchParam)
     return result;
 }
 
+// ----------------------------------------------------------------------------
+// patch visibility
+// ----------------------------------------------------------------------------
+
+//
+// With OSD_ENABLE_PATCH_VISIBILITY, OsdPatchVisibilityBuffer holds a value
+// per patch, zero for the hidden patches (e.g. animated holes), which are
+// culled by OSD_PATCH_CULL.
+//
+
+#ifdef OSD_ENABLE_PATCH_VISIBILITY
+
+uniform usamplerBuffer OsdPatchVisibilityBuffer;
+
+bool OsdIsPatchVisible(int patchIndex)
+{
+    return (texelFetch(OsdPatchVisibilityBuffer, patchIndex).x != 0u);
+}
+
+#define OSD_PATCH_CULL_HIDDEN()                                     \
+    if (! OsdIsPatchVisible(OsdGetPatchIndex(gl_PrimitiveID))) {    \
+        gl_TessLevelInner[0] = 0;                                   \
+        gl_TessLevelInner[1] = 0;                                   \
+        gl_TessLevelOuter[0] = 0;                                   \
+        gl_TessLevelOuter[1] = 0;                                   \
+        gl_TessLevelOuter[2] = 0;                                   \
+        gl_TessLevelOuter[3] = 0;                                   \
+        return;                                                     \
+    }
+
+#else
+#define OSD_PATCH_CULL_HIDDEN()
+#endif
+
 // ----------------------------------------------------------------------------
 // patch culling
 // ----------------------------------------------------------------------------
@@ -252,6 +295,7 @@ vec4 OsdInterpolatePatchCoordTriangle(vec2 localUV, ivec3 patchParam)
     outpt.v.clipFlag = ivec3(clip0) + 2*ivec3(clip1);           \
 
 #define OSD_PATCH_CULL(N)                            \
+    OSD_PATCH_CULL_HIDDEN()                          \
     ivec3 clipFlag = ivec3(0);                       \
     for(int i = 0; i < N; ++i) {                     \
         clipFlag |= inpt[i].v.clipFlag;              \
@@ -268,7 +312,7 @@ vec4 OsdInterpolatePatchCoordTriangle(vec2 localUV, ivec3 patchParam)
 
 #else
 #define OSD_PATCH_CULL_COMPUTE_CLIPFLAGS(P)
-#define OSD_PATCH_CULL(N)
+#define OSD_PATCH_CULL(N) OSD_PATCH_CULL_HIDDEN()
 #endif
 
 // ----------------------------------------------------------------------------
@@ -324,6 +368,115 @@ OsdUnivar4x4(in float u, out float B[4], out float D[4], out float C[4])
     C[3] = A2;
 }
 
+// ----------------------------------------------------------------------------
+// Basis Look-up Table
+// ----------------------------------------------------------------------------
+//
+// With uniform tessellation the domain points of all patches lie on a fixed
+// grid, and when OSD_PATCH_ENABLE_BASIS_LUT is defined the Bezier basis of
+// their coordinates is read from OsdBasisLUTBuffer (see Osd::TessBasisTable)
+// rather than computed.  Coordinates off the grid are computed as usual.
+//
+#if defined OSD_PATCH_ENABLE_BASIS_LUT
+
+uniform samplerBuffer OsdBasisLUTBuffer;
+
+// client provided, the resolution returned by Osd::TessBasisTable::Compute()
+int OsdBasisLUTResolution();
+
+bool
+OsdLookupUnivar4x4(in float u, out vec4 B, out vec4 D, out vec4 C)
+{
+    float r = float(OsdBasisLUTResolution());
+    float k = round(u * r);
+    if (abs(u * r - k) > 0.001f) {
+        return false;
+    }
+    int index = 3 * int(k);
+    B = texelFetch(OsdBasisLUTBuffer, index);
+    D = texelFetch(OsdBasisLUTBuffer, index + 1);
+    C = texelFetch(OsdBasisLUTBuffer, index + 2);
+    return true;
+}
+
+#endif
+
+// Univariate BSpline basis (and its derivatives) across semi-sharp creases
+// at either end of the span -- the span is subdivided with the crease rules
+// until the creases have decayed and the resulting smooth span evaluated
+// (see Osd_evalBSplineCurveCreased() of the shared patch basis).
+void
+OsdUnivarBSplineCreased(in float u, in float sharpness0, in float sharpness1,
+                        out float B[4], out float D[4], out float C[4])
+{
+    float m[16];
+    for (int i = 0; i < 16; ++i) {
+        m[i] = ((i % 5) == 0) ? 1.0f : 0.0f;
+    }
+
+    float t = u;
+    float scale = 1.0f;
+    for (int level = 0; (level < 11) &&
+            ((sharpness0 > 0.0f) || (sharpness1 > 0.0f)); ++level) {
+        float f0 = clamp(sharpness0, 0.0f, 1.0f);
+        float f1 = clamp(sharpness1, 0.0f, 1.0f);
+
+        float c[20];
+        for (int j = 0; j < 4; ++j) {
+            float x0 = m[j], x1 = m[4+j], x2 = m[8+j], x3 = m[12+j];
+
+            c[j]    = 0.5f * (x0 + x1);
+            c[4+j]  = mix(0.125f * (x0 + 6.0f*x1 + x2), x1, f0);
+            c[8+j]  = 0.5f * (x1 + x2);
+            c[12+j] = mix(0.125f * (x1 + 6.0f*x2 + x3), x2, f1);
+            c[16+j] = 0.5f * (x2 + x3);
+        }
+
+        int first = 0;
+        if (t <= 0.5f) {
+            t = 2.0f * t;
+            sharpness0 -= 1.0f;
+            sharpness1 = 0.0f;
+        } else {
+            t = 2.0f * t - 1.0f;
+            sharpness0 = 0.0f;
+            sharpness1 -= 1.0f;
+            first = 4;
+        }
+        for (int i = 0; i < 16; ++i) {
+            m[i] = c[first + i];
+        }
+        scale *= 2.0f;
+    }
+
+    float t2 = t * t;
+    float t3 = t * t2;
+
+    float w[4], dw[4], dw2[4];
+    w[0] = (1.0f - 3.0f*(t - t2) - t3) / 6.0f;
+    w[1] = (4.0f - 6.0f*t2 + 3.0f*t3) / 6.0f;
+    w[2] = (1.0f + 3.0f*(t + t2 - t3)) / 6.0f;
+    w[3] = t3 / 6.0f;
+
+    dw[0] = -0.5f*t2 + t - 0.5f;
+    dw[1] =  1.5f*t2 - 2.0f*t;
+    dw[2] = -1.5f*t2 + t + 0.5f;
+    dw[3] =  0.5f*t2;
+
+    dw2[0] = 1.0f - t;
+    dw2[1] = 3.0f*t - 2.0f;
+    dw2[2] = 1.0f - 3.0f*t;
+    dw2[3] = t;
+
+    for (int j = 0; j < 4; ++j) {
+        B[j] = w[0]*m[j] + w[1]*m[4+j] + w[2]*m[8+j] + w[3]*m[12+j];
+        D[j] = scale * (dw[0]*m[j] + dw[1]*m[4+j] +
+                        dw[2]*m[8+j] + dw[3]*m[12+j]);
+        C[j] = scale * scale * (dw2[0]*m[j] + dw2[1]*m[4+j] +
+                                dw2[2]*m[8+j] + dw2[3]*m[12+j]);
+    }
+}
+
 // ----------------------------------------------------------------------------
 
 struct OsdPerPatchVertexBezier {
@@ -361,6 +514,25 @@ OsdEvalBezier(vec3 cp[16], vec2 uv)
     return P;
 }
 
+// Double-crease patches, whose vSegments are negative, keep their BSpline
+// points (see OsdComputePerPatchVertexBSpline()) and are evaluated with the
+// BSpline basis across the creases.
+//
+void
+OsdEvalBSplineDoubleCreaseBasis(ivec3 patchParam, vec2 uv,
+                                out float Bu[4], out float Du[4], out float Cu[4],
+                                out float Bv[4], out float Dv[4], out float Cv[4])
+{
+    vec2 sharpness = OsdGetPatchDoubleCreaseSharpness(patchParam);
+    if ((OsdGetPatchBoundaryMask(patchParam) & 1) != 0) {
+        OsdUnivarBSplineCreased(uv.x, 0.0f, 0.0f, Bu, Du, Cu);
+        OsdUnivarBSplineCreased(uv.y, sharpness.x, sharpness.y, Bv, Dv, Cv);
+    } else {
+        OsdUnivarBSplineCreased(uv.x, sharpness.x, sharpness.y, Bu, Du, Cu);
+        OsdUnivarBSplineCreased(uv.y, 0.0f, 0.0f, Bv, Dv, Cv);
+    }
+}
+
 // When OSD_PATCH_ENABLE_SINGLE_CREASE is defined,
 // this function evaluates single-crease patch, which is segmented into
 // 3 parts in the v-direction.
@@ -379,6 +551,21 @@ OsdEvalBezier(OsdPerPatchVertexBezier cp[16], ivec3 patchParam, vec2 uv)
     float B[4], D[4];
     float s = OsdGetPatchSingleCreaseSegmentParameter(patchParam, uv);
 
+#if defined OSD_PATCH_ENABLE_SINGLE_CREASE
+    if (cp[0].vSegments.x < 0) {
+        float Bu[4], Du[4], Cu[4], Bv[4], Dv[4], Cv[4];
+        OsdEvalBSplineDoubleCreaseBasis(patchParam, uv, Bu, Du, Cu, Bv, Dv, Cv);
+
+        vec3 P = vec3(0);
+        for (int i=0; i<4; ++i) {
+            for (int j=0; j<4; ++j) {
+                P += (Bv[i] * Bu[j]) * cp[4*i + j].P;
+            }
+        }
+        return P;
+    }
+#endif
+
     OsdUnivar4x4(uv.x, B, D);
 #if defined OSD_PATCH_ENABLE_SINGLE_CREASE
     vec2 vSegments = cp[0].vSegments;
@@ -597,9 +784,59 @@ uniform mat4 Mi = mat4(
     0.f,     0.f,     1.f,     0.f
 );
 
+#if defined OSD_PATCH_ENABLE_SINGLE_CREASE
+
+// With OSD_PATCH_ENABLE_SINGLE_CREASE_MATRICES, the sharpness-dependent
+// matrices of the single-crease patches are read from
+// OsdSingleCreaseMatricesBuffer, 9 texels per patch pre-computed by the
+// patch table (see Osd::SingleCreaseMatrices), rather than computed for each
+// control point.
+#if defined OSD_PATCH_ENABLE_SINGLE_CREASE_MATRICES
+uniform samplerBuffer OsdSingleCreaseMatricesBuffer;
+#endif
+
+void
+OsdGetSingleCreaseMatrices(int patchIndex, float sharpness,
+                           out vec2 vSegments, out mat4 Mj, out mat4 Ms)
+{
+#if defined OSD_PATCH_ENABLE_SINGLE_CREASE_MATRICES
+    if (patchIndex >= 0) {
+        int base = patchIndex * 9;
+        vSegments = texelFetch(OsdSingleCreaseMatricesBuffer, base).xy;
+        Mj = mat4(texelFetch(OsdSingleCreaseMatricesBuffer, base + 1),
+                  texelFetch(OsdSingleCreaseMatricesBuffer, base + 2),
+                  texelFetch(OsdSingleCreaseMatricesBuffer, base + 3),
+                  texelFetch(OsdSingleCreaseMatricesBuffer, base + 4));
+        Ms = mat4(texelFetch(OsdSingleCreaseMatricesBuffer, base + 5),
+                  texelFetch(OsdSingleCreaseMatricesBuffer, base + 6),
+                  texelFetch(OsdSingleCreaseMatricesBuffer, base + 7),
+                  texelFetch(OsdSingleCreaseMatricesBuffer, base + 8));
+        return;
+    }
+#endif
+    float Sf = floor(sharpness);
+    float Sc = ceil(sharpness);
+    float Sr = fract(sharpness);
+    mat4 Mf = OsdComputeMs(Sf);
+    mat4 Mc = OsdComputeMs(Sc);
+    Mj = (1-Sr) * Mf + Sr * Mi;
+    Ms = (1-Sr) * Mf + Sr * Mc;
+    float s0 = 1 - pow(2, -floor(sharpness));
+    float s1 = 1 - pow(2, -ceil(sharpness));
+    vSegments = vec2(s0, s1);
+}
+
+#endif
+
 // convert BSpline cv to Bezier cv
+//
+// The patchIndex locates the pre-computed matrices of single-crease patches
+// with OSD_PATCH_ENABLE_SINGLE_CREASE_MATRICES (a negative index computes
+// them instead).
+//
 void
-OsdComputePerPatchVertexBSpline(ivec3 patchParam, int ID, vec3 cv[16],
+OsdComputePerPatchVertexBSpline(ivec3 patchParam, int patchIndex, int ID,
+                                vec3 cv[16],
                                 out OsdPerPatchVertexBezier result)
 {
     result.patchParam = patchParam;
@@ -615,16 +852,10 @@ OsdComputePerPatchVertexBSpline(ivec3 patchParam, int ID, vec3 cv[16],
 
     float sharpness = OsdGetPatchSharpness(patchParam);
     if (sharpness > 0) {
-        float Sf = floor(sharpness);
-        float Sc = ceil(sharpness);
-        float Sr = fract(sharpness);
-        mat4 Mf = OsdComputeMs(Sf);
-        mat4 Mc = OsdComputeMs(Sc);
-        mat4 Mj = (1-Sr) * Mf + Sr * Mi;
-        mat4 Ms = (1-Sr) * Mf + Sr * Mc;
-        float s0 = 1 - pow(2, -floor(sharpness));
-        float s1 = 1 - pow(2, -ceil(sharpness));
-        result.vSegments = vec2(s0, s1);
+        vec2 vSegments;
+        mat4 Mj, Ms;
+        OsdGetSingleCreaseMatrices(patchIndex, sharpness, vSegments, Mj, Ms);
+        result.vSegments = vSegments;
 
         mat4 MUi = Q, MUj = Q, MUs = Q;
         mat4 MVi = Q, MVj = Q, MVs = Q;
@@ -669,6 +900,13 @@ OsdComputePerPatchVertexBSpline(ivec3 patchParam, int ID, vec3 cv[16],
         result.P  = P;
         result.P1 = P1;
         result.P2 = P2;
+    } else if (sharpness < 0) {
+        // double-crease patches keep their BSpline points
+        result.vSegments = vec2(-1);
+
+        result.P  = cv[ID];
+        result.P1 = cv[ID];
+        result.P2 = cv[ID];
     } else {
         result.vSegments = vec2(0);
 
@@ -708,12 +946,175 @@ OsdComputePerPatchVertexBSpline(ivec3 patchParam, int ID, vec3 cv[16],
 #endif
 }
 
+void
+OsdComputePerPatchVertexBSpline(ivec3 patchParam, int ID, vec3 cv[16],
+                                out OsdPerPatchVertexBezier result)
+{
+    OsdComputePerPatchVertexBSpline(patchParam, -1, ID, cv, result);
+}
+
+#if defined OSD_PATCH_ENABLE_SINGLE_CREASE
+void
+OsdEvalPatchBSplineDoubleCrease(ivec3 patchParam, vec2 UV,
+                   OsdPerPatchVertexBezier cv[16],
+                   out vec3 P, out vec3 dPu, out vec3 dPv,
+                   out vec3 N, out vec3 dNu, out vec3 dNv)
+{
+    float Bu[4], Du[4], Cu[4], Bv[4], Dv[4], Cv[4];
+    OsdEvalBSplineDoubleCreaseBasis(patchParam, UV, Bu, Du, Cu, Bv, Dv, Cv);
+
+    P = vec3(0);
+    dPu = vec3(0);
+    dPv = vec3(0);
+
+    vec3 dUU = vec3(0);
+    vec3 dVV = vec3(0);
+    vec3 dUV = vec3(0);
+
+    for (int i=0; i<4; ++i) {
+        for (int j=0; j<4; ++j) {
+            vec3 CV = cv[4*i + j].P;
+            P   += (Bv[i] * Bu[j]) * CV;
+            dPu += (Bv[i] * Du[j]) * CV;
+            dPv += (Dv[i] * Bu[j]) * CV;
+            dUU += (Bv[i] * Cu[j]) * CV;
+            dVV += (Cv[i] * Bu[j]) * CV;
+            dUV += (Dv[i] * Du[j]) * CV;
+        }
+    }
+
+    float level = float(OsdGetPatchFaceLevel(patchParam));
+    dPu *= level;
+    dPv *= level;
+
+    N = cross(dPu, dPv);
+    float nLength = length(N);
+    if (nLength > 0) {
+        N = N / nLength;
+    }
+
+#ifndef OSD_COMPUTE_NORMAL_DERIVATIVES
+    dNu = vec3(0);
+    dNv = vec3(0);
+#else
+    dUU *= level * level;
+    dVV *= level * level;
+    dUV *= level * level;
+
+    dNu = cross(dUU, dPv) + cross(dPu, dUV);
+    dNv = cross(dUV, dPv) + cross(dPu, dVV);
+
+    float nLengthInv = (nLength > 0) ? (1.0f / nLength) : 1.0f;
+
+    //  Project derivatives of non-unit normals into tangent plane of N:
+    dNu = (dNu - dot(dNu,N) * N) * nLengthInv;
+    dNv = (dNv - dot(dNv,N) * N) * nLengthInv;
+#endif
+}
+#endif
+
+#if defined OSD_PATCH_ENABLE_BASIS_LUT && !defined OSD_PATCH_ENABLE_SINGLE_CREASE
+//
+//  Tensor product evaluation with the basis of the look-up table, returning
+//  false when UV is off its grid or the normal is degenerate, to be resolved
+//  by OsdEvalPatchBezier():
+//
+bool
+OsdEvalPatchBezierBasisLUT(ivec3 patchParam, vec2 UV,
+                           OsdPerPatchVertexBezier cv[16],
+                           out vec3 P, out vec3 dPu, out vec3 dPv,
+                           out vec3 N, out vec3 dNu, out vec3 dNv)
+{
+    vec4 Bu, Du, Cu, Bv, Dv, Cv;
+    if (!OsdLookupUnivar4x4(UV.x, Bu, Du, Cu) ||
+        !OsdLookupUnivar4x4(UV.y, Bv, Dv, Cv)) {
+        return false;
+    }
+
+    P = vec3(0);
+    dPu = vec3(0);
+    dPv = vec3(0);
+#ifdef OSD_COMPUTE_NORMAL_DERIVATIVES
+    vec3 dUU = vec3(0);
+    vec3 dVV = vec3(0);
+    vec3 dUV = vec3(0);
+#endif
+
+    for (int i=0; i<4; ++i) {
+        vec3 rowB = vec3(0);
+        vec3 rowD = vec3(0);
+#ifdef OSD_COMPUTE_NORMAL_DERIVATIVES
+        vec3 rowC = vec3(0);
+#endif
+        for (int j=0; j<4; ++j) {
+            vec3 CV = cv[4*i + j].P;
+            rowB += Bu[j] * CV;
+            rowD += Du[j] * CV;
+#ifdef OSD_COMPUTE_NORMAL_DERIVATIVES
+            rowC += Cu[j] * CV;
+#endif
+        }
+        P   += Bv[i] * rowB;
+        dPu += Bv[i] * rowD;
+        dPv += Dv[i] * rowB;
+#ifdef OSD_COMPUTE_NORMAL_DERIVATIVES
+        dUU += Bv[i] * rowC;
+        dVV += Cv[i] * rowB;
+        dUV += Dv[i] * rowD;
+#endif
+    }
+
+    int level = OsdGetPatchFaceLevel(patchParam);
+    dPu *= 3 * level;
+    dPv *= 3 * level;
+
+    float nEpsilon = (length(dPu) + length(dPv)) * 0.00001f;
+
+    N = cross(dPu, dPv);
+
+    float nLength = length(N);
+    if (nLength <= nEpsilon) {
+        return false;
+    }
+    N = N / nLength;
+
+#ifndef OSD_COMPUTE_NORMAL_DERIVATIVES
+    dNu = vec3(0);
+    dNv = vec3(0);
+#else
+    dUU *= 6 * level;
+    dVV *= 6 * level;
+    dUV *= 9 * level;
+
+    dNu = cross(dUU, dPv) + cross(dPu, dUV);
+    dNv = cross(dUV, dPv) + cross(dPu, dVV);
+
+    dNu = (dNu - dot(dNu,N) * N) / nLength;
+    dNv = (dNv - dot(dNv,N) * N) / nLength;
+#endif
+    return true;
+}
+#endif
+
 void
 OsdEvalPatchBezier(ivec3 patchParam, vec2 UV,
                    OsdPerPatchVertexBezier cv[16],
                    out vec3 P, out vec3 dPu, out vec3 dPv,
                    out vec3 N, out vec3 dNu, out vec3 dNv)
 {
+#if defined OSD_PATCH_ENABLE_SINGLE_CREASE
+    if (cv[0].vSegments.x < 0) {
+        OsdEvalPatchBSplineDoubleCrease(patchParam, UV, cv,
+                                        P, dPu, dPv, N, dNu, dNv);
+        return;
+    }
+#elif defined OSD_PATCH_ENABLE_BASIS_LUT
+    if (OsdEvalPatchBezierBasisLUT(patchParam, UV, cv,
+                                   P, dPu, dPv, N, dNu, dNv)) {
+        return;
+    }
+#endif
+
     //
     //  Use the recursive nature of the basis functions to compute a 2x2 set
     //  of intermediate points (via repeated linear interpolation).  These
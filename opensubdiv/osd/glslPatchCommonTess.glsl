@@ -26,6 +26,13 @@
 // Tessellation
 // ----------------------------------------------------------------------------
 
+// Tessellation levels read from OsdTessLevelBuffer are screen space levels
+#if defined OSD_ENABLE_TESS_LEVEL_BUFFER
+#ifndef OSD_ENABLE_SCREENSPACE_TESSELLATION
+#define OSD_ENABLE_SCREENSPACE_TESSELLATION
+#endif
+#endif
+
 // For now, fractional spacing is supported only with screen space tessellation
 #ifndef OSD_ENABLE_SCREENSPACE_TESSELLATION
 #undef OSD_FRACTIONAL_EVEN_SPACING
@@ -550,6 +557,59 @@ OsdEvalPatchBezierTriangleTessLevels(vec3 cv[15],
                                  tessLevelOuter, tessLevelInner);
 }
 
+//
+// With OSD_ENABLE_TESS_LEVEL_BUFFER, the screen-space levels of the edge
+// segments are computed once by a compute pass (see GLTessLevelComputer)
+// into OsdTessLevelBuffer, and OsdPatchEdgeBuffer holds the segments of the
+// 4 Lo and 4 Hi edge segments of each patch (-1 for no segment).
+//
+
+#if defined OSD_ENABLE_TESS_LEVEL_BUFFER
+
+uniform samplerBuffer OsdTessLevelBuffer;
+uniform isamplerBuffer OsdPatchEdgeBuffer;
+
+float
+Osd_GetSegmentTessLevel(int patchIndex, int segment)
+{
+    int index = texelFetch(OsdPatchEdgeBuffer, patchIndex * 8 + segment).x;
+    return (index >= 0) ? texelFetch(OsdTessLevelBuffer, index).x : 0.0;
+}
+
+void
+OsdGetTessLevelsFromBuffer(int patchIndex,
+                 out vec4 tessOuterLo, out vec4 tessOuterHi)
+{
+    for (int i = 0; i < 4; ++i) {
+        tessOuterLo[i] = Osd_GetSegmentTessLevel(patchIndex, i);
+        tessOuterHi[i] = Osd_GetSegmentTessLevel(patchIndex, i + 4);
+    }
+}
+
+void
+OsdGetTessLevelsFromBuffer(int patchIndex,
+                 out vec4 tessLevelOuter, out vec2 tessLevelInner,
+                 out vec4 tessOuterLo, out vec4 tessOuterHi)
+{
+    OsdGetTessLevelsFromBuffer(patchIndex, tessOuterLo, tessOuterHi);
+
+    OsdComputeTessLevels(tessOuterLo, tessOuterHi,
+                         tessLevelOuter, tessLevelInner);
+}
+
+void
+OsdGetTessLevelsFromBufferTriangle(int patchIndex,
+                 out vec4 tessLevelOuter, out vec2 tessLevelInner,
+                 out vec4 tessOuterLo, out vec4 tessOuterHi)
+{
+    OsdGetTessLevelsFromBuffer(patchIndex, tessOuterLo, tessOuterHi);
+
+    OsdComputeTessLevelsTriangle(tessOuterLo, tessOuterHi,
+                                 tessLevelOuter, tessLevelInner);
+}
+
+#endif
+
 void
 OsdGetTessLevelsAdaptiveRefinedPoints(vec3 cpRefined[16], ivec3 patchParam,
                         out vec4 tessLevelOuter, out vec2 tessLevelInner,
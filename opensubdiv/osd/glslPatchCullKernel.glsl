@@ -0,0 +1,113 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+//------------------------------------------------------------------------------
+
+//
+// Each invocation tests a patch of a patch array, appending the visible
+// patches to the culled index and patch param buffers of the array and
+// counting their control vertices in the draw command of the array.
+//
+
+layout(local_size_x=WORK_GROUP_SIZE, local_size_y=1, local_size_z=1) in;
+layout(std430) buffer;
+
+uniform int vertexOffset = 0;
+uniform int vertexStride = 3;
+
+uniform int numPatches = 0;
+uniform int patchStride = 0;
+uniform int indexBase = 0;
+uniform int primitiveIdBase = 0;
+uniform int drawCommand = 0;
+uniform int cullHull = 0;
+uniform int useVisibility = 0;
+uniform mat4 modelViewProjectionMatrix;
+
+layout(binding=0) buffer vertex_buffer      { float vertexBuffer[]; };
+layout(binding=1) buffer index_buffer       { int   patchIndexBuffer[]; };
+layout(binding=2) buffer param_buffer       { int   patchParamBuffer[]; };
+layout(binding=3) buffer visibility_buffer  { uint  visibilityBuffer[]; };
+layout(binding=4) buffer culled_index       { int   culledIndexBuffer[]; };
+layout(binding=5) buffer culled_param       { int   culledParamBuffer[]; };
+layout(binding=6) buffer culled_patch       { int   culledPatchBuffer[]; };
+layout(binding=7) buffer draw_commands      { uint  drawCommandBuffer[]; };
+
+vec4 readPosition(int vertex) {
+    int index = vertexOffset + vertex * vertexStride;
+    return vec4(vertexBuffer[index],
+                vertexBuffer[index + 1],
+                vertexBuffer[index + 2], 1.0);
+}
+
+// one byte per patch, zero for hidden patches
+bool isPatchVisible(int patchIndex) {
+    uint word = visibilityBuffer[patchIndex >> 2];
+    return ((word >> (8 * (patchIndex & 3))) & 0xffu) != 0u;
+}
+
+// the patch is outside the frustum when all its control vertices are on the
+// outer side of one of the clip planes (see OSD_PATCH_CULL)
+bool isHullOutside(int firstIndex) {
+    ivec3 clipFlag = ivec3(0);
+    for (int i = 0; i < patchStride; ++i) {
+        vec4 clipPos = modelViewProjectionMatrix *
+            readPosition(patchIndexBuffer[firstIndex + i]);
+        bvec3 clip0 = lessThan(clipPos.xyz, vec3(clipPos.w));
+        bvec3 clip1 = greaterThan(clipPos.xyz, -vec3(clipPos.w));
+        clipFlag |= ivec3(clip0) + 2*ivec3(clip1);
+    }
+    return clipFlag != ivec3(3);
+}
+
+void main() {
+
+    int current = int(gl_GlobalInvocationID.x);
+    if (current >= numPatches) return;
+
+    int patchIndex = primitiveIdBase + current;
+    int firstIndex = indexBase + current * patchStride;
+
+    if (useVisibility != 0 && !isPatchVisible(patchIndex)) return;
+
+    if (cullHull != 0 && isHullOutside(firstIndex)) return;
+
+    uint count = atomicAdd(drawCommandBuffer[drawCommand * 5],
+                           uint(patchStride));
+    int slot = int(count) / patchStride;
+
+    int dstIndex = indexBase + slot * patchStride;
+    for (int i = 0; i < patchStride; ++i) {
+        culledIndexBuffer[dstIndex + i] = patchIndexBuffer[firstIndex + i];
+    }
+
+    int dstPatch = primitiveIdBase + slot;
+    for (int i = 0; i < 3; ++i) {
+        culledParamBuffer[dstPatch * 3 + i] = patchParamBuffer[patchIndex * 3 + i];
+    }
+    culledPatchBuffer[dstPatch] = patchIndex;
+}
+
+//------------------------------------------------------------------------------
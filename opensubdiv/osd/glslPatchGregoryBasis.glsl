@@ -79,7 +79,12 @@ void main()
 
         OSD_PATCH_CULL(20);
 
-#if defined OSD_ENABLE_SCREENSPACE_TESSELLATION
+#if defined OSD_ENABLE_TESS_LEVEL_BUFFER
+        OsdGetTessLevelsFromBuffer(
+                OsdGetPatchIndex(gl_PrimitiveID),
+                tessLevelOuter, tessLevelInner,
+                tessOuterLo, tessOuterHi);
+#elif defined OSD_ENABLE_SCREENSPACE_TESSELLATION
         // Gather bezier control points to compute limit surface tess levels
         OsdPerPatchVertexBezier bezcv[16];
         bezcv[ 0].P = inpt[ 0].v.position.xyz;
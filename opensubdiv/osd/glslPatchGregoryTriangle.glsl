@@ -79,7 +79,12 @@ void main()
 
         OSD_PATCH_CULL(18);
 
-#if defined OSD_ENABLE_SCREENSPACE_TESSELLATION
+#if defined OSD_ENABLE_TESS_LEVEL_BUFFER
+        OsdGetTessLevelsFromBufferTriangle(
+                OsdGetPatchIndex(gl_PrimitiveID),
+                tessLevelOuter, tessLevelInner,
+                tessOuterLo, tessOuterHi);
+#elif defined OSD_ENABLE_SCREENSPACE_TESSELLATION
         // Gather bezier control points to compute limit surface tess levels
         vec3 cv[15];
         cv[ 0] = inpt[ 0].v.position.xyz;
@@ -0,0 +1,159 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+//------------------------------------------------------------------------------
+
+//
+// Lookup of the patches of (u,v) locations of patch (Ptex) faces in the
+// quadtree of a GLPatchMap -- the traversal of Far::PatchMap::FindPatch().
+//
+// The packed quadtree holds four words per node, one per quadrant: the index
+// of the child node or patch handle in the upper 30 bits, and the isLeaf and
+// isSet flags of the child in bits 1 and 0. The handles are three ints each
+// (arrayIndex, patchIndex, vertIndex).
+//
+
+#ifndef OSD_PATCH_MAP_QUADTREE_BINDING
+#define OSD_PATCH_MAP_QUADTREE_BINDING 14
+#endif
+#ifndef OSD_PATCH_MAP_HANDLES_BINDING
+#define OSD_PATCH_MAP_HANDLES_BINDING 15
+#endif
+
+layout(std430, binding=OSD_PATCH_MAP_QUADTREE_BINDING)
+    readonly buffer OsdPatchMapQuadtree_buffer { uint OsdPatchMapQuadtree[]; };
+layout(std430, binding=OSD_PATCH_MAP_HANDLES_BINDING)
+    readonly buffer OsdPatchMapHandles_buffer { int OsdPatchMapHandles[]; };
+
+// minimum and maximum patch face, maximum depth and triangular patches
+uniform ivec4 OsdPatchMapParams;
+
+// Returns the handle (arrayIndex, patchIndex, vertIndex) of the patch of the
+// location, or ivec3(-1) for the faces not supported by the map and holes
+ivec3 OsdPatchMapFindPatch(int faceId, float u, float v)
+{
+    if ((faceId < OsdPatchMapParams.x) || (faceId > OsdPatchMapParams.y)) {
+        return ivec3(-1);
+    }
+
+    int node = faceId - OsdPatchMapParams.x;
+    if ((OsdPatchMapQuadtree[node * 4] & 1u) == 0u) {
+        return ivec3(-1);
+    }
+
+    bool triangular = (OsdPatchMapParams.w != 0);
+    bool rotated = false;
+    float median = 0.5;
+
+    for (int depth = 0; depth <= OsdPatchMapParams.z; ++depth) {
+        int quadrant = 0;
+        if (!triangular) {
+            if (u >= median) { u -= median; quadrant |= 1; }
+            if (v >= median) { v -= median; quadrant |= 2; }
+        } else if (!rotated) {
+            if (u >= median) {
+                u -= median;
+                quadrant = 1;
+            } else if (v >= median) {
+                v -= median;
+                quadrant = 2;
+            } else if ((u + v) >= median) {
+                rotated = true;
+                quadrant = 3;
+            }
+        } else {
+            if (u < median) {
+                v -= median;
+                quadrant = 1;
+            } else if (v < median) {
+                u -= median;
+                quadrant = 2;
+            } else {
+                u -= median;
+                v -= median;
+                if ((u + v) < median) {
+                    rotated = false;
+                    quadrant = 3;
+                }
+            }
+        }
+
+        uint child = OsdPatchMapQuadtree[node * 4 + quadrant];
+        if ((child & 2u) != 0u) {
+            int handle = int(child >> 2) * 3;
+            return ivec3(OsdPatchMapHandles[handle],
+                         OsdPatchMapHandles[handle + 1],
+                         OsdPatchMapHandles[handle + 2]);
+        }
+        node = int(child >> 2);
+        median *= 0.5;
+    }
+    return ivec3(-1);
+}
+
+//------------------------------------------------------------------------------
+
+#if defined(OSD_PATCH_MAP_FIND_PATCHES_KERNEL)
+
+//
+// Each invocation writes the PatchCoord of a location
+//
+
+layout(local_size_x=WORK_GROUP_SIZE, local_size_y=1, local_size_z=1) in;
+
+// Osd reflection of Osd::PatchCoord
+struct PatchCoord {
+    int arrayIndex;
+    int patchIndex;
+    int vertIndex;
+    float s;
+    float t;
+};
+
+uniform int numLocations = 0;
+
+layout(std430, binding=0) buffer faceId_buffer { int patchFaceIds[]; };
+layout(std430, binding=1) buffer uv_buffer { float uvBuffer[]; };
+layout(std430, binding=2) buffer patchCoord_buffer { PatchCoord patchCoords[]; };
+
+void main() {
+
+    int current = int(gl_GlobalInvocationID.x);
+    if (current >= numLocations) return;
+
+    float u = uvBuffer[current * 2];
+    float v = uvBuffer[current * 2 + 1];
+    ivec3 handle = OsdPatchMapFindPatch(patchFaceIds[current], u, v);
+
+    PatchCoord coord;
+    coord.arrayIndex = handle.x;
+    coord.patchIndex = handle.y;
+    coord.vertIndex = handle.z;
+    coord.s = u;
+    coord.t = v;
+    patchCoords[current] = coord;
+}
+
+#endif
@@ -0,0 +1,102 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+//------------------------------------------------------------------------------
+
+//
+// Each invocation computes the screen-space tessellation level of an edge
+// segment, from the limit positions at the ends of the segment on the patch
+// assigned to the segment.
+//
+
+layout(local_size_x=WORK_GROUP_SIZE, local_size_y=1, local_size_z=1) in;
+layout(std430) buffer;
+
+uniform int vertexOffset = 0;
+uniform int vertexStride = 3;
+uniform int numSegments = 0;
+uniform mat4 modelViewMatrix;
+uniform mat4 projectionMatrix;
+uniform float tessLevel = 1.0;
+
+struct Segment {
+    ivec4 patch;        // patch index, patch type, index base
+    vec4 endPoints;     // (u,v) of both ends in the patch domain
+};
+
+layout(binding=0) buffer vertex_buffer      { float vertexBuffer[]; };
+layout(binding=1) buffer segment_buffer     { Segment segments[]; };
+layout(binding=2) buffer patchIndex_buffer  { int patchIndexBuffer[]; };
+layout(binding=3) buffer patchParam_buffer  { OsdPatchParam patchParamBuffer[]; };
+layout(binding=4) buffer tessLevel_buffer   { float tessLevelBuffer[]; };
+
+vec3 readPosition(int vertex) {
+    int index = vertexOffset + vertex * vertexStride;
+    return vec3(vertexBuffer[index],
+                vertexBuffer[index + 1],
+                vertexBuffer[index + 2]);
+}
+
+vec3 evalLimit(Segment segment, OsdPatchParam param, float u, float v) {
+    float wP[20], wDu[20], wDv[20], wDuu[20], wDuv[20], wDvv[20];
+    int nPoints = OsdEvaluatePatchBasisNormalized(segment.patch.y, param,
+        u, v, wP, wDu, wDv, wDuu, wDuv, wDvv);
+
+    vec3 position = vec3(0);
+    for (int cv = 0; cv < nPoints; ++cv) {
+        int index = patchIndexBuffer[segment.patch.z + cv];
+        position += wP[cv] * readPosition(index);
+    }
+    return position;
+}
+
+// same as OsdComputeTessLevel() of glslPatchCommonTess.glsl
+float computeTessLevel(vec3 p0, vec3 p1) {
+    p0 = (modelViewMatrix * vec4(p0, 1.0)).xyz;
+    p1 = (modelViewMatrix * vec4(p1, 1.0)).xyz;
+    vec3 center = (p0 + p1) / 2.0;
+    float diameter = distance(p0, p1);
+    vec4 p = projectionMatrix * vec4(center, 1.0);
+    float projLength = abs(diameter * projectionMatrix[1][1] / p.w);
+    float level = max(1.0, tessLevel * projLength);
+    return min(level, gl_MaxTessGenLevel / 2);
+}
+
+void main() {
+
+    int current = int(gl_GlobalInvocationID.x);
+    if (current >= numSegments) return;
+
+    Segment segment = segments[current];
+    OsdPatchParam param = patchParamBuffer[segment.patch.x];
+
+    vec3 p0 = evalLimit(segment, param,
+                        segment.endPoints.x, segment.endPoints.y);
+    vec3 p1 = evalLimit(segment, param,
+                        segment.endPoints.z, segment.endPoints.w);
+
+    tessLevelBuffer[current] = computeTessLevel(p0, p1);
+}
+
+//------------------------------------------------------------------------------
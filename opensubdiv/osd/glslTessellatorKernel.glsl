@@ -0,0 +1,494 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+//------------------------------------------------------------------------------
+
+//
+// Each work group tessellates a patch of a patch array: its first invocation
+// computes the rates of the edges of the patch and allocates its vertices,
+// triangles and cluster in the output buffers, then the vertices of the
+// tessellation pattern of CpuTessellator are evaluated and its triangles
+// written by all the invocations of the group.
+//
+// The edges of transition patches have the rates of their two halves, which
+// are each shared with a patch of the next level (see GLTessLevelComputer).
+// The vertices of such edges are spaced uniformly along each half.
+//
+
+layout(local_size_x=WORK_GROUP_SIZE, local_size_y=1, local_size_z=1) in;
+layout(std430) buffer;
+
+uniform int vertexOffset = 0;
+uniform int vertexStride = 3;
+
+uniform int numPatches = 0;
+uniform int patchStride = 0;
+uniform int indexBase = 0;
+uniform int primitiveIdBase = 0;
+uniform int patchType = 0;
+uniform int regularPatchType = 0;
+uniform int triangular = 0;
+
+uniform int useTessLevelBuffer = 0;
+uniform float tessLevel = 1.0;
+
+uniform uint maxVertices = 0u;
+uniform uint maxIndices = 0u;
+
+uniform samplerBuffer OsdTessLevelBuffer;
+uniform isamplerBuffer OsdPatchEdgeBuffer;
+
+layout(binding=0) buffer vertex_buffer      { float vertexBuffer[]; };
+layout(binding=1) buffer index_buffer       { int   patchIndexBuffer[]; };
+layout(binding=2) buffer param_buffer       { OsdPatchParam patchParamBuffer[]; };
+layout(binding=3) buffer tess_vertex_buffer { float tessVertexBuffer[]; };
+layout(binding=4) buffer tess_index_buffer  { uint  tessIndexBuffer[]; };
+layout(binding=5) buffer cluster_buffer     { uint  clusterBuffer[]; };
+layout(binding=6) buffer draw_command       { uint  drawCommandBuffer[]; };
+
+// the layouts of the draw command and cluster buffers (see
+// GLComputeTessellator)
+#define COMMAND_INDEX_COUNT     0
+#define COMMAND_VERTEX_COUNT    5
+#define COMMAND_CLUSTER_COUNT   6
+#define COMMAND_OVERFLOW        7
+
+#define CLUSTER_SIZE            8
+
+shared int sRates[8];       // rates of the first and second half of each
+                            // edge (0 for the second half of regular edges)
+shared int sNu;             // segments of the interior grid (quads), or of
+shared int sNv;             // its sides (triangles, sNu only)
+shared int sNumVertices;
+shared int sNumTriangles;
+shared uint sVertexBase;
+shared uint sFirstIndex;
+shared bool sAllocated;
+
+vec3 readPosition(int vertex) {
+    int index = vertexOffset + vertex * vertexStride;
+    return vec3(vertexBuffer[index],
+                vertexBuffer[index + 1],
+                vertexBuffer[index + 2]);
+}
+
+int getNumEdges() {
+    return (triangular != 0) ? 3 : 4;
+}
+
+int getEdgeRate(int edge) {
+    return sRates[2 * edge] + sRates[2 * edge + 1];
+}
+
+int getEdgeStart(int edge) {
+    int start = 0;
+    for (int e = 0; e < edge; ++e) {
+        start += getEdgeRate(e);
+    }
+    return start;
+}
+
+bool isUntessellated() {
+    for (int e = 0; e < getNumEdges(); ++e) {
+        if (getEdgeRate(e) != 1) return false;
+    }
+    return true;
+}
+
+// the location of vertex k of an edge as a fraction of the edge
+ivec2 getEdgeFraction(int edge, int k) {
+    int r0 = sRates[2 * edge];
+    int r1 = sRates[2 * edge + 1];
+    if (r1 == 0) return ivec2(k, r0);
+    if (k < r0) return ivec2(k, 2 * r0);
+    return ivec2(k - r0 + r1, 2 * r1);
+}
+
+// ----------------------------------------------------------------------------
+// edge rates
+
+int getRate(float level) {
+    return clamp(int(ceil(level)), 1, MAX_EDGE_RATE);
+}
+
+float getSegmentLevel(int patchIndex, int segment) {
+    int index = texelFetch(OsdPatchEdgeBuffer, patchIndex * 8 + segment).x;
+    return (index >= 0) ? texelFetch(OsdTessLevelBuffer, index).x : 0.0;
+}
+
+// Edge e of the pattern runs from corner e to corner e+1, while the edges of
+// the tess level buffer run from their Lo to their Hi corners in the order of
+// the tessOuterLo levels (see glslPatchCommonTess.glsl).
+void computeEdgeRates(int patchIndex, OsdPatchParam param) {
+
+    int transitionMask = OsdPatchParamGetTransition(param);
+
+    // uniform rates are halved at each refinement level, as for
+    // OsdGetTessLevelsUniform()
+    float level = tessLevel /
+        pow(2.0, float(OsdPatchParamGetDepth(param) - 1));
+
+    int numEdges = getNumEdges();
+    for (int e = 0; e < numEdges; ++e) {
+        int tessEdge = (e + 1) % numEdges;
+        bool reversed = (triangular != 0) ? (e >= 1) : (e >= 2);
+
+        if (useTessLevelBuffer != 0) {
+            float lo = getSegmentLevel(patchIndex, tessEdge);
+            float hi = getSegmentLevel(patchIndex, 4 + tessEdge);
+            if (hi == 0.0) {
+                sRates[2 * e] = getRate(lo);
+                sRates[2 * e + 1] = 0;
+            } else {
+                sRates[2 * e] = getRate(reversed ? hi : lo);
+                sRates[2 * e + 1] = getRate(reversed ? lo : hi);
+            }
+        } else {
+            int transitionBit = (triangular != 0)
+                ? (1 << ((tessEdge + 2) % 3))
+                : (1 << ((tessEdge + 3) % 4));
+            if ((transitionMask & transitionBit) != 0) {
+                sRates[2 * e] = getRate(level * 0.5);
+                sRates[2 * e + 1] = getRate(level * 0.5);
+            } else {
+                sRates[2 * e] = getRate(level);
+                sRates[2 * e + 1] = 0;
+            }
+        }
+    }
+    for (int e = numEdges; e < 4; ++e) {
+        sRates[2 * e] = sRates[2 * e + 1] = 0;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// allocation of the outputs
+
+bool allocate(int counter, uint count, uint capacity, out uint base) {
+    uint current = drawCommandBuffer[counter];
+    for (;;) {
+        if (current + count > capacity) return false;
+        uint previous = atomicCompSwap(drawCommandBuffer[counter],
+                                       current, current + count);
+        if (previous == current) break;
+        current = previous;
+    }
+    base = current;
+    return true;
+}
+
+void allocatePatch(int patchIndex) {
+
+    int numEdges = getNumEdges();
+    int numBoundary = getEdgeStart(numEdges);
+
+    if (isUntessellated()) {
+        sNu = sNv = 0;
+        sNumVertices = numEdges;
+        sNumTriangles = numEdges - 2;
+    } else if (triangular != 0) {
+        int n = max(3, max(getEdgeRate(0), max(getEdgeRate(1),
+                                               getEdgeRate(2))));
+        sNu = sNv = n;
+        sNumVertices = numBoundary + (n - 2) * (n - 1) / 2;
+        sNumTriangles = numBoundary + (n - 3) * (n - 3) + 3 * (n - 3);
+    } else {
+        int nu = max(2, max(getEdgeRate(0), getEdgeRate(2)));
+        int nv = max(2, max(getEdgeRate(1), getEdgeRate(3)));
+        sNu = nu;
+        sNv = nv;
+        sNumVertices = numBoundary + (nu - 1) * (nv - 1);
+        sNumTriangles = numBoundary + 2 * (nu - 2) * (nv - 2) +
+                        2 * (nu - 2) + 2 * (nv - 2);
+    }
+
+    uint vertexBase = 0u, firstIndex = 0u;
+    sAllocated =
+        allocate(COMMAND_VERTEX_COUNT, uint(sNumVertices),
+                 maxVertices, vertexBase) &&
+        allocate(COMMAND_INDEX_COUNT, uint(3 * sNumTriangles),
+                 maxIndices, firstIndex);
+
+    if (!sAllocated) {
+        drawCommandBuffer[COMMAND_OVERFLOW] = 1u;
+        return;
+    }
+    sVertexBase = vertexBase;
+    sFirstIndex = firstIndex;
+
+    uint cluster = atomicAdd(drawCommandBuffer[COMMAND_CLUSTER_COUNT], 1u);
+    uint c = cluster * CLUSTER_SIZE;
+    clusterBuffer[c + 0] = vertexBase;
+    clusterBuffer[c + 1] = uint(sNumVertices);
+    clusterBuffer[c + 2] = firstIndex;
+    clusterBuffer[c + 3] = uint(sNumTriangles);
+    clusterBuffer[c + 4] = uint(patchIndex);
+    clusterBuffer[c + 5] = 0u;
+    clusterBuffer[c + 6] = 0u;
+    clusterBuffer[c + 7] = 0u;
+}
+
+// ----------------------------------------------------------------------------
+// vertices
+
+// boundary vertices come first, counter-clockwise from (0,0), then the
+// interior vertices in rows of increasing v
+vec2 getPatternCoord(int vertex) {
+
+    int numEdges = getNumEdges();
+
+    if (isUntessellated()) {
+        if (vertex == 0) return vec2(0, 0);
+        if (vertex == 1) return vec2(1, 0);
+        if (vertex == 2) return (triangular != 0) ? vec2(0, 1) : vec2(1, 1);
+        return vec2(0, 1);
+    }
+
+    int start = 0;
+    for (int e = 0; e < numEdges; ++e) {
+        int rate = getEdgeRate(e);
+        if (vertex < start + rate) {
+            ivec2 f = getEdgeFraction(e, vertex - start);
+            float t = float(f.x) / float(f.y);
+            if (triangular != 0) {
+                if (e == 0) return vec2(t, 0.0);
+                if (e == 1) return vec2(1.0 - t, t);
+                return vec2(0.0, 1.0 - t);
+            }
+            if (e == 0) return vec2(t, 0.0);
+            if (e == 1) return vec2(1.0, t);
+            if (e == 2) return vec2(1.0 - t, 1.0);
+            return vec2(0.0, 1.0 - t);
+        }
+        start += rate;
+    }
+
+    int q = vertex - start;
+    if (triangular != 0) {
+        int n = sNu;
+        int j = 1;
+        while (q >= n - 1 - j) {
+            q -= n - 1 - j;
+            ++j;
+        }
+        return vec2(float(q + 1) / float(n), float(j) / float(n));
+    }
+    int nu = sNu, nv = sNv;
+    return vec2(float(q % (nu - 1) + 1) / float(nu),
+                float(q / (nu - 1) + 1) / float(nv));
+}
+
+void writeVertex(int vertex, OsdPatchParam param, int type, int firstIndex) {
+
+    vec2 st = getPatternCoord(vertex);
+
+    float wP[20], wDu[20], wDv[20], wDuu[20], wDuv[20], wDvv[20];
+    int nPoints = OsdEvaluatePatchBasisNormalized(type, param,
+        st.x, st.y, wP, wDu, wDv, wDuu, wDuv, wDvv);
+
+    vec3 P = vec3(0), dPu = vec3(0), dPv = vec3(0);
+    for (int cv = 0; cv < nPoints; ++cv) {
+        vec3 p = readPosition(patchIndexBuffer[firstIndex + cv]);
+        P += wP[cv] * p;
+        dPu += wDu[cv] * p;
+        dPv += wDv[cv] * p;
+    }
+    vec3 N = cross(dPu, dPv);
+    float len = length(N);
+    N = (len > 0.0) ? (N / len) : vec3(0);
+
+    float uv[2] = float[2](st.x, st.y);
+    if (triangular != 0) {
+        OsdPatchParamUnnormalizeTriangle(param, uv);
+    } else {
+        OsdPatchParamUnnormalize(param, uv);
+    }
+
+    int dst = int(sVertexBase + uint(vertex)) * 8;
+    tessVertexBuffer[dst + 0] = P.x;
+    tessVertexBuffer[dst + 1] = P.y;
+    tessVertexBuffer[dst + 2] = P.z;
+    tessVertexBuffer[dst + 3] = N.x;
+    tessVertexBuffer[dst + 4] = N.y;
+    tessVertexBuffer[dst + 5] = N.z;
+    tessVertexBuffer[dst + 6] = uv[0];
+    tessVertexBuffer[dst + 7] = uv[1];
+}
+
+// ----------------------------------------------------------------------------
+// triangles
+
+void writeTriangle(int triangle, int v0, int v1, int v2) {
+    int dst = int(sFirstIndex) + 3 * triangle;
+    tessIndexBuffer[dst + 0] = sVertexBase + uint(v0);
+    tessIndexBuffer[dst + 1] = sVertexBase + uint(v1);
+    tessIndexBuffer[dst + 2] = sVertexBase + uint(v2);
+}
+
+int getInteriorVertex(int i, int j) {
+    int innerStart = getEdgeStart(getNumEdges());
+    if (triangular != 0) {
+        int n = sNu;
+        return innerStart + (j - 1) * (n - 1) - (j - 1) * j / 2 + (i - 1);
+    }
+    return innerStart + (j - 1) * (sNu - 1) + (i - 1);
+}
+
+int getNumInnerVertices(int edge) {
+    if (triangular != 0) return sNu - 2;
+    return ((edge & 1) != 0) ? (sNv - 1) : (sNu - 1);
+}
+
+// the vertex k of the row of interior vertices facing an edge
+int getInnerVertex(int edge, int k) {
+    int nu = sNu, nv = sNv;
+    if (triangular != 0) {
+        if (edge == 0) return getInteriorVertex(1 + k, 1);
+        if (edge == 1) return getInteriorVertex(nu - 2 - k, 1 + k);
+        return getInteriorVertex(1, nu - 2 - k);
+    }
+    if (edge == 0) return getInteriorVertex(1 + k, 1);
+    if (edge == 1) return getInteriorVertex(nu - 1, 1 + k);
+    if (edge == 2) return getInteriorVertex(nu - 1 - k, nv - 1);
+    return getInteriorVertex(1, nv - 1 - k);
+}
+
+int getOuterVertex(int edge, int k) {
+    int rate = getEdgeRate(edge);
+    if (k < rate) return getEdgeStart(edge) + k;
+    return getEdgeStart((edge + 1) % getNumEdges());
+}
+
+int getNumEdgeTriangles(int edge) {
+    return getEdgeRate(edge) + getNumInnerVertices(edge) - 1;
+}
+
+// stitches the segments of an edge to the segments of the interior row
+// facing it, where the inner vertex j lies at (j + 1) / n along the edge
+void stitchEdge(int edge, int triangle) {
+
+    int rate = getEdgeRate(edge);
+    int n = (triangular == 0 && (edge & 1) != 0) ? sNv : sNu;
+    int numInnerSegments = getNumInnerVertices(edge) - 1;
+
+    int i = 0, j = 0;
+    while ((i < rate) || (j < numInnerSegments)) {
+        ivec2 f = getEdgeFraction(edge, i + 1);
+        if ((j == numInnerSegments) ||
+            ((i < rate) && (f.x * n <= (j + 2) * f.y))) {
+            writeTriangle(triangle++, getOuterVertex(edge, i),
+                                      getOuterVertex(edge, i + 1),
+                                      getInnerVertex(edge, j));
+            ++i;
+        } else {
+            writeTriangle(triangle++, getOuterVertex(edge, i),
+                                      getInnerVertex(edge, j + 1),
+                                      getInnerVertex(edge, j));
+            ++j;
+        }
+    }
+}
+
+void writeTriangles(int invocation) {
+
+    int numEdges = getNumEdges();
+
+    if (isUntessellated()) {
+        if (invocation == 0) {
+            writeTriangle(0, 0, 1, 2);
+            if (numEdges == 4) writeTriangle(1, 0, 2, 3);
+        }
+        return;
+    }
+
+    // the triangles of each edge, then those of the interior
+    int interiorStart = 0;
+    for (int e = 0; e < numEdges; ++e) {
+        if (invocation == e) stitchEdge(e, interiorStart);
+        interiorStart += getNumEdgeTriangles(e);
+    }
+
+    if (triangular != 0) {
+        int n = sNu;
+        for (int j = 1 + invocation; j < n - 2; j += WORK_GROUP_SIZE) {
+            int triangle = interiorStart + (j - 1) * (2 * n - 5 - j);
+            for (int i = 1; i < n - 1 - j; ++i) {
+                writeTriangle(triangle++, getInteriorVertex(i, j),
+                                          getInteriorVertex(i + 1, j),
+                                          getInteriorVertex(i, j + 1));
+                if (i + j < n - 2) {
+                    writeTriangle(triangle++, getInteriorVertex(i + 1, j),
+                                              getInteriorVertex(i + 1, j + 1),
+                                              getInteriorVertex(i, j + 1));
+                }
+            }
+        }
+    } else {
+        int nu = sNu, nv = sNv;
+        int numCells = (nu - 2) * (nv - 2);
+        for (int c = invocation; c < numCells; c += WORK_GROUP_SIZE) {
+            int i = c % (nu - 2) + 1;
+            int j = c / (nu - 2) + 1;
+            int v00 = getInteriorVertex(i, j);
+            int v10 = getInteriorVertex(i + 1, j);
+            int v11 = getInteriorVertex(i + 1, j + 1);
+            int v01 = getInteriorVertex(i, j + 1);
+            writeTriangle(interiorStart + 2 * c,     v00, v10, v11);
+            writeTriangle(interiorStart + 2 * c + 1, v00, v11, v01);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void main() {
+
+    // patches past the maximum work group count of a dimension are
+    // dispatched in rows
+    int current = int(gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x);
+    if (current >= numPatches) return;
+
+    int patchIndex = primitiveIdBase + current;
+    int firstIndex = indexBase + current * patchStride;
+    int invocation = int(gl_LocalInvocationID.x);
+
+    OsdPatchParam param = patchParamBuffer[patchIndex];
+    int type = OsdPatchParamIsRegular(param) ? regularPatchType : patchType;
+
+    if (invocation == 0) {
+        computeEdgeRates(patchIndex, param);
+        allocatePatch(patchIndex);
+    }
+    barrier();
+
+    if (!sAllocated) return;
+
+    for (int v = invocation; v < sNumVertices; v += WORK_GROUP_SIZE) {
+        writeVertex(v, param, type, firstIndex);
+    }
+    writeTriangles(invocation);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,200 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+//------------------------------------------------------------------------------
+
+//
+// Generates a level of a uniform refinement from its parent level: the pass
+// over the parent faces writes the face-vertices and face-edges of their
+// child faces and the edge-vertices of the child edges interior to them, and
+// the pass over the parent edges the edge-vertices of their two child edges.
+//
+// The children are indexed as by Vtr::QuadRefinement and Vtr::TriRefinement
+// for a full (uniform) refinement: the child faces and interior child edges
+// of each parent face follow those of the preceding faces, the two child
+// edges of each parent edge follow those of all faces, and the child vertex
+// of each parent face, edge or vertex is at the base of its type plus the
+// index of the parent.
+//
+
+layout(local_size_x=WORK_GROUP_SIZE, local_size_y=1, local_size_z=1) in;
+layout(std430) buffer;
+
+uniform int refinePass = 0;
+uniform int triSplit = 0;
+
+uniform int numParentFaces = 0;
+uniform int numParentEdges = 0;
+uniform int parentRegFaceSize = 4;  // 0 if the faces have offsets
+
+uniform int childVertFromFaceBase = 0;
+uniform int childVertFromEdgeBase = 0;
+uniform int childVertFromVertBase = 0;
+uniform int childEdgeFromEdgeBase = 0;
+
+layout(binding=0) buffer parent_face_verts  { int parentFaceVerts[]; };
+layout(binding=1) buffer parent_face_edges  { int parentFaceEdges[]; };
+layout(binding=2) buffer parent_edge_verts  { int parentEdgeVerts[]; };
+layout(binding=3) buffer parent_face_offset { int parentFaceOffsets[]; };
+layout(binding=4) buffer child_face_verts   { int childFaceVerts[]; };
+layout(binding=5) buffer child_face_edges   { int childFaceEdges[]; };
+layout(binding=6) buffer child_edge_verts   { int childEdgeVerts[]; };
+
+int getIndex() {
+    return int((gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x) *
+               gl_WorkGroupSize.x + gl_LocalInvocationID.x);
+}
+
+// Returns which of the two child edges of a parent edge is incident to one
+// of its end vertices (the first, if the edge is degenerate)
+int getEdgeChildOfVertex(int edge, int vert, int degenerateChild) {
+    int v0 = parentEdgeVerts[2*edge];
+    int v1 = parentEdgeVerts[2*edge+1];
+    return (v0 != v1) ? ((v0 != vert) ? 1 : 0) : degenerateChild;
+}
+
+void refineQuadFace(int pFace) {
+
+    int offset = pFace * parentRegFaceSize;
+    int size = parentRegFaceSize;
+    if (parentRegFaceSize == 0) {
+        offset = parentFaceOffsets[pFace];
+        size = parentFaceOffsets[pFace+1] - offset;
+    }
+
+    int cVertOfFace = childVertFromFaceBase + pFace;
+
+    for (int j = 0; j < size; ++j) {
+        int jPrev = (j + size - 1) % size;
+
+        int pVert = parentFaceVerts[offset + j];
+        int pNextEdge = parentFaceEdges[offset + j];
+        int pPrevEdge = parentFaceEdges[offset + jPrev];
+
+        // the children of quads are oriented as their parent, those of
+        // other faces start from the corner vertex
+        int r = (size == 4) ? j : 0;
+        int cFace = offset + j;
+
+        childFaceVerts[4*cFace + r]           = childVertFromVertBase + pVert;
+        childFaceVerts[4*cFace + ((r+1) & 3)] = childVertFromEdgeBase + pNextEdge;
+        childFaceVerts[4*cFace + ((r+2) & 3)] = cVertOfFace;
+        childFaceVerts[4*cFace + ((r+3) & 3)] = childVertFromEdgeBase + pPrevEdge;
+
+        int cEdgeOfNextEdge = childEdgeFromEdgeBase + 2*pNextEdge +
+                              getEdgeChildOfVertex(pNextEdge, pVert, 0);
+        int cEdgeOfPrevEdge = childEdgeFromEdgeBase + 2*pPrevEdge +
+                              getEdgeChildOfVertex(pPrevEdge, pVert, 1);
+
+        childFaceEdges[4*cFace + r]           = cEdgeOfNextEdge;
+        childFaceEdges[4*cFace + ((r+1) & 3)] = offset + j;
+        childFaceEdges[4*cFace + ((r+2) & 3)] = offset + jPrev;
+        childFaceEdges[4*cFace + ((r+3) & 3)] = cEdgeOfPrevEdge;
+
+        // the interior child edge perpendicular to the next edge
+        childEdgeVerts[2*(offset + j)]     = cVertOfFace;
+        childEdgeVerts[2*(offset + j) + 1] = childVertFromEdgeBase + pNextEdge;
+    }
+}
+
+void refineTriFace(int pFace) {
+
+    int pVerts[3], pEdges[3], cVertOfEdge[3], cEdgeOfEdge[3][2];
+    for (int i = 0; i < 3; ++i) {
+        pVerts[i] = parentFaceVerts[3*pFace + i];
+        pEdges[i] = parentFaceEdges[3*pFace + i];
+        cVertOfEdge[i] = childVertFromEdgeBase + pEdges[i];
+
+        // the child edges of each parent edge in the order of the face
+        int reversed = getEdgeChildOfVertex(pEdges[i], pVerts[i], 0);
+        cEdgeOfEdge[i][0] = childEdgeFromEdgeBase + 2*pEdges[i] + reversed;
+        cEdgeOfEdge[i][1] = childEdgeFromEdgeBase + 2*pEdges[i] + 1 - reversed;
+    }
+
+    int cFace = 4 * pFace;
+    int cEdge = 3 * pFace;
+
+    childFaceVerts[3*cFace + 0]  = childVertFromVertBase + pVerts[0];
+    childFaceVerts[3*cFace + 1]  = cVertOfEdge[0];
+    childFaceVerts[3*cFace + 2]  = cVertOfEdge[2];
+    childFaceVerts[3*cFace + 3]  = cVertOfEdge[0];
+    childFaceVerts[3*cFace + 4]  = childVertFromVertBase + pVerts[1];
+    childFaceVerts[3*cFace + 5]  = cVertOfEdge[1];
+    childFaceVerts[3*cFace + 6]  = cVertOfEdge[2];
+    childFaceVerts[3*cFace + 7]  = cVertOfEdge[1];
+    childFaceVerts[3*cFace + 8]  = childVertFromVertBase + pVerts[2];
+    childFaceVerts[3*cFace + 9]  = cVertOfEdge[1];
+    childFaceVerts[3*cFace + 10] = cVertOfEdge[2];
+    childFaceVerts[3*cFace + 11] = cVertOfEdge[0];
+
+    childFaceEdges[3*cFace + 0]  = cEdgeOfEdge[0][0];
+    childFaceEdges[3*cFace + 1]  = cEdge + 0;
+    childFaceEdges[3*cFace + 2]  = cEdgeOfEdge[2][1];
+    childFaceEdges[3*cFace + 3]  = cEdgeOfEdge[0][1];
+    childFaceEdges[3*cFace + 4]  = cEdgeOfEdge[1][0];
+    childFaceEdges[3*cFace + 5]  = cEdge + 1;
+    childFaceEdges[3*cFace + 6]  = cEdge + 2;
+    childFaceEdges[3*cFace + 7]  = cEdgeOfEdge[1][1];
+    childFaceEdges[3*cFace + 8]  = cEdgeOfEdge[2][0];
+    childFaceEdges[3*cFace + 9]  = cEdge + 2;
+    childFaceEdges[3*cFace + 10] = cEdge + 0;
+    childFaceEdges[3*cFace + 11] = cEdge + 1;
+
+    childEdgeVerts[2*cEdge + 0] = cVertOfEdge[0];
+    childEdgeVerts[2*cEdge + 1] = cVertOfEdge[2];
+    childEdgeVerts[2*cEdge + 2] = cVertOfEdge[1];
+    childEdgeVerts[2*cEdge + 3] = cVertOfEdge[0];
+    childEdgeVerts[2*cEdge + 4] = cVertOfEdge[2];
+    childEdgeVerts[2*cEdge + 5] = cVertOfEdge[1];
+}
+
+void refineEdge(int pEdge) {
+
+    int cVertOfEdge = childVertFromEdgeBase + pEdge;
+
+    for (int j = 0; j < 2; ++j) {
+        int cEdge = childEdgeFromEdgeBase + 2*pEdge + j;
+        childEdgeVerts[2*cEdge]     = cVertOfEdge;
+        childEdgeVerts[2*cEdge + 1] = childVertFromVertBase +
+                                      parentEdgeVerts[2*pEdge + j];
+    }
+}
+
+void main() {
+
+    int index = getIndex();
+
+    if (refinePass == 0) {
+        if (index >= numParentFaces) return;
+        if (triSplit != 0) {
+            refineTriFace(index);
+        } else {
+            refineQuadFace(index);
+        }
+    } else {
+        if (index >= numParentEdges) return;
+        refineEdge(index);
+    }
+}
@@ -0,0 +1,104 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../osd/mesh.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+struct EvaluatorCacheSync::Timestamp {
+    Timestamp() : tick(0) { }
+
+    std::atomic<unsigned int> tick;
+};
+
+struct EvaluatorCacheSync::State {
+    State() : table(NULL), clock(0) { }
+
+    std::atomic<void const *> table;
+    std::atomic<unsigned int> clock;
+    std::mutex mutex;
+};
+
+EvaluatorCacheSync::EvaluatorCacheSync() : _state(new State) {
+}
+
+EvaluatorCacheSync::~EvaluatorCacheSync() {
+    delete _state;
+}
+
+void const *
+EvaluatorCacheSync::LoadTable() const {
+    return _state->table.load(std::memory_order_acquire);
+}
+
+void
+EvaluatorCacheSync::StoreTable(void const *table) {
+    _state->table.store(table, std::memory_order_release);
+}
+
+void
+EvaluatorCacheSync::Lock() {
+    _state->mutex.lock();
+}
+
+void
+EvaluatorCacheSync::Unlock() {
+    _state->mutex.unlock();
+}
+
+EvaluatorCacheSync::Timestamp *
+EvaluatorCacheSync::CreateTimestamp() {
+    Timestamp *timestamp = new Timestamp;
+    Touch(timestamp);
+    return timestamp;
+}
+
+void
+EvaluatorCacheSync::DeleteTimestamp(Timestamp *timestamp) {
+    delete timestamp;
+}
+
+void
+EvaluatorCacheSync::Touch(Timestamp *timestamp) {
+    timestamp->tick.store(
+        _state->clock.fetch_add(1, std::memory_order_relaxed),
+        std::memory_order_relaxed);
+}
+
+unsigned int
+EvaluatorCacheSync::GetAge(Timestamp const *timestamp) const {
+    return _state->clock.load(std::memory_order_relaxed) -
+           timestamp->tick.load(std::memory_order_relaxed);
+}
+
+} // end namespace Osd
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
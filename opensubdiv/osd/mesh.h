@@ -27,17 +27,22 @@
 
 #include "../version.h"
 
+#include <algorithm>
 #include <bitset>
 #include <cassert>
 #include <cstring>
+#include <limits>
 #include <vector>
 
 #include "../far/topologyRefiner.h"
 #include "../far/patchTableFactory.h"
+#include "../far/stencilDependencies.h"
 #include "../far/stencilTable.h"
 #include "../far/stencilTableFactory.h"
+#include "../far/trace.h"
 
 #include "../osd/bufferDescriptor.h"
+#include "../osd/nonCopyable.h"
 
 struct ID3D11DeviceContext;
 
@@ -58,12 +63,454 @@ enum MeshBits {
     MeshEndCapBSplineBasis   = 8,  // exclusive
     MeshEndCapGregoryBasis   = 9,  // exclusive
     MeshEndCapLegacyGregory  = 10, // exclusive
-    NUM_MESH_BITS            = 11,
+    MeshMultiLevelStencils   = 11,
+    MeshStencilDependencies  = 12,
+    MeshUseDoubleCreasePatch = 13, // not drawn by HLSL and Metal shaders
+    MeshDetectUnchangedInputs = 14,
+    NUM_MESH_BITS            = 15,
 };
 typedef std::bitset<NUM_MESH_BITS> MeshBitset;
 
 // ---------------------------------------------------------------------------
 
+/// \brief The device independent data of an Osd::Mesh
+///
+/// MeshFarData refines the topology and creates the Far patch and stencil
+/// tables of a Mesh, which is the bulk of its construction, without any
+/// access to the device. It can so be constructed on worker threads (e.g.
+/// by an asset loader keeping many meshes in flight) while the Meshes of
+/// previously completed MeshFarData are created and uploaded on the thread
+/// owning the device context:
+///
+///     // worker thread
+///     Osd::MeshFarData *data = new Osd::MeshFarData(refiner, 3, 0, level);
+///
+///     // device thread
+///     mesh = new Osd::Mesh<...>(data, evaluatorCache, deviceContext);
+///
+/// It can also be constructed from the tables of an earlier construction,
+/// e.g. serialized to a cache, so that creating the Mesh only uploads them:
+///
+///     Osd::MeshFarData *data = new Osd::MeshFarData(
+///         Far::PatchTableSerializer::Deserialize(patchData, patchSize),
+///         Far::StencilTableSerializer::Deserialize(stencilData, stencilSize),
+///         NULL, 3, 0);
+///
+/// With MeshMultiLevelStencils, the stencils of each level are not
+/// factorized against the control vertices but refer to the vertices of the
+/// previous level, and are evaluated one level at a time. The stencils are
+/// much smaller at deep levels, at the cost of refining the vertices of all
+/// the intermediate levels, which uniformly refined meshes then place after
+/// the vertices of the last level.
+///
+class MeshFarData {
+public:
+    /// \brief Constructor
+    ///
+    /// @param refiner             topology refiner, owned by this class
+    ///
+    /// @param numVertexElements   number of vertex primvar elements
+    ///
+    /// @param numVaryingElements  number of varying primvar elements
+    ///
+    /// @param level               refinement level
+    ///
+    /// @param bits                MeshBits options
+    ///
+    MeshFarData(Far::TopologyRefiner * refiner,
+                int numVertexElements,
+                int numVaryingElements,
+                int level,
+                MeshBitset bits = MeshBitset()) :
+
+            _refiner(refiner),
+            _farPatchTable(NULL),
+            _vertexStencils(NULL),
+            _varyingStencils(NULL),
+            _numVertexElements(numVertexElements),
+            _numVaryingElements(numVaryingElements),
+            _bits(bits) {
+
+        assert(_refiner);
+
+        OPENSUBDIV_TRACE_SCOPE("mesh.initialize.far");
+
+        refineMesh(*_refiner, level, bits);
+
+        initializeTables(level, bits);
+    }
+
+    /// \brief Constructor from prebuilt tables, e.g. deserialized from a
+    ///        cache (see Far::PatchTableSerializer and
+    ///        Far::StencilTableSerializer), so that the Mesh constructed
+    ///        from this data only creates the device tables and buffers.
+    ///        The tables are those of a MeshFarData constructed from a
+    ///        refiner: the stencils include those of the local points of
+    ///        the patch table (see
+    ///        Far::StencilTableFactory::AppendLocalPointStencilTable()) and
+    ///        are evaluated as a single range.
+    ///
+    ///        There is no refiner (GetTopologyRefiner() returns NULL) and no
+    ///        face-varying stencils, and only the bits of \p bits which do
+    ///        not affect the creation of the tables apply (e.g.
+    ///        MeshInterleaveVarying or MeshStencilDependencies).
+    ///
+    /// @param patchTable          patch table, owned by this class
+    ///
+    /// @param vertexStencils      vertex stencils, owned by this class
+    ///
+    /// @param varyingStencils     varying stencils (or NULL), owned by this
+    ///                            class
+    ///
+    /// @param numVertexElements   number of vertex primvar elements
+    ///
+    /// @param numVaryingElements  number of varying primvar elements
+    ///
+    /// @param bits                MeshBits options
+    ///
+    MeshFarData(Far::PatchTable * patchTable,
+                Far::StencilTable const * vertexStencils,
+                Far::StencilTable const * varyingStencils,
+                int numVertexElements,
+                int numVaryingElements,
+                MeshBitset bits = MeshBitset()) :
+
+            _refiner(NULL),
+            _farPatchTable(patchTable),
+            _vertexStencils(vertexStencils),
+            _varyingStencils(varyingStencils),
+            _numVertexElements(numVertexElements),
+            _numVaryingElements(numVaryingElements),
+            _bits(bits) {
+
+        assert(_farPatchTable && _vertexStencils);
+
+        _bits.reset(MeshMultiLevelStencils);
+        _bits.reset(MeshFVarData);
+
+        if (_vertexStencils->GetNumStencils() > 0) {
+            _stencilRanges.push_back(
+                std::make_pair(0, _vertexStencils->GetNumStencils()));
+        }
+    }
+
+    ~MeshFarData() {
+        delete _refiner;
+        delete _farPatchTable;
+        delete _vertexStencils;
+        delete _varyingStencils;
+        for (int i = 0; i < (int)_fvarStencils.size(); ++i) {
+            delete _fvarStencils[i];
+        }
+    }
+
+    /// Returns the refined topology (NULL if constructed from prebuilt
+    /// tables)
+    Far::TopologyRefiner const * GetTopologyRefiner() const {
+        return _refiner;
+    }
+
+    /// Returns the patch table
+    Far::PatchTable const * GetFarPatchTable() const {
+        return _farPatchTable;
+    }
+
+    /// Returns the vertex stencils, including the local point stencils
+    Far::StencilTable const * GetVertexStencilTable() const {
+        return _vertexStencils;
+    }
+
+    /// Returns the varying stencils, including the local point stencils
+    Far::StencilTable const * GetVaryingStencilTable() const {
+        return _varyingStencils;
+    }
+
+    /// Returns the number of face-varying channels with stencils (only
+    /// created with MeshFVarData)
+    int GetNumFVarChannels() const {
+        return (int)_fvarStencils.size();
+    }
+
+    /// Returns the face-varying stencils of the channel, including the
+    /// local point stencils
+    Far::StencilTable const * GetFVarStencilTable(int channel) const {
+        return _fvarStencils[channel];
+    }
+
+    /// \brief Ranges of stencils [first, second) in the order they are to be
+    ///        evaluated, each only depending on the vertices refined by the
+    ///        ranges before it
+    typedef std::vector<std::pair<int, int> > StencilRanges;
+
+    /// Returns the ranges of the vertex and varying stencils, a single range
+    /// unless created with MeshMultiLevelStencils
+    StencilRanges const & GetStencilRanges() const {
+        return _stencilRanges;
+    }
+
+    /// Returns the ranges of the face-varying stencils of the channel
+    StencilRanges const & GetFVarStencilRanges(int channel) const {
+        return _fvarStencilRanges[channel];
+    }
+
+private:
+    template <class PATCH_TABLE> friend class MeshInterface;
+    template <typename VERTEX_BUFFER, typename STENCIL_TABLE,
+              typename EVALUATOR, typename PATCH_TABLE,
+              typename DEVICE_CONTEXT> friend class Mesh;
+    template <typename VERTEX_BUFFER, typename STENCIL_TABLE,
+              typename EVALUATOR, typename PATCH_TABLE,
+              typename DEVICE_CONTEXT> friend class MeshInstanceSet;
+
+    //  Non-copyable:
+    MeshFarData(MeshFarData const &);
+    MeshFarData & operator=(MeshFarData const &);
+
+    static inline void refineMesh(Far::TopologyRefiner & refiner,
+                                  int level, MeshBitset bits) {
+        if (bits.test(MeshAdaptive)) {
+            Far::TopologyRefiner::AdaptiveOptions options(level);
+            options.useSingleCreasePatch = bits.test(MeshUseSingleCreasePatch);
+            options.useDoubleCreasePatch = bits.test(MeshUseDoubleCreasePatch);
+            options.useInfSharpPatch = bits.test(MeshUseInfSharpPatch);
+            options.considerFVarChannels = bits.test(MeshFVarAdaptive);
+            refiner.RefineAdaptive(options);
+        } else {
+            //  This dependency on FVar channels should not be necessary
+            bool fullTopologyInLastLevel = refiner.GetNumFVarChannels()>0;
+
+            Far::TopologyRefiner::UniformOptions options(level);
+            options.fullTopologyInLastLevel = fullTopologyInLastLevel;
+            refiner.RefineUniform(options);
+        }
+    }
+
+    void initializeTables(int level, MeshBitset bits) {
+
+        bool multiLevel = bits.test(MeshMultiLevelStencils);
+
+        Far::StencilTableFactory::Options options;
+        options.generateOffsets = true;
+        options.generateIntermediateLevels =
+            (_refiner->IsUniform() && !multiLevel) ? false : true;
+        options.factorizeIntermediateLevels = !multiLevel;
+
+        if (_numVertexElements>0) {
+
+            _vertexStencils = Far::StencilTableFactory::Create(*_refiner,
+                                                               options);
+        }
+
+        if (_numVaryingElements>0) {
+
+            options.interpolationMode =
+                Far::StencilTableFactory::INTERPOLATE_VARYING;
+
+            _varyingStencils = Far::StencilTableFactory::Create(*_refiner,
+                                                                options);
+        }
+
+        if (bits.test(MeshFVarData)) {
+
+            options.interpolationMode =
+                Far::StencilTableFactory::INTERPOLATE_FACE_VARYING;
+
+            _fvarStencils.resize(_refiner->GetNumFVarChannels(), NULL);
+            for (int channel = 0; channel < (int)_fvarStencils.size();
+                 ++channel) {
+                options.fvarChannel = channel;
+                _fvarStencils[channel] =
+                    Far::StencilTableFactory::Create(*_refiner, options);
+            }
+        }
+
+        Far::PatchTableFactory::Options poptions(level);
+        poptions.generateFVarTables = bits.test(MeshFVarData);
+        poptions.generateFVarLegacyLinearPatches = !bits.test(MeshFVarAdaptive);
+        poptions.generateLegacySharpCornerPatches = !bits.test(MeshUseSmoothCornerPatch);
+        poptions.useSingleCreasePatch = bits.test(MeshUseSingleCreasePatch);
+        poptions.useDoubleCreasePatch = bits.test(MeshUseDoubleCreasePatch);
+        poptions.useInfSharpPatch = bits.test(MeshUseInfSharpPatch);
+
+        // points on bilinear and gregory basis endcap boundaries can be
+        // shared among adjacent patches to save some stencils.
+        if (bits.test(MeshEndCapBilinearBasis)) {
+            poptions.SetEndCapType(
+                Far::PatchTableFactory::Options::ENDCAP_BILINEAR_BASIS);
+            poptions.shareEndCapPatchPoints = true;
+        } else if (bits.test(MeshEndCapBSplineBasis)) {
+            poptions.SetEndCapType(
+                Far::PatchTableFactory::Options::ENDCAP_BSPLINE_BASIS);
+        } else if (bits.test(MeshEndCapGregoryBasis)) {
+            poptions.SetEndCapType(
+                Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+            poptions.shareEndCapPatchPoints = true;
+        } else if (bits.test(MeshEndCapLegacyGregory)) {
+            poptions.SetEndCapType(
+                Far::PatchTableFactory::Options::ENDCAP_LEGACY_GREGORY);
+        }
+
+        _farPatchTable = Far::PatchTableFactory::Create(*_refiner, poptions);
+
+        // if there's endcap stencils, merge it into regular stencils.
+        if (_farPatchTable->GetLocalPointStencilTable()) {
+            // append stencils
+            if (Far::StencilTable const *vertexStencilsWithLocalPoints =
+                Far::StencilTableFactory::AppendLocalPointStencilTable(
+                    *_refiner,
+                    _vertexStencils,
+                    _farPatchTable->GetLocalPointStencilTable(),
+                    !multiLevel)) {
+                delete _vertexStencils;
+                _vertexStencils = vertexStencilsWithLocalPoints;
+            }
+            if (_varyingStencils) {
+                if (Far::StencilTable const *varyingStencilsWithLocalPoints =
+                    Far::StencilTableFactory::AppendLocalPointStencilTable(
+                        *_refiner,
+                        _varyingStencils,
+                        _farPatchTable->GetLocalPointVaryingStencilTable(),
+                        !multiLevel)) {
+                    delete _varyingStencils;
+                    _varyingStencils = varyingStencilsWithLocalPoints;
+                }
+            }
+        }
+        for (int channel = 0; channel < (int)_fvarStencils.size();
+             ++channel) {
+            if (Far::StencilTable const *fvarStencilsWithLocalPoints =
+                Far::StencilTableFactory::AppendLocalPointStencilTableFaceVarying(
+                    *_refiner,
+                    _fvarStencils[channel],
+                    _farPatchTable->GetLocalPointFaceVaryingStencilTable(
+                        channel),
+                    channel, !multiLevel)) {
+                delete _fvarStencils[channel];
+                _fvarStencils[channel] = fvarStencilsWithLocalPoints;
+            }
+        }
+
+        Far::StencilTable const * tables[2] = { _vertexStencils,
+                                                _varyingStencils };
+        initializeStencilRanges(-1, multiLevel, tables, 2, _stencilRanges);
+        _vertexStencils = tables[0];
+        _varyingStencils = tables[1];
+
+        _fvarStencilRanges.resize(_fvarStencils.size());
+        for (int channel = 0; channel < (int)_fvarStencils.size();
+             ++channel) {
+            initializeStencilRanges(channel, multiLevel,
+                                    &_fvarStencils[channel], 1,
+                                    _fvarStencilRanges[channel]);
+        }
+    }
+
+    // Splits the stencils into a range per level followed by the local
+    // points. The unfactorized stencils of each level, which refer to the
+    // vertices of the previous level, are rebuilt to refer to their vertices
+    // in the buffer, where the last level of uniformly refined meshes
+    // follows the control vertices as their patches expect.
+    void initializeStencilRanges(int channel, bool multiLevel,
+                                 Far::StencilTable const ** tables,
+                                 int numTables, StencilRanges & ranges) {
+
+        Far::StencilTable const * table = NULL;
+        for (int i = 0; i < numTables && !table; ++i) {
+            table = tables[i];
+        }
+        if (!table || table->GetNumStencils() == 0) return;
+
+        int numStencils = table->GetNumStencils();
+        if (!multiLevel) {
+            ranges.push_back(std::make_pair(0, numStencils));
+            return;
+        }
+
+        int numControlVertices = table->GetNumControlVertices();
+        int numLevels = _refiner->GetMaxLevel();
+
+        std::vector<int> levelSizes(numLevels + 1);
+        for (int level = 0; level <= numLevels; ++level) {
+            Far::TopologyLevel const & refLevel = _refiner->GetLevel(level);
+            levelSizes[level] = (channel < 0)
+                ? refLevel.GetNumVertices()
+                : refLevel.GetNumFVarValues(channel);
+        }
+
+        // first stencil of each level in the table and in the buffer
+        bool reordered = _refiner->IsUniform() && numLevels > 1;
+        std::vector<int> levelStencils(numLevels + 1, 0);
+        std::vector<int> levelVertices(numLevels + 1, 0);
+        for (int level = 1; level <= numLevels; ++level) {
+            levelStencils[level] = (level == 1) ? 0
+                : levelStencils[level - 1] + levelSizes[level - 1];
+            levelVertices[level] = numControlVertices + levelStencils[level]
+                + (reordered ? levelSizes[numLevels] : 0);
+        }
+        if (reordered) {
+            levelVertices[numLevels] = numControlVertices;
+        }
+        int numRefined = levelStencils[numLevels] + levelSizes[numLevels];
+        assert(numRefined <= numStencils);
+
+        for (int i = 0; i < numTables; ++i) {
+            if (!tables[i]) continue;
+
+            std::vector<Far::StencilTable const *> parts;
+            std::vector<Far::Index> remap;
+            for (int level = 1; level <= numLevels; ++level) {
+                remap.resize(levelSizes[level - 1]);
+                for (int j = 0; j < (int)remap.size(); ++j) {
+                    remap[j] = levelVertices[level - 1] + j;
+                }
+                parts.push_back(Far::StencilTableFactory::ExtractStencils(
+                    tables[i], levelStencils[level],
+                    levelStencils[level] + levelSizes[level], &remap[0]));
+            }
+            if (reordered) {
+                std::rotate(parts.begin(), parts.end() - 1, parts.end());
+            }
+            // local points already refer to the vertices of the buffer
+            parts.push_back(Far::StencilTableFactory::ExtractStencils(
+                tables[i], numRefined, numStencils));
+
+            delete tables[i];
+            tables[i] = Far::StencilTableFactory::Create(
+                (int)parts.size(), &parts[0]);
+            for (int j = 0; j < (int)parts.size(); ++j) {
+                delete parts[j];
+            }
+        }
+
+        for (int level = 1; level <= numLevels; ++level) {
+            int start = levelVertices[level] - numControlVertices;
+            if (levelSizes[level] > 0) {
+                ranges.push_back(
+                    std::make_pair(start, start + levelSizes[level]));
+            }
+        }
+        if (numRefined < numStencils) {
+            ranges.push_back(std::make_pair(numRefined, numStencils));
+        }
+    }
+
+    Far::TopologyRefiner * _refiner;
+    Far::PatchTable * _farPatchTable;
+
+    Far::StencilTable const * _vertexStencils;
+    Far::StencilTable const * _varyingStencils;
+    std::vector<Far::StencilTable const *> _fvarStencils;
+
+    StencilRanges _stencilRanges;
+    std::vector<StencilRanges> _fvarStencilRanges;
+
+    int _numVertexElements;
+    int _numVaryingElements;
+    MeshBitset _bits;
+};
+
+// ---------------------------------------------------------------------------
+
 template <class PATCH_TABLE>
 class MeshInterface {
 public:
@@ -87,6 +534,10 @@ public:
 
     virtual void Refine() = 0;
 
+    /// Returns false if the refined vertices are up to date with the inputs
+    /// updated since the last Refine(), which is then a no-op
+    virtual bool NeedsRefine() const { return true; }
+
     virtual void Synchronize() = 0;
 
     virtual PatchTable * GetPatchTable() const = 0;
@@ -116,21 +567,75 @@ protected:
     }
     static inline void refineMesh(Far::TopologyRefiner & refiner,
                                   int level, MeshBitset bits) {
-        if (bits.test(MeshAdaptive)) {
-            Far::TopologyRefiner::AdaptiveOptions options(level);
-            options.useSingleCreasePatch = bits.test(MeshUseSingleCreasePatch);
-            options.useInfSharpPatch = bits.test(MeshUseInfSharpPatch);
-            options.considerFVarChannels = bits.test(MeshFVarAdaptive);
-            refiner.RefineAdaptive(options);
-        } else {
-            //  This dependency on FVar channels should not be necessary
-            bool fullTopologyInLastLevel = refiner.GetNumFVarChannels()>0;
+        MeshFarData::refineMesh(refiner, level, bits);
+    }
+};
 
-            Far::TopologyRefiner::UniformOptions options(level);
-            options.fullTopologyInLastLevel = fullTopologyInLastLevel;
-            refiner.RefineUniform(options);
+/// \brief Refines the meshes of a scene whose inputs changed since their
+///        last refinement, skipping the static meshes
+///
+/// The evaluations of all the dirty meshes are issued before waiting on
+/// any of them, so that the kernels of the GPU backends are queued back to
+/// back, then each refined mesh is synchronized (unless synchronize is
+/// false, e.g. to overlap the evaluations with other work and call
+/// Synchronize() later).
+///
+/// @param meshes       the meshes of the scene
+///
+/// @param numMeshes    number of meshes
+///
+/// @param synchronize  synchronizes the refined meshes before returning
+///
+/// @return             the number of meshes refined
+///
+template <class PATCH_TABLE>
+int
+RefineMeshes(MeshInterface<PATCH_TABLE> * const meshes[], int numMeshes,
+             bool synchronize = true) {
+
+    OPENSUBDIV_TRACE_SCOPE("mesh.refine.scene");
+
+    std::vector<MeshInterface<PATCH_TABLE> *> dirty;
+    for (int i = 0; i < numMeshes; ++i) {
+        if (meshes[i] && meshes[i]->NeedsRefine()) {
+            dirty.push_back(meshes[i]);
         }
     }
+
+    for (int i = 0; i < (int)dirty.size(); ++i) {
+        dirty[i]->Refine();
+    }
+    if (synchronize) {
+        for (int i = 0; i < (int)dirty.size(); ++i) {
+            dirty[i]->Synchronize();
+        }
+    }
+    return (int)dirty.size();
+}
+
+// ---------------------------------------------------------------------------
+
+/// \brief Device fences of the vertex buffers of the Meshes drawn with a
+///        PATCH_TABLE (see Mesh::SetNumVertexBuffers())
+///
+/// A fence is inserted once the commands drawing a buffer are issued, and
+/// waited on before the buffer is written again. glMesh.h specializes it
+/// for the GLPatchTable; the default does not fence, leaving the ordering
+/// of the writes after the draws to the device.
+///
+template <class PATCH_TABLE>
+struct MeshBufferFence {
+    typedef void * Type;
+
+    template <typename DEVICE_CONTEXT>
+    static Type Insert(DEVICE_CONTEXT * /* deviceContext */) {
+        return NULL;
+    }
+
+    /// Waits for the fence to be signaled and releases it
+    template <typename DEVICE_CONTEXT>
+    static void Wait(Type /* fence */, DEVICE_CONTEXT * /* deviceContext */) {
+    }
 };
 
 // ---------------------------------------------------------------------------
@@ -174,25 +679,120 @@ convertToCompatibleStencilTable<Far::StencilTable, Far::StencilTable, ID3D11Devi
     return new Far::StencilTable(*table);
 }
 
+// Converts the stencils of each range of a Far stencil table, extracting each
+// range unless it is the whole table
+template <typename STENCIL_TABLE, typename DEVICE_CONTEXT>
+void
+convertToCompatibleStencilTables(
+    Far::StencilTable const *table, MeshFarData::StencilRanges const &ranges,
+    DEVICE_CONTEXT *context, std::vector<STENCIL_TABLE const *> &result) {
+    result.clear();
+    if (! table) return;
+    for (int i = 0; i < (int)ranges.size(); ++i) {
+        if (ranges[i].first == 0 &&
+            ranges[i].second == table->GetNumStencils()) {
+            result.push_back(
+                convertToCompatibleStencilTable<STENCIL_TABLE>(
+                table, context));
+        } else {
+            Far::StencilTable const *range =
+                Far::StencilTableFactory::ExtractStencils(
+                table, ranges[i].first, ranges[i].second);
+            result.push_back(
+                convertToCompatibleStencilTable<STENCIL_TABLE>(
+                range, context));
+            delete range;
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 
+/// @cond INTERNAL
+
+// Synchronization of the threads sharing an EvaluatorCacheT -- the atomic
+// variables and the mutex it requires are defined in mesh.cpp, so that this
+// header does not depend on C++11 threading support.
+class EvaluatorCacheSync : private NonCopyable<EvaluatorCacheSync> {
+public:
+    // last use of a cached entry, for the LRU eviction
+    struct Timestamp;
+
+    EvaluatorCacheSync();
+    ~EvaluatorCacheSync();
+
+    // the published table of entries (acquire/release ordering)
+    void const *LoadTable() const;
+    void StoreTable(void const *table);
+
+    // lock guarding insertions and the deletion of retired entries
+    void Lock();
+    void Unlock();
+
+    Timestamp *CreateTimestamp();
+    static void DeleteTimestamp(Timestamp *timestamp);
+
+    // stamps the entry with the current tick of the clock, and returns the
+    // number of ticks since (compared as ages to allow the clock to wrap)
+    void Touch(Timestamp *timestamp);
+    unsigned int GetAge(Timestamp const *timestamp) const;
+
+    class ScopedLock {
+    public:
+        explicit ScopedLock(EvaluatorCacheSync &sync) : _sync(sync) {
+            _sync.Lock();
+        }
+        ~ScopedLock() { _sync.Unlock(); }
+    private:
+        ScopedLock(ScopedLock const &);
+        ScopedLock &operator=(ScopedLock const &);
+
+        EvaluatorCacheSync &_sync;
+    };
+
+private:
+    struct State;
+    State *_state;
+};
+
+/// @endcond
+
 // Osd evaluator cache: for the GPU backends require compiled instance
 //   (GLXFB, GLCompute, CL)
 //
 // note: this is just an example usage and client applications are supposed
 //       to implement their own structure for Evaluator instance.
 //
+// The cache can be shared by threads: lookups of cached evaluators do not
+// lock, they search an immutable table of the entries sorted by hashed keys,
+// which insertions replace under a lock. With a capacity, inserting into a
+// full cache evicts the least recently used evaluator. As other threads may
+// still be using evicted evaluators (and the tables they replaced), these
+// are only deleted by DeleteRetiredEvaluators(), which the client calls when
+// no evaluation or lookup is in progress, e.g. once per frame on the thread
+// owning the device context.
+//
 template <typename EVALUATOR>
 class EvaluatorCacheT {
 public:
+    /// \brief Constructor
+    ///
+    /// @param capacity  maximum number of cached evaluators (0: unbounded)
+    ///
+    explicit EvaluatorCacheT(int capacity = 0) : _capacity(capacity) { }
+
     ~EvaluatorCacheT() {
-        for(typename Evaluators::iterator it = _evaluators.begin();
-            it != _evaluators.end(); ++it) {
-            delete it->evaluator;
+        Evaluators const *table = loadTable();
+        if (table) {
+            for (typename Evaluators::const_iterator it = table->begin();
+                 it != table->end(); ++it) {
+                deleteEntry(*it);
+            }
+            delete table;
         }
+        DeleteRetiredEvaluators();
     }
 
-    // XXX: FIXME, linear search
     struct Entry {
         Entry(BufferDescriptor const &srcDescArg,
               BufferDescriptor const &dstDescArg,
@@ -203,7 +803,10 @@ public:
                               duuDesc(BufferDescriptor()),
                               duvDesc(BufferDescriptor()),
                               dvvDesc(BufferDescriptor()),
-                              evaluator(evalArg) {}
+                              evaluator(evalArg),
+                              hash(hashKey(srcDesc, dstDesc, duDesc, dvDesc,
+                                           duuDesc, duvDesc, dvvDesc)),
+                              lastUse(NULL) {}
         Entry(BufferDescriptor const &srcDescArg,
               BufferDescriptor const &dstDescArg,
               BufferDescriptor const &duDescArg,
@@ -216,13 +819,19 @@ public:
                               duuDesc(duuDescArg),
                               duvDesc(duvDescArg),
                               dvvDesc(dvvDescArg),
-                              evaluator(evalArg) {}
+                              evaluator(evalArg),
+                              hash(hashKey(srcDesc, dstDesc, duDesc, dvDesc,
+                                           duuDesc, duvDesc, dvvDesc)),
+                              lastUse(NULL) {}
         BufferDescriptor srcDesc, dstDesc;
         BufferDescriptor duDesc, dvDesc;
         BufferDescriptor duuDesc, duvDesc, dvvDesc;
         EVALUATOR *evaluator;
+        unsigned int hash;
+        EvaluatorCacheSync::Timestamp *lastUse;  // for the LRU eviction
     };
-    typedef std::vector<Entry> Evaluators;
+    // entries sorted by hash
+    typedef std::vector<Entry *> Evaluators;
 
     template <typename DEVICE_CONTEXT>
     EVALUATOR *GetEvaluator(BufferDescriptor const &srcDesc,
@@ -261,29 +870,158 @@ public:
                             BufferDescriptor const &dvvDesc,
                             DEVICE_CONTEXT *deviceContext) {
 
-        for(typename Evaluators::iterator it = _evaluators.begin();
-            it != _evaluators.end(); ++it) {
-            if (isEqual(srcDesc, it->srcDesc) &&
-                isEqual(dstDesc, it->dstDesc) &&
-                isEqual(duDesc,  it->duDesc) &&
-                isEqual(dvDesc,  it->dvDesc) &&
-                isEqual(duuDesc, it->duuDesc) &&
-                isEqual(duvDesc, it->duvDesc) &&
-                isEqual(dvvDesc, it->dvvDesc)) {
-                return it->evaluator;
+        unsigned int hash = hashKey(srcDesc, dstDesc, duDesc, dvDesc,
+                                    duuDesc, duvDesc, dvvDesc);
+
+        Entry *entry = find(loadTable(), hash,
+                            srcDesc, dstDesc, duDesc, dvDesc,
+                            duuDesc, duvDesc, dvvDesc);
+        if (! entry) {
+            EvaluatorCacheSync::ScopedLock lock(_sync);
+
+            // another thread may have inserted it since the lookup
+            Evaluators const *table = loadTable();
+            entry = find(table, hash, srcDesc, dstDesc, duDesc, dvDesc,
+                         duuDesc, duvDesc, dvvDesc);
+            if (! entry) {
+                EVALUATOR *e = EVALUATOR::Create(srcDesc, dstDesc,
+                                                 duDesc, dvDesc,
+                                                 duuDesc, duvDesc, dvvDesc,
+                                                 deviceContext);
+                entry = new Entry(srcDesc, dstDesc,
+                                  duDesc, dvDesc,
+                                  duuDesc, duvDesc, dvvDesc, e);
+                if (_capacity > 0) {
+                    entry->lastUse = _sync.CreateTimestamp();
+                }
+                insert(table, entry);
             }
         }
-        EVALUATOR *e = EVALUATOR::Create(srcDesc, dstDesc,
-                                         duDesc, dvDesc,
-                                         duuDesc, duvDesc, dvvDesc,
-                                         deviceContext);
-        _evaluators.push_back(Entry(srcDesc, dstDesc,
-                                    duDesc, dvDesc,
-                                    duuDesc, duvDesc, dvvDesc, e));
-        return e;
+        if (_capacity > 0) {
+            _sync.Touch(entry->lastUse);
+        }
+        return entry->evaluator;
+    }
+
+    /// \brief Returns the number of cached evaluators
+    int GetNumEvaluators() const {
+        Evaluators const *table = loadTable();
+        return table ? (int)table->size() : 0;
+    }
+
+    /// \brief Deletes the evaluators evicted from the cache. No other thread
+    ///        may be looking up or using evaluators of this cache.
+    void DeleteRetiredEvaluators() {
+        EvaluatorCacheSync::ScopedLock lock(_sync);
+
+        for (int i = 0; i < (int)_retiredEntries.size(); ++i) {
+            deleteEntry(_retiredEntries[i]);
+        }
+        _retiredEntries.clear();
+        for (int i = 0; i < (int)_retiredTables.size(); ++i) {
+            delete _retiredTables[i];
+        }
+        _retiredTables.clear();
     }
 
 private:
+    Evaluators const *loadTable() const {
+        return static_cast<Evaluators const *>(_sync.LoadTable());
+    }
+
+    static void deleteEntry(Entry *entry) {
+        EvaluatorCacheSync::DeleteTimestamp(entry->lastUse);
+        delete entry->evaluator;
+        delete entry;
+    }
+
+    static Entry *find(Evaluators const *table, unsigned int hash,
+                       BufferDescriptor const &srcDesc,
+                       BufferDescriptor const &dstDesc,
+                       BufferDescriptor const &duDesc,
+                       BufferDescriptor const &dvDesc,
+                       BufferDescriptor const &duuDesc,
+                       BufferDescriptor const &duvDesc,
+                       BufferDescriptor const &dvvDesc) {
+        if (! table) return NULL;
+
+        for (typename Evaluators::const_iterator it =
+                 std::lower_bound(table->begin(), table->end(), hash,
+                                  entryHashLess);
+             it != table->end() && (*it)->hash == hash; ++it) {
+            Entry *entry = *it;
+            if (isEqual(srcDesc, entry->srcDesc) &&
+                isEqual(dstDesc, entry->dstDesc) &&
+                isEqual(duDesc,  entry->duDesc) &&
+                isEqual(dvDesc,  entry->dvDesc) &&
+                isEqual(duuDesc, entry->duuDesc) &&
+                isEqual(duvDesc, entry->duvDesc) &&
+                isEqual(dvvDesc, entry->dvvDesc)) {
+                return entry;
+            }
+        }
+        return NULL;
+    }
+
+    // Publishes a copy of the table with the new entry, evicting the least
+    // recently used entry if the cache is full (called with _sync locked)
+    void insert(Evaluators const *table, Entry *entry) {
+        Evaluators *newTable = table ? new Evaluators(*table)
+                                     : new Evaluators();
+
+        if (_capacity > 0 && (int)newTable->size() >= _capacity) {
+            typename Evaluators::iterator lru = newTable->begin();
+            for (typename Evaluators::iterator it = newTable->begin();
+                 it != newTable->end(); ++it) {
+                if (_sync.GetAge((*it)->lastUse) >
+                    _sync.GetAge((*lru)->lastUse)) {
+                    lru = it;
+                }
+            }
+            _retiredEntries.push_back(*lru);
+            newTable->erase(lru);
+        }
+        newTable->insert(std::upper_bound(newTable->begin(), newTable->end(),
+                                          entry->hash, hashEntryLess),
+                         entry);
+
+        _sync.StoreTable(newTable);
+        if (table) {
+            _retiredTables.push_back(table);
+        }
+    }
+
+    static bool entryHashLess(Entry const *entry, unsigned int hash) {
+        return entry->hash < hash;
+    }
+    static bool hashEntryLess(unsigned int hash, Entry const *entry) {
+        return hash < entry->hash;
+    }
+
+    static unsigned int hashKey(BufferDescriptor const &srcDesc,
+                                BufferDescriptor const &dstDesc,
+                                BufferDescriptor const &duDesc,
+                                BufferDescriptor const &dvDesc,
+                                BufferDescriptor const &duuDesc,
+                                BufferDescriptor const &duvDesc,
+                                BufferDescriptor const &dvvDesc) {
+        BufferDescriptor const *descs[7] = {
+            &srcDesc, &dstDesc, &duDesc, &dvDesc,
+            &duuDesc, &duvDesc, &dvvDesc };
+
+        // FNV-1a over the fields compared by isEqual
+        unsigned int hash = 2166136261u;
+        for (int i = 0; i < 7; ++i) {
+            int fields[3] = { descs[i]->stride ?
+                                  (descs[i]->offset % descs[i]->stride) : 0,
+                              descs[i]->length, descs[i]->stride };
+            for (int j = 0; j < 3; ++j) {
+                hash = (hash ^ (unsigned int)fields[j]) * 16777619u;
+            }
+        }
+        return hash;
+    }
+
     static bool isEqual(BufferDescriptor const &a,
                         BufferDescriptor const &b) {
         int offsetA = a.stride ? (a.offset % a.stride) : 0;
@@ -296,7 +1034,13 @@ private:
                 a.stride == b.stride);
     }
 
-    Evaluators _evaluators;
+    int _capacity;
+
+    EvaluatorCacheSync _sync;
+
+    // evicted entries and replaced tables, deleted by DeleteRetiredEvaluators
+    std::vector<Entry *> _retiredEntries;
+    std::vector<Evaluators const *> _retiredTables;
 };
 
 /// @cond INTERNAL
@@ -424,6 +1168,7 @@ public:
     typedef DEVICE_CONTEXT DeviceContext;
     typedef EvaluatorCacheT<Evaluator> EvaluatorCache;
     typedef typename PatchTable::VertexBufferBinding VertexBufferBinding;
+    typedef MeshBufferFence<PatchTable> BufferFence;
 
     Mesh(Far::TopologyRefiner * refiner,
          int numVertexElements,
@@ -433,117 +1178,327 @@ public:
          EvaluatorCache * evaluatorCache = NULL,
          DeviceContext * deviceContext = NULL) :
 
-            _refiner(refiner),
+            _refiner(NULL),
             _farPatchTable(NULL),
+            _numControlVertices(0),
             _numVertices(0),
             _maxValence(0),
             _vertexBuffer(NULL),
             _varyingBuffer(NULL),
-            _vertexStencilTable(NULL),
-            _varyingStencilTable(NULL),
+            _vertexDependencies(NULL),
             _evaluatorCache(evaluatorCache),
             _patchTable(NULL),
-            _deviceContext(deviceContext) {
+            _deviceContext(deviceContext),
+            _writeBuffer(0),
+            _drawBuffer(0),
+            _drawBufferPending(false),
+            _detectUnchangedInputs(false),
+            _inputVersion(1),
+            _refinedVersion(0) {
 
-        assert(_refiner);
+        assert(refiner);
 
-        MeshInterface<PATCH_TABLE>::refineMesh(
-            *_refiner, level, bits);
+        MeshFarData farData(refiner,
+                            numVertexElements, numVaryingElements,
+                            level, bits);
 
-        int vertexBufferStride = numVertexElements +
-            (bits.test(MeshInterleaveVarying) ? numVaryingElements : 0);
-        int varyingBufferStride =
-            (bits.test(MeshInterleaveVarying) ? 0 : numVaryingElements);
+        initialize(farData);
+    }
 
-        initializeContext(numVertexElements,
-                          numVaryingElements,
-                          level, bits);
+    /// \brief Constructs the mesh from device independent data, typically
+    ///        built on another thread (see MeshFarData). Only the device
+    ///        tables and buffers are created here.
+    ///
+    /// @param farData         device independent data, deleted by this
+    ///                        constructor
+    ///
+    /// @param evaluatorCache  evaluator cache (or NULL)
+    ///
+    /// @param deviceContext   device context (or NULL)
+    ///
+    Mesh(MeshFarData * farData,
+         EvaluatorCache * evaluatorCache = NULL,
+         DeviceContext * deviceContext = NULL) :
 
-        initializeVertexBuffers(_numVertices,
-                                vertexBufferStride,
-                                varyingBufferStride);
+            _refiner(NULL),
+            _farPatchTable(NULL),
+            _numControlVertices(0),
+            _numVertices(0),
+            _maxValence(0),
+            _vertexBuffer(NULL),
+            _varyingBuffer(NULL),
+            _vertexDependencies(NULL),
+            _evaluatorCache(evaluatorCache),
+            _patchTable(NULL),
+            _deviceContext(deviceContext),
+            _writeBuffer(0),
+            _drawBuffer(0),
+            _drawBufferPending(false),
+            _detectUnchangedInputs(false),
+            _inputVersion(1),
+            _refinedVersion(0) {
 
-        // configure vertex buffer descriptor
-        _vertexDesc =
-            BufferDescriptor(0, numVertexElements, vertexBufferStride);
-        if (bits.test(MeshInterleaveVarying)) {
-            _varyingDesc = BufferDescriptor(
-                numVertexElements, numVaryingElements, vertexBufferStride);
-        } else {
-            _varyingDesc = BufferDescriptor(
-                0, numVaryingElements, varyingBufferStride);
-        }
+        assert(farData);
+
+        initialize(*farData);
+
+        delete farData;
     }
 
     virtual ~Mesh() {
         delete _refiner;
         delete _farPatchTable;
-        delete _vertexBuffer;
-        delete _varyingBuffer;
-        delete _vertexStencilTable;
-        delete _varyingStencilTable;
+        for (int i = 0; i < (int)_vertexBuffers.size(); ++i) {
+            if (_bufferFences[i]) {
+                BufferFence::Wait(_bufferFences[i], _deviceContext);
+            }
+            delete _vertexBuffers[i];
+            delete _varyingBuffers[i];
+        }
+        deleteStencilTables(_vertexStencilTables);
+        deleteStencilTables(_varyingStencilTables);
+        delete _vertexDependencies;
+        for (int i = 0; i < (int)_fvarStencilTables.size(); ++i) {
+            deleteStencilTables(_fvarStencilTables[i]);
+            delete _fvarBuffers[i];
+        }
         delete _patchTable;
         // deviceContext and evaluatorCache are not owned by this class.
     }
 
+    /// \brief Updates vertices of the vertex buffer, so that the next
+    ///        Refine() refines them.
+    ///
+    /// With MeshDetectUnchangedInputs, the mesh keeps a copy of its control
+    /// vertices to compare the updates with: control vertices updated with
+    /// the values they already have are neither uploaded nor refined again,
+    /// e.g. for the static meshes of an animation updated every frame.
+    ///
     virtual void UpdateVertexBuffer(float const *vertexData,
                                     int startVertex, int numVerts) {
+        if (!updateControlValues(_controlVertexValues,
+                                 _vertexBuffer->GetNumElements(),
+                                 vertexData, startVertex, numVerts)) return;
+
+        advanceBuffers();
         _vertexBuffer->UpdateData(vertexData, startVertex, numVerts,
                                   _deviceContext);
+        ++_inputVersion;
     }
 
     virtual void UpdateVaryingBuffer(float const *varyingData,
                                      int startVertex, int numVerts) {
+        if (!updateControlValues(_controlVaryingValues,
+                                 _varyingBuffer->GetNumElements(),
+                                 varyingData, startVertex, numVerts)) return;
+
+        advanceBuffers();
         _varyingBuffer->UpdateData(varyingData, startVertex, numVerts,
                                    _deviceContext);
+        ++_inputVersion;
     }
 
+    /// \brief Allocates the buffer of the face-varying values of a channel
+    ///        with stencils (see GetNumFVarChannels()), replacing any
+    ///        previous buffer. Refine() then also refines the values of
+    ///        the channel.
+    ///
+    /// @param channel      face-varying channel
+    ///
+    /// @param numElements  number of elements of each value (e.g. 2 for UVs)
+    ///
+    virtual void InitializeFVarBuffer(int channel, int numElements) {
+        delete _fvarBuffers[channel];
+        _fvarBuffers[channel] = VertexBuffer::Create(
+            numElements, _fvarNumValues[channel], _deviceContext);
+        _fvarDescs[channel] =
+            BufferDescriptor(0, numElements, numElements);
+        ++_inputVersion;
+    }
+
+    virtual void UpdateFVarBuffer(int channel, float const *fvarData,
+                                  int startValue, int numValues) {
+        _fvarBuffers[channel]->UpdateData(fvarData, startValue, numValues,
+                                          _deviceContext);
+        ++_inputVersion;
+    }
+
+    /// \brief Refines the vertex, varying and face-varying buffers, unless
+    ///        no input changed since the last refinement (see NeedsRefine())
     virtual void Refine() {
 
-        int numControlVertices = _refiner->GetLevel(0).GetNumVertices();
+        if (!NeedsRefine()) return;
 
-        BufferDescriptor srcDesc = _vertexDesc;
-        BufferDescriptor dstDesc(srcDesc);
-        dstDesc.offset += numControlVertices * dstDesc.stride;
+        OPENSUBDIV_TRACE_SCOPE("mesh.refine");
 
-        // note that the _evaluatorCache can be NULL and thus
-        // the evaluatorInstance can be NULL
-        //  (for uninstantiatable kernels CPU,TBB etc)
-        Evaluator const *instance = GetEvaluator<Evaluator>(
-            _evaluatorCache, srcDesc, dstDesc,
-            _deviceContext);
+        advanceBuffers();
 
-        Evaluator::EvalStencils(_vertexBuffer, srcDesc,
-                                _vertexBuffer, dstDesc,
-                                _vertexStencilTable,
-                                instance, _deviceContext);
+        int numControlVertices = _numControlVertices;
+
+        refineStencils(_vertexBuffer, _vertexDesc, numControlVertices,
+                       _vertexStencilTables, _stencilRanges);
 
         if (_varyingDesc.length > 0) {
-            BufferDescriptor vSrcDesc = _varyingDesc;
-            BufferDescriptor vDstDesc(vSrcDesc);
-            vDstDesc.offset += numControlVertices * vDstDesc.stride;
+            // interleaved varying are refined in the vertex buffer
+            refineStencils(_varyingBuffer ? _varyingBuffer : _vertexBuffer,
+                           _varyingDesc, numControlVertices,
+                           _varyingStencilTables, _stencilRanges);
+        }
 
-            instance = GetEvaluator<Evaluator>(
-                _evaluatorCache, vSrcDesc, vDstDesc,
-                _deviceContext);
+        for (int channel = 0; channel < (int)_fvarBuffers.size(); ++channel) {
+            if (!_fvarBuffers[channel]) continue;
 
-            if (_varyingBuffer) {
-                // non-interleaved
-                Evaluator::EvalStencils(_varyingBuffer, vSrcDesc,
-                                        _varyingBuffer, vDstDesc,
-                                        _varyingStencilTable,
-                                        instance, _deviceContext);
-            } else {
-                // interleaved
-                Evaluator::EvalStencils(_vertexBuffer, vSrcDesc,
-                                        _vertexBuffer, vDstDesc,
-                                        _varyingStencilTable,
-                                        instance, _deviceContext);
+            int numControlValues = _fvarNumControlValues[channel];
+
+            refineStencils(_fvarBuffers[channel], _fvarDescs[channel],
+                           numControlValues, _fvarStencilTables[channel],
+                           _fvarStencilRanges[channel]);
+        }
+
+        publishBuffers();
+
+        _refinedVersion = _inputVersion;
+    }
+
+    /// \brief Allocates a ring of vertex (and varying) buffers, so that
+    ///        Refine() writes the next buffer of the ring while the device
+    ///        still draws the buffers refined before.
+    ///
+    /// BindVertexBuffer() and BindVaryingBuffer() bind the buffer last
+    /// refined. A fence (see MeshBufferFence) is inserted on that buffer
+    /// when the next input is updated -- i.e. once the commands drawing it
+    /// are issued -- and waited on only when the ring wraps around to the
+    /// buffer, so that refining and drawing are not serialized by the
+    /// device.
+    ///
+    /// Each buffer of the ring only retains the data written to it: the
+    /// mesh keeps a copy of the control vertices updated with
+    /// UpdateVertexBuffer() and UpdateVaryingBuffer(), uploaded to the
+    /// next buffer of the ring before it is refined, while the control
+    /// vertices written to the buffers returned by GetVertexBuffer() and
+    /// GetVaryingBuffer() are to be written in full after each Refine().
+    /// Face-varying buffers are not part of the ring.
+    ///
+    /// To be called before the buffers are first updated.
+    ///
+    /// @param numBuffers  number of buffers of the ring (1 to only refine
+    ///                    the buffer drawn, as by default)
+    ///
+    void SetNumVertexBuffers(int numBuffers) {
+
+        assert(numBuffers > 0);
+
+        for (int i = 0; i < (int)_bufferFences.size(); ++i) {
+            if (_bufferFences[i]) {
+                BufferFence::Wait(_bufferFences[i], _deviceContext);
+            }
+        }
+        while ((int)_vertexBuffers.size() > numBuffers) {
+            delete _vertexBuffers.back();
+            delete _varyingBuffers.back();
+            _vertexBuffers.pop_back();
+            _varyingBuffers.pop_back();
+        }
+        while ((int)_vertexBuffers.size() < numBuffers) {
+            _vertexBuffers.push_back(createBuffer(_vertexBuffers[0]));
+            _varyingBuffers.push_back(createBuffer(_varyingBuffers[0]));
+        }
+        _bufferFences.assign(numBuffers, typename BufferFence::Type());
+
+        _writeBuffer = _drawBuffer = 0;
+        _drawBufferPending = false;
+        _vertexBuffer = _vertexBuffers[0];
+        _varyingBuffer = _varyingBuffers[0];
+    }
+
+    /// Returns the number of buffers of the ring of vertex buffers
+    int GetNumVertexBuffers() const { return (int)_vertexBuffers.size(); }
+
+    virtual bool NeedsRefine() const {
+        return _refinedVersion != _inputVersion;
+    }
+
+    /// \brief Returns the version of the inputs, incremented by each update
+    ///        of the buffers (e.g. to track the changes of a mesh)
+    unsigned int GetInputVersion() const { return _inputVersion; }
+
+    /// \brief Marks the inputs as changed, so that the next Refine()
+    ///        refines them, e.g. after writing to the control vertices of
+    ///        a buffer bound by the client
+    void MarkInputsChanged() { ++_inputVersion; }
+
+    /// \brief Refines only the vertices depending on the given control
+    ///        vertices, e.g. after UpdateVertexBuffer for the control
+    ///        vertices moved by a brush stroke.
+    ///
+    /// Requires a mesh created with MeshStencilDependencies, and an
+    /// evaluator supporting the evaluation of a list of stencils (e.g.
+    /// CpuEvaluator, TbbEvaluator, CudaEvaluator or GLComputeEvaluator).
+    /// Face-varying buffers are not refined. With a ring of vertex buffers
+    /// (see SetNumVertexBuffers()), the buffer refined holds the vertices
+    /// of an earlier refinement, so that all its vertices are refined.
+    ///
+    /// @param controlVertices     indices of the modified control vertices
+    ///
+    /// @param numControlVertices  number of modified control vertices
+    ///
+    /// @param refinedVertices     optionally returns the sorted indices of
+    ///                            the refined vertices (and local points) in
+    ///                            the vertex buffer, e.g. to find the patches
+    ///                            to update
+    ///
+    void RefineDependentVertices(Far::Index const controlVertices[],
+                                 int numControlVertices,
+                                 std::vector<Far::Index> * refinedVertices =
+                                     NULL) {
+
+        OPENSUBDIV_TRACE_SCOPE("mesh.refine.dependent");
+
+        assert(_vertexDependencies);
+
+        std::vector<Far::Index> stencils;
+        _vertexDependencies->FindDependentStencils(
+            controlVertices, numControlVertices, stencils);
+
+        int numBaseVertices = _numControlVertices;
+
+        advanceBuffers();
+
+        if (_vertexBuffers.size() > 1) {
+            refineStencils(_vertexBuffer, _vertexDesc, numBaseVertices,
+                           _vertexStencilTables, _stencilRanges);
+            if (_varyingDesc.length > 0) {
+                refineStencils(_varyingBuffer ? _varyingBuffer : _vertexBuffer,
+                               _varyingDesc, numBaseVertices,
+                               _varyingStencilTables, _stencilRanges);
+            }
+        } else {
+            refineDependentStencils(_vertexBuffer, _vertexDesc,
+                                    numBaseVertices, _vertexStencilTables,
+                                    _stencilRanges, stencils);
+
+            if (_varyingDesc.length > 0) {
+                // varying stencils depend on a subset of the control
+                // vertices of the vertex stencils
+                refineDependentStencils(
+                    _varyingBuffer ? _varyingBuffer : _vertexBuffer,
+                    _varyingDesc, numBaseVertices,
+                    _varyingStencilTables, _stencilRanges, stencils);
+            }
+        }
+
+        publishBuffers();
+
+        if (refinedVertices) {
+            refinedVertices->resize(stencils.size());
+            for (int i = 0; i < (int)stencils.size(); ++i) {
+                (*refinedVertices)[i] = numBaseVertices + stencils[i];
             }
         }
     }
 
     virtual void Synchronize() {
+        OPENSUBDIV_TRACE_SCOPE("mesh.synchronize");
         Evaluator::Synchronize(_deviceContext);
     }
 
@@ -560,122 +1515,299 @@ public:
     virtual int GetMaxValence() const { return _maxValence; }
 
     virtual VertexBufferBinding BindVertexBuffer() {
-        return _vertexBuffer->BindVBO(_deviceContext);
+        return _vertexBuffers[_drawBuffer]->BindVBO(_deviceContext);
     }
 
     virtual VertexBufferBinding BindVaryingBuffer() {
-        return _varyingBuffer->BindVBO(_deviceContext);
+        return _varyingBuffers[_drawBuffer]->BindVBO(_deviceContext);
+    }
+
+    virtual VertexBufferBinding BindFVarBuffer(int channel) {
+        return _fvarBuffers[channel]->BindVBO(_deviceContext);
     }
 
+    // the buffers returned may be written to by the client, so that
+    // returning them marks the inputs as changed (and also bypasses
+    // MeshDetectUnchangedInputs). With a ring of vertex buffers, the buffers
+    // returned are the next ones to be refined.
     virtual VertexBuffer * GetVertexBuffer() {
+        advanceBuffers();
+        MarkInputsChanged();
+        _controlVertexValues.clear();
         return _vertexBuffer;
     }
 
     virtual VertexBuffer * GetVaryingBuffer() {
+        advanceBuffers();
+        MarkInputsChanged();
+        _controlVaryingValues.clear();
         return _varyingBuffer;
     }
 
+    /// Returns the number of face-varying channels with stencils, which
+    /// are only created with MeshFVarData
+    virtual int GetNumFVarChannels() const {
+        return (int)_fvarStencilTables.size();
+    }
+
+    /// Returns the number of face-varying values of a channel, i.e. the
+    /// coarse, refined and local point values
+    virtual int GetNumFVarValues(int channel) const {
+        return _fvarNumValues[channel];
+    }
+
+    /// Returns the face-varying buffer of a channel (or NULL if it is not
+    /// initialized)
+    virtual VertexBuffer * GetFVarBuffer(int channel) {
+        MarkInputsChanged();
+        return _fvarBuffers[channel];
+    }
+
     virtual Far::TopologyRefiner const * GetTopologyRefiner() const {
         return _refiner;
     }
 
 private:
-    void initializeContext(int numVertexElements,
-                           int numVaryingElements,
-                           int level, MeshBitset bits) {
-        assert(_refiner);
+    // Returns false if the update leaves the control values unchanged (with
+    // MeshDetectUnchangedInputs), otherwise stores the updated values in
+    // the copy of the control values (allocated on the first update with
+    // NaNs, which differ from any value), also kept for a ring of buffers
+    bool updateControlValues(std::vector<float> & values, int numElements,
+                             float const *data, int start, int count) {
+
+        if (!_detectUnchangedInputs && _vertexBuffers.size() == 1) return true;
+
+        int numControlValues = _numControlVertices;
+        if (start < 0 || start + count > numControlValues) {
+            // refined vertices are updated: the copy is no longer valid
+            values.clear();
+            return true;
+        }
 
-        Far::StencilTableFactory::Options options;
-        options.generateOffsets = true;
-        options.generateIntermediateLevels =
-            _refiner->IsUniform() ? false : true;
+        if (values.empty()) {
+            values.resize((size_t)numControlValues * numElements,
+                          std::numeric_limits<float>::quiet_NaN());
+        }
 
-        Far::StencilTable const * vertexStencils = NULL;
-        Far::StencilTable const * varyingStencils = NULL;
+        float * dst = &values[(size_t)start * numElements];
+        int length = count * numElements;
 
-        if (numVertexElements>0) {
+        int i = 0;
+        if (_detectUnchangedInputs) {
+            while (i < length && dst[i] == data[i]) ++i;
+            if (i == length) return false;
+        }
 
-            vertexStencils = Far::StencilTableFactory::Create(*_refiner,
-                                                              options);
+        std::memcpy(dst + i, data + i, (length - i) * sizeof(float));
+        return true;
+    }
+
+    // Evaluates the stencil tables of the ranges in order, each refining the
+    // vertices following the control vertices from the start of its range
+    void refineStencils(VertexBuffer * buffer,
+                        BufferDescriptor const & srcDesc,
+                        int numControlVertices,
+                        std::vector<StencilTable const *> const & tables,
+                        MeshFarData::StencilRanges const & ranges) {
+
+        for (int i = 0; i < (int)tables.size(); ++i) {
+            BufferDescriptor dstDesc(srcDesc);
+            dstDesc.offset +=
+                (numControlVertices + ranges[i].first) * dstDesc.stride;
+
+            // note that the _evaluatorCache can be NULL and thus
+            // the evaluatorInstance can be NULL
+            //  (for uninstantiatable kernels CPU,TBB etc)
+            Evaluator const *instance = GetEvaluator<Evaluator>(
+                _evaluatorCache, srcDesc, dstDesc,
+                _deviceContext);
+
+            Evaluator::EvalStencils(buffer, srcDesc,
+                                    buffer, dstDesc,
+                                    tables[i],
+                                    instance, _deviceContext);
         }
+    }
 
-        if (numVaryingElements>0) {
+    // Evaluates the given sorted stencils of the table (indexed as the
+    // stencils of all ranges) range by range
+    void refineDependentStencils(
+        VertexBuffer * buffer,
+        BufferDescriptor const & srcDesc,
+        int numControlVertices,
+        std::vector<StencilTable const *> const & tables,
+        MeshFarData::StencilRanges const & ranges,
+        std::vector<Far::Index> const & stencils) {
+
+        std::vector<Far::Index> rangeStencils;
+        for (int i = 0; i < (int)tables.size(); ++i) {
+            std::vector<Far::Index>::const_iterator
+                first = std::lower_bound(stencils.begin(), stencils.end(),
+                                         ranges[i].first),
+                last = std::lower_bound(first, stencils.end(),
+                                        ranges[i].second);
+            if (first == last) continue;
+
+            rangeStencils.clear();
+            for ( ; first != last; ++first) {
+                rangeStencils.push_back(*first - ranges[i].first);
+            }
 
-            options.interpolationMode =
-                Far::StencilTableFactory::INTERPOLATE_VARYING;
+            BufferDescriptor dstDesc(srcDesc);
+            dstDesc.offset +=
+                (numControlVertices + ranges[i].first) * dstDesc.stride;
 
-            varyingStencils = Far::StencilTableFactory::Create(*_refiner,
-                                                               options);
+            Evaluator const *instance = GetEvaluator<Evaluator>(
+                _evaluatorCache, srcDesc, dstDesc,
+                _deviceContext);
+
+            Evaluator::EvalStencils(buffer, srcDesc,
+                                    buffer, dstDesc,
+                                    tables[i],
+                                    &rangeStencils[0],
+                                    (int)rangeStencils.size(),
+                                    instance, _deviceContext);
         }
+    }
 
-        Far::PatchTableFactory::Options poptions(level);
-        poptions.generateFVarTables = bits.test(MeshFVarData);
-        poptions.generateFVarLegacyLinearPatches = !bits.test(MeshFVarAdaptive);
-        poptions.generateLegacySharpCornerPatches = !bits.test(MeshUseSmoothCornerPatch);
-        poptions.useSingleCreasePatch = bits.test(MeshUseSingleCreasePatch);
-        poptions.useInfSharpPatch = bits.test(MeshUseInfSharpPatch);
+    // The buffer last refined is drawn until the next buffer of the ring
+    // is written (see advanceBuffers())
+    void publishBuffers() {
+        if (_vertexBuffers.size() == 1) return;
 
-        // points on bilinear and gregory basis endcap boundaries can be
-        // shared among adjacent patches to save some stencils.
-        if (bits.test(MeshEndCapBilinearBasis)) {
-            poptions.SetEndCapType(
-                Far::PatchTableFactory::Options::ENDCAP_BILINEAR_BASIS);
-            poptions.shareEndCapPatchPoints = true;
-        } else if (bits.test(MeshEndCapBSplineBasis)) {
-            poptions.SetEndCapType(
-                Far::PatchTableFactory::Options::ENDCAP_BSPLINE_BASIS);
-        } else if (bits.test(MeshEndCapGregoryBasis)) {
-            poptions.SetEndCapType(
-                Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
-            poptions.shareEndCapPatchPoints = true;
-        } else if (bits.test(MeshEndCapLegacyGregory)) {
-            poptions.SetEndCapType(
-                Far::PatchTableFactory::Options::ENDCAP_LEGACY_GREGORY);
+        _drawBuffer = _writeBuffer;
+        _drawBufferPending = true;
+    }
+
+    // Fences the buffer drawn and moves on to the next buffer of the ring,
+    // once released by the device, restoring its control values
+    void advanceBuffers() {
+        if (!_drawBufferPending) return;
+        _drawBufferPending = false;
+
+        // the commands drawing the buffer have all been issued by now
+        _bufferFences[_drawBuffer] = BufferFence::Insert(_deviceContext);
+
+        _writeBuffer = (_writeBuffer + 1) % (int)_vertexBuffers.size();
+        if (_bufferFences[_writeBuffer]) {
+            BufferFence::Wait(_bufferFences[_writeBuffer], _deviceContext);
+            _bufferFences[_writeBuffer] = typename BufferFence::Type();
         }
 
-        _farPatchTable = Far::PatchTableFactory::Create(*_refiner, poptions);
+        _vertexBuffer = _vertexBuffers[_writeBuffer];
+        _varyingBuffer = _varyingBuffers[_writeBuffer];
 
-        // if there's endcap stencils, merge it into regular stencils.
-        if (_farPatchTable->GetLocalPointStencilTable()) {
-            // append stencils
-            if (Far::StencilTable const *vertexStencilsWithLocalPoints =
-                Far::StencilTableFactory::AppendLocalPointStencilTable(
-                    *_refiner,
-                    vertexStencils,
-                    _farPatchTable->GetLocalPointStencilTable())) {
-                delete vertexStencils;
-                vertexStencils = vertexStencilsWithLocalPoints;
-            }
-            if (varyingStencils) {
-                if (Far::StencilTable const *varyingStencilsWithLocalPoints =
-                    Far::StencilTableFactory::AppendLocalPointStencilTable(
-                        *_refiner,
-                        varyingStencils,
-                        _farPatchTable->GetLocalPointVaryingStencilTable())) {
-                    delete varyingStencils;
-                    varyingStencils = varyingStencilsWithLocalPoints;
-                }
-            }
+        int numControlVertices = _numControlVertices;
+        if (!_controlVertexValues.empty()) {
+            _vertexBuffer->UpdateData(&_controlVertexValues[0],
+                                      0, numControlVertices, _deviceContext);
+        }
+        if (!_controlVaryingValues.empty()) {
+            _varyingBuffer->UpdateData(&_controlVaryingValues[0],
+                                       0, numControlVertices, _deviceContext);
+        }
+    }
+
+    VertexBuffer * createBuffer(VertexBuffer const * buffer) {
+        return buffer ? VertexBuffer::Create(buffer->GetNumElements(),
+                                             _numVertices, _deviceContext)
+                      : NULL;
+    }
+
+    static void deleteStencilTables(
+        std::vector<StencilTable const *> & tables) {
+        for (int i = 0; i < (int)tables.size(); ++i) {
+            delete tables[i];
+        }
+        tables.clear();
+    }
+
+    void initialize(MeshFarData & farData) {
+
+        int numVertexElements = farData._numVertexElements;
+        int numVaryingElements = farData._numVaryingElements;
+        MeshBitset bits = farData._bits;
+
+        _detectUnchangedInputs = bits.test(MeshDetectUnchangedInputs);
+
+        int vertexBufferStride = numVertexElements +
+            (bits.test(MeshInterleaveVarying) ? numVaryingElements : 0);
+        int varyingBufferStride =
+            (bits.test(MeshInterleaveVarying) ? 0 : numVaryingElements);
+
+        initializeContext(farData);
+
+        initializeVertexBuffers(_numVertices,
+                                vertexBufferStride,
+                                varyingBufferStride);
+
+        // configure vertex buffer descriptor
+        _vertexDesc =
+            BufferDescriptor(0, numVertexElements, vertexBufferStride);
+        if (bits.test(MeshInterleaveVarying)) {
+            _varyingDesc = BufferDescriptor(
+                numVertexElements, numVaryingElements, vertexBufferStride);
+        } else {
+            _varyingDesc = BufferDescriptor(
+                0, numVaryingElements, varyingBufferStride);
         }
+    }
+
+    void initializeContext(MeshFarData & farData) {
+
+        OPENSUBDIV_TRACE_SCOPE("mesh.initialize");
+
+        // take ownership of the refiner and the patch table
+        _refiner = farData._refiner;
+        _farPatchTable = farData._farPatchTable;
+        farData._refiner = NULL;
+        farData._farPatchTable = NULL;
+
+        Far::StencilTable const * vertexStencils = farData._vertexStencils;
+        Far::StencilTable const * varyingStencils = farData._varyingStencils;
 
         _maxValence = _farPatchTable->GetMaxValence();
         _patchTable = PatchTable::Create(_farPatchTable, _deviceContext);
 
         // numvertices = coarse verts + refined verts + gregory basis verts
-        _numVertices = vertexStencils->GetNumControlVertices()
-            + vertexStencils->GetNumStencils();
+        _numControlVertices = vertexStencils->GetNumControlVertices();
+        _numVertices = _numControlVertices + vertexStencils->GetNumStencils();
 
         // convert to device stenciltable if necessary.
-        _vertexStencilTable =
-            convertToCompatibleStencilTable<StencilTable>(
-            vertexStencils, _deviceContext);
-        _varyingStencilTable =
-            convertToCompatibleStencilTable<StencilTable>(
-            varyingStencils, _deviceContext);
+        _stencilRanges = farData._stencilRanges;
+        convertToCompatibleStencilTables<StencilTable>(
+            vertexStencils, _stencilRanges, _deviceContext,
+            _vertexStencilTables);
+        convertToCompatibleStencilTables<StencilTable>(
+            varyingStencils, _stencilRanges, _deviceContext,
+            _varyingStencilTables);
+
+        if (farData._bits.test(MeshStencilDependencies)) {
+            _vertexDependencies =
+                new Far::StencilDependencies(*vertexStencils);
+        }
 
-        // FIXME: we do extra copyings for Far::Stencils.
-        delete vertexStencils;
-        delete varyingStencils;
+        int numFVarChannels = (int)farData._fvarStencils.size();
+        _fvarStencilTables.resize(numFVarChannels);
+        _fvarStencilRanges = farData._fvarStencilRanges;
+        _fvarNumControlValues.resize(numFVarChannels, 0);
+        _fvarNumValues.resize(numFVarChannels, 0);
+        _fvarBuffers.resize(numFVarChannels, NULL);
+        _fvarDescs.resize(numFVarChannels);
+        for (int channel = 0; channel < numFVarChannels; ++channel) {
+            Far::StencilTable const * fvarStencils =
+                farData._fvarStencils[channel];
+            _fvarNumControlValues[channel] =
+                fvarStencils->GetNumControlVertices();
+            _fvarNumValues[channel] = _fvarNumControlValues[channel]
+                + fvarStencils->GetNumStencils();
+            convertToCompatibleStencilTables<StencilTable>(
+                fvarStencils, _fvarStencilRanges[channel], _deviceContext,
+                _fvarStencilTables[channel]);
+        }
+
+        // FIXME: we do extra copyings for Far::Stencils (released with
+        //        the MeshFarData)
     }
 
     void initializeVertexBuffers(int numVertices,
@@ -691,26 +1823,61 @@ private:
             _varyingBuffer = VertexBuffer::Create(numVaryingElements,
                                                   numVertices, _deviceContext);
         }
+
+        _vertexBuffers.assign(1, _vertexBuffer);
+        _varyingBuffers.assign(1, _varyingBuffer);
+        _bufferFences.assign(1, typename BufferFence::Type());
     }
 
     Far::TopologyRefiner * _refiner;
     Far::PatchTable * _farPatchTable;
 
+    int _numControlVertices;
     int _numVertices;
     int _maxValence;
 
+    // buffers of the ring written next (see SetNumVertexBuffers())
     VertexBuffer * _vertexBuffer;
     VertexBuffer * _varyingBuffer;
 
     BufferDescriptor _vertexDesc;
     BufferDescriptor _varyingDesc;
 
-    StencilTable const * _vertexStencilTable;
-    StencilTable const * _varyingStencilTable;
+    // reverse index of the vertex stencils (with MeshStencilDependencies)
+    Far::StencilDependencies const * _vertexDependencies;
+
+    // device stencil tables of each range of stencils
+    std::vector<StencilTable const *> _vertexStencilTables;
+    std::vector<StencilTable const *> _varyingStencilTables;
+    MeshFarData::StencilRanges _stencilRanges;
     EvaluatorCache * _evaluatorCache;
 
+    std::vector<std::vector<StencilTable const *> > _fvarStencilTables;
+    std::vector<MeshFarData::StencilRanges> _fvarStencilRanges;
+    std::vector<int> _fvarNumControlValues;
+    std::vector<int> _fvarNumValues;
+    std::vector<VertexBuffer *> _fvarBuffers;
+    std::vector<BufferDescriptor> _fvarDescs;
+
     PatchTable *_patchTable;
     DeviceContext *_deviceContext;
+
+    // ring of vertex buffers, written in turn by the refinements while the
+    // buffer last refined is drawn
+    std::vector<VertexBuffer *> _vertexBuffers;
+    std::vector<VertexBuffer *> _varyingBuffers;
+    std::vector<typename BufferFence::Type> _bufferFences;
+    int _writeBuffer;
+    int _drawBuffer;
+    bool _drawBufferPending;
+
+    // change detection: the inputs are refined when their version differs
+    // from the version last refined
+    bool _detectUnchangedInputs;
+    std::vector<float> _controlVertexValues;
+    std::vector<float> _controlVaryingValues;
+    unsigned int _inputVersion;
+    unsigned int _refinedVersion;
 };
 
 } // end namespace Osd
@@ -0,0 +1,389 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_OSD_MESH_INSTANCE_SET_H
+#define OPENSUBDIV3_OSD_MESH_INSTANCE_SET_H
+
+#include "../version.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "../osd/mesh.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+/// \brief N instances of one refined topology, each with its own vertex data
+///
+/// MeshInstanceSet shares a single patch table, vertex stencil table and
+/// evaluator among all its instances (e.g. for crowds or vegetation) and
+/// stores their vertices in a single buffer, interleaved per vertex:
+///
+///     [ vertex 0: instance 0, instance 1, ... ][ vertex 1: ... ] ...
+///
+/// Since stencils combine all the elements of a vertex alike, all the
+/// instances are then refined by a single stencil evaluation per Refine(),
+/// as if they were one primvar of numInstances * numVertexElements
+/// elements. The primvar of an instance is described by
+/// GetInstanceDescriptor(), e.g. to bind it for drawing with the stride
+/// of the interleaved vertices.
+///
+/// Note that the GPU kernels are compiled for the interleaved length, so
+/// very large instance counts are better split among several sets.
+///
+template <typename VERTEX_BUFFER,
+          typename STENCIL_TABLE,
+          typename EVALUATOR,
+          typename PATCH_TABLE,
+          typename DEVICE_CONTEXT = void>
+class MeshInstanceSet {
+public:
+    typedef VERTEX_BUFFER VertexBuffer;
+    typedef EVALUATOR Evaluator;
+    typedef STENCIL_TABLE StencilTable;
+    typedef PATCH_TABLE PatchTable;
+    typedef DEVICE_CONTEXT DeviceContext;
+    typedef EvaluatorCacheT<Evaluator> EvaluatorCache;
+    typedef typename PatchTable::VertexBufferBinding VertexBufferBinding;
+
+    /// \brief Constructor
+    ///
+    /// @param refiner            topology refiner, owned by this class
+    ///
+    /// @param numInstances       number of instances
+    ///
+    /// @param numVertexElements  number of vertex primvar elements of each
+    ///                           instance
+    ///
+    /// @param level              refinement level
+    ///
+    /// @param bits               MeshBits options (varying and face-varying
+    ///                           data are not supported)
+    ///
+    /// @param evaluatorCache     evaluator cache (or NULL)
+    ///
+    /// @param deviceContext      device context (or NULL)
+    ///
+    MeshInstanceSet(Far::TopologyRefiner * refiner,
+                    int numInstances,
+                    int numVertexElements,
+                    int level,
+                    MeshBitset bits = MeshBitset(),
+                    EvaluatorCache * evaluatorCache = NULL,
+                    DeviceContext * deviceContext = NULL) :
+
+            _refiner(NULL),
+            _farPatchTable(NULL),
+            _numInstances(numInstances),
+            _numControlVertices(0),
+            _numVertices(0),
+            _maxValence(0),
+            _vertexBuffer(NULL),
+            _evaluatorCache(evaluatorCache),
+            _patchTable(NULL),
+            _deviceContext(deviceContext) {
+
+        assert(refiner && numInstances > 0 && numVertexElements > 0);
+
+        MeshFarData farData(refiner, numVertexElements, 0, level, bits);
+
+        initialize(farData);
+    }
+
+    /// \brief Constructs the set from device independent data, typically
+    ///        built on another thread (see MeshFarData), with no varying
+    ///        elements.
+    ///
+    /// @param farData         device independent data, deleted by this
+    ///                        constructor
+    ///
+    /// @param numInstances    number of instances
+    ///
+    /// @param evaluatorCache  evaluator cache (or NULL)
+    ///
+    /// @param deviceContext   device context (or NULL)
+    ///
+    MeshInstanceSet(MeshFarData * farData,
+                    int numInstances,
+                    EvaluatorCache * evaluatorCache = NULL,
+                    DeviceContext * deviceContext = NULL) :
+
+            _refiner(NULL),
+            _farPatchTable(NULL),
+            _numInstances(numInstances),
+            _numControlVertices(0),
+            _numVertices(0),
+            _maxValence(0),
+            _vertexBuffer(NULL),
+            _evaluatorCache(evaluatorCache),
+            _patchTable(NULL),
+            _deviceContext(deviceContext) {
+
+        assert(farData && numInstances > 0);
+
+        initialize(*farData);
+
+        delete farData;
+    }
+
+    ~MeshInstanceSet() {
+        delete _refiner;
+        delete _farPatchTable;
+        delete _vertexBuffer;
+        for (int i = 0; i < (int)_vertexStencilTables.size(); ++i) {
+            delete _vertexStencilTables[i];
+        }
+        delete _patchTable;
+        // deviceContext and evaluatorCache are not owned by this class.
+    }
+
+    /// \brief Updates the interleaved vertices of all the instances
+    ///
+    /// @param vertexData   numVerts vertices, each with the elements of all
+    ///                     the instances in order
+    ///
+    /// @param startVertex  index of the first vertex to update
+    ///
+    /// @param numVerts     number of vertices to update
+    ///
+    void UpdateVertexBuffer(float const *vertexData,
+                            int startVertex, int numVerts) {
+        _vertexBuffer->UpdateData(vertexData, startVertex, numVerts,
+                                  _deviceContext);
+    }
+
+    /// \brief Updates the control vertices of a single instance. The data
+    ///        is staged and uploaded for all the instances on the next
+    ///        Refine().
+    ///
+    /// @param instance     index of the instance
+    ///
+    /// @param vertexData   numVerts vertices of numVertexElements elements
+    ///
+    /// @param startVertex  index of the first control vertex to update
+    ///
+    /// @param numVerts     number of control vertices to update
+    ///
+    void UpdateInstanceVertexBuffer(int instance, float const *vertexData,
+                                    int startVertex, int numVerts) {
+        assert(instance >= 0 && instance < _numInstances);
+        assert(startVertex >= 0 &&
+               startVertex + numVerts <= getNumControlVertices());
+
+        int length = _instanceDesc.length;
+        float *dst = &_stagedControlVertices[
+            startVertex * _vertexDesc.stride + instance * length];
+        for (int i = 0; i < numVerts; ++i) {
+            std::memcpy(dst, vertexData, length * sizeof(float));
+            dst += _vertexDesc.stride;
+            vertexData += length;
+        }
+
+        int endVertex = startVertex + numVerts;
+        if (_stagedBegin < _stagedEnd) {
+            _stagedBegin = std::min(_stagedBegin, startVertex);
+            _stagedEnd = std::max(_stagedEnd, endVertex);
+        } else {
+            _stagedBegin = startVertex;
+            _stagedEnd = endVertex;
+        }
+    }
+
+    /// \brief Uploads the staged control vertices (if any) and refines the
+    ///        vertices of all the instances with a single stencil evaluation
+    ///        (per level with MeshMultiLevelStencils)
+    void Refine() {
+
+        OPENSUBDIV_TRACE_SCOPE("mesh.refine");
+
+        if (_stagedBegin < _stagedEnd) {
+            UpdateVertexBuffer(
+                &_stagedControlVertices[_stagedBegin * _vertexDesc.stride],
+                _stagedBegin, _stagedEnd - _stagedBegin);
+            _stagedBegin = _stagedEnd = 0;
+        }
+
+        int numControlVertices = getNumControlVertices();
+
+        BufferDescriptor srcDesc = _vertexDesc;
+
+        for (int i = 0; i < (int)_vertexStencilTables.size(); ++i) {
+            BufferDescriptor dstDesc(srcDesc);
+            dstDesc.offset +=
+                (numControlVertices + _stencilRanges[i].first) *
+                dstDesc.stride;
+
+            // note that the _evaluatorCache can be NULL and thus
+            // the evaluatorInstance can be NULL
+            //  (for uninstantiatable kernels CPU,TBB etc)
+            Evaluator const *instance = GetEvaluator<Evaluator>(
+                _evaluatorCache, srcDesc, dstDesc,
+                _deviceContext);
+
+            Evaluator::EvalStencils(_vertexBuffer, srcDesc,
+                                    _vertexBuffer, dstDesc,
+                                    _vertexStencilTables[i],
+                                    instance, _deviceContext);
+        }
+    }
+
+    void Synchronize() {
+        OPENSUBDIV_TRACE_SCOPE("mesh.synchronize");
+        Evaluator::Synchronize(_deviceContext);
+    }
+
+    /// Returns the number of instances
+    int GetNumInstances() const { return _numInstances; }
+
+    /// Returns the number of vertices of each instance
+    int GetNumVertices() const { return _numVertices; }
+
+    int GetMaxValence() const { return _maxValence; }
+
+    /// \brief Returns the descriptor of the primvar of an instance in the
+    ///        vertex buffer
+    BufferDescriptor GetInstanceDescriptor(int instance) const {
+        BufferDescriptor desc(_instanceDesc);
+        desc.offset += instance * desc.length;
+        return desc;
+    }
+
+    /// Returns the descriptor of the interleaved primvars of all the
+    /// instances in the vertex buffer
+    BufferDescriptor const & GetVertexDescriptor() const {
+        return _vertexDesc;
+    }
+
+    PatchTable * GetPatchTable() const {
+        return _patchTable;
+    }
+
+    Far::PatchTable const *GetFarPatchTable() const {
+        return _farPatchTable;
+    }
+
+    Far::TopologyRefiner const * GetTopologyRefiner() const {
+        return _refiner;
+    }
+
+    VertexBufferBinding BindVertexBuffer() {
+        return _vertexBuffer->BindVBO(_deviceContext);
+    }
+
+    VertexBuffer * GetVertexBuffer() {
+        return _vertexBuffer;
+    }
+
+private:
+    //  Non-copyable:
+    MeshInstanceSet(MeshInstanceSet const &);
+    MeshInstanceSet & operator=(MeshInstanceSet const &);
+
+    int getNumControlVertices() const {
+        return _numControlVertices;
+    }
+
+    void initialize(MeshFarData & farData) {
+
+        OPENSUBDIV_TRACE_SCOPE("mesh.initialize");
+
+        assert(farData._vertexStencils);
+
+        // take ownership of the refiner and the patch table
+        _refiner = farData._refiner;
+        _farPatchTable = farData._farPatchTable;
+        farData._refiner = NULL;
+        farData._farPatchTable = NULL;
+
+        Far::StencilTable const * vertexStencils = farData._vertexStencils;
+
+        _maxValence = _farPatchTable->GetMaxValence();
+        _patchTable = PatchTable::Create(_farPatchTable, _deviceContext);
+
+        // numvertices = coarse verts + refined verts + gregory basis verts
+        _numControlVertices = vertexStencils->GetNumControlVertices();
+        _numVertices = _numControlVertices + vertexStencils->GetNumStencils();
+
+        // convert to device stenciltable if necessary.
+        _stencilRanges = farData._stencilRanges;
+        convertToCompatibleStencilTables<StencilTable>(
+            vertexStencils, _stencilRanges, _deviceContext,
+            _vertexStencilTables);
+
+        // all the instances interleaved in each vertex
+        int numVertexElements = farData._numVertexElements;
+        int vertexBufferStride = numVertexElements * _numInstances;
+
+        _vertexBuffer = VertexBuffer::Create(vertexBufferStride,
+                                             _numVertices, _deviceContext);
+
+        _vertexDesc =
+            BufferDescriptor(0, vertexBufferStride, vertexBufferStride);
+        _instanceDesc =
+            BufferDescriptor(0, numVertexElements, vertexBufferStride);
+
+        _stagedControlVertices.resize(
+            getNumControlVertices() * vertexBufferStride, 0.0f);
+        _stagedBegin = _stagedEnd = 0;
+    }
+
+    Far::TopologyRefiner * _refiner;
+    Far::PatchTable * _farPatchTable;
+
+    int _numInstances;
+    int _numControlVertices;
+    int _numVertices;
+    int _maxValence;
+
+    VertexBuffer * _vertexBuffer;
+
+    BufferDescriptor _vertexDesc;
+    BufferDescriptor _instanceDesc;
+
+    std::vector<float> _stagedControlVertices;
+    int _stagedBegin;
+    int _stagedEnd;
+
+    // device stencil tables of each range of stencils
+    std::vector<StencilTable const *> _vertexStencilTables;
+    MeshFarData::StencilRanges _stencilRanges;
+    EvaluatorCache * _evaluatorCache;
+
+    PatchTable *_patchTable;
+    DeviceContext *_deviceContext;
+};
+
+} // end namespace Osd
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_MESH_INSTANCE_SET_H
@@ -133,6 +133,15 @@ static id<MTLBuffer> createBuffer(const std::vector<T> &vec,
 #endif
 }
 
+#ifdef OPENSUBDIV_64BIT_OFFSETS
+// The kernels address the stencil tables with 32-bit offsets
+static id<MTLBuffer> createBuffer(const std::vector<OpenSubdiv::Far::Offset> &vec,
+                                      MTLContext* context)
+{
+    return createBuffer(std::vector<int>(vec.begin(), vec.end()), context);
+}
+#endif
+
 using namespace OpenSubdiv::OPENSUBDIV_VERSION;
 using namespace Osd;
 
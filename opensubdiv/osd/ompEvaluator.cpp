@@ -24,6 +24,8 @@
 
 #include "../osd/ompEvaluator.h"
 #include "../osd/ompKernel.h"
+#include "../osd/cpuKernel.h"
+#include "../far/trace.h"
 #include "../osd/patchBasisCommonTypes.h"
 #include "../osd/patchBasisCommon.h"
 #include "../osd/patchBasisCommonEval.h"
@@ -40,11 +42,13 @@ OmpEvaluator::EvalStencils(
     const float *src, BufferDescriptor const &srcDesc,
     float *dst,       BufferDescriptor const &dstDesc,
     const int * sizes,
-    const int * offsets,
+    const Far::Offset * offsets,
     const int * indices,
     const float * weights,
     int start, int end) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.omp");
+
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
 
@@ -63,13 +67,15 @@ OmpEvaluator::EvalStencils(
     float *du,        BufferDescriptor const &duDesc,
     float *dv,        BufferDescriptor const &dvDesc,
     const int * sizes,
-    const int * offsets,
+    const Far::Offset * offsets,
     const int * indices,
     const float * weights,
     const float * duWeights,
     const float * dvWeights,
     int start, int end) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.omp");
+
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
     if (srcDesc.length != duDesc.length) return false;
@@ -97,7 +103,7 @@ OmpEvaluator::EvalStencils(
     float *duv,       BufferDescriptor const &duvDesc,
     float *dvv,       BufferDescriptor const &dvvDesc,
     const int * sizes,
-    const int * offsets,
+    const Far::Offset * offsets,
     const int * indices,
     const float * weights,
     const float * duWeights,
@@ -107,6 +113,8 @@ OmpEvaluator::EvalStencils(
     const float * dvvWeights,
     int start, int end) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.omp");
+
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
     if (srcDesc.length != duDesc.length) return false;
@@ -160,6 +168,45 @@ struct BufferAdapter {
     int _stride;
 };
 
+/* static */
+bool
+OmpEvaluator::EvalStencils(StencilEvalJob const * jobs, int numJobs) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.omp");
+
+    for (int i = 0; i < numJobs; ++i) {
+        if (jobs[i].srcDesc.length != jobs[i].dstDesc.length) return false;
+    }
+
+    OmpEvalStencils(jobs, numJobs);
+
+    return true;
+}
+
+/* static */
+bool
+OmpEvaluator::EvalStencils(PrimvarBinding const * bindings, int numBindings,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const float * weights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.omp");
+
+    if (end <= start) return true;
+    for (int b = 0; b < numBindings; ++b) {
+        if (bindings[b].srcDesc.length != bindings[b].dstDesc.length) {
+            return false;
+        }
+    }
+
+    OmpEvalStencils(bindings, numBindings, sizes, offsets, indices, weights,
+                    start, end);
+
+    return true;
+}
+
 /* static */
 bool
 OmpEvaluator::EvalPatches(
@@ -176,8 +223,14 @@ OmpEvaluator::EvalPatches(
     else return false;
     BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
 
-#pragma omp parallel for
+    OmpEvalScope scope(OmpEvalScope::PATCHES);
+    int numThreads = scope.GetNumThreads();
+
+#pragma omp parallel for schedule(runtime) num_threads(numThreads)
     for (int i = 0; i < numPatchCoords; ++i) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.omp");
+
         BufferAdapter<float> dstT(dst + dstDesc.stride*i, dstDesc.length, dstDesc.stride);
 
         float wP[20];
@@ -222,6 +275,8 @@ OmpEvaluator::EvalPatches(
     const int *patchIndexBuffer,
     PatchParam const *patchParamBuffer) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.omp");
+
     src += srcDesc.offset;
     if (dst) dst += dstDesc.offset;
     if (du)  du += duDesc.offset;
@@ -229,7 +284,10 @@ OmpEvaluator::EvalPatches(
 
     BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
 
-#pragma omp parallel for
+    OmpEvalScope scope(OmpEvalScope::PATCHES);
+    int numThreads = scope.GetNumThreads();
+
+#pragma omp parallel for schedule(runtime) num_threads(numThreads)
     for (int i = 0; i < numPatchCoords; ++i) {
         float wP[20], wDu[20], wDv[20];
         BufferAdapter<float> dstT(dst + dstDesc.stride*i, dstDesc.length, dstDesc.stride);
@@ -287,6 +345,8 @@ OmpEvaluator::EvalPatches(
     const int *patchIndexBuffer,
     PatchParam const *patchParamBuffer) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.omp");
+
     src += srcDesc.offset;
     if (dst) dst += dstDesc.offset;
     if (du)  du += duDesc.offset;
@@ -297,7 +357,10 @@ OmpEvaluator::EvalPatches(
 
     BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
 
-#pragma omp parallel for
+    OmpEvalScope scope(OmpEvalScope::PATCHES);
+    int numThreads = scope.GetNumThreads();
+
+#pragma omp parallel for schedule(runtime) num_threads(numThreads)
     for (int i = 0; i < numPatchCoords; ++i) {
         float wP[20], wDu[20], wDv[20], wDuu[20], wDuv[20], wDvv[20];
         BufferAdapter<float> dstT(dst + dstDesc.stride*i, dstDesc.length, dstDesc.stride);
@@ -364,6 +427,32 @@ OmpEvaluator::SetNumThreads(int numThreads) {
     omp_set_num_threads(numThreads);
 }
 
+/* static */
+void
+OmpEvaluator::SetStencilEvalOptions(StencilEvalOptions const &options) {
+    OmpSetStencilEvalOptions(options.schedule, options.chunkSize,
+                             options.numThreads, options.balanceBySize);
+}
+
+/* static */
+void
+OmpEvaluator::SetPatchEvalOptions(PatchEvalOptions const &options) {
+    OmpSetPatchEvalOptions(options.schedule, options.chunkSize,
+                           options.numThreads);
+}
+
+/* static */
+void
+OmpEvaluator::SetReproducible(bool reproducible) {
+    CpuSetReproducible(reproducible);
+}
+
+/* static */
+bool
+OmpEvaluator::IsReproducible() {
+    return CpuIsReproducible();
+}
+
 }  // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
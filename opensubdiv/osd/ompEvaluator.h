@@ -122,7 +122,7 @@ public:
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
         const int * sizes,
-        const int * offsets,
+        const Far::Offset * offsets,
         const int * indices,
         const float * weights,
         int start, int end);
@@ -237,7 +237,7 @@ public:
         float *du,        BufferDescriptor const &duDesc,
         float *dv,        BufferDescriptor const &dvDesc,
         const int * sizes,
-        const int * offsets,
+        const Far::Offset * offsets,
         const int * indices,
         const float * weights,
         const float * duWeights,
@@ -405,7 +405,7 @@ public:
         float *duv,       BufferDescriptor const &duvDesc,
         float *dvv,       BufferDescriptor const &dvvDesc,
         const int * sizes,
-        const int * offsets,
+        const Far::Offset * offsets,
         const int * indices,
         const float * weights,
         const float * duWeights,
@@ -415,6 +415,89 @@ public:
         const float * dvvWeights,
         int start, int end);
 
+    /// \brief Batched stencil evaluation of several meshes
+    ///
+    /// Evaluates the stencils of all jobs in a single parallel dispatch. Each
+    /// job has its own buffers and stencil table, so that many small meshes
+    /// can be evaluated together without paying the dispatch overhead of one
+    /// EvalStencils() call per mesh.
+    ///
+    /// @param jobs           array of stencil evaluation jobs
+    ///
+    /// @param numJobs        number of jobs
+    ///
+    /// @return               false if the descriptors of any job mismatch, in
+    ///                       which case no job is evaluated
+    ///
+    static bool EvalStencils(StencilEvalJob const * jobs, int numJobs);
+
+    /// \brief Static eval stencils function applying the stencils of a table
+    ///        to several primvars in a single pass (see PrimvarBinding)
+    ///
+    /// @param bindings       array of primvar bindings, with raw CPU pointers
+    ///
+    /// @param numBindings    number of primvar bindings
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param instance       not used in the omp kernel
+    ///                       (declared as a typed pointer to prevent
+    ///                        undesirable template resolution)
+    ///
+    /// @param deviceContext  not used in the omp kernel
+    ///
+    template <typename STENCIL_TABLE>
+    static bool EvalStencils(
+        PrimvarBinding const * bindings, int numBindings,
+        STENCIL_TABLE const *stencilTable,
+        const OmpEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalStencils(bindings, numBindings,
+                            &stencilTable->GetSizes()[0],
+                            &stencilTable->GetOffsets()[0],
+                            &stencilTable->GetControlIndices()[0],
+                            &stencilTable->GetWeights()[0],
+                            /*start = */ 0,
+                            /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function applying the stencils to several
+    ///        primvars in a single pass, which takes raw CPU pointers
+    ///
+    /// @param bindings       array of primvar bindings
+    ///
+    /// @param numBindings    number of primvar bindings
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    /// @return               false if the descriptors of any binding
+    ///                       mismatch, in which case nothing is evaluated
+    ///
+    static bool EvalStencils(
+        PrimvarBinding const * bindings, int numBindings,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        int start, int end);
+
     /// ----------------------------------------------------------------------
     ///
     ///   Limit evaluations with PatchTable
@@ -1226,6 +1309,81 @@ public:
     static void Synchronize(void *deviceContext = NULL);
 
     static void SetNumThreads(int numThreads);
+
+    /// \brief Enables or disables reproducible evaluation, shared with
+    ///        CpuEvaluator (see CpuEvaluator::SetReproducible())
+    static void SetReproducible(bool reproducible);
+
+    /// \brief Returns true if reproducible evaluation is enabled
+    static bool IsReproducible();
+
+    /// \brief The OpenMP schedule of the loops of an evaluation
+    enum Schedule {
+        SCHEDULE_STATIC,    ///< schedule(static) (default)
+        SCHEDULE_DYNAMIC,   ///< schedule(dynamic)
+        SCHEDULE_GUIDED     ///< schedule(guided)
+    };
+
+    /// \brief Options controlling how EvalStencils distributes stencils
+    ///        among threads
+    ///
+    /// Stencils vary in size (e.g. those of the points of Gregory patches
+    /// around extraordinary vertices are much larger than the others), so a
+    /// static schedule may balance them poorly.  Either the chunks can be
+    /// scheduled dynamically, or, when balanceBySize is set, the stencils are
+    /// split into a single contiguous range per thread of about the same
+    /// total size, which balances the threads without the overhead of a
+    /// dynamic schedule.
+    ///
+    /// The number of threads applies to each call, without changing the
+    /// number of threads of the other parallel regions of the caller (as
+    /// SetNumThreads() does).
+    ///
+    struct StencilEvalOptions {
+
+        StencilEvalOptions() :
+            schedule(SCHEDULE_STATIC),
+            balanceBySize(false),
+            chunkSize(0),
+            numThreads(0) { }
+
+        unsigned int schedule      : 2, ///< schedule of the chunks
+                     balanceBySize : 1; ///< a range of stencils of equal
+                                        ///< total size per thread
+        int          chunkSize;         ///< stencils per chunk (0 for the
+                                        ///< default of the kernels)
+        int          numThreads;        ///< threads of each call (0 for
+                                        ///< omp_get_max_threads())
+    };
+
+    /// \brief Set the options used by all subsequent EvalStencils calls
+    ///
+    /// @param options         the new options
+    ///
+    static void SetStencilEvalOptions(StencilEvalOptions const &options);
+
+    /// \brief Options controlling how EvalPatches distributes PatchCoords
+    ///        among threads
+    ///
+    struct PatchEvalOptions {
+
+        PatchEvalOptions() :
+            schedule(SCHEDULE_STATIC),
+            chunkSize(0),
+            numThreads(0) { }
+
+        unsigned int schedule : 2;      ///< schedule of the chunks
+        int          chunkSize;         ///< coords per chunk (0 for the
+                                        ///< default of the schedule)
+        int          numThreads;        ///< threads of each call (0 for
+                                        ///< omp_get_max_threads())
+    };
+
+    /// \brief Set the options used by all subsequent EvalPatches calls
+    ///
+    /// @param options         the new options
+    ///
+    static void SetPatchEvalOptions(PatchEvalOptions const &options);
 };
 
 
@@ -23,8 +23,11 @@
 //
 
 #include "../osd/ompKernel.h"
+#include "../osd/cpuKernel.h"
+#include "../osd/types.h"
 #include "../osd/bufferDescriptor.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <omp.h>
@@ -69,6 +72,158 @@ copy(float *dst, int dstIndex, const float *src,
     memcpy(dst, src, desc.length*sizeof(float));
 }
 
+//
+//  Scheduling of stencil and patch evaluation -- the schedule and number of
+//  threads of the loops, and whether the stencils are split into a range of
+//  about the same total size per thread (see OmpEvaluator::StencilEvalOptions
+//  and PatchEvalOptions):
+//
+namespace {
+    struct EvalOptions {
+        omp_sched_t schedule;
+        int         chunkSize;
+        int         numThreads;
+        bool        balanceBySize;
+    };
+
+    EvalOptions stencilEvalOptions = { omp_sched_static, 0, 0, false };
+    EvalOptions patchEvalOptions   = { omp_sched_static, 0, 0, false };
+
+    omp_sched_t
+    getSchedule(int schedule) {
+        switch (schedule) {
+            case 1:  return omp_sched_dynamic;
+            case 2:  return omp_sched_guided;
+            default: return omp_sched_static;
+        }
+    }
+
+    //  Evaluates the stencils [start, end) by ranges: of rangeSize stencils
+    //  (or chunkSize if set) distributed by the schedule of the scope, or
+    //  one per thread of stencils of about the same total size -- the offset
+    //  of each stencil being the total size of the preceding stencils:
+    template <class BODY>
+    void
+    runStencilRanges(int const * sizes, Far::Offset const * offsets,
+                     int start, int end, int rangeSize, int numThreads,
+                     BODY const &body) {
+
+        if (end <= start) return;
+
+        if (stencilEvalOptions.balanceBySize && numThreads > 1) {
+            Far::Offset first = offsets[start];
+            Far::Offset total = offsets[end - 1] + sizes[end - 1] - first;
+
+            std::vector<int> bounds(numThreads + 1, end);
+            bounds[0] = start;
+            for (int t = 1; t < numThreads; ++t) {
+                Far::Offset target = first +
+                    (Far::Offset)(((long long)total * t) / numThreads);
+                bounds[t] = (int)(std::lower_bound(offsets + start,
+                                                   offsets + end, target) -
+                                  offsets);
+            }
+
+#pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+            for (int t = 0; t < numThreads; ++t) {
+                if (bounds[t] < bounds[t + 1]) {
+                    body(bounds[t], bounds[t + 1]);
+                }
+            }
+            return;
+        }
+
+        if (stencilEvalOptions.chunkSize > 0) {
+            rangeSize = stencilEvalOptions.chunkSize;
+        }
+        int numRanges = (end - start + rangeSize - 1) / rangeSize;
+
+#pragma omp parallel for schedule(runtime) num_threads(numThreads)
+        for (int r = 0; r < numRanges; ++r) {
+            int first = start + r * rangeSize;
+            body(first, std::min(first + rangeSize, end));
+        }
+    }
+} // end namespace
+
+void
+OmpSetStencilEvalOptions(int schedule, int chunkSize, int numThreads,
+                         bool balanceBySize) {
+
+    stencilEvalOptions.schedule      = getSchedule(schedule);
+    stencilEvalOptions.chunkSize     = chunkSize;
+    stencilEvalOptions.numThreads    = numThreads;
+    stencilEvalOptions.balanceBySize = balanceBySize;
+}
+
+void
+OmpSetPatchEvalOptions(int schedule, int chunkSize, int numThreads) {
+
+    patchEvalOptions.schedule   = getSchedule(schedule);
+    patchEvalOptions.chunkSize  = chunkSize;
+    patchEvalOptions.numThreads = numThreads;
+}
+
+OmpEvalScope::OmpEvalScope(Kind kind) {
+
+    EvalOptions const & options =
+        (kind == STENCILS) ? stencilEvalOptions : patchEvalOptions;
+
+    _numThreads = (options.numThreads > 0) ? options.numThreads
+                                           : omp_get_max_threads();
+
+    omp_sched_t prevSchedule;
+    omp_get_schedule(&prevSchedule, &_prevChunkSize);
+    _prevSchedule = (int)prevSchedule;
+
+    //  the stencils are scheduled in ranges of chunkSize stencils, so only
+    //  the coords of patches are scheduled in chunks
+    omp_set_schedule(options.schedule,
+                     (kind == PATCHES) ? options.chunkSize : 0);
+}
+
+OmpEvalScope::~OmpEvalScope() {
+    omp_set_schedule((omp_sched_t)_prevSchedule, _prevChunkSize);
+}
+
+//
+// Evaluates blocks of stencils concurrently with the kernels specialized for
+// the primvar length, when all destinations have the length of the source --
+// returns false if no such kernel applies.  As in the generic kernels below,
+// the results of stencil (start + i) are written to element i.
+//
+template <int NUM_OUTPUTS> static bool
+evalFixedLengthStencils(float const * src, BufferDescriptor const &srcDesc,
+                        float * const * dsts,
+                        BufferDescriptor const * const * dstDescs,
+                        float const * const * weights,
+                        int const * sizes, Far::Offset const * offsets,
+                        int const * indices, int start, int end,
+                        int numThreads) {
+
+    int length = srcDesc.length;
+    if (length < 1 || length > 16) return false;
+    for (int d = 0; d < NUM_OUTPUTS; ++d) {
+        if (dstDescs[d]->length != length) return false;
+    }
+
+    runStencilRanges(sizes, offsets, start, end, 256, numThreads,
+                     [&](int first, int last) {
+
+        int count = last - first;
+        Far::Offset offset = offsets[first];
+
+        CpuStencilOutputs<NUM_OUTPUTS> out;
+        for (int d = 0; d < NUM_OUTPUTS; ++d) {
+            out.dst[d] = dsts[d] + (first - start) * dstDescs[d]->stride;
+            out.dstStride[d] = dstDescs[d]->stride;
+            out.weights[d] = weights[d] + offset;
+        }
+        ComputeFixedLengthStencils<NUM_OUTPUTS>(src, srcDesc.stride, length,
+            out, sizes + first, indices + offset, count);
+    });
+    return true;
+}
 
 // XXXX manuelk this should be optimized further by using SIMD - considering
 //              OMP is somewhat obsolete - this is probably not worth it.
@@ -76,42 +231,51 @@ void
 OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 int start, int end) {
     start = (start > 0 ? start : 0);
+
+    OmpEvalScope scope(OmpEvalScope::STENCILS);
+    int numThreads = scope.GetNumThreads();
     
     src += srcDesc.offset;
     dst += dstDesc.offset;
 
-    int numThreads = omp_get_max_threads();
-    int n = end - start;
+    BufferDescriptor const * dstDescPtr = &dstDesc;
+    if (evalFixedLengthStencils<1>(src, srcDesc, &dst, &dstDescPtr, &weights,
+                                   sizes, offsets, indices, start, end,
+                                   numThreads)) {
+        return;
+    }
 
     float * result = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
 
-#pragma omp parallel for
-    for (int i = 0; i < n; ++i) {
+    runStencilRanges(sizes, offsets, start, end, 1, numThreads,
+                     [&](int first, int last) {
+        for (int index = first; index < last; ++index) {
 
-        int index = i + start; // Stencil index
+            int i = index - start;
 
-        // Get thread-local pointers
-        int const           * threadIndices = indices + offsets[index];
-        float const         * threadWeights = weights + offsets[index];
+            // Get thread-local pointers
+            int const           * threadIndices = indices + offsets[index];
+            float const         * threadWeights = weights + offsets[index];
 
-        int threadId = omp_get_thread_num();
+            int threadId = omp_get_thread_num();
 
-        float * threadResult = result + threadId*srcDesc.length;
+            float * threadResult = result + threadId*srcDesc.length;
 
-        clear(threadResult, dstDesc);
+            clear(threadResult, dstDesc);
 
-        for (int j=0; j<(int)sizes[index]; ++j) {
-            addWithWeight(threadResult, src,
-                threadIndices[j], threadWeights[j], srcDesc);
-        }
+            for (int j=0; j<(int)sizes[index]; ++j) {
+                addWithWeight(threadResult, src,
+                    threadIndices[j], threadWeights[j], srcDesc);
+            }
 
-        copy(dst, i, threadResult, dstDesc);
-    }
+            copy(dst, i, threadResult, dstDesc);
+        }
+    });
 }
 
 void
@@ -120,7 +284,7 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDu,     BufferDescriptor const &dstDuDesc,
                 float * dstDv,     BufferDescriptor const &dstDvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -128,52 +292,64 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 int start, int end) {
     start = (start > 0 ? start : 0);
 
+    OmpEvalScope scope(OmpEvalScope::STENCILS);
+    int numThreads = scope.GetNumThreads();
+
     src += srcDesc.offset;
     dst += dstDesc.offset;
     dstDu += dstDuDesc.offset;
     dstDv += dstDvDesc.offset;
 
-    int numThreads = omp_get_max_threads();
-    int n = end - start;
+    float * const dsts[3] = { dst, dstDu, dstDv };
+    BufferDescriptor const * const dstDescs[3] = {
+        &dstDesc, &dstDuDesc, &dstDvDesc };
+    float const * const dstWeights[3] = { weights, duWeights, dvWeights };
+    if (evalFixedLengthStencils<3>(src, srcDesc, dsts, dstDescs, dstWeights,
+                                   sizes, offsets, indices, start, end,
+                                   numThreads)) {
+        return;
+    }
 
     float * result = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
     float * resultDu = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
     float * resultDv = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
 
-#pragma omp parallel for
-    for (int i = 0; i < n; ++i) {
+    runStencilRanges(sizes, offsets, start, end, 1, numThreads,
+                     [&](int first, int last) {
+        for (int index = first; index < last; ++index) {
 
-        int index = i + start; // Stencil index
+            int i = index - start;
 
-        // Get thread-local pointers
-        int const           * threadIndices = indices + offsets[index];
-        float const         * threadWeights = weights + offsets[index];
-        float const         * threadWeightsDu = duWeights + offsets[index];
-        float const         * threadWeightsDv = dvWeights + offsets[index];
+            // Get thread-local pointers
+            int const           * threadIndices = indices + offsets[index];
+            float const         * threadWeights = weights + offsets[index];
+            float const         * threadWeightsDu = duWeights + offsets[index];
+            float const         * threadWeightsDv = dvWeights + offsets[index];
 
-        int threadId = omp_get_thread_num();
+            int threadId = omp_get_thread_num();
 
-        float * threadResult = result + threadId*srcDesc.length;
-        float * threadResultDu = resultDu + threadId*srcDesc.length;
-        float * threadResultDv = resultDv + threadId*srcDesc.length;
+            float * threadResult = result + threadId*srcDesc.length;
+            float * threadResultDu = resultDu + threadId*srcDesc.length;
+            float * threadResultDv = resultDv + threadId*srcDesc.length;
 
-        clear(threadResult, dstDesc);
-        clear(threadResultDu, dstDuDesc);
-        clear(threadResultDv, dstDvDesc);
+            clear(threadResult, dstDesc);
+            clear(threadResultDu, dstDuDesc);
+            clear(threadResultDv, dstDvDesc);
 
-        for (int j=0; j<(int)sizes[index]; ++j) {
-            addWithWeight(threadResult, src,
-                threadIndices[j], threadWeights[j], srcDesc);
-            addWithWeight(threadResultDu, src,
-                threadIndices[j], threadWeightsDu[j], srcDesc);
-            addWithWeight(threadResultDv, src,
-                threadIndices[j], threadWeightsDv[j], srcDesc);
-        }
+            for (int j=0; j<(int)sizes[index]; ++j) {
+                addWithWeight(threadResult, src,
+                    threadIndices[j], threadWeights[j], srcDesc);
+                addWithWeight(threadResultDu, src,
+                    threadIndices[j], threadWeightsDu[j], srcDesc);
+                addWithWeight(threadResultDv, src,
+                    threadIndices[j], threadWeightsDv[j], srcDesc);
+            }
 
-        copy(dst, i, threadResult, dstDesc);
-        copy(dstDu, i, threadResultDu, dstDuDesc);
-        copy(dstDv, i, threadResultDv, dstDvDesc);
-    }
+            copy(dst, i, threadResult, dstDesc);
+            copy(dstDu, i, threadResultDu, dstDuDesc);
+            copy(dstDv, i, threadResultDv, dstDvDesc);
+        }
+    });
 
 }
 
@@ -186,7 +362,7 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDuv,    BufferDescriptor const &dstDuvDesc,
                 float * dstDvv,    BufferDescriptor const &dstDvvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -197,6 +373,9 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 int start, int end) {
     start = (start > 0 ? start : 0);
 
+    OmpEvalScope scope(OmpEvalScope::STENCILS);
+    int numThreads = scope.GetNumThreads();
+
     src += srcDesc.offset;
     dst += dstDesc.offset;
     dstDu += dstDuDesc.offset;
@@ -205,8 +384,16 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     dstDuv += dstDuvDesc.offset;
     dstDvv += dstDvvDesc.offset;
 
-    int numThreads = omp_get_max_threads();
-    int n = end - start;
+    float * const dsts[6] = { dst, dstDu, dstDv, dstDuu, dstDuv, dstDvv };
+    BufferDescriptor const * const dstDescs[6] = { &dstDesc,
+        &dstDuDesc, &dstDvDesc, &dstDuuDesc, &dstDuvDesc, &dstDvvDesc };
+    float const * const dstWeights[6] = { weights, duWeights, dvWeights,
+                                          duuWeights, duvWeights, dvvWeights };
+    if (evalFixedLengthStencils<6>(src, srcDesc, dsts, dstDescs, dstWeights,
+                                   sizes, offsets, indices, start, end,
+                                   numThreads)) {
+        return;
+    }
 
     float * result = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
     float * resultDu = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
@@ -215,59 +402,151 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     float * resultDuv = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
     float * resultDvv = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
 
-#pragma omp parallel for
-    for (int i = 0; i < n; ++i) {
-
-        int index = i + start; // Stencil index
-
-        // Get thread-local pointers
-        int const           * threadIndices = indices + offsets[index];
-        float const         * threadWeights = weights + offsets[index];
-        float const         * threadWeightsDu = duWeights + offsets[index];
-        float const         * threadWeightsDv = dvWeights + offsets[index];
-        float const         * threadWeightsDuu = duuWeights + offsets[index];
-        float const         * threadWeightsDuv = duvWeights + offsets[index];
-        float const         * threadWeightsDvv = dvvWeights + offsets[index];
-
-        int threadId = omp_get_thread_num();
-
-        float * threadResult = result + threadId*srcDesc.length;
-        float * threadResultDu = resultDu + threadId*srcDesc.length;
-        float * threadResultDv = resultDv + threadId*srcDesc.length;
-        float * threadResultDuu = resultDuu + threadId*srcDesc.length;
-        float * threadResultDuv = resultDuv + threadId*srcDesc.length;
-        float * threadResultDvv = resultDvv + threadId*srcDesc.length;
-
-        clear(threadResult, dstDesc);
-        clear(threadResultDu, dstDuDesc);
-        clear(threadResultDv, dstDvDesc);
-        clear(threadResultDuu, dstDuuDesc);
-        clear(threadResultDuv, dstDuvDesc);
-        clear(threadResultDvv, dstDvvDesc);
-
-        for (int j=0; j<(int)sizes[index]; ++j) {
-            addWithWeight(threadResult, src,
-                threadIndices[j], threadWeights[j], srcDesc);
-            addWithWeight(threadResultDu, src,
-                threadIndices[j], threadWeightsDu[j], srcDesc);
-            addWithWeight(threadResultDv, src,
-                threadIndices[j], threadWeightsDv[j], srcDesc);
-            addWithWeight(threadResultDuu, src,
-                threadIndices[j], threadWeightsDuu[j], srcDesc);
-            addWithWeight(threadResultDuv, src,
-                threadIndices[j], threadWeightsDuv[j], srcDesc);
-            addWithWeight(threadResultDvv, src,
-                threadIndices[j], threadWeightsDvv[j], srcDesc);
+    runStencilRanges(sizes, offsets, start, end, 1, numThreads,
+                     [&](int first, int last) {
+        for (int index = first; index < last; ++index) {
+
+            int i = index - start;
+
+            // Get thread-local pointers
+            int const           * threadIndices = indices + offsets[index];
+            float const         * threadWeights = weights + offsets[index];
+            float const         * threadWeightsDu = duWeights + offsets[index];
+            float const         * threadWeightsDv = dvWeights + offsets[index];
+            float const         * threadWeightsDuu = duuWeights + offsets[index];
+            float const         * threadWeightsDuv = duvWeights + offsets[index];
+            float const         * threadWeightsDvv = dvvWeights + offsets[index];
+
+            int threadId = omp_get_thread_num();
+
+            float * threadResult = result + threadId*srcDesc.length;
+            float * threadResultDu = resultDu + threadId*srcDesc.length;
+            float * threadResultDv = resultDv + threadId*srcDesc.length;
+            float * threadResultDuu = resultDuu + threadId*srcDesc.length;
+            float * threadResultDuv = resultDuv + threadId*srcDesc.length;
+            float * threadResultDvv = resultDvv + threadId*srcDesc.length;
+
+            clear(threadResult, dstDesc);
+            clear(threadResultDu, dstDuDesc);
+            clear(threadResultDv, dstDvDesc);
+            clear(threadResultDuu, dstDuuDesc);
+            clear(threadResultDuv, dstDuvDesc);
+            clear(threadResultDvv, dstDvvDesc);
+
+            for (int j=0; j<(int)sizes[index]; ++j) {
+                addWithWeight(threadResult, src,
+                    threadIndices[j], threadWeights[j], srcDesc);
+                addWithWeight(threadResultDu, src,
+                    threadIndices[j], threadWeightsDu[j], srcDesc);
+                addWithWeight(threadResultDv, src,
+                    threadIndices[j], threadWeightsDv[j], srcDesc);
+                addWithWeight(threadResultDuu, src,
+                    threadIndices[j], threadWeightsDuu[j], srcDesc);
+                addWithWeight(threadResultDuv, src,
+                    threadIndices[j], threadWeightsDuv[j], srcDesc);
+                addWithWeight(threadResultDvv, src,
+                    threadIndices[j], threadWeightsDvv[j], srcDesc);
+            }
+
+            copy(dst, i, threadResult, dstDesc);
+            copy(dstDu, i, threadResultDu, dstDuDesc);
+            copy(dstDv, i, threadResultDv, dstDvDesc);
+            copy(dstDuu, i, threadResultDuu, dstDuuDesc);
+            copy(dstDuv, i, threadResultDuv, dstDuvDesc);
+            copy(dstDvv, i, threadResultDvv, dstDvvDesc);
         }
+    });
+
+}
 
-        copy(dst, i, threadResult, dstDesc);
-        copy(dstDu, i, threadResultDu, dstDuDesc);
-        copy(dstDv, i, threadResultDv, dstDvDesc);
-        copy(dstDuu, i, threadResultDuu, dstDuuDesc);
-        copy(dstDuv, i, threadResultDuv, dstDuvDesc);
-        copy(dstDvv, i, threadResultDvv, dstDvvDesc);
+//
+//  Batched evaluation of the stencils of several jobs -- the stencils of all
+//  jobs are split into chunks (each within a single job) that are evaluated
+//  concurrently with the scalar CPU kernel:
+//
+static const int batchChunkSize = 256;
+
+static void
+splitStencilEvalJobs(StencilEvalJob const * jobs, int numJobs,
+                     std::vector<int> & chunkJobs,
+                     std::vector<int> & chunkStarts) {
+
+    for (int i = 0; i < numJobs; ++i) {
+        for (int start = jobs[i].start; start < jobs[i].end;
+             start += batchChunkSize) {
+            chunkJobs.push_back(i);
+            chunkStarts.push_back(start);
+        }
     }
+}
+
+static void
+evalStencilEvalJobChunk(StencilEvalJob const & job, int start) {
+
+    int end = std::min(start + batchChunkSize, job.end);
+
+    CpuEvalStencils(job.src, job.srcDesc,
+                    job.dst + (start - job.start) * job.dstDesc.stride,
+                    job.dstDesc,
+                    job.sizes, job.offsets, job.indices, job.weights,
+                    start, end);
+}
+
+void
+OmpEvalStencils(StencilEvalJob const * jobs, int numJobs) {
+
+    std::vector<int> chunkJobs, chunkStarts;
+    splitStencilEvalJobs(jobs, numJobs, chunkJobs, chunkStarts);
+
+    int numChunks = (int)chunkJobs.size();
 
+    //  chunks of different jobs differ in cost, so are always dynamic
+    OmpEvalScope scope(OmpEvalScope::STENCILS);
+    int numThreads = scope.GetNumThreads();
+
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (int i = 0; i < numChunks; ++i) {
+        evalStencilEvalJobChunk(jobs[chunkJobs[i]], chunkStarts[i]);
+    }
+}
+
+//
+//  Evaluation of the stencils for several primvars in a single pass -- the
+//  stencils are split into chunks that are evaluated concurrently with the
+//  CPU kernel, with the destinations offset to the first stencil of each:
+//
+void
+OmpEvalStencils(PrimvarBinding const * bindings, int numBindings,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end) {
+
+    if (numBindings == 0) return;
+
+    int numChunks = (end - start + batchChunkSize - 1) / batchChunkSize;
+
+    OmpEvalScope scope(OmpEvalScope::STENCILS);
+    int numThreads = scope.GetNumThreads();
+
+#pragma omp parallel for schedule(runtime) num_threads(numThreads)
+    for (int i = 0; i < numChunks; ++i) {
+
+        int chunkStart = start + i * batchChunkSize;
+        int chunkEnd = std::min(chunkStart + batchChunkSize, end);
+
+        std::vector<PrimvarBinding> chunkBindings(bindings,
+                                                  bindings + numBindings);
+        for (int b = 0; b < numBindings; ++b) {
+            chunkBindings[b].dst += (chunkStart - start) *
+                                    chunkBindings[b].dstDesc.stride;
+        }
+
+        CpuEvalStencils(&chunkBindings[0], numBindings,
+                        sizes, offsets, indices, weights,
+                        chunkStart, chunkEnd);
+    }
 }
 
 }  // end namespace Osd
@@ -26,6 +26,7 @@
 #define OPENSUBDIV3_OSD_OMP_KERNEL_H
 
 #include "../version.h"
+#include "../far/types.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -33,12 +34,14 @@ namespace OPENSUBDIV_VERSION {
 namespace Osd {
 
 struct BufferDescriptor;
+struct StencilEvalJob;
+struct PrimvarBinding;
 
 void
 OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 int start, int end);
@@ -49,7 +52,7 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDu,     BufferDescriptor const &dstDuDesc,
                 float * dstDv,     BufferDescriptor const &dstDvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -65,7 +68,7 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDuv,    BufferDescriptor const &dstDuvDesc,
                 float * dstDvv,    BufferDescriptor const &dstDvvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -75,6 +78,44 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float const * dvvWeights,
                 int start, int end);
 
+void
+OmpEvalStencils(StencilEvalJob const * jobs, int numJobs);
+
+void
+OmpEvalStencils(PrimvarBinding const * bindings, int numBindings,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end);
+
+void
+OmpSetStencilEvalOptions(int schedule, int chunkSize, int numThreads,
+                         bool balanceBySize);
+
+void
+OmpSetPatchEvalOptions(int schedule, int chunkSize, int numThreads);
+
+//
+//  Sets the schedule of the loops of an evaluation of stencils or patches,
+//  which use schedule(runtime) and num_threads(GetNumThreads()) -- the
+//  schedule of the calling thread is restored on destruction:
+//
+class OmpEvalScope {
+public:
+    enum Kind { STENCILS, PATCHES };
+
+    explicit OmpEvalScope(Kind kind);
+    ~OmpEvalScope();
+
+    int GetNumThreads() const { return _numThreads; }
+
+private:
+    int _numThreads;
+    int _prevSchedule;
+    int _prevChunkSize;
+};
+
 } // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
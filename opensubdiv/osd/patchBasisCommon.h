@@ -221,6 +221,147 @@ Osd_EvalBasisBSpline(OSD_REAL s, OSD_REAL t,
     return 16;
 }
 
+// namespace {
+    //
+    //  Cubic BSpline curve basis evaluation across semi-sharp creases at
+    //  either end of the span, i.e. at the knots of the 2nd and 3rd points.
+    //  The span is subdivided with the crease rules until the creases have
+    //  decayed -- the half adjacent to a crease keeping it one level less
+    //  sharp and the other half having none -- and the resulting smooth span
+    //  evaluated.  The rows of m are the points of the current span as
+    //  weights of the original ones:
+    //
+    OSD_FUNCTION_STORAGE_CLASS
+    // template <typename REAL>
+    void
+    Osd_evalBSplineCurveCreased(OSD_REAL t,
+        OSD_REAL sharpness0, OSD_REAL sharpness1,
+        OSD_OUT_ARRAY(OSD_REAL, wP, 4),
+        OSD_OUT_ARRAY(OSD_REAL, wDP, 4),
+        OSD_OUT_ARRAY(OSD_REAL, wDP2, 4)) {
+
+        OSD_REAL m[16];
+        for (int i = 0; i < 16; ++i) {
+            m[i] = ((i % 5) == 0) ? 1.0f : 0.0f;
+        }
+
+        OSD_REAL scale = 1.0f;
+        for (int level = 0; (level < 11) &&
+                ((sharpness0 > 0.0f) || (sharpness1 > 0.0f)); ++level) {
+
+            //  Fraction of the sharp vertex rule at each end:
+            OSD_REAL f0 = (sharpness0 < 0.0f) ? 0.0f :
+                          (sharpness0 > 1.0f) ? 1.0f : sharpness0;
+            OSD_REAL f1 = (sharpness1 < 0.0f) ? 0.0f :
+                          (sharpness1 > 1.0f) ? 1.0f : sharpness1;
+
+            OSD_REAL c[20];
+            for (int j = 0; j < 4; ++j) {
+                OSD_REAL x0 = m[j], x1 = m[4+j], x2 = m[8+j], x3 = m[12+j];
+
+                c[j]    = 0.5f * (x0 + x1);
+                c[4+j]  = (1.0f - f0) * 0.125f * (x0 + 6.0f*x1 + x2) + f0 * x1;
+                c[8+j]  = 0.5f * (x1 + x2);
+                c[12+j] = (1.0f - f1) * 0.125f * (x1 + 6.0f*x2 + x3) + f1 * x2;
+                c[16+j] = 0.5f * (x2 + x3);
+            }
+
+            int first = 0;
+            if (t <= 0.5f) {
+                t = 2.0f * t;
+                sharpness0 -= 1.0f;
+                sharpness1 = 0.0f;
+            } else {
+                t = 2.0f * t - 1.0f;
+                sharpness0 = 0.0f;
+                sharpness1 -= 1.0f;
+                first = 4;
+            }
+            for (int i = 0; i < 16; ++i) {
+                m[i] = c[first + i];
+            }
+            scale *= 2.0f;
+        }
+
+        OSD_REAL w[4], dw[4], dw2[4];
+        Osd_evalBSplineCurve(t, w, OSD_OPTIONAL_INIT(wDP, dw), OSD_OPTIONAL_INIT(wDP2, dw2));
+
+        for (int j = 0; j < 4; ++j) {
+            wP[j] = w[0]*m[j] + w[1]*m[4+j] + w[2]*m[8+j] + w[3]*m[12+j];
+        }
+        if (OSD_OPTIONAL(wDP)) {
+            for (int j = 0; j < 4; ++j) {
+                wDP[j] = scale * (dw[0]*m[j] + dw[1]*m[4+j] +
+                                  dw[2]*m[8+j] + dw[3]*m[12+j]);
+            }
+        }
+        if (OSD_OPTIONAL(wDP2)) {
+            for (int j = 0; j < 4; ++j) {
+                wDP2[j] = scale * scale * (dw2[0]*m[j] + dw2[1]*m[4+j] +
+                                           dw2[2]*m[8+j] + dw2[3]*m[12+j]);
+            }
+        }
+    }
+// } // end namespace
+
+//
+//  BSpline basis of a double-crease patch, i.e. with semi-sharp creases along
+//  two opposite edges:  along edges 0 and 2 (creased in t) when the boundary
+//  mask of the patch includes edge 0, otherwise along edges 3 and 1 (creased
+//  in s), with the given sharpness of the lower and upper crease.
+//
+OSD_FUNCTION_STORAGE_CLASS
+int
+Osd_EvalBasisBSplineDoubleCrease(OSD_REAL s, OSD_REAL t,
+    int boundaryMask, OSD_REAL sharpness0, OSD_REAL sharpness1,
+    OSD_OUT_ARRAY(OSD_REAL, wP, 16),
+    OSD_OUT_ARRAY(OSD_REAL, wDs, 16),
+    OSD_OUT_ARRAY(OSD_REAL, wDt, 16),
+    OSD_OUT_ARRAY(OSD_REAL, wDss, 16),
+    OSD_OUT_ARRAY(OSD_REAL, wDst, 16),
+    OSD_OUT_ARRAY(OSD_REAL, wDtt, 16)) {
+
+    OSD_REAL sWeights[4], tWeights[4], dsWeights[4], dtWeights[4], dssWeights[4], dttWeights[4];
+
+    if ((boundaryMask & 1) != 0) {
+        Osd_evalBSplineCurve(s, sWeights, OSD_OPTIONAL_INIT(wDs, dsWeights), OSD_OPTIONAL_INIT(wDss, dssWeights));
+        Osd_evalBSplineCurveCreased(t, sharpness0, sharpness1,
+            tWeights, OSD_OPTIONAL_INIT(wDt, dtWeights), OSD_OPTIONAL_INIT(wDtt, dttWeights));
+    } else {
+        Osd_evalBSplineCurveCreased(s, sharpness0, sharpness1,
+            sWeights, OSD_OPTIONAL_INIT(wDs, dsWeights), OSD_OPTIONAL_INIT(wDss, dssWeights));
+        Osd_evalBSplineCurve(t, tWeights, OSD_OPTIONAL_INIT(wDt, dtWeights), OSD_OPTIONAL_INIT(wDtt, dttWeights));
+    }
+
+    if (OSD_OPTIONAL(wP)) {
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                wP[4*i+j] = sWeights[j] * tWeights[i];
+            }
+        }
+    }
+
+    if (OSD_OPTIONAL(wDs && wDt)) {
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                wDs[4*i+j] = dsWeights[j] * tWeights[i];
+                wDt[4*i+j] = sWeights[j] * dtWeights[i];
+            }
+        }
+
+        if (OSD_OPTIONAL(wDss && wDst && wDtt)) {
+            for (int i = 0; i < 4; ++i) {
+                for (int j = 0; j < 4; ++j) {
+                    wDss[4*i+j] = dssWeights[j] * tWeights[i];
+                    wDst[4*i+j] = dsWeights[j] * dtWeights[i];
+                    wDtt[4*i+j] = sWeights[j] * dttWeights[i];
+                }
+            }
+        }
+    }
+    return 16;
+}
+
 // namespace {
     //
     //  Cubic Bezier curve basis evaluation:
@@ -42,20 +42,38 @@ OsdEvaluatePatchBasisNormalized(
 
     int nPoints = 0;
     if (patchType == OSD_PATCH_DESCRIPTOR_REGULAR) {
+        // the boundary mask of a double-crease patch identifies its creases
+        OSD_REAL creaseSharpness[2];
+        bool doubleCrease = OsdPatchParamIsDoubleCrease(param);
+        if (doubleCrease) {
+            OsdPatchParamGetDoubleCreaseSharpness(param, creaseSharpness);
+        }
 #if OSD_ARRAY_ARG_BOUND_OPTIONAL
-        nPoints = Osd_EvalBasisBSpline(s, t, wP, wDs, wDt, wDss, wDst, wDtt);
-        if (boundaryMask != 0) {
-            Osd_boundBasisBSpline(
-                boundaryMask, wP, wDs, wDt, wDss, wDst, wDtt);
+        if (doubleCrease) {
+            nPoints = Osd_EvalBasisBSplineDoubleCrease(s, t, boundaryMask,
+                creaseSharpness[0], creaseSharpness[1],
+                wP, wDs, wDt, wDss, wDst, wDtt);
+        } else {
+            nPoints = Osd_EvalBasisBSpline(s, t, wP, wDs, wDt, wDss, wDst, wDtt);
+            if (boundaryMask != 0) {
+                Osd_boundBasisBSpline(
+                    boundaryMask, wP, wDs, wDt, wDss, wDst, wDtt);
+            }
         }
 #else
         OSD_REAL wP16[16], wDs16[16], wDt16[16],
                  wDss16[16], wDst16[16], wDtt16[16];
-        nPoints = Osd_EvalBasisBSpline(
-                s, t, wP16, wDs16, wDt16, wDss16, wDst16, wDtt16);
-        if (boundaryMask != 0) {
-            Osd_boundBasisBSpline(
-                boundaryMask, wP16, wDs16, wDt16, wDss16, wDst16, wDtt16);
+        if (doubleCrease) {
+            nPoints = Osd_EvalBasisBSplineDoubleCrease(s, t, boundaryMask,
+                creaseSharpness[0], creaseSharpness[1],
+                wP16, wDs16, wDt16, wDss16, wDst16, wDtt16);
+        } else {
+            nPoints = Osd_EvalBasisBSpline(
+                    s, t, wP16, wDs16, wDt16, wDss16, wDst16, wDtt16);
+            if (boundaryMask != 0) {
+                Osd_boundBasisBSpline(
+                    boundaryMask, wP16, wDs16, wDt16, wDss16, wDst16, wDtt16);
+            }
         }
         for (int i=0; i<nPoints; ++i) {
             wP[i] = wP16[i];
@@ -193,4 +211,51 @@ OsdEvaluatePatchBasis(
     return nPoints;
 }
 
+//
+// Same as OsdEvaluatePatchBasis() with the normalization of the patch
+// parameterization and the scale of the derivatives given pre-expanded,
+// rather than decoded from the PatchParam bitfields (the PatchParam is
+// still needed for the boundary mask of regular patches)
+//
+OSD_FUNCTION_STORAGE_CLASS
+int
+OsdEvaluatePatchBasisWithNormalization(
+    int patchType, OsdPatchParam param,
+    OsdPatchParamNormalization normalization,
+    OSD_REAL s, OSD_REAL t,
+    OSD_OUT_ARRAY(OSD_REAL, wP, 20),
+    OSD_OUT_ARRAY(OSD_REAL, wDs, 20),
+    OSD_OUT_ARRAY(OSD_REAL, wDt, 20),
+    OSD_OUT_ARRAY(OSD_REAL, wDss, 20),
+    OSD_OUT_ARRAY(OSD_REAL, wDst, 20),
+    OSD_OUT_ARRAY(OSD_REAL, wDtt, 20)) {
+
+    s = s * normalization.scale + normalization.offsetU;
+    t = t * normalization.scale + normalization.offsetV;
+
+    int nPoints = OsdEvaluatePatchBasisNormalized(
+        patchType, param, s, t, wP, wDs, wDt, wDss, wDst, wDtt);
+
+    if (OSD_OPTIONAL(wDs && wDt)) {
+        OSD_REAL d1Scale = normalization.derivScale;
+
+        for (int i = 0; i < nPoints; ++i) {
+            wDs[i] *= d1Scale;
+            wDt[i] *= d1Scale;
+        }
+
+        if (OSD_OPTIONAL(wDss && wDst && wDtt)) {
+            // the sign of the first derivatives is kept
+            OSD_REAL d2Scale = d1Scale * ((d1Scale < 0) ? -d1Scale : d1Scale);
+
+            for (int i = 0; i < nPoints; ++i) {
+                wDss[i] *= d2Scale;
+                wDst[i] *= d2Scale;
+                wDtt[i] *= d2Scale;
+            }
+        }
+    }
+    return nPoints;
+}
+
 #endif /* OPENSUBDIV3_OSD_PATCH_BASIS_COMMON_EVAL_H */
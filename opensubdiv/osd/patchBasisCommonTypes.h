@@ -177,6 +177,8 @@
 
 #else
 
+    #include <cmath>
+
     #define OSD_FUNCTION_STORAGE_CLASS static inline
     #define OSD_DATA_STORAGE_CLASS static
     #define OSD_REAL float
@@ -212,6 +214,7 @@
 typedef struct OsdPatchParam OsdPatchParam;
 typedef struct OsdPatchArray OsdPatchArray;
 typedef struct OsdPatchCoord OsdPatchCoord;
+typedef struct OsdPatchParamNormalization OsdPatchParamNormalization;
 #endif
 
 // Osd reflection of Far::PatchDescriptor
@@ -353,6 +356,28 @@ OsdPatchParamIsRegular(OsdPatchParam param)
     return (((param.field1 >> 5) & 0x1) != 0);
 }
 
+// A negative sharpness encodes the two creases of a double-crease patch
+// (see Far::PatchTable::EncodeDoubleCreaseSharpness())
+OSD_FUNCTION_STORAGE_CLASS
+bool
+OsdPatchParamIsDoubleCrease(OsdPatchParam param)
+{
+    return (param.sharpness < 0.0f);
+}
+
+OSD_FUNCTION_STORAGE_CLASS
+void
+OsdPatchParamGetDoubleCreaseSharpness(
+        OsdPatchParam param,
+        OSD_OUT_ARRAY(OSD_REAL, sharpness, 2))
+{
+    OSD_REAL encoded = -param.sharpness;
+    OSD_REAL lower = OSD_REAL_CAST(floor(encoded * (1.0f / 4096.0f)));
+
+    sharpness[0] = lower * (1.0f / 256.0f);
+    sharpness[1] = (encoded - lower * 4096.0f) * (1.0f / 256.0f);
+}
+
 OSD_FUNCTION_STORAGE_CLASS
 bool
 OsdPatchParamIsTriangleRotated(OsdPatchParam param)
@@ -419,4 +444,30 @@ OsdPatchParamUnnormalizeTriangle(
     }
 }
 
+// Osd reflection of Osd::PatchParamNormalization -- the mapping of a
+// PatchParam from the parameterization of its face to that of the patch,
+// pre-expanded so that it need not be decoded from the bitfields:
+//     (u,v) = (s,t) * scale + (offsetU,offsetV)
+// derivScale is the scale of the first derivatives, negated for rotated
+// triangles.
+struct OsdPatchParamNormalization {
+    float scale;
+    float offsetU;
+    float offsetV;
+    float derivScale;
+};
+
+OSD_FUNCTION_STORAGE_CLASS
+OsdPatchParamNormalization
+OsdPatchParamNormalizationInit(
+    float scale, float offsetU, float offsetV, float derivScale)
+{
+    OsdPatchParamNormalization normalization;
+    normalization.scale = scale;
+    normalization.offsetU = offsetU;
+    normalization.offsetV = offsetV;
+    normalization.derivScale = derivScale;
+    return normalization;
+}
+
 #endif /* OPENSUBDIV3_OSD_PATCH_BASIS_COMMON_TYPES_H */
@@ -0,0 +1,207 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/residencyManager.h"
+
+#include <cassert>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+ResidencyManager::Resource::Resource(ResidencyManager & manager) :
+    _manager(&manager), _prev(NULL), _next(NULL),
+    _memoryUsage(0), _lastFrame(0), _resident(false) {
+
+    ++_manager->_numResources;
+}
+
+ResidencyManager::Resource::~Resource() {
+
+    //  The subclass must have evicted its device table -- it can no longer
+    //  be evicted through the subclass here:
+    assert(!_resident);
+
+    if (_manager) {
+        --_manager->_numResources;
+    }
+}
+
+bool
+ResidencyManager::Resource::acquire() {
+
+    if (!_manager) return false;
+
+    ResidencyManager & manager = *_manager;
+
+    _lastFrame = manager._frame;
+
+    if (_resident) {
+        //  Move to the most recently used:
+        manager.unlink(this);
+        manager.link(this);
+        return true;
+    }
+
+    //  Make room for the size of a previous upload (if any) before uploading
+    //  and fit the budget again with the actual size after:
+    manager.fitBudget(_memoryUsage);
+
+    size_t memoryUsage = 0;
+    if (!upload(memoryUsage)) {
+        return false;
+    }
+    _memoryUsage = memoryUsage;
+    _resident = true;
+
+    manager.link(this);
+    manager._memoryUsage += _memoryUsage;
+    if (manager._memoryUsage > manager._peakMemoryUsage) {
+        manager._peakMemoryUsage = manager._memoryUsage;
+    }
+    ++manager._numResident;
+    ++manager._numUploads;
+
+    manager.fitBudget(0);
+    return true;
+}
+
+void
+ResidencyManager::Resource::release() {
+
+    if (_resident) {
+        if (_manager) {
+            _manager->evictResource(this);
+        } else {
+            evict();
+            _resident = false;
+        }
+    }
+}
+
+ResidencyManager::ResidencyManager(size_t budget) :
+    _budget(budget), _memoryUsage(0), _peakMemoryUsage(0),
+    _numResources(0), _numResident(0), _numUploads(0), _numEvictions(0),
+    _frame(1), _leastRecent(NULL), _mostRecent(NULL) {
+}
+
+ResidencyManager::~ResidencyManager() {
+
+    //  Remaining resources are evicted and detached, so they no longer refer
+    //  to the manager when destroyed:
+    while (_leastRecent) {
+        Resource * resource = _leastRecent;
+        evictResource(resource);
+        resource->_manager = NULL;
+    }
+}
+
+void
+ResidencyManager::SetBudget(size_t budget) {
+
+    _budget = budget;
+    fitBudget(0);
+}
+
+void
+ResidencyManager::EndFrame() {
+
+    ++_frame;
+    fitBudget(0);
+}
+
+void
+ResidencyManager::EvictUnused(int numFrames) {
+
+    //  Resources are ordered by use, so those not used recently lead the list:
+    while (_leastRecent &&
+           ((numFrames <= 0) ||
+            (_frame - _leastRecent->_lastFrame >= (unsigned int)numFrames))) {
+        evictResource(_leastRecent);
+        ++_numEvictions;
+    }
+}
+
+void
+ResidencyManager::link(Resource * resource) {
+
+    resource->_prev = _mostRecent;
+    resource->_next = NULL;
+    if (_mostRecent) {
+        _mostRecent->_next = resource;
+    } else {
+        _leastRecent = resource;
+    }
+    _mostRecent = resource;
+}
+
+void
+ResidencyManager::unlink(Resource * resource) {
+
+    if (resource->_prev) {
+        resource->_prev->_next = resource->_next;
+    } else {
+        _leastRecent = resource->_next;
+    }
+    if (resource->_next) {
+        resource->_next->_prev = resource->_prev;
+    } else {
+        _mostRecent = resource->_prev;
+    }
+    resource->_prev = resource->_next = NULL;
+}
+
+void
+ResidencyManager::evictResource(Resource * resource) {
+
+    assert(resource->_resident);
+
+    unlink(resource);
+    resource->evict();
+    resource->_resident = false;
+
+    _memoryUsage -= resource->_memoryUsage;
+    --_numResident;
+}
+
+void
+ResidencyManager::fitBudget(size_t reserved) {
+
+    if (_budget == 0) return;
+
+    //  Evict the least recently used resources until the reserved memory fits,
+    //  stopping at those used during the current frame:
+    while (_leastRecent && (_memoryUsage + reserved > _budget) &&
+           (_leastRecent->_lastFrame != _frame)) {
+        evictResource(_leastRecent);
+        ++_numEvictions;
+    }
+}
+
+} // end namespace Osd
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,283 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_RESIDENCY_MANAGER_H
+#define OPENSUBDIV3_OSD_RESIDENCY_MANAGER_H
+
+#include "../version.h"
+
+#include "../osd/nonCopyable.h"
+
+#include <cstddef>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+/// \brief Keeps the device memory of the tables of many meshes within a budget
+///
+/// ResidencyManager accounts for the device memory of the tables registered
+/// with it (see ResidentTable) and, when their total exceeds its budget,
+/// deletes the device tables least recently acquired.  Evicted tables are
+/// created again from their source tables the next time they are acquired,
+/// e.g. when a mesh which left the view becomes visible again:
+///
+///     Osd::ResidencyManager manager(512 << 20);
+///
+///     Osd::ResidentTable<Osd::GLStencilTableSSBO, Far::StencilTable>
+///         stencilTable(manager, farStencilTable);
+///     Osd::ResidentTable<Osd::GLPatchTable, Far::PatchTable>
+///         patchTable(manager, farPatchTable);
+///
+///     // each frame, for each visible mesh:
+///     GLComputeEvaluator::EvalStencils(..., stencilTable.Acquire(), ...);
+///     draw(patchTable.Acquire());
+///
+///     manager.EndFrame();
+///
+/// Tables acquired since the last EndFrame() are never evicted, since the
+/// commands of the frame may still refer to them -- so the budget is exceeded
+/// when the tables of a single frame don't fit.  A budget of 0 is unbounded,
+/// the manager then only accounts for the memory of the tables (which may
+/// still be evicted explicitly with EvictUnused()).
+///
+/// The device tables must report their memory with GetMemoryUsage().  The
+/// manager is not thread-safe and, like the device tables, is to be used on
+/// the thread owning the device context.
+///
+class ResidencyManager : private NonCopyable<ResidencyManager> {
+public:
+
+    /// \brief Base class of the tables registered with a ResidencyManager
+    ///
+    /// Subclasses create and delete their device table on upload() and
+    /// evict(), and call acquire() before each use of the device table.
+    ///
+    class Resource : private NonCopyable<Resource> {
+    public:
+        /// \brief Returns true if the device table is currently allocated
+        bool IsResident() const { return _resident; }
+
+        /// \brief Returns the device memory of the table when resident, or
+        ///        when it was last resident
+        size_t GetMemoryUsage() const { return _memoryUsage; }
+
+        /// \brief Returns the manager of the resource (or NULL if the
+        ///        manager was destroyed first)
+        ResidencyManager * GetManager() const { return _manager; }
+
+    protected:
+        explicit Resource(ResidencyManager & manager);
+
+        /// \brief Unregisters the resource -- subclasses must first evict
+        ///        their device table with release() in their destructor
+        virtual ~Resource();
+
+        /// \brief Makes the resource resident, uploading it if needed, and
+        ///        marks it as the most recently used
+        ///
+        /// @return  false if the upload failed
+        ///
+        bool acquire();
+
+        /// \brief Evicts the device table if resident
+        void release();
+
+        /// \brief Creates the device table
+        ///
+        /// @param memoryUsage  the device memory allocated by the table
+        ///
+        /// @return             false if the table could not be created
+        ///
+        virtual bool upload(size_t & memoryUsage) = 0;
+
+        /// \brief Deletes the device table
+        virtual void evict() = 0;
+
+    private:
+        friend class ResidencyManager;
+
+        ResidencyManager * _manager;
+
+        //  Resident resources are linked from the least to the most recently
+        //  used:
+        Resource * _prev;
+        Resource * _next;
+
+        size_t       _memoryUsage;
+        unsigned int _lastFrame;
+        bool         _resident;
+    };
+
+    /// \brief Constructor
+    ///
+    /// @param budget  the device memory of the resident tables not to
+    ///                exceed, in bytes (0 for unbounded)
+    ///
+    explicit ResidencyManager(size_t budget = 0);
+
+    /// \brief Destructor, evicts all resident tables
+    ~ResidencyManager();
+
+    /// \brief Returns the budget (0 if unbounded)
+    size_t GetBudget() const { return _budget; }
+
+    /// \brief Sets the budget, evicting the tables which no longer fit
+    void SetBudget(size_t budget);
+
+    /// \brief Returns the device memory of the resident tables
+    size_t GetMemoryUsage() const { return _memoryUsage; }
+
+    /// \brief Returns the highest device memory of the resident tables
+    size_t GetPeakMemoryUsage() const { return _peakMemoryUsage; }
+
+    /// \brief Returns the number of registered tables
+    int GetNumResources() const { return _numResources; }
+
+    /// \brief Returns the number of resident tables
+    int GetNumResidentResources() const { return _numResident; }
+
+    /// \brief Returns the number of uploads, including the first upload of
+    ///        each table
+    int GetNumUploads() const { return _numUploads; }
+
+    /// \brief Returns the number of tables evicted to fit the budget or by
+    ///        EvictUnused()
+    int GetNumEvictions() const { return _numEvictions; }
+
+    /// \brief Ends the current frame, allowing the tables acquired during the
+    ///        frame to be evicted, and evicts those exceeding the budget
+    void EndFrame();
+
+    /// \brief Evicts the tables not acquired during the last numFrames frames
+    ///        (including the current one), regardless of the budget
+    ///
+    /// A numFrames of 0 evicts all the tables, which must then no longer be
+    /// in use by the device.
+    ///
+    void EvictUnused(int numFrames = 1);
+
+private:
+    void link(Resource * resource);
+    void unlink(Resource * resource);
+
+    void evictResource(Resource * resource);
+    void fitBudget(size_t reserved);
+
+    size_t _budget;
+    size_t _memoryUsage;
+    size_t _peakMemoryUsage;
+
+    int _numResources;
+    int _numResident;
+    int _numUploads;
+    int _numEvictions;
+
+    unsigned int _frame;
+
+    Resource * _leastRecent;
+    Resource * _mostRecent;
+};
+
+/// \brief A device table managed by a ResidencyManager
+///
+/// The device table is created from the source table with
+/// DEVICE_TABLE::Create(sourceTable, deviceContext) when first acquired, and
+/// again when acquired after being evicted.  The source table is not owned
+/// and must outlive the ResidentTable.
+///
+template <typename DEVICE_TABLE,
+          typename SOURCE_TABLE,
+          typename DEVICE_CONTEXT = void>
+class ResidentTable : public ResidencyManager::Resource {
+public:
+    typedef DEVICE_TABLE DeviceTable;
+    typedef SOURCE_TABLE SourceTable;
+    typedef DEVICE_CONTEXT DeviceContext;
+
+    /// \brief Constructor, the device table is not created until acquired
+    ///
+    /// @param manager        the manager accounting for the table
+    ///
+    /// @param sourceTable    the table from which the device table is created
+    ///
+    /// @param deviceContext  the device context given to the device table
+    ///
+    ResidentTable(ResidencyManager & manager,
+                  SourceTable const * sourceTable,
+                  DeviceContext * deviceContext = NULL) :
+        ResidencyManager::Resource(manager),
+        _sourceTable(sourceTable), _deviceContext(deviceContext),
+        _deviceTable(NULL) { }
+
+    virtual ~ResidentTable() {
+        release();
+    }
+
+    /// \brief Returns the device table, uploading it if not resident, and
+    ///        marks it as used during the current frame
+    ///
+    /// The device table remains valid until the end of the frame, after
+    /// which it may be evicted and the pointer invalidated.  Returns NULL if
+    /// the device table could not be created.
+    ///
+    DeviceTable * Acquire() {
+        return acquire() ? _deviceTable : NULL;
+    }
+
+    /// \brief Returns the device table if resident (or NULL), without
+    ///        marking it as used
+    DeviceTable * GetDeviceTable() const { return _deviceTable; }
+
+    /// \brief Returns the source table
+    SourceTable const * GetSourceTable() const { return _sourceTable; }
+
+protected:
+    virtual bool upload(size_t & memoryUsage) {
+        _deviceTable = DeviceTable::Create(_sourceTable, _deviceContext);
+        memoryUsage = _deviceTable ? _deviceTable->GetMemoryUsage() : 0;
+        return _deviceTable != NULL;
+    }
+
+    virtual void evict() {
+        delete _deviceTable;
+        _deviceTable = NULL;
+    }
+
+private:
+    SourceTable const * _sourceTable;
+    DeviceContext *     _deviceContext;
+    DeviceTable *       _deviceTable;
+};
+
+} // end namespace Osd
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_OSD_RESIDENCY_MANAGER_H
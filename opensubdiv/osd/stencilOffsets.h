@@ -0,0 +1,69 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_OSD_STENCIL_OFFSETS_H
+#define OPENSUBDIV3_OSD_STENCIL_OFFSETS_H
+
+#include "../version.h"
+#include "../far/error.h"
+#include "../far/types.h"
+
+#include <limits>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+namespace internal {
+
+//
+//  The GPU kernels address stencil tables with 32-bit offsets.  With 64-bit
+//  Far::Offsets, the offsets of a table are narrowed for the kernels only if
+//  they all fit in that range -- a larger table is rejected with an error
+//  (and no device buffer is created for it) rather than silently wrapped:
+//
+inline bool
+NarrowStencilOffsets(std::vector<Far::Offset> const & offsets,
+                     std::vector<int> & narrowed) {
+
+    if (!offsets.empty() &&
+        offsets.back() > (Far::Offset)std::numeric_limits<int>::max()) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "Failure creating device stencil table -- offsets exceed the "
+            "32-bit range of the GPU kernels.");
+        return false;
+    }
+    narrowed.assign(offsets.begin(), offsets.end());
+    return true;
+}
+
+} // end namespace internal
+} // end namespace Osd
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+} // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_STENCIL_OFFSETS_H
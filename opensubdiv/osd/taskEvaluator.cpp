@@ -0,0 +1,468 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../osd/taskEvaluator.h"
+#include "../osd/cpuEvaluator.h"
+
+#include <algorithm>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+const int TaskEvaluator::STENCILS_PER_TASK;
+const int TaskEvaluator::PATCH_COORDS_PER_TASK;
+
+namespace {
+
+    //
+    //  Invokes all tasks on the scheduler given as device context, or in
+    //  order on the calling thread if there is none:
+    //
+    void
+    runTasks(void * deviceContext, int numTasks,
+             TaskScheduler::TaskFunction task, void * data) {
+
+        TaskScheduler * scheduler = static_cast<TaskScheduler *>(deviceContext);
+
+        if (scheduler && (numTasks > 1)) {
+            scheduler->ParallelFor(numTasks, task, data);
+        } else {
+            for (int i = 0; i < numTasks; ++i) {
+                task(data, i);
+            }
+        }
+    }
+
+    inline int
+    numTasksFor(int count, int countPerTask) {
+        return (count + countPerTask - 1) / countPerTask;
+    }
+
+    inline float *
+    elementAt(float * p, BufferDescriptor const & desc, int index) {
+        return p ? (p + index * desc.stride) : 0;
+    }
+
+    //
+    //  Arguments of stencil evaluation -- the number of derivatives present
+    //  selects which of the CpuEvaluator methods is invoked per task:
+    //
+    struct StencilTaskData {
+        float const * src;
+        float * dst;
+        float * du;
+        float * dv;
+        float * duu;
+        float * duv;
+        float * dvv;
+        BufferDescriptor srcDesc;
+        BufferDescriptor dstDesc;
+        BufferDescriptor duDesc;
+        BufferDescriptor dvDesc;
+        BufferDescriptor duuDesc;
+        BufferDescriptor duvDesc;
+        BufferDescriptor dvvDesc;
+        int const * sizes;
+        Far::Offset const * offsets;
+        int const * indices;
+        float const * weights;
+        float const * duWeights;
+        float const * dvWeights;
+        float const * duuWeights;
+        float const * duvWeights;
+        float const * dvvWeights;
+        int start;
+        int end;
+        int numDerivatives;
+    };
+
+    void
+    evalStencilTask(void * data, int taskIndex) {
+
+        StencilTaskData const & d = *static_cast<StencilTaskData *>(data);
+
+        int start = d.start + taskIndex * TaskEvaluator::STENCILS_PER_TASK;
+        int end = std::min(start + TaskEvaluator::STENCILS_PER_TASK, d.end);
+
+        //  The CPU kernel writes the first stencil evaluated to the first
+        //  element of the destination:
+        int dstIndex = start - d.start;
+
+        float * dst = elementAt(d.dst, d.dstDesc, dstIndex);
+        float * du  = elementAt(d.du,  d.duDesc,  dstIndex);
+        float * dv  = elementAt(d.dv,  d.dvDesc,  dstIndex);
+        float * duu = elementAt(d.duu, d.duuDesc, dstIndex);
+        float * duv = elementAt(d.duv, d.duvDesc, dstIndex);
+        float * dvv = elementAt(d.dvv, d.dvvDesc, dstIndex);
+
+        if (d.numDerivatives == 0) {
+            CpuEvaluator::EvalStencils(d.src, d.srcDesc, dst, d.dstDesc,
+                d.sizes, d.offsets, d.indices, d.weights, start, end);
+        } else if (d.numDerivatives == 1) {
+            CpuEvaluator::EvalStencils(d.src, d.srcDesc, dst, d.dstDesc,
+                du, d.duDesc, dv, d.dvDesc,
+                d.sizes, d.offsets, d.indices,
+                d.weights, d.duWeights, d.dvWeights, start, end);
+        } else {
+            CpuEvaluator::EvalStencils(d.src, d.srcDesc, dst, d.dstDesc,
+                du, d.duDesc, dv, d.dvDesc,
+                duu, d.duuDesc, duv, d.duvDesc, dvv, d.dvvDesc,
+                d.sizes, d.offsets, d.indices,
+                d.weights, d.duWeights, d.dvWeights,
+                d.duuWeights, d.duvWeights, d.dvvWeights, start, end);
+        }
+    }
+
+    //
+    //  Arguments of patch evaluation:
+    //
+    struct PatchTaskData {
+        float const * src;
+        float * dst;
+        float * du;
+        float * dv;
+        float * duu;
+        float * duv;
+        float * dvv;
+        BufferDescriptor srcDesc;
+        BufferDescriptor dstDesc;
+        BufferDescriptor duDesc;
+        BufferDescriptor dvDesc;
+        BufferDescriptor duuDesc;
+        BufferDescriptor duvDesc;
+        BufferDescriptor dvvDesc;
+        int numPatchCoords;
+        PatchCoord const * patchCoords;
+        PatchArray const * patchArrays;
+        int const * patchIndexBuffer;
+        PatchParam const * patchParamBuffer;
+        int numDerivatives;
+    };
+
+    void
+    evalPatchTask(void * data, int taskIndex) {
+
+        PatchTaskData const & d = *static_cast<PatchTaskData *>(data);
+
+        int begin = taskIndex * TaskEvaluator::PATCH_COORDS_PER_TASK;
+        int count = std::min(TaskEvaluator::PATCH_COORDS_PER_TASK,
+                             d.numPatchCoords - begin);
+
+        float * dst = elementAt(d.dst, d.dstDesc, begin);
+        float * du  = elementAt(d.du,  d.duDesc,  begin);
+        float * dv  = elementAt(d.dv,  d.dvDesc,  begin);
+        float * duu = elementAt(d.duu, d.duuDesc, begin);
+        float * duv = elementAt(d.duv, d.duvDesc, begin);
+        float * dvv = elementAt(d.dvv, d.dvvDesc, begin);
+
+        if (d.numDerivatives == 0) {
+            CpuEvaluator::EvalPatches(d.src, d.srcDesc, dst, d.dstDesc,
+                count, d.patchCoords + begin,
+                d.patchArrays, d.patchIndexBuffer, d.patchParamBuffer);
+        } else if (d.numDerivatives == 1) {
+            CpuEvaluator::EvalPatches(d.src, d.srcDesc, dst, d.dstDesc,
+                du, d.duDesc, dv, d.dvDesc,
+                count, d.patchCoords + begin,
+                d.patchArrays, d.patchIndexBuffer, d.patchParamBuffer);
+        } else {
+            CpuEvaluator::EvalPatches(d.src, d.srcDesc, dst, d.dstDesc,
+                du, d.duDesc, dv, d.dvDesc,
+                duu, d.duuDesc, duv, d.duvDesc, dvv, d.dvvDesc,
+                count, d.patchCoords + begin,
+                d.patchArrays, d.patchIndexBuffer, d.patchParamBuffer);
+        }
+    }
+
+    bool
+    evalStencils(StencilTaskData & data, void * deviceContext) {
+
+        if (data.end <= data.start) return true;
+        if (data.srcDesc.length != data.dstDesc.length) return false;
+        if (data.numDerivatives > 0) {
+            if (data.srcDesc.length != data.duDesc.length) return false;
+            if (data.srcDesc.length != data.dvDesc.length) return false;
+        }
+        if (data.numDerivatives > 1) {
+            if (data.srcDesc.length != data.duuDesc.length) return false;
+            if (data.srcDesc.length != data.duvDesc.length) return false;
+            if (data.srcDesc.length != data.dvvDesc.length) return false;
+        }
+
+        runTasks(deviceContext,
+                 numTasksFor(data.end - data.start,
+                             TaskEvaluator::STENCILS_PER_TASK),
+                 evalStencilTask, &data);
+        return true;
+    }
+
+    bool
+    evalPatches(PatchTaskData & data, void * deviceContext) {
+
+        if (data.src == 0) return false;
+        if (data.dst && (data.srcDesc.length != data.dstDesc.length)) {
+            return false;
+        }
+        if ((data.numDerivatives == 0) && (data.dst == 0)) return false;
+
+        float const * derivs[5] = { data.du, data.dv,
+                                    data.duu, data.duv, data.dvv };
+        BufferDescriptor const * derivDescs[5] = { &data.duDesc, &data.dvDesc,
+            &data.duuDesc, &data.duvDesc, &data.dvvDesc };
+        for (int i = 0; i < 5; ++i) {
+            if (derivs[i] && (data.srcDesc.length != derivDescs[i]->length)) {
+                return false;
+            }
+        }
+
+        runTasks(deviceContext,
+                 numTasksFor(data.numPatchCoords,
+                             TaskEvaluator::PATCH_COORDS_PER_TASK),
+                 evalPatchTask, &data);
+        return true;
+    }
+
+    StencilTaskData
+    initStencilTaskData(float const * src, BufferDescriptor const & srcDesc,
+                        float * dst,       BufferDescriptor const & dstDesc,
+                        int const * sizes,
+                        Far::Offset const * offsets,
+                        int const * indices,
+                        float const * weights,
+                        int start, int end) {
+
+        StencilTaskData data;
+        data.src = src;
+        data.dst = dst;
+        data.du = data.dv = data.duu = data.duv = data.dvv = 0;
+        data.srcDesc = srcDesc;
+        data.dstDesc = dstDesc;
+        data.sizes = sizes;
+        data.offsets = offsets;
+        data.indices = indices;
+        data.weights = weights;
+        data.duWeights = data.dvWeights = 0;
+        data.duuWeights = data.duvWeights = data.dvvWeights = 0;
+        data.start = start;
+        data.end = end;
+        data.numDerivatives = 0;
+        return data;
+    }
+
+    PatchTaskData
+    initPatchTaskData(float const * src, BufferDescriptor const & srcDesc,
+                      float * dst,       BufferDescriptor const & dstDesc,
+                      int numPatchCoords,
+                      PatchCoord const * patchCoords,
+                      PatchArray const * patchArrays,
+                      int const * patchIndexBuffer,
+                      PatchParam const * patchParamBuffer) {
+
+        PatchTaskData data;
+        data.src = src;
+        data.dst = dst;
+        data.du = data.dv = data.duu = data.duv = data.dvv = 0;
+        data.srcDesc = srcDesc;
+        data.dstDesc = dstDesc;
+        data.numPatchCoords = numPatchCoords;
+        data.patchCoords = patchCoords;
+        data.patchArrays = patchArrays;
+        data.patchIndexBuffer = patchIndexBuffer;
+        data.patchParamBuffer = patchParamBuffer;
+        data.numDerivatives = 0;
+        return data;
+    }
+} // end namespace
+
+/* static */
+bool
+TaskEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                            float *dst,       BufferDescriptor const &dstDesc,
+                            const int * sizes,
+                            const Far::Offset * offsets,
+                            const int * indices,
+                            const float * weights,
+                            int start, int end,
+                            void * deviceContext) {
+
+    StencilTaskData data = initStencilTaskData(src, srcDesc, dst, dstDesc,
+        sizes, offsets, indices, weights, start, end);
+
+    return evalStencils(data, deviceContext);
+}
+
+/* static */
+bool
+TaskEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                            float *dst,       BufferDescriptor const &dstDesc,
+                            float *du,        BufferDescriptor const &duDesc,
+                            float *dv,        BufferDescriptor const &dvDesc,
+                            const int * sizes,
+                            const Far::Offset * offsets,
+                            const int * indices,
+                            const float * weights,
+                            const float * duWeights,
+                            const float * dvWeights,
+                            int start, int end,
+                            void * deviceContext) {
+
+    StencilTaskData data = initStencilTaskData(src, srcDesc, dst, dstDesc,
+        sizes, offsets, indices, weights, start, end);
+    data.du = du;
+    data.dv = dv;
+    data.duDesc = duDesc;
+    data.dvDesc = dvDesc;
+    data.duWeights = duWeights;
+    data.dvWeights = dvWeights;
+    data.numDerivatives = 1;
+
+    return evalStencils(data, deviceContext);
+}
+
+/* static */
+bool
+TaskEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                            float *dst,       BufferDescriptor const &dstDesc,
+                            float *du,        BufferDescriptor const &duDesc,
+                            float *dv,        BufferDescriptor const &dvDesc,
+                            float *duu,       BufferDescriptor const &duuDesc,
+                            float *duv,       BufferDescriptor const &duvDesc,
+                            float *dvv,       BufferDescriptor const &dvvDesc,
+                            const int * sizes,
+                            const Far::Offset * offsets,
+                            const int * indices,
+                            const float * weights,
+                            const float * duWeights,
+                            const float * dvWeights,
+                            const float * duuWeights,
+                            const float * duvWeights,
+                            const float * dvvWeights,
+                            int start, int end,
+                            void * deviceContext) {
+
+    StencilTaskData data = initStencilTaskData(src, srcDesc, dst, dstDesc,
+        sizes, offsets, indices, weights, start, end);
+    data.du  = du;
+    data.dv  = dv;
+    data.duu = duu;
+    data.duv = duv;
+    data.dvv = dvv;
+    data.duDesc  = duDesc;
+    data.dvDesc  = dvDesc;
+    data.duuDesc = duuDesc;
+    data.duvDesc = duvDesc;
+    data.dvvDesc = dvvDesc;
+    data.duWeights  = duWeights;
+    data.dvWeights  = dvWeights;
+    data.duuWeights = duuWeights;
+    data.duvWeights = duvWeights;
+    data.dvvWeights = dvvWeights;
+    data.numDerivatives = 2;
+
+    return evalStencils(data, deviceContext);
+}
+
+/* static */
+bool
+TaskEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           int numPatchCoords,
+                           const PatchCoord *patchCoords,
+                           const PatchArray *patchArrays,
+                           const int *patchIndexBuffer,
+                           const PatchParam *patchParamBuffer,
+                           void * deviceContext) {
+
+    PatchTaskData data = initPatchTaskData(src, srcDesc, dst, dstDesc,
+        numPatchCoords, patchCoords,
+        patchArrays, patchIndexBuffer, patchParamBuffer);
+
+    return evalPatches(data, deviceContext);
+}
+
+/* static */
+bool
+TaskEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           float *du,        BufferDescriptor const &duDesc,
+                           float *dv,        BufferDescriptor const &dvDesc,
+                           int numPatchCoords,
+                           const PatchCoord *patchCoords,
+                           const PatchArray *patchArrays,
+                           const int *patchIndexBuffer,
+                           const PatchParam *patchParamBuffer,
+                           void * deviceContext) {
+
+    PatchTaskData data = initPatchTaskData(src, srcDesc, dst, dstDesc,
+        numPatchCoords, patchCoords,
+        patchArrays, patchIndexBuffer, patchParamBuffer);
+    data.du = du;
+    data.dv = dv;
+    data.duDesc = duDesc;
+    data.dvDesc = dvDesc;
+    data.numDerivatives = 1;
+
+    return evalPatches(data, deviceContext);
+}
+
+/* static */
+bool
+TaskEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           float *du,        BufferDescriptor const &duDesc,
+                           float *dv,        BufferDescriptor const &dvDesc,
+                           float *duu,       BufferDescriptor const &duuDesc,
+                           float *duv,       BufferDescriptor const &duvDesc,
+                           float *dvv,       BufferDescriptor const &dvvDesc,
+                           int numPatchCoords,
+                           const PatchCoord *patchCoords,
+                           const PatchArray *patchArrays,
+                           const int *patchIndexBuffer,
+                           const PatchParam *patchParamBuffer,
+                           void * deviceContext) {
+
+    PatchTaskData data = initPatchTaskData(src, srcDesc, dst, dstDesc,
+        numPatchCoords, patchCoords,
+        patchArrays, patchIndexBuffer, patchParamBuffer);
+    data.du  = du;
+    data.dv  = dv;
+    data.duu = duu;
+    data.duv = duv;
+    data.dvv = dvv;
+    data.duDesc  = duDesc;
+    data.dvDesc  = dvDesc;
+    data.duuDesc = duuDesc;
+    data.duvDesc = duvDesc;
+    data.dvvDesc = dvvDesc;
+    data.numDerivatives = 2;
+
+    return evalPatches(data, deviceContext);
+}
+
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
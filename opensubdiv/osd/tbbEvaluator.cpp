@@ -24,8 +24,28 @@
 
 #include "../osd/tbbEvaluator.h"
 #include "../osd/tbbKernel.h"
+#include "../osd/cpuKernel.h"
+#include "../far/stencilTable.h"
+#include "../far/trace.h"
 
+// (any TBB header defines TBB_INTERFACE_VERSION)
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#if TBB_INTERFACE_VERSION >= 11000
+#include <tbb/global_control.h>
+#else
 #include <tbb/task_scheduler_init.h>
+#endif
+
+#if TBB_INTERFACE_VERSION >= 12000
+#include <tbb/info.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -38,11 +58,36 @@ TbbEvaluator::EvalStencils(
     const float *src, BufferDescriptor const &srcDesc,
     float *dst,       BufferDescriptor const &dstDesc,
     const int * sizes,
-    const int * offsets,
+    const Far::Offset * offsets,
+    const int * indices,
+    const float * weights,
+    const int * stencilIndices, int numStencilIndices) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb");
+
+    if (numStencilIndices <= 0) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    TbbEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, indices, weights,
+                    stencilIndices, numStencilIndices);
+
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalStencils(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    const int * sizes,
+    const Far::Offset * offsets,
     const int * indices,
     const float * weights,
     int start, int end) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb");
+
     if (end <= start) return true;
 
     TbbEvalStencils(src, srcDesc, dst, dstDesc,
@@ -59,13 +104,15 @@ TbbEvaluator::EvalStencils(
     float *du,        BufferDescriptor const &duDesc,
     float *dv,        BufferDescriptor const &dvDesc,
     const int * sizes,
-    const int * offsets,
+    const Far::Offset * offsets,
     const int * indices,
     const float * weights,
     const float * duWeights,
     const float * dvWeights,
     int start, int end) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb");
+
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
     if (srcDesc.length != duDesc.length) return false;
@@ -96,7 +143,7 @@ TbbEvaluator::EvalStencils(
     float *duv,       BufferDescriptor const &duvDesc,
     float *dvv,       BufferDescriptor const &dvvDesc,
     const int * sizes,
-    const int * offsets,
+    const Far::Offset * offsets,
     const int * indices,
     const float * weights,
     const float * duWeights,
@@ -106,6 +153,8 @@ TbbEvaluator::EvalStencils(
     const float * dvvWeights,
     int start, int end) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb");
+
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
     if (srcDesc.length != duDesc.length) return false;
@@ -129,6 +178,45 @@ TbbEvaluator::EvalStencils(
     return true;
 }
 
+/* static */
+bool
+TbbEvaluator::EvalStencils(StencilEvalJob const * jobs, int numJobs) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb");
+
+    for (int i = 0; i < numJobs; ++i) {
+        if (jobs[i].srcDesc.length != jobs[i].dstDesc.length) return false;
+    }
+
+    TbbEvalStencils(jobs, numJobs);
+
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalStencils(PrimvarBinding const * bindings, int numBindings,
+                           const int * sizes,
+                           const Far::Offset * offsets,
+                           const int * indices,
+                           const float * weights,
+                           int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb");
+
+    if (end <= start) return true;
+    for (int b = 0; b < numBindings; ++b) {
+        if (bindings[b].srcDesc.length != bindings[b].dstDesc.length) {
+            return false;
+        }
+    }
+
+    TbbEvalStencils(bindings, numBindings, sizes, offsets, indices, weights,
+                    start, end);
+
+    return true;
+}
+
 /* static */
 bool
 TbbEvaluator::EvalPatches(
@@ -140,6 +228,8 @@ TbbEvaluator::EvalPatches(
     const int *patchIndexBuffer,
     const PatchParam *patchParamBuffer) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.tbb");
+
     if (srcDesc.length != dstDesc.length) return false;
 
     TbbEvalPatches(src, srcDesc, dst, dstDesc,
@@ -167,6 +257,8 @@ TbbEvaluator::EvalPatches(
     const int *patchIndexBuffer,
     const PatchParam *patchParamBuffer) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.tbb");
+
     if (srcDesc.length != dstDesc.length) return false;
 
     TbbEvalPatches(src, srcDesc, dst, dstDesc,
@@ -196,6 +288,8 @@ TbbEvaluator::EvalPatches(
     const int *patchIndexBuffer,
     const PatchParam *patchParamBuffer) {
 
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.tbb");
+
     if (srcDesc.length != dstDesc.length) return false;
 
     TbbEvalPatches(src, srcDesc, dst, dstDesc,
@@ -207,19 +301,367 @@ TbbEvaluator::EvalPatches(
     return true;
 }
 
+/* static */
+bool
+TbbEvaluator::EvalStencilsNormals(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *normal,    BufferDescriptor const &normalDesc,
+    const int * sizes,
+    const Far::Offset * offsets,
+    const int * indices,
+    const float * weights,
+    const float * duWeights,
+    const float * dvWeights,
+    int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb");
+
+    if (end <= start) return true;
+    if (srcDesc.length < 3 || normalDesc.length != 3) return false;
+    if (dst && srcDesc.length != dstDesc.length) return false;
+
+    TbbEvalStencilsNormals(src, srcDesc, dst, dstDesc, normal, normalDesc,
+                           sizes, offsets, indices,
+                           weights, duWeights, dvWeights, start, end);
+
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalPatchesNormals(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *normal,    BufferDescriptor const &normalDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrayBuffer,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.tbb");
+
+    if (srcDesc.length < 3 || normalDesc.length != 3) return false;
+    if (dst && srcDesc.length != dstDesc.length) return false;
+
+    TbbEvalPatchesNormals(src, srcDesc, dst, dstDesc, normal, normalDesc,
+                          numPatchCoords, patchCoords,
+                          patchArrayBuffer, patchIndexBuffer,
+                          patchParamBuffer);
+
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalStencilsSamples(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numSamples, int srcSampleStride, int dstSampleStride,
+    const int * sizes,
+    const Far::Offset * offsets,
+    const int * indices,
+    const float * weights,
+    int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb");
+
+    if (end <= start || numSamples <= 0) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    TbbEvalStencilsSamples(src, srcDesc, dst, dstDesc,
+                           numSamples, srcSampleStride, dstSampleStride,
+                           sizes, offsets, indices, weights, start, end);
+
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalPatchesSamples(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *du,        BufferDescriptor const &duDesc,
+    float *dv,        BufferDescriptor const &dvDesc,
+    int numSamples, int srcSampleStride, int dstSampleStride,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrayBuffer,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.patches.tbb");
+
+    if (!src || !dst || numSamples <= 0) return false;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (du && srcDesc.length != duDesc.length) return false;
+    if (dv && srcDesc.length != dvDesc.length) return false;
+
+    TbbEvalPatchesSamples(src, srcDesc, dst, dstDesc,
+                          du, duDesc, dv, dvDesc,
+                          numSamples, srcSampleStride, dstSampleStride,
+                          numPatchCoords, patchCoords,
+                          patchArrayBuffer, patchIndexBuffer,
+                          patchParamBuffer);
+
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalStencilsBounds(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    const int * sizes,
+    const Far::Offset * offsets,
+    const int * indices,
+    const float * weights,
+    BoundsDescriptor const &bounds,
+    int start, int end) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb");
+
+    if (dstDesc.length < 3 || srcDesc.length != dstDesc.length) return false;
+    if (!bounds.bounds || bounds.numRanges < 1) return false;
+
+    CpuClearBounds(bounds);
+    if (end <= start) return true;
+
+    TbbEvalStencilsBounds(src, srcDesc, dst, dstDesc,
+                          sizes, offsets, indices, weights,
+                          bounds, start, end);
+
+    return true;
+}
+
 /* static */
 void
 TbbEvaluator::Synchronize(void *) {
 }
 
+// ---------------------------------------------------------------------------
+
+#if TBB_INTERFACE_VERSION >= 12000
+//  One arena per NUMA node, constrained to the threads of that node and
+//  shared by all tables (without NUMA support, TBB reports a single node):
+static std::vector<tbb::task_arena>
+createNumaArenas() {
+    std::vector<tbb::numa_node_id> nodes = tbb::info::numa_nodes();
+
+    std::vector<tbb::task_arena> arenas;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        arenas.push_back(tbb::task_arena(
+            tbb::task_arena::constraints(nodes[i])));
+    }
+    return arenas;
+}
+
+static std::vector<tbb::task_arena> &
+getNumaArenas() {
+    static std::vector<tbb::task_arena> arenas = createNumaArenas();
+    return arenas;
+}
+#endif
+
+static void
+touchSlice(float *buffer, BufferDescriptor const &desc, int start, int end) {
+    tbb::parallel_for(tbb::blocked_range<int>(start, end),
+        [=](tbb::blocked_range<int> const &r) {
+            for (int i = r.begin(); i < r.end(); ++i) {
+                std::memset(buffer + desc.offset + i * desc.stride, 0,
+                            desc.length * sizeof(float));
+            }
+        });
+}
+
+TbbNumaStencilTable::TbbNumaStencilTable(Far::StencilTable const *stencilTable)
+    : _numStencils(stencilTable->GetNumStencils()) {
+
+    std::vector<int>         const & sizes   = stencilTable->GetSizes();
+    std::vector<Far::Offset> const & offsets = stencilTable->GetOffsets();
+    std::vector<int>         const & indices = stencilTable->GetControlIndices();
+    std::vector<float>       const & weights = stencilTable->GetWeights();
+
+    //  Balance the number of entries of each node with its concurrency:
+    std::vector<int> concurrency;
+#if TBB_INTERFACE_VERSION >= 12000
+    std::vector<tbb::numa_node_id> nodes = tbb::info::numa_nodes();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        concurrency.push_back(std::max(1,
+            tbb::info::default_concurrency(nodes[i])));
+    }
+#else
+    concurrency.push_back(1);
+#endif
+    long long totalConcurrency = 0;
+    for (size_t i = 0; i < concurrency.size(); ++i) {
+        totalConcurrency += concurrency[i];
+    }
+    long long numEntries = 0;
+    for (int i = 0; i < _numStencils; ++i) {
+        numEntries += sizes[i];
+    }
+
+    _slices.resize(concurrency.size());
+
+    long long entries = 0, nodeConcurrency = 0;
+    for (int i = 0, stencil = 0; i < (int)_slices.size(); ++i) {
+        nodeConcurrency += concurrency[i];
+        long long endEntries = (i == (int)_slices.size() - 1) ? numEntries :
+                               (numEntries * nodeConcurrency) / totalConcurrency;
+
+        _slices[i].start = stencil;
+        while ((stencil < _numStencils) && (entries < endEntries)) {
+            entries += sizes[stencil++];
+        }
+        if (i == (int)_slices.size() - 1) stencil = _numStencils;
+        _slices[i].end = stencil;
+    }
+
+    //  Copy each slice from a thread of its node:
+    for (int i = 0; i < (int)_slices.size(); ++i) {
+        Slice & slice = _slices[i];
+
+        auto copySlice = [&]() {
+            int numSliceStencils = slice.end - slice.start;
+            if (numSliceStencils == 0) return;
+
+            Far::Offset first = offsets[slice.start];
+            Far::Offset last  = offsets[slice.end - 1] + sizes[slice.end - 1];
+
+            slice.sizes.assign(sizes.begin() + slice.start,
+                               sizes.begin() + slice.end);
+            slice.offsets.resize(numSliceStencils);
+            for (int j = 0; j < numSliceStencils; ++j) {
+                slice.offsets[j] = offsets[slice.start + j] - first;
+            }
+            slice.indices.assign(indices.begin() + first,
+                                 indices.begin() + last);
+            slice.weights.assign(weights.begin() + first,
+                                 weights.begin() + last);
+        };
+#if TBB_INTERFACE_VERSION >= 12000
+        getNumaArenas()[i].execute(copySlice);
+#else
+        copySlice();
+#endif
+    }
+}
+
+void
+TbbNumaStencilTable::FirstTouch(float *buffer,
+                                BufferDescriptor const &desc) const {
+
+    for (int i = 0; i < (int)_slices.size(); ++i) {
+        Slice const & slice = _slices[i];
+#if TBB_INTERFACE_VERSION >= 12000
+        getNumaArenas()[i].execute([&]() {
+            touchSlice(buffer, desc, slice.start, slice.end);
+        });
+#else
+        touchSlice(buffer, desc, slice.start, slice.end);
+#endif
+    }
+}
+
+/* static */
+bool
+TbbEvaluator::EvalNumaStencils(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    TbbNumaStencilTable const *stencilTable) {
+
+    OPENSUBDIV_TRACE_SCOPE("eval.stencils.tbb.numa");
+
+    if (srcDesc.length != dstDesc.length) return false;
+
+    std::vector<TbbNumaStencilTable::Slice> const & slices =
+        stencilTable->_slices;
+
+    auto evalSlice = [=, &slices](int i) {
+        TbbNumaStencilTable::Slice const & slice = slices[i];
+        TbbEvalStencils(src, srcDesc,
+                        dst + slice.start * dstDesc.stride, dstDesc,
+                        &slice.sizes[0], &slice.offsets[0],
+                        &slice.indices[0], &slice.weights[0],
+                        0, slice.end - slice.start);
+    };
+
+#if TBB_INTERFACE_VERSION >= 12000
+    //  Run the slices of all nodes concurrently, each in the arena of its
+    //  node, then wait for all of them:
+    std::vector<tbb::task_arena> & arenas = getNumaArenas();
+    std::vector<tbb::task_group> groups(slices.size());
+    for (int i = 0; i < (int)slices.size(); ++i) {
+        if (slices[i].start == slices[i].end) continue;
+        tbb::task_group & group = groups[i];
+        arenas[i].execute([&group, &evalSlice, i]() {
+            group.run([&evalSlice, i]() { evalSlice(i); });
+        });
+    }
+    for (int i = 0; i < (int)slices.size(); ++i) {
+        if (slices[i].start == slices[i].end) continue;
+        tbb::task_group & group = groups[i];
+        arenas[i].execute([&group]() { group.wait(); });
+    }
+#else
+    for (int i = 0; i < (int)slices.size(); ++i) {
+        if (slices[i].start == slices[i].end) continue;
+        evalSlice(i);
+    }
+#endif
+    return true;
+}
+
+#if TBB_INTERFACE_VERSION >= 11000
+//  The limit on the number of threads persists for the lifetime of the
+//  global_control object:
+static tbb::global_control * s_globalControl = NULL;
+#endif
+
 /* static */
 void
 TbbEvaluator::SetNumThreads(int numThreads) {
+#if TBB_INTERFACE_VERSION >= 11000
+    delete s_globalControl;
+    s_globalControl = NULL;
+    if (numThreads != -1) {
+        s_globalControl = new tbb::global_control(
+            tbb::global_control::max_allowed_parallelism, numThreads);
+    }
+#else
     if (numThreads == -1) {
         tbb::task_scheduler_init init;
     } else {
         tbb::task_scheduler_init init(numThreads);
     }
+#endif
+}
+
+/* static */
+void
+TbbEvaluator::SetPatchEvalOptions(PatchEvalOptions const &options) {
+    TbbSetPatchEvalOptions(options.grainSize, options.partitioner,
+                           options.groupByPatch, options.isolate);
+}
+
+/* static */
+void
+TbbEvaluator::SetStencilEvalOptions(StencilEvalOptions const &options) {
+    TbbSetStencilEvalOptions(options.grainSize, options.isolate);
+}
+
+/* static */
+void
+TbbEvaluator::SetReproducible(bool reproducible) {
+    CpuSetReproducible(reproducible);
+}
+
+/* static */
+bool
+TbbEvaluator::IsReproducible() {
+    return CpuIsReproducible();
 }
 
 }  // end namespace Osd
@@ -30,12 +30,76 @@
 #include "../osd/types.h"
 
 #include <cstddef>
+#include <vector>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+namespace Far {
+    class StencilTable;
+}
+
 namespace Osd {
 
+/// \brief Stencil table partitioned across the NUMA nodes of the system
+///
+/// The stencils are split into one contiguous range per NUMA node, balanced
+/// by number of entries and by the concurrency of each node.  The slice of
+/// each range is allocated and first-touched by a thread of its node, and
+/// TbbEvaluator::EvalStencils() evaluates each range in a task arena
+/// constrained to the threads of its node, so that the table is read from
+/// local memory.
+///
+/// Since each node always writes the same range of the destination buffer,
+/// pages of the buffer first written by an evaluation are also local to the
+/// node writing them.  FirstTouch() does so explicitly for a newly allocated
+/// buffer.
+///
+/// With a single NUMA node, or a TBB version without NUMA support, the table
+/// has a single slice and is evaluated as a Far::StencilTable.
+///
+class TbbNumaStencilTable {
+public:
+    static TbbNumaStencilTable * Create(Far::StencilTable const *stencilTable,
+                                        void *deviceContext = NULL) {
+        (void)deviceContext;  // unused
+        return new TbbNumaStencilTable(stencilTable);
+    }
+
+    explicit TbbNumaStencilTable(Far::StencilTable const *stencilTable);
+
+    /// \brief Returns the number of stencils of the table
+    int GetNumStencils() const { return _numStencils; }
+
+    /// \brief Returns the number of slices (one per NUMA node)
+    int GetNumSlices() const { return (int)_slices.size(); }
+
+    /// \brief Returns the range of stencils of a slice
+    void GetSliceRange(int slice, int *start, int *end) const {
+        *start = _slices[slice].start;
+        *end = _slices[slice].end;
+    }
+
+    /// \brief Zeroes the elements of a newly allocated buffer, writing the
+    ///        range of each slice from the threads of its node
+    void FirstTouch(float *buffer, BufferDescriptor const &desc) const;
+
+private:
+    friend class TbbEvaluator;
+
+    struct Slice {
+        int start, end;
+
+        std::vector<int>         sizes;
+        std::vector<Far::Offset> offsets;
+        std::vector<int>         indices;
+        std::vector<float>       weights;
+    };
+
+    int                _numStencils;
+    std::vector<Slice> _slices;
+};
+
 class TbbEvaluator {
 public:
     /// ----------------------------------------------------------------------
@@ -122,7 +186,7 @@ public:
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
         const int * sizes,
-        const int * offsets,
+        const Far::Offset * offsets,
         const int * indices,
         const float * weights,
         int start, int end);
@@ -237,7 +301,7 @@ public:
         float *du,        BufferDescriptor const &duDesc,
         float *dv,        BufferDescriptor const &dvDesc,
         const int * sizes,
-        const int * offsets,
+        const Far::Offset * offsets,
         const int * indices,
         const float * weights,
         const float * duWeights,
@@ -405,7 +469,7 @@ public:
         float *duv,       BufferDescriptor const &duvDesc,
         float *dvv,       BufferDescriptor const &dvvDesc,
         const int * sizes,
-        const int * offsets,
+        const Far::Offset * offsets,
         const int * indices,
         const float * weights,
         const float * duWeights,
@@ -415,6 +479,237 @@ public:
         const float * dvvWeights,
         int start, int end);
 
+    /// \brief Batched stencil evaluation of several meshes
+    ///
+    /// Evaluates the stencils of all jobs in a single parallel dispatch. Each
+    /// job has its own buffers and stencil table, so that many small meshes
+    /// can be evaluated together without paying the dispatch overhead of one
+    /// EvalStencils() call per mesh.
+    ///
+    /// @param jobs           array of stencil evaluation jobs
+    ///
+    /// @param numJobs        number of jobs
+    ///
+    /// @return               false if the descriptors of any job mismatch, in
+    ///                       which case no job is evaluated
+    ///
+    static bool EvalStencils(StencilEvalJob const * jobs, int numJobs);
+
+    /// \brief Generic static eval stencils function with a
+    ///        TbbNumaStencilTable, evaluating the slice of each NUMA node
+    ///        with the threads of that node
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   TbbNumaStencilTable
+    ///
+    /// @param instance       not used in the tbb kernel
+    ///
+    /// @param deviceContext  not used in the tbb kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        TbbNumaStencilTable const *stencilTable,
+        TbbEvaluator const *instance = NULL,
+        void *deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalNumaStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                                dstBuffer->BindCpuBuffer(), dstDesc,
+                                stencilTable);
+    }
+
+    /// \brief Static eval stencils function with a TbbNumaStencilTable which
+    ///        takes raw CPU pointers for input and output.
+    ///
+    /// @param src            Input primvar pointer. An offset of srcDesc
+    ///                       will be applied internally (i.e. the pointer
+    ///                       should not include the offset)
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer. An offset of dstDesc
+    ///                       will be applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   TbbNumaStencilTable
+    ///
+    static bool EvalNumaStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        TbbNumaStencilTable const *stencilTable);
+
+    /// \brief Static eval stencils function applying the stencils of a table
+    ///        to several primvars in a single pass (see PrimvarBinding)
+    ///
+    /// @param bindings       array of primvar bindings, with raw CPU pointers
+    ///
+    /// @param numBindings    number of primvar bindings
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param instance       not used in the tbb kernel
+    ///                       (declared as a typed pointer to prevent
+    ///                        undesirable template resolution)
+    ///
+    /// @param deviceContext  not used in the tbb kernel
+    ///
+    template <typename STENCIL_TABLE>
+    static bool EvalStencils(
+        PrimvarBinding const * bindings, int numBindings,
+        STENCIL_TABLE const *stencilTable,
+        const TbbEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalStencils(bindings, numBindings,
+                            &stencilTable->GetSizes()[0],
+                            &stencilTable->GetOffsets()[0],
+                            &stencilTable->GetControlIndices()[0],
+                            &stencilTable->GetWeights()[0],
+                            /*start = */ 0,
+                            /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function applying the stencils to several
+    ///        primvars in a single pass, which takes raw CPU pointers
+    ///
+    /// @param bindings       array of primvar bindings
+    ///
+    /// @param numBindings    number of primvar bindings
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    /// @return               false if the descriptors of any binding
+    ///                       mismatch, in which case nothing is evaluated
+    ///
+    static bool EvalStencils(
+        PrimvarBinding const * bindings, int numBindings,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        int start, int end);
+
+    /// \brief Generic static eval stencils function for a subset of the
+    ///        stencils of a table.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param stencilIndices indices of the stencils to evaluate -- each is
+    ///                       written to the element of dstBuffer of the same
+    ///                       index, other elements are not modified
+    ///
+    /// @param numStencilIndices number of stencil indices
+    ///
+    /// @param instance       not used in the tbb kernel
+    ///
+    /// @param deviceContext  not used in the tbb kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        STENCIL_TABLE const *stencilTable,
+        const int * stencilIndices, int numStencilIndices,
+        TbbEvaluator const *instance = NULL,
+        void *deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            &stencilTable->GetSizes()[0],
+                            &stencilTable->GetOffsets()[0],
+                            &stencilTable->GetControlIndices()[0],
+                            &stencilTable->GetWeights()[0],
+                            stencilIndices, numStencilIndices);
+    }
+
+    /// \brief Static eval stencils function for a subset of the stencils of
+    ///        a table, which takes raw CPU pointers for input and output.
+    ///
+    /// @param src            Input primvar pointer. An offset of srcDesc
+    ///                       will be applied internally (i.e. the pointer
+    ///                       should not include the offset)
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer. An offset of dstDesc
+    ///                       will be applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param stencilIndices indices of the stencils to evaluate
+    ///
+    /// @param numStencilIndices number of stencil indices
+    ///
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const int * stencilIndices, int numStencilIndices);
+
     /// ----------------------------------------------------------------------
     ///
     ///   Limit evaluations with PatchTable
@@ -1219,19 +1514,725 @@ public:
 
     /// ----------------------------------------------------------------------
     ///
-    ///   Other methods
+    ///   Normal evaluations
     ///
     /// ----------------------------------------------------------------------
 
-    /// \brief synchronize all asynchronous computation invoked on this device.
-    static void Synchronize(void *deviceContext = NULL);
+    /// \brief Generic static eval stencils function writing the unit normals
+    ///        of the limit surface -- the normalized cross product of the
+    ///        first three elements of the derivatives, which are accumulated
+    ///        in the kernel but not written -- and the limit points.
+    ///
+    /// @param srcBuffer      Input primvar buffer (of at least 3 elements).
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param normalBuffer   Output buffer of the normals
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param normalDesc     vertex buffer descriptor for the normalBuffer
+    ///                       (of length 3)
+    ///
+    /// @param stencilTable   Far::LimitStencilTable or equivalent
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        STENCIL_TABLE const *stencilTable,
+        const TbbEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
 
-    /// \brief initialize tbb task schedular
-    ///        (optional: client may use tbb::task_scheduler_init)
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencilsNormals(srcBuffer->BindCpuBuffer(), srcDesc,
+                                   dstBuffer->BindCpuBuffer(), dstDesc,
+                                   normalBuffer->BindCpuBuffer(), normalDesc,
+                                   &stencilTable->GetSizes()[0],
+                                   &stencilTable->GetOffsets()[0],
+                                   &stencilTable->GetControlIndices()[0],
+                                   &stencilTable->GetWeights()[0],
+                                   &stencilTable->GetDuWeights()[0],
+                                   &stencilTable->GetDvWeights()[0],
+                                   /*start = */ 0,
+                                   /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Generic static eval stencils function writing only the unit
+    ///        normals of the limit surface (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        STENCIL_TABLE const *stencilTable,
+        const TbbEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencilsNormals(srcBuffer->BindCpuBuffer(), srcDesc,
+                                   NULL, BufferDescriptor(),
+                                   normalBuffer->BindCpuBuffer(), normalDesc,
+                                   &stencilTable->GetSizes()[0],
+                                   &stencilTable->GetOffsets()[0],
+                                   &stencilTable->GetControlIndices()[0],
+                                   &stencilTable->GetWeights()[0],
+                                   &stencilTable->GetDuWeights()[0],
+                                   &stencilTable->GetDvWeights()[0],
+                                   /*start = */ 0,
+                                   /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function writing the unit normals of the
+    ///        limit surface, which takes raw CPU pointers for input and
+    ///        output.
     ///
-    /// @param numThreads      how many threads
+    /// @param src            Input primvar pointer (of at least 3 elements).
+    ///                       An offset of srcDesc will be applied internally
     ///
-    static void SetNumThreads(int numThreads);
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer (or NULL to write only
+    ///                       the normals). An offset of dstDesc will be
+    ///                       applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param normal         Output pointer of the normals. An offset of
+    ///                       normalDesc will be applied internally.
+    ///
+    /// @param normalDesc     vertex buffer descriptor for the normals
+    ///                       (of length 3)
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param duWeights      pointer to the du-weights buffer of the stencil table
+    ///
+    /// @param dvWeights      pointer to the dv-weights buffer of the stencil table
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    static bool EvalStencilsNormals(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *normal,    BufferDescriptor const &normalDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        int start, int end);
+
+    /// \brief Generic limit eval function writing the unit normals of the
+    ///        limit surface and the limit points (see EvalStencilsNormals()).
+    ///
+    /// @param srcBuffer        Input primvar buffer (of at least 3 elements).
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param normalBuffer     Output buffer of the normals
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param normalDesc       vertex buffer descriptor for the normalBuffer
+    ///                         (of length 3)
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,    BufferDescriptor const &dstDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        TbbEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesNormals(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  dstBuffer->BindCpuBuffer(), dstDesc,
+                                  normalBuffer->BindCpuBuffer(), normalDesc,
+                                  numPatchCoords,
+                                  (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                                  patchTable->GetPatchArrayBuffer(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Generic limit eval function writing only the unit normals of
+    ///        the limit surface (see above).
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesNormals(
+        SRC_BUFFER *srcBuffer,    BufferDescriptor const &srcDesc,
+        DST_BUFFER *normalBuffer, BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        TbbEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesNormals(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  NULL, BufferDescriptor(),
+                                  normalBuffer->BindCpuBuffer(), normalDesc,
+                                  numPatchCoords,
+                                  (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                                  patchTable->GetPatchArrayBuffer(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static limit eval function writing the unit normals of the
+    ///        limit surface, which takes raw CPU pointers for input and
+    ///        output.
+    ///
+    /// @param src              Input primvar pointer (of at least 3
+    ///                         elements). An offset of srcDesc will be
+    ///                         applied internally
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst              Output primvar pointer (or NULL to write only
+    ///                         the normals). An offset of dstDesc will be
+    ///                         applied internally.
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param normal           Output pointer of the normals. An offset of
+    ///                         normalDesc will be applied internally.
+    ///
+    /// @param normalDesc       vertex buffer descriptor for the normals
+    ///                         (of length 3)
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///                         indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer an array of patch indices
+    ///                         indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer an array of Osd::PatchParam struct
+    ///                         indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatchesNormals(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *normal,    BufferDescriptor const &normalDesc,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Time-sampled evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static eval stencils function evaluating several time
+    ///        samples of the primvars (e.g. the cage positions from shutter
+    ///        open to shutter close for motion blur) in a single traversal of
+    ///        the stencil table, each index and weight being loaded once for
+    ///        all the samples.
+    ///
+    /// @param srcBuffer      Input primvar buffer holding the samples.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor of the first sample of
+    ///                       the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer holding the samples.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor of the first sample of
+    ///                       the output buffer
+    ///
+    /// @param numSamples     number of time samples
+    ///
+    /// @param srcSampleStride  number of floats from a sample of the source
+    ///                       to the next (e.g. the number of vertices times
+    ///                       srcDesc.stride, for samples laid out one after
+    ///                       the other)
+    ///
+    /// @param dstSampleStride  number of floats from a sample of the
+    ///                       destinations to the next
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsSamples(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        STENCIL_TABLE const *stencilTable,
+        const TbbEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencilsSamples(srcBuffer->BindCpuBuffer(), srcDesc,
+                                   dstBuffer->BindCpuBuffer(), dstDesc,
+                                   numSamples, srcSampleStride,
+                                   dstSampleStride,
+                                   &stencilTable->GetSizes()[0],
+                                   &stencilTable->GetOffsets()[0],
+                                   &stencilTable->GetControlIndices()[0],
+                                   &stencilTable->GetWeights()[0],
+                                   /*start = */ 0,
+                                   /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function evaluating several time samples
+    ///        of the primvars, which takes raw CPU pointers for input and
+    ///        output.
+    ///
+    /// @param src            Input primvar pointer of the first sample. An
+    ///                       offset of srcDesc will be applied internally
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer of the first sample. An
+    ///                       offset of dstDesc will be applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param numSamples     number of time samples
+    ///
+    /// @param srcSampleStride  number of floats from a sample of the source
+    ///                       to the next (e.g. the number of vertices times
+    ///                       srcDesc.stride, for samples laid out one after
+    ///                       the other)
+    ///
+    /// @param dstSampleStride  number of floats from a sample of the
+    ///                       destinations to the next
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    static bool EvalStencilsSamples(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        int start, int end);
+
+    /// \brief Generic limit eval function evaluating several time samples of
+    ///        the primvars, the basis of each coord being evaluated once for
+    ///        all the samples (see EvalStencilsSamples()).
+    ///
+    /// @param srcBuffer        Input primvar buffer holding the samples.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor of the first sample
+    ///                         of the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer holding the samples.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor of the first sample
+    ///                         of the output buffer
+    ///
+    /// @param numSamples     number of time samples
+    ///
+    /// @param srcSampleStride  number of floats from a sample of the source
+    ///                         to the next (e.g. the number of vertices times
+    ///                         srcDesc.stride, for samples laid out one after
+    ///                         the other)
+    ///
+    /// @param dstSampleStride  number of floats from a sample of the
+    ///                         destinations to the next
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param instance         not used in the tbb evaluator
+    ///
+    /// @param deviceContext    not used in the tbb evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesSamples(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        TbbEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesSamples(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  dstBuffer->BindCpuBuffer(), dstDesc,
+                                  NULL, BufferDescriptor(),
+                                  NULL, BufferDescriptor(),
+                                  numSamples, srcSampleStride, dstSampleStride,
+                                  numPatchCoords,
+                                  (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                                  patchTable->GetPatchArrayBuffer(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Generic limit eval function evaluating several time samples of
+    ///        the primvars and of their derivatives (see above), the samples
+    ///        of the derivatives being dstSampleStride floats apart as well.
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesSamples(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        TbbEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesSamples(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  dstBuffer->BindCpuBuffer(), dstDesc,
+                                  duBuffer->BindCpuBuffer(),  duDesc,
+                                  dvBuffer->BindCpuBuffer(),  dvDesc,
+                                  numSamples, srcSampleStride, dstSampleStride,
+                                  numPatchCoords,
+                                  (const PatchCoord*)patchCoords->BindCpuBuffer(),
+                                  patchTable->GetPatchArrayBuffer(),
+                                  patchTable->GetPatchIndexBuffer(),
+                                  patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static limit eval function evaluating several time samples of
+    ///        the primvars and optionally of their derivatives, which takes
+    ///        raw CPU pointers for input and output.
+    ///
+    /// @param src              Input primvar pointer of the first sample. An
+    ///                         offset of srcDesc will be applied internally
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst              Output primvar pointer of the first sample. An
+    ///                         offset of dstDesc will be applied internally.
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param du               Output pointer of the first sample of the
+    ///                         derivatives wrt u (or NULL)
+    ///
+    /// @param duDesc           vertex buffer descriptor for the du buffer
+    ///
+    /// @param dv               Output pointer of the first sample of the
+    ///                         derivatives wrt v (or NULL)
+    ///
+    /// @param dvDesc           vertex buffer descriptor for the dv buffer
+    ///
+    /// @param numSamples     number of time samples
+    ///
+    /// @param srcSampleStride  number of floats from a sample of the source
+    ///                         to the next (e.g. the number of vertices times
+    ///                         srcDesc.stride, for samples laid out one after
+    ///                         the other)
+    ///
+    /// @param dstSampleStride  number of floats from a sample of the
+    ///                         destinations to the next
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchArrays      an array of Osd::PatchArray struct
+    ///                         indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer an array of patch indices
+    ///                         indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer an array of Osd::PatchParam struct
+    ///                         indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatchesSamples(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        int numSamples, int srcSampleStride, int dstSampleStride,
+        int numPatchCoords,
+        PatchCoord const *patchCoords,
+        PatchArray const *patchArrays,
+        const int *patchIndexBuffer,
+        PatchParam const *patchParamBuffer);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Bounded stencil evaluations
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static eval stencils function also computing the
+    ///        bounding boxes of the first three elements of the results (see
+    ///        BoundsDescriptor), reduced as they are written rather than in
+    ///        a second pass over the destination buffer.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer (of at least 3 elements).
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   Far::StencilTable or equivalent
+    ///
+    /// @param bounds         ranges of the stencils and their bounding boxes
+    ///
+    /// @param instance       not used in the cpu kernel
+    ///
+    /// @param deviceContext  not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencilsBounds(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        STENCIL_TABLE const *stencilTable,
+        BoundsDescriptor const &bounds,
+        const TbbEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencilsBounds(srcBuffer->BindCpuBuffer(), srcDesc,
+                                  dstBuffer->BindCpuBuffer(), dstDesc,
+                                  &stencilTable->GetSizes()[0],
+                                  &stencilTable->GetOffsets()[0],
+                                  &stencilTable->GetControlIndices()[0],
+                                  &stencilTable->GetWeights()[0],
+                                  bounds,
+                                  /*start = */ 0,
+                                  /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static eval stencils function also computing the bounding
+    ///        boxes of the first three elements of the results, which takes
+    ///        raw CPU pointers for input and output.
+    ///
+    /// @param src            Input primvar pointer. An offset of srcDesc
+    ///                       will be applied internally
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst            Output primvar pointer (of at least 3 elements).
+    ///                       An offset of dstDesc will be applied internally.
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param sizes          pointer to the sizes buffer of the stencil table
+    ///
+    /// @param offsets        pointer to the offsets buffer of the stencil table
+    ///
+    /// @param indices        pointer to the indices buffer of the stencil table
+    ///
+    /// @param weights        pointer to the weights buffer of the stencil table
+    ///
+    /// @param bounds         ranges of the stencils and their bounding boxes,
+    ///                       bounding the stencils from start to end only
+    ///
+    /// @param start          start index of stencil table
+    ///
+    /// @param end            end index of stencil table
+    ///
+    static bool EvalStencilsBounds(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        const int * sizes,
+        const Far::Offset * offsets,
+        const int * indices,
+        const float * weights,
+        BoundsDescriptor const &bounds,
+        int start, int end);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   Other methods
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief synchronize all asynchronous computation invoked on this device.
+    static void Synchronize(void *deviceContext = NULL);
+
+    /// \brief initialize tbb task schedular
+    ///        (optional: client may use tbb::global_control)
+    ///
+    /// @param numThreads      how many threads (-1 restores the default)
+    ///
+    static void SetNumThreads(int numThreads);
+
+    /// \brief Enables or disables reproducible evaluation, shared with
+    ///        CpuEvaluator (see CpuEvaluator::SetReproducible())
+    static void SetReproducible(bool reproducible);
+
+    /// \brief Returns true if reproducible evaluation is enabled
+    static bool IsReproducible();
+
+    /// \brief Options controlling how EvalStencils distributes stencils
+    ///        among tasks
+    ///
+    /// All evaluations run in the task arena of the calling thread, so a
+    /// client sharing TBB with other work, e.g. a renderer, may constrain
+    /// them to the threads of its own arena by calling them within
+    /// tbb::task_arena::execute().  When isolate is set, each evaluation
+    /// also runs in an isolated region (tbb::this_task_arena::isolate), so
+    /// that a thread waiting for its tasks does not take unrelated tasks of
+    /// the arena and the latency of the evaluation is not extended by them.
+    ///
+    struct StencilEvalOptions {
+
+        StencilEvalOptions() :
+            isolate(false),
+            grainSize(200) { }
+
+        unsigned int isolate : 1;  ///< run in an isolated region
+        int          grainSize;    ///< minimum number of stencils per task
+    };
+
+    /// \brief Set the options used by all subsequent EvalStencils calls
+    ///
+    /// @param options         the new options
+    ///
+    static void SetStencilEvalOptions(StencilEvalOptions const &options);
+
+    /// \brief Options controlling how EvalPatches distributes PatchCoords
+    ///        among tasks
+    ///
+    struct PatchEvalOptions {
+
+        enum Partitioner {
+            PARTITIONER_AUTO,     ///< tbb::auto_partitioner (default)
+            PARTITIONER_AFFINITY, ///< tbb::affinity_partitioner, replayed
+                                  ///< across calls
+            PARTITIONER_STATIC,   ///< tbb::static_partitioner
+            PARTITIONER_SIMPLE    ///< tbb::simple_partitioner
+        };
+
+        PatchEvalOptions() :
+            groupByPatch(false),
+            partitioner(PARTITIONER_AUTO),
+            isolate(false),
+            grainSize(200) { }
+
+        unsigned int groupByPatch : 1, ///< visit PatchCoords grouped by patch
+                     partitioner  : 2, ///< partitioner splitting the coords
+                     isolate      : 1; ///< run in an isolated region (see
+                                       ///< StencilEvalOptions)
+        int          grainSize;        ///< minimum number of coords per task
+    };
+
+    /// \brief Set the options used by all subsequent EvalPatches calls
+    ///
+    /// When groupByPatch is set, PatchCoords that are not already ordered by
+    /// patch are evaluated in an order sorted by patch (results are still
+    /// written in the order of the given PatchCoords), so that coords
+    /// sharing a patch are evaluated by the same task.  This is of benefit
+    /// when coords are clustered on relatively few patches but in no
+    /// particular order, at the cost of sorting their indices per call.
+    ///
+    /// The affinity partitioner records the mapping of tasks to threads to
+    /// improve cache reuse across repeated calls with the same number of
+    /// coords.  Its state is shared, so EvalPatches should not be invoked
+    /// concurrently from multiple threads when it is used.
+    ///
+    /// @param options         the new options
+    ///
+    static void SetPatchEvalOptions(PatchEvalOptions const &options);
 };
 
 
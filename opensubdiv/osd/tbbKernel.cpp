@@ -24,15 +24,18 @@
 
 #include "../osd/cpuKernel.h"
 #include "../osd/tbbKernel.h"
+#include "../osd/tbbEvaluator.h"
 #include "../osd/types.h"
 #include "../osd/bufferDescriptor.h"
-#include "../osd/patchBasisCommonTypes.h"
-#include "../osd/patchBasisCommon.h"
-#include "../osd/patchBasisCommonEval.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+#include <tbb/spin_mutex.h>
+#include <tbb/task_arena.h>
+#include <vector>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -75,6 +78,49 @@ copy(float *dst, int dstIndex, const float *src,
     memcpy(dst, src, desc.length*sizeof(float));
 }
 
+//
+//  Scheduling of stencil evaluation -- the grain size of the ranges of
+//  stencils can be set and evaluation optionally isolated (see
+//  TbbEvaluator::StencilEvalOptions):
+//
+namespace {
+    int  stencilEvalGrainSize = grain_size;
+    bool stencilEvalIsolated  = false;
+
+    //  Within an isolated region, a thread waiting for the tasks of the
+    //  evaluation does not take unrelated tasks of the enclosing arena:
+    template <class BODY>
+    void
+    runIsolated(bool isolated, BODY const &body) {
+#if TBB_INTERFACE_VERSION >= 11000
+        if (isolated) {
+            tbb::this_task_arena::isolate(body);
+            return;
+        }
+#else
+        (void)isolated;
+#endif
+        body();
+    }
+
+    template <class KERNEL>
+    void
+    runStencilKernel(int start, int end, KERNEL const &kernel) {
+
+        tbb::blocked_range<int> range(start, end,
+                                      std::max(1, stencilEvalGrainSize));
+        runIsolated(stencilEvalIsolated, [&]() {
+            tbb::parallel_for(range, kernel);
+        });
+    }
+} // end namespace
+
+void
+TbbSetStencilEvalOptions(int grainSize, bool isolate) {
+
+    stencilEvalGrainSize = grainSize;
+    stencilEvalIsolated  = isolate;
+}
 
 class TBBStencilKernel {
 
@@ -84,15 +130,15 @@ class TBBStencilKernel {
     float * _vertexDst;
 
     int const * _sizes;
-    int const * _offsets,
-              * _indices;
+    Far::Offset const * _offsets;
+    int const * _indices;
     float const * _weights;
 
 
 public:
     TBBStencilKernel(float const *src, BufferDescriptor srcDesc,
                      float *dst,       BufferDescriptor dstDesc,
-                     int const * sizes, int const * offsets,
+                     int const * sizes, Far::Offset const * offsets,
                      int const * indices, float const * weights) :
          _srcDesc(srcDesc),
          _dstDesc(dstDesc),
@@ -115,49 +161,46 @@ public:
     }
 
     void operator() (tbb::blocked_range<int> const &r) const {
-#define USE_SIMD
-#ifdef USE_SIMD
-        if (_srcDesc.length==4 && _srcDesc.stride==4 && _dstDesc.stride==4) {
 
-            // SIMD fast path for aligned primvar data (4 floats)
-            int offset = _offsets[r.begin()];
-            ComputeStencilKernel<4>(_vertexSrc, _vertexDst,
-                _sizes, _indices+offset, _weights+offset, r.begin(), r.end());
+        if (_srcDesc.length == _dstDesc.length) {
 
-        } else if (_srcDesc.length==8 && _srcDesc.stride==4 && _dstDesc.stride==4) {
+            // Kernel specialized for the primvar length (up to 16 floats)
+            Far::Offset offset = _offsets[r.begin()];
 
-            // SIMD fast path for aligned primvar data (8 floats)
-            int offset = _offsets[r.begin()];
-            ComputeStencilKernel<8>(_vertexSrc, _vertexDst,
-                _sizes, _indices+offset, _weights+offset, r.begin(), r.end());
+            CpuStencilOutputs<1> out;
+            out.dst[0] = _vertexDst + r.begin() * _dstDesc.stride;
+            out.dstStride[0] = _dstDesc.stride;
+            out.weights[0] = _weights + offset;
 
-        } else {
-#else
-        {
-#endif
-            int const * sizes = _sizes;
-            int const * indices = _indices;
-            float const * weights = _weights;
-
-            if (r.begin()>0) {
-                sizes += r.begin();
-                indices += _offsets[r.begin()];
-                weights += _offsets[r.begin()];
+            if (ComputeFixedLengthStencils<1>(_vertexSrc, _srcDesc.stride,
+                    _srcDesc.length, out, _sizes + r.begin(),
+                    _indices + offset, r.end() - r.begin())) {
+                return;
             }
+        }
 
-            // Slow path for non-aligned data
-            float * result = (float*)alloca(_srcDesc.length * sizeof(float));
+        int const * sizes = _sizes;
+        int const * indices = _indices;
+        float const * weights = _weights;
 
-            for (int i=r.begin(); i<r.end(); ++i, ++sizes) {
+        if (r.begin()>0) {
+            sizes += r.begin();
+            indices += _offsets[r.begin()];
+            weights += _offsets[r.begin()];
+        }
+
+        // Slow path for longer primvars
+        float * result = (float*)alloca(_srcDesc.length * sizeof(float));
 
-                clear(result, _dstDesc);
+        for (int i=r.begin(); i<r.end(); ++i, ++sizes) {
 
-                for (int j=0; j<*sizes; ++j) {
-                    addWithWeight(result, _vertexSrc, *indices++, *weights++, _srcDesc);
-                }
+            clear(result, _dstDesc);
 
-                copy(_vertexDst, i, result, _dstDesc);
+            for (int j=0; j<*sizes; ++j) {
+                addWithWeight(result, _vertexSrc, *indices++, *weights++, _srcDesc);
             }
+
+            copy(_vertexDst, i, result, _dstDesc);
         }
     }
 };
@@ -166,7 +209,7 @@ void
 TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 int start, int end) {
@@ -177,9 +220,7 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     TBBStencilKernel kernel(src, srcDesc, dst, dstDesc,
                             sizes, offsets, indices, weights);
 
-    tbb::blocked_range<int> range(start, end, grain_size);
-
-    tbb::parallel_for(range, kernel);
+    runStencilKernel(start, end, kernel);
 }
 
 void
@@ -188,7 +229,7 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * du,        BufferDescriptor const &duDesc,
                 float * dv,        BufferDescriptor const &dvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -204,22 +245,19 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     if (dst) {
         TBBStencilKernel kernel(src, srcDesc, dst, dstDesc,
                                 sizes, offsets, indices, weights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
+        runStencilKernel(start, end, kernel);
     }
 
     if (du) {
         TBBStencilKernel kernel(src, srcDesc, du, duDesc,
                                 sizes, offsets, indices, duWeights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
+        runStencilKernel(start, end, kernel);
     }
 
     if (dv) {
         TBBStencilKernel kernel(src, srcDesc, dv, dvDesc,
                                 sizes, offsets, indices, dvWeights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
+        runStencilKernel(start, end, kernel);
     }
 
 }
@@ -233,7 +271,7 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * duv,       BufferDescriptor const &duvDesc,
                 float * dvv,       BufferDescriptor const &dvvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -255,77 +293,426 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     if (dst) {
         TBBStencilKernel kernel(src, srcDesc, dst, dstDesc,
                                 sizes, offsets, indices, weights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
+        runStencilKernel(start, end, kernel);
     }
 
     if (du) {
         TBBStencilKernel kernel(src, srcDesc, du, duDesc,
                                 sizes, offsets, indices, duWeights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
+        runStencilKernel(start, end, kernel);
     }
 
     if (dv) {
         TBBStencilKernel kernel(src, srcDesc, dv, dvDesc,
                                 sizes, offsets, indices, dvWeights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
+        runStencilKernel(start, end, kernel);
     }
 
     if (duu) {
         TBBStencilKernel kernel(src, srcDesc, duu, duuDesc,
                                 sizes, offsets, indices, duuWeights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
+        runStencilKernel(start, end, kernel);
     }
 
     if (duv) {
         TBBStencilKernel kernel(src, srcDesc, duv, duvDesc,
                                 sizes, offsets, indices, duvWeights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
+        runStencilKernel(start, end, kernel);
     }
 
     if (dvv) {
         TBBStencilKernel kernel(src, srcDesc, dvv, dvvDesc,
                                 sizes, offsets, indices, dvvWeights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
+        runStencilKernel(start, end, kernel);
     }
 }
 
-// ---------------------------------------------------------------------------
+//
+//  Batched evaluation of the stencils of several jobs -- the stencils of all
+//  jobs are split into chunks (each within a single job) that are evaluated
+//  concurrently with the scalar CPU kernel:
+//
+static const int batchChunkSize = 256;
+
+static void
+splitStencilEvalJobs(StencilEvalJob const * jobs, int numJobs,
+                     std::vector<int> & chunkJobs,
+                     std::vector<int> & chunkStarts) {
+
+    for (int i = 0; i < numJobs; ++i) {
+        for (int start = jobs[i].start; start < jobs[i].end;
+             start += batchChunkSize) {
+            chunkJobs.push_back(i);
+            chunkStarts.push_back(start);
+        }
+    }
+}
+
+static void
+evalStencilEvalJobChunk(StencilEvalJob const & job, int start) {
+
+    int end = std::min(start + batchChunkSize, job.end);
+
+    CpuEvalStencils(job.src, job.srcDesc,
+                    job.dst + (start - job.start) * job.dstDesc.stride,
+                    job.dstDesc,
+                    job.sizes, job.offsets, job.indices, job.weights,
+                    start, end);
+}
+
+class TBBStencilBatchKernel {
 
-template <typename T>
-struct BufferAdapter {
-    BufferAdapter(T *p, int length, int stride) :
-        _p(p), _length(length), _stride(stride) { }
-    void Clear() {
-        for (int i = 0; i < _length; ++i) _p[i] = 0;
+    StencilEvalJob const * _jobs;
+    int const * _chunkJobs;
+    int const * _chunkStarts;
+
+public:
+    TBBStencilBatchKernel(StencilEvalJob const * jobs,
+                          int const * chunkJobs, int const * chunkStarts) :
+        _jobs(jobs), _chunkJobs(chunkJobs), _chunkStarts(chunkStarts) { }
+
+    void operator() (tbb::blocked_range<int> const &r) const {
+        for (int i = r.begin(); i < r.end(); ++i) {
+            evalStencilEvalJobChunk(_jobs[_chunkJobs[i]], _chunkStarts[i]);
+        }
     }
-    void AddWithWeight(T const *src, float w) {
-        if (_p) {
-            for (int i = 0; i < _length; ++i) {
-                _p[i] += src[i] * w;
-            }
+};
+
+void
+TbbEvalStencils(StencilEvalJob const * jobs, int numJobs) {
+
+    std::vector<int> chunkJobs, chunkStarts;
+    splitStencilEvalJobs(jobs, numJobs, chunkJobs, chunkStarts);
+
+    if (chunkJobs.empty()) return;
+
+    TBBStencilBatchKernel kernel(jobs, &chunkJobs[0], &chunkStarts[0]);
+
+    tbb::blocked_range<int> range(0, (int)chunkJobs.size(), 1);
+
+    runIsolated(stencilEvalIsolated, [&]() {
+        tbb::parallel_for(range, kernel);
+    });
+}
+
+//
+//  Evaluation of the stencils for several primvars in a single pass -- each
+//  range is evaluated with the CPU kernel, with its destinations offset to
+//  the first stencil of the range:
+//
+class TBBStencilPrimvarsKernel {
+
+    PrimvarBinding const * _bindings;
+    int _numBindings;
+    int const * _sizes;
+    Far::Offset const * _offsets;
+    int const * _indices;
+    float const * _weights;
+    int _start;
+
+public:
+    TBBStencilPrimvarsKernel(PrimvarBinding const * bindings, int numBindings,
+                             int const * sizes, Far::Offset const * offsets,
+                             int const * indices, float const * weights,
+                             int start) :
+        _bindings(bindings), _numBindings(numBindings),
+        _sizes(sizes), _offsets(offsets),
+        _indices(indices), _weights(weights), _start(start) { }
+
+    void operator() (tbb::blocked_range<int> const &r) const {
+
+        std::vector<PrimvarBinding> bindings(_bindings,
+                                             _bindings + _numBindings);
+        for (int b = 0; b < _numBindings; ++b) {
+            bindings[b].dst += (r.begin() - _start) *
+                               bindings[b].dstDesc.stride;
         }
+
+        CpuEvalStencils(&bindings[0], _numBindings,
+                        _sizes, _offsets, _indices, _weights,
+                        r.begin(), r.end());
     }
-    const T *operator[] (int index) const {
-        return _p + _stride * index;
+};
+
+void
+TbbEvalStencils(PrimvarBinding const * bindings, int numBindings,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end) {
+
+    if (numBindings == 0) return;
+
+    TBBStencilPrimvarsKernel kernel(bindings, numBindings,
+                                    sizes, offsets, indices, weights, start);
+
+    runStencilKernel(start, end, kernel);
+}
+
+//
+//  Evaluation of a subset of the stencils given by a list of indices -- the
+//  list is split into ranges that are evaluated with the CPU kernel:
+//
+class TBBStencilIndexedKernel {
+
+    float const * _src;
+    BufferDescriptor _srcDesc;
+    float * _dst;
+    BufferDescriptor _dstDesc;
+    int const * _sizes;
+    Far::Offset const * _offsets;
+    int const * _indices;
+    float const * _weights;
+    int const * _stencilIndices;
+
+public:
+    TBBStencilIndexedKernel(float const * src, BufferDescriptor const &srcDesc,
+                            float * dst,       BufferDescriptor const &dstDesc,
+                            int const * sizes, Far::Offset const * offsets,
+                            int const * indices, float const * weights,
+                            int const * stencilIndices) :
+        _src(src), _srcDesc(srcDesc), _dst(dst), _dstDesc(dstDesc),
+        _sizes(sizes), _offsets(offsets), _indices(indices),
+        _weights(weights), _stencilIndices(stencilIndices) { }
+
+    void operator() (tbb::blocked_range<int> const &r) const {
+        CpuEvalStencils(_src, _srcDesc, _dst, _dstDesc,
+                        _sizes, _offsets, _indices, _weights,
+                        _stencilIndices + r.begin(), (int)r.size());
     }
-    BufferAdapter<T> & operator ++() {
-        if (_p) {
-            _p += _stride;
-        }
-        return *this;
+};
+
+void
+TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int const * stencilIndices, int numStencilIndices) {
+
+    TBBStencilIndexedKernel kernel(src, srcDesc, dst, dstDesc,
+                                   sizes, offsets, indices, weights,
+                                   stencilIndices);
+
+    runStencilKernel(0, numStencilIndices, kernel);
+}
+
+//
+//  Evaluation of the normals of limit stencils -- each range is evaluated
+//  with the CPU kernel, with its destinations offset to the first stencil of
+//  the range:
+//
+class TBBStencilNormalsKernel {
+
+    float const * _src;
+    BufferDescriptor _srcDesc;
+    float * _dst;
+    BufferDescriptor _dstDesc;
+    float * _normal;
+    BufferDescriptor _normalDesc;
+    int const * _sizes;
+    Far::Offset const * _offsets;
+    int const * _indices;
+    float const * _weights;
+    float const * _duWeights;
+    float const * _dvWeights;
+
+public:
+    TBBStencilNormalsKernel(float const * src, BufferDescriptor const &srcDesc,
+                            float * dst,       BufferDescriptor const &dstDesc,
+                            float * normal,    BufferDescriptor const &normalDesc,
+                            int const * sizes, Far::Offset const * offsets,
+                            int const * indices, float const * weights,
+                            float const * duWeights, float const * dvWeights) :
+        _src(src), _srcDesc(srcDesc), _dst(dst), _dstDesc(dstDesc),
+        _normal(normal), _normalDesc(normalDesc),
+        _sizes(sizes), _offsets(offsets), _indices(indices),
+        _weights(weights), _duWeights(duWeights), _dvWeights(dvWeights) { }
+
+    void operator() (tbb::blocked_range<int> const &r) const {
+        CpuEvalStencilsNormals(_src, _srcDesc,
+            _dst ? _dst + r.begin() * _dstDesc.stride : 0, _dstDesc,
+            _normal + r.begin() * _normalDesc.stride, _normalDesc,
+            _sizes, _offsets, _indices, _weights, _duWeights, _dvWeights,
+            r.begin(), r.end());
     }
+};
 
-    T *_p;
-    int _length;
-    int _stride;
+void
+TbbEvalStencilsNormals(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       float * normal,    BufferDescriptor const &normalDesc,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       float const * duWeights,
+                       float const * dvWeights,
+                       int start, int end) {
+
+    TBBStencilNormalsKernel kernel(src, srcDesc, dst, dstDesc,
+                                   normal, normalDesc,
+                                   sizes, offsets, indices,
+                                   weights, duWeights, dvWeights);
+
+    runStencilKernel(start, end, kernel);
+}
+
+//
+//  Evaluation of time samples -- each range is evaluated with the CPU
+//  kernel, with its destinations offset to the first stencil of the range:
+//
+class TBBStencilSamplesKernel {
+
+    float const * _src;
+    BufferDescriptor _srcDesc;
+    float * _dst;
+    BufferDescriptor _dstDesc;
+    int _numSamples;
+    int _srcSampleStride;
+    int _dstSampleStride;
+    int const * _sizes;
+    Far::Offset const * _offsets;
+    int const * _indices;
+    float const * _weights;
+
+public:
+    TBBStencilSamplesKernel(float const * src, BufferDescriptor const &srcDesc,
+                            float * dst,       BufferDescriptor const &dstDesc,
+                            int numSamples, int srcSampleStride,
+                            int dstSampleStride,
+                            int const * sizes, Far::Offset const * offsets,
+                            int const * indices, float const * weights) :
+        _src(src), _srcDesc(srcDesc), _dst(dst), _dstDesc(dstDesc),
+        _numSamples(numSamples), _srcSampleStride(srcSampleStride),
+        _dstSampleStride(dstSampleStride),
+        _sizes(sizes), _offsets(offsets), _indices(indices),
+        _weights(weights) { }
+
+    void operator() (tbb::blocked_range<int> const &r) const {
+        CpuEvalStencilsSamples(_src, _srcDesc,
+            _dst + r.begin() * _dstDesc.stride, _dstDesc,
+            _numSamples, _srcSampleStride, _dstSampleStride,
+            _sizes, _offsets, _indices, _weights,
+            r.begin(), r.end());
+    }
 };
 
+void
+TbbEvalStencilsSamples(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       int numSamples, int srcSampleStride,
+                       int dstSampleStride,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       int start, int end) {
+
+    TBBStencilSamplesKernel kernel(src, srcDesc, dst, dstDesc,
+                                   numSamples, srcSampleStride,
+                                   dstSampleStride,
+                                   sizes, offsets, indices, weights);
+
+    runStencilKernel(start, end, kernel);
+}
+
+//
+//  Evaluation with bounding boxes -- each range is evaluated with the CPU
+//  kernel into local boxes for the ranges of stencils it overlaps, which are
+//  then merged into the boxes of the descriptor:
+//
+class TBBStencilBoundsKernel {
+
+    float const * _src;
+    BufferDescriptor _srcDesc;
+    float * _dst;
+    BufferDescriptor _dstDesc;
+    int const * _sizes;
+    Far::Offset const * _offsets;
+    int const * _indices;
+    float const * _weights;
+    BoundsDescriptor _bounds;
+    tbb::spin_mutex * _boundsMutex;
+
+public:
+    TBBStencilBoundsKernel(float const * src, BufferDescriptor const &srcDesc,
+                           float * dst,       BufferDescriptor const &dstDesc,
+                           int const * sizes, Far::Offset const * offsets,
+                           int const * indices, float const * weights,
+                           BoundsDescriptor const & bounds,
+                           tbb::spin_mutex * boundsMutex) :
+        _src(src), _srcDesc(srcDesc), _dst(dst), _dstDesc(dstDesc),
+        _sizes(sizes), _offsets(offsets), _indices(indices),
+        _weights(weights), _bounds(bounds), _boundsMutex(boundsMutex) { }
+
+    void operator() (tbb::blocked_range<int> const &r) const {
+
+        //  Identify the boxes of the ranges overlapping r:
+        int first = 0;
+        int last  = 1;
+        if (_bounds.rangeOffsets) {
+            int const * rangeOffsets    = _bounds.rangeOffsets;
+            int const * rangeOffsetsEnd = rangeOffsets + _bounds.numRanges + 1;
+
+            first = (int)(std::upper_bound(rangeOffsets, rangeOffsetsEnd,
+                                           r.begin()) - rangeOffsets) - 1;
+            last  = (int)(std::lower_bound(rangeOffsets, rangeOffsetsEnd,
+                                           r.end()) - rangeOffsets);
+            first = std::max(first, 0);
+            last  = std::min(last, _bounds.numRanges);
+        }
+
+        std::vector<float> localBoxes(std::max(last - first, 0) * 6);
+
+        BoundsDescriptor localBounds;
+        localBounds.numRanges    = (int)localBoxes.size() / 6;
+        localBounds.rangeOffsets = _bounds.rangeOffsets
+                                 ? _bounds.rangeOffsets + first : 0;
+        localBounds.bounds       = localBoxes.empty() ? 0 : &localBoxes[0];
+
+        CpuClearBounds(localBounds);
+        CpuEvalStencilsBounds(_src, _srcDesc,
+            _dst + r.begin() * _dstDesc.stride, _dstDesc,
+            _sizes, _offsets, _indices, _weights,
+            localBounds, r.begin(), r.end());
+
+        tbb::spin_mutex::scoped_lock lock(*_boundsMutex);
+
+        for (int i = 0; i < localBounds.numRanges; ++i) {
+            float const * localBox = &localBoxes[i * 6];
+            float * box = _bounds.bounds + (first + i) * 6;
+            for (int k = 0; k < 3; ++k) {
+                box[k]     = std::min(box[k],     localBox[k]);
+                box[3 + k] = std::max(box[3 + k], localBox[3 + k]);
+            }
+        }
+    }
+};
+
+void
+TbbEvalStencilsBounds(float const * src, BufferDescriptor const &srcDesc,
+                      float * dst,       BufferDescriptor const &dstDesc,
+                      int const * sizes,
+                      Far::Offset const * offsets,
+                      int const * indices,
+                      float const * weights,
+                      BoundsDescriptor const & bounds,
+                      int start, int end) {
+
+    tbb::spin_mutex boundsMutex;
+
+    TBBStencilBoundsKernel kernel(src, srcDesc, dst, dstDesc,
+                                  sizes, offsets, indices, weights,
+                                  bounds, &boundsMutex);
+
+    runStencilKernel(start, end, kernel);
+}
+
+// ---------------------------------------------------------------------------
+
 class TbbEvalPatchesKernel {
     BufferDescriptor _srcDesc;
     BufferDescriptor _dstDesc;
@@ -343,6 +730,7 @@ class TbbEvalPatchesKernel {
     float * _dstDvv;
     int _numPatchCoords;
     const PatchCoord *_patchCoords;
+    const int        *_patchCoordOrder;
     const PatchArray *_patchArrayBuffer;
     const int        *_patchIndexBuffer;
     const PatchParam *_patchParamBuffer;
@@ -357,6 +745,7 @@ public:
                          float *dstDvv,    BufferDescriptor dstDvvDesc,
                          int numPatchCoords,
                          const PatchCoord *patchCoords,
+                         const int *patchCoordOrder,
                          const PatchArray *patchArrayBuffer,
                          const int *patchIndexBuffer,
                          const PatchParam *patchParamBuffer) :
@@ -368,189 +757,213 @@ public:
         _dstDuu(dstDuu), _dstDuv(dstDuv), _dstDvv(dstDvv),
         _numPatchCoords(numPatchCoords),
         _patchCoords(patchCoords),
+        _patchCoordOrder(patchCoordOrder),
         _patchArrayBuffer(patchArrayBuffer),
         _patchIndexBuffer(patchIndexBuffer),
         _patchParamBuffer(patchParamBuffer) {
     }
 
     void operator() (tbb::blocked_range<int> const &r) const {
-        if (_dstDu == NULL && _dstDv == NULL) {
-            compute(r);
-        } else if (_dstDuu == NULL && _dstDuv == NULL && _dstDvv == NULL) {
-            computeWith1stDerivative(r);
-        } else {
-            computeWith2ndDerivative(r);
-        }
+        //  Coords are visited in the given order (if any) and results
+        //  written to the location of each coord in the original array:
+        CpuEvalPatches(_src + _srcDesc.offset, _srcDesc,
+                       offsetBuffer(_dst, _dstDesc), _dstDesc,
+                       offsetBuffer(_dstDu, _dstDuDesc), _dstDuDesc,
+                       offsetBuffer(_dstDv, _dstDvDesc), _dstDvDesc,
+                       offsetBuffer(_dstDuu, _dstDuuDesc), _dstDuuDesc,
+                       offsetBuffer(_dstDuv, _dstDuvDesc), _dstDuvDesc,
+                       offsetBuffer(_dstDvv, _dstDvvDesc), _dstDvvDesc,
+                       _patchCoords, _patchCoordOrder, _patchArrayBuffer,
+                       _patchIndexBuffer, _patchParamBuffer,
+                       r.begin(), r.end());
     }
 
-    void compute(tbb::blocked_range<int> const &r) const {
-        float wP[20];
-        BufferAdapter<const float> srcT(_src + _srcDesc.offset,
-                                        _srcDesc.length,
-                                        _srcDesc.stride);
-        BufferAdapter<float> dstT(_dst + _dstDesc.offset
-                                       + r.begin() * _dstDesc.stride,
-                                  _dstDesc.length,
-                                  _dstDesc.stride);
-
-
-        for (int i = r.begin(); i < r.end(); ++i) {
-            PatchCoord const &coord = _patchCoords[i];
-            PatchArray const &array = _patchArrayBuffer[coord.handle.arrayIndex];
-
-            Osd::PatchParam const & paramStruct =
-                _patchParamBuffer[coord.handle.patchIndex];
-            OsdPatchParam param = OsdPatchParamInit(
-                paramStruct.field0, paramStruct.field1, paramStruct.sharpness);
-
-            int patchType = OsdPatchParamIsRegular(param)
-                ? array.GetPatchTypeRegular()
-                : array.GetPatchTypeIrregular();
-
-            int nPoints = OsdEvaluatePatchBasis(patchType, param,
-                    coord.s, coord.t, wP, 0, 0, 0, 0, 0);
-
-            int indexBase = array.GetIndexBase() + array.GetStride() *
-                    (coord.handle.patchIndex - array.GetPrimitiveIdBase());
-
-            const int *cvs = &_patchIndexBuffer[indexBase];
-
-            dstT.Clear();
-            for (int j = 0; j < nPoints; ++j) {
-                dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
-            }
-            ++dstT;
-        }
+private:
+    static float * offsetBuffer(float *dst, BufferDescriptor const &desc) {
+        return dst ? dst + desc.offset : 0;
     }
+};
 
-    void computeWith1stDerivative(tbb::blocked_range<int> const &r) const {
-        float wP[20], wDu[20], wDv[20];
-        BufferAdapter<const float> srcT(_src + _srcDesc.offset,
-                                        _srcDesc.length,
-                                        _srcDesc.stride);
-        BufferAdapter<float> dstT(_dst + _dstDesc.offset
-                                       + r.begin() * _dstDesc.stride,
-                                  _dstDesc.length,
-                                  _dstDesc.stride);
-        BufferAdapter<float> dstDuT(_dstDu + _dstDuDesc.offset
-                                       + r.begin() * _dstDuDesc.stride,
-                                    _dstDuDesc.length,
-                                    _dstDuDesc.stride);
-        BufferAdapter<float> dstDvT(_dstDv + _dstDvDesc.offset
-                                       + r.begin() * _dstDvDesc.stride,
-                                    _dstDvDesc.length,
-                                    _dstDvDesc.stride);
+//
+//  Evaluation of the normals of patches -- the coords of each range are
+//  evaluated by the CPU kernel (in the order given, not grouped by patch):
+//
+class TbbEvalPatchesNormalsKernel {
+    BufferDescriptor _srcDesc;
+    BufferDescriptor _dstDesc;
+    BufferDescriptor _normalDesc;
+    float const * _src;
+    float * _dst;
+    float * _normal;
+    const PatchCoord *_patchCoords;
+    const PatchArray *_patchArrayBuffer;
+    const int        *_patchIndexBuffer;
+    const PatchParam *_patchParamBuffer;
 
-        for (int i = r.begin(); i < r.end(); ++i) {
-            PatchCoord const &coord = _patchCoords[i];
-            PatchArray const &array = _patchArrayBuffer[coord.handle.arrayIndex];
+public:
+    TbbEvalPatchesNormalsKernel(float const *src, BufferDescriptor srcDesc,
+                                float *dst,       BufferDescriptor dstDesc,
+                                float *normal,    BufferDescriptor normalDesc,
+                                const PatchCoord *patchCoords,
+                                const PatchArray *patchArrayBuffer,
+                                const int *patchIndexBuffer,
+                                const PatchParam *patchParamBuffer) :
+        _srcDesc(srcDesc), _dstDesc(dstDesc), _normalDesc(normalDesc),
+        _src(src), _dst(dst), _normal(normal),
+        _patchCoords(patchCoords),
+        _patchArrayBuffer(patchArrayBuffer),
+        _patchIndexBuffer(patchIndexBuffer),
+        _patchParamBuffer(patchParamBuffer) {
+    }
 
-            Osd::PatchParam const & paramStruct =
-                _patchParamBuffer[coord.handle.patchIndex];
-            OsdPatchParam param = OsdPatchParamInit(
-                paramStruct.field0, paramStruct.field1, paramStruct.sharpness);
+    void operator() (tbb::blocked_range<int> const &r) const {
+        CpuEvalPatchesNormals(_src + _srcDesc.offset, _srcDesc,
+                              _dst ? _dst + _dstDesc.offset : 0, _dstDesc,
+                              _normal + _normalDesc.offset, _normalDesc,
+                              _patchCoords, _patchArrayBuffer,
+                              _patchIndexBuffer, _patchParamBuffer,
+                              r.begin(), r.end());
+    }
+};
 
-            int patchType = OsdPatchParamIsRegular(param)
-                ? array.GetPatchTypeRegular()
-                : array.GetPatchTypeIrregular();
+//
+//  Evaluation of the time samples of patches -- the coords of each range are
+//  evaluated by the CPU kernel (in the order given, not grouped by patch):
+//
+class TbbEvalPatchesSamplesKernel {
+    BufferDescriptor _srcDesc;
+    BufferDescriptor _dstDesc;
+    BufferDescriptor _duDesc;
+    BufferDescriptor _dvDesc;
+    float const * _src;
+    float * _dst;
+    float * _du;
+    float * _dv;
+    int _numSamples;
+    int _srcSampleStride;
+    int _dstSampleStride;
+    const PatchCoord *_patchCoords;
+    const PatchArray *_patchArrayBuffer;
+    const int        *_patchIndexBuffer;
+    const PatchParam *_patchParamBuffer;
 
-            int nPoints = OsdEvaluatePatchBasis(patchType, param,
-                    coord.s, coord.t, wP, wDu, wDv, 0, 0, 0);
+public:
+    TbbEvalPatchesSamplesKernel(float const *src, BufferDescriptor srcDesc,
+                                float *dst,       BufferDescriptor dstDesc,
+                                float *du,        BufferDescriptor duDesc,
+                                float *dv,        BufferDescriptor dvDesc,
+                                int numSamples, int srcSampleStride,
+                                int dstSampleStride,
+                                const PatchCoord *patchCoords,
+                                const PatchArray *patchArrayBuffer,
+                                const int *patchIndexBuffer,
+                                const PatchParam *patchParamBuffer) :
+        _srcDesc(srcDesc), _dstDesc(dstDesc),
+        _duDesc(duDesc), _dvDesc(dvDesc),
+        _src(src), _dst(dst), _du(du), _dv(dv),
+        _numSamples(numSamples), _srcSampleStride(srcSampleStride),
+        _dstSampleStride(dstSampleStride),
+        _patchCoords(patchCoords),
+        _patchArrayBuffer(patchArrayBuffer),
+        _patchIndexBuffer(patchIndexBuffer),
+        _patchParamBuffer(patchParamBuffer) {
+    }
 
-            int indexBase = array.GetIndexBase() + array.GetStride() *
-                    (coord.handle.patchIndex - array.GetPrimitiveIdBase());
+    void operator() (tbb::blocked_range<int> const &r) const {
+        CpuEvalPatchesSamples(_src + _srcDesc.offset, _srcDesc,
+                              _dst + _dstDesc.offset, _dstDesc,
+                              _du ? _du + _duDesc.offset : 0, _duDesc,
+                              _dv ? _dv + _dvDesc.offset : 0, _dvDesc,
+                              _numSamples, _srcSampleStride, _dstSampleStride,
+                              _patchCoords, _patchArrayBuffer,
+                              _patchIndexBuffer, _patchParamBuffer,
+                              r.begin(), r.end());
+    }
+};
 
-            const int *cvs = &_patchIndexBuffer[indexBase];
+//
+//  Scheduling of patch evaluation -- coords may optionally be visited in an
+//  order grouped by patch (so that consecutive coords in a task share the
+//  same control points) and the partitioner used to split the coords among
+//  tasks can be chosen:
+//
+namespace {
+    int patchEvalGrainSize    = grain_size;
+    int patchEvalPartitioner  =
+        TbbEvaluator::PatchEvalOptions::PARTITIONER_AUTO;
+    bool patchEvalGroupByPatch = false;
+    bool patchEvalIsolated     = false;
+
+    //  The affinity partitioner records the mapping of sub-ranges to threads
+    //  to replay it in subsequent calls:
+    tbb::affinity_partitioner patchEvalAffinityPartitioner;
+
+    struct PatchCoordLess {
+        PatchCoordLess(PatchCoord const * coords) : _coords(coords) { }
+
+        bool operator() (int a, int b) const {
+            int pa = _coords[a].handle.patchIndex;
+            int pb = _coords[b].handle.patchIndex;
+            return (pa < pb) || ((pa == pb) && (a < b));
+        }
+        PatchCoord const * _coords;
+    };
+
+    //  Returns false if the coords are already grouped by patch:
+    bool
+    groupPatchCoords(int numPatchCoords, PatchCoord const * patchCoords,
+                     std::vector<int> & order) {
+
+        bool isGrouped = true;
+        for (int i = 1; isGrouped && (i < numPatchCoords); ++i) {
+            isGrouped = patchCoords[i-1].handle.patchIndex <=
+                        patchCoords[i].handle.patchIndex;
+        }
+        if (isGrouped) return false;
 
-            dstT.Clear();
-            dstDuT.Clear();
-            dstDvT.Clear();
-            for (int j = 0; j < nPoints; ++j) {
-                dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
-                dstDuT.AddWithWeight(srcT[cvs[j]], wDu[j]);
-                dstDvT.AddWithWeight(srcT[cvs[j]], wDv[j]);
-            }
-            ++dstT;
-            ++dstDuT;
-            ++dstDvT;
+        order.resize(numPatchCoords);
+        for (int i = 0; i < numPatchCoords; ++i) {
+            order[i] = i;
         }
+        std::sort(order.begin(), order.end(), PatchCoordLess(patchCoords));
+        return true;
     }
 
-    void computeWith2ndDerivative(tbb::blocked_range<int> const &r) const {
-        float wP[20], wDu[20], wDv[20], wDuu[20], wDuv[20], wDvv[20];
-        BufferAdapter<const float> srcT(_src + _srcDesc.offset,
-                                        _srcDesc.length,
-                                        _srcDesc.stride);
-        BufferAdapter<float> dstT(_dst + _dstDesc.offset
-                                       + r.begin() * _dstDesc.stride,
-                                  _dstDesc.length,
-                                  _dstDesc.stride);
-        BufferAdapter<float> dstDuT(_dstDu + _dstDuDesc.offset
-                                       + r.begin() * _dstDuDesc.stride,
-                                  _dstDuDesc.length,
-                                  _dstDuDesc.stride);
-        BufferAdapter<float> dstDvT(_dstDv + _dstDvDesc.offset
-                                       + r.begin() * _dstDvDesc.stride,
-                                  _dstDvDesc.length,
-                                  _dstDvDesc.stride);
-        BufferAdapter<float> dstDuuT(_dstDuu + _dstDuuDesc.offset
-                                       + r.begin() * _dstDuuDesc.stride,
-                                  _dstDuuDesc.length,
-                                  _dstDuuDesc.stride);
-        BufferAdapter<float> dstDuvT(_dstDuv + _dstDuvDesc.offset
-                                       + r.begin() * _dstDuvDesc.stride,
-                                  _dstDuvDesc.length,
-                                  _dstDuvDesc.stride);
-        BufferAdapter<float> dstDvvT(_dstDvv + _dstDvvDesc.offset
-                                       + r.begin() * _dstDvvDesc.stride,
-                                  _dstDvvDesc.length,
-                                  _dstDvvDesc.stride);
-
-        for (int i = r.begin(); i < r.end(); ++i) {
-            PatchCoord const &coord = _patchCoords[i];
-            PatchArray const &array = _patchArrayBuffer[coord.handle.arrayIndex];
-
-            Osd::PatchParam const & paramStruct =
-                _patchParamBuffer[coord.handle.patchIndex];
-            OsdPatchParam param = OsdPatchParamInit(
-                paramStruct.field0, paramStruct.field1, paramStruct.sharpness);
-
-            int patchType = OsdPatchParamIsRegular(param)
-                ? array.GetPatchTypeRegular()
-                : array.GetPatchTypeIrregular();
-
-            int nPoints = OsdEvaluatePatchBasis(patchType, param,
-                    coord.s, coord.t, wP, wDu, wDv, wDuu, wDuv, wDvv);
-
-            int indexBase = array.GetIndexBase() + array.GetStride() *
-                    (coord.handle.patchIndex - array.GetPrimitiveIdBase());
-
-            const int *cvs = &_patchIndexBuffer[indexBase];
-
-            dstT.Clear();
-            dstDuT.Clear();
-            dstDvT.Clear();
-            dstDuuT.Clear();
-            dstDuvT.Clear();
-            dstDvvT.Clear();
-            for (int j = 0; j < nPoints; ++j) {
-                dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
-                dstDuT.AddWithWeight(srcT[cvs[j]], wDu[j]);
-                dstDvT.AddWithWeight(srcT[cvs[j]], wDv[j]);
-                dstDuuT.AddWithWeight(srcT[cvs[j]], wDuu[j]);
-                dstDuvT.AddWithWeight(srcT[cvs[j]], wDuv[j]);
-                dstDvvT.AddWithWeight(srcT[cvs[j]], wDvv[j]);
+    template <class KERNEL>
+    void
+    runPatchEvalKernel(int numPatchCoords, KERNEL const &kernel) {
+
+        tbb::blocked_range<int> range(0, numPatchCoords,
+                                      std::max(1, patchEvalGrainSize));
+
+        runIsolated(patchEvalIsolated, [&]() {
+            switch (patchEvalPartitioner) {
+            case TbbEvaluator::PatchEvalOptions::PARTITIONER_SIMPLE:
+                tbb::parallel_for(range, kernel, tbb::simple_partitioner());
+                break;
+            case TbbEvaluator::PatchEvalOptions::PARTITIONER_STATIC:
+                tbb::parallel_for(range, kernel, tbb::static_partitioner());
+                break;
+            case TbbEvaluator::PatchEvalOptions::PARTITIONER_AFFINITY:
+                tbb::parallel_for(range, kernel, patchEvalAffinityPartitioner);
+                break;
+            default:
+                tbb::parallel_for(range, kernel, tbb::auto_partitioner());
+                break;
             }
-            ++dstT;
-            ++dstDuT;
-            ++dstDvT;
-            ++dstDuuT;
-            ++dstDuvT;
-            ++dstDvvT;
-        }
+        });
     }
-};
+} // end namespace
+
+void
+TbbSetPatchEvalOptions(int grainSize, int partitioner, bool groupByPatch,
+                       bool isolate) {
 
+    patchEvalGrainSize    = grainSize;
+    patchEvalPartitioner  = partitioner;
+    patchEvalGroupByPatch = groupByPatch;
+    patchEvalIsolated     = isolate;
+}
 
 void
 TbbEvalPatches(float const *src, BufferDescriptor const &srcDesc,
@@ -563,19 +976,13 @@ TbbEvalPatches(float const *src, BufferDescriptor const &srcDesc,
                const int *patchIndexBuffer,
                const PatchParam *patchParamBuffer) {
 
-    TbbEvalPatchesKernel kernel(src, srcDesc, dst, dstDesc,
-                                dstDu, dstDuDesc, dstDv, dstDvDesc,
-                                NULL, BufferDescriptor(),
-                                NULL, BufferDescriptor(),
-                                NULL, BufferDescriptor(),
-                                numPatchCoords, patchCoords,
-                                patchArrayBuffer,
-                                patchIndexBuffer,
-                                patchParamBuffer);
-
-    tbb::blocked_range<int> range(0, numPatchCoords, grain_size);
-    tbb::parallel_for(range, kernel);
-
+    TbbEvalPatches(src, srcDesc, dst, dstDesc,
+                   dstDu, dstDuDesc, dstDv, dstDvDesc,
+                   NULL, BufferDescriptor(),
+                   NULL, BufferDescriptor(),
+                   NULL, BufferDescriptor(),
+                   numPatchCoords, patchCoords,
+                   patchArrayBuffer, patchIndexBuffer, patchParamBuffer);
 }
 
 
@@ -593,19 +1000,73 @@ TbbEvalPatches(float const *src, BufferDescriptor const &srcDesc,
                const int *patchIndexBuffer,
                const PatchParam *patchParamBuffer) {
 
+    if (numPatchCoords <= 0) return;
+
+    std::vector<int> patchCoordOrder;
+    bool isReordered = patchEvalGroupByPatch &&
+        groupPatchCoords(numPatchCoords, patchCoords, patchCoordOrder);
+
     TbbEvalPatchesKernel kernel(src, srcDesc, dst, dstDesc,
                                 dstDu, dstDuDesc, dstDv, dstDvDesc,
                                 dstDuu, dstDuuDesc,
                                 dstDuv, dstDuvDesc,
                                 dstDvv, dstDvvDesc,
                                 numPatchCoords, patchCoords,
+                                isReordered ? &patchCoordOrder[0] : NULL,
                                 patchArrayBuffer,
                                 patchIndexBuffer,
                                 patchParamBuffer);
 
-    tbb::blocked_range<int> range(0, numPatchCoords, grain_size);
-    tbb::parallel_for(range, kernel);
+    runPatchEvalKernel(numPatchCoords, kernel);
+}
 
+void
+TbbEvalPatchesNormals(float const *src, BufferDescriptor const &srcDesc,
+                      float *dst,       BufferDescriptor const &dstDesc,
+                      float *normal,    BufferDescriptor const &normalDesc,
+                      int numPatchCoords,
+                      const PatchCoord *patchCoords,
+                      const PatchArray *patchArrayBuffer,
+                      const int *patchIndexBuffer,
+                      const PatchParam *patchParamBuffer) {
+
+    if (numPatchCoords <= 0) return;
+
+    TbbEvalPatchesNormalsKernel kernel(src, srcDesc, dst, dstDesc,
+                                       normal, normalDesc,
+                                       patchCoords,
+                                       patchArrayBuffer,
+                                       patchIndexBuffer,
+                                       patchParamBuffer);
+
+    runPatchEvalKernel(numPatchCoords, kernel);
+}
+
+void
+TbbEvalPatchesSamples(float const *src, BufferDescriptor const &srcDesc,
+                      float *dst,       BufferDescriptor const &dstDesc,
+                      float *du,        BufferDescriptor const &duDesc,
+                      float *dv,        BufferDescriptor const &dvDesc,
+                      int numSamples, int srcSampleStride,
+                      int dstSampleStride,
+                      int numPatchCoords,
+                      const PatchCoord *patchCoords,
+                      const PatchArray *patchArrayBuffer,
+                      const int *patchIndexBuffer,
+                      const PatchParam *patchParamBuffer) {
+
+    if (numPatchCoords <= 0) return;
+
+    TbbEvalPatchesSamplesKernel kernel(src, srcDesc, dst, dstDesc,
+                                       du, duDesc, dv, dvDesc,
+                                       numSamples, srcSampleStride,
+                                       dstSampleStride,
+                                       patchCoords,
+                                       patchArrayBuffer,
+                                       patchIndexBuffer,
+                                       patchParamBuffer);
+
+    runPatchEvalKernel(numPatchCoords, kernel);
 }
 
 
@@ -28,6 +28,7 @@
 #include "../version.h"
 #include "../far/patchDescriptor.h"
 #include "../far/patchParam.h"
+#include "../far/types.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -38,12 +39,15 @@ struct PatchArray;
 struct PatchCoord;
 struct PatchParam;
 struct BufferDescriptor;
+struct StencilEvalJob;
+struct PrimvarBinding;
+struct BoundsDescriptor;
 
 void
 TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 int start, int end);
@@ -54,7 +58,7 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDu,     BufferDescriptor const &dstDuDesc,
                 float * dstDv,     BufferDescriptor const &dstDvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -70,7 +74,7 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dstDuv,    BufferDescriptor const &dstDuvDesc,
                 float * dstDvv,    BufferDescriptor const &dstDvvDesc,
                 int const * sizes,
-                int const * offsets,
+                Far::Offset const * offsets,
                 int const * indices,
                 float const * weights,
                 float const * duWeights,
@@ -80,6 +84,70 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float const * dvvWeights,
                 int start, int end);
 
+void
+TbbEvalStencils(StencilEvalJob const * jobs, int numJobs);
+
+void
+TbbEvalStencils(PrimvarBinding const * bindings, int numBindings,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end);
+
+void
+TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                Far::Offset const * offsets,
+                int const * indices,
+                float const * weights,
+                int const * stencilIndices, int numStencilIndices);
+
+void
+TbbEvalStencilsNormals(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       float * normal,    BufferDescriptor const &normalDesc,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       float const * duWeights,
+                       float const * dvWeights,
+                       int start, int end);
+
+void
+TbbEvalStencilsSamples(float const * src, BufferDescriptor const &srcDesc,
+                       float * dst,       BufferDescriptor const &dstDesc,
+                       int numSamples, int srcSampleStride,
+                       int dstSampleStride,
+                       int const * sizes,
+                       Far::Offset const * offsets,
+                       int const * indices,
+                       float const * weights,
+                       int start, int end);
+
+//
+// Extends the bounding boxes of the ranges of the stencils by the first three
+// elements of their results (see CpuEvalStencilsBounds())
+//
+void
+TbbEvalStencilsBounds(float const * src, BufferDescriptor const &srcDesc,
+                      float * dst,       BufferDescriptor const &dstDesc,
+                      int const * sizes,
+                      Far::Offset const * offsets,
+                      int const * indices,
+                      float const * weights,
+                      BoundsDescriptor const & bounds,
+                      int start, int end);
+
+void
+TbbSetStencilEvalOptions(int grainSize, bool isolate);
+
+void
+TbbSetPatchEvalOptions(int grainSize, int partitioner, bool groupByPatch,
+                       bool isolate);
+
 void
 TbbEvalPatches(float const *src, BufferDescriptor const &srcDesc,
                float *dst,       BufferDescriptor const &dstDesc,
@@ -105,6 +173,29 @@ TbbEvalPatches(float const *src, BufferDescriptor const &srcDesc,
                const int *patchIndexBuffer,
                const PatchParam *patchParamBuffer);
 
+void
+TbbEvalPatchesNormals(float const *src, BufferDescriptor const &srcDesc,
+                      float *dst,       BufferDescriptor const &dstDesc,
+                      float *normal,    BufferDescriptor const &normalDesc,
+                      int numPatchCoords,
+                      const PatchCoord *patchCoords,
+                      const PatchArray *patchArrayBuffer,
+                      const int *patchIndexBuffer,
+                      const PatchParam *patchParamBuffer);
+
+void
+TbbEvalPatchesSamples(float const *src, BufferDescriptor const &srcDesc,
+                      float *dst,       BufferDescriptor const &dstDesc,
+                      float *du,        BufferDescriptor const &duDesc,
+                      float *dv,        BufferDescriptor const &dvDesc,
+                      int numSamples, int srcSampleStride,
+                      int dstSampleStride,
+                      int numPatchCoords,
+                      const PatchCoord *patchCoords,
+                      const PatchArray *patchArrayBuffer,
+                      const int *patchIndexBuffer,
+                      const PatchParam *patchParamBuffer);
+
 }  // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
@@ -0,0 +1,84 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/tessBasisTable.h"
+
+#include <algorithm>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+int
+TessBasisTable::GetResolution(int tessLevel) {
+
+    //  Transition edges and patches tessellated once are split at 1/2:
+    return 2 * std::max(tessLevel, 1);
+}
+
+int
+TessBasisTable::Compute(int tessLevel, std::vector<float> & table) {
+
+    int resolution = GetResolution(tessLevel);
+
+    table.resize(12 * (resolution + 1));
+
+    float * w = &table[0];
+    for (int k = 0; k <= resolution; ++k, w += 12) {
+        float t = (float)k / (float)resolution;
+        float s = 1.0f - t;
+
+        //  Same expressions as OsdUnivar4x4() so that the results match:
+        float A0 = s * s;
+        float A1 = 2 * s * t;
+        float A2 = t * t;
+
+        w[0] = s * A0;
+        w[1] = t * A0 + s * A1;
+        w[2] = t * A1 + s * A2;
+        w[3] = t * A2;
+
+        w[4] =    - A0;
+        w[5] = A0 - A1;
+        w[6] = A1 - A2;
+        w[7] = A2;
+
+        A0 =   - s;
+        A1 = s - t;
+        A2 = t;
+
+        w[8]  =    - A0;
+        w[9]  = A0 - A1;
+        w[10] = A1 - A2;
+        w[11] = A2;
+    }
+    return resolution;
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,77 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_TESS_BASIS_TABLE_H
+#define OPENSUBDIV3_OSD_TESS_BASIS_TABLE_H
+
+#include "../version.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+/// \brief Look-up table of the cubic Bezier basis for uniform tessellation
+///
+/// With uniform tessellation the parametric coordinates of the domain points
+/// of all patches are multiples of 1/(2 x tessLevel), including the points
+/// of transition edges, and of patches whose tessellation is divided by
+/// their refinement level.  When OSD_PATCH_ENABLE_BASIS_LUT is defined, the
+/// patch shaders read the basis of those coordinates from a buffer holding
+/// this table (OsdBasisLUTBuffer) instead of computing it for each domain
+/// point; coordinates off the grid are evaluated as usual.
+///
+/// The table holds three float4 for each of the resolution + 1 samples: the
+/// weights of the cubic Bernstein polynomials and of their first and second
+/// derivatives as computed by OsdUnivar4x4() (the derivatives unscaled).
+///
+class TessBasisTable {
+public:
+    /// \brief Returns the number of intervals of the table for a uniform
+    ///        tessellation level, to be returned by OsdBasisLUTResolution()
+    static int GetResolution(int tessLevel);
+
+    /// \brief Computes the table for a uniform tessellation level
+    ///
+    /// @param tessLevel  the uniform tessellation level (OsdTessLevel())
+    ///
+    /// @param table      the 12 x (GetResolution(tessLevel) + 1) floats of
+    ///                   the table
+    ///
+    /// @return           the resolution of the table
+    ///
+    static int Compute(int tessLevel, std::vector<float> & table);
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_TESS_BASIS_TABLE_H
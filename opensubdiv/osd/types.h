@@ -27,8 +27,10 @@
 
 #include "../version.h"
 #include "../far/patchTable.h"
+#include "../osd/bufferDescriptor.h"
 
 #include <algorithm>
+#include <cmath>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -129,8 +131,241 @@ struct PatchParam : public Far::PatchParam {
     float sharpness;
 };
 
+/// \brief Pre-expanded normalization of a PatchParam
+///
+/// Maps the parameterization of the face of a patch to that of the patch,
+/// (u,v) = (s,t) * scale + (offsetU,offsetV), and gives the scale of its
+/// first derivatives. Device kernels read it instead of decoding the depth,
+/// uv-offset and triangle rotation from the PatchParam bitfields for each
+/// evaluation (see GLPatchTable::GetPatchParamNormalizationBuffer()).
+///
+struct PatchParamNormalization {
+    // float4 struct.
+    PatchParamNormalization() :
+        scale(1.0f), offsetU(0.0f), offsetV(0.0f), derivScale(1.0f) { }
+
+    /// \brief Constructor
+    ///
+    /// @param param     patch parameter to expand
+    ///
+    /// @param triangle  true if the patch is a triangle (the normalization
+    ///                  of rotated triangles reverses their parameterization)
+    ///
+    PatchParamNormalization(Far::PatchParam const &param, bool triangle) {
+        float fracInv = 1.0f / param.GetParamFraction();
+        int depthFactor = 1 << param.GetDepth();
+        if (triangle && param.IsTriangleRotated()) {
+            scale = -fracInv;
+            offsetU = (float)(depthFactor - param.GetU());
+            offsetV = (float)(depthFactor - param.GetV());
+            derivScale = -(float)depthFactor;
+        } else {
+            scale = fracInv;
+            offsetU = -(float)param.GetU();
+            offsetV = -(float)param.GetV();
+            derivScale = (float)depthFactor;
+        }
+    }
+
+    float scale;        ///< scale of the face parameterization
+    float offsetU;      ///< offset of the normalized u
+    float offsetV;      ///< offset of the normalized v
+    float derivScale;   ///< scale (and sign) of the first derivatives
+};
+
+/// \brief Pre-computed sharpness-dependent matrices of a single-crease patch
+///
+/// The Bezier conversion of a single-crease patch blends matrices depending
+/// on the floor and ceiling of its sharpness (see OsdComputeMs()), which the
+/// patch shaders otherwise compute for each control point of each patch.
+/// These depend only on the sharpness, so they are computed once with the
+/// device patch tables and read by the shaders compiled with
+/// OSD_PATCH_ENABLE_SINGLE_CREASE_MATRICES instead (see
+/// GLPatchTable::GetSingleCreaseMatricesTextureBuffer()).
+///
+/// The matrices are stored column by column, as mat4 are constructed in the
+/// GLSL shaders, and are flipped by the shaders according to the boundary
+/// of the crease as those of OsdComputeMs() are.
+///
+struct SingleCreaseMatrices {
+    // 9 float4 struct.
+    SingleCreaseMatrices() {
+        std::fill(vSegments, vSegments + 4, 0.0f);
+        std::fill(Mj, Mj + 16, 0.0f);
+        std::fill(Ms, Ms + 16, 0.0f);
+    }
+
+    /// \brief Constructor
+    ///
+    /// @param sharpness  sharpness of the crease, greater than zero
+    ///
+    explicit SingleCreaseMatrices(float sharpness) {
+        static float const Mi[16] = {
+            1.f/6.f, 4.f/6.f, 1.f/6.f, 0.f,
+            0.f,     4.f/6.f, 2.f/6.f, 0.f,
+            0.f,     2.f/6.f, 4.f/6.f, 0.f,
+            0.f,     0.f,     1.f,     0.f };
+
+        float Sf = std::floor(sharpness);
+        float Sc = std::ceil(sharpness);
+        float Sr = sharpness - Sf;
+
+        float Mf[16], Mc[16];
+        computeMs(Sf, Mf);
+        computeMs(Sc, Mc);
+        for (int i = 0; i < 16; ++i) {
+            Mj[i] = (1 - Sr) * Mf[i] + Sr * Mi[i];
+            Ms[i] = (1 - Sr) * Mf[i] + Sr * Mc[i];
+        }
+
+        vSegments[0] = 1.0f - std::pow(2.0f, -Sf);
+        vSegments[1] = 1.0f - std::pow(2.0f, -Sc);
+        vSegments[2] = 0.0f;
+        vSegments[3] = 0.0f;
+    }
+
+    float vSegments[4]; ///< segments of the crease (xy, zw unused)
+    float Mj[16];       ///< matrix of the floor sharpness segment
+    float Ms[16];       ///< matrix of the ceiling sharpness segment
+
+private:
+    static void computeMs(float sharpness, float m[16]) {
+        float s = std::pow(2.0f, sharpness);
+        float s2 = s*s;
+        float s3 = s2*s;
+        float const c[16] = {
+            0, s + 1 + 3*s2 - s3, 7*s - 2 - 6*s2 + 2*s3, (1-s)*(s-1)*(s-1),
+            0,       (1+s)*(1+s),        6*s - 2 - 2*s2,       (s-1)*(s-1),
+            0,               1+s,               6*s - 2,               1-s,
+            0,                 1,               6*s - 2,                 1 };
+        for (int i = 0; i < 16; ++i) {
+            m[i] = c[i] / (s * 6.0f);
+        }
+        m[0] = 1.0f / 6.0f;
+    }
+};
+
+/// \brief Evaluation of a range of stencils between raw CPU buffers
+///
+/// Jobs allow the stencils of several meshes, each with its own buffers and
+/// stencil table, to be evaluated together in a single parallel dispatch
+/// (see the EvalStencils() overloads taking arrays of jobs). The fields are
+/// those of the raw EvalStencils() functions: the offsets of the buffer
+/// descriptors are applied internally, and stencil start+k is written to
+/// element k of the destination.
+///
+struct StencilEvalJob {
+    StencilEvalJob() :
+        src(0), dst(0), sizes(0), offsets(0), indices(0), weights(0),
+        start(0), end(0) { }
+
+    const float *    src;      ///< input primvar pointer
+    BufferDescriptor srcDesc;  ///< descriptor for the input buffer
+    float *          dst;      ///< output primvar pointer
+    BufferDescriptor dstDesc;  ///< descriptor for the output buffer
+
+    const int *         sizes;    ///< sizes buffer of the stencil table
+    const Far::Offset * offsets;  ///< offsets buffer of the stencil table
+    const int *         indices;  ///< indices buffer of the stencil table
+    const float *       weights;  ///< weights buffer of the stencil table
+
+    int start;                 ///< first stencil to evaluate
+    int end;                   ///< end of the range of stencils
+};
+
+/// \brief Binding of one of the primvars to which the same stencils apply
+///
+/// The EvalStencils() overloads taking arrays of bindings apply the stencils
+/// to all of the bound primvars (e.g. positions, rest positions and colors)
+/// in a single pass, so that the sizes, indices and weights of the stencil
+/// table are read once rather than once per primvar. The offsets of the
+/// buffer descriptors are applied internally, and stencil start+k is written
+/// to element k of each destination.
+///
+struct PrimvarBinding {
+    PrimvarBinding() : src(0), dst(0) { }
+
+    PrimvarBinding(const float * src_, BufferDescriptor const &srcDesc_,
+                   float * dst_,       BufferDescriptor const &dstDesc_) :
+        src(src_), srcDesc(srcDesc_), dst(dst_), dstDesc(dstDesc_) { }
+
+    const float *    src;      ///< input primvar pointer
+    BufferDescriptor srcDesc;  ///< descriptor for the input buffer
+    float *          dst;      ///< output primvar pointer
+    BufferDescriptor dstDesc;  ///< descriptor for the output buffer
+};
+
+/// \brief Skinning applied by the EvalStencilsSkinned() functions to the
+///        positions of the control vertices gathered by the stencils
+///
+/// The first three elements of each source vertex of index lower than
+/// numControlVertices are deformed by the bones influencing the vertex, so
+/// that the stencils refine the skinned cage without a separate pass
+/// writing it. The other elements, and the vertices refined from the
+/// skinned control vertices, are gathered as is.
+///
+/// The pointers address host memory, as only the CpuEvaluator provides
+/// EvalStencilsSkinned().
+///
+struct SkinningDescriptor {
+    enum Method {
+        LINEAR_BLEND = 0,     ///< bones are 3x4 row-major matrices
+        DUAL_QUATERNION = 1   ///< bones are unit dual quaternions, the real
+                              ///< part (x, y, z, w) then the dual part
+    };
+
+    SkinningDescriptor() :
+        method(LINEAR_BLEND), numControlVertices(0), numInfluences(0),
+        bones(0), boneIndices(0), boneWeights(0) { }
+
+    Method        method;
+    int           numControlVertices;  ///< number of skinned source vertices
+    int           numInfluences;       ///< number of bones of each vertex
+    float const * bones;               ///< 12 (or 8) floats per bone
+    int   const * boneIndices;         ///< numInfluences bones per vertex
+    float const * boneWeights;         ///< numInfluences weights per vertex
+};
+
+/// \brief Bounding boxes reduced by the EvalStencilsBounds() functions
+///
+/// The boxes bound the first three elements of the vertices written by the
+/// stencils, one box for each range of consecutive stencils, e.g. for the
+/// vertices of each mesh of a stencil table combining several meshes. The
+/// stencils of range r are those of index rangeOffsets[r] to
+/// rangeOffsets[r+1]-1 in the stencil table.
+///
+/// Each box is written as 6 floats, its minimum (x, y, z) followed by its
+/// maximum. A box whose range has no stencils evaluated is empty, with a
+/// minimum of FLT_MAX and a maximum of -FLT_MAX.
+///
+/// The pointers address host memory, as only the Cpu and Tbb evaluators
+/// provide EvalStencilsBounds().
+///
+struct BoundsDescriptor {
+    BoundsDescriptor() : numRanges(1), rangeOffsets(0), bounds(0) { }
+
+    int         numRanges;     ///< number of bounding boxes
+    int const * rangeOffsets;  ///< numRanges+1 increasing stencil indices,
+                               ///< or 0 for a single box of all the stencils
+    float *     bounds;        ///< 6 floats per box
+};
+
+/// \brief Displacement sampled by the EvalPatchesDisplaced() functions
+///
+/// Returns the scalar displacement along the normal at the location (u,v)
+/// of ptex face faceId -- e.g. from a ptex texture, or from a UDIM texture
+/// through the texture coordinates of the face -- and writes its
+/// derivatives with respect to u and v to dDu and dDv unless they are NULL.
+/// The data pointer given with the sampler is passed through.
+///
+typedef float (*DisplacementSampler)(void *data, int faceId,
+                                     float u, float v,
+                                     float *dDu, float *dDv);
+
 typedef std::vector<PatchArray> PatchArrayVector;
 typedef std::vector<PatchParam> PatchParamVector;
+typedef std::vector<PatchParamNormalization> PatchParamNormalizationVector;
+typedef std::vector<SingleCreaseMatrices> SingleCreaseMatricesVector;
 
 }  // end namespace Osd
 
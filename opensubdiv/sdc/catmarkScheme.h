@@ -489,12 +489,16 @@ Scheme<SCHEME_CATMARK>::assignSmoothLimitTangentMasks(VERTEX const& vertex,
         double edgeWeightScale = 4.0f;
         double faceWeightScale = 1.0f / (4.0f * lambda - 1.0f);
 
+        //  Each cosine is shared by consecutive edge and face weights, so carry
+        //  it forward rather than evaluating it twice per iteration:
+        double cosThetaI = 1.0f;
         for (int i = 0; i < valence; ++i) {
-            double cosThetaI      = std::cos(  i  * theta);
             double cosThetaIplus1 = std::cos((i+1)* theta);
 
             tan1Mask.EdgeWeight(i) = (Weight) (edgeWeightScale * cosThetaI);
             tan1Mask.FaceWeight(i) = (Weight) (faceWeightScale * (cosThetaI + cosThetaIplus1));
+
+            cosThetaI = cosThetaIplus1;
         }
     }
 
@@ -82,17 +82,17 @@ Crease::ComputeFractionalWeightAtVertex(float        parentVertexSharpness,
     //
     if (IsUniform() || (childSharpness == 0)) {
         for (int i = 0; i < incidentEdgeCount; ++i) {
-            if (IsSharp(parentSharpness[i]) && (parentSharpness[i] <= 1.0f)) {
-                transitionSum   += parentSharpness[i];
-                transitionCount ++;
-            }
+            bool isTransition = IsSharp(parentSharpness[i]) & (parentSharpness[i] <= 1.0f);
+
+            transitionSum   += isTransition ? parentSharpness[i] : 0.0f;
+            transitionCount += isTransition;
         }
     } else {
         for (int i = 0; i < incidentEdgeCount; ++i) {
-            if (IsSharp(parentSharpness[i]) && IsSmooth(childSharpness[i])) {
-                transitionSum   += parentSharpness[i];
-                transitionCount ++;
-            }
+            bool isTransition = IsSharp(parentSharpness[i]) & IsSmooth(childSharpness[i]);
+
+            transitionSum   += isTransition ? parentSharpness[i] : 0.0f;
+            transitionCount += isTransition;
         }
     }
     if (transitionCount == 0) return 0.0f;
@@ -118,10 +118,10 @@ Crease::SubdivideEdgeSharpnessAtVertex(float         edgeSharpness,
     float sharpSum   = 0.0f;
     int   sharpCount = 0;
     for (int i = 0; i < incEdgeCountAtVertex; ++i) {
-        if (IsSemiSharp(incEdgeSharpness[i])) {
-            sharpCount ++;
-            sharpSum += incEdgeSharpness[i];
-        }
+        bool isSemiSharp = IsSemiSharp(incEdgeSharpness[i]);
+
+        sharpCount += isSemiSharp;
+        sharpSum   += isSemiSharp ? incEdgeSharpness[i] : 0.0f;
     }
     if (sharpCount > 1) {
         //  Chaikin rule is 3/4 original sharpness + 1/4 average of the others
@@ -157,10 +157,10 @@ Crease::SubdivideEdgeSharpnessesAroundVertex(int          edgeCount,
         float sharpSum   = 0.0f;
         int   sharpCount = 0;
         for (int i = 0; i < edgeCount; ++i) {
-            if (IsSemiSharp(parentSharpness[i])) {
-                sharpCount ++;
-                sharpSum += parentSharpness[i];
-            }
+            bool isSemiSharp = IsSemiSharp(parentSharpness[i]);
+
+            sharpCount += isSemiSharp;
+            sharpSum   += isSemiSharp ? parentSharpness[i] : 0.0f;
         }
 
         //
@@ -57,6 +57,29 @@ template <>
 inline int Scheme<SCHEME_LOOP>::GetLocalNeighborhoodSize() { return 1; }
 
 
+//
+//  Cosine of the angle (2*pi / valence) used by the smooth vertex and limit
+//  masks.  The values for the most common irregular valences are tabulated
+//  (as evaluated via std::cos() for the expression below) to avoid a cosine
+//  for every irregular vertex:
+//
+inline double
+loopCosTwoPiOverValence(int valence) {
+
+    static double const cosTable[13] = { 0.0, 0.0, 0.0,
+        -0.49999999999999978,   6.123233995736766e-17, 0.30901699437494745,
+         0.50000000000000011,   0.62348980185873359,   0.70710678118654757,
+         0.76604444311897801,   0.80901699437494745,   0.84125353283118121,
+         0.86602540378443871 };
+
+    if ((valence >= 3) && (valence <= 12)) {
+        return cosTable[valence];
+    }
+    double invValence = 1.0f / (double) valence;
+    return std::cos(M_PI * 2.0f * invValence);
+}
+
+
 //
 //  Protected methods to assign the two types of masks for an edge-vertex --
 //  Crease and Smooth.
@@ -194,12 +217,9 @@ Scheme<SCHEME_LOOP>::assignSmoothMaskForVertex(VERTEX const& vertex, MASK& mask)
 
     if (valence != 6) {
         //  From HbrLoopSubdivision<T>::Subdivide(mesh, vertex):
-        //     - could use some lookup tables here for common irregular valence (5, 7, 8)
-        //       or all of these cosine calls will be adding up...
-
         double dValence   = (double) valence;
         double invValence = 1.0f / dValence;
-        double cosTheta   = std::cos(M_PI * 2.0f * invValence);
+        double cosTheta   = loopCosTwoPiOverValence(valence);
 
         double beta = 0.25f * cosTheta + 0.375f;
 
@@ -298,7 +318,7 @@ Scheme<SCHEME_LOOP>::assignSmoothLimitMask(VERTEX const& vertex, MASK& posMask)
     } else {
         double dValence   = (double) valence;
         double invValence = 1.0f / dValence;
-        double cosTheta   = std::cos(M_PI * 2.0f * invValence);
+        double cosTheta   = loopCosTwoPiOverValence(valence);
 
         double beta  = 0.25f * cosTheta + 0.375f;
         double gamma = (0.625f - (beta * beta)) * invValence;
@@ -0,0 +1,150 @@
+//
+//   Copyright 2014 DreamWorks Animation LLC.
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+#include "../vtr/arena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Vtr {
+namespace internal {
+
+const size_t Arena::ALIGNMENT;
+const size_t Arena::DEFAULT_BLOCK_SIZE;
+
+Arena::Arena(size_t minBlockSize,
+             AllocateFunc allocateFunc, DeallocateFunc deallocateFunc) :
+    _minBlockSize(alignSize(minBlockSize)),
+    _allocateFunc(allocateFunc),
+    _deallocateFunc(deallocateFunc),
+    _next(0),
+    _remaining(0) {
+}
+
+Arena::~Arena() {
+    clear();
+}
+
+void
+Arena::clear() {
+    for (size_t i = 0; i < _blocks.size(); ++i) {
+        if (_deallocateFunc) {
+            _deallocateFunc(_blocks[i].data, _blocks[i].size);
+        } else {
+            std::free(_blocks[i].data);
+        }
+    }
+    _blocks.clear();
+    _next = 0;
+    _remaining = 0;
+}
+
+size_t
+Arena::getCapacity() const {
+    size_t capacity = 0;
+    for (size_t i = 0; i < _blocks.size(); ++i) {
+        capacity += _blocks[i].size;
+    }
+    return capacity;
+}
+
+bool
+Arena::addBlock(size_t size) {
+
+    Block block;
+    block.size = std::max(_minBlockSize, alignSize(size));
+    block.data = static_cast<char *>(_allocateFunc ?
+        _allocateFunc(block.size) : std::malloc(block.size));
+    if (block.data == 0) {
+        return false;
+    }
+    _blocks.push_back(block);
+
+    _next = block.data;
+    _remaining = block.size;
+    return true;
+}
+
+void *
+Arena::allocate(size_t size) {
+
+    void * ptr = 0;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp critical (VtrArena)
+#endif
+    {
+        size = alignSize(size);
+        if ((size <= _remaining) || addBlock(size)) {
+            ptr = _next;
+            _next      += size;
+            _remaining -= size;
+        }
+    }
+    //  Exceptions cannot be thrown from within the critical section:
+    if (ptr == 0) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void
+Arena::deallocate(void * ptr, size_t size) {
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp critical (VtrArena)
+#endif
+    {
+        //  Reclaim the memory only if it was the most recent allocation:
+        size = alignSize(size);
+        if (static_cast<char *>(ptr) + size == _next) {
+            _next      -= size;
+            _remaining += size;
+        }
+    }
+}
+
+void
+Arena::reserve(size_t size) {
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp critical (VtrArena)
+#endif
+    {
+        if (alignSize(size) > _remaining) {
+            //  Failure is deferred to the allocation needing the memory:
+            addBlock(size);
+        }
+    }
+}
+
+} // end namespace internal
+} // end namespace Vtr
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
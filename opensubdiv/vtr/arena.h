@@ -0,0 +1,194 @@
+//
+//   Copyright 2014 DreamWorks Animation LLC.
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+#ifndef OPENSUBDIV3_VTR_ARENA_H
+#define OPENSUBDIV3_VTR_ARENA_H
+
+#include "../version.h"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Vtr {
+namespace internal {
+
+//
+//  Simple arena from which the vectors of Levels, Refinements and their
+//  face-varying counterparts can be allocated:
+//
+//  Memory is allocated from a list of large blocks and is only released when
+//  the Arena is cleared or destroyed -- deallocation only reclaims memory
+//  when it is the most recent allocation (as is typical of a vector that is
+//  trimmed after being sized to a maximum).  Clients that know the amount of
+//  memory they are about to allocate can reserve() it upfront so that it is
+//  contiguous.
+//
+//  Allocation is serialized when OpenMP is enabled, as the relations of a
+//  child Level may be populated (and so their vectors resized) concurrently.
+//
+class Arena {
+public:
+    static const size_t ALIGNMENT = 16;
+    static const size_t DEFAULT_BLOCK_SIZE = 1 << 16;
+
+    //  Optional functions allocating and releasing the blocks (in place of
+    //  malloc and free) -- allocation failure is reported by returning 0:
+    typedef void * (*AllocateFunc)(size_t size);
+    typedef void   (*DeallocateFunc)(void * block, size_t size);
+
+    explicit Arena(size_t minBlockSize = DEFAULT_BLOCK_SIZE,
+                   AllocateFunc allocateFunc = 0,
+                   DeallocateFunc deallocateFunc = 0);
+    ~Arena();
+
+    void * allocate(size_t size);
+    void   deallocate(void * ptr, size_t size);
+
+    //  Ensure the next size bytes allocated are taken from a single block:
+    void reserve(size_t size);
+
+    //  Release all blocks -- all memory allocated must no longer be in use:
+    void clear();
+
+    size_t getNumBlocks() const { return _blocks.size(); }
+    size_t getCapacity() const;
+
+private:
+    //  Non-copyable:
+    Arena(Arena const &);
+    Arena & operator=(Arena const &);
+
+    bool   addBlock(size_t size);
+
+    static size_t alignSize(size_t size) {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    struct Block {
+        char * data;
+        size_t size;
+    };
+
+    std::vector<Block> _blocks;
+    size_t             _minBlockSize;
+
+    AllocateFunc       _allocateFunc;
+    DeallocateFunc     _deallocateFunc;
+
+    char *             _next;
+    size_t             _remaining;
+};
+
+//
+//  Allocator for use with std::vector -- allocating from the heap when not
+//  assigned an Arena:
+//
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T              value_type;
+    typedef T *            pointer;
+    typedef T const *      const_pointer;
+    typedef T &            reference;
+    typedef T const &      const_reference;
+    typedef std::size_t    size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <typename U> struct rebind { typedef ArenaAllocator<U> other; };
+
+    ArenaAllocator(Arena * arena = 0) : _arena(arena) { }
+    template <typename U>
+    ArenaAllocator(ArenaAllocator<U> const & other) : _arena(other.getArena()) { }
+
+    Arena * getArena() const { return _arena; }
+
+    pointer allocate(size_type n, void const * = 0) {
+        if (n == 0) return 0;
+        void * ptr = _arena ? _arena->allocate(n * sizeof(T))
+                            : ::operator new(n * sizeof(T));
+        return static_cast<pointer>(ptr);
+    }
+    void deallocate(pointer ptr, size_type n) {
+        if (ptr == 0) return;
+        if (_arena) {
+            _arena->deallocate(ptr, n * sizeof(T));
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+
+    size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+    pointer       address(reference x) const       { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+
+    void construct(pointer p, T const & value) { new (p) T(value); }
+    void destroy(pointer p) { p->~T(); }
+
+private:
+    Arena * _arena;
+};
+
+template <typename T, typename U>
+inline bool
+operator==(ArenaAllocator<T> const & a, ArenaAllocator<U> const & b) {
+    return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+inline bool
+operator!=(ArenaAllocator<T> const & a, ArenaAllocator<U> const & b) {
+    return a.getArena() != b.getArena();
+}
+
+//
+//  Vector allocated from an Arena (or the heap when none is assigned):
+//
+template <typename T>
+class ArenaVector : public std::vector<T, ArenaAllocator<T> > {
+public:
+    typedef std::vector<T, ArenaAllocator<T> > BaseType;
+
+    explicit ArenaVector(Arena * arena = 0) :
+        BaseType(ArenaAllocator<T>(arena)) { }
+
+    Arena * getArena() const { return this->get_allocator().getArena(); }
+
+    size_t getMemoryUsage() const { return this->capacity() * sizeof(T); }
+
+    //  Release all elements and their memory (not returned to an Arena until cleared):
+    void release() { ArenaVector(getArena()).swap(*this); }
+};
+
+} // end namespace internal
+} // end namespace Vtr
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_VTR_ARENA_H */
@@ -0,0 +1,218 @@
+//
+//   Copyright 2014 DreamWorks Animation LLC.
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+#ifndef OPENSUBDIV3_VTR_BINARY_STREAM_H
+#define OPENSUBDIV3_VTR_BINARY_STREAM_H
+
+#include "../version.h"
+
+#include <cstring>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Vtr {
+namespace internal {
+
+//
+//  Simple classes for writing and reading flat binary buffers of plain data
+//  and vectors of plain data:
+//
+//  The contents of vectors are aligned (relative to the start of the buffer)
+//  to the size of the largest scalar types, so that a buffer that has itself
+//  been suitably allocated or mapped into memory can be accessed in place.
+//  No conversions are applied to the data -- buffers are only intended to be
+//  read by the same build of the library that wrote them, so it is up to
+//  clients of these classes to write (and verify) tags that identify them.
+//
+//  The writer can be given no buffer, in which case it only accumulates the
+//  size required. Both the writer and reader fail safely when the capacity
+//  of the buffer is exceeded, and the failure is sticky so that it is only
+//  necessary to inspect it when done.
+//
+//
+//  Header identifying the contents of a buffer and the build that wrote it:
+//
+//  Clients provide a tag and version identifying the format, and the sizes of
+//  the types written (which will otherwise be assumed when read).  The byte
+//  order of the host is added so that the header as a whole can be compared
+//  to one initialized by the reader.
+//
+struct BinaryHeader {
+    static const int MAX_TYPE_SIZES = 16;
+
+    BinaryHeader() {
+        std::memset(this, 0, sizeof(BinaryHeader));
+    }
+    BinaryHeader(char const tag[8], unsigned int versionArg) {
+        std::memset(this, 0, sizeof(BinaryHeader));
+        std::memcpy(magic, tag, sizeof(magic));
+        version   = versionArg;
+        endianTag = 0x01020304;
+    }
+
+    void setTypeSize(int i, size_t size) { typeSizes[i] = (unsigned char) size; }
+
+    bool isCompatible(BinaryHeader const & other) const {
+        return std::memcmp(this, &other, sizeof(BinaryHeader)) == 0;
+    }
+
+    char          magic[8];
+    unsigned int  version;
+    unsigned int  endianTag;
+    unsigned char typeSizes[MAX_TYPE_SIZES];
+};
+
+class BinaryWriter {
+public:
+    static const size_t ALIGNMENT = 8;
+
+    BinaryWriter(void * buffer = 0, size_t capacity = 0) :
+        _buffer(static_cast<unsigned char *>(buffer)),
+        _capacity(capacity),
+        _size(0),
+        _failed(false) { }
+
+    size_t getSize() const { return _size; }
+    bool   isValid() const { return !_failed; }
+
+    void writeBytes(void const * data, size_t size) {
+        if (_buffer && !_failed) {
+            if (_size + size > _capacity) {
+                _failed = true;
+            } else if (size) {
+                std::memcpy(_buffer + _size, data, size);
+            }
+        }
+        _size += size;
+    }
+
+    void align() {
+        static const unsigned char zeros[ALIGNMENT] = { 0 };
+        writeBytes(zeros, (ALIGNMENT - (_size % ALIGNMENT)) % ALIGNMENT);
+    }
+
+    template <typename T>
+    void write(T const & value) {
+        writeBytes(&value, sizeof(T));
+    }
+
+    template <typename T, typename A>
+    void writeVector(std::vector<T, A> const & values) {
+        write((unsigned int) values.size());
+        align();
+        if (!values.empty()) {
+            writeBytes(&values[0], values.size() * sizeof(T));
+        }
+    }
+
+private:
+    unsigned char * _buffer;
+    size_t          _capacity;
+    size_t          _size;
+    bool            _failed;
+};
+
+class BinaryReader {
+public:
+    static const size_t ALIGNMENT = BinaryWriter::ALIGNMENT;
+
+    BinaryReader(void const * buffer, size_t size) :
+        _buffer(static_cast<unsigned char const *>(buffer)),
+        _size(size),
+        _offset(0),
+        _failed(buffer == 0) { }
+
+    size_t getOffset() const { return _offset; }
+    bool   isValid() const { return !_failed; }
+
+    //  Returns a pointer to the next bytes in the buffer (0 on failure):
+    void const * readBytes(size_t size) {
+        if (_failed || (size > _size - _offset)) {
+            _failed = true;
+            return 0;
+        }
+        void const * data = _buffer + _offset;
+        _offset += size;
+        return data;
+    }
+
+    void align() {
+        readBytes((ALIGNMENT - (_offset % ALIGNMENT)) % ALIGNMENT);
+    }
+
+    template <typename T>
+    bool read(T & value) {
+        void const * data = readBytes(sizeof(T));
+        if (data) {
+            std::memcpy(&value, data, sizeof(T));
+        }
+        return data != 0;
+    }
+
+    //  Returns a pointer to the elements of a vector written in place, and
+    //  the number of elements:
+    template <typename T>
+    T const * readVectorInPlace(unsigned int & count) {
+        count = 0;
+        if (!read(count)) return 0;
+        align();
+        if ((size_t) count > (_size - _offset) / sizeof(T)) {
+            _failed = true;
+            count = 0;
+            return 0;
+        }
+        return static_cast<T const *>(readBytes(count * sizeof(T)));
+    }
+
+    template <typename T, typename A>
+    bool readVector(std::vector<T, A> & values) {
+        unsigned int count = 0;
+        T const * data = readVectorInPlace<T>(count);
+        if (data) {
+            values.resize(count);
+            if (count) {
+                std::memcpy(&values[0], data, count * sizeof(T));
+            }
+        } else {
+            values.clear();
+        }
+        return isValid();
+    }
+
+private:
+    unsigned char const * _buffer;
+    size_t                _size;
+    size_t                _offset;
+    bool                  _failed;
+};
+
+} // end namespace internal
+} // end namespace Vtr
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_VTR_BINARY_STREAM_H */
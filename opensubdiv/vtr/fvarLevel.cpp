@@ -26,6 +26,7 @@
 #include "../vtr/array.h"
 #include "../vtr/stackBuffer.h"
 #include "../vtr/level.h"
+#include "../vtr/binaryStream.h"
 
 #include "../vtr/fvarLevel.h"
 
@@ -76,7 +77,20 @@ FVarLevel::FVarLevel(Level const& level) :
     _isLinear(false),
     _hasLinearBoundaries(false),
     _hasDependentSharpness(false),
-    _valueCount(0) {
+    _matchesVertexTopology(false),
+    _valuesAreVertices(false),
+    _valueCount(0),
+    _faceVertValues(level.getArena()),
+    _edgeTags(level.getArena()),
+    _vertSiblingCounts(level.getArena()),
+    _vertSiblingOffsets(level.getArena()),
+    _vertFaceSiblings(level.getArena()),
+    _vertValueIndices(level.getArena()),
+    _vertValueTags(level.getArena()),
+    _vertValueCreaseEnds(level.getArena()) {
+
+    _matchingETag.clear();
+    _matchingValueTag.clear();
 }
 
 FVarLevel::~FVarLevel() {
@@ -111,7 +125,10 @@ FVarLevel::resizeComponents() {
 void
 FVarLevel::resizeVertexValues(int vertexValueCount) {
 
-    _vertValueIndices.resize(vertexValueCount);
+    //  Values of refined levels are ordered as the vertex-values (see getVertexValue()):
+    if (_level.getDepth() == 0) {
+        _vertValueIndices.resize(vertexValueCount);
+    }
 
     ValueTag valueTagMatch;
     valueTagMatch.clear();
@@ -142,7 +159,7 @@ FVarLevel::resizeValues(int valueCount) {
 //  topology of their parent) and no further analysis is required.
 //
 void
-FVarLevel::completeTopologyFromFaceValues(int regularBoundaryValence) {
+FVarLevel::completeTopologyFromFaceValues(int regularBoundaryValence, int numThreads) {
 
     //
     //  Assign some members and local variables based on the interpolation options (the
@@ -200,187 +217,224 @@ FVarLevel::completeTopologyFromFaceValues(int regularBoundaryValence) {
     //  The second pass initializes remaining members based on the total number of siblings
     //  M after allocating appropriate vectors dependent on M.
     //
-    std::vector<LocalIndex> vertexMismatch(_level.getNumVertices(), 0);
-
-    _vertFaceSiblings.resize(_level.getNumVertexFacesTotal(), 0);
+    int const numVertices = _level.getNumVertices();
+    int const numEdges    = _level.getNumEdges();
 
-    int const maxValence = _level.getMaxValence();
-
-    internal::StackBuffer<Index,16>     indexBuffer(maxValence);
-    internal::StackBuffer<int,16>       valueBuffer(maxValence);
-    internal::StackBuffer<Sibling,16>   siblingBuffer(maxValence);
-    internal::StackBuffer<ValueSpan,16> spanBuffer(maxValence);
+    std::vector<LocalIndex> vertexMismatch(numVertices, 0);
 
-    int *     uniqueValues   = valueBuffer;
-    Sibling * vValueSiblings = siblingBuffer;
+    _vertFaceSiblings.resize(_level.getNumVertexFacesTotal(), 0);
 
-    int totalValueCount = 0;
-    for (int vIndex = 0; vIndex < _level.getNumVertices(); ++vIndex) {
-        //
-        //  Retrieve the FVar values from each incident face and store locally for
-        //  use -- we will identify the index of its corresponding "sibling" as we
-        //  inspect them more closely later:
-        //
-        ConstIndexArray       vFaces  = _level.getVertexFaces(vIndex);
-        ConstLocalIndexArray  vInFace = _level.getVertexFaceLocalIndices(vIndex);
+    //
+    //  The vertices are inspected concurrently, so discts edges are not tagged as
+    //  they are detected (possibly from both of their end vertices).  Each is only
+    //  marked from the end vertex that detected it, and the edges and vertices are
+    //  tagged from these marks once all vertices have been inspected:
+    //
+    std::vector<unsigned char> edgeDisctsFromV0(numEdges, 0);
+    std::vector<unsigned char> edgeDisctsFromV1(numEdges, 0);
 
-        Index * vValues = indexBuffer;
+    int const maxValence = _level.getMaxValence();
 
-        for (int i = 0; i < vFaces.size(); ++i) {
-            vValues[i] = _faceVertValues[_level.getOffsetOfFaceVertices(vFaces[i]) + vInFace[i]];
-        }
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel if (numThreads > 1) num_threads(numThreads)
+#else
+    (void)numThreads;
+#endif
+    {
+        internal::StackBuffer<Index,16>     indexBuffer(maxValence);
+        internal::StackBuffer<int,16>       valueBuffer(maxValence);
+        internal::StackBuffer<Sibling,16>   siblingBuffer(maxValence);
+
+        int *     uniqueValues   = valueBuffer;
+        Sibling * vValueSiblings = siblingBuffer;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp for schedule(static, 256)
+#endif
+        for (int vIndex = 0; vIndex < numVertices; ++vIndex) {
+            //
+            //  Retrieve the FVar values from each incident face and store locally for
+            //  use -- we will identify the index of its corresponding "sibling" as we
+            //  inspect them more closely later:
+            //
+            ConstIndexArray       vFaces  = _level.getVertexFaces(vIndex);
+            ConstLocalIndexArray  vInFace = _level.getVertexFaceLocalIndices(vIndex);
 
-        //
-        //  Inspect the incident edges of the vertex and tag those whose FVar values are
-        //  discts between the two (or more) faces sharing that edge.  When manifold, we
-        //  know an edge is discts when two successive fvar-values differ -- so we will
-        //  make use of the local buffer of values.  Unfortunately we can't infer anything
-        //  about the edges for a non-manifold vertex, so that case will be more complex.
-        //
-        ConstIndexArray       vEdges  = _level.getVertexEdges(vIndex);
-        ConstLocalIndexArray  vInEdge = _level.getVertexEdgeLocalIndices(vIndex);
+            Index * vValues = indexBuffer;
 
-        bool vIsManifold = !_level.getVertexTag(vIndex)._nonManifold;
-        bool vIsBoundary = _level.getVertexTag(vIndex)._boundary;
+            for (int i = 0; i < vFaces.size(); ++i) {
+                vValues[i] = _faceVertValues[_level.getOffsetOfFaceVertices(vFaces[i]) + vInFace[i]];
+            }
 
-        if (vIsManifold) {
             //
-            //  We want to use face indices here as we are accessing the fvar-values per
-            //  face.  The indexing range here maps to the interior edges for boundary
-            //  and interior verts:
+            //  Inspect the incident edges of the vertex and mark those whose FVar values are
+            //  discts between the two (or more) faces sharing that edge.  When manifold, we
+            //  know an edge is discts when two successive fvar-values differ -- so we will
+            //  make use of the local buffer of values.  Unfortunately we can't infer anything
+            //  about the edges for a non-manifold vertex, so that case will be more complex.
             //
-            for (int i = vIsBoundary; i < vFaces.size(); ++i) {
-                int vFaceNext = i;
-                int vFacePrev = i ? (i - 1) : (vFaces.size() - 1);
+            ConstIndexArray       vEdges  = _level.getVertexEdges(vIndex);
+            ConstLocalIndexArray  vInEdge = _level.getVertexEdgeLocalIndices(vIndex);
 
-                if (vValues[vFaceNext] != vValues[vFacePrev]) {
-                    Index eIndex = vEdges[i];
+            bool vIsManifold = !_level.getVertexTag(vIndex)._nonManifold;
+            bool vIsBoundary = _level.getVertexTag(vIndex)._boundary;
 
-                    //  Tag both end vertices as not matching topology:
-                    ConstIndexArray eVerts = _level.getEdgeVertices(eIndex);
-                    vertexMismatch[eVerts[0]] = true;
-                    vertexMismatch[eVerts[1]] = true;
+            if (vIsManifold) {
+                //
+                //  We want to use face indices here as we are accessing the fvar-values per
+                //  face.  The indexing range here maps to the interior edges for boundary
+                //  and interior verts:
+                //
+                for (int i = vIsBoundary; i < vFaces.size(); ++i) {
+                    int vFaceNext = i;
+                    int vFacePrev = i ? (i - 1) : (vFaces.size() - 1);
 
-                    //  Tag the corresponding edge as discts:
-                    ETag& eTag = _edgeTags[eIndex];
+                    if (vValues[vFaceNext] != vValues[vFacePrev]) {
+                        Index eIndex = vEdges[i];
 
-                    eTag._disctsV0 = (eVerts[0] == vIndex);
-                    eTag._disctsV1 = (eVerts[1] == vIndex);
-                    eTag._mismatch = true;
-                    eTag._linear = (ETag::ETagSize) _hasLinearBoundaries;
-                }
-            }
-        } else if (vFaces.size() > 0) {
-            //
-            //  Unfortunately for non-manifold cases we can't make as much use of the
-            //  retrieved face-values as there is no correlation between the incident
-            //  edge and face lists.  So inspect each edge for continuity between its
-            //  faces in general -- which is awkward (and what we were hoping to avoid
-            //  by doing the overall vertex traversal to begin with):
-            //
-            for (int i = 0; i < vEdges.size(); ++i) {
-                Index eIndex = vEdges[i];
-
-                ConstIndexArray eFaces  = _level.getEdgeFaces(eIndex);
-                if (eFaces.size() < 2) continue;
-
-                ConstLocalIndexArray eInFace = _level.getEdgeFaceLocalIndices(eIndex);
-                ConstIndexArray      eVerts  = _level.getEdgeVertices(eIndex);
-
-                int   vertInEdge = vInEdge[i];
-                bool  markEdgeDiscts = false;
-                Index valueIndexInFace0 = 0;
-                for (int j = 0; !markEdgeDiscts && (j < eFaces.size()); ++j) {
-                    Index           fIndex  = eFaces[j];
-                    ConstIndexArray fVerts  = _level.getFaceVertices(fIndex);
-                    ConstIndexArray fValues = getFaceValues(fIndex);
-
-                    int edgeInFace   = eInFace[j];
-                    int edgeReversed = (eVerts[0] != fVerts[edgeInFace]);
-                    int vertInFace   = edgeInFace + (vertInEdge != edgeReversed);
-                    if (vertInFace == fVerts.size()) vertInFace = 0;
-
-                    if (j == 0) {
-                        valueIndexInFace0 = fValues[vertInFace];
-                    } else {
-                        markEdgeDiscts = (fValues[vertInFace] != valueIndexInFace0);
+                        //  Mark the edge as discts from this end:
+                        ConstIndexArray eVerts = _level.getEdgeVertices(eIndex);
+                        if (eVerts[0] == vIndex) edgeDisctsFromV0[eIndex] = true;
+                        if (eVerts[1] == vIndex) edgeDisctsFromV1[eIndex] = true;
                     }
                 }
-                if (markEdgeDiscts) {
-                    //  Tag both end vertices as not matching topology:
-                    vertexMismatch[eVerts[0]] = true;
-                    vertexMismatch[eVerts[1]] = true;
-
-                    //  Tag the corresponding edge as discts:
-                    ETag& eTag = _edgeTags[eIndex];
-
-                    eTag._disctsV0 = (eVerts[0] == vIndex);
-                    eTag._disctsV1 = (eVerts[1] == vIndex);
-                    eTag._mismatch = true;
-                    eTag._linear = (ETag::ETagSize) _hasLinearBoundaries;
+            } else if (vFaces.size() > 0) {
+                //
+                //  Unfortunately for non-manifold cases we can't make as much use of the
+                //  retrieved face-values as there is no correlation between the incident
+                //  edge and face lists.  So inspect each edge for continuity between its
+                //  faces in general -- which is awkward (and what we were hoping to avoid
+                //  by doing the overall vertex traversal to begin with):
+                //
+                for (int i = 0; i < vEdges.size(); ++i) {
+                    Index eIndex = vEdges[i];
+
+                    ConstIndexArray eFaces  = _level.getEdgeFaces(eIndex);
+                    if (eFaces.size() < 2) continue;
+
+                    ConstLocalIndexArray eInFace = _level.getEdgeFaceLocalIndices(eIndex);
+                    ConstIndexArray      eVerts  = _level.getEdgeVertices(eIndex);
+
+                    int   vertInEdge = vInEdge[i];
+                    bool  markEdgeDiscts = false;
+                    Index valueIndexInFace0 = 0;
+                    for (int j = 0; !markEdgeDiscts && (j < eFaces.size()); ++j) {
+                        Index           fIndex  = eFaces[j];
+                        ConstIndexArray fVerts  = _level.getFaceVertices(fIndex);
+                        ConstIndexArray fValues = getFaceValues(fIndex);
+
+                        int edgeInFace   = eInFace[j];
+                        int edgeReversed = (eVerts[0] != fVerts[edgeInFace]);
+                        int vertInFace   = edgeInFace + (vertInEdge != edgeReversed);
+                        if (vertInFace == fVerts.size()) vertInFace = 0;
+
+                        if (j == 0) {
+                            valueIndexInFace0 = fValues[vertInFace];
+                        } else {
+                            markEdgeDiscts = (fValues[vertInFace] != valueIndexInFace0);
+                        }
+                    }
+                    if (markEdgeDiscts) {
+                        //  Mark the edge as discts from this end:
+                        if (eVerts[0] == vIndex) edgeDisctsFromV0[eIndex] = true;
+                        if (eVerts[1] == vIndex) edgeDisctsFromV1[eIndex] = true;
+                    }
                 }
             }
-        }
 
-        //
-        //  While we've tagged the vertex as having mismatched FVar topology in the presence of
-        //  any discts edges, we also need to account for different treatment of vertices along
-        //  geometric boundaries if the FVar interpolation rules affect them.  So inspect all
-        //  boundary vertices that have not already been tagged.
-        //
-        if (vIsBoundary && !vertexMismatch[vIndex]) {
-            if (_hasLinearBoundaries && (vFaces.size() > 0)) {
-                vertexMismatch[vIndex] = true;
+            //
+            //  Inspect the set of fvar-values around the vertex to identify the number of
+            //  unique values.  While doing so, associate a "sibling index" (over the range
+            //  of unique values) with each value around the vertex (this latter need makes
+            //  it harder to make simple use of std::sort() and uniq() on the set of values)
+            //
+            int uniqueValueCount = 1;
+
+            uniqueValues[0] = vValues[0];
+            vValueSiblings[0] = 0;
 
-                if (vIsManifold) {
-                    _edgeTags[vEdges[0]]._linear = true;
-                    _edgeTags[vEdges[vEdges.size()-1]]._linear = true;
+            for (int i = 1; i < vFaces.size(); ++i) {
+                if (vValues[i] == vValues[i-1]) {
+                    vValueSiblings[i] = vValueSiblings[i-1];
                 } else {
-                    for (int i = 0; i < vEdges.size(); ++i) {
-                        if (_level.getEdgeTag(vEdges[i])._boundary) {
-                            _edgeTags[vEdges[i]]._linear = true;
+                    //  Add the "new" value if not already present -- unless found, the
+                    //  sibling index will be for the next/new unique value:
+                    vValueSiblings[i] = (Sibling) uniqueValueCount;
+
+                    if (uniqueValueCount == 1) {
+                        uniqueValues[uniqueValueCount++] = vValues[i];
+                    } else if ((uniqueValueCount == 2) && (uniqueValues[0] != vValues[i])) {
+                        uniqueValues[uniqueValueCount++] = vValues[i];
+                    } else {
+                        int* uniqueBegin = uniqueValues;
+                        int* uniqueEnd   = uniqueValues + uniqueValueCount;
+                        int* uniqueFound = std::find(uniqueBegin, uniqueEnd, vValues[i]);
+                        if (uniqueFound == uniqueEnd) {
+                            uniqueValues[uniqueValueCount++] = vValues[i];
+                        } else {
+                            vValueSiblings[i] = (Sibling) (uniqueFound - uniqueBegin);
                         }
                     }
                 }
-            } else if (vFaces.size() == 1) {
-                if (makeSmoothCornersSharp) {
-                    vertexMismatch[vIndex] = true;
+            }
+
+            //
+            //  Update the value count for this vertex (offsets are assigned once all
+            //  are known) and the vert-face siblings from the local array above:
+            //
+            _vertSiblingCounts[vIndex] = (LocalIndex) uniqueValueCount;
+
+            if (uniqueValueCount > 1) {
+                SiblingArray vFaceSiblings = getVertexFaceSiblings(vIndex);
+                for (int i = 0; i < vFaces.size(); ++i) {
+                    vFaceSiblings[i] = vValueSiblings[i];
                 }
             }
         }
+    }
 
-        //
-        //  Inspect the set of fvar-values around the vertex to identify the number of
-        //  unique values.  While doing so, associate a "sibling index" (over the range
-        //  of unique values) with each value around the vertex (this latter need makes
-        //  it harder to make simple use of std::sort() and uniq() on the set of values)
-        //
-        int uniqueValueCount = 1;
+    //
+    //  The presence of a discts edge marks the vertices at BOTH ends as having
+    //  mismatched topology.  While we've tagged the vertex as having mismatched FVar
+    //  topology in the presence of any discts edges, we also need to account for
+    //  different treatment of vertices along geometric boundaries if the FVar
+    //  interpolation rules affect them.  So inspect all boundary vertices that have
+    //  not already been tagged -- as when traversing the vertices in order, i.e.
+    //  those without discts edges marked from themselves or lower indexed vertices.
+    //
+    std::vector<unsigned char> vertexLinearBoundary(numVertices, 0);
 
-        uniqueValues[0] = vValues[0];
-        vValueSiblings[0] = 0;
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(static, 256)
+#endif
+    for (int vIndex = 0; vIndex < numVertices; ++vIndex) {
+        ConstIndexArray vEdges = _level.getVertexEdges(vIndex);
 
-        for (int i = 1; i < vFaces.size(); ++i) {
-            if (vValues[i] == vValues[i-1]) {
-                vValueSiblings[i] = vValueSiblings[i-1];
-            } else {
-                //  Add the "new" value if not already present -- unless found, the
-                //  sibling index will be for the next/new unique value:
-                vValueSiblings[i] = (Sibling) uniqueValueCount;
-
-                if (uniqueValueCount == 1) {
-                    uniqueValues[uniqueValueCount++] = vValues[i];
-                } else if ((uniqueValueCount == 2) && (uniqueValues[0] != vValues[i])) {
-                    uniqueValues[uniqueValueCount++] = vValues[i];
-                } else {
-                    int* uniqueBegin = uniqueValues;
-                    int* uniqueEnd   = uniqueValues + uniqueValueCount;
-                    int* uniqueFound = std::find(uniqueBegin, uniqueEnd, vValues[i]);
-                    if (uniqueFound == uniqueEnd) {
-                        uniqueValues[uniqueValueCount++] = vValues[i];
-                    } else {
-                        vValueSiblings[i] = (Sibling) (uniqueFound - uniqueBegin);
-                    }
+        bool hasDisctsEdges      = false;
+        bool hasPrecedingDiscts  = false;
+        for (int i = 0; i < vEdges.size(); ++i) {
+            ConstIndexArray eVerts = _level.getEdgeVertices(vEdges[i]);
+
+            bool disctsFromV0 = edgeDisctsFromV0[vEdges[i]] != 0;
+            bool disctsFromV1 = edgeDisctsFromV1[vEdges[i]] != 0;
+
+            hasDisctsEdges     |= disctsFromV0 || disctsFromV1;
+            hasPrecedingDiscts |= (disctsFromV0 && (eVerts[0] <= vIndex)) ||
+                                  (disctsFromV1 && (eVerts[1] <= vIndex));
+        }
+        bool isMismatched = hasDisctsEdges;
+
+        Level::VTag const vTag = _level.getVertexTag(vIndex);
+
+        int vFaceCount = _level.getNumVertexFaces(vIndex);
+
+        if (vTag._boundary && !hasPrecedingDiscts) {
+            if (_hasLinearBoundaries && (vFaceCount > 0)) {
+                isMismatched = true;
+                vertexLinearBoundary[vIndex] = true;
+            } else if (vFaceCount == 1) {
+                if (makeSmoothCornersSharp) {
+                    isMismatched = true;
                 }
             }
         }
@@ -390,27 +444,59 @@ FVarLevel::completeTopologyFromFaceValues(int regularBoundaryValence) {
         //  edges that would previously have identified mismatch (e.g. two faces meeting
         //  at a common vertex), so deal with that case now that we've counted values:
         //
-        if (!vIsManifold && !vertexMismatch[vIndex]) {
-            vertexMismatch[vIndex] = (uniqueValueCount > 1);
+        if (vTag._nonManifold && (_vertSiblingCounts[vIndex] > 1)) {
+            isMismatched = true;
         }
+        vertexMismatch[vIndex] = isMismatched;
+    }
 
-        //
-        //  Update the value count and offset for this vertex and cumulative totals:
-        //
-        _vertSiblingCounts[vIndex]  = (LocalIndex) uniqueValueCount;
-        _vertSiblingOffsets[vIndex] = totalValueCount;
+    //
+    //  Tag the discts edges -- the discts end is that of the last (highest indexed)
+    //  vertex marking it -- and the boundary edges of vertices made linear above:
+    //
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads) schedule(static, 256)
+#endif
+    for (int eIndex = 0; eIndex < numEdges; ++eIndex) {
+        ConstIndexArray eVerts = _level.getEdgeVertices(eIndex);
 
-        totalValueCount += uniqueValueCount;
+        ETag& eTag = _edgeTags[eIndex];
 
-        //  Update the vert-face siblings from the local array above:
-        if (uniqueValueCount > 1) {
-            SiblingArray vFaceSiblings = getVertexFaceSiblings(vIndex);
-            for (int i = 0; i < vFaces.size(); ++i) {
-                vFaceSiblings[i] = vValueSiblings[i];
+        if (edgeDisctsFromV0[eIndex] || edgeDisctsFromV1[eIndex]) {
+            Index vLast = !edgeDisctsFromV1[eIndex] ? eVerts[0] :
+                          (!edgeDisctsFromV0[eIndex] ? eVerts[1] : std::max(eVerts[0], eVerts[1]));
+
+            eTag._disctsV0 = (eVerts[0] == vLast);
+            eTag._disctsV1 = (eVerts[1] == vLast);
+            eTag._mismatch = true;
+            eTag._linear = (ETag::ETagSize) _hasLinearBoundaries;
+        } else {
+            for (int i = 0; i < 2; ++i) {
+                Index vIndex = eVerts[i];
+                if (!vertexLinearBoundary[vIndex]) continue;
+
+                if (!_level.getVertexTag(vIndex)._nonManifold) {
+                    ConstIndexArray vEdges = _level.getVertexEdges(vIndex);
+                    if ((vEdges[0] == eIndex) || (vEdges[vEdges.size()-1] == eIndex)) {
+                        eTag._linear = true;
+                    }
+                } else if (_level.getEdgeTag(eIndex)._boundary) {
+                    eTag._linear = true;
+                }
             }
         }
     }
 
+    //
+    //  Assign an offset to the first value of each vertex from the cumulative totals:
+    //
+    int totalValueCount = 0;
+    for (int vIndex = 0; vIndex < numVertices; ++vIndex) {
+        _vertSiblingOffsets[vIndex] = totalValueCount;
+
+        totalValueCount += _vertSiblingCounts[vIndex];
+    }
+
     //
     //  Now that we know the total number of additional sibling values (M values in addition
     //  to the N vertex values) allocate space to accommodate all N + M vertex values.
@@ -420,161 +506,194 @@ FVarLevel::completeTopologyFromFaceValues(int regularBoundaryValence) {
     //
     resizeVertexValues(totalValueCount);
 
-    for (int vIndex = 0; vIndex < _level.getNumVertices(); ++vIndex) {
-        ConstIndexArray       vFaces  = _level.getVertexFaces(vIndex);
-        ConstLocalIndexArray  vInFace = _level.getVertexFaceLocalIndices(vIndex);
+    //
+    //  When no vertex is mismatched and each value is uniquely associated with a
+    //  vertex, the channel matches the vertex topology -- refinement of the channel
+    //  is then trivial as all child values will correspond to child vertices:
+    //
+    _matchesVertexTopology = !_isLinear && (totalValueCount == _valueCount) &&
+        (std::find(vertexMismatch.begin(), vertexMismatch.end(), true) == vertexMismatch.end());
+
+    if (_matchesVertexTopology) {
+        std::vector<unsigned char> valueAssigned(_valueCount, 0);
+        for (int vIndex = 0; _matchesVertexTopology && (vIndex < _level.getNumVertices()); ++vIndex) {
+            ConstIndexArray vFaces = _level.getVertexFaces(vIndex);
+            if (vFaces.size() == 0) {
+                _matchesVertexTopology = false;
+            } else {
+                Index vValue = _faceVertValues[_level.getOffsetOfFaceVertices(vFaces[0]) +
+                                               _level.getVertexFaceLocalIndices(vIndex)[0]];
+                _matchesVertexTopology = !valueAssigned[vValue];
+                valueAssigned[vValue] = true;
+            }
+        }
+    }
 
-        //
-        //  First step is to assign the values associated with the faces by retrieving them
-        //  from the faces.  If the face-varying topology around this vertex matches the vertex
-        //  topology, there is little more to do as other members were bulk-initialized to
-        //  match, so we can continue immediately:
-        //
-        IndexArray vValues = getVertexValues(vIndex);
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel if (numThreads > 1) num_threads(numThreads)
+#endif
+    {
+        internal::StackBuffer<ValueSpan,16> spanBuffer(maxValence);
 
-        if (vFaces.size() > 0) {
-            vValues[0] = _faceVertValues[_level.getOffsetOfFaceVertices(vFaces[0]) + vInFace[0]];
-        } else {
-            vValues[0] = 0;
-        }
-        if (!vertexMismatch[vIndex]) {
-            continue;
-        }
-        if (vValues.size() > 1) {
-            ConstSiblingArray vFaceSiblings = getVertexFaceSiblings(vIndex);
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp for schedule(static, 256)
+#endif
+        for (int vIndex = 0; vIndex < numVertices; ++vIndex) {
+            ConstIndexArray       vFaces  = _level.getVertexFaces(vIndex);
+            ConstLocalIndexArray  vInFace = _level.getVertexFaceLocalIndices(vIndex);
+
+            //
+            //  First step is to assign the values associated with the faces by retrieving them
+            //  from the faces.  If the face-varying topology around this vertex matches the vertex
+            //  topology, there is little more to do as other members were bulk-initialized to
+            //  match, so we can continue immediately:
+            //
+            IndexArray vValues = getVertexValues(vIndex);
+
+            if (vFaces.size() > 0) {
+                vValues[0] = _faceVertValues[_level.getOffsetOfFaceVertices(vFaces[0]) + vInFace[0]];
+            } else {
+                vValues[0] = 0;
+            }
+            if (!vertexMismatch[vIndex]) {
+                continue;
+            }
+            if (vValues.size() > 1) {
+                ConstSiblingArray vFaceSiblings = getVertexFaceSiblings(vIndex);
 
-            for (int i = 1, nextSibling = 1; i < vFaces.size(); ++i) {
-                if (vFaceSiblings[i] == nextSibling) {
-                    vValues[nextSibling++] = _faceVertValues[_level.getOffsetOfFaceVertices(vFaces[i]) + vInFace[i]];
+                for (int i = 1, nextSibling = 1; i < vFaces.size(); ++i) {
+                    if (vFaceSiblings[i] == nextSibling) {
+                        vValues[nextSibling++] = _faceVertValues[_level.getOffsetOfFaceVertices(vFaces[i]) + vInFace[i]];
+                    }
                 }
             }
-        }
 
-        //  XXXX (barfowl) -- this pre-emptive sharpening of values will need to be
-        //  revisited soon.  This intentionally avoids the overhead of identifying the
-        //  local topology of the values along its boundaries -- necessary for smooth
-        //  boundary values but not for sharp as far as refining and limiting the
-        //  values is concerned.  But ultimately we need more information than just
-        //  the sharp tag when it comes to identifying and gathering FVar patches.
-        //
-        //  Currently values for non-manifold vertices are sharpened, and that may
-        //  also need to be revisited.
-        //
-        //  Until then...
-        //
-        //  If all values for this vertex are to be designated as sharp, the value tags
-        //  have already been initialized for this by default, so we can continue.  On
-        //  further inspection there may be other cases where all are determined to be
-        //  sharp, but use what information we can now to avoid that inspection:
-        //
-        //  Regarding sharpness of the vertex itself, its vertex tags reflect the inf-
-        //  or semi-sharp nature of the vertex and edges around it, so be careful not
-        //  to assume too much from say, the presence of an incident inf-sharp edge.
-        //  We can make clear decisions based on the sharpness of the vertex itself.
-        //
-        ValueTagArray vValueTags = getVertexValueTags(vIndex);
+            //  XXXX (barfowl) -- this pre-emptive sharpening of values will need to be
+            //  revisited soon.  This intentionally avoids the overhead of identifying the
+            //  local topology of the values along its boundaries -- necessary for smooth
+            //  boundary values but not for sharp as far as refining and limiting the
+            //  values is concerned.  But ultimately we need more information than just
+            //  the sharp tag when it comes to identifying and gathering FVar patches.
+            //
+            //  Currently values for non-manifold vertices are sharpened, and that may
+            //  also need to be revisited.
+            //
+            //  Until then...
+            //
+            //  If all values for this vertex are to be designated as sharp, the value tags
+            //  have already been initialized for this by default, so we can continue.  On
+            //  further inspection there may be other cases where all are determined to be
+            //  sharp, but use what information we can now to avoid that inspection:
+            //
+            //  Regarding sharpness of the vertex itself, its vertex tags reflect the inf-
+            //  or semi-sharp nature of the vertex and edges around it, so be careful not
+            //  to assume too much from say, the presence of an incident inf-sharp edge.
+            //  We can make clear decisions based on the sharpness of the vertex itself.
+            //
+            ValueTagArray vValueTags = getVertexValueTags(vIndex);
 
-        Level::VTag const vTag = _level.getVertexTag(vIndex);
+            Level::VTag const vTag = _level.getVertexTag(vIndex);
 
-        bool allCornersAreSharp = _hasLinearBoundaries || vTag._infSharp || vTag._nonManifold ||
-                                  (_hasDependentSharpness && (vValues.size() > 2)) ||
-                                  (sharpenDarts && (vValues.size() == 1) && !vTag._boundary);
+            bool allCornersAreSharp = _hasLinearBoundaries || vTag._infSharp || vTag._nonManifold ||
+                                      (_hasDependentSharpness && (vValues.size() > 2)) ||
+                                      (sharpenDarts && (vValues.size() == 1) && !vTag._boundary);
 
-        //
-        //  Values may be a mix of sharp corners and smooth boundaries -- start by
-        //  gathering information about the "span" of faces for each value.
-        //
-        //  Note that the term "span" presumes sequential and continuous, but the
-        //  result for a span may include multiple disconnected regions sharing the
-        //  common value -- think of a familiar non-manifold "bowtie" vertex in FVar
-        //  space.  Such spans are locally non-manifold but are marked as "disjoint"
-        //  to avoid overloading "non-manifold" here.
-        //
-        ValueSpan * vValueSpans = spanBuffer;
-        memset(vValueSpans, 0, vValues.size() * sizeof(ValueSpan));
+            //
+            //  Values may be a mix of sharp corners and smooth boundaries -- start by
+            //  gathering information about the "span" of faces for each value.
+            //
+            //  Note that the term "span" presumes sequential and continuous, but the
+            //  result for a span may include multiple disconnected regions sharing the
+            //  common value -- think of a familiar non-manifold "bowtie" vertex in FVar
+            //  space.  Such spans are locally non-manifold but are marked as "disjoint"
+            //  to avoid overloading "non-manifold" here.
+            //
+            ValueSpan * vValueSpans = spanBuffer;
+            memset(vValueSpans, 0, vValues.size() * sizeof(ValueSpan));
 
-        gatherValueSpans(vIndex, vValueSpans);
+            gatherValueSpans(vIndex, vValueSpans);
 
-        //
-        //  Spans are identified as sharp or smooth based on their own local topology,
-        //  but the sharpness of one span may be dependent on the sharpness of another
-        //  if certain linear-interpolation options were specified.  Mark both as
-        //  infinitely sharp where possible (rather than semi-sharp) to avoid
-        //  re-assessing this dependency as sharpness is reduced during refinement.
-        //
-        bool hasDependentValuesToSharpen = false;
-        if (!allCornersAreSharp) {
-            if (_hasDependentSharpness && (vValues.size() == 2)) {
-                //  Detect interior inf-sharp or discts edges:
-                allCornersAreSharp = vValueSpans[0]._infSharpEdgeCount || vValueSpans[1]._infSharpEdgeCount ||
-                                     vValueSpans[0]._disctsEdgeCount   || vValueSpans[1]._disctsEdgeCount;
-
-                //  Detect a sharp corner, making both sharp:
-                if (sharpenBothIfOneCorner) {
-                    allCornersAreSharp |= (vValueSpans[0]._size == 1) || (vValueSpans[1]._size == 1);
-                }
+            //
+            //  Spans are identified as sharp or smooth based on their own local topology,
+            //  but the sharpness of one span may be dependent on the sharpness of another
+            //  if certain linear-interpolation options were specified.  Mark both as
+            //  infinitely sharp where possible (rather than semi-sharp) to avoid
+            //  re-assessing this dependency as sharpness is reduced during refinement.
+            //
+            bool hasDependentValuesToSharpen = false;
+            if (!allCornersAreSharp) {
+                if (_hasDependentSharpness && (vValues.size() == 2)) {
+                    //  Detect interior inf-sharp or discts edges:
+                    allCornersAreSharp = vValueSpans[0]._infSharpEdgeCount || vValueSpans[1]._infSharpEdgeCount ||
+                                         vValueSpans[0]._disctsEdgeCount   || vValueSpans[1]._disctsEdgeCount;
+
+                    //  Detect a sharp corner, making both sharp:
+                    if (sharpenBothIfOneCorner) {
+                        allCornersAreSharp |= (vValueSpans[0]._size == 1) || (vValueSpans[1]._size == 1);
+                    }
 
-                //  If only one semi-sharp, need to mark the other as dependent on it:
-                hasDependentValuesToSharpen = (vValueSpans[0]._semiSharpEdgeCount > 0) !=
-                                              (vValueSpans[1]._semiSharpEdgeCount > 0);
+                    //  If only one semi-sharp, need to mark the other as dependent on it:
+                    hasDependentValuesToSharpen = (vValueSpans[0]._semiSharpEdgeCount > 0) !=
+                                                  (vValueSpans[1]._semiSharpEdgeCount > 0);
+                }
             }
-        }
 
-        //
-        //  Inspect each vertex value to determine if it is a smooth boundary (crease) and tag
-        //  it accordingly.  If not semi-sharp, be sure to consider those values sharpened by
-        //  the topology of other values.
-        //
-        for (int i = 0; i < vValues.size(); ++i) {
-            ValueTag & valueTag = vValueTags[i];
-
-            valueTag.clear();
-            valueTag._mismatch = true;
-
-            ValueSpan const & vSpan = vValueSpans[i];
-            if (vSpan._disctsEdgeCount) {
-                valueTag._nonManifold = true;
-                continue;
-            }
-            assert(vSpan._size != 0);
+            //
+            //  Inspect each vertex value to determine if it is a smooth boundary (crease) and tag
+            //  it accordingly.  If not semi-sharp, be sure to consider those values sharpened by
+            //  the topology of other values.
+            //
+            for (int i = 0; i < vValues.size(); ++i) {
+                ValueTag & valueTag = vValueTags[i];
 
-            bool isInfSharp = allCornersAreSharp || vSpan._infSharpEdgeCount ||
-                              ((vSpan._size == 1) && fvarCornersAreSharp);
+                valueTag.clear();
+                valueTag._mismatch = true;
 
-            if (vSpan._size == 1) {
-                valueTag._xordinary = !isInfSharp;
-            } else {
-                valueTag._xordinary = (vSpan._size != regularBoundaryValence);
-            }
+                ValueSpan const & vSpan = vValueSpans[i];
+                if (vSpan._disctsEdgeCount) {
+                    valueTag._nonManifold = true;
+                    continue;
+                }
+                assert(vSpan._size != 0);
 
-            valueTag._infSharpEdges = (vSpan._infSharpEdgeCount > 0);
-            valueTag._infIrregular = vSpan._infSharpEdgeCount ? ((vSpan._size - vSpan._infSharpEdgeCount) > 1)
-                                   : (isInfSharp ? (vSpan._size > 1) : valueTag._xordinary);
+                bool isInfSharp = allCornersAreSharp || vSpan._infSharpEdgeCount ||
+                                  ((vSpan._size == 1) && fvarCornersAreSharp);
 
-            if (!isInfSharp) {
-                //
-                //  Remember that a semi-sharp value (or one dependent on one) needs to be
-                //  treated as a corner (at least three sharp edges or one sharp vertex)
-                //  until the sharpness has decayed, so don't tag them as creases here.
-                //  But do initialize and maintain the ends of the crease until needed.
-                //
-                if (vSpan._semiSharpEdgeCount || vTag._semiSharp) {
-                    valueTag._semiSharp = true;
-                } else if (hasDependentValuesToSharpen) {
-                    valueTag._semiSharp = true;
-                    valueTag._depSharp = true;
+                if (vSpan._size == 1) {
+                    valueTag._xordinary = !isInfSharp;
                 } else {
-                    valueTag._crease = true;
+                    valueTag._xordinary = (vSpan._size != regularBoundaryValence);
                 }
 
-                if (hasCreaseEnds()) {
-                    CreaseEndPair & valueCrease = getVertexValueCreaseEnds(vIndex)[i];
-
-                    valueCrease._startFace = vSpan._start;
-                    if ((i == 0) && (vSpan._start != 0)) {
-                        valueCrease._endFace = (LocalIndex) (vSpan._start + vSpan._size - 1 - vFaces.size());
+                valueTag._infSharpEdges = (vSpan._infSharpEdgeCount > 0);
+                valueTag._infIrregular = vSpan._infSharpEdgeCount ? ((vSpan._size - vSpan._infSharpEdgeCount) > 1)
+                                       : (isInfSharp ? (vSpan._size > 1) : valueTag._xordinary);
+
+                if (!isInfSharp) {
+                    //
+                    //  Remember that a semi-sharp value (or one dependent on one) needs to be
+                    //  treated as a corner (at least three sharp edges or one sharp vertex)
+                    //  until the sharpness has decayed, so don't tag them as creases here.
+                    //  But do initialize and maintain the ends of the crease until needed.
+                    //
+                    if (vSpan._semiSharpEdgeCount || vTag._semiSharp) {
+                        valueTag._semiSharp = true;
+                    } else if (hasDependentValuesToSharpen) {
+                        valueTag._semiSharp = true;
+                        valueTag._depSharp = true;
                     } else {
-                        valueCrease._endFace = (LocalIndex) (vSpan._start + vSpan._size - 1);
+                        valueTag._crease = true;
+                    }
+
+                    if (hasCreaseEnds()) {
+                        CreaseEndPair & valueCrease = getVertexValueCreaseEnds(vIndex)[i];
+
+                        valueCrease._startFace = vSpan._start;
+                        if ((i == 0) && (vSpan._start != 0)) {
+                            valueCrease._endFace = (LocalIndex) (vSpan._start + vSpan._size - 1 - vFaces.size());
+                        } else {
+                            valueCrease._endFace = (LocalIndex) (vSpan._start + vSpan._size - 1);
+                        }
                     }
                 }
             }
@@ -621,6 +740,15 @@ FVarLevel::getVertexCreaseEndValues(Index vIndex, Sibling vSibling, Index endVal
 bool
 FVarLevel::validate() const {
 
+    //  Nothing is stored when values are implicitly the vertices:
+    if (_valuesAreVertices) {
+        if (_valueCount != _level.getNumVertices()) {
+            printf("Error:  value/vertex count mismatch\n");
+            return false;
+        }
+        return true;
+    }
+
     //
     //  Verify that member sizes match sizes for the associated level:
     //
@@ -637,7 +765,7 @@ FVarLevel::validate() const {
         return false;
     }
     if (_level.getDepth() > 0) {
-        if (_valueCount != (int)_vertValueIndices.size()) {
+        if (_valueCount != (int)_vertValueTags.size()) {
             printf("Error:  value/vertex-value count mismatch\n");
             return false;
         }
@@ -704,17 +832,77 @@ FVarLevel::validate() const {
     return true;
 }
 
+//
+//  Serialization to/from a flat binary buffer (see Level::write/read):
+//
 void
-FVarLevel::print() const {
+FVarLevel::write(BinaryWriter & stream) const {
+
+    stream.write(_options);
+    stream.write(_isLinear);
+    stream.write(_hasLinearBoundaries);
+    stream.write(_hasDependentSharpness);
+    stream.write(_matchesVertexTopology);
+    stream.write(_valuesAreVertices);
+    stream.write(_valueCount);
+
+    stream.writeVector(_faceVertValues);
+    stream.writeVector(_edgeTags);
+
+    stream.writeVector(_vertSiblingCounts);
+    stream.writeVector(_vertSiblingOffsets);
+    stream.writeVector(_vertFaceSiblings);
+
+    stream.writeVector(_vertValueIndices);
+    stream.writeVector(_vertValueTags);
+    stream.writeVector(_vertValueCreaseEnds);
+}
 
-    std::vector<Sibling> fvSiblingVector;
-    buildFaceVertexSiblingsFromVertexFaceSiblings(fvSiblingVector);
+bool
+FVarLevel::read(BinaryReader & stream) {
+
+    stream.read(_options);
+    stream.read(_isLinear);
+    stream.read(_hasLinearBoundaries);
+    stream.read(_hasDependentSharpness);
+    stream.read(_matchesVertexTopology);
+    stream.read(_valuesAreVertices);
+    stream.read(_valueCount);
+
+    stream.readVector(_faceVertValues);
+    stream.readVector(_edgeTags);
+
+    stream.readVector(_vertSiblingCounts);
+    stream.readVector(_vertSiblingOffsets);
+    stream.readVector(_vertFaceSiblings);
+
+    stream.readVector(_vertValueIndices);
+    stream.readVector(_vertValueTags);
+    stream.readVector(_vertValueCreaseEnds);
+
+    if (_valuesAreVertices) {
+        return stream.isValid() && _faceVertValues.empty() && _vertSiblingCounts.empty();
+    }
+    return stream.isValid() &&
+           ((int)_faceVertValues.size() == _level.getNumFaceVerticesTotal()) &&
+           ((int)_vertSiblingCounts.size() == _level.getNumVertices());
+}
+
+void
+FVarLevel::print() const {
 
     printf("Face-varying data channel:\n");
     printf("  Inventory:\n");
     printf("    vertex count       = %d\n", _level.getNumVertices());
     printf("    source value count = %d\n", _valueCount);
-    printf("    vertex value count = %d\n", (int)_vertValueIndices.size());
+    if (_valuesAreVertices) {
+        printf("    values are vertices\n");
+        return;
+    }
+    printf("    vertex value count = %d\n", (int)_vertValueTags.size());
+
+    std::vector<Sibling> fvSiblingVector;
+    buildFaceVertexSiblingsFromVertexFaceSiblings(fvSiblingVector);
 
     printf("  Face values:\n");
     for (int i = 0; i < _level.getNumFaces(); ++i) {
@@ -746,11 +934,9 @@ FVarLevel::print() const {
 
         printf("    vert%4d:  vcount = %1d, voffset =%4d, ", i, vCount, vOffset);
 
-        ConstIndexArray vValues = getVertexValues(i);
-
         printf("values =");
-        for (int j = 0; j < vValues.size(); ++j) {
-            printf("%4d", vValues[j]);
+        for (int j = 0; j < vCount; ++j) {
+            printf("%4d", getVertexValue(i, (Sibling)j));
         }
         if (vCount > 1) {
             ConstValueTagArray vValueTags = getVertexValueTags(i);
@@ -1034,9 +1220,15 @@ FVarLevel::getFaceValueTags(Index faceIndex, ValueTag valueTags[]) const {
     ConstIndexArray faceValues = getFaceValues(faceIndex);
     ConstIndexArray faceVerts  = _level.getFaceVertices(faceIndex);
 
+    if (_valuesAreVertices) {
+        for (int i = 0; i < faceValues.size(); ++i) {
+            valueTags[i] = _matchingValueTag;
+        }
+        return;
+    }
     for (int i = 0; i < faceValues.size(); ++i) {
         Index srcValueIndex = findVertexValueIndex(faceVerts[i], faceValues[i]);
-        assert(_vertValueIndices[srcValueIndex] == faceValues[i]);
+        assert(_vertValueIndices.empty() || (_vertValueIndices[srcValueIndex] == faceValues[i]));
 
         valueTags[i] = _vertValueTags[srcValueIndex];
     }
@@ -1045,6 +1237,8 @@ FVarLevel::getFaceValueTags(Index faceIndex, ValueTag valueTags[]) const {
 FVarLevel::ValueTag
 FVarLevel::getFaceCompositeValueTag(Index faceIndex) const {
 
+    if (_valuesAreVertices) return _matchingValueTag;
+
     ConstIndexArray faceValues = getFaceValues(faceIndex);
     ConstIndexArray faceVerts  = _level.getFaceVertices(faceIndex);
 
@@ -1053,7 +1247,7 @@ FVarLevel::getFaceCompositeValueTag(Index faceIndex) const {
     ValueTagSize compInt = 0;
     for (int i = 0; i < faceValues.size(); ++i) {
         Index srcValueIndex = findVertexValueIndex(faceVerts[i], faceValues[i]);
-        assert(_vertValueIndices[srcValueIndex] == faceValues[i]);
+        assert(_vertValueIndices.empty() || (_vertValueIndices[srcValueIndex] == faceValues[i]));
 
         ValueTag const &   srcTag = _vertValueTags[srcValueIndex];
         ValueTagSize const srcInt = srcTag.getBits();
@@ -1063,6 +1257,33 @@ FVarLevel::getFaceCompositeValueTag(Index faceIndex) const {
     return ValueTag(compInt);
 }
 
+size_t
+FVarLevel::getMemoryUsage() const {
+
+    return sizeof(*this) +
+        _faceVertValues.getMemoryUsage() +
+        _edgeTags.getMemoryUsage() +
+        _vertSiblingCounts.getMemoryUsage() +
+        _vertSiblingOffsets.getMemoryUsage() +
+        _vertFaceSiblings.getMemoryUsage() +
+        _vertValueIndices.getMemoryUsage() +
+        _vertValueTags.getMemoryUsage() +
+        _vertValueCreaseEnds.getMemoryUsage();
+}
+
+void
+FVarLevel::releaseTopology() {
+
+    _faceVertValues.release();
+    _edgeTags.release();
+    _vertSiblingCounts.release();
+    _vertSiblingOffsets.release();
+    _vertFaceSiblings.release();
+    _vertValueIndices.release();
+    _vertValueTags.release();
+    _vertValueCreaseEnds.release();
+}
+
 } // end namespace internal
 } // end namespace Vtr
 
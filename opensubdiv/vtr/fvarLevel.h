@@ -172,17 +172,31 @@ public:
     FVarLevel(Level const& level);
     ~FVarLevel();
 
+    //  Serialization to/from a flat binary buffer (see Level::write/read):
+    void write(BinaryWriter & stream) const;
+    bool read(BinaryReader & stream);
+
     //  Queries for the entire channel:
     Level const& getLevel() const { return _level; }
 
     int getNumValues() const          { return _valueCount; }
-    int getNumFaceValuesTotal() const { return (int) _faceVertValues.size(); }
+    int getNumFaceValuesTotal() const { return _valuesAreVertices ? _level.getNumFaceVerticesTotal()
+                                                                  : (int) _faceVertValues.size(); }
 
     bool isLinear() const            { return _isLinear; }
     bool hasLinearBoundaries() const { return _hasLinearBoundaries; }
     bool hasSmoothBoundaries() const { return ! _hasLinearBoundaries; }
     bool hasCreaseEnds() const       { return hasSmoothBoundaries(); }
 
+    //  A channel matching the vertex topology has a single value per vertex that
+    //  is interpolated identically, so refined values correspond to vertices:
+    bool matchesVertexTopology() const { return _matchesVertexTopology; }
+
+    //  The refined levels of such a channel are compact:  each value is implicitly
+    //  the vertex of the same index, so no topology is stored and all queries are
+    //  answered from the Level (face-values are face-vertices and tags are clear):
+    bool valuesAreVertices() const { return _valuesAreVertices; }
+
     Sdc::Options getOptions() const { return _options; }
 
     //  Queries per face:
@@ -190,18 +204,27 @@ public:
     IndexArray       getFaceValues(Index fIndex);
 
     //  Queries per edge:
-    ETag getEdgeTag(Index eIndex) const          { return _edgeTags[eIndex]; }
+    ETag getEdgeTag(Index eIndex) const          { return _valuesAreVertices ? _matchingETag : _edgeTags[eIndex]; }
     bool edgeTopologyMatches(Index eIndex) const { return !getEdgeTag(eIndex)._mismatch; }
 
     //  Queries per vertex (and its potential sibling values):
-    int   getNumVertexValues(Index v) const                  { return _vertSiblingCounts[v]; }
-    Index getVertexValueOffset(Index v, Sibling i = 0) const { return _vertSiblingOffsets[v] + i; }
+    int   getNumVertexValues(Index v) const { return _valuesAreVertices ? 1 : _vertSiblingCounts[v]; }
+    Index getVertexValueOffset(Index v, Sibling i = 0) const {
+        return (_valuesAreVertices ? v : _vertSiblingOffsets[v]) + i;
+    }
 
-    Index getVertexValue(Index v, Sibling i = 0) const { return _vertValueIndices[getVertexValueOffset(v,i)]; }
+    //  Vertex-values are only indirect at level 0 -- values of refined levels are
+    //  ordered as the vertex-values and the indices are not stored:
+    Index getVertexValue(Index v, Sibling i = 0) const {
+        return _vertValueIndices.empty() ? getVertexValueOffset(v,i)
+                                         : _vertValueIndices[getVertexValueOffset(v,i)];
+    }
 
     Index findVertexValueIndex(Index vertexIndex, Index valueIndex) const;
 
-    //  Methods to access/modify array properties per vertex:
+    //  Methods to access/modify array properties per vertex (the array of values is
+    //  only stored at level 0 and the siblings and crease-ends only when values are
+    //  not implicitly vertices):
     ConstIndexArray  getVertexValues(Index vIndex) const;
     IndexArray       getVertexValues(Index vIndex);
 
@@ -215,7 +238,9 @@ public:
     SiblingArray       getVertexFaceSiblings(Index vIndex);
 
     //  Queries per value:
-    ValueTag getValueTag(Index valueIndex) const          { return _vertValueTags[valueIndex]; }
+    ValueTag getValueTag(Index valueIndex) const {
+        return _valuesAreVertices ? _matchingValueTag : _vertValueTags[valueIndex];
+    }
     bool     valueTopologyMatches(Index valueIndex) const { return !getValueTag(valueIndex)._mismatch; }
 
     CreaseEndPair getValueCreaseEndPair(Index valueIndex) const { return _vertValueCreaseEnds[valueIndex]; }
@@ -237,13 +262,19 @@ public:
     void resizeComponents();
 
     //  Topological analysis methods -- tagging and face-value population:
-    void completeTopologyFromFaceValues(int regBoundaryValence);
+    void completeTopologyFromFaceValues(int regBoundaryValence, int numThreads = 1);
     void initializeFaceValuesFromFaceVertices();
     void initializeFaceValuesFromVertexFaceSiblings();
 
     struct ValueSpan;
     void gatherValueSpans(Index vIndex, ValueSpan * vValueSpans) const;
 
+    //  Number of bytes allocated by the channel:
+    size_t getMemoryUsage() const;
+
+    //  Release all values and tags while retaining the number of values:
+    void releaseTopology();
+
     //  Debugging methods:
     bool validate() const;
     void print() const;
@@ -261,8 +292,14 @@ private:
     bool _isLinear;
     bool _hasLinearBoundaries;
     bool _hasDependentSharpness;
+    bool _matchesVertexTopology;
+    bool _valuesAreVertices;
     int  _valueCount;
 
+    //  Tags returned for all components when values are implicitly vertices:
+    ETag     _matchingETag;
+    ValueTag _matchingValueTag;
+
     //
     //  Vectors recording face-varying topology including tags that help propagate
     //  data through the refinement hierarchy.  Vectors are not sparse but most use
@@ -274,21 +311,25 @@ private:
     //  it takes a considerable amount of the refinement time (1/3).  We can reduce
     //  both if we are willing to compute these on demand for clients.
     //
+    //  None of these vectors are allocated for the refined levels of a channel that
+    //  matches the vertex topology (see valuesAreVertices()), and the vertex-value
+    //  indices are only allocated at level 0 where values are indirect.
+    //
     //  Per-face (matches face-verts of corresponding level):
-    std::vector<Index> _faceVertValues;
+    ArenaVector<Index> _faceVertValues;
 
     //  Per-edge:
-    std::vector<ETag> _edgeTags;
+    ArenaVector<ETag> _edgeTags;
 
     //  Per-vertex:
-    std::vector<Sibling>  _vertSiblingCounts;
-    std::vector<int>      _vertSiblingOffsets;
-    std::vector<Sibling>  _vertFaceSiblings;
+    ArenaVector<Sibling>  _vertSiblingCounts;
+    ArenaVector<int>      _vertSiblingOffsets;
+    ArenaVector<Sibling>  _vertFaceSiblings;
 
     //  Per-value:
-    std::vector<Index>         _vertValueIndices;
-    std::vector<ValueTag>      _vertValueTags;
-    std::vector<CreaseEndPair> _vertValueCreaseEnds;
+    ArenaVector<Index>         _vertValueIndices;
+    ArenaVector<ValueTag>      _vertValueTags;
+    ArenaVector<CreaseEndPair> _vertValueCreaseEnds;
 };
 
 //
@@ -297,6 +338,8 @@ private:
 inline ConstIndexArray
 FVarLevel::getFaceValues(Index fIndex) const {
 
+    if (_valuesAreVertices) return _level.getFaceVertices(fIndex);
+
     int vCount  = _level.getNumFaceVertices(fIndex);
     int vOffset = _level.getOffsetOfFaceVertices(fIndex);
     return ConstIndexArray(&_faceVertValues[vOffset], vCount);
@@ -304,6 +347,8 @@ FVarLevel::getFaceValues(Index fIndex) const {
 inline IndexArray
 FVarLevel::getFaceValues(Index fIndex) {
 
+    assert(!_valuesAreVertices);
+
     int vCount  = _level.getNumFaceVertices(fIndex);
     int vOffset = _level.getOffsetOfFaceVertices(fIndex);
     return IndexArray(&_faceVertValues[vOffset], vCount);
@@ -312,6 +357,8 @@ FVarLevel::getFaceValues(Index fIndex) {
 inline FVarLevel::ConstSiblingArray
 FVarLevel::getVertexFaceSiblings(Index vIndex) const {
 
+    assert(!_valuesAreVertices);
+
     int vCount  = _level.getNumVertexFaces(vIndex);
     int vOffset = _level.getOffsetOfVertexFaces(vIndex);
     return ConstSiblingArray(&_vertFaceSiblings[vOffset], vCount);
@@ -327,6 +374,8 @@ FVarLevel::getVertexFaceSiblings(Index vIndex) {
 inline ConstIndexArray
 FVarLevel::getVertexValues(Index vIndex) const
 {
+    assert(_level.getDepth() == 0);
+
     int vCount  = getNumVertexValues(vIndex);
     int vOffset = getVertexValueOffset(vIndex);
     return ConstIndexArray(&_vertValueIndices[vOffset], vCount);
@@ -334,6 +383,8 @@ FVarLevel::getVertexValues(Index vIndex) const
 inline IndexArray
 FVarLevel::getVertexValues(Index vIndex)
 {
+    assert(_level.getDepth() == 0);
+
     int vCount  = getNumVertexValues(vIndex);
     int vOffset = getVertexValueOffset(vIndex);
     return IndexArray(&_vertValueIndices[vOffset], vCount);
@@ -342,6 +393,8 @@ FVarLevel::getVertexValues(Index vIndex)
 inline FVarLevel::ConstValueTagArray
 FVarLevel::getVertexValueTags(Index vIndex) const
 {
+    if (_valuesAreVertices) return ConstValueTagArray(&_matchingValueTag, 1);
+
     int vCount  = getNumVertexValues(vIndex);
     int vOffset = getVertexValueOffset(vIndex);
     return ConstValueTagArray(&_vertValueTags[vOffset], vCount);
@@ -357,6 +410,8 @@ FVarLevel::getVertexValueTags(Index vIndex)
 inline FVarLevel::ConstCreaseEndPairArray
 FVarLevel::getVertexValueCreaseEnds(Index vIndex) const
 {
+    assert(!_valuesAreVertices);
+
     int vCount  = getNumVertexValues(vIndex);
     int vOffset = getVertexValueOffset(vIndex);
     return ConstCreaseEndPairArray(&_vertValueCreaseEnds[vOffset], vCount);
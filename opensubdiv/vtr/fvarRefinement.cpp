@@ -29,6 +29,7 @@
 #include "../vtr/fvarLevel.h"
 
 #include "../vtr/fvarRefinement.h"
+#include "../vtr/binaryStream.h"
 
 #include <cassert>
 #include <cstdio>
@@ -57,12 +58,28 @@ FVarRefinement::FVarRefinement(Refinement const& refinement,
     _parentLevel(refinement.parent()),
     _parentFVar(parentFVarLevel),
     _childLevel(refinement.child()),
-    _childFVar(childFVarLevel) {
+    _childFVar(childFVarLevel),
+    _childValueParentSource(refinement.child().getArena()) {
 }
 
 FVarRefinement::~FVarRefinement() {
 }
 
+//
+//  Serialization to/from a flat binary buffer (see Refinement::write/read):
+//
+void
+FVarRefinement::write(BinaryWriter & stream) const {
+
+    stream.writeVector(_childValueParentSource);
+}
+
+bool
+FVarRefinement::read(BinaryReader & stream) {
+
+    return stream.readVector(_childValueParentSource);
+}
+
 
 //
 // Methods supporting the refinement of face-varying data that has previously
@@ -82,6 +99,13 @@ FVarRefinement::applyRefinement() {
     _childFVar._hasLinearBoundaries   = _parentFVar._hasLinearBoundaries;
     _childFVar._hasDependentSharpness = _parentFVar._hasDependentSharpness;
 
+    _childFVar._matchesVertexTopology = _parentFVar._matchesVertexTopology;
+
+    if (_childFVar._matchesVertexTopology) {
+        applyMatchingRefinement();
+        return;
+    }
+
     //
     //  It's difficult to know immediately how many child values arise from the
     //  refinement -- particularly when sparse, so we get a close upper bound,
@@ -95,7 +119,9 @@ FVarRefinement::applyRefinement() {
     propagateValueTags();
     if (_childFVar.hasSmoothBoundaries()) {
         propagateValueCreases();
-        reclassifySemisharpValues();
+        if (_parentLevel.hasSemiSharpFeatures()) {
+            reclassifySemisharpValues();
+        }
     }
 
     //
@@ -116,6 +142,22 @@ FVarRefinement::applyRefinement() {
     //assert(_childFVar.validate());
 }
 
+//
+//  When the parent channel matches the vertex topology, so will the child and
+//  each child value corresponds to (and is ordered as) its child vertex:  none
+//  of the analysis and propagation of tags is necessary, and as all vertex
+//  values, edges and vertex-face siblings are as they would be initialized, the
+//  child stores none of them (nor the parent sources of its values) and its
+//  values are implicitly its vertices.
+//
+void
+FVarRefinement::applyMatchingRefinement() {
+
+    _childFVar.resizeValues(_childLevel.getNumVertices());
+
+    _childFVar._valuesAreVertices = true;
+}
+
 //
 //  Quickly estimate the memory required for face-varying vertex-values in the child
 //  and allocate them.  For uniform refinement this estimate should exactly match the
@@ -171,11 +213,7 @@ FVarRefinement::trimAndFinalizeChildValues() {
 
     _childValueParentSource.resize(_childFVar._valueCount);
 
-    //  Allocate and initialize the vector of indices (redundant after level 0):
-    _childFVar._vertValueIndices.resize(_childFVar._valueCount);
-    for (int i = 0; i < _childFVar._valueCount; ++i) {
-        _childFVar._vertValueIndices[i] = i;
-    }
+    //  The vector of indices is redundant after level 0 and is not allocated
 }
 
 inline int
@@ -685,6 +723,12 @@ FVarRefinement::getFractionalWeight(Index pVert, LocalIndex pSibling,
             interiorEdgeCount, pEdgeSharpness, cEdgeSharpness);
 }
 
+size_t
+FVarRefinement::getMemoryUsage() const {
+
+    return sizeof(*this) + _childValueParentSource.getMemoryUsage();
+}
+
 } // end namespace internal
 } // end namespace Vtr
 
@@ -62,15 +62,28 @@ public:
     ~FVarRefinement();
 
     int getChildValueParentSource(Index vIndex, int sibling) const {
-        return _childValueParentSource[_childFVar.getVertexValueOffset(vIndex, (LocalIndex)sibling)];
+        //  Parent sources are not stored when child values are vertices (all 0):
+        return _childFVar.valuesAreVertices() ? 0 :
+               _childValueParentSource[_childFVar.getVertexValueOffset(vIndex, (LocalIndex)sibling)];
     }
 
     float getFractionalWeight(Index pVert, LocalIndex pSibling,
                               Index cVert, LocalIndex cSibling) const;
 
 
+    //  Serialization to/from a flat binary buffer (see Refinement::write/read):
+    void write(BinaryWriter & stream) const;
+    bool read(BinaryReader & stream);
+
+    //  Number of bytes allocated by the refinement of the channel:
+    size_t getMemoryUsage() const;
+
+    //  Release the parent sources of child values:
+    void releaseMappings() { _childValueParentSource.release(); }
+
     //  Modifiers supporting application of the refinement:
     void applyRefinement();
+    void applyMatchingRefinement();
 
     void estimateAndAllocateChildValues();
     void populateChildValues();
@@ -104,7 +117,7 @@ private:
     //  be a parent value, in which case the source of the parent component will
     //  be stored.  So we refer to the parent "source" rather than "sibling":
     //
-    std::vector<LocalIndex> _childValueParentSource;
+    ArenaVector<LocalIndex> _childValueParentSource;
 };
 
 } // end namespace internal
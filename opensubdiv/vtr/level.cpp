@@ -28,6 +28,7 @@
 #include "../vtr/refinement.h"
 #include "../vtr/fvarLevel.h"
 #include "../vtr/stackBuffer.h"
+#include "../vtr/binaryStream.h"
 
 #include <cassert>
 #include <cstdio>
@@ -58,13 +59,33 @@ namespace internal {
 //
 //  Simple (for now) constructor and destructor:
 //
-Level::Level() :
+Level::Level(Arena * arena) :
     _faceCount(0),
     _edgeCount(0),
     _vertCount(0),
     _depth(0),
     _maxEdgeFaces(0),
-    _maxValence(0) {
+    _maxValence(0),
+    _regFaceSize(0),
+    _hasSemiSharpFeatures(false),
+    _faceVertCountsAndOffsets(arena),
+    _faceVertIndices(arena),
+    _faceEdgeIndices(arena),
+    _faceTags(arena),
+    _edgeVertIndices(arena),
+    _edgeFaceCountsAndOffsets(arena),
+    _edgeFaceIndices(arena),
+    _edgeFaceLocalIndices(arena),
+    _edgeSharpness(arena),
+    _edgeTags(arena),
+    _vertFaceCountsAndOffsets(arena),
+    _vertFaceIndices(arena),
+    _vertFaceLocalIndices(arena),
+    _vertEdgeCountsAndOffsets(arena),
+    _vertEdgeIndices(arena),
+    _vertEdgeLocalIndices(arena),
+    _vertSharpness(arena),
+    _vertTags(arena) {
 }
 
 Level::~Level() {
@@ -148,16 +169,211 @@ Level::getTopologyErrorString(TopologyError errCode) {
 //          - bool validate(ValidateOptions const& options) const;
 //
 
-#define REPORT(code, format, ...) \
-    if (callback) { \
-        char const * errStr = getTopologyErrorString(code); \
-        char msg[1024]; \
-        snprintf(msg, 1024, "%s - " format, errStr, ##__VA_ARGS__); \
-        callback(code, msg, clientData); \
+//
+//  Validation is applied to each set of components in parallel over successive
+//  blocks of the set, so that it can exit early once the error limit is reached
+//  while still recording the same (first) errors regardless of the number of
+//  threads.  Each of the tests below inspects a single component and returns
+//  false with the information of its first error if found invalid:
+//
+namespace {
+    typedef Level::TopologyError     TopologyError;
+    typedef Level::TopologyErrorInfo TopologyErrorInfo;
+
+    inline bool
+    recordError(TopologyErrorInfo & error, TopologyError code, int dim, Index comp, int member) {
+        error.errCode      = code;
+        error.componentDim = dim;
+        error.component    = comp;
+        error.member       = member;
+        return false;
     }
 
+    //  Each face-vert has corresponding vert-face (and child):
+    struct FaceVertCorrelationTest {
+        FaceVertCorrelationTest(Level const & level) : _level(level) { }
+
+        bool operator()(Index fIndex, TopologyErrorInfo & error) const {
+            ConstIndexArray fVerts = _level.getFaceVertices(fIndex);
+
+            for (int i = 0; i < fVerts.size(); ++i) {
+                ConstIndexArray      vFaces  = _level.getVertexFaces(fVerts[i]);
+                ConstLocalIndexArray vInFace = _level.getVertexFaceLocalIndices(fVerts[i]);
+
+                bool vertFaceOfFaceExists = false;
+                for (int j = 0; j < vFaces.size(); ++j) {
+                    if ((vFaces[j] == fIndex) && (vInFace[j] == i)) {
+                        vertFaceOfFaceExists = true;
+                        break;
+                    }
+                }
+                if (!vertFaceOfFaceExists) {
+                    return recordError(error,
+                        Level::TOPOLOGY_FAILED_CORRELATION_FACE_VERT, 2, fIndex, i);
+                }
+            }
+            return true;
+        }
+        Level const & _level;
+    };
+
+    //  Each face-edge has corresponding edge-face:
+    struct FaceEdgeCorrelationTest {
+        FaceEdgeCorrelationTest(Level const & level) : _level(level) { }
+
+        bool operator()(Index fIndex, TopologyErrorInfo & error) const {
+            ConstIndexArray fEdges = _level.getFaceEdges(fIndex);
+
+            for (int i = 0; i < fEdges.size(); ++i) {
+                ConstIndexArray      eFaces  = _level.getEdgeFaces(fEdges[i]);
+                ConstLocalIndexArray eInFace = _level.getEdgeFaceLocalIndices(fEdges[i]);
+
+                bool edgeFaceOfFaceExists = false;
+                for (int j = 0; j < eFaces.size(); ++j) {
+                    if ((eFaces[j] == fIndex) && (eInFace[j] == i)) {
+                        edgeFaceOfFaceExists = true;
+                        break;
+                    }
+                }
+                if (!edgeFaceOfFaceExists) {
+                    return recordError(error,
+                        Level::TOPOLOGY_FAILED_CORRELATION_FACE_EDGE, 2, fIndex, i);
+                }
+            }
+            return true;
+        }
+        Level const & _level;
+    };
+
+    //  Each edge-vert has corresponding vert-edge (and child):
+    struct EdgeVertCorrelationTest {
+        EdgeVertCorrelationTest(Level const & level) : _level(level) { }
+
+        bool operator()(Index eIndex, TopologyErrorInfo & error) const {
+            ConstIndexArray eVerts = _level.getEdgeVertices(eIndex);
+
+            for (int i = 0; i < 2; ++i) {
+                ConstIndexArray      vEdges  = _level.getVertexEdges(eVerts[i]);
+                ConstLocalIndexArray vInEdge = _level.getVertexEdgeLocalIndices(eVerts[i]);
+
+                bool vertEdgeOfEdgeExists = false;
+                for (int j = 0; j < vEdges.size(); ++j) {
+                    if ((vEdges[j] == eIndex) && (vInEdge[j] == i)) {
+                        vertEdgeOfEdgeExists = true;
+                        break;
+                    }
+                }
+                if (!vertEdgeOfEdgeExists) {
+                    return recordError(error,
+                        Level::TOPOLOGY_FAILED_CORRELATION_FACE_VERT, 1, eIndex, i);
+                }
+            }
+            return true;
+        }
+        Level const & _level;
+    };
+
+    //  Vert-faces and vert-edges are properly ordered and in sync -- currently this
+    //  requires the relations exactly match those that we construct from the ordering
+    //  method, i.e. we do not allow rotations for interior vertices:
+    struct VertOrientationTest {
+        VertOrientationTest(Level const & level) : _level(level) { }
+
+        bool operator()(Index vIndex, TopologyErrorInfo & error) const {
+            Level::VTag const & vTag = _level.getVertexTag(vIndex);
+            if (vTag._incomplete || vTag._nonManifold) return true;
+
+            ConstIndexArray vFaces = _level.getVertexFaces(vIndex);
+            ConstIndexArray vEdges = _level.getVertexEdges(vIndex);
+
+            internal::StackBuffer<Index,32> indexBuffer(vFaces.size() + vEdges.size());
+
+            Index * vFacesOrdered = indexBuffer;
+            Index * vEdgesOrdered = indexBuffer + vFaces.size();
+
+            if (!_level.orderVertexFacesAndEdges(vIndex, vFacesOrdered, vEdgesOrdered)) {
+                return recordError(error,
+                    Level::TOPOLOGY_FAILED_ORIENTATION_INCIDENT_FACES_EDGES, 0, vIndex, 0);
+            }
+            for (int i = 0; i < vFaces.size(); ++i) {
+                if (vFaces[i] != vFacesOrdered[i]) {
+                    return recordError(error,
+                        Level::TOPOLOGY_FAILED_ORIENTATION_INCIDENT_FACE, 0, vIndex, i);
+                }
+            }
+            for (int i = 0; i < vEdges.size(); ++i) {
+                if (vEdges[i] != vEdgesOrdered[i]) {
+                    return recordError(error,
+                        Level::TOPOLOGY_FAILED_ORIENTATION_INCIDENT_EDGE, 0, vIndex, i);
+                }
+            }
+            return true;
+        }
+        Level const & _level;
+    };
+
+    //  Non-manifold tags are appropriately assigned to edges -- note we have to
+    //  validate orientation of vertex neighbors to do this rigorously:
+    struct EdgeNonManifoldTest {
+        EdgeNonManifoldTest(Level const & level) : _level(level) { }
+
+        bool operator()(Index eIndex, TopologyErrorInfo & error) const {
+            if (_level.getEdgeTag(eIndex)._nonManifold) return true;
+
+            ConstIndexArray eVerts = _level.getEdgeVertices(eIndex);
+            if (eVerts[0] == eVerts[1]) {
+                return recordError(error, Level::TOPOLOGY_DEGENERATE_EDGE, 1, eIndex, 0);
+            }
+
+            ConstIndexArray eFaces = _level.getEdgeFaces(eIndex);
+            if ((eFaces.size() < 1) || (eFaces.size() > 2)) {
+                return recordError(error,
+                    Level::TOPOLOGY_NON_MANIFOLD_EDGE, 1, eIndex, eFaces.size());
+            }
+            return true;
+        }
+        Level const & _level;
+    };
+
+    inline bool
+    errorLimitReached(Level::TopologyErrorList const & errors, int maxErrors) {
+        return (maxErrors > 0) && ((int)errors.size() >= maxErrors);
+    }
+
+    template <class TEST>
+    void
+    validateComponents(int numComponents, TEST const & test,
+                       Level::TopologyErrorList & errors, int maxErrors, int numThreads) {
+
+        int const blockSize = 16 * 1024;
+
+        std::vector<TopologyErrorInfo> blockErrors(std::min(blockSize, numComponents));
+        std::vector<unsigned char>     blockIsValid(blockErrors.size());
+
+        for (int begin = 0; begin < numComponents; begin += blockSize) {
+            int end = std::min(begin + blockSize, numComponents);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+            #pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+#endif
+            for (int i = begin; i < end; ++i) {
+                blockIsValid[i - begin] = test(i, blockErrors[i - begin]);
+            }
+
+            for (int i = begin; i < end; ++i) {
+                if (!blockIsValid[i - begin]) {
+                    errors.push_back(blockErrors[i - begin]);
+
+                    if ((maxErrors > 0) && ((int)errors.size() >= maxErrors)) return;
+                }
+            }
+        }
+        (void) numThreads;
+    }
+}
+
 bool
-Level::validateTopology(ValidationCallback callback, void const * clientData) const {
+Level::validateTopology(TopologyErrorList & errors, int maxErrors, int numThreads) const {
 
     //
     //  Verify internal topological consistency (eventually a Level method?):
@@ -176,176 +392,141 @@ Level::validateTopology(ValidationCallback callback, void const * clientData) co
     //      - each vert-face <face,child> pair is unique
     //      - each vert-edge <edge,child> pair is unique
     //
-    bool returnOnFirstError = true;
-    bool isValid = true;
+    //  Missing relations make further tests impossible, so validation stops when
+    //  any are detected:
+    //
+    errors.clear();
+
+    TopologyErrorInfo missing;
+    missing.componentDim = -1;
+    missing.component    = INDEX_INVALID;
+    missing.member       = 0;
 
     //  Verify each face-vert has corresponding vert-face and child:
     if ((getNumFaceVerticesTotal() == 0) || (getNumVertexFacesTotal() == 0)) {
         if (getNumFaceVerticesTotal() == 0) {
-            REPORT(TOPOLOGY_MISSING_FACE_VERTS, "missing face-verts");
+            missing.errCode = TOPOLOGY_MISSING_FACE_VERTS;
+            errors.push_back(missing);
         }
         if (getNumVertexFacesTotal() == 0) {
-            REPORT(TOPOLOGY_MISSING_VERT_FACES, "missing vert-faces");
+            missing.errCode = TOPOLOGY_MISSING_VERT_FACES;
+            errors.push_back(missing);
         }
         return false;
     }
-    for (int fIndex = 0; fIndex < getNumFaces(); ++fIndex) {
-        ConstIndexArray     fVerts      = getFaceVertices(fIndex);
-        int                 fVertCount  = fVerts.size();
-
-        for (int i = 0; i < fVertCount; ++i) {
-            Index vIndex = fVerts[i];
-
-            ConstIndexArray        vFaces = getVertexFaces(vIndex);
-            ConstLocalIndexArray  vInFace = getVertexFaceLocalIndices(vIndex);
-
-            bool vertFaceOfFaceExists = false;
-            for (int j = 0; j < vFaces.size(); ++j) {
-                if ((vFaces[j] == fIndex) && (vInFace[j] == i)) {
-                    vertFaceOfFaceExists = true;
-                    break;
-                }
-            }
-            if (!vertFaceOfFaceExists) {
-                REPORT(TOPOLOGY_FAILED_CORRELATION_FACE_VERT,
-                    "face %d correlation of vert %d failed", fIndex, i);
-                if (returnOnFirstError) return false;
-                isValid = false;
-            }
-        }
-    }
+    validateComponents(getNumFaces(), FaceVertCorrelationTest(*this), errors, maxErrors, numThreads);
+    if (errorLimitReached(errors, maxErrors)) return false;
 
     //  Verify each face-edge has corresponding edge-face:
     if ((getNumEdgeFacesTotal() == 0) || (getNumFaceEdgesTotal() == 0)) {
         if (getNumEdgeFacesTotal() == 0) {
-            REPORT(TOPOLOGY_MISSING_EDGE_FACES, "missing edge-faces");
+            missing.errCode = TOPOLOGY_MISSING_EDGE_FACES;
+            errors.push_back(missing);
         }
         if (getNumFaceEdgesTotal() == 0) {
-            REPORT(TOPOLOGY_MISSING_FACE_EDGES, "missing face-edges");
+            missing.errCode = TOPOLOGY_MISSING_FACE_EDGES;
+            errors.push_back(missing);
         }
         return false;
     }
-    for (int fIndex = 0; fIndex < getNumFaces(); ++fIndex) {
-        ConstIndexArray  fEdges      = getFaceEdges(fIndex);
-        int              fEdgeCount  = fEdges.size();
-
-        for (int i = 0; i < fEdgeCount; ++i) {
-            int eIndex = fEdges[i];
-
-            ConstIndexArray       eFaces = getEdgeFaces(eIndex);
-            ConstLocalIndexArray eInFace = getEdgeFaceLocalIndices(eIndex);
-
-            bool edgeFaceOfFaceExists = false;
-            for (int j = 0; j < eFaces.size(); ++j) {
-                if ((eFaces[j] == fIndex) && (eInFace[j] == i)) {
-                    edgeFaceOfFaceExists = true;
-                    break;
-                }
-            }
-            if (!edgeFaceOfFaceExists) {
-                REPORT(TOPOLOGY_FAILED_CORRELATION_FACE_EDGE,
-                     "face %d correlation of edge %d failed", fIndex, i);
-                if (returnOnFirstError) return false;
-                isValid = false;
-            }
-        }
-    }
+    validateComponents(getNumFaces(), FaceEdgeCorrelationTest(*this), errors, maxErrors, numThreads);
+    if (errorLimitReached(errors, maxErrors)) return false;
 
     //  Verify each edge-vert has corresponding vert-edge and child:
     if ((getNumEdgeVerticesTotal() == 0) || (getNumVertexEdgesTotal() == 0)) {
         if (getNumEdgeVerticesTotal() == 0) {
-            REPORT(TOPOLOGY_MISSING_EDGE_VERTS, "missing edge-verts");
+            missing.errCode = TOPOLOGY_MISSING_EDGE_VERTS;
+            errors.push_back(missing);
         }
         if (getNumVertexEdgesTotal() == 0) {
-            REPORT(TOPOLOGY_MISSING_VERT_EDGES, "missing vert-edges");
+            missing.errCode = TOPOLOGY_MISSING_VERT_EDGES;
+            errors.push_back(missing);
         }
         return false;
     }
-    for (int eIndex = 0; eIndex < getNumEdges(); ++eIndex) {
-        ConstIndexArray  eVerts = getEdgeVertices(eIndex);
-
-        for (int i = 0; i < 2; ++i) {
-            Index vIndex = eVerts[i];
+    validateComponents(getNumEdges(), EdgeVertCorrelationTest(*this), errors, maxErrors, numThreads);
+    if (errorLimitReached(errors, maxErrors)) return false;
 
-            ConstIndexArray       vEdges = getVertexEdges(vIndex);
-            ConstLocalIndexArray  vInEdge = getVertexEdgeLocalIndices(vIndex);
+    //  Verify that vert-faces and vert-edges are properly ordered and in sync:
+    validateComponents(getNumVertices(), VertOrientationTest(*this), errors, maxErrors, numThreads);
+    if (errorLimitReached(errors, maxErrors)) return false;
 
-            bool vertEdgeOfEdgeExists = false;
-            for (int j = 0; j < vEdges.size(); ++j) {
-                if ((vEdges[j] == eIndex) && (vInEdge[j] == i)) {
-                    vertEdgeOfEdgeExists = true;
-                    break;
-                }
-            }
-            if (!vertEdgeOfEdgeExists) {
-                REPORT(TOPOLOGY_FAILED_CORRELATION_FACE_VERT,
-                    "edge %d correlation of vert %d failed", eIndex, i);
-                if (returnOnFirstError) return false;
-                isValid = false;
-            }
-        }
-    }
+    //  Verify non-manifold tags are appropriately assigned to edges and vertices:
+    validateComponents(getNumEdges(), EdgeNonManifoldTest(*this), errors, maxErrors, numThreads);
+    if (errorLimitReached(errors, maxErrors)) return false;
 
-    //  Verify that vert-faces and vert-edges are properly ordered and in sync:
-    //      - currently this requires the relations exactly match those that we construct from
-    //        the ordering method, i.e. we do not allow rotations for interior vertices.
-    internal::StackBuffer<Index,32> indexBuffer(2 * _maxValence);
+    return errors.empty();
+}
 
-    for (int vIndex = 0; vIndex < getNumVertices(); ++vIndex) {
-        if (_vertTags[vIndex]._incomplete || _vertTags[vIndex]._nonManifold) continue;
+void
+Level::formatTopologyError(TopologyErrorInfo const & error, char * msg, int msgSize) {
+
+    char const * errStr = getTopologyErrorString(error.errCode);
+
+    switch (error.errCode) {
+        case TOPOLOGY_MISSING_EDGE_FACES:
+            snprintf(msg, msgSize, "%s - missing edge-faces", errStr); break;
+        case TOPOLOGY_MISSING_EDGE_VERTS:
+            snprintf(msg, msgSize, "%s - missing edge-verts", errStr); break;
+        case TOPOLOGY_MISSING_FACE_EDGES:
+            snprintf(msg, msgSize, "%s - missing face-edges", errStr); break;
+        case TOPOLOGY_MISSING_FACE_VERTS:
+            snprintf(msg, msgSize, "%s - missing face-verts", errStr); break;
+        case TOPOLOGY_MISSING_VERT_FACES:
+            snprintf(msg, msgSize, "%s - missing vert-faces", errStr); break;
+        case TOPOLOGY_MISSING_VERT_EDGES:
+            snprintf(msg, msgSize, "%s - missing vert-edges", errStr); break;
+
+        case TOPOLOGY_FAILED_CORRELATION_FACE_VERT:
+            snprintf(msg, msgSize, "%s - %s %d correlation of vert %d failed", errStr,
+                (error.componentDim == 1) ? "edge" : "face", error.component, error.member);
+            break;
+        case TOPOLOGY_FAILED_CORRELATION_FACE_EDGE:
+            snprintf(msg, msgSize, "%s - face %d correlation of edge %d failed", errStr,
+                error.component, error.member);
+            break;
 
-        ConstIndexArray  vFaces = getVertexFaces(vIndex);
-        ConstIndexArray  vEdges = getVertexEdges(vIndex);
+        case TOPOLOGY_FAILED_ORIENTATION_INCIDENT_FACES_EDGES:
+            snprintf(msg, msgSize, "%s - vertex %d cannot orient incident faces and edges",
+                errStr, error.component);
+            break;
+        case TOPOLOGY_FAILED_ORIENTATION_INCIDENT_FACE:
+            snprintf(msg, msgSize, "%s - vertex %d orientation failure at incident face %d",
+                errStr, error.component, error.member);
+            break;
+        case TOPOLOGY_FAILED_ORIENTATION_INCIDENT_EDGE:
+            snprintf(msg, msgSize, "%s - vertex %d orientation failure at incident edge %d",
+                errStr, error.component, error.member);
+            break;
 
-        Index * vFacesOrdered = indexBuffer;
-        Index * vEdgesOrdered = indexBuffer + vFaces.size();
+        case TOPOLOGY_DEGENERATE_EDGE:
+            snprintf(msg, msgSize, "%s - Error in eIndex = %d:  degenerate edge not tagged "
+                "marked non-manifold", errStr, error.component);
+            break;
+        case TOPOLOGY_NON_MANIFOLD_EDGE:
+            snprintf(msg, msgSize, "%s - edge %d with %d incident faces not tagged non-manifold",
+                errStr, error.component, error.member);
+            break;
 
-        if (!orderVertexFacesAndEdges(vIndex, vFacesOrdered, vEdgesOrdered)) {
-            REPORT(TOPOLOGY_FAILED_ORIENTATION_INCIDENT_FACES_EDGES,
-                "vertex %d cannot orient incident faces and edges", vIndex);
-            if (returnOnFirstError) return false;
-            isValid = false;
-        }
-        for (int i = 0; i < vFaces.size(); ++i) {
-            if (vFaces[i] != vFacesOrdered[i]) {
-                REPORT(TOPOLOGY_FAILED_ORIENTATION_INCIDENT_FACE,
-                    "vertex %d orientation failure at incident face %d", vIndex, i);
-                if (returnOnFirstError) return false;
-                isValid = false;
-                break;
-            }
-        }
-        for (int i = 0; i < vEdges.size(); ++i) {
-            if (vEdges[i] != vEdgesOrdered[i]) {
-                REPORT(TOPOLOGY_FAILED_ORIENTATION_INCIDENT_EDGE,
-                    "vertex %d orientation failure at incident edge %d", vIndex, i);
-                if (returnOnFirstError) return false;
-                isValid = false;
-                break;
-            }
-        }
+        default:
+            snprintf(msg, msgSize, "%s - component %d", errStr, error.component);
+            break;
     }
+}
 
-    //  Verify non-manifold tags are appropriately assigned to edges and vertices:
-    //      - note we have to validate orientation of vertex neighbors to do this rigorously
-    for (int eIndex = 0; eIndex < getNumEdges(); ++eIndex) {
-        Level::ETag const& eTag = _edgeTags[eIndex];
-        if (eTag._nonManifold) continue;
+bool
+Level::validateTopology(ValidationCallback callback, void const * clientData,
+                        int numThreads) const {
 
-        ConstIndexArray  eVerts = getEdgeVertices(eIndex);
-        if (eVerts[0] == eVerts[1]) {
-            REPORT(TOPOLOGY_DEGENERATE_EDGE,
-                "Error in eIndex = %d:  degenerate edge not tagged marked non-manifold", eIndex);
-            if (returnOnFirstError) return false;
-            isValid = false;
-        }
+    TopologyErrorList errors;
 
-        ConstIndexArray  eFaces = getEdgeFaces(eIndex);
-        if ((eFaces.size() < 1) || (eFaces.size() > 2)) {
-            REPORT(TOPOLOGY_NON_MANIFOLD_EDGE,
-                "edge %d with %d incident faces not tagged non-manifold", eIndex, eFaces.size());
-            if (returnOnFirstError) return false;
-            isValid = false;
+    bool isValid = validateTopology(errors, 1, numThreads);
+
+    if (callback) {
+        for (int i = 0; i < (int)errors.size(); ++i) {
+            char msg[1024];
+            formatTopologyError(errors[i], msg, 1024);
+            callback(errors[i].errCode, msg, clientData);
         }
     }
     return isValid;
@@ -422,7 +603,11 @@ Level::print(const Refinement* pRefinement) const {
     printf("  Topology relation sizes:\n");
 
     printf("    Face relations:\n");
-    printf("      face-vert counts/offset = %lu\n", (unsigned long)_faceVertCountsAndOffsets.size());
+    if (_regFaceSize) {
+        printf("      face-vert counts/offset = implicit (%d per face)\n", _regFaceSize);
+    } else {
+        printf("      face-vert counts/offset = %lu\n", (unsigned long)_faceVertCountsAndOffsets.size());
+    }
     printf("      face-vert indices = %lu\n", (unsigned long)_faceVertIndices.size());
     if (_faceVertIndices.size()) {
         for (int i = 0; printFaceVerts && i < getNumFaces(); ++i) {
@@ -564,7 +749,15 @@ Level::doesEdgeFVarTopologyMatch(Index eIndex, int fvarChannel) const {
 bool
 Level::doesFaceFVarTopologyMatch(Index fIndex, int fvarChannel) const {
 
-    return ! getFVarLevel(fvarChannel).getFaceCompositeValueTag(fIndex).isMismatch();
+    FVarLevel const & fvarLevel = getFVarLevel(fvarChannel);
+
+    return fvarLevel.matchesVertexTopology() ||
+           ! fvarLevel.getFaceCompositeValueTag(fIndex).isMismatch();
+}
+bool
+Level::doesFVarChannelTopologyMatch(int fvarChannel) const {
+
+    return getFVarLevel(fvarChannel).matchesVertexTopology();
 }
 
 void
@@ -1428,6 +1621,70 @@ Level::isSingleCreasePatch(Index face, float *sharpnessOut, int *sharpEdgeInFace
     return true;
 }
 
+bool
+Level::isDoubleCreasePatch(Index face, float *sharpnessOut, int *sharpEdgeInFaceOut) const {
+
+    //  A regular interior face between two parallel creases, i.e. with two
+    //  opposite sharp edges, has all four face-vertices as Crease vertices.
+    //  Reject any other features quickly using the composite tag as above:
+    //
+    ConstIndexArray fVerts = getFaceVertices(face);
+    if (fVerts.size() != 4) {
+        return false;
+    }
+
+    VTag allCornersTag = getFaceCompositeVTag(fVerts);
+    if ((allCornersTag._rule != Sdc::Crease::RULE_CREASE) ||
+          allCornersTag._boundary ||
+          allCornersTag._xordinary ||
+          allCornersTag._nonManifold) {
+        return false;
+    }
+
+    //  Identify the pair of opposite sharp edges -- the other pair must be
+    //  smooth for each crease to run along the face:
+    //
+    ConstIndexArray fEdges = getFaceEdges(face);
+
+    //  Only semi-sharp creases are considered -- inf-sharp edges are dealt with
+    //  as boundaries or isolated as before:
+    //
+    int sharpEdgeInFace = -1;
+    if (Sdc::Crease::IsSmooth(getEdgeSharpness(fEdges[1])) &&
+        Sdc::Crease::IsSmooth(getEdgeSharpness(fEdges[3]))) {
+        sharpEdgeInFace = 0;
+    } else if (Sdc::Crease::IsSmooth(getEdgeSharpness(fEdges[0])) &&
+               Sdc::Crease::IsSmooth(getEdgeSharpness(fEdges[2]))) {
+        sharpEdgeInFace = 1;
+    } else {
+        return false;
+    }
+    if (!Sdc::Crease::IsSemiSharp(getEdgeSharpness(fEdges[sharpEdgeInFace])) ||
+        !Sdc::Crease::IsSemiSharp(getEdgeSharpness(fEdges[sharpEdgeInFace + 2]))) {
+        return false;
+    }
+
+    //  Reject if the crease at any of the four vertices is not regular, i.e.
+    //  any pair of opposing edges does not have the same sharpness value:
+    //
+    for (int i = 0; i < 4; ++i) {
+        ConstIndexArray vEdges = getVertexEdges(fVerts[i]);
+
+        if (!isSharpnessEqual(getEdgeSharpness(vEdges[0]), getEdgeSharpness(vEdges[2])) ||
+            !isSharpnessEqual(getEdgeSharpness(vEdges[1]), getEdgeSharpness(vEdges[3]))) {
+            return false;
+        }
+    }
+    if (sharpnessOut) {
+        sharpnessOut[0] = getEdgeSharpness(fEdges[sharpEdgeInFace]);
+        sharpnessOut[1] = getEdgeSharpness(fEdges[sharpEdgeInFace + 2]);
+    }
+    if (sharpEdgeInFaceOut) {
+        *sharpEdgeInFaceOut = sharpEdgeInFace;
+    }
+    return true;
+}
+
 //
 //  What follows is an internal/anonymous class and protected methods to complete all
 //  topological relations when only the face-vertex relations are defined.
@@ -1462,7 +1719,7 @@ namespace {
 
     class DynamicRelation {
     public:
-        DynamicRelation(IndexVector& countAndOffsets, IndexVector& indices, int membersPerComp);
+        DynamicRelation(ArenaVector<Index>& countAndOffsets, ArenaVector<Index>& indices, int membersPerComp);
         ~DynamicRelation() { }
 
     public:
@@ -1478,14 +1735,14 @@ namespace {
         int _compCount;
         int _memberCountPerComp;
 
-        IndexVector & _countsAndOffsets;
-        IndexVector & _regIndices;
+        ArenaVector<Index> & _countsAndOffsets;
+        ArenaVector<Index> & _regIndices;
 
         IrregIndexMap _irregIndices;
     };
 
     inline
-    DynamicRelation::DynamicRelation(IndexVector& countAndOffsets, IndexVector& indices, int membersPerComp) :
+    DynamicRelation::DynamicRelation(ArenaVector<Index>& countAndOffsets, ArenaVector<Index>& indices, int membersPerComp) :
             _compCount(0),
             _memberCountPerComp(membersPerComp),
             _countsAndOffsets(countAndOffsets),
@@ -1575,11 +1832,11 @@ namespace {
             cannotBeCompressedInPlace |= (memberCount > (_memberCountPerComp * _compCount));
 
             //  Copy members into the original or temporary vector accordingly:
-            IndexVector  tmpIndices;
+            ArenaVector<Index>  tmpIndices(_regIndices.getArena());
             if (cannotBeCompressedInPlace) {
                 tmpIndices.resize(memberCount);
             }
-            IndexVector& dstIndices = cannotBeCompressedInPlace ? tmpIndices : _regIndices;
+            ArenaVector<Index>& dstIndices = cannotBeCompressedInPlace ? tmpIndices : _regIndices;
 
             int memberMax = _memberCountPerComp;
             for (int i = 0; i < _compCount; ++i) {
@@ -1636,8 +1893,43 @@ Level::findEdge(Index v0Index, Index v1Index) const {
     return this->findEdge(v0Index, v1Index, this->getVertexEdges(v0Index));
 }
 
+int
+Level::gatherVertexVertices(std::vector<Index> & offsets,
+                            std::vector<Index> & indices) const {
+
+    //
+    //  Vertex-edges are not stored contiguously in refined levels, so the
+    //  compact offsets are accumulated first.  The opposite vertex of each
+    //  edge is then gathered, skipping degenerate edges:
+    //
+    int numVerts = getNumVertices();
+
+    offsets.resize(numVerts + 1);
+    offsets[0] = 0;
+    for (Index v = 0; v < numVerts; ++v) {
+        offsets[v + 1] = offsets[v] + getNumVertexEdges(v);
+    }
+
+    indices.resize(offsets[numVerts]);
+    int numIndices = 0;
+    for (Index v = 0; v < numVerts; ++v) {
+        ConstIndexArray vEdges = getVertexEdges(v);
+
+        offsets[v] = numIndices;
+        for (int i = 0; i < vEdges.size(); ++i) {
+            ConstIndexArray eVerts = getEdgeVertices(vEdges[i]);
+            if (eVerts[0] != eVerts[1]) {
+                indices[numIndices++] = (eVerts[0] == v) ? eVerts[1] : eVerts[0];
+            }
+        }
+    }
+    offsets[numVerts] = numIndices;
+    indices.resize(numIndices);
+    return numIndices;
+}
+
 bool
-Level::completeTopologyFromFaceVertices() {
+Level::completeTopologyFromFaceVertices(int numThreads) {
 
     //
     //  It's assumed (a pre-condition) that face-vertices have been fully specified and that we
@@ -1659,10 +1951,78 @@ Level::completeTopologyFromFaceVertices() {
     this->resizeEdges(0);
 
     //
-    //  Resize face-edges to match face-verts and reserve for edges based on an estimate:
+    //  Resize face-edges to match face-verts:
     //
     this->_faceEdgeIndices.resize(this->getNumFaceVerticesTotal());
 
+    //
+    //  Identify the edges and populate all relations involving them -- sorting the
+    //  face-vertices into edges when multiple threads are available and reverting to
+    //  the incremental search when the sorted approach cannot be applied:
+    //
+    IndexVector nonManifoldEdges;
+
+    if ((numThreads < 2) || !gatherEdgesFromSortedFaceVertices(nonManifoldEdges, numThreads)) {
+        gatherEdgesFromFaceVertices(nonManifoldEdges);
+    }
+
+    //  If max-edge-faces too large, max-valence must also be, so just need the one:
+    if (_maxValence > VALENCE_LIMIT) {
+        return false;
+    }
+
+    //
+    //  At this point all incident members are associated with each component.  We still
+    //  need to populate the "local indices" for each and orient manifold components in
+    //  counter-clockwise order.  First tag non-manifold edges and their incident
+    //  vertices so that we can trivially skip orienting these -- though some vertices
+    //  will be determined non-manifold as a result of a failure to orient them (and
+    //  will be marked accordingly when so detected).
+    //
+    //  Finally, the local indices are assigned.  This is trivial for manifold components
+    //  as if component V is in component F, V will only occur once in F.  For non-manifold
+    //  cases V may occur multiple times in F -- we rely on such instances being successive
+    //  based on their original assignment above, which simplifies the task.
+    //
+    //  First resize edges to the new count to ensure anything related to edges is created:
+    eCount = this->getNumEdges();
+    this->resizeEdges(eCount);
+
+    for (int i = 0; i < (int)nonManifoldEdges.size(); ++i) {
+        Index eIndex = nonManifoldEdges[i];
+
+        _edgeTags[eIndex]._nonManifold = true;
+
+        IndexArray eVerts = getEdgeVertices(eIndex);
+        _vertTags[eVerts[0]]._nonManifold = true;
+        _vertTags[eVerts[1]]._nonManifold = true;
+    }
+
+    orientIncidentComponents(numThreads);
+
+    populateLocalIndices(numThreads);
+
+//printf("Vertex topology completed...\n");
+//this->print();
+//printf("  validating vertex topology...\n");
+//this->validateTopology();
+//assert(this->validateTopology());
+    return true;
+}
+
+//
+//  Incremental identification of edges -- each edge of each face is searched for
+//  among the edges incident its first vertex and created when not found:
+//
+void
+Level::gatherEdgesFromFaceVertices(IndexVector & nonManifoldEdges) {
+
+    int vCount = this->getNumVertices();
+    int fCount = this->getNumFaces();
+
+    //
+    //  Reserve for edges based on an estimate:
+    //
     int eCountEstimate = (vCount << 1);
 
     this->_edgeVertIndices.reserve(eCountEstimate * 2);
@@ -1680,9 +2040,6 @@ Level::completeTopologyFromFaceVertices() {
     DynamicRelation dynVertFaces(this->_vertFaceCountsAndOffsets, this->_vertFaceIndices, avgSize);
     DynamicRelation dynVertEdges(this->_vertEdgeCountsAndOffsets, this->_vertEdgeIndices, avgSize);
 
-    //  Inspect each edge created and identify those that are non-manifold as we go:
-    IndexVector nonManifoldEdges;
-
     for (Index fIndex = 0; fIndex < fCount; ++fIndex) {
         IndexArray fVerts = this->getFaceVertices(fIndex);
         IndexArray fEdges = this->getFaceEdges(fIndex);
@@ -1765,53 +2122,239 @@ Level::completeTopologyFromFaceVertices() {
     assert(_maxValence > 0);
     _maxValence = std::max(maxVertFaces, _maxValence);
     _maxValence = std::max(maxVertEdges, _maxValence);
+}
 
-    //  If max-edge-faces too large, max-valence must also be, so just need the one:
-    if (_maxValence > VALENCE_LIMIT) {
-        return false;
+//
+//  Sorted identification of edges -- the edge leading from each face-vertex is
+//  keyed by its lower and higher vertex, and the face-vertices sorted by these
+//  keys (in parallel, per lower vertex) so that all occurrences of each edge
+//  are adjacent.  Edges are numbered, and all incident relations populated, in
+//  the same order as the incremental search so that both approaches produce
+//  identical topology.  Degenerate edges and edges occurring more than once in
+//  a face require the incremental search, so false is returned (with nothing
+//  modified) when either is detected:
+//
+namespace {
+    struct FaceVertexEdgeLess {
+        FaceVertexEdgeLess(Index const * upperVertex) : _upperVertex(upperVertex) { }
+
+        bool operator()(Index a, Index b) const {
+            return (_upperVertex[a] != _upperVertex[b]) ?
+                   (_upperVertex[a] <  _upperVertex[b]) : (a < b);
+        }
+        Index const * _upperVertex;
+    };
+}
+
+bool
+Level::gatherEdgesFromSortedFaceVertices(IndexVector & nonManifoldEdges, int numThreads) {
+
+    int vCount  = this->getNumVertices();
+    int fCount  = this->getNumFaces();
+    int fvCount = this->getNumFaceVerticesTotal();
+
+    //
+    //  Identify the face and the lower and upper vertex of the edge leading from
+    //  each face-vertex:
+    //
+    IndexVector fvFaces(fvCount);
+    IndexVector fvLowerVerts(fvCount);
+    IndexVector fvUpperVerts(fvCount);
+
+    int hasDegenerateEdges = 0;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for reduction(|:hasDegenerateEdges) if (numThreads > 1) num_threads(numThreads)
+#endif
+    for (Index fIndex = 0; fIndex < fCount; ++fIndex) {
+        ConstIndexArray fVerts = this->getFaceVertices(fIndex);
+
+        int fvOffset = this->getOffsetOfFaceVertices(fIndex);
+        for (int i = 0; i < fVerts.size(); ++i) {
+            Index v0Index = fVerts[i];
+            Index v1Index = fVerts[(i+1) % fVerts.size()];
+
+            fvFaces[fvOffset + i]      = fIndex;
+            fvLowerVerts[fvOffset + i] = std::min(v0Index, v1Index);
+            fvUpperVerts[fvOffset + i] = std::max(v0Index, v1Index);
+
+            hasDegenerateEdges |= (v0Index == v1Index);
+        }
     }
+    if (hasDegenerateEdges) return false;
 
     //
-    //  At this point all incident members are associated with each component.  We still
-    //  need to populate the "local indices" for each and orient manifold components in
-    //  counter-clockwise order.  First tag non-manifold edges and their incident
-    //  vertices so that we can trivially skip orienting these -- though some vertices
-    //  will be determined non-manifold as a result of a failure to orient them (and
-    //  will be marked accordingly when so detected).
+    //  Bucket the face-vertices by their lower vertex and sort each bucket by the
+    //  upper vertex (and face-vertex) so occurrences of each edge are successive
+    //  and in their original order -- the first occurrence of each being the one
+    //  to define the edge:
     //
-    //  Finally, the local indices are assigned.  This is trivial for manifold components
-    //  as if component V is in component F, V will only occur once in F.  For non-manifold
-    //  cases V may occur multiple times in F -- we rely on such instances being successive
-    //  based on their original assignment above, which simplifies the task.
+    IndexVector bucketOffsets(vCount + 1, 0);
+    for (int i = 0; i < fvCount; ++i) {
+        ++ bucketOffsets[fvLowerVerts[i] + 1];
+    }
+    for (int v = 0; v < vCount; ++v) {
+        bucketOffsets[v + 1] += bucketOffsets[v];
+    }
+
+    IndexVector bucketMembers(fvCount);
+    {
+        IndexVector bucketSizes(vCount, 0);
+        for (int i = 0; i < fvCount; ++i) {
+            Index vLower = fvLowerVerts[i];
+            bucketMembers[bucketOffsets[vLower] + bucketSizes[vLower]++] = i;
+        }
+    }
+
+    IndexVector fvFirstOccurrence(fvCount);
+
+    int hasRepeatedEdges = 0;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for reduction(|:hasRepeatedEdges) if (numThreads > 1) num_threads(numThreads)
+#endif
+    for (Index vIndex = 0; vIndex < vCount; ++vIndex) {
+        Index * bucketBegin = &bucketMembers[0] + bucketOffsets[vIndex];
+        Index * bucketEnd   = &bucketMembers[0] + bucketOffsets[vIndex + 1];
+
+        std::sort(bucketBegin, bucketEnd, FaceVertexEdgeLess(&fvUpperVerts[0]));
+
+        Index * first = bucketBegin;
+        for (Index * fv = bucketBegin; fv != bucketEnd; ++fv) {
+            if (fvUpperVerts[*fv] != fvUpperVerts[*first]) {
+                first = fv;
+            } else if (fv != first) {
+                //  Occurrences within the same face are successive:
+                hasRepeatedEdges |= (fvFaces[*fv] == fvFaces[*(fv - 1)]);
+            }
+            fvFirstOccurrence[*fv] = *first;
+        }
+    }
+    if (hasRepeatedEdges) return false;
+
     //
-    //  First resize edges to the new count to ensure anything related to edges is created:
-    eCount = this->getNumEdges();
+    //  Number the edges in order of their first occurrence while assigning the
+    //  face-edges and edge-vertices, then gather the edge-faces in order:
+    //
+    IndexArray faceEdges(&_faceEdgeIndices[0], fvCount);
+
+    _edgeVertIndices.resize(0);
+    _edgeVertIndices.reserve(2 * fvCount);
+
+    int eCount = 0;
+    for (int i = 0; i < fvCount; ++i) {
+        if (fvFirstOccurrence[i] == i) {
+            faceEdges[i] = eCount ++;
+            Index v0Index = _faceVertIndices[i];
+            _edgeVertIndices.push_back(v0Index);
+            _edgeVertIndices.push_back((v0Index == fvLowerVerts[i]) ? fvUpperVerts[i]
+                                                                     : fvLowerVerts[i]);
+        } else {
+            faceEdges[i] = faceEdges[fvFirstOccurrence[i]];
+        }
+    }
     this->resizeEdges(eCount);
+    this->resizeEdgeVertices();
 
-    for (int i = 0; i < (int)nonManifoldEdges.size(); ++i) {
-        Index eIndex = nonManifoldEdges[i];
+    _edgeFaceIndices.resize(fvCount);
 
-        _edgeTags[eIndex]._nonManifold = true;
+    int maxEdgeFaces = 0;
 
-        IndexArray eVerts = getEdgeVertices(eIndex);
-        _vertTags[eVerts[0]]._nonManifold = true;
-        _vertTags[eVerts[1]]._nonManifold = true;
+    std::vector<unsigned char> isEdgeNonManifold(eCount, 0);
+    {
+        for (int i = 0; i < fvCount; ++i) {
+            ++ _edgeFaceCountsAndOffsets[2*faceEdges[i]];
+        }
+        for (int e = 0, offset = 0; e < eCount; ++e) {
+            int count = _edgeFaceCountsAndOffsets[2*e];
+
+            _edgeFaceCountsAndOffsets[2*e]   = 0;
+            _edgeFaceCountsAndOffsets[2*e+1] = offset;
+            offset += count;
+        }
+        for (int i = 0; i < fvCount; ++i) {
+            Index eIndex = faceEdges[i];
+            int & count  = _edgeFaceCountsAndOffsets[2*eIndex];
+
+            _edgeFaceIndices[_edgeFaceCountsAndOffsets[2*eIndex+1] + count] = fvFaces[i];
+
+            //  Non-manifold if more than two faces or a second of the same orientation:
+            if (count > 1) {
+                isEdgeNonManifold[eIndex] = true;
+            } else if (count == 1) {
+                isEdgeNonManifold[eIndex] |= (_faceVertIndices[i] == _edgeVertIndices[2*eIndex]);
+            }
+            ++ count;
+            maxEdgeFaces = std::max(maxEdgeFaces, count);
+        }
+    }
+    for (int e = 0; e < eCount; ++e) {
+        if (isEdgeNonManifold[e]) nonManifoldEdges.push_back(e);
     }
 
-    orientIncidentComponents();
+    //
+    //  Gather the vertex-faces in order of the face-vertices and the vertex-edges
+    //  in order of the edges (the end vertices of each successively):
+    //
+    int maxVertFaces = 0;
+    {
+        for (int v = 0; v < vCount; ++v) {
+            _vertFaceCountsAndOffsets[2*v] = 0;
+        }
+        for (int i = 0; i < fvCount; ++i) {
+            ++ _vertFaceCountsAndOffsets[2*_faceVertIndices[i]];
+        }
+        for (int v = 0, offset = 0; v < vCount; ++v) {
+            int count = _vertFaceCountsAndOffsets[2*v];
 
-    populateLocalIndices();
+            _vertFaceCountsAndOffsets[2*v]   = 0;
+            _vertFaceCountsAndOffsets[2*v+1] = offset;
+            offset += count;
+            maxVertFaces = std::max(maxVertFaces, count);
+        }
+        _vertFaceIndices.resize(fvCount);
+        for (int i = 0; i < fvCount; ++i) {
+            Index vIndex = _faceVertIndices[i];
+            int & count  = _vertFaceCountsAndOffsets[2*vIndex];
 
-//printf("Vertex topology completed...\n");
-//this->print();
-//printf("  validating vertex topology...\n");
-//this->validateTopology();
-//assert(this->validateTopology());
+            _vertFaceIndices[_vertFaceCountsAndOffsets[2*vIndex+1] + count++] = fvFaces[i];
+        }
+    }
+
+    int maxVertEdges = 0;
+    {
+        for (int v = 0; v < vCount; ++v) {
+            _vertEdgeCountsAndOffsets[2*v] = 0;
+        }
+        for (int i = 0; i < 2 * eCount; ++i) {
+            ++ _vertEdgeCountsAndOffsets[2*_edgeVertIndices[i]];
+        }
+        for (int v = 0, offset = 0; v < vCount; ++v) {
+            int count = _vertEdgeCountsAndOffsets[2*v];
+
+            _vertEdgeCountsAndOffsets[2*v]   = 0;
+            _vertEdgeCountsAndOffsets[2*v+1] = offset;
+            offset += count;
+            maxVertEdges = std::max(maxVertEdges, count);
+        }
+        _vertEdgeIndices.resize(2 * eCount);
+        for (int i = 0; i < 2 * eCount; ++i) {
+            Index vIndex = _edgeVertIndices[i];
+            int & count  = _vertEdgeCountsAndOffsets[2*vIndex];
+
+            _vertEdgeIndices[_vertEdgeCountsAndOffsets[2*vIndex+1] + count++] = i >> 1;
+        }
+    }
+
+    _maxEdgeFaces = maxEdgeFaces;
+
+    _maxValence = std::max(maxVertFaces, _maxValence);
+    _maxValence = std::max(maxVertEdges, _maxValence);
     return true;
 }
 
 void
-Level::populateLocalIndices() {
+Level::populateLocalIndices(int numThreads) {
 
     //
     //  We have three sets of local indices -- edge-faces, vert-faces and vert-edges:
@@ -1823,6 +2366,9 @@ Level::populateLocalIndices() {
     this->_vertEdgeLocalIndices.resize(this->_vertEdgeIndices.size());
     this->_edgeFaceLocalIndices.resize(this->_edgeFaceIndices.size());
 
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+#endif
     for (Index vIndex = 0; vIndex < vCount; ++vIndex) {
         IndexArray      vFaces   = this->getVertexFaces(vIndex);
         LocalIndexArray vInFaces = this->getVertexFaceLocalIndices(vIndex);
@@ -1846,6 +2392,9 @@ Level::populateLocalIndices() {
         }
     }
 
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+#endif
     for (Index vIndex = 0; vIndex < vCount; ++vIndex) {
         IndexArray      vEdges   = this->getVertexEdges(vIndex);
         LocalIndexArray vInEdges = this->getVertexEdgeLocalIndices(vIndex);
@@ -1863,9 +2412,14 @@ Level::populateLocalIndices() {
                 vInEdges[i] = (i && (vEdges[i] == vEdges[i-1]));
             }
         }
-        _maxValence = std::max(_maxValence, vEdges.size());
+    }
+    for (Index vIndex = 0; vIndex < vCount; ++vIndex) {
+        _maxValence = std::max(_maxValence, this->getNumVertexEdges(vIndex));
     }
 
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+#endif
     for (Index eIndex = 0; eIndex < eCount; ++eIndex) {
         IndexArray      eFaces   = this->getEdgeFaces(eIndex);
         LocalIndexArray eInFaces = this->getEdgeFaceLocalIndices(eIndex);
@@ -1891,10 +2445,13 @@ Level::populateLocalIndices() {
 }
 
 void
-Level::orientIncidentComponents() {
+Level::orientIncidentComponents(int numThreads) {
 
     int vCount = getNumVertices();
 
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+#endif
     for (Index vIndex = 0; vIndex < vCount; ++vIndex) {
         Level::VTag & vTag = _vertTags[vIndex];
         if (!vTag._nonManifold) {
@@ -2064,7 +2621,7 @@ Level::getFVarOptions(int channel) const {
 
 ConstIndexArray
 Level::getFaceFVarValues(Index faceIndex, int channel) const {
-    return _fvarChannels[channel]->getFaceValues(faceIndex);
+    return getFVarLevel(channel).getFaceValues(faceIndex);
 }
 
 IndexArray
@@ -2073,8 +2630,210 @@ Level::getFaceFVarValues(Index faceIndex, int channel) {
 }
 
 void
-Level::completeFVarChannelTopology(int channel, int regBoundaryValence) {
-    return _fvarChannels[channel]->completeTopologyFromFaceValues(regBoundaryValence);
+Level::completeFVarChannelTopology(int channel, int regBoundaryValence, int numThreads) {
+    return _fvarChannels[channel]->completeTopologyFromFaceValues(regBoundaryValence, numThreads);
+}
+
+//
+//  Serialization of the Level to/from a flat binary buffer:
+//
+//  All vectors are written as is -- the tags are plain bitfields and so are only
+//  meaningful to the same build of the library, which is the responsibility of
+//  the client (the owning Far class) to verify.  Reading expects an empty Level
+//  (as constructed) and allocates the face-varying channels as they are read.
+//
+void
+Level::write(BinaryWriter & stream) const {
+
+    stream.write(_faceCount);
+    stream.write(_edgeCount);
+    stream.write(_vertCount);
+    stream.write(_depth);
+    stream.write(_maxEdgeFaces);
+    stream.write(_maxValence);
+    stream.write(_regFaceSize);
+    stream.write(_hasSemiSharpFeatures);
+
+    stream.writeVector(_faceVertCountsAndOffsets);
+    stream.writeVector(_faceVertIndices);
+    stream.writeVector(_faceEdgeIndices);
+    stream.writeVector(_faceTags);
+
+    stream.writeVector(_edgeVertIndices);
+    stream.writeVector(_edgeFaceCountsAndOffsets);
+    stream.writeVector(_edgeFaceIndices);
+    stream.writeVector(_edgeFaceLocalIndices);
+    stream.writeVector(_edgeSharpness);
+    stream.writeVector(_edgeTags);
+
+    stream.writeVector(_vertFaceCountsAndOffsets);
+    stream.writeVector(_vertFaceIndices);
+    stream.writeVector(_vertFaceLocalIndices);
+    stream.writeVector(_vertEdgeCountsAndOffsets);
+    stream.writeVector(_vertEdgeIndices);
+    stream.writeVector(_vertEdgeLocalIndices);
+    stream.writeVector(_vertSharpness);
+    stream.writeVector(_vertTags);
+
+    stream.write((int) _fvarChannels.size());
+    for (int i = 0; i < (int) _fvarChannels.size(); ++i) {
+        _fvarChannels[i]->write(stream);
+    }
+}
+
+bool
+Level::read(BinaryReader & stream) {
+
+    assert(_faceCount == 0 && _fvarChannels.empty());
+
+    stream.read(_faceCount);
+    stream.read(_edgeCount);
+    stream.read(_vertCount);
+    stream.read(_depth);
+    stream.read(_maxEdgeFaces);
+    stream.read(_maxValence);
+    stream.read(_regFaceSize);
+    stream.read(_hasSemiSharpFeatures);
+
+    stream.readVector(_faceVertCountsAndOffsets);
+    stream.readVector(_faceVertIndices);
+    stream.readVector(_faceEdgeIndices);
+    stream.readVector(_faceTags);
+
+    stream.readVector(_edgeVertIndices);
+    stream.readVector(_edgeFaceCountsAndOffsets);
+    stream.readVector(_edgeFaceIndices);
+    stream.readVector(_edgeFaceLocalIndices);
+    stream.readVector(_edgeSharpness);
+    stream.readVector(_edgeTags);
+
+    stream.readVector(_vertFaceCountsAndOffsets);
+    stream.readVector(_vertFaceIndices);
+    stream.readVector(_vertFaceLocalIndices);
+    stream.readVector(_vertEdgeCountsAndOffsets);
+    stream.readVector(_vertEdgeIndices);
+    stream.readVector(_vertEdgeLocalIndices);
+    stream.readVector(_vertSharpness);
+    stream.readVector(_vertTags);
+
+    int fvarChannelCount = 0;
+    if (!stream.read(fvarChannelCount) || (fvarChannelCount < 0)) {
+        return false;
+    }
+    for (int i = 0; i < fvarChannelCount; ++i) {
+        FVarLevel * fvarLevel = new FVarLevel(*this);
+        _fvarChannels.push_back(fvarLevel);
+
+        if (!fvarLevel->read(stream)) {
+            return false;
+        }
+    }
+
+    //  Sanity check the vectors whose sizes are implied by the inventory:
+    return stream.isValid() &&
+           ((int)_faceTags.size() == _faceCount) &&
+           ((int)_faceVertCountsAndOffsets.size() == (_regFaceSize ? 0 : 2 * _faceCount)) &&
+           ((int)_edgeTags.size() == _edgeCount) &&
+           ((int)_vertTags.size() == _vertCount);
+}
+
+//
+//  The incident relations of a refined Level are populated from an estimate
+//  of their size and trimmed to what is used, leaving excess capacity that can
+//  be significant when refinement is sparse.  Memory allocated from an Arena is
+//  not reclaimed by a smaller copy, so vectors using one are left as is:
+//
+namespace {
+    template <typename T>
+    void
+    shrinkVectorToFit(ArenaVector<T> & v) {
+
+        if ((v.getArena() == 0) && (v.capacity() > v.size() + v.size() / 8)) {
+            ArenaVector<T> tmp;
+            tmp.assign(v.begin(), v.end());
+            v.swap(tmp);
+        }
+    }
+}
+
+void
+Level::shrinkIncidentRelations() {
+
+    shrinkVectorToFit(_edgeFaceIndices);
+    shrinkVectorToFit(_edgeFaceLocalIndices);
+
+    shrinkVectorToFit(_vertFaceIndices);
+    shrinkVectorToFit(_vertFaceLocalIndices);
+
+    shrinkVectorToFit(_vertEdgeIndices);
+    shrinkVectorToFit(_vertEdgeLocalIndices);
+}
+
+//
+//  Memory usage of the Level -- the capacity of all vectors (which is only
+//  an approximation of the memory allocated when those are taken from an
+//  Arena) plus that of its face-varying channels:
+//
+size_t
+Level::getMemoryUsage() const {
+
+    size_t bytes = sizeof(*this) +
+        _faceVertCountsAndOffsets.getMemoryUsage() +
+        _faceVertIndices.getMemoryUsage() +
+        _faceEdgeIndices.getMemoryUsage() +
+        _faceTags.getMemoryUsage() +
+
+        _edgeVertIndices.getMemoryUsage() +
+        _edgeFaceCountsAndOffsets.getMemoryUsage() +
+        _edgeFaceIndices.getMemoryUsage() +
+        _edgeFaceLocalIndices.getMemoryUsage() +
+        _edgeSharpness.getMemoryUsage() +
+        _edgeTags.getMemoryUsage() +
+
+        _vertFaceCountsAndOffsets.getMemoryUsage() +
+        _vertFaceIndices.getMemoryUsage() +
+        _vertFaceLocalIndices.getMemoryUsage() +
+        _vertEdgeCountsAndOffsets.getMemoryUsage() +
+        _vertEdgeIndices.getMemoryUsage() +
+        _vertEdgeLocalIndices.getMemoryUsage() +
+        _vertSharpness.getMemoryUsage() +
+        _vertTags.getMemoryUsage() +
+
+        _fvarChannels.capacity() * sizeof(FVarLevel*);
+
+    for (int i = 0; i < (int)_fvarChannels.size(); ++i) {
+        bytes += _fvarChannels[i]->getMemoryUsage();
+    }
+    return bytes;
+}
+
+void
+Level::releaseTopology() {
+
+    _faceVertCountsAndOffsets.release();
+    _faceVertIndices.release();
+    _faceEdgeIndices.release();
+    _faceTags.release();
+
+    _edgeVertIndices.release();
+    _edgeFaceCountsAndOffsets.release();
+    _edgeFaceIndices.release();
+    _edgeFaceLocalIndices.release();
+    _edgeSharpness.release();
+    _edgeTags.release();
+
+    _vertFaceCountsAndOffsets.release();
+    _vertFaceIndices.release();
+    _vertFaceLocalIndices.release();
+    _vertEdgeCountsAndOffsets.release();
+    _vertEdgeIndices.release();
+    _vertEdgeLocalIndices.release();
+    _vertSharpness.release();
+    _vertTags.release();
+
+    for (int i = 0; i < (int)_fvarChannels.size(); ++i) {
+        _fvarChannels[i]->releaseTopology();
+    }
 }
 
 } // end namespace internal
@@ -30,6 +30,7 @@
 #include "../sdc/crease.h"
 #include "../sdc/options.h"
 #include "../vtr/types.h"
+#include "../vtr/arena.h"
 
 #include <algorithm>
 #include <vector>
@@ -48,6 +49,8 @@ class TriRefinement;
 class QuadRefinement;
 class FVarRefinement;
 class FVarLevel;
+class BinaryWriter;
+class BinaryReader;
 
 //
 //  Level:
@@ -205,12 +208,16 @@ public:
     };
 
 public:
-    Level();
+    //  All vectors of a Level (and its FVarLevels) are allocated from the
+    //  given Arena when not null:
+    Level(Arena * arena = 0);
     ~Level();
 
     //  Simple accessors:
     int getDepth() const { return _depth; }
 
+    Arena * getArena() const { return _faceVertIndices.getArena(); }
+
     int getNumVertices() const { return _vertCount; }
     int getNumFaces() const    { return _faceCount; }
     int getNumEdges() const    { return _edgeCount; }
@@ -226,6 +233,10 @@ public:
     int getMaxValence() const { return _maxValence; }
     int getMaxEdgeFaces() const { return _maxEdgeFaces; }
 
+    //  Whether any edge or vertex is semi-sharp -- if not, all sharpness values
+    //  are either smooth or infinite and are not affected by subdivision:
+    bool hasSemiSharpFeatures() const { return _hasSemiSharpFeatures; }
+
     //  Methods to access the relation tables/indices -- note that for some relations
     //  (i.e. those where a component is "contained by" a neighbor, or more generally
     //  when the neighbor is a simplex of higher dimension) we store an additional
@@ -314,14 +325,44 @@ public:
 
     typedef void (* ValidationCallback)(TopologyError errCode, char const * msg, void const * clientData);
 
-    bool validateTopology(ValidationCallback callback=0, void const * clientData=0) const;
+    bool validateTopology(ValidationCallback callback=0, void const * clientData=0,
+                          int numThreads=1) const;
+
+    //  Errors detected by validation identify the component (of dimension 0, 1 or 2
+    //  for vertices, edges and faces, or -1 for missing relations) and the member of
+    //  its relation (or count) that was found invalid.  At most one error is recorded
+    //  per component and validation stops once maxErrors are recorded (0 for all):
+    struct TopologyErrorInfo {
+        TopologyError errCode;
+        int           componentDim;
+        Index         component;
+        int           member;
+    };
+    typedef std::vector<TopologyErrorInfo> TopologyErrorList;
+
+    bool validateTopology(TopologyErrorList & errors, int maxErrors=1, int numThreads=1) const;
+
+    static void formatTopologyError(TopologyErrorInfo const & error, char * msg, int msgSize);
 
     void print(const Refinement* parentRefinement = 0) const;
 
+    //  Number of bytes allocated by the Level and its face-varying channels:
+    size_t getMemoryUsage() const;
+
+    //  Release all topology and face-varying values while retaining the component
+    //  counts (and face-varying value counts) of the Level:
+    void releaseTopology();
+
+    //  Serialization of all topology and face-varying channels to/from a flat
+    //  binary buffer -- reading expects an empty Level:
+    void write(BinaryWriter & stream) const;
+    bool read(BinaryReader & stream);
+
 public:
     //  High-level topology queries -- these may be moved elsewhere:
 
     bool isSingleCreasePatch(Index face, float* sharpnessOut=NULL, int* rotationOut=NULL) const;
+    bool isDoubleCreasePatch(Index face, float* sharpnessOut=NULL, int* rotationOut=NULL) const;
 
     //
     //  When inspecting topology, the component tags -- particularly VTag and ETag -- are most
@@ -337,6 +378,7 @@ public:
     bool doesVertexFVarTopologyMatch(Index vIndex, int fvarChannel) const;
     bool doesFaceFVarTopologyMatch(  Index fIndex, int fvarChannel) const;
     bool doesEdgeFVarTopologyMatch(  Index eIndex, int fvarChannel) const;
+    bool doesFVarChannelTopologyMatch(int fvarChannel) const;
 
     void getFaceVTags(Index fIndex, VTag vTags[], int fvarChannel = -1) const;
     void getFaceETags(Index fIndex, ETag eTags[], int fvarChannel = -1) const;
@@ -389,6 +431,14 @@ public:
     void resizeVertexEdges(int numVertexEdgesTotal);
 
     void setMaxValence(int maxValence);
+    void setHasSemiSharpFeatures(bool hasSemiSharpFeatures);
+
+    //  Declare all faces to be of the given size, releasing their counts/offsets:
+    void setRegularFaceSize(int faceSize);
+
+    //  Release the excess capacity of the incident relations (edge-faces,
+    //  vert-faces and vert-edges) when populated from an over-allocated estimate:
+    void shrinkIncidentRelations();
 
     //  Modifiers to populate the relations for each component:
     IndexArray getFaceVertices(Index faceIndex);
@@ -412,12 +462,17 @@ public:
 
     IndexArray getFaceFVarValues(Index faceIndex, int channel);
 
-    void completeFVarChannelTopology(int channel, int regBoundaryValence);
+    void completeFVarChannelTopology(int channel, int regBoundaryValence,
+                                     int numThreads = 1);
 
     //  Counts and offsets for all relation types:
     //      - these may be unwarranted if we let Refinement access members directly...
-    int getNumFaceVertices(     Index faceIndex) const { return _faceVertCountsAndOffsets[2*faceIndex]; }
-    int getOffsetOfFaceVertices(Index faceIndex) const { return _faceVertCountsAndOffsets[2*faceIndex + 1]; }
+    int getNumFaceVertices(     Index faceIndex) const {
+        return _regFaceSize ? _regFaceSize : _faceVertCountsAndOffsets[2*faceIndex];
+    }
+    int getOffsetOfFaceVertices(Index faceIndex) const {
+        return _regFaceSize ? (_regFaceSize * faceIndex) : _faceVertCountsAndOffsets[2*faceIndex + 1];
+    }
 
     int getNumFaceEdges(     Index faceIndex) const { return getNumFaceVertices(faceIndex); }
     int getOffsetOfFaceEdges(Index faceIndex) const { return getOffsetOfFaceVertices(faceIndex); }
@@ -436,6 +491,19 @@ public:
 
     ConstIndexArray getFaceVertices() const;
 
+    //  Whole relations stored as (count, offset) pairs per component indexing
+    //  a single array of incident components:
+    ConstIndexArray getEdgeVertices() const;
+    ConstIndexArray getVertexFaceCountsAndOffsets() const;
+    ConstIndexArray getVertexFaces() const;
+    ConstIndexArray getVertexEdgeCountsAndOffsets() const;
+    ConstIndexArray getVertexEdges() const;
+
+    //  Compact offsets (one more than the number of vertices) and indices of
+    //  the vertices sharing an edge with each vertex, in vertex-edge order:
+    int gatherVertexVertices(std::vector<Index> & offsets,
+                             std::vector<Index> & indices) const;
+
     //
     //  Note that for some relations, the size of the relations for a child component
     //  can vary radically from its parent due to the sparsity of the refinement.  So
@@ -465,16 +533,19 @@ public:
     //  it necessary to write code to define and orient all relations -- and most
     //  of that seemed best placed here.
     //
-    bool completeTopologyFromFaceVertices();
+    //  Edges are identified incrementally by default -- given more than one thread,
+    //  the face-vertices are first sorted into edges in parallel (falling back to
+    //  the incremental approach for degenerate or repeated edges):
+    bool completeTopologyFromFaceVertices(int numThreads = 1);
     Index findEdge(Index v0, Index v1, ConstIndexArray v0Edges) const;
 
     //  Methods supporting the above:
-    void orientIncidentComponents();
+    void gatherEdgesFromFaceVertices(IndexVector & nonManifoldEdges);
+    bool gatherEdgesFromSortedFaceVertices(IndexVector & nonManifoldEdges, int numThreads);
+    void orientIncidentComponents(int numThreads = 1);
     bool orderVertexFacesAndEdges(Index vIndex, Index* vFaces, Index* vEdges) const;
     bool orderVertexFacesAndEdges(Index vIndex);
-    void populateLocalIndices();
-
-    IndexArray shareFaceVertCountsAndOffsets() const;
+    void populateLocalIndices(int numThreads = 1);
 
 private:
     //  Refinement classes (including all subclasses) build a Level:
@@ -504,6 +575,15 @@ private:
     int _maxEdgeFaces;
     int _maxValence;
 
+    //  Size shared by all faces of a refined level (3 or 4), in which case the
+    //  counts and offsets of the face-vert relation are implicit and not stored.
+    //  Zero for a base level with faces of arbitrary size:
+    int _regFaceSize;
+
+    //  Set when any edge or vertex is semi-sharp, to bypass the subdivision of
+    //  sharpness values (and inspection of their effects) when none are:
+    bool _hasSemiSharpFeatures;
+
     //
     //  Topology vectors:
     //      Note that of all of these, only data for the face-edge relation is not
@@ -523,31 +603,31 @@ private:
     //
 
     //  Per-face:
-    std::vector<Index> _faceVertCountsAndOffsets;  // 2 per face, redundant after level 0
-    std::vector<Index> _faceVertIndices;           // 3 or 4 per face, variable at level 0
-    std::vector<Index> _faceEdgeIndices;           // matches face-vert indices
-    std::vector<FTag>  _faceTags;                  // 1 per face:  includes "hole" tag
+    ArenaVector<Index>      _faceVertCountsAndOffsets;  // 2 per face, empty after level 0
+    ArenaVector<Index>      _faceVertIndices;           // 3 or 4 per face, variable at level 0
+    ArenaVector<Index>      _faceEdgeIndices;           // matches face-vert indices
+    ArenaVector<FTag>       _faceTags;                  // 1 per face:  includes "hole" tag
 
     //  Per-edge:
-    std::vector<Index>      _edgeVertIndices;           // 2 per edge
-    std::vector<Index>      _edgeFaceCountsAndOffsets;  // 2 per edge
-    std::vector<Index>      _edgeFaceIndices;           // varies with faces per edge
-    std::vector<LocalIndex> _edgeFaceLocalIndices;      // varies with faces per edge
+    ArenaVector<Index>      _edgeVertIndices;           // 2 per edge
+    ArenaVector<Index>      _edgeFaceCountsAndOffsets;  // 2 per edge
+    ArenaVector<Index>      _edgeFaceIndices;           // varies with faces per edge
+    ArenaVector<LocalIndex> _edgeFaceLocalIndices;      // varies with faces per edge
 
-    std::vector<float>      _edgeSharpness;             // 1 per edge
-    std::vector<ETag>       _edgeTags;                  // 1 per edge:  manifold, boundary, etc.
+    ArenaVector<float>      _edgeSharpness;             // 1 per edge
+    ArenaVector<ETag>       _edgeTags;                  // 1 per edge:  manifold, boundary, etc.
 
     //  Per-vertex:
-    std::vector<Index>      _vertFaceCountsAndOffsets;  // 2 per vertex
-    std::vector<Index>      _vertFaceIndices;           // varies with valence
-    std::vector<LocalIndex> _vertFaceLocalIndices;      // varies with valence, 8-bit for now
+    ArenaVector<Index>      _vertFaceCountsAndOffsets;  // 2 per vertex
+    ArenaVector<Index>      _vertFaceIndices;           // varies with valence
+    ArenaVector<LocalIndex> _vertFaceLocalIndices;      // varies with valence, 8-bit for now
 
-    std::vector<Index>      _vertEdgeCountsAndOffsets;  // 2 per vertex
-    std::vector<Index>      _vertEdgeIndices;           // varies with valence
-    std::vector<LocalIndex> _vertEdgeLocalIndices;      // varies with valence, 8-bit for now
+    ArenaVector<Index>      _vertEdgeCountsAndOffsets;  // 2 per vertex
+    ArenaVector<Index>      _vertEdgeIndices;           // varies with valence
+    ArenaVector<LocalIndex> _vertEdgeLocalIndices;      // varies with valence, 8-bit for now
 
-    std::vector<float>      _vertSharpness;             // 1 per vertex
-    std::vector<VTag>       _vertTags;                  // 1 per vertex:  manifold, Sdc::Rule, etc.
+    ArenaVector<float>      _vertSharpness;             // 1 per vertex
+    ArenaVector<VTag>       _vertTags;                  // 1 per vertex:  manifold, Sdc::Rule, etc.
 
     //  Face-varying channels:
     std::vector<FVarLevel*> _fvarChannels;
@@ -558,13 +638,13 @@ private:
 //
 inline ConstIndexArray
 Level::getFaceVertices(Index faceIndex) const {
-    return ConstIndexArray(&_faceVertIndices[_faceVertCountsAndOffsets[faceIndex*2+1]],
-                          _faceVertCountsAndOffsets[faceIndex*2]);
+    return ConstIndexArray(&_faceVertIndices[getOffsetOfFaceVertices(faceIndex)],
+                          getNumFaceVertices(faceIndex));
 }
 inline IndexArray
 Level::getFaceVertices(Index faceIndex) {
-    return IndexArray(&_faceVertIndices[_faceVertCountsAndOffsets[faceIndex*2+1]],
-                          _faceVertCountsAndOffsets[faceIndex*2]);
+    return IndexArray(&_faceVertIndices[getOffsetOfFaceVertices(faceIndex)],
+                          getNumFaceVertices(faceIndex));
 }
 
 inline void
@@ -583,18 +663,44 @@ Level::getFaceVertices() const {
     return ConstIndexArray(&_faceVertIndices[0], (int)_faceVertIndices.size());
 }
 
+inline ConstIndexArray
+Level::getEdgeVertices() const {
+    return ConstIndexArray(_edgeVertIndices.empty() ? 0 : &_edgeVertIndices[0],
+                          (int)_edgeVertIndices.size());
+}
+inline ConstIndexArray
+Level::getVertexFaceCountsAndOffsets() const {
+    return ConstIndexArray(_vertFaceCountsAndOffsets.empty() ? 0 : &_vertFaceCountsAndOffsets[0],
+                          (int)_vertFaceCountsAndOffsets.size());
+}
+inline ConstIndexArray
+Level::getVertexFaces() const {
+    return ConstIndexArray(_vertFaceIndices.empty() ? 0 : &_vertFaceIndices[0],
+                          (int)_vertFaceIndices.size());
+}
+inline ConstIndexArray
+Level::getVertexEdgeCountsAndOffsets() const {
+    return ConstIndexArray(_vertEdgeCountsAndOffsets.empty() ? 0 : &_vertEdgeCountsAndOffsets[0],
+                          (int)_vertEdgeCountsAndOffsets.size());
+}
+inline ConstIndexArray
+Level::getVertexEdges() const {
+    return ConstIndexArray(_vertEdgeIndices.empty() ? 0 : &_vertEdgeIndices[0],
+                          (int)_vertEdgeIndices.size());
+}
+
 //
 //  Access/modify the edges incident a given face:
 //
 inline ConstIndexArray
 Level::getFaceEdges(Index faceIndex) const {
-    return ConstIndexArray(&_faceEdgeIndices[_faceVertCountsAndOffsets[faceIndex*2+1]],
-                          _faceVertCountsAndOffsets[faceIndex*2]);
+    return ConstIndexArray(&_faceEdgeIndices[getOffsetOfFaceVertices(faceIndex)],
+                          getNumFaceVertices(faceIndex));
 }
 inline IndexArray
 Level::getFaceEdges(Index faceIndex) {
-    return IndexArray(&_faceEdgeIndices[_faceVertCountsAndOffsets[faceIndex*2+1]],
-                          _faceVertCountsAndOffsets[faceIndex*2]);
+    return IndexArray(&_faceEdgeIndices[getOffsetOfFaceVertices(faceIndex)],
+                          getNumFaceVertices(faceIndex));
 }
 
 //
@@ -677,6 +783,10 @@ inline void
 Level::setMaxValence(int valence) {
     _maxValence = valence;
 }
+inline void
+Level::setHasSemiSharpFeatures(bool hasSemiSharpFeatures) {
+    _hasSemiSharpFeatures = hasSemiSharpFeatures;
+}
 
 //
 //  Access/modify the vertices incident a given edge:
@@ -798,12 +908,19 @@ Level::isVertexNonManifold(Index vertIndex) const {
 inline void
 Level::resizeFaces(int faceCount) {
     _faceCount = faceCount;
-    _faceVertCountsAndOffsets.resize(2 * faceCount);
+    if (!_regFaceSize) {
+        _faceVertCountsAndOffsets.resize(2 * faceCount);
+    }
 
     _faceTags.resize(faceCount);
     std::memset(&_faceTags[0], 0, _faceCount * sizeof(FTag));
 }
 inline void
+Level::setRegularFaceSize(int faceSize) {
+    _regFaceSize = faceSize;
+    _faceVertCountsAndOffsets.release();
+}
+inline void
 Level::resizeFaceVertices(int totalFaceVertCount) {
     _faceVertIndices.resize(totalFaceVertCount);
 }
@@ -861,14 +978,6 @@ Level::resizeVertexEdges(int totalVertEdgeCount) {
     _vertEdgeLocalIndices.resize(totalVertEdgeCount);
 }
 
-inline IndexArray
-Level::shareFaceVertCountsAndOffsets() const {
-    // XXXX manuelk we have to force const casting here (classes don't 'share'
-    // members usually...)
-    return IndexArray(const_cast<Index *>(&_faceVertCountsAndOffsets[0]),
-        (int)_faceVertCountsAndOffsets.size());
-}
-
 } // end namespace internal
 } // end namespace Vtr
 
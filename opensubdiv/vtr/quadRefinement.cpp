@@ -70,18 +70,14 @@ QuadRefinement::allocateParentChildIndices() {
     int vertChildVertCount = _parent->getNumVertices();
 
     //
-    //  First reference the parent Level's face-vertex counts/offsets -- they can be used
-    //  here for both the face-child-faces and face-child-edges as they both have one per
-    //  face-vertex.
+    //  The face-child-faces and face-child-edges both have one per face-vertex, and so
+    //  use the parent Level's face-vertex counts/offsets.
     //
     //  Given we will be ignoring initial values with uniform refinement and assigning all
     //  directly, initializing here is a waste...
     //
     Index initValue = 0;
 
-    _faceChildFaceCountsAndOffsets = _parent->shareFaceVertCountsAndOffsets();
-    _faceChildEdgeCountsAndOffsets = _parent->shareFaceVertCountsAndOffsets();
-
     _faceChildFaceIndices.resize(faceChildFaceCount, initValue);
     _faceChildEdgeIndices.resize(faceChildEdgeCount, initValue);
     _edgeChildEdgeIndices.resize(edgeChildEdgeCount, initValue);
@@ -99,25 +95,16 @@ QuadRefinement::allocateParentChildIndices() {
 void
 QuadRefinement::populateFaceVertexRelation() {
 
-    //  Both face-vertex and face-edge share the face-vertex counts/offsets within a
-    //  Level, so be sure not to re-initialize it if already done:
+    //  All child faces are quads, so the face-vertex counts/offsets (shared by face-edges)
+    //  are implicit and need not be populated:
     //
-    if (_child->_faceVertCountsAndOffsets.size() == 0) {
-        populateFaceVertexCountsAndOffsets();
-    }
+    _child->_regFaceSize = 4;
     _child->_faceVertIndices.resize(_child->getNumFaces() * 4);
 
-    populateFaceVerticesFromParentFaces();
-}
-
-void
-QuadRefinement::populateFaceVertexCountsAndOffsets() {
-
-    _child->_faceVertCountsAndOffsets.resize(_child->getNumFaces() * 2);
-
-    for (int i = 0; i < _child->getNumFaces(); ++i) {
-        _child->_faceVertCountsAndOffsets[i*2 + 0] = 4;
-        _child->_faceVertCountsAndOffsets[i*2 + 1] = i << 2;
+    if (_parent->_regFaceSize == 4) {
+        populateFaceVerticesFromParentQuads();
+    } else {
+        populateFaceVerticesFromParentFaces();
     }
 }
 
@@ -134,6 +121,9 @@ QuadRefinement::populateFaceVerticesFromParentFaces() {
     //  for its face-verts from the child vertices of the parent face, its edges
     //  and its vertices.
     //
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
     for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
         ConstIndexArray pFaceVerts = _parent->getFaceVertices(pFace),
                         pFaceEdges = _parent->getFaceEdges(pFace),
@@ -172,6 +162,47 @@ QuadRefinement::populateFaceVerticesFromParentFaces() {
     }
 }
 
+void
+QuadRefinement::populateFaceVerticesFromParentQuads() {
+
+    //
+    //  Specialization of the above when all parent faces are quads (as is the
+    //  case for all refined levels and most base levels), so that the face-verts,
+    //  face-edges and child faces of each parent face are found at fixed offsets
+    //  and each child face is oriented as the parent:
+    //
+    Index const * pFaceVertIndices = &_parent->_faceVertIndices[0];
+    Index const * pFaceEdgeIndices = &_parent->_faceEdgeIndices[0];
+    Index       * cFaceVertIndices = &_child->_faceVertIndices[0];
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
+    for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
+        Index const * pFaceVerts    = pFaceVertIndices + 4 * pFace;
+        Index const * pFaceEdges    = pFaceEdgeIndices + 4 * pFace;
+        Index const * pFaceChildren = &_faceChildFaceIndices[4 * pFace];
+
+        Index cVertOfFace = _faceChildVertIndex[pFace];
+
+        for (int j = 0; j < 4; ++j) {
+            Index cFace = pFaceChildren[j];
+            if (IndexIsValid(cFace)) {
+                int jNext = (j + 1) & 3;
+                int jOpp  = (j + 2) & 3;
+                int jPrev = (j + 3) & 3;
+
+                Index * cFaceVerts = cFaceVertIndices + 4 * cFace;
+
+                cFaceVerts[j]     = _vertChildVertIndex[pFaceVerts[j]];
+                cFaceVerts[jNext] = _edgeChildVertIndex[pFaceEdges[j]];
+                cFaceVerts[jOpp]  = cVertOfFace;
+                cFaceVerts[jPrev] = _edgeChildVertIndex[pFaceEdges[jPrev]];
+            }
+        }
+    }
+}
+
 
 //
 //  Methods to populate the face-vertex relation of the child Level:
@@ -180,15 +211,17 @@ QuadRefinement::populateFaceVerticesFromParentFaces() {
 void
 QuadRefinement::populateFaceEdgeRelation() {
 
-    //  Both face-vertex and face-edge share the face-vertex counts/offsets, so be sure
-    //  not to re-initialize it if already done:
+    //  All child faces are quads, so the face-vertex counts/offsets (shared by face-edges)
+    //  are implicit and need not be populated:
     //
-    if (_child->_faceVertCountsAndOffsets.size() == 0) {
-        populateFaceVertexCountsAndOffsets();
-    }
+    _child->_regFaceSize = 4;
     _child->_faceEdgeIndices.resize(_child->getNumFaces() * 4);
 
-    populateFaceEdgesFromParentFaces();
+    if (_parent->_regFaceSize == 4) {
+        populateFaceEdgesFromParentQuads();
+    } else {
+        populateFaceEdgesFromParentFaces();
+    }
 }
 
 void
@@ -205,6 +238,9 @@ QuadRefinement::populateFaceEdgesFromParentFaces() {
     //  The two remaining edges per child faces are perpendicular to these prev/next
     //  edges and share the child vertex of the parent face.
     //
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
     for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
         ConstIndexArray pFaceVerts = _parent->getFaceVertices(pFace),
                         pFaceEdges = _parent->getFaceEdges(pFace),
@@ -271,6 +307,58 @@ QuadRefinement::populateFaceEdgesFromParentFaces() {
     }
 }
 
+void
+QuadRefinement::populateFaceEdgesFromParentQuads() {
+
+    //
+    //  Specialization of the above when all parent faces are quads -- see
+    //  populateFaceVerticesFromParentQuads():
+    //
+    Index const * pFaceVertIndices = &_parent->_faceVertIndices[0];
+    Index const * pFaceEdgeIndices = &_parent->_faceEdgeIndices[0];
+    Index       * cFaceEdgeIndices = &_child->_faceEdgeIndices[0];
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
+    for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
+        Index const * pFaceVerts      = pFaceVertIndices + 4 * pFace;
+        Index const * pFaceEdges      = pFaceEdgeIndices + 4 * pFace;
+        Index const * pFaceChildFaces = &_faceChildFaceIndices[4 * pFace];
+        Index const * pFaceChildEdges = &_faceChildEdgeIndices[4 * pFace];
+
+        for (int j = 0; j < 4; ++j) {
+            Index cFace = pFaceChildFaces[j];
+            if (IndexIsValid(cFace)) {
+                int jNext = (j + 1) & 3;
+                int jOpp  = (j + 2) & 3;
+                int jPrev = (j + 3) & 3;
+
+                Index pPrevEdge = pFaceEdges[jPrev];
+                Index pNextEdge = pFaceEdges[j];
+
+                ConstIndexArray pPrevEdgeVerts = _parent->getEdgeVertices(pPrevEdge);
+                ConstIndexArray pNextEdgeVerts = _parent->getEdgeVertices(pNextEdge);
+
+                Index pCornerVert = pFaceVerts[j];
+
+                int cornerInPrevEdge = (pPrevEdgeVerts[0] != pPrevEdgeVerts[1])
+                                     ? (pPrevEdgeVerts[0] != pCornerVert) : 1;
+
+                int cornerInNextEdge = (pNextEdgeVerts[0] != pNextEdgeVerts[1])
+                                     ? (pNextEdgeVerts[0] != pCornerVert) : 0;
+
+                Index * cFaceEdges = cFaceEdgeIndices + 4 * cFace;
+
+                cFaceEdges[j]     = _edgeChildEdgeIndices[2 * pNextEdge + cornerInNextEdge];
+                cFaceEdges[jNext] = pFaceChildEdges[j];
+                cFaceEdges[jOpp]  = pFaceChildEdges[jPrev];
+                cFaceEdges[jPrev] = _edgeChildEdgeIndices[2 * pPrevEdge + cornerInPrevEdge];
+            }
+        }
+    }
+}
+
 //
 //  Methods to populate the edge-vertex relation of the child Level:
 //      - child edges originate from parent faces and edges
@@ -293,6 +381,9 @@ QuadRefinement::populateEdgeVerticesFromParentFaces() {
     //  to all.  The second vertex is the child vertex of the parent edge to
     //  which the new child edge is perpendicular.
     //
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
     for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
         ConstIndexArray pFaceEdges      = _parent->getFaceEdges(pFace),
                         pFaceChildEdges = getFaceChildEdges(pFace);
@@ -318,6 +409,9 @@ QuadRefinement::populateEdgeVerticesFromParentEdges() {
     //  to both.  The second vertex is the child vertex of the vertex at the
     //  end of the parent edge.
     //
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
     for (Index pEdge = 0; pEdge < _parent->getNumEdges(); ++pEdge) {
         ConstIndexArray pEdgeVerts = _parent->getEdgeVertices(pEdge),
                         pEdgeChildren = getEdgeChildEdges(pEdge);
@@ -509,6 +603,7 @@ QuadRefinement::populateEdgeFacesFromParentEdges() {
 //      - sparse refinement poses challenges with allocation here:
 //          - we need to update the counts/offsets as we populate
 //          - note this imposes ordering constraints and inhibits concurrency
+//          - so child vertices are visited in order rather than their parents
 //
 void
 QuadRefinement::populateVertexFaceRelation() {
@@ -560,9 +655,10 @@ QuadRefinement::populateVertexFaceRelation() {
 void
 QuadRefinement::populateVertexFacesFromParentFaces() {
 
-    for (int pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
-        int cVert = _faceChildVertIndex[pFace];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromFaces();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromFaces();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pFace = _childVertexParentIndex[cVert];
 
         ConstIndexArray pFaceChildren = getFaceChildFaces(pFace);
         int pFaceSize = pFaceChildren.size();
@@ -595,9 +691,10 @@ QuadRefinement::populateVertexFacesFromParentFaces() {
 void
 QuadRefinement::populateVertexFacesFromParentEdges() {
 
-    for (int pEdge = 0; pEdge < _parent->getNumEdges(); ++pEdge) {
-        int cVert = _edgeChildVertIndex[pEdge];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromEdges();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromEdges();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pEdge = _childVertexParentIndex[cVert];
 
         ConstIndexArray      pEdgeFaces  = _parent->getEdgeFaces(pEdge);
         ConstLocalIndexArray pEdgeInFace = _parent->getEdgeFaceLocalIndices(pEdge);
@@ -647,9 +744,10 @@ QuadRefinement::populateVertexFacesFromParentEdges() {
 void
 QuadRefinement::populateVertexFacesFromParentVertices() {
 
-    for (int pVert = 0; pVert < _parent->getNumVertices(); ++pVert) {
-        int cVert = _vertChildVertIndex[pVert];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromVertices();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromVertices();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pVert = _childVertexParentIndex[cVert];
 
         ConstIndexArray      pVertFaces  = _parent->getVertexFaces(pVert);
         ConstLocalIndexArray pVertInFace = _parent->getVertexFaceLocalIndices(pVert);
@@ -692,6 +790,7 @@ QuadRefinement::populateVertexFacesFromParentVertices() {
 //      - sparse refinement poses challenges with allocation here:
 //          - we need to update the counts/offsets as we populate
 //          - note this imposes ordering constraints and inhibits concurrency
+//          - so child vertices are visited in order rather than their parents
 //
 void
 QuadRefinement::populateVertexEdgeRelation() {
@@ -747,9 +846,10 @@ QuadRefinement::populateVertexEdgeRelation() {
 void
 QuadRefinement::populateVertexEdgesFromParentFaces() {
 
-    for (int pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
-        int cVert = _faceChildVertIndex[pFace];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromFaces();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromFaces();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pFace = _childVertexParentIndex[cVert];
 
         ConstIndexArray pFaceVerts = _parent->getFaceVertices(pFace),
                         pFaceChildEdges = getFaceChildEdges(pFace);
@@ -795,9 +895,10 @@ QuadRefinement::populateVertexEdgesFromParentEdges() {
     //  face.  We then swap the second and third (and possibly the first two) so
     //  that we have the desired origin sequence beginning [edge, face, edge, ...]
     //
-    for (int pEdge = 0; pEdge < _parent->getNumEdges(); ++pEdge) {
-        int cVert = _edgeChildVertIndex[pEdge];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromEdges();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromEdges();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pEdge = _childVertexParentIndex[cVert];
 
         ConstIndexArray      pEdgeFaces  = _parent->getEdgeFaces(pEdge);
         ConstLocalIndexArray pEdgeInFace = _parent->getEdgeFaceLocalIndices(pEdge);
@@ -869,9 +970,10 @@ QuadRefinement::populateVertexEdgesFromParentEdges() {
 void
 QuadRefinement::populateVertexEdgesFromParentVertices() {
 
-    for (int pVert = 0; pVert < _parent->getNumVertices(); ++pVert) {
-        int cVert = _vertChildVertIndex[pVert];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromVertices();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromVertices();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pVert = _childVertexParentIndex[cVert];
 
         ConstIndexArray      pVertEdges  = _parent->getVertexEdges(pVert);
         ConstLocalIndexArray pVertInEdge = _parent->getVertexEdgeLocalIndices(pVert);
@@ -68,10 +68,11 @@ protected:
     //
     //  Internal helper methods for populating the topology:
     //
-    void populateFaceVertexCountsAndOffsets();
     void populateFaceVerticesFromParentFaces();
+    void populateFaceVerticesFromParentQuads();
 
     void populateFaceEdgesFromParentFaces();
+    void populateFaceEdgesFromParentQuads();
 
     void populateEdgeVerticesFromParentFaces();
     void populateEdgeVerticesFromParentEdges();
@@ -30,9 +30,11 @@
 #include "../vtr/fvarLevel.h"
 #include "../vtr/fvarRefinement.h"
 #include "../vtr/stackBuffer.h"
+#include "../vtr/binaryStream.h"
 
 #include <cassert>
 #include <cstdio>
+#include <algorithm>
 #include <utility>
 
 
@@ -52,6 +54,8 @@ Refinement::Refinement(Level const & parentArg, Level & childArg, Sdc::Options c
     _regFaceSize(-1),
     _uniform(false),
     _faceVertsFirst(false),
+    _orderVertsByFaces(false),
+    _numThreads(1),
     _childFaceFromFaceCount(0),
     _childEdgeFromFaceCount(0),
     _childEdgeFromEdgeCount(0),
@@ -63,7 +67,22 @@ Refinement::Refinement(Level const & parentArg, Level & childArg, Sdc::Options c
     _firstChildEdgeFromEdge(0),
     _firstChildVertFromFace(0),
     _firstChildVertFromEdge(0),
-    _firstChildVertFromVert(0) {
+    _firstChildVertFromVert(0),
+    _faceChildFaceIndices  (childArg.getArena()),
+    _faceChildEdgeIndices  (childArg.getArena()),
+    _faceChildVertIndex    (childArg.getArena()),
+    _edgeChildEdgeIndices  (childArg.getArena()),
+    _edgeChildVertIndex    (childArg.getArena()),
+    _vertChildVertIndex    (childArg.getArena()),
+    _childFaceParentIndex  (childArg.getArena()),
+    _childEdgeParentIndex  (childArg.getArena()),
+    _childVertexParentIndex(childArg.getArena()),
+    _childFaceTag          (childArg.getArena()),
+    _childEdgeTag          (childArg.getArena()),
+    _childVertexTag        (childArg.getArena()),
+    _parentFaceTag         (childArg.getArena()),
+    _parentEdgeTag         (childArg.getArena()),
+    _parentVertexTag       (childArg.getArena()) {
 
     assert((childArg.getDepth() == 0) && (childArg.getNumVertices() == 0));
     childArg._depth = 1 + parentArg.getDepth();
@@ -76,6 +95,129 @@ Refinement::~Refinement() {
     }
 }
 
+//
+//  Serialization to/from a flat binary buffer:
+//
+//  The child Level is written first, followed by the parent-to-child mapping and
+//  tags and the face-varying refinements.  The counts/offsets for child faces and
+//  edges of parent faces are not written -- they are either shared with or
+//  computed in the same way from the parent Level, so the subclass is left to
+//  re-establish them (along with the other vectors that are then overwritten).
+//
+void
+Refinement::write(BinaryWriter & stream) const {
+
+    _child->write(stream);
+
+    stream.write(_uniform);
+    stream.write(_faceVertsFirst);
+    stream.write(_orderVertsByFaces);
+
+    stream.write(_childFaceFromFaceCount);
+    stream.write(_childEdgeFromFaceCount);
+    stream.write(_childEdgeFromEdgeCount);
+    stream.write(_childVertFromFaceCount);
+    stream.write(_childVertFromEdgeCount);
+    stream.write(_childVertFromVertCount);
+
+    stream.write(_firstChildFaceFromFace);
+    stream.write(_firstChildEdgeFromFace);
+    stream.write(_firstChildEdgeFromEdge);
+    stream.write(_firstChildVertFromFace);
+    stream.write(_firstChildVertFromEdge);
+    stream.write(_firstChildVertFromVert);
+
+    stream.writeVector(_faceChildFaceIndices);
+    stream.writeVector(_faceChildEdgeIndices);
+    stream.writeVector(_faceChildVertIndex);
+    stream.writeVector(_edgeChildEdgeIndices);
+    stream.writeVector(_edgeChildVertIndex);
+    stream.writeVector(_vertChildVertIndex);
+
+    stream.writeVector(_childFaceParentIndex);
+    stream.writeVector(_childEdgeParentIndex);
+    stream.writeVector(_childVertexParentIndex);
+
+    stream.writeVector(_childFaceTag);
+    stream.writeVector(_childEdgeTag);
+    stream.writeVector(_childVertexTag);
+
+    stream.writeVector(_parentFaceTag);
+    stream.writeVector(_parentEdgeTag);
+    stream.writeVector(_parentVertexTag);
+
+    for (int i = 0; i < (int)_fvarChannels.size(); ++i) {
+        _fvarChannels[i]->write(stream);
+    }
+}
+
+bool
+Refinement::read(BinaryReader & stream) {
+
+    assert(_fvarChannels.empty());
+
+    if (!_child->read(stream)) {
+        return false;
+    }
+    if (_child->getNumFVarChannels() != _parent->getNumFVarChannels()) {
+        return false;
+    }
+
+    allocateParentChildIndices();
+
+    stream.read(_uniform);
+    stream.read(_faceVertsFirst);
+    stream.read(_orderVertsByFaces);
+
+    stream.read(_childFaceFromFaceCount);
+    stream.read(_childEdgeFromFaceCount);
+    stream.read(_childEdgeFromEdgeCount);
+    stream.read(_childVertFromFaceCount);
+    stream.read(_childVertFromEdgeCount);
+    stream.read(_childVertFromVertCount);
+
+    stream.read(_firstChildFaceFromFace);
+    stream.read(_firstChildEdgeFromFace);
+    stream.read(_firstChildEdgeFromEdge);
+    stream.read(_firstChildVertFromFace);
+    stream.read(_firstChildVertFromEdge);
+    stream.read(_firstChildVertFromVert);
+
+    stream.readVector(_faceChildFaceIndices);
+    stream.readVector(_faceChildEdgeIndices);
+    stream.readVector(_faceChildVertIndex);
+    stream.readVector(_edgeChildEdgeIndices);
+    stream.readVector(_edgeChildVertIndex);
+    stream.readVector(_vertChildVertIndex);
+
+    stream.readVector(_childFaceParentIndex);
+    stream.readVector(_childEdgeParentIndex);
+    stream.readVector(_childVertexParentIndex);
+
+    stream.readVector(_childFaceTag);
+    stream.readVector(_childEdgeTag);
+    stream.readVector(_childVertexTag);
+
+    stream.readVector(_parentFaceTag);
+    stream.readVector(_parentEdgeTag);
+    stream.readVector(_parentVertexTag);
+
+    for (int i = 0; i < _parent->getNumFVarChannels(); ++i) {
+        FVarRefinement * fvarRefinement = new FVarRefinement(*this,
+                *_parent->_fvarChannels[i], *_child->_fvarChannels[i]);
+        _fvarChannels.push_back(fvarRefinement);
+
+        if (!fvarRefinement->read(stream)) {
+            return false;
+        }
+    }
+
+    return stream.isValid() &&
+           ((int)_edgeChildVertIndex.size() == _parent->getNumEdges()) &&
+           ((int)_vertChildVertIndex.size() == _parent->getNumVertices()) &&
+           ((int)_childVertexParentIndex.size() == _child->getNumVertices());
+}
+
 void
 Refinement::initializeChildComponentCounts() {
 
@@ -119,8 +261,10 @@ Refinement::refine(Options refineOptions) {
     //  This will become redundant when/if assigned on construction:
     assert(_parent && _child);
 
-    _uniform        = !refineOptions._sparse;
-    _faceVertsFirst =  refineOptions._faceVertsFirst;
+    _uniform           = !refineOptions._sparse;
+    _faceVertsFirst    =  refineOptions._faceVertsFirst;
+    _orderVertsByFaces =  refineOptions._orderVertsByFaces;
+    _numThreads        =  std::max(1, (int) refineOptions._numThreads);
 
     //  We may soon have an option here to suppress refinement of FVar channels...
     bool refineOptions_ignoreFVarChannels = false;
@@ -135,6 +279,8 @@ Refinement::refine(Options refineOptions) {
 
     initializeChildComponentCounts();
 
+    reserveChildStorage(refineOptions);
+
     populateChildToParentMapping();
 
     propagateComponentTags();
@@ -175,6 +321,74 @@ Refinement::refine(Options refineOptions) {
     //assert(_child->validateTopology());
 }
 
+void
+Refinement::populateMissingChildRelations() {
+
+    //
+    //  Each relation is populated independently from the parent Level and the
+    //  parent-child mappings retained by the refinement, so only those missing
+    //  need be generated.  Sharpness and vertex Rules were already determined
+    //  without them:
+    //
+    Relations relationsToPopulate;
+    relationsToPopulate._faceVertices = (_child->getNumFaceVerticesTotal() == 0);
+    relationsToPopulate._faceEdges    = (_child->getNumFaceEdgesTotal()    == 0);
+    relationsToPopulate._edgeVertices = (_child->getNumEdgeVerticesTotal() == 0);
+    relationsToPopulate._edgeFaces    = (_child->getNumEdgeFacesTotal()    == 0);
+    relationsToPopulate._vertexFaces  = (_child->getNumVertexFacesTotal()  == 0);
+    relationsToPopulate._vertexEdges  = (_child->getNumVertexEdgesTotal()  == 0);
+
+    subdivideTopology(relationsToPopulate);
+}
+
+
+//
+//  When the child Level is allocated from an Arena, the memory for its vectors
+//  (and those of the child-to-parent mapping) is reserved upfront from the
+//  component counts, so the vectors of the child are contiguous.  The estimate
+//  is based on regular faces and vertices and is only needed to be approximate
+//  -- any excess is taken from subsequent blocks of the Arena:
+//
+void
+Refinement::reserveChildStorage(Options refineOptions) {
+
+    Arena * arena = _child->getArena();
+    if (arena == 0) return;
+
+    size_t nFaces = (size_t) _child->getNumFaces();
+    size_t nEdges = (size_t) _child->getNumEdges();
+    size_t nVerts = (size_t) _child->getNumVertices();
+
+    size_t nFaceVerts = nFaces * _regFaceSize;
+
+    //  Child-to-parent mapping and tags:
+    size_t size = (nFaces + nEdges + nVerts) * (sizeof(Index) + sizeof(ChildTag));
+
+    //  Face-vertices and component tags and sharpness are always populated:
+    size = size + nFaces * 2 * sizeof(Index) + nFaceVerts * sizeof(Index)
+                + nFaces * sizeof(Level::FTag) + nEdges * sizeof(Level::ETag)
+                + nVerts * sizeof(Level::VTag)
+                + (nEdges + nVerts) * sizeof(float);
+
+    bool vertFaces = !refineOptions._minimalTopology ||
+                     (_parent->getNumFVarChannels() > 0);
+    if (vertFaces) {
+        size = size + nVerts * 2 * sizeof(Index)
+                    + nFaceVerts * (sizeof(Index) + sizeof(LocalIndex));
+    }
+    if (!refineOptions._minimalTopology) {
+        //  Face-edges, edge-verts, edge-faces and vert-edges:
+        size = size + nFaceVerts * sizeof(Index)
+                    + nEdges * 2 * sizeof(Index)
+                    + nEdges * 2 * sizeof(Index)
+                    + nEdges * 2 * (sizeof(Index) + sizeof(LocalIndex))
+                    + nVerts * 2 * sizeof(Index)
+                    + nEdges * 2 * (sizeof(Index) + sizeof(LocalIndex));
+    }
+
+    //  Allow for the alignment of each of the vectors:
+    arena->reserve(size + 32 * Arena::ALIGNMENT);
+}
 
 //
 //  Methods to construct the parent-to-child mapping
@@ -203,7 +417,7 @@ namespace {
     inline bool isSparseIndexMarked(Index index)   { return index != 0; }
 
     inline int
-    sequenceSparseIndexVector(IndexVector& indexVector, int baseValue = 0) {
+    sequenceSparseIndexVector(ArenaVector<Index>& indexVector, int baseValue = 0) {
         int validCount = 0;
         for (int i = 0; i < (int) indexVector.size(); ++i) {
             indexVector[i] = isSparseIndexMarked(indexVector[i])
@@ -213,13 +427,48 @@ namespace {
     }
 
     inline int
-    sequenceFullIndexVector(IndexVector& indexVector, int baseValue = 0) {
+    sequenceFullIndexVector(ArenaVector<Index>& indexVector, int baseValue = 0) {
         int indexCount = (int) indexVector.size();
         for (int i = 0; i < indexCount; ++i) {
             indexVector[i] = baseValue++;
         }
         return indexCount;
     }
+
+    //
+    //  Reassign the (already sequenced) valid indices in the order their components
+    //  are first encountered by the faces of the given Level -- components incident
+    //  no face retain their relative order at the end of the sequence:
+    //
+    inline void
+    resequenceIndexVectorByFaces(ArenaVector<Index>& indexVector, int baseValue,
+            Level const & level, ConstIndexArray (Level::*getFaceComponents)(Index) const) {
+
+        Index const pendingIndex = INDEX_INVALID - 1;
+
+        int indexCount = (int) indexVector.size();
+        for (int i = 0; i < indexCount; ++i) {
+            if (IndexIsValid(indexVector[i])) {
+                indexVector[i] = pendingIndex;
+            }
+        }
+
+        Index nextIndex = baseValue;
+        for (Index face = 0; face < level.getNumFaces(); ++face) {
+            ConstIndexArray faceComponents = (level.*getFaceComponents)(face);
+            for (int j = 0; j < faceComponents.size(); ++j) {
+                Index & index = indexVector[faceComponents[j]];
+                if (index == pendingIndex) {
+                    index = nextIndex++;
+                }
+            }
+        }
+        for (int i = 0; i < indexCount; ++i) {
+            if (indexVector[i] == pendingIndex) {
+                indexVector[i] = nextIndex++;
+            }
+        }
+    }
 }
 
 void
@@ -302,6 +551,20 @@ Refinement::populateParentChildIndices() {
             _childVertFromEdgeCount = sequenceSparseIndexVector(_edgeChildVertIndex, _firstChildVertFromEdge);
         }
     }
+
+    //
+    //  When ordering vertices by faces, the blocks of child vertices retain their
+    //  position and size, but the children of edges and vertices are reassigned in
+    //  the order their parents are encountered by the parent faces -- so that, like
+    //  the children of the faces themselves, the children of neighboring faces are
+    //  near each other (the rest of the code only relies on the blocks):
+    //
+    if (_orderVertsByFaces) {
+        resequenceIndexVectorByFaces(_edgeChildVertIndex, _firstChildVertFromEdge,
+                                     *_parent, &Level::getFaceEdges);
+        resequenceIndexVectorByFaces(_vertChildVertIndex, _firstChildVertFromVert,
+                                     *_parent, &Level::getFaceVertices);
+    }
 }
 
 void
@@ -544,11 +807,10 @@ Refinement::populateVertexParentFromParentFaces(ChildTag const initialChildTags[
     if (getNumChildVerticesFromFaces() == 0) return;
 
     if (_uniform) {
-        Index cVert = getFirstChildVertexFromFaces();
-        for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace, ++cVert) {
+        for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
             //  Child tag was initialized as the complete and only child when allocated
 
-            _childVertexParentIndex[cVert] = pFace;
+            _childVertexParentIndex[_faceChildVertIndex[pFace]] = pFace;
         }
     } else {
         ChildTag const & completeChildTag = initialChildTags[0][0];
@@ -569,11 +831,10 @@ void
 Refinement::populateVertexParentFromParentEdges(ChildTag const initialChildTags[2][4]) {
 
     if (_uniform) {
-        Index cVert = getFirstChildVertexFromEdges();
-        for (Index pEdge = 0; pEdge < _parent->getNumEdges(); ++pEdge, ++cVert) {
+        for (Index pEdge = 0; pEdge < _parent->getNumEdges(); ++pEdge) {
             //  Child tag was initialized as the complete and only child when allocated
 
-            _childVertexParentIndex[cVert] = pEdge;
+            _childVertexParentIndex[_edgeChildVertIndex[pEdge]] = pEdge;
         }
     } else {
         ChildTag const & completeChildTag = initialChildTags[0][0];
@@ -594,11 +855,10 @@ void
 Refinement::populateVertexParentFromParentVertices(ChildTag const initialChildTags[2][4]) {
 
     if (_uniform) {
-        Index cVert = getFirstChildVertexFromVertices();
-        for (Index pVert = 0; pVert < _parent->getNumVertices(); ++pVert, ++cVert) {
+        for (Index pVert = 0; pVert < _parent->getNumVertices(); ++pVert) {
             //  Child tag was initialized as the complete and only child when allocated
 
-            _childVertexParentIndex[cVert] = pVert;
+            _childVertexParentIndex[_vertChildVertIndex[pVert]] = pVert;
         }
     } else {
         ChildTag const & completeChildTag = initialChildTags[0][0];
@@ -618,7 +878,9 @@ Refinement::populateVertexParentFromParentVertices(ChildTag const initialChildTa
 
 
 //
-//  Methods to propagate/initialize child component tags from their parent component:
+//  Methods to propagate/initialize child component tags from their parent component
+//  -- each child tag is assigned only from its own parent component, so the tags are
+//  propagated over the available threads:
 //
 void
 Refinement::propagateComponentTags() {
@@ -641,9 +903,12 @@ Refinement::populateFaceTagsFromParentFaces() {
     //
     //  Tags for faces originating from faces are inherited from the parent face:
     //
-    Index cFace    = getFirstChildFaceFromFaces();
-    Index cFaceEnd = cFace + getNumChildFacesFromFaces();
-    for ( ; cFace < cFaceEnd; ++cFace) {
+    Index cFaceBegin = getFirstChildFaceFromFaces();
+    Index cFaceEnd   = cFaceBegin + getNumChildFacesFromFaces();
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
+    for (Index cFace = cFaceBegin; cFace < cFaceEnd; ++cFace) {
         _child->_faceTags[cFace] = _parent->_faceTags[_childFaceParentIndex[cFace]];
     }
 }
@@ -665,9 +930,12 @@ Refinement::populateEdgeTagsFromParentFaces() {
     Level::ETag eTag;
     eTag.clear();
 
-    Index cEdge    = getFirstChildEdgeFromFaces();
-    Index cEdgeEnd = cEdge + getNumChildEdgesFromFaces();
-    for ( ; cEdge < cEdgeEnd; ++cEdge) {
+    Index cEdgeBegin = getFirstChildEdgeFromFaces();
+    Index cEdgeEnd   = cEdgeBegin + getNumChildEdgesFromFaces();
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
+    for (Index cEdge = cEdgeBegin; cEdge < cEdgeEnd; ++cEdge) {
         _child->_edgeTags[cEdge] = eTag;
     }
 }
@@ -677,9 +945,12 @@ Refinement::populateEdgeTagsFromParentEdges() {
     //
     //  Tags for edges originating from edges are inherited from the parent edge:
     //
-    Index cEdge    = getFirstChildEdgeFromEdges();
-    Index cEdgeEnd = cEdge + getNumChildEdgesFromEdges();
-    for ( ; cEdge < cEdgeEnd; ++cEdge) {
+    Index cEdgeBegin = getFirstChildEdgeFromEdges();
+    Index cEdgeEnd   = cEdgeBegin + getNumChildEdgesFromEdges();
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
+    for (Index cEdge = cEdgeBegin; cEdge < cEdgeEnd; ++cEdge) {
         _child->_edgeTags[cEdge] = _parent->_edgeTags[_childEdgeParentIndex[cEdge]];
     }
 }
@@ -694,6 +965,9 @@ Refinement::populateVertexTagVectors() {
     populateVertexTagsFromParentVertices();
 
     if (!_uniform) {
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
         for (Index cVert = 0; cVert < _child->getNumVertices(); ++cVert) {
             if (_childVertexTag[cVert]._incomplete) {
                 _child->_vertTags[cVert]._incomplete = true;
@@ -715,15 +989,21 @@ Refinement::populateVertexTagsFromParentFaces() {
     vTag.clear();
     vTag._rule = Sdc::Crease::RULE_SMOOTH;
 
-    Index cVert    = getFirstChildVertexFromFaces();
-    Index cVertEnd = cVert + getNumChildVerticesFromFaces();
+    Index cVertBegin = getFirstChildVertexFromFaces();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromFaces();
 
     if (_parent->_depth > 0) {
-        for ( ; cVert < cVertEnd; ++cVert) {
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
+        for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
             _child->_vertTags[cVert] = vTag;
         }
     } else {
-        for ( ; cVert < cVertEnd; ++cVert) {
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
+        for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
             _child->_vertTags[cVert] = vTag;
 
             if (_parent->getNumFaceVertices(_childVertexParentIndex[cVert]) != _regFaceSize) {
@@ -739,9 +1019,12 @@ Refinement::populateVertexTagsFromParentEdges() {
     //  Tags for vertices originating from edges are initialized according to the tags
     //  of the parent edge:
     //
-    Level::VTag vTag;
-    vTag.clear();
+    Level::VTag vTagCleared;
+    vTagCleared.clear();
 
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
     for (Index pEdge = 0; pEdge < _parent->getNumEdges(); ++pEdge) {
         Index cVert = _edgeChildVertIndex[pEdge];
         if (!IndexIsValid(cVert)) continue;
@@ -750,6 +1033,8 @@ Refinement::populateVertexTagsFromParentEdges() {
         //  on the parent edge:
         Level::ETag const& pEdgeTag = _parent->_edgeTags[pEdge];
 
+        Level::VTag vTag = vTagCleared;
+
         vTag._nonManifold    = pEdgeTag._nonManifold;
         vTag._boundary       = pEdgeTag._boundary;
         vTag._semiSharpEdges = pEdgeTag._semiSharp;
@@ -769,9 +1054,12 @@ Refinement::populateVertexTagsFromParentVertices() {
     //
     //  Tags for vertices originating from vertices are inherited from the parent vertex:
     //
-    Index cVert    = getFirstChildVertexFromVertices();
-    Index cVertEnd = cVert + getNumChildVerticesFromVertices();
-    for ( ; cVert < cVertEnd; ++cVert) {
+    Index cVertBegin = getFirstChildVertexFromVertices();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromVertices();
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
         _child->_vertTags[cVert] = _parent->_vertTags[_childVertexParentIndex[cVert]];
         _child->_vertTags[cVert]._incidIrregFace = 0;
     }
@@ -790,6 +1078,11 @@ Refinement::populateVertexTagsFromParentVertices() {
 void
 Refinement::subdivideTopology(Relations const& applyTo) {
 
+    //
+    //  The face-vertex, face-edge and edge-vertex relations have a fixed size per
+    //  child component, so the subclasses distribute the parent components over
+    //  the available threads when populating them:
+    //
     if (applyTo._faceVertices) {
         populateFaceVertexRelation();
     }
@@ -799,14 +1092,38 @@ Refinement::subdivideTopology(Relations const& applyTo) {
     if (applyTo._edgeVertices) {
         populateEdgeVertexRelation();
     }
-    if (applyTo._edgeFaces) {
-        populateEdgeFaceRelation();
-    }
-    if (applyTo._vertexFaces) {
-        populateVertexFaceRelation();
+
+    //
+    //  The counts/offsets of the remaining relations are populated incrementally,
+    //  which prevents partitioning the parent components.  Each relation writes
+    //  to its own vectors of the child Level though, so the three can be populated
+    //  concurrently:
+    //
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel sections if (_numThreads > 1) num_threads(std::min(_numThreads, 3))
+#endif
+    {
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp section
+#endif
+        if (applyTo._edgeFaces) {
+            populateEdgeFaceRelation();
+        }
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp section
+#endif
+        if (applyTo._vertexFaces) {
+            populateVertexFaceRelation();
+        }
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp section
+#endif
+        if (applyTo._vertexEdges) {
+            populateVertexEdgeRelation();
+        }
     }
-    if (applyTo._vertexEdges) {
-        populateVertexEdgeRelation();
+    if (!_uniform) {
+        _child->shrinkIncidentRelations();
     }
 
     //
@@ -854,15 +1171,20 @@ Refinement::subdivideSharpnessValues() {
     //
 
     //  These methods will update sharpness tags local to the edges and vertices:
-    subdivideEdgeSharpness();
-    subdivideVertexSharpness();
+    bool hasSemiSharpEdges = subdivideEdgeSharpness();
+    bool hasSemiSharpVerts = subdivideVertexSharpness();
+
+    _child->_hasSemiSharpFeatures = hasSemiSharpEdges || hasSemiSharpVerts;
 
     //  This method uses local sharpness tags (set above) to update vertex tags that
-    //  reflect the neighborhood of the vertex (e.g. its rule):
-    reclassifySemisharpVertices();
+    //  reflect the neighborhood of the vertex (e.g. its rule) -- none are affected
+    //  when the parent has no semi-sharp features, as all sharpness is infinite:
+    if (_parent->_hasSemiSharpFeatures) {
+        reclassifySemisharpVertices();
+    }
 }
 
-void
+bool
 Refinement::subdivideEdgeSharpness() {
 
     Sdc::Crease creasing(_options);
@@ -885,13 +1207,27 @@ Refinement::subdivideEdgeSharpness() {
     //  non-trivial creasing method like Chaikin is used.  This is not being
     //  done now but is worth considering...
     //
+    //  Without any semi-sharp parent edges, only the infinitely sharp child edges
+    //  need to be assigned.  Returns whether any child edges remain semi-sharp.
+    //
+    Index cEdge    = getFirstChildEdgeFromEdges();
+    Index cEdgeEnd = cEdge + getNumChildEdgesFromEdges();
+
+    if (!_parent->_hasSemiSharpFeatures) {
+        for ( ; cEdge < cEdgeEnd; ++cEdge) {
+            if (_child->_edgeTags[cEdge]._infSharp) {
+                _child->_edgeSharpness[cEdge] = Sdc::Crease::SHARPNESS_INFINITE;
+            }
+        }
+        return false;
+    }
+
     internal::StackBuffer<float,16> pVertEdgeSharpness;
     if (!creasing.IsUniform()) {
         pVertEdgeSharpness.Reserve(_parent->getMaxValence());
     }
 
-    Index cEdge    = getFirstChildEdgeFromEdges();
-    Index cEdgeEnd = cEdge + getNumChildEdgesFromEdges();
+    bool hasSemiSharpEdges = false;
     for ( ; cEdge < cEdgeEnd; ++cEdge) {
         float&       cSharpness = _child->_edgeSharpness[cEdge];
         Level::ETag& cEdgeTag   = _child->_edgeTags[cEdge];
@@ -917,12 +1253,15 @@ Refinement::subdivideEdgeSharpness() {
             }
             if (! Sdc::Crease::IsSharp(cSharpness)) {
                 cEdgeTag._semiSharp = false;
+            } else {
+                hasSemiSharpEdges = true;
             }
         }
     }
+    return hasSemiSharpEdges;
 }
 
-void
+bool
 Refinement::subdivideVertexSharpness() {
 
     Sdc::Crease creasing(_options);
@@ -938,6 +1277,7 @@ Refinement::subdivideVertexSharpness() {
     Index cVertBegin = getFirstChildVertexFromVertices();
     Index cVertEnd   = cVertBegin + getNumChildVerticesFromVertices();
 
+    bool hasSemiSharpVerts = false;
     for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
         float&       cSharpness = _child->_vertSharpness[cVert];
         Level::VTag& cVertTag   = _child->_vertTags[cVert];
@@ -951,9 +1291,12 @@ Refinement::subdivideVertexSharpness() {
             cSharpness = creasing.SubdivideVertexSharpness(pSharpness);
             if (! Sdc::Crease::IsSharp(cSharpness)) {
                 cVertTag._semiSharp = false;
+            } else {
+                hasSemiSharpVerts = true;
             }
         }
     }
+    return hasSemiSharpVerts;
 }
 
 void
@@ -1244,6 +1587,66 @@ Refinement::markSparseEdgeChildren() {
     }
 }
 
+//
+//  Memory usage of the refinement -- the child Level is not included as it
+//  is owned and reported separately:
+//
+size_t
+Refinement::getMemoryUsage() const {
+
+    size_t bytes = sizeof(*this) +
+        _faceChildFaceIndices.getMemoryUsage() +
+        _faceChildEdgeIndices.getMemoryUsage() +
+        _faceChildVertIndex.getMemoryUsage() +
+        _edgeChildEdgeIndices.getMemoryUsage() +
+        _edgeChildVertIndex.getMemoryUsage() +
+        _vertChildVertIndex.getMemoryUsage() +
+
+        _childFaceParentIndex.getMemoryUsage() +
+        _childEdgeParentIndex.getMemoryUsage() +
+        _childVertexParentIndex.getMemoryUsage() +
+        _childFaceTag.getMemoryUsage() +
+        _childEdgeTag.getMemoryUsage() +
+        _childVertexTag.getMemoryUsage() +
+
+        _parentFaceTag.getMemoryUsage() +
+        _parentEdgeTag.getMemoryUsage() +
+        _parentVertexTag.getMemoryUsage() +
+
+        _fvarChannels.capacity() * sizeof(FVarRefinement*);
+
+    for (int i = 0; i < (int)_fvarChannels.size(); ++i) {
+        bytes += _fvarChannels[i]->getMemoryUsage();
+    }
+    return bytes;
+}
+
+void
+Refinement::releaseMappings() {
+
+    _faceChildFaceIndices.release();
+    _faceChildEdgeIndices.release();
+    _faceChildVertIndex.release();
+    _edgeChildEdgeIndices.release();
+    _edgeChildVertIndex.release();
+    _vertChildVertIndex.release();
+
+    _childFaceParentIndex.release();
+    _childEdgeParentIndex.release();
+    _childVertexParentIndex.release();
+    _childFaceTag.release();
+    _childEdgeTag.release();
+    _childVertexTag.release();
+
+    _parentFaceTag.release();
+    _parentEdgeTag.release();
+    _parentVertexTag.release();
+
+    for (int i = 0; i < (int)_fvarChannels.size(); ++i) {
+        _fvarChannels[i]->releaseMappings();
+    }
+}
+
 } // end namespace internal
 } // end namespace Vtr
 
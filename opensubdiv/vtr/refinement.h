@@ -100,6 +100,17 @@ public:
     //          vertex-faces for any face-varying channels present.  So it will
     //          generate one or two of the six possible topological relations.
     //
+    //      "order verts by faces": child vertices of each origin (faces, edges or
+    //          vertices) remain in their block, but within each block they are
+    //          ordered by a traversal of the parent faces rather than by the index
+    //          of their parent, so the children of neighboring parent faces are
+    //          near each other in all three blocks.
+    //
+    //      "num threads": the number of threads over which the population of
+    //          each topological relation is distributed.  Child components are
+    //          only ever written by the parent component from which they originate,
+    //          so the result is independent of the number of threads.
+    //
     //  These are strictly controlled right now, e.g. for sparse refinement, we
     //  currently enforce full topology at the finest level to allow for subsequent
     //  patch construction.
@@ -107,12 +118,16 @@ public:
     struct Options {
         Options() : _sparse(false),
                     _faceVertsFirst(false),
-                    _minimalTopology(false)
+                    _orderVertsByFaces(false),
+                    _minimalTopology(false),
+                    _numThreads(0)
                     { }
 
-        unsigned int _sparse          : 1;
-        unsigned int _faceVertsFirst  : 1;
-        unsigned int _minimalTopology : 1;
+        unsigned int _sparse            : 1;
+        unsigned int _faceVertsFirst    : 1;
+        unsigned int _orderVertsByFaces : 1;
+        unsigned int _minimalTopology   : 1;
+        unsigned int _numThreads        : 8;
 
         //  Still under consideration:
         //unsigned int _childToParentMap : 1;
@@ -120,8 +135,26 @@ public:
 
     void refine(Options options = Options());
 
+    //  Populate the child relations suppressed by refinement with minimal topology,
+    //  i.e. when the full topology of the child is later required after all:
+    void populateMissingChildRelations();
+
     bool hasFaceVerticesFirst() const { return _faceVertsFirst; }
 
+    //  Serialization of the refinement, its child Level and face-varying refinements
+    //  to/from a flat binary buffer -- reading expects a newly constructed refinement
+    //  whose parent Level has been fully read:
+    void write(BinaryWriter & stream) const;
+    bool read(BinaryReader & stream);
+
+    //  Number of bytes allocated by the refinement and its face-varying channels
+    //  (excluding the child Level):
+    virtual size_t getMemoryUsage() const;
+
+    //  Release all parent-child mappings and tags (of the refinement and its face-
+    //  varying channels) while retaining the counts of child components:
+    virtual void releaseMappings();
+
 public:
     //
     //  Access to members -- some testing classes (involving vertex interpolation)
@@ -240,6 +273,10 @@ public:
 
     void initializeChildComponentCounts();
 
+    //  Reserve memory for the child (when allocated from an Arena) once its
+    //  component counts are known:
+    void reserveChildStorage(Options refineOptions);
+
     //
     //  Methods involved in constructing the child-to-parent mapping:
     //
@@ -310,8 +347,8 @@ public:
     //
     void subdivideSharpnessValues();
 
-    void subdivideVertexSharpness();
-    void subdivideEdgeSharpness();
+    bool subdivideVertexSharpness();
+    bool subdivideEdgeSharpness();
     void reclassifySemisharpVertices();
 
     //
@@ -340,6 +377,8 @@ protected:
     //  Determined by the refinement options:
     bool _uniform;
     bool _faceVertsFirst;
+    bool _orderVertsByFaces;
+    int  _numThreads;
 
     //
     //  Inventory and ordering of the types of child components:
@@ -366,40 +405,36 @@ protected:
     //  that have not spawned all child components will have their missing children
     //  marked as invalid.
     //
-    //  NOTE the "Array" members here.  Often vectors within the Level can be shared
-    //  with the Refinement, and an Array instance is used to do so.  If not shared
-    //  the subclass just initializes the Array members after allocating its own local
-    //  vector members.
+    //  The counts and offsets of the face-child-faces and face-child-edges are
+    //  not stored:  they match the face-verts of the parent, except for the
+    //  child faces of a triangle split, which are always 4 per face.
     //
-    IndexArray _faceChildFaceCountsAndOffsets;
-    IndexArray _faceChildEdgeCountsAndOffsets;
-
-    IndexVector _faceChildFaceIndices;  // *cannot* always use face-vert counts/offsets
-    IndexVector _faceChildEdgeIndices;  // can use face-vert counts/offsets
-    IndexVector _faceChildVertIndex;
+    ArenaVector<Index> _faceChildFaceIndices;  // 4 per face if split to tris
+    ArenaVector<Index> _faceChildEdgeIndices;  // uses face-vert counts/offsets
+    ArenaVector<Index> _faceChildVertIndex;
 
-    IndexVector _edgeChildEdgeIndices;  // trivial/corresponding pair for each
-    IndexVector _edgeChildVertIndex;
+    ArenaVector<Index> _edgeChildEdgeIndices;  // trivial/corresponding pair for each
+    ArenaVector<Index> _edgeChildVertIndex;
 
-    IndexVector _vertChildVertIndex;
+    ArenaVector<Index> _vertChildVertIndex;
 
     //
     //  The child-to-parent mapping:
     //
-    IndexVector _childFaceParentIndex;
-    IndexVector _childEdgeParentIndex;
-    IndexVector _childVertexParentIndex;
+    ArenaVector<Index> _childFaceParentIndex;
+    ArenaVector<Index> _childEdgeParentIndex;
+    ArenaVector<Index> _childVertexParentIndex;
 
-    std::vector<ChildTag> _childFaceTag;
-    std::vector<ChildTag> _childEdgeTag;
-    std::vector<ChildTag> _childVertexTag;
+    ArenaVector<ChildTag> _childFaceTag;
+    ArenaVector<ChildTag> _childEdgeTag;
+    ArenaVector<ChildTag> _childVertexTag;
 
     //
     //  Tags for sparse selection of components:
     //
-    std::vector<SparseTag> _parentFaceTag;
-    std::vector<SparseTag> _parentEdgeTag;
-    std::vector<SparseTag> _parentVertexTag;
+    ArenaVector<SparseTag> _parentFaceTag;
+    ArenaVector<SparseTag> _parentEdgeTag;
+    ArenaVector<SparseTag> _parentVertexTag;
 
     //
     //  Refinement data for face-varying channels present in the Levels being refined:
@@ -410,28 +445,34 @@ protected:
 inline ConstIndexArray
 Refinement::getFaceChildFaces(Index parentFace) const {
 
-    return ConstIndexArray(&_faceChildFaceIndices[_faceChildFaceCountsAndOffsets[2*parentFace+1]],
-                                             _faceChildFaceCountsAndOffsets[2*parentFace]);
+    if (_splitType == Sdc::SPLIT_TO_TRIS) {
+        return ConstIndexArray(&_faceChildFaceIndices[4*parentFace], 4);
+    }
+    return ConstIndexArray(&_faceChildFaceIndices[_parent->getOffsetOfFaceVertices(parentFace)],
+                                             _parent->getNumFaceVertices(parentFace));
 }
 
 inline IndexArray
 Refinement::getFaceChildFaces(Index parentFace) {
 
-    return IndexArray(&_faceChildFaceIndices[_faceChildFaceCountsAndOffsets[2*parentFace+1]],
-                                             _faceChildFaceCountsAndOffsets[2*parentFace]);
+    if (_splitType == Sdc::SPLIT_TO_TRIS) {
+        return IndexArray(&_faceChildFaceIndices[4*parentFace], 4);
+    }
+    return IndexArray(&_faceChildFaceIndices[_parent->getOffsetOfFaceVertices(parentFace)],
+                                             _parent->getNumFaceVertices(parentFace));
 }
 
 inline ConstIndexArray
 Refinement::getFaceChildEdges(Index parentFace) const {
 
-    return ConstIndexArray(&_faceChildEdgeIndices[_faceChildEdgeCountsAndOffsets[2*parentFace+1]],
-                                             _faceChildEdgeCountsAndOffsets[2*parentFace]);
+    return ConstIndexArray(&_faceChildEdgeIndices[_parent->getOffsetOfFaceVertices(parentFace)],
+                                             _parent->getNumFaceVertices(parentFace));
 }
 inline IndexArray
 Refinement::getFaceChildEdges(Index parentFace) {
 
-    return IndexArray(&_faceChildEdgeIndices[_faceChildEdgeCountsAndOffsets[2*parentFace+1]],
-                                             _faceChildEdgeCountsAndOffsets[2*parentFace]);
+    return IndexArray(&_faceChildEdgeIndices[_parent->getOffsetOfFaceVertices(parentFace)],
+                                             _parent->getNumFaceVertices(parentFace));
 }
 
 inline ConstIndexArray
@@ -0,0 +1,135 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../vtr/stackBuffer.h"
+
+#include <cstring>
+#include <new>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Vtr {
+namespace internal {
+
+//
+//  The cache of blocks is kept per thread, which requires thread-local storage
+//  (C++11), otherwise blocks are always allocated and released directly:
+//
+#if (__cplusplus >= 201103L) || (defined(_MSC_VER) && (_MSC_VER >= 1900))
+    #define VTR_HAS_SCRATCH_CACHE
+#endif
+
+namespace {
+#ifdef VTR_HAS_SCRATCH_CACHE
+    //
+    //  Blocks are cached in power-of-two size classes from 64 bytes to 64 KB,
+    //  retaining a few blocks of each class so that nested StackBuffers of
+    //  similar size are served from the cache (retaining at most 512 KB per
+    //  thread).  Larger blocks are allocated and released directly:
+    //
+    int const MIN_SCRATCH_CLASS   = 6;
+    int const MAX_SCRATCH_CLASS   = 16;
+    int const NUM_SCRATCH_CLASSES = MAX_SCRATCH_CLASS - MIN_SCRATCH_CLASS + 1;
+    int const MAX_CACHED_BLOCKS   = 4;
+
+    class ScratchCache {
+    public:
+        ScratchCache() {
+            std::memset(_numBlocks, 0, sizeof(_numBlocks));
+        }
+        ~ScratchCache() {
+            for (int i = 0; i < NUM_SCRATCH_CLASSES; ++i) {
+                for (int j = 0; j < _numBlocks[i]; ++j) {
+                    ::operator delete(_blocks[i][j]);
+                }
+            }
+        }
+
+        void * pop(int sizeClass) {
+            int & n = _numBlocks[sizeClass - MIN_SCRATCH_CLASS];
+            return n ? _blocks[sizeClass - MIN_SCRATCH_CLASS][--n] : 0;
+        }
+        bool push(int sizeClass, void * block) {
+            int & n = _numBlocks[sizeClass - MIN_SCRATCH_CLASS];
+            if (n == MAX_CACHED_BLOCKS) return false;
+            _blocks[sizeClass - MIN_SCRATCH_CLASS][n++] = block;
+            return true;
+        }
+
+    private:
+        void * _blocks[NUM_SCRATCH_CLASSES][MAX_CACHED_BLOCKS];
+        int    _numBlocks[NUM_SCRATCH_CLASSES];
+    };
+
+    thread_local ScratchCache scratchCache;
+
+    inline int
+    getScratchClass(size_t size) {
+        int sizeClass = MIN_SCRATCH_CLASS;
+        while (((size_t)1 << sizeClass) < size) ++sizeClass;
+        return sizeClass;
+    }
+#endif
+}
+
+void *
+allocateScratch(size_t & size) {
+
+#ifdef VTR_HAS_SCRATCH_CACHE
+    if (size > ((size_t)1 << MAX_SCRATCH_CLASS)) {
+        return ::operator new(size);
+    }
+
+    int sizeClass = getScratchClass(size);
+    size = (size_t)1 << sizeClass;
+
+    void * block = scratchCache.pop(sizeClass);
+    return block ? block : ::operator new(size);
+#else
+    return ::operator new(size);
+#endif
+}
+
+void
+deallocateScratch(void * block, size_t size) {
+
+#ifdef VTR_HAS_SCRATCH_CACHE
+    //  The size given may be less than that of the block when truncated to
+    //  a whole number of elements, but remains within the same class:
+    if ((size > ((size_t)1 << MAX_SCRATCH_CLASS)) ||
+            !scratchCache.push(getScratchClass(size), block)) {
+        ::operator delete(block);
+    }
+#else
+    (void) size;
+    ::operator delete(block);
+#endif
+}
+
+} // end namespace internal
+} // end namespace Vtr
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
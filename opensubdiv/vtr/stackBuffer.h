@@ -26,6 +26,8 @@
 
 #include "../version.h"
 
+#include <cstddef>
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
@@ -45,6 +47,19 @@ namespace internal {
 //  Support for resizing is available to reuse an instance at the beginning of a
 //  loop with a new size, but resizing in this case reinitializes all elements.
 //
+//  Memory exceeding the static SIZE is taken from a small cache of blocks local
+//  to each thread rather than from the heap, so that the large neighborhoods of
+//  high valence vertices do not repeatedly allocate (nor contend for the heap
+//  when refinement and the factories are run in parallel).
+//
+
+//
+//  Allocation from the scratch cache of the calling thread (see stackBuffer.cpp)
+//  -- the size allocated is rounded up and returned, and must be given when the
+//  block is released (by any thread):
+//
+void * allocateScratch(size_t & size);
+void   deallocateScratch(void * block, size_t size);
 
 template <typename TYPE, unsigned int SIZE, bool POD_TYPE = false>
 class StackBuffer
@@ -101,20 +116,25 @@ template <typename TYPE, unsigned int SIZE, bool POD_TYPE>
 inline void
 StackBuffer<TYPE,SIZE,POD_TYPE>::allocate(size_type capacity) {
 
-    //  Again, is alignment an issue here?  C++ spec says new will return pointer
-    //  "suitably aligned" for conversion to pointers of other types, which implies
-    //  at least an alignment of 16.
-    _dynamicData = static_cast<char*>(::operator new(capacity * sizeof(TYPE)));
+    //  Again, is alignment an issue here?  Scratch blocks are allocated with new,
+    //  which the C++ spec says will return pointer "suitably aligned" for
+    //  conversion to pointers of other types, which implies at least an
+    //  alignment of 16.  The rounded size of the block extends the capacity:
+    size_t size = capacity * sizeof(TYPE);
+    _dynamicData = static_cast<char*>(allocateScratch(size));
 
     _data = reinterpret_cast<TYPE*>(_dynamicData);
-    _capacity = capacity;
+    _capacity = static_cast<size_type>(size / sizeof(TYPE));
 }
 
 template <typename TYPE, unsigned int SIZE, bool POD_TYPE>
 inline void
 StackBuffer<TYPE,SIZE,POD_TYPE>::deallocate() {
 
-    ::operator delete(_dynamicData);
+    if (_dynamicData) {
+        deallocateScratch(_dynamicData, _capacity * sizeof(TYPE));
+        _dynamicData = 0;
+    }
 
     _data = reinterpret_cast<TYPE*>(_staticData);
     _capacity = SIZE;
@@ -77,22 +77,6 @@ TriRefinement::allocateParentChildIndices() {
     int edgeChildVertCount = _parent->getNumEdges();
     int vertChildVertCount = _parent->getNumVertices();
 
-    //
-    //  First initialize the count/offset vectors for the child-faces and child-edges of
-    //  parent faces.  For now we can use the parent's face-vert counts for the child-edges
-    //  of faces, but we must use a local vector for the child-faces.
-    //
-    //  This will be more necessary (and need adjustment) when N-sided faces are supported.
-    //
-    _localFaceChildFaceCountsAndOffsets.resize(_parent->getNumFaces() * 2, 4);
-    for (int i = 0; i < _parent->getNumFaces(); ++i) {
-        _localFaceChildFaceCountsAndOffsets[i*2 + 1] = 4 * i;
-    }
-
-    _faceChildFaceCountsAndOffsets = IndexArray(&_localFaceChildFaceCountsAndOffsets[0],
-                                                (int)_localFaceChildFaceCountsAndOffsets.size());
-    _faceChildEdgeCountsAndOffsets = _parent->shareFaceVertCountsAndOffsets();
-
     //
     //  Given we will be ignoring initial values with uniform refinement and assigning all
     //  directly, initializing here is a waste...
@@ -116,31 +100,22 @@ TriRefinement::allocateParentChildIndices() {
 void
 TriRefinement::populateFaceVertexRelation() {
 
-    //  Both face-vertex and face-edge share the face-vertex counts/offsets within a
-    //  Level, so be sure not to re-initialize it if already done:
+    //  All child faces are triangles, so the face-vertex counts/offsets (shared by face-edges)
+    //  are implicit and need not be populated:
     //
-    if (_child->_faceVertCountsAndOffsets.size() == 0) {
-        populateFaceVertexCountsAndOffsets();
-    }
+    _child->_regFaceSize = 3;
     _child->_faceVertIndices.resize(_child->getNumFaces() * 3);
 
     populateFaceVerticesFromParentFaces();
 }
 
-void
-TriRefinement::populateFaceVertexCountsAndOffsets() {
-
-    _child->_faceVertCountsAndOffsets.resize(_child->getNumFaces() * 2, 3);
-
-    for (int i = 0; i < _child->getNumFaces(); ++i) {
-        _child->_faceVertCountsAndOffsets[i*2 + 1] = i * 3;
-    }
-}
-
 void
 TriRefinement::populateFaceVerticesFromParentFaces() {
 
-   for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
+    for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
         ConstIndexArray pFaceVerts = _parent->getFaceVertices(pFace),
                         pFaceEdges = _parent->getFaceEdges(pFace),
                         pFaceChildren = getFaceChildFaces(pFace);
@@ -202,12 +177,10 @@ TriRefinement::populateFaceVerticesFromParentFaces() {
 void
 TriRefinement::populateFaceEdgeRelation() {
 
-    //  Both face-vertex and face-edge share the face-vertex counts/offsets, so be sure
-    //  not to re-initialize it if already done:
+    //  All child faces are triangles, so the face-vertex counts/offsets (shared by face-edges)
+    //  are implicit and need not be populated:
     //
-    if (_child->_faceVertCountsAndOffsets.size() == 0) {
-        populateFaceVertexCountsAndOffsets();
-    }
+    _child->_regFaceSize = 3;
     _child->_faceEdgeIndices.resize(_child->getNumFaces() * 3);
 
     populateFaceEdgesFromParentFaces();
@@ -216,6 +189,9 @@ TriRefinement::populateFaceEdgeRelation() {
 void
 TriRefinement::populateFaceEdgesFromParentFaces() {
 
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
     for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
         ConstIndexArray pFaceVerts = _parent->getFaceVertices(pFace),
                         pFaceEdges = _parent->getFaceEdges(pFace),
@@ -288,6 +264,9 @@ TriRefinement::populateEdgeVertexRelation() {
 void
 TriRefinement::populateEdgeVerticesFromParentFaces() {
 
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
     for (Index pFace = 0; pFace < _parent->getNumFaces(); ++pFace) {
         ConstIndexArray pFaceEdges      = _parent->getFaceEdges(pFace),
                         pFaceChildEdges = getFaceChildEdges(pFace);
@@ -324,6 +303,9 @@ TriRefinement::populateEdgeVerticesFromParentFaces() {
 void
 TriRefinement::populateEdgeVerticesFromParentEdges() {
 
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for if (_numThreads > 1) num_threads(_numThreads)
+#endif
     for (Index pEdge = 0; pEdge < _parent->getNumEdges(); ++pEdge) {
         ConstIndexArray pEdgeVerts      = _parent->getEdgeVertices(pEdge),
                         pEdgeChildEdges = getEdgeChildEdges(pEdge);
@@ -502,6 +484,7 @@ TriRefinement::populateEdgeFacesFromParentEdges() {
 //      - sparse refinement poses challenges with allocation here:
 //          - we need to update the counts/offsets as we populate
 //          - note this imposes ordering constraints and inhibits concurrency
+//          - so child vertices are visited in order rather than their parents
 //
 void
 TriRefinement::populateVertexFaceRelation() {
@@ -538,9 +521,10 @@ TriRefinement::populateVertexFaceRelation() {
 void
 TriRefinement::populateVertexFacesFromParentEdges() {
 
-    for (Index pEdge = 0; pEdge < _parent->getNumEdges(); ++pEdge) {
-        Index cVert = _edgeChildVertIndex[pEdge];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromEdges();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromEdges();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pEdge = _childVertexParentIndex[cVert];
 
         ConstIndexArray      pEdgeFaces  = _parent->getEdgeFaces(pEdge);
         ConstLocalIndexArray pEdgeInFace = _parent->getEdgeFaceLocalIndices(pEdge);
@@ -606,9 +590,10 @@ TriRefinement::populateVertexFacesFromParentEdges() {
 void
 TriRefinement::populateVertexFacesFromParentVertices() {
 
-    for (Index pVert = 0; pVert < _parent->getNumVertices(); ++pVert) {
-        Index cVert = _vertChildVertIndex[pVert];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromVertices();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromVertices();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pVert = _childVertexParentIndex[cVert];
 
         //
         //  Inspect the parent vert's faces:
@@ -647,6 +632,7 @@ TriRefinement::populateVertexFacesFromParentVertices() {
 //      - sparse refinement poses challenges with allocation here:
 //          - we need to update the counts/offsets as we populate
 //          - note this imposes ordering constraints and inhibits concurrency
+//          - so child vertices are visited in order rather than their parents
 //
 void
 TriRefinement::populateVertexEdgeRelation() {
@@ -698,9 +684,10 @@ TriRefinement::populateVertexEdgeRelation() {
 void
 TriRefinement::populateVertexEdgesFromParentEdges() {
 
-    for (Index pEdge = 0; pEdge < _parent->getNumEdges(); ++pEdge) {
-        Index cVert = _edgeChildVertIndex[pEdge];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromEdges();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromEdges();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pEdge = _childVertexParentIndex[cVert];
 
         //
         //  First inspect the parent edge -- its parent faces then its child edges:
@@ -791,9 +778,10 @@ TriRefinement::populateVertexEdgesFromParentEdges() {
 void
 TriRefinement::populateVertexEdgesFromParentVertices() {
 
-    for (Index pVert = 0; pVert < _parent->getNumVertices(); ++pVert) {
-        Index cVert = _vertChildVertIndex[pVert];
-        if (!IndexIsValid(cVert)) continue;
+    Index cVertBegin = getFirstChildVertexFromVertices();
+    Index cVertEnd   = cVertBegin + getNumChildVerticesFromVertices();
+    for (Index cVert = cVertBegin; cVert < cVertEnd; ++cVert) {
+        Index pVert = _childVertexParentIndex[cVert];
 
         //
         //  Inspect the parent vert's edges first:
@@ -0,0 +1,322 @@
+//
+//   Copyright 2013 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef HBR_FAR_UTILS_H
+#define HBR_FAR_UTILS_H
+
+#include "hbr_utils.h"
+
+#include <opensubdiv/far/topologyRefinerFactory.h>
+#include <opensubdiv/far/error.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+//------------------------------------------------------------------------------
+//
+//  Factory constructing TopologyRefiners directly from the coarse faces of an
+//  HbrMesh, without an intermediate Shape.
+//
+//  Member specializations of TopologyRefinerFactory<MESH> cannot be partial, so
+//  the factory for HbrMesh<T> derives from it and assembles the base level with
+//  its own methods, using the protected base level accessors of its parent.
+//
+//  Face-vertices are assigned from the Hbr faces and the remaining relations
+//  completed by Vtr (in parallel when requested), after which the sharpness of
+//  Hbr edges and vertices and the holes of Hbr faces are assigned directly.
+//  Base vertices are indexed by Hbr vertex ID, except for the vertices Hbr
+//  splits from non-manifold vertices, which are merged back with the vertex
+//  they were split from.  Neither face-varying data nor hierarchical edits are
+//  converted.
+//
+template <class T>
+class HbrTopologyRefinerFactory : public TopologyRefinerFactory< HbrMesh<T> > {
+
+public:
+    typedef HbrMesh<T>                          Mesh;
+    typedef TopologyRefinerFactory< HbrMesh<T> > Base;
+    typedef typename Base::Options              Options;
+
+    //  Scheme and options matching the subdivision rules of the mesh
+    static Sdc::SchemeType GetSchemeType(Mesh const & mesh);
+    static Sdc::Options GetSchemeOptions(Mesh const & mesh);
+
+    static TopologyRefiner * Create(Mesh const & mesh) {
+        return Create(mesh, Options(GetSchemeType(mesh), GetSchemeOptions(mesh)));
+    }
+
+    static TopologyRefiner * Create(Mesh const & mesh, Options options);
+
+protected:
+    //  Base vertex of each Hbr vertex ID, returning the number of base vertices
+    static int getBaseVertexIndices(Mesh const & mesh, std::vector<Index> & indices);
+
+    static bool resizeComponentTopology(TopologyRefiner & refiner, Mesh const & mesh,
+                                        int numBaseVertices);
+    static bool assignComponentTopology(TopologyRefiner & refiner, Mesh const & mesh,
+                                        Index const * baseVertexIndices, int numThreads);
+    static bool assignComponentTags(TopologyRefiner & refiner, Mesh const & mesh,
+                                    Index const * baseVertexIndices, int numThreads);
+
+    static void reportInvalidTopology(typename Base::TopologyError errCode,
+                                      char const * msg, Mesh const & mesh);
+};
+
+template <class T>
+Sdc::SchemeType
+HbrTopologyRefinerFactory<T>::GetSchemeType(Mesh const & mesh) {
+
+    HbrSubdivision<T> * subdivision = mesh.GetSubdivision();
+
+    if (dynamic_cast<HbrLoopSubdivision<T> *>(subdivision)) {
+        return Sdc::SCHEME_LOOP;
+    } else if (dynamic_cast<HbrBilinearSubdivision<T> *>(subdivision)) {
+        return Sdc::SCHEME_BILINEAR;
+    }
+    return Sdc::SCHEME_CATMARK;
+}
+
+template <class T>
+Sdc::Options
+HbrTopologyRefinerFactory<T>::GetSchemeOptions(Mesh const & mesh) {
+
+    Sdc::Options result;
+
+    switch (mesh.GetInterpolateBoundaryMethod()) {
+        case Mesh::k_InterpolateBoundaryNone:
+            result.SetVtxBoundaryInterpolation(Sdc::Options::VTX_BOUNDARY_NONE);
+            break;
+        case Mesh::k_InterpolateBoundaryEdgeOnly:
+            result.SetVtxBoundaryInterpolation(Sdc::Options::VTX_BOUNDARY_EDGE_ONLY);
+            break;
+        default:
+            result.SetVtxBoundaryInterpolation(Sdc::Options::VTX_BOUNDARY_EDGE_AND_CORNER);
+            break;
+    }
+
+    HbrSubdivision<T> * subdivision = mesh.GetSubdivision();
+    if (subdivision && (subdivision->GetCreaseSubdivisionMethod() ==
+                        HbrSubdivision<T>::k_CreaseChaikin)) {
+        result.SetCreasingMethod(Sdc::Options::CREASE_CHAIKIN);
+    } else {
+        result.SetCreasingMethod(Sdc::Options::CREASE_UNIFORM);
+    }
+
+    HbrCatmarkSubdivision<T> * catmark =
+        dynamic_cast<HbrCatmarkSubdivision<T> *>(subdivision);
+    if (catmark && (catmark->GetTriangleSubdivisionMethod() ==
+                    HbrCatmarkSubdivision<T>::k_New)) {
+        result.SetTriangleSubdivision(Sdc::Options::TRI_SUB_SMOOTH);
+    } else {
+        result.SetTriangleSubdivision(Sdc::Options::TRI_SUB_CATMARK);
+    }
+    return result;
+}
+
+template <class T>
+TopologyRefiner *
+HbrTopologyRefinerFactory<T>::Create(Mesh const & mesh, Options options) {
+
+    TopologyRefiner * refiner =
+        new TopologyRefiner(options.schemeType, options.schemeOptions);
+
+    //  The same sequence of steps as TopologyRefinerFactory<MESH>::Create(),
+    //  without face-varying channels:
+    int numThreads = options.numThreads;
+
+    std::vector<Index> baseVertexIndices;
+    int numBaseVertices = getBaseVertexIndices(mesh, baseVertexIndices);
+    Index const * vertexIndices = baseVertexIndices.empty() ? 0 : &baseVertexIndices[0];
+
+    typename Base::TopologyCallback callback =
+        reinterpret_cast<typename Base::TopologyCallback>(reportInvalidTopology);
+
+    if (! resizeComponentTopology(*refiner, mesh, numBaseVertices) ||
+        ! Base::prepareComponentTopologySizing(*refiner) ||
+        ! assignComponentTopology(*refiner, mesh, vertexIndices, numThreads) ||
+        ! Base::prepareComponentTopologyAssignment(*refiner,
+                options.validateFullTopology, callback, &mesh, numThreads) ||
+        ! assignComponentTags(*refiner, mesh, vertexIndices, numThreads) ||
+        ! Base::prepareComponentTagsAndSharpness(*refiner) ||
+        ! Base::prepareFaceVaryingChannels(*refiner)) {
+        delete refiner;
+        return 0;
+    }
+    return refiner;
+}
+
+template <class T>
+int
+HbrTopologyRefinerFactory<T>::getBaseVertexIndices(Mesh const & mesh,
+                                                   std::vector<Index> & indices) {
+
+    //  Without refinement all vertices are coarse (including those that are
+    //  disconnected), otherwise only those of the coarse faces are known to be:
+    int numFaces = mesh.GetNumCoarseFaces();
+    int numVertexIDs = 0;
+    if (numFaces == mesh.GetNumFaces()) {
+        numVertexIDs = mesh.GetNumVertices();
+    } else {
+        for (int i = 0; i < numFaces; ++i) {
+            HbrFace<T> * face = mesh.GetFace(i);
+            for (int j = 0; j < face->GetNumVertices(); ++j) {
+                numVertexIDs = std::max(numVertexIDs, face->GetVertex(j)->GetID() + 1);
+            }
+        }
+    }
+
+    indices.resize(numVertexIDs);
+    for (int i = 0; i < numVertexIDs; ++i) {
+        indices[i] = i;
+    }
+
+    //  Split vertices are created after all others, so their IDs are last:
+    int numSplitVertices = 0;
+#ifdef HBR_ADAPTIVE
+    std::vector<std::pair<int, int> > const & splitVertices = mesh.GetSplitVertices();
+    for (int i = 0; i < (int)splitVertices.size(); ++i) {
+        if (splitVertices[i].first < numVertexIDs) {
+            indices[splitVertices[i].first] = splitVertices[i].second;
+            ++numSplitVertices;
+        }
+    }
+#endif
+    return numVertexIDs - numSplitVertices;
+}
+
+template <class T>
+bool
+HbrTopologyRefinerFactory<T>::resizeComponentTopology(
+    TopologyRefiner & refiner, Mesh const & mesh, int numBaseVertices) {
+
+    int numFaces = mesh.GetNumCoarseFaces();
+
+    Base::setNumBaseFaces(refiner, numFaces);
+    for (int i = 0; i < numFaces; ++i) {
+        Base::setNumBaseFaceVertices(refiner, i, mesh.GetFace(i)->GetNumVertices());
+    }
+    Base::setNumBaseVertices(refiner, numBaseVertices);
+    return true;
+}
+
+template <class T>
+bool
+HbrTopologyRefinerFactory<T>::assignComponentTopology(
+    TopologyRefiner & refiner, Mesh const & mesh,
+    Index const * baseVertexIndices, int numThreads) {
+
+    int numFaces = Base::getNumBaseFaces(refiner);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    numThreads = std::max(1, numThreads);
+    #pragma omp parallel for num_threads(numThreads) if (numThreads > 1) \
+                             schedule(dynamic, 1024)
+#else
+    (void)numThreads;
+#endif
+    for (int i = 0; i < numFaces; ++i) {
+        HbrFace<T> * face = mesh.GetFace(i);
+
+        IndexArray dstFaceVerts = Base::getBaseFaceVertices(refiner, i);
+        for (int j = 0; j < dstFaceVerts.size(); ++j) {
+            dstFaceVerts[j] = baseVertexIndices[face->GetVertex(j)->GetID()];
+        }
+    }
+    return true;
+}
+
+template <class T>
+bool
+HbrTopologyRefinerFactory<T>::assignComponentTags(
+    TopologyRefiner & refiner, Mesh const & mesh,
+    Index const * baseVertexIndices, int numThreads) {
+
+    //
+    //  Each edge is sharpened once from the half-edge of the face with the
+    //  lower ID, so faces can be processed independently.  Holes also tag the
+    //  refiner as a whole and are assigned serially:
+    //
+    int numFaces = Base::getNumBaseFaces(refiner);
+    int numVerts = Base::getNumBaseVertices(refiner);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    numThreads = std::max(1, numThreads);
+    #pragma omp parallel for num_threads(numThreads) if (numThreads > 1) \
+                             schedule(dynamic, 1024)
+#else
+    (void)numThreads;
+#endif
+    for (int i = 0; i < numFaces; ++i) {
+        HbrFace<T> * face = mesh.GetFace(i);
+
+        for (int j = 0; j < face->GetNumVertices(); ++j) {
+            HbrHalfedge<T> * edge = face->GetEdge(j);
+            if (edge->GetSharpness() <= 0.0f) continue;
+
+            HbrHalfedge<T> * opposite = edge->GetOpposite();
+            if (opposite && (opposite->GetFace()->GetID() < i)) continue;
+
+            Index e = Base::findBaseEdge(refiner,
+                baseVertexIndices[edge->GetOrgVertex()->GetID()],
+                baseVertexIndices[edge->GetDestVertex()->GetID()]);
+            if (e != INDEX_INVALID) {
+                Base::setBaseEdgeSharpness(refiner, e, edge->GetSharpness());
+            }
+        }
+    }
+
+    for (int i = 0; i < numFaces; ++i) {
+        if (mesh.GetFace(i)->IsHole()) {
+            Base::setBaseFaceHole(refiner, i, true);
+        }
+    }
+
+    for (int i = 0; i < numVerts; ++i) {
+        HbrVertex<T> * vertex = mesh.GetVertex(i);
+        if (vertex && (vertex->GetSharpness() > 0.0f)) {
+            Base::setBaseVertexSharpness(refiner, i, vertex->GetSharpness());
+        }
+    }
+    return true;
+}
+
+template <class T>
+void
+HbrTopologyRefinerFactory<T>::reportInvalidTopology(
+    typename Base::TopologyError /* errCode */, char const * msg,
+    Mesh const & /* mesh */) {
+    Warning(msg);
+}
+
+} // namespace Far
+
+} // namespace OPENSUBDIV_VERSION
+} // namespace OpenSubdiv
+
+#endif /* HBR_FAR_UTILS_H */
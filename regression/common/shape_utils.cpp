@@ -28,6 +28,7 @@
 #include <cassert>
 #include <cstdio>
 #include <cstring>
+#include <cstdlib>
 #include <iterator>
 #include <fstream>
 #include <sstream>
@@ -60,6 +61,72 @@ Shape::~Shape() {
         delete mtls[i];
 }
 
+//------------------------------------------------------------------------------
+//
+//  The OBJ string is tokenized in place, a line at a time, with numbers never
+//  read beyond the end of their line.  Values are identical to those of the
+//  sscanf() "%f" and "%d" conversions (i.e. strtof() and strtol()).
+//
+static char const * lineEnd(char const * s) {
+    while (*s && *s != '\n') ++s;
+    return s;
+}
+
+//  Plain decimals whose digits fit the 24 bits of a float mantissa, and
+//  whose power of ten is exact in a float, are converted with a single
+//  (correctly rounded) multiplication or division -- the result is then
+//  that of strtof(), which handles all other numbers:
+static float parseFloat(char const * s, char ** end) {
+
+    static float const powersOf10[] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+    char const * cp = s;
+    while (*cp == ' ' || *cp == '\t') ++cp;
+
+    bool negative = (*cp == '-');
+    if (*cp == '-' || *cp == '+') ++cp;
+
+    unsigned long mantissa = 0;
+    int nDigits = 0, exponent = 0;
+    for ( ; *cp >= '0' && *cp <= '9'; ++cp, ++nDigits) {
+        mantissa = mantissa * 10 + (*cp - '0');
+    }
+    if (*cp == '.') {
+        for (++cp; *cp >= '0' && *cp <= '9'; ++cp, ++nDigits, --exponent) {
+            mantissa = mantissa * 10 + (*cp - '0');
+        }
+    }
+    if (nDigits == 0 || nDigits > 8 || mantissa >= (1ul << 24) ||
+        exponent < -10 || *cp == 'e' || *cp == 'E' ||
+                          *cp == 'x' || *cp == 'X') {
+        return strtof(s, end);
+    }
+    *end = const_cast<char *>(cp);
+
+    float value = exponent ? (float)mantissa / powersOf10[-exponent]
+                           : (float)mantissa;
+    return negative ? -value : value;
+}
+
+static bool parseFloats(char const * s, char const * eol, int n, float * values) {
+    for (int i=0; i<n; ++i) {
+        char * end;
+        values[i] = parseFloat(s, &end);
+        if (end == s || end > eol) return false;
+        s = end;
+    }
+    return true;
+}
+
+static bool parseInt(char const * & s, char const * eol, int & value) {
+    char * end;
+    value = (int)strtol(s, &end, 10);
+    if (end == s || end > eol) return false;
+    s = end;
+    return true;
+}
+
 //------------------------------------------------------------------------------
 Shape * Shape::parseObj(char const * shapestr, Scheme shapescheme, bool isLeftHanded,
                         bool parsemtl) {
@@ -69,44 +136,58 @@ Shape * Shape::parseObj(char const * shapestr, Scheme shapescheme, bool isLeftHa
     s->scheme = shapescheme;
     s->isLeftHanded = isLeftHanded;
 
-    char * str=const_cast<char *>(shapestr), line[256], buf[256], usemtl=-1;
-    bool done = false;
-    while (! done) {
-        done = sgets(line, sizeof(line), &str)==0;
-        if (line[0]) {
-          char* end = &line[strlen(line)-1];
-          if (*end == '\n') *end = '\0'; // strip trailing nl
+    //  Count the vertices and faces to reserve the arrays:
+    int nverts = 0, nfaces = 0;
+    for (char const * line = shapestr; *line; ) {
+        if (line[1] == ' ') {
+            nverts += (line[0] == 'v');
+            nfaces += (line[0] == 'f');
         }
-        float x, y, z, u, v;
+        line = lineEnd(line);
+        if (*line) ++line;
+    }
+    s->verts.reserve(3 * nverts);
+    s->nvertsPerFace.reserve(nfaces);
+    s->faceverts.reserve(4 * nfaces);
+
+    char usemtl=-1;
+    std::string buf;
+
+    for (char const * line = shapestr; *line; ) {
+        char const * eol = lineEnd(line);
+
+        float v[3];
         switch (line[0]) {
             case 'v': switch (line[1]) {
-                          case ' ': if (sscanf(line, "v %f %f %f", &x, &y, &z) == 3) {
-                                         s->verts.push_back(x);
-                                         s->verts.push_back(y);
-                                         s->verts.push_back(z);
+                          case ' ': if (parseFloats(line+2, eol, 3, v)) {
+                                         s->verts.insert(s->verts.end(), v, v+3);
+                                    } break;
+                          case 't': if (parseFloats(line+2, eol, 2, v)) {
+                                        s->uvs.insert(s->uvs.end(), v, v+2);
                                     } break;
-                          case 't': if (sscanf(line, "vt %f %f", &u, &v) == 2) {
-                                        s->uvs.push_back(u);
-                                        s->uvs.push_back(v);
+                          case 'n': if (parseFloats(line+2, eol, 3, v)) {
+                                        s->normals.insert(s->normals.end(), v, v+3);
                                     } break;
-                          case 'n' : if (sscanf(line, "vn %f %f %f", &x, &y, &z) == 3) {
-                                        s->normals.push_back(x);
-                                        s->normals.push_back(y);
-                                        s->normals.push_back(z);
-                                     } break; // skip normals for now
                       } break;
             case 'f': if (line[1] == ' ') {
                           int vi, ti, ni;
-                          const char* cp = &line[2];
-                          while (*cp == ' ') cp++;
-                          int nverts = 0, nitems=0;
-                          while( (nitems=sscanf(cp, "%d/%d/%d", &vi, &ti, &ni))>0) {
+                          char const * cp = &line[2];
+                          int nverts = 0;
+                          for (;;) {
+                              while (*cp == ' ') cp++;
+                              if (! parseInt(cp, eol, vi)) break;
+                              int nitems = 1;
+                              if (*cp == '/' && parseInt(++cp, eol, ti)) {
+                                  nitems = 2;
+                                  if (*cp == '/' && parseInt(++cp, eol, ni)) {
+                                      nitems = 3;
+                                  }
+                              }
                               nverts++;
                               s->faceverts.push_back(vi-1);
                               if(nitems > 1) s->faceuvs.push_back(ti-1);
                               if(nitems > 2) s->facenormals.push_back(ni-1);
-                              while (*cp && *cp != ' ') cp++;
-                              while (*cp == ' ') cp++;
+                              while (cp < eol && *cp != ' ') cp++;
                           }
                           s->nvertsPerFace.push_back(nverts);
                           if (! s->mtls.empty()) {
@@ -114,25 +195,30 @@ Shape * Shape::parseObj(char const * shapestr, Scheme shapescheme, bool isLeftHa
                           }
                       } break;
             case 't' : if (line[1] == ' ') {
-                           Shape::tag * t = tag::parseTag( line );
+                           buf.assign(line, eol);
+                           Shape::tag * t = tag::parseTag( buf.c_str() );
                            if (t)
                                s->tags.push_back(t);
                        } break;
-            case 'u' : if (parsemtl && sscanf(line, "usemtl %s", buf)==1) {
-                           usemtl = s->FindMaterial(buf);
+            case 'u' : if (parsemtl) {
+                           buf.assign(line, eol);
+                           char name[256];
+                           if (sscanf(buf.c_str(), "usemtl %255s", name)==1) {
+                               usemtl = s->FindMaterial(name);
+                           }
                        } break;
-            case 'm' : if (parsemtl && sscanf(line, "mtllib %s", buf)==1) {
-                           std::ifstream ifs(buf);
-                           if (ifs) {
-                               std::stringstream ss;
-                               ss << ifs.rdbuf();
-                               ifs.close();
-                               std::string tmpStr = ss.str();
-                               s->parseMtllib(tmpStr.c_str());
-                               s->mtllib = buf;
+            case 'm' : if (parsemtl) {
+                           buf.assign(line, eol);
+                           char name[256];
+                           std::string mtlstr;
+                           if (sscanf(buf.c_str(), "mtllib %255s", name)==1 &&
+                               readShapeFile(name, mtlstr)) {
+                               s->parseMtllib(mtlstr.c_str());
+                               s->mtllib = name;
                            }
                        } break;
         }
+        line = *eol ? eol+1 : eol;
     }
     return s;
 }
@@ -390,3 +476,23 @@ std::string Shape::genRIB() const {
 
     return rib.str();
 }
+
+//------------------------------------------------------------------------------
+bool readShapeFile(char const * filename, std::string & data) {
+
+    FILE * f = fopen(filename, "rb");
+    if (! f) return false;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    bool success = (size >= 0);
+    if (success) {
+        data.resize((size_t)size);
+        success = (size == 0) ||
+                  (fread(&data[0], 1, (size_t)size, f) == (size_t)size);
+    }
+    fclose(f);
+    return success;
+}
@@ -135,4 +135,10 @@ struct Shape {
 
 //------------------------------------------------------------------------------
 
+//  Reads the whole content of a (e.g. OBJ) file into a string -- returns
+//  false if the file cannot be read
+bool readShapeFile(char const * filename, std::string & data);
+
+//------------------------------------------------------------------------------
+
 #endif /* SHAPE_UTILS_H */
@@ -22,6 +22,7 @@
 //   language governing permissions and limitations under the Apache License.
 //
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <fstream>
@@ -67,7 +68,11 @@ struct TestResult {
         timeRefine(0),
         timePatchFactory(0),
         timeStencilFactory(0),
-        timeAppendStencil(0) { }
+        timeAppendStencil(0),
+        memRefiner(0),
+        memPatchTable(0),
+        memStencilTable(0),
+        memPeak(0) { }
 
     std::string name;
     int level;
@@ -76,6 +81,63 @@ struct TestResult {
     double timePatchFactory;
     double timeStencilFactory;
     double timeAppendStencil;
+
+    //  Bytes retained by each of the resulting tables, and the peak of the
+    //  bytes retained by all tables alive at any stage of the test:
+    size_t memRefiner;
+    size_t memPatchTable;
+    size_t memStencilTable;
+    size_t memPeak;
+};
+
+//  Statistics of a timing over repeated runs of a test:
+struct TimeStats {
+    TimeStats() : min(0), mean(0), max(0) { }
+
+    void Accumulate(double t, int runIndex) {
+        if (runIndex == 0) {
+            min = max = mean = t;
+        } else {
+            min = std::min(min, t);
+            max = std::max(max, t);
+            mean += (t - mean) / (runIndex + 1);
+        }
+    }
+
+    double min;
+    double mean;
+    double max;
+};
+
+struct TestStats {
+    TestStats() : level(-1), numRuns(0) { }
+
+    void Accumulate(TestResult const & result) {
+        name  = result.name;
+        level = result.level;
+
+        total.Accumulate(result.timeTotal, numRuns);
+        refine.Accumulate(result.timeRefine, numRuns);
+        patchFactory.Accumulate(result.timePatchFactory, numRuns);
+        stencilFactory.Accumulate(result.timeStencilFactory, numRuns);
+        appendStencil.Accumulate(result.timeAppendStencil, numRuns);
+
+        //  Memory does not vary between runs -- keep that of the last:
+        memory = result;
+        ++numRuns;
+    }
+
+    std::string name;
+    int level;
+    int numRuns;
+
+    TimeStats total;
+    TimeStats refine;
+    TimeStats patchFactory;
+    TimeStats stencilFactory;
+    TimeStats appendStencil;
+
+    TestResult memory;
 };
 
 template <typename REAL>
@@ -117,6 +179,9 @@ RunPerfTest(Shape const & shape, TestOptions const & options) {
     s.Stop();
     result.timeRefine = s.GetElapsed();
 
+    result.memRefiner = refiner->GetMemoryUsage();
+    result.memPeak = result.memRefiner;
+
     // ----------------------------------------------------------------------
     // Create patch table
     Far::PatchTable const * patchTable = NULL;
@@ -125,6 +190,9 @@ RunPerfTest(Shape const & shape, TestOptions const & options) {
         patchTable = Far::PatchTableFactory::Create(*refiner, poptions);
         s.Stop();
         result.timePatchFactory = s.GetElapsed();
+
+        result.memPatchTable = patchTable->GetMemoryUsage();
+        result.memPeak = result.memRefiner + result.memPatchTable;
     } else {
         result.timePatchFactory = 0;
     }
@@ -140,6 +208,10 @@ RunPerfTest(Shape const & shape, TestOptions const & options) {
 
         s.Stop();
         result.timeStencilFactory = s.GetElapsed();
+
+        result.memStencilTable = vertexStencils->GetMemoryUsage();
+        result.memPeak = result.memRefiner + result.memPatchTable +
+                         result.memStencilTable;
     } else {
         result.timeStencilFactory = 0;
     }
@@ -153,12 +225,20 @@ RunPerfTest(Shape const & shape, TestOptions const & options) {
             FarStencilTableFactory::AppendLocalPointStencilTable(
                 *refiner, vertexStencils,
                 patchTable->GetLocalPointStencilTable<REAL>())) {
+            //  Both stencil tables are alive until the original is deleted:
+            result.memPeak = std::max(result.memPeak,
+                result.memRefiner + result.memPatchTable +
+                result.memStencilTable +
+                vertexStencilsWithLocalPoints->GetMemoryUsage());
+
             delete vertexStencils;
             vertexStencils = vertexStencilsWithLocalPoints;
         }
 
         s.Stop();
         result.timeAppendStencil = s.GetElapsed();
+
+        result.memStencilTable = vertexStencils->GetMemoryUsage();
     } else {
         result.timeAppendStencil = 0;
     }
@@ -178,25 +258,44 @@ RunPerfTest(Shape const & shape, TestOptions const & options) {
 struct PrintOptions {
     PrintOptions() :
         csvFormat(false),
+        jsonFormat(false),
         refineTime(true),
         patchTime(true),
         stencilTime(true),
         appendTime(true),
-        totalTime(true) { }
+        totalTime(true),
+        memory(true) { }
 
     bool csvFormat;
+    bool jsonFormat;
     bool refineTime;
     bool patchTime;
     bool stencilTime;
     bool appendTime;
     bool totalTime;
+    bool memory;
 };
 
+static char const * g_schemeNames[3] = { "bilinear", "catmark", "loop" };
+
+static char const *
+GetEndCapName(Far::PatchTableFactory::Options::EndCapType endCapType) {
+
+    switch (endCapType) {
+    case Far::PatchTableFactory::Options::ENDCAP_BILINEAR_BASIS:
+        return "linear";
+    case Far::PatchTableFactory::Options::ENDCAP_BSPLINE_BASIS:
+        return "regular";
+    case Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS:
+        return "gregory";
+    default:
+        return "other";
+    }
+}
+
 static void
 PrintShape(ShapeDesc const & shapeDesc, PrintOptions const & ) {
 
-    static char const * g_schemeNames[3] = { "bilinear", "catmark", "loop" };
-
     char const * shapeName   = shapeDesc.name.c_str();
     Scheme       shapeScheme = shapeDesc.scheme;
 
@@ -204,40 +303,66 @@ PrintShape(ShapeDesc const & shapeDesc, PrintOptions const & ) {
 }
 
 static void
-PrintResult(TestResult const & result, PrintOptions const & options) {
+PrintTime(char const * label, TimeStats const & time, double total,
+          int numRuns) {
+
+    if (numRuns > 1) {
+        printf("    %-27s %f %5.2f%%  (mean %f, max %f)\n", label,
+               time.min, time.min/total*100, time.mean, time.max);
+    } else {
+        printf("    %-27s %f %5.2f%%\n", label,
+               time.min, time.min/total*100);
+    }
+}
+
+static void
+PrintResult(TestStats const & stats, PrintOptions const & options) {
+
+    //  Times of repeated runs are reported as the minimum (with the mean
+    //  and maximum following):
+    double total = stats.total.min;
 
     //  If only printing the total, combine on same line as level:
     if (!options.refineTime  && !options.patchTime &&
-        !options.stencilTime && !options.appendTime) {
-        printf("  level %d:  %f\n", result.level, result.timeTotal);
+        !options.stencilTime && !options.appendTime && !options.memory) {
+        printf("  level %d:  %f\n", stats.level, total);
         return;
     }
 
-    printf("  level %d:\n", result.level);
+    printf("  level %d:\n", stats.level);
 
     if (options.refineTime) {
-        printf("    TopologyRefiner::Refine     %f %5.2f%%\n",
-               result.timeRefine,
-               result.timeRefine/result.timeTotal*100);
+        PrintTime("TopologyRefiner::Refine", stats.refine, total,
+                  stats.numRuns);
     }
     if (options.patchTime) {
-        printf("    PatchTableFactory::Create   %f %5.2f%%\n",
-               result.timePatchFactory,
-               result.timePatchFactory/result.timeTotal*100);
+        PrintTime("PatchTableFactory::Create", stats.patchFactory, total,
+                  stats.numRuns);
     }
     if (options.stencilTime) {
-        printf("    StencilTableFactory::Create %f %5.2f%%\n",
-               result.timeStencilFactory,
-               result.timeStencilFactory/result.timeTotal*100);
+        PrintTime("StencilTableFactory::Create", stats.stencilFactory, total,
+                  stats.numRuns);
     }
     if (options.appendTime) {
-        printf("    StencilTableFactory::Append %f %5.2f%%\n",
-               result.timeAppendStencil,
-               result.timeAppendStencil/result.timeTotal*100);
+        PrintTime("StencilTableFactory::Append", stats.appendStencil, total,
+                  stats.numRuns);
     }
     if (options.totalTime) {
-        printf("    Total                       %f\n",
-               result.timeTotal);
+        if (stats.numRuns > 1) {
+            printf("    Total                       %f  (mean %f, max %f)\n",
+                   stats.total.min, stats.total.mean, stats.total.max);
+        } else {
+            printf("    Total                       %f\n", total);
+        }
+    }
+    if (options.memory) {
+        TestResult const & mem = stats.memory;
+        printf("    Memory (bytes)              refiner %lu, patches %lu, "
+               "stencils %lu, peak %lu\n",
+               (unsigned long) mem.memRefiner,
+               (unsigned long) mem.memPatchTable,
+               (unsigned long) mem.memStencilTable,
+               (unsigned long) mem.memPeak);
     }
 }
 
@@ -247,27 +372,121 @@ PrintHeaderCSV(PrintOptions const & options) {
     // spreadsheet header row
     printf("shape");
     printf(",level");
+    printf(",runs");
     if (options.refineTime)  printf(",refine");
     if (options.patchTime)   printf(",patch");
     if (options.stencilTime) printf(",stencilFactory");
     if (options.appendTime)  printf(",stencilAppend");
-    if (options.totalTime)   printf(",total");
+    if (options.totalTime)   printf(",total,totalMean,totalMax");
+    if (options.memory) {
+        printf(",memRefiner,memPatchTable,memStencilTable,memPeak");
+    }
     printf("\n");
 }
 static void
-PrintResultCSV(TestResult const & result, PrintOptions const & options) {
+PrintResultCSV(TestStats const & stats, PrintOptions const & options) {
 
     // spreadsheet data row
-    printf("%s",  result.name.c_str());
-    printf(",%d", result.level);
-    if (options.refineTime)  printf(",%f", result.timeRefine);
-    if (options.patchTime)   printf(",%f", result.timePatchFactory);
-    if (options.stencilTime) printf(",%f", result.timeStencilFactory);
-    if (options.appendTime)  printf(",%f", result.timeAppendStencil);
-    if (options.totalTime)   printf(",%f", result.timeTotal);
+    printf("%s",  stats.name.c_str());
+    printf(",%d", stats.level);
+    printf(",%d", stats.numRuns);
+    if (options.refineTime)  printf(",%f", stats.refine.min);
+    if (options.patchTime)   printf(",%f", stats.patchFactory.min);
+    if (options.stencilTime) printf(",%f", stats.stencilFactory.min);
+    if (options.appendTime)  printf(",%f", stats.appendStencil.min);
+    if (options.totalTime) {
+        printf(",%f,%f,%f", stats.total.min, stats.total.mean,
+                            stats.total.max);
+    }
+    if (options.memory) {
+        TestResult const & mem = stats.memory;
+        printf(",%lu,%lu,%lu,%lu", (unsigned long) mem.memRefiner,
+                                   (unsigned long) mem.memPatchTable,
+                                   (unsigned long) mem.memStencilTable,
+                                   (unsigned long) mem.memPeak);
+    }
     printf("\n");
 }
 
+//
+//  JSON output -- a single object with the options of the run and an array
+//  of results (one per shape and level) intended to be archived and compared
+//  between releases:
+//
+static void
+PrintStringJSON(std::string const & str) {
+
+    printf("\"");
+    for (size_t i = 0; i < str.size(); ++i) {
+        char c = str[i];
+        if ((c == '"') || (c == '\\')) {
+            printf("\\%c", c);
+        } else if ((unsigned char)c < 0x20) {
+            printf("\\u%04x", (unsigned int)(unsigned char)c);
+        } else {
+            printf("%c", c);
+        }
+    }
+    printf("\"");
+}
+
+static void
+PrintTimeJSON(char const * label, TimeStats const & time, bool last = false) {
+
+    printf("        \"%s\": { \"min\": %f, \"mean\": %f, \"max\": %f }%s\n",
+           label, time.min, time.mean, time.max, last ? "" : ",");
+}
+
+static void
+PrintHeaderJSON(TestOptions const & testOptions, int numRuns,
+                bool runDouble) {
+
+    printf("{\n");
+    printf("  \"options\": {\n");
+    printf("    \"adaptive\": %s,\n", testOptions.refineAdaptive ? "true" : "false");
+    printf("    \"endCap\": \"%s\",\n", GetEndCapName(testOptions.endCapType));
+    printf("    \"precision\": \"%s\",\n", runDouble ? "double" : "float");
+    printf("    \"patches\": %s,\n", testOptions.createPatches ? "true" : "false");
+    printf("    \"stencils\": %s,\n", testOptions.createStencils ? "true" : "false");
+    printf("    \"runs\": %d\n", numRuns);
+    printf("  },\n");
+    printf("  \"results\": [");
+}
+
+static void
+PrintResultJSON(TestStats const & stats, ShapeDesc const & shapeDesc,
+                bool first) {
+
+    TestResult const & mem = stats.memory;
+
+    printf("%s\n    {\n", first ? "" : ",");
+    printf("      \"shape\": ");
+    PrintStringJSON(stats.name);
+    printf(",\n");
+    printf("      \"scheme\": \"%s\",\n", g_schemeNames[shapeDesc.scheme]);
+    printf("      \"level\": %d,\n", stats.level);
+    printf("      \"time\": {\n");
+    PrintTimeJSON("refine",         stats.refine);
+    PrintTimeJSON("patchFactory",   stats.patchFactory);
+    PrintTimeJSON("stencilFactory", stats.stencilFactory);
+    PrintTimeJSON("stencilAppend",  stats.appendStencil);
+    PrintTimeJSON("total",          stats.total, true);
+    printf("      },\n");
+    printf("      \"memory\": {\n");
+    printf("        \"refiner\": %lu,\n", (unsigned long) mem.memRefiner);
+    printf("        \"patchTable\": %lu,\n", (unsigned long) mem.memPatchTable);
+    printf("        \"stencilTable\": %lu,\n", (unsigned long) mem.memStencilTable);
+    printf("        \"peak\": %lu\n", (unsigned long) mem.memPeak);
+    printf("      }\n");
+    printf("    }");
+}
+
+static void
+PrintFooterJSON() {
+
+    printf("\n  ]\n}\n");
+}
+
 //------------------------------------------------------------------------------
 
 static int
@@ -291,6 +510,7 @@ int main(int argc, char **argv)
     Scheme defaultScheme = kCatmark;
     int minLevel = 1;
     int maxLevel = 2;
+    int numRuns = 1;
     bool runDouble = false;
 
     for (int i = 1; i < argc; ++i) {
@@ -302,6 +522,9 @@ int main(int argc, char **argv)
             testOptions.refineAdaptive = false;
         } else if (!strcmp(argv[i], "-l")) {
             if (++i < argc) maxLevel = parseIntArg(argv[i], maxLevel);
+        } else if (!strcmp(argv[i], "-r")) {
+            if (++i < argc) numRuns = parseIntArg(argv[i], numRuns);
+            if (numRuns < 1) numRuns = 1;
         } else if (!strcmp(argv[i], "-bilinear")) {
             defaultScheme = kBilinear;
         } else if (!strcmp(argv[i], "-catmark")) {
@@ -340,8 +563,13 @@ int main(int argc, char **argv)
             printOptions.patchTime   = false;
             printOptions.stencilTime = false;
             printOptions.appendTime  = false;
+            printOptions.memory      = false;
+        } else if (!strcmp(argv[i], "-nomemory")) {
+            printOptions.memory = false;
         } else if (!strcmp(argv[i], "-csv")) {
             printOptions.csvFormat = true;
+        } else if (!strcmp(argv[i], "-json")) {
+            printOptions.jsonFormat = true;
         } else {
             fprintf(stderr,
                 "Warning: unrecognized argument '%s' ignored\n", argv[i]);
@@ -352,12 +580,9 @@ int main(int argc, char **argv)
     if (!objFiles.empty()) {
         for (size_t i = 0; i < objFiles.size(); ++i) {
             char const * objFile = objFiles[i].c_str();
-            std::ifstream ifs(objFile);
-            if (ifs) {
-                std::stringstream ss;
-                ss << ifs.rdbuf();
-                ifs.close();
-                g_shapes.push_back(ShapeDesc(objFile, ss.str(), defaultScheme));
+            std::string objString;
+            if (readShapeFile(objFile, objString)) {
+                g_shapes.push_back(ShapeDesc(objFile, objString, defaultScheme));
             } else {
                 fprintf(stderr,
                     "Warning: cannot open shape file '%s'\n", objFile);
@@ -372,36 +597,50 @@ int main(int argc, char **argv)
     //  For each shape, run tests for all specified levels -- printing the
     //  results in the specified format:
     //
-    if (printOptions.csvFormat) {
+    if (printOptions.jsonFormat) {
+        PrintHeaderJSON(testOptions, numRuns, runDouble);
+    } else if (printOptions.csvFormat) {
         PrintHeaderCSV(printOptions);
     }
+    bool firstResult = true;
     for (size_t i = 0; i < g_shapes.size(); ++i) {
         ShapeDesc const & shapeDesc = g_shapes[i];
         Shape const * shape = Shape::parseObj(shapeDesc);
 
-        if (!printOptions.csvFormat) {
+        if (!printOptions.csvFormat && !printOptions.jsonFormat) {
             PrintShape(shapeDesc, printOptions);
         }
 
         for (int levelIndex = minLevel; levelIndex <= maxLevel; ++levelIndex) {
             testOptions.refineLevel = levelIndex;
 
-            TestResult result;
-            if (runDouble) {
-                result = RunPerfTest<double>(*shape, testOptions);
-            } else {
-                result = RunPerfTest<float>(*shape, testOptions);
+            TestStats stats;
+            for (int run = 0; run < numRuns; ++run) {
+                TestResult result;
+                if (runDouble) {
+                    result = RunPerfTest<double>(*shape, testOptions);
+                } else {
+                    result = RunPerfTest<float>(*shape, testOptions);
+                }
+                result.name = shapeDesc.name;
+
+                stats.Accumulate(result);
             }
-            result.name = shapeDesc.name;
 
-            if (printOptions.csvFormat) {
-                PrintResultCSV(result, printOptions);
+            if (printOptions.jsonFormat) {
+                PrintResultJSON(stats, shapeDesc, firstResult);
+            } else if (printOptions.csvFormat) {
+                PrintResultCSV(stats, printOptions);
             } else {
-                PrintResult(result, printOptions);
+                PrintResult(stats, printOptions);
             }
+            firstResult = false;
         }
         delete shape;
     }
+    if (printOptions.jsonFormat) {
+        PrintFooterJSON();
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -22,14 +22,25 @@
 //   language governing permissions and limitations under the Apache License.
 //
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 
 
 #include "../../regression/common/hbr_utils.h"
 #include "../../regression/common/far_utils.h"
 #include "../../regression/common/cmp_utils.h"
 
+#include <opensubdiv/far/hierarchicalEdits.h>
+#include <opensubdiv/far/patchTableFactory.h>
+#include <opensubdiv/far/patchTableSerializer.h>
+#include <opensubdiv/far/stencilTableFactory.h>
+#include <opensubdiv/far/stencilTableSerializer.h>
+#include <opensubdiv/far/topologyDescriptor.h>
+#include <opensubdiv/far/topologyRefinerSerializer.h>
+
 #include "init_shapes.h"
 
 //
@@ -119,6 +130,8 @@ typedef OpenSubdiv::Sdc::Options                       SdcOptions;
 typedef OpenSubdiv::Far::TopologyLevel                 FarTopologyLevel;
 typedef OpenSubdiv::Far::TopologyRefiner               FarTopologyRefiner;
 typedef OpenSubdiv::Far::TopologyRefinerFactory<Shape> FarTopologyRefinerFactory;
+typedef OpenSubdiv::Far::HierarchicalEdits             FarHierarchicalEdits;
+typedef OpenSubdiv::Far::PatchTable                    FarPatchTable;
 
 //------------------------------------------------------------------------------
 #ifdef foo
@@ -338,6 +351,1119 @@ checkMesh(Shape const & shape, std::string const& name, int maxlevel) {
     return failureCount;
 }
 
+//------------------------------------------------------------------------------
+static float
+getMaxEdgeSharpness(FarTopologyLevel const & level) {
+
+    float maxSharpness = 0.0f;
+    for (int i = 0; i < level.GetNumEdges(); ++i) {
+        maxSharpness = std::max(maxSharpness, level.GetEdgeSharpness(i));
+    }
+    return maxSharpness;
+}
+
+//
+//  Sharpness edits making a refined level of a smooth mesh semi-sharp must
+//  be propagated to the subsequent levels as any other semi-sharp feature:
+//
+static int
+checkHierarchicalSharpnessEdits() {
+
+    printf("- %-25s ( %-8s ): \n", "sharpness edits", "Catmark");
+
+    Shape * shape = Shape::parseObj(ShapeDesc("catmark_cube", catmark_cube, kCatmark));
+
+    FarTopologyRefiner * refiner = FarTopologyRefinerFactory::Create(*shape,
+        FarTopologyRefinerFactory::Options(GetSdcType(*shape), GetSdcOptions(*shape)));
+
+    int const childFaces[] = { 0 };
+
+    FarHierarchicalEdits edits;
+    edits.AddEdgeSharpnessEdit(0, 1, childFaces, 1, 3.0f);
+
+    refiner->RefineUniform(FarTopologyRefiner::UniformOptions(3), edits);
+
+    int failureCount = 0;
+    for (int level = 1; level <= refiner->GetMaxLevel(); ++level) {
+        float expected = (float)(4 - level);
+        float sharpness = getMaxEdgeSharpness(refiner->GetLevel(level));
+        if (sharpness != expected) {
+            printf("  level %d : max edge sharpness %f (expected %f)\n",
+                level, sharpness, expected);
+            ++failureCount;
+        }
+    }
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+
+    delete refiner;
+    delete shape;
+    return failureCount;
+}
+
+//
+//  Updates of base sharpness must be rejected when the base level is shared
+//  with other instances or the refined levels include hierarchical edits:
+//
+static int
+checkBaseSharpnessUpdates() {
+
+    printf("- %-25s ( %-8s ): \n", "base sharpness updates", "Catmark");
+
+    Shape * shape = Shape::parseObj(ShapeDesc("catmark_cube", catmark_cube, kCatmark));
+
+    //  Face-varying channels (also dependent on sharpness) are omitted:
+    shape->uvs.clear();
+    shape->faceuvs.clear();
+
+    FarTopologyRefinerFactory::Options options(GetSdcType(*shape), GetSdcOptions(*shape));
+
+    int   const  edges[] = { 0 };
+    float const  sharpness[] = { 3.0f };
+    OpenSubdiv::Far::ConstIndexArray updatedEdges(edges, 1), noVertices(0, 0);
+
+    int failureCount = 0;
+
+    //  Rejected while a copy shares the base level, accepted once released:
+    FarTopologyRefiner * refiner = FarTopologyRefinerFactory::Create(*shape, options);
+    refiner->RefineUniform(FarTopologyRefiner::UniformOptions(2));
+
+    FarTopologyRefiner * copy = FarTopologyRefinerFactory::Create(*refiner);
+    if (refiner->UpdateBaseSharpness(updatedEdges, sharpness, noVertices, 0)) {
+        printf("  update of shared base level not rejected\n");
+        ++failureCount;
+    }
+    delete copy;
+
+    if (!refiner->UpdateBaseSharpness(updatedEdges, sharpness, noVertices, 0)) {
+        printf("  update of unshared base level rejected\n");
+        ++failureCount;
+    } else if (getMaxEdgeSharpness(refiner->GetLevel(1)) != 2.0f) {
+        printf("  update of base level not propagated\n");
+        ++failureCount;
+    }
+    delete refiner;
+
+    //  Rejected when hierarchical edits were applied:
+    int const childFaces[] = { 0 };
+
+    FarHierarchicalEdits edits;
+    edits.AddEdgeSharpnessEdit(0, 1, childFaces, 1, 3.0f);
+
+    refiner = FarTopologyRefinerFactory::Create(*shape, options);
+    refiner->RefineUniform(FarTopologyRefiner::UniformOptions(2), edits);
+
+    if (refiner->UpdateBaseSharpness(updatedEdges, sharpness, noVertices, 0)) {
+        printf("  update of base level refined with edits not rejected\n");
+        ++failureCount;
+    }
+    delete refiner;
+
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+
+    delete shape;
+    return failureCount;
+}
+
+//
+//  Vertex edits applied by stencils must match the vertex data refined by the
+//  PrimvarRefiner with each edit applied once its whole level is interpolated,
+//  i.e. to its edited vertex only and not to the other vertices of its level
+//  (e.g. the edge-vertices computed from an edited face-vertex):
+//
+static int
+checkHierarchicalVertexEdits() {
+
+    typedef OpenSubdiv::Far::StencilTableFactoryReal<float> StencilTableFactory;
+    typedef OpenSubdiv::Far::StencilTableReal<float>        StencilTable;
+
+    printf("- %-25s ( %-8s ): \n", "vertex edits", "All");
+
+    static float const editValues[2][3] = { { 0.1f, -0.2f, 0.5f },
+                                            { -0.3f, 0.4f, 0.2f } };
+    int const maxLevel = 2;
+
+    int failureCount = 0;
+    for (int i = 0; i < (int)g_shapes.size(); ++i) {
+        ShapeDesc const & desc = g_shapes[i];
+
+        Shape * shape = Shape::parseObj(desc);
+        if (!shape) continue;
+
+        //  Each vertex of the first child of base face 0 is edited (the first
+        //  replaced, the others offset), as is a vertex of one of its own
+        //  children:
+        FarHierarchicalEdits edits;
+
+        int const childFaces[] = { 0, 2 };
+        int numChildVertices = (desc.scheme == kLoop) ? 3 : 4;
+        for (int vertex = 0; vertex < numChildVertices; ++vertex) {
+            edits.AddVertexEdit(0, 1, childFaces, vertex, (vertex == 0) ?
+                FarHierarchicalEdits::OPERATION_SET : FarHierarchicalEdits::OPERATION_ADD);
+        }
+        edits.AddVertexEdit(0, 2, childFaces, 1);
+
+        FarTopologyRefiner * refiner = FarTopologyRefinerFactory::Create(*shape,
+            FarTopologyRefinerFactory::Options(GetSdcType(*shape), GetSdcOptions(*shape)));
+        refiner->RefineUniform(FarTopologyRefiner::UniformOptions(maxLevel), edits);
+
+        int numBaseVertices = refiner->GetLevel(0).GetNumVertices();
+        int numEdits = edits.GetNumVertexEdits();
+
+        std::vector<xyzVV> controlValues(numBaseVertices + numEdits);
+        for (int vertex = 0; vertex < numBaseVertices; ++vertex) {
+            controlValues[vertex].SetPosition(shape->verts[vertex*3],
+                shape->verts[vertex*3+1], shape->verts[vertex*3+2]);
+        }
+        for (int edit = 0; edit < numEdits; ++edit) {
+            float const * value = editValues[edit % 2];
+            controlValues[numBaseVertices + edit].SetPosition(value[0], value[1], value[2]);
+        }
+
+        //  Expected values of all refined levels:
+        std::vector<xyzVV> expected(refiner->GetNumVerticesTotal());
+
+        OpenSubdiv::Far::PrimvarRefiner primvarRefiner(*refiner);
+
+        xyzVV * src = &expected[0];
+        std::copy(controlValues.begin(), controlValues.begin() + numBaseVertices, src);
+        for (int level = 1; level <= maxLevel; ++level) {
+            xyzVV * dst = src + refiner->GetLevel(level-1).GetNumVertices();
+            primvarRefiner.Interpolate(level, src, dst);
+
+            for (int edit = 0; edit < numEdits; ++edit) {
+                if (edits.GetVertexEditLevel(edit) != level) continue;
+
+                xyzVV & value = dst[edits.FindVertexEditVertex(*refiner, edit)];
+                if (edits.GetVertexEditOperation(edit) == FarHierarchicalEdits::OPERATION_SET) {
+                    value.Clear();
+                }
+                value.AddWithWeight(controlValues[numBaseVertices + edit], 1.0f);
+            }
+            src = dst;
+        }
+
+        StencilTable const * stencils = StencilTableFactory::Create(*refiner, edits);
+
+        int numControlVertices = stencils->GetNumControlVertices();
+        int numStencils = stencils->GetNumStencils();
+
+        std::vector<xyzVV> values(numStencils);
+        stencils->UpdateValues(&controlValues[0], &values[0]);
+
+        int numMismatches = 0;
+        for (int vertex = 0; vertex < numStencils; ++vertex) {
+            float const * a = values[vertex].GetPos();
+            float const * b = expected[numBaseVertices + vertex].GetPos();
+            float dist = std::max(std::fabs(a[0] - b[0]),
+                         std::max(std::fabs(a[1] - b[1]), std::fabs(a[2] - b[2])));
+            if (dist > 1e-4f) {
+                ++numMismatches;
+            }
+        }
+        if (numControlVertices != numBaseVertices + numEdits) {
+            printf("  %s : %d control vertices (expected %d)\n", desc.name.c_str(),
+                numControlVertices, numBaseVertices + numEdits);
+            ++failureCount;
+        } else if (numMismatches) {
+            printf("  %s : %d of %d vertices differ\n", desc.name.c_str(),
+                numMismatches, numStencils);
+            ++failureCount;
+        }
+        delete stencils;
+        delete refiner;
+        delete shape;
+    }
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+    return failureCount;
+}
+
+//------------------------------------------------------------------------------
+//
+//  Serialization -- buffers written by the serializers must be read back to
+//  instances identical to those written, and truncated or corrupt buffers must
+//  be rejected (with an error) rather than read:
+//
+typedef std::vector<unsigned char> SerializedBuffer;
+
+//  The header common to all buffers is 32 bytes -- its magic tag, version,
+//  byte order and type sizes are at offsets 0, 8, 12 and 16:
+static int const g_headerSize = 32;
+
+static int g_serializerErrors = 0;
+
+static void
+countSerializerError(OpenSubdiv::Far::ErrorType, const char *) {
+    ++g_serializerErrors;
+}
+
+template <typename ARRAY>
+static bool
+isEqualArray(ARRAY const & a, ARRAY const & b) {
+
+    return (a.size() == b.size()) && ((a.size() == 0) ||
+        (std::memcmp(&a[0], &b[0], a.size() * sizeof(a[0])) == 0));
+}
+
+//
+//  Deserializes a copy of the buffer truncated to each of a sampling of sizes
+//  (every size for small buffers), and of the buffer with each of the given
+//  fields overwritten with -1:
+//
+template <typename SERIALIZER>
+static int
+checkRejectedBuffers(std::string const & name, SerializedBuffer const & buffer,
+                     int const corruptOffsets[], int numCorruptOffsets) {
+
+    size_t const maxTruncations = 64;
+
+    size_t size = buffer.size();
+    size_t step = (size > maxTruncations) ? (size / maxTruncations) : 1;
+
+    std::vector<size_t> truncatedSizes;
+    for (size_t truncatedSize = 0; truncatedSize < size; truncatedSize += step) {
+        truncatedSizes.push_back(truncatedSize);
+    }
+    if (truncatedSizes.back() != size - 1) {
+        truncatedSizes.push_back(size - 1);
+    }
+
+    OpenSubdiv::Far::SetErrorCallback(countSerializerError);
+
+    int failureCount = 0;
+    for (int i = 0; i < (int)truncatedSizes.size(); ++i) {
+        SerializedBuffer truncated(buffer.begin(), buffer.begin() + truncatedSizes[i]);
+
+        g_serializerErrors = 0;
+        delete SERIALIZER::Deserialize(
+            truncated.empty() ? 0 : &truncated[0], truncated.size());
+        if (g_serializerErrors == 0) {
+            printf("  %s : truncated buffer (%d of %d bytes) not rejected\n",
+                name.c_str(), (int)truncatedSizes[i], (int)size);
+            ++failureCount;
+            break;
+        }
+    }
+    for (int i = 0; i < numCorruptOffsets; ++i) {
+        SerializedBuffer corrupt(buffer);
+        std::memset(&corrupt[corruptOffsets[i]], 0xff, sizeof(int));
+
+        g_serializerErrors = 0;
+        delete SERIALIZER::Deserialize(&corrupt[0], corrupt.size());
+        if (g_serializerErrors == 0) {
+            printf("  %s : corrupt buffer (at byte %d) not rejected\n",
+                name.c_str(), corruptOffsets[i]);
+            ++failureCount;
+        }
+    }
+
+    OpenSubdiv::Far::SetErrorCallback(0);
+    return failureCount;
+}
+
+//
+//  Compares the topology, tags and face-varying values of two levels, and
+//  the relations to their parent and child levels when present:
+//
+static char const *
+compareTopologyLevels(FarTopologyLevel const & a, FarTopologyLevel const & b,
+                      bool hasParent, bool hasChild, bool hasFaceChildVertex) {
+
+    if ((a.GetNumVertices() != b.GetNumVertices()) ||
+        (a.GetNumEdges() != b.GetNumEdges()) ||
+        (a.GetNumFaces() != b.GetNumFaces()) ||
+        (a.GetNumFaceVertices() != b.GetNumFaceVertices())) {
+        return "component counts";
+    }
+
+    //  Only the face-vertices are present in a last level refined without
+    //  the full topology (indicated by the absence of edge-vertices):
+    bool hasFullTopology = (a.GetEdgeVertexIndices().size() > 0);
+
+    if (!isEqualArray(a.GetEdgeVertexIndices(), b.GetEdgeVertexIndices()) ||
+        !isEqualArray(a.GetVertexFaceCountsAndOffsets(), b.GetVertexFaceCountsAndOffsets()) ||
+        !isEqualArray(a.GetVertexFaceIndices(), b.GetVertexFaceIndices()) ||
+        !isEqualArray(a.GetVertexEdgeCountsAndOffsets(), b.GetVertexEdgeCountsAndOffsets()) ||
+        !isEqualArray(a.GetVertexEdgeIndices(), b.GetVertexEdgeIndices())) {
+        return "relation tables";
+    }
+
+    for (int f = 0; f < a.GetNumFaces(); ++f) {
+        if (!isEqualArray(a.GetFaceVertices(f), b.GetFaceVertices(f)) ||
+            (hasFullTopology && !isEqualArray(a.GetFaceEdges(f), b.GetFaceEdges(f)))) {
+            return "face relations";
+        }
+        if (a.IsFaceHole(f) != b.IsFaceHole(f)) {
+            return "face holes";
+        }
+        if (hasParent && (a.GetFaceParentFace(f) != b.GetFaceParentFace(f))) {
+            return "face parents";
+        }
+        if (hasChild && (!isEqualArray(a.GetFaceChildFaces(f), b.GetFaceChildFaces(f)) ||
+                         !isEqualArray(a.GetFaceChildEdges(f), b.GetFaceChildEdges(f)) ||
+                         (hasFaceChildVertex &&
+                          (a.GetFaceChildVertex(f) != b.GetFaceChildVertex(f))))) {
+            return "face children";
+        }
+    }
+    for (int e = 0; hasFullTopology && (e < a.GetNumEdges()); ++e) {
+        if (!isEqualArray(a.GetEdgeVertices(e), b.GetEdgeVertices(e)) ||
+            !isEqualArray(a.GetEdgeFaces(e), b.GetEdgeFaces(e)) ||
+            !isEqualArray(a.GetEdgeFaceLocalIndices(e), b.GetEdgeFaceLocalIndices(e))) {
+            return "edge relations";
+        }
+        if ((a.GetEdgeSharpness(e) != b.GetEdgeSharpness(e)) ||
+            (a.IsEdgeBoundary(e) != b.IsEdgeBoundary(e)) ||
+            (a.IsEdgeNonManifold(e) != b.IsEdgeNonManifold(e))) {
+            return "edge tags";
+        }
+        if (hasChild && (!isEqualArray(a.GetEdgeChildEdges(e), b.GetEdgeChildEdges(e)) ||
+                         (a.GetEdgeChildVertex(e) != b.GetEdgeChildVertex(e)))) {
+            return "edge children";
+        }
+    }
+    for (int v = 0; v < a.GetNumVertices(); ++v) {
+        if (hasFullTopology && (!isEqualArray(a.GetVertexFaces(v), b.GetVertexFaces(v)) ||
+            !isEqualArray(a.GetVertexEdges(v), b.GetVertexEdges(v)) ||
+            !isEqualArray(a.GetVertexFaceLocalIndices(v), b.GetVertexFaceLocalIndices(v)) ||
+            !isEqualArray(a.GetVertexEdgeLocalIndices(v), b.GetVertexEdgeLocalIndices(v)))) {
+            return "vertex relations";
+        }
+        if ((a.GetVertexSharpness(v) != b.GetVertexSharpness(v)) ||
+            (a.GetVertexRule(v) != b.GetVertexRule(v)) ||
+            (a.IsVertexBoundary(v) != b.IsVertexBoundary(v)) ||
+            (a.IsVertexNonManifold(v) != b.IsVertexNonManifold(v))) {
+            return "vertex tags";
+        }
+        if (hasChild && (a.GetVertexChildVertex(v) != b.GetVertexChildVertex(v))) {
+            return "vertex children";
+        }
+    }
+
+    if (a.GetNumFVarChannels() != b.GetNumFVarChannels()) {
+        return "face-varying channels";
+    }
+    for (int c = 0; c < a.GetNumFVarChannels(); ++c) {
+        if ((a.GetNumFVarValues(c) != b.GetNumFVarValues(c)) ||
+            (a.DoesFVarChannelTopologyMatch(c) != b.DoesFVarChannelTopologyMatch(c))) {
+            return "face-varying values";
+        }
+        for (int f = 0; f < a.GetNumFaces(); ++f) {
+            if (!isEqualArray(a.GetFaceFVarValues(f, c), b.GetFaceFVarValues(f, c)) ||
+                (a.DoesFaceFVarTopologyMatch(f, c) != b.DoesFaceFVarTopologyMatch(f, c))) {
+                return "face-varying values";
+            }
+        }
+        for (int e = 0; hasFullTopology && (e < a.GetNumEdges()); ++e) {
+            if (a.DoesEdgeFVarTopologyMatch(e, c) != b.DoesEdgeFVarTopologyMatch(e, c)) {
+                return "face-varying edge topology";
+            }
+        }
+        for (int v = 0; v < a.GetNumVertices(); ++v) {
+            if (a.DoesVertexFVarTopologyMatch(v, c) != b.DoesVertexFVarTopologyMatch(v, c)) {
+                return "face-varying vertex topology";
+            }
+        }
+    }
+    return 0;
+}
+
+static char const *
+compareTopologyRefiners(FarTopologyRefiner const & a, FarTopologyRefiner const & b) {
+
+    SdcOptions aOptions = a.GetSchemeOptions(),
+               bOptions = b.GetSchemeOptions();
+
+    if ((a.GetSchemeType() != b.GetSchemeType()) ||
+        (aOptions.GetVtxBoundaryInterpolation() != bOptions.GetVtxBoundaryInterpolation()) ||
+        (aOptions.GetFVarLinearInterpolation() != bOptions.GetFVarLinearInterpolation()) ||
+        (aOptions.GetCreasingMethod() != bOptions.GetCreasingMethod()) ||
+        (aOptions.GetTriangleSubdivision() != bOptions.GetTriangleSubdivision())) {
+        return "scheme";
+    }
+    if ((a.IsUniform() != b.IsUniform()) ||
+        (a.GetNumLevels() != b.GetNumLevels()) ||
+        (a.GetMaxLevel() != b.GetMaxLevel()) ||
+        (a.GetMaxValence() != b.GetMaxValence()) ||
+        (a.HasHoles() != b.HasHoles()) ||
+        (a.GetNumFVarChannels() != b.GetNumFVarChannels())) {
+        return "refiner properties";
+    }
+    if ((a.GetNumVerticesTotal() != b.GetNumVerticesTotal()) ||
+        (a.GetNumEdgesTotal() != b.GetNumEdgesTotal()) ||
+        (a.GetNumFacesTotal() != b.GetNumFacesTotal()) ||
+        (a.GetNumFaceVerticesTotal() != b.GetNumFaceVerticesTotal())) {
+        return "component totals";
+    }
+    for (int c = 0; c < a.GetNumFVarChannels(); ++c) {
+        if (a.GetNumFVarValuesTotal(c) != b.GetNumFVarValuesTotal(c)) {
+            return "face-varying totals";
+        }
+    }
+    //  Faces are only assigned child vertices when split to quads:
+    bool hasFaceChildVertex = (OpenSubdiv::Sdc::SchemeTypeTraits::GetTopologicalSplitType(
+        a.GetSchemeType()) == OpenSubdiv::Sdc::SPLIT_TO_QUADS);
+
+    for (int level = 0; level < a.GetNumLevels(); ++level) {
+        char const * mismatch = compareTopologyLevels(a.GetLevel(level), b.GetLevel(level),
+            level > 0, level < a.GetMaxLevel(), hasFaceChildVertex);
+        if (mismatch) {
+            return mismatch;
+        }
+    }
+    return 0;
+}
+
+static int
+checkRefinerSerialization(FarTopologyRefiner const & refiner, std::string const & name) {
+
+    typedef OpenSubdiv::Far::TopologyRefinerSerializer Serializer;
+
+    SerializedBuffer buffer(Serializer::GetSerializedSize(refiner));
+    if (buffer.empty() ||
+        (Serializer::Serialize(refiner, &buffer[0], buffer.size()) != buffer.size())) {
+        printf("  %s : refiner not serialized\n", name.c_str());
+        return 1;
+    }
+
+    FarTopologyRefiner * copy = Serializer::Deserialize(&buffer[0], buffer.size());
+    if (!copy) {
+        printf("  %s : refiner not deserialized\n", name.c_str());
+        return 1;
+    }
+
+    int failureCount = 0;
+
+    char const * mismatch = compareTopologyRefiners(refiner, *copy);
+    if (mismatch) {
+        printf("  %s : deserialized refiner differs (%s)\n", name.c_str(), mismatch);
+        ++failureCount;
+    }
+
+    SerializedBuffer copyBuffer(Serializer::GetSerializedSize(*copy));
+    if (copyBuffer.empty() ||
+        !Serializer::Serialize(*copy, &copyBuffer[0], copyBuffer.size()) ||
+        !isEqualArray(buffer, copyBuffer)) {
+        printf("  %s : deserialized refiner serialized differently\n", name.c_str());
+        ++failureCount;
+    }
+    delete copy;
+
+    //  Fields of the header and the scheme type following it:
+    int const corruptOffsets[] = { 0, 8, 12, 16, g_headerSize };
+
+    failureCount += checkRejectedBuffers<Serializer>(name, buffer, corruptOffsets,
+        (int)(sizeof(corruptOffsets) / sizeof(int)));
+    return failureCount;
+}
+
+static int
+checkRefinerSerializers() {
+
+    printf("- %-25s ( %-8s ): \n", "refiner serialization", "All");
+
+    int failureCount = 0;
+    for (int i = 0; i < (int)g_shapes.size(); ++i) {
+        ShapeDesc const & desc = g_shapes[i];
+
+        Shape * shape = Shape::parseObj(desc);
+        if (!shape) continue;
+
+        FarTopologyRefinerFactory::Options options(GetSdcType(*shape), GetSdcOptions(*shape));
+
+        //  Unrefined, uniformly and adaptively refined instances:
+        FarTopologyRefiner * base = FarTopologyRefinerFactory::Create(*shape, options);
+        failureCount += checkRefinerSerialization(*base, desc.name + " (base)");
+        delete base;
+
+        FarTopologyRefiner * uniform = FarTopologyRefinerFactory::Create(*shape, options);
+        uniform->RefineUniform(FarTopologyRefiner::UniformOptions(2));
+        failureCount += checkRefinerSerialization(*uniform, desc.name + " (uniform)");
+        delete uniform;
+
+        if (desc.scheme != kBilinear) {
+            FarTopologyRefiner * adaptive = FarTopologyRefinerFactory::Create(*shape, options);
+            adaptive->RefineAdaptive(FarTopologyRefiner::AdaptiveOptions(3));
+            failureCount += checkRefinerSerialization(*adaptive, desc.name + " (adaptive)");
+            delete adaptive;
+        }
+        delete shape;
+    }
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+    return failureCount;
+}
+
+template <typename REAL>
+static char const *
+compareStencilTables(OpenSubdiv::Far::StencilTableReal<REAL> const * a,
+                     OpenSubdiv::Far::StencilTableReal<REAL> const * b) {
+
+    if (!a || !b) {
+        return (a || b) ? "stencil table presence" : 0;
+    }
+    if ((a->GetNumStencils() != b->GetNumStencils()) ||
+        (a->GetNumControlVertices() != b->GetNumControlVertices())) {
+        return "stencil counts";
+    }
+    if (!isEqualArray(a->GetSizes(), b->GetSizes()) ||
+        !isEqualArray(a->GetOffsets(), b->GetOffsets()) ||
+        !isEqualArray(a->GetControlIndices(), b->GetControlIndices()) ||
+        !isEqualArray(a->GetWeights(), b->GetWeights())) {
+        return "stencils";
+    }
+    return 0;
+}
+
+static char const *
+comparePatchTables(FarPatchTable const * aTable, FarPatchTable const * bTable) {
+
+    FarPatchTable const & a = *aTable;
+    FarPatchTable const & b = *bTable;
+
+    if ((a.IsFeatureAdaptive() != b.IsFeatureAdaptive()) ||
+        (a.GetNumControlVerticesTotal() != b.GetNumControlVerticesTotal()) ||
+        (a.GetNumPatchesTotal() != b.GetNumPatchesTotal()) ||
+        (a.GetMaxValence() != b.GetMaxValence()) ||
+        (a.GetNumPtexFaces() != b.GetNumPtexFaces())) {
+        return "table properties";
+    }
+
+    if (a.GetNumPatchArrays() != b.GetNumPatchArrays()) {
+        return "patch arrays";
+    }
+    for (int i = 0; i < a.GetNumPatchArrays(); ++i) {
+        if ((a.GetPatchArrayDescriptor(i).GetType() != b.GetPatchArrayDescriptor(i).GetType()) ||
+            (a.GetNumPatches(i) != b.GetNumPatches(i)) ||
+            !isEqualArray(a.GetPatchArrayVertices(i), b.GetPatchArrayVertices(i)) ||
+            !isEqualArray(a.GetPatchParams(i), b.GetPatchParams(i))) {
+            return "patch arrays";
+        }
+    }
+    if (!isEqualArray(a.GetPatchControlVerticesTable(), b.GetPatchControlVerticesTable()) ||
+        !isEqualArray(a.GetPatchParamTable(), b.GetPatchParamTable())) {
+        return "patch vertices and params";
+    }
+    if (!isEqualArray(a.GetQuadOffsetsTable(), b.GetQuadOffsetsTable()) ||
+        !isEqualArray(a.GetVertexValenceTable(), b.GetVertexValenceTable())) {
+        return "legacy Gregory tables";
+    }
+    if (!isEqualArray(a.GetSharpnessIndexTable(), b.GetSharpnessIndexTable()) ||
+        !isEqualArray(a.GetSharpnessValues(), b.GetSharpnessValues())) {
+        return "sharpness tables";
+    }
+    if (!isEqualArray(a.GetPatchRemapTable(), b.GetPatchRemapTable())) {
+        return "patch remap table";
+    }
+    for (int face = 0; face < a.GetNumPtexFaces(); ++face) {
+        if (!isEqualArray(a.GetPtexFacePatches(face), b.GetPtexFacePatches(face))) {
+            return "ptex face patches";
+        }
+    }
+
+    if ((a.GetVaryingPatchDescriptor().GetType() != b.GetVaryingPatchDescriptor().GetType()) ||
+        !isEqualArray(a.GetVaryingVertices(), b.GetVaryingVertices())) {
+        return "varying patches";
+    }
+
+    if (a.GetNumFVarChannels() != b.GetNumFVarChannels()) {
+        return "face-varying channels";
+    }
+    for (int c = 0; c < a.GetNumFVarChannels(); ++c) {
+        if ((a.GetSharedFVarChannel(c) != b.GetSharedFVarChannel(c)) ||
+            (a.GetFVarChannelLinearInterpolation(c) != b.GetFVarChannelLinearInterpolation(c)) ||
+            (a.GetFVarPatchDescriptorRegular(c).GetType() !=
+             b.GetFVarPatchDescriptorRegular(c).GetType()) ||
+            (a.GetFVarPatchDescriptorIrregular(c).GetType() !=
+             b.GetFVarPatchDescriptorIrregular(c).GetType()) ||
+            (a.GetFVarValueStride(c) != b.GetFVarValueStride(c)) ||
+            !isEqualArray(a.GetFVarValues(c), b.GetFVarValues(c)) ||
+            !isEqualArray(a.GetFVarPatchParams(c), b.GetFVarPatchParams(c))) {
+            return "face-varying patches";
+        }
+    }
+
+    if ((a.GetNumLocalPoints() != b.GetNumLocalPoints()) ||
+        (a.GetNumLocalPointsVarying() != b.GetNumLocalPointsVarying())) {
+        return "local points";
+    }
+    char const * mismatch = compareStencilTables(a.GetLocalPointStencilTable(),
+                                                 b.GetLocalPointStencilTable());
+    if (!mismatch) {
+        mismatch = compareStencilTables(a.GetLocalPointVaryingStencilTable(),
+                                        b.GetLocalPointVaryingStencilTable());
+    }
+    for (int c = 0; !mismatch && (c < a.GetNumFVarChannels()); ++c) {
+        if (a.GetNumLocalPointsFaceVarying(c) != b.GetNumLocalPointsFaceVarying(c)) {
+            return "face-varying local points";
+        }
+        mismatch = compareStencilTables(a.GetLocalPointFaceVaryingStencilTable(c),
+                                        b.GetLocalPointFaceVaryingStencilTable(c));
+    }
+    return mismatch;
+}
+
+//
+//  Round-trips a table through its serializer and compares the copy (and its
+//  own serialization) to the original, before checking rejected buffers:
+//
+template <typename SERIALIZER, typename TABLE>
+static int
+checkTableSerialization(TABLE const & table, std::string const & name,
+                        char const * (*compareTables)(TABLE const *, TABLE const *),
+                        int corruptOffset) {
+
+    SerializedBuffer buffer(SERIALIZER::GetSerializedSize(table));
+    if (buffer.empty() ||
+        (SERIALIZER::Serialize(table, &buffer[0], buffer.size()) != buffer.size())) {
+        printf("  %s : table not serialized\n", name.c_str());
+        return 1;
+    }
+
+    TABLE const * copy = SERIALIZER::Deserialize(&buffer[0], buffer.size());
+    if (!copy) {
+        printf("  %s : table not deserialized\n", name.c_str());
+        return 1;
+    }
+
+    int failureCount = 0;
+
+    char const * mismatch = compareTables(&table, copy);
+    if (mismatch) {
+        printf("  %s : deserialized table differs (%s)\n", name.c_str(), mismatch);
+        ++failureCount;
+    }
+
+    SerializedBuffer copyBuffer(SERIALIZER::GetSerializedSize(*copy));
+    if (copyBuffer.empty() ||
+        !SERIALIZER::Serialize(*copy, &copyBuffer[0], copyBuffer.size()) ||
+        !isEqualArray(buffer, copyBuffer)) {
+        printf("  %s : deserialized table serialized differently\n", name.c_str());
+        ++failureCount;
+    }
+    delete copy;
+
+    int const corruptOffsets[] = { 0, 8, 12, 16, corruptOffset };
+
+    failureCount += checkRejectedBuffers<SERIALIZER>(name, buffer, corruptOffsets,
+        (int)(sizeof(corruptOffsets) / sizeof(int)));
+    return failureCount;
+}
+
+static int
+checkTableSerializers() {
+
+    typedef OpenSubdiv::Far::PatchTableFactory                    PatchTableFactory;
+    typedef OpenSubdiv::Far::PatchTableSerializer                 PatchTableSerializer;
+    typedef OpenSubdiv::Far::StencilTableFactoryReal<float>       StencilTableFactory;
+    typedef OpenSubdiv::Far::StencilTableFactoryReal<double>      StencilTableFactoryDouble;
+    typedef OpenSubdiv::Far::StencilTableSerializerReal<float>    StencilTableSerializer;
+    typedef OpenSubdiv::Far::StencilTableSerializerReal<double>   StencilTableSerializerDouble;
+    typedef OpenSubdiv::Far::StencilTableReal<float>              StencilTable;
+    typedef OpenSubdiv::Far::StencilTableReal<double>             StencilTableDouble;
+
+    printf("- %-25s ( %-8s ): \n", "table serialization", "All");
+
+    //  The number of patch arrays follows six other properties, and the
+    //  number of stencil sizes follows the number of control vertices:
+    int const patchCorruptOffset   = g_headerSize + 6 * sizeof(int);
+    int const stencilCorruptOffset = g_headerSize + sizeof(int);
+
+    int failureCount = 0;
+    for (int i = 0; i < (int)g_shapes.size(); ++i) {
+        ShapeDesc const & desc = g_shapes[i];
+
+        Shape * shape = Shape::parseObj(desc);
+        if (!shape) continue;
+
+        FarTopologyRefiner * refiner = FarTopologyRefinerFactory::Create(*shape,
+            FarTopologyRefinerFactory::Options(GetSdcType(*shape), GetSdcOptions(*shape)));
+
+        //  Patches include the varying and face-varying tables, single-crease
+        //  sharpness and ptex face patches (and legacy Gregory tables when
+        //  supported):
+        PatchTableFactory::Options patchOptions(2);
+        patchOptions.generateFVarTables      = true;
+        patchOptions.useSingleCreasePatch    = true;
+        patchOptions.generatePtexFacePatches = true;
+        if (desc.scheme == kCatmark) {
+            patchOptions.SetEndCapType(PatchTableFactory::Options::ENDCAP_LEGACY_GREGORY);
+        }
+
+        if (desc.scheme == kBilinear) {
+            refiner->RefineUniform(FarTopologyRefiner::UniformOptions(2));
+        } else {
+            FarTopologyRefiner::AdaptiveOptions adaptiveOptions =
+                patchOptions.GetRefineAdaptiveOptions();
+            adaptiveOptions.considerFVarChannels = true;
+            refiner->RefineAdaptive(adaptiveOptions);
+        }
+
+        FarPatchTable * patchTable = PatchTableFactory::Create(*refiner, patchOptions);
+        failureCount += checkTableSerialization<PatchTableSerializer>(*patchTable,
+            desc.name + " (patches)", comparePatchTables, patchCorruptOffset);
+        delete patchTable;
+
+        //  Stencils in single precision with offsets and double without:
+        StencilTableFactory::Options stencilOptions;
+        stencilOptions.generateOffsets = true;
+
+        StencilTable const * stencilTable =
+            StencilTableFactory::Create(*refiner, stencilOptions);
+        failureCount += checkTableSerialization<StencilTableSerializer>(*stencilTable,
+            desc.name + " (stencils)", compareStencilTables<float>, stencilCorruptOffset);
+        delete stencilTable;
+
+        StencilTableDouble const * stencilTableDouble =
+            StencilTableFactoryDouble::Create(*refiner);
+        failureCount += checkTableSerialization<StencilTableSerializerDouble>(*stencilTableDouble,
+            desc.name + " (double stencils)", compareStencilTables<double>,
+            stencilCorruptOffset);
+        delete stencilTableDouble;
+
+        delete refiner;
+        delete shape;
+    }
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+    return failureCount;
+}
+
+//------------------------------------------------------------------------------
+//
+//  Threaded construction -- refiners and tables built with multiple threads
+//  must be identical to those built serially:
+//
+static int const g_numThreads = 4;
+
+static int
+compareThreadedRefiners(FarTopologyRefiner const & serial, FarTopologyRefiner const & threaded,
+                        std::string const & name) {
+
+    char const * mismatch = compareTopologyRefiners(serial, threaded);
+    if (mismatch) {
+        printf("  %s : threaded refiner differs (%s)\n", name.c_str(), mismatch);
+        return 1;
+    }
+    return 0;
+}
+
+static int
+checkThreadedRefinement() {
+
+    printf("- %-25s ( %-8s ): \n", "threaded refinement", "All");
+
+    int failureCount = 0;
+    for (int i = 0; i < (int)g_shapes.size(); ++i) {
+        ShapeDesc const & desc = g_shapes[i];
+
+        Shape * shape = Shape::parseObj(desc);
+        if (!shape) continue;
+
+        FarTopologyRefinerFactory::Options options(GetSdcType(*shape), GetSdcOptions(*shape));
+
+        FarTopologyRefiner::UniformOptions uniformOptions(3);
+        uniformOptions.fullTopologyInLastLevel = true;
+
+        FarTopologyRefiner * serial = FarTopologyRefinerFactory::Create(*shape, options);
+        serial->RefineUniform(uniformOptions);
+
+        uniformOptions.numThreads = g_numThreads;
+
+        FarTopologyRefiner * threaded = FarTopologyRefinerFactory::Create(*shape, options);
+        threaded->RefineUniform(uniformOptions);
+
+        failureCount += compareThreadedRefiners(*serial, *threaded, desc.name + " (uniform)");
+        delete serial;
+        delete threaded;
+
+        if (desc.scheme != kBilinear) {
+            FarTopologyRefiner::AdaptiveOptions adaptiveOptions(3);
+
+            serial = FarTopologyRefinerFactory::Create(*shape, options);
+            serial->RefineAdaptive(adaptiveOptions);
+
+            adaptiveOptions.numThreads = g_numThreads;
+
+            threaded = FarTopologyRefinerFactory::Create(*shape, options);
+            threaded->RefineAdaptive(adaptiveOptions);
+
+            failureCount += compareThreadedRefiners(*serial, *threaded, desc.name + " (adaptive)");
+            delete serial;
+            delete threaded;
+        }
+        delete shape;
+    }
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+    return failureCount;
+}
+
+static int
+checkThreadedStencils() {
+
+    typedef OpenSubdiv::Far::StencilTableFactoryReal<float> StencilTableFactory;
+    typedef OpenSubdiv::Far::StencilTableReal<float>        StencilTable;
+
+    printf("- %-25s ( %-8s ): \n", "threaded stencils", "All");
+
+    static char const * modes[] = { "vertex", "varying", "face-varying" };
+
+    int failureCount = 0;
+    for (int i = 0; i < (int)g_shapes.size(); ++i) {
+        ShapeDesc const & desc = g_shapes[i];
+
+        Shape * shape = Shape::parseObj(desc);
+        if (!shape) continue;
+
+        FarTopologyRefiner * refiner = FarTopologyRefinerFactory::Create(*shape,
+            FarTopologyRefinerFactory::Options(GetSdcType(*shape), GetSdcOptions(*shape)));
+        refiner->RefineUniform(FarTopologyRefiner::UniformOptions(2));
+
+        //  Each interpolation mode with stencils factorized from the control
+        //  vertices and from the previous level:
+        int numModes = refiner->GetNumFVarChannels() ? 3 : 2;
+        for (int mode = 0; mode < numModes; ++mode) {
+            for (int factorize = 0; factorize < 2; ++factorize) {
+                StencilTableFactory::Options options;
+                options.interpolationMode           = mode;
+                options.generateOffsets             = true;
+                options.factorizeIntermediateLevels = factorize;
+
+                StencilTable const * serial = StencilTableFactory::Create(*refiner, options);
+
+                options.numThreads = g_numThreads;
+
+                StencilTable const * threaded = StencilTableFactory::Create(*refiner, options);
+
+                char const * mismatch = compareStencilTables(serial, threaded);
+                if (mismatch) {
+                    printf("  %s (%s%s) : threaded stencils differ (%s)\n", desc.name.c_str(),
+                        modes[mode], factorize ? ", factorized" : "", mismatch);
+                    ++failureCount;
+                }
+                delete serial;
+                delete threaded;
+            }
+        }
+        delete refiner;
+        delete shape;
+    }
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+    return failureCount;
+}
+
+static int
+checkThreadedPatches() {
+
+    typedef OpenSubdiv::Far::PatchTableFactory PatchTableFactory;
+    typedef PatchTableFactory::Options         PatchOptions;
+
+    printf("- %-25s ( %-8s ): \n", "threaded patches", "All");
+
+    static PatchOptions::EndCapType const endCapTypes[] = {
+        PatchOptions::ENDCAP_BSPLINE_BASIS,
+        PatchOptions::ENDCAP_GREGORY_BASIS,
+        PatchOptions::ENDCAP_LEGACY_GREGORY };
+    static char const * endCapNames[] = { "B-spline", "Gregory", "legacy Gregory" };
+
+    int failureCount = 0;
+    for (int i = 0; i < (int)g_shapes.size(); ++i) {
+        ShapeDesc const & desc = g_shapes[i];
+
+        if (desc.scheme == kBilinear) continue;
+
+        Shape * shape = Shape::parseObj(desc);
+        if (!shape) continue;
+
+        //  Patches include the face-varying patches and single creases, with
+        //  each type of end-cap (legacy Gregory only supported by Catmark):
+        PatchOptions options(2);
+        options.generateFVarTables   = true;
+        options.useSingleCreasePatch = true;
+
+        FarTopologyRefiner::AdaptiveOptions adaptiveOptions = options.GetRefineAdaptiveOptions();
+        adaptiveOptions.considerFVarChannels = true;
+
+        FarTopologyRefiner * refiner = FarTopologyRefinerFactory::Create(*shape,
+            FarTopologyRefinerFactory::Options(GetSdcType(*shape), GetSdcOptions(*shape)));
+        refiner->RefineAdaptive(adaptiveOptions);
+
+        int numEndCapTypes = (desc.scheme == kCatmark) ? 3 : 2;
+        for (int endCap = 0; endCap < numEndCapTypes; ++endCap) {
+            options.SetEndCapType(endCapTypes[endCap]);
+            options.numThreads = 0;
+
+            FarPatchTable * serial = PatchTableFactory::Create(*refiner, options);
+
+            options.numThreads = g_numThreads;
+
+            FarPatchTable * threaded = PatchTableFactory::Create(*refiner, options);
+
+            char const * mismatch = comparePatchTables(serial, threaded);
+            if (mismatch) {
+                printf("  %s (%s) : threaded patches differ (%s)\n", desc.name.c_str(),
+                    endCapNames[endCap], mismatch);
+                ++failureCount;
+            }
+            delete serial;
+            delete threaded;
+        }
+        delete refiner;
+        delete shape;
+    }
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+    return failureCount;
+}
+
+static int
+compareThreadedBaseRefiners(FarTopologyRefiner * serial, FarTopologyRefiner * threaded,
+                            std::string const & name) {
+
+    int failureCount = 0;
+    if (!serial || !threaded) {
+        if (serial || threaded) {
+            printf("  %s : threaded refiner %s\n", name.c_str(),
+                threaded ? "created but serial not" : "not created");
+            ++failureCount;
+        }
+    } else {
+        failureCount = compareThreadedRefiners(*serial, *threaded, name);
+    }
+    delete serial;
+    delete threaded;
+    return failureCount;
+}
+
+static int
+checkThreadedBaseTopology() {
+
+    typedef OpenSubdiv::Far::TopologyDescriptor                 Descriptor;
+    typedef OpenSubdiv::Far::TopologyRefinerFactory<Descriptor> DescriptorFactory;
+
+    printf("- %-25s ( %-8s ): \n", "threaded base topology", "All");
+
+    int failureCount = 0;
+    for (int i = 0; i < (int)g_shapes.size(); ++i) {
+        ShapeDesc const & desc = g_shapes[i];
+
+        Shape * shape = Shape::parseObj(desc);
+        if (!shape) continue;
+
+        //  The base level is completed from the face-vertices (and validated)
+        //  both when assigned by the Shape factory and a TopologyDescriptor:
+        FarTopologyRefinerFactory::Options options(GetSdcType(*shape), GetSdcOptions(*shape));
+        options.validateFullTopology = true;
+
+        FarTopologyRefiner * serial = FarTopologyRefinerFactory::Create(*shape, options);
+
+        options.numThreads = g_numThreads;
+
+        FarTopologyRefiner * threaded = FarTopologyRefinerFactory::Create(*shape, options);
+
+        failureCount += compareThreadedBaseRefiners(serial, threaded, desc.name + " (shape)");
+
+        Descriptor descriptor;
+        descriptor.numVertices        = shape->GetNumVertices();
+        descriptor.numFaces           = shape->GetNumFaces();
+        descriptor.numVertsPerFace    = &shape->nvertsPerFace[0];
+        descriptor.vertIndicesPerFace = &shape->faceverts[0];
+        descriptor.isLeftHanded       = shape->isLeftHanded;
+
+        Descriptor::FVarChannel uvChannel;
+        if (!shape->faceuvs.empty()) {
+            uvChannel.numValues    = (int)shape->uvs.size() / 2;
+            uvChannel.valueIndices = &shape->faceuvs[0];
+
+            descriptor.numFVarChannels = 1;
+            descriptor.fvarChannels    = &uvChannel;
+        }
+
+        DescriptorFactory::Options descriptorOptions(options.schemeType, options.schemeOptions);
+        descriptorOptions.validateFullTopology = true;
+
+        serial = DescriptorFactory::Create(descriptor, descriptorOptions);
+
+        descriptorOptions.numThreads = g_numThreads;
+
+        threaded = DescriptorFactory::Create(descriptor, descriptorOptions);
+
+        failureCount += compareThreadedBaseRefiners(serial, threaded, desc.name + " (descriptor)");
+
+        delete shape;
+    }
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+    return failureCount;
+}
+
+static int
+checkThreadedFeatureSelection() {
+
+    printf("- %-25s ( %-8s ): \n", "threaded isolation", "All");
+
+    //  Features selected for isolation vary with the adaptive options (other
+    //  than the default already covered by threaded refinement):
+    static char const * variants[] = {
+        "secondary level", "single crease", "double crease", "inf-sharp", "face-varying" };
+    int const numVariants = (int)(sizeof(variants) / sizeof(variants[0]));
+
+    int failureCount = 0;
+    for (int i = 0; i < (int)g_shapes.size(); ++i) {
+        ShapeDesc const & desc = g_shapes[i];
+
+        if (desc.scheme == kBilinear) continue;
+
+        Shape * shape = Shape::parseObj(desc);
+        if (!shape) continue;
+
+        FarTopologyRefinerFactory::Options options(GetSdcType(*shape), GetSdcOptions(*shape));
+
+        for (int variant = 0; variant < numVariants; ++variant) {
+            FarTopologyRefiner::AdaptiveOptions adaptiveOptions(3);
+            switch (variant) {
+                case 0: adaptiveOptions.secondaryLevel       = 2; break;
+                case 1: adaptiveOptions.useSingleCreasePatch = true; break;
+                case 2: adaptiveOptions.useSingleCreasePatch = true;
+                        adaptiveOptions.useDoubleCreasePatch = true; break;
+                case 3: adaptiveOptions.useInfSharpPatch     = true; break;
+                case 4: adaptiveOptions.considerFVarChannels = true; break;
+            }
+
+            FarTopologyRefiner * serial = FarTopologyRefinerFactory::Create(*shape, options);
+            serial->RefineAdaptive(adaptiveOptions);
+
+            adaptiveOptions.numThreads = g_numThreads;
+
+            FarTopologyRefiner * threaded = FarTopologyRefinerFactory::Create(*shape, options);
+            threaded->RefineAdaptive(adaptiveOptions);
+
+            failureCount += compareThreadedRefiners(*serial, *threaded,
+                desc.name + " (" + variants[variant] + ")");
+            delete serial;
+            delete threaded;
+        }
+        delete shape;
+    }
+    if (failureCount == 0) {
+        printf("  success !\n");
+    }
+    return failureCount;
+}
+
 //------------------------------------------------------------------------------
 int main(int /* argc */, char ** /* argv */) {
 
@@ -362,6 +1488,17 @@ int main(int /* argc */, char ** /* argv */) {
         delete shape;
     }
 
+    total+=checkHierarchicalSharpnessEdits();
+    total+=checkBaseSharpnessUpdates();
+    total+=checkHierarchicalVertexEdits();
+    total+=checkRefinerSerializers();
+    total+=checkTableSerializers();
+    total+=checkThreadedRefinement();
+    total+=checkThreadedStencils();
+    total+=checkThreadedPatches();
+    total+=checkThreadedBaseTopology();
+    total+=checkThreadedFeatureSelection();
+
     if (g_debugmode)
         printf("]\n");
     else {
@@ -370,6 +1507,7 @@ int main(int /* argc */, char ** /* argv */) {
         else
           printf("Total failures : %d\n", total);
     }
+    return total;
 }
 
 //------------------------------------------------------------------------------
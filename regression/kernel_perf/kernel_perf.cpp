@@ -0,0 +1,774 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opensubdiv/sdc/catmarkScheme.h>
+#include <opensubdiv/sdc/loopScheme.h>
+#include <opensubdiv/vtr/level.h>
+#include <opensubdiv/far/patchBasis.h>
+#include <opensubdiv/far/patchMap.h>
+#include <opensubdiv/far/patchTableFactory.h>
+#include <opensubdiv/far/ptexIndices.h>
+#include <opensubdiv/far/stencilBuilder.h>
+#include <opensubdiv/far/stencilTableFactory.h>
+
+#include <opensubdiv/osd/bufferDescriptor.h>
+#include <opensubdiv/osd/cpuKernel.h>
+#include <opensubdiv/osd/cpuPatchCoordSampler.h>
+#include <opensubdiv/osd/cpuPatchTable.h>
+
+#include "../../regression/common/far_utils.h"
+#include "../../examples/common/stopwatch.h"
+
+#include "init_shapes.h"
+
+//------------------------------------------------------------------------------
+//
+//  Microbenchmarks of the primitives at the core of refinement, table
+//  construction and evaluation, each timed in isolation and reported as the
+//  average time of a single operation (a mask, a basis evaluation, a stencil
+//  applied to a vertex...) so that regressions of any one of them are not
+//  hidden by the coarser timings of far_perf and osd_perf.
+//
+//  Each benchmark runs batches of operations until a minimum time is
+//  reached, after a first batch to warm up caches.
+//
+
+using namespace OpenSubdiv;
+
+struct TestOptions {
+    TestOptions() :
+        refineLevel(2),
+        samplesPerFace(4),
+        minTime(0.1) { }
+
+    int    refineLevel;
+    int    samplesPerFace;
+    double minTime;
+};
+
+//
+//  The tables of a shape shared by the benchmarks, built once:
+//
+struct TestData {
+    TestData() : refiner(0), stencilTable(0), patchTable(0),
+                 cpuPatchTable(0), patchMap(0) { }
+    ~TestData() {
+        delete refiner;
+        delete stencilTable;
+        delete patchTable;
+        delete cpuPatchTable;
+        delete patchMap;
+    }
+
+    Far::TopologyRefiner *    refiner;
+    Far::StencilTable const * stencilTable;
+    Far::PatchTable const *   patchTable;
+    Osd::CpuPatchTable *      cpuPatchTable;
+    Far::PatchMap *           patchMap;
+
+    std::vector<Osd::PatchCoord> patchCoords;
+
+    //  Locations of ptex faces to look up in the PatchMap:
+    std::vector<int>   lookupFaces;
+    std::vector<float> lookupUVs;
+
+    //  Primvars of all vertices, interleaved and as separate components:
+    std::vector<float>  vertices;
+    std::vector<double> verticesDouble;
+    std::vector<float>  components[3];
+
+    //  Destinations of the results of the patches:
+    std::vector<float> patchResults;
+
+    int numControlVertices;
+    int numTotalVertices;
+};
+
+static TestData *
+CreateTestData(Shape const & shape, TestOptions const & options) {
+
+    TestData * data = new TestData;
+
+    data->refiner = Far::TopologyRefinerFactory<Shape>::Create(shape,
+        Far::TopologyRefinerFactory<Shape>::Options(GetSdcType(shape),
+                                                    GetSdcOptions(shape)));
+    assert(data->refiner);
+    Far::TopologyRefiner & refiner = *data->refiner;
+
+    Far::PatchTableFactory::Options poptions(options.refineLevel);
+    poptions.SetEndCapType(
+        Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+    refiner.RefineAdaptive(poptions.GetRefineAdaptiveOptions());
+
+    Far::StencilTableFactory::Options soptions;
+    soptions.generateOffsets = true;
+    soptions.generateIntermediateLevels = true;
+
+    Far::StencilTable * stencilTable = const_cast<Far::StencilTable *>(
+        Far::StencilTableFactory::Create(refiner, soptions));
+
+    data->patchTable = Far::PatchTableFactory::Create(refiner, poptions);
+
+    Far::StencilTableFactory::AppendLocalPointStencilTable(refiner,
+        *stencilTable, data->patchTable->GetLocalPointStencilTable());
+    data->stencilTable = stencilTable;
+
+    data->cpuPatchTable = Osd::CpuPatchTable::Create(data->patchTable);
+    data->patchMap = new Far::PatchMap(*data->patchTable);
+
+    data->numControlVertices = refiner.GetLevel(0).GetNumVertices();
+    data->numTotalVertices   = data->numControlVertices +
+                               stencilTable->GetNumStencils();
+
+    //  Positions of the control vertices, in all representations:
+    data->vertices.resize(data->numTotalVertices * 3, 0.0f);
+    std::copy(shape.verts.begin(),
+              shape.verts.begin() + data->numControlVertices * 3,
+              data->vertices.begin());
+    data->verticesDouble.assign(data->vertices.begin(),
+                                data->vertices.end());
+    for (int k = 0; k < 3; ++k) {
+        data->components[k].resize(data->numTotalVertices);
+        for (int i = 0; i < data->numTotalVertices; ++i) {
+            data->components[k][i] = data->vertices[i * 3 + k];
+        }
+    }
+
+    //  Uniform samples of the ptex faces:
+    Osd::CpuPatchCoordSampler sampler(refiner, *data->patchTable);
+    int n = options.samplesPerFace;
+    data->patchCoords.resize(sampler.GetNumPtexFaces() * n * n);
+    data->patchCoords.resize(
+        sampler.SampleUniform(n, &data->patchCoords[0]));
+    data->patchResults.resize(std::max(1, (int)data->patchCoords.size()) * 3);
+
+    //  Pseudo-random locations of the ptex faces:
+    int numPtexFaces = sampler.GetNumPtexFaces();
+    unsigned int seed = 1;
+    for (int i = 0; i < 4096; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        data->lookupFaces.push_back((int)((seed >> 8) % numPtexFaces));
+        seed = seed * 1103515245u + 12345u;
+        data->lookupUVs.push_back((float)((seed >> 8) & 0xffff) / 65536.0f);
+        seed = seed * 1103515245u + 12345u;
+        data->lookupUVs.push_back((float)((seed >> 8) & 0xffff) / 65536.0f);
+    }
+    return data;
+}
+
+//------------------------------------------------------------------------------
+//
+//  Benchmarks -- each function runs one batch and returns the number of
+//  operations it performed:
+//
+typedef int (*BenchmarkFunc)(TestData & data, int param);
+
+struct Benchmark {
+    Benchmark(std::string const & n, BenchmarkFunc f, int p = 0) :
+        name(n), func(f), param(p) { }
+
+    std::string   name;
+    BenchmarkFunc func;
+    int           param;
+};
+
+//
+//  Sdc masks -- a minimal neighborhood of a vertex of given valence and
+//  sharpness, and a mask of weights on the stack:
+//
+class VertexNeighborhood {
+public:
+    VertexNeighborhood(int valence, float edgeSharpness, bool boundary) :
+        _valence(valence), _boundary(boundary), _edgeSharpness(edgeSharpness) { }
+
+    int GetNumEdges() const { return _valence; }
+    int GetNumFaces() const { return _boundary ? _valence - 1 : _valence; }
+
+    float GetSharpness() const { return 0.0f; }
+    float * GetSharpnessPerEdge(float sharpness[]) const {
+        for (int i = 0; i < _valence; ++i) {
+            sharpness[i] = (i == 0 || i == _valence / 2) ? _edgeSharpness : 0.0f;
+        }
+        if (_boundary) {
+            sharpness[0] = sharpness[_valence - 1] = Sdc::Crease::SHARPNESS_INFINITE;
+        }
+        return sharpness;
+    }
+
+    float GetChildSharpness(Sdc::Crease const &) const { return 0.0f; }
+    float * GetChildSharpnessPerEdge(Sdc::Crease const & crease,
+                                     float sharpness[]) const {
+        float parentSharpness[Vtr::VALENCE_LIMIT];
+        GetSharpnessPerEdge(parentSharpness);
+        crease.SubdivideEdgeSharpnessesAroundVertex(_valence, parentSharpness,
+                                                    sharpness);
+        return sharpness;
+    }
+
+private:
+    int   _valence;
+    bool  _boundary;
+    float _edgeSharpness;
+};
+
+class StackMask {
+public:
+    typedef float Weight;
+
+    StackMask() : _vertCount(0), _edgeCount(0), _faceCount(0),
+                  _faceCenters(false) { }
+
+    int GetNumVertexWeights() const { return _vertCount; }
+    int GetNumEdgeWeights()   const { return _edgeCount; }
+    int GetNumFaceWeights()   const { return _faceCount; }
+
+    void SetNumVertexWeights(int count) { _vertCount = count; }
+    void SetNumEdgeWeights(  int count) { _edgeCount = count; }
+    void SetNumFaceWeights(  int count) { _faceCount = count; }
+
+    Weight const& VertexWeight(int i) const { return _vertWeights[i]; }
+    Weight const& EdgeWeight(  int i) const { return _edgeWeights[i]; }
+    Weight const& FaceWeight(  int i) const { return _faceWeights[i]; }
+
+    Weight& VertexWeight(int i) { return _vertWeights[i]; }
+    Weight& EdgeWeight(  int i) { return _edgeWeights[i]; }
+    Weight& FaceWeight(  int i) { return _faceWeights[i]; }
+
+    bool AreFaceWeightsForFaceCenters() const  { return _faceCenters; }
+    void SetFaceWeightsForFaceCenters(bool on) { _faceCenters = on; }
+
+private:
+    Weight _vertWeights[1];
+    Weight _edgeWeights[Vtr::VALENCE_LIMIT];
+    Weight _faceWeights[Vtr::VALENCE_LIMIT];
+
+    int  _vertCount;
+    int  _edgeCount;
+    int  _faceCount;
+    bool _faceCenters;
+};
+
+//  Prevents the computation of unused results from being optimized away:
+static volatile float g_sink = 0.0f;
+
+template <Sdc::SchemeType SCHEME>
+static int
+RunVertexMask(int valence, float edgeSharpness, bool boundary) {
+
+    Sdc::Scheme<SCHEME> scheme;
+    VertexNeighborhood vertex(valence, edgeSharpness, boundary);
+
+    int const numMasks = 1000;
+    float sum = 0.0f;
+    for (int i = 0; i < numMasks; ++i) {
+        StackMask mask;
+        scheme.ComputeVertexVertexMask(vertex, mask);
+        sum += mask.VertexWeight(0);
+    }
+    g_sink = sum;
+    return numMasks;
+}
+
+static int
+BenchCatmarkSmoothMask(TestData &, int valence) {
+    return RunVertexMask<Sdc::SCHEME_CATMARK>(valence, 0.0f, false);
+}
+
+static int
+BenchCatmarkCreaseMask(TestData &, int valence) {
+    return RunVertexMask<Sdc::SCHEME_CATMARK>(valence, 1.5f, false);
+}
+
+static int
+BenchCatmarkBoundaryMask(TestData &, int valence) {
+    return RunVertexMask<Sdc::SCHEME_CATMARK>(valence, 0.0f, true);
+}
+
+static int
+BenchLoopSmoothMask(TestData &, int valence) {
+    return RunVertexMask<Sdc::SCHEME_LOOP>(valence, 0.0f, false);
+}
+
+//
+//  Far patch basis of each patch type at a grid of locations:
+//
+static int
+BenchPatchBasis(TestData &, int patchType) {
+
+    Far::PatchParam param;
+    param.Set(0, 0, 0, 1, false, 0, 0, true);
+
+    float wP[20], wDs[20], wDt[20];
+
+    int const n = 32;
+    float sum = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            float s = (i + 0.5f) / n;
+            float t = (j + 0.5f) / n;
+            if ((patchType == Far::PatchDescriptor::LOOP) ||
+                (patchType == Far::PatchDescriptor::GREGORY_TRIANGLE) ||
+                (patchType == Far::PatchDescriptor::TRIANGLES)) {
+                //  Fold into the triangular domain:
+                if (s + t > 1.0f) {
+                    s = 1.0f - s;
+                    t = 1.0f - t;
+                }
+            }
+            Far::internal::EvaluatePatchBasis<float>(patchType, param, s, t,
+                                                     wP, wDs, wDt);
+            sum += wP[0] + wDs[0] + wDt[0];
+        }
+    }
+    g_sink = sum;
+    return n * n;
+}
+
+//
+//  Far::PatchMap look-up of pseudo-random locations:
+//
+static int
+BenchPatchMapFindPatch(TestData & data, int) {
+
+    int numLookups = (int)data.lookupFaces.size();
+    int found = 0;
+    for (int i = 0; i < numLookups; ++i) {
+        found += data.patchMap->FindPatch(data.lookupFaces[i],
+                                          data.lookupUVs[2*i],
+                                          data.lookupUVs[2*i+1]) != 0;
+    }
+    g_sink = (float)found;
+    return numLookups;
+}
+
+//
+//  Far StencilBuilder -- accumulation of coarse vertices into new vertices
+//  (as for face-points), then of those new vertices into others, which are
+//  factorized into the coarse vertices (as for vertices of later levels):
+//
+static int
+BenchStencilBuilder(TestData &, int factorized) {
+
+    typedef Far::internal::StencilBuilder<float> Builder;
+
+    int const numCoarse  = 1024;
+    int const numPoints  = 1024;
+
+    Builder builder(numCoarse, false);
+
+    Builder::Index coarse(&builder, 0);
+    Builder::Index level1(&builder, numCoarse);
+    Builder::Index level2(&builder, numCoarse + numPoints);
+
+    for (int i = 0; i < numPoints; ++i) {
+        Builder::Index dst = level1[i];
+        for (int j = 0; j < 4; ++j) {
+            dst.AddWithWeight(coarse[(i + j * 31) % numCoarse], 0.25f);
+        }
+    }
+    if (!factorized) {
+        return numPoints * 4;
+    }
+
+    for (int i = 0; i < numPoints; ++i) {
+        Builder::Index dst = level2[i];
+        for (int j = 0; j < 4; ++j) {
+            dst.AddWithWeight(level1[(i + j * 17) % numPoints], 0.25f);
+        }
+    }
+    return numPoints * 8;
+}
+
+//
+//  Vtr Level -- construction of all topological relations of the base
+//  level from its face-vertices (including their assignment):
+//
+static int
+BenchLevelTopology(TestData & data, int) {
+
+    Far::TopologyLevel const & base = data.refiner->GetLevel(0);
+
+    int numFaces = base.GetNumFaces();
+
+    Vtr::internal::Level level;
+    level.resizeVertices(base.GetNumVertices());
+    level.resizeFaces(numFaces);
+
+    int numFaceVertices = 0;
+    for (int face = 0; face < numFaces; ++face) {
+        int size = base.GetFaceVertices(face).size();
+        level.resizeFaceVertices(face, size);
+        numFaceVertices += size;
+    }
+    level.resizeFaceVertices(numFaceVertices);
+    for (int face = 0; face < numFaces; ++face) {
+        Far::ConstIndexArray src = base.GetFaceVertices(face);
+        Vtr::IndexArray dst = level.getFaceVertices(face);
+        for (int i = 0; i < src.size(); ++i) {
+            dst[i] = src[i];
+        }
+    }
+    level.completeTopologyFromFaceVertices();
+    return numFaces;
+}
+
+//
+//  Osd CPU kernels -- the stencils of all refined vertices and local points
+//  applied to 3-component primvars, the weights also serving as those of
+//  the derivatives (their cost does not depend on the values):
+//
+static int
+BenchCpuStencils(TestData & data, int reproducible) {
+
+    Far::StencilTable const & table = *data.stencilTable;
+
+    Osd::BufferDescriptor srcDesc(0, 3, 3);
+    Osd::BufferDescriptor dstDesc(data.numControlVertices * 3, 3, 3);
+
+    float * vertices = &data.vertices[0];
+
+    Osd::CpuSetReproducible(reproducible != 0);
+    Osd::CpuEvalStencils(vertices, srcDesc, vertices, dstDesc,
+                         &table.GetSizes()[0], &table.GetOffsets()[0],
+                         &table.GetControlIndices()[0], &table.GetWeights()[0],
+                         0, table.GetNumStencils());
+    Osd::CpuSetReproducible(false);
+    return table.GetNumStencils();
+}
+
+static int
+BenchCpuStencilsDerivatives(TestData & data, int) {
+
+    Far::StencilTable const & table = *data.stencilTable;
+
+    Osd::BufferDescriptor srcDesc(0, 3, 3);
+    Osd::BufferDescriptor dstDesc(data.numControlVertices * 3, 3, 3);
+
+    //  Derivatives are written over the results, which are not read:
+    float * vertices = &data.vertices[0];
+    float const * weights = &table.GetWeights()[0];
+
+    Osd::CpuEvalStencils(vertices, srcDesc, vertices, dstDesc,
+                         vertices, dstDesc, vertices, dstDesc,
+                         &table.GetSizes()[0], &table.GetOffsets()[0],
+                         &table.GetControlIndices()[0],
+                         weights, weights, weights,
+                         0, table.GetNumStencils());
+    return table.GetNumStencils();
+}
+
+static int
+BenchCpuStencilsDouble(TestData & data, int) {
+
+    Far::StencilTable const & table = *data.stencilTable;
+
+    Osd::BufferDescriptor srcDesc(0, 3, 3);
+    Osd::BufferDescriptor dstDesc(data.numControlVertices * 3, 3, 3);
+
+    double * vertices = &data.verticesDouble[0];
+
+    Osd::CpuEvalStencils(vertices, srcDesc, vertices, dstDesc,
+                         &table.GetSizes()[0], &table.GetOffsets()[0],
+                         &table.GetControlIndices()[0], &table.GetWeights()[0],
+                         0, table.GetNumStencils());
+    return table.GetNumStencils();
+}
+
+static int
+BenchCpuStencilsSoa(TestData & data, int) {
+
+    Far::StencilTable const & table = *data.stencilTable;
+
+    float const * src[3];
+    float * dst[3];
+    for (int k = 0; k < 3; ++k) {
+        src[k] = &data.components[k][0];
+        dst[k] = &data.components[k][data.numControlVertices];
+    }
+
+    Osd::CpuEvalStencilsSoa(src, dst, 0, 0, 3,
+                            &table.GetSizes()[0], &table.GetOffsets()[0],
+                            &table.GetControlIndices()[0],
+                            &table.GetWeights()[0], 0, 0,
+                            0, table.GetNumStencils());
+    return table.GetNumStencils();
+}
+
+static int
+BenchCpuPatches(TestData & data, int derivatives) {
+
+    int numCoords = (int)data.patchCoords.size();
+    if (numCoords == 0) return 0;
+
+    Osd::CpuPatchTable const & table = *data.cpuPatchTable;
+
+    Osd::BufferDescriptor srcDesc(0, 3, 3);
+    Osd::BufferDescriptor dstDesc(0, 3, 3);
+    Osd::BufferDescriptor noDesc;
+
+    float * dst = &data.patchResults[0];
+    float * dstDeriv = derivatives ? dst : 0;
+
+    Osd::CpuEvalPatches(&data.vertices[0], srcDesc, dst, dstDesc,
+                        dstDeriv, dstDeriv ? dstDesc : noDesc,
+                        dstDeriv, dstDeriv ? dstDesc : noDesc,
+                        0, noDesc, 0, noDesc, 0, noDesc,
+                        &data.patchCoords[0], 0,
+                        table.GetPatchArrayBuffer(),
+                        table.GetPatchIndexBuffer(),
+                        table.GetPatchParamBuffer(),
+                        0, numCoords);
+    return numCoords;
+}
+
+static void
+initBenchmarks(std::vector<Benchmark> & benchmarks) {
+
+    static int const valences[] = { 3, 4, 5, 6, 8, 12 };
+    char name[64];
+    for (int i = 0; i < (int)(sizeof(valences) / sizeof(int)); ++i) {
+        int v = valences[i];
+        snprintf(name, sizeof(name), "sdc/catmarkSmoothMask/%d", v);
+        benchmarks.push_back(Benchmark(name, BenchCatmarkSmoothMask, v));
+        snprintf(name, sizeof(name), "sdc/catmarkCreaseMask/%d", v);
+        benchmarks.push_back(Benchmark(name, BenchCatmarkCreaseMask, v));
+        snprintf(name, sizeof(name), "sdc/catmarkBoundaryMask/%d", v);
+        benchmarks.push_back(Benchmark(name, BenchCatmarkBoundaryMask, v));
+        snprintf(name, sizeof(name), "sdc/loopSmoothMask/%d", v);
+        benchmarks.push_back(Benchmark(name, BenchLoopSmoothMask, v));
+    }
+
+    typedef Far::PatchDescriptor Desc;
+    benchmarks.push_back(Benchmark("far/patchBasis/quads",
+                                   BenchPatchBasis, Desc::QUADS));
+    benchmarks.push_back(Benchmark("far/patchBasis/triangles",
+                                   BenchPatchBasis, Desc::TRIANGLES));
+    benchmarks.push_back(Benchmark("far/patchBasis/regular",
+                                   BenchPatchBasis, Desc::REGULAR));
+    benchmarks.push_back(Benchmark("far/patchBasis/loop",
+                                   BenchPatchBasis, Desc::LOOP));
+    benchmarks.push_back(Benchmark("far/patchBasis/gregoryBasis",
+                                   BenchPatchBasis, Desc::GREGORY_BASIS));
+    benchmarks.push_back(Benchmark("far/patchBasis/gregoryTriangle",
+                                   BenchPatchBasis, Desc::GREGORY_TRIANGLE));
+
+    benchmarks.push_back(Benchmark("far/patchMapFindPatch",
+                                   BenchPatchMapFindPatch));
+    benchmarks.push_back(Benchmark("far/stencilBuilder/coarse",
+                                   BenchStencilBuilder, 0));
+    benchmarks.push_back(Benchmark("far/stencilBuilder/factorized",
+                                   BenchStencilBuilder, 1));
+
+    benchmarks.push_back(Benchmark("vtr/levelTopology",
+                                   BenchLevelTopology));
+
+    benchmarks.push_back(Benchmark("osd/cpuStencils",
+                                   BenchCpuStencils, 0));
+    benchmarks.push_back(Benchmark("osd/cpuStencils/reproducible",
+                                   BenchCpuStencils, 1));
+    benchmarks.push_back(Benchmark("osd/cpuStencils/derivatives",
+                                   BenchCpuStencilsDerivatives));
+    benchmarks.push_back(Benchmark("osd/cpuStencils/double",
+                                   BenchCpuStencilsDouble));
+    benchmarks.push_back(Benchmark("osd/cpuStencils/soa",
+                                   BenchCpuStencilsSoa));
+    benchmarks.push_back(Benchmark("osd/cpuPatches",
+                                   BenchCpuPatches, 0));
+    benchmarks.push_back(Benchmark("osd/cpuPatches/derivatives",
+                                   BenchCpuPatches, 1));
+}
+
+//------------------------------------------------------------------------------
+
+struct BenchmarkResult {
+    BenchmarkResult() : timePerOp(0), numOps(0) { }
+
+    double timePerOp;
+    long   numOps;
+};
+
+static BenchmarkResult
+RunBenchmark(Benchmark const & benchmark, TestData & data,
+             TestOptions const & options) {
+
+    BenchmarkResult result;
+
+    //  Warm up once before timing:
+    if (benchmark.func(data, benchmark.param) == 0) {
+        return result;
+    }
+
+    Stopwatch s;
+    do {
+        s.Start();
+        result.numOps += benchmark.func(data, benchmark.param);
+        s.Stop();
+    } while (s.GetTotalElapsed() < options.minTime);
+
+    result.timePerOp = s.GetTotalElapsed() / (double)result.numOps;
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+static int
+parseIntArg(char const * argString, int dfltValue = 0) {
+    char *argEndptr;
+    int argValue = strtol(argString, &argEndptr, 10);
+    if (*argEndptr != 0) {
+        fprintf(stderr,
+                "Warning: non-integer option parameter '%s' ignored\n",
+                argString);
+        argValue = dfltValue;
+    }
+    return argValue;
+}
+
+static void
+usage(char const * program) {
+    printf("Usage: %s [options] [file.obj]\n", program);
+    printf("  -f <filter>       run only the benchmarks whose name contains\n");
+    printf("                    the given string\n");
+    printf("  -l <level>        adaptive refinement level (default 2)\n");
+    printf("  -s <samples>      patch coords per ptex face edge (default 4)\n");
+    printf("  -t <seconds>      minimum time of each benchmark (default 0.1)\n");
+    printf("  -bilinear, -catmark, -loop  scheme of a given .obj file\n");
+    printf("  -csv              print results as comma separated values\n");
+    printf("  -list             list the benchmarks without running them\n");
+}
+
+int main(int argc, char **argv)
+{
+    TestOptions testOptions;
+    std::string filter;
+    std::string objFile;
+    Scheme defaultScheme = kCatmark;
+    bool csvFormat = false;
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strstr(argv[i], ".obj")) {
+            objFile = argv[i];
+        } else if (!strcmp(argv[i], "-f")) {
+            if (++i < argc) filter = argv[i];
+        } else if (!strcmp(argv[i], "-l")) {
+            if (++i < argc) testOptions.refineLevel =
+                std::max(1, parseIntArg(argv[i], testOptions.refineLevel));
+        } else if (!strcmp(argv[i], "-s")) {
+            if (++i < argc) testOptions.samplesPerFace =
+                std::max(1, parseIntArg(argv[i], testOptions.samplesPerFace));
+        } else if (!strcmp(argv[i], "-t")) {
+            if (++i < argc) testOptions.minTime = atof(argv[i]);
+        } else if (!strcmp(argv[i], "-bilinear")) {
+            defaultScheme = kBilinear;
+        } else if (!strcmp(argv[i], "-catmark")) {
+            defaultScheme = kCatmark;
+        } else if (!strcmp(argv[i], "-loop")) {
+            defaultScheme = kLoop;
+        } else if (!strcmp(argv[i], "-csv")) {
+            csvFormat = true;
+        } else if (!strcmp(argv[i], "-list")) {
+            listOnly = true;
+        } else if (!strcmp(argv[i], "-h")) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr,
+                "Warning: unrecognized argument '%s' ignored\n", argv[i]);
+        }
+    }
+
+    std::vector<Benchmark> benchmarks;
+    initBenchmarks(benchmarks);
+
+    if (listOnly) {
+        for (size_t i = 0; i < benchmarks.size(); ++i) {
+            printf("%s\n", benchmarks[i].name.c_str());
+        }
+        return 0;
+    }
+
+    if (!objFile.empty()) {
+        std::string objString;
+        if (readShapeFile(objFile.c_str(), objString)) {
+            g_shapes.push_back(
+                ShapeDesc(objFile.c_str(), objString, defaultScheme));
+        } else {
+            fprintf(stderr,
+                "Warning: cannot open shape file '%s'\n", objFile.c_str());
+        }
+    }
+    if (g_shapes.empty()) {
+        initShapes();
+    }
+
+    //  The tables of the shape are shared by all benchmarks:
+    ShapeDesc const & shapeDesc = g_shapes[0];
+    Shape const * shape = Shape::parseObj(shapeDesc);
+    TestData * data = CreateTestData(*shape, testOptions);
+
+    if (csvFormat) {
+        printf("benchmark,time_ns,operations\n");
+    } else {
+        printf("%s: %d control vertices, %d stencils, %d patch coords\n",
+            shapeDesc.name.c_str(), data->numControlVertices,
+            data->stencilTable->GetNumStencils(),
+            (int)data->patchCoords.size());
+        printf("  %-36s %12s %12s\n", "benchmark", "time ns/op", "operations");
+    }
+
+    for (size_t i = 0; i < benchmarks.size(); ++i) {
+        Benchmark const & benchmark = benchmarks[i];
+        if (!filter.empty() &&
+            benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        BenchmarkResult result = RunBenchmark(benchmark, *data, testOptions);
+
+        if (csvFormat) {
+            printf("%s,%g,%ld\n", benchmark.name.c_str(),
+                result.timePerOp * 1.0e9, result.numOps);
+        } else {
+            printf("  %-36s %12.2f %12ld\n", benchmark.name.c_str(),
+                result.timePerOp * 1.0e9, result.numOps);
+        }
+    }
+
+    delete data;
+    delete shape;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,726 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opensubdiv/far/patchMap.h>
+#include <opensubdiv/far/patchTableFactory.h>
+#include <opensubdiv/far/ptexIndices.h>
+#include <opensubdiv/far/stencilTableFactory.h>
+
+#include <opensubdiv/osd/mesh.h>
+#include <opensubdiv/osd/cpuEvaluator.h>
+#include <opensubdiv/osd/cpuPatchTable.h>
+#include <opensubdiv/osd/cpuVertexBuffer.h>
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <opensubdiv/osd/ompEvaluator.h>
+#endif
+
+#ifdef OPENSUBDIV_HAS_TBB
+    #include <opensubdiv/osd/tbbEvaluator.h>
+#endif
+
+#ifdef OPENSUBDIV_HAS_CUDA
+    #include <cuda_runtime.h>
+    #include <opensubdiv/osd/cudaEvaluator.h>
+    #include <opensubdiv/osd/cudaPatchTable.h>
+    #include <opensubdiv/osd/cudaVertexBuffer.h>
+#endif
+
+#include "../../regression/common/far_utils.h"
+#include "../../examples/common/objAnim.h"
+#include "../../examples/common/stopwatch.h"
+
+#include "../shapes/catmark_car.h"
+
+//------------------------------------------------------------------------------
+//
+//  Playback of an animated cache: the topology and the tables are built once
+//  from the first frame, and each frame then interpolates the coarse positions,
+//  uploads them and evaluates the stencils and patches -- the per-frame work
+//  of an application playing back deforming geometry.  The latency of each of
+//  these phases is measured for every frame and reported as percentiles.
+//
+
+using namespace OpenSubdiv;
+
+enum Backend {
+    kCPU = 0,
+    kOPENMP,
+    kTBB,
+    kCUDA,
+    kNumBackends
+};
+
+static char const * g_backendNames[kNumBackends] = {
+    "CPU", "OpenMP", "TBB", "CUDA"
+};
+
+enum Phase {
+    kInterpolate = 0,
+    kUpload,
+    kStencils,
+    kPatches,
+    kFrame,
+    kNumPhases
+};
+
+static char const * g_phaseNames[kNumPhases] = {
+    "interpolate", "upload", "stencils", "patches", "frame"
+};
+
+struct TestOptions {
+    TestOptions() :
+        refineLevel(2),
+        refineAdaptive(true),
+        evalDerivatives(false),
+        samplesPerFace(4),
+        numFrames(240),
+        endCapType(Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS) { }
+
+    int  refineLevel;
+    bool refineAdaptive;
+    bool evalDerivatives;
+    int  samplesPerFace;
+    int  numFrames;
+
+    Far::PatchTableFactory::Options::EndCapType endCapType;
+};
+
+//
+//  The animated positions -- either the key-frames of an ObjAnim or, when no
+//  sequence is given, key-frames deforming a built-in shape procedurally:
+//
+class Animation {
+public:
+    Animation(ObjAnim const * objAnim) :
+        _objAnim(objAnim), _shape(objAnim->GetShape()) { }
+
+    Animation(Shape const * shape, int numKeyframes) :
+        _objAnim(0), _shape(shape) {
+
+        int numVerts = shape->GetNumVertices();
+
+        //  Twist the shape about its vertical axis by a varying angle:
+        _keyframes.resize(numKeyframes);
+        for (int key = 0; key < numKeyframes; ++key) {
+            float twist = 0.5f * sinf(6.2831853f * key / numKeyframes);
+
+            std::vector<float> & positions = _keyframes[key];
+            positions.resize(numVerts * 3);
+            for (int i = 0; i < numVerts; ++i) {
+                float const * src = &shape->verts[i * 3];
+                float angle = twist * src[2];
+                float c = cosf(angle);
+                float s = sinf(angle);
+                positions[i*3 + 0] = c * src[0] - s * src[1];
+                positions[i*3 + 1] = s * src[0] + c * src[1];
+                positions[i*3 + 2] = src[2];
+            }
+        }
+    }
+
+    ~Animation() {
+        if (_objAnim) {
+            delete _objAnim;
+        } else {
+            delete _shape;
+        }
+    }
+
+    Shape const * GetShape() const { return _shape; }
+
+    int GetNumKeyframes() const {
+        return _objAnim ? _objAnim->GetNumKeyframes() : (int)_keyframes.size();
+    }
+
+    //  Interpolates as ObjAnim does, at 24 key-frames per second:
+    void InterpolatePositions(float time, float * positions, int stride) const {
+        if (_objAnim) {
+            _objAnim->InterpolatePositions(time, positions, stride);
+            return;
+        }
+        int nkeys  = (int)_keyframes.size();
+        int nverts = _shape->GetNumVertices();
+
+        float p = fmodf(time * 24.0f, (float)nkeys);
+        int   key = (int)p;
+        float b = p - key;
+
+        float const * p0 = &_keyframes[key][0];
+        float const * p1 = &_keyframes[(key + 1) % nkeys][0];
+        for (int i = 0; i < nverts; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                positions[i*stride + j] = p0[i*3 + j] * (1 - b) +
+                                          p1[i*3 + j] * b;
+            }
+        }
+    }
+
+private:
+    ObjAnim const * _objAnim;
+    Shape const *   _shape;
+
+    std::vector<std::vector<float> > _keyframes;
+};
+
+//
+//  Tables shared by all backends, built once for the animation:
+//
+struct TestData {
+    TestData() : stencilTable(0), patchTable(0) { }
+    ~TestData() {
+        delete stencilTable;
+        delete patchTable;
+    }
+
+    Far::StencilTable const * stencilTable;
+    Far::PatchTable const *   patchTable;
+
+    std::vector<Osd::PatchCoord> patchCoords;
+
+    int numControlVertices;
+    int numTotalVertices;
+};
+
+struct TestResult {
+    TestResult() :
+        backend(kCPU),
+        numFrames(0) { }
+
+    Backend backend;
+    int     numFrames;
+
+    //  Latency of each phase for every frame (seconds):
+    std::vector<double> times[kNumPhases];
+};
+
+//------------------------------------------------------------------------------
+
+static TestData *
+CreateTestData(Shape const & shape, TestOptions const & options) {
+
+    Sdc::SchemeType sdcType = GetSdcType(shape);
+    Sdc::Options sdcOptions = GetSdcOptions(shape);
+
+    Far::TopologyRefiner * refiner = Far::TopologyRefinerFactory<Shape>::Create(
+        shape, Far::TopologyRefinerFactory<Shape>::Options(sdcType, sdcOptions));
+    assert(refiner);
+
+    Far::PatchTableFactory::Options poptions(options.refineLevel);
+    poptions.SetEndCapType(options.endCapType);
+
+    if (options.refineAdaptive) {
+        refiner->RefineAdaptive(poptions.GetRefineAdaptiveOptions());
+    } else {
+        Far::TopologyRefiner::UniformOptions uoptions(options.refineLevel);
+        uoptions.fullTopologyInLastLevel = true;
+        refiner->RefineUniform(uoptions);
+    }
+
+    TestData * data = new TestData;
+
+    Far::StencilTableFactory::Options soptions;
+    soptions.generateOffsets = true;
+    soptions.generateIntermediateLevels = options.refineAdaptive;
+
+    Far::StencilTable * stencilTable = const_cast<Far::StencilTable *>(
+        Far::StencilTableFactory::Create(*refiner, soptions));
+
+    data->patchTable = Far::PatchTableFactory::Create(*refiner, poptions);
+
+    //  Append the local points of the patch table to the stencils:
+    Far::StencilTableFactory::AppendLocalPointStencilTable(*refiner,
+        *stencilTable, data->patchTable->GetLocalPointStencilTable());
+    data->stencilTable = stencilTable;
+
+    data->numControlVertices = refiner->GetLevel(0).GetNumVertices();
+    data->numTotalVertices   = data->numControlVertices +
+                               stencilTable->GetNumStencils();
+
+    //  Sample each ptex face uniformly:
+    Far::PtexIndices ptexIndices(*refiner);
+    Far::PatchMap patchMap(*data->patchTable);
+
+    int numFaces = ptexIndices.GetNumFaces();
+    int n = options.samplesPerFace;
+
+    data->patchCoords.reserve(numFaces * n * n);
+    for (int face = 0; face < numFaces; ++face) {
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                float s = (i + 0.5f) / n;
+                float t = (j + 0.5f) / n;
+
+                Far::PatchTable::PatchHandle const * handle =
+                    patchMap.FindPatch(face, s, t);
+                if (handle) {
+                    data->patchCoords.push_back(Osd::PatchCoord(*handle, s, t));
+                }
+            }
+        }
+    }
+
+    delete refiner;
+    return data;
+}
+
+//------------------------------------------------------------------------------
+
+//
+//  Play back the animation with a given backend, timing each phase of every
+//  frame:
+//
+template <typename VERTEX_BUFFER, typename STENCIL_TABLE,
+          typename PATCH_TABLE, typename EVALUATOR,
+          typename DEVICE_CONTEXT>
+static TestResult
+RunBackend(Backend backend, Animation const & anim, TestData const & data,
+           TestOptions const & options,
+           Osd::EvaluatorCacheT<EVALUATOR> * evaluatorCache,
+           DEVICE_CONTEXT * deviceContext) {
+
+    int const width    = 3;
+    int numPatchCoords = (int) data.patchCoords.size();
+    int numFrames      = options.numFrames;
+
+    TestResult result;
+    result.backend   = backend;
+    result.numFrames = numFrames;
+    for (int i = 0; i < kNumPhases; ++i) {
+        result.times[i].reserve(numFrames);
+    }
+
+    int derivWidth = options.evalDerivatives ? (2 * width) : 0;
+
+    VERTEX_BUFFER * srcBuffer = VERTEX_BUFFER::Create(
+        width, data.numTotalVertices, deviceContext);
+    VERTEX_BUFFER * dstBuffer = VERTEX_BUFFER::Create(
+        width, std::max(numPatchCoords, 1), deviceContext);
+    VERTEX_BUFFER * derivBuffer = options.evalDerivatives
+        ? VERTEX_BUFFER::Create(derivWidth, std::max(numPatchCoords, 1),
+                                deviceContext)
+        : 0;
+    VERTEX_BUFFER * patchCoordBuffer = VERTEX_BUFFER::Create(
+        5, std::max(numPatchCoords, 1), deviceContext);
+
+    if (numPatchCoords) {
+        patchCoordBuffer->UpdateData((float const *)&data.patchCoords[0], 0,
+                                     numPatchCoords, deviceContext);
+    }
+
+    STENCIL_TABLE const * stencilTable =
+        Osd::convertToCompatibleStencilTable<STENCIL_TABLE>(
+            data.stencilTable, deviceContext);
+
+    PATCH_TABLE * patchTable =
+        PATCH_TABLE::Create(data.patchTable, deviceContext);
+
+    Osd::BufferDescriptor srcDesc(0, width, width);
+    Osd::BufferDescriptor dstDesc(data.numControlVertices * width,
+                                  width, width);
+    Osd::BufferDescriptor patchDesc(0, width, width);
+    Osd::BufferDescriptor duDesc(0,     width, derivWidth);
+    Osd::BufferDescriptor dvDesc(width, width, derivWidth);
+
+    EVALUATOR const * stencilInstance = Osd::GetEvaluator<EVALUATOR>(
+        evaluatorCache, srcDesc, dstDesc, deviceContext);
+    EVALUATOR const * patchInstance = options.evalDerivatives
+        ? Osd::GetEvaluator<EVALUATOR>(evaluatorCache,
+              srcDesc, patchDesc, duDesc, dvDesc, deviceContext)
+        : Osd::GetEvaluator<EVALUATOR>(evaluatorCache,
+              srcDesc, patchDesc, deviceContext);
+
+    std::vector<float> positions(data.numControlVertices * width);
+
+    //  The first frame warms up (compiling kernels and transferring data)
+    //  and is not recorded:
+    for (int frame = -1; frame < numFrames; ++frame) {
+        float time = (float)std::max(frame, 0) / 24.0f;
+
+        Stopwatch s[kNumPhases];
+
+        s[kFrame].Start();
+
+        s[kInterpolate].Start();
+        anim.InterpolatePositions(time, &positions[0], width);
+        s[kInterpolate].Stop();
+
+        s[kUpload].Start();
+        srcBuffer->UpdateData(&positions[0], 0,
+                              data.numControlVertices, deviceContext);
+        EVALUATOR::Synchronize(deviceContext);
+        s[kUpload].Stop();
+
+        s[kStencils].Start();
+        EVALUATOR::EvalStencils(srcBuffer, srcDesc, srcBuffer, dstDesc,
+                                stencilTable, stencilInstance, deviceContext);
+        EVALUATOR::Synchronize(deviceContext);
+        s[kStencils].Stop();
+
+        s[kPatches].Start();
+        if (numPatchCoords) {
+            if (options.evalDerivatives) {
+                EVALUATOR::EvalPatches(srcBuffer, srcDesc,
+                                       dstBuffer, patchDesc,
+                                       derivBuffer, duDesc,
+                                       derivBuffer, dvDesc,
+                                       numPatchCoords, patchCoordBuffer,
+                                       patchTable, patchInstance,
+                                       deviceContext);
+            } else {
+                EVALUATOR::EvalPatches(srcBuffer, srcDesc,
+                                       dstBuffer, patchDesc,
+                                       numPatchCoords, patchCoordBuffer,
+                                       patchTable, patchInstance,
+                                       deviceContext);
+            }
+            EVALUATOR::Synchronize(deviceContext);
+        }
+        s[kPatches].Stop();
+
+        s[kFrame].Stop();
+
+        if (frame >= 0) {
+            for (int i = 0; i < kNumPhases; ++i) {
+                result.times[i].push_back(s[i].GetElapsed());
+            }
+        }
+    }
+
+    delete srcBuffer;
+    delete dstBuffer;
+    delete derivBuffer;
+    delete patchCoordBuffer;
+    delete stencilTable;
+    delete patchTable;
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+//
+//  Availability of each backend in this build (and on this machine for those
+//  requiring a device):
+//
+struct Backends {
+    Backends() {
+        for (int i = 0; i < kNumBackends; ++i) available[i] = false;
+        available[kCPU] = true;
+#ifdef OPENSUBDIV_HAS_OPENMP
+        available[kOPENMP] = true;
+#endif
+#ifdef OPENSUBDIV_HAS_TBB
+        available[kTBB] = true;
+#endif
+#ifdef OPENSUBDIV_HAS_CUDA
+        int deviceCount = 0;
+        if ((cudaGetDeviceCount(&deviceCount) == cudaSuccess) &&
+            (deviceCount > 0)) {
+            available[kCUDA] = (cudaSetDevice(0) == cudaSuccess);
+        }
+#endif
+    }
+
+    bool available[kNumBackends];
+};
+
+static TestResult
+RunPerfTest(Backend backend, Animation const & anim, TestData const & data,
+            TestOptions const & options) {
+
+    switch (backend) {
+    case kCPU:
+        return RunBackend<Osd::CpuVertexBuffer, Far::StencilTable,
+                          Osd::CpuPatchTable, Osd::CpuEvaluator, void>(
+            backend, anim, data, options, NULL, NULL);
+#ifdef OPENSUBDIV_HAS_OPENMP
+    case kOPENMP:
+        return RunBackend<Osd::CpuVertexBuffer, Far::StencilTable,
+                          Osd::CpuPatchTable, Osd::OmpEvaluator, void>(
+            backend, anim, data, options, NULL, NULL);
+#endif
+#ifdef OPENSUBDIV_HAS_TBB
+    case kTBB:
+        return RunBackend<Osd::CpuVertexBuffer, Far::StencilTable,
+                          Osd::CpuPatchTable, Osd::TbbEvaluator, void>(
+            backend, anim, data, options, NULL, NULL);
+#endif
+#ifdef OPENSUBDIV_HAS_CUDA
+    case kCUDA:
+        return RunBackend<Osd::CudaVertexBuffer, Osd::CudaStencilTable,
+                          Osd::CudaPatchTable, Osd::CudaEvaluator, void>(
+            backend, anim, data, options, NULL, NULL);
+#endif
+    default:
+        break;
+    }
+    assert("Unavailable backend" == 0);
+    return TestResult();
+}
+
+//------------------------------------------------------------------------------
+
+struct PrintOptions {
+    PrintOptions() : csvFormat(false) { }
+
+    bool csvFormat;
+};
+
+//  Nearest-rank percentile of a sorted sequence:
+static double
+GetPercentile(std::vector<double> const & sorted, double percent) {
+
+    if (sorted.empty()) return 0;
+
+    int rank = (int) ceil(percent * 0.01 * (double)sorted.size());
+    return sorted[std::min(std::max(rank, 1), (int)sorted.size()) - 1];
+}
+
+static void
+PrintHeader(char const * name, TestData const & data,
+            TestOptions const & options, PrintOptions const & ) {
+
+    printf("%s: level %d (%s), %d control vertices, %d stencils, "
+           "%d patch coords%s\n", name, options.refineLevel,
+           options.refineAdaptive ? "adaptive" : "uniform",
+           data.numControlVertices, data.stencilTable->GetNumStencils(),
+           (int) data.patchCoords.size(),
+           options.evalDerivatives ? " with derivatives" : "");
+}
+
+static void
+PrintResult(TestResult const & result, PrintOptions const & ) {
+
+    printf("  %-7s %d frames     p50 ms     p90 ms     p99 ms     max ms\n",
+           g_backendNames[result.backend], result.numFrames);
+
+    for (int i = 0; i < kNumPhases; ++i) {
+        std::vector<double> sorted = result.times[i];
+        std::sort(sorted.begin(), sorted.end());
+
+        printf("    %-14s %10.4f %10.4f %10.4f %10.4f\n", g_phaseNames[i],
+               GetPercentile(sorted, 50) * 1000.0,
+               GetPercentile(sorted, 90) * 1000.0,
+               GetPercentile(sorted, 99) * 1000.0,
+               sorted.empty() ? 0.0 : sorted.back() * 1000.0);
+    }
+}
+
+static void
+PrintHeaderCSV(PrintOptions const & ) {
+
+    // spreadsheet header row
+    printf("shape,level,backend,frames,phase,p50,p90,p99,max\n");
+}
+
+static void
+PrintResultCSV(char const * name, TestOptions const & options,
+               TestResult const & result, PrintOptions const & ) {
+
+    // spreadsheet data rows, one per phase
+    for (int i = 0; i < kNumPhases; ++i) {
+        std::vector<double> sorted = result.times[i];
+        std::sort(sorted.begin(), sorted.end());
+
+        printf("%s,%d,%s,%d,%s", name, options.refineLevel,
+               g_backendNames[result.backend], result.numFrames,
+               g_phaseNames[i]);
+        printf(",%g,%g,%g,%g\n",
+               GetPercentile(sorted, 50), GetPercentile(sorted, 90),
+               GetPercentile(sorted, 99),
+               sorted.empty() ? 0.0 : sorted.back());
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static int
+parseIntArg(char const * argString, int dfltValue = 0) {
+    char *argEndptr;
+    int argValue = strtol(argString, &argEndptr, 10);
+    if (*argEndptr != 0) {
+        fprintf(stderr,
+                "Warning: non-integer option parameter '%s' ignored\n",
+                argString);
+        argValue = dfltValue;
+    }
+    return argValue;
+}
+
+static void
+usage(char const * program) {
+    printf("Usage: %s [options] [frame.obj ...]\n", program);
+    printf("  frame.obj ...     key-frames of the animation, sharing their\n");
+    printf("                    topology (a deforming built-in shape if none)\n");
+    printf("  -a | -u           adaptive (default) or uniform refinement\n");
+    printf("  -l <level>        refinement level (default 2)\n");
+    printf("  -f <frames>       number of frames played back (default 240)\n");
+    printf("  -s <samples>      patch coords per ptex face edge (default 4)\n");
+    printf("  -d                evaluate patches with first derivatives\n");
+    printf("  -e <type>         end cap type: linear, regular or gregory\n");
+    printf("  -bilinear, -catmark, -loop  scheme of given .obj files\n");
+    printf("  -cpu -omp -tbb -cuda\n");
+    printf("                    backends to run (all available by default)\n");
+    printf("  -csv              print results as comma separated values\n");
+}
+
+int main(int argc, char **argv)
+{
+    TestOptions testOptions;
+    PrintOptions printOptions;
+    std::vector<char const *> objFiles;
+    Scheme defaultScheme = kCatmark;
+
+    bool backendRequested[kNumBackends];
+    bool anyBackendRequested = false;
+    for (int i = 0; i < kNumBackends; ++i) backendRequested[i] = false;
+
+    for (int i = 1; i < argc; ++i) {
+        Backend requested = kNumBackends;
+
+        if (strstr(argv[i], ".obj")) {
+            objFiles.push_back(argv[i]);
+        } else if (!strcmp(argv[i], "-a")) {
+            testOptions.refineAdaptive = true;
+        } else if (!strcmp(argv[i], "-u")) {
+            testOptions.refineAdaptive = false;
+        } else if (!strcmp(argv[i], "-l")) {
+            if (++i < argc) testOptions.refineLevel =
+                parseIntArg(argv[i], testOptions.refineLevel);
+        } else if (!strcmp(argv[i], "-f")) {
+            if (++i < argc) testOptions.numFrames =
+                std::max(1, parseIntArg(argv[i], testOptions.numFrames));
+        } else if (!strcmp(argv[i], "-s")) {
+            if (++i < argc) testOptions.samplesPerFace =
+                std::max(1, parseIntArg(argv[i], testOptions.samplesPerFace));
+        } else if (!strcmp(argv[i], "-d")) {
+            testOptions.evalDerivatives = true;
+        } else if (!strcmp(argv[i], "-bilinear")) {
+            defaultScheme = kBilinear;
+        } else if (!strcmp(argv[i], "-catmark")) {
+            defaultScheme = kCatmark;
+        } else if (!strcmp(argv[i], "-loop")) {
+            defaultScheme = kLoop;
+        } else if (!strcmp(argv[i], "-e")) {
+            char const * type = (++i < argc) ? argv[i] : "";
+            if (!strcmp(type, "linear")) {
+                testOptions.endCapType =
+                        Far::PatchTableFactory::Options::ENDCAP_BILINEAR_BASIS;
+            } else if (!strcmp(type, "regular")) {
+                testOptions.endCapType =
+                        Far::PatchTableFactory::Options::ENDCAP_BSPLINE_BASIS;
+            } else if (!strcmp(type, "gregory")) {
+                testOptions.endCapType =
+                        Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS;
+            } else {
+                fprintf(stderr, "Error: Unknown endcap type %s\n", type);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-cpu")) {
+            requested = kCPU;
+        } else if (!strcmp(argv[i], "-omp")) {
+            requested = kOPENMP;
+        } else if (!strcmp(argv[i], "-tbb")) {
+            requested = kTBB;
+        } else if (!strcmp(argv[i], "-cuda")) {
+            requested = kCUDA;
+        } else if (!strcmp(argv[i], "-csv")) {
+            printOptions.csvFormat = true;
+        } else if (!strcmp(argv[i], "-h")) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr,
+                "Warning: unrecognized argument '%s' ignored\n", argv[i]);
+        }
+        if (requested != kNumBackends) {
+            backendRequested[requested] = true;
+            anyBackendRequested = true;
+        }
+    }
+
+    Backends backends;
+
+    std::vector<Backend> backendsToRun;
+    for (int i = 0; i < kNumBackends; ++i) {
+        if (anyBackendRequested && !backendRequested[i]) continue;
+
+        if (backends.available[i]) {
+            backendsToRun.push_back((Backend) i);
+        } else if (anyBackendRequested) {
+            fprintf(stderr, "Warning: backend %s is not available\n",
+                    g_backendNames[i]);
+        }
+    }
+
+    Animation * anim = 0;
+    char const * name = "catmark_car";
+    if (!objFiles.empty()) {
+        ObjAnim const * objAnim = ObjAnim::Create(objFiles, defaultScheme);
+        if (!objAnim) {
+            fprintf(stderr, "Error: cannot read the animation\n");
+            return 1;
+        }
+        anim = new Animation(objAnim);
+        name = objFiles[0];
+    } else {
+        anim = new Animation(
+            Shape::parseObj(ShapeDesc(name, catmark_car, kCatmark)), 24);
+    }
+
+    //  Build the tables once, then play back the animation with each backend:
+    TestData * data = CreateTestData(*anim->GetShape(), testOptions);
+
+    if (printOptions.csvFormat) {
+        PrintHeaderCSV(printOptions);
+    } else {
+        PrintHeader(name, *data, testOptions, printOptions);
+    }
+    for (size_t b = 0; b < backendsToRun.size(); ++b) {
+        TestResult result = RunPerfTest(backendsToRun[b], *anim,
+                                        *data, testOptions);
+        if (printOptions.csvFormat) {
+            PrintResultCSV(name, testOptions, result, printOptions);
+        } else {
+            PrintResult(result, printOptions);
+        }
+    }
+
+    delete data;
+    delete anim;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
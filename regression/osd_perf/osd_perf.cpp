@@ -0,0 +1,837 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#if defined(OSD_PERF_HAS_GLFW)
+    #include "glLoader.h"
+    #include <GLFW/glfw3.h>
+#endif
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opensubdiv/far/patchMap.h>
+#include <opensubdiv/far/patchTableFactory.h>
+#include <opensubdiv/far/ptexIndices.h>
+#include <opensubdiv/far/stencilTableFactory.h>
+
+#include <opensubdiv/osd/mesh.h>
+#include <opensubdiv/osd/cpuEvaluator.h>
+#include <opensubdiv/osd/cpuPatchTable.h>
+#include <opensubdiv/osd/cpuVertexBuffer.h>
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <opensubdiv/osd/ompEvaluator.h>
+#endif
+
+#ifdef OPENSUBDIV_HAS_TBB
+    #include <opensubdiv/osd/tbbEvaluator.h>
+#endif
+
+#ifdef OPENSUBDIV_HAS_CUDA
+    #include <cuda_runtime.h>
+    #include <opensubdiv/osd/cudaEvaluator.h>
+    #include <opensubdiv/osd/cudaPatchTable.h>
+    #include <opensubdiv/osd/cudaVertexBuffer.h>
+#endif
+
+#ifdef OPENSUBDIV_HAS_OPENCL
+    #include <opensubdiv/osd/clEvaluator.h>
+    #include <opensubdiv/osd/clPatchTable.h>
+    #include <opensubdiv/osd/clVertexBuffer.h>
+#endif
+
+#if defined(OPENSUBDIV_HAS_GLSL_COMPUTE) && defined(OSD_PERF_HAS_GLFW)
+    #include <opensubdiv/osd/glComputeEvaluator.h>
+    #include <opensubdiv/osd/glPatchTable.h>
+    #include <opensubdiv/osd/glVertexBuffer.h>
+    #define OSD_PERF_HAS_GLSL_COMPUTE
+#endif
+
+#include "../../regression/common/far_utils.h"
+#include "../../examples/common/stopwatch.h"
+
+#include "init_shapes.h"
+
+//------------------------------------------------------------------------------
+
+using namespace OpenSubdiv;
+
+enum Backend {
+    kCPU = 0,
+    kOPENMP,
+    kTBB,
+    kCUDA,
+    kCL,
+    kGLCompute,
+    kNumBackends
+};
+
+static char const * g_backendNames[kNumBackends] = {
+    "CPU", "OpenMP", "TBB", "CUDA", "OpenCL", "GLCompute"
+};
+
+struct TestOptions {
+    TestOptions() :
+        refineLevel(2),
+        refineAdaptive(true),
+        evalDerivatives(false),
+        primvarWidth(3),
+        samplesPerFace(4),
+        minTime(0.1),
+        endCapType(Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS) { }
+
+    int    refineLevel;
+    bool   refineAdaptive;
+    bool   evalDerivatives;
+    int    primvarWidth;
+    int    samplesPerFace;
+    double minTime;
+
+    Far::PatchTableFactory::Options::EndCapType endCapType;
+};
+
+//
+//  Topology and primvar data shared by all backends for a shape and level:
+//
+struct TestData {
+    TestData() : stencilTable(0), patchTable(0) { }
+    ~TestData() {
+        delete stencilTable;
+        delete patchTable;
+    }
+
+    Far::StencilTable const * stencilTable;
+    Far::PatchTable const *   patchTable;
+
+    std::vector<Osd::PatchCoord> patchCoords;
+
+    //  Values of the control vertices (the primvar width is the stride):
+    std::vector<float> coarseValues;
+
+    int numControlVertices;
+    int numTotalVertices;
+};
+
+struct TestResult {
+    TestResult() :
+        level(-1),
+        width(0),
+        backend(kCPU),
+        numStencils(0),
+        numPatchCoords(0),
+        timeStencils(0),
+        timePatches(0),
+        tableBytes(0),
+        bufferBytes(0) { }
+
+    std::string name;
+    int level;
+    int width;
+    Backend backend;
+
+    int numStencils;
+    int numPatchCoords;
+
+    //  Average time of a single evaluation:
+    double timeStencils;
+    double timePatches;
+
+    //  Memory of the stencil and patch tables and the primvar buffers:
+    size_t tableBytes;
+    size_t bufferBytes;
+};
+
+//------------------------------------------------------------------------------
+
+static TestData *
+CreateTestData(Shape const & shape, TestOptions const & options) {
+
+    Sdc::SchemeType sdcType = GetSdcType(shape);
+    Sdc::Options sdcOptions = GetSdcOptions(shape);
+
+    Far::TopologyRefiner * refiner = Far::TopologyRefinerFactory<Shape>::Create(
+        shape, Far::TopologyRefinerFactory<Shape>::Options(sdcType, sdcOptions));
+    assert(refiner);
+
+    Far::PatchTableFactory::Options poptions(options.refineLevel);
+    poptions.SetEndCapType(options.endCapType);
+
+    if (options.refineAdaptive) {
+        refiner->RefineAdaptive(poptions.GetRefineAdaptiveOptions());
+    } else {
+        Far::TopologyRefiner::UniformOptions uoptions(options.refineLevel);
+        uoptions.fullTopologyInLastLevel = true;
+        refiner->RefineUniform(uoptions);
+    }
+
+    TestData * data = new TestData;
+
+    Far::StencilTableFactory::Options soptions;
+    soptions.generateOffsets = true;
+    soptions.generateIntermediateLevels = options.refineAdaptive;
+
+    Far::StencilTable const * stencilTable =
+        Far::StencilTableFactory::Create(*refiner, soptions);
+
+    data->patchTable = Far::PatchTableFactory::Create(*refiner, poptions);
+
+    //  Append the local points of the patch table to the stencils:
+    if (Far::StencilTable const * stencilTableWithLocalPoints =
+        Far::StencilTableFactory::AppendLocalPointStencilTable(
+            *refiner, stencilTable,
+            data->patchTable->GetLocalPointStencilTable())) {
+        delete stencilTable;
+        stencilTable = stencilTableWithLocalPoints;
+    }
+    data->stencilTable = stencilTable;
+
+    data->numControlVertices = refiner->GetLevel(0).GetNumVertices();
+    data->numTotalVertices   = data->numControlVertices +
+                               stencilTable->GetNumStencils();
+
+    //  Sample each ptex face uniformly:
+    Far::PtexIndices ptexIndices(*refiner);
+    Far::PatchMap patchMap(*data->patchTable);
+
+    int numFaces = ptexIndices.GetNumFaces();
+    int n = options.samplesPerFace;
+
+    data->patchCoords.reserve(numFaces * n * n);
+    for (int face = 0; face < numFaces; ++face) {
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                float s = (i + 0.5f) / n;
+                float t = (j + 0.5f) / n;
+
+                Far::PatchTable::PatchHandle const * handle =
+                    patchMap.FindPatch(face, s, t);
+                if (handle) {
+                    data->patchCoords.push_back(Osd::PatchCoord(*handle, s, t));
+                }
+            }
+        }
+    }
+
+    //  Assign the coarse positions to the first three components and
+    //  arbitrary values derived from them to the remaining:
+    int width = options.primvarWidth;
+    data->coarseValues.resize(data->numControlVertices * width);
+    for (int v = 0; v < data->numControlVertices; ++v) {
+        float * dst = &data->coarseValues[v * width];
+        for (int k = 0; k < width; ++k) {
+            dst[k] = (k < 3) ? shape.verts[v*3 + k]
+                             : shape.verts[v*3 + (k % 3)] * (float)k;
+        }
+    }
+
+    delete refiner;
+    return data;
+}
+
+static size_t
+GetStencilTableBytes(Far::StencilTable const & table) {
+
+    return table.GetSizes().size()          * sizeof(int) +
+           table.GetOffsets().size()        * sizeof(Far::Offset) +
+           table.GetControlIndices().size() * sizeof(Far::Index) +
+           table.GetWeights().size()        * sizeof(float);
+}
+
+static size_t
+GetPatchTableBytes(Far::PatchTable const & table) {
+
+    size_t numPatches = (size_t) table.GetNumPatchesTotal();
+
+    return table.GetPatchControlVerticesTable().size() * sizeof(Far::Index) +
+           table.GetNumPatchArrays() * sizeof(Osd::PatchArray) +
+           numPatches * sizeof(Osd::PatchParam);
+}
+
+//------------------------------------------------------------------------------
+
+//
+//  Run the evaluation of stencils and patches with a given backend, repeating
+//  each until the minimum time is reached:
+//
+template <typename VERTEX_BUFFER, typename STENCIL_TABLE,
+          typename PATCH_TABLE, typename EVALUATOR,
+          typename DEVICE_CONTEXT>
+static TestResult
+RunBackend(Backend backend, TestData const & data, TestOptions const & options,
+           Osd::EvaluatorCacheT<EVALUATOR> * evaluatorCache,
+           DEVICE_CONTEXT * deviceContext) {
+
+    int width          = options.primvarWidth;
+    int numPatchCoords = (int) data.patchCoords.size();
+    int numStencils    = data.stencilTable->GetNumStencils();
+
+    TestResult result;
+    result.level          = options.refineLevel;
+    result.width          = width;
+    result.backend        = backend;
+    result.numStencils    = numStencils;
+    result.numPatchCoords = numPatchCoords;
+
+    int derivWidth = options.evalDerivatives ? (2 * width) : 0;
+
+    VERTEX_BUFFER * srcBuffer = VERTEX_BUFFER::Create(
+        width, data.numTotalVertices, deviceContext);
+    VERTEX_BUFFER * dstBuffer = VERTEX_BUFFER::Create(
+        width, std::max(numPatchCoords, 1), deviceContext);
+    VERTEX_BUFFER * derivBuffer = options.evalDerivatives
+        ? VERTEX_BUFFER::Create(derivWidth, std::max(numPatchCoords, 1),
+                                deviceContext)
+        : 0;
+    VERTEX_BUFFER * patchCoordBuffer = VERTEX_BUFFER::Create(
+        5, std::max(numPatchCoords, 1), deviceContext);
+
+    srcBuffer->UpdateData(&data.coarseValues[0], 0,
+                          data.numControlVertices, deviceContext);
+    if (numPatchCoords) {
+        patchCoordBuffer->UpdateData((float const *)&data.patchCoords[0], 0,
+                                     numPatchCoords, deviceContext);
+    }
+
+    STENCIL_TABLE const * stencilTable =
+        Osd::convertToCompatibleStencilTable<STENCIL_TABLE>(
+            data.stencilTable, deviceContext);
+
+    PATCH_TABLE * patchTable =
+        PATCH_TABLE::Create(data.patchTable, deviceContext);
+
+    result.tableBytes  = GetStencilTableBytes(*data.stencilTable) +
+                         GetPatchTableBytes(*data.patchTable);
+    result.bufferBytes = ((size_t) data.numTotalVertices * width +
+                          (size_t) numPatchCoords * (width + derivWidth) +
+                          (size_t) numPatchCoords * 5) * sizeof(float);
+
+    //
+    //  Stencils -- refined vertices follow the control vertices in the
+    //  source buffer:
+    //
+    Osd::BufferDescriptor srcDesc(0, width, width);
+    Osd::BufferDescriptor dstDesc(data.numControlVertices * width,
+                                  width, width);
+
+    EVALUATOR const * instance = Osd::GetEvaluator<EVALUATOR>(
+        evaluatorCache, srcDesc, dstDesc, deviceContext);
+
+    //  Warm up once (compiling kernels and transferring data) before timing:
+    EVALUATOR::EvalStencils(srcBuffer, srcDesc, srcBuffer, dstDesc,
+                            stencilTable, instance, deviceContext);
+    EVALUATOR::Synchronize(deviceContext);
+
+    Stopwatch s;
+    int iterations = 0;
+    do {
+        s.Start();
+        EVALUATOR::EvalStencils(srcBuffer, srcDesc, srcBuffer, dstDesc,
+                                stencilTable, instance, deviceContext);
+        EVALUATOR::Synchronize(deviceContext);
+        s.Stop();
+        ++iterations;
+    } while (s.GetTotalElapsed() < options.minTime);
+
+    result.timeStencils = s.GetTotalElapsed() / iterations;
+
+    //
+    //  Patches -- with optional first derivatives:
+    //
+    if (numPatchCoords) {
+        Osd::BufferDescriptor patchDesc(0, width, width);
+        Osd::BufferDescriptor duDesc(0,     width, derivWidth);
+        Osd::BufferDescriptor dvDesc(width, width, derivWidth);
+
+        if (options.evalDerivatives) {
+            instance = Osd::GetEvaluator<EVALUATOR>(evaluatorCache,
+                srcDesc, patchDesc, duDesc, dvDesc, deviceContext);
+        } else {
+            instance = Osd::GetEvaluator<EVALUATOR>(evaluatorCache,
+                srcDesc, patchDesc, deviceContext);
+        }
+
+        Stopwatch p;
+        iterations = 0;
+        //  The first iteration warms up and is not timed:
+        for (int i = 0; (i <= 1) || (p.GetTotalElapsed() < options.minTime); ++i) {
+            p.Start();
+            if (options.evalDerivatives) {
+                EVALUATOR::EvalPatches(srcBuffer, srcDesc,
+                                       dstBuffer, patchDesc,
+                                       derivBuffer, duDesc,
+                                       derivBuffer, dvDesc,
+                                       numPatchCoords, patchCoordBuffer,
+                                       patchTable, instance, deviceContext);
+            } else {
+                EVALUATOR::EvalPatches(srcBuffer, srcDesc,
+                                       dstBuffer, patchDesc,
+                                       numPatchCoords, patchCoordBuffer,
+                                       patchTable, instance, deviceContext);
+            }
+            EVALUATOR::Synchronize(deviceContext);
+            if (i > 0) {
+                p.Stop();
+                ++iterations;
+            }
+        }
+        result.timePatches = p.GetTotalElapsed() / iterations;
+    }
+
+    delete srcBuffer;
+    delete dstBuffer;
+    delete derivBuffer;
+    delete patchCoordBuffer;
+    delete stencilTable;
+    delete patchTable;
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+#ifdef OPENSUBDIV_HAS_OPENCL
+//
+//  Minimal OpenCL context, unlike that of the examples not shared with GL:
+//
+class CLPerfDeviceContext {
+public:
+    CLPerfDeviceContext() : _clContext(NULL), _clCommandQueue(NULL) { }
+    ~CLPerfDeviceContext() {
+        if (_clCommandQueue) clReleaseCommandQueue(_clCommandQueue);
+        if (_clContext) clReleaseContext(_clContext);
+    }
+
+    bool Initialize() {
+#ifdef OPENSUBDIV_HAS_CLEW
+        if (clewInit() != CLEW_SUCCESS) return false;
+#endif
+        cl_platform_id platform = NULL;
+        cl_uint numPlatforms = 0;
+        if ((clGetPlatformIDs(1, &platform, &numPlatforms) != CL_SUCCESS) ||
+            (numPlatforms == 0)) {
+            return false;
+        }
+        cl_device_id device = NULL;
+        if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device,
+                           NULL) != CL_SUCCESS) {
+            if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device,
+                               NULL) != CL_SUCCESS) {
+                return false;
+            }
+        }
+        cl_int err = CL_SUCCESS;
+        _clContext = clCreateContext(NULL, 1, &device, NULL, NULL, &err);
+        if (err != CL_SUCCESS) return false;
+
+        _clCommandQueue = clCreateCommandQueue(_clContext, device, 0, &err);
+        return (err == CL_SUCCESS);
+    }
+
+    cl_context GetContext() const {
+        return _clContext;
+    }
+    cl_command_queue GetCommandQueue() const {
+        return _clCommandQueue;
+    }
+
+private:
+    cl_context _clContext;
+    cl_command_queue _clCommandQueue;
+};
+#endif
+
+//
+//  Availability of each backend in this build (and on this machine for those
+//  requiring a device):
+//
+struct Backends {
+    Backends() {
+        for (int i = 0; i < kNumBackends; ++i) available[i] = false;
+        available[kCPU] = true;
+#ifdef OPENSUBDIV_HAS_OPENMP
+        available[kOPENMP] = true;
+#endif
+#ifdef OPENSUBDIV_HAS_TBB
+        available[kTBB] = true;
+#endif
+#ifdef OPENSUBDIV_HAS_CUDA
+        int deviceCount = 0;
+        if ((cudaGetDeviceCount(&deviceCount) == cudaSuccess) &&
+            (deviceCount > 0)) {
+            available[kCUDA] = (cudaSetDevice(0) == cudaSuccess);
+        }
+#endif
+#ifdef OPENSUBDIV_HAS_OPENCL
+        available[kCL] = clDeviceContext.Initialize();
+#endif
+    }
+
+    bool available[kNumBackends];
+
+#ifdef OPENSUBDIV_HAS_OPENCL
+    CLPerfDeviceContext clDeviceContext;
+    Osd::EvaluatorCacheT<Osd::CLEvaluator> clEvaluatorCache;
+#endif
+#ifdef OSD_PERF_HAS_GLSL_COMPUTE
+    Osd::EvaluatorCacheT<Osd::GLComputeEvaluator> glComputeEvaluatorCache;
+#endif
+};
+
+static TestResult
+RunPerfTest(Backend backend, Backends & backends,
+            TestData const & data, TestOptions const & options) {
+
+    switch (backend) {
+    case kCPU:
+        return RunBackend<Osd::CpuVertexBuffer, Far::StencilTable,
+                          Osd::CpuPatchTable, Osd::CpuEvaluator, void>(
+            backend, data, options, NULL, NULL);
+#ifdef OPENSUBDIV_HAS_OPENMP
+    case kOPENMP:
+        return RunBackend<Osd::CpuVertexBuffer, Far::StencilTable,
+                          Osd::CpuPatchTable, Osd::OmpEvaluator, void>(
+            backend, data, options, NULL, NULL);
+#endif
+#ifdef OPENSUBDIV_HAS_TBB
+    case kTBB:
+        return RunBackend<Osd::CpuVertexBuffer, Far::StencilTable,
+                          Osd::CpuPatchTable, Osd::TbbEvaluator, void>(
+            backend, data, options, NULL, NULL);
+#endif
+#ifdef OPENSUBDIV_HAS_CUDA
+    case kCUDA:
+        return RunBackend<Osd::CudaVertexBuffer, Osd::CudaStencilTable,
+                          Osd::CudaPatchTable, Osd::CudaEvaluator, void>(
+            backend, data, options, NULL, NULL);
+#endif
+#ifdef OPENSUBDIV_HAS_OPENCL
+    case kCL:
+        return RunBackend<Osd::CLVertexBuffer, Osd::CLStencilTable,
+                          Osd::CLPatchTable, Osd::CLEvaluator,
+                          CLPerfDeviceContext>(
+            backend, data, options,
+            &backends.clEvaluatorCache, &backends.clDeviceContext);
+#endif
+#ifdef OSD_PERF_HAS_GLSL_COMPUTE
+    case kGLCompute:
+        return RunBackend<Osd::GLVertexBuffer, Osd::GLStencilTableSSBO,
+                          Osd::GLPatchTable, Osd::GLComputeEvaluator, void>(
+            backend, data, options,
+            &backends.glComputeEvaluatorCache, NULL);
+#endif
+    default:
+        break;
+    }
+    (void)backends;
+    assert("Unavailable backend" == 0);
+    return TestResult();
+}
+
+//------------------------------------------------------------------------------
+
+struct PrintOptions {
+    PrintOptions() : csvFormat(false) { }
+
+    bool csvFormat;
+};
+
+static double
+GetRate(int count, double time) {
+    return (time > 0) ? (count / time) : 0;
+}
+
+static void
+PrintShape(ShapeDesc const & shapeDesc, PrintOptions const & ) {
+
+    static char const * g_schemeNames[3] = { "bilinear", "catmark", "loop" };
+
+    char const * shapeName   = shapeDesc.name.c_str();
+    Scheme       shapeScheme = shapeDesc.scheme;
+
+    printf("%s (%s):\n", shapeName, g_schemeNames[shapeScheme]);
+}
+
+static void
+PrintResult(TestResult const & result, PrintOptions const & ) {
+
+    printf("  level %d, width %2d, %-9s  "
+           "stencils %8d %10.4f ms %8.3f Mverts/s   "
+           "patches %8d %10.4f ms %8.3f Mcoords/s   "
+           "tables %8.3f MB  buffers %8.3f MB\n",
+           result.level, result.width, g_backendNames[result.backend],
+           result.numStencils, result.timeStencils * 1000.0,
+           GetRate(result.numStencils, result.timeStencils) * 1e-6,
+           result.numPatchCoords, result.timePatches * 1000.0,
+           GetRate(result.numPatchCoords, result.timePatches) * 1e-6,
+           result.tableBytes  / (1024.0 * 1024.0),
+           result.bufferBytes / (1024.0 * 1024.0));
+}
+
+static void
+PrintHeaderCSV(PrintOptions const & ) {
+
+    // spreadsheet header row
+    printf("shape,level,width,backend");
+    printf(",stencils,stencilTime,vertsPerSecond");
+    printf(",patchCoords,patchTime,coordsPerSecond");
+    printf(",tableBytes,bufferBytes");
+    printf("\n");
+}
+
+static void
+PrintResultCSV(TestResult const & result, PrintOptions const & ) {
+
+    // spreadsheet data row
+    printf("%s,%d,%d,%s", result.name.c_str(), result.level, result.width,
+           g_backendNames[result.backend]);
+    printf(",%d,%g,%g", result.numStencils, result.timeStencils,
+           GetRate(result.numStencils, result.timeStencils));
+    printf(",%d,%g,%g", result.numPatchCoords, result.timePatches,
+           GetRate(result.numPatchCoords, result.timePatches));
+    printf(",%lu,%lu", (unsigned long) result.tableBytes,
+           (unsigned long) result.bufferBytes);
+    printf("\n");
+}
+
+//------------------------------------------------------------------------------
+
+static int
+parseIntArg(char const * argString, int dfltValue = 0) {
+    char *argEndptr;
+    int argValue = strtol(argString, &argEndptr, 10);
+    if (*argEndptr != 0) {
+        fprintf(stderr,
+                "Warning: non-integer option parameter '%s' ignored\n",
+                argString);
+        argValue = dfltValue;
+    }
+    return argValue;
+}
+
+static void
+usage(char const * program) {
+    printf("Usage: %s [options] [file.obj ...]\n", program);
+    printf("  -a | -u           adaptive (default) or uniform refinement\n");
+    printf("  -l <level>        maximum level (levels 1 to 3 by default)\n");
+    printf("  -w <width>        primvar width (repeatable, default 3 and 8)\n");
+    printf("  -s <samples>      patch coords per ptex face edge (default 4)\n");
+    printf("  -t <seconds>      minimum time of each measurement (default 0.1)\n");
+    printf("  -d                evaluate patches with first derivatives\n");
+    printf("  -e <type>         end cap type: linear, regular or gregory\n");
+    printf("  -bilinear, -catmark, -loop  scheme of given .obj files\n");
+    printf("  -cpu -omp -tbb -cuda -cl -glcompute\n");
+    printf("                    backends to run (all available by default)\n");
+    printf("  -csv              print results as comma separated values\n");
+}
+
+int main(int argc, char **argv)
+{
+    TestOptions testOptions;
+    PrintOptions printOptions;
+    std::vector<std::string> objFiles;
+    std::vector<int> widths;
+    Scheme defaultScheme = kCatmark;
+    int minLevel = 1;
+    int maxLevel = 3;
+
+    bool backendRequested[kNumBackends];
+    bool anyBackendRequested = false;
+    for (int i = 0; i < kNumBackends; ++i) backendRequested[i] = false;
+
+    for (int i = 1; i < argc; ++i) {
+        Backend requested = kNumBackends;
+
+        if (strstr(argv[i], ".obj")) {
+            objFiles.push_back(std::string(argv[i]));
+        } else if (!strcmp(argv[i], "-a")) {
+            testOptions.refineAdaptive = true;
+        } else if (!strcmp(argv[i], "-u")) {
+            testOptions.refineAdaptive = false;
+        } else if (!strcmp(argv[i], "-l")) {
+            if (++i < argc) maxLevel = parseIntArg(argv[i], maxLevel);
+        } else if (!strcmp(argv[i], "-w")) {
+            if (++i < argc) widths.push_back(std::max(1, parseIntArg(argv[i], 3)));
+        } else if (!strcmp(argv[i], "-s")) {
+            if (++i < argc) testOptions.samplesPerFace =
+                std::max(1, parseIntArg(argv[i], testOptions.samplesPerFace));
+        } else if (!strcmp(argv[i], "-t")) {
+            if (++i < argc) testOptions.minTime = atof(argv[i]);
+        } else if (!strcmp(argv[i], "-d")) {
+            testOptions.evalDerivatives = true;
+        } else if (!strcmp(argv[i], "-bilinear")) {
+            defaultScheme = kBilinear;
+        } else if (!strcmp(argv[i], "-catmark")) {
+            defaultScheme = kCatmark;
+        } else if (!strcmp(argv[i], "-loop")) {
+            defaultScheme = kLoop;
+        } else if (!strcmp(argv[i], "-e")) {
+            char const * type = (++i < argc) ? argv[i] : "";
+            if (!strcmp(type, "linear")) {
+                testOptions.endCapType =
+                        Far::PatchTableFactory::Options::ENDCAP_BILINEAR_BASIS;
+            } else if (!strcmp(type, "regular")) {
+                testOptions.endCapType =
+                        Far::PatchTableFactory::Options::ENDCAP_BSPLINE_BASIS;
+            } else if (!strcmp(type, "gregory")) {
+                testOptions.endCapType =
+                        Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS;
+            } else {
+                fprintf(stderr, "Error: Unknown endcap type %s\n", type);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-cpu")) {
+            requested = kCPU;
+        } else if (!strcmp(argv[i], "-omp")) {
+            requested = kOPENMP;
+        } else if (!strcmp(argv[i], "-tbb")) {
+            requested = kTBB;
+        } else if (!strcmp(argv[i], "-cuda")) {
+            requested = kCUDA;
+        } else if (!strcmp(argv[i], "-cl")) {
+            requested = kCL;
+        } else if (!strcmp(argv[i], "-glcompute")) {
+            requested = kGLCompute;
+        } else if (!strcmp(argv[i], "-csv")) {
+            printOptions.csvFormat = true;
+        } else if (!strcmp(argv[i], "-h")) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr,
+                "Warning: unrecognized argument '%s' ignored\n", argv[i]);
+        }
+        if (requested != kNumBackends) {
+            backendRequested[requested] = true;
+            anyBackendRequested = true;
+        }
+    }
+    minLevel = std::min(minLevel, maxLevel);
+
+    if (widths.empty()) {
+        widths.push_back(3);
+        widths.push_back(8);
+    }
+
+#if defined(OSD_PERF_HAS_GLFW)
+    //  A GL context is required by the GL backends -- create a hidden window:
+    GLFWwindow * window = 0;
+    if (glfwInit()) {
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        window = glfwCreateWindow(16, 16, "osd_perf", NULL, NULL);
+        if (window) {
+            glfwMakeContextCurrent(window);
+            OpenSubdiv::internal::GLLoader::applicationInitializeGL();
+        }
+    }
+#endif
+
+    Backends backends;
+#if defined(OSD_PERF_HAS_GLSL_COMPUTE)
+    backends.available[kGLCompute] = (window != 0);
+#endif
+
+    std::vector<Backend> backendsToRun;
+    for (int i = 0; i < kNumBackends; ++i) {
+        if (anyBackendRequested && !backendRequested[i]) continue;
+
+        if (backends.available[i]) {
+            backendsToRun.push_back((Backend) i);
+        } else if (anyBackendRequested) {
+            fprintf(stderr, "Warning: backend %s is not available\n",
+                    g_backendNames[i]);
+        }
+    }
+
+    if (!objFiles.empty()) {
+        for (size_t i = 0; i < objFiles.size(); ++i) {
+            char const * objFile = objFiles[i].c_str();
+            std::string objString;
+            if (readShapeFile(objFile, objString)) {
+                g_shapes.push_back(ShapeDesc(objFile, objString, defaultScheme));
+            } else {
+                fprintf(stderr,
+                    "Warning: cannot open shape file '%s'\n", objFile);
+            }
+        }
+    }
+
+    if (g_shapes.empty()) {
+        initShapes();
+    }
+
+    //  For each shape, run tests for all specified levels, widths and
+    //  backends -- printing the results in the specified format:
+    //
+    if (printOptions.csvFormat) {
+        PrintHeaderCSV(printOptions);
+    }
+    for (size_t i = 0; i < g_shapes.size(); ++i) {
+        ShapeDesc const & shapeDesc = g_shapes[i];
+        Shape const * shape = Shape::parseObj(shapeDesc);
+
+        if (!printOptions.csvFormat) {
+            PrintShape(shapeDesc, printOptions);
+        }
+
+        for (int levelIndex = minLevel; levelIndex <= maxLevel; ++levelIndex) {
+            testOptions.refineLevel = levelIndex;
+
+            for (size_t w = 0; w < widths.size(); ++w) {
+                testOptions.primvarWidth = widths[w];
+
+                TestData * data = CreateTestData(*shape, testOptions);
+
+                for (size_t b = 0; b < backendsToRun.size(); ++b) {
+                    TestResult result = RunPerfTest(backendsToRun[b], backends,
+                                                    *data, testOptions);
+                    result.name = shapeDesc.name;
+
+                    if (printOptions.csvFormat) {
+                        PrintResultCSV(result, printOptions);
+                    } else {
+                        PrintResult(result, printOptions);
+                    }
+                }
+                delete data;
+            }
+        }
+        delete shape;
+    }
+
+#if defined(OSD_PERF_HAS_GLFW)
+    if (window) {
+        glfwDestroyWindow(window);
+    }
+    glfwTerminate();
+#endif
+    return 0;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,682 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opensubdiv/far/patchMap.h>
+#include <opensubdiv/far/patchTableFactory.h>
+#include <opensubdiv/far/primvarRefiner.h>
+#include <opensubdiv/far/ptexIndices.h>
+#include <opensubdiv/far/stencilTableFactory.h>
+#include <opensubdiv/far/topologyDescriptor.h>
+
+#include <opensubdiv/osd/mesh.h>
+#include <opensubdiv/osd/cpuPatchTable.h>
+#include <opensubdiv/osd/cpuVertexBuffer.h>
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <omp.h>
+    #include <opensubdiv/osd/ompEvaluator.h>
+#endif
+
+#ifdef OPENSUBDIV_HAS_TBB
+    #include <opensubdiv/osd/tbbEvaluator.h>
+#endif
+
+#include "../../regression/common/far_utils.h"
+#include "../../examples/common/stopwatch.h"
+
+#include "init_shapes.h"
+
+//------------------------------------------------------------------------------
+//
+//  Scalability of the construction of the Far tables and of the evaluation
+//  with the OpenMP and TBB evaluators: meshes of increasing size are
+//  synthesized by uniformly refining the given shapes as base cages, and
+//  each stage is timed for a sweep of thread counts, reporting its speedup
+//  and efficiency relative to a single thread.
+//
+
+using namespace OpenSubdiv;
+
+enum Stage {
+    kRefine = 0,
+    kStencilFactory,
+    kPatchFactory,
+    kOmpStencils,
+    kOmpPatches,
+    kTbbStencils,
+    kTbbPatches,
+    kNumStages
+};
+
+static char const * g_stageNames[kNumStages] = {
+    "refine", "stencilFactory", "patchFactory",
+    "ompStencils", "ompPatches", "tbbStencils", "tbbPatches"
+};
+
+struct TestOptions {
+    TestOptions() :
+        refineLevel(2),
+        samplesPerFace(2),
+        numRuns(3),
+        minTime(0.05) { }
+
+    int    refineLevel;
+    int    samplesPerFace;
+    int    numRuns;
+    double minTime;
+};
+
+//
+//  A base cage of a given size -- the topology and positions of a shape
+//  uniformly refined a number of times, including its sharpness:
+//
+struct Cage {
+    Sdc::SchemeType sdcType;
+    Sdc::Options    sdcOptions;
+
+    std::vector<int>        vertsPerFace;
+    std::vector<Far::Index> faceVerts;
+    std::vector<Far::Index> creaseVerts;
+    std::vector<float>      creaseWeights;
+    std::vector<Far::Index> cornerVerts;
+    std::vector<float>      cornerWeights;
+
+    std::vector<float> positions;
+
+    int GetNumVertices() const { return (int)positions.size() / 3; }
+    int GetNumFaces() const { return (int)vertsPerFace.size(); }
+
+    Far::TopologyRefiner * CreateRefiner(int numThreads) const;
+};
+
+Far::TopologyRefiner *
+Cage::CreateRefiner(int numThreads) const {
+
+    typedef Far::TopologyDescriptor Descriptor;
+
+    Descriptor desc;
+    desc.numVertices            = GetNumVertices();
+    desc.numFaces               = GetNumFaces();
+    desc.numVertsPerFace        = &vertsPerFace[0];
+    desc.vertIndicesPerFace     = &faceVerts[0];
+    desc.numCreases             = (int)creaseWeights.size();
+    desc.creaseVertexIndexPairs = creaseWeights.empty() ? 0 : &creaseVerts[0];
+    desc.creaseWeights          = creaseWeights.empty() ? 0 : &creaseWeights[0];
+    desc.numCorners             = (int)cornerWeights.size();
+    desc.cornerVertexIndices    = cornerWeights.empty() ? 0 : &cornerVerts[0];
+    desc.cornerWeights          = cornerWeights.empty() ? 0 : &cornerWeights[0];
+
+    Far::TopologyRefinerFactory<Descriptor>::Options options(sdcType,
+                                                             sdcOptions);
+    options.numThreads = numThreads;
+
+    return Far::TopologyRefinerFactory<Descriptor>::Create(desc, options);
+}
+
+//  Minimal vertex class interpolating positions with the PrimvarRefiner:
+struct Point3 {
+    void Clear() { p[0] = p[1] = p[2] = 0.0f; }
+    void AddWithWeight(Point3 const & src, float w) {
+        p[0] += w * src.p[0];
+        p[1] += w * src.p[1];
+        p[2] += w * src.p[2];
+    }
+    float p[3];
+};
+
+static Cage *
+CreateCage(Shape const & shape, int level) {
+
+    Sdc::SchemeType sdcType = GetSdcType(shape);
+    Sdc::Options sdcOptions = GetSdcOptions(shape);
+
+    Far::TopologyRefiner * refiner = Far::TopologyRefinerFactory<Shape>::Create(
+        shape, Far::TopologyRefinerFactory<Shape>::Options(sdcType, sdcOptions));
+    assert(refiner);
+
+    if (level > 0) {
+        Far::TopologyRefiner::UniformOptions uoptions(level);
+        uoptions.fullTopologyInLastLevel = true;
+        refiner->RefineUniform(uoptions);
+    }
+
+    Cage * cage = new Cage;
+    cage->sdcType    = sdcType;
+    cage->sdcOptions = sdcOptions;
+
+    //  Interpolate the positions to the last level:
+    std::vector<Point3> points(refiner->GetNumVerticesTotal());
+    memcpy(&points[0], &shape.verts[0], shape.verts.size() * sizeof(float));
+
+    Far::PrimvarRefiner primvarRefiner(*refiner);
+    Point3 * src = &points[0];
+    for (int l = 1; l <= level; ++l) {
+        Point3 * dst = src + refiner->GetLevel(l - 1).GetNumVertices();
+        primvarRefiner.Interpolate(l, src, dst);
+        src = dst;
+    }
+
+    Far::TopologyLevel const & last = refiner->GetLevel(level);
+
+    cage->positions.assign(&src[0].p[0],
+                           &src[0].p[0] + last.GetNumVertices() * 3);
+
+    cage->vertsPerFace.resize(last.GetNumFaces());
+    cage->faceVerts.reserve(last.GetNumFaceVertices());
+    for (int f = 0; f < last.GetNumFaces(); ++f) {
+        Far::ConstIndexArray fVerts = last.GetFaceVertices(f);
+        cage->vertsPerFace[f] = fVerts.size();
+        cage->faceVerts.insert(cage->faceVerts.end(),
+                               fVerts.begin(), fVerts.end());
+    }
+    for (int e = 0; e < last.GetNumEdges(); ++e) {
+        float sharpness = last.GetEdgeSharpness(e);
+        if (sharpness > 0.0f) {
+            Far::ConstIndexArray eVerts = last.GetEdgeVertices(e);
+            cage->creaseVerts.push_back(eVerts[0]);
+            cage->creaseVerts.push_back(eVerts[1]);
+            cage->creaseWeights.push_back(sharpness);
+        }
+    }
+    for (int v = 0; v < last.GetNumVertices(); ++v) {
+        float sharpness = last.GetVertexSharpness(v);
+        if (sharpness > 0.0f) {
+            cage->cornerVerts.push_back(v);
+            cage->cornerWeights.push_back(sharpness);
+        }
+    }
+
+    delete refiner;
+    return cage;
+}
+
+//------------------------------------------------------------------------------
+
+//
+//  Tables built with a given number of threads, and the time of each stage
+//  of their construction:
+//
+struct TestData {
+    TestData() : stencilTable(0), patchTable(0) { }
+    ~TestData() {
+        delete stencilTable;
+        delete patchTable;
+    }
+
+    Far::StencilTable const * stencilTable;
+    Far::PatchTable const *   patchTable;
+
+    std::vector<Osd::PatchCoord> patchCoords;
+
+    int numControlVertices;
+    int numTotalVertices;
+
+    double timeRefine;
+    double timeStencilFactory;
+    double timePatchFactory;
+};
+
+static TestData *
+CreateTestData(Cage const & cage, TestOptions const & options,
+               int numThreads) {
+
+    TestData * data = new TestData;
+
+    Stopwatch s;
+
+    s.Start();
+    Far::TopologyRefiner * refiner = cage.CreateRefiner(numThreads);
+    assert(refiner);
+
+    Far::PatchTableFactory::Options poptions(options.refineLevel);
+    poptions.SetEndCapType(
+        Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+    poptions.numThreads = numThreads;
+
+    Far::TopologyRefiner::AdaptiveOptions aoptions =
+        poptions.GetRefineAdaptiveOptions();
+    aoptions.numThreads = numThreads;
+    refiner->RefineAdaptive(aoptions);
+    s.Stop();
+    data->timeRefine = s.GetElapsed();
+
+    s.Start();
+    Far::StencilTableFactory::Options soptions;
+    soptions.generateOffsets = true;
+    soptions.generateIntermediateLevels = true;
+    soptions.numThreads = numThreads;
+
+    Far::StencilTable * stencilTable = const_cast<Far::StencilTable *>(
+        Far::StencilTableFactory::Create(*refiner, soptions));
+    s.Stop();
+    data->timeStencilFactory = s.GetElapsed();
+
+    s.Start();
+    data->patchTable = Far::PatchTableFactory::Create(*refiner, poptions);
+    s.Stop();
+    data->timePatchFactory = s.GetElapsed();
+
+    //  Append the local points of the patch table to the stencils:
+    Far::StencilTableFactory::AppendLocalPointStencilTable(*refiner,
+        *stencilTable, data->patchTable->GetLocalPointStencilTable());
+    data->stencilTable = stencilTable;
+
+    data->numControlVertices = refiner->GetLevel(0).GetNumVertices();
+    data->numTotalVertices   = data->numControlVertices +
+                               stencilTable->GetNumStencils();
+
+    //  Sample each ptex face uniformly:
+    Far::PtexIndices ptexIndices(*refiner);
+    Far::PatchMap patchMap(*data->patchTable);
+
+    int numFaces = ptexIndices.GetNumFaces();
+    int n = options.samplesPerFace;
+
+    data->patchCoords.reserve(numFaces * n * n);
+    for (int face = 0; face < numFaces; ++face) {
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                float s = (i + 0.5f) / n;
+                float t = (j + 0.5f) / n;
+
+                Far::PatchTable::PatchHandle const * handle =
+                    patchMap.FindPatch(face, s, t);
+                if (handle) {
+                    data->patchCoords.push_back(Osd::PatchCoord(*handle, s, t));
+                }
+            }
+        }
+    }
+
+    delete refiner;
+    return data;
+}
+
+//------------------------------------------------------------------------------
+
+//
+//  Evaluate the stencils and patches with a CPU evaluator, repeating each
+//  until the minimum time is reached, and return the average times:
+//
+template <typename EVALUATOR>
+static void
+RunEvaluator(Cage const & cage, TestData const & data,
+             TestOptions const & options,
+             double & timeStencils, double & timePatches) {
+
+    int const width    = 3;
+    int numPatchCoords = (int) data.patchCoords.size();
+
+    Osd::CpuVertexBuffer * srcBuffer = Osd::CpuVertexBuffer::Create(
+        width, data.numTotalVertices);
+    Osd::CpuVertexBuffer * dstBuffer = Osd::CpuVertexBuffer::Create(
+        width, std::max(numPatchCoords, 1));
+    Osd::CpuVertexBuffer * patchCoordBuffer = Osd::CpuVertexBuffer::Create(
+        5, std::max(numPatchCoords, 1));
+
+    srcBuffer->UpdateData(&cage.positions[0], 0, data.numControlVertices);
+    if (numPatchCoords) {
+        patchCoordBuffer->UpdateData((float const *)&data.patchCoords[0], 0,
+                                     numPatchCoords);
+    }
+
+    Osd::CpuPatchTable * patchTable =
+        Osd::CpuPatchTable::Create(data.patchTable);
+
+    Osd::BufferDescriptor srcDesc(0, width, width);
+    Osd::BufferDescriptor dstDesc(data.numControlVertices * width,
+                                  width, width);
+
+    //  Warm up once before timing:
+    EVALUATOR::EvalStencils(srcBuffer, srcDesc, srcBuffer, dstDesc,
+                            data.stencilTable);
+
+    Stopwatch s;
+    int iterations = 0;
+    do {
+        s.Start();
+        EVALUATOR::EvalStencils(srcBuffer, srcDesc, srcBuffer, dstDesc,
+                                data.stencilTable);
+        s.Stop();
+        ++iterations;
+    } while (s.GetTotalElapsed() < options.minTime);
+    timeStencils = s.GetTotalElapsed() / iterations;
+
+    timePatches = 0;
+    if (numPatchCoords) {
+        Osd::BufferDescriptor patchDesc(0, width, width);
+
+        EVALUATOR::EvalPatches(srcBuffer, srcDesc, dstBuffer, patchDesc,
+                               numPatchCoords, patchCoordBuffer, patchTable);
+        Stopwatch p;
+        iterations = 0;
+        do {
+            p.Start();
+            EVALUATOR::EvalPatches(srcBuffer, srcDesc, dstBuffer, patchDesc,
+                                   numPatchCoords, patchCoordBuffer,
+                                   patchTable);
+            p.Stop();
+            ++iterations;
+        } while (p.GetTotalElapsed() < options.minTime);
+        timePatches = p.GetTotalElapsed() / iterations;
+    }
+
+    delete srcBuffer;
+    delete dstBuffer;
+    delete patchCoordBuffer;
+    delete patchTable;
+}
+
+//
+//  The times of all stages for a given number of threads -- the minimum of
+//  several runs for the construction of the tables:
+//
+struct TestResult {
+    TestResult() : numThreads(0) {
+        for (int i = 0; i < kNumStages; ++i) times[i] = 0;
+    }
+
+    int    numThreads;
+    double times[kNumStages];
+};
+
+static TestResult
+RunScalingTest(Cage const & cage, TestOptions const & options,
+               int numThreads) {
+
+    TestResult result;
+    result.numThreads = numThreads;
+
+    TestData * data = 0;
+    for (int run = 0; run < options.numRuns; ++run) {
+        delete data;
+        data = CreateTestData(cage, options, numThreads);
+
+        double timeRefine  = data->timeRefine;
+        double timeStencil = data->timeStencilFactory;
+        double timePatch   = data->timePatchFactory;
+        if (run == 0) {
+            result.times[kRefine]         = timeRefine;
+            result.times[kStencilFactory] = timeStencil;
+            result.times[kPatchFactory]   = timePatch;
+        } else {
+            result.times[kRefine] =
+                std::min(result.times[kRefine], timeRefine);
+            result.times[kStencilFactory] =
+                std::min(result.times[kStencilFactory], timeStencil);
+            result.times[kPatchFactory] =
+                std::min(result.times[kPatchFactory], timePatch);
+        }
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    Osd::OmpEvaluator::SetNumThreads(numThreads);
+    RunEvaluator<Osd::OmpEvaluator>(cage, *data, options,
+        result.times[kOmpStencils], result.times[kOmpPatches]);
+#endif
+#ifdef OPENSUBDIV_HAS_TBB
+    Osd::TbbEvaluator::SetNumThreads(numThreads);
+    RunEvaluator<Osd::TbbEvaluator>(cage, *data, options,
+        result.times[kTbbStencils], result.times[kTbbPatches]);
+    Osd::TbbEvaluator::SetNumThreads(-1);
+#endif
+
+    delete data;
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+struct PrintOptions {
+    PrintOptions() : csvFormat(false) { }
+
+    bool csvFormat;
+};
+
+static bool
+IsStageAvailable(int stage) {
+#ifndef OPENSUBDIV_HAS_OPENMP
+    if ((stage == kOmpStencils) || (stage == kOmpPatches)) return false;
+#endif
+#ifndef OPENSUBDIV_HAS_TBB
+    if ((stage == kTbbStencils) || (stage == kTbbPatches)) return false;
+#endif
+    (void)stage;
+    return true;
+}
+
+static double
+GetSpeedup(double serialTime, double time) {
+    return (time > 0) ? (serialTime / time) : 0;
+}
+
+static void
+PrintCage(char const * name, int size, Cage const & cage,
+          PrintOptions const & ) {
+
+    printf("%s x%d: %d faces, %d vertices\n", name, size,
+           cage.GetNumFaces(), cage.GetNumVertices());
+}
+
+static void
+PrintResults(std::vector<TestResult> const & results,
+             PrintOptions const & ) {
+
+    printf("  %-15s threads    time ms   speedup  efficiency\n", "stage");
+    for (int stage = 0; stage < kNumStages; ++stage) {
+        if (!IsStageAvailable(stage)) continue;
+
+        double serialTime = results[0].times[stage];
+        for (size_t i = 0; i < results.size(); ++i) {
+            TestResult const & result = results[i];
+            double speedup = GetSpeedup(serialTime, result.times[stage]);
+
+            printf("  %-15s %7d %10.4f %9.2f %10.1f%%\n",
+                   (i == 0) ? g_stageNames[stage] : "", result.numThreads,
+                   result.times[stage] * 1000.0, speedup,
+                   100.0 * speedup / result.numThreads);
+        }
+    }
+}
+
+static void
+PrintHeaderCSV(PrintOptions const & ) {
+
+    // spreadsheet header row
+    printf("shape,size,faces,vertices,stage,threads,time,speedup,efficiency\n");
+}
+
+static void
+PrintResultsCSV(char const * name, int size, Cage const & cage,
+                std::vector<TestResult> const & results,
+                PrintOptions const & ) {
+
+    // spreadsheet data rows, one per stage and thread count
+    for (int stage = 0; stage < kNumStages; ++stage) {
+        if (!IsStageAvailable(stage)) continue;
+
+        double serialTime = results[0].times[stage];
+        for (size_t i = 0; i < results.size(); ++i) {
+            TestResult const & result = results[i];
+            double speedup = GetSpeedup(serialTime, result.times[stage]);
+
+            printf("%s,%d,%d,%d,%s,%d,%g,%g,%g\n", name, size,
+                   cage.GetNumFaces(), cage.GetNumVertices(),
+                   g_stageNames[stage], result.numThreads,
+                   result.times[stage], speedup, speedup / result.numThreads);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static int
+parseIntArg(char const * argString, int dfltValue = 0) {
+    char *argEndptr;
+    int argValue = strtol(argString, &argEndptr, 10);
+    if (*argEndptr != 0) {
+        fprintf(stderr,
+                "Warning: non-integer option parameter '%s' ignored\n",
+                argString);
+        argValue = dfltValue;
+    }
+    return argValue;
+}
+
+static int
+getMaxThreads() {
+#ifdef OPENSUBDIV_HAS_OPENMP
+    return omp_get_num_procs();
+#else
+    return 4;
+#endif
+}
+
+static void
+usage(char const * program) {
+    printf("Usage: %s [options] [file.obj ...]\n", program);
+    printf("  -l <level>        adaptive refinement level (default 2)\n");
+    printf("  -m <size>         uniform refinements of the base cages to\n");
+    printf("                    synthesize larger meshes (0 to 2 by default)\n");
+    printf("  -j <threads>      maximum number of threads (default: number of\n");
+    printf("                    processors), doubled from 1 in the sweep\n");
+    printf("  -r <runs>         runs of the construction of the tables\n");
+    printf("                    (default 3, the minimum time is reported)\n");
+    printf("  -s <samples>      patch coords per ptex face edge (default 2)\n");
+    printf("  -t <seconds>      minimum time of each evaluation (default 0.05)\n");
+    printf("  -bilinear, -catmark, -loop  scheme of given .obj files\n");
+    printf("  -csv              print results as comma separated values\n");
+}
+
+int main(int argc, char **argv)
+{
+    TestOptions testOptions;
+    PrintOptions printOptions;
+    std::vector<std::string> objFiles;
+    Scheme defaultScheme = kCatmark;
+    int maxSize = 2;
+    int maxThreads = getMaxThreads();
+
+    for (int i = 1; i < argc; ++i) {
+        if (strstr(argv[i], ".obj")) {
+            objFiles.push_back(std::string(argv[i]));
+        } else if (!strcmp(argv[i], "-l")) {
+            if (++i < argc) testOptions.refineLevel =
+                parseIntArg(argv[i], testOptions.refineLevel);
+        } else if (!strcmp(argv[i], "-m")) {
+            if (++i < argc) maxSize = std::max(0, parseIntArg(argv[i], maxSize));
+        } else if (!strcmp(argv[i], "-j")) {
+            if (++i < argc) maxThreads =
+                std::min(255, std::max(1, parseIntArg(argv[i], maxThreads)));
+        } else if (!strcmp(argv[i], "-r")) {
+            if (++i < argc) testOptions.numRuns =
+                std::max(1, parseIntArg(argv[i], testOptions.numRuns));
+        } else if (!strcmp(argv[i], "-s")) {
+            if (++i < argc) testOptions.samplesPerFace =
+                std::max(1, parseIntArg(argv[i], testOptions.samplesPerFace));
+        } else if (!strcmp(argv[i], "-t")) {
+            if (++i < argc) testOptions.minTime = atof(argv[i]);
+        } else if (!strcmp(argv[i], "-bilinear")) {
+            defaultScheme = kBilinear;
+        } else if (!strcmp(argv[i], "-catmark")) {
+            defaultScheme = kCatmark;
+        } else if (!strcmp(argv[i], "-loop")) {
+            defaultScheme = kLoop;
+        } else if (!strcmp(argv[i], "-csv")) {
+            printOptions.csvFormat = true;
+        } else if (!strcmp(argv[i], "-h")) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr,
+                "Warning: unrecognized argument '%s' ignored\n", argv[i]);
+        }
+    }
+
+    //  Thread counts doubling from 1, ending with the maximum:
+    std::vector<int> threadCounts;
+    for (int n = 1; n < maxThreads; n *= 2) {
+        threadCounts.push_back(n);
+    }
+    threadCounts.push_back(maxThreads);
+
+    if (!objFiles.empty()) {
+        for (size_t i = 0; i < objFiles.size(); ++i) {
+            char const * objFile = objFiles[i].c_str();
+            std::string objString;
+            if (readShapeFile(objFile, objString)) {
+                g_shapes.push_back(ShapeDesc(objFile, objString, defaultScheme));
+            } else {
+                fprintf(stderr,
+                    "Warning: cannot open shape file '%s'\n", objFile);
+            }
+        }
+    }
+
+    if (g_shapes.empty()) {
+        initShapes();
+    }
+
+    //  For each shape and size of cage, run the tests for all thread counts:
+    //
+    if (printOptions.csvFormat) {
+        PrintHeaderCSV(printOptions);
+    }
+    for (size_t i = 0; i < g_shapes.size(); ++i) {
+        ShapeDesc const & shapeDesc = g_shapes[i];
+        Shape const * shape = Shape::parseObj(shapeDesc);
+
+        for (int size = 0; size <= maxSize; ++size) {
+            Cage const * cage = CreateCage(*shape, size);
+
+            std::vector<TestResult> results;
+            for (size_t t = 0; t < threadCounts.size(); ++t) {
+                results.push_back(
+                    RunScalingTest(*cage, testOptions, threadCounts[t]));
+            }
+
+            if (printOptions.csvFormat) {
+                PrintResultsCSV(shapeDesc.name.c_str(), size, *cage,
+                                results, printOptions);
+            } else {
+                PrintCage(shapeDesc.name.c_str(), size, *cage, printOptions);
+                PrintResults(results, printOptions);
+            }
+            delete cage;
+        }
+        delete shape;
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------